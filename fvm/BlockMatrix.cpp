@@ -26,10 +26,17 @@ BlockMatrix::~BlockMatrix() {
 /**
  * Construct the matrix
  */
-void BlockMatrix::ConstructSystem() {
+void BlockMatrix::ConstructSystem(const PetscInt *nnzRow) {
     // Determine matrix size
     PetscInt mSize = this->next_subindex;
 
+    // Use the given number of non-zeros per row (e.g. the pattern
+    // of a previously assembled matrix)
+    if (nnzRow != nullptr) {
+        this->Construct(mSize, mSize, 0, nnzRow);
+        return;
+    }
+
     // Calculate number of non-zero elements in matrix
     PetscInt *nnz = new PetscInt[mSize];
     for (struct _subeq& s : this->subeqs) {
@@ -50,6 +57,32 @@ void BlockMatrix::ConstructSystem() {
     delete [] nnz;
 }
 
+/**
+ * Create a new BlockMatrix which shares the block structure and
+ * PETSc matrix of this matrix, but which appends all elements that
+ * are set in it to the given buffer rather than inserting them
+ * directly into the PETSc matrix. The buffered elements can later
+ * be inserted into this matrix using 'InsertBufferedElements()'.
+ *
+ * The returned object does not own the PETSc matrix and must be
+ * deleted by the caller (before this matrix is destroyed).
+ *
+ * buf: Buffer to store elements in.
+ */
+BlockMatrix *BlockMatrix::CreateBufferedView(vector<struct buffered_element> *buf) {
+    BlockMatrix *view = new BlockMatrix();
+
+    view->subeqs        = this->subeqs;
+    view->next_subindex = this->next_subindex;
+    view->m             = this->m;
+    view->n             = this->n;
+    view->petsc_mat     = this->petsc_mat;
+    view->allocated     = false;
+    view->elementBuffer = buf;
+
+    return view;
+}
+
 /**
  * Defines a new "sub-equation" to include in the matrix. The
  * sub-equation appears by getting its own (square) matrix block
@@ -87,7 +120,8 @@ len_t BlockMatrix::CreateSubEquation(const PetscInt n, const PetscInt nnz, const
  */
 void BlockMatrix::IMinusDtA(const PetscScalar dt) {
     Vec v;
-    VecCreateSeq(PETSC_COMM_WORLD, n, &v);
+    this->EndDirectAssembly();
+    MatCreateVecs(this->petsc_mat, &v, nullptr);
     
     const PetscInt offs = this->rowOffset;
     for (PetscInt i = 0; i < this->blockn; i++)
@@ -126,6 +160,79 @@ PetscInt BlockMatrix::GetOffsetById(const PetscInt subeqId) {
     );
 }
 
+/**
+ * Get the number of non-zero elements stored in each row of the
+ * (assembled) matrix. The pattern can be used to preallocate an
+ * identically structured matrix via 'ConstructSystem()'.
+ *
+ * nnzRow: Array to store the number of non-zeros of each row in
+ *         (must have as many elements as the matrix has rows).
+ */
+void BlockMatrix::GetNonZeroPattern(PetscInt *nnzRow) {
+    const PetscInt mSize = this->next_subindex;
+
+    this->EndDirectAssembly();
+
+    for (PetscInt row = 0; row < mSize; row++) {
+        PetscInt ncols;
+        MatGetRow(this->petsc_mat, row, &ncols, nullptr, nullptr);
+        nnzRow[row] = ncols;
+        MatRestoreRow(this->petsc_mat, row, &ncols, nullptr, nullptr);
+    }
+}
+
+/**
+ * Count the number of non-zero elements stored in each block of
+ * the matrix, and compare with the number of non-zeros preallocated
+ * for each block row (i.e. the estimate given to 'CreateSubEquation()').
+ * Rows containing more elements than were preallocated for them
+ * required PETSc to allocate more memory during assembly.
+ *
+ * RETURNS a list with one element per block row of the matrix.
+ */
+vector<struct BlockMatrix::block_sparsity> BlockMatrix::GetSparsity() {
+    const len_t nblocks = this->subeqs.size();
+    const PetscInt mSize = this->next_subindex;
+    vector<struct block_sparsity> stats(nblocks);
+
+    this->EndDirectAssembly();
+
+    for (len_t i = 0; i < nblocks; i++) {
+        const struct _subeq& s = this->subeqs[i];
+        // (the number of non-zeros per row is limited in 'ConstructSystem()')
+        const len_t snnz = (len_t)min(s.nnz, mSize);
+
+        stats[i].n            = s.n;
+        stats[i].nnzEstimated = s.n * snnz;
+        stats[i].nnzUsed      = 0;
+        stats[i].rowsExceeded = 0;
+        stats[i].nnzBlock.assign(nblocks, 0);
+
+        for (PetscInt row = s.offset; row < s.offset+s.n; row++) {
+            PetscInt ncols;
+            const PetscInt *cols;
+            MatGetRow(this->petsc_mat, row, &ncols, &cols, nullptr);
+
+            // Columns are sorted, so the block index only
+            // increases along the row
+            len_t j = 0;
+            for (PetscInt k = 0; k < ncols; k++) {
+                while (j+1 < nblocks && cols[k] >= this->subeqs[j+1].offset)
+                    j++;
+                stats[i].nnzBlock[j]++;
+            }
+
+            stats[i].nnzUsed += ncols;
+            if ((len_t)ncols > snnz)
+                stats[i].rowsExceeded++;
+
+            MatRestoreRow(this->petsc_mat, row, &ncols, &cols, nullptr);
+        }
+    }
+
+    return stats;
+}
+
 /**
  * Sets which sub-equation to write into.
  *
@@ -146,7 +253,8 @@ void BlockMatrix::SelectSubEquation(const PetscInt subeq1, const PetscInt subeq2
  */
 void BlockMatrix::ZeroEquation(const PetscInt subeq) {
     IS is;
-    ISCreateStride(PETSC_COMM_WORLD, this->subeqs.at(subeq).n, this->subeqs.at(subeq).offset, 1, &is);
+    this->EndDirectAssembly();
+    ISCreateStride(PETSC_COMM_SELF, this->subeqs.at(subeq).n, this->subeqs.at(subeq).offset, 1, &is);
 
     MatZeroRowsColumnsIS(this->petsc_mat, is, 0, nullptr, nullptr);
 
@@ -0,0 +1,54 @@
+/**
+ * Initialization of the device (GPU) execution space used by the
+ * kernels of 'FVM::Device'.
+ */
+
+#include "FVM/Device.hpp"
+
+using namespace DREAM::FVM;
+
+
+namespace {
+    // 'true' if Kokkos was initialized by 'Device::Initialize()' (and
+    // not by the program calling DREAM), in which case it should also
+    // be finalized by DREAM
+    bool ownsKokkos = false;
+}
+
+
+/**
+ * Initialize the device execution space. This must be called
+ * before PETSc is initialized.
+ *
+ * argc: Pointer to number of command-line arguments (may be 'nullptr').
+ * argv: Pointer to list of command-line arguments (may be 'nullptr').
+ */
+void Device::Initialize(int *argc, char **argv[]) {
+#ifdef DREAM_WITH_KOKKOS
+    if (Kokkos::is_initialized() || Kokkos::is_finalized())
+        return;
+
+    if (argc != nullptr && argv != nullptr)
+        Kokkos::initialize(*argc, *argv);
+    else
+        Kokkos::initialize();
+
+    ownsKokkos = true;
+#else
+    (void)argc;
+    (void)argv;
+#endif
+}
+
+/**
+ * Finalize the device execution space. This must be called
+ * after PETSc has been finalized.
+ */
+void Device::Finalize() {
+#ifdef DREAM_WITH_KOKKOS
+    if (ownsKokkos && Kokkos::is_initialized() && !Kokkos::is_finalized())
+        Kokkos::finalize();
+
+    ownsKokkos = false;
+#endif
+}
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include "FVM/Equation/AdvectionDiffusionTerm.hpp"
+#include "FVM/TermTimings.hpp"
 
 
 using namespace DREAM::FVM;
@@ -105,17 +106,62 @@ void AdvectionDiffusionTerm::Rebuild(const real_t t, const real_t dt, UnknownQua
 
     // Rebuild advection-diffusion coefficients
     for (auto it = advectionterms.begin(); it != advectionterms.end(); it++){
+        TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_REBUILD);
         (*it)->Rebuild(t, dt, uqty);
+        (*it)->SetRebuilt(t, dt);
     }
 
     for (auto it = diffusionterms.begin(); it != diffusionterms.end(); it++){
+        TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_REBUILD);
         (*it)->Rebuild(t, dt, uqty);
+        (*it)->SetRebuilt(t, dt);
     }
     
     this->AdvectionTerm::RebuildFluxLimiterDamping(t, dt);
     this->AdvectionTerm::RebuildInterpolationCoefficients(uqty, this->drr, this->d11, this->d22);
 }
 
+/**
+ * Returns 'true' if all advection and diffusion terms making up
+ * this term have declared the inputs they depend on.
+ */
+bool AdvectionDiffusionTerm::HasRebuildInputs() const {
+    for (auto it = advectionterms.begin(); it != advectionterms.end(); it++)
+        if (!(*it)->HasRebuildInputs())
+            return false;
+
+    for (auto it = diffusionterms.begin(); it != diffusionterms.end(); it++)
+        if (!(*it)->HasRebuildInputs())
+            return false;
+
+    return true;
+}
+
+/**
+ * Returns 'true' if this term must be rebuilt. Since the coefficients
+ * of all terms are accumulated into the same arrays, the rebuild can
+ * only be skipped if none of the terms need to be rebuilt. Flux
+ * limited interpolation coefficients depend on the solution and on
+ * the iteration, and so always require a rebuild.
+ */
+bool AdvectionDiffusionTerm::NeedsRebuild(
+    const real_t t, const real_t dt, UnknownQuantityHandler *uqty
+) const {
+    if (!this->HasRebuildInputs() || this->AdvectionTerm::IsRebuildPending() ||
+        this->AdvectionTerm::UsesFluxLimiter())
+        return true;
+
+    for (auto it = advectionterms.begin(); it != advectionterms.end(); it++)
+        if ((*it)->NeedsRebuild(t, dt, uqty))
+            return true;
+
+    for (auto it = diffusionterms.begin(); it != diffusionterms.end(); it++)
+        if ((*it)->NeedsRebuild(t, dt, uqty))
+            return true;
+
+    return false;
+}
+
 /**
  * Save the advection and diffusion coefficients of this
  * object to the specified file.
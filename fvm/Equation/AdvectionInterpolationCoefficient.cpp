@@ -2,7 +2,10 @@
  * Implementation of a class which evaluates, stores and provides
  * interpolation coefficients for advection terms.
  */
+#include "FVM/Device.hpp"
 #include "FVM/Equation/AdvectionInterpolationCoefficient.hpp"
+#include "FVM/MemoryAccounting.hpp"
+#include "FVM/Parallel.hpp"
 #include <algorithm>
 #include <limits>
 
@@ -28,12 +31,14 @@ AdvectionInterpolationCoefficient::AdvectionInterpolationCoefficient(Grid*g, flu
     for(len_t k=1; k<2*STENCIL_WIDTH;k++)
         delta_prev[k] = 0;
 
+    MemoryAccounting::Register(this, "equation/interpolation", [this]() { return this->GetMemoryUsage(); });
 }
 
 /**
  * Destructor.
  */
 AdvectionInterpolationCoefficient::~AdvectionInterpolationCoefficient(){
+    MemoryAccounting::Unregister(this);
     Deallocate();
     delete [] delta_prev;
     delete [] delta_tmp;
@@ -48,35 +53,51 @@ bool AdvectionInterpolationCoefficient::GridRebuilt(){
     this->nr = grid->GetNr() + (fgType==FLUXGRIDTYPE_RADIAL);
     n1 = new len_t[nr];
     n2 = new len_t[nr];
-    deltas = new real_t**[nr];
-    deltas_jac = new real_t**[nr];
+    cellOffset = new len_t[nr];
+    fOffset = new len_t[nr];
+
+    this->nCells = 0;
+    len_t nf = 0;
     for(len_t ir=0; ir<nr; ir++){
-        // XXX: If radial flux grid, assume same momentum grid at all radii
-        n1[ir] = grid->GetNp1(ir*(fgType!=FLUXGRIDTYPE_RADIAL)) + (fgType==FLUXGRIDTYPE_P1);
-        n2[ir] = grid->GetNp2(ir*(fgType!=FLUXGRIDTYPE_RADIAL)) + (fgType==FLUXGRIDTYPE_P2);
-        len_t N = n1[ir]*n2[ir];
-        deltas[ir] = new real_t*[N];
-        deltas_jac[ir] = new real_t*[N];
-        for(len_t i=0; i<N; i++){
-            deltas[ir][i] = new real_t[2*STENCIL_WIDTH];
-            deltas_jac[ir][i] = new real_t[2*STENCIL_WIDTH];
-        }
-        
+        n1[ir] = grid->GetNp1(ir, fgType);
+        n2[ir] = grid->GetNp2(ir, fgType);
+        cellOffset[ir] = this->nCells;
+        this->nCells += n1[ir]*n2[ir];
+
+        fOffset[ir] = nf;
+        nf += (n1[ir]-(fgType==FLUXGRIDTYPE_P1)) * (n2[ir]-(fgType==FLUXGRIDTYPE_P2));
     }
+
+    // The coefficients of all flux grid cells are stored in a single
+    // contiguous array (the stencil of each cell being stored contiguously,
+    // with cells ordered in the same way as the unknown quantity), with the
+    // jacobian coefficients following immediately after (the
+    // coefficients are used in kernels on the device, see
+    // 'AdvectionTerm::SetMatrixElementsDevice()')
+    const len_t nStencil = 2*STENCIL_WIDTH*nCells;
+    deltas = Device::Allocate<real_t>(2*nStencil);
+    deltas_jac = deltas + nStencil;
+
     ResetCoefficient();
     return true;
 }
 
+/**
+ * Returns the number of bytes used for storing the interpolation
+ * coefficients (and their jacobian counterparts).
+ */
+size_t AdvectionInterpolationCoefficient::GetMemoryUsage() const {
+    if (this->deltas == nullptr)
+        return 0;
+
+    return 2*(2*STENCIL_WIDTH*this->nCells)*sizeof(real_t) + 4*this->nr*sizeof(len_t);
+}
+
 /**
  * Sets interpolation coefficients to 0.
  */
 void AdvectionInterpolationCoefficient::ResetCoefficient(){
-    for(len_t ir=0; ir<nr; ir++)
-        for(len_t i=0; i<n1[ir]*n2[ir]; i++)
-            for(len_t k=0; k<2*STENCIL_WIDTH; k++){
-                deltas[ir][i][k] = 0;
-                deltas_jac[ir][i][k] = 0;
-            }
+    Parallel::FirstTouch(deltas, 2*(2*STENCIL_WIDTH*nCells));
     hasNonTrivialJacobian = false;
 }
 
@@ -92,7 +113,7 @@ void AdvectionInterpolationCoefficient::SetCoefficient(real_t **A, real_t **/*D*
     const real_t *x = nullptr, *x_f = nullptr;
     int_t N;
     real_t *f = IsFluxLimiterMethod(adv_i) ? unknowns->GetUnknownData(id_unknown)+offset : nullptr; 
-    YFunc_params yf_par = {f,n1,n2,0,0,0};
+    YFunc_params yf_par = {f,n1,n2,fOffset,grid,0,0,0};
     
     real_t(*YFunc)(int_t,void*);
     for(len_t ir=0; ir<nr; ir++){
@@ -115,159 +136,181 @@ void AdvectionInterpolationCoefficient::SetCoefficient(real_t **A, real_t **/*D*
             default:
                 throw FVMException("AdvectionInterpolationCoefficient: Invalid flux grid type specified.");
         }
-        
-        for(len_t i=0; i<n1[ir]; i++)
-            for(len_t j=0; j<n2[ir]; j++){
-                for(len_t k=0; k<2*STENCIL_WIDTH; k++)
-                    delta_tmp[k] = 0;
 
-                len_t pind = j*n1[ir]+i;
+        // (the number of grid points along the interpolation
+        // direction is the same for all cells at this radius)
+        GetIndex(ir,0,0,&N);
+
+        adv_interpolation method = adv_i;
+        // When 1 or 2 grid points are used, use central difference scheme
+        if(N<3)
+            method = AD_INTERP_CENTRED;
+        // on the initial rebuild, if using flux limiters, use a robust method 
+        // to obtain a good starting point to iterate the flux limiter from
+        else if(isFirstRebuild && IsFluxLimiterMethod(adv_i))
+            method = AD_INTERP_UPWIND;
+
+        // Select the specialized kernel once for all
+        // cells at this radius
+        #define SET_COEFF(M) \
+            case M: SetCoefficientsAtRadius<M>(ir, A, x, x_f, YFunc, yf_par, damping_factor); break;
+        switch(method){
+            SET_COEFF(AD_INTERP_CENTRED)
+            SET_COEFF(AD_INTERP_UPWIND)
+            SET_COEFF(AD_INTERP_UPWIND_2ND_ORDER)
+            SET_COEFF(AD_INTERP_DOWNWIND)
+            SET_COEFF(AD_INTERP_QUICK)
+            SET_COEFF(AD_INTERP_SMART)
+            SET_COEFF(AD_INTERP_MUSCL)
+            SET_COEFF(AD_INTERP_OSPRE)
+            SET_COEFF(AD_INTERP_TCDF)
+            default:
+                throw FVMException("Invalid interpolation method: not yet supported.");
+        }
+        #undef SET_COEFF
+    }
+    ApplyBoundaryCondition();
+    isFirstRebuild = false;
+}
 
-                bool isFlowPositive = (A[ir][pind]>0);
+/**
+ * Set the interpolation coefficients of all cells at the given
+ * radius using the interpolation method 'method'. The method is a
+ * template parameter so that each scheme is compiled into its own
+ * branch-free loop over the cells.
+ *
+ * ir:             Radial index of flux grid cells to set coefficients for.
+ * A:              Advection coefficient.
+ * x:              Grid points along the interpolation direction.
+ * x_f:            Flux grid points along the interpolation direction.
+ * YFunc:          Function returning the unknown quantity (flux limiters only).
+ * yf_par:         Parameters to pass to 'YFunc'.
+ * damping_factor: Damping applied to the GPLK flux limiter schemes.
+ */
+template<AdvectionInterpolationCoefficient::adv_interpolation method>
+void AdvectionInterpolationCoefficient::SetCoefficientsAtRadius(
+    const len_t ir, real_t **A, const real_t *x, const real_t *x_f,
+    real_t(*YFunc)(int_t,void*), YFunc_params &yf_par, const real_t damping_factor
+) {
+    int_t N;
+    for(len_t i=0; i<n1[ir]; i++)
+        for(len_t j=0; j<n2[ir]; j++){
+            len_t pind = j*n1[ir]+i;
+            real_t *delta = GetDelta(ir, pind);
+            real_t *delta_jac = GetDeltaJacobian(ir, pind);
+
+            bool isFlowPositive = (A[ir][pind]>0);
+            
+            // sign of A: +1 for A>0 and -1 for A<=0 
+            int_t sgn = isFlowPositive - !isFlowPositive;
+            shiftU1 = -(1+sgn)/2;   // 0.5 step upstream
+            shiftU2 = -(1+3*sgn)/2; // 1.5 steps upstream
+            shiftD1 = (-1+sgn)/2;   // 0.5 step downstream
+            
+            int_t ind = GetIndex(ir,i,j,&N);
+            xf  = x_f[ind];
+            x_0 = x_f[0];
+            xN  = x_f[N];
+
+            yf_par.ir = ir;
+            yf_par.i = i;
+            yf_par.j = j;
+            real_t alpha;
+            if constexpr (method == AD_INTERP_CENTRED) {
+                alpha = 0.0;
+                SetFirstOrderCoefficient(ind,N,x,alpha,delta);
+            } else if constexpr (method == AD_INTERP_UPWIND) {
+                alpha = 0.5;
+                SetFirstOrderCoefficient(ind,N,x,alpha,delta);
+            } else if constexpr (method == AD_INTERP_UPWIND_2ND_ORDER) {
+                // 2nd order upwind
+                alpha = -(1.0/8.0)*(GetXi(x,ind+shiftU2,N) - xf)/(GetXi(x,ind+shiftD1,N) - xf);
+                SetSecondOrderCoefficient(ind,N,x,alpha,delta);
+            } else if constexpr (method == AD_INTERP_DOWNWIND) {
+                alpha = 0.5*(GetXi(x,ind+shiftD1,N) - xf)/(GetXi(x,ind+shiftU1,N) - xf);
+                SetFirstOrderCoefficient(ind,N,x,alpha,delta);
+            } else if constexpr (method == AD_INTERP_QUICK) {
+                alpha = 0.0;
+                SetSecondOrderCoefficient(ind,N,x,alpha,delta);
+            } else if constexpr (method == AD_INTERP_SMART) {
+                // Sets interpolation coefficients using the flux limited
+                // SMART method
+
+                real_t r = GetFluxLimiterR(ind,N,YFunc,&yf_par,x);
                 
-                // sign of A: +1 for A>0 and -1 for A<=0 
-                int_t sgn = isFlowPositive - !isFlowPositive;
-                shiftU1 = -(1+sgn)/2;   // 0.5 step upstream
-                shiftU2 = -(1+3*sgn)/2; // 1.5 steps upstream
-                shiftD1 = (-1+sgn)/2;   // 0.5 step downstream
+                real_t kappa = 0.5;
+                real_t M = 4;
+                alpha = 0;
+                SetGPLKScheme(ind, N, x, r, alpha, kappa, M, damping_factor, delta);
+            } else if constexpr (method == AD_INTERP_MUSCL) {
+                // Sets interpolation coefficients using the flux limited
+                // MUSCL method
+
+                real_t r = GetFluxLimiterR(ind,N,YFunc,&yf_par,x);
                 
-                int_t ind = GetIndex(ir,i,j,&N);
-                xf  = x_f[ind];
-                x_0 = x_f[0];
-                xN  = x_f[N];
-
-                adv_interpolation method = adv_i;
-                // When 1 or 2 grid points are used, use central difference scheme
-                if(N<3)
-                    method = AD_INTERP_CENTRED;
-                // on the initial rebuild, if using flux limiters, use a robust method 
-                // to obtain a good starting point to iterate the flux limiter from
-                else if(isFirstRebuild && IsFluxLimiterMethod(adv_i))
-                    method = AD_INTERP_UPWIND;
-
-                yf_par.ir = ir;
-                yf_par.i = i;
-                yf_par.j = j;
-                real_t alpha;
-                switch(method){
-                    case AD_INTERP_CENTRED: {
-                        alpha = 0.0;
-                        SetFirstOrderCoefficient(ind,N,x,alpha,deltas[ir][pind]);
-                        break;
-                    } case AD_INTERP_UPWIND: {
-                        alpha = 0.5;
-                        SetFirstOrderCoefficient(ind,N,x,alpha,deltas[ir][pind]);
-                        break;
-                    } case AD_INTERP_UPWIND_2ND_ORDER: {
-                        // 2nd order upwind
-                        alpha = -(1.0/8.0)*(GetXi(x,ind+shiftU2,N) - xf)/(GetXi(x,ind+shiftD1,N) - xf);
-                        SetSecondOrderCoefficient(ind,N,x,alpha,deltas[ir][pind]);
-                        break;
-                    } case AD_INTERP_DOWNWIND: {
-                        alpha = 0.5*(GetXi(x,ind+shiftD1,N) - xf)/(GetXi(x,ind+shiftU1,N) - xf);
-                        SetFirstOrderCoefficient(ind,N,x,alpha,deltas[ir][pind]);
-                        break;
-                    } case AD_INTERP_QUICK: {
-                        alpha = 0.0;
-                        SetSecondOrderCoefficient(ind,N,x,alpha,deltas[ir][pind]);
-                        break;
-                    } case AD_INTERP_SMART: {
-                        // Sets interpolation coefficients using the flux limited
-                        // SMART method
-
-                        real_t r = GetFluxLimiterR(ind,N,YFunc,&yf_par,x);
-                        
-                        real_t kappa = 0.5;
-                        real_t M = 4;
-                        alpha = 0;
-                        SetGPLKScheme(ind, N, x, r, alpha, kappa, M, damping_factor, deltas[ir][pind]);
-
-                        break;
-                    } case AD_INTERP_MUSCL: {
-                        // Sets interpolation coefficients using the flux limited
-                        // MUSCL method
-
-                        real_t r = GetFluxLimiterR(ind,N,YFunc,&yf_par,x);
-                        
-                        real_t kappa = 0;
-                        real_t M = 2;
-                        alpha = 0;
-                        SetGPLKScheme(ind, N, x, r, alpha, kappa, M, damping_factor, deltas[ir][pind]);
-
-                        break;
-                    } case AD_INTERP_OSPRE: {
-                        // Sets interpolation coefficients using the continuous
-                        // flux limited OSPRE method
-
-                        real_t r = GetFluxLimiterR(ind,N,YFunc,&yf_par,x);
-                        real_t psi = 1.5*r*(r+1)/(r*r+r+1);
-                        real_t psiPrime = 1.5*(1+2*r)/((r*r+r+1)*(r*r+r+1));
-//                        real_t a = psi - r*psiPrime;
-//                        real_t b = psiPrime;
-//                        SetLinearFluxLimitedCoefficient(ind,N,x,a,b,deltas[ir][pind]);
-                        SetFluxLimitedCoefficient(ind,N,x,psi,deltas[ir][pind]);
-                        SetFluxLimitedCoefficient(ind,N,x,psi,delta_tmp,r,psiPrime);
-
-                        break;
-                    } case AD_INTERP_TCDF: {
-                        // Sets interpolation coefficients using the continuous
-                        // flux limited TCDF method, described in
-                        //      D Zhang et al., J Comp Phys 302, 114 (2015).
-                        // The flux limiter is defined piecewise but is C1 in order
-                        // to ensure good convergence properties. Has a large overlap 
-                        // with QUICK (in the interval 0.5 < r < 2.0)
-
-                        real_t r = GetFluxLimiterR(ind,N,YFunc,&yf_par,x);
-                        real_t psi, psiPrime;
-                        if(r<0){
-                            psi = r*(1+r)/(1+r*r);
-                            psiPrime = (1+2*r-r*r)/((1+r*r)*(1+r*r));
-                        } else if(r<0.5){
-                            psi = r*r*r - 2*r*r +2*r;
-                            psiPrime = 3*r*r - 4*r + 2;
-                        } else if(r<2){
-                            psi = 0.25 + 0.75*r;
-                            psiPrime = 0.75;
-                        } else {
-                            psi = (2*r*r - 2*r - 2.25) / (r*r - r -1);
-                            psiPrime = 0.25*(2*r-1) / ((r*r - r -1)*(r*r - r -1)); 
-                        }
-                        SetFluxLimitedCoefficient(ind,N,x,psi,deltas[ir][pind]);
-                        SetFluxLimitedCoefficient(ind,N,x,psi,delta_tmp,r,psiPrime);
-/*
-                        real_t a = psi - r*psiPrime;
-                        real_t b = psiPrime;
-                        SetLinearFluxLimitedCoefficient(ind,N,x,a,b,deltas[ir][pind]);
-*/
-                        break;
-                    } default: {
-                        throw FVMException("Invalid interpolation method: not yet supported.");
-                        break;
-                    }
-                }
+                real_t kappa = 0;
+                real_t M = 2;
+                alpha = 0;
+                SetGPLKScheme(ind, N, x, r, alpha, kappa, M, damping_factor, delta);
+            } else if constexpr (method == AD_INTERP_OSPRE) {
+                // Sets interpolation coefficients using the continuous
+                // flux limited OSPRE method
+                for(len_t k=0; k<2*STENCIL_WIDTH; k++)
+                    delta_tmp[k] = 0;
+
+                real_t r = GetFluxLimiterR(ind,N,YFunc,&yf_par,x);
+                real_t psi = 1.5*r*(r+1)/(r*r+r+1);
+                real_t psiPrime = 1.5*(1+2*r)/((r*r+r+1)*(r*r+r+1));
+                SetFluxLimitedCoefficient(ind,N,x,psi,delta);
+                SetFluxLimitedCoefficient(ind,N,x,psi,delta_tmp,r,psiPrime);
+            } else if constexpr (method == AD_INTERP_TCDF) {
+                // Sets interpolation coefficients using the continuous
+                // flux limited TCDF method, described in
+                //      D Zhang et al., J Comp Phys 302, 114 (2015).
+                // The flux limiter is defined piecewise but is C1 in order
+                // to ensure good convergence properties. Has a large overlap 
+                // with QUICK (in the interval 0.5 < r < 2.0)
+                for(len_t k=0; k<2*STENCIL_WIDTH; k++)
+                    delta_tmp[k] = 0;
 
-                if(jac_mode == OptionConstants::AD_INTERP_JACOBIAN_UPWIND) // Sets delta_jac to UPWIND interpolation
-                    SetFirstOrderCoefficient(ind,N,x,0.5,deltas_jac[ir][pind]); 
-                else if(jac_mode == OptionConstants::AD_INTERP_JACOBIAN_LINEAR || !IsSmoothFluxLimiter(method))
-                    for(len_t k=0;k<2*STENCIL_WIDTH; k++) // ignores f jacobian wrt delta (when available, for continuous limiters)
-                        deltas_jac[ir][pind][k] = deltas[ir][pind][k];
-                else // jac_mode = AD_INTERP_JACOBIAN_FULL, and smooth limiter
-                    for(len_t k=0;k<2*STENCIL_WIDTH; k++)
-                        deltas_jac[ir][pind][k] = delta_tmp[k];
-
-                // set nearly zero interpolation coefficients to identically zero to reduce nnz
-                real_t eps = std::numeric_limits<real_t>::epsilon();
-                real_t threshold_eps = 1e6;
-                for(len_t k=0; k<2*STENCIL_WIDTH; k++){
-                    if(fabs(deltas[ir][pind][k]) < eps*threshold_eps)
-                        deltas[ir][pind][k] = 0.0;
-                    if(fabs(deltas_jac[ir][pind][k]) < eps*threshold_eps)
-                        deltas_jac[ir][pind][k] = 0.0;
+                real_t r = GetFluxLimiterR(ind,N,YFunc,&yf_par,x);
+                real_t psi, psiPrime;
+                if(r<0){
+                    psi = r*(1+r)/(1+r*r);
+                    psiPrime = (1+2*r-r*r)/((1+r*r)*(1+r*r));
+                } else if(r<0.5){
+                    psi = r*r*r - 2*r*r +2*r;
+                    psiPrime = 3*r*r - 4*r + 2;
+                } else if(r<2){
+                    psi = 0.25 + 0.75*r;
+                    psiPrime = 0.75;
+                } else {
+                    psi = (2*r*r - 2*r - 2.25) / (r*r - r -1);
+                    psiPrime = 0.25*(2*r-1) / ((r*r - r -1)*(r*r - r -1)); 
                 }
+                SetFluxLimitedCoefficient(ind,N,x,psi,delta);
+                SetFluxLimitedCoefficient(ind,N,x,psi,delta_tmp,r,psiPrime);
             }
-    }
-    ApplyBoundaryCondition();
-    isFirstRebuild = false;
+
+            if(jac_mode == OptionConstants::AD_INTERP_JACOBIAN_UPWIND) // Sets delta_jac to UPWIND interpolation
+                SetFirstOrderCoefficient(ind,N,x,0.5,delta_jac); 
+            else if(jac_mode == OptionConstants::AD_INTERP_JACOBIAN_LINEAR || !IsSmoothFluxLimiter(method))
+                for(len_t k=0;k<2*STENCIL_WIDTH; k++) // ignores f jacobian wrt delta (when available, for continuous limiters)
+                    delta_jac[k] = delta[k];
+            else // jac_mode = AD_INTERP_JACOBIAN_FULL, and smooth limiter
+                for(len_t k=0;k<2*STENCIL_WIDTH; k++)
+                    delta_jac[k] = delta_tmp[k];
+
+            // set nearly zero interpolation coefficients to identically zero to reduce nnz
+            const real_t eps = std::numeric_limits<real_t>::epsilon();
+            const real_t threshold_eps = 1e6;
+            for(len_t k=0; k<2*STENCIL_WIDTH; k++){
+                if(fabs(delta[k]) < eps*threshold_eps)
+                    delta[k] = 0.0;
+                if(fabs(delta_jac[k]) < eps*threshold_eps)
+                    delta_jac[k] = 0.0;
+            }
+        }
 }
 
 /**
@@ -405,35 +448,37 @@ void AdvectionInterpolationCoefficient::SetLinearFluxLimitedCoefficient(int_t in
  */
 void AdvectionInterpolationCoefficient::ApplyBoundaryCondition(){
     for(len_t ir=0; ir<nr; ir++)
-        for(len_t i=0; i<n1[ir]; i++)
-            for(len_t j=0; j<n2[ir]; j++){
+        for(len_t j=0; j<n2[ir]; j++)
+            for(len_t i=0; i<n1[ir]; i++){
                 int_t N;
                 int_t ind = GetIndex(ir,i,j,&N);
                 len_t pind = j*n1[ir]+i;
+                real_t *delta = GetDelta(ir, pind);
+                real_t *delta_jac = GetDeltaJacobian(ir, pind);
                 len_t k_max = 2*STENCIL_WIDTH-1;
                 if(bc_lower == AD_BC_MIRRORED)
                     for(len_t k=0; k+ind<STENCIL_WIDTH; k++){
-                        deltas[ir][pind][k_max-2*ind-k] += deltas[ir][pind][k];
-                        deltas[ir][pind][k] = 0;
-                        deltas_jac[ir][pind][k_max-2*ind-k] += deltas_jac[ir][pind][k];
-                        deltas_jac[ir][pind][k] = 0;
+                        delta[k_max-2*ind-k] += delta[k];
+                        delta[k] = 0;
+                        delta_jac[k_max-2*ind-k] += delta_jac[k];
+                        delta_jac[k] = 0;
                     }
                 else if(bc_lower == AD_BC_DIRICHLET && ind == 0)
                     for(len_t k=0; k<2*STENCIL_WIDTH; k++){
-                        deltas[ir][pind][k] = 0;
-                        deltas_jac[ir][pind][k] = 0;
+                        delta[k] = 0;
+                        delta_jac[k] = 0;
                     }
                 if(bc_upper == AD_BC_MIRRORED)
                     for(len_t k=N+STENCIL_WIDTH-ind; k<=k_max; k++){
-                        deltas[ir][pind][k_max+2*(N-ind)-k] += deltas[ir][pind][k];
-                        deltas[ir][pind][k] = 0;
-                        deltas_jac[ir][pind][k_max+2*(N-ind)-k] += deltas_jac[ir][pind][k];
-                        deltas_jac[ir][pind][k] = 0;
+                        delta[k_max+2*(N-ind)-k] += delta[k];
+                        delta[k] = 0;
+                        delta_jac[k_max+2*(N-ind)-k] += delta_jac[k];
+                        delta_jac[k] = 0;
                     }
                 else if(bc_upper == AD_BC_DIRICHLET && ind==N)
                     for(len_t k=0; k<2*STENCIL_WIDTH; k++){
-                        deltas[ir][pind][k] = 0;
-                        deltas_jac[ir][pind][k] = 0;
+                        delta[k] = 0;
+                        delta_jac[k] = 0;
                     }
             }
 }
@@ -483,26 +528,15 @@ void AdvectionInterpolationCoefficient::SetNNZ(adv_interpolation adv_i){
  * Deallocator
  */
 void AdvectionInterpolationCoefficient::Deallocate(){
-    if(deltas != nullptr){
-        for(len_t ir=0; ir<nr; ir++){
-            for(len_t i=0; i<n1[ir]*n2[ir]; i++)
-                delete [] deltas[ir][i];
-            delete [] deltas[ir];
-        }
-        delete [] deltas;
-    }
-    if(deltas_jac != nullptr){
-        for(len_t ir=0; ir<nr; ir++){
-            for(len_t i=0; i<n1[ir]*n2[ir]; i++)
-                delete [] deltas_jac[ir][i];
-            delete [] deltas_jac[ir];
-        }
-        delete [] deltas_jac;
-    }
+    // 'deltas_jac' points into the same array as 'deltas'
+    Device::Free(deltas);
+    deltas = deltas_jac = nullptr;
 
     if(n1!=nullptr){
         delete [] n1;
         delete [] n2;
+        delete [] cellOffset;
+        delete [] fOffset;
     }
 
 }
@@ -2,6 +2,8 @@
  * Implementation of a general advection term.
  */
 
+#include <algorithm>
+#include "FVM/Device.hpp"
 #include "FVM/Equation/AdvectionTerm.hpp"
 #include "FVM/Grid/Grid.hpp"
 
@@ -78,10 +80,12 @@ void AdvectionTerm::AllocateCoefficients() {
         nElements_f1pSq += n2[i];
     }
 
-    this->fr[0] = new real_t[nElements_fr];
-    this->f1[0] = new real_t[nElements_f1];
-    this->f2[0] = new real_t[nElements_f2];
-    this->f1pSqAtZero[0] = new real_t[nElements_f1pSq];
+    // (the coefficients are used in kernels on the
+    // device, see 'SetMatrixElementsDevice()')
+    this->fr[0] = Device::Allocate<real_t>(nElements_fr);
+    this->f1[0] = Device::Allocate<real_t>(nElements_f1);
+    this->f2[0] = Device::Allocate<real_t>(nElements_f2);
+    this->f1pSqAtZero[0] = Device::Allocate<real_t>(nElements_f1pSq);
 
     for (len_t i = 1; i < nr; i++) {
         this->fr[i] = this->fr[i-1] + (n1[i-1]*n2[i-1]);
@@ -90,9 +94,8 @@ void AdvectionTerm::AllocateCoefficients() {
         this->f1pSqAtZero[i] = this->f1pSqAtZero[i-1] + n2[i-1];
     }
 
-    // XXX: Here we assume that the momentum grid is the same
-    // at all radial grid points, so that n1_{nr+1/2} = n1_{nr-1/2}
-    // (and the same for n2)
+    // (the outermost radial flux grid point uses the momentum
+    // grid of the last cell, so that n1_{nr+1/2} = n1_{nr-1/2})
     this->fr[nr]  = this->fr[nr-1]  + n1[nr-1]*n2[nr-1];
 
     this->ResetCoefficients();
@@ -109,15 +112,28 @@ void AdvectionTerm::AllocateCoefficients() {
     }
 
     this->coefficientsShared = false;
+    this->deviceStencilValid = false;
 }
 
 /**
- * Allocate differentiation coefficients.
+ * Allocate differentiation coefficients. Terms which do not
+ * depend on any other unknown quantity have no differentiation
+ * coefficients, and no memory is allocated for them.
  */
 void AdvectionTerm::AllocateDifferentiationCoefficients() {
+    AllocateDifferentiationCoefficients(GetMaxNumberOfMultiplesJacobian());
+}
+
+/**
+ * Allocate differentiation coefficients for the given
+ * number of multiples.
+ */
+void AdvectionTerm::AllocateDifferentiationCoefficients(const len_t nMultiples) {
     DeallocateDifferentiationCoefficients();
-    len_t nMultiples = GetMaxNumberOfMultiplesJacobian();
+    if (nMultiples == 0)
+        return;
 
+    this->nDiffMultiples = nMultiples;
     this->dfr = new real_t*[(nr+1)*nMultiples];
     this->df1 = new real_t*[nr*nMultiples];
     this->df2 = new real_t*[nr*nMultiples];
@@ -152,9 +168,8 @@ void AdvectionTerm::AllocateDifferentiationCoefficients() {
             this->df1pSqAtZero[ir+n*nr] = this->df1pSqAtZero[ir-1+n*nr] + n2[ir-1];
         }
 
-        // XXX: Here we assume that the momentum grid is the same
-        // at all radial grid points, so that n1_{nr+1/2} = n1_{nr-1/2}
-        // (and the same for n2)
+        // (the outermost radial flux grid point uses the momentum
+        // grid of the last cell, so that n1_{nr+1/2} = n1_{nr-1/2})
         this->dfr[nr+n*(nr+1)] = this->dfr[nr-1+n*(nr+1)] + n1[nr-1]*n2[nr-1];
     }
 
@@ -166,19 +181,19 @@ void AdvectionTerm::AllocateDifferentiationCoefficients() {
  */
 void AdvectionTerm::DeallocateCoefficients() {
     if (f2 != nullptr) {
-        delete [] f2[0];
+        Device::Free(f2[0]);
         delete [] f2;
     }
     if (f1 != nullptr) {
-        delete [] f1[0];
+        Device::Free(f1[0]);
         delete [] f1;
     }
     if (fr != nullptr) {
-        delete [] fr[0];
+        Device::Free(fr[0]);
         delete [] fr;
     }
     if (f1pSqAtZero != nullptr) {
-        delete [] f1pSqAtZero[0];
+        Device::Free(f1pSqAtZero[0]);
         delete [] f1pSqAtZero;
     }
     
@@ -204,9 +219,17 @@ void AdvectionTerm::DeallocateDifferentiationCoefficients() {
         delete [] dfr[0];
         delete [] dfr;
     }
+    if (df1pSqAtZero != nullptr) {
+        delete [] df1pSqAtZero[0];
+        delete [] df1pSqAtZero;
+    }
     if (JacobianColumn != nullptr){
         delete [] JacobianColumn;
     }
+
+    this->dfr = this->df1 = this->df2 = this->df1pSqAtZero = nullptr;
+    this->JacobianColumn = nullptr;
+    this->nDiffMultiples = 0;
 }
 
 /**
@@ -231,6 +254,7 @@ void AdvectionTerm::SetCoefficients(
     this->deltaRadialFlux = delta;
 
     this->coefficientsShared = true;
+    this->deviceStencilValid = false;
 }
 
 /**
@@ -248,6 +272,7 @@ void AdvectionTerm::SetInterpolationCoefficients(
     this->delta2 = d2;
 
     this->interpolationCoefficientsShared = true;
+    this->deviceStencilValid = false;
 }
 
 /**
@@ -298,6 +323,8 @@ bool AdvectionTerm::GridRebuilt() {
 
     // TODO: find condition for when to allocate these
     AllocateDifferentiationCoefficients();
+
+    this->deviceStencilValid = false;
     
     return rebuilt;
 }
@@ -353,9 +380,8 @@ void AdvectionTerm::ResetCoefficients() {
         nr = this->grid->GetNr();
 
     for (len_t ir = 0; ir < nr+1; ir++) {
-        // XXX here we assume that all momentum grids are the same
-        const len_t np2 = this->grid->GetMomentumGrid(0)->GetNp2();
-        const len_t np1 = this->grid->GetMomentumGrid(0)->GetNp1();
+        const len_t np2 = this->grid->GetNp2_fr(ir);
+        const len_t np1 = this->grid->GetNp1_fr(ir);
 
         for (len_t j = 0; j < np2; j++)
             for (len_t i = 0; i < np1; i++)
@@ -387,16 +413,15 @@ void AdvectionTerm::ResetCoefficients() {
  * Set all differentiation coefficients to zero.
  */
 void AdvectionTerm::ResetDifferentiationCoefficients() {
-    len_t nMultiples = GetMaxNumberOfMultiplesJacobian();
+    const len_t nMultiples = this->nDiffMultiples;
 
     const len_t
         nr = this->grid->GetNr();
 
     for(len_t n=0; n<nMultiples; n++){
         for (len_t ir = 0; ir < nr+1; ir++) {
-            // XXX here we assume that all momentum grids are the same
-            const len_t np2 = this->grid->GetMomentumGrid(0)->GetNp2();
-            const len_t np1 = this->grid->GetMomentumGrid(0)->GetNp1();
+            const len_t np2 = this->grid->GetNp2_fr(ir);
+            const len_t np1 = this->grid->GetNp1_fr(ir);
 
             for (len_t j = 0; j < np2; j++)
                 for (len_t i = 0; i < np1; i++)
@@ -444,26 +469,107 @@ bool AdvectionTerm::SetJacobianBlock(
     * to this advection coefficient 
     */
     len_t nMultiples;
-    if(!HasJacobianContribution(derivId, &nMultiples))
+    if(!SetDifferentiationCoefficients(derivId, &nMultiples))
         return contributes;
     else
         contributes = true;
-    
+
+    SetJacobianContributions(nMultiples, jac, x);
+
+    return contributes;
+}
+
+/**
+ * Evaluate the differentiation coefficients of this term with
+ * respect to the unknown 'derivId'.
+ *
+ * derivId:    ID of the quantity with respect to which the
+ *             derivative is to be evaluated.
+ * nMultiples: On return, contains the number of multiples of
+ *             the unknown 'derivId'.
+ *
+ * RETURNS false if this term does not depend on 'derivId'.
+ */
+bool AdvectionTerm::SetDifferentiationCoefficients(const len_t derivId, len_t *nMultiples) {
+    if (!HasJacobianContribution(derivId, nMultiples))
+        return false;
+
+    interp_mode = AdvectionInterpolationCoefficient::AD_INTERP_MODE_JACOBIAN;
 
     // TODO: allocate differentiation coefficients in a more logical location
-    if(df1 == nullptr)
+    if (this->nDiffMultiples < *nMultiples)
         AllocateDifferentiationCoefficients();
 
     // Set partial advection coefficients for this advection term 
-    SetPartialAdvectionTerm(derivId, nMultiples);
+    SetPartialAdvectionTerm(derivId, *nMultiples);
+
+    return true;
+}
+
+/**
+ * Sum the differentiation coefficients of the given terms, and
+ * store the result in the differentiation coefficients of this
+ * term. This allows the jacobian contributions of several terms
+ * depending on the same unknown to be set in a single pass.
+ *
+ * terms: List of terms, and the number of multiples of the unknown
+ *        for which their differentiation coefficients have been set.
+ */
+void AdvectionTerm::SumDifferentiationCoefficients(
+    const std::vector<std::pair<AdvectionTerm*, len_t>>& terms
+) {
+    len_t nMultiples = 0;
+    for (auto &t : terms)
+        nMultiples = std::max(nMultiples, t.second);
+
+    if (this->nDiffMultiples < nMultiples)
+        AllocateDifferentiationCoefficients(nMultiples);
+    else
+        ResetDifferentiationCoefficients();
+
+    len_t
+        nElements_fr = n1[nr-1]*n2[nr-1],
+        nElements_f1 = 0,
+        nElements_f2 = 0,
+        nElements_f1pSq = 0;
 
+    for (len_t i = 0; i < nr; i++) {
+        nElements_fr += n1[i]*n2[i];
+        nElements_f1 += (n1[i]+1)*n2[i];
+        nElements_f2 += n1[i]*(n2[i]+1);
+        nElements_f1pSq += n2[i];
+    }
+
+    for (auto &t : terms) {
+        const AdvectionTerm *at = t.first;
+        for (len_t n = 0; n < t.second; n++) {
+            for (len_t i = 0; i < nElements_fr; i++)
+                this->dfr[n*(nr+1)][i] += at->dfr[n*(nr+1)][i];
+            for (len_t i = 0; i < nElements_f1; i++)
+                this->df1[n*nr][i] += at->df1[n*nr][i];
+            for (len_t i = 0; i < nElements_f2; i++)
+                this->df2[n*nr][i] += at->df2[n*nr][i];
+            for (len_t i = 0; i < nElements_f1pSq; i++)
+                this->df1pSqAtZero[n*nr][i] += at->df1pSqAtZero[n*nr][i];
+        }
+    }
+}
+
+/**
+ * Set the jacobian contributions corresponding to the current
+ * differentiation coefficients of this term.
+ *
+ * nMultiples: Number of multiples of the unknown with respect to
+ *             which the differentiation coefficients were evaluated.
+ * jac:        Jacobian matrix block to populate.
+ * x:          Value of the unknown quantity.
+ */
+void AdvectionTerm::SetJacobianContributions(const len_t nMultiples, Matrix *jac, const real_t *x) {
     for(len_t n=0; n<nMultiples; n++){
         SetPartialJacobianContribution(0, JACOBIAN_SET_CENTER, n, jac, x);
         SetPartialJacobianContribution(-1,JACOBIAN_SET_LOWER, n, jac, x);
         SetPartialJacobianContribution(+1,JACOBIAN_SET_UPPER, n, jac, x);
     }
-
-    return contributes;
 }
 
 
@@ -507,13 +613,156 @@ void AdvectionTerm::ResetJacobianColumn(){
  * rhs: Right-hand-side of equation (not used).
  */
 void AdvectionTerm::SetMatrixElements(Matrix *mat, real_t*) {
+    if (this->SetMatrixElementsDevice(mat))
+        return;
+
     jacobian_interp_mode set = NO_JACOBIAN;
-    #define f(K,I,J,V) mat->SetElement(offset+j*np1+i, offset + ((K)-ir)*np2*np1 + (J)*np1 + (I), (V))
+    #define f(K,I,J,V) mat->SetElement(offset+j*np1+i, grid->GetCellOffset(K) + (J)*n1[K] + (I), (V))
+    #define BeginRow()
+    #define EndRow()
     #   include "AdvectionTerm.set.cpp"
+    #undef EndRow
+    #undef BeginRow
     #undef f
 }
 
 
+/**
+ * Construct the stencil of this term applied on the device (see
+ * 'DeviceStencil'). This reproduces the matrix elements set by
+ * 'AdvectionTerm.set.cpp' (without jacobian contributions), for grids
+ * with the same momentum grid at all radii and without mirrored
+ * trapped regions.
+ *
+ * RETURNS false if the stencil can not be applied on the device.
+ */
+bool AdvectionTerm::BuildDeviceStencil() {
+    enum { C_FR, C_F1, C_F2, C_F1PSQ };
+    enum { D_R, D_1, D_2 };
+
+    this->deviceStencil.Clear();
+    if (!grid->HasRadiallyUniformMomentumGrid())
+        return false;
+
+    const len_t nr = grid->GetNr();
+    for (len_t ir = 0; ir < nr; ir++)
+        for (len_t j = 0; j < grid->GetMomentumGrid(ir)->GetNp2(); j++)
+            if (grid->IsNegativePitchTrappedIgnorableCell(ir,j) ||
+                grid->IsNegativePitchTrappedIgnorableRadialFluxCell(ir,j))
+                return false;
+
+    const real_t *dr = grid->GetRadialGrid()->GetDr();
+    DeviceStencil &s = this->deviceStencil;
+
+    len_t offset = 0;
+    for (len_t ir = 0; ir < nr; ir++) {
+        const MomentumGrid *mg = grid->GetMomentumGrid(ir);
+        const len_t np1 = mg->GetNp1(), np2 = mg->GetNp2();
+        const real_t
+            *Vp     = grid->GetVp(ir),
+            *Vp_fr  = grid->GetVp_fr(ir),
+            *Vp_fr1 = grid->GetVp_fr(ir+1),
+            *Vp_f1  = grid->GetVp_f1(ir),
+            *Vp_f2  = grid->GetVp_f2(ir),
+            *VpOverP2AtZero = grid->GetVpOverP2AtZero(ir),
+            *dp1    = mg->GetDp1(),
+            *dp2    = mg->GetDp2();
+
+        const len_t
+            ofr  = fr[ir] - fr[0],
+            ofr1 = fr[ir+1] - fr[0],
+            of1  = f1[ir] - f1[0],
+            of2  = f2[ir] - f2[0],
+            of1p = f1pSqAtZero[ir] - f1pSqAtZero[0];
+
+        for (len_t j = 0; j < np2; j++) {
+            for (len_t i = 0; i < np1; i++) {
+                const len_t c = j*np1+i;
+                s.BeginRow(offset + c);
+
+                // Radius (flux through the faces ir-1/2 and ir+1/2)
+                real_t S_i = Vp_fr[c]  / (Vp[c]*dr[ir]);
+                real_t S_o = Vp_fr1[c] / (Vp[c]*dr[ir]);
+                len_t d = deltar->GetCoefficientIndex(ir,i,j);
+                for (len_t n, k = deltar->GetKmin(ir, &n); k <= deltar->GetKmax(ir,nr); k++, n++)
+                    s.Add(grid->GetCellOffset(k) + c, C_FR, ofr+c, -S_i, D_R, d+n);
+
+                d = deltar->GetCoefficientIndex(ir+1,i,j);
+                for (len_t n, k = deltar->GetKmin(ir+1, &n); k <= deltar->GetKmax(ir+1,nr); k++, n++)
+                    s.Add(grid->GetCellOffset(k) + c, C_FR, ofr1+c, S_o, D_R, d+n);
+
+                // Momentum 1 (the flux through the p=0 face is given by
+                // the coefficient multiplied by p^2)
+                const real_t VpDp1 = Vp[c]*dp1[i];
+                const bool pZero = (mg->GetP1_f(i) == 0);
+                S_i = (pZero ? VpOverP2AtZero[j] : Vp_f1[j*(np1+1)+i]) / VpDp1;
+                S_o = Vp_f1[j*(np1+1)+i+1] / VpDp1;
+
+                d = delta1->GetCoefficientIndex(ir,i,j);
+                for (len_t n, k = delta1->GetKmin(i, &n); k <= delta1->GetKmax(i,np1); k++, n++) {
+                    const PetscInt col = offset + j*np1+k;
+                    if (pZero)
+                        s.Add(col, C_F1PSQ, of1p+j, -S_i, D_1, d+n);
+                    else
+                        s.Add(col, C_F1, of1+j*(np1+1)+i, -S_i, D_1, d+n);
+                }
+
+                d = delta1->GetCoefficientIndex(ir,i+1,j);
+                for (len_t n, k = delta1->GetKmin(i+1, &n); k <= delta1->GetKmax(i+1,np1); k++, n++)
+                    s.Add(offset + j*np1+k, C_F1, of1+j*(np1+1)+i+1, S_o, D_1, d+n);
+
+                // Momentum 2
+                const real_t VpDp2 = Vp[c]*dp2[j];
+                S_i = Vp_f2[j*np1+i]     / VpDp2;
+                S_o = Vp_f2[(j+1)*np1+i] / VpDp2;
+
+                d = delta2->GetCoefficientIndex(ir,i,j);
+                for (len_t n, k = delta2->GetKmin(j, &n); k <= delta2->GetKmax(j,np2); k++, n++)
+                    s.Add(offset + k*np1+i, C_F2, of2+j*np1+i, -S_i, D_2, d+n);
+
+                d = delta2->GetCoefficientIndex(ir,i,j+1);
+                for (len_t n, k = delta2->GetKmin(j+1, &n); k <= delta2->GetKmax(j+1,np2); k++, n++)
+                    s.Add(offset + k*np1+i, C_F2, of2+(j+1)*np1+i, S_o, D_2, d+n);
+            }
+        }
+
+        offset += np1*np2;
+    }
+
+    return true;
+}
+
+/**
+ * Set the matrix elements of this term from a kernel on the device,
+ * if the matrix supports device assembly.
+ *
+ * RETURNS false if the elements must instead be set on the host.
+ */
+bool AdvectionTerm::SetMatrixElementsDevice(Matrix *mat) {
+    if (!Device::IsEnabled())
+        return false;
+
+    if (!this->deviceStencilValid) {
+        this->deviceStencilSupported = this->BuildDeviceStencil();
+        this->deviceStencilValid = true;
+    }
+
+    if (!this->deviceStencilSupported)
+        return false;
+
+    const DeviceStencil::arrays
+        c = {{ fr[0], f1[0], f2[0], f1pSqAtZero[0], nullptr }},
+        d = {{
+            deltar->GetCoefficients(interp_mode),
+            delta1->GetCoefficients(interp_mode),
+            delta2->GetCoefficients(interp_mode),
+            nullptr, nullptr
+        }};
+
+    return this->deviceStencil.Apply(mat, c, d);
+}
+
+
 /**
  * Instead of building a linear operator (matrix) to apply to a vector
  * 'x', this routine builds immediately the resulting vector.
@@ -529,9 +778,16 @@ void AdvectionTerm::SetVectorElements(
     const real_t *const* f2, const real_t *const* f1pSqAtZero, jacobian_interp_mode set
 ) {
     interp_mode = AdvectionInterpolationCoefficient::AD_INTERP_MODE_FULL;
-    #define f(K,I,J,V) vec[offset+j*np1+i] += (V)*x[offset+((K)-ir)*np2*np1 + (J)*np1 + (I)]
+    // (the contributions to each element of 'vec' are summed in a
+    // local variable, since the compiler must otherwise assume that
+    // 'vec' may alias 'x' and write each contribution to memory)
+    #define BeginRow() real_t rowValue = 0
+    #define f(K,I,J,V) rowValue += (V)*x[grid->GetCellOffset(K) + (J)*n1[K] + (I)]
+    #define EndRow() vec[offset+j*np1+i] += rowValue
     #   include "AdvectionTerm.set.cpp"
+    #undef EndRow
     #undef f
+    #undef BeginRow
 }
 
 /**
@@ -544,8 +800,19 @@ void AdvectionTerm::SaveCoefficientsSFile(const std::string& filename) {
     sf->Close();
 }
 void AdvectionTerm::SaveCoefficientsSFile(SFile *sf) {
+    // With different momentum grids at different radii, the
+    // coefficients are saved as flat lists
+    if (!this->grid->HasRadiallyUniformMomentumGrid()) {
+        if (this->fr != nullptr)
+            sf->WriteList("Fr", this->fr[0], this->grid->GetNCells_fr());
+        if (this->f2 != nullptr)
+            sf->WriteList("F2", this->f2[0], this->grid->GetNCells_f2());
+        if (this->f1 != nullptr)
+            sf->WriteList("F1", this->f1[0], this->grid->GetNCells_f1());
+        return;
+    }
+
     sfilesize_t dims[3];
-    // XXX here we assume that all momentum grids are the same
     const sfilesize_t
         nr = this->grid->GetNr(),
         n1 = this->grid->GetMomentumGrid(0)->GetNp1(),
@@ -1,6 +1,18 @@
 /**
  * Implementation of the general 'SetXXX' routine. It is
  * made specific with the help of the 'f' macro.
+ *
+ * All elements 'f' on one matrix row (i.e. in cell (ir,i,j))
+ * are set between the 'BeginRow()' and 'EndRow()' macros,
+ * which allows the row to be accumulated locally.
+ *
+ * The 'f' macro takes the indices of the column cell (K,I,J)
+ * in terms of the momentum grid used at radius K. When radii
+ * use different momentum grids, the unknown in a neighbouring
+ * radius is mapped onto the momentum grid of the radial flux
+ * grid point, and the flux through the outer face of the cell
+ * is distributed over the cells covering the face, using the
+ * conservative overlaps of 'MomentumGridMapping'.
  */
 
 // void AdvectionTerm::SetXXX(f) {
@@ -11,13 +23,27 @@
     const real_t
         *dr = grid->GetRadialGrid()->GetDr();
 
+    // Adds the contribution 'V' multiplying the unknown at radius K,
+    // evaluated in cell (A,B) of the momentum grid 'MG'
+    #define XR(K,A,B,MG,V) \
+        if (grid->GetMomentumGrid(K) == (MG)) f((K),(A),(B),(V)); \
+        else grid->GetMomentumGridMapping(grid->GetMomentumGrid(K), (MG))->ForEachOverlap( \
+            (A), (B), [&](const len_t c_, const len_t d_, const real_t W_, const real_t) \
+                { f((K),c_,d_,W_*(V)); } \
+        )
+
     // Iterate over interior radial grid points
     for (len_t ir = 0; ir < nr; ir++) {
-        const MomentumGrid *mg = grid->GetMomentumGrid(ir);
+        const MomentumGrid
+            *mg   = grid->GetMomentumGrid(ir),
+            *mg_o = grid->GetMomentumGrid_fr(ir+1);
+        const MomentumGridMapping *map_o =
+            grid->GetMomentumGridMapping(mg_o, mg);
 
         const len_t
             np1 = mg->GetNp1(),
-            np2 = mg->GetNp2();
+            np2 = mg->GetNp2(),
+            np1_o = mg_o->GetNp1();
 
         const real_t
             *Vp     = grid->GetVp(ir),
@@ -26,7 +52,9 @@
             *Vp_f1  = grid->GetVp_f1(ir),
             *Vp_f2  = grid->GetVp_f2(ir),
             *dp1    = mg->GetDp1(),
-            *dp2    = mg->GetDp2();
+            *dp2    = mg->GetDp2(),
+            *dp1_o  = mg_o->GetDp1(),
+            *dp2_o  = mg_o->GetDp2();
 
         for (len_t j = 0; j < np2; j++) {
             // Do not set terms in the negative trapped region where the 
@@ -36,6 +64,7 @@
             bool isNegativeTrappedRadial = grid->IsNegativePitchTrappedIgnorableRadialFluxCell(ir,j);
 
             for (len_t i = 0; i < np1; i++) {
+                BeginRow();
                 real_t 
                     S_i, // advection coefficient on left-hand face of the cell
                     S_o; // advection coefficient on right-hand face of the cell
@@ -43,23 +72,13 @@
                 /////////////////////////
                 // RADIUS
                 /////////////////////////
-                #define X(K,V) f((K),i,j,V)
-                // XXX: Here we assume that the momentum grid is the same at all
-                // radial points.
-                //
-                // OTHERWISE...:
-                // This term is pretty difficult, since we need to evaluate the
-                // coefficients in different radial grid points, which in general
-                // have different momentum grids and thus require interpolation
-                // across grids. For this application, we should be able to assume
-                // that momentum grids at all radii use the same coordinate systems.
-                // In general, it is much more difficult, though (so it would require
-                // a bit more thinking if we wanted to interpolate generally between
-                // two different momentum grids)
+                // (the inner face of the cell uses the same momentum grid
+                // as the cell, while the outer face uses 'mg_o')
+                #define X(K,V) XR((K),i,j,mg,V)
 
                 // Trapping BC: even if the cell is not ignorable, it may still 
                 // be such that the radial flux should be mirrored 
-                if( !isNegativeTrappedRadial && ( Fr(ir,   i, j, fr) || Fr(ir+1, i, j, fr) ) ) {
+                if( !isNegativeTrappedRadial && map_o == nullptr && ( Fr(ir,   i, j, fr) || Fr(ir+1, i, j, fr) ) ) {
                     S_i = Fr(ir,   i, j, fr) *  Vp_fr[j*np1+i] / (Vp[j*np1+i] * dr[ir]);
                     S_o = Fr(ir+1, i, j, fr) * Vp_fr1[j*np1+i] / (Vp[j*np1+i] * dr[ir]);
 
@@ -83,11 +102,49 @@
                     // Phi^(r)_{ir+1/2,i,j}: Flow out from the cell to the "right" r face
                     for(len_t n, k = deltar->GetKmin(ir+1, &n); k <= deltar->GetKmax(ir+1,nr); k++, n++)
                         X(k,  S_o * delta[n]);
+                } else if (!isNegativeTrappedRadial && map_o != nullptr) {
+                    // Phi^(r)_{ir-1/2,i,j}: Flow into the cell from the "left" r face
+                    if (Fr(ir, i, j, fr)) {
+                        S_i = Fr(ir, i, j, fr) * Vp_fr[j*np1+i] / (Vp[j*np1+i] * dr[ir]);
+                        if(set==JACOBIAN_SET_LOWER)
+                            S_i *= 1 - deltaRadialFlux[ir];
+                        else if(set==JACOBIAN_SET_CENTER)
+                            S_i *= deltaRadialFlux[ir];
+                        else if(set==JACOBIAN_SET_UPPER)
+                            S_i = 0;
+
+                        delta = deltar->GetCoefficient(ir,i,j,interp_mode);
+                        for(len_t n, k = deltar->GetKmin(ir, &n); k <= deltar->GetKmax(ir,nr); k++, n++)
+                            X(k, -S_i * delta[n]);
+                    }
+
+                    // Phi^(r)_{ir+1/2,a,b}: Flow out from the cell through the
+                    // cells (a,b) of the "right" r face which overlap this
+                    // cell, each contributing with the fraction R of its flux
+                    map_o->ForEachOverlap(i, j, [&](const len_t a, const len_t b, const real_t, const real_t R) {
+                        if (!Fr(ir+1, a, b, fr))
+                            return;
+
+                        real_t S = R * Fr(ir+1, a, b, fr) * Vp_fr1[b*np1_o+a] * dp1_o[a]*dp2_o[b]
+                            / (Vp[j*np1+i] * dr[ir] * dp1[i]*dp2[j]);
+                        if(set==JACOBIAN_SET_LOWER)
+                            S = 0;
+                        else if(set==JACOBIAN_SET_CENTER)
+                            S *= 1 - deltaRadialFlux[ir];
+                        else if(set==JACOBIAN_SET_UPPER)
+                            S *= deltaRadialFlux[ir];
+
+                        const real_t *delta_o = deltar->GetCoefficient(ir+1,a,b,interp_mode);
+                        for(len_t n, k = deltar->GetKmin(ir+1, &n); k <= deltar->GetKmax(ir+1,nr); k++, n++)
+                            XR(k, a, b, mg_o, S * delta_o[n]);
+                    });
                 }
                 #undef X
                 
-                if(set==JACOBIAN_SET_LOWER || set==JACOBIAN_SET_UPPER)
+                if(set==JACOBIAN_SET_LOWER || set==JACOBIAN_SET_UPPER) {
+                    EndRow();
                     continue;
+                }
 
                 /////////////////////////
                 // MOMENTUM 1
@@ -136,8 +193,12 @@
                         X(i, k,  S_o * delta[n]);
                 }
                 #undef X
+
+                EndRow();
             }
         }
 
         offset += np1*np2;
     }
+
+    #undef XR
@@ -14,11 +14,13 @@
  * (the boundary condition is applied on the boundary marked with the crosses)
  */
 
+#include <algorithm>
 #include "FVM/BlockMatrix.hpp"
 #include "FVM/Equation/BoundaryConditions/PXiExternalKineticKinetic.hpp"
 
 
 using namespace DREAM::FVM::BC;
+using namespace std;
 
 
 /**
@@ -41,15 +43,26 @@ PXiExternalKineticKinetic::PXiExternalKineticKinetic(
 PXiExternalKineticKinetic::~PXiExternalKineticKinetic() { }
 
 
+/**
+ * Get the maximum number of xi points at any radius on the
+ * lower and upper grids (which may use different momentum
+ * grids at different radii).
+ */
+void PXiExternalKineticKinetic::GetMaxNp2(len_t &ln2, len_t &un2) const {
+    for (len_t ir = 0; ir < this->lowerGrid->GetNr(); ir++) {
+        ln2 = max(ln2, this->lowerGrid->GetNp2(ir));
+        un2 = max(un2, this->upperGrid->GetNp2(ir));
+    }
+}
+
 /**
  * Returns the number of non-zero elements set by this boundary
  * condition, per row, in the linear operator matrix.
  */
 len_t PXiExternalKineticKinetic::GetNumberOfNonZerosPerRow() const {
     if (this->type == TYPE_DENSITY) {
-        const len_t
-            ln2 = this->lowerGrid->GetMomentumGrid(0)->GetNp2(),
-            un2 = this->upperGrid->GetMomentumGrid(0)->GetNp2();
+        len_t ln2 = 0, un2 = 0;
+        GetMaxNp2(ln2, un2);
         return 2*(ln2 + 2*un2);
     } else
         // On kinetic grids, this term does not add any non-zero
@@ -63,11 +76,8 @@ len_t PXiExternalKineticKinetic::GetNumberOfNonZerosPerRow() const {
  * condition, per row, in the jacobian matrix.
  */
 len_t PXiExternalKineticKinetic::GetNumberOfNonZerosPerRow_jac() const {
-    // XXX here we assume that all momentum grids are the same
-    // at all radii
-    const len_t
-        ln2 = this->lowerGrid->GetMomentumGrid(0)->GetNp2(),
-        un2 = this->upperGrid->GetMomentumGrid(0)->GetNp2();
+    len_t ln2 = 0, un2 = 0;
+    GetMaxNp2(ln2, un2);
 
     /*AdvectionDiffusionTerm *adt = oprtr->GetAdvectionDiffusion();
     len_t nnzOffDiag = adt->GetNumberOfNonZerosPerRow_jac() - adt->GetNumberOfNonZerosPerRow();*/
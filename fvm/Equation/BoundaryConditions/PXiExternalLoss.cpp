@@ -6,6 +6,7 @@
  * lost across the boundary handled by this boundary condition.
  */
 
+#include <algorithm>
 #include <functional>
 #include "FVM/Equation/BoundaryConditions/PXiExternalLoss.hpp"
 
@@ -45,6 +46,15 @@ PXiExternalLoss::PXiExternalLoss(
             );
     } else
         this->distributionGrid = distGrid;
+
+    this->boundaryFlux = new real_t[this->distributionGrid->GetNr()];
+}
+
+/**
+ * Destructor.
+ */
+PXiExternalLoss::~PXiExternalLoss() {
+    delete [] this->boundaryFlux;
 }
 
 
@@ -53,12 +63,13 @@ PXiExternalLoss::PXiExternalLoss(
  * condition in the linear operator matrix.
  */
 len_t PXiExternalLoss::GetNumberOfNonZerosPerRow() const {
-    // XXX here we assume that all momentum grids are the same
-    // at all radii
-    if (this->boundary == BOUNDARY_FLUID)
+    if (this->boundary == BOUNDARY_FLUID) {
         // Up to 9 elements per xi (by Dpx)
-        return 9*this->distributionGrid->GetMomentumGrid(0)->GetNp2();
-    else
+        len_t nxi = 0;
+        for (len_t ir = 0; ir < this->distributionGrid->GetNr(); ir++)
+            nxi = std::max(nxi, this->distributionGrid->GetNp2(ir));
+        return 9*nxi;
+    } else
         // No additional non-zeros needed (other than those set by the 
         // kinetic equation)
         return 0;
@@ -80,9 +91,12 @@ len_t PXiExternalLoss::GetNumberOfNonZerosPerRow_jac() const {
 
 /**
  * Rebuild coefficients for this term.
- * (not used)
+ * (not used, except for invalidating the boundary flux)
  */
-bool PXiExternalLoss::Rebuild(const real_t, UnknownQuantityHandler*) { return false; }
+bool PXiExternalLoss::Rebuild(const real_t, UnknownQuantityHandler*) {
+    this->boundaryFluxValid = false;
+    return false;
+}
 
 /**
  * Add flux to jacobian block.
@@ -133,11 +147,60 @@ void PXiExternalLoss::AddToVectorElements_c(
     const real_t *const*, const real_t *const* df1, const real_t *const*,
     const real_t *const*, const real_t *const* dd11, const real_t *const* dd12,
     const real_t *const*, const real_t *const*,
-    jacobian_interp_mode
+    jacobian_interp_mode set_mode
 ) {
+    // When evaluating the residual (as opposed to the jacobian), the
+    // flux through the boundary is recorded as a by-product
+    real_t *flux = nullptr;
+    if (set_mode == NO_JACOBIAN) {
+        flux = this->boundaryFlux;
+        for (len_t ir = 0; ir < this->distributionGrid->GetNr(); ir++)
+            flux[ir] = 0;
+    }
+
     this->__SetElements([&vec,&f](const len_t I, const len_t J, const real_t V) {
         vec[I] += V*f[J];
-    }, df1, dd11, dd12);
+    }, df1, dd11, dd12, flux, f);
+
+    if (flux != nullptr)
+        this->boundaryFluxValid = true;
+}
+
+/**
+ * Returns the particle flux through the upper momentum boundary, per
+ * unit volume, at each radius (i.e. the rate at which particles are
+ * added to the fluid density which receives the particles lost across
+ * the boundary). The flux is recorded whenever the residual containing
+ * this boundary condition is evaluated, and so it is typically
+ * available without any further evaluation. If the boundary condition
+ * has been rebuilt since the residual was last evaluated (or if the
+ * residual is never evaluated, as in the linearly implicit solver),
+ * the flux is evaluated for the given distribution function.
+ *
+ * NOTE: The non-linear solver evaluates the residual before taking a
+ * Newton step, so that the recorded flux corresponds to the last
+ * Newton iterate (which agrees with the converged solution to within
+ * the solver tolerance).
+ *
+ * f: Distribution function to evaluate the flux for, if necessary.
+ */
+const real_t *PXiExternalLoss::GetBoundaryFlux(const real_t *f) {
+    if (!this->boundaryFluxValid) {
+        const real_t *const* Ap  = oprtr->GetAdvectionCoeff1();
+        const real_t *const* Dpp = oprtr->GetDiffusionCoeff11();
+        const real_t *const* Dpx = oprtr->GetDiffusionCoeff12();
+
+        for (len_t ir = 0; ir < this->distributionGrid->GetNr(); ir++)
+            this->boundaryFlux[ir] = 0;
+
+        this->__SetElements(
+            [](const len_t, const len_t, const real_t) {},
+            Ap, Dpp, Dpx, this->boundaryFlux, f
+        );
+        this->boundaryFluxValid = true;
+    }
+
+    return this->boundaryFlux;
 }
 
 /**
@@ -161,7 +224,8 @@ void PXiExternalLoss::__SetElements(
 
 void PXiExternalLoss::__SetElements(
     std::function<void(const len_t, const len_t, const real_t)> f,
-    const real_t *const* cAp, const real_t *const* cDpp, const real_t *const* cDpx
+    const real_t *const* cAp, const real_t *const* cDpp, const real_t *const* cDpx,
+    real_t *flux, const real_t *x
 ) {
     const len_t nr = this->grid->GetNr();
     len_t offset = 0;
@@ -208,6 +272,17 @@ void PXiExternalLoss::__SetElements(
                 iVd  = Vp[idx2-offset] * dp[np-1];
             }
 
+            // Set element, and (optionally) accumulate the flux through the
+            // boundary (per unit volume, as seen from the fluid side)
+            const real_t wFlux = (
+                this->boundary == BOUNDARY_FLUID ? 1 : -iVd*dxi[j]/VpVol[ir]
+            );
+            auto set = [&f,&flux,&x,ir,wFlux](const len_t I, const len_t J, const real_t V) {
+                f(I, J, V);
+                if (flux != nullptr)
+                    flux[ir] += wFlux*V*x[J];
+            };
+
             // Contribution from advection and PP diffusion
             if (this->boundaryCondition == BC_F_0) {
                 real_t Vd = Vp_fp[j*(np+1) + np] / iVd;
@@ -217,16 +292,16 @@ void PXiExternalLoss::__SetElements(
                 if (Ap != nullptr) {
                     real_t delta1 = (Ap[j*(np+1) + np]>0); 
                     // Phi_{N_p+1/2}  -- f_{N_p+1} = 0
-                    f(idx1, idx2, delta1*Ap[j*(np+1) + np] * Vd);
+                    set(idx1, idx2, delta1*Ap[j*(np+1) + np] * Vd);
                 }
 
                 // Dpp
                 if (Dpp != nullptr)
-                    f(idx1, idx2, Dpp[j*(np+1) + np]/dp_f[np-2] * Vd);
+                    set(idx1, idx2, Dpp[j*(np+1) + np]/dp_f[np-2] * Vd);
 
                 if (Dpx != nullptr && j > 0 && j < nxi-1) {
-                    f(idx1, idx2+np-1, -Dpx[j*(np+1) + np] / (2*dp_f[np-2]) * Vd);
-                    f(idx1, idx2-np-1, +Dpx[j*(np+1) + np] / (2*dp_f[np-2]) * Vd);
+                    set(idx1, idx2+np-1, -Dpx[j*(np+1) + np] / (2*dp_f[np-2]) * Vd);
+                    set(idx1, idx2-np-1, +Dpx[j*(np+1) + np] / (2*dp_f[np-2]) * Vd);
                 }
             } else {
                 const real_t *delta1_0 = oprtr->GetInterpolationCoeff1(ir,np-1,j);
@@ -237,33 +312,33 @@ void PXiExternalLoss::__SetElements(
                 if (Ap != nullptr) {
                     // Phi_{N_p-1/2}
                     for(len_t k=0; k<3; k++)
-                        f(idx1, idx2+k-2, (1+dd)*delta1_0[k]*Ap[j*(np+1) + np-1] * Vd);
+                        set(idx1, idx2+k-2, (1+dd)*delta1_0[k]*Ap[j*(np+1) + np-1] * Vd);
                 
                     // Phi_{N_p-3/2}
                     for(len_t k=0; k<4; k++)
-                        f(idx1, idx2+k-3, -dd*delta1_1[k]*Ap[j*(np+1) + np-1] * Vd);
+                        set(idx1, idx2+k-3, -dd*delta1_1[k]*Ap[j*(np+1) + np-1] * Vd);
                 }
 
                 // Dpp
                 if (Dpp != nullptr) {
-                    f(idx1, idx2,   -(1+dd)*Dpp[j*(np+1) + np-1]/dp_f[np-2] * Vd);
-                    f(idx1, idx2-1,  (1+dd)*Dpp[j*(np+1) + np-1]/dp_f[np-2] * Vd);
+                    set(idx1, idx2,   -(1+dd)*Dpp[j*(np+1) + np-1]/dp_f[np-2] * Vd);
+                    set(idx1, idx2-1,  (1+dd)*Dpp[j*(np+1) + np-1]/dp_f[np-2] * Vd);
 
-                    f(idx1, idx2-1,  dd*Dpp[j*(np+1) + np-2]/dp_f[np-3] * Vd);
-                    f(idx1, idx2-2, -dd*Dpp[j*(np+1) + np-2]/dp_f[np-3] * Vd);
+                    set(idx1, idx2-1,  dd*Dpp[j*(np+1) + np-2]/dp_f[np-3] * Vd);
+                    set(idx1, idx2-2, -dd*Dpp[j*(np+1) + np-2]/dp_f[np-3] * Vd);
                 }
 
                 // Dpx
                 if (Dpx != nullptr && j > 0 && j < nxi-1) {
-                    f(idx1, idx2+np,   -(1+dd)*Dpx[j*(np+1) + np-1] / (dp_f[np-2]+dp_f[np-3]) * Vd);
-                    f(idx1, idx2+np-1, -(1+dd)*Dpx[j*(np+1) + np-1] / (dp_f[np-2]+dp_f[np-3]) * Vd);
-                    f(idx1, idx2-np,   +(1+dd)*Dpx[j*(np+1) + np-1] / (dp_f[np-2]+dp_f[np-3]) * Vd);
-                    f(idx1, idx2-np-1, +(1+dd)*Dpx[j*(np+1) + np-1] / (dp_f[np-2]+dp_f[np-3]) * Vd);
-
-                    f(idx1, idx2+np-1, +dd*Dpx[j*(np+1) + np-2] / (dp_f[np-3]+dp_f[np-4]) * Vd);
-                    f(idx1, idx2+np-2, +dd*Dpx[j*(np+1) + np-2] / (dp_f[np-3]+dp_f[np-4]) * Vd);
-                    f(idx1, idx2-np-1, -dd*Dpx[j*(np+1) + np-2] / (dp_f[np-3]+dp_f[np-4]) * Vd);
-                    f(idx1, idx2-np-2, -dd*Dpx[j*(np+1) + np-2] / (dp_f[np-3]+dp_f[np-4]) * Vd);
+                    set(idx1, idx2+np,   -(1+dd)*Dpx[j*(np+1) + np-1] / (dp_f[np-2]+dp_f[np-3]) * Vd);
+                    set(idx1, idx2+np-1, -(1+dd)*Dpx[j*(np+1) + np-1] / (dp_f[np-2]+dp_f[np-3]) * Vd);
+                    set(idx1, idx2-np,   +(1+dd)*Dpx[j*(np+1) + np-1] / (dp_f[np-2]+dp_f[np-3]) * Vd);
+                    set(idx1, idx2-np-1, +(1+dd)*Dpx[j*(np+1) + np-1] / (dp_f[np-2]+dp_f[np-3]) * Vd);
+
+                    set(idx1, idx2+np-1, +dd*Dpx[j*(np+1) + np-2] / (dp_f[np-3]+dp_f[np-4]) * Vd);
+                    set(idx1, idx2+np-2, +dd*Dpx[j*(np+1) + np-2] / (dp_f[np-3]+dp_f[np-4]) * Vd);
+                    set(idx1, idx2-np-1, -dd*Dpx[j*(np+1) + np-2] / (dp_f[np-3]+dp_f[np-4]) * Vd);
+                    set(idx1, idx2-np-2, -dd*Dpx[j*(np+1) + np-2] / (dp_f[np-3]+dp_f[np-4]) * Vd);
                 }
             }
         }
@@ -39,18 +39,42 @@ PXiInternalTrapping::~PXiInternalTrapping() {
  * Deallocate memory for the 'trappedNegXi_indices' array.
  */
 void PXiInternalTrapping::DeallocateTrappedIndices() {
-    len_t nr = this->grid->GetNr();
-    for (len_t ir = 0; ir < nr; ir++)
+    if (this->trappedNegXi_indices == nullptr)
+        return;
+
+    len_t nr = this->nr;
+    for (len_t ir = 0; ir < nr; ir++) {
         delete [] trappedNegXi_indices[ir];
+        delete [] trappedPosXi_indices[ir];
+        delete [] trappedNegXiRadial_indices[ir];
+        delete [] trappedPosXiRadial_indices[ir];
+    }
 
     delete [] trappedNegXi_indices;
+    delete [] trappedPosXi_indices;
     delete [] nTrappedNegXi_indices;
+    delete [] trappedNegXiRadial_indices;
+    delete [] trappedPosXiRadial_indices;
+    delete [] nTrappedNegXiRadial_indices;
 
     delete [] rowsToReset;
 
+    delete [] mirrorWeights;
+    delete [] mirrorCols;
+    delete [] mirrorRows;
+    delete [] mirrorOffsets;
+
     this->trappedNegXi_indices = nullptr;
+    this->trappedPosXi_indices = nullptr;
     this->nTrappedNegXi_indices = nullptr;
+    this->trappedNegXiRadial_indices = nullptr;
+    this->trappedPosXiRadial_indices = nullptr;
+    this->nTrappedNegXiRadial_indices = nullptr;
     this->rowsToReset = nullptr;
+    this->mirrorOffsets = nullptr;
+    this->mirrorRows = nullptr;
+    this->mirrorCols = nullptr;
+    this->mirrorWeights = nullptr;
 }
 
 /**
@@ -71,7 +95,7 @@ void PXiInternalTrapping::LocateTrappedRegion() {
     if (this->trappedNegXi_indices != nullptr)
         this->DeallocateTrappedIndices();
 
-    len_t nr = this->grid->GetNr();
+    len_t nr = this->nr = this->grid->GetNr();
     this->trappedNegXi_indices  = new PetscInt*[nr];
     this->trappedPosXi_indices  = new PetscInt*[nr];
     this->nTrappedNegXi_indices = new PetscInt[nr];
@@ -166,6 +190,45 @@ void PXiInternalTrapping::LocateTrappedRegion() {
         }
         offset += nP*nXi;
     }
+
+    this->BuildMirrorMap();
+}
+
+/**
+ * Construct the map which sets f(xi0) = f(-xi0) in the trapped
+ * region. Since the map only depends on the grid, it is built once
+ * whenever the grid is rebuilt and then applied directly when
+ * assembling the matrix and function vector.
+ */
+void PXiInternalTrapping::BuildMirrorMap() {
+    const len_t nr = this->nr;
+
+    // Count number of elements (at most two per reset row)
+    this->mirrorOffsets = new len_t[nr+1];
+    this->mirrorOffsets[0] = 0;
+    for (len_t ir = 0; ir < nr; ir++)
+        this->mirrorOffsets[ir+1] = this->mirrorOffsets[ir]
+            + 2*this->grid->GetNp1(ir)*this->nTrappedNegXi_indices[ir];
+
+    const len_t nmax = this->mirrorOffsets[nr];
+    this->mirrorRows    = new PetscInt[nmax];
+    this->mirrorCols    = new PetscInt[nmax];
+    this->mirrorWeights = new real_t[nmax];
+
+    len_t offset = 0, k = 0;
+    for (len_t ir = 0; ir < nr; ir++) {
+        this->mirrorOffsets[ir] = k;
+        offset += this->_setElements(
+            ir, offset,
+            [this,&k](const len_t I, const len_t J, const real_t v) {
+                this->mirrorRows[k]    = I;
+                this->mirrorCols[k]    = J;
+                this->mirrorWeights[k] = v;
+                k++;
+            }
+        );
+    }
+    this->mirrorOffsets[nr] = k;
 }
 
 /**
@@ -388,18 +451,12 @@ void PXiInternalTrapping::SetMatrixElements(
         for(len_t it=0; it<nRowsToReset; it++)
             rhs[rowsToReset[it]] = 0;
     
-    const len_t nr = this->grid->GetNr();
-    len_t offset = 0;
-    // Iterate over all rows with -xi_T <= xi0 < 0.
-    for (len_t ir = 0; ir < nr; ir++) {
-        // NOTE: Must be 'INSERT_VALUES' since we called 'SetDiagonalConstant(...)' 
-        // above and didn't call 'PartialAssemble()' after...
-        offset += this->_setElements(
-            ir, offset,
-            [&mat](const len_t I, const len_t J, const real_t v)
-            { mat->SetElement(I, J, v, INSERT_VALUES); }
-        );
-    }
+    // Set f(xi0) = f(-xi0) in all rows with -xi_T <= xi0 < 0.
+    // NOTE: Must be 'INSERT_VALUES' since we called 'SetDiagonalConstant(...)' 
+    // above and didn't call 'PartialAssemble()' after...
+    const len_t n = this->mirrorOffsets[this->nr];
+    for (len_t k = 0; k < n; k++)
+        mat->SetElement(mirrorRows[k], mirrorCols[k], mirrorWeights[k], INSERT_VALUES);
 }
 
 /**
@@ -407,20 +464,14 @@ void PXiInternalTrapping::SetMatrixElements(
  * and set f(xi0) = f(-xi0) in this region.
  */
 void PXiInternalTrapping::SetVectorElements(real_t *vec, const real_t *f) {
-    const len_t nr = this->grid->GetNr();
-    len_t offset = 0;
-
     // Reset elements corresponding to -xi_T <= xi0 < 0
     for(len_t it=0; it<nRowsToReset; it++)
         vec[rowsToReset[it]] = -f[rowsToReset[it]];
 
-    // Iterate over all rows with -xi_T <= xi0 < 0.
-    for (len_t ir = 0; ir < nr; ir++) {
-        offset += this->_setElements(
-            ir, offset,
-            [&vec,&f](const len_t I, const len_t J, const real_t v) { vec[I] += v*f[J]; }
-        );
-    }
+    // Set f(xi0) = f(-xi0) in all rows with -xi_T <= xi0 < 0.
+    const len_t n = this->mirrorOffsets[this->nr];
+    for (len_t k = 0; k < n; k++)
+        vec[mirrorRows[k]] += mirrorWeights[k]*f[mirrorCols[k]];
 }
 
 /**
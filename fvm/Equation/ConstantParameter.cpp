@@ -19,6 +19,7 @@ ConstantParameter::ConstantParameter(Grid *g, const real_t v)
     : PredeterminedParameter(g) {
 
     SetName("Constant");
+    SetRebuildInputs({}, false);
 
     const len_t N = g->GetNCells();
 
@@ -0,0 +1,244 @@
+/**
+ * Stencil of an equation term, applied to a matrix from a kernel on
+ * the device (see 'FVM::Device' and 'Matrix::BeginDeviceAssembly()').
+ *
+ * The matrix elements of the advection and diffusion terms are sums of
+ * products of a geometric weight (depending only on the grid), one of
+ * the coefficients of the term and, for advection terms, one of the
+ * interpolation coefficients of the flux. The stencil is therefore
+ * built once on the host (whenever the grid or the storage of the
+ * coefficients changes) as a list of entries
+ *
+ *   (row, column, weight, coefficient index, interpolation coefficient index),
+ *
+ * and the coefficients are then combined into the matrix values by a
+ * kernel, with one thread per row (so that no two threads add to the
+ * same element), writing directly into the device value array of the
+ * matrix.
+ *
+ * Entries can only be applied to elements which are part of the
+ * non-zero structure recorded for the matrix. Entries outside of the
+ * structure (normally because their coefficient vanished in the host
+ * assembly from which the structure was recorded) are skipped as long
+ * as their contributions vanish. Otherwise, the stencil is not applied
+ * and the elements must be set on the host (which extends the
+ * structure for later assemblies).
+ */
+
+#include "FVM/Device.hpp"
+#include "FVM/Equation/DeviceStencil.hpp"
+
+
+using namespace DREAM::FVM;
+
+
+/**
+ * Destructor.
+ */
+DeviceStencil::~DeviceStencil() {
+    this->DeallocateDevice();
+}
+
+/**
+ * Free the copies of the stencil on the device, as well as the
+ * element locations of all matrices.
+ */
+void DeviceStencil::DeallocateDevice() {
+    Device::FreeDevice(this->d_rowStart);
+    Device::FreeDevice(this->d_delta);
+    Device::FreeDevice(this->d_array);
+    Device::FreeDevice(this->d_deltaArray);
+    Device::FreeDevice(this->d_coef);
+    Device::FreeDevice(this->d_weight);
+
+    this->d_rowStart = this->d_delta = nullptr;
+    this->d_array = this->d_deltaArray = nullptr;
+    this->d_coef = nullptr;
+    this->d_weight = nullptr;
+
+    for (struct device_slots &ds : this->deviceSlots)
+        Device::FreeDevice(ds.slots);
+    this->deviceSlots.clear();
+
+    this->finalized = false;
+}
+
+/**
+ * Remove all entries of the stencil.
+ */
+void DeviceStencil::Clear() {
+    this->DeallocateDevice();
+
+    this->rows.clear();
+    this->rowStart.clear();
+    this->cols.clear();
+    this->array.clear();
+    this->deltaArray.clear();
+    this->coef.clear();
+    this->delta.clear();
+    this->weight.clear();
+}
+
+/**
+ * Start a new row of the stencil. The entries added until the next
+ * call to this method belong to the row 'row' (relative to the row
+ * offset of the matrix). Each row may only be begun once.
+ */
+void DeviceStencil::BeginRow(const PetscInt row) {
+    this->rows.push_back(row);
+    this->rowStart.push_back((PetscInt)this->cols.size());
+}
+
+/**
+ * Add an entry to the current row of the stencil.
+ *
+ * col:        Column of the element (relative to the column offset
+ *             of the matrix).
+ * array:      Index of the coefficient array to use.
+ * coef:       Index of the coefficient in the coefficient array.
+ * weight:     Weight multiplying the coefficient.
+ * deltaArray: Index of the interpolation coefficient array to use.
+ * delta:      Index of the interpolation coefficient in the array
+ *             (or -1 if the entry contains no interpolation coefficient).
+ */
+void DeviceStencil::Add(
+    const PetscInt col, const int array, const len_t coef,
+    const real_t weight, const int deltaArray, const PetscInt delta
+) {
+    this->cols.push_back(col);
+    this->array.push_back(array);
+    this->coef.push_back(coef);
+    this->weight.push_back(weight);
+    this->deltaArray.push_back(deltaArray);
+    this->delta.push_back(delta);
+}
+
+/**
+ * Copy the entries of the stencil to the device.
+ */
+void DeviceStencil::Finalize() {
+    this->nRows = this->rows.size();
+    this->nEntries = this->cols.size();
+
+    std::vector<PetscInt> rs(this->rowStart);
+    rs.push_back((PetscInt)this->nEntries);
+
+    this->d_rowStart = Device::AllocateDevice<PetscInt>(this->nRows+1);
+    Device::CopyToDevice(this->d_rowStart, rs.data(), this->nRows+1);
+
+    if (this->nEntries > 0) {
+        this->d_delta = Device::AllocateDevice<PetscInt>(this->nEntries);
+        this->d_array = Device::AllocateDevice<int>(this->nEntries);
+        this->d_deltaArray = Device::AllocateDevice<int>(this->nEntries);
+        this->d_coef = Device::AllocateDevice<len_t>(this->nEntries);
+        this->d_weight = Device::AllocateDevice<real_t>(this->nEntries);
+
+        Device::CopyToDevice(this->d_delta, this->delta.data(), this->nEntries);
+        Device::CopyToDevice(this->d_array, this->array.data(), this->nEntries);
+        Device::CopyToDevice(this->d_deltaArray, this->deltaArray.data(), this->nEntries);
+        Device::CopyToDevice(this->d_coef, this->coef.data(), this->nEntries);
+        Device::CopyToDevice(this->d_weight, this->weight.data(), this->nEntries);
+    }
+
+    this->finalized = true;
+}
+
+/**
+ * Returns the locations (on the device) in the value array of the
+ * given matrix of the elements of all stencil entries.
+ */
+struct DeviceStencil::device_slots *DeviceStencil::GetDeviceSlots(const Matrix *mat) {
+    struct device_slots *ds = nullptr;
+    for (struct device_slots &d : this->deviceSlots)
+        if (d.mat == mat)
+            ds = &d;
+
+    if (ds == nullptr) {
+        this->deviceSlots.push_back({mat, 0, 0, 0, 0, Device::AllocateDevice<PetscInt>(this->nEntries)});
+        ds = &this->deviceSlots.back();
+    } else if (
+        ds->csrRevision == mat->GetCSRRevision() &&
+        ds->rowOffset == mat->GetRowOffset() &&
+        ds->colOffset == mat->GetColOffset()
+    )
+        return ds;
+
+    std::vector<PetscInt> s(this->nEntries);
+    len_t nMissing = 0;
+    for (len_t r = 0; r < this->nRows; r++) {
+        const len_t e1 = (r+1 < this->nRows ? (len_t)this->rowStart[r+1] : this->nEntries);
+        for (len_t e = this->rowStart[r]; e < e1; e++) {
+            s[e] = mat->GetCSRIndex(this->rows[r], this->cols[e]);
+            if (s[e] < 0)
+                nMissing++;
+        }
+    }
+
+    Device::CopyToDevice(ds->slots, s.data(), this->nEntries);
+
+    ds->csrRevision = mat->GetCSRRevision();
+    ds->rowOffset = mat->GetRowOffset();
+    ds->colOffset = mat->GetColOffset();
+    ds->nMissing = nMissing;
+
+    return ds;
+}
+
+/**
+ * Add the elements of the stencil to the given matrix from a kernel
+ * on the device, if the matrix supports device assembly.
+ *
+ * mat:    Matrix to add elements to.
+ * c:      Coefficient arrays (indexed by the 'array' of each entry).
+ * deltas: Interpolation coefficient arrays (indexed by the
+ *         'deltaArray' of each entry).
+ *
+ * RETURNS false if the elements must instead be set on the host.
+ */
+bool DeviceStencil::Apply(Matrix *mat, const struct arrays &c, const struct arrays &deltas) {
+    if (!Device::IsEnabled())
+        return false;
+
+    PetscScalar *values = mat->BeginDeviceAssembly();
+    if (values == nullptr)
+        return false;
+
+    if (!this->finalized)
+        this->Finalize();
+
+    const struct device_slots *ds = this->GetDeviceSlots(mat);
+    const PetscInt *slots = ds->slots, *rs = this->d_rowStart, *dl = this->d_delta;
+    const int *arr = this->d_array, *da = this->d_deltaArray;
+    const len_t *ci = this->d_coef;
+    const real_t *w = this->d_weight;
+
+    auto value = DREAM_DEVICE_LAMBDA (const PetscInt e) -> real_t {
+        const real_t C = c.p[arr[e]][ci[e]];
+        if (C == 0)
+            return 0;
+        else if (dl[e] < 0)
+            return w[e]*C;
+        else
+            return w[e]*C*deltas.p[da[e]][dl[e]];
+    };
+
+    // Entries outside of the structure of the matrix can only be
+    // skipped if they do not contribute
+    if (ds->nMissing > 0) {
+        const bool missing = Device::Any(this->nEntries, DREAM_DEVICE_LAMBDA (const len_t e) -> bool {
+            return (slots[e] < 0 && value(e) != 0);
+        });
+
+        if (missing)
+            return false;
+    }
+
+    Device::For(this->nRows, DREAM_DEVICE_LAMBDA (const len_t r) {
+        for (PetscInt e = rs[r]; e < rs[r+1]; e++) {
+            if (slots[e] >= 0)
+                values[slots[e]] += value(e);
+        }
+    });
+
+    return true;
+}
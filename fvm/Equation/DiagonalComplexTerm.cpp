@@ -100,6 +100,16 @@ void DiagonalComplexTerm::SetVectorElements(real_t *vec, const real_t *x) {
     });
 }
 
+/**
+ * Add the diagonal matrix elements of this term to 'diag'
+ * (only valid for terms which are 'IsFusable()').
+ */
+void DiagonalComplexTerm::AddToDiagonal(real_t *diag) {
+    const len_t N = this->grid->GetNCells();
+    for (len_t i = 0; i < N; i++)
+        diag[i] += weights[i];
+}
+
 /**
  * Internal routine for setting matrix/vector elements.
  */
@@ -45,6 +45,15 @@ void DiagonalLinearTerm::SetVectorElements(real_t *vec, const real_t *x) {
         vec[i] += weights[i] * x[i];
 }
 
+/**
+ * Add the diagonal matrix elements of this term to 'diag'.
+ */
+void DiagonalLinearTerm::AddToDiagonal(real_t *diag) {
+    len_t N = this->grid->GetNCells();
+    for (len_t i = 0; i < N; i++)
+        diag[i] += weights[i];
+}
+
 /**
  * Transform the given input vector 'vec' so as to solve for
  * the value of the unknown quantity operated on by this
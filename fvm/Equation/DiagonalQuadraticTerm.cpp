@@ -81,6 +81,17 @@ void DiagonalQuadraticTerm::SetVectorElements(real_t *vec, const real_t *x) {
             vec[i] += weights[n*N+i] * y[n*N+i] * x[i];
 }
 
+/**
+ * Add the diagonal matrix elements of this term to 'diag'.
+ */
+void DiagonalQuadraticTerm::AddToDiagonal(real_t *diag) {
+    len_t N = this->DiagonalTerm::grid->GetNCells();
+    real_t *y = unknowns->GetUnknownData(wUqtyId);
+    for (len_t i = 0; i < N; i++)
+        for(len_t n=0; n<wUqtyNMultiples; n++)
+            diag[i] += weights[n*N+i] * y[n*N+i];
+}
+
 /**
  * Transform the given input vector 'vec' so as to solve for
  * the value of the unknown quantity operated on by this
@@ -2,7 +2,9 @@
  * Implementation of a general diffusion term.
  */
 
+#include <algorithm>
 #include "FVM/config.h"
+#include "FVM/Device.hpp"
 #include "FVM/Equation/DiffusionTerm.hpp"
 #include "FVM/Grid/Grid.hpp"
 
@@ -60,11 +62,13 @@ void DiffusionTerm::AllocateCoefficients() {
         nElements_f2 += n1[i]*(n2[i]+1);
     }
 
-    this->drr[0] = new real_t[nElements_fr];
-    this->d11[0] = new real_t[nElements_f1];
-    this->d12[0] = new real_t[nElements_f1];
-    this->d22[0] = new real_t[nElements_f2];
-    this->d21[0] = new real_t[nElements_f2];
+    // (the coefficients are used in kernels on the
+    // device, see 'SetMatrixElementsDevice()')
+    this->drr[0] = Device::Allocate<real_t>(nElements_fr);
+    this->d11[0] = Device::Allocate<real_t>(nElements_f1);
+    this->d12[0] = Device::Allocate<real_t>(nElements_f1);
+    this->d22[0] = Device::Allocate<real_t>(nElements_f2);
+    this->d21[0] = Device::Allocate<real_t>(nElements_f2);
 
     for (len_t i = 1; i < nr; i++) {
         this->drr[i] = this->drr[i-1] + (n1[i-1]*n2[i-1]);
@@ -74,8 +78,8 @@ void DiffusionTerm::AllocateCoefficients() {
         this->d21[i] = this->d21[i-1] + (n1[i-1]*(n2[i-1]+1));
     }
 
-    // XXX Here we explicitly assume that n1[i] = n1[i+1]
-    // at all radii
+    // (the outermost radial flux grid point uses the momentum
+    // grid of the last cell, so that n1_{nr+1/2} = n1_{nr-1/2})
     this->drr[nr]  = this->drr[nr-1]  + (n1[nr-1]*n2[nr-1]);
 
     this->ResetCoefficients();
@@ -92,11 +96,28 @@ void DiffusionTerm::AllocateCoefficients() {
     }
 
     this->coefficientsShared = false;
+    this->deviceStencilValid = false;
 }
 
+/**
+ * Allocate differentiation coefficients. Terms which do not
+ * depend on any other unknown quantity have no differentiation
+ * coefficients, and no memory is allocated for them.
+ */
 void DiffusionTerm::AllocateDifferentiationCoefficients() {
+    AllocateDifferentiationCoefficients(GetMaxNumberOfMultiplesJacobian());
+}
+
+/**
+ * Allocate differentiation coefficients for the given
+ * number of multiples.
+ */
+void DiffusionTerm::AllocateDifferentiationCoefficients(const len_t nMultiples) {
     DeallocateDifferentiationCoefficients();
-    len_t nMultiples = GetMaxNumberOfMultiplesJacobian();
+    if (nMultiples == 0)
+        return;
+
+    this->nDiffMultiples = nMultiples;
 
     this->ddrr = new real_t*[(nr+1)*nMultiples];
     this->dd11 = new real_t*[nr*nMultiples];
@@ -137,8 +158,8 @@ void DiffusionTerm::AllocateDifferentiationCoefficients() {
             this->dd21[i+n*nr] = this->dd21[i-1+n*nr] + (n1[i-1]*(n2[i-1]+1));
         }
 
-        // XXX Here we explicitly assume that n1[i] = n1[i+1]
-        // at all radii
+        // (the outermost radial flux grid point uses the momentum
+        // grid of the last cell, so that n1_{nr+1/2} = n1_{nr-1/2})
         this->ddrr[nr+n*(nr+1)] = this->ddrr[nr-1+n*(nr+1)] + (n1[nr-1]*n2[nr-1]);
 
     }
@@ -151,23 +172,23 @@ void DiffusionTerm::AllocateDifferentiationCoefficients() {
  */
 void DiffusionTerm::DeallocateCoefficients() {
     if (drr != nullptr) {
-        delete [] drr[0];
+        Device::Free(drr[0]);
         delete [] drr;
     }
     if (d11 != nullptr) {
-        delete [] d11[0];
+        Device::Free(d11[0]);
         delete [] d11;
     }
     if (d12 != nullptr) {
-        delete [] d12[0];
+        Device::Free(d12[0]);
         delete [] d12;
     }
     if (d21 != nullptr) {
-        delete [] d21[0];
+        Device::Free(d21[0]);
         delete [] d21;
     }
     if (d22 != nullptr) {
-        delete [] d22[0];
+        Device::Free(d22[0]);
         delete [] d22;
     }
 
@@ -202,6 +223,10 @@ void DiffusionTerm::DeallocateDifferentiationCoefficients() {
 
     if(JacobianColumn != nullptr)
         delete [] JacobianColumn;
+
+    this->ddrr = this->dd11 = this->dd12 = this->dd21 = this->dd22 = nullptr;
+    this->JacobianColumn = nullptr;
+    this->nDiffMultiples = 0;
 }
 
 /**
@@ -238,6 +263,7 @@ void DiffusionTerm::SetCoefficients(
     this->deltaRadialFlux = delta;
 
     this->coefficientsShared = true;
+    this->deviceStencilValid = false;
 }
 
 /**
@@ -250,6 +276,8 @@ bool DiffusionTerm::GridRebuilt() {
     
     // TODO: find condition for when to allocate these
     this->AllocateDifferentiationCoefficients();
+
+    this->deviceStencilValid = false;
     
     // Do not re-build if our coefficients are owned by someone else
     if (this->coefficientsShared)
@@ -267,9 +295,8 @@ void DiffusionTerm::ResetCoefficients() {
         nr = this->grid->GetNr();
 
     for (len_t ir = 0; ir < nr+1; ir++) {
-        // XXX here we assume that all momentum grids are the same
-        const len_t np2 = this->grid->GetMomentumGrid(0)->GetNp2();
-        const len_t np1 = this->grid->GetMomentumGrid(0)->GetNp1();
+        const len_t np2 = this->grid->GetNp2_fr(ir);
+        const len_t np1 = this->grid->GetNp1_fr(ir);
 
         for (len_t j = 0; j < np2; j++)
             for (len_t i = 0; i < np1; i++)
@@ -303,16 +330,15 @@ void DiffusionTerm::ResetCoefficients() {
  * Set all differentiation coefficients to zero.
  */
 void DiffusionTerm::ResetDifferentiationCoefficients() {
-    len_t nMultiples = GetMaxNumberOfMultiplesJacobian();
+    const len_t nMultiples = this->nDiffMultiples;
 
     const len_t
         nr = this->grid->GetNr();
 
     for(len_t n=0; n<nMultiples; n++){
         for (len_t ir = 0; ir < nr+1; ir++) {
-            // XXX here we assume that all momentum grids are the same
-            const len_t np2 = this->grid->GetMomentumGrid(0)->GetNp2();
-            const len_t np1 = this->grid->GetMomentumGrid(0)->GetNp1();
+            const len_t np2 = this->grid->GetNp2_fr(ir);
+            const len_t np1 = this->grid->GetNp1_fr(ir);
 
             for (len_t j = 0; j < np2; j++)
                 for (len_t i = 0; i < np1; i++)
@@ -366,25 +392,105 @@ bool DiffusionTerm::SetJacobianBlock(
     * to this advection coefficient 
     */
     len_t nMultiples;
-    if(!HasJacobianContribution(derivId, &nMultiples))
+    if(!SetDifferentiationCoefficients(derivId, &nMultiples))
         return contributes;
     else
         contributes = true;
-    
+
+    SetJacobianContributions(nMultiples, jac, x);
+
+    return contributes;
+}
+
+/**
+ * Evaluate the differentiation coefficients of this term with
+ * respect to the unknown 'derivId'.
+ *
+ * derivId:    ID of the quantity with respect to which the
+ *             derivative is to be evaluated.
+ * nMultiples: On return, contains the number of multiples of
+ *             the unknown 'derivId'.
+ *
+ * RETURNS false if this term does not depend on 'derivId'.
+ */
+bool DiffusionTerm::SetDifferentiationCoefficients(const len_t derivId, len_t *nMultiples) {
+    if (!HasJacobianContribution(derivId, nMultiples))
+        return false;
+
     // TODO: allocate differentiation coefficients in a more logical location
-    if(dd11 == nullptr)
+    if (this->nDiffMultiples < *nMultiples)
         AllocateDifferentiationCoefficients();
 
-    // Set partial advection coefficients for this advection term 
-    SetPartialDiffusionTerm(derivId, nMultiples);
+    // Set partial diffusion coefficients for this diffusion term
+    SetPartialDiffusionTerm(derivId, *nMultiples);
+
+    return true;
+}
+
+/**
+ * Sum the differentiation coefficients of the given terms, and
+ * store the result in the differentiation coefficients of this
+ * term. This allows the jacobian contributions of several terms
+ * depending on the same unknown to be set in a single pass.
+ *
+ * terms: List of terms, and the number of multiples of the unknown
+ *        for which their differentiation coefficients have been set.
+ */
+void DiffusionTerm::SumDifferentiationCoefficients(
+    const std::vector<std::pair<DiffusionTerm*, len_t>>& terms
+) {
+    len_t nMultiples = 0;
+    for (auto &t : terms)
+        nMultiples = std::max(nMultiples, t.second);
 
+    if (this->nDiffMultiples < nMultiples)
+        AllocateDifferentiationCoefficients(nMultiples);
+    else
+        ResetDifferentiationCoefficients();
+
+    len_t
+        nElements_fr = n1[nr-1]*n2[nr-1],
+        nElements_f1 = 0,
+        nElements_f2 = 0;
+
+    for (len_t i = 0; i < nr; i++) {
+        nElements_fr += n1[i]*n2[i];
+        nElements_f1 += (n1[i]+1)*n2[i];
+        nElements_f2 += n1[i]*(n2[i]+1);
+    }
+
+    for (auto &t : terms) {
+        const DiffusionTerm *dt = t.first;
+        for (len_t n = 0; n < t.second; n++) {
+            for (len_t i = 0; i < nElements_fr; i++)
+                this->ddrr[n*(nr+1)][i] += dt->ddrr[n*(nr+1)][i];
+            for (len_t i = 0; i < nElements_f1; i++) {
+                this->dd11[n*nr][i] += dt->dd11[n*nr][i];
+                this->dd12[n*nr][i] += dt->dd12[n*nr][i];
+            }
+            for (len_t i = 0; i < nElements_f2; i++) {
+                this->dd21[n*nr][i] += dt->dd21[n*nr][i];
+                this->dd22[n*nr][i] += dt->dd22[n*nr][i];
+            }
+        }
+    }
+}
+
+/**
+ * Set the jacobian contributions corresponding to the current
+ * differentiation coefficients of this term.
+ *
+ * nMultiples: Number of multiples of the unknown with respect to
+ *             which the differentiation coefficients were evaluated.
+ * jac:        Jacobian matrix block to populate.
+ * x:          Value of the unknown quantity.
+ */
+void DiffusionTerm::SetJacobianContributions(const len_t nMultiples, Matrix *jac, const real_t *x) {
     for(len_t n=0; n<nMultiples; n++){
         SetPartialJacobianContribution(0, JACOBIAN_SET_CENTER, n, jac, x);
         SetPartialJacobianContribution(-1,JACOBIAN_SET_LOWER, n, jac, x);
         SetPartialJacobianContribution(+1,JACOBIAN_SET_UPPER, n, jac, x);
     }
-
-    return contributes;
 }
 
 /**
@@ -428,13 +534,193 @@ void DiffusionTerm::ResetJacobianColumn(){
  * rhs: Right-hand-side of equation (not side).
  */
 void DiffusionTerm::SetMatrixElements(Matrix *mat, real_t*) {
+    if (this->SetMatrixElementsDevice(mat))
+        return;
+
     jacobian_interp_mode set = NO_JACOBIAN;
-    #define f(K,I,J,V) mat->SetElement(offset+j*np1+i, offset + ((K)-ir)*np2*np1 + (J)*np1 + (I), (V))
+    #define f(K,I,J,V) mat->SetElement(offset+j*np1+i, grid->GetCellOffset(K) + (J)*n1[K] + (I), (V))
+    #define BeginRow()
+    #define EndRow()
     #   include "DiffusionTerm.set.cpp"
+    #undef EndRow
+    #undef BeginRow
     #undef f
 }
 
 
+/**
+ * Construct the stencil of this term applied on the device (see
+ * 'DeviceStencil'). This reproduces the matrix elements set by
+ * 'DiffusionTerm.set.cpp' (without jacobian contributions), for grids
+ * with the same momentum grid at all radii and without mirrored
+ * trapped regions.
+ *
+ * RETURNS false if the stencil can not be applied on the device.
+ */
+bool DiffusionTerm::BuildDeviceStencil() {
+    enum { C_RR, C_11, C_12, C_21, C_22 };
+
+    this->deviceStencil.Clear();
+    if (!grid->HasRadiallyUniformMomentumGrid())
+        return false;
+
+    const len_t nr = grid->GetNr();
+    for (len_t ir = 0; ir < nr; ir++)
+        for (len_t j = 0; j < grid->GetMomentumGrid(ir)->GetNp2(); j++)
+            if (grid->IsNegativePitchTrappedIgnorableCell(ir,j) ||
+                grid->IsNegativePitchTrappedIgnorableRadialFluxCell(ir,j))
+                return false;
+
+    const real_t
+        *dr   = grid->GetRadialGrid()->GetDr(),
+        *dr_f = grid->GetRadialGrid()->GetDr_f();
+    DeviceStencil &s = this->deviceStencil;
+
+    len_t offset = 0;
+    for (len_t ir = 0; ir < nr; ir++) {
+        const MomentumGrid *mg = grid->GetMomentumGrid(ir);
+        const len_t np1 = mg->GetNp1(), np2 = mg->GetNp2();
+        const real_t
+            *Vp     = grid->GetVp(ir),
+            *Vp_fr  = grid->GetVp_fr(ir),
+            *Vp_fr1 = grid->GetVp_fr(ir+1),
+            *Vp_f1  = grid->GetVp_f1(ir),
+            *Vp_f2  = grid->GetVp_f2(ir),
+            *dp1    = mg->GetDp1(),
+            *dp2    = mg->GetDp2(),
+            *dp1_f  = mg->GetDp1_f(),
+            *dp2_f  = mg->GetDp2_f();
+
+        const len_t
+            orr  = drr[ir] - drr[0],
+            orr1 = drr[ir+1] - drr[0],
+            o11  = d11[ir] - d11[0],
+            o12  = d12[ir] - d12[0],
+            o21  = d21[ir] - d21[0],
+            o22  = d22[ir] - d22[0];
+
+        // Column of cell (I,J) at radius K
+        #define COL(K,I,J) (grid->GetCellOffset(K) + (J)*np1 + (I))
+        // Index of a coefficient on the p1 and p2 flux grids
+        #define IDX1(I,J) ((J)*(np1+1) + (I))
+        #define IDX2(I,J) ((J)*np1 + (I))
+
+        for (len_t j = 0; j < np2; j++) {
+            for (len_t i = 0; i < np1; i++) {
+                const len_t c = j*np1+i;
+                s.BeginRow(offset + c);
+                real_t S;
+
+                // Radius
+                if (ir > 0) {
+                    S = Vp_fr[c] / (dr[ir]*dr_f[ir-1]*Vp[c]);
+                    s.Add(COL(ir-1,i,j), C_RR, orr+c, -S);
+                    s.Add(COL(ir,  i,j), C_RR, orr+c, +S);
+                }
+                if (ir < nr-1) {
+                    S = Vp_fr1[c] / (dr[ir]*dr_f[ir]*Vp[c]);
+                    s.Add(COL(ir,  i,j), C_RR, orr1+c, +S);
+                    s.Add(COL(ir+1,i,j), C_RR, orr1+c, -S);
+                }
+
+                // Momentum 1/1
+                if (i > 0) {
+                    S = Vp_f1[IDX1(i,j)] / (dp1[i]*dp1_f[i-1]*Vp[c]);
+                    s.Add(COL(ir,i-1,j), C_11, o11+IDX1(i,j), -S);
+                    s.Add(COL(ir,i,  j), C_11, o11+IDX1(i,j), +S);
+                }
+                if (i < np1-1) {
+                    S = Vp_f1[IDX1(i+1,j)] / (dp1[i]*dp1_f[i]*Vp[c]);
+                    s.Add(COL(ir,i+1,j), C_11, o11+IDX1(i+1,j), -S);
+                    s.Add(COL(ir,i,  j), C_11, o11+IDX1(i+1,j), +S);
+                }
+
+                // Momentum 2/2
+                if (j > 0) {
+                    S = Vp_f2[IDX2(i,j)] / (dp2[j]*dp2_f[j-1]*Vp[c]);
+                    s.Add(COL(ir,i,j),   C_22, o22+IDX2(i,j), +S);
+                    s.Add(COL(ir,i,j-1), C_22, o22+IDX2(i,j), -S);
+                }
+                if (j < np2-1) {
+                    S = Vp_f2[IDX2(i,j+1)] / (dp2[j]*dp2_f[j]*Vp[c]);
+                    s.Add(COL(ir,i,j+1), C_22, o22+IDX2(i,j+1), -S);
+                    s.Add(COL(ir,i,j),   C_22, o22+IDX2(i,j+1), +S);
+                }
+
+                // Momentum 1/2
+                if (j > 0 && j < np2-1) {
+                    if (i > 0) {
+                        S = Vp_f1[IDX1(i,j)] / (dp1[i]*(dp2_f[j]+dp2_f[j-1])*Vp[c]);
+                        s.Add(COL(ir,i,  j+1), C_12, o12+IDX1(i,j), +S);
+                        s.Add(COL(ir,i-1,j+1), C_12, o12+IDX1(i,j), +S);
+                        s.Add(COL(ir,i,  j-1), C_12, o12+IDX1(i,j), -S);
+                        s.Add(COL(ir,i-1,j-1), C_12, o12+IDX1(i,j), -S);
+                    }
+                    if (i < np1-1) {
+                        S = Vp_f1[IDX1(i+1,j)] / (dp1[i]*(dp2_f[j]+dp2_f[j-1])*Vp[c]);
+                        s.Add(COL(ir,i+1,j+1), C_12, o12+IDX1(i+1,j), -S);
+                        s.Add(COL(ir,i,  j+1), C_12, o12+IDX1(i+1,j), -S);
+                        s.Add(COL(ir,i+1,j-1), C_12, o12+IDX1(i+1,j), +S);
+                        s.Add(COL(ir,i,  j-1), C_12, o12+IDX1(i+1,j), +S);
+                    }
+                }
+
+                // Momentum 2/1
+                if (i > 0 && i < np1-1) {
+                    if (j > 0) {
+                        S = Vp_f2[IDX2(i,j)] / (dp2[j]*(dp1_f[i]+dp1_f[i-1])*Vp[c]);
+                        s.Add(COL(ir,i+1,j-1), C_21, o21+IDX2(i,j), +S);
+                        s.Add(COL(ir,i+1,j),   C_21, o21+IDX2(i,j), +S);
+                        s.Add(COL(ir,i-1,j-1), C_21, o21+IDX2(i,j), -S);
+                        s.Add(COL(ir,i-1,j),   C_21, o21+IDX2(i,j), -S);
+                    }
+                    if (j < np2-1) {
+                        S = Vp_f2[IDX2(i,j+1)] / (dp2[j]*(dp1_f[i]+dp1_f[i-1])*Vp[c]);
+                        s.Add(COL(ir,i+1,j+1), C_21, o21+IDX2(i,j+1), -S);
+                        s.Add(COL(ir,i+1,j),   C_21, o21+IDX2(i,j+1), -S);
+                        s.Add(COL(ir,i-1,j+1), C_21, o21+IDX2(i,j+1), +S);
+                        s.Add(COL(ir,i-1,j),   C_21, o21+IDX2(i,j+1), +S);
+                    }
+                }
+            }
+        }
+
+        #undef IDX2
+        #undef IDX1
+        #undef COL
+
+        offset += np1*np2;
+    }
+
+    return true;
+}
+
+/**
+ * Set the matrix elements of this term from a kernel on the device,
+ * if the matrix supports device assembly.
+ *
+ * RETURNS false if the elements must instead be set on the host.
+ */
+bool DiffusionTerm::SetMatrixElementsDevice(Matrix *mat) {
+    if (!Device::IsEnabled())
+        return false;
+
+    if (!this->deviceStencilValid) {
+        this->deviceStencilSupported = this->BuildDeviceStencil();
+        this->deviceStencilValid = true;
+    }
+
+    if (!this->deviceStencilSupported)
+        return false;
+
+    const DeviceStencil::arrays
+        c = {{ drr[0], d11[0], d12[0], d21[0], d22[0] }},
+        d = {{ nullptr, nullptr, nullptr, nullptr, nullptr }};
+
+    return this->deviceStencil.Apply(mat, c, d);
+}
+
+
 /**
  * Instead of building a linear operator (matrix) to apply to a vector
  * 'x', this routine builds immediately the resulting vector.
@@ -456,9 +742,16 @@ void DiffusionTerm::SetVectorElements(
     const real_t *const* d21 ,const real_t *const* d22,
     jacobian_interp_mode set
 ) {
-    #define f(K,I,J,V) vec[offset+j*np1+i] += (V)*x[offset+((K)-ir)*np2*np1 + (J)*np1 + (I)]
+    // (the contributions to each element of 'vec' are summed in a
+    // local variable, since the compiler must otherwise assume that
+    // 'vec' may alias 'x' and write each contribution to memory)
+    #define BeginRow() real_t rowValue = 0
+    #define f(K,I,J,V) rowValue += (V)*x[grid->GetCellOffset(K) + (J)*n1[K] + (I)]
+    #define EndRow() vec[offset+j*np1+i] += rowValue
     #   include "DiffusionTerm.set.cpp"
+    #undef EndRow
     #undef f
+    #undef BeginRow
 }
 
 
@@ -472,8 +765,23 @@ void DiffusionTerm::SaveCoefficientsSFile(const std::string& filename) {
     sf->Close();
 }
 void DiffusionTerm::SaveCoefficientsSFile(SFile *sf) {
+    // With different momentum grids at different radii, the
+    // coefficients are saved as flat lists
+    if (!this->grid->HasRadiallyUniformMomentumGrid()) {
+        if (this->drr != nullptr)
+            sf->WriteList("Drr", this->drr[0], this->grid->GetNCells_fr());
+        if (this->d21 != nullptr)
+            sf->WriteList("D21", this->d21[0], this->grid->GetNCells_f2());
+        if (this->d22 != nullptr)
+            sf->WriteList("D22", this->d22[0], this->grid->GetNCells_f2());
+        if (this->d12 != nullptr)
+            sf->WriteList("D12", this->d12[0], this->grid->GetNCells_f1());
+        if (this->d11 != nullptr)
+            sf->WriteList("D11", this->d11[0], this->grid->GetNCells_f1());
+        return;
+    }
+
     sfilesize_t dims[3];
-    // XXX here we assume that all momentum grids are the same
     const sfilesize_t
         nr = this->grid->GetNr(),
         n1 = this->grid->GetMomentumGrid(0)->GetNp1(),
@@ -1,6 +1,15 @@
 /**
  * Implementation of a general 'SetXXX()' routine for the
  * FVM DiffusionTerm.
+ *
+ * All elements 'f' on one matrix row (i.e. in cell (ir,i,j))
+ * are set between the 'BeginRow()' and 'EndRow()' macros,
+ * which allows the row to be accumulated locally.
+ *
+ * As in 'AdvectionTerm.set.cpp', the radial fluxes between radii
+ * using different momentum grids are evaluated on the momentum grid
+ * of the radial flux grid point, and the flux through the outer face
+ * of the cell is distributed conservatively over the cells covering it.
  */
 
 // void DiffusionTerm::SetXXX(f) {
@@ -11,14 +20,28 @@
     const real_t
         *dr   = grid->GetRadialGrid()->GetDr(),
         *dr_f = grid->GetRadialGrid()->GetDr_f();
+
+    // Adds the contribution 'V' multiplying the unknown at radius K,
+    // evaluated in cell (A,B) of the momentum grid 'MG'
+    #define XR(K,A,B,MG,V) \
+        if (grid->GetMomentumGrid(K) == (MG)) f((K),(A),(B),(V)); \
+        else grid->GetMomentumGridMapping(grid->GetMomentumGrid(K), (MG))->ForEachOverlap( \
+            (A), (B), [&](const len_t c_, const len_t d_, const real_t W_, const real_t) \
+                { f((K),c_,d_,W_*(V)); } \
+        )
     
     // Iterate over interior radial grid points
     for (len_t ir = 0; ir < nr; ir++) {
-        const MomentumGrid *mg = grid->GetMomentumGrid(ir);
+        const MomentumGrid
+            *mg   = grid->GetMomentumGrid(ir),
+            *mg_o = grid->GetMomentumGrid_fr(ir+1);
+        const MomentumGridMapping *map_o =
+            grid->GetMomentumGridMapping(mg_o, mg);
 
         const len_t
             np1 = mg->GetNp1(),
-            np2 = mg->GetNp2();
+            np2 = mg->GetNp2(),
+            np1_o = mg_o->GetNp1();
 
         const real_t
             *Vp     = grid->GetVp(ir),
@@ -29,7 +52,9 @@
             *dp1    = mg->GetDp1(),
             *dp2    = mg->GetDp2(),
             *dp1_f  = mg->GetDp1_f(),
-            *dp2_f  = mg->GetDp2_f();
+            *dp2_f  = mg->GetDp2_f(),
+            *dp1_o  = mg_o->GetDp1(),
+            *dp2_o  = mg_o->GetDp2();
 
         for (len_t j = 0; j < np2; j++) {
             // Do not set terms in the negative trapped region where the 
@@ -39,6 +64,7 @@
             bool isNegativeTrappedRadial = grid->IsNegativePitchTrappedIgnorableRadialFluxCell(ir,j);
 
             for (len_t i = 0; i < np1; i++) {
+                BeginRow();
                 real_t S;
 
                 /////////////////////////
@@ -51,12 +77,14 @@
                 // diffusion coefficients should must be negative to get the correct
                 // sign on the diffusion term, which is why we use abs(Drr) here. 
                 // This should however probably be reworked in a better way...
-                if(!isNegativeTrappedRadial && ( abs(Drr(ir, i, j, drr)) || abs(Drr(ir+1, i, j, drr)) ) ){
-                    #define X(K,V) f((K),i,j,(V))
+                // (with a different momentum grid on the outer face, the
+                // coefficients on the face are checked individually below)
+                if(!isNegativeTrappedRadial && ( map_o != nullptr || abs(Drr(ir, i, j, drr)) || abs(Drr(ir+1, i, j, drr)) ) ){
+                    // (the inner face of the cell uses the same momentum
+                    // grid as the cell, while the outer face uses 'mg_o')
+                    #define X(K,V) XR((K),i,j,mg,(V))
                     // Phi^(r)_{k-1/2}
                     if (ir > 0) {
-                        // XXX: Here, we explicitly assume that the momentum grids are
-                        // the same at all radii, so that p at (ir, i, j) = p at (ir+1, i, j)
                         S = Drr(ir, i, j, drr)*Vp_fr[j*np1+i] / (dr[ir]*dr_f[ir-1]*Vp[j*np1+i]);
                         if(set==JACOBIAN_SET_LOWER)
                             S *= 1 - deltaRadialFlux[ir];
@@ -71,9 +99,25 @@
                     }
 
                     // Phi^(r)_{k+1/2}
-                    if (ir < nr-1) {
-                        // XXX: Here, we explicitly assume that the momentum grids are
-                        // the same at all radii, so that p at (ir, i, j) = p at (ir+1, i, j)
+                    if (ir < nr-1 && map_o != nullptr) {
+                        // Flux through the cells (a,b) of the outer face which
+                        // overlap this cell, each contributing with the fraction
+                        // R of its flux
+                        map_o->ForEachOverlap(i, j, [&](const len_t a, const len_t b, const real_t, const real_t R) {
+                            real_t S_o = R * Drr(ir+1, a, b, drr)*Vp_fr1[b*np1_o+a]*dp1_o[a]*dp2_o[b]
+                                / (dr[ir]*dr_f[ir]*Vp[j*np1+i]*dp1[i]*dp2[j]);
+
+                            if(set==JACOBIAN_SET_LOWER)
+                                S_o = 0;
+                            else if(set==JACOBIAN_SET_CENTER)
+                                S_o *= 1 - deltaRadialFlux[ir+1];
+                            else if(set==JACOBIAN_SET_UPPER)
+                                S_o *= deltaRadialFlux[ir+1];
+
+                            XR(ir,   a, b, mg_o, +S_o);
+                            XR(ir+1, a, b, mg_o, -S_o);
+                        });
+                    } else if (ir < nr-1) {
                         S = Drr(ir+1, i, j, drr)*Vp_fr1[j*np1+i] / (dr[ir]*dr_f[ir]*Vp[j*np1+i]);
 
                         if(set==JACOBIAN_SET_LOWER)
@@ -88,8 +132,10 @@
                     }
                     #undef X
                 }
-                if(set==JACOBIAN_SET_LOWER || set==JACOBIAN_SET_UPPER)
+                if(set==JACOBIAN_SET_LOWER || set==JACOBIAN_SET_UPPER) {
+                    EndRow();
                     continue;
+                }
                 
                 #define X(I,J,V) f(ir,(I),(J),(V))
                 /////////////////////////
@@ -169,8 +215,12 @@
                 }
                 
                 #undef X
+
+                EndRow();
             }
         }
 
         offset += np1*np2;
     }
+
+    #undef XR
@@ -56,6 +56,7 @@ void EquationTerm::DeallocateMemory() {
  */
 bool EquationTerm::GridRebuilt() {
     this->AllocateMemory();
+    this->InvalidateRebuild();
 
     return true;
 }
@@ -80,3 +81,62 @@ bool EquationTerm::HasJacobianContribution(len_t derivId, len_t *nMultiples) {
     return hasDerivIdContribution;
 }
 
+
+/**
+ * Returns 'true' if the coefficients of this term must be rebuilt
+ * for the given time. Unless the term has declared its inputs (via
+ * 'SetRebuildInputs()' or 'AddUnknownForRebuild()'), this is always
+ * the case. Otherwise, the term is rebuilt if the grid has been
+ * rebuilt, if the time or time step has changed (for time-dependent
+ * terms), or if any of the input unknowns have changed.
+ *
+ * t:    Time for which the term is to be rebuilt.
+ * dt:   Length of time step to take next.
+ * uqty: List of unknown quantities.
+ */
+bool EquationTerm::NeedsRebuild(
+    const real_t t, const real_t dt, UnknownQuantityHandler *uqty
+) const {
+    if (!this->rebuildInputsDeclared || this->rebuildPending)
+        return true;
+
+    if (this->rebuildTimeDependent && (t != this->rebuildTime || dt != this->rebuildTimeStep))
+        return true;
+
+    for (len_t id : this->rebuildInputs)
+        if (uqty->HasChanged(id))
+            return true;
+
+    return false;
+}
+
+/**
+ * Rebuild this term, unless none of its inputs have changed
+ * since the previous rebuild.
+ *
+ * RETURNS 'true' if the term was rebuilt.
+ */
+bool EquationTerm::RebuildIfNeeded(
+    const real_t t, const real_t dt, UnknownQuantityHandler *uqty
+) {
+    if (!NeedsRebuild(t, dt, uqty)) {
+        this->nRebuildsSkipped++;
+        return false;
+    }
+
+    this->Rebuild(t, dt, uqty);
+    this->SetRebuilt(t, dt);
+    this->nRebuilds++;
+
+    return true;
+}
+
+/**
+ * Record that this term has been rebuilt for the given time
+ * and time step.
+ */
+void EquationTerm::SetRebuilt(const real_t t, const real_t dt) {
+    this->rebuildPending = false;
+    this->rebuildTime = t;
+    this->rebuildTimeStep = dt;
+}
@@ -0,0 +1,160 @@
+/**
+ * Evaluation of several moments of the same distribution function in a
+ * single pass over the distribution.
+ *
+ * Each moment of a distribution function (density, current density,
+ * kinetic energy, ...) is a separate 'MomentQuantity', and evaluating
+ * them one at a time streams the (large) distribution function through
+ * memory once per moment. Moments which have opted in to fused
+ * evaluation (see 'MomentQuantity::EnableFusedEvaluation()') instead
+ * share one of these objects, which evaluates all of them together the
+ * first time any of them is requested, sweeping over the distribution
+ * one radial grid point at a time, so that the part of the distribution
+ * being integrated stays in cache while the quadrature weights of all
+ * moments are applied to it. The values are reused by the remaining
+ * moments for as long as the distribution function and the quadrature
+ * weights are unchanged.
+ */
+
+#include <map>
+#include <tuple>
+#include "FVM/Equation/FusedMomentEvaluator.hpp"
+#include "FVM/Equation/MomentQuantity.hpp"
+
+
+using namespace DREAM::FVM;
+using namespace std;
+
+
+/**
+ * Constructor.
+ *
+ * fGrid: Grid on which the distribution function is defined.
+ * fId:   ID of the distribution function.
+ * u:     List of unknown quantities.
+ */
+FusedMomentEvaluator::FusedMomentEvaluator(
+    Grid *fGrid, const len_t fId, UnknownQuantityHandler *u
+) : fGrid(fGrid), fId(fId), unknowns(u) { }
+
+/**
+ * Returns the evaluator shared by all moments of the given
+ * distribution function. The evaluator is created when the first
+ * moment requests it, and is destroyed together with the last
+ * moment using it.
+ */
+shared_ptr<FusedMomentEvaluator> FusedMomentEvaluator::Get(
+    Grid *fGrid, const len_t fId, UnknownQuantityHandler *u
+) {
+    static map<tuple<Grid*, len_t, UnknownQuantityHandler*>, weak_ptr<FusedMomentEvaluator>> registry;
+
+    // Forget evaluators which are no longer in use
+    for (auto it = registry.begin(); it != registry.end();) {
+        if (it->second.expired())
+            it = registry.erase(it);
+        else
+            it++;
+    }
+
+    auto key = make_tuple(fGrid, fId, u);
+    auto it = registry.find(key);
+    if (it != registry.end())
+        return it->second.lock();
+
+    shared_ptr<FusedMomentEvaluator> e = make_shared<FusedMomentEvaluator>(fGrid, fId, u);
+    registry[key] = e;
+
+    return e;
+}
+
+
+/**
+ * Add a moment to be evaluated by this object.
+ *
+ * RETURNS the index of the moment (to pass to 'GetMoment()').
+ */
+len_t FusedMomentEvaluator::Add(MomentQuantity *mq) {
+    this->moments.push_back(mq);
+    this->weightsRevision.push_back(0);
+    this->valid = false;
+
+    return this->moments.size()-1;
+}
+
+/**
+ * Remove a moment from this object (e.g. when it is destroyed).
+ * The indices of the remaining moments are unchanged.
+ */
+void FusedMomentEvaluator::Remove(MomentQuantity *mq) {
+    for (len_t m = 0; m < this->moments.size(); m++)
+        if (this->moments[m] == mq)
+            this->moments[m] = nullptr;
+}
+
+
+/**
+ * (private)
+ * Evaluate all moments for the given distribution function, unless
+ * they have already been evaluated for its current value.
+ *
+ * f: Distribution function (data of the unknown quantity 'fId').
+ */
+void FusedMomentEvaluator::Evaluate(const real_t *f) {
+    const len_t nr = this->fGrid->GetNr();
+    const len_t nm = this->moments.size();
+    const len_t version = this->unknowns->GetVersion(this->fId);
+
+    bool changed = (!this->valid || f != this->evaluatedF || version != this->evaluatedVersion);
+    for (len_t m = 0; m < nm; m++) {
+        MomentQuantity *mq = this->moments[m];
+        if (mq == nullptr)
+            continue;
+
+        mq->UpdateWeights();
+        if (mq->weightsRevision != this->weightsRevision[m]) {
+            this->weightsRevision[m] = mq->weightsRevision;
+            changed = true;
+        }
+    }
+
+    if (!changed)
+        return;
+
+    this->values.resize(nm*nr);
+    for (len_t ir = 0; ir < nr; ir++) {
+        for (len_t m = 0; m < nm; m++) {
+            const MomentQuantity *mq = this->moments[m];
+            if (mq == nullptr)
+                continue;
+
+            const len_t k0 = mq->weightsFirst[ir], n = mq->weightsLength[ir];
+            const real_t
+                *w  = mq->weights + k0,
+                *in = mq->integrand + k0,
+                *fk = f + k0;
+
+            real_t VAL = 0;
+            #pragma omp simd reduction(+:VAL)
+            for (len_t k = 0; k < n; k++)
+                VAL += w[k] * in[k] * fk[k];
+
+            this->values[m*nr + ir] = VAL;
+        }
+    }
+
+    this->evaluatedF = f;
+    this->evaluatedVersion = version;
+    this->valid = true;
+}
+
+/**
+ * Returns the values of the specified moment of the given
+ * distribution function, in all radial grid points.
+ *
+ * m: Index of the moment (as returned by 'Add()').
+ * f: Distribution function (data of the unknown quantity 'fId').
+ */
+const real_t *FusedMomentEvaluator::GetMoment(const len_t m, const real_t *f) {
+    this->Evaluate(f);
+    return this->values.data() + m*this->fGrid->GetNr();
+}
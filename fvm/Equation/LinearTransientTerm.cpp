@@ -26,8 +26,8 @@ LinearTransientTerm::LinearTransientTerm(Grid *grid, const len_t unknownId)
  * dt: Length of next time step to take.
  */
 void LinearTransientTerm::Rebuild(const real_t, const real_t dt, UnknownQuantityHandler *uqty) {
-    this->dt = dt;
-    this->xn = uqty->GetUnknownDataPrevious(this->unknownId);
+    this->dt = uqty->GetTransientTimeStep(dt);
+    this->xn = uqty->GetUnknownDataTransientPrevious(this->unknownId, dt);
 
     if(!hasBeenInitialized){
         InitializeWeights();
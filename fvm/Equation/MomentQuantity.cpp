@@ -3,6 +3,7 @@
  * (such as the moment of a distribution function).
  */
 
+#include "FVM/Device.hpp"
 #include "FVM/Equation/MomentQuantity.hpp"
 #include "DREAM/Constants.hpp"
 #include "DREAM/Settings/OptionConstants.hpp"
@@ -34,7 +35,11 @@ MomentQuantity::MomentQuantity(
  * Destructor.
  */
 MomentQuantity::~MomentQuantity() {
-    delete [] this->integrand;
+    if (this->fused != nullptr)
+        this->fused->Remove(this);
+
+    DeallocateWeights();
+    Device::Free(this->integrand);
     delete [] this->diffIntegrand;
 }
 
@@ -45,20 +50,257 @@ MomentQuantity::~MomentQuantity() {
 bool MomentQuantity::GridRebuilt() {
     bool rebuilt = this->EquationTerm::GridRebuilt();
     const len_t N = this->fGrid->GetNCells();
-    if (this->nIntegrand != N) {
+
+    // The quadrature weights depend on the phase space
+    // jacobian, which may have changed
+    this->weightsValid = false;
+
+    if (this->nIntegrand != N || this->weightsNr != this->fGrid->GetNr()) {
         this->nIntegrand = N;
-        if(integrand != nullptr)
-            delete [] integrand;
-        this->integrand = new real_t[N];
+        // The integrand and weights are used in kernels on
+        // the device (see 'SetMatrixElementsDevice()')
+        Device::Free(this->integrand);
+        this->integrand = Device::Allocate<real_t>(N);
 
         if(GetMaxNumberOfMultiplesJacobian())
             AllocateDiffIntegrand();
 
+        AllocateWeights();
+
         return true;
     } else
         return rebuilt;   
 }
 
+/**
+ * Evaluate this moment together with all other moments of the same
+ * distribution function which have enabled fused evaluation, in a
+ * single pass over the distribution function (see
+ * 'FusedMomentEvaluator'). This requires that the integrand only
+ * changes when the grid is rebuilt.
+ */
+void MomentQuantity::EnableFusedEvaluation() {
+    if (this->fused != nullptr)
+        return;
+
+    this->fused = FusedMomentEvaluator::Get(this->fGrid, this->fId, this->unknowns);
+    this->fusedIndex = this->fused->Add(this);
+}
+
+/**
+ * Allocate memory for the quadrature weights.
+ */
+void MomentQuantity::AllocateWeights() {
+    DeallocateWeights();
+
+    const len_t nr = this->fGrid->GetNr();
+    const len_t N  = this->nIntegrand;
+
+    this->weightsNr      = nr;
+    this->weights        = Device::Allocate<real_t>(N);
+    this->weightsFirst   = new len_t[nr];
+    this->weightsLength  = new len_t[nr];
+    this->weightsTcold   = new real_t[nr];
+    this->weightsColumns = new PetscInt[N];
+    this->rowValues      = new PetscScalar[MomentQuantity::GetNumberOfNonZerosPerRow()];
+
+    for (len_t k = 0; k < N; k++)
+        this->weightsColumns[k] = k;
+}
+
+/**
+ * Free the memory used by the quadrature weights.
+ */
+void MomentQuantity::DeallocateWeights() {
+    if (this->weights == nullptr)
+        return;
+
+    delete [] this->rowValues;
+    delete [] this->weightsColumns;
+    delete [] this->weightsTcold;
+    delete [] this->weightsLength;
+    delete [] this->weightsFirst;
+    Device::Free(this->weights);
+
+    this->weights = nullptr;
+    this->weightsValid = false;
+
+    DeallocateDeviceSlots();
+}
+
+/**
+ * Free the element locations used for device assembly.
+ */
+void MomentQuantity::DeallocateDeviceSlots() {
+    for (struct device_slots &ds : this->deviceSlots)
+        Device::FreeDevice(ds.slots);
+
+    this->deviceSlots.clear();
+}
+
+/**
+ * Returns the locations (on the device) in the value array of
+ * the given matrix of the elements set by this moment, or
+ * 'nullptr' if some element is not part of the recorded non-zero
+ * structure of the matrix.
+ */
+const PetscInt *MomentQuantity::GetDeviceSlots(const Matrix *mat) {
+    const len_t N = this->nIntegrand;
+    struct device_slots *ds = nullptr;
+    for (struct device_slots &d : this->deviceSlots)
+        if (d.mat == mat)
+            ds = &d;
+
+    if (ds == nullptr) {
+        this->deviceSlots.push_back({mat, 0, 0, 0, 0, false, Device::AllocateDevice<PetscInt>(N)});
+        ds = &this->deviceSlots.back();
+    } else if (
+        ds->csrRevision == mat->GetCSRRevision() &&
+        ds->weightsRevision == this->weightsRevision &&
+        ds->rowOffset == mat->GetRowOffset() &&
+        ds->colOffset == mat->GetColOffset()
+    )
+        return (ds->complete ? ds->slots : nullptr);
+
+    std::vector<PetscInt> s(N, -1);
+    bool complete = true;
+    const len_t nr = fGrid->GetNr();
+    for (len_t ir = 0; ir < nr && complete; ir++) {
+        const len_t k0 = this->weightsFirst[ir], n = this->weightsLength[ir];
+        for (len_t k = k0; k < k0+n && complete; k++) {
+            s[k] = mat->GetCSRIndex(ir, this->weightsColumns[k]);
+            complete = (s[k] >= 0);
+        }
+    }
+
+    if (complete)
+        Device::CopyToDevice(ds->slots, s.data(), N);
+
+    ds->csrRevision = mat->GetCSRRevision();
+    ds->weightsRevision = this->weightsRevision;
+    ds->rowOffset = mat->GetRowOffset();
+    ds->colOffset = mat->GetColOffset();
+    ds->complete = complete;
+
+    return (complete ? ds->slots : nullptr);
+}
+
+/**
+ * Returns true if the threshold envelope of this moment
+ * depends on the cold electron temperature.
+ */
+bool MomentQuantity::ThresholdDependsOnTemperature() const {
+    if (!this->hasThreshold)
+        return false;
+
+    switch (this->pMode) {
+        case P_THRESHOLD_MODE_MIN_THERMAL:
+        case P_THRESHOLD_MODE_MIN_THERMAL_SMOOTH:
+        case P_THRESHOLD_MODE_MAX_THERMAL:
+        case P_THRESHOLD_MODE_MAX_THERMAL_SMOOTH:
+            return true;
+
+        default:
+            return false;
+    }
+}
+
+/**
+ * Evaluate the quadrature weights of the moment (which contain
+ * the phase space jacobian, the cell volumes, the limits of the
+ * xi integral and the threshold envelope). Only radial grid
+ * points for which the weights may have changed since the last
+ * evaluation are updated.
+ */
+void MomentQuantity::UpdateWeights() {
+    const bool dependsOnT = ThresholdDependsOnTemperature();
+    if (this->weightsValid && !dependsOnT)
+        return;
+
+    const len_t nr = fGrid->GetNr();
+    const real_t *Tcold = dependsOnT ? unknowns->GetUnknownData(id_Tcold) : nullptr;
+
+    bool updated = false;
+    len_t offset = 0;
+    for (len_t ir = 0; ir < nr; ir++) {
+        const FVM::MomentumGrid *mg = fGrid->GetMomentumGrid(ir);
+        const len_t np1 = mg->GetNp1();
+        const len_t np2 = mg->GetNp2();
+
+        if (this->weightsValid && Tcold[ir] == this->weightsTcold[ir]) {
+            offset += np1*np2;
+            continue;
+        }
+
+        const real_t *Vp = fGrid->GetVp(ir);
+        const real_t VpVol = fGrid->GetVpVol(ir);
+        const real_t
+            *dp1 = mg->GetDp1(),
+            *dp2 = mg->GetDp2();
+        const real_t *xi_f = mg->GetP2_f();
+
+        // Determine xi integration limits
+        // (note that since xi=0 may lie anywhere within a grid cell,
+        // we must properly adjust the first/last cell length to
+        // accurately correspond to the actual positive/negative part
+        // of the cell)
+        len_t j0 = 0, jmax = np2;
+        real_t dxi_first = dp2[0], dxi_last = dp2[np2-1];
+        switch (xiMode) {
+            case XI_MODE_NEG: {
+                for (len_t j = 1; j < np2+1; j++) {
+                    if (xi_f[j]*xi_f[j-1] < 0 || xi_f[j] == 0) {
+                        jmax = j;
+                        dxi_last = -xi_f[j-1];
+                        break;
+                    }
+                }
+            } break;
+            case XI_MODE_POS: {
+                for (len_t j = 1; j < np2+1; j++) {
+                    if (xi_f[j]*xi_f[j-1] < 0 || xi_f[j] == 0) {
+                        j0 = j-1;
+                        dxi_first = xi_f[j];
+                        break;
+                    }
+                }
+            } break;
+
+            default: break;
+        }
+
+        real_t *w = this->weights + offset;
+        for (len_t k = 0; k < np1*np2; k++)
+            w[k] = 0;
+
+        for (len_t i = 0; i < np1; i++) {
+            real_t envelope = ThresholdEnvelope(ir,i);
+            real_t common = envelope * dp1[i] / VpVol;
+
+            w[j0*np1+i] = common * Vp[j0*np1+i] * dxi_first;
+            for (len_t j = j0+1; j < jmax-1; j++) {
+                len_t idx = j*np1 + i;
+                w[idx] = common * Vp[idx] * dp2[j];
+            }
+
+            if (jmax-1 != j0)
+                w[(jmax-1)*np1+i] = common * Vp[(jmax-1)*np1+i] * dxi_last;
+        }
+
+        updated = true;
+        this->weightsFirst[ir]  = offset + j0*np1;
+        this->weightsLength[ir] = (jmax-j0)*np1;
+        if (dependsOnT)
+            this->weightsTcold[ir] = Tcold[ir];
+
+        offset += np1*np2;
+    }
+
+    if (updated)
+        this->weightsRevision++;
+    this->weightsValid = true;
+}
+
 void MomentQuantity::AllocateDiffIntegrand(){
     len_t nMultiples = GetMaxNumberOfMultiplesJacobian();
     if(nMultiples){
@@ -339,25 +581,46 @@ bool MomentQuantity::SetJacobianBlock(
     if(derivId==id_Tcold)
         AddDiffEnvelope();
     
-    len_t offset_n = 0;
-    #define X(ID,V) \
-        VAL += (V)*f[offset+(ID)]*diffIntegrand[offset_n + (ID)];
-    #define ApplyX(IR) \
-        IND = (IR) + n*nr; \
-        jac->SetRow((IR), 1, &IND, &VAL); \
-        VAL = 0;
-    PetscInt IND;
-    PetscScalar VAL = 0;
-    for(len_t n=0; n<nMultiples;n++){
-        #include "MomentQuantity.setel.cpp"
-        offset_n += offset; 
+    UpdateWeights();
+
+    const len_t nr = fGrid->GetNr();
+    for (len_t n = 0; n < nMultiples; n++) {
+        const real_t *dI = this->diffIntegrand + n*this->nIntegrand;
+        for (len_t ir = 0; ir < nr; ir++) {
+            const len_t k0 = this->weightsFirst[ir], k1 = k0 + this->weightsLength[ir];
+
+            PetscScalar VAL = 0;
+            for (len_t k = k0; k < k1; k++)
+                VAL += this->weights[k] * f[k] * dI[k];
+
+            PetscInt IND = ir + n*nr;
+            jac->SetRow(ir, 1, &IND, &VAL);
+        }
     }
-    #undef ApplyX
-    #undef X
 
     return true;
 }
 
+/**
+ * Evaluate the distribution function weighted with the quadrature
+ * weights of this moment, 'wf[k] = weights[k]*f[k]', in all cells
+ * of the distribution grid (outside of the integration limits, 'wf'
+ * vanishes). The moment of any integrand 'I' in radial grid point 'ir'
+ * is then given by the sum of 'I[k]*wf[k]' over the cells of 'ir',
+ * which allows several integrands to be evaluated simultaneously.
+ *
+ * f:  Distribution function.
+ * wf: On return, contains the weighted distribution function
+ *     (size fGrid->GetNCells()).
+ */
+void MomentQuantity::SetWeightedDistribution(const real_t *f, real_t *wf) {
+    UpdateWeights();
+
+    const len_t N = fGrid->GetNCells();
+    for (len_t k = 0; k < N; k++)
+        wf[k] = this->weights[k] * f[k];
+}
+
 /**
  * Set the elements of the linear operator matrix corresponding to
  * this operator.
@@ -366,22 +629,49 @@ bool MomentQuantity::SetJacobianBlock(
  * rhs: Equation right-hand-side.
  */
 void MomentQuantity::SetMatrixElements(Matrix *mat, real_t*) {
-    #define X(ID,V) \
-        IND_ARR[N_IND] = offset + (ID); \
-        VAL_ARR[N_IND]= (V) * integrand[offset + (ID)]; \
-        N_IND++; 
-    #define ApplyX(IR) \
-        mat->SetRow((IR),N_IND,IND_ARR, VAL_ARR); \
-        N_IND = 0;
-    len_t N_IND = 0;
-    const len_t SIZE = GetNumberOfNonZerosPerRow();
-    PetscInt *IND_ARR = new PetscInt[SIZE];
-    PetscScalar *VAL_ARR = new PetscScalar[SIZE];
-    #   include "MomentQuantity.setel.cpp"
-    delete [] IND_ARR;
-    delete [] VAL_ARR;
-    #undef ApplyX
-    #undef X
+    UpdateWeights();
+
+    if (this->SetMatrixElementsDevice(mat))
+        return;
+
+    const len_t nr = fGrid->GetNr();
+    for (len_t ir = 0; ir < nr; ir++) {
+        const len_t k0 = this->weightsFirst[ir], n = this->weightsLength[ir];
+        for (len_t k = 0; k < n; k++)
+            this->rowValues[k] = this->weights[k0+k] * this->integrand[k0+k];
+
+        mat->SetRow(ir, n, this->weightsColumns+k0, this->rowValues);
+    }
+}
+
+/**
+ * Set the elements of the matrix from a kernel on the device, if
+ * the matrix supports device assembly. Each cell contributes to a
+ * single element of the matrix, so that all cells can be handled
+ * concurrently.
+ *
+ * RETURNS false if the elements must instead be set on the host.
+ */
+bool MomentQuantity::SetMatrixElementsDevice(Matrix *mat) {
+    if (!Device::IsEnabled())
+        return false;
+
+    PetscScalar *values = mat->BeginDeviceAssembly();
+    if (values == nullptr)
+        return false;
+
+    const PetscInt *slots = this->GetDeviceSlots(mat);
+    if (slots == nullptr)
+        return false;
+
+    const real_t *w = this->weights, *I = this->integrand;
+    Device::For(this->nIntegrand, DREAM_DEVICE_LAMBDA (const len_t k) {
+        const PetscInt idx = slots[k];
+        if (idx >= 0)
+            values[idx] += w[k] * I[k];
+    });
+
+    return true;
 }
 
 /**
@@ -393,10 +683,25 @@ void MomentQuantity::SetMatrixElements(Matrix *mat, real_t*) {
  *      this operator.
  */
 void MomentQuantity::SetVectorElements(real_t *vec, const real_t *f) {
-    #define X(ID,V) vec[ir] += f[offset+(ID)] * integrand[offset+(ID)] * (V);
-    #define ApplyX(IR) {}; // do nothing
-    #   include "MomentQuantity.setel.cpp"
-    #undef ApplyX
-    #undef X
+    const len_t nr = fGrid->GetNr();
+    if (this->fused != nullptr && f == unknowns->GetUnknownData(fId)) {
+        const real_t *m = this->fused->GetMoment(this->fusedIndex, f);
+        for (len_t ir = 0; ir < nr; ir++)
+            vec[ir] += m[ir];
+
+        return;
+    }
+
+    UpdateWeights();
+
+    for (len_t ir = 0; ir < nr; ir++) {
+        const len_t k0 = this->weightsFirst[ir], k1 = k0 + this->weightsLength[ir];
+
+        real_t VAL = 0;
+        for (len_t k = k0; k < k1; k++)
+            VAL += this->weights[k] * this->integrand[k] * f[k];
+
+        vec[ir] += VAL;
+    }
 }
 
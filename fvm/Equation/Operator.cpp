@@ -4,7 +4,11 @@
  */
 
 #include <algorithm>
+#include <cmath>
+#include <functional>
 #include "FVM/Equation/Operator.hpp"
+#include "FVM/TermTimings.hpp"
+#include "FVM/Tracer.hpp"
 
 #include <iostream>
 #include <stdlib.h>
@@ -13,6 +17,11 @@ using namespace DREAM::FVM;
 using namespace std;
 
 
+// Name under which the combined advection-diffusion term is timed
+static const string ADVECTION_DIFFUSION_NAME = "Advection-diffusion";
+// Name under which the diagonal terms assembled together are timed
+static const string DIAGONAL_TERMS_NAME = "Diagonal terms";
+
 /**
  * Constructor.
  */
@@ -112,6 +121,71 @@ void Operator::CheckConsistency() {
         if (adterm != nullptr || terms.size() > 0 || boundaryConditions.size() > 0 || eval_terms.size() > 0)
             throw OperatorException("A predetermined quantity cannot have other equation terms.");
     }
+
+    GroupTerms();
+}
+
+/**
+ * Sort the terms of this operator by kind. Diagonal terms whose
+ * matrices consist of only the main diagonal (see
+ * 'DiagonalTerm::IsFusable()') are assembled together by summing
+ * their weights in a single pass over the grid, from which one
+ * diagonal is then set in the matrix/function vector (instead of
+ * one per term). This is only done if the operator has at least two
+ * such terms. All other terms are assembled individually, as before.
+ *
+ * The lists 'terms' and 'eval_terms' are left untouched, so that all
+ * terms are still rebuilt (with their own weights) and may be accessed
+ * individually.
+ */
+void Operator::GroupTerms() {
+    diagonalTerms.clear();
+    otherTerms.clear();
+    otherEvalTerms.clear();
+
+    // ('EvaluableEquationTerm's and 'DiagonalTerm's are separate
+    // bases of e.g. 'DiagonalLinearTerm', so a cross-cast is needed)
+    auto fusable = [](EquationTerm *t) -> DiagonalTerm* {
+        DiagonalTerm *d = dynamic_cast<DiagonalTerm*>(t);
+        return ((d != nullptr && d->IsFusable()) ? d : nullptr);
+    };
+
+    len_t nFusable = 0;
+    for (EvaluableEquationTerm *t : eval_terms)
+        if (fusable(t)) nFusable++;
+    for (EquationTerm *t : terms)
+        if (fusable(t)) nFusable++;
+
+    for (EvaluableEquationTerm *t : eval_terms) {
+        DiagonalTerm *d = (nFusable > 1 ? fusable(t) : nullptr);
+        if (d != nullptr) diagonalTerms.push_back(d);
+        else otherEvalTerms.push_back(t);
+    }
+    for (EquationTerm *t : terms) {
+        DiagonalTerm *d = (nFusable > 1 ? fusable(t) : nullptr);
+        if (d != nullptr) diagonalTerms.push_back(d);
+        else otherTerms.push_back(t);
+    }
+}
+
+/**
+ * Sum the diagonal matrix elements of all diagonal terms which
+ * are assembled together.
+ *
+ * RETURNS the summed diagonal (of size equal to the number of
+ * cells of the grid).
+ */
+const real_t *Operator::BuildDiagonal() {
+    const len_t N = this->grid->GetNCells();
+    // (the grid may have been rebuilt since the last call)
+    if (this->diagonal.size() != N)
+        this->diagonal.resize(N);
+
+    std::fill(this->diagonal.begin(), this->diagonal.end(), 0);
+    for (DiagonalTerm *term : diagonalTerms)
+        term->AddToDiagonal(this->diagonal.data());
+
+    return this->diagonal.data();
 }
 
 /**
@@ -195,6 +269,83 @@ bool Operator::IsEvaluable() const {
         (this->predetermined == nullptr && this->eval_terms.size() >= 1);
 }
 
+/**
+ * Returns true if all terms and boundary conditions of this
+ * operator can be rebuilt, and used to build jacobian matrix
+ * blocks, concurrently with the terms of other operators.
+ */
+bool Operator::IsThreadSafe() const {
+    if (adterm != nullptr && !adterm->IsThreadSafe())
+        return false;
+    if (predetermined != nullptr && !predetermined->IsThreadSafe())
+        return false;
+
+    for (EquationTerm *term : terms)
+        if (!term->IsThreadSafe())
+            return false;
+    for (EvaluableEquationTerm *term : eval_terms)
+        if (!term->IsThreadSafe())
+            return false;
+    for (BC::BoundaryCondition *bc : boundaryConditions)
+        if (!bc->IsThreadSafe())
+            return false;
+
+    return true;
+}
+
+/**
+ * Adds to 'objs' the shared objects modified by the terms and
+ * boundary conditions of this operator (see
+ * 'EquationTerm::GetSharedObjects()').
+ */
+void Operator::GetSharedObjects(vector<const void*>& objs) const {
+    if (adterm != nullptr)
+        adterm->GetSharedObjects(objs);
+    if (predetermined != nullptr)
+        predetermined->GetSharedObjects(objs);
+
+    for (EquationTerm *term : terms)
+        term->GetSharedObjects(objs);
+    for (EvaluableEquationTerm *term : eval_terms)
+        term->GetSharedObjects(objs);
+    for (BC::BoundaryCondition *bc : boundaryConditions)
+        bc->GetSharedObjects(objs);
+}
+
+/**
+ * Returns true if the contribution of this operator to the
+ * jacobian matrix does not change during a time step (see
+ * 'EquationTerm::IsJacobianConstant()'). Boundary conditions are
+ * conservatively assumed to depend on the unknowns, as are advection
+ * terms with flux limiters (whose interpolation coefficients depend
+ * on the unknown).
+ */
+bool Operator::IsJacobianConstant() const {
+    if (this->boundaryConditions.size() > 0)
+        return false;
+
+    for (EquationTerm *term : terms)
+        if (!term->IsJacobianConstant())
+            return false;
+    for (EvaluableEquationTerm *term : eval_terms)
+        if (!term->IsJacobianConstant())
+            return false;
+
+    if (this->adterm != nullptr) {
+        for (AdvectionTerm *term : adterm->GetAdvectionTerms())
+            if (!term->IsJacobianConstant())
+                return false;
+        for (DiffusionTerm *term : adterm->GetDiffusionTerms())
+            if (!term->IsJacobianConstant())
+                return false;
+
+        if (!adterm->GetAdvectionTerms().empty() && adterm->AdvectionTerm::UsesFluxLimiter())
+            return false;
+    }
+
+    return true;
+}
+
 /**
  * Returns the number of non-zero elements inserted into
  * a linear operator matrix by this operator object.
@@ -263,25 +414,97 @@ void Operator::MakeIdentifiable(int_t id, EquationTerm *trm) {
 void Operator::RebuildTerms(const real_t t, const real_t dt, UnknownQuantityHandler *uqty) {
     // Predetermined value
     if (predetermined != nullptr) {
-        this->predetermined->Rebuild(t, dt, uqty);
+        this->predetermined->RebuildIfNeeded(t, dt, uqty);
         return;
     }
 
     // Evaluatable equation terms
-    for (auto it = eval_terms.begin(); it != eval_terms.end(); it++)
-        (*it)->Rebuild(t, dt, uqty);
+    for (auto it = eval_terms.begin(); it != eval_terms.end(); it++) {
+        Tracer::Scope trace((*it)->GetName(), "term");
+        TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_REBUILD);
+        (*it)->RebuildIfNeeded(t, dt, uqty);
+    }
 
     // Other equation terms
-    for (auto it = terms.begin(); it != terms.end(); it++)
-        (*it)->Rebuild(t, dt, uqty);
+    for (auto it = terms.begin(); it != terms.end(); it++) {
+        Tracer::Scope trace((*it)->GetName(), "term");
+        TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_REBUILD);
+        (*it)->RebuildIfNeeded(t, dt, uqty);
+    }
 
     // Advection-diffusion term
-    if (adterm != nullptr)
-        adterm->Rebuild(t, dt, uqty);
+    if (adterm != nullptr) {
+        Tracer::Scope trace("Advection-diffusion", "term");
+        TermTimings::Scope timing(ADVECTION_DIFFUSION_NAME, TermTimings::PHASE_REBUILD);
+        adterm->AdvectionTerm::RebuildIfNeeded(t, dt, uqty);
+    }
 
     // Boundary conditions
-    for (auto it = boundaryConditions.begin(); it != boundaryConditions.end(); it++)
+    for (auto it = boundaryConditions.begin(); it != boundaryConditions.end(); it++) {
+        TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_REBUILD);
         (*it)->Rebuild(t, uqty);
+    }
+}
+
+/**
+ * Returns 'true' if any term of this operator has declared (via
+ * 'EquationTerm::AddUnknownForJacobian()') that it contributes to
+ * the jacobian with respect to the unknown with ID 'derivId'.
+ */
+bool Operator::HasJacobianContribution(const len_t derivId) const {
+    if (predetermined != nullptr)
+        return predetermined->HasJacobianContribution(derivId);
+
+    for (auto it = eval_terms.begin(); it != eval_terms.end(); it++)
+        if ((*it)->HasJacobianContribution(derivId))
+            return true;
+
+    for (auto it = terms.begin(); it != terms.end(); it++)
+        if ((*it)->HasJacobianContribution(derivId))
+            return true;
+
+    if (adterm != nullptr) {
+        for (auto a : adterm->GetAdvectionTerms())
+            if (a->HasJacobianContribution(derivId))
+                return true;
+        for (auto d : adterm->GetDiffusionTerms())
+            if (d->HasJacobianContribution(derivId))
+                return true;
+    }
+
+    return false;
+}
+
+/**
+ * Print the number of times that each term of this operator which
+ * has declared its inputs has been rebuilt, and the number of times
+ * its rebuild has been skipped since none of its inputs had changed.
+ *
+ * prefix: Name to print before the name of each term.
+ */
+void Operator::PrintRebuildStatistics(const std::string& prefix) const {
+    auto print = [&prefix](const EquationTerm *t, const std::string& name) {
+        if (!t->HasRebuildInputs())
+            return;
+
+        printf(
+            "  %s/%s:  " LEN_T_PRINTF_FMT " rebuilt, " LEN_T_PRINTF_FMT " skipped\n",
+            prefix.c_str(), name.c_str(), t->GetNRebuilds(), t->GetNRebuildsSkipped()
+        );
+    };
+
+    if (predetermined != nullptr) {
+        print(predetermined, predetermined->GetName());
+        return;
+    }
+
+    for (auto it = eval_terms.begin(); it != eval_terms.end(); it++)
+        print(*it, (*it)->GetName());
+    for (auto it = terms.begin(); it != terms.end(); it++)
+        print(*it, (*it)->GetName());
+
+    if (adterm != nullptr)
+        print(static_cast<const AdvectionTerm*>(adterm), "Advection-diffusion");
 }
 
 /**
@@ -302,16 +525,43 @@ bool Operator::SetJacobianBlock(
 ) {
     bool contributes = false;
 
-    for (auto it = eval_terms.begin(); it != eval_terms.end(); it++) {
+    // Diagonal terms assembled together
+    if (!diagonalTerms.empty()) {
+        TermTimings::Scope timing(DIAGONAL_TERMS_NAME, TermTimings::PHASE_JACOBIAN);
+        bool c = false;
+        if (derivId == uqtyId) {
+            const real_t *diag = BuildDiagonal();
+            const len_t N = this->grid->GetNCells();
+            for (len_t i = 0; i < N; i++)
+                jac->SetElement(i, i, diag[i]);
+
+            c = true;
+        }
+
+        for (DiagonalTerm *term : diagonalTerms)
+            c |= term->AddWeightsJacobianBlock(uqtyId, derivId, jac, x);
+
+        CheckJacobianElements(DIAGONAL_TERMS_NAME, derivId, jac);
+        contributes |= c;
+#ifndef NDEBUG
+        if (c && printTerms) printf("Contribution from %s", DIAGONAL_TERMS_NAME.c_str());
+#endif
+    }
+
+    for (auto it = otherEvalTerms.begin(); it != otherEvalTerms.end(); it++) {
+        TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_JACOBIAN);
         bool c = (*it)->SetJacobianBlock( uqtyId, derivId, jac, x);
+        CheckJacobianElements((*it)->GetName(), derivId, jac);
         contributes |= c;
 #ifndef NDEBUG
         if (c && printTerms) printf("Contribution from %s", (*it)->GetName().c_str());
 #endif
     }
 
-    for (auto it = terms.begin(); it != terms.end(); it++) {
+    for (auto it = otherTerms.begin(); it != otherTerms.end(); it++) {
+        TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_JACOBIAN);
         bool c = (*it)->SetJacobianBlock(uqtyId, derivId, jac, x);
+        CheckJacobianElements((*it)->GetName(), derivId, jac);
         contributes |= c;
 #ifndef NDEBUG
         if (c && printTerms) printf("Contribution from %s", (*it)->GetName().c_str());
@@ -320,17 +570,21 @@ bool Operator::SetJacobianBlock(
 
     // Advection-diffusion term?
     if (adterm != nullptr) {
+        TermTimings::Scope timing(ADVECTION_DIFFUSION_NAME, TermTimings::PHASE_JACOBIAN);
         contributes |=
 #ifndef NDEBUG
             adterm->SetJacobianBlock(uqtyId, derivId, jac, x, printTerms);
 #else
             adterm->SetJacobianBlock(uqtyId, derivId, jac, x);
 #endif
+        CheckJacobianElements(ADVECTION_DIFFUSION_NAME, derivId, jac);
     }
 
     // Boundary conditions
     for (auto it = boundaryConditions.begin(); it != boundaryConditions.end(); it++) {
+            TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_JACOBIAN);
             bool c = (*it)->AddToJacobianBlock(uqtyId, derivId, jac, x);
+            CheckJacobianElements((*it)->GetName(), derivId, jac);
             contributes |= c;
 #ifndef NDEBUG
         if (c && printTerms) printf("Contribution from %s", (*it)->GetName().c_str());
@@ -340,6 +594,34 @@ bool Operator::SetJacobianBlock(
     return contributes;
 }
 
+/**
+ * Verify that the term with the given name did not set any non-finite
+ * (NaN or Inf) elements in the jacobian matrix, so that a corrupted
+ * jacobian is reported as soon as it is built, together with the term
+ * and matrix element responsible (rather than when the matrix is
+ * factorized). Since the elements are checked as they are set (see
+ * 'Matrix::HasNonFiniteElement()'), this only costs a flag test.
+ *
+ * name:    Name of the term which was just added to the jacobian.
+ * derivId: ID of the unknown with respect to which the term was
+ *          differentiated.
+ * jac:     Jacobian matrix (block).
+ */
+void Operator::CheckJacobianElements(
+    const string& name, const len_t derivId, const Matrix *jac
+) const {
+    PetscInt I, J;
+    if (!jac->HasNonFiniteElement(&I, &J))
+        return;
+
+    throw OperatorException(
+        "Term '%s' set a non-finite jacobian element in row %lld, column %lld "
+        "of its block (differentiated with respect to unknown " LEN_T_PRINTF_FMT ").",
+        name.c_str(), (long long)(I - jac->GetRowOffset()),
+        (long long)(J - jac->GetColOffset()), derivId
+    );
+}
+
 /**
  * Routine specifically designed for boundary conditions which need to
  * overwrite elements in the jacobian matrix.
@@ -358,7 +640,9 @@ bool Operator::SetJacobianBlockBC(
 ) {
     bool contributes = false;
     for (auto it = boundaryConditions.begin(); it != boundaryConditions.end(); it++) {
+        TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_JACOBIAN);
         bool c = (*it)->SetJacobianBlock(uqtyId, derivId, jac, x);
+        CheckJacobianElements((*it)->GetName(), derivId, jac);
         contributes |= c;
 #ifndef NDEBUG
         if (c && printTerms) printf("Contribution from %s", (*it)->GetName().c_str());
@@ -379,31 +663,93 @@ void Operator::SetMatrixElements(Matrix *mat, real_t *rhs) {
     if (this->IsPredetermined()) {
         this->predetermined->SetMatrixElements(mat, rhs);
     } else {
-        for (auto it = eval_terms.begin(); it != eval_terms.end(); it++)
+        // Diagonal terms assembled together
+        if (!diagonalTerms.empty()) {
+            TermTimings::Scope timing(DIAGONAL_TERMS_NAME, TermTimings::PHASE_MATRIX);
+            const real_t *diag = BuildDiagonal();
+            const len_t N = this->grid->GetNCells();
+            for (len_t i = 0; i < N; i++)
+                mat->SetElement(i, i, diag[i]);
+        }
+
+        for (auto it = otherEvalTerms.begin(); it != otherEvalTerms.end(); it++) {
+            TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_MATRIX);
             (*it)->SetMatrixElements(mat, rhs);
+        }
 
-        for (auto it = terms.begin(); it != terms.end(); it++)
+        for (auto it = otherTerms.begin(); it != otherTerms.end(); it++) {
+            TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_MATRIX);
             (*it)->SetMatrixElements(mat, rhs);
+        }
 
         // Advection-diffusion term?
-        if (adterm != nullptr)
+        if (adterm != nullptr) {
+            TermTimings::Scope timing(ADVECTION_DIFFUSION_NAME, TermTimings::PHASE_MATRIX);
             adterm->SetMatrixElements(mat, rhs);
+        }
 
         // Boundary conditions
-        for (auto it = boundaryConditions.begin(); it != boundaryConditions.end(); it++)
+        for (auto it = boundaryConditions.begin(); it != boundaryConditions.end(); it++) {
+            TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_MATRIX);
             (*it)->AddToMatrixElements(mat, rhs);
+        }
 
         // TODO Partially assemble matrix
         mat->PartialAssemble();
 
         // Hard set boundary conditions
-        for (auto it = boundaryConditions.begin(); it != boundaryConditions.end(); it++)
+        for (auto it = boundaryConditions.begin(); it != boundaryConditions.end(); it++) {
+            TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_MATRIX);
             (*it)->SetMatrixElements(mat, rhs);
+        }
 
         mat->PartialAssemble();
     }
 }
 
+/**
+ * Identify the term of this operator which sets a non-finite (NaN or
+ * Inf) value in element 'i' of the function vector, by evaluating each
+ * term separately. This is only intended for locating the origin of a
+ * non-finite residual, and is therefore not optimized.
+ *
+ * i: Index of the non-finite element of the function vector.
+ * n: Number of elements in the function vector.
+ * x: Value of the unknown to which this operator is applied.
+ *
+ * RETURNS the name of the first term found evaluating to a non-finite
+ * value in element 'i', or an empty string if no such term exists.
+ */
+string Operator::FindNonFiniteTerm(const len_t i, const len_t n, const real_t *x) {
+    vector<real_t> v(n);
+    auto evaluatesToNonFinite = [&v,i](std::function<void(real_t*)> f) {
+        std::fill(v.begin(), v.end(), 0);
+        f(v.data());
+        return !std::isfinite(v[i]);
+    };
+
+    if (this->IsPredetermined()) {
+        if (evaluatesToNonFinite([this,x](real_t *vec) { this->predetermined->SetVectorElements(vec, x); }))
+            return this->predetermined->GetName();
+        else
+            return "";
+    }
+
+    for (EvaluableEquationTerm *term : eval_terms)
+        if (evaluatesToNonFinite([term,x](real_t *vec) { term->SetVectorElements(vec, x); }))
+            return term->GetName();
+    for (EquationTerm *term : terms)
+        if (evaluatesToNonFinite([term,x](real_t *vec) { term->SetVectorElements(vec, x); }))
+            return term->GetName();
+    if (adterm != nullptr && evaluatesToNonFinite([this,x](real_t *vec) { adterm->SetVectorElements(vec, x); }))
+        return ADVECTION_DIFFUSION_NAME;
+    for (BC::BoundaryCondition *bc : boundaryConditions)
+        if (evaluatesToNonFinite([bc,x](real_t *vec) { bc->AddToVectorElements(vec, x); bc->SetVectorElements(vec, x); }))
+            return bc->GetName();
+
+    return "";
+}
+
 /**
  * Evaluate this operator and assign its value to the
  * given function vector.
@@ -415,22 +761,41 @@ void Operator::SetVectorElements(real_t *vec, const real_t *x) {
     if (this->IsPredetermined()) {
         this->predetermined->SetVectorElements(vec, x);
     } else {
-        for (auto it = eval_terms.begin(); it != eval_terms.end(); it++)
+        // Diagonal terms assembled together
+        if (!diagonalTerms.empty()) {
+            TermTimings::Scope timing(DIAGONAL_TERMS_NAME, TermTimings::PHASE_VECTOR);
+            const real_t *diag = BuildDiagonal();
+            const len_t N = this->grid->GetNCells();
+            for (len_t i = 0; i < N; i++)
+                vec[i] += diag[i] * x[i];
+        }
+
+        for (auto it = otherEvalTerms.begin(); it != otherEvalTerms.end(); it++) {
+            TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_VECTOR);
             (*it)->SetVectorElements(vec, x);
+        }
 
-        for (auto it = terms.begin(); it != terms.end(); it++)
+        for (auto it = otherTerms.begin(); it != otherTerms.end(); it++) {
+            TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_VECTOR);
             (*it)->SetVectorElements(vec, x);
+        }
 
         // Advection-diffusion term?
-        if (adterm != nullptr)
+        if (adterm != nullptr) {
+            TermTimings::Scope timing(ADVECTION_DIFFUSION_NAME, TermTimings::PHASE_VECTOR);
             adterm->SetVectorElements(vec, x);
+        }
 
         // Boundary conditions
-        for (auto it = boundaryConditions.begin(); it != boundaryConditions.end(); it++)
+        for (auto it = boundaryConditions.begin(); it != boundaryConditions.end(); it++) {
+            TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_VECTOR);
             (*it)->AddToVectorElements(vec, x);
+        }
 
-        for (auto it = boundaryConditions.begin(); it != boundaryConditions.end(); it++)
+        for (auto it = boundaryConditions.begin(); it != boundaryConditions.end(); it++) {
+            TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_VECTOR);
             (*it)->SetVectorElements(vec, x);
+        }
     }
 }
 
@@ -15,12 +15,18 @@ using namespace DREAM::FVM;
  */
 PrescribedParameter::PrescribedParameter(Grid *g, enum Interpolator1D::interp_method interp)
     : PredeterminedParameter(g), interp_method(interp) {
+
+    // Only depends on time
+    SetRebuildInputs();
 }
 PrescribedParameter::PrescribedParameter(Grid *g, Interpolator1D *i1d)
     : PredeterminedParameter(g), interp(i1d) {
     
     this->time = interp->GetX();
     this->data = interp->GetY();
+
+    // Only depends on time
+    SetRebuildInputs();
 }
 
 /**
@@ -29,6 +35,8 @@ PrescribedParameter::PrescribedParameter(Grid *g, Interpolator1D *i1d)
 PrescribedParameter::~PrescribedParameter() {
     if (time != nullptr)
         DeallocateData();
+
+    delete [] this->externalData;
 }
 
 /**
@@ -80,6 +88,7 @@ void PrescribedParameter::SetData(const len_t nt, real_t *t, real_t *v, bool cop
     }
 
     this->interp = new Interpolator1D(nt, N, this->time, this->data, this->interp_method);
+    this->InvalidateRebuild();
 }
 
 
@@ -90,6 +99,12 @@ void PrescribedParameter::SetData(const len_t nt, real_t *t, real_t *v, bool cop
  * t: Current simulation time.
  */
 void PrescribedParameter::Rebuild(const real_t t, const real_t, UnknownQuantityHandler*) {
+    if (this->externalData != nullptr) {
+        this->currentTime = t;
+        this->interpolatedData = this->externalData;
+        return;
+    }
+
     if (this->currentTime == t && this->interpolatedData != nullptr)
         return;
 
@@ -97,6 +112,44 @@ void PrescribedParameter::Rebuild(const real_t t, const real_t, UnknownQuantityH
     this->interpolatedData = this->interp->Eval(t);
 }
 
+/**
+ * Returns a pointer to a buffer which replaces the prescribed time
+ * evolution of this parameter. The buffer is initialized with the
+ * current value of the parameter, and may be modified in place
+ * between time steps (the parameter then takes the value in the
+ * buffer for all subsequent time steps, until the buffer is released
+ * with 'ReleaseExternalData()').
+ */
+real_t *PrescribedParameter::GetExternalData() {
+    if (this->externalData != nullptr)
+        return this->externalData;
+
+    const len_t N = grid->GetNCells();
+    const real_t *v = this->interpolatedData;
+    if (v == nullptr)
+        v = this->interp->Eval(this->currentTime);
+
+    this->externalData = new real_t[N];
+    for (len_t i = 0; i < N; i++)
+        this->externalData[i] = v[i];
+
+    this->interpolatedData = this->externalData;
+    return this->externalData;
+}
+
+/**
+ * Release the buffer returned by 'GetExternalData()' and resume
+ * following the prescribed time evolution of this parameter.
+ */
+void PrescribedParameter::ReleaseExternalData() {
+    if (this->externalData == nullptr)
+        return;
+
+    delete [] this->externalData;
+    this->externalData = nullptr;
+    this->interpolatedData = this->interp->Eval(this->currentTime);
+}
+
 /**
  * Set the elements in the matrix and on the RHS corresponding
  * to this quantity.
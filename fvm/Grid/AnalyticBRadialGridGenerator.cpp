@@ -88,6 +88,10 @@ AnalyticBRadialGridGenerator::~AnalyticBRadialGridGenerator(){
         gsl_interp_accel_free(gsl_acc_Delta);
     }
 
+    delete [] this->theta_trig;
+    delete [] this->cosTheta;
+    delete [] this->sinTheta;
+
     DeallocateShapeProfiles();
 }
 
@@ -309,6 +313,113 @@ void AnalyticBRadialGridGenerator::EvaluateGeometricQuantities_fr(const len_t ir
 }
 
 
+/**
+ * Evaluate cos(theta) and sin(theta) in the given poloidal angles,
+ * unless they are the same angles as in the previous call.
+ */
+void AnalyticBRadialGridGenerator::SetTrigonometricFunctions(const len_t ntheta, const real_t *theta) {
+    if (ntheta == this->ntheta_trig && std::equal(theta, theta+ntheta, this->theta_trig))
+        return;
+
+    delete [] this->theta_trig;
+    delete [] this->cosTheta;
+    delete [] this->sinTheta;
+
+    this->ntheta_trig = ntheta;
+    this->theta_trig  = new real_t[ntheta];
+    this->cosTheta    = new real_t[ntheta];
+    this->sinTheta    = new real_t[ntheta];
+    for (len_t it = 0; it < ntheta; it++) {
+        this->theta_trig[it] = theta[it];
+        this->cosTheta[it]   = cos(theta[it]);
+        this->sinTheta[it]   = sin(theta[it]);
+    }
+}
+
+/**
+ * Evaluate B, the Jacobian, R/R0 and |nabla r|^2 on one flux surface,
+ * with the given shape parameters, in all poloidal angles set with
+ * 'SetTrigonometricFunctions()'. This is the same calculation as in
+ * 'EvaluateGeometricQuantities()', but with the trigonometric functions
+ * of theta shared between all flux surfaces, and those of delta*sin(theta)
+ * skipped when there is no triangularity.
+ */
+void AnalyticBRadialGridGenerator::EvaluateGeometryKernel(
+    const real_t r, const real_t kappa, const real_t kappaPrime,
+    const real_t delta, const real_t deltaPrime,
+    const real_t Delta, const real_t DeltaPrime,
+    const real_t GOverR0, const real_t psiPrime,
+    const len_t ntheta, real_t *B, real_t *Jacobian, real_t *ROverR0, real_t *NablaR2
+) {
+    const real_t rk = r*kappaPrime;
+    const real_t c1 = delta*(kappa + rk) - r*kappa*deltaPrime;
+    const real_t Bp0 = psiPrime/(2*M_PI);
+
+    for (len_t it = 0; it < ntheta; it++) {
+        const real_t ct = this->cosTheta[it], st = this->sinTheta[it];
+
+        real_t sdt = 0.0, cdt = 1.0;
+        if (delta) {
+            cdt = cos(delta*st);
+            sdt = sin(delta*st);
+        }
+
+        const real_t stdt = st*cdt+sdt*ct; // = sin(theta + delta*sin(theta))
+        const real_t ctdt = ct*cdt-st*sdt; // = cos(theta + delta*sin(theta))
+
+        const real_t JOverRr = kappa*(cdt + DeltaPrime*ct) + st*stdt * (rk + ct*c1);
+
+        real_t RR0 = 1;
+        if (!R0IsInf)
+            RR0 += (Delta + r*ctdt)/R0;
+
+        const real_t deltaTerm = (1.0+delta*ct)*stdt;
+        const real_t kappaTerm = kappa*ct;
+        const real_t NR2 = (kappaTerm*kappaTerm + deltaTerm*deltaTerm) / (JOverRr*JOverRr);
+
+        const real_t Btor = GOverR0/RR0;
+        real_t BpolSq = 0;
+        if (psiPrime) {
+            const real_t Bp = Bp0/RR0;
+            BpolSq = NR2*Bp*Bp;
+        }
+
+        B[it]        = sqrt(Btor*Btor+BpolSq);
+        Jacobian[it] = r * RR0 * JOverRr;
+        ROverR0[it]  = RR0;
+        NablaR2[it]  = NR2;
+    }
+}
+
+/**
+ * Evaluate all geometric quantities at radial grid point ir
+ * in all the given poloidal angles.
+ */
+void AnalyticBRadialGridGenerator::EvaluateGeometricQuantitiesOnTheta(
+    const len_t ir, const len_t ntheta, const real_t *theta,
+    real_t *B, real_t *Jacobian, real_t *ROverR0, real_t *NablaR2
+) {
+    SetTrigonometricFunctions(ntheta, theta);
+    EvaluateGeometryKernel(
+        r[ir], kappa[ir], kappaPrime[ir], delta[ir], deltaPrime[ir],
+        Delta[ir], DeltaPrime[ir], BtorGOverR0[ir], psiPrimeRef[ir],
+        ntheta, B, Jacobian, ROverR0, NablaR2
+    );
+}
+// Same as EvaluateGeometricQuantitiesOnTheta, but on the radial flux grid
+void AnalyticBRadialGridGenerator::EvaluateGeometricQuantitiesOnTheta_fr(
+    const len_t ir, const len_t ntheta, const real_t *theta,
+    real_t *B, real_t *Jacobian, real_t *ROverR0, real_t *NablaR2
+) {
+    SetTrigonometricFunctions(ntheta, theta);
+    EvaluateGeometryKernel(
+        r_f[ir], kappa_f[ir], kappaPrime_f[ir], delta_f[ir], deltaPrime_f[ir],
+        Delta_f[ir], DeltaPrime_f[ir], BtorGOverR0_f[ir], psiPrimeRef_f[ir],
+        ntheta, B, Jacobian, ROverR0, NablaR2
+    );
+}
+
+
 /**
  * Interpolates input shape-parameter profiles (kappa, delta, ...) which are defined on 
  * input rProfilesProvided array to the r and r_f grids
@@ -0,0 +1,264 @@
+/**
+ * Implementation of a bicubic spline with precomputed patch coefficients.
+ *
+ * The spline is identical to the 'gsl_interp2d_bicubic' spline of GSL:
+ * the partial derivatives df/dx, df/dy and d^2f/dxdy in the grid points
+ * are estimated using natural cubic splines along each grid line, and f
+ * is represented by a bicubic Hermite polynomial in each patch. Unlike
+ * GSL, which re-derives the 16 polynomial coefficients of a patch from
+ * the function values and derivatives in every evaluation, we compute
+ * all coefficients once when the spline is constructed. An evaluation
+ * then only consists of locating the patch and evaluating a bicubic
+ * polynomial, and the function value and both first derivatives can be
+ * obtained together at little extra cost.
+ *
+ * Since the spline keeps no state between evaluations (such as the
+ * interval cache of a 'gsl_interp_accel'), it may be evaluated from
+ * several threads simultaneously.
+ */
+
+#include <algorithm>
+#include <gsl/gsl_spline.h>
+#include "FVM/Grid/BicubicSpline.hpp"
+
+
+using namespace DREAM::FVM;
+
+
+/**
+ * Constructor.
+ *
+ * x:  Grid points in the first coordinate (strictly increasing).
+ * nx: Number of points in 'x' (at least 3).
+ * y:  Grid points in the second coordinate (strictly increasing).
+ * ny: Number of points in 'y' (at least 3).
+ * z:  Function values to interpolate, with z(x[i], y[j]) = z[j*nx + i]
+ *     (the same ordering as used by 'gsl_spline2d').
+ */
+BicubicSpline::BicubicSpline(
+    const real_t *x, const len_t nx, const real_t *y, const len_t ny,
+    const real_t *z
+) : nx(nx), ny(ny) {
+    this->x = new real_t[nx];
+    this->y = new real_t[ny];
+    std::copy(x, x+nx, this->x);
+    std::copy(y, y+ny, this->y);
+
+    this->idx = new real_t[nx-1];
+    this->idy = new real_t[ny-1];
+    for (len_t i = 0; i < nx-1; i++)
+        this->idx[i] = 1/(x[i+1]-x[i]);
+    for (len_t j = 0; j < ny-1; j++)
+        this->idy[j] = 1/(y[j+1]-y[j]);
+
+    // Estimate partial derivatives in grid points
+    real_t *zx  = new real_t[nx*ny];
+    real_t *zy  = new real_t[nx*ny];
+    real_t *zxy = new real_t[nx*ny];
+    real_t *line = new real_t[std::max(nx, ny)];
+
+    gsl_interp_accel *acc = gsl_interp_accel_alloc();
+    gsl_spline *sx = gsl_spline_alloc(gsl_interp_cspline, nx);
+    for (len_t j = 0; j < ny; j++) {
+        for (len_t i = 0; i < nx; i++)
+            line[i] = z[j*nx+i];
+
+        gsl_spline_init(sx, x, line, nx);
+        gsl_interp_accel_reset(acc);
+        for (len_t i = 0; i < nx; i++)
+            zx[j*nx+i] = gsl_spline_eval_deriv(sx, x[i], acc);
+    }
+    gsl_spline_free(sx);
+
+    gsl_spline *sy = gsl_spline_alloc(gsl_interp_cspline, ny);
+    for (len_t i = 0; i < nx; i++) {
+        for (len_t j = 0; j < ny; j++)
+            line[j] = z[j*nx+i];
+
+        gsl_spline_init(sy, y, line, ny);
+        gsl_interp_accel_reset(acc);
+        for (len_t j = 0; j < ny; j++)
+            zy[j*nx+i] = gsl_spline_eval_deriv(sy, y[j], acc);
+
+        for (len_t j = 0; j < ny; j++)
+            line[j] = zx[j*nx+i];
+
+        gsl_spline_init(sy, y, line, ny);
+        gsl_interp_accel_reset(acc);
+        for (len_t j = 0; j < ny; j++)
+            zxy[j*nx+i] = gsl_spline_eval_deriv(sy, y[j], acc);
+    }
+    gsl_spline_free(sy);
+    gsl_interp_accel_free(acc);
+
+    // Hermite basis: coefficients of t^a for the values
+    // and (scaled) derivatives in the end points of [0,1]
+    const real_t M[4][4] = {
+        { 1,  0,  0,  0},
+        { 0,  0,  1,  0},
+        {-3,  3, -2, -1},
+        { 2, -2,  1,  1}
+    };
+
+    // Calculate bicubic coefficients C = M*F*M^T of each patch
+    this->coeffs = new real_t[16*(nx-1)*(ny-1)];
+    for (len_t j = 0; j < ny-1; j++) {
+        const real_t dy = y[j+1]-y[j];
+        for (len_t i = 0; i < nx-1; i++) {
+            const real_t dx = x[i+1]-x[i];
+            const len_t
+                i00 = j*nx+i,     i10 = j*nx+i+1,
+                i01 = (j+1)*nx+i, i11 = (j+1)*nx+i+1;
+
+            const real_t F[4][4] = {
+                {z[i00],     z[i01],     dy*zy[i00],     dy*zy[i01]},
+                {z[i10],     z[i11],     dy*zy[i10],     dy*zy[i11]},
+                {dx*zx[i00], dx*zx[i01], dx*dy*zxy[i00], dx*dy*zxy[i01]},
+                {dx*zx[i10], dx*zx[i11], dx*dy*zxy[i10], dx*dy*zxy[i11]}
+            };
+
+            real_t MF[4][4];
+            for (len_t a = 0; a < 4; a++)
+                for (len_t l = 0; l < 4; l++) {
+                    MF[a][l] = 0;
+                    for (len_t k = 0; k < 4; k++)
+                        MF[a][l] += M[a][k]*F[k][l];
+                }
+
+            real_t *c = this->coeffs + 16*(j*(nx-1)+i);
+            for (len_t a = 0; a < 4; a++)
+                for (len_t b = 0; b < 4; b++) {
+                    c[4*a+b] = 0;
+                    for (len_t l = 0; l < 4; l++)
+                        c[4*a+b] += MF[a][l]*M[b][l];
+                }
+        }
+    }
+
+    delete [] line;
+    delete [] zxy;
+    delete [] zy;
+    delete [] zx;
+}
+
+/**
+ * Destructor.
+ */
+BicubicSpline::~BicubicSpline() {
+    delete [] this->coeffs;
+    delete [] this->idy;
+    delete [] this->idx;
+    delete [] this->y;
+    delete [] this->x;
+}
+
+
+/**
+ * Locate the interval of the grid 'v' (with 'n' points) which
+ * contains the value 'a'. Points outside the grid are assigned
+ * to the first or last interval (so that the spline is
+ * extrapolated).
+ *
+ * hint: Interval to check first.
+ */
+len_t BicubicSpline::FindInterval(
+    const real_t a, const real_t *v, const len_t n, const len_t hint
+) const {
+    if (hint < n-1 && v[hint] <= a && a < v[hint+1])
+        return hint;
+
+    len_t k = std::upper_bound(v, v+n, a) - v;
+    if (k == 0) return 0;
+    else if (k >= n-1) return n-2;
+    else return k-1;
+}
+
+/**
+ * Locate the patch containing the point (x,y).
+ *
+ * p: On return, contains the location of the point. On input, the
+ *    patch stored in 'p' is checked first, so that consecutive
+ *    evaluations in nearby points (e.g. along a grid line) are
+ *    located without a binary search.
+ */
+void BicubicSpline::Locate(const real_t x, const real_t y, struct point &p) const {
+    p.i = FindInterval(x, this->x, this->nx, p.i);
+    p.j = FindInterval(y, this->y, this->ny, p.j);
+
+    p.t = (x - this->x[p.i]) * this->idx[p.i];
+    p.u = (y - this->y[p.j]) * this->idy[p.j];
+}
+
+
+/**
+ * Evaluate the spline in the given (located) point.
+ */
+real_t BicubicSpline::Eval(const struct point &p) const {
+    const real_t *c = this->coeffs + 16*(p.j*(nx-1)+p.i);
+    const real_t t = p.t, u = p.u;
+
+    real_t f = 0;
+    for (int a = 3; a >= 0; a--)
+        f = f*t + (((c[4*a+3]*u + c[4*a+2])*u + c[4*a+1])*u + c[4*a]);
+
+    return f;
+}
+
+/**
+ * Evaluate the spline and its first derivatives in
+ * the given (located) point.
+ *
+ * p:    Point to evaluate spline in.
+ * f:    On return, contains the value of the spline.
+ * dfdx: On return, contains the derivative with respect to x.
+ * dfdy: On return, contains the derivative with respect to y.
+ */
+void BicubicSpline::Eval(const struct point &p, real_t &f, real_t &dfdx, real_t &dfdy) const {
+    const real_t *c = this->coeffs + 16*(p.j*(nx-1)+p.i);
+    const real_t t = p.t, u = p.u;
+
+    real_t g[4], dg[4];
+    for (len_t a = 0; a < 4; a++) {
+        const real_t *ca = c + 4*a;
+        g[a]  = ((ca[3]*u + ca[2])*u + ca[1])*u + ca[0];
+        dg[a] = (3*ca[3]*u + 2*ca[2])*u + ca[1];
+    }
+
+    f    = ((g[3]*t + g[2])*t + g[1])*t + g[0];
+    dfdx = ((3*g[3]*t + 2*g[2])*t + g[1]) * this->idx[p.i];
+    dfdy = (((dg[3]*t + dg[2])*t + dg[1])*t + dg[0]) * this->idy[p.j];
+}
+
+
+/**
+ * Evaluate the spline in the point (x,y).
+ */
+real_t BicubicSpline::Eval(const real_t x, const real_t y) const {
+    struct point p;
+    Locate(x, y, p);
+    return Eval(p);
+}
+
+/**
+ * Evaluate the derivative of the spline with respect
+ * to x in the point (x,y).
+ */
+real_t BicubicSpline::EvalDerivX(const real_t x, const real_t y) const {
+    struct point p;
+    real_t f, dfdx, dfdy;
+    Locate(x, y, p);
+    Eval(p, f, dfdx, dfdy);
+    return dfdx;
+}
+
+/**
+ * Evaluate the derivative of the spline with respect
+ * to y in the point (x,y).
+ */
+real_t BicubicSpline::EvalDerivY(const real_t x, const real_t y) const {
+    struct point p;
+    real_t f, dfdx, dfdy;
+    Locate(x, y, p);
+    Eval(p, f, dfdx, dfdy);
+    return dfdy;
+}
@@ -15,9 +15,18 @@
  * 
  * It is initialized (or refreshed) with Rebuild(), which should
  * be called _after_ the FluxSurfaceAverager has been Rebuilt.
+ * If the magnetic field is uniform on the flux surfaces (as in
+ * cylindrical geometry), all orbits are passing with xi = xi0, and
+ * Rebuild() neither allocates bounce data nor evaluates any bounce
+ * integrals: V' and the bounce averages are then given in closed form.
+ * The radial loops of Rebuild() are parallelized (see 'FVM::Parallel'),
+ * with each thread using its own GSL workspaces (obtained from
+ * FluxSurfaceAverager::GetWorkspace()).
  */
 
+#include <vector>
 #include "FVM/Grid/BounceAverager.hpp"
+#include "FVM/Parallel.hpp"
 #include <gsl/gsl_roots.h>
 #include <gsl/gsl_errno.h>
 
@@ -34,6 +43,7 @@ BounceAverager::BounceAverager(
 ) : grid(g), fluxSurfaceAverager(fsa), ntheta_interp_trapped(ntheta_interp_trapped) {
 
     geometryIsSymmetric = fluxSurfaceAverager->isGeometrySymmetric();
+    fieldIsUniform              = fluxSurfaceAverager->isFieldUniform();
     ntheta_interp_passing       = fluxSurfaceAverager->GetNTheta();
     theta_passing               = fluxSurfaceAverager->GetTheta();
     weights_passing             = fluxSurfaceAverager->GetWeights();
@@ -46,10 +56,6 @@ BounceAverager::BounceAverager(
 
     InitializeQuadrature(q_method_trapped);
 
-    // Use the Brent algorithm for root finding when determining the theta bounce points
-    const gsl_root_fsolver_type *GSL_rootsolver_type = gsl_root_fsolver_brent;
-    gsl_fsolver = gsl_root_fsolver_alloc (GSL_rootsolver_type);
-    gsl_adaptive = gsl_integration_workspace_alloc(1000);
     qaws_table = gsl_integration_qaws_table_alloc(-0.5, -0.5, 0, 0);    
 }
 
@@ -57,8 +63,6 @@ BounceAverager::BounceAverager(
  * Destructor.
  */
 BounceAverager::~BounceAverager(){
-    gsl_root_fsolver_free(gsl_fsolver);
-    gsl_integration_workspace_free(gsl_adaptive);
     gsl_integration_qaws_table_free(qaws_table);
     
     if(!integrateTrappedAdaptive)
@@ -126,8 +130,12 @@ void BounceAverager::InitializeQuadrature(FluxSurfaceAverager::quadrature_method
 /**
  * Rebuilds quantities needed to perform bounce averages.
  * Should be called after FluxSurfaceAverager->Rebuild().
+ *
+ * cache: If not 'nullptr', the bounce points and the bounce-averaged
+ *        metric are taken from (or, if missing, added to) this
+ *        geometry cache.
  */
-void BounceAverager::Rebuild(){
+void BounceAverager::Rebuild(GeometryCache *cache){
     UpdateGridResolution();
     
     // If data has been generated already, deallocate.
@@ -138,8 +146,21 @@ void BounceAverager::Rebuild(){
         NablaR2->DeallocateData();
     }
 
+    if(fieldIsUniform){
+        isTrapped = nullptr;
+        grid->SetBounceParameters(false,
+            nullptr, nullptr, nullptr, nullptr,
+            nullptr, nullptr, nullptr, nullptr,
+            nullptr, nullptr, nullptr, nullptr);
+
+        real_t **Vp, **Vp_fr, **Vp_f1, **Vp_f2, **VpOverP2AtZero;
+        SetVpsUniform(Vp, Vp_fr, Vp_f1, Vp_f2, VpOverP2AtZero);
+        grid->SetVp(Vp,Vp_fr,Vp_f1,Vp_f2,VpOverP2AtZero);
+        return;
+    }
+
     // Initialize isTrapped and theta bounce points. True if any isTrapped.
-    bool hasTrapped = InitializeBounceIntegralQuantities();
+    bool hasTrapped = InitializeBounceIntegralQuantities(cache);
 
     // true if data should be stored on trapped grid (ie not adaptive quad) 
     bool storeTrapped =  hasTrapped && !integrateTrappedAdaptive;
@@ -149,11 +170,14 @@ void BounceAverager::Rebuild(){
 
     // Allocate memory
     if ( storePassing || storeTrapped)
-        Metric->AllocateData();
+        Metric->AllocateData(
+            storeTrapped ? ntheta_interp_trapped : 0,
+            storePassing ? ntheta_interp_passing : 0
+        );
     if(storeTrapped){
-        BOverBmin->AllocateData();
-        ROverR0->AllocateData();
-        NablaR2->AllocateData();
+        BOverBmin->AllocateData(ntheta_interp_trapped);
+        ROverR0->AllocateData(ntheta_interp_trapped);
+        NablaR2->AllocateData(ntheta_interp_trapped);
     }
 
     // If using fixed quadrature on passing grid, store metric on passing theta grid
@@ -171,6 +195,20 @@ void BounceAverager::Rebuild(){
 
     // Calculate bounce-averaged metric and hand over to grid 
     real_t **Vp, **Vp_fr, **Vp_f1, **Vp_f2, **VpOverP2AtZero;
+    // (the geometry cache is only used when the same momentum
+    // grid is used at all radii)
+    const len_t n1 = np1[0], n2 = np2[0];
+    if (cache != nullptr &&
+        cache->Get("ba/Vp", Vp, nr, n1*n2) &&
+        cache->Get("ba/Vp_fr", Vp_fr, nr+1, n1*n2) &&
+        cache->Get("ba/Vp_f1", Vp_f1, nr, (n1+1)*n2) &&
+        cache->Get("ba/Vp_f2", Vp_f2, nr, n1*(n2+1)) &&
+        cache->Get("ba/VpOverP2AtZero", VpOverP2AtZero, nr, n2)) {
+
+        grid->SetVp(Vp,Vp_fr,Vp_f1,Vp_f2,VpOverP2AtZero);
+        return;
+    }
+
     bool isPXiGrid = true; 
     if(isPXiGrid)
         SetVpsPXi(Vp, Vp_f1, VpOverP2AtZero);
@@ -181,29 +219,55 @@ void BounceAverager::Rebuild(){
     SetVp(Vp_fr,FLUXGRIDTYPE_RADIAL);
     SetVp(Vp_f2,FLUXGRIDTYPE_P2);
 
+    if (cache != nullptr) {
+        cache->Put("ba/Vp", Vp, nr, n1*n2);
+        cache->Put("ba/Vp_fr", Vp_fr, nr+1, n1*n2);
+        cache->Put("ba/Vp_f1", Vp_f1, nr, (n1+1)*n2);
+        cache->Put("ba/Vp_f2", Vp_f2, nr, n1*(n2+1));
+        cache->Put("ba/VpOverP2AtZero", VpOverP2AtZero, nr, n2);
+    }
+
     grid->SetVp(Vp,Vp_fr,Vp_f1,Vp_f2,VpOverP2AtZero);
 }
 
+/**
+ * Add all settings of this BounceAverager (and of the
+ * FluxSurfaceAverager it uses) which affect the bounce
+ * averages to the given geometry cache key.
+ */
+void BounceAverager::AddToHash(GeometryCache::Hash &h) const {
+    fluxSurfaceAverager->AddToHash(h);
+
+    h.Add(integrateTrappedAdaptive);
+    h.Add(integratePassingAdaptive);
+    h.Add(ntheta_interp_trapped);
+    if (!integrateTrappedAdaptive) {
+        h.Add(theta_trapped_ref, ntheta_interp_trapped);
+        h.Add(weights_trapped_ref, ntheta_interp_trapped);
+    }
+}
+
 /**
  *  Allocate and set VPrime to the bounce integral of the metric
  */
 void BounceAverager::SetVp(real_t**&Vp, fluxGridType fluxGridType){
     len_t nr = this->nr + (fluxGridType == FLUXGRIDTYPE_RADIAL);
-    // XXX: assume same grid at all radii
-    len_t n1 = np1[0] + (fluxGridType == FLUXGRIDTYPE_P1 ? 1 : 0);
-    len_t n2 = np2[0] + (fluxGridType == FLUXGRIDTYPE_P2 ? 1 : 0);
     Vp = new real_t*[nr];
-    // XXX: assumes p-xi grid
-    const real_t *p;
-    if(fluxGridType == FLUXGRIDTYPE_P1)
-        p = grid->GetMomentumGrid(0)->GetP_f1();
-    else if(fluxGridType == FLUXGRIDTYPE_P2)
-        p = grid->GetMomentumGrid(0)->GetP_f2();
-    else
-        p = grid->GetMomentumGrid(0)->GetP();
 
     bool isPXiGrid = true; 
-    for(len_t ir = 0; ir<nr; ir++){
+    Parallel::For(nr, Parallel::GetNumberOfThreads(), [&](const len_t ir) {
+        const len_t n1 = grid->GetNp1(ir, fluxGridType);
+        const len_t n2 = grid->GetNp2(ir, fluxGridType);
+        // XXX: assumes p-xi grid
+        const MomentumGrid *mg = grid->GetMomentumGrid(ir, fluxGridType);
+        const real_t *p;
+        if(fluxGridType == FLUXGRIDTYPE_P1)
+            p = mg->GetP_f1();
+        else if(fluxGridType == FLUXGRIDTYPE_P2)
+            p = mg->GetP_f2();
+        else
+            p = mg->GetP();
+
         Vp[ir] = new real_t[n1*n2];
         for(len_t j = 0; j<n2; j++){
             if(isPXiGrid){ // assume Vp scales as ~p^2
@@ -220,7 +284,7 @@ void BounceAverager::SetVp(real_t**&Vp, fluxGridType fluxGridType){
                     );
                 }
         }
-    }
+    });
 }
 
 
@@ -234,11 +298,11 @@ void BounceAverager::SetVpsPXi(real_t**&Vp, real_t **&Vp_f1, real_t **&VpOverP2)
     Vp_f1    = new real_t*[nr];
     VpOverP2 = new real_t*[nr];
     
-    const real_t *p = grid->GetMomentumGrid(0)->GetP1();
-    const real_t *p_f = grid->GetMomentumGrid(0)->GetP1_f();
-    for(len_t ir = 0; ir<nr; ir++){
+    Parallel::For(nr, Parallel::GetNumberOfThreads(), [&](const len_t ir) {
         len_t n1 = np1[ir];
         len_t n2 = np2[ir];
+        const real_t *p = grid->GetMomentumGrid(ir)->GetP1();
+        const real_t *p_f = grid->GetMomentumGrid(ir)->GetP1_f();
         Vp[ir]       = new real_t[n1*n2];
         Vp_f1[ir]    = new real_t[(n1+1)*n2];
         VpOverP2[ir] = new real_t[n2];
@@ -250,9 +314,79 @@ void BounceAverager::SetVpsPXi(real_t**&Vp, real_t **&Vp_f1, real_t **&VpOverP2)
             }
             Vp_f1[ir][j*(n1+1)+n1] = VpOverP2[ir][j] * p_f[n1]*p_f[n1];                
         }
+    });
+}
+
+
+/**
+ * Allocate and set VPrime in a magnetic field which is uniform on the
+ * flux surfaces. Since xi = xi0 and B = Bmin everywhere, the metric is
+ * sqrt(g) = 2*pi*p^2*J, and the bounce integral of the metric reduces
+ * to 2*pi*p^2*VpVol (or 4*pi*p^2*VpVol when the pitch is not resolved,
+ * i.e. when Nxi = 1, in which case the integral is also taken over xi0).
+ */
+void BounceAverager::SetVpsUniform(real_t **&Vp, real_t **&Vp_fr, real_t **&Vp_f1, real_t **&Vp_f2, real_t **&VpOverP2){
+    Vp       = new real_t*[nr];
+    Vp_fr    = new real_t*[nr+1];
+    Vp_f1    = new real_t*[nr];
+    Vp_f2    = new real_t*[nr];
+    VpOverP2 = new real_t*[nr];
+
+    for(len_t ir = 0; ir<nr; ir++){
+        len_t n1 = np1[ir];
+        len_t n2 = np2[ir];
+        const real_t xiFactor = (n2==1) ? 4*M_PI : 2*M_PI;
+        const real_t *p = grid->GetMomentumGrid(ir)->GetP1();
+        const real_t *p_f = grid->GetMomentumGrid(ir)->GetP1_f();
+        Vp[ir]       = new real_t[n1*n2];
+        Vp_f1[ir]    = new real_t[(n1+1)*n2];
+        Vp_f2[ir]    = new real_t[n1*(n2+1)];
+        VpOverP2[ir] = new real_t[n2];
+
+        const real_t V = xiFactor * grid->GetRadialGrid()->GetVpVol(ir);
+        for(len_t j = 0; j<n2; j++){
+            VpOverP2[ir][j] = V;
+            for(len_t i = 0; i<n1; i++)
+                Vp[ir][j*n1+i] = V * p[i]*p[i];
+            for(len_t i = 0; i<=n1; i++)
+                Vp_f1[ir][j*(n1+1)+i] = V * p_f[i]*p_f[i];
+        }
+        for(len_t j = 0; j<=n2; j++)
+            for(len_t i = 0; i<n1; i++)
+                Vp_f2[ir][j*n1+i] = V * p[i]*p[i];
+    }
+
+    for(len_t ir = 0; ir<=nr; ir++){
+        const len_t n1 = grid->GetNp1_fr(ir), n2 = grid->GetNp2_fr(ir);
+        const real_t xiFactor = (n2==1) ? 4*M_PI : 2*M_PI;
+        const real_t *p = grid->GetMomentumGrid_fr(ir)->GetP1();
+        Vp_fr[ir] = new real_t[n1*n2];
+        const real_t V = xiFactor * grid->GetRadialGrid()->GetVpVol_f(ir);
+        for(len_t j = 0; j<n2; j++)
+            for(len_t i = 0; i<n1; i++)
+                Vp_fr[ir][j*n1+i] = V * p[i]*p[i];
     }
 }
 
+/**
+ * Get R/R0 and |nabla r|^2 on flux surface 'ir' in a magnetic
+ * field which is uniform on the flux surfaces, in which case the
+ * bounce average of F(xi/xi0, B/Bmin, R/R0, |nabla r|^2) is simply
+ * F(1, 1, R/R0, |nabla r|^2).
+ *
+ * RETURNS false if the bounce average vanishes identically on
+ * the flux surface (i.e. if V' = 0, as at r = 0).
+ */
+bool BounceAverager::GetUniformGeometry(len_t ir, fluxGridType fluxGridType, real_t &ROverR0, real_t &NablaR2){
+    const real_t VpVol = (fluxGridType == FLUXGRIDTYPE_RADIAL) ?
+        grid->GetRadialGrid()->GetVpVol_f(ir) : grid->GetRadialGrid()->GetVpVol(ir);
+    if(VpVol == 0)
+        return false;
+
+    real_t B, Jacobian;
+    fluxSurfaceAverager->GeometricQuantitiesAtTheta(ir, 0, B, Jacobian, ROverR0, NablaR2, fluxGridType);
+    return true;
+}
 
 
 /**
@@ -260,13 +394,38 @@ void BounceAverager::SetVpsPXi(real_t**&Vp, real_t **&Vp_f1, real_t **&VpOverP2)
  *      F = F(xi/xi0, B/Bmin, R/R0, |nabla r|^2) on grid point (ir,i,j).
  */ 
 real_t BounceAverager::CalculateBounceAverage(len_t ir, len_t i, len_t j, fluxGridType fluxGridType, real_t(*F)(real_t,real_t,real_t,real_t,void*), void *par, const int_t *F_list){
+    // (when Nxi = 1, the bounce average is also averaged over xi0)
+    if(fieldIsUniform && !HasSinglePitchCell(ir, fluxGridType)){
+        real_t ROverR0, NablaR2;
+        if(!GetUniformGeometry(ir, fluxGridType, ROverR0, NablaR2))
+            return 0;
+        if(F_list != nullptr)
+            return FluxSurfaceAverager::AssembleBAFunc(1, 1, ROverR0, NablaR2, F_list);
+        else
+            return F(1, 1, ROverR0, NablaR2, par);
+    }
+
+    real_t norm = GetBounceAverageNormalization(ir,i,j,fluxGridType);
+    if(norm == 0)
+        return 0;
+
+    return norm * EvaluateBounceIntegralOverP2(ir,i,j,fluxGridType, F, par, F_list);
+}
+
+/**
+ * Returns the factor which converts the bounce integral over p^2
+ * in grid point (ir,i,j) to a bounce average (i.e. p^2/V'), or 0
+ * if the bounce average vanishes identically in the point.
+ */
+real_t BounceAverager::GetBounceAverageNormalization(len_t ir, len_t i, len_t j, fluxGridType fluxGridType){
     real_t Vp, p, preFactor;
+    const MomentumGrid *mg = grid->GetMomentumGrid(ir, fluxGridType);
     if(fluxGridType == FLUXGRIDTYPE_P1)
-        p = grid->GetMomentumGrid(0)->GetP_f1(i,j);
+        p = mg->GetP_f1(i,j);
     else if(fluxGridType == FLUXGRIDTYPE_P2)
-        p = grid->GetMomentumGrid(0)->GetP_f2(i,j);
+        p = mg->GetP_f2(i,j);
     else
-        p = grid->GetMomentumGrid(0)->GetP(i,j);
+        p = mg->GetP(i,j);
 
     if(p==0){
         Vp = grid->GetVpOverP2AtZero(ir)[j];
@@ -279,12 +438,7 @@ real_t BounceAverager::CalculateBounceAverage(len_t ir, len_t i, len_t j, fluxGr
     if(!Vp)
         return 0;
 
-    real_t BI = preFactor * EvaluateBounceIntegralOverP2(ir,i,j,fluxGridType, F, par, F_list);
-    if(!BI)
-        return 0;
-        
-    // Otherwise, use regular definition:
-    return BI / Vp;
+    return preFactor / Vp;
 }
 
 
@@ -296,7 +450,7 @@ real_t BounceAverager::CalculateBounceAverage(len_t ir, len_t i, len_t j, fluxGr
  * Bounce averages for further details.
  */
 real_t BounceAverager::EvaluateBounceIntegralOverP2(len_t ir, len_t i, len_t j, fluxGridType fluxGridType, real_t(*F_ref)(real_t,real_t,real_t,real_t,void*), void *F_ref_par, const int_t *Flist){
-    if(np2[0]==1){
+    if(HasSinglePitchCell(ir, fluxGridType)){
         if(Flist != nullptr){
             if(Flist[0]%2==1)
                 return 0;
@@ -397,6 +551,7 @@ real_t BounceAverager::EvaluateBounceIntegralOverP2(len_t ir, len_t i, len_t j,
         if(isTrapped && F_eval(0,1,1,1,&params)!=0)
             params.integrateQAWS = true;
 
+        gsl_integration_workspace *gsl_adaptive = FluxSurfaceAverager::GetWorkspace().adaptive;
         gsl_function GSL_func; 
 
         GSL_func.function = &(FluxSurfaceAverager::BounceIntegralFunction);
@@ -410,36 +565,106 @@ real_t BounceAverager::EvaluateBounceIntegralOverP2(len_t ir, len_t i, len_t j,
     }
 
     // otherwise continue and use the chosen fixed quadrature
+    struct fixed_quadrature q;
+    SetFixedQuadrature(ir,i,j,fluxGridType,isTrapped,xi0,theta_b1,theta_b2,SingularPointCorrection,q);
 
-    const real_t *BOverBmin = this->BOverBmin->GetData(ir,i,j,fluxGridType);
-    const real_t *ROverR0   = this->ROverR0->GetData(ir,i,j,fluxGridType);
-    const real_t *NablaR2   = this->NablaR2->GetData(ir,i,j,fluxGridType);
-    const real_t *Metric    = this->Metric->GetData(ir,i,j,fluxGridType);
-
-    len_t ntheta;
-    const real_t *weights;
-    real_t weightScaleFactor;
-    if(isTrapped){
-        ntheta  = ntheta_interp_trapped;
-        weights = weights_trapped_ref;
-        weightScaleFactor = theta_b2-theta_b1;
-    } else {
-        ntheta  = ntheta_interp_passing;
-        weights = this->weights_passing;
-        weightScaleFactor = 1;
-    }
-        
     bool hasFList = (Flist_eval != nullptr);
-    for (len_t it = 0; it<ntheta; it++) {
+    for (len_t it = 0; it<q.ntheta; it++) {
         // treat the singular cylindrical case 
-        real_t xiOverXi0 = MomentumGrid::evaluateXiOverXi0(xi0, BOverBmin[it]);
-        real_t w = weightScaleFactor*weights[it];
+        real_t xiOverXi0 = MomentumGrid::evaluateXiOverXi0(xi0, q.BOverBmin[it]);
         real_t Function = hasFList ? 
-            fluxSurfaceAverager->AssembleBAFunc(xiOverXi0, BOverBmin[it], ROverR0[it], NablaR2[it], Flist_eval)
-            : F_eval(xiOverXi0,BOverBmin[it],ROverR0[it],NablaR2[it],&params);
-        BounceIntegral += 2*M_PI*w*Metric[it]*Function;
+            fluxSurfaceAverager->AssembleBAFunc(xiOverXi0, q.BOverBmin[it], q.ROverR0[it], q.NablaR2[it], Flist_eval)
+            : F_eval(xiOverXi0,q.BOverBmin[it],q.ROverR0[it],q.NablaR2[it],&params);
+        BounceIntegral += q.weights[it]*q.Metric[it]*Function;
     }        
-    return SingularPointCorrection*BounceIntegral;    
+    return q.scaleFactor*BounceIntegral;    
+}
+
+/**
+ * Check whether the bounce integral in grid point (ir,i,j) is
+ * evaluated with the fixed quadrature (i.e. without any of the
+ * special treatments of 'EvaluateBounceIntegralOverP2()') and, if so,
+ * set the quadrature rule to use for the point.
+ *
+ * RETURNS true if the bounce integral can be evaluated with the
+ * quadrature rule 'q', and false if the general method must be used.
+ */
+bool BounceAverager::GetFixedQuadrature(len_t ir, len_t i, len_t j, fluxGridType fluxGridType, struct fixed_quadrature &q){
+    if(HasSinglePitchCell(ir, fluxGridType))
+        return false;
+
+    // Cells that will be mirrored
+    if(fluxGridType != FLUXGRIDTYPE_P2){
+        real_t xi_f2 = GetXi0(ir,i,j+1,FLUXGRIDTYPE_P2);
+        real_t xiT = (fluxGridType==FLUXGRIDTYPE_RADIAL) ? grid->GetRadialGrid()->GetXi0TrappedBoundary_fr(ir) : grid->GetRadialGrid()->GetXi0TrappedBoundary(ir);
+        if(xi_f2 < 100*realeps && xi_f2 > -xiT && xiT > 0)
+            return false;
+    }
+
+    real_t xi0 = GetXi0(ir,i,j,fluxGridType);
+    bool isTrapped = BounceSurfaceQuantity::IsTrapped(ir,i,j,fluxGridType,grid);
+    real_t Bmin = fluxSurfaceAverager->GetBmin(ir,fluxGridType);
+    real_t Bmax = fluxSurfaceAverager->GetBmax(ir,fluxGridType);
+
+    // Cells containing the trapped-passing boundary or xi0=0
+    if(Bmin!=Bmax && (fluxGridType==FLUXGRIDTYPE_DISTRIBUTION)){
+        real_t xi_f1 = GetXi0(ir,i,j,FLUXGRIDTYPE_P2);
+        real_t xi_f2 = GetXi0(ir,i,j+1,FLUXGRIDTYPE_P2);
+        if(xi_f1>xi_f2){
+            real_t xi_tmp = xi_f1;
+            xi_f1 = xi_f2;
+            xi_f2 = xi_tmp;
+        }
+        if(fluxSurfaceAverager->shouldCellAverageBounceIntegral(ir,xi_f1,xi_f2, fluxGridType) || (xi_f1 < 0 && xi_f2 > 0))
+            return false;
+    }
+
+    if( (isTrapped && (xi0<100*realeps || integrateTrappedAdaptive)) || ((!isTrapped) && integratePassingAdaptive) )
+        return false;
+
+    real_t theta_b1 = BounceSurfaceQuantity::Theta_B1(ir,i,j,fluxGridType,grid);
+    real_t theta_b2 = BounceSurfaceQuantity::Theta_B2(ir,i,j,fluxGridType,grid);
+
+    // there are two identical and mirrored intervals which contribute
+    real_t correction = (geometryIsSymmetric && theta_b1>0) ? 2 : 1;
+
+    SetFixedQuadrature(ir,i,j,fluxGridType,isTrapped,xi0,theta_b1,theta_b2,correction,q);
+    return true;
+}
+
+/**
+ * Set the fixed quadrature rule to use for evaluating the bounce
+ * integral in grid point (ir,i,j).
+ *
+ * isTrapped:  Whether or not the orbit is trapped.
+ * xi0:        Pitch of the grid point.
+ * theta_b1:   Lower bounce point.
+ * theta_b2:   Upper bounce point.
+ * correction: Factor multiplying the bounce integral (accounting for
+ *             mirrored intervals and singular points).
+ * q:          On return, contains the quadrature rule.
+ */
+void BounceAverager::SetFixedQuadrature(
+    len_t ir, len_t i, len_t j, fluxGridType fluxGridType, bool isTrapped,
+    real_t xi0, real_t theta_b1, real_t theta_b2, real_t correction,
+    struct fixed_quadrature &q
+){
+    q.BOverBmin = this->BOverBmin->GetData(ir,i,j,fluxGridType);
+    q.ROverR0   = this->ROverR0->GetData(ir,i,j,fluxGridType);
+    q.NablaR2   = this->NablaR2->GetData(ir,i,j,fluxGridType);
+    q.Metric    = this->Metric->GetData(ir,i,j,fluxGridType);
+    q.xi0       = xi0;
+    q.isTrapped = isTrapped;
+
+    if(isTrapped){
+        q.ntheta  = ntheta_interp_trapped;
+        q.weights = weights_trapped_ref;
+        q.scaleFactor = 2*M_PI*correction*(theta_b2-theta_b1);
+    } else {
+        q.ntheta  = ntheta_interp_passing;
+        q.weights = this->weights_passing;
+        q.scaleFactor = 2*M_PI*correction;
+    }
 }
 
 
@@ -447,13 +672,13 @@ real_t BounceAverager::EvaluateBounceIntegralOverP2(len_t ir, len_t i, len_t j,
 /**
  * Set isTrapped and poloidal bounce points and hands over ownership to Grid.
  */
-bool BounceAverager::InitializeBounceIntegralQuantities(){
+bool BounceAverager::InitializeBounceIntegralQuantities(GeometryCache *cache){
     AllocateBounceIntegralQuantities();
     bool hasTrapped;
-    hasTrapped  = SetIsTrapped(isTrapped,    theta_b1,    theta_b2,    FLUXGRIDTYPE_DISTRIBUTION);
-    hasTrapped += SetIsTrapped(isTrapped_fr, theta_b1_fr, theta_b2_fr, FLUXGRIDTYPE_RADIAL);
-    hasTrapped += SetIsTrapped(isTrapped_f1, theta_b1_f1, theta_b2_f1, FLUXGRIDTYPE_P1);
-    hasTrapped += SetIsTrapped(isTrapped_f2, theta_b1_f2, theta_b2_f2, FLUXGRIDTYPE_P2);
+    hasTrapped  = SetIsTrapped(isTrapped,    theta_b1,    theta_b2,    FLUXGRIDTYPE_DISTRIBUTION, cache, "");
+    hasTrapped += SetIsTrapped(isTrapped_fr, theta_b1_fr, theta_b2_fr, FLUXGRIDTYPE_RADIAL, cache, "_fr");
+    hasTrapped += SetIsTrapped(isTrapped_f1, theta_b1_f1, theta_b2_f1, FLUXGRIDTYPE_P1, cache, "_f1");
+    hasTrapped += SetIsTrapped(isTrapped_f2, theta_b1_f2, theta_b2_f2, FLUXGRIDTYPE_P2, cache, "_f2");
 
     grid->SetBounceParameters(hasTrapped,
         isTrapped, isTrapped_fr, isTrapped_f1, isTrapped_f2,
@@ -465,26 +690,51 @@ bool BounceAverager::InitializeBounceIntegralQuantities(){
 
 /**
  * Helper function for InitializeBounceIntegralQuantities().
+ *
+ * cache:  Geometry cache to take the bounce points from (or
+ *         'nullptr' to always calculate them).
+ * suffix: Suffix identifying the grid in the cache.
  */
-bool BounceAverager::SetIsTrapped(bool **&isTrapped, real_t **&theta_b1, real_t **&theta_b2, fluxGridType fluxGridType){
+bool BounceAverager::SetIsTrapped(
+    bool **&isTrapped, real_t **&theta_b1, real_t **&theta_b2, fluxGridType fluxGridType,
+    GeometryCache *cache, const std::string& suffix
+){
     bool hasTrapped = false;
-    real_t Bmin, Bmax;
-    /**
-     * XXX: Here we assume same grid at all radii.
-     */
     len_t nr = this->nr + (fluxGridType == FLUXGRIDTYPE_RADIAL);
-    len_t n1 = np1[0] + (fluxGridType == FLUXGRIDTYPE_P1);
-    len_t n2 = np2[0]+ (fluxGridType == FLUXGRIDTYPE_P2);
-    for(len_t ir = 0; ir<nr; ir++){
+
+    // (the geometry cache is only used when the same momentum
+    // grid is used at all radii)
+    if (cache != nullptr) {
+        const len_t n1 = grid->GetNp1(0, fluxGridType);
+        const len_t n2 = grid->GetNp2(0, fluxGridType);
+        if (cache->Fill("ba/isTrapped"+suffix, isTrapped, nr, n1*n2) &&
+        cache->Fill("ba/isTrapped"+suffix, isTrapped, nr, n1*n2) &&
+            cache->Fill("ba/theta_b1"+suffix, theta_b1, nr, n1*n2) &&
+            cache->Fill("ba/theta_b2"+suffix, theta_b2, nr, n1*n2)) {
+
+            for (len_t ir = 0; ir < nr && !hasTrapped; ir++)
+                for (len_t i = 0; i < n1*n2; i++)
+                    if (isTrapped[ir][i]) { hasTrapped = true; break; }
+
+            return hasTrapped;
+        }
+    }
+
+    // (each radius records whether it has trapped orbits)
+    std::vector<char> trappedAt(nr, 0);
+    Parallel::For(nr, Parallel::GetNumberOfThreads(), [&](const len_t ir) {
+        const len_t n1 = grid->GetNp1(ir, fluxGridType);
+        const len_t n2 = grid->GetNp2(ir, fluxGridType);
+        gsl_root_fsolver *gsl_fsolver = FluxSurfaceAverager::GetWorkspace().fsolver;
         real_t theta_Bmin = 0, theta_Bmax = 0;
-        Bmin = fluxSurfaceAverager->GetBmin(ir,fluxGridType, &theta_Bmin);
-        Bmax = fluxSurfaceAverager->GetBmax(ir,fluxGridType, &theta_Bmax);
+        real_t Bmin = fluxSurfaceAverager->GetBmin(ir,fluxGridType, &theta_Bmin);
+        real_t Bmax = fluxSurfaceAverager->GetBmax(ir,fluxGridType, &theta_Bmax);
 
         // in cylindrical grid or at r=0, isTrapped is false and we skip to next radius 
         if(Bmin==Bmax){
             for(len_t i = 0; i<n1*n2; i++)
                 isTrapped[ir][i] = false;
-            continue;
+            return;
         }
 
         for(len_t j = 0; j<n2; j++)
@@ -493,7 +743,7 @@ bool BounceAverager::SetIsTrapped(bool **&isTrapped, real_t **&theta_b1, real_t
                 real_t xi0 = GetXi0(ir,i,j,fluxGridType);
                 if((1-xi0*xi0) > Bmin/Bmax){
                     isTrapped[ir][pind] = true;
-                    hasTrapped = true;
+                    trappedAt[ir] = 1;
                     if(std::abs(xi0)<100*realeps){ // xi0=0 case: infinitely deeply trapped
                         theta_b1[ir][pind] = theta_Bmin;
                         theta_b2[ir][pind] = theta_Bmin;
@@ -505,7 +755,20 @@ bool BounceAverager::SetIsTrapped(bool **&isTrapped, real_t **&theta_b1, real_t
                 } else 
                     isTrapped[ir][n1*j+i] = false;
             }
+    });
+
+    for (len_t ir = 0; ir < nr; ir++)
+        if (trappedAt[ir])
+            hasTrapped = true;
+
+    if (cache != nullptr) {
+        const len_t n1 = grid->GetNp1(0, fluxGridType);
+        const len_t n2 = grid->GetNp2(0, fluxGridType);
+        cache->Put("ba/isTrapped"+suffix, isTrapped, nr, n1*n2);
+        cache->Put("ba/theta_b1"+suffix, theta_b1, nr, n1*n2);
+        cache->Put("ba/theta_b2"+suffix, theta_b2, nr, n1*n2);
     }
+
     return hasTrapped;
 }
 
@@ -547,10 +810,9 @@ void BounceAverager::AllocateBounceIntegralQuantities(){
         theta_b1_f2[ir]  = new real_t[n1*n2];
         theta_b2_f2[ir]  = new real_t[n1*n2];
     }
-    // XXX: Assume same momentum grid at all radii
     for(len_t ir = 0; ir<=nr; ir++){
-        n1 = np1[0];
-        n2 = np2[0];
+        n1 = grid->GetNp1_fr(ir);
+        n2 = grid->GetNp2_fr(ir);
         isTrapped_fr[ir] = new bool[n1*n2];
         theta_b1_fr[ir]  = new real_t[n1*n2];
         theta_b2_fr[ir]  = new real_t[n1*n2];
@@ -558,16 +820,25 @@ void BounceAverager::AllocateBounceIntegralQuantities(){
 }
 
 
+/**
+ * Returns 'true' if the pitch is not resolved (Nxi = 1) on the
+ * momentum grid of the given flux grid at radius 'ir'.
+ */
+bool BounceAverager::HasSinglePitchCell(len_t ir, fluxGridType fluxGridType) const {
+    return (grid->GetMomentumGrid(ir, fluxGridType)->GetNp2() == 1);
+}
+
+
 /**
  * Helper function to get xi0 from MomentumGrid.
- * XXX: Assume same momentum grid at all radii
  */
-real_t BounceAverager::GetXi0(len_t /*ir*/, len_t /*i*/, len_t j, fluxGridType fluxGridType)
+real_t BounceAverager::GetXi0(len_t ir, len_t /*i*/, len_t j, fluxGridType fluxGridType)
 {
+    const MomentumGrid *mg = grid->GetMomentumGrid(ir, fluxGridType);
     if(fluxGridType==FLUXGRIDTYPE_P2)
-        return grid->GetMomentumGrid(0)->GetP2_f(j);
+        return mg->GetP2_f(j);
     else 
-        return grid->GetMomentumGrid(0)->GetP2(j);
+        return mg->GetP2(j);
 
     /*
     if (fluxGridType == FLUXGRIDTYPE_P1) 
@@ -5,8 +5,10 @@
  * normalized to a factor of p^2
  */
 
+#include <vector>
 #include "FVM/Grid/BounceSurfaceMetric.hpp"
 #include "FVM/Grid/fluxGridType.enum.hpp"
+#include "FVM/Parallel.hpp"
 
 
 using namespace DREAM::FVM;
@@ -46,14 +48,11 @@ void BounceSurfaceMetric::SetDataForPassing(
 
 /**
  * Interpolates data to the poloidal bouncegrid (trapped theta grid).
- * XXX: Assumes same momentum grid at all radii
  */
 void BounceSurfaceMetric::InterpolateToBounceGrid(
-    real_t ***&bounceData, fluxGridType fluxGridType)
+    struct bouncedata &bounceData, fluxGridType fluxGridType)
 {
     len_t nr = this->nr + (fluxGridType==FLUXGRIDTYPE_RADIAL);
-    len_t n1 = np1[0] + (fluxGridType==FLUXGRIDTYPE_P1);
-    len_t n2 = np2[0] + (fluxGridType==FLUXGRIDTYPE_P2);
     const real_t *Bmin;
     if(fluxGridType == FLUXGRIDTYPE_RADIAL)
         Bmin = grid->GetRadialGrid()->GetBmin_f();
@@ -64,15 +63,16 @@ void BounceSurfaceMetric::InterpolateToBounceGrid(
 
     bool isPXiGrid = true;
     if(isPXiGrid) {
-        FVM::MomentumGrid *mg = grid->GetMomentumGrid(0);
-        const real_t *xi0;
-        if(fluxGridType == FLUXGRIDTYPE_P2)
-            xi0 = mg->GetP2_f();
-        else 
-            xi0 = mg->GetP2();
-
-        real_t *tmp = new real_t[ntheta_interp_trapped];
-        for(len_t ir = 0; ir<nr; ir++)
+        Parallel::ForWithScratch<std::vector<real_t>>(nr, Parallel::GetNumberOfThreads(), [&](const len_t ir, std::vector<real_t> &tmp) {
+            const len_t n1 = grid->GetNp1(ir, fluxGridType);
+            const len_t n2 = grid->GetNp2(ir, fluxGridType);
+            FVM::MomentumGrid *mg = grid->GetMomentumGrid(ir, fluxGridType);
+            const real_t *xi0;
+            if(fluxGridType == FLUXGRIDTYPE_P2)
+                xi0 = mg->GetP2_f();
+            else 
+                xi0 = mg->GetP2();
+
             for(len_t j=0; j<n2; j++)
                 if(IsTrapped(ir,0,j,fluxGridType,grid)){
                     for(len_t it=0; it<ntheta_interp_trapped; it++){
@@ -86,20 +86,20 @@ void BounceSurfaceMetric::InterpolateToBounceGrid(
                         tmp[it] = Jacobian * mg->evaluatePXiMetricOverP2(xiOverXi0,BOverBmin);
                     }
                     for(len_t i=0; i<n1; i++){ 
-                        len_t pind = n1*j+i;
-                        bounceData[ir][pind] = new real_t[ntheta_interp_trapped];
+                        real_t *d = bounceData.At(ir,i,j);
                         for(len_t it=0; it<ntheta_interp_trapped; it++)
-                            bounceData[ir][pind][it] = tmp[it]; 
+                            d[it] = tmp[it]; 
                     }
                 }
-        delete [] tmp;
+        }, ntheta_interp_trapped);
     } else {
-        for(len_t ir = 0; ir<nr; ir++)
+        for(len_t ir = 0; ir<nr; ir++){
+            const len_t n1 = grid->GetNp1(ir, fluxGridType);
+            const len_t n2 = grid->GetNp2(ir, fluxGridType);
             for(len_t i=0; i<n1; i++)
                 for(len_t j=0; j<n2; j++)
                     if(IsTrapped(ir,i,j,fluxGridType,grid)){
-                        len_t pind = n1*j+i;
-                        bounceData[ir][pind] = new real_t[ntheta_interp_trapped];
+                        real_t *d = bounceData.At(ir,i,j);
                         for(len_t it=0; it<ntheta_interp_trapped; it++){
                             real_t theta = ThetaBounceAtIt(ir,i,j,it,fluxGridType);
                             real_t B,Jacobian,ROverR0,NablaR2;
@@ -108,10 +108,11 @@ void BounceSurfaceMetric::InterpolateToBounceGrid(
                             if(Bmin[ir]!=0)
                                 BOverBmin = B/Bmin[ir];
 
-                            grid->GetMomentumGrid(0)->EvaluateMetricOverP2(i,j,fluxGridType, 1, &theta,&BOverBmin, sqrtg_tmp);
-                            bounceData[ir][pind][it] = sqrtg_tmp[0] * Jacobian;
+                            grid->GetMomentumGrid(ir, fluxGridType)->EvaluateMetricOverP2(i,j,fluxGridType, 1, &theta,&BOverBmin, sqrtg_tmp);
+                            d[it] = sqrtg_tmp[0] * Jacobian;
                         }
                     }
+        }
     }
     delete [] sqrtg_tmp;
     trappedAllocated = true;
@@ -126,27 +127,26 @@ const real_t *BounceSurfaceMetric::GetData(len_t ir, len_t i, len_t j, fluxGridT
 
 /**
  * Interpolates data to the poloidal fluxgrid theta.
- * XXX: Assumes same momentum grid at all radii
  */
 void BounceSurfaceMetric::InterpolateToFluxGrid(
-    real_t ***&bounceData, fluxGridType fluxGridType,
+    struct bouncedata &bounceData, fluxGridType fluxGridType,
     len_t ntheta_interp_passing, const real_t *theta_passing){
     
     len_t nr = this->nr + (fluxGridType==FLUXGRIDTYPE_RADIAL);
-    len_t n1 = np1[0] + (fluxGridType==FLUXGRIDTYPE_P1);
-    len_t n2 = np2[0] + (fluxGridType==FLUXGRIDTYPE_P2);
 
     for(len_t ir = 0; ir<nr; ir++){
+        const len_t n1 = grid->GetNp1(ir, fluxGridType);
+        const len_t n2 = grid->GetNp2(ir, fluxGridType);
+        const MomentumGrid *mg = grid->GetMomentumGrid(ir, fluxGridType);
         const real_t *BOverBmin = this->BOverBmin->GetData(ir,fluxGridType);
         const real_t *Jacobian  = this->fluxSurfaceQuantity->GetData(ir,fluxGridType);
         for(len_t i=0; i<n1; i++)
             for(len_t j=0; j<n2; j++)
                 if(!IsTrapped(ir,i,j,fluxGridType,grid)){
-                    len_t pind = n1*j+i;
-                    bounceData[ir][pind] = new real_t[ntheta_interp_passing];
-                    grid->GetMomentumGrid(0)->EvaluateMetricOverP2(i,j,fluxGridType, ntheta_interp_passing, theta_passing, BOverBmin, bounceData[ir][pind]);    
+                    real_t *d = bounceData.At(ir,i,j);
+                    mg->EvaluateMetricOverP2(i,j,fluxGridType, ntheta_interp_passing, theta_passing, BOverBmin, d);    
                     for(len_t it=0; it<ntheta_interp_passing; it++)
-                        bounceData[ir][pind][it] *= Jacobian[it];
+                        d[it] *= Jacobian[it];
                 }
     }
 }
@@ -163,35 +163,8 @@ const real_t BounceSurfaceMetric::evaluateAtTheta(len_t ir, len_t i, len_t j, re
 /**
  * Evaluates the metric at poloidal angle theta: Jacobian(ir,theta) * sqrtg( B(ir,theta),i,j)
  */
-const real_t BounceSurfaceMetric::evaluateAtTheta(len_t /*ir*/, len_t i, len_t j, real_t theta, real_t BOverBmin, real_t Jacobian, fluxGridType fluxGridType) const {
+const real_t BounceSurfaceMetric::evaluateAtTheta(len_t ir, len_t i, len_t j, real_t theta, real_t BOverBmin, real_t Jacobian, fluxGridType fluxGridType) const {
     real_t *sqrtg;
-    grid->GetMomentumGrid(0)->EvaluateMetricOverP2(i,j,fluxGridType, 1, &theta,&BOverBmin, sqrtg);
+    grid->GetMomentumGrid(ir, fluxGridType)->EvaluateMetricOverP2(i,j,fluxGridType, 1, &theta,&BOverBmin, sqrtg);
     return *(sqrtg) * Jacobian;
 }
-
-/**
- * Deallocator
- */
-void BounceSurfaceMetric::DeleteData(real_t ***&data, len_t nr, len_t np1, len_t np2, fluxGridType fluxGrid){
-    for(len_t ir=0; ir<nr; ir++){
-        for (len_t j = 0; j < np2; j++) {
-            for(len_t i = 0; i<np1; i++){
-                bool trap = false;
-                switch (fluxGrid) {
-                    case FLUXGRIDTYPE_DISTRIBUTION: trap = grid->IsTrapped(ir, i, j); break;
-                    case FLUXGRIDTYPE_RADIAL: trap = grid->IsTrapped_fr(ir, i, j); break;
-                    case FLUXGRIDTYPE_P1: trap = grid->IsTrapped_f1(ir, i, j); break;
-                    case FLUXGRIDTYPE_P2: trap = grid->IsTrapped_f2(ir, i, j); break;
-                    default: break;
-                }
-
-                // delete only if allocated
-                if( (trap && trappedAllocated) || ( (!trap) && passingAllocated) ) 
-                    delete [] data[ir][j*np1 + i];
-            }
-        }         
-        delete [] data[ir];
-    }
-    delete [] data;
-}
-    
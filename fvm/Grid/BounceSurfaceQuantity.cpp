@@ -4,8 +4,11 @@
  * to corresponding FluxSurfaceQuantity.
  */
 
+#include <vector>
 #include "FVM/Grid/BounceSurfaceQuantity.hpp"
 #include "FVM/Grid/fluxGridType.enum.hpp"
+#include "FVM/MemoryAccounting.hpp"
+#include "FVM/Parallel.hpp"
 
 
 using namespace DREAM::FVM;
@@ -17,52 +20,56 @@ BounceSurfaceQuantity::BounceSurfaceQuantity(Grid *g, FluxSurfaceQuantity *fluxS
     : fluxSurfaceQuantity(fluxSurfaceQuantity), grid(g)
 {
     gsl_acc = gsl_interp_accel_alloc();
+
+    MemoryAccounting::Register(this, "grid/bouncesurface", [this]() { return this->GetMemoryUsage(); });
 }
 
 /**
  * Destructor.
  */
 BounceSurfaceQuantity::~BounceSurfaceQuantity(){
+    MemoryAccounting::Unregister(this);
     DeallocateData();
     gsl_interp_accel_free(gsl_acc);
 }
 
 /**
  * Interpolates data to the trapped poloidal theta grid.
- * XXX: Assumes same momentum grid at all radii
  */
 void BounceSurfaceQuantity::InterpolateToBounceGrid(
-    real_t ***&bounceData, fluxGridType fluxGridType
+    struct bouncedata &bounceData, fluxGridType fluxGridType
 ){
     len_t nr = this->nr + (fluxGridType==FLUXGRIDTYPE_RADIAL);
-    len_t n1 = np1[0] + (fluxGridType==FLUXGRIDTYPE_P1);
-    len_t n2 = np2[0] + (fluxGridType==FLUXGRIDTYPE_P2);
 
     // XXX optimization: assume p-xi grid
     bool isPXiGrid = true;
     if(isPXiGrid){
-        real_t *tmp = new real_t[ntheta_interp_trapped];
-        for(len_t ir = 0; ir<nr; ir++)
+        Parallel::ForWithScratch<std::vector<real_t>>(nr, Parallel::GetNumberOfThreads(), [&](const len_t ir, std::vector<real_t> &tmp) {
+            const len_t n1 = grid->GetNp1(ir, fluxGridType);
+            const len_t n2 = grid->GetNp2(ir, fluxGridType);
             for(len_t j=0; j<n2; j++)
                 if(IsTrapped(ir,0,j,fluxGridType, grid)){
                     for(len_t it=0; it<ntheta_interp_trapped; it++)
                         tmp[it] = fluxSurfaceQuantity->evaluateAtTheta(ir, ThetaBounceAtIt(ir,0,j,it,fluxGridType), fluxGridType);
                     for(len_t i=0; i<n1; i++){
-                        bounceData[ir][n1*j+i] = new real_t[ntheta_interp_trapped];
+                        real_t *d = bounceData.At(ir,i,j);
                         for(len_t it=0; it<ntheta_interp_trapped; it++)
-                            bounceData[ir][n1*j+i][it] = tmp[it];
+                            d[it] = tmp[it];
                     }
                 }
-        delete [] tmp;
+        }, ntheta_interp_trapped);
     } else {
-        for(len_t ir = 0; ir<nr; ir++)
+        for(len_t ir = 0; ir<nr; ir++){
+            const len_t n1 = grid->GetNp1(ir, fluxGridType);
+            const len_t n2 = grid->GetNp2(ir, fluxGridType);
             for(len_t i=0; i<n1; i++)
                 for(len_t j=0; j<n2; j++)
                     if(IsTrapped(ir,i,j,fluxGridType, grid)){
-                        bounceData[ir][n1*j+i] = new real_t[ntheta_interp_trapped];
+                        real_t *d = bounceData.At(ir,i,j);
                         for(len_t it=0; it<ntheta_interp_trapped; it++)
-                            bounceData[ir][n1*j+i][it] = fluxSurfaceQuantity->evaluateAtTheta(ir, ThetaBounceAtIt(ir,i,j,it,fluxGridType), fluxGridType);
+                            d[it] = fluxSurfaceQuantity->evaluateAtTheta(ir, ThetaBounceAtIt(ir,i,j,it,fluxGridType), fluxGridType);
                     }
+        }
     }
 }
 
@@ -147,13 +154,13 @@ real_t BounceSurfaceQuantity::Theta_B2(len_t ir, len_t i, len_t j, fluxGridType
 const real_t *BounceSurfaceQuantity::GetBounceData(len_t ir, len_t i, len_t j, fluxGridType fluxGridType) const {
     switch(fluxGridType){
         case FLUXGRIDTYPE_DISTRIBUTION:
-            return bounceData[ir][np1[ir]*j+i];
+            return bounceData.At(ir,i,j);
         case FLUXGRIDTYPE_RADIAL:
-            return bounceData_fr[ir][np1[0]*j+i];
+            return bounceData_fr.At(ir,i,j);
         case FLUXGRIDTYPE_P1:
-            return bounceData_f1[ir][(np1[ir]+1)*j+i];
+            return bounceData_f1.At(ir,i,j);
         case FLUXGRIDTYPE_P2:
-            return bounceData_f2[ir][np1[ir]*j+i];
+            return bounceData_f2.At(ir,i,j);
         default:
             throw FVMException("Invalid fluxGridType: '%d' called in BounceSurfaceQuantity.", fluxGridType);
             return nullptr;
@@ -188,40 +195,48 @@ real_t BounceSurfaceQuantity::ThetaBounceAtIt(len_t ir, len_t i, len_t j, len_t
 }
 
 /**
- * Deallocate one bounceData.
- * XXX: assumes same momentum grid at all radii
- */
-void BounceSurfaceQuantity::DeleteData(real_t ***&data, len_t nr, len_t np1, len_t np2, fluxGridType fluxgrid){
-    for(len_t ir=0; ir < nr; ir++){
-        for (len_t j = 0; j < np2; j++)
-            for(len_t i = 0; i < np1; i++) {
-                bool del = false;
-                switch (fluxgrid) {
-                    case FLUXGRIDTYPE_DISTRIBUTION: del = grid->IsTrapped(ir, i, j); break;
-                    case FLUXGRIDTYPE_RADIAL: del = grid->IsTrapped_fr(ir, i, j); break;
-                    case FLUXGRIDTYPE_P1: del = grid->IsTrapped_f1(ir, i, j); break;
-                    case FLUXGRIDTYPE_P2: del = grid->IsTrapped_f2(ir, i, j); break;
-                    default: del = false; break;
-                }
+ * Returns the number of bytes used for storing the values of
+ * this quantity on the poloidal grids of all phase-space points.
+ */
+size_t BounceSurfaceQuantity::GetMemoryUsage() const {
+    size_t n = 0;
+    for (const struct bouncedata *d : {&bounceData, &bounceData_fr, &bounceData_f1, &bounceData_f2}) {
+        if (d->offset == nullptr)
+            continue;
 
-                if (del)
-                    delete [] data[ir][j*np2+i];
-            }
-        delete [] data[ir];
+        const len_t N = d->cellOffset[d->nr];
+        n += (N+1 + 2*d->nr+1)*sizeof(len_t) + d->offset[N]*sizeof(real_t);
     }
-    delete [] data;
+
+    return n;
+}
+
+/**
+ * Deallocate one bounceData.
+ */
+void BounceSurfaceQuantity::DeleteData(struct bouncedata &data){
+    delete [] data.data;
+    delete [] data.offset;
+    delete [] data.cellOffset;
+    delete [] data.n1;
+
+    data.data   = nullptr;
+    data.offset = nullptr;
+    data.cellOffset = nullptr;
+    data.n1 = nullptr;
+    data.nr = 0;
 }
 
 /**
  * Deallocate all trapped data
  */
 void BounceSurfaceQuantity::DeallocateData(){
-    if(bounceData == nullptr)
+    if(bounceData.offset == nullptr)
         return;
-    DeleteData(bounceData,    nr,   np1[0],   np2[0], FLUXGRIDTYPE_DISTRIBUTION);
-    DeleteData(bounceData_fr, nr+1, np1[0],   np2[0], FLUXGRIDTYPE_RADIAL);
-    DeleteData(bounceData_f1, nr,   np1[0]+1, np2[0], FLUXGRIDTYPE_P1);
-    DeleteData(bounceData_f2, nr,   np1[0],   np2[0]+1, FLUXGRIDTYPE_P2);
+    DeleteData(bounceData);
+    DeleteData(bounceData_fr);
+    DeleteData(bounceData_f1);
+    DeleteData(bounceData_f2);
     
     trappedAllocated = false;
     passingAllocated = false;
@@ -229,20 +244,63 @@ void BounceSurfaceQuantity::DeallocateData(){
 }
 
 /**
- * Allocate bounceData.
+ * Allocate one bounceData. The layout (i.e. which points are trapped)
+ * is fixed at this point, so that the data can later be deallocated
+ * without consulting the grid (which may have changed by then).
+ *
+ * nr:             Number of radial points of the grid.
+ * fluxGridType:   Grid on which the data is stored.
+ * ntheta_trapped: Number of poloidal angles to store for each
+ *                 trapped point.
+ * ntheta_passing: Number of poloidal angles to store for each
+ *                 passing point.
  */
-void BounceSurfaceQuantity::AllocateSingle(real_t ***&bounceData, len_t nr, len_t n1, len_t n2){
-    bounceData = new real_t**[nr];    
-    for(len_t ir = 0; ir<nr; ir++)
-        bounceData[ir] = new real_t*[n1*n2];
+void BounceSurfaceQuantity::AllocateSingle(
+    struct bouncedata &bounceData, len_t nr,
+    fluxGridType fluxGridType, len_t ntheta_trapped, len_t ntheta_passing
+){
+    bounceData.nr = nr;
+    bounceData.n1 = new len_t[nr];
+    bounceData.cellOffset = new len_t[nr+1];
+    bounceData.cellOffset[0] = 0;
+    for(len_t ir = 0; ir<nr; ir++){
+        bounceData.n1[ir] = grid->GetNp1(ir, fluxGridType);
+        bounceData.cellOffset[ir+1] = bounceData.cellOffset[ir]
+            + bounceData.n1[ir]*grid->GetNp2(ir, fluxGridType);
+    }
+
+    const len_t N = bounceData.cellOffset[nr];
+    bounceData.offset = new len_t[N+1];
+
+    len_t offset = 0;
+    for(len_t ir = 0; ir<nr; ir++){
+        const len_t n1 = bounceData.n1[ir];
+        const len_t n2 = grid->GetNp2(ir, fluxGridType);
+        for(len_t j = 0; j<n2; j++)
+            for(len_t i = 0; i<n1; i++){
+                bounceData.offset[bounceData.cellOffset[ir]+j*n1+i] = offset;
+                if(IsTrapped(ir,i,j,fluxGridType,grid))
+                    offset += ntheta_trapped;
+                else
+                    offset += ntheta_passing;
+            }
+    }
+    bounceData.offset[N] = offset;
+    bounceData.data = new real_t[offset];
+    Parallel::FirstTouch(bounceData.data, offset);
 }
 
 /**
  * Allocate all trapped data.
+ *
+ * ntheta_trapped: Number of poloidal angles to store for each
+ *                 trapped point.
+ * ntheta_passing: Number of poloidal angles to store for each
+ *                 passing point (only used by the metric).
  */
-void BounceSurfaceQuantity::AllocateData(){
-    AllocateSingle(bounceData, nr, np1[0], np2[0]);
-    AllocateSingle(bounceData_fr, nr+1, np1[0], np2[0]);
-    AllocateSingle(bounceData_f1, nr, np1[0]+1, np2[0]);
-    AllocateSingle(bounceData_f2, nr, np1[0], np2[0]+1);
+void BounceSurfaceQuantity::AllocateData(len_t ntheta_trapped, len_t ntheta_passing){
+    AllocateSingle(bounceData,    nr,   FLUXGRIDTYPE_DISTRIBUTION, ntheta_trapped, ntheta_passing);
+    AllocateSingle(bounceData_fr, nr+1, FLUXGRIDTYPE_RADIAL, ntheta_trapped, ntheta_passing);
+    AllocateSingle(bounceData_f1, nr,   FLUXGRIDTYPE_P1, ntheta_trapped, ntheta_passing);
+    AllocateSingle(bounceData_f2, nr,   FLUXGRIDTYPE_P2, ntheta_trapped, ntheta_passing);
 }
@@ -170,6 +170,10 @@ real_t FluxSurfaceAverager::EvaluateAvalancheDeltaHat(len_t ir, real_t p, real_t
     h_gsl_func.function = &(hIntegrand);
     h_gsl_func.params = &h_params;
     
+    struct thread_workspace &ws = GetWorkspace();
+    gsl_integration_workspace *gsl_adaptive = ws.adaptive;
+    gsl_root_fsolver *gsl_fsolver = ws.fsolver;
+
     // settings for integral
     real_t epsabs = 0, epsrel = 1e-4, lim = gsl_adaptive->limit, error;
     real_t deltaHat;
@@ -6,9 +6,15 @@
  * It is initialized (or refreshed) with Rebuild(), which should
  * be called after RadialGridGenerator has called 
  * SetReferenceMagneticFieldData(...).
+ *
+ * The radial loops of Rebuild() (and of the BounceAverager) are
+ * parallelized (see 'FVM::Parallel'). Since the GSL integration and root-finding
+ * workspaces cannot be shared between threads, one set of workspaces
+ * is allocated for each thread (see 'GetWorkspace()').
  */
 
 #include "FVM/Grid/FluxSurfaceAverager.hpp"
+#include "FVM/Parallel.hpp"
 #include "gsl/gsl_errno.h"
 using namespace std;
 using namespace DREAM::FVM;
@@ -21,7 +27,7 @@ FluxSurfaceAverager::FluxSurfaceAverager(
     RadialGrid *g, RadialGridGenerator *rgg, bool geometryIsSymmetric, len_t ntheta_interp,
     interp_method i_method, quadrature_method q_method
 ) : rGrid(g), gridGenerator(rgg), geometryIsSymmetric(geometryIsSymmetric), 
-    ntheta_interp(ntheta_interp) {
+    interpMethod(i_method), ntheta_interp(ntheta_interp) {
     const gsl_interp_type *interpolationMethod;
     switch(i_method){
         case INTERP_LINEAR:
@@ -40,25 +46,25 @@ FluxSurfaceAverager::FluxSurfaceAverager(
 
     InitializeQuadrature(q_method);
 
+    fieldIsUniform = gridGenerator->IsFieldUniform();
+
     BOverBmin = new FluxSurfaceQuantity(rGrid, [rgg,g](len_t ir, real_t theta){if(!g->GetBmin(ir)) return 1.0; else return rgg->BAtTheta(ir,theta)/g->GetBmin(ir);}, [rgg,g](len_t ir, real_t theta){if(!g->GetBmin_f(ir)) return 1.0; else return rgg->BAtTheta_f(ir,theta)/g->GetBmin_f(ir);}, interpolationMethod);
     Jacobian  = new FluxSurfaceQuantity(rGrid, [rgg](len_t ir, real_t theta){return rgg->JacobianAtTheta(ir,theta);},           [rgg](len_t ir, real_t theta){return rgg->JacobianAtTheta_f(ir,theta);}, interpolationMethod);
     ROverR0   = new FluxSurfaceQuantity(rGrid, [rgg](len_t ir, real_t theta){return rgg->ROverR0AtTheta(ir,theta);},            [rgg](len_t ir, real_t theta){return rgg->ROverR0AtTheta_f(ir,theta);}, interpolationMethod);
     NablaR2   = new FluxSurfaceQuantity(rGrid, [rgg](len_t ir, real_t theta){return rgg->NablaR2AtTheta(ir,theta);},            [rgg](len_t ir, real_t theta){return rgg->NablaR2AtTheta_f(ir,theta);}, interpolationMethod);
 
-    // Use the Brent algorithm for root finding in determining the theta bounce points
-    const gsl_root_fsolver_type *GSL_rootsolver_type = gsl_root_fsolver_brent;
-    gsl_fsolver = gsl_root_fsolver_alloc (GSL_rootsolver_type);
     qaws_table = gsl_integration_qaws_table_alloc(-0.5, -0.5, 0, 0);
+    xiCellTable_lo = gsl_integration_glfixed_table_alloc(8);
+    xiCellTable_hi = gsl_integration_glfixed_table_alloc(16);
 }
 
 /**
  * Destructor
  */
 FluxSurfaceAverager::~FluxSurfaceAverager(){
-    gsl_root_fsolver_free(gsl_fsolver);
-
     DeallocateQuadrature();
     DeallocateReferenceData();
+    DeallocateWeightedJacobian();
     delete BOverBmin;
     delete Jacobian;
     delete ROverR0;
@@ -69,29 +75,163 @@ FluxSurfaceAverager::~FluxSurfaceAverager(){
 /**
  * (Re-)Initializes everyting required to perform flux surface averages.
  * Should be called after SetReferenceMagneticFieldData(...).
+ *
+ * cache: If not 'nullptr', the flux-surface averaged Jacobian is
+ *        taken from (or, if missing, added to) this geometry cache.
  */
-void FluxSurfaceAverager::Rebuild(){
+void FluxSurfaceAverager::Rebuild(GeometryCache *cache){
     this->nr = rGrid->GetNr();
 
     // if using fixed quadrature, store all quantities on the theta grid
     if(!integrateAdaptive){
-        BOverBmin->InterpolateMagneticDataToTheta(theta, ntheta_interp);
-        Jacobian->InterpolateMagneticDataToTheta(theta, ntheta_interp);
-        ROverR0->InterpolateMagneticDataToTheta(theta, ntheta_interp);
-        NablaR2->InterpolateMagneticDataToTheta(theta, ntheta_interp);
+        InterpolateMagneticDataToTheta();
+        SetWeightedJacobian();
     }
 
+    real_t *VpVol = nullptr, *VpVol_f = nullptr;
+    if (cache != nullptr && cache->Get("fsa/VpVol", VpVol, nr) && cache->Get("fsa/VpVol_f", VpVol_f, nr+1)) {
+        rGrid->SetVpVol(VpVol,VpVol_f);
+        return;
+    } else if (VpVol != nullptr)
+        delete [] VpVol;
+
     // Calculate flux-surface averaged Jacobian and hand over to RadialGrid.
-    real_t *VpVol   = new real_t[nr];
-    real_t *VpVol_f = new real_t[nr+1];    
-    for(len_t ir=0; ir<nr;  ir++)
+    VpVol   = new real_t[nr];
+    VpVol_f = new real_t[nr+1];    
+    Parallel::For(nr, Parallel::GetNumberOfThreads(), [&](const len_t ir) {
         VpVol[ir]   = EvaluateFluxSurfaceIntegral(ir, FLUXGRIDTYPE_DISTRIBUTION, RadialGrid::FSA_FUNC_UNITY, nullptr, RadialGrid::FSA_PARAM_UNITY);
-    for(len_t ir=0; ir<=nr; ir++)
+    });
+    Parallel::For(nr+1, Parallel::GetNumberOfThreads(), [&](const len_t ir) {
         VpVol_f[ir] = EvaluateFluxSurfaceIntegral(ir, FLUXGRIDTYPE_RADIAL, RadialGrid::FSA_FUNC_UNITY, nullptr, RadialGrid::FSA_PARAM_UNITY);
+    });
+
+    if (cache != nullptr) {
+        cache->Put("fsa/VpVol", VpVol, nr);
+        cache->Put("fsa/VpVol_f", VpVol_f, nr+1);
+    }
     
     rGrid->SetVpVol(VpVol,VpVol_f);
 }
 
+/**
+ * Evaluate and store B/Bmin, the Jacobian, R/R0 and |nabla r|^2 on
+ * the theta grid of the fixed quadrature. All quantities are evaluated
+ * together, one flux surface at a time, which allows the grid
+ * generator to share the work between them.
+ */
+void FluxSurfaceAverager::InterpolateMagneticDataToTheta(){
+    real_t **B = new real_t*[nr],   **J = new real_t*[nr],
+        **R = new real_t*[nr],      **N = new real_t*[nr];
+    real_t **B_f = new real_t*[nr+1], **J_f = new real_t*[nr+1],
+        **R_f = new real_t*[nr+1],    **N_f = new real_t*[nr+1];
+
+    for(len_t ir=0; ir<nr; ir++){
+        B[ir] = new real_t[ntheta_interp];
+        J[ir] = new real_t[ntheta_interp];
+        R[ir] = new real_t[ntheta_interp];
+        N[ir] = new real_t[ntheta_interp];
+        gridGenerator->EvaluateGeometricQuantitiesOnTheta(ir, ntheta_interp, theta, B[ir], J[ir], R[ir], N[ir]);
+
+        real_t Bmin = rGrid->GetBmin(ir);
+        for(len_t it=0; it<ntheta_interp; it++)
+            B[ir][it] = Bmin ? B[ir][it]/Bmin : 1.0;
+    }
+    for(len_t ir=0; ir<=nr; ir++){
+        B_f[ir] = new real_t[ntheta_interp];
+        J_f[ir] = new real_t[ntheta_interp];
+        R_f[ir] = new real_t[ntheta_interp];
+        N_f[ir] = new real_t[ntheta_interp];
+        gridGenerator->EvaluateGeometricQuantitiesOnTheta_fr(ir, ntheta_interp, theta, B_f[ir], J_f[ir], R_f[ir], N_f[ir]);
+
+        real_t Bmin = rGrid->GetBmin_f(ir);
+        for(len_t it=0; it<ntheta_interp; it++)
+            B_f[ir][it] = Bmin ? B_f[ir][it]/Bmin : 1.0;
+    }
+
+    BOverBmin->SetInterpolatedData(B, B_f);
+    Jacobian->SetInterpolatedData(J, J_f);
+    ROverR0->SetInterpolatedData(R, R_f);
+    NablaR2->SetInterpolatedData(N, N_f);
+}
+
+/**
+ * Evaluate the products of the quadrature weights and the spatial
+ * jacobian, 2*pi*w_i*J(theta_i), on all flux surfaces.
+ */
+void FluxSurfaceAverager::SetWeightedJacobian(){
+    DeallocateWeightedJacobian();
+
+    weightedJacobian   = new real_t[nr*ntheta_interp];
+    weightedJacobian_f = new real_t[(nr+1)*ntheta_interp];
+
+    for(len_t ir=0; ir<nr; ir++){
+        const real_t *J = Jacobian->GetData(ir, FLUXGRIDTYPE_DISTRIBUTION);
+        for(len_t it=0; it<ntheta_interp; it++)
+            weightedJacobian[ir*ntheta_interp+it] = 2*M_PI*weights[it]*J[it];
+    }
+    for(len_t ir=0; ir<=nr; ir++){
+        const real_t *J = Jacobian->GetData(ir, FLUXGRIDTYPE_RADIAL);
+        for(len_t it=0; it<ntheta_interp; it++)
+            weightedJacobian_f[ir*ntheta_interp+it] = 2*M_PI*weights[it]*J[it];
+    }
+}
+
+/**
+ * Deallocate the weighted jacobian.
+ */
+void FluxSurfaceAverager::DeallocateWeightedJacobian(){
+    delete [] weightedJacobian;
+    delete [] weightedJacobian_f;
+    weightedJacobian = nullptr;
+    weightedJacobian_f = nullptr;
+}
+
+/**
+ * Add all settings of this FluxSurfaceAverager which affect
+ * the flux surface averages to the given geometry cache key.
+ */
+void FluxSurfaceAverager::AddToHash(GeometryCache::Hash &h) const {
+    h.Add(integrateAdaptive);
+    h.Add(geometryIsSymmetric);
+    h.Add((int)interpMethod);
+    h.Add(ntheta_interp);
+    if (!integrateAdaptive) {
+        h.Add(theta, ntheta_interp);
+        h.Add(weights, ntheta_interp);
+    }
+}
+
+
+/**
+ * Allocate the GSL workspaces of a thread.
+ */
+FluxSurfaceAverager::thread_workspace::thread_workspace(){
+    adaptive       = gsl_integration_workspace_alloc(1000);
+    adaptive_outer = gsl_integration_workspace_alloc(1000);
+    // Use the Brent algorithm for root finding in determining the theta bounce points
+    fsolver        = gsl_root_fsolver_alloc(gsl_root_fsolver_brent);
+}
+
+/**
+ * Deallocate the GSL workspaces of a thread.
+ */
+FluxSurfaceAverager::thread_workspace::~thread_workspace(){
+    gsl_integration_workspace_free(adaptive);
+    gsl_integration_workspace_free(adaptive_outer);
+    gsl_root_fsolver_free(fsolver);
+}
+
+/**
+ * Returns the GSL workspaces to be used by the calling thread.
+ * The workspaces are allocated the first time they are requested
+ * on a thread (and are shared by all FluxSurfaceAveragers on that
+ * thread), and are deallocated when the thread exits.
+ */
+struct FluxSurfaceAverager::thread_workspace &FluxSurfaceAverager::GetWorkspace(){
+    static thread_local struct thread_workspace ws;
+    return ws;
+}
+
 
 /**
  *  Evaluates the flux surface average <F> of a function F = F(B/Bmin, R/R0, |nabla r|^2) on radial grid point ir. 
@@ -103,6 +243,16 @@ real_t FluxSurfaceAverager::CalculateFluxSurfaceAverage(len_t ir, fluxGridType f
     if(VpVol == 0) 
         return F(1,1,1,par);
 
+    // in fields which are uniform on the flux surface, <F> = F
+    if(fieldIsUniform){
+        real_t B, Jacobian, ROverR0, NablaR2;
+        GeometricQuantitiesAtTheta(ir, 0, B, Jacobian, ROverR0, NablaR2, fluxGridType);
+        if(F_list != nullptr)
+            return AssembleFSAFunc(1, ROverR0, NablaR2, F_list);
+        else
+            return F(1, ROverR0, NablaR2, par);
+    }
+
     // otherwise use regular method
     return EvaluateFluxSurfaceIntegral(ir,fluxGridType, F, par, F_list) / VpVol;
 }
@@ -148,18 +298,20 @@ real_t FluxSurfaceAverager::EvaluateFluxSurfaceIntegral(len_t ir, fluxGridType f
     // Calculate using fixed quadrature:
     if(!integrateAdaptive){
         const real_t *BOverBmin = this->BOverBmin->GetData(ir, fluxGridType);
-        const real_t *Jacobian  = this->Jacobian->GetData(ir,fluxGridType);
         const real_t *ROverR0   = this->ROverR0->GetData(ir, fluxGridType);
         const real_t *NablaR2   = this->NablaR2->GetData(ir, fluxGridType);
-
-        bool hasFlist = (F_list!=nullptr);    
-        for (len_t it = 0; it<ntheta_interp; it++)
-            fluxSurfaceIntegral += weights[it] * Jacobian[it] 
-                * (hasFlist ? AssembleFSAFunc(BOverBmin[it], ROverR0[it], NablaR2[it], F_list) 
-                    : F(BOverBmin[it], ROverR0[it], NablaR2[it], par));
-        fluxSurfaceIntegral *= 2*M_PI;
+        const real_t *wJ = (fluxGridType==FLUXGRIDTYPE_RADIAL ? weightedJacobian_f : weightedJacobian)
+            + ir*ntheta_interp;
+
+        if(F_list != nullptr)
+            for (len_t it = 0; it<ntheta_interp; it++)
+                fluxSurfaceIntegral += wJ[it] * AssembleFSAFunc(BOverBmin[it], ROverR0[it], NablaR2[it], F_list);
+        else
+            for (len_t it = 0; it<ntheta_interp; it++)
+                fluxSurfaceIntegral += wJ[it] * F(BOverBmin[it], ROverR0[it], NablaR2[it], par);
     // or by using adaptive quadrature:
     } else {
+        gsl_integration_workspace *gsl_adaptive = GetWorkspace().adaptive;
         gsl_function GSL_func; 
         FluxSurfaceIntegralParams params = {F, par, F_list, ir, GetBmin(ir,fluxGridType), this, fluxGridType}; 
         GSL_func.function = &(FluxSurfaceIntegralFunction);
@@ -170,15 +322,80 @@ real_t FluxSurfaceAverager::EvaluateFluxSurfaceIntegral(len_t ir, fluxGridType f
     return fluxSurfaceIntegral;  
 } 
 
+/**
+ * Evaluate the flux surface integrals of several functions, each
+ * given as a list of exponents (see 'AssembleFSAFunc()'), on the
+ * flux surface 'ir'. With the fixed quadrature, all integrals are
+ * evaluated in a single pass over the poloidal grid.
+ *
+ * nF:      Number of functions to integrate.
+ * F_lists: List of exponents for each function.
+ * I:       On return, contains the flux surface integral of
+ *          each function (array of size 'nF').
+ */
+void FluxSurfaceAverager::EvaluateFluxSurfaceIntegrals(
+    len_t ir, fluxGridType fluxGridType, const len_t nF,
+    const int_t *const* F_lists, real_t *I
+){
+    if(integrateAdaptive){
+        for(len_t k=0; k<nF; k++)
+            I[k] = EvaluateFluxSurfaceIntegral(ir, fluxGridType, RadialGrid::FSA_FUNC_UNITY /*(not used)*/, nullptr, F_lists[k]);
+        return;
+    }
+
+    const real_t *BOverBmin = this->BOverBmin->GetData(ir, fluxGridType);
+    const real_t *ROverR0   = this->ROverR0->GetData(ir, fluxGridType);
+    const real_t *NablaR2   = this->NablaR2->GetData(ir, fluxGridType);
+    const real_t *wJ = (fluxGridType==FLUXGRIDTYPE_RADIAL ? weightedJacobian_f : weightedJacobian)
+        + ir*ntheta_interp;
+
+    for(len_t k=0; k<nF; k++)
+        I[k] = 0;
+    for(len_t it=0; it<ntheta_interp; it++)
+        for(len_t k=0; k<nF; k++)
+            I[k] += wJ[it] * AssembleFSAFunc(BOverBmin[it], ROverR0[it], NablaR2[it], F_lists[k]);
+}
+
+/**
+ * Evaluate the flux surface averages of several functions, each
+ * given as a list of exponents, on the flux surface 'ir' (see
+ * 'EvaluateFluxSurfaceIntegrals()').
+ */
+void FluxSurfaceAverager::CalculateFluxSurfaceAverages(
+    len_t ir, fluxGridType fluxGridType, const len_t nF,
+    const int_t *const* F_lists, real_t *FSA
+){
+    real_t VpVol = GetVpVol(ir,fluxGridType);
+
+    // treat singular point r=0 separately where orbit parameters are constant 
+    if(VpVol == 0){
+        for(len_t k=0; k<nF; k++)
+            FSA[k] = AssembleFSAFunc(1, 1, 1, F_lists[k]);
+        return;
+    }
+
+    if(fieldIsUniform){
+        real_t B, Jacobian, ROverR0, NablaR2;
+        GeometricQuantitiesAtTheta(ir, 0, B, Jacobian, ROverR0, NablaR2, fluxGridType);
+        for(len_t k=0; k<nF; k++)
+            FSA[k] = AssembleFSAFunc(1, ROverR0, NablaR2, F_lists[k]);
+        return;
+    }
+
+    EvaluateFluxSurfaceIntegrals(ir, fluxGridType, nF, F_lists, FSA);
+    for(len_t k=0; k<nF; k++)
+        FSA[k] /= VpVol;
+}
+
 
 
 /**
  * Deallocate quadrature.
  */
 void FluxSurfaceAverager::DeallocateQuadrature(){
-    gsl_integration_workspace_free(gsl_adaptive);
-    gsl_integration_workspace_free(gsl_adaptive_outer);
     gsl_integration_qaws_table_free(qaws_table);
+    gsl_integration_glfixed_table_free(xiCellTable_lo);
+    gsl_integration_glfixed_table_free(xiCellTable_hi);
     if(gsl_w != nullptr)
         gsl_integration_fixed_free(gsl_w);
 }
@@ -196,8 +413,6 @@ void FluxSurfaceAverager::DeallocateQuadrature(){
  *      https://www.gnu.org/software/gsl/doc/html/integration.html
  */
 void FluxSurfaceAverager::InitializeQuadrature(quadrature_method q_method){
-    gsl_adaptive = gsl_integration_workspace_alloc(1000);
-    gsl_adaptive_outer = gsl_integration_workspace_alloc(1000);
     std::function<real_t(real_t,real_t,real_t)>  QuadWeightFunction;
     if(geometryIsSymmetric)
         theta_max = M_PI;
@@ -438,7 +653,7 @@ real_t FluxSurfaceAverager::EvaluatePXiBounceIntegralAtP(len_t ir, real_t xi0, f
                 Flist_eval[4] *= 2;
         }
         F_eval = BA_FUNC_TRAPPED;
-        FindBouncePoints(ir, Bmin, theta_Bmin, theta_Bmax, this, xi0, fluxGridType, &theta_b1, &theta_b2,gsl_fsolver,geometryIsSymmetric);
+        FindBouncePoints(ir, Bmin, theta_Bmin, theta_Bmax, this, xi0, fluxGridType, &theta_b1, &theta_b2,GetWorkspace().fsolver,geometryIsSymmetric);
         if(theta_b1==theta_b2)
             return 0;
     } else { 
@@ -459,6 +674,7 @@ real_t FluxSurfaceAverager::EvaluatePXiBounceIntegralAtP(len_t ir, real_t xi0, f
     GSL_func.params = &params;
     real_t bounceIntegral, error; 
 
+    gsl_integration_workspace *gsl_adaptive = GetWorkspace().adaptive;
     real_t epsabs = 0, epsrel = 1e-3, lim = gsl_adaptive->limit; 
     if(params.integrateQAWS)
         gsl_integration_qaws(&GSL_func,theta_b1,theta_b2,qaws_table,epsabs,epsrel,lim,gsl_adaptive,&bounceIntegral,&error);
@@ -717,6 +933,66 @@ real_t FluxSurfaceAverager::evaluatePXiBounceIntegralAtXi(real_t xi0, void *par)
 }
 
 
+/**
+ * Helper function for the fixed quadrature in 'IntegrateBounceIntegralOverXi()':
+ * returns the integrand after the substitution xi = xi_s + L*s^3.
+ */
+struct ClusteredIntegrandParams {gsl_function *func; real_t xi_s; real_t L;};
+real_t FluxSurfaceAverager::evaluateClusteredIntegrand(real_t s, void *par){
+    ClusteredIntegrandParams *params = (struct ClusteredIntegrandParams*)par;
+    real_t s2 = s*s;
+    return 3*params->L*s2 * params->func->function(params->xi_s + params->L*s2*s, params->func->params);
+}
+
+/**
+ * Integrates the bounce integral 'gsl_func' over xi0 from xi_l to xi_u,
+ * where the interval does not contain the trapped-passing boundary
+ * xi0 = +/-xiT in its interior. Near the boundary, the bounce integral
+ * has a logarithmic singularity, and it is otherwise smooth. We
+ * therefore substitute xi0 = xi_s + L*s^3, where xi_s is the end point
+ * closest to the boundary, which removes the singularity to leading
+ * order, and apply Gauss-Legendre rules with 8 and 16 points. If the
+ * two rules agree to the requested tolerance, the 16-point result is
+ * used. Otherwise we fall back to adaptive quadrature.
+ *
+ * singular: If true, the interval has an end point on the
+ *           trapped-passing boundary.
+ */
+real_t FluxSurfaceAverager::IntegrateBounceIntegralOverXi(
+    gsl_function *gsl_func, real_t xi_l, real_t xi_u, real_t xiT, bool singular
+){
+    const real_t epsrel = 1e-3;
+
+    real_t d_l = fabs(fabs(xi_l)-xiT), d_u = fabs(fabs(xi_u)-xiT);
+    ClusteredIntegrandParams params;
+    if(d_l <= d_u)
+        params = {gsl_func, xi_l, xi_u-xi_l};
+    else
+        params = {gsl_func, xi_u, xi_l-xi_u};
+
+    gsl_function clustered;
+    clustered.function = &(evaluateClusteredIntegrand);
+    clustered.params = &params;
+
+    real_t I_lo = gsl_integration_glfixed(&clustered, 0, 1, xiCellTable_lo);
+    real_t I_hi = gsl_integration_glfixed(&clustered, 0, 1, xiCellTable_hi);
+
+    // (integration limits reversed if clustering towards xi_u)
+    real_t sign = (d_l <= d_u) ? 1 : -1;
+    if(fabs(I_hi-I_lo) <= epsrel*fabs(I_hi))
+        return sign*I_hi;
+
+    gsl_integration_workspace *gsl_adaptive_outer = GetWorkspace().adaptive_outer;
+    real_t result, error, lim = gsl_adaptive_outer->limit;
+    if(singular){
+        real_t pts[2] = {xi_l,xi_u};
+        gsl_integration_qagp(gsl_func,pts,2,0,epsrel,lim,gsl_adaptive_outer,&result,&error);
+    } else
+        gsl_integration_qag(gsl_func,xi_l,xi_u,0,epsrel,lim,GSL_INTEG_GAUSS41,gsl_adaptive_outer,&result,&error);
+
+    return result;
+}
+
 /**
  * Averages the bounce integral over xi from xi_l to xi_u (which are assumed to satisfy xi_l<=xi_u)
  */
@@ -729,13 +1005,6 @@ real_t FluxSurfaceAverager::EvaluateCellAveragedBounceIntegralOverP2(len_t ir, r
         partResult2 = 0,
         partResult3 = 0;
     
-    int key = GSL_INTEG_GAUSS41;
-    real_t 
-        epsabs = 0,
-        epsrel = 1e-3,
-        lim = gsl_adaptive->limit,
-        error;
-    
     real_t xiT;
     if(fluxGridType == FLUXGRIDTYPE_RADIAL)
         xiT = rGrid->GetXi0TrappedBoundary_fr(ir);
@@ -748,40 +1017,25 @@ real_t FluxSurfaceAverager::EvaluateCellAveragedBounceIntegralOverP2(len_t ir, r
     
     // contribution from negative pitch passing region
     if(xi_l < -xiT){
-        real_t pts[2] = {xi_l,-xiT};
-        int npts = 2;
         if(xi_u < -xiT)
-            gsl_integration_qag(&gsl_func,xi_l,xi_u,epsabs,epsrel,lim,key,gsl_adaptive_outer,&partResult1,&error);
+            partResult1 = IntegrateBounceIntegralOverXi(&gsl_func,xi_l,xi_u,xiT,false);
         else if( xi_u>0 ) // if xi_u<=0, this is a "negative pitch trapped" cel which is mirrored and should have Vp=0
-            gsl_integration_qagp(&gsl_func,pts,npts,epsabs,epsrel,lim,gsl_adaptive_outer,&partResult1,&error);
+            partResult1 = IntegrateBounceIntegralOverXi(&gsl_func,xi_l,-xiT,xiT,true);
     }
     // contribution from positive pitch trapped region
     if(xi_u>0 && xi_l<xiT){
-        if(xi_u<xiT){
-            if(xi_l<0)
-                gsl_integration_qag(&gsl_func,0,xi_u,epsabs,epsrel,lim,key,gsl_adaptive_outer,&partResult2,&error);
-            else 
-                gsl_integration_qag(&gsl_func,xi_l,xi_u,epsabs,epsrel,lim,key,gsl_adaptive_outer,&partResult2,&error);
-        } else {
-            if(xi_l<0){
-                real_t pts[2] = {0,xiT};
-                int npts = 2;
-                gsl_integration_qagp(&gsl_func,pts,npts,epsabs,epsrel,lim,gsl_adaptive_outer,&partResult2,&error);
-            } else {
-                real_t pts[2] = {xi_l,xiT};
-                int npts = 2;
-                gsl_integration_qagp(&gsl_func,pts,npts,epsabs,epsrel,lim,gsl_adaptive_outer,&partResult2,&error);
-            }
-        }
+        real_t xi_lower = (xi_l<0) ? 0 : xi_l;
+        if(xi_u<xiT)
+            partResult2 = IntegrateBounceIntegralOverXi(&gsl_func,xi_lower,xi_u,xiT,false);
+        else
+            partResult2 = IntegrateBounceIntegralOverXi(&gsl_func,xi_lower,xiT,xiT,true);
     }
     // contribution from positive pitch passing region
     if(xi_u>xiT){
-        real_t pts[2] = {xiT,xi_u};
-        int npts = 2;
         if(xi_l<=xiT)
-            gsl_integration_qagp(&gsl_func,pts,npts,epsabs,epsrel,lim,gsl_adaptive_outer,&partResult3,&error);
+            partResult3 = IntegrateBounceIntegralOverXi(&gsl_func,xiT,xi_u,xiT,true);
         else 
-            gsl_integration_qag(&gsl_func,xi_l,xi_u,epsabs,epsrel,lim,key,gsl_adaptive_outer,&partResult3,&error);
+            partResult3 = IntegrateBounceIntegralOverXi(&gsl_func,xi_l,xi_u,xiT,false);
     }    
 
     return (partResult1+partResult2+partResult3)/dxi;
@@ -50,6 +50,21 @@ void FluxSurfaceQuantity::InterpolateMagneticDataToTheta(real_t *theta, len_t nt
     }
 }
 
+/**
+ * Set the data on the theta grid directly (instead of evaluating
+ * the quantity point-by-point in 'InterpolateMagneticDataToTheta()').
+ * This object takes ownership of the given arrays.
+ *
+ * data:    Quantity on the distribution grid (size nr x ntheta).
+ * data_fr: Quantity on the radial flux grid (size (nr+1) x ntheta).
+ */
+void FluxSurfaceQuantity::SetInterpolatedData(real_t **data, real_t **data_fr){
+    DeallocateInterpolatedData();
+    nr = rGrid->GetNr();
+    quantityData    = data;
+    quantityData_fr = data_fr;
+}
+
 /**
  * Deallocator
  */
@@ -0,0 +1,313 @@
+/**
+ * Implementation of a persistent, on-disk cache for the geometric
+ * quantities computed when constructing a grid (flux surface averages,
+ * bounce points, phase-space jacobians, bounce averages, ...).
+ *
+ * A cache file is identified by a 64-bit key, computed by hashing the
+ * magnetic equilibrium together with all grid settings which affect
+ * the geometric quantities. The file contains a list of named arrays
+ * of real numbers, stored as
+ *
+ *   [magic (8 bytes)] [key] [number of entries]
+ *   For each entry:
+ *     [length of name] [name (padded to a multiple of 8 bytes)]
+ *     [number of elements] [elements]
+ *
+ * where all integers are 64-bit. When loaded, the file is memory-mapped
+ * and the arrays are copied directly from the mapping, so that no part
+ * of the file which is not needed is ever read from disk.
+ *
+ * Missing or corrupt cache files are never an error: the quantities are
+ * then simply recomputed (and the cache file is rewritten).
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "FVM/FVMException.hpp"
+#include "FVM/Grid/GeometryCache.hpp"
+
+
+using namespace DREAM::FVM;
+using namespace std;
+
+
+static const char GEOMETRY_CACHE_MAGIC[8] = {'D','R','E','A','M','G','C','1'};
+
+
+/**
+ * Add the given bytes to the hash.
+ */
+void GeometryCache::Hash::Add(const void *data, const size_t n) {
+    const unsigned char *p = (const unsigned char*)data;
+    for (size_t i = 0; i < n; i++) {
+        this->h ^= p[i];
+        this->h *= 1099511628211ull;
+    }
+}
+
+
+/**
+ * Constructor.
+ *
+ * directory: Directory in which cache files are stored.
+ * key:       Key identifying the geometry.
+ */
+GeometryCache::GeometryCache(const string& directory, const uint64_t key)
+    : key(key) {
+
+    char name[64];
+    snprintf(name, sizeof(name), "dream-geometry-%016llx.cache", (unsigned long long)key);
+
+    if (directory.empty() || directory.back() == '/')
+        this->filename = directory + name;
+    else
+        this->filename = directory + "/" + name;
+}
+
+/**
+ * Destructor.
+ */
+GeometryCache::~GeometryCache() {
+    if (this->mapping != nullptr)
+        munmap(this->mapping, this->mappingSize);
+}
+
+
+/**
+ * Try to load the cache file corresponding to the key
+ * of this cache.
+ *
+ * RETURNS true if the cache file exists and is valid.
+ */
+bool GeometryCache::Load() {
+    int fd = open(this->filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)(sizeof(GEOMETRY_CACHE_MAGIC) + 2*sizeof(uint64_t))) {
+        close(fd);
+        return false;
+    }
+
+    size_t size = (size_t)st.st_size;
+    void *m = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+
+    if (m == MAP_FAILED)
+        return false;
+
+    // Parse header and build index of entries
+    const char *p = (const char*)m, *end = p + size;
+    auto readU64 = [&p,&end](uint64_t &v) {
+        if (end-p < (ptrdiff_t)sizeof(uint64_t)) return false;
+        memcpy(&v, p, sizeof(uint64_t));
+        p += sizeof(uint64_t);
+        return true;
+    };
+
+    bool valid = (memcmp(p, GEOMETRY_CACHE_MAGIC, sizeof(GEOMETRY_CACHE_MAGIC)) == 0);
+    p += sizeof(GEOMETRY_CACHE_MAGIC);
+
+    uint64_t fileKey = 0, nEntries = 0;
+    valid = valid && readU64(fileKey) && readU64(nEntries) && (fileKey == this->key);
+
+    map<string, pair<const real_t*, len_t>> index;
+    for (uint64_t i = 0; valid && i < nEntries; i++) {
+        uint64_t nameLength, n;
+        if (!readU64(nameLength)) { valid = false; break; }
+
+        uint64_t padded = 8*((nameLength+7)/8);
+        if ((uint64_t)(end-p) < padded) { valid = false; break; }
+        string name(p, nameLength);
+        p += padded;
+
+        if (!readU64(n) || (uint64_t)(end-p) < n*sizeof(real_t)) { valid = false; break; }
+        index[name] = {(const real_t*)p, (len_t)n};
+        p += n*sizeof(real_t);
+    }
+
+    if (!valid) {
+        munmap(m, size);
+        return false;
+    }
+
+    this->mapping = m;
+    this->mappingSize = size;
+    this->entries = std::move(index);
+
+    return true;
+}
+
+/**
+ * Write all data added with 'Put()' to the cache file. The data
+ * is first written to a temporary file, which is then moved into
+ * place, so that simulations running simultaneously never see a
+ * partially written cache file.
+ */
+void GeometryCache::Save() {
+    const string tmpname = this->filename + "." + to_string(getpid()) + ".tmp";
+    ofstream f(tmpname, ios::binary);
+    if (!f.good())
+        throw FVMException("GeometryCache: Unable to create cache file '%s'.", tmpname.c_str());
+
+    uint64_t nEntries = this->pending.size();
+    f.write(GEOMETRY_CACHE_MAGIC, sizeof(GEOMETRY_CACHE_MAGIC));
+    f.write((const char*)&this->key, sizeof(uint64_t));
+    f.write((const char*)&nEntries, sizeof(uint64_t));
+
+    const char zeros[8] = {0};
+    for (auto it = this->pending.begin(); it != this->pending.end(); it++) {
+        uint64_t nameLength = it->first.size();
+        uint64_t n = it->second.size();
+
+        f.write((const char*)&nameLength, sizeof(uint64_t));
+        f.write(it->first.c_str(), nameLength);
+        f.write(zeros, 8*((nameLength+7)/8) - nameLength);
+        f.write((const char*)&n, sizeof(uint64_t));
+        f.write((const char*)it->second.data(), n*sizeof(real_t));
+    }
+
+    f.close();
+    if (!f.good() || rename(tmpname.c_str(), this->filename.c_str()) != 0) {
+        remove(tmpname.c_str());
+        throw FVMException("GeometryCache: Unable to write cache file '%s'.", this->filename.c_str());
+    }
+}
+
+
+/**
+ * Locate the named array in the loaded cache file.
+ *
+ * RETURNS a pointer to the data, or 'nullptr' if no array
+ * with the given name and number of elements exists.
+ */
+const real_t *GeometryCache::Find(const string& name, const len_t n) const {
+    auto it = this->entries.find(name);
+    if (it == this->entries.end() || it->second.second != n)
+        return nullptr;
+    else
+        return it->second.first;
+}
+
+/**
+ * Load the named 1D array from the cache.
+ *
+ * name: Name of the array.
+ * data: On return, contains a newly allocated copy of the array.
+ * n:    Number of elements of the array.
+ *
+ * RETURNS true if the array was found (otherwise, 'data' is not
+ * modified).
+ */
+bool GeometryCache::Get(const string& name, real_t *&data, const len_t n) {
+    const real_t *src = Find(name, n);
+    if (src == nullptr)
+        return false;
+
+    data = new real_t[n];
+    memcpy(data, src, n*sizeof(real_t));
+    return true;
+}
+
+/**
+ * Load the named 2D array (with 'nRows' rows, each of which
+ * contains 'rowLength' elements) from the cache.
+ */
+bool GeometryCache::Get(const string& name, real_t **&data, const len_t nRows, const len_t rowLength) {
+    const real_t *src = Find(name, nRows*rowLength);
+    if (src == nullptr)
+        return false;
+
+    data = new real_t*[nRows];
+    for (len_t i = 0; i < nRows; i++) {
+        data[i] = new real_t[rowLength];
+        memcpy(data[i], src + i*rowLength, rowLength*sizeof(real_t));
+    }
+    return true;
+}
+
+/**
+ * Load the named 2D boolean array from the cache.
+ */
+bool GeometryCache::Get(const string& name, bool **&data, const len_t nRows, const len_t rowLength) {
+    const real_t *src = Find(name, nRows*rowLength);
+    if (src == nullptr)
+        return false;
+
+    data = new bool*[nRows];
+    for (len_t i = 0; i < nRows; i++) {
+        data[i] = new bool[rowLength];
+        for (len_t j = 0; j < rowLength; j++)
+            data[i][j] = (src[i*rowLength + j] != 0);
+    }
+    return true;
+}
+
+/**
+ * Copy the named 2D array from the cache into the given
+ * (already allocated) array.
+ */
+bool GeometryCache::Fill(const string& name, real_t **data, const len_t nRows, const len_t rowLength) {
+    const real_t *src = Find(name, nRows*rowLength);
+    if (src == nullptr)
+        return false;
+
+    for (len_t i = 0; i < nRows; i++)
+        memcpy(data[i], src + i*rowLength, rowLength*sizeof(real_t));
+    return true;
+}
+
+/**
+ * Copy the named 2D boolean array from the cache into the
+ * given (already allocated) array.
+ */
+bool GeometryCache::Fill(const string& name, bool **data, const len_t nRows, const len_t rowLength) {
+    const real_t *src = Find(name, nRows*rowLength);
+    if (src == nullptr)
+        return false;
+
+    for (len_t i = 0; i < nRows; i++)
+        for (len_t j = 0; j < rowLength; j++)
+            data[i][j] = (src[i*rowLength + j] != 0);
+    return true;
+}
+
+
+/**
+ * Add the given 1D array to the data to save to the cache file.
+ */
+void GeometryCache::Put(const string& name, const real_t *data, const len_t n) {
+    if (data == nullptr)
+        return;
+
+    this->pending[name].assign(data, data+n);
+}
+
+/**
+ * Add the given 2D array (with 'nRows' rows, each of which contains
+ * 'rowLength' elements) to the data to save to the cache file.
+ */
+void GeometryCache::Put(const string& name, real_t **data, const len_t nRows, const len_t rowLength) {
+    vector<real_t> &v = this->pending[name];
+    v.resize(nRows*rowLength);
+    for (len_t i = 0; i < nRows; i++)
+        memcpy(v.data() + i*rowLength, data[i], rowLength*sizeof(real_t));
+}
+
+/**
+ * Add the given 2D boolean array to the data to save to
+ * the cache file.
+ */
+void GeometryCache::Put(const string& name, bool **data, const len_t nRows, const len_t rowLength) {
+    vector<real_t> &v = this->pending[name];
+    v.resize(nRows*rowLength);
+    for (len_t i = 0; i < nRows; i++)
+        for (len_t j = 0; j < rowLength; j++)
+            v[i*rowLength + j] = (data[i][j] ? 1 : 0);
+}
@@ -4,6 +4,7 @@
 
 #include <algorithm>
 #include <vector>
+#include "FVM/FVMException.hpp"
 #include "FVM/Grid/Grid.hpp"
 
 
@@ -14,12 +15,40 @@ using namespace DREAM::FVM;
  * Constructor.
  */
 Grid::Grid(RadialGrid *rg, MomentumGrid *mg, const real_t /*t0*/, FluxSurfaceAverager::quadrature_method qm_trapped, len_t ntheta_interp_trapped) {
-    this->rgrid = rg;
-    this->momentumGrids = new MomentumGrid*[rgrid->GetNr()];
+    this->momentumGrids = new MomentumGrid*[rg->GetNr()];
 
-    for (len_t i = 0; i < rgrid->GetNr(); i++)
+    for (len_t i = 0; i < rg->GetNr(); i++)
         this->momentumGrids[i] = mg;
 
+    Initialize(rg, qm_trapped, ntheta_interp_trapped);
+}
+
+/**
+ * Constructor for a grid which uses different momentum grids
+ * at different radii.
+ *
+ * mgs: List of momentum grids to use at each radius (of size nr).
+ *      Several radii may share the same momentum grid. This grid
+ *      takes ownership of the momentum grids (but not of the list).
+ */
+Grid::Grid(RadialGrid *rg, MomentumGrid **mgs, const real_t /*t0*/, FluxSurfaceAverager::quadrature_method qm_trapped, len_t ntheta_interp_trapped) {
+    this->momentumGrids = new MomentumGrid*[rg->GetNr()];
+
+    for (len_t i = 0; i < rg->GetNr(); i++)
+        this->momentumGrids[i] = mgs[i];
+
+    Initialize(rg, qm_trapped, ntheta_interp_trapped);
+}
+
+/**
+ * Initialization common to the constructors.
+ */
+void Grid::Initialize(RadialGrid *rg, FluxSurfaceAverager::quadrature_method qm_trapped, len_t ntheta_interp_trapped) {
+    this->rgrid = rg;
+
+    for (len_t i = 0; i < rgrid->GetNr(); i++)
+        if (find(distinctGrids.begin(), distinctGrids.end(), momentumGrids[i]) == distinctGrids.end())
+            distinctGrids.push_back(momentumGrids[i]);
 
     FluxSurfaceAverager *FSA = rg->GetFluxSurfaceAverager();
 
@@ -55,6 +84,8 @@ Grid::~Grid() {
     DeallocateVprime();
     DeallocateBAvg();
     DeallocateBounceParameters();
+    DeallocateMomentumGridMappings();
+    delete [] this->cellOffsets;
     delete [] this->momentumGrids;
     delete this->rgrid;
     delete this->bounceAverager;
@@ -94,12 +125,8 @@ const len_t Grid::GetNCells_fr() const {
     const len_t Nr = this->GetNr();
     len_t N = 0;
 
-    for (len_t i = 0; i < Nr; i++)
-        N += this->momentumGrids[i]->GetNCells();
-
-    // XXX here we assume that all momentum grids are the same
-    // double count last momentum grid (since nr+1)
-    N += this->momentumGrids[Nr-1]->GetNCells();
+    for (len_t i = 0; i <= Nr; i++)
+        N += this->GetMomentumGrid_fr(i)->GetNCells();
 
     return N;
 }
@@ -130,6 +157,80 @@ const len_t Grid::GetNCells_f2() const {
     return N;
 }
 
+/**
+ * Returns true if the same momentum grid is used at all radii.
+ */
+bool Grid::HasRadiallyUniformMomentumGrid() const {
+    return (this->distinctGrids.size() <= 1);
+}
+
+/**
+ * Returns the mapping from the momentum grid 'from' to the
+ * momentum grid 'to' (both of which must be used at some radius
+ * of this grid), or 'nullptr' if 'from' and 'to' are the same
+ * grid (in which case the mapping is the identity).
+ */
+const MomentumGridMapping *Grid::GetMomentumGridMapping(
+    const MomentumGrid *from, const MomentumGrid *to
+) const {
+    if (from == to)
+        return nullptr;
+
+    const len_t n = this->distinctGrids.size();
+    len_t a = n, b = n;
+    for (len_t k = 0; k < n; k++) {
+        if (this->distinctGrids[k] == from) a = k;
+        if (this->distinctGrids[k] == to) b = k;
+    }
+
+    if (a == n || b == n || this->gridMappings.empty())
+        throw FVMException("Grid: No mapping between the requested momentum grids.");
+
+    return this->gridMappings[a*n+b];
+}
+
+/**
+ * Recalculate the cell offsets of the radii, and the mappings
+ * between the distinct momentum grids of this grid (after the
+ * momentum grids have been rebuilt).
+ */
+void Grid::RebuildMomentumGridMappings() {
+    const len_t nr = GetNr();
+
+    delete [] this->cellOffsets;
+    this->cellOffsets = new len_t[nr+1];
+    this->cellOffsets[0] = 0;
+    for (len_t ir = 0; ir < nr; ir++)
+        this->cellOffsets[ir+1] = this->cellOffsets[ir] + this->momentumGrids[ir]->GetNCells();
+
+    DeallocateMomentumGridMappings();
+
+    const len_t n = this->distinctGrids.size();
+    this->maxMomentumGridOverlap = 1;
+    if (n <= 1)
+        return;
+
+    this->gridMappings.resize(n*n, nullptr);
+    for (len_t a = 0; a < n; a++)
+        for (len_t b = 0; b < n; b++) {
+            if (a == b)
+                continue;
+
+            MomentumGridMapping *m = new MomentumGridMapping(distinctGrids[a], distinctGrids[b]);
+            this->gridMappings[a*n+b] = m;
+            this->maxMomentumGridOverlap = max(this->maxMomentumGridOverlap, m->GetMaxOverlap());
+        }
+}
+
+/**
+ * Deallocate the mappings between momentum grids.
+ */
+void Grid::DeallocateMomentumGridMappings() {
+    for (MomentumGridMapping *m : this->gridMappings)
+        delete m;
+    this->gridMappings.clear();
+}
+
 /**
  * Integrate the given vector numerically over the entire
  * phase space (radius+momentum).
@@ -213,6 +314,11 @@ bool Grid::Rebuild(const real_t t) {
     if (this->rgrid->NeedsRebuild(t))
         rgridUpdated = this->rgrid->Rebuild(t);
 
+    // The radial grid may be shared with other grids, one of
+    // which may already have rebuilt it
+    rgridUpdated |= this->rgrid->JacobiansOutdated() ||
+        (this->rgrid->GetJacobianRevision() != this->rgridRevision);
+
     updated = rgridUpdated;
 
     // Re-build momentum grids
@@ -232,17 +338,87 @@ bool Grid::Rebuild(const real_t t) {
 /**
  * Rebuilds magnetic-field data and initializes 
  * flux surface and bounce average calculations.
+ *
+ * The flux surface averages of the radial grid are only recalculated
+ * if the radial grid has changed since they were last calculated, so
+ * that they are calculated only once for all grids sharing the same
+ * radial grid.
+ *
+ * If a geometry cache directory has been set, the flux surface
+ * averages, bounce points and bounce averages are loaded from the
+ * cache file corresponding to this geometry (if it exists), or are
+ * calculated and written to a new cache file.
  */
 void Grid::RebuildJacobians(){ 
-    this->rgrid->RebuildJacobians(); 
-    this->bounceAverager->Rebuild();
-    RebuildBounceAveragedQuantities();
+    RebuildMomentumGridMappings();
+
+    GeometryCache *cache = CreateGeometryCache();
+
+    if (this->rgrid->JacobiansOutdated())
+        this->rgrid->RebuildJacobians(cache); 
+    this->rgridRevision = this->rgrid->GetJacobianRevision();
+
+    this->bounceAverager->Rebuild(cache);
+    RebuildBounceAveragedQuantities(cache);
+
+    if (cache != nullptr) {
+        if (!cache->IsLoaded())
+            cache->Save();
+        delete cache;
+    }
+}
+
+/**
+ * Create the geometry cache for this grid.
+ *
+ * RETURNS 'nullptr' if the geometry cache has been disabled,
+ * or if the geometry of this grid cannot be cached (i.e. if
+ * the magnetic field is not numeric or the grid is not
+ * the same at all radii).
+ */
+GeometryCache *Grid::CreateGeometryCache() {
+    if (this->geometryCacheDirectory.empty())
+        return nullptr;
+
+    const len_t nr = GetNr();
+    if (!HasRadiallyUniformMomentumGrid())
+        return nullptr;
+
+    GeometryCache::Hash h;
+    if (!this->rgrid->GetGenerator()->HashGeometry(h))
+        return nullptr;
+
+    // Radial grid
+    h.Add(nr);
+    h.Add(this->rgrid->GetR_f(), nr+1);
+    h.Add(this->rgrid->GetR(), nr);
+
+    // Momentum grid
+    const MomentumGrid *mg = this->momentumGrids[0];
+    const len_t np1 = mg->GetNp1(), np2 = mg->GetNp2();
+    h.Add(np1);
+    h.Add(np2);
+    h.Add(mg->GetP1(), np1);
+    h.Add(mg->GetP1_f(), np1+1);
+    h.Add(mg->GetP2(), np2);
+    h.Add(mg->GetP2_f(), np2+1);
+
+    // Quadratures
+    this->bounceAverager->AddToHash(h);
+
+    GeometryCache *cache = new GeometryCache(this->geometryCacheDirectory, h.Get());
+    cache->Load();
+
+    return cache;
 }
 
 /**
  * Calculates and stores bounce averaged quantities.
+ *
+ * cache: Optional geometry cache from which to load (or
+ *        to which to save) the bounce averages.
  */
-void Grid::RebuildBounceAveragedQuantities(){
+void Grid::RebuildBounceAveragedQuantities(GeometryCache *cache){
  real_t 
     **BA_xi_fr,
     **BA_xi_f1,
@@ -254,32 +430,66 @@ void Grid::RebuildBounceAveragedQuantities(){
     **BA_xi2B2_f1,
     **BA_xi2B2_f2;
     
+    // (the geometry cache is only used when the same
+    // momentum grid is used at all radii)
+    const len_t nr = GetNr(), np1 = GetNp1(0), np2 = GetNp2(0);
+    bool cached = (cache != nullptr &&
+        cache->Get("ba/xi_fr",       BA_xi_fr, nr+1, np1*np2) &&
+        cache->Get("ba/xi_f1",       BA_xi_f1, nr, (np1+1)*np2) &&
+        cache->Get("ba/xi_f2",       BA_xi_f2, nr, np1*(np2+1)) &&
+        cache->Get("ba/xi2OverB_f1", BA_xi2OverB_f1, nr, (np1+1)*np2) &&
+        cache->Get("ba/xi2OverB_f2", BA_xi2OverB_f2, nr, np1*(np2+1)) &&
+        cache->Get("ba/B3_f1",       BA_B3_f1, nr, (np1+1)*np2) &&
+        cache->Get("ba/B3_f2",       BA_B3_f2, nr, np1*(np2+1)) &&
+        cache->Get("ba/xi2B2_f1",    BA_xi2B2_f1, nr, (np1+1)*np2) &&
+        cache->Get("ba/xi2B2_f2",    BA_xi2B2_f2, nr, np1*(np2+1)));
+
+    // Functions to bounce average
+    auto xi       = [](real_t xiOverXi0, real_t, real_t, real_t) { return xiOverXi0; };
+    auto xi2OverB = [](real_t xiOverXi0, real_t BOverBmin, real_t, real_t) { return xiOverXi0*xiOverXi0/BOverBmin; };
+    auto B3       = [](real_t, real_t BOverBmin, real_t, real_t) { return BOverBmin*BOverBmin*BOverBmin; };
+    auto xi2B2    = [](real_t xiOverXi0, real_t BOverBmin, real_t, real_t) { return BOverBmin*BOverBmin*xiOverXi0*xiOverXi0; };
+
     bool isPXiGrid = true;
-    if(isPXiGrid){
-        SetBounceAveragePXi(BA_xi_fr,       FLUXGRIDTYPE_RADIAL, RadialGrid::BA_FUNC_XI, nullptr, RadialGrid::BA_PARAM_XI);
-        SetBounceAveragePXi(BA_xi_f1,       FLUXGRIDTYPE_P1, RadialGrid::BA_FUNC_XI, nullptr, RadialGrid::BA_PARAM_XI);
-        SetBounceAveragePXi(BA_xi_f2,       FLUXGRIDTYPE_P2, RadialGrid::BA_FUNC_XI, nullptr, RadialGrid::BA_PARAM_XI);
-        SetBounceAveragePXi(BA_xi2OverB_f1, FLUXGRIDTYPE_P1, RadialGrid::BA_FUNC_XI_SQUARED_OVER_B, nullptr, RadialGrid::BA_PARAM_XI_SQUARED_OVER_B);
-        SetBounceAveragePXi(BA_xi2OverB_f2, FLUXGRIDTYPE_P2, RadialGrid::BA_FUNC_XI_SQUARED_OVER_B, nullptr, RadialGrid::BA_PARAM_XI_SQUARED_OVER_B);
-        SetBounceAveragePXi(BA_B3_f1,       FLUXGRIDTYPE_P1, RadialGrid::BA_FUNC_B_CUBED, nullptr, RadialGrid::BA_PARAM_B_CUBED);
-        SetBounceAveragePXi(BA_B3_f2,       FLUXGRIDTYPE_P2, RadialGrid::BA_FUNC_B_CUBED, nullptr, RadialGrid::BA_PARAM_B_CUBED);
-        SetBounceAveragePXi(BA_xi2B2_f1,    FLUXGRIDTYPE_P1, RadialGrid::BA_FUNC_XI_SQUARED_B_SQUARED, nullptr, RadialGrid::BA_PARAM_XI_SQUARED_B_SQUARED);
-        SetBounceAveragePXi(BA_xi2B2_f2,    FLUXGRIDTYPE_P2, RadialGrid::BA_FUNC_XI_SQUARED_B_SQUARED, nullptr, RadialGrid::BA_PARAM_XI_SQUARED_B_SQUARED);
+    if(cached){
+        // Bounce averages taken from geometry cache
+    } else if(isPXiGrid){
+        SetBounceAveragePXi(BA_xi_fr,       FLUXGRIDTYPE_RADIAL, xi, RadialGrid::BA_PARAM_XI);
+        SetBounceAveragePXi(BA_xi_f1,       FLUXGRIDTYPE_P1, xi, RadialGrid::BA_PARAM_XI);
+        SetBounceAveragePXi(BA_xi_f2,       FLUXGRIDTYPE_P2, xi, RadialGrid::BA_PARAM_XI);
+        SetBounceAveragePXi(BA_xi2OverB_f1, FLUXGRIDTYPE_P1, xi2OverB, RadialGrid::BA_PARAM_XI_SQUARED_OVER_B);
+        SetBounceAveragePXi(BA_xi2OverB_f2, FLUXGRIDTYPE_P2, xi2OverB, RadialGrid::BA_PARAM_XI_SQUARED_OVER_B);
+        SetBounceAveragePXi(BA_B3_f1,       FLUXGRIDTYPE_P1, B3, RadialGrid::BA_PARAM_B_CUBED);
+        SetBounceAveragePXi(BA_B3_f2,       FLUXGRIDTYPE_P2, B3, RadialGrid::BA_PARAM_B_CUBED);
+        SetBounceAveragePXi(BA_xi2B2_f1,    FLUXGRIDTYPE_P1, xi2B2, RadialGrid::BA_PARAM_XI_SQUARED_B_SQUARED);
+        SetBounceAveragePXi(BA_xi2B2_f2,    FLUXGRIDTYPE_P2, xi2B2, RadialGrid::BA_PARAM_XI_SQUARED_B_SQUARED);
     } else {
-        SetBounceAverage(BA_xi_fr,       FLUXGRIDTYPE_RADIAL, RadialGrid::BA_FUNC_XI, nullptr, RadialGrid::BA_PARAM_XI);
-        SetBounceAverage(BA_xi_f1,       FLUXGRIDTYPE_P1, RadialGrid::BA_FUNC_XI, nullptr, RadialGrid::BA_PARAM_XI);
-        SetBounceAverage(BA_xi_f2,       FLUXGRIDTYPE_P2, RadialGrid::BA_FUNC_XI, nullptr, RadialGrid::BA_PARAM_XI);
-        SetBounceAverage(BA_xi2OverB_f1, FLUXGRIDTYPE_P1, RadialGrid::BA_FUNC_XI_SQUARED_OVER_B, nullptr, RadialGrid::BA_PARAM_XI_SQUARED_OVER_B);
-        SetBounceAverage(BA_xi2OverB_f2, FLUXGRIDTYPE_P2, RadialGrid::BA_FUNC_XI_SQUARED_OVER_B, nullptr, RadialGrid::BA_PARAM_XI_SQUARED_OVER_B);
-        SetBounceAverage(BA_B3_f1,       FLUXGRIDTYPE_P1, RadialGrid::BA_FUNC_B_CUBED, nullptr, RadialGrid::BA_PARAM_B_CUBED);
-        SetBounceAverage(BA_B3_f2,       FLUXGRIDTYPE_P2, RadialGrid::BA_FUNC_B_CUBED, nullptr, RadialGrid::BA_PARAM_B_CUBED);
-        SetBounceAverage(BA_xi2B2_f1,    FLUXGRIDTYPE_P1, RadialGrid::BA_FUNC_XI_SQUARED_B_SQUARED, nullptr, RadialGrid::BA_PARAM_XI_SQUARED_B_SQUARED);
-        SetBounceAverage(BA_xi2B2_f2,    FLUXGRIDTYPE_P2, RadialGrid::BA_FUNC_XI_SQUARED_B_SQUARED, nullptr, RadialGrid::BA_PARAM_XI_SQUARED_B_SQUARED);
+        SetBounceAverage(BA_xi_fr,       FLUXGRIDTYPE_RADIAL, xi, RadialGrid::BA_PARAM_XI);
+        SetBounceAverage(BA_xi_f1,       FLUXGRIDTYPE_P1, xi, RadialGrid::BA_PARAM_XI);
+        SetBounceAverage(BA_xi_f2,       FLUXGRIDTYPE_P2, xi, RadialGrid::BA_PARAM_XI);
+        SetBounceAverage(BA_xi2OverB_f1, FLUXGRIDTYPE_P1, xi2OverB, RadialGrid::BA_PARAM_XI_SQUARED_OVER_B);
+        SetBounceAverage(BA_xi2OverB_f2, FLUXGRIDTYPE_P2, xi2OverB, RadialGrid::BA_PARAM_XI_SQUARED_OVER_B);
+        SetBounceAverage(BA_B3_f1,       FLUXGRIDTYPE_P1, B3, RadialGrid::BA_PARAM_B_CUBED);
+        SetBounceAverage(BA_B3_f2,       FLUXGRIDTYPE_P2, B3, RadialGrid::BA_PARAM_B_CUBED);
+        SetBounceAverage(BA_xi2B2_f1,    FLUXGRIDTYPE_P1, xi2B2, RadialGrid::BA_PARAM_XI_SQUARED_B_SQUARED);
+        SetBounceAverage(BA_xi2B2_f2,    FLUXGRIDTYPE_P2, xi2B2, RadialGrid::BA_PARAM_XI_SQUARED_B_SQUARED);
+    }
+
+    if (!cached && cache != nullptr) {
+        cache->Put("ba/xi_fr",       BA_xi_fr, nr+1, np1*np2);
+        cache->Put("ba/xi_f1",       BA_xi_f1, nr, (np1+1)*np2);
+        cache->Put("ba/xi_f2",       BA_xi_f2, nr, np1*(np2+1));
+        cache->Put("ba/xi2OverB_f1", BA_xi2OverB_f1, nr, (np1+1)*np2);
+        cache->Put("ba/xi2OverB_f2", BA_xi2OverB_f2, nr, np1*(np2+1));
+        cache->Put("ba/B3_f1",       BA_B3_f1, nr, (np1+1)*np2);
+        cache->Put("ba/B3_f2",       BA_B3_f2, nr, np1*(np2+1));
+        cache->Put("ba/xi2B2_f1",    BA_xi2B2_f1, nr, (np1+1)*np2);
+        cache->Put("ba/xi2B2_f2",    BA_xi2B2_f2, nr, np1*(np2+1));
     }
     InitializeBAvg(BA_xi_fr,BA_xi_f1,BA_xi_f2,BA_xi2OverB_f1, BA_xi2OverB_f2,BA_B3_f1,BA_B3_f2,
         BA_xi2B2_f1,BA_xi2B2_f2);
 
-    CalculateAvalancheDeltaHat();
+    CalculateAvalancheDeltaHat(cache);
 
 }
 
@@ -298,85 +508,15 @@ real_t Grid::CalculateFluxSurfaceAverage(len_t ir, fluxGridType fluxGridType, re
     return rgrid->CalculateFluxSurfaceAverage(ir,fluxGridType,F,par,Flist);
 }
 
-/**
- * Helper method to set one bounce averaged coefficient on the entire grid
- */
-void Grid::SetBounceAverage(real_t **&BA_quantity, fluxGridType fluxGridType, real_t(*F)(real_t,real_t,real_t,real_t,void*), void *par, const int_t *Flist){
-    len_t nr = GetNr() + (fluxGridType==FLUXGRIDTYPE_RADIAL);
-    len_t np1, np2;
-    BA_quantity = new real_t*[nr];
-    for(len_t ir=0; ir<nr; ir++){
-        MomentumGrid *mg = momentumGrids[ir];
-        np1 = mg->GetNp1() + (fluxGridType==FLUXGRIDTYPE_P1);
-        np2 = mg->GetNp2() + (fluxGridType==FLUXGRIDTYPE_P2);
-        bool pIsZero; // set to 1 if p(0,0)=0 since metric is singular
-        if(fluxGridType==FLUXGRIDTYPE_P1)
-            pIsZero = (mg->GetP_f1(0,0)==0);
-        else if(fluxGridType==FLUXGRIDTYPE_P2)
-            pIsZero = (mg->GetP_f2(0,0)==0);
-        else 
-            pIsZero = (mg->GetP(0,0)==0);
-
-        BA_quantity[ir] = new real_t[np1*np2];
-        for(len_t j=0;j<np2;j++){
-            if(pIsZero){
-                real_t xi0;
-                if(fluxGridType==FLUXGRIDTYPE_P1)
-                    xi0 = mg->GetXi0_f1(0,j);
-                else if(fluxGridType==FLUXGRIDTYPE_P2)
-                    xi0 = mg->GetXi0_f2(0,j);
-                else 
-                    xi0 = mg->GetXi0(0,j);
-                BA_quantity[ir][j*np1] = this->rgrid->CalculatePXiBounceAverageAtP(ir,xi0,fluxGridType,F,par,Flist);
-            } 
-            for(len_t i=pIsZero;i<np1;i++)
-                BA_quantity[ir][j*np1+i] = CalculateBounceAverage(ir,i,j,fluxGridType,F,par,Flist);
-        }
-    }    
-}
-/**
- * Optimized helper method to set one bounce averaged coefficient on the entire grid,
- * assuming that the grid uses p-xi coordinates and the bounce average is independent
- * of p
- */
-void Grid::SetBounceAveragePXi(real_t **&BA_quantity, fluxGridType fluxGridType, real_t(*F)(real_t,real_t,real_t,real_t,void*), void *par, const int_t *Flist){
-    len_t nr = GetNr() + (fluxGridType==FLUXGRIDTYPE_RADIAL);
-    len_t np1, np2;
-    // XXX: assumes same momentumgrid at all radii
-    MomentumGrid *mg = momentumGrids[0];
-    np1 = mg->GetNp1() + (fluxGridType==FLUXGRIDTYPE_P1);
-    np2 = mg->GetNp2() + (fluxGridType==FLUXGRIDTYPE_P2);
-    BA_quantity = new real_t*[nr];
-    for(len_t ir=0; ir<nr; ir++){
-//        bool pIsZero = false; // set to 1 if p(0)=0 since metric is singular
-//        if(fluxGridType==FLUXGRIDTYPE_P1)
-//            pIsZero = (mg->GetP1_f(0)==0);
-
-        BA_quantity[ir] = new real_t[np1*np2];
-        for(len_t j=0;j<np2;j++){
-            /*
-            if(pIsZero){
-                real_t xi0;
-                if(fluxGridType==FLUXGRIDTYPE_P2)
-                    xi0 = mg->GetP2_f(j);
-                else 
-                    xi0 = mg->GetP2(j);
-                BA_quantity[ir][j*np1] = this->rgrid->CalculatePXiBounceAverageAtP(ir,xi0,fluxGridType,F,Flist);
-            } 
-            */
-            real_t BA = CalculateBounceAverage(ir,0,j,fluxGridType,F,par,Flist);
-            for(len_t i=0;i<np1;i++)
-                BA_quantity[ir][j*np1+i] = BA;
-        }
-    }    
-}
-
 /**
  * Evaluates and stores the bounce- and cell averaged delta function 
  * that appears in the Rosenbluth-Putvinski avalanche source.
  * See documentation in doc/notes/theory for more details.
+ *
+ * cache: Optional geometry cache from which to load (or to
+ *        which to save) the delta function.
  */
-void Grid::CalculateAvalancheDeltaHat(){
+void Grid::CalculateAvalancheDeltaHat(GeometryCache *cache){
     if(avalancheDeltaHat != nullptr){
         for(len_t ir=0; ir<GetNr(); ir++){
             delete [] avalancheDeltaHat[ir];
@@ -384,6 +524,21 @@ void Grid::CalculateAvalancheDeltaHat(){
         }
         delete [] avalancheDeltaHat;
         delete [] avalancheDeltaHatNegativePitch;
+        avalancheDeltaHat = nullptr;
+        avalancheDeltaHatNegativePitch = nullptr;
+    }
+
+    // (the geometry cache is only used when the same
+    // momentum grid is used at all radii)
+    if (cache != nullptr &&
+        cache->Get("ba/avalancheDeltaHat", avalancheDeltaHat, GetNr(), GetNp1(0)*GetNp2(0)) &&
+        cache->Get("ba/avalancheDeltaHatNegativePitch", avalancheDeltaHatNegativePitch, GetNr(), GetNp1(0)*GetNp2(0)))
+        return;
+    else if (avalancheDeltaHat != nullptr) {
+        // (only the positive-pitch array was found in the cache)
+        for(len_t ir=0; ir<GetNr(); ir++)
+            delete [] avalancheDeltaHat[ir];
+        delete [] avalancheDeltaHat;
     }
 
     avalancheDeltaHat = new real_t*[GetNr()];
@@ -421,6 +576,11 @@ void Grid::CalculateAvalancheDeltaHat(){
             }        
     }
 
+    if (cache != nullptr) {
+        cache->Put("ba/avalancheDeltaHat", avalancheDeltaHat, GetNr(), GetNp1(0)*GetNp2(0));
+        cache->Put("ba/avalancheDeltaHatNegativePitch", avalancheDeltaHatNegativePitch, GetNr(), GetNp1(0)*GetNp2(0));
+    }
+
 }
 
 /**
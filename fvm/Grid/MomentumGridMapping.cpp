@@ -0,0 +1,162 @@
+/**
+ * Implementation of the conservative mapping between two p-xi
+ * momentum grids, used for coupling radii which use different
+ * momentum grids (see 'Grid::GetMomentumGridMapping()').
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "FVM/FVMException.hpp"
+#include "FVM/Grid/MomentumGridMapping.hpp"
+
+
+using namespace std;
+using namespace DREAM::FVM;
+
+
+namespace {
+    // Momentum-space volume of the interval [p0, p1] (per unit solid angle)
+    real_t MeasureP(const real_t p0, const real_t p1) { return (p1*p1*p1 - p0*p0*p0)/3; }
+    // Length of the pitch interval [xi0, xi1]
+    real_t MeasureXi(const real_t xi0, const real_t xi1) { return (xi1 - xi0); }
+}
+
+
+/**
+ * Constructor.
+ *
+ * from: Momentum grid on which the mapped functions are defined.
+ * to:   Momentum grid onto which the functions are mapped.
+ */
+MomentumGridMapping::MomentumGridMapping(
+    const MomentumGrid *from, const MomentumGrid *to
+) : from(from), to(to) {
+    len_t max1, max2;
+    SetOverlap(
+        to->GetNp1(), to->GetP1_f(), from->GetNp1(), from->GetP1_f(),
+        MeasureP, offset1, index1, weight1, rweight1, max1
+    );
+    SetOverlap(
+        to->GetNp2(), to->GetP2_f(), from->GetNp2(), from->GetP2_f(),
+        MeasureXi, offset2, index2, weight2, rweight2, max2
+    );
+
+    this->maxOverlap = max1*max2;
+}
+
+/**
+ * Destructor.
+ */
+MomentumGridMapping::~MomentumGridMapping() {
+    delete [] offset1;
+    delete [] index1;
+    delete [] weight1;
+    delete [] offset2;
+    delete [] index2;
+    delete [] weight2;
+    delete [] rweight1;
+    delete [] rweight2;
+}
+
+
+/**
+ * Calculate the overlap between the cells of two grids along
+ * one momentum coordinate.
+ *
+ * nTo:        Number of cells of the grid mapped to.
+ * xTo:        Cell faces of the grid mapped to (size nTo+1).
+ * nFrom:      Number of cells of the grid mapped from.
+ * xFrom:      Cell faces of the grid mapped from (size nFrom+1).
+ * measure:    Function giving the volume of an interval along
+ *             the coordinate.
+ * offset:     On return, contains the offset of the overlapping
+ *             cells of each cell of the grid mapped to in 'index'
+ *             and 'weight' (size nTo+1).
+ * index:      On return, contains the indices of the overlapping
+ *             cells of the grid mapped from.
+ * weight:     On return, contains the fraction of the volume of the
+ *             cell mapped to covered by each overlapping cell.
+ * rweight:    On return, contains the fraction of the volume of each
+ *             overlapping cell covered by the cell mapped to.
+ * maxOverlap: On return, contains the maximum number of cells
+ *             overlapping a single cell of the grid mapped to.
+ */
+void MomentumGridMapping::SetOverlap(
+    const len_t nTo, const real_t *xTo, const len_t nFrom,
+    const real_t *xFrom, real_t (*measure)(const real_t, const real_t),
+    len_t *&offset, len_t *&index, real_t *&weight, real_t *&rweight,
+    len_t &maxOverlap
+) {
+    const real_t scale = max(abs(xTo[nTo]-xTo[0]), abs(xFrom[nFrom]-xFrom[0]));
+    const real_t tol = 100*numeric_limits<real_t>::epsilon() * scale;
+    if (abs(xTo[0]-xFrom[0]) > tol || abs(xTo[nTo]-xFrom[nFrom]) > tol)
+        throw FVMException(
+            "MomentumGridMapping: The momentum grids do not cover the same "
+            "momentum space: [%e, %e] vs. [%e, %e].",
+            xFrom[0], xFrom[nFrom], xTo[0], xTo[nTo]
+        );
+
+    vector<len_t> idx;
+    vector<real_t> w, rw;
+    offset = new len_t[nTo+1];
+    maxOverlap = 0;
+
+    for (len_t i = 0, a = 0; i < nTo; i++) {
+        offset[i] = idx.size();
+
+        // Skip cells lying entirely below this cell
+        while (a+1 < nFrom && xFrom[a+1] <= xTo[i]+tol)
+            a++;
+
+        const real_t V = measure(xTo[i], xTo[i+1]);
+        for (len_t b = a; b < nFrom && xFrom[b] < xTo[i+1]-tol; b++) {
+            const real_t x0 = max(xTo[i], xFrom[b]);
+            const real_t x1 = min(xTo[i+1], xFrom[b+1]);
+            if (x1 <= x0)
+                continue;
+
+            const real_t v = measure(x0, x1);
+            idx.push_back(b);
+            w.push_back(v / V);
+            rw.push_back(v / measure(xFrom[b], xFrom[b+1]));
+        }
+
+        maxOverlap = max(maxOverlap, (len_t)(idx.size()-offset[i]));
+    }
+    offset[nTo] = idx.size();
+
+    index  = new len_t[idx.size()];
+    weight = new real_t[w.size()];
+    rweight = new real_t[rw.size()];
+    copy(idx.begin(), idx.end(), index);
+    copy(w.begin(), w.end(), weight);
+    copy(rw.begin(), rw.end(), rweight);
+}
+
+
+/**
+ * Evaluate the volume average of the function 'fFrom', defined
+ * on the grid 'from', over the cell (i,j) of the grid 'to'.
+ */
+real_t MomentumGridMapping::Interpolate(const real_t *fFrom, const len_t i, const len_t j) const {
+    const len_t n1 = from->GetNp1();
+    real_t v = 0;
+    ForEachOverlap(i, j, [&v,fFrom,n1](const len_t a, const len_t b, const real_t W, const real_t) {
+        v += W * fFrom[b*n1+a];
+    });
+
+    return v;
+}
+
+/**
+ * Map the function 'fFrom', defined on the grid 'from', onto
+ * the grid 'to' (with the result stored in 'fTo').
+ */
+void MomentumGridMapping::Interpolate(const real_t *fFrom, real_t *fTo) const {
+    const len_t n1 = to->GetNp1(), n2 = to->GetNp2();
+    for (len_t j = 0; j < n2; j++)
+        for (len_t i = 0; i < n1; i++)
+            fTo[j*n1+i] = Interpolate(fFrom, i, j);
+}
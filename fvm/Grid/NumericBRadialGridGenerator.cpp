@@ -5,13 +5,33 @@
  */
 #include <algorithm>
 #include <gsl/gsl_interp.h>
-#include <gsl/gsl_spline2d.h>
+#ifdef _OPENMP
+#   include <omp.h>
+#endif
 #include "FVM/Grid/NumericBRadialGridGenerator.hpp"
 
 
 using namespace DREAM::FVM;
 
 
+/**
+ * Returns the interpolation accelerator to use for the radial
+ * coordinate. Since the accelerator caches the most recently
+ * used interval, it may not be shared between threads; inside of
+ * parallel regions (e.g. when rebuilding the flux surface and bounce
+ * averagers), no accelerator is used and the interval is instead
+ * located with a binary search. (The 2D splines keep no state and
+ * can be evaluated from any thread.)
+ */
+gsl_interp_accel *NumericBRadialGridGenerator::AccR() const {
+#ifdef _OPENMP
+    if (omp_in_parallel())
+        return nullptr;
+#endif
+    return this->acc_r;
+}
+
+
 /**
  * Constructor for a uniform radial grid.
  *
@@ -68,7 +88,6 @@ void NumericBRadialGridGenerator::Init(
 	this->psiPrimeRef_f = new real_t[GetNr()+1];
 
     this->acc_r = gsl_interp_accel_alloc();
-    this->acc_theta = gsl_interp_accel_alloc();
 
     LoadMagneticFieldData(mf, frmt);
 }
@@ -80,16 +99,8 @@ NumericBRadialGridGenerator::~NumericBRadialGridGenerator() {
     if (this->rf_provided != nullptr)
         delete [] this->rf_provided;
 
-    if (this->spline_R != nullptr) {
-        gsl_spline_free(this->spline_psi);
-        gsl_spline2d_free(this->spline_R);
-        gsl_spline2d_free(this->spline_Z);
-        gsl_spline2d_free(this->spline_BR);
-        gsl_spline2d_free(this->spline_BZ);
-        gsl_spline2d_free(this->spline_Bphi);
-    }
+    DeallocateSplines();
 
-    gsl_interp_accel_free(this->acc_theta);
     gsl_interp_accel_free(this->acc_r);
 
 	delete [] this->BtorGOverR0;
@@ -97,6 +108,24 @@ NumericBRadialGridGenerator::~NumericBRadialGridGenerator() {
 }
 
 
+/**
+ * Deallocate the splines used for interpolating in the
+ * magnetic field data.
+ */
+void NumericBRadialGridGenerator::DeallocateSplines() {
+    if (this->spline_R == nullptr)
+        return;
+
+    gsl_spline_free(this->spline_psi);
+    delete this->spline_R;
+    delete this->spline_Z;
+    delete this->spline_Bphi;
+    delete this->spline_B;
+
+    this->spline_R = nullptr;
+}
+
+
 /**
  * Make sure that the given poloidal angle is on the interval
  * [0, 2pi], and if not, shift so that it is.
@@ -328,6 +357,28 @@ real_t *NumericBRadialGridGenerator::addThetaDataPoint(
 	return arr;
 }
 
+/**
+ * Add the loaded magnetic equilibrium to the given geometry
+ * cache key. Since the equilibrium is static, all geometric
+ * quantities derived from it can be cached.
+ */
+bool NumericBRadialGridGenerator::HashGeometry(GeometryCache::Hash &h) {
+    h.Add(std::string("NumericBRadialGridGenerator"));
+    h.Add(this->npsi);
+    h.Add(this->ntheta);
+    h.Add(this->Rp);
+    h.Add(this->Zp);
+    h.Add(this->psi, this->npsi);
+    h.Add(this->theta, this->ntheta);
+    h.Add(this->R, this->npsi*this->ntheta);
+    h.Add(this->Z, this->npsi*this->ntheta);
+    h.Add(this->dataBR, this->npsi*this->ntheta);
+    h.Add(this->dataBZ, this->npsi*this->ntheta);
+    h.Add(this->dataBphi, this->npsi*this->ntheta);
+
+    return true;
+}
+
 /**
  * Rebuild this numeric radial B grid.
  */
@@ -390,37 +441,25 @@ bool NumericBRadialGridGenerator::Rebuild(const real_t, RadialGrid *rGrid) {
     rGrid->Initialize(r, r_f, dr, dr_f);
 
     // Construct splines for input data
+    // (the bicubic coefficients of the 2D splines are computed
+    // once here, which makes each evaluation considerably
+    // cheaper than with 'gsl_spline2d')
+    DeallocateSplines();
     this->spline_psi  = gsl_spline_alloc(gsl_interp_steffen, this->npsi);
+    gsl_spline_init(this->spline_psi, this->input_r, this->psi, this->npsi);
 
-    const gsl_interp2d_type *splineType = gsl_interp2d_bicubic; //or ..._bilinear
-    this->spline_R    = gsl_spline2d_alloc(splineType, this->npsi, this->ntheta);
-    this->spline_Z    = gsl_spline2d_alloc(splineType, this->npsi, this->ntheta);
-    this->spline_BR   = gsl_spline2d_alloc(splineType, this->npsi, this->ntheta);
-    this->spline_BZ   = gsl_spline2d_alloc(splineType, this->npsi, this->ntheta);
-    this->spline_Bphi = gsl_spline2d_alloc(splineType, this->npsi, this->ntheta);
-    this->spline_B    = gsl_spline2d_alloc(splineType, this->npsi, this->ntheta);
-
-    gsl_spline_init(this->spline_psi,    this->input_r, this->psi,   this->npsi);
-    gsl_spline2d_init(this->spline_R,    this->input_r, this->theta, this->R, this->npsi, this->ntheta);
-    gsl_spline2d_init(this->spline_Z,    this->input_r, this->theta, this->Z, this->npsi, this->ntheta);
-    gsl_spline2d_init(this->spline_BR,   this->input_r, this->theta, this->dataBR, this->npsi, this->ntheta);
-    gsl_spline2d_init(this->spline_BZ,   this->input_r, this->theta, this->dataBZ, this->npsi, this->ntheta);
-    gsl_spline2d_init(this->spline_Bphi, this->input_r, this->theta, this->dataBphi, this->npsi, this->ntheta);
-    gsl_spline2d_init(this->spline_B,    this->input_r, this->theta, this->dataB, this->npsi, this->ntheta);
+    this->spline_R    = new BicubicSpline(this->input_r, this->npsi, this->theta, this->ntheta, this->R);
+    this->spline_Z    = new BicubicSpline(this->input_r, this->npsi, this->theta, this->ntheta, this->Z);
+    this->spline_Bphi = new BicubicSpline(this->input_r, this->npsi, this->theta, this->ntheta, this->dataBphi);
+    this->spline_B    = new BicubicSpline(this->input_r, this->npsi, this->theta, this->ntheta, this->dataB);
 
 	// Reference quantities
 	for (len_t i = 0; i < GetNr(); i++) {
 		real_t
-			R  = gsl_spline2d_eval(
-					this->spline_R, this->r[i], 0,
-					this->acc_r, this->acc_theta
-				),
-			Bphi = gsl_spline2d_eval(
-					this->spline_Bphi, this->r[i], 0,
-					this->acc_r, this->acc_theta
-				),
+			R  = this->spline_R->Eval(this->r[i], 0),
+			Bphi = this->spline_Bphi->Eval(this->r[i], 0),
             psip = gsl_spline_eval_deriv(
-                    this->spline_psi, this->r[i], this->acc_r
+                    this->spline_psi, this->r[i], AccR()
                 );
 
 		this->BtorGOverR0[i] = (R/this->Rp) * Bphi;
@@ -429,16 +468,10 @@ bool NumericBRadialGridGenerator::Rebuild(const real_t, RadialGrid *rGrid) {
 	}
 	for (len_t i = 0; i < GetNr()+1; i++) {
 		real_t
-			R  = gsl_spline2d_eval(
-					this->spline_R, this->r_f[i], 0,
-					this->acc_r, this->acc_theta
-				),
-			Bphi = gsl_spline2d_eval(
-					this->spline_Bphi, this->r_f[i], 0,
-					this->acc_r, this->acc_theta
-				),
+			R  = this->spline_R->Eval(this->r_f[i], 0),
+			Bphi = this->spline_Bphi->Eval(this->r_f[i], 0),
             psip = gsl_spline_eval_deriv(
-                    this->spline_psi, this->r_f[i], this->acc_r
+                    this->spline_psi, this->r_f[i], AccR()
                 );
 
 		this->BtorGOverR0_f[i] = (R/this->Rp) * Bphi;
@@ -474,13 +507,12 @@ real_t NumericBRadialGridGenerator::JacobianAtTheta(
 ) {
     real_t t = this->_thetaBounded(theta);
 
-    real_t dRdr = gsl_spline2d_eval_deriv_x(this->spline_R, r, t, this->acc_r, this->acc_theta);
-    real_t dRdt = gsl_spline2d_eval_deriv_y(this->spline_R, r, t, this->acc_r, this->acc_theta);
-
-    real_t dZdr = gsl_spline2d_eval_deriv_x(this->spline_Z, r, t, this->acc_r, this->acc_theta);
-    real_t dZdt = gsl_spline2d_eval_deriv_y(this->spline_Z, r, t, this->acc_r, this->acc_theta);
+    BicubicSpline::point p;
+    this->spline_R->Locate(r, t, p);
 
-    real_t R    = gsl_spline2d_eval(this->spline_R, r, t, this->acc_r, this->acc_theta);
+    real_t R, dRdr, dRdt, Z, dZdr, dZdt;
+    this->spline_R->Eval(p, R, dRdr, dRdt);
+    this->spline_Z->Eval(p, Z, dZdr, dZdt);
 
     if (_R != nullptr) *_R = R;
     if (_dRdt != nullptr) *_dRdt = dRdt;
@@ -499,7 +531,7 @@ real_t NumericBRadialGridGenerator::ROverR0AtTheta(
     const real_t r, const real_t theta
 ) {
     real_t t = this->_thetaBounded(theta);
-    return gsl_spline2d_eval(this->spline_R, r, t, this->acc_r, this->acc_theta) / this->Rp;
+    return this->spline_R->Eval(r, t) / this->Rp;
 }
 
 /**
@@ -539,7 +571,41 @@ void NumericBRadialGridGenerator::EvaluateGeometricQuantities(
     ROverR0  = R/this->Rp;
     NablaR2  = r==0 ? 0 : (R*R/(Jacobian*Jacobian) * (dRdt*dRdt + dZdt*dZdt));
 
-    B = gsl_spline2d_eval(this->spline_B, r, t, this->acc_r, this->acc_theta);
+    B = this->spline_B->Eval(r, t);
+}
+
+/**
+ * Evaluate B, the Jacobian, R/R0 and |nabla r|^2 in all the given
+ * poloidal angles on the flux surface with minor radius 'r'. All
+ * quantities in a point are obtained from a single patch lookup,
+ * and consecutive (increasing) angles are typically found in the
+ * same or the next patch, so that no binary searches are needed.
+ *
+ * r:      Minor radius.
+ * ntheta: Number of poloidal angles.
+ * theta:  Poloidal angles to evaluate quantities in.
+ */
+void NumericBRadialGridGenerator::EvaluateGeometricQuantitiesOnTheta(
+    const real_t r, const len_t ntheta, const real_t *theta, real_t *B,
+    real_t *Jacobian, real_t *ROverR0, real_t *NablaR2
+) {
+    BicubicSpline::point p;
+    for (len_t it = 0; it < ntheta; it++) {
+        real_t t = this->_thetaBounded(theta[it]);
+        this->spline_R->Locate(r, t, p);
+
+        real_t R, dRdr, dRdt, Z, dZdr, dZdt;
+        this->spline_R->Eval(p, R, dRdr, dRdt);
+        this->spline_Z->Eval(p, Z, dZdr, dZdt);
+
+        real_t J_R0 = R/this->Rp*fabs(dRdr*dZdt - dRdt*dZdr);
+
+        B[it]        = this->spline_B->Eval(p);
+        Jacobian[it] = J_R0;
+        ROverR0[it]  = R/this->Rp;
+        // (same convention at r=0 as in 'NablaR2AtTheta()')
+        NablaR2[it]  = (r==0 ? 1.0 : R*R/(Rp*Rp*J_R0*J_R0) * (dRdt*dRdt + dZdt*dZdt));
+    }
 }
 
 /**
@@ -548,7 +614,7 @@ void NumericBRadialGridGenerator::EvaluateGeometricQuantities(
  */
 real_t NumericBRadialGridGenerator::EvalB(const real_t r, const real_t theta) {
     real_t t    = this->_thetaBounded(theta);
-    return gsl_spline2d_eval(this->spline_B, r, t, this->acc_r, this->acc_theta);
+    return this->spline_B->Eval(r, t);
 }
 
 real_t NumericBRadialGridGenerator::BAtTheta(const len_t ir, const real_t theta) {
@@ -607,24 +673,12 @@ void NumericBRadialGridGenerator::GetRThetaPhiFromCartesian(real_t *r, real_t *t
 	real_t rhoa, rhob;
 	do {
 		real_t
-		    xxa = gsl_spline2d_eval(
-		        this->spline_R, ra, *theta,
-		        this->acc_r, this->acc_theta
-		    ) - Rp,
-		    yya = gsl_spline2d_eval(
-		        this->spline_Z, ra, *theta,
-		        this->acc_r, this->acc_theta
-		    ) - this->Zp;
+		    xxa = this->spline_R->Eval(ra, *theta) - Rp,
+		    yya = this->spline_Z->Eval(ra, *theta) - this->Zp;
 		   
 		real_t
-		    xxb = gsl_spline2d_eval(
-		        this->spline_R, rb, *theta,
-		        this->acc_r, this->acc_theta
-		    )-Rp,
-		    yyb = gsl_spline2d_eval(
-		        this->spline_Z, rb, *theta,
-		        this->acc_r, this->acc_theta
-		    )- this->Zp;
+		    xxb = this->spline_R->Eval(rb, *theta)-Rp,
+		    yyb = this->spline_Z->Eval(rb, *theta)- this->Zp;
 		rhoa=hypot(xxa,yya);
 		rhob=hypot(xxb,yyb);
 		if(rhoa>rho && rhob>rho){
@@ -644,14 +698,8 @@ void NumericBRadialGridGenerator::GetRThetaPhiFromCartesian(real_t *r, real_t *t
 	    do {
 	        r_tmp = (ra+rb)/2;
 	        real_t
-	            xx = gsl_spline2d_eval(
-	                this->spline_R, r_tmp, *theta,
-	                this->acc_r, this->acc_theta
-	            )-Rp,
-	            yy = gsl_spline2d_eval(
-	                this->spline_Z, r_tmp, *theta,
-	                this->acc_r, this->acc_theta
-	            ) - this->Zp;
+	            xx = this->spline_R->Eval(r_tmp, *theta)-Rp,
+	            yy = this->spline_Z->Eval(r_tmp, *theta) - this->Zp;
 
 	        if (hypot(xx, yy) < rho)
 	            ra = r_tmp;
@@ -668,26 +716,14 @@ void NumericBRadialGridGenerator::GetRThetaPhiFromCartesian(real_t *r, real_t *t
 	/*r_tmp=startingGuessR;
 	do {
 	    real_t
-	        xx = gsl_spline2d_eval(
-	            this->spline_R, r_tmp, *theta,
-	            this->acc_r, this->acc_theta
-	        ),
-	        yy = gsl_spline2d_eval(
-	            this->spline_Z, r_tmp, *theta,
-	            this->acc_r, this->acc_theta
-	        );
+	        xx = this->spline_R->Eval(r_tmp, *theta),
+	        yy = this->spline_Z->Eval(r_tmp, *theta);
 	        
-	    // note that r_tmp is here the x-variable given to gsl_spline2d_eval_deriv_x, 
+	    // note that r_tmp is here the x-variable given to EvalDerivX, 
 	    // so that it should really be the x-derivative which is evaluated for both xx and yy
 	    real_t
-	        dxxdr = gsl_spline2d_eval_deriv_x(
-	            this->spline_R, r_tmp, *theta,
-	            this->acc_r, this->acc_theta
-	        ),
-	        dyydr = gsl_spline2d_eval_deriv_x(
-	            this->spline_Z, r_tmp, *theta,
-	            this->acc_r, this->acc_theta
-	        );
+	        dxxdr = this->spline_R->EvalDerivX(r_tmp, *theta),
+	        dyydr = this->spline_Z->EvalDerivX(r_tmp, *theta);
 	        
 	    real_t rho_newton=hypot(xx,yy);
 	    r_tmp=r_tmp-(rho_newton-rho)/((xx*dxxdr+yy*dyydr)/rho_newton);
@@ -705,22 +741,10 @@ void NumericBRadialGridGenerator::GetGradRCartesian(real_t* gradr, real_t r, rea
 	//throw FVMException("NumericBRadialGridGenerator: This module is currently incompatible with the SPI module.");
 	if(r<r_f[GetNr()]){
         real_t
-        dRdr = gsl_spline2d_eval_deriv_x(
-            this->spline_R, r, theta,
-            this->acc_r, this->acc_theta
-        ),
-        dzdr = gsl_spline2d_eval_deriv_x(
-            this->spline_Z, r, theta,
-            this->acc_r, this->acc_theta
-        ),    
-        dRdtheta = gsl_spline2d_eval_deriv_y(
-            this->spline_R, r, theta,
-            this->acc_r, this->acc_theta
-        ),    
-        dzdtheta = gsl_spline2d_eval_deriv_y(
-            this->spline_Z, r, theta,
-            this->acc_r, this->acc_theta
-        );
+        dRdr = this->spline_R->EvalDerivX(r, theta),
+        dzdr = this->spline_Z->EvalDerivX(r, theta),    
+        dRdtheta = this->spline_R->EvalDerivY(r, theta),    
+        dzdtheta = this->spline_Z->EvalDerivY(r, theta);
         
         real_t common_factor = 1/(dRdr*dzdtheta - dRdtheta*dzdr);
         gradr[0] = common_factor * dzdtheta * cos(phi);
@@ -0,0 +1,140 @@
+/**
+ * Implementation of a momentum (p) grid generator which adapts the
+ * grid to the gradients of a reference distribution function.
+ *
+ * The grid points are distributed so that the monitor function
+ *
+ *   M(p) = 1 + (dpRatio-1) * |df/dp| / max|df/dp|
+ *
+ * is equidistributed, i.e. so that the integral of M(p) over every
+ * cell is the same. Here, f is a Maxwell-Jüttner distribution with the
+ * reference temperature Theta = T/mc^2. Cells are therefore up to
+ * 'dpRatio' times smaller where the thermal bulk varies rapidly than in
+ * the tail, where the grid is (nearly) uniform. The total number of
+ * cells is fixed, which means one grid with 'np' cells resolves both
+ * the bulk and the tail.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "FVM/Grid/MomentumGrid.hpp"
+#include "FVM/Grid/MomentumGridGenerator.hpp"
+#include "FVM/Grid/RadialGrid.hpp"
+#include "FVM/Grid/PXiGrid/PAdaptiveGridGenerator.hpp"
+
+
+using namespace DREAM::FVM::PXiGrid;
+
+/**
+ * Constructor.
+ *
+ * np:      Number of points on (cell) grid.
+ * pMin:    Minimum value of coordinate on (flux) grid.
+ * pMax:    Maximum value of coordinate on (flux) grid.
+ * Theta:   Temperature of the reference distribution (normalized
+ *          to the electron rest energy mc^2).
+ * dpRatio: Ratio between the largest and smallest cell on the grid.
+ */
+PAdaptiveGridGenerator::PAdaptiveGridGenerator(
+    const len_t np, const real_t pMin, const real_t pMax,
+    const real_t Theta, const real_t dpRatio
+) : np(np), pMin(pMin), pMax(pMax), Theta(Theta), dpRatio(dpRatio) {
+    if (np < 1)
+        throw MomentumGridGeneratorException(
+            "Adaptive p grid generator: The grid must contain at least one cell."
+        );
+    if (pMin >= pMax)
+        throw MomentumGridGeneratorException(
+            "Adaptive p grid generator: The lower boundary 'pMin' must be located below 'pMax'."
+        );
+    if (Theta <= 0)
+        throw MomentumGridGeneratorException(
+            "Adaptive p grid generator: The reference temperature must be positive."
+        );
+    if (dpRatio < 1)
+        throw MomentumGridGeneratorException(
+            "Adaptive p grid generator: The ratio between the largest and smallest cell must be at least 1."
+        );
+}
+
+
+/**
+ * Evaluate the (unnormalized) gradient |df/dp| of the reference
+ * distribution in the given point.
+ */
+real_t PAdaptiveGridGenerator::EvaluateGradient(const real_t p) const {
+    const real_t gamma = sqrt(1 + p*p);
+    return p/(gamma*Theta) * exp(-(gamma-1)/Theta);
+}
+
+
+/***********************************
+ * PUBLIC METHODS                  *
+ ***********************************/
+/**
+ * Re-build the given momentum grid using this
+ * grid generator.
+ *
+ * mg: Momentum grid to re-build.
+ *
+ * (All other parameters are unused).
+ */
+bool PAdaptiveGridGenerator::Rebuild(const real_t, const len_t, MomentumGrid *mg, const RadialGrid*) {
+    real_t
+        *p    = new real_t[this->np],
+        *p_f  = new real_t[this->np+1],
+        *dp   = new real_t[this->np],
+        *dp_f = nullptr;
+
+    // Sample the monitor function on a fine uniform grid
+    const len_t nFine = std::max((len_t)1000, 100*this->np);
+    const real_t h = (this->pMax - this->pMin) / nFine;
+    real_t *M = new real_t[nFine+1];
+
+    real_t g0 = 0;
+    for (len_t k = 0; k <= nFine; k++) {
+        M[k] = EvaluateGradient(this->pMin + k*h);
+        g0 = std::max(g0, M[k]);
+    }
+    for (len_t k = 0; k <= nFine; k++)
+        M[k] = (g0 > 0 ? 1 + (this->dpRatio-1) * M[k]/g0 : 1);
+
+    // Cumulative integral of the monitor function (trapezoidal rule)
+    real_t *I = new real_t[nFine+1];
+    I[0] = 0;
+    for (len_t k = 0; k < nFine; k++)
+        I[k+1] = I[k] + 0.5*h*(M[k] + M[k+1]);
+
+    // Build flux grid by inverting the cumulative integral
+    const real_t dI = I[nFine] / this->np;
+    p_f[0] = this->pMin;
+    for (len_t i = 1, k = 0; i < this->np; i++) {
+        const real_t target = i*dI;
+        while (k < nFine-1 && I[k+1] < target)
+            k++;
+
+        p_f[i] = this->pMin + h*(k + (target-I[k]) / (I[k+1]-I[k]));
+    }
+    p_f[this->np] = this->pMax;
+
+    delete [] I;
+    delete [] M;
+
+    for (len_t i = 0; i < this->np; i++)
+        dp[i] = p_f[i+1] - p_f[i];
+
+    // Build cell grid
+    for (len_t i = 0; i < this->np; i++)
+        p[i] = 0.5 * (p_f[i+1] + p_f[i]);
+
+    if (this->np > 1) {
+        dp_f = new real_t[this->np-1];
+        for (len_t i = 0; i < this->np-1; i++)
+            dp_f[i] = p[i+1] - p[i];
+    }
+
+    mg->InitializeP1("p", this->np, p, p_f, dp, dp_f);
+
+    initialized = true;
+    return true;
+}
@@ -0,0 +1,136 @@
+/**
+ * Implementation of a pitch (xi) grid generator which places the cell
+ * centres in the nodes of an 'nxi'-point Gauss-Legendre quadrature,
+ * with cell widths equal to the corresponding quadrature weights, i.e.
+ *
+ *   xi_{1/2}   = -1,
+ *   xi_{k+1/2} = xi_{k-1/2} + w_k,
+ *   xi_k       = k'th Gauss-Legendre node,
+ *
+ * (the nodes are guaranteed to lie inside their cells, since the partial
+ * sums of the weights separate the nodes). This is an ordinary finite
+ * volume grid: the distribution function is still represented by its
+ * cell averages, and operators and moments are discretized exactly as on
+ * any other non-uniform pitch grid. The Gauss-Legendre quadrature only
+ * determines the placement of the cells, which are clustered towards
+ * xi = +-1, where anisotropic runaway distributions vary most rapidly.
+ * (In particular, moments are not exact for polynomial distributions,
+ * since the cell averages of the discrete solution are not the nodal
+ * values of the quadrature, and since the moments are weighted with the
+ * bounce-averaged metric rather than with dxi alone.)
+ */
+
+#include <cmath>
+#include <limits>
+#include "FVM/Grid/MomentumGrid.hpp"
+#include "FVM/Grid/MomentumGridGenerator.hpp"
+#include "FVM/Grid/RadialGrid.hpp"
+#include "FVM/Grid/PXiGrid/XiGaussLegendreNodeGridGenerator.hpp"
+
+using namespace DREAM::FVM::PXiGrid;
+
+/**
+ * Constructor.
+ *
+ * nxi: Number of points on (cell) grid.
+ */
+XiGaussLegendreNodeGridGenerator::XiGaussLegendreNodeGridGenerator(
+    const len_t nxi
+) : nxi(nxi) {
+    
+    if (nxi < 1)
+        throw MomentumGridGeneratorException(
+            "Gauss-Legendre xi grid generator: The grid must contain at least 1 cell. Specified number of cells: " LEN_T_PRINTF_FMT ".", nxi
+        );
+}
+
+
+/***********************************
+ * PUBLIC METHODS                  *
+ ***********************************/
+/**
+ * Evaluate the nodes and weights of the n-point Gauss-Legendre
+ * quadrature on [-1, 1], ordered by increasing node value. The nodes
+ * are located with Newton's method from their asymptotic locations.
+ *
+ * n: Number of nodes.
+ * x: On return, contains the nodes (length n).
+ * w: On return, contains the weights (length n).
+ */
+void XiGaussLegendreNodeGridGenerator::GetGaussLegendreNodes(
+    const len_t n, real_t *x, real_t *w
+) {
+    const len_t MAX_ITERATIONS = 100;
+
+    // The nodes are symmetric about xi = 0, and so only
+    // the nodes in (0, 1] are evaluated
+    for (len_t i = 0; i < (n+1)/2; i++) {
+        real_t z = cos(M_PI*(i+0.75) / (n+0.5)), dP = 0;
+
+        for (len_t it = 0; it < MAX_ITERATIONS; it++) {
+            // Evaluate P_n(z) (and its derivative) with the
+            // three-term recurrence relation
+            real_t P = 1, Pprev = 0;
+            for (len_t k = 1; k <= n; k++) {
+                const real_t Pk = ((2*k-1)*z*P - (k-1)*Pprev) / k;
+                Pprev = P;
+                P = Pk;
+            }
+            dP = n*(z*P - Pprev) / (z*z - 1);
+
+            const real_t dz = P / dP;
+            z -= dz;
+
+            if (fabs(dz) <= 4*std::numeric_limits<real_t>::epsilon())
+                break;
+        }
+
+        const real_t wi = 2 / ((1-z*z)*dP*dP);
+        x[i]     = -z;  x[n-1-i] = z;
+        w[i]     = wi;  w[n-1-i] = wi;
+    }
+
+    // (the middle node of an odd quadrature is exactly zero)
+    if (n % 2 == 1)
+        x[n/2] = 0;
+}
+
+/**
+ * Re-build the given momentum grid using this
+ * grid generator.
+ *
+ * mg: Momentum grid to re-build.
+ *
+ * (All other parameters are unused).
+ */
+bool XiGaussLegendreNodeGridGenerator::Rebuild(const real_t, const len_t, MomentumGrid *mg, const RadialGrid*) {
+    real_t
+        *xi    = new real_t[this->nxi],
+        *xi_f  = new real_t[this->nxi+1],
+        *dxi   = new real_t[this->nxi],
+        *dxi_f = nullptr;
+
+    // Cell grid and cell widths
+    GetGaussLegendreNodes(this->nxi, xi, dxi);
+
+    // Build flux grid (the weights sum to 2, so that the last
+    // face is set explicitly to avoid round-off)
+    xi_f[0] = -1;
+    for (len_t i = 1; i < this->nxi; i++)
+        xi_f[i] = xi_f[i-1] + dxi[i-1];
+    xi_f[this->nxi] = 1;
+
+    // Make the cell widths consistent with the flux grid
+    for (len_t i = 0; i < this->nxi; i++)
+        dxi[i] = xi_f[i+1] - xi_f[i];
+
+    if (this->nxi > 1) {
+        dxi_f = new real_t[this->nxi-1];
+        for (len_t i = 0; i < this->nxi-1; i++)
+            dxi_f[i] = xi[i+1] - xi[i];
+    }
+
+    mg->InitializeP2("xi", this->nxi, xi, xi_f, dxi, dxi_f);
+    this->initialized = true;
+    return true;
+}
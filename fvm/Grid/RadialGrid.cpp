@@ -65,6 +65,8 @@ bool RadialGrid::Rebuild(const real_t t) {
     // Re-build radial grid
     if (this->generator->NeedsRebuild(t)){
         bool rebuilt = this->generator->Rebuild(t, this);
+        if (rebuilt)
+            this->jacobiansOutdated = true;
         return rebuilt;
     }
     else return false;
@@ -73,11 +75,17 @@ bool RadialGrid::Rebuild(const real_t t) {
 /**
  * Rebuilds magnetic-field data and initializes flux 
  * surface average calculations.
+ *
+ * cache: Optional geometry cache from which to load (or
+ *        to which to save) the flux surface averages.
  */
-void RadialGrid::RebuildJacobians(){ 
+void RadialGrid::RebuildJacobians(GeometryCache *cache){ 
     this->generator->RebuildJacobians(this);
-    fluxSurfaceAverager->Rebuild();
-    RebuildFluxSurfaceAveragedQuantities();
+    fluxSurfaceAverager->Rebuild(cache);
+    RebuildFluxSurfaceAveragedQuantities(cache);
+
+    this->jacobiansOutdated = false;
+    this->jacobianRevision++;
 }
 
 
@@ -170,8 +178,11 @@ void RadialGrid::SetReferenceMagneticFieldData(
 
 /**
  * Calculate and store flux surface averages.
+ *
+ * cache: Optional geometry cache from which to load (or
+ *        to which to save) the flux surface averages.
  */
-void RadialGrid::RebuildFluxSurfaceAveragedQuantities(){
+void RadialGrid::RebuildFluxSurfaceAveragedQuantities(GeometryCache *cache){
  real_t 
     *effectivePassingFraction   = nullptr, 
     *effectivePassingFraction_f = nullptr, 
@@ -184,12 +195,39 @@ void RadialGrid::RebuildFluxSurfaceAveragedQuantities(){
     *FSA_1OverR2   = nullptr,
     *FSA_1OverR2_f = nullptr;
 
-    SetFluxSurfaceAverage(FSA_1OverR2,FSA_1OverR2_f, FSA_FUNC_ONE_OVER_R_SQUARED, nullptr, FSA_PARAM_ONE_OVER_R_SQUARED);
-    SetFluxSurfaceAverage(FSA_B,FSA_B_f, FSA_FUNC_B, nullptr, FSA_PARAM_B);
-    SetFluxSurfaceAverage(FSA_B2,FSA_B2_f, FSA_FUNC_B_SQUARED, nullptr, FSA_PARAM_B_SQUARED);
-    SetFluxSurfaceAverage(FSA_nablaR2OverR2,FSA_nablaR2OverR2_f, FSA_FUNC_NABLA_R_SQUARED_OVER_R_SQUARED, nullptr, FSA_PARAM_NABLA_R_SQUARED_OVER_R_SQUARED);
-    
-    SetEffectivePassingFraction(effectivePassingFraction,effectivePassingFraction_f, FSA_B2, FSA_B2_f);
+    bool cached = (cache != nullptr &&
+        cache->Get("fsa/1OverR2", FSA_1OverR2, nr) && cache->Get("fsa/1OverR2_f", FSA_1OverR2_f, nr+1) &&
+        cache->Get("fsa/B", FSA_B, nr) && cache->Get("fsa/B_f", FSA_B_f, nr+1) &&
+        cache->Get("fsa/B2", FSA_B2, nr) && cache->Get("fsa/B2_f", FSA_B2_f, nr+1) &&
+        cache->Get("fsa/nablaR2OverR2", FSA_nablaR2OverR2, nr) &&
+        cache->Get("fsa/nablaR2OverR2_f", FSA_nablaR2OverR2_f, nr+1) &&
+        cache->Get("fsa/effectivePassingFraction", effectivePassingFraction, nr));
+
+    if (!cached) {
+        // (the cache is written in one go, so it either
+        // contains all or none of the quantities)
+        real_t **FSA[]   = {&FSA_1OverR2, &FSA_B, &FSA_B2, &FSA_nablaR2OverR2};
+        real_t **FSA_f[] = {&FSA_1OverR2_f, &FSA_B_f, &FSA_B2_f, &FSA_nablaR2OverR2_f};
+        const int_t *FSA_params[] = {
+            FSA_PARAM_ONE_OVER_R_SQUARED, FSA_PARAM_B,
+            FSA_PARAM_B_SQUARED, FSA_PARAM_NABLA_R_SQUARED_OVER_R_SQUARED
+        };
+        SetFluxSurfaceAverages(4, FSA, FSA_f, FSA_params);
+        
+        SetEffectivePassingFraction(effectivePassingFraction,effectivePassingFraction_f, FSA_B2, FSA_B2_f);
+
+        if (cache != nullptr) {
+            cache->Put("fsa/1OverR2", FSA_1OverR2, nr);
+            cache->Put("fsa/1OverR2_f", FSA_1OverR2_f, nr+1);
+            cache->Put("fsa/B", FSA_B, nr);
+            cache->Put("fsa/B_f", FSA_B_f, nr+1);
+            cache->Put("fsa/B2", FSA_B2, nr);
+            cache->Put("fsa/B2_f", FSA_B2_f, nr+1);
+            cache->Put("fsa/nablaR2OverR2", FSA_nablaR2OverR2, nr);
+            cache->Put("fsa/nablaR2OverR2_f", FSA_nablaR2OverR2_f, nr+1);
+            cache->Put("fsa/effectivePassingFraction", effectivePassingFraction, nr);
+        }
+    }
 
     InitializeFSAvg(effectivePassingFraction,effectivePassingFraction_f,
         FSA_B,FSA_B_f,FSA_B2,FSA_B2_f,FSA_1OverR2, FSA_1OverR2_f,FSA_nablaR2OverR2,FSA_nablaR2OverR2_f);
@@ -217,6 +255,41 @@ void RadialGrid::RebuildFluxSurfaceAveragedQuantities(){
     }
 }
 
+/**
+ * Helper method to store the flux surface averages of several
+ * functions, given as lists of exponents, which are all evaluated
+ * in the same pass over the flux surfaces.
+ *
+ * nF:                Number of quantities to evaluate.
+ * FSA_quantities:    On return, contains newly allocated arrays with
+ *                    the flux surface averages on the distribution grid.
+ * FSA_quantities_f:  On return, contains newly allocated arrays with
+ *                    the flux surface averages on the radial flux grid.
+ * Flists:            List of exponents representing each function.
+ */
+void RadialGrid::SetFluxSurfaceAverages(
+    const len_t nF, real_t **FSA_quantities[], real_t **FSA_quantities_f[],
+    const int_t *const* Flists
+){
+    for(len_t k=0; k<nF; k++){
+        *FSA_quantities[k]   = new real_t[GetNr()];
+        *FSA_quantities_f[k] = new real_t[GetNr()+1];
+    }
+
+    real_t *FSA = new real_t[nF];
+    for(len_t ir=0; ir<nr; ir++){
+        fluxSurfaceAverager->CalculateFluxSurfaceAverages(ir, FLUXGRIDTYPE_DISTRIBUTION, nF, Flists, FSA);
+        for(len_t k=0; k<nF; k++)
+            (*FSA_quantities[k])[ir] = FSA[k];
+    }
+    for(len_t ir=0; ir<=nr; ir++){
+        fluxSurfaceAverager->CalculateFluxSurfaceAverages(ir, FLUXGRIDTYPE_RADIAL, nF, Flists, FSA);
+        for(len_t k=0; k<nF; k++)
+            (*FSA_quantities_f[k])[ir] = FSA[k];
+    }
+    delete [] FSA;
+}
+
 /**
  * Helper method to store flux surface averages.
  */
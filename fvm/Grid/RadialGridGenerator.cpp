@@ -95,6 +95,42 @@ real_t RadialGridGenerator::BAtTheta_f(const len_t ir, const real_t theta) {
     return sqrt(Btor*Btor+Bpol*Bpol);
 }
 
+/**
+ * Evaluate the magnetic field strength B, the Jacobian, R/R0 and
+ * |nabla r|^2 at radial index ir on the distribution grid, in all
+ * of the given poloidal angles.
+ *
+ * ir:     Radial index.
+ * ntheta: Number of poloidal angles.
+ * theta:  Poloidal angles to evaluate quantities in.
+ * B, Jacobian, ROverR0, NablaR2:
+ *   On return, contain the quantities in each poloidal angle
+ *   (each array must contain 'ntheta' elements).
+ */
+void RadialGridGenerator::EvaluateGeometricQuantitiesOnTheta(
+    const len_t ir, const len_t ntheta, const real_t *theta,
+    real_t *B, real_t *Jacobian, real_t *ROverR0, real_t *NablaR2
+) {
+    for (len_t it = 0; it < ntheta; it++) {
+        B[it]        = BAtTheta(ir, theta[it]);
+        Jacobian[it] = JacobianAtTheta(ir, theta[it]);
+        ROverR0[it]  = ROverR0AtTheta(ir, theta[it]);
+        NablaR2[it]  = NablaR2AtTheta(ir, theta[it]);
+    }
+}
+// Same as EvaluateGeometricQuantitiesOnTheta, but on the radial flux grid
+void RadialGridGenerator::EvaluateGeometricQuantitiesOnTheta_fr(
+    const len_t ir, const len_t ntheta, const real_t *theta,
+    real_t *B, real_t *Jacobian, real_t *ROverR0, real_t *NablaR2
+) {
+    for (len_t it = 0; it < ntheta; it++) {
+        B[it]        = BAtTheta_f(ir, theta[it]);
+        Jacobian[it] = JacobianAtTheta_f(ir, theta[it]);
+        ROverR0[it]  = ROverR0AtTheta_f(ir, theta[it]);
+        NablaR2[it]  = NablaR2AtTheta_f(ir, theta[it]);
+    }
+}
+
 // The remaining functions are related to determining theta_Bmin and theta_Bmax
 // with a gsl fmin algorithm
 struct EvalBParams {len_t ir; RadialGridGenerator* rgg; int_t sgn;};
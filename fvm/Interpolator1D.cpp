@@ -37,6 +37,8 @@ Interpolator1D::Interpolator1D(
     const len_t nx, const len_t nblocks, const real_t *x, const real_t *y,
     enum interp_method meth
 ) : nx(nx), nblocks(nblocks), x(x), y(y), method(meth) {
+
+    this->lastIndex = &this->ownIndex;
     
     // Since the 'nearest' interpolation method returns an
     // exact copy of some of the data in 'y', we won't need
@@ -64,6 +66,17 @@ Interpolator1D::~Interpolator1D() {
         delete [] this->buffer;
 }
 
+/**
+ * Make this interpolator use the same cached interval index as
+ * the given interpolator. This is useful when several interpolators
+ * are defined on the same 'x' grid and evaluated in the same
+ * points, as only the first evaluation then needs to locate 'x'.
+ * The 'other' interpolator must outlive this object.
+ */
+void Interpolator1D::ShareIndex(Interpolator1D *other) {
+    this->lastIndex = other->lastIndex;
+}
+
 /**
  * Evaluate 'y' in the given 'x' point.
  *
@@ -73,7 +86,7 @@ Interpolator1D::~Interpolator1D() {
 const real_t *Interpolator1D::Eval(const real_t x) {
     switch (this->method) {
         case INTERP_NEAREST: return _eval_nearest(x);
-        case INTERP_LINEAR: return _eval_linear(x);
+        case INTERP_LINEAR: return _eval_linear(x, this->buffer);
 
         // We shouldn't end up here, so just return
         // 'nullptr' to make the compiler shut up
@@ -82,11 +95,49 @@ const real_t *Interpolator1D::Eval(const real_t x) {
     }
 }
 
+/**
+ * Evaluate 'y' in the given 'x' point, and store the
+ * result in 'out' (which must contain at least 'nblocks'
+ * elements).
+ */
+void Interpolator1D::Eval(const real_t x, real_t *out) {
+    if (this->method == INTERP_LINEAR)
+        _eval_linear(x, out);
+    else {
+        const real_t *v = _eval_nearest(x);
+        for (len_t i = 0; i < nblocks; i++)
+            out[i] = v[i];
+    }
+}
+
+/**
+ * Check if the interval with index 'ix' is the interval which
+ * the binary search in '_find_x()' would return for 'xv'.
+ */
+bool Interpolator1D::_in_interval(const real_t xv, const len_t ix) const {
+    if (ix+1 >= nx)
+        return (nx <= 1 && ix == 0);
+
+    if (xIncreasing)
+        return ((ix == 0 || x[ix] < xv) && (ix+2 == nx || x[ix+1] >= xv));
+    else
+        return ((ix == 0 || x[ix] >= xv) && (ix+2 == nx || x[ix+1] < xv));
+}
+
 /**
  * Locate the index of an 'x' that is before the given
  * value of 'x' in the x vector.
  */
 len_t Interpolator1D::_find_x(const real_t xv) {
+    // Same or next interval as in the previous evaluation?
+    const len_t last = *this->lastIndex;
+    if (_in_interval(xv, last))
+        return last;
+    else if (_in_interval(xv, last+1))
+        return (*this->lastIndex = last+1);
+    else if (last > 0 && _in_interval(xv, last-1))
+        return (*this->lastIndex = last-1);
+
     int a = 0;
     int b = nx-1;
 
@@ -101,13 +152,16 @@ len_t Interpolator1D::_find_x(const real_t xv) {
         }
     }
 
+    *this->lastIndex = a;
     return a;
 }
 
 /**
  * Linear interpolation.
+ *
+ * buffer: Array to store the result in.
  */
-const real_t *Interpolator1D::_eval_linear(const real_t xv) {
+const real_t *Interpolator1D::_eval_linear(const real_t xv, real_t *buffer) {
     len_t ix = _find_x(xv);
 
     if (ix+1 >= nx) {
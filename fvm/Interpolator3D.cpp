@@ -2,10 +2,12 @@
  * Implementation of a 3D interpolation class.
  */
 
+#include <algorithm>
 #include <cmath>
 #include <gsl/gsl_interp.h>
 #include "FVM/FVMException.hpp"
 #include "FVM/Interpolator3D.hpp"
+#include "FVM/Parallel.hpp"
 
 
 using namespace DREAM::FVM;
@@ -66,57 +68,70 @@ const real_t *Interpolator3D::Eval(
     FVM::Grid *grid, enum momentumgrid_type type,
     enum fluxGridType fgt, real_t *out
 ) {
-    // XXX Here we assume that all momentum grids are the same
-    switch (fgt) {
-        case FLUXGRIDTYPE_DISTRIBUTION:
-            return this->Eval(
-                grid->GetNr(),
-                grid->GetMomentumGrid(0)->GetNp2(),
-                grid->GetMomentumGrid(0)->GetNp1(),
-                grid->GetRadialGrid()->GetR(),
-                grid->GetMomentumGrid(0)->GetP2(),
-                grid->GetMomentumGrid(0)->GetP1(),
-                type, out
-            );
+    const len_t nr = grid->GetNr() + (fgt==FLUXGRIDTYPE_RADIAL);
+    const real_t *r = _radial_points(grid, fgt);
 
-        case FLUXGRIDTYPE_RADIAL:
-            return this->Eval(
-                grid->GetNr()+1,
-                grid->GetMomentumGrid(0)->GetNp2(),
-                grid->GetMomentumGrid(0)->GetNp1(),
-                grid->GetRadialGrid()->GetR_f(),
-                grid->GetMomentumGrid(0)->GetP2(),
-                grid->GetMomentumGrid(0)->GetP1(),
-                type, out
-            );
+    if (out == nullptr)
+        out = new real_t[_n_points(grid, fgt)];
 
-        case FLUXGRIDTYPE_P2:
-            return this->Eval(
-                grid->GetNr(),
-                grid->GetMomentumGrid(0)->GetNp2()+1,
-                grid->GetMomentumGrid(0)->GetNp1(),
-                grid->GetRadialGrid()->GetR(),
-                grid->GetMomentumGrid(0)->GetP2_f(),
-                grid->GetMomentumGrid(0)->GetP1(),
-                type, out
-            );
+    // Evaluate on the momentum grid of each radius separately
+    // (since different radii may use different momentum grids)
+    for (len_t ir = 0, offset = 0; ir < nr; ir++) {
+        const real_t *p1, *p2;
+        const len_t np1 = grid->GetNp1(ir, fgt), np2 = grid->GetNp2(ir, fgt);
+        _momentum_points(grid->GetMomentumGrid(ir, fgt), fgt, p1, p2);
+
+        this->Eval(1, np2, np1, r+ir, p2, p1, type, out+offset);
+        offset += np1*np2;
+    }
+
+    return out;
+}
 
+/**
+ * Returns the radial points of the given flux grid
+ * of 'grid'.
+ */
+const real_t *Interpolator3D::_radial_points(FVM::Grid *grid, enum fluxGridType fgt) {
+    switch (fgt) {
+        case FLUXGRIDTYPE_DISTRIBUTION:
         case FLUXGRIDTYPE_P1:
-            return this->Eval(
-                grid->GetNr(),
-                grid->GetMomentumGrid(0)->GetNp2(),
-                grid->GetMomentumGrid(0)->GetNp1()+1,
-                grid->GetRadialGrid()->GetR(),
-                grid->GetMomentumGrid(0)->GetP2(),
-                grid->GetMomentumGrid(0)->GetP1_f(),
-                type, out
-            );
+        case FLUXGRIDTYPE_P2:
+            return grid->GetRadialGrid()->GetR();
+        case FLUXGRIDTYPE_RADIAL:
+            return grid->GetRadialGrid()->GetR_f();
 
         default:
             throw FVMException("Unrecognized flux grid type specified: %d.", fgt);
     }
 }
 
+/**
+ * Returns the momentum coordinates 'p1' and 'p2' of the given
+ * flux grid of the momentum grid 'mg'.
+ */
+void Interpolator3D::_momentum_points(
+    const MomentumGrid *mg, enum fluxGridType fgt,
+    const real_t *&p1, const real_t *&p2
+) {
+    p1 = (fgt==FLUXGRIDTYPE_P1 ? mg->GetP1_f() : mg->GetP1());
+    p2 = (fgt==FLUXGRIDTYPE_P2 ? mg->GetP2_f() : mg->GetP2());
+}
+
+/**
+ * Returns the total number of points of the given flux
+ * grid of 'grid'.
+ */
+len_t Interpolator3D::_n_points(FVM::Grid *grid, enum fluxGridType fgt) {
+    const len_t nr = grid->GetNr() + (fgt==FLUXGRIDTYPE_RADIAL);
+
+    len_t n = 0;
+    for (len_t ir = 0; ir < nr; ir++)
+        n += grid->GetNp1(ir, fgt) * grid->GetNp2(ir, fgt);
+
+    return n;
+}
+
 /**
  * Evaluate the data of this object on the
  * given computational grid.
@@ -140,42 +155,142 @@ const real_t *Interpolator3D::Eval(
 
     const enum interp_method meth = this->method;
 
-    #define EVAL(X1,X2,X3) \
-        for (len_t k = 0; k < nx1; k++) { \
-            for (len_t j = 0; j < nx2; j++) { \
-                for (len_t i = 0; i < nx3; i++) { \
-                    const len_t idx = (k*nx2 + j)*nx3 + i; \
-                    if (meth == INTERP_NEAREST) { \
-                        out[idx] = this->_eval_nearest((X1), (X2), (X3)); \
-                    } else { \
-                        out[idx] = this->_eval_linear((X1), (X2), (X3)); \
-                    } \
-                } \
-            } \
+    for (len_t k = 0; k < nx1; k++) {
+        for (len_t j = 0; j < nx2; j++) {
+            for (len_t i = 0; i < nx3; i++) {
+                const len_t idx = (k*nx2 + j)*nx3 + i;
+                real_t X1, X2, X3;
+                _target_point(type, x1[k], x2[j], x3[i], X1, X2, X3);
+
+                if (meth == INTERP_NEAREST)
+                    out[idx] = this->_eval_nearest(X1, X2, X3);
+                else
+                    out[idx] = this->_eval_linear(X1, X2, X3);
+            }
         }
+    }
+    
+    return out;
+}
 
+/**
+ * Convert the given target point, given in coordinates of
+ * the momentum grid type 'type', to the coordinates of the
+ * grid of this interpolator.
+ */
+void Interpolator3D::_target_point(
+    const enum momentumgrid_type type,
+    const real_t x1, const real_t x2, const real_t x3,
+    real_t &X1, real_t &X2, real_t &X3
+) const {
+    X1 = x1;
     if (type == this->gridtype) {
-        EVAL(x1[k], x2[j], x3[i]);
+        X2 = x2;
+        X3 = x3;
     } else if (type == GRID_PXI) {
-        const real_t *p  = x3;
-        const real_t *xi = x2;
-        #define PPAR (p[i]*xi[j])
-        #define PPERP (p[i]*sqrt(1-xi[j]*xi[j]))
-        EVAL(x1[k], PPERP, PPAR);
-        #undef PPERP
-        #undef PPAR
-    } else if (type == GRID_PPARPPERP) {
-        const real_t *ppar  = x3;
-        const real_t *pperp = x2;
-        #define P (sqrt(ppar[i]*ppar[i] + pperp[j]*pperp[j]))
-        #define XI (ppar[i]/P)
-        EVAL(x1[k], XI, P);
-        #undef XI
-        #undef P
+        const real_t p = x3, xi = x2;
+        X2 = p*sqrt(1-xi*xi);   // pperp
+        X3 = p*xi;              // ppar
+    } else {
+        const real_t ppar = x3, pperp = x2;
+        const real_t p = sqrt(ppar*ppar + pperp*pperp);
+        X2 = ppar/p;            // xi
+        X3 = p;
     }
+}
 
-    #undef EVAL
-    
+/**
+ * Precompute the interpolation stencil for the given
+ * computational grid (see 'Eval()' for the meaning of
+ * the arguments). The returned stencil should be deleted
+ * by the caller.
+ *
+ * The stencil only depends on the grid of this interpolator
+ * (and not on the data 'y'), so that it can also be applied
+ * to other data given on the same grid.
+ */
+Interpolator3D::Stencil *Interpolator3D::CreateStencil(
+    FVM::Grid *grid, enum momentumgrid_type type,
+    enum fluxGridType fgt
+) {
+    const len_t nr = grid->GetNr() + (fgt==FLUXGRIDTYPE_RADIAL);
+    const real_t *r = _radial_points(grid, fgt);
+
+    const len_t nw = (this->method == INTERP_NEAREST ? 1 : 8);
+    Stencil *st = new Stencil(_n_points(grid, fgt), nw);
+
+    for (len_t ir = 0, offset = 0; ir < nr; ir++) {
+        const real_t *p1, *p2;
+        const len_t np1 = grid->GetNp1(ir, fgt), np2 = grid->GetNp2(ir, fgt);
+        _momentum_points(grid->GetMomentumGrid(ir, fgt), fgt, p1, p2);
+
+        _fill_stencil(
+            1, np2, np1, r+ir, p2, p1, type,
+            st->GetIndices()+offset*nw, st->GetWeights()+offset*nw
+        );
+        offset += np1*np2;
+    }
+
+    return st;
+}
+
+/**
+ * Precompute the interpolation stencil for the given target
+ * grid (see 'Eval()' for the meaning of the arguments).
+ */
+Interpolator3D::Stencil *Interpolator3D::CreateStencil(
+    const len_t nx1, const len_t nx2, const len_t nx3,
+    const real_t *x1, const real_t *x2, const real_t *x3,
+    enum momentumgrid_type type
+) {
+    const len_t nw = (this->method == INTERP_NEAREST ? 1 : 8);
+    Stencil *st = new Stencil(nx1*nx2*nx3, nw);
+    _fill_stencil(nx1, nx2, nx3, x1, x2, x3, type, st->GetIndices(), st->GetWeights());
+
+    return st;
+}
+
+/**
+ * Set the interpolation stencil for the given target grid
+ * in the arrays 'index' and 'weight' (which must be large
+ * enough to hold the stencil of all target points).
+ */
+void Interpolator3D::_fill_stencil(
+    const len_t nx1, const len_t nx2, const len_t nx3,
+    const real_t *x1, const real_t *x2, const real_t *x3,
+    enum momentumgrid_type type, len_t *index, real_t *weight
+) {
+    const len_t nw = (this->method == INTERP_NEAREST ? 1 : 8);
+    for (len_t k = 0; k < nx1; k++) {
+        for (len_t j = 0; j < nx2; j++) {
+            for (len_t i = 0; i < nx3; i++) {
+                const len_t idx = ((k*nx2 + j)*nx3 + i) * nw;
+                real_t X1, X2, X3;
+                _target_point(type, x1[k], x2[j], x3[i], X1, X2, X3);
+
+                if (this->method == INTERP_NEAREST)
+                    this->_stencil_nearest(X1, X2, X3, index+idx, weight+idx);
+                else
+                    this->_stencil_linear(X1, X2, X3, index+idx, weight+idx);
+            }
+        }
+    }
+}
+
+/**
+ * Evaluate the data of this object in the target points
+ * of the given (precomputed) stencil.
+ *
+ * st:  Stencil to evaluate.
+ * out: Array to store interpolated data in. If 'nullptr',
+ *      new memory is allocated and must later be deleted by
+ *      the caller.
+ */
+const real_t *Interpolator3D::Eval(const Stencil *st, real_t *out) const {
+    if (out == nullptr)
+        out = new real_t[st->GetNPoints()];
+
+    st->Eval(this->y, out);
     return out;
 }
 
@@ -205,6 +320,79 @@ real_t Interpolator3D::_eval_nearest(
     return this->y[(ix1*nx2 + ix2)*nx3 + ix3];
 }
 
+/**
+ * Construct the stencil of a single point using the
+ * 'nearest' interpolation algorithm.
+ */
+void Interpolator3D::_stencil_nearest(
+    const real_t x1, const real_t x2, const real_t x3,
+    len_t *index, real_t *weight
+) {
+    len_t ix1 = _find_x1(x1);
+    len_t ix2 = _find_x2(x2);
+    len_t ix3 = _find_x3(x3);
+
+    #define CORRECT(arr) do { \
+        if ((i ## arr) +1 < (this->n ## arr)) {\
+            if (abs(this-> arr [(i ## arr)] - arr) > abs(this-> arr [(i ## arr)+1] - arr)) \
+                (i ## arr)++; \
+        }} while (false)
+
+    if (nx1 > 1) CORRECT(x1);
+    if (nx2 > 1) CORRECT(x2);
+    if (nx3 > 1) CORRECT(x3);
+
+    #undef CORRECT
+
+    index[0]  = (ix1*nx2 + ix2)*nx3 + ix3;
+    weight[0] = 1;
+}
+
+/**
+ * Construct the stencil of a single point using the
+ * 'linear' interpolation algorithm (i.e. the weights of the
+ * eight surrounding data points used by '_eval_linear()').
+ */
+void Interpolator3D::_stencil_linear(
+    const real_t x1, const real_t x2, const real_t x3,
+    len_t *index, real_t *weight
+) {
+    len_t ix10 = _find_x1(x1);
+    len_t ix20 = _find_x2(x2);
+    len_t ix30 = _find_x3(x3);
+
+    if (this->nx1 > 1 && ix10+1 == this->nx1) ix10--;
+    if (this->nx2 > 1 && ix20+1 == this->nx2) ix20--;
+    if (this->nx3 > 1 && ix30+1 == this->nx3) ix30--;
+
+    len_t ix11 = ix10 + 1;
+    len_t ix21 = ix20 + 1;
+    len_t ix31 = ix30 + 1;
+
+    // Check for single grid points
+    if (ix11 == this->nx1) ix11 = ix10;
+    if (ix21 == this->nx2) ix21 = ix20;
+    if (ix31 == this->nx3) ix31 = ix30;
+
+    real_t x1d=0, x2d=0, x3d=0;
+    if (this->x1 != nullptr)
+        if (ix10 != ix11) x1d = (x1-this->x1[ix10]) / (this->x1[ix11] - this->x1[ix10]);
+    if (this->x2 != nullptr)
+        if (ix20 != ix21) x2d = (x2-this->x2[ix20]) / (this->x2[ix21] - this->x2[ix20]);
+    if (this->x3 != nullptr)
+        if (ix30 != ix31) x3d = (x3-this->x3[ix30]) / (this->x3[ix31] - this->x3[ix30]);
+
+    const len_t  i1[2] = {ix10, ix11}, i2[2] = {ix20, ix21}, i3[2] = {ix30, ix31};
+    const real_t w1[2] = {1-x1d, x1d}, w2[2] = {1-x2d, x2d}, w3[2] = {1-x3d, x3d};
+
+    for (len_t a = 0, n = 0; a < 2; a++)
+        for (len_t b = 0; b < 2; b++)
+            for (len_t c = 0; c < 2; c++, n++) {
+                index[n]  = (i1[a]*nx2 + i2[b])*nx3 + i3[c];
+                weight[n] = w1[a]*w2[b]*w3[c];
+            }
+}
+
 /**
  * Evaluate a single point on the grid using the
  * 'linear' interpolation algorithm.
@@ -259,6 +447,59 @@ real_t Interpolator3D::_eval_linear(
     return (y0*(1 - x3d) + y1*x3d);
 }
 
+
+/**
+ * Constructor.
+ *
+ * nPoints:  Number of target points of the stencil.
+ * nWeights: Number of data points contributing to each target point.
+ */
+Interpolator3D::Stencil::Stencil(const len_t nPoints, const len_t nWeights)
+    : nPoints(nPoints), nWeights(nWeights) {
+
+    this->index  = new len_t[nPoints*nWeights];
+    this->weight = new real_t[nPoints*nWeights];
+}
+
+/**
+ * Destructor.
+ */
+Interpolator3D::Stencil::~Stencil() {
+    delete [] this->weight;
+    delete [] this->index;
+}
+
+/**
+ * Apply this stencil to the given data (given on the input grid
+ * of the interpolator which created this stencil).
+ *
+ * y:   Data to interpolate.
+ * out: Array to store the 'nPoints' interpolated values in.
+ */
+void Interpolator3D::Stencil::Eval(const real_t *y, real_t *out) const {
+    const len_t nw = this->nWeights;
+    const len_t *index = this->index;
+    const real_t *weight = this->weight;
+
+    // Points are evaluated in blocks, and only in parallel
+    // for large stencils (each point is very cheap)
+    const len_t BLOCK_SIZE = 4096;
+    const len_t n = this->nPoints;
+    const len_t nBlocks = (n + BLOCK_SIZE-1) / BLOCK_SIZE;
+    const len_t nThreads = (n > 10000 ? Parallel::GetNumberOfThreads() : 1);
+
+    Parallel::For(nBlocks, nThreads, [&](const len_t b) {
+        const len_t i1 = std::min(n, (b+1)*BLOCK_SIZE);
+        for (len_t i = b*BLOCK_SIZE; i < i1; i++) {
+            real_t v = 0;
+            for (len_t j = 0; j < nw; j++)
+                v += weight[i*nw + j] * y[index[i*nw + j]];
+
+            out[i] = v;
+        }
+    });
+}
+
 /**
  * Locate the index i that is such that
  *
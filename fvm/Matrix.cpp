@@ -5,22 +5,39 @@
  * 'EquationSystem' class.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <cstring>
 #include <iostream>
+#include <vector>
 #include <petscmat.h>
+#include "FVM/Device.hpp"
 #include "FVM/Matrix.hpp"
+#include "FVM/MemoryAccounting.hpp"
+#include "FVM/PETScBackend.hpp"
 
 
 using namespace std;
 using namespace DREAM::FVM;
 
+
+// Maximum length of the direct assembly trace, relative to
+// the number of non-zero elements of the matrix
+#define MATRIX_MAX_TRACE_FACTOR 8
+
 /**
  * Constructors.
  */
-Matrix::Matrix() {}
+Matrix::Matrix() {
+    MemoryAccounting::Register(this, "petsc/matrix", [this]() { return this->GetMemoryUsage(); });
+}
 Matrix::Matrix(const PetscInt m, const PetscInt n, Mat mat) {
     this->m = m;
     this->n = n;
     this->petsc_mat = mat;
+
+    MemoryAccounting::Register(this, "petsc/matrix", [this]() { return this->GetMemoryUsage(); });
 }
 
 /**
@@ -43,7 +60,11 @@ Matrix::Matrix(const PetscInt m, const PetscInt n, Mat mat) {
 Matrix::Matrix(
     const PetscInt m, const PetscInt n, const PetscInt nnz,
     const PetscInt *nnzl
-) { this->Construct(m, n, nnz, nnzl); }
+) {
+    this->Construct(m, n, nnz, nnzl);
+
+    MemoryAccounting::Register(this, "petsc/matrix", [this]() { return this->GetMemoryUsage(); });
+}
 
 void Matrix::Construct(
     const PetscInt m, const PetscInt n, const PetscInt nnz,
@@ -56,8 +77,9 @@ void Matrix::Construct(
 
     this->m = m;
     this->n = n;
+    this->csrValid = false;
 
-    if ((ierr=MatCreateSeqAIJ(PETSC_COMM_WORLD, m, n, nnz, nnzl, &this->petsc_mat)))
+    if ((ierr=PETScBackend::CreateMatrix(m, n, nnz, nnzl, &this->petsc_mat)))
         throw MatrixException("Failed to allocate memory for PETSc matrix. Error code: %d", ierr);
 
     // Ensure that the non-zero structure of the matrix is
@@ -85,6 +107,7 @@ void Matrix::Construct(
  * Destructor.
  */
 Matrix::~Matrix() {
+    MemoryAccounting::Unregister(this);
     this->Destroy();
 }
 
@@ -94,8 +117,14 @@ Matrix::~Matrix() {
  * and before the matrix is "used".
  */
 void Matrix::Assemble() {
+    this->EndDirectAssembly();
+
     MatAssemblyBegin(this->petsc_mat, MAT_FINAL_ASSEMBLY);
     MatAssemblyEnd(this->petsc_mat, MAT_FINAL_ASSEMBLY);
+    this->EndDeviceAssembly();
+
+    if (this->directAssembly)
+        this->UpdateCSRStructure();
 }
 
 /**
@@ -106,8 +135,292 @@ void Matrix::Assemble() {
  * (than element insertion) can be conducted.
  */
 void Matrix::PartialAssemble() {
+    this->EndDirectAssembly();
+
     MatAssemblyBegin(this->petsc_mat, MAT_FLUSH_ASSEMBLY);
     MatAssemblyEnd(this->petsc_mat, MAT_FLUSH_ASSEMBLY);
+    this->EndDeviceAssembly();
+}
+
+/**
+ * Enable or disable direct assembly of this matrix. With direct
+ * assembly, the non-zero structure (in compressed sparse row format)
+ * of the matrix is recorded after each call to 'Assemble()'. In the
+ * following assemblies, elements belonging to this structure are then
+ * written straight into the value array of the PETSc matrix, avoiding
+ * the overhead of one call to 'MatSetValues()' per element. Elements
+ * outside of the recorded structure are still inserted through PETSc
+ * (after which direct assembly is suspended until the next final
+ * assembly). Since values are added in the same order and to the same
+ * memory locations as with 'MatSetValues()', the resulting matrix is
+ * identical to that obtained without direct assembly.
+ *
+ * The locations of the elements set between two calls to 'Zero()' are
+ * furthermore recorded, so that a matrix which is rebuilt with the same
+ * stencils (as is normally the case) is assembled by only writing the
+ * values into the recorded locations.
+ *
+ * Direct assembly is only available for sequential AIJ matrices, and
+ * is silently ignored for other matrix types. For matrices stored on a
+ * GPU, the recorded structure is only used for device assembly (see
+ * 'BeginDeviceAssembly()').
+ */
+void Matrix::SetDirectAssembly(const bool v) {
+    this->EndDirectAssembly();
+    this->directAssembly = v;
+    this->csrValid = false;
+    this->csrTrace.clear();
+    this->csrTracePos = 0;
+}
+
+/**
+ * Prepare for writing elements directly into the value array
+ * of the PETSc matrix.
+ *
+ * RETURNS true if elements can be written directly into the
+ * array 'csrValues' (at the indices given by 'FindCSRIndex()').
+ */
+bool Matrix::BeginDirectAssembly() {
+    if (this->csrValues != nullptr)
+        return true;
+    else if (!this->csrValid || this->csrOnDevice)
+        return false;
+
+    // Verify that the non-zero structure has not been modified
+    // (e.g. by external calls to PETSc) since it was recorded
+    PetscObjectState state;
+    MatGetNonzeroState(this->petsc_mat, &state);
+    if (state != this->csrNonzeroState) {
+        this->csrValid = false;
+        return false;
+    }
+
+    MatSeqAIJGetArray(this->petsc_mat, &this->csrValues);
+    return true;
+}
+
+/**
+ * Hand the value array of the PETSc matrix back to PETSc. This
+ * must be done before any PETSc routine is applied to the matrix.
+ */
+void Matrix::EndDirectAssembly() {
+    if (this->csrValues == nullptr)
+        return;
+
+    MatSeqAIJRestoreArray(this->petsc_mat, &this->csrValues);
+    this->csrValues = nullptr;
+}
+
+/**
+ * Locate the given element in the recorded non-zero structure.
+ *
+ * irow: Global row index of element.
+ * icol: Global column index of element.
+ *
+ * RETURNS the index of the element in the value array of the
+ * matrix, or -1 if the element is not part of the structure.
+ */
+PetscInt Matrix::FindCSRIndex(const PetscInt irow, const PetscInt icol) const {
+    if (irow < 0 || irow >= this->m)
+        return -1;
+
+    const PetscInt *begin = this->csrCols.data() + this->csrRowPtr[irow];
+    const PetscInt *end   = this->csrCols.data() + this->csrRowPtr[irow+1];
+    const PetscInt *p = std::lower_bound(begin, end, icol);
+
+    if (p == end || *p != icol)
+        return -1;
+    else
+        return (p - this->csrCols.data());
+}
+
+/**
+ * Record the non-zero structure of the (assembled) matrix, if it
+ * has changed since it was last recorded.
+ */
+void Matrix::UpdateCSRStructure() {
+    PetscBool isSeqAIJ, isDevice = PETSC_FALSE;
+    PetscObjectTypeCompare((PetscObject)this->petsc_mat, MATSEQAIJ, &isSeqAIJ);
+    if (!isSeqAIJ && PETScBackend::IsGPU() && Device::IsEnabled())
+        PetscObjectTypeCompare((PetscObject)this->petsc_mat, PETScBackend::GetMatType(), &isDevice);
+
+    if (!isSeqAIJ && !isDevice) {
+        this->csrValid = false;
+        return;
+    }
+
+    PetscObjectState state;
+    MatGetNonzeroState(this->petsc_mat, &state);
+    if (this->csrValid && state == this->csrNonzeroState)
+        return;
+
+    PetscInt nrows;
+    const PetscInt *ia, *ja;
+    PetscBool done;
+    MatGetRowIJ(this->petsc_mat, 0, PETSC_FALSE, PETSC_FALSE, &nrows, &ia, &ja, &done);
+    if (!done || nrows != this->m) {
+        this->csrValid = false;
+        return;
+    }
+
+    this->csrRowPtr.assign(ia, ia+nrows+1);
+    this->csrCols.assign(ja, ja+ia[nrows]);
+    MatRestoreRowIJ(this->petsc_mat, 0, PETSC_FALSE, PETSC_FALSE, &nrows, &ia, &ja, &done);
+
+    this->csrNonzeroState = state;
+    this->csrValid = true;
+    this->csrOnDevice = isDevice;
+    this->csrRevision = ++Matrix::nextCSRRevision;
+
+    // Recorded locations refer to the old structure
+    this->csrTrace.clear();
+    this->csrTracePos = 0;
+}
+
+/**
+ * Prepare for adding elements to the matrix from a kernel running
+ * on the device (see 'FVM::Device'). The kernel should add the value
+ * of element (i, j) to the returned array, at the index given by
+ * 'GetCSRIndex(i, j)'. Several kernels may add to the array between
+ * two assemblies; the values are added to the matrix when the matrix
+ * is next (partially) assembled. Only elements within the non-zero
+ * structure recorded for direct assembly can be set in this way.
+ *
+ * RETURNS the device array to add values to, or 'nullptr' if device
+ * assembly is not available for this matrix (in which case the
+ * elements should be set with 'SetElement()' or 'SetRow()').
+ */
+PetscScalar *Matrix::BeginDeviceAssembly() {
+    if (!this->csrValid || !this->csrOnDevice || this->elementBuffer != nullptr)
+        return nullptr;
+
+    PetscObjectState state;
+    MatGetNonzeroState(this->petsc_mat, &state);
+    if (state != this->csrNonzeroState && !this->deviceValuesPending) {
+        this->csrValid = false;
+        return nullptr;
+    }
+
+    const len_t nnz = this->csrCols.size();
+    if (this->deviceValuesSize != nnz) {
+        if (this->deviceValuesPending)
+            return nullptr;
+
+        Device::FreeDevice(this->deviceValues);
+        this->deviceValues = Device::AllocateDevice<PetscScalar>(nnz);
+        this->deviceValuesSize = nnz;
+    }
+
+    this->deviceValuesPending = true;
+    return this->deviceValues;
+}
+
+/**
+ * Add the values set from the device since the last assembly to
+ * the PETSc matrix. This is done after 'MatAssemblyEnd()', so that
+ * the device values are added after all values set on the host.
+ */
+void Matrix::EndDeviceAssembly() {
+    if (!this->deviceValuesPending)
+        return;
+
+    this->deviceValuesPending = false;
+
+    PetscObjectState state;
+    MatGetNonzeroState(this->petsc_mat, &state);
+
+    if (state == this->csrNonzeroState) {
+        if (!this->cooValid || this->cooNonzeroState != state)
+            this->SetupCOO();
+
+        MatSetValuesCOO(this->petsc_mat, this->deviceValues, ADD_VALUES);
+    } else {
+        // Elements outside of the recorded structure were inserted on
+        // the host after the device values were set, so the values
+        // must be inserted element by element (using the structure
+        // for which they were set)
+        const len_t nnz = this->deviceValuesSize;
+        vector<PetscScalar> v(nnz);
+        Device::CopyToHost(v.data(), this->deviceValues, nnz);
+
+        for (PetscInt i = 0; i < this->m; i++) {
+            const PetscInt k0 = this->csrRowPtr[i];
+            const PetscInt n  = this->csrRowPtr[i+1] - k0;
+            MatSetValues(this->petsc_mat, 1, &i, n, this->csrCols.data()+k0, v.data()+k0, ADD_VALUES);
+        }
+
+        MatAssemblyBegin(this->petsc_mat, MAT_FINAL_ASSEMBLY);
+        MatAssemblyEnd(this->petsc_mat, MAT_FINAL_ASSEMBLY);
+    }
+
+    PetscScalar *v = this->deviceValues;
+    Device::For(this->deviceValuesSize, DREAM_DEVICE_LAMBDA (const len_t k) { v[k] = 0; });
+}
+
+/**
+ * Set the COO preallocation of the matrix, which is required by
+ * 'MatSetValuesCOO()', from the recorded non-zero structure. Since
+ * the structure is the same as that of the matrix, only the mapping
+ * of the COO values changes, but PETSc discards the values of the
+ * matrix, which are therefore saved and restored.
+ */
+void Matrix::SetupCOO() {
+    const PetscCount nnz = this->csrCols.size();
+    vector<PetscInt> cooRows(nnz);
+    for (PetscInt i = 0; i < this->m; i++)
+        for (PetscInt k = this->csrRowPtr[i]; k < this->csrRowPtr[i+1]; k++)
+            cooRows[k] = i;
+
+    vector<PetscInt> cooCols(this->csrCols);
+    vector<PetscScalar> values(nnz);
+    const PetscScalar *a;
+    MatSeqAIJGetArrayRead(this->petsc_mat, &a);
+    std::copy(a, a+nnz, values.data());
+    MatSeqAIJRestoreArrayRead(this->petsc_mat, &a);
+
+    MatSetPreallocationCOO(this->petsc_mat, nnz, cooRows.data(), cooCols.data());
+    MatSetValuesCOO(this->petsc_mat, values.data(), INSERT_VALUES);
+
+    // The structure is unchanged, but PETSc regards it as new
+    PetscObjectState state;
+    MatGetNonzeroState(this->petsc_mat, &state);
+    this->csrNonzeroState = state;
+    this->cooNonzeroState = state;
+    this->cooValid = true;
+}
+
+/**
+ * Locate the given element in the value array of the matrix during
+ * direct assembly. The element is first compared to the element set
+ * at the same point in the previous assembly (see 'csrTrace'), in
+ * which case its location is known without searching the non-zero
+ * structure. If the sequence of elements set deviates from that of
+ * the previous assembly, the remainder of the trace is re-recorded.
+ *
+ * irow: Global row index of element.
+ * icol: Global column index of element.
+ *
+ * RETURNS the index of the element in the value array of the
+ * matrix, or -1 if the element is not part of the structure.
+ */
+PetscInt Matrix::LocateDirect(const PetscInt irow, const PetscInt icol) {
+    if (this->csrTracePos < this->csrTrace.size()) {
+        const struct trace_element &e = this->csrTrace[this->csrTracePos];
+        if (e.i == irow && e.j == icol) {
+            this->csrTracePos++;
+            return e.idx;
+        }
+
+        this->csrTrace.resize(this->csrTracePos);
+    }
+
+    PetscInt idx = FindCSRIndex(irow, icol);
+    if (this->csrTrace.size() < MATRIX_MAX_TRACE_FACTOR*this->csrCols.size()) {
+        this->csrTrace.push_back({irow, icol, idx});
+        this->csrTracePos++;
+    }
+
+    return idx;
 }
 
 /**
@@ -123,6 +436,7 @@ bool Matrix::ContainsNaNOrInf(len_t *I, len_t *J) {
     const PetscScalar *vals;
     PetscInt ncols;
 
+    this->EndDirectAssembly();
     for (PetscInt i = 0; i < this->m; i++) {
         MatGetRow(this->petsc_mat, i, &ncols, &cols, &vals);
 
@@ -143,8 +457,32 @@ bool Matrix::ContainsNaNOrInf(len_t *I, len_t *J) {
  * Destroy this matrix.
  */
 void Matrix::Destroy() {
-    if (this->allocated)
+    if (this->allocated) {
+        this->EndDirectAssembly();
         MatDestroy(&this->petsc_mat);
+    }
+
+    this->DestroyWorkVectors();
+    this->csrValid = false;
+    this->cooValid = false;
+
+    Device::FreeDevice(this->deviceValues);
+    this->deviceValues = nullptr;
+    this->deviceValuesSize = 0;
+    this->deviceValuesPending = false;
+}
+
+/**
+ * Destroy the work vectors used for matrix-vector
+ * multiplications.
+ */
+void Matrix::DestroyWorkVectors() {
+    if (this->mulX != nullptr)
+        VecDestroy(&this->mulX);
+    if (this->mulY != nullptr)
+        VecDestroy(&this->mulY);
+
+    this->mulX = this->mulY = nullptr;
 }
 
 /**
@@ -159,6 +497,7 @@ void Matrix::Destroy() {
  * r: Right vector to transform with (may be 'nullptr').
  */
 void Matrix::DiagonalScale(Vec l, Vec r) {
+    this->EndDirectAssembly();
     MatDiagonalScale(this->petsc_mat, l, r);
 }
 
@@ -172,15 +511,48 @@ void Matrix::DiagonalScale(Vec l, Vec r) {
  * Both parameters contain the desired value on return.
  */
 void Matrix::GetOwnershipRange(PetscInt *ir, PetscInt *nr) {
+    this->EndDirectAssembly();
     MatGetOwnershipRange(this->petsc_mat, ir, nr);
     *nr = *nr - *ir;
 }
 
+/**
+ * Insert (add) the given list of buffered elements into the
+ * PETSc matrix. The elements are inserted in the order in which
+ * they appear in the list, so that the result is identical to
+ * that obtained when setting the elements directly.
+ *
+ * buf: List of elements to add to the matrix.
+ */
+void Matrix::InsertBufferedElements(const vector<struct buffered_element>& buf) {
+    len_t k = 0;
+    if (this->BeginDirectAssembly()) {
+        for (; k < buf.size(); k++) {
+            PetscInt idx = LocateDirect(buf[k].i, buf[k].j);
+            if (idx < 0)
+                break;
+
+            this->csrValues[idx] += buf[k].v;
+        }
+
+        // Element outside of the recorded non-zero
+        // structure; insert the rest through PETSc
+        if (k < buf.size()) {
+            this->EndDirectAssembly();
+            this->csrValid = false;
+        }
+    }
+
+    for (; k < buf.size(); k++)
+        MatSetValue(this->petsc_mat, buf[k].i, buf[k].j, buf[k].v, ADD_VALUES);
+}
+
 /**
  * Returns the matrix element with the given indices.
  */
 real_t Matrix::GetElement(const PetscInt i, const PetscInt j) {
     PetscScalar v;
+    this->EndDirectAssembly();
     MatGetValues(this->petsc_mat, 1, &i, 1, &j, &v);
 
     return v;
@@ -201,10 +573,29 @@ void Matrix::GetRow(const PetscInt i, PetscScalar *v) {
     delete [] idx;
 }
 void Matrix::GetRow(const PetscInt i, const PetscInt *j, PetscScalar *v) {
+    this->EndDirectAssembly();
     MatGetValues(this->petsc_mat, 1, &i, n, j, v);
 }
 
 
+/**
+ * Returns the non-zero pattern of the (assembled) matrix. On
+ * return, 'pattern[i]' contains the column indices of all
+ * elements stored in row 'i' (including explicit zeros).
+ */
+void Matrix::GetSparsityPattern(vector<vector<PetscInt>>& pattern) {
+    PetscInt ncols;
+    const PetscInt *cols;
+
+    this->EndDirectAssembly();
+    pattern.resize(this->m);
+    for (PetscInt i = 0; i < this->m; i++) {
+        MatGetRow(this->petsc_mat, i, &ncols, &cols, nullptr);
+        pattern[i].assign(cols, cols+ncols);
+        MatRestoreRow(this->petsc_mat, i, &ncols, &cols, nullptr);
+    }
+}
+
 /**
  * Returns the requested matrix column in the given vector.
  */
@@ -219,6 +610,7 @@ void Matrix::GetColumn(const PetscInt j, PetscScalar *v) {
     delete [] idx;
 }
 void Matrix::GetColumn(const PetscInt j, const PetscInt *i, PetscScalar *v) {
+    this->EndDirectAssembly();
     MatGetValues(this->petsc_mat,this->m, i, 1, &j, v);
 }
 
@@ -241,7 +633,8 @@ real_t *Matrix::GetRowMaxAbs() {
 void Matrix::GetRowMaxAbs(real_t *v) {
     Vec s;
 
-    VecCreateSeq(PETSC_COMM_WORLD, this->m, &s);
+    this->EndDirectAssembly();
+    MatCreateVecs(this->petsc_mat, nullptr, &s);
     VecAssemblyBegin(s);
     VecAssemblyEnd(s);
 
@@ -263,11 +656,165 @@ void Matrix::GetRowMaxAbs(real_t *v) {
  */
 len_t Matrix::GetNNZ() {
     MatInfo info;
+    this->EndDirectAssembly();
     MatGetInfo(this->petsc_mat, MAT_GLOBAL_MAX, &info);
 
     return info.nz_used;
 }
 
+/**
+ * Check whether the non-zero structure or any of the values of this
+ * (assembled) matrix differ from those recorded in the given snapshot,
+ * and record the current values in the snapshot if so. The values are
+ * compared exactly, so that a matrix reported as unchanged is
+ * bit-for-bit identical to the one in the snapshot. Only sequential
+ * AIJ matrices are compared; any other matrix is always reported as
+ * changed.
+ *
+ * snap: Snapshot of the matrix values (updated on return).
+ *
+ * RETURNS true if the matrix differs from the snapshot.
+ */
+bool Matrix::HasChangedSince(struct value_snapshot& snap) {
+    this->EndDirectAssembly();
+
+    PetscBool isSeqAIJ;
+    PetscObjectTypeCompare((PetscObject)this->petsc_mat, MATSEQAIJ, &isSeqAIJ);
+    if (!isSeqAIJ) {
+        snap.values.clear();
+        return true;
+    }
+
+    PetscObjectState state;
+    MatGetNonzeroState(this->petsc_mat, &state);
+
+    MatInfo info;
+    MatGetInfo(this->petsc_mat, MAT_LOCAL, &info);
+    const size_t nnz = (size_t)info.nz_used;
+
+    const PetscScalar *a;
+    MatSeqAIJGetArrayRead(this->petsc_mat, &a);
+
+    bool changed = (
+        state != snap.nonzeroState || nnz == 0 || snap.values.size() != nnz ||
+        memcmp(a, snap.values.data(), nnz*sizeof(PetscScalar)) != 0
+    );
+
+    if (changed) {
+        snap.nonzeroState = state;
+        snap.values.assign(a, a+nnz);
+    }
+
+    MatSeqAIJRestoreArrayRead(this->petsc_mat, &a);
+
+    return changed;
+}
+
+/**
+ * Record the values of this (assembled) matrix in the given snapshot,
+ * so that they can later be restored with 'RestoreValues()'. Only
+ * sequential AIJ matrices can be saved.
+ *
+ * snap: Snapshot to store the matrix values in.
+ *
+ * RETURNS true if the values were saved.
+ */
+bool Matrix::SaveValues(struct value_snapshot& snap) {
+    this->EndDirectAssembly();
+
+    PetscBool isSeqAIJ;
+    PetscObjectTypeCompare((PetscObject)this->petsc_mat, MATSEQAIJ, &isSeqAIJ);
+    if (!isSeqAIJ) {
+        snap.values.clear();
+        return false;
+    }
+
+    MatGetNonzeroState(this->petsc_mat, &snap.nonzeroState);
+
+    MatInfo info;
+    MatGetInfo(this->petsc_mat, MAT_LOCAL, &info);
+    const size_t nnz = (size_t)info.nz_used;
+
+    const PetscScalar *a;
+    MatSeqAIJGetArrayRead(this->petsc_mat, &a);
+    snap.values.assign(a, a+nnz);
+    MatSeqAIJRestoreArrayRead(this->petsc_mat, &a);
+
+    return true;
+}
+
+/**
+ * Overwrite the values of this (assembled) matrix with those recorded
+ * in the given snapshot (see 'SaveValues()'). The values can only be
+ * restored if the non-zero structure of the matrix is the same as when
+ * the snapshot was taken. As with 'Zero()', this marks the start of a
+ * new assembly sequence, and elements set afterwards are added to the
+ * restored values.
+ *
+ * snap: Snapshot of the matrix values.
+ *
+ * RETURNS true if the values were restored, and false if the matrix
+ * was left unchanged.
+ */
+bool Matrix::RestoreValues(const struct value_snapshot& snap) {
+    this->EndDirectAssembly();
+
+    if (snap.values.empty())
+        return false;
+
+    PetscBool isSeqAIJ;
+    PetscObjectTypeCompare((PetscObject)this->petsc_mat, MATSEQAIJ, &isSeqAIJ);
+    if (!isSeqAIJ)
+        return false;
+
+    PetscObjectState state;
+    MatGetNonzeroState(this->petsc_mat, &state);
+
+    MatInfo info;
+    MatGetInfo(this->petsc_mat, MAT_LOCAL, &info);
+    if (state != snap.nonzeroState || (size_t)info.nz_used != snap.values.size())
+        return false;
+
+    PetscScalar *a;
+    MatSeqAIJGetArray(this->petsc_mat, &a);
+    memcpy(a, snap.values.data(), snap.values.size()*sizeof(PetscScalar));
+    MatSeqAIJRestoreArray(this->petsc_mat, &a);
+
+    this->csrTracePos = 0;
+    this->nonFinite = false;
+
+    return true;
+}
+
+/**
+ * Returns the number of bytes used by this matrix (including
+ * the non-zero structure recorded for direct assembly).
+ */
+size_t Matrix::GetMemoryUsage() const {
+    if (!this->allocated || this->petsc_mat == nullptr)
+        return 0;
+
+    return GetMemoryUsage(this->petsc_mat)
+        + (this->csrRowPtr.capacity() + this->csrCols.capacity()) * sizeof(PetscInt)
+        + this->csrTrace.capacity() * sizeof(struct trace_element);
+}
+
+/**
+ * Returns an estimate of the number of bytes used by the given
+ * PETSc matrix, based on the number of allocated non-zeros (this
+ * is also valid for factored matrices, including those of the
+ * external factorization packages).
+ */
+size_t Matrix::GetMemoryUsage(Mat mat) {
+    MatInfo info;
+    PetscInt rows, cols;
+    if (MatGetInfo(mat, MAT_LOCAL, &info) || MatGetLocalSize(mat, &rows, &cols))
+        return 0;
+
+    return (size_t)info.nz_allocated * (sizeof(PetscScalar) + sizeof(PetscInt))
+        + (rows+1) * sizeof(PetscInt);
+}
+
 /**
  * Forms the matrix
  * 
@@ -278,6 +825,7 @@ len_t Matrix::GetNNZ() {
  */
 void Matrix::IMinusDtA(const PetscScalar dt) {
     PetscScalar DT = -dt;
+    this->EndDirectAssembly();
     MatScale(this->petsc_mat, DT);
     MatShift(this->petsc_mat, 1.0);
 }
@@ -300,34 +848,85 @@ real_t *Matrix::Multiply(const len_t n, const real_t *f) {
             this->n, n
         );
 
-    Vec f_v, Af_v;
-
-    VecCreateSeqWithArray(PETSC_COMM_WORLD, 1, n, f, &f_v);
-    VecCreateSeq(PETSC_COMM_WORLD, this->m, &Af_v);
-
-    VecAssemblyBegin(f_v);  VecAssemblyEnd(f_v);
-    VecAssemblyBegin(Af_v); VecAssemblyEnd(Af_v);
-
-    MatMult(this->petsc_mat, f_v, Af_v);
-
-    real_t *Af;
-    VecGetArray(Af_v, &Af);
-
     real_t *r = new real_t[this->m];
-    for (PetscInt i = 0; i < this->m; i++)
-        r[i] = Af[i];
-
-    VecDestroy(&Af_v);
-    VecDestroy(&f_v);
+    this->Multiply(f, r);
 
     return r;
 }
 
+/**
+ * Evaluate
+ *
+ *   y = alpha*A*x + beta*y,
+ *
+ * where 'A' is this matrix. The work vectors used are kept
+ * between calls, so that no memory is allocated after the
+ * first multiplication (and the same matrix may therefore not
+ * be used for multiplications on several threads at once).
+ *
+ * x:     Vector to multiply with (with as many elements as
+ *        this matrix has columns).
+ * y:     Vector to store the result in (with as many elements
+ *        as this matrix has rows). If 'beta == 0', 'y' is not
+ *        read and need not be initialized.
+ * alpha: Factor multiplying the matrix-vector product.
+ * beta:  Factor multiplying 'y' before the product is added.
+ */
+void Matrix::Multiply(const real_t *x, real_t *y, const real_t alpha, const real_t beta) {
+    this->EndDirectAssembly();
+
+    // (use vectors compatible with the matrix, which may live on a GPU)
+    if (this->mulX == nullptr)
+        MatCreateVecs(this->petsc_mat, &this->mulX, &this->mulY);
+
+    PetscScalar *xv;
+    VecGetArray(this->mulX, &xv);
+    for (PetscInt i = 0; i < this->n; i++)
+        xv[i] = x[i];
+    VecRestoreArray(this->mulX, &xv);
+
+    MatMult(this->petsc_mat, this->mulX, this->mulY);
+
+    const PetscScalar *Ax;
+    VecGetArrayRead(this->mulY, &Ax);
+    if (beta == 0) {
+        for (PetscInt i = 0; i < this->m; i++)
+            y[i] = alpha*Ax[i];
+    } else {
+        for (PetscInt i = 0; i < this->m; i++)
+            y[i] = alpha*Ax[i] + beta*y[i];
+    }
+    VecRestoreArrayRead(this->mulY, &Ax);
+}
+
+/**
+ * Evaluate
+ *
+ *   y_k = alpha*A*x_k + beta*y_k,
+ *
+ * for several vectors x_k, y_k (k = 0, 1, ..., nVectors-1),
+ * reusing the same work vectors for all multiplications.
+ *
+ * nVectors: Number of vectors to multiply.
+ * x:        List of vectors to multiply with.
+ * y:        List of vectors to store the results in.
+ * alpha:    Factor multiplying the matrix-vector products.
+ * beta:     Factor multiplying 'y_k' before the product is added.
+ */
+void Matrix::Multiply(
+    const len_t nVectors, const real_t *const* x, real_t *const* y,
+    const real_t alpha, const real_t beta
+) {
+    for (len_t k = 0; k < nVectors; k++)
+        this->Multiply(x[k], y[k], alpha, beta);
+}
+
 /**
  * Print basic information about the PETSc matrix.
  */
 void Matrix::PrintInfo() {
     MatInfo info;
+    this->EndDirectAssembly();
     MatGetInfo(this->petsc_mat, MAT_GLOBAL_MAX, &info);
 
     cout << ":: MATRIX INFORMATION" << endl;
@@ -355,7 +954,26 @@ void Matrix::ResetOffset() {
 }
 
 /**
- * Sets one element in the matrix.
+ * Returns true if any element has been given a non-finite value
+ * (NaN or Inf) since the matrix was last zeroed. In contrast to
+ * 'ContainsNaNOrInf()', this does not require the matrix to be
+ * assembled, since the values are checked as they are set.
+ *
+ * I: Global row of the first non-finite element (if present).
+ * J: Global column of the first non-finite element (if present).
+ */
+bool Matrix::HasNonFiniteElement(PetscInt *I, PetscInt *J) const {
+    if (this->nonFinite) {
+        if (I != nullptr) *I = this->nonFiniteRow;
+        if (J != nullptr) *J = this->nonFiniteCol;
+    }
+
+    return this->nonFinite;
+}
+
+/**
+ * Sets one element in the matrix (unless its row is excluded by
+ * the row mask, see 'SetRowMask()').
  *
  * irow:        Element row.
  * icol:        Element column.
@@ -366,8 +984,44 @@ void Matrix::SetElement(
     const PetscInt irow, const PetscInt icol,
     const PetscScalar v, InsertMode insert_mode
 ) {
-    if (v != 0)
-        MatSetValue(this->petsc_mat, this->rowOffset+irow, this->colOffset+icol, v, insert_mode);
+    if (this->IsRowMasked(this->rowOffset+irow))
+        return;
+
+    if (!std::isfinite(v))
+        this->RecordNonFinite(this->rowOffset+irow, this->colOffset+icol);
+
+    if (this->elementBuffer != nullptr) {
+        if (v == 0)
+            return;
+        else if (insert_mode != ADD_VALUES)
+            throw MatrixException("Only 'ADD_VALUES' is supported when buffering matrix elements.");
+
+        this->elementBuffer->push_back({this->rowOffset+irow, this->colOffset+icol, v});
+        return;
+    }
+    
+    if (this->BeginDirectAssembly()) {
+        // (zero elements are also located, so that the sequence
+        // of elements set does not depend on their values)
+        PetscInt idx = LocateDirect(this->rowOffset+irow, this->colOffset+icol);
+        if (v == 0)
+            return;
+        else if (idx >= 0) {
+            if (insert_mode == ADD_VALUES)
+                this->csrValues[idx] += v;
+            else
+                this->csrValues[idx] = v;
+
+            return;
+        }
+
+        // New non-zero: PETSc must (re)allocate memory for it
+        this->EndDirectAssembly();
+        this->csrValid = false;
+    } else if (v == 0)
+        return;
+
+    MatSetValue(this->petsc_mat, this->rowOffset+irow, this->colOffset+icol, v, insert_mode);
 }
 
 /**
@@ -380,13 +1034,56 @@ void Matrix::SetOffset(const PetscInt rOff, const PetscInt cOff) {
 }
 
 /**
- * Sets the values of one row of the matrix.
+ * Sets the values of one row of the matrix (unless the row is
+ * excluded by the row mask, see 'SetRowMask()').
  */
 void Matrix::SetRow(
 	PetscInt irow, const PetscInt ncol,
 	PetscInt *icol, const PetscScalar *v,
 	InsertMode insert_mode
 ) {
+    if (this->IsRowMasked(this->rowOffset+irow))
+        return;
+
+    for (PetscInt k = 0; k < ncol; k++)
+        if (!std::isfinite(v[k]))
+            this->RecordNonFinite(this->rowOffset+irow, this->colOffset+icol[k]);
+
+    if (this->elementBuffer != nullptr) {
+        if (insert_mode != ADD_VALUES)
+            throw MatrixException("Only 'ADD_VALUES' is supported when buffering matrix elements.");
+
+        for (PetscInt i = 0; i < ncol; i++)
+            this->elementBuffer->push_back({this->rowOffset+irow, this->colOffset+icol[i], v[i]});
+
+        return;
+    }
+
+    if (this->BeginDirectAssembly()) {
+        const PetscInt r = this->rowOffset+irow;
+
+        // Check that all elements are within the recorded
+        // non-zero structure before writing any of them
+        bool inStructure = true;
+        for (PetscInt k = 0; k < ncol && inStructure; k++)
+            inStructure = (FindCSRIndex(r, this->colOffset+icol[k]) >= 0);
+
+        if (inStructure) {
+            for (PetscInt k = 0; k < ncol; k++) {
+                PetscInt idx = FindCSRIndex(r, this->colOffset+icol[k]);
+                if (insert_mode == ADD_VALUES)
+                    this->csrValues[idx] += v[k];
+                else
+                    this->csrValues[idx] = v[k];
+            }
+
+            return;
+        }
+
+        this->EndDirectAssembly();
+        this->csrValid = false;
+    }
+
     // Apply offsets
     irow += this->rowOffset;
     for(PetscInt i=0; i<ncol; i++)
@@ -406,10 +1103,11 @@ void Matrix::SetRow(
 void Matrix::View(const enum view_format format, const string& filename) {
     PetscViewer viewer;
 
+    this->EndDirectAssembly();
     if (format == NON_ZERO_STRUCT)
         viewer = PETSC_VIEWER_DRAW_WORLD;
     else if (format == BINARY_MATLAB) {
-        PetscViewerBinaryOpen(PETSC_COMM_WORLD, filename.c_str(), FILE_MODE_WRITE, &viewer);
+        PetscViewerBinaryOpen(PETSC_COMM_SELF, filename.c_str(), FILE_MODE_WRITE, &viewer);
     } else {
         viewer = PETSC_VIEWER_STDOUT_SELF;
         
@@ -422,12 +1120,98 @@ void Matrix::View(const enum view_format format, const string& filename) {
         PetscViewerDestroy(&viewer);
 }
 
+/**
+ * Save the matrix to the named file in a raw binary CSR format, which
+ * can be memory-mapped when read (so that individual blocks of large
+ * matrices can be inspected without loading the full matrix). The file
+ * consists of (all integers are 64-bit and all data is stored in the
+ * byte order of the machine which wrote it)
+ *
+ *   char    magic[8]   = "DREAMCSR"
+ *   int64   version    = 1
+ *   int64   nrows, ncols, nnz
+ *   int64   nindex     (number of bytes in the index, a multiple of 8)
+ *   char    index[nindex]
+ *   int64   rowptr[nrows+1]
+ *   int64   colidx[nnz]
+ *   double  values[nnz]
+ *
+ * The index is an arbitrary string (e.g. JSON) describing the contents
+ * of the matrix, padded with spaces.
+ *
+ * filename: Name of file to write the matrix to.
+ * index:    Description of the matrix to store with it.
+ */
+void Matrix::SaveCSR(const string& filename, const string& index) {
+    this->EndDirectAssembly();
+
+    FILE *f = fopen(filename.c_str(), "wb");
+    if (f == nullptr)
+        throw MatrixException("Unable to open '%s' for writing.", filename.c_str());
+
+    const PetscInt *cols;
+    const PetscScalar *vals;
+    PetscInt ncols;
+
+    // Row pointers
+    vector<int64_t> rowptr(this->m+1, 0);
+    for (PetscInt i = 0; i < this->m; i++) {
+        MatGetRow(this->petsc_mat, i, &ncols, nullptr, nullptr);
+        rowptr[i+1] = rowptr[i] + ncols;
+        MatRestoreRow(this->petsc_mat, i, &ncols, nullptr, nullptr);
+    }
+
+    string idx = index;
+    idx.resize(((idx.size()+7)/8)*8, ' ');
+
+    const char magic[8] = {'D','R','E','A','M','C','S','R'};
+    const int64_t header[5] = {1, (int64_t)this->m, (int64_t)this->n, rowptr[this->m], (int64_t)idx.size()};
+
+    fwrite(magic, 1, sizeof(magic), f);
+    fwrite(header, sizeof(int64_t), 5, f);
+    fwrite(idx.data(), 1, idx.size(), f);
+    fwrite(rowptr.data(), sizeof(int64_t), rowptr.size(), f);
+
+    // Column indices, followed by the values (one row at a time)
+    vector<int64_t> c;
+    for (PetscInt i = 0; i < this->m; i++) {
+        MatGetRow(this->petsc_mat, i, &ncols, &cols, nullptr);
+        c.assign(cols, cols+ncols);
+        fwrite(c.data(), sizeof(int64_t), c.size(), f);
+        MatRestoreRow(this->petsc_mat, i, &ncols, &cols, nullptr);
+    }
+
+    vector<double> v;
+    for (PetscInt i = 0; i < this->m; i++) {
+        MatGetRow(this->petsc_mat, i, &ncols, nullptr, &vals);
+        v.assign(vals, vals+ncols);
+        fwrite(v.data(), sizeof(double), v.size(), f);
+        MatRestoreRow(this->petsc_mat, i, &ncols, nullptr, &vals);
+    }
+
+    const bool failed = (ferror(f) != 0);
+    if (fclose(f) != 0 || failed)
+        throw MatrixException("Failed to write matrix to '%s'.", filename.c_str());
+}
+
 /**
  * Zero the non-zero entries. This routine
  * retains the non-zero structure of the matrix, though,
  * and should be called before rebuilding the matrix.
+ * With direct assembly, this also marks the start of
+ * a new assembly sequence (see 'LocateDirect()').
  */
 void Matrix::Zero(bool keepNzStructure) {
+    this->EndDirectAssembly();
+    this->csrTracePos = 0;
+    this->nonFinite = false;
+
+    // Discard values set from the device since the last assembly
+    if (this->deviceValuesPending) {
+        PetscScalar *v = this->deviceValues;
+        Device::For(this->deviceValuesSize, DREAM_DEVICE_LAMBDA (const len_t k) { v[k] = 0; });
+        this->deviceValuesPending = false;
+    }
     if(!keepNzStructure)
         MatSetOption(this->petsc_mat, MAT_KEEP_NONZERO_PATTERN, PETSC_FALSE);
     else
@@ -445,6 +1229,7 @@ void Matrix::Zero(bool keepNzStructure) {
  * i: Indices of rows to zero.
  */
 void Matrix::ZeroRows(const PetscInt n, const PetscInt i[]) {
+    this->EndDirectAssembly();
 	MatZeroRows(this->petsc_mat, n, i, 0.0, nullptr, nullptr);
 }
 
@@ -456,6 +1241,86 @@ void Matrix::ZeroRows(const PetscInt n, const PetscInt i[]) {
  * v: The constant value that the diagonal will take 
  */
 void Matrix::SetDiagonalConstant(const PetscInt n, const PetscInt i[], const PetscReal v) {
+    if (this->elementBuffer != nullptr)
+        throw MatrixException("Matrix elements cannot be inserted when buffering matrix elements.");
+
+    this->EndDirectAssembly();
     for(PetscInt it=0; it<n; it++)
         MatSetValue(this->petsc_mat, this->rowOffset+i[it], this->colOffset+i[it], v, INSERT_VALUES);
 }
+
+
+/**
+ * FACTORIZATION ORDERING
+ *
+ * The order of the rows and columns in which a matrix is factorized
+ * can be given explicitly for each matrix, using 'SetFactorOrdering()'.
+ * The permutation is attached to the PETSc matrix and is picked up by
+ * the PETSc matrix ordering named 'FACTOR_ORDERING' when the matrix is
+ * factorized, so that the layout of the matrix (and of all vectors)
+ * seen by the equation terms remains unchanged.
+ */
+const char *Matrix::FACTOR_ORDERING = "dream";
+static const char *FACTOR_ORDERING_KEY = "DREAM_FactorOrdering";
+
+/**
+ * PETSc matrix ordering function returning the permutation
+ * attached to the matrix (or the nested dissection ordering,
+ * which PETSc uses by default for LU factorizations, if no
+ * permutation has been attached).
+ */
+static PetscErrorCode Matrix_GetFactorOrdering(Mat mat, MatOrderingType, IS *row, IS *col) {
+    PetscObject perm = nullptr;
+    PetscObjectQuery((PetscObject)mat, FACTOR_ORDERING_KEY, &perm);
+
+    if (perm == nullptr)
+        return MatGetOrdering(mat, MATORDERINGND, row, col);
+
+    ISDuplicate((IS)perm, row);
+    ISDuplicate((IS)perm, col);
+    ISSetPermutation(*row);
+    ISSetPermutation(*col);
+
+    return 0;
+}
+
+/**
+ * Register the matrix ordering 'FACTOR_ORDERING' with PETSc.
+ * Must be called (after PETSc has been initialized) before the
+ * ordering is selected for a factorization.
+ */
+void Matrix::RegisterFactorOrdering() {
+    static bool registered = false;
+    if (registered)
+        return;
+
+    MatOrderingRegister(FACTOR_ORDERING, &Matrix_GetFactorOrdering);
+    registered = true;
+}
+
+/**
+ * Set the order in which the rows (and columns) of this matrix
+ * are eliminated when the matrix is factorized with the ordering
+ * 'FACTOR_ORDERING'. Element 'i' of the permutation is the index
+ * of the row (column) which is placed in position 'i'. Since the
+ * permutation is attached to the PETSc matrix, it must be set
+ * again whenever the matrix is reconstructed.
+ *
+ * perm: Permutation of the rows of the matrix.
+ */
+void Matrix::SetFactorOrdering(const vector<PetscInt>& perm) {
+    if ((PetscInt)perm.size() != this->m)
+        throw MatrixException(
+            "The factorization ordering has %zu elements, but the matrix has "
+            "%lld rows.", perm.size(), (long long)this->m
+        );
+
+    RegisterFactorOrdering();
+
+    IS is;
+    ISCreateGeneral(PETSC_COMM_SELF, this->m, perm.data(), PETSC_COPY_VALUES, &is);
+    ISSetPermutation(is);
+    // (the matrix keeps its own reference to the index set)
+    PetscObjectCompose((PetscObject)this->petsc_mat, FACTOR_ORDERING_KEY, (PetscObject)is);
+    ISDestroy(&is);
+}
@@ -4,12 +4,107 @@
 
 #include <iostream>
 #include "FVM/MatrixInverter.hpp"
+#include "FVM/MemoryAccounting.hpp"
 
 
 using namespace DREAM::FVM;
 using namespace std;
 
 
+/**
+ * Constructor.
+ */
+MatrixInverter::MatrixInverter() {
+    MemoryAccounting::Register(this, "petsc/factorization", [this]() { return this->GetMemoryUsage(); });
+}
+
+/**
+ * Destructor.
+ */
+MatrixInverter::~MatrixInverter() {
+    MemoryAccounting::Unregister(this);
+}
+
+/**
+ * Returns the factorized matrix computed in the most recent call to
+ * 'Invert()', or 'nullptr' if the inverter does not factorize the
+ * matrix, or no matrix has been factorized yet.
+ */
+Mat MatrixInverter::GetFactorMatrix() const {
+    PC pc;
+    Mat F = nullptr;
+    PetscBool isFactor = PETSC_FALSE;
+
+    if (this->ksp == nullptr || KSPGetPC(this->ksp, &pc))
+        return nullptr;
+
+    PetscObjectTypeCompareAny((PetscObject)pc, &isFactor, PCLU, PCILU, PCCHOLESKY, PCICC, "");
+    if (!isFactor)
+        return nullptr;
+
+    // (PETSc raises an error if the matrix has not been factorized yet)
+    PetscPushErrorHandler(PetscIgnoreErrorHandler, nullptr);
+    PetscErrorCode ierr = PCFactorGetMatrix(pc, &F);
+    PetscPopErrorHandler();
+
+    if (ierr)
+        return nullptr;
+
+    return F;
+}
+
+/**
+ * Returns the number of bytes used by the factorization computed
+ * in the most recent call to 'Invert()' (or 0 if the inverter does
+ * not factorize the matrix, or no matrix has been factorized yet).
+ */
+size_t MatrixInverter::GetMemoryUsage() const {
+    Mat F = this->GetFactorMatrix();
+    if (F == nullptr)
+        return 0;
+
+    return Matrix::GetMemoryUsage(F);
+}
+
+/**
+ * Returns the fill of the most recent factorization, i.e. the ratio
+ * of the number of non-zeros in the factors to the number of non-zeros
+ * in the factorized matrix (or 0 if no factorization is available).
+ */
+real_t MatrixInverter::GetFactorizationFill() const {
+    PC pc;
+    Mat A, P;
+    MatInfo infoA, infoF;
+
+    Mat F = this->GetFactorMatrix();
+    if (F == nullptr)
+        return 0;
+
+    KSPGetPC(this->ksp, &pc);
+    PCGetOperators(pc, &A, &P);
+    MatGetInfo(P, MAT_LOCAL, &infoA);
+    MatGetInfo(F, MAT_LOCAL, &infoF);
+
+    if (infoA.nz_used <= 0)
+        return 0;
+
+    return infoF.nz_used / infoA.nz_used;
+}
+
+/**
+ * Returns the number of iterations taken by the linear solver in
+ * the most recent call to 'Invert()' (1 for direct solvers).
+ */
+len_t MatrixInverter::GetIterationNumber() const {
+    PetscInt its = 0;
+
+    if (this->ksp == nullptr || KSPGetIterationNumber(this->ksp, &its))
+        return 0;
+
+    return (len_t)its;
+}
+
+
 /**
  * Print info about the most recently factored matrix.
  */
@@ -37,3 +132,13 @@ void MatrixInverter::PrintInfo() {
     cout << "   # mallocs during fact.: " << info.factor_mallocs << endl;
 }
 
+/**
+ * Specify whether or not to reuse the factorization (or, for
+ * iterative solvers, the preconditioner) from the previous
+ * call to 'Invert()'. When enabled, the matrix passed to
+ * 'Invert()' is not refactorized, even if it has been modified.
+ */
+void MatrixInverter::SetReuseFactorization(const bool v) {
+    this->reuseFactorization = v;
+    KSPSetReusePreconditioner(this->ksp, v ? PETSC_TRUE : PETSC_FALSE);
+}
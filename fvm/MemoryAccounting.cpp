@@ -0,0 +1,209 @@
+/**
+ * The MemoryAccounting registry keeps track of the memory used by the
+ * large containers of a simulation (quantity data, bounce surface data,
+ * interpolation coefficients, PETSc matrices and factorizations). Each
+ * container registers itself, together with a function returning the
+ * number of bytes it currently occupies, under a category name, e.g.
+ *
+ *   MemoryAccounting::Register(this, "quantitydata/data", [this]() {
+ *       return this->nElements*sizeof(real_t);
+ *   });
+ *
+ * and unregisters in its destructor. Since the usage is only evaluated
+ * when the registry is sampled, registration costs nothing during the
+ * simulation. The peak usage of each category is the largest usage seen
+ * in any sample (the registry is sampled after every time step when
+ * memory accounting is enabled).
+ */
+
+#include <cstdio>
+#include <sys/resource.h>
+#include <unistd.h>
+#include <vector>
+#include "FVM/MemoryAccounting.hpp"
+
+
+using namespace DREAM::FVM;
+using namespace std;
+
+
+/**
+ * Enable or disable sampling of the memory usage and clear
+ * all previously recorded peaks.
+ *
+ * enable: If true, enables memory accounting.
+ */
+void MemoryAccounting::Configure(const bool enable) {
+    lock_guard<mutex> lock(mtx);
+
+    MemoryAccounting::enabled = enable;
+    MemoryAccounting::peak.clear();
+}
+
+/**
+ * Register an object which reports its memory usage.
+ *
+ * owner:    Object to register (used as key when unregistering).
+ * category: Name of the category to assign the memory to.
+ * usage:    Function returning the number of bytes currently used.
+ */
+void MemoryAccounting::Register(
+    const void *owner, const string& category, function<size_t()> usage
+) {
+    lock_guard<mutex> lock(mtx);
+    sources.insert({owner, {category, usage}});
+}
+
+/**
+ * Remove all registrations made by the given object.
+ *
+ * owner: Object to unregister.
+ */
+void MemoryAccounting::Unregister(const void *owner) {
+    lock_guard<mutex> lock(mtx);
+    sources.erase(owner);
+}
+
+/**
+ * Evaluate the memory currently used in each category,
+ * and update the peak usage of the categories.
+ *
+ * RETURNS a map from category name to number of bytes used.
+ */
+map<string, size_t> MemoryAccounting::Sample() {
+    lock_guard<mutex> lock(mtx);
+
+    map<string, size_t> usage;
+    for (auto it = sources.begin(); it != sources.end(); it++)
+        usage[it->second.category] += it->second.usage();
+
+    for (auto it = usage.begin(); it != usage.end(); it++) {
+        if (it->second > peak[it->first])
+            peak[it->first] = it->second;
+    }
+
+    return usage;
+}
+
+/**
+ * Returns the resident set size of the process (in bytes),
+ * or 0 if it cannot be determined on this system.
+ */
+size_t MemoryAccounting::GetResidentMemory() {
+    size_t rss = 0;
+#if defined(__linux__)
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (f != nullptr) {
+        unsigned long long size, resident;
+        if (fscanf(f, "%llu %llu", &size, &resident) == 2)
+            rss = resident * sysconf(_SC_PAGESIZE);
+        fclose(f);
+    }
+#endif
+    return rss;
+}
+
+/**
+ * Returns the peak resident set size of the process (in bytes).
+ */
+size_t MemoryAccounting::GetPeakResidentMemory() {
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) != 0)
+        return 0;
+
+#if defined(__APPLE__)
+    return ru.ru_maxrss;
+#else
+    // Given in kilobytes
+    return ru.ru_maxrss * 1024;
+#endif
+}
+
+/**
+ * Format the given number of bytes as a string with a
+ * suitable unit.
+ */
+string MemoryAccounting::FormatBytes(const real_t bytes) {
+    const char *units[] = {"B", "kiB", "MiB", "GiB", "TiB"};
+    real_t v = bytes;
+    len_t i = 0;
+    while (v >= 1024 && i < 4) {
+        v /= 1024;
+        i++;
+    }
+
+    char buffer[32];
+    snprintf(buffer, sizeof(buffer), "%.1f %s", v, units[i]);
+    return string(buffer);
+}
+
+/**
+ * Print the current and peak memory usage of every category,
+ * together with the resident memory of the process.
+ *
+ * title: Title of the table.
+ */
+void MemoryAccounting::PrintSummary(const string& title) {
+    map<string, size_t> usage = Sample();
+
+    int maxlen = 24;
+    for (auto it = usage.begin(); it != usage.end(); it++)
+        maxlen = max(static_cast<int>(it->first.length()), maxlen);
+
+    printf("[Memory usage %s]\n", title.c_str());
+    printf("  %-*s  %12s  %12s\n", maxlen, "Category", "current", "peak");
+
+    size_t total = 0, totalPeak = 0;
+    for (auto it = usage.begin(); it != usage.end(); it++) {
+        const size_t p = peak[it->first];
+        printf("  %-*s  %12s  %12s\n", maxlen, it->first.c_str(),
+            FormatBytes(it->second).c_str(), FormatBytes(p).c_str());
+
+        total += it->second;
+        totalPeak += p;
+    }
+
+    printf("  %-*s  %12s  %12s\n", maxlen, "Total (accounted)",
+        FormatBytes(total).c_str(), FormatBytes(totalPeak).c_str());
+    printf("  %-*s  %12s  %12s\n", maxlen, "Resident (process)",
+        FormatBytes(GetResidentMemory()).c_str(), FormatBytes(GetPeakResidentMemory()).c_str());
+}
+
+/**
+ * Save the current and peak memory usage of every category
+ * to the given SFile object. The category names are stored as
+ * a ';'-separated list, and the memory usage in bytes.
+ *
+ * sf:   SFile object to save memory usage to.
+ * path: Path in SFile object to save memory usage to.
+ */
+void MemoryAccounting::SaveSummary(SFile *sf, const string& path) {
+    map<string, size_t> usage = Sample();
+
+    const len_t n = usage.size();
+    string names;
+    real_t *current = new real_t[n];
+    real_t *peaks   = new real_t[n];
+
+    len_t i = 0;
+    for (auto it = usage.begin(); it != usage.end(); it++, i++) {
+        names += it->first + ";";
+        current[i] = it->second;
+        peaks[i] = peak[it->first];
+    }
+
+    sf->CreateStruct(path);
+    sf->WriteString(path+"/names", names);
+    sf->WriteList(path+"/current", current, n);
+    sf->WriteList(path+"/peak", peaks, n);
+    sf->WriteScalar(path+"/resident", (real_t)GetResidentMemory());
+    sf->WriteScalar(path+"/peakresident", (real_t)GetPeakResidentMemory());
+
+    sf->WriteAttribute_string(path+"/current", "desc", "Memory used at the end of the simulation (bytes)");
+    sf->WriteAttribute_string(path+"/peak", "desc", "Largest memory usage observed during the simulation (bytes)");
+    sf->WriteAttribute_string(path+"/resident", "desc", "Resident memory of the process at the end of the simulation (bytes)");
+    sf->WriteAttribute_string(path+"/peakresident", "desc", "Peak resident memory of the process (bytes)");
+
+    delete [] peaks;
+    delete [] current;
+}
@@ -3,14 +3,72 @@
  * system of equations. The vectors only contain data for
  * the non-trivial unknown quantities, and norms should be
  * reported for each non-trivial unknown separately.
+ *
+ * All norms are evaluated by the same kernel, which computes the
+ * norms of a solution vector and of a step (or of the difference
+ * between two solution vectors), and optionally the weighted RMS
+ * norm of the step, in a single (vectorized) pass over the vectors.
+ * Large unknowns are summed in blocks by 'Parallel::Sum()', which
+ * makes the norms (and hence the convergence of the solvers)
+ * independent of the number of threads.
  */
 
+#include <cmath>
 #include <vector>
 #include "FVM/NormEvaluator.hpp"
+#include "FVM/Parallel.hpp"
 
 using namespace std;
 using namespace DREAM::FVM;
 
+
+namespace {
+    /**
+     * Sums of squares evaluated by 'norm_block()'.
+     */
+    struct norm_sums {
+        real_t sx=0, sd=0, sw=0;
+
+        norm_sums operator+(const norm_sums &o) const
+        { return norm_sums{sx+o.sx, sd+o.sd, sw+o.sw}; }
+    };
+
+    /**
+     * Evaluate the sums of squares of one block (unknown quantity) of
+     * the solution 'x' (if SOL), of the step 'd', where d = v1-v2 (if
+     * DIFF) or d = v1, and (if WEIGHTED) of d/(atol + rtol*|x|).
+     */
+    template<bool SOL, bool DIFF, bool WEIGHTED>
+    void norm_block(
+        const len_t N, const real_t *x, const real_t *v1, const real_t *v2,
+        const real_t atol, const real_t rtol,
+        norm_sums &s
+    ) {
+        real_t a = 0, b = 0, c = 0;
+
+        #pragma omp simd reduction(+:a,b,c)
+        for (len_t j = 0; j < N; j++) {
+            const real_t d = (DIFF ? v1[j]-v2[j] : v1[j]);
+            b += d*d;
+
+            if (SOL)
+                a += x[j]*x[j];
+            if (WEIGHTED) {
+                const real_t e = d / (atol + rtol*fabs(x[j]));
+                c += e*e;
+            }
+        }
+
+        s = norm_sums{a, b, c};
+    }
+
+    typedef void (*norm_block_t)(
+        const len_t, const real_t*, const real_t*, const real_t*,
+        const real_t, const real_t, norm_sums&
+    );
+}
+
+
 /**
  * Constructor.
  */
@@ -35,21 +93,8 @@ const real_t *NormEvaluator::Norm2(const real_t *vec) {
     this->Norm2(vec, this->retvec);
     return this->retvec;
 }
-void NormEvaluator:: Norm2(const real_t *vec, real_t *rvec) {
-    len_t offset = 0, i = 0;
-    for (auto id : this->nontrivials) {
-        FVM::UnknownQuantity *uqn = this->unknowns->GetUnknown(id);
-        const len_t N = uqn->NumberOfElements();
-
-        rvec[i] = 0;
-        for (len_t j = 0; j < N; j++)
-            rvec[i] += vec[offset+j]*vec[offset+j];
-
-        rvec[i] = sqrt(rvec[i]);
-
-        offset += N;
-        i++;
-    }
+void NormEvaluator::Norm2(const real_t *vec, real_t *rvec) {
+    this->Norms(nullptr, vec, nullptr, nullptr, rvec);
 }
 
 /**
@@ -63,21 +108,77 @@ const real_t *NormEvaluator::Norm2Diff(const real_t *vec1, const real_t *vec2) {
     return this->retvec;
 }
 void NormEvaluator::Norm2Diff(const real_t *vec1, const real_t *vec2, real_t *rvec) {
+    this->Norms(nullptr, vec1, vec2, nullptr, rvec);
+}
+
+/**
+ * Evaluate, in a single pass over the vectors, the 2-norms of a
+ * solution vector 'x' and of a step 'dx' for each non-trivial unknown.
+ * The step is either given directly (as 'v1', with 'v2 = nullptr') or
+ * as the difference 'v1-v2' of two solution vectors. If 'wrms' is
+ * given, the weighted RMS norm of the step
+ *
+ *   sqrt[ 1/N sum_i[ (dx_i / (abstol + reltol*|x_i|))^2 ] ]
+ *
+ * is also evaluated for each unknown (with 'abstol' and 'reltol'
+ * given per non-trivial unknown), which is zero for unknowns whose
+ * tolerances are both zero.
+ *
+ * x:      Solution vector (may be 'nullptr' if neither 'xnorm' nor
+ *         'wrms' are required).
+ * v1:     Step, or first vector of the difference.
+ * v2:     Second vector of the difference (or 'nullptr').
+ * xnorm:  On return, contains the 2-norms of 'x'.
+ * dxnorm: On return, contains the 2-norms of the step.
+ * abstol: Absolute tolerances of the non-trivial unknowns.
+ * reltol: Relative tolerances of the non-trivial unknowns.
+ * wrms:   On return, contains the weighted RMS norms of the step.
+ */
+void NormEvaluator::Norms(
+    const real_t *x, const real_t *v1, const real_t *v2,
+    real_t *xnorm, real_t *dxnorm,
+    const real_t *abstol, const real_t *reltol, real_t *wrms
+) {
+    const bool sol = (x != nullptr && xnorm != nullptr);
+    const bool diff = (v2 != nullptr);
+    const bool weighted = (wrms != nullptr);
+
+    static const norm_block_t kernels[8] = {
+        norm_block<false,false,false>, norm_block<false,false,true>,
+        norm_block<false,true,false>,  norm_block<false,true,true>,
+        norm_block<true,false,false>,  norm_block<true,false,true>,
+        norm_block<true,true,false>,   norm_block<true,true,true>
+    };
+
+    const len_t nThreads = Parallel::GetNumberOfThreads();
+
     len_t offset = 0, i = 0;
     for (auto id : this->nontrivials) {
-        FVM::UnknownQuantity *uqn = this->unknowns->GetUnknown(id);
-        const len_t N = uqn->NumberOfElements();
+        const len_t N = this->unknowns->GetUnknown(id)->NumberOfElements();
+        const bool w = weighted && (abstol[i] != 0 || reltol[i] != 0);
+        const norm_block_t kernel = kernels[4*sol + 2*diff + w];
 
-        rvec[i] = 0;
-        for (len_t j = 0; j < N; j++) {
-            real_t v = vec1[offset+j] - vec2[offset+j];
-            rvec[i] += v*v;
-        }
+        const real_t *xi  = (x == nullptr ? nullptr : x+offset);
+        const real_t *v1i = v1+offset;
+        const real_t *v2i = (diff ? v2+offset : nullptr);
+        const real_t atol = (w ? abstol[i] : 0), rtol = (w ? reltol[i] : 0);
 
-        rvec[i] = sqrt(rvec[i]);
+        const norm_sums s = Parallel::Sum(N, nThreads, norm_sums(),
+            [=](const len_t j0, const len_t j1) {
+                norm_sums b;
+                kernel(
+                    j1-j0, (xi == nullptr ? nullptr : xi+j0), v1i+j0,
+                    (v2i == nullptr ? nullptr : v2i+j0), atol, rtol, b
+                );
+                return b;
+            }
+        );
+
+        if (sol) xnorm[i] = sqrt(s.sx);
+        dxnorm[i] = sqrt(s.sd);
+        if (weighted) wrms[i] = (w && N > 0 ? sqrt(s.sw/N) : 0);
 
         offset += N;
         i++;
     }
 }
-
@@ -0,0 +1,199 @@
+/**
+ * Selection of the PETSc backend used for the matrices and vectors
+ * of the equation system, as well as for the linear solves.
+ *
+ * By default, all matrices are of the sequential AIJ type and all
+ * vectors are standard sequential vectors, living in host memory. If
+ * DREAM has been compiled with 'DREAM_WITH_GPU' and PETSc has been
+ * built with CUDA, HIP or Kokkos support, the equation system can
+ * instead be represented using the corresponding device matrix and
+ * vector types, so that matrix-vector products, Krylov iterations
+ * and (where supported) triangular solves are carried out on the GPU.
+ *
+ * The matrices are always assembled on the host (the equation terms
+ * are evaluated on the CPU), and the values are copied to the device
+ * when the matrix is first used after assembly. Since the non-zero
+ * pattern of the matrices is kept between iterations (see
+ * 'Matrix::Construct()'), only the matrix values (and not the
+ * structure) are transferred in each iteration.
+ *
+ * The backend must be selected before any matrices or vectors
+ * are created.
+ */
+
+#include "FVM/FVMException.hpp"
+#include "FVM/PETScBackend.hpp"
+
+
+using namespace DREAM::FVM;
+
+
+/**
+ * Select the backend to use for all matrices and vectors
+ * created hereafter.
+ */
+void PETScBackend::SetBackend(enum backend b) {
+    if (!IsAvailable(b))
+        throw FVMException(
+            "The '%s' PETSc backend is not available. DREAM must be compiled "
+            "with 'DREAM_WITH_GPU', and PETSc must be built with support for '%s'.",
+            GetName(b), GetName(b)
+        );
+
+    current = b;
+}
+
+/**
+ * Returns 'true' if the given backend can be used with this
+ * build of DREAM and PETSc.
+ */
+bool PETScBackend::IsAvailable(enum backend b) {
+    switch (b) {
+        case BACKEND_CPU: return true;
+#ifdef DREAM_WITH_GPU
+#   ifdef PETSC_HAVE_CUDA
+        case BACKEND_CUDA: return true;
+#   endif
+#   ifdef PETSC_HAVE_HIP
+        case BACKEND_HIP: return true;
+#   endif
+#   ifdef PETSC_HAVE_KOKKOS_KERNELS
+        case BACKEND_KOKKOS: return true;
+#   endif
+#endif
+        default: return false;
+    }
+}
+
+/**
+ * Returns the name of the given backend.
+ */
+const char *PETScBackend::GetName(enum backend b) {
+    switch (b) {
+        case BACKEND_CPU: return "CPU";
+        case BACKEND_CUDA: return "CUDA";
+        case BACKEND_HIP: return "HIP";
+        case BACKEND_KOKKOS: return "Kokkos";
+        default: return "unknown";
+    }
+}
+
+/**
+ * Returns the PETSc matrix type to use with the current backend.
+ */
+MatType PETScBackend::GetMatType() {
+    switch (current) {
+#if defined(DREAM_WITH_GPU) && defined(PETSC_HAVE_CUDA)
+        case BACKEND_CUDA: return MATSEQAIJCUSPARSE;
+#endif
+#if defined(DREAM_WITH_GPU) && defined(PETSC_HAVE_HIP)
+        case BACKEND_HIP: return MATSEQAIJHIPSPARSE;
+#endif
+#if defined(DREAM_WITH_GPU) && defined(PETSC_HAVE_KOKKOS_KERNELS)
+        case BACKEND_KOKKOS: return MATSEQAIJKOKKOS;
+#endif
+        default: return MATSEQAIJ;
+    }
+}
+
+/**
+ * Returns the PETSc vector type to use with the current backend.
+ */
+VecType PETScBackend::GetVecType() {
+    switch (current) {
+#if defined(DREAM_WITH_GPU) && defined(PETSC_HAVE_CUDA)
+        case BACKEND_CUDA: return VECSEQCUDA;
+#endif
+#if defined(DREAM_WITH_GPU) && defined(PETSC_HAVE_HIP)
+        case BACKEND_HIP: return VECSEQHIP;
+#endif
+#if defined(DREAM_WITH_GPU) && defined(PETSC_HAVE_KOKKOS_KERNELS)
+        case BACKEND_KOKKOS: return VECSEQKOKKOS;
+#endif
+        default: return VECSEQ;
+    }
+}
+
+/**
+ * Create a new sparse matrix using the current backend.
+ *
+ * m, n: Number of rows and columns of the matrix.
+ * nz:   Number of non-zeros per row (if 'nnz' is not given).
+ * nnz:  Number of non-zeros in each row (or 'nullptr').
+ * mat:  On return, contains the newly created matrix.
+ */
+PetscErrorCode PETScBackend::CreateMatrix(
+    const PetscInt m, const PetscInt n, const PetscInt nz,
+    const PetscInt *nnz, Mat *mat
+) {
+    if (current == BACKEND_CPU)
+        return MatCreateSeqAIJ(PETSC_COMM_SELF, m, n, nz, nnz, mat);
+
+    PetscErrorCode ierr;
+    if ((ierr=MatCreate(PETSC_COMM_SELF, mat))) return ierr;
+    if ((ierr=MatSetSizes(*mat, m, n, m, n))) return ierr;
+    if ((ierr=MatSetType(*mat, GetMatType()))) return ierr;
+
+    return MatSeqAIJSetPreallocation(*mat, nz, nnz);
+}
+
+/**
+ * Create a new vector using the current backend.
+ *
+ * n:   Number of elements of the vector.
+ * vec: On return, contains the newly created vector.
+ */
+PetscErrorCode PETScBackend::CreateVector(const PetscInt n, Vec *vec) {
+    if (current == BACKEND_CPU)
+        return VecCreateSeq(PETSC_COMM_SELF, n, vec);
+
+    PetscErrorCode ierr;
+    if ((ierr=VecCreate(PETSC_COMM_SELF, vec))) return ierr;
+    if ((ierr=VecSetSizes(*vec, n, n))) return ierr;
+
+    return VecSetType(*vec, GetVecType());
+}
+
+/**
+ * Create a new vector which uses the given array for storing its
+ * elements, so that data can be passed between the vector and the
+ * array without copying. This is only possible on the CPU; with a GPU
+ * backend, a regular (device) vector is created instead, and the
+ * caller must copy the data between the vector and the array.
+ *
+ * n:     Number of elements of the vector.
+ * array: Array to use for storing the vector elements
+ *        (must remain allocated until the vector is destroyed).
+ * vec:   On return, contains the newly created vector.
+ *
+ * RETURNS true if the vector shares its memory with 'array'.
+ */
+bool PETScBackend::CreateVectorWithArray(const PetscInt n, PetscScalar *array, Vec *vec) {
+    if (current == BACKEND_CPU) {
+        VecCreateSeqWithArray(PETSC_COMM_SELF, 1, n, array, vec);
+        return true;
+    } else {
+        CreateVector(n, vec);
+        return false;
+    }
+}
+
+/**
+ * Make the given LU/ILU preconditioner carry out the factorization
+ * and triangular solves on the device (if a GPU backend is selected).
+ * For other preconditioners, this method does nothing.
+ */
+void PETScBackend::SetFactorSolverType(PC pc) {
+    switch (current) {
+#if defined(DREAM_WITH_GPU) && defined(PETSC_HAVE_CUDA)
+        case BACKEND_CUDA: PCFactorSetMatSolverType(pc, MATSOLVERCUSPARSE); break;
+#endif
+#if defined(DREAM_WITH_GPU) && defined(PETSC_HAVE_HIP)
+        case BACKEND_HIP: PCFactorSetMatSolverType(pc, MATSOLVERHIPSPARSE); break;
+#endif
+#if defined(DREAM_WITH_GPU) && defined(PETSC_HAVE_KOKKOS_KERNELS)
+        case BACKEND_KOKKOS: PCFactorSetMatSolverType(pc, MATSOLVERKOKKOS); break;
+#endif
+        default: break;
+    }
+}
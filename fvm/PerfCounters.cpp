@@ -0,0 +1,139 @@
+/**
+ * The PerfCounters class provides access to the hardware performance
+ * counters of the CPU via the Linux 'perf_event' interface. For every
+ * thread which reads the counters, one group of counters (cycles,
+ * instructions, last-level cache references and misses) is opened,
+ * counting only the user-space work done by that thread. Together with
+ * the timers of a 'TimeKeeper', the counters can be used to determine
+ * whether a kernel is limited by computation (high number of instructions
+ * per cycle) or by memory accesses (many last-level cache misses).
+ *
+ * On systems other than Linux, or if access to the performance counters
+ * is not permitted (see '/proc/sys/kernel/perf_event_paranoid'), the
+ * counters are unavailable and 'Configure()' returns 'false'.
+ */
+
+#include <cstring>
+#include "FVM/PerfCounters.hpp"
+
+#if defined(__linux__)
+#   include <linux/perf_event.h>
+#   include <sys/ioctl.h>
+#   include <sys/syscall.h>
+#   include <unistd.h>
+#endif
+
+
+using namespace DREAM::FVM;
+
+
+/**
+ * Enable or disable reading of the performance counters. When
+ * enabling, the counters are opened for the calling thread to
+ * verify that they are available.
+ *
+ * enable: If true, enables the performance counters.
+ *
+ * RETURNS false if the counters could not be enabled.
+ */
+bool PerfCounters::Configure(const bool enable) {
+    PerfCounters::enabled = enable && Open();
+    return (PerfCounters::enabled == enable);
+}
+
+/**
+ * Open the group of counters for the calling thread.
+ *
+ * RETURNS true if the counters are available on this thread.
+ */
+bool PerfCounters::Open() {
+    if (fds[0] >= 0)
+        return true;
+    else if (fds[0] == -2)
+        return false;
+
+#if defined(__linux__)
+    const uint64_t configs[N_COUNTERS] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_CACHE_REFERENCES,
+        PERF_COUNT_HW_CACHE_MISSES
+    };
+
+    for (len_t i = 0; i < N_COUNTERS; i++) {
+        struct perf_event_attr pe;
+        memset(&pe, 0, sizeof(pe));
+
+        pe.type = PERF_TYPE_HARDWARE;
+        pe.size = sizeof(pe);
+        pe.config = configs[i];
+        pe.read_format = PERF_FORMAT_GROUP;
+        pe.exclude_kernel = 1;
+        pe.exclude_hv = 1;
+
+        // Count the calling thread, on any CPU
+        const int leader = (i == 0 ? -1 : fds[0]);
+        fds[i] = syscall(SYS_perf_event_open, &pe, 0, -1, leader, 0);
+
+        if (fds[i] < 0) {
+            for (len_t j = 0; j < i; j++) {
+                close(fds[j]);
+                fds[j] = -1;
+            }
+
+            fds[0] = -2;
+            return false;
+        }
+    }
+
+    return true;
+#else
+    fds[0] = -2;
+    return false;
+#endif
+}
+
+/**
+ * Read the current values of the counters of the calling thread.
+ * The values are counted from when the counters were opened, so
+ * only differences between two reads are meaningful.
+ *
+ * val: On return, contains the counter values (zero if the counters
+ *      are unavailable).
+ *
+ * RETURNS true if the counters could be read.
+ */
+bool PerfCounters::Read(struct values &val) {
+    if (!Open())
+        return false;
+
+#if defined(__linux__)
+    // Layout of the data read (with 'PERF_FORMAT_GROUP')
+    struct {
+        uint64_t nr;
+        uint64_t v[N_COUNTERS];
+    } data;
+
+    if (read(fds[0], &data, sizeof(data)) != sizeof(data))
+        return false;
+
+    for (len_t i = 0; i < N_COUNTERS; i++)
+        val.v[i] = data.v[i];
+
+    return true;
+#else
+    return false;
+#endif
+}
+
+/**
+ * Returns the name of the specified counter (used when
+ * saving the counters to file).
+ */
+const char *PerfCounters::GetName(const len_t i) {
+    const char *names[N_COUNTERS] = {
+        "cycles", "instructions", "llcreferences", "llcmisses"
+    };
+
+    return names[i];
+}
@@ -0,0 +1,111 @@
+/**
+ * The PetscLog class makes the phases of the DREAM solver visible in the
+ * PETSc performance log (as shown with '-log_view'). Each phase of a
+ * Newton iteration (rebuild, residual, jacobian, inversion) is a separate
+ * log stage, so that the flops, memory and time of the PETSc operations
+ * carried out in that phase are reported separately, and the 'Invert()'
+ * methods of the matrix inverters are logged as events. Stages and
+ * events are registered with PETSc the first time they are used.
+ *
+ * When enabled, the PETSc log summary can also be saved to the output
+ * file, so that it can be compared with the timings recorded by DREAM.
+ */
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <unistd.h>
+#include <petscviewer.h>
+#include "FVM/PetscLog.hpp"
+
+
+using namespace DREAM::FVM;
+using namespace std;
+
+
+/**
+ * Enable or disable PETSc logging of the solver phases. Since
+ * PETSc only collects performance data if logging has been
+ * activated (which is otherwise done with '-log_view'), this
+ * starts the default PETSc logger.
+ *
+ * enable: If true, enables PETSc logging.
+ */
+void PetscLog::Configure(const bool enable) {
+    if (enable && stages.empty() && events.empty()) {
+        PetscLogDefaultBegin();
+        PetscClassIdRegister("DREAM", &classId);
+    }
+
+    PetscLog::enabled = enable;
+}
+
+/**
+ * Returns the PETSc log stage with the given name,
+ * registering it if it does not already exist.
+ *
+ * name: Name of the stage.
+ */
+PetscLogStage PetscLog::GetStage(const char *name) {
+    auto it = stages.find(name);
+    if (it != stages.end())
+        return it->second;
+
+    PetscLogStage stage;
+    PetscLogStageRegister(name, &stage);
+    stages[name] = stage;
+
+    return stage;
+}
+
+/**
+ * Returns the PETSc log event with the given name,
+ * registering it if it does not already exist.
+ *
+ * name: Name of the event.
+ */
+PetscLogEvent PetscLog::GetEvent(const char *name) {
+    auto it = events.find(name);
+    if (it != events.end())
+        return it->second;
+
+    PetscLogEvent event;
+    PetscLogEventRegister(name, classId, &event);
+    events[name] = event;
+
+    return event;
+}
+
+/**
+ * Save the PETSc log summary (in the same format as shown
+ * with '-log_view') to the given SFile object. Since PETSc
+ * can only write the summary to an ASCII viewer, it is first
+ * written to a temporary file.
+ *
+ * sf:   SFile object to save log summary to.
+ * path: Path in SFile object to save log summary to.
+ */
+void PetscLog::SaveSummary(SFile *sf, const string& path) {
+    const char *tmpdir = getenv("TMPDIR");
+    string filename = string(tmpdir == nullptr ? "/tmp" : tmpdir) + "/dream_petsclog_XXXXXX";
+
+    int fd = mkstemp(&filename[0]);
+    if (fd < 0)
+        return;
+    close(fd);
+
+    PetscViewer viewer;
+    PetscViewerASCIIOpen(PETSC_COMM_SELF, filename.c_str(), &viewer);
+    PetscLogView(viewer);
+    PetscViewerDestroy(&viewer);
+
+    ifstream f(filename);
+    stringstream ss;
+    ss << f.rdbuf();
+    f.close();
+    remove(filename.c_str());
+
+    sf->WriteString(path, ss.str());
+    sf->WriteAttribute_string(path, "desc", "PETSc performance summary (as shown with '-log_view')");
+}
@@ -16,6 +16,8 @@
 
 #include <string>
 #include "FVM/FVMException.hpp"
+#include "FVM/MemoryAccounting.hpp"
+#include "FVM/Parallel.hpp"
 #include "FVM/QuantityData.hpp"
 
 
@@ -49,17 +51,33 @@ QuantityData::QuantityData(Grid *grid, const len_t nMultiples, enum FVM::fluxGri
     this->nMultiples = nMultiples;
 
     AllocateData();
+
+    MemoryAccounting::Register(this, "quantitydata/data", [this]() { return this->GetMemoryUsage(); });
+    MemoryAccounting::Register(this, "quantitydata/saved", [this]() { return this->GetSavedStepsMemoryUsage(); });
 }
 
 /**
  * Destructor.
  */
 QuantityData::~QuantityData() {
+    MemoryAccounting::Unregister(this);
+
     for (auto it = store.begin(); it != store.end(); it++)
         delete [] *it;
+    for (auto it = storeSingle.begin(); it != storeSingle.end(); it++)
+        delete [] *it;
+    if (stepBuffer != nullptr)
+        delete [] stepBuffer;
+    if (lastSaved != nullptr) {
+        delete [] lastSaved;
+        delete [] interpBuffer;
+    }
 
-    delete [] olddata[0];
+    delete [] oldblock;
     delete [] olddata;
+    delete [] oldtime;
+    if (oldcomb != nullptr)
+        delete [] oldcomb;
     delete [] data;
     delete [] idxVec;
 }
@@ -74,24 +92,125 @@ void QuantityData::AllocateData() {
     if (N_SAVE_OLD_STEPS == 0)
         throw FVM::FVMException("QuantityData: The parameter 'N_SAVE_OLD_STEPS' must be at least 1.");
 
+    this->oldblock = new real_t[N_SAVE_OLD_STEPS*this->nElements];
     this->olddata = new real_t*[N_SAVE_OLD_STEPS];
-    this->olddata[0] = new real_t[N_SAVE_OLD_STEPS*this->nElements];
-    for (len_t i = 1; i < N_SAVE_OLD_STEPS; i++)
-        this->olddata[i] = this->olddata[i-1] + this->nElements;
+    for (len_t i = 0; i < N_SAVE_OLD_STEPS; i++)
+        this->olddata[i] = this->oldblock + i*this->nElements;
 
     this->oldtime = new real_t[N_SAVE_OLD_STEPS];
     this->idxVec = new PetscInt[this->nElements];
 
     this->nOldSaved = 0;
 
-    for (len_t i = 0; i < nElements; i++)
-        this->data[i] = 0;
-    for (len_t i = 0; i < N_SAVE_OLD_STEPS*nElements; i++)
-        this->olddata[0][i] = 0;
+    FVM::Parallel::FirstTouch(this->data, nElements);
+    FVM::Parallel::FirstTouch(this->oldblock, N_SAVE_OLD_STEPS*nElements);
     for (len_t i = 0; i < nElements; i++)
         this->idxVec[i] = (PetscInt)i;
 }
 
+/**
+ * Returns the number of bytes used for the current and old
+ * time steps of this quantity (i.e. excluding saved steps).
+ */
+size_t QuantityData::GetMemoryUsage() const {
+    size_t n = (1 + N_SAVE_OLD_STEPS) * this->nElements * sizeof(real_t)
+        + N_SAVE_OLD_STEPS * (sizeof(real_t*) + sizeof(real_t))
+        + this->nElements * sizeof(PetscInt);
+
+    if (this->oldcomb != nullptr)
+        n += this->nElements * sizeof(real_t);
+    if (this->stepBuffer != nullptr)
+        n += this->nElements * sizeof(real_t);
+    if (this->lastSaved != nullptr)
+        n += 2 * this->nElements * sizeof(real_t);
+
+    return n;
+}
+
+/**
+ * Returns the number of bytes used for the saved time steps
+ * of this quantity which are kept in memory.
+ */
+size_t QuantityData::GetSavedStepsMemoryUsage() const {
+    return this->nElements * (
+        this->store.size() * sizeof(real_t) +
+        this->storeSingle.size() * sizeof(float)
+    ) + this->times.size() * sizeof(real_t);
+}
+
+/**
+ * Change the number of old time steps kept in 'olddata'. The most
+ * recent old time steps are retained.
+ *
+ * n: New number of old time steps to keep.
+ */
+void QuantityData::SetNSaveOldSteps(const len_t n) {
+    if (n == 0)
+        throw FVM::FVMException("QuantityData: The number of old time steps to keep must be at least 1.");
+    else if (n == N_SAVE_OLD_STEPS)
+        return;
+
+    real_t *ob = new real_t[n*this->nElements];
+    real_t **od = new real_t*[n];
+    for (len_t i = 0; i < n; i++)
+        od[i] = ob + i*this->nElements;
+
+    real_t *ot = new real_t[n];
+
+    const len_t nKeep = min(n, N_SAVE_OLD_STEPS);
+    for (len_t i = 0; i < n; i++) {
+        for (len_t j = 0; j < this->nElements; j++)
+            od[i][j] = (i < nKeep ? this->olddata[i][j] : 0);
+
+        ot[i] = (i < nKeep ? this->oldtime[i] : 0);
+    }
+
+    delete [] this->oldblock;
+    delete [] this->olddata;
+    delete [] this->oldtime;
+
+    this->oldblock = ob;
+    this->olddata = od;
+    this->oldtime = ot;
+    this->N_SAVE_OLD_STEPS = n;
+    this->nOldSaved = min(this->nOldSaved, n);
+}
+
+/**
+ * Returns the linear combination
+ *
+ *   sum_j c[j] * olddata[idx[j]]
+ *
+ * of old time steps. The result is cached and only
+ * recomputed when 'version' changes.
+ *
+ * version: Identifier of the requested combination (must be
+ *          changed by the caller whenever 'n', 'idx' or 'c' change).
+ * n:       Number of old time steps to combine.
+ * idx:     Indices of old time steps to combine (size n).
+ * c:       Coefficients of the combination (size n).
+ */
+real_t *QuantityData::GetOldStepCombination(
+    const len_t version, const len_t n, const len_t *idx, const real_t *c
+) {
+    if (this->oldcomb == nullptr)
+        this->oldcomb = new real_t[this->nElements];
+
+    if (version != this->oldcombVersion) {
+        for (len_t i = 0; i < this->nElements; i++) {
+            real_t v = 0;
+            for (len_t j = 0; j < n; j++)
+                v += c[j] * this->olddata[idx[j]][i];
+
+            this->oldcomb[i] = v;
+        }
+
+        this->oldcombVersion = version;
+    }
+
+    return this->oldcomb;
+}
+
 /**
  * Returns 'true' if we can roll back the saved data by
  * at least one time step.
@@ -111,14 +230,17 @@ bool QuantityData::CanRollbackSaveStep() const {
  *           buffer.
  */
 void QuantityData::SaveStep(const real_t t, bool trueSave) {
-    // Move old data...
+    this->oldcombVersion = 0;
+
+    // Move old data (the buffer of the oldest step
+    // retained is reused for the new step)...
     len_t nMin = min(this->nOldSaved, N_SAVE_OLD_STEPS-1);
+    real_t *buf = this->olddata[nMin];
     for (len_t i = nMin; i > 0; i--) {
-        for (len_t j = 0; j < this->nElements; j++)
-            this->olddata[i][j] = this->olddata[i-1][j];
-
+        this->olddata[i] = this->olddata[i-1];
         this->oldtime[i] = this->oldtime[i-1];
     }
+    this->olddata[0] = buf;
 
     if (this->nOldSaved < N_SAVE_OLD_STEPS)
         this->nOldSaved++;
@@ -129,14 +251,11 @@ void QuantityData::SaveStep(const real_t t, bool trueSave) {
     
     this->oldtime[0] = t;
 
-    // Copy to true 'store' array
     if (trueSave) {
-        real_t *v = new real_t[this->nElements];
-        for (len_t i = 0; i < nElements; i++)
-            v[i] = this->olddata[0][i];
-
-        times.push_back(this->oldtime[0]);
-        store.push_back(v);
+        if (this->outputTimes == nullptr)
+            AppendSavedStep(this->olddata[0], t);
+        else
+            SaveOutputTimes(t);
 
         // If we do a 'true' save, we cannot roll back the solution anymore
         // (this is just an imposed limitation; rolling back stored solutions
@@ -146,6 +265,219 @@ void QuantityData::SaveStep(const real_t t, bool trueSave) {
     }
 }
 
+/**
+ * Copy the given data to the true 'store' array as the saved step
+ * at time 't' (rounding to single precision if requested; the initial
+ * value is always kept in double precision, since it is used when
+ * setting up other quantities).
+ */
+void QuantityData::AppendSavedStep(const real_t *d, const real_t t) {
+    // (if only the final step is to be kept, the previously
+    // saved step is overwritten, but never the initial value)
+    const bool replace = (this->finalOnly && this->times.size() >= 2);
+
+    if (this->singlePrecision && !store.empty()) {
+        float *v = (replace ? storeSingle.back() : new float[this->nElements]);
+        for (len_t i = 0; i < nElements; i++)
+            v[i] = (float)d[i];
+
+        if (!replace)
+            storeSingle.push_back(v);
+    } else {
+        real_t *v = (replace ? store.back() : new real_t[this->nElements]);
+        for (len_t i = 0; i < nElements; i++)
+            v[i] = d[i];
+
+        if (!replace)
+            store.push_back(v);
+    }
+
+    if (replace)
+        times.back() = t;
+    else
+        times.push_back(t);
+}
+
+/**
+ * Save the output times passed since the previous (true) saved
+ * step, linearly interpolating between the previous and current
+ * saved steps (dense output). Apart from the initial value, only
+ * the data in the output times is kept in the 'store' array.
+ *
+ * t: Time of the current saved step.
+ */
+void QuantityData::SaveOutputTimes(const real_t t) {
+    if (this->lastSaved == nullptr) {
+        this->lastSaved = new real_t[this->nElements];
+        this->interpBuffer = new real_t[this->nElements];
+
+        // The previous saved step is the initial value (if any; quantities
+        // without an initial value use their first saved step for all
+        // output times preceding it)
+        const bool hasInitial = !this->store.empty();
+        const real_t *d = (hasInitial ? this->store.front() : this->data);
+        for (len_t i = 0; i < nElements; i++)
+            this->lastSaved[i] = d[i];
+        this->lastSavedTime = (hasInitial ? this->times.front() : t);
+    }
+
+    // (output times preceding the initial value are skipped)
+    const bool skipEarly = !this->store.empty();
+    const real_t t0 = this->lastSavedTime;
+    const vector<real_t>& tout = *this->outputTimes;
+    for (; this->nextOutputTime < tout.size() && tout[this->nextOutputTime] <= t; this->nextOutputTime++) {
+        const real_t tk = tout[this->nextOutputTime];
+        if (tk <= t0 && skipEarly)
+            continue;
+
+        const real_t w = (t > t0 ? (tk-t0) / (t-t0) : 1);
+        for (len_t i = 0; i < nElements; i++)
+            this->interpBuffer[i] = this->lastSaved[i] + w*(this->data[i] - this->lastSaved[i]);
+
+        AppendSavedStep(this->interpBuffer, tk);
+    }
+
+    for (len_t i = 0; i < nElements; i++)
+        this->lastSaved[i] = this->data[i];
+    this->lastSavedTime = t;
+}
+
+/**
+ * Produce saved steps only in the given (sorted) output times,
+ * instead of in every (true) saved step. The values in the output
+ * times are obtained by interpolating linearly between the saved
+ * steps surrounding them, so that the time stepper does not need to
+ * take steps which land on the output times.
+ *
+ * tout: List of output times (must remain valid for the lifetime of
+ *       this object).
+ */
+void QuantityData::SetOutputTimes(const vector<real_t> *tout) {
+    this->outputTimes = tout;
+    this->nextOutputTime = 0;
+}
+
+/**
+ * Returns the data of the saved step with index 'i' (where
+ * step 0 is the initial value).
+ */
+const real_t *QuantityData::GetSavedStep(const len_t i) {
+    if (i == 0)
+        return this->store[0];
+    else if (i <= this->nReleasedSteps || i >= this->GetNSavedSteps())
+        throw FVM::FVMException(
+            "QuantityData: Saved step " LEN_T_PRINTF_FMT " is not available in memory.", i
+        );
+
+    if (!this->singlePrecision)
+        return this->store[i-this->nReleasedSteps];
+
+    // Convert step to double precision
+    if (this->stepBuffer == nullptr)
+        this->stepBuffer = new real_t[this->nElements];
+
+    const float *v = this->storeSingle[i-this->nReleasedSteps-1];
+    for (len_t j = 0; j < this->nElements; j++)
+        this->stepBuffer[j] = v[j];
+
+    return this->stepBuffer;
+}
+
+/**
+ * Specify whether or not to store saved steps (except the initial
+ * value) in single precision. This halves the memory (and disk space)
+ * needed for the saved steps, and should be set before any steps following
+ * the initial value have been saved.
+ */
+void QuantityData::SetSinglePrecision(bool single) {
+    if (single != this->singlePrecision && this->times.size() > 1)
+        throw FVM::FVMException(
+            "QuantityData: Cannot change precision of saved steps after "
+            "steps have been saved."
+        );
+
+    this->singlePrecision = single;
+}
+
+/**
+ * Specify whether or not to only keep the most recent saved step
+ * (in addition to the initial value) of this quantity. Every saved
+ * step then replaces the previous one, so that the memory (and disk
+ * space) needed for the quantity does not grow with the number of
+ * saved steps. This is mainly useful for large kinetic quantities, of
+ * which only reductions are needed at intermediate times (see e.g.
+ * the 'hottail/f_pitchint' other quantity). Should be set before any
+ * steps following the initial value have been saved.
+ */
+void QuantityData::SetFinalOnly(bool final) {
+    if (final != this->finalOnly && this->times.size() > 1)
+        throw FVM::FVMException(
+            "QuantityData: Cannot change which saved steps to keep after "
+            "steps have been saved."
+        );
+
+    this->finalOnly = final;
+}
+
+/**
+ * Free the memory occupied by all saved steps, except the
+ * initial value. This is used when the saved steps have been
+ * written to file as part of the simulation (in which case
+ * they need not be kept in memory). The time of each step is
+ * kept.
+ */
+void QuantityData::ReleaseSavedSteps() {
+    for (len_t i = 1; i < this->store.size(); i++)
+        delete [] this->store[i];
+
+    this->nReleasedSteps += this->storeSingle.size();
+    for (len_t i = 0; i < this->storeSingle.size(); i++)
+        delete [] this->storeSingle[i];
+    this->storeSingle.clear();
+
+    if (this->store.size() > 1) {
+        this->nReleasedSteps += this->store.size()-1;
+        this->store.resize(1);
+    }
+}
+
+/**
+ * Hand over the saved steps (except the initial one) to the caller,
+ * which becomes responsible for deleting them. This is equivalent to
+ * 'ReleaseSavedSteps()', but without freeing the data.
+ *
+ * steps: Vector to append the saved steps to (in order).
+ */
+void QuantityData::TakeSavedSteps(vector<real_t*>& steps) {
+    if (this->singlePrecision)
+        throw FVM::FVMException(
+            "QuantityData: The saved steps are stored in single precision."
+        );
+
+    for (len_t i = 1; i < this->store.size(); i++)
+        steps.push_back(this->store[i]);
+
+    if (this->store.size() > 1) {
+        this->nReleasedSteps += this->store.size()-1;
+        this->store.resize(1);
+    }
+}
+
+/**
+ * Hand over the saved steps (except the initial one) which are
+ * stored in single precision to the caller, which becomes
+ * responsible for deleting them.
+ *
+ * steps: Vector to append the saved steps to (in order).
+ */
+void QuantityData::TakeSavedSteps(vector<float*>& steps) {
+    for (float *v : this->storeSingle)
+        steps.push_back(v);
+
+    this->nReleasedSteps += this->storeSingle.size();
+    this->storeSingle.clear();
+}
+
 /**
  * Roll back a previously saved time step. This method is
  * the inverse of the method 'SaveStep()' with 'trueSave = false'.
@@ -154,16 +486,19 @@ void QuantityData::RollbackSaveStep() {
     if (!CanRollbackSaveStep())
         throw FVM::FVMException("QuantityData: Cannot roll back previous time step.");
 
+    this->oldcombVersion = 0;
+    this->version++;
+
     for (len_t i = 0; i < this->nElements; i++)
         this->data[i] = this->olddata[0][i];
 
     len_t nMin = min(this->nOldSaved, this->N_SAVE_OLD_STEPS);
+    real_t *buf = this->olddata[0];
     for (len_t i = 0; i < nMin-1; i++) {
-        for (len_t j = 0; j < this->nElements; j++)
-            this->olddata[i][j] = this->olddata[i+1][j];
-
+        this->olddata[i] = this->olddata[i+1];
         this->oldtime[i] = this->oldtime[i+1];
     }
+    this->olddata[nMin-1] = buf;
 
     this->nOldSaved--;
 }
@@ -183,7 +518,7 @@ void QuantityData::Store(Vec& vec, const len_t offset, bool mayBeConstant) {
         // Check if the current and given data are
         // exactly equal (i.e. constant)
         Vec tv;
-        VecCreateSeqWithArray(PETSC_COMM_WORLD, 1, nElements, this->data, &tv);
+        VecCreateSeqWithArray(PETSC_COMM_SELF, 1, nElements, this->data, &tv);
 
         PetscBool eq;
         VecEqual(vec, tv, &eq);
@@ -197,6 +532,7 @@ void QuantityData::Store(Vec& vec, const len_t offset, bool mayBeConstant) {
     }
 
     this->hasChanged = true;
+    this->version++;
 
     if ((len_t)idxVec[0] != offset) {
         for (len_t i = 0; i < nElements; i++)
@@ -220,12 +556,11 @@ void QuantityData::Store(const real_t *vec, const len_t offset, bool mayBeConsta
     if (mayBeConstant) {
         // Check if the current and given data are
         // exactly equal (i.e. constant)
-        real_t s = 0;
-        for (len_t i = 0; i < nElements; i++)
-            s += this->data[i] - vec[offset+i];
+        bool eq = true;
+        for (len_t i = 0; i < nElements && eq; i++)
+            eq = (this->data[i] == vec[offset+i]);
 
-        // Equal?
-        if (s == 0) {
+        if (eq) {
             this->hasChanged = false;
             return;
         }
@@ -233,6 +568,7 @@ void QuantityData::Store(const real_t *vec, const len_t offset, bool mayBeConsta
 
     // Data is updated
     this->hasChanged = true;
+    this->version++;
 
     for (len_t i = 0; i < nElements; i++)
         this->data[i] = vec[offset+i];
@@ -247,23 +583,51 @@ void QuantityData::Store(const real_t *vec, const len_t offset, bool mayBeConsta
  * mayBeConstant: If true, indicates that the data may not
  *                have changed since the last iteration.
  *
- * XXX here we assume that all momentum grids have the same
- * sizes at all radii
+ * If different radii use different momentum grids, 'n' is ignored
+ * and the number of elements stored for each radius is instead
+ * taken from the momentum grid of that radius (i.e. only the first
+ * elements of 'vec[i]' are stored if it is larger).
  */
 void QuantityData::Store(
     const len_t m, const len_t n,
     const real_t *const* vec, bool mayBeConstant
 ) {
+    if (!this->grid->HasRadiallyUniformMomentumGrid()) {
+        bool eq = mayBeConstant;
+        for (len_t i = 0, offset = 0; i < m && eq; i++) {
+            const len_t ni = this->grid->GetNp1(i, this->fluxGridType) * this->grid->GetNp2(i, this->fluxGridType);
+            for (len_t j = 0; j < ni && eq; j++)
+                eq = (this->data[offset + j] == vec[i][j]);
+            offset += ni;
+        }
+
+        if (eq) {
+            this->hasChanged = false;
+            return;
+        }
+
+        this->hasChanged = true;
+        this->version++;
+
+        for (len_t i = 0, offset = 0; i < m; i++) {
+            const len_t ni = this->grid->GetNp1(i, this->fluxGridType) * this->grid->GetNp2(i, this->fluxGridType);
+            for (len_t j = 0; j < ni; j++)
+                this->data[offset + j] = vec[i][j];
+            offset += ni;
+        }
+
+        return;
+    }
+
     if (mayBeConstant) {
         // Check if the current and given data are
         // exactly equal (i.e. constant)
-        real_t s = 0;
-        for (len_t i = 0; i < m; i++)
-            for (len_t j = 0; j < n; j++)
-                s += this->data[i*n + j] - vec[i][j];
+        bool eq = true;
+        for (len_t i = 0; i < m && eq; i++)
+            for (len_t j = 0; j < n && eq; j++)
+                eq = (this->data[i*n + j] == vec[i][j]);
 
-        // Equal?
-        if (s == 0) {
+        if (eq) {
             this->hasChanged = false;
             return;
         }
@@ -271,6 +635,7 @@ void QuantityData::Store(
 
     // Data has changed
     this->hasChanged = true;
+    this->version++;
 
     for (len_t i = 0; i < m; i++) {
         for (len_t j = 0; j < n; j++)
@@ -304,6 +669,7 @@ void QuantityData::Store(const int_t *vec, const len_t offset, bool mayBeConstan
  * for the data and _then_ writing to the array).
  */
 real_t *QuantityData::StoreEmpty() {
+    this->version++;
     return this->data;
 }
 
@@ -324,7 +690,16 @@ void QuantityData::SaveSFile(
     SFile *sf, const string& name, const string& path,
     const string& description, bool saveMeta
 ) {
-	this->SaveSFile_internal(sf, name, path, description, saveMeta, this->times, this->store);
+    if (this->nReleasedSteps > 0)
+        throw FVM::FVMException(
+            "QuantityData: Cannot save '%s': saved steps have been released from memory.",
+            name.c_str()
+        );
+
+	this->SaveSFile_internal(
+        sf, name, path, description, saveMeta, this->times, this->store,
+        this->singlePrecision ? &this->storeSingle : nullptr
+    );
 }
 
 /**
@@ -364,16 +739,18 @@ void QuantityData::SaveSFileCurrent(
  *              in addition to any coordinate grids (e.g. 'r', 'p', 'xi' etc.).
  * times:       Time array to save.
  * store:       Data array to save.
+ * storef:      If not 'nullptr', contains all steps following the
+ *              first (which is taken from 'store') in single precision.
  */
 void QuantityData::SaveSFile_internal(
     SFile *sf, const string& name, const string& path,
     const string& description, bool saveMeta,
-	vector<real_t>& times, vector<real_t*>& store
+	vector<real_t>& times, vector<real_t*>& store,
+    const vector<float*> *storef
 ) {
     const len_t
         nt  = times.size(),
         nr  = this->grid->GetNr(),
-        // XXX Here we assume that all momentum grids are the same
         np1 = this->grid->GetMomentumGrid(0)->GetNp1(),
         np2 = this->grid->GetMomentumGrid(0)->GetNp2();
 
@@ -399,8 +776,11 @@ void QuantityData::SaveSFile_internal(
                 sf->WriteList(group + "r", this->grid->GetRadialGrid()->GetR(), nr);
         }
 
-        // XXX Here we assume that all momentum grids are the same
-        if (np1 > 1) {
+        // (with different momentum grids at different radii, the
+        // momentum grids are only saved with the grid, see
+        // 'GetStepDimensions()')
+        const bool uniform = this->grid->HasRadiallyUniformMomentumGrid();
+        if (np1 > 1 && uniform) {
             const string p1name = this->grid->GetMomentumGrid(0)->GetP1Name();
 
             if (this->fluxGridType == FLUXGRIDTYPE_P1)
@@ -409,7 +789,7 @@ void QuantityData::SaveSFile_internal(
                 sf->WriteList(group + p1name, this->grid->GetMomentumGrid(0)->GetP1(), np1);
         }
 
-        if (np2 > 1) {
+        if (np2 > 1 && uniform) {
             const string p2name = this->grid->GetMomentumGrid(0)->GetP2Name();
 
             if (this->fluxGridType == FLUXGRIDTYPE_P2)
@@ -419,26 +799,8 @@ void QuantityData::SaveSFile_internal(
         }
     }
 
-    sfilesize_t ndims = 1;
     sfilesize_t dims[5] = {nt,0,0,0,0};
-
-    if (this->nMultiples > 1) dims[ndims++] = this->nMultiples;
-    //if (nr > 1 || np2 > 1 || np1 > 1) dims[ndims++] = nr;
-
-    // Always include radial dimension
-    if (this->fluxGridType == FLUXGRIDTYPE_RADIAL)
-        dims[ndims++] = nr+1;
-    else dims[ndims++] = nr;
-
-    if (np2 > 1 || np1 > 1) {
-        if (this->fluxGridType == FLUXGRIDTYPE_P2)
-            dims[ndims++] = np2+1;
-        else dims[ndims++] = np2;
-
-        if (this->fluxGridType == FLUXGRIDTYPE_P1)
-            dims[ndims++] = np1+1;
-        else dims[ndims++] = np1;
-    }
+    sfilesize_t ndims = 1 + this->GetStepDimensions(dims+1);
 
     // Compute number of elements
     len_t nel = dims[0];
@@ -450,8 +812,14 @@ void QuantityData::SaveSFile_internal(
     // array first)
     real_t *data = new real_t[nel];
     for (len_t i = 0; i < nt; i++) {
-        for (len_t j = 0; j < nElements; j++)
-            data[i*nElements + j] = store[i][j];
+        if (storef != nullptr && i > 0) {
+            const float *v = (*storef)[i-1];
+            for (len_t j = 0; j < nElements; j++)
+                data[i*nElements + j] = v[j];
+        } else {
+            for (len_t j = 0; j < nElements; j++)
+                data[i*nElements + j] = store[i][j];
+        }
     }
 
     sf->WriteMultiArray(group + dname, data, ndims, dims);
@@ -462,6 +830,47 @@ void QuantityData::SaveSFile_internal(
     delete [] data;
 }
 
+/**
+ * Get the dimensions of a single saved step of this quantity, as
+ * it is stored in the output file. Returns the number of dimensions
+ * (at most 4) and sets 'dims' accordingly.
+ *
+ * When different radii use different momentum grids, kinetic
+ * quantities are saved as a single (flat) dimension containing
+ * the momentum grids of all radii one after the other.
+ */
+len_t QuantityData::GetStepDimensions(sfilesize_t *dims) const {
+    const len_t
+        nr  = this->grid->GetNr(),
+        np1 = this->grid->GetMomentumGrid(0)->GetNp1(),
+        np2 = this->grid->GetMomentumGrid(0)->GetNp2();
+
+    len_t ndims = 0;
+    if (this->nMultiples > 1) dims[ndims++] = this->nMultiples;
+
+    if (!this->grid->HasRadiallyUniformMomentumGrid()) {
+        dims[ndims++] = this->nElements / this->nMultiples;
+        return ndims;
+    }
+
+    // Always include radial dimension
+    if (this->fluxGridType == FLUXGRIDTYPE_RADIAL)
+        dims[ndims++] = nr+1;
+    else dims[ndims++] = nr;
+
+    if (np2 > 1 || np1 > 1) {
+        if (this->fluxGridType == FLUXGRIDTYPE_P2)
+            dims[ndims++] = np2+1;
+        else dims[ndims++] = np2;
+
+        if (this->fluxGridType == FLUXGRIDTYPE_P1)
+            dims[ndims++] = np1+1;
+        else dims[ndims++] = np1;
+    }
+
+    return ndims;
+}
+
 /**
  * Set the initial value of the specified unknown quantity. If
  * the initial value has previously been specified, it is overwritten.
@@ -508,3 +917,36 @@ void QuantityData::SetInitialValue(const real_t *val, const real_t t0) {
         delete [] init;
 }
 
+/**
+ * Restore the state of this quantity from a checkpoint. The given
+ * data is used as the initial value of the quantity, and the old
+ * time steps needed for evaluating time derivatives (and for rolling
+ * back steps) are restored.
+ *
+ * val:      Data in the current time step.
+ * t0:       Time of the current time step.
+ * olddat:   Contents of the 'olddata' buffers (stored contiguously,
+ *           most recent time step first).
+ * oldtim:   Times corresponding to the 'olddata' buffers.
+ * nBuffers: Number of buffers in 'olddat' (normally 'N_SAVE_OLD_STEPS').
+ * nOld:     Number of old time steps stored (see 'nOldSaved').
+ */
+void QuantityData::RestoreState(
+    const real_t *val, const real_t t0, const real_t *olddat,
+    const real_t *oldtim, const len_t nBuffers, const len_t nOld
+) {
+    this->SetInitialValue(val, t0);
+
+    // (the 'olddata' buffers are used even if 'nOldSaved = 0', since
+    // the most recent one then holds the previous time step)
+    const len_t n = min(nBuffers, this->N_SAVE_OLD_STEPS);
+    for (len_t i = 0; i < n; i++) {
+        for (len_t j = 0; j < this->nElements; j++)
+            this->olddata[i][j] = olddat[i*this->nElements + j];
+
+        this->oldtime[i] = oldtim[i];
+    }
+
+    this->nOldSaved = min(nOld, n);
+    this->oldcombVersion = 0;
+}
@@ -0,0 +1,98 @@
+/**
+ * Implementation of a bump allocator for temporary arrays which are
+ * only needed within a single iteration of the solver (partial
+ * derivatives, tabulated intermediate quantities etc.).
+ *
+ * Each thread has its own arena, obtained through 'ScratchArena::Get()'.
+ * Memory is handed out by advancing a pointer into a large block, and
+ * is released all at once when the solver moves on to the next
+ * iteration (signalled by 'ScratchArena::NextIteration()'). When an
+ * arena is reset, any additional blocks which were needed during the
+ * previous iteration are merged into a single block, so that after
+ * the first few iterations no heap allocations are made at all.
+ */
+
+#include <algorithm>
+#include "FVM/ScratchArena.hpp"
+
+
+using namespace DREAM::FVM;
+using namespace std;
+
+
+// Alignment of all memory handed out by the arena
+static const size_t SCRATCH_ARENA_ALIGNMENT = alignof(std::max_align_t);
+// Minimum size of blocks allocated by the arena
+static const size_t SCRATCH_ARENA_MIN_CHUNK = 1 << 16;
+
+
+/**
+ * Destructor.
+ */
+ScratchArena::~ScratchArena() {
+    for (auto &c : this->chunks)
+        delete [] c.data;
+}
+
+/**
+ * Returns the scratch arena belonging to the calling thread.
+ */
+ScratchArena& ScratchArena::Get() {
+    static thread_local ScratchArena arena;
+    return arena;
+}
+
+
+/**
+ * Hand out 'n' bytes of scratch memory.
+ */
+void *ScratchArena::AllocateBytes(const size_t n) {
+    // Release all memory handed out in previous iterations
+    const len_t it = currentIteration.load(memory_order_relaxed);
+    if (it != this->iteration) {
+        Reset();
+        this->iteration = it;
+    }
+
+    const size_t nAligned = SCRATCH_ARENA_ALIGNMENT * ((n + SCRATCH_ARENA_ALIGNMENT-1) / SCRATCH_ARENA_ALIGNMENT);
+
+    if (this->chunks.empty() || this->chunks.back().used + nAligned > this->chunks.back().size) {
+        const size_t size = max(max(nAligned, SCRATCH_ARENA_MIN_CHUNK), 2*GetCapacity());
+        this->chunks.push_back({new char[size], size, 0});
+        nHeapAllocations++;
+    }
+
+    struct chunk &c = this->chunks.back();
+    void *p = c.data + c.used;
+    c.used += nAligned;
+
+    return p;
+}
+
+/**
+ * Release all memory handed out by this arena. If more than
+ * one block was used, the blocks are replaced by a single block
+ * large enough to hold all of them.
+ */
+void ScratchArena::Reset() {
+    if (this->chunks.size() > 1) {
+        const size_t size = GetCapacity();
+        for (auto &c : this->chunks)
+            delete [] c.data;
+
+        this->chunks.clear();
+        this->chunks.push_back({new char[size], size, 0});
+        nHeapAllocations++;
+    } else if (this->chunks.size() == 1)
+        this->chunks[0].used = 0;
+}
+
+/**
+ * Returns the total number of bytes held by this arena.
+ */
+size_t ScratchArena::GetCapacity() const {
+    size_t s = 0;
+    for (auto &c : this->chunks)
+        s += c.size;
+    return s;
+}
@@ -1,13 +1,57 @@
 /**
  * Implementation of matrix invertor utilizing an iterative
- * Generalized Minimal Residual (GMRES) method with an LU preconditioner.
+ * Generalized Minimal Residual (GMRES) method.
+ *
+ * By default, GMRES is preconditioned with a block Jacobi
+ * preconditioner with one block per unknown quantity. Since this
+ * ignores all coupling between unknowns, the solver can alternatively
+ * be given a list of "splits", i.e. groups of unknowns, which are then
+ * used to build a PETSc field-split preconditioner. With two splits,
+ * the second split is coupled to the first through a Schur complement
+ * (approximated using the diagonal of the first block), which
+ * captures e.g. the strong coupling within the fluid "circuit"
+ * equations (E_field, psi_p, j_tot, T_cold, ...) when the kinetic
+ * equations are placed in the first split. Each split is solved with
+ * a single application of LU, ILU or algebraic multigrid.
+ *
+ * When the kinetic equations contain no radial transport, the kinetic
+ * blocks of the matrix are block diagonal in radius, and a kinetic
+ * split can then be solved exactly by factorizing the (much smaller)
+ * momentum-space block of each radius separately
+ * (SPLIT_SOLVER_RADIAL_LU). Whether the matrix really has this
+ * structure is verified the first time the system is solved.
+ *
+ * Fluid unknowns with several multiples (such as the ion densities,
+ * with one multiple per charge state) couple the multiples at each
+ * radius through small dense blocks (the ionization and recombination
+ * rates). A split of such unknowns can be preconditioned by inverting
+ * the dense block of each radius (SPLIT_SOLVER_RADIAL_DENSE). The rows
+ * of the split are then ordered by radius, so that the multiples of
+ * each radius are contiguous, and the blocks are inverted together by
+ * PETSc's variable-size point-block Jacobi preconditioner.
+ *
+ * For large momentum grids, the factorization of a kinetic split may
+ * instead be replaced by a geometric multigrid V-cycle
+ * (SPLIT_SOLVER_MG), which requires memory and time proportional to the
+ * number of cells. The momentum grid of each radius is coarsened by a
+ * factor of two along each coordinate which has sufficiently many cells,
+ * the unknowns are interpolated with (cell-centred) bilinear
+ * prolongation, and the coarse operators are formed by Galerkin
+ * projection (so that no equation terms need to be rediscretized on
+ * the coarse grids). Since the advection-diffusion operators in (p, xi)
+ * are strongly anisotropic, the smoother relaxes whole grid lines along
+ * p and/or xi at a time.
  */
 
+#include <cstdio>
 #include <petscksp.h>
 #include <petscvec.h>
 #include <vector>
 #include "FVM/config.h"
+#include "FVM/FVMException.hpp"
 #include "FVM/Matrix.hpp"
+#include "FVM/PETScBackend.hpp"
+#include "FVM/PetscLog.hpp"
 #include "FVM/UnknownQuantityHandler.hpp"
 #include "FVM/Solvers/MIGMRES.hpp"
 
@@ -17,15 +61,22 @@ using namespace std;
 /**
  * Constructor.
  *
- * n: Number of elements in solution vector.
+ * n:                   Number of elements in solution vector.
+ * nontrivial_unknowns: List of IDs of unknowns in the matrix (in order).
+ * unknowns:            List of unknowns in the equation system.
+ * converge:            Convergence test to use (or 'nullptr' for default).
+ * context:             Context to pass to the convergence test.
+ * splits:              Groups of unknowns to use for a field-split
+ *                      preconditioner. If fewer than two splits are given,
+ *                      a block Jacobi preconditioner is used instead.
  */
 MIGMRES::MIGMRES(
     const len_t n, vector<len_t>& nontrivial_unknowns,
     UnknownQuantityHandler *unknowns,
     PetscErrorCode (*converge)(KSP, PetscInt, PetscReal, KSPConvergedReason*, void*),
-    void *context
-) {
-    KSPCreate(PETSC_COMM_WORLD, &this->ksp);
+    void *context, const vector<struct split>& splits
+) : splits(splits) {
+    KSPCreate(PETSC_COMM_SELF, &this->ksp);
     this->xn = n;
 
     // Construct a vector indicating to PETSc how to
@@ -46,8 +97,12 @@ MIGMRES::MIGMRES(
     PC pc;
     KSPGetPC(ksp, &pc);
 
-    PCSetType(pc, PCBJACOBI);
-    PCBJacobiSetTotalBlocks(pc, this->nBlocks, this->blocks);
+    if (this->splits.size() >= 2)
+        this->ConfigureFieldSplit(nontrivial_unknowns, unknowns);
+    else {
+        PCSetType(pc, PCBJACOBI);
+        PCBJacobiSetTotalBlocks(pc, this->nBlocks, this->blocks);
+    }
 
     if (converge != nullptr)
         this->SetConvergenceTest(converge, context);
@@ -77,13 +132,535 @@ MIGMRES::~MIGMRES() {
  *    of size n at least.
  */
 void MIGMRES::Invert(Matrix *A, Vec *b, Vec *x) {
+    PetscLog::Event event("MIGMRES::Invert");
+
     KSPSetOperators(this->ksp, A->mat(), A->mat());
+    KSPSetType(this->ksp, KSPGMRES);
+
+    // The solvers of the individual splits can only be
+    // accessed once the preconditioner has been set up
+    if (!this->splits.empty() && !this->splitsConfigured) {
+        // Per-radius factorization is only exact if the kinetic
+        // split does not couple different radii
+        for (auto &s : this->splits) {
+            if (s.solver == SPLIT_SOLVER_RADIAL_LU && !IsRadiallyBlockDiagonal(A, s)) {
+                printf(
+                    "WARNING: GMRES: Split '%s' couples different radii. "
+                    "Using a single LU factorization for the split instead.\n",
+                    s.name.c_str()
+                );
+                s.solver = SPLIT_SOLVER_LU;
+            }
+        }
+
+        KSPSetUp(this->ksp);
+        this->ConfigureSplitSolvers();
+    } else if (this->splits.empty() && PETScBackend::IsGPU() && !this->blocksConfigured) {
+        KSPSetUp(this->ksp);
+        this->ConfigureBlockSolvers();
+    }
 
     // Solve
-    KSPSetType(this->ksp, KSPGMRES);
     KSPSolve(this->ksp, *b, *x);
 }
 
+/**
+ * Set up the field-split preconditioner, defining one split (index
+ * set) per group of unknowns.
+ *
+ * nontrivial_unknowns: List of IDs of unknowns in the matrix (in order).
+ * unknowns:            List of unknowns in the equation system.
+ */
+void MIGMRES::ConfigureFieldSplit(
+    vector<len_t>& nontrivial_unknowns, UnknownQuantityHandler *unknowns
+) {
+    PC pc;
+    KSPGetPC(this->ksp, &pc);
+    PCSetType(pc, PCFIELDSPLIT);
+
+    for (auto &s : this->splits) {
+        vector<PetscInt>& idx = s.rows;
+        idx.clear();
+        s.radialBlocks.clear();
+        s.radialNp1.clear();
+
+        vector<PetscInt> offsets;
+        for (len_t id : s.unknowns) {
+            // Locate the unknown in the matrix
+            PetscInt offset = 0;
+            bool found = false;
+            for (len_t i = 0; i < this->nBlocks; i++) {
+                if (nontrivial_unknowns[i] == id) {
+                    found = true;
+                    break;
+                }
+                offset += this->blocks[i];
+            }
+
+            if (!found)
+                throw FVMException(
+                    "GMRES: Unknown '%s' in field split '%s' is not part of the equation system matrix.",
+                    unknowns->GetUnknown(id)->GetName().c_str(), s.name.c_str()
+                );
+
+            offsets.push_back(offset);
+
+            const PetscInt nel = unknowns->GetUnknown(id)->NumberOfElements();
+            for (PetscInt j = 0; j < nel; j++)
+                idx.push_back(offset+j);
+
+            // Size of the block of each radius (elements are
+            // ordered with radius as the slowest index)
+            UnknownQuantity *uqn = unknowns->GetUnknown(id);
+            Grid *g = uqn->GetGrid();
+            const len_t nMultiples = uqn->NumberOfMultiples();
+            for (len_t k = 0; k < nMultiples; k++) {
+                for (len_t ir = 0; ir < g->GetNr(); ir++) {
+                    s.radialBlocks.push_back(g->GetMomentumGrid(ir)->GetNCells());
+                    s.radialNp1.push_back(g->GetMomentumGrid(ir)->GetNp1());
+                }
+            }
+        }
+
+        if (s.solver == SPLIT_SOLVER_RADIAL_DENSE)
+            this->OrderByRadius(s, offsets, unknowns);
+
+        IS is;
+        ISCreateGeneral(PETSC_COMM_SELF, idx.size(), idx.data(), PETSC_COPY_VALUES, &is);
+        PCFieldSplitSetIS(pc, s.name.c_str(), is);
+        // (the preconditioner keeps its own reference to the index set)
+        ISDestroy(&is);
+    }
+
+    if (this->splits.size() == 2) {
+        PCFieldSplitSetType(pc, PC_COMPOSITE_SCHUR);
+        PCFieldSplitSetSchurFactType(pc, PC_FIELDSPLIT_SCHUR_FACT_FULL);
+        // Precondition the Schur complement using an explicitly assembled
+        // approximation (A11 - A10 diag(A00)^-1 A01), so that it can be
+        // factorized with LU
+        PCFieldSplitSetSchurPre(pc, PC_FIELDSPLIT_SCHUR_PRE_SELFP, nullptr);
+    } else
+        PCFieldSplitSetType(pc, PC_COMPOSITE_MULTIPLICATIVE);
+}
+
+/**
+ * Order the rows of the given split by radius, so that all multiples
+ * of all unknowns of the split at one radius form one (dense) block.
+ * Only fluid unknowns (with one element per radius and multiple) can
+ * be ordered in this way.
+ *
+ * s:        Split to order.
+ * offsets:  Index of the first row of each unknown of the split in
+ *           the matrix.
+ * unknowns: List of unknowns in the equation system.
+ */
+void MIGMRES::OrderByRadius(
+    struct split& s, const vector<PetscInt>& offsets, UnknownQuantityHandler *unknowns
+) {
+    const len_t nr = unknowns->GetUnknown(s.unknowns[0])->GetGrid()->GetNr();
+    for (len_t id : s.unknowns) {
+        Grid *g = unknowns->GetUnknown(id)->GetGrid();
+        if (g->GetNr() != nr || g->GetNCells() != nr)
+            throw FVMException(
+                "GMRES: Unknown '%s' in field split '%s' is not a fluid quantity on the "
+                "same radial grid as the other unknowns of the split.",
+                unknowns->GetUnknown(id)->GetName().c_str(), s.name.c_str()
+            );
+    }
+
+    s.rows.clear();
+    s.radialBlocks.assign(nr, 0);
+    s.radialNp1.clear();
+    for (len_t ir = 0; ir < nr; ir++) {
+        for (len_t i = 0; i < s.unknowns.size(); i++) {
+            const len_t nMultiples = unknowns->GetUnknown(s.unknowns[i])->NumberOfMultiples();
+            for (len_t k = 0; k < nMultiples; k++)
+                s.rows.push_back(offsets[i] + (PetscInt)(k*nr + ir));
+
+            s.radialBlocks[ir] += nMultiples;
+        }
+    }
+}
+
+/**
+ * Select the solver to use in each split of the field-split
+ * preconditioner.
+ */
+void MIGMRES::ConfigureSplitSolvers() {
+    PC pc;
+    KSPGetPC(this->ksp, &pc);
+
+    PetscInt n;
+    KSP *subksp;
+    PCFieldSplitGetSubKSP(pc, &n, &subksp);
+
+    for (PetscInt i = 0; i < n && i < (PetscInt)this->splits.size(); i++) {
+        PC subpc;
+        KSPSetType(subksp[i], KSPPREONLY);
+        KSPGetPC(subksp[i], &subpc);
+
+        switch (this->splits[i].solver) {
+            case SPLIT_SOLVER_LU: PCSetType(subpc, PCLU); break;
+            case SPLIT_SOLVER_ILU: PCSetType(subpc, PCILU); break;
+            case SPLIT_SOLVER_GAMG: PCSetType(subpc, PCGAMG); break;
+            case SPLIT_SOLVER_RADIAL_LU:
+                ConfigureRadialBlocks(subksp[i], this->splits[i]);
+                continue;
+            case SPLIT_SOLVER_RADIAL_DENSE:
+                ConfigureDenseBlocks(subksp[i], this->splits[i]);
+                continue;
+            case SPLIT_SOLVER_MG:
+                ConfigureMultigrid(subksp[i], this->splits[i]);
+                continue;
+        }
+
+        PETScBackend::SetFactorSolverType(subpc);
+    }
+
+    PetscFree(subksp);
+    this->splitsConfigured = true;
+}
+
+/**
+ * Configure the solver of the given split to factorize the block
+ * of each radius separately, using a block Jacobi preconditioner
+ * with one block per radius and an LU factorization in each block.
+ *
+ * subksp: Solver of the split.
+ * s:      Split to configure.
+ */
+void MIGMRES::ConfigureRadialBlocks(KSP subksp, struct split& s) {
+    PC subpc;
+    KSPGetPC(subksp, &subpc);
+    PCSetType(subpc, PCBJACOBI);
+    PCBJacobiSetTotalBlocks(subpc, s.radialBlocks.size(), s.radialBlocks.data());
+
+    // The block solvers can only be accessed once the
+    // block Jacobi preconditioner has been set up
+    KSPSetUp(subksp);
+
+    PetscInt n;
+    KSP *blockksp;
+    PCBJacobiGetSubKSP(subpc, &n, nullptr, &blockksp);
+
+    for (PetscInt i = 0; i < n; i++) {
+        PC blockpc;
+        KSPSetType(blockksp[i], KSPPREONLY);
+        KSPGetPC(blockksp[i], &blockpc);
+        PCSetType(blockpc, PCLU);
+        PETScBackend::SetFactorSolverType(blockpc);
+    }
+}
+
+/**
+ * Configure the solver of the given split to apply the inverse of the
+ * dense block of each radius, using PETSc's variable-size point-block
+ * Jacobi preconditioner. The blocks are inverted directly (without
+ * creating one sub-solver per block as with 'ConfigureRadialBlocks()'),
+ * which is much cheaper for the many small blocks of fluid unknowns.
+ * The preconditioner is exact if the split does not couple different
+ * radii (e.g. the ion densities without radial transport).
+ *
+ * subksp: Solver of the split.
+ * s:      Split to configure (with rows ordered by radius).
+ */
+void MIGMRES::ConfigureDenseBlocks(KSP subksp, struct split& s) {
+    // (the operator of the split is only available once
+    // the field-split preconditioner has been set up)
+    Mat Amat, Pmat;
+    KSPGetOperators(subksp, &Amat, &Pmat);
+    MatSetVariableBlockSizes(Pmat, (PetscInt)s.radialBlocks.size(), s.radialBlocks.data());
+
+    PC subpc;
+    KSPGetPC(subksp, &subpc);
+    PCSetType(subpc, PCVPBJACOBI);
+}
+
+/**
+ * Configure the solver of the given split to apply one V-cycle of
+ * geometric multigrid, using the momentum grids of the split (see the
+ * comment at the top of this file). Coarsening stops once no momentum
+ * grid can be coarsened further (or after 'MG_MAX_LEVELS' levels), and
+ * the coarsest level is solved with LU.
+ *
+ * subksp: Solver of the split.
+ * s:      Split to configure.
+ */
+void MIGMRES::ConfigureMultigrid(KSP subksp, struct split& s) {
+    // Number of cells along p and xi in each (radial) block
+    // of each level, from the finest to the coarsest level
+    vector<vector<PetscInt>> n1 = {s.radialNp1}, n2(1);
+    for (len_t b = 0; b < s.radialBlocks.size(); b++)
+        n2[0].push_back(s.radialBlocks[b] / s.radialNp1[b]);
+
+    auto coarsen = [](const PetscInt n) { return (n >= MG_MIN_COARSEN ? (n+1)/2 : n); };
+    while (n1.size() < MG_MAX_LEVELS) {
+        vector<PetscInt> c1, c2;
+        bool coarsened = false;
+        for (len_t b = 0; b < n1.back().size(); b++) {
+            c1.push_back(coarsen(n1.back()[b]));
+            c2.push_back(coarsen(n2.back()[b]));
+            coarsened = coarsened || (c1[b] != n1.back()[b] || c2[b] != n2.back()[b]);
+        }
+
+        if (!coarsened)
+            break;
+
+        n1.push_back(c1);
+        n2.push_back(c2);
+    }
+
+    const PetscInt nlevels = n1.size();
+
+    PC subpc;
+    KSPSetType(subksp, KSPPREONLY);
+    KSPGetPC(subksp, &subpc);
+    PCSetType(subpc, PCMG);
+    PCMGSetLevels(subpc, nlevels, nullptr);
+    PCMGSetType(subpc, PC_MG_MULTIPLICATIVE);
+    PCMGSetCycleType(subpc, PC_MG_CYCLE_V);
+    PCMGSetGalerkin(subpc, PC_MG_GALERKIN_BOTH);
+    PCMGSetNumberSmooth(subpc, 2);
+
+    // (PETSc numbers the levels from the coarsest (0) to the
+    // finest, while 'n1' and 'n2' start from the finest level)
+    for (PetscInt l = 1; l < nlevels; l++) {
+        const len_t k = nlevels-1-l;
+
+        Mat P = CreateProlongation(n1[k], n2[k], n1[k+1], n2[k+1]);
+        PCMGSetInterpolation(subpc, l, P);
+        // (the preconditioner keeps its own reference to the matrix)
+        MatDestroy(&P);
+
+        KSP smoother;
+        PCMGGetSmoother(subpc, l, &smoother);
+        ConfigureLineSmoother(smoother, n1[k], n2[k], s.mgLines);
+    }
+
+    KSP coarse;
+    PC coarsepc;
+    PCMGGetCoarseSolve(subpc, &coarse);
+    KSPSetType(coarse, KSPPREONLY);
+    KSPGetPC(coarse, &coarsepc);
+    PCSetType(coarsepc, PCLU);
+    PETScBackend::SetFactorSolverType(coarsepc);
+}
+
+/**
+ * Configure the given multigrid smoother to relax grid lines in
+ * momentum space, using an additive Schwarz preconditioner without
+ * overlap in which every line forms one subdomain. The subdomains are
+ * relaxed one after another (line Gauss-Seidel). Restricted to a line,
+ * the operator is tridiagonal (on all levels, with the 3x3 stencils of
+ * the fine operator and of the Galerkin coarse operators), so that the
+ * default ILU(0) solver of each subdomain solves the line exactly.
+ *
+ * smoother: Smoother to configure.
+ * n1:       Number of cells along p in each block of the level.
+ * n2:       Number of cells along xi in each block of the level.
+ * lines:    Lines to relax.
+ */
+void MIGMRES::ConfigureLineSmoother(
+    KSP smoother, const vector<PetscInt>& n1, const vector<PetscInt>& n2,
+    enum mg_lines lines
+) {
+    PC pc;
+    KSPSetType(smoother, KSPRICHARDSON);
+    KSPGetPC(smoother, &pc);
+    PCSetType(pc, PCASM);
+    PCASMSetOverlap(pc, 0);
+    PCASMSetLocalType(pc, PC_COMPOSITE_MULTIPLICATIVE);
+
+    vector<IS> is;
+    PetscInt offset = 0;
+    for (len_t b = 0; b < n1.size(); b++) {
+        bool pLines  = (lines != MG_LINES_XI);
+        bool xiLines = (lines != MG_LINES_P);
+
+        // Lines of a single cell are covered by the other direction
+        if (pLines && xiLines) {
+            if (n2[b] == 1) xiLines = false;
+            else if (n1[b] == 1) pLines = false;
+        }
+
+        // (cells are ordered with p as the fastest index)
+        if (pLines) {
+            for (PetscInt j = 0; j < n2[b]; j++) {
+                IS line;
+                ISCreateStride(PETSC_COMM_SELF, n1[b], offset + j*n1[b], 1, &line);
+                is.push_back(line);
+            }
+        }
+        if (xiLines) {
+            for (PetscInt i = 0; i < n1[b]; i++) {
+                IS line;
+                ISCreateStride(PETSC_COMM_SELF, n2[b], offset + i, n1[b], &line);
+                is.push_back(line);
+            }
+        }
+
+        offset += n1[b]*n2[b];
+    }
+
+    PCASMSetLocalSubdomains(pc, (PetscInt)is.size(), is.data(), nullptr);
+    // (the preconditioner keeps its own references to the index sets)
+    for (IS &line : is)
+        ISDestroy(&line);
+}
+
+/**
+ * Create the prolongation matrix interpolating the unknowns from
+ * one multigrid level to the next finer level. Each (radial) block
+ * is interpolated separately, using cell-centred bilinear
+ * interpolation along the coordinates which were coarsened.
+ *
+ * n1f, n2f: Number of cells along p and xi in each block on the fine level.
+ * n1c, n2c: Number of cells along p and xi in each block on the coarse level.
+ */
+Mat MIGMRES::CreateProlongation(
+    const vector<PetscInt>& n1f, const vector<PetscInt>& n2f,
+    const vector<PetscInt>& n1c, const vector<PetscInt>& n2c
+) {
+    PetscInt mf = 0, mc = 0;
+    for (len_t b = 0; b < n1f.size(); b++) {
+        mf += n1f[b]*n2f[b];
+        mc += n1c[b]*n2c[b];
+    }
+
+    Mat P;
+    PETScBackend::CreateMatrix(mf, mc, 4, nullptr, &P);
+
+    // Coarse cells (and weights) from which fine cell 'i' is
+    // interpolated along one coordinate. A fine cell lies a quarter
+    // of a coarse cell from the centre of its parent cell.
+    auto interp1D = [](
+        const PetscInt i, const PetscInt nf, const PetscInt nc,
+        PetscInt idx[2], PetscScalar w[2]
+    ) {
+        if (nf == nc) {
+            idx[0] = i; w[0] = 1;
+            return 1;
+        }
+
+        const PetscInt I = i/2;
+        const PetscInt J = (i%2 == 0 ? I-1 : I+1);
+        if (J < 0 || J >= nc) {
+            idx[0] = I; w[0] = 1;
+            return 1;
+        }
+
+        idx[0] = I; w[0] = 0.75;
+        idx[1] = J; w[1] = 0.25;
+        return 2;
+    };
+
+    PetscInt of = 0, oc = 0;
+    for (len_t b = 0; b < n1f.size(); b++) {
+        for (PetscInt j = 0; j < n2f[b]; j++) {
+            PetscInt jdx[2];
+            PetscScalar wj[2];
+            const int nj = interp1D(j, n2f[b], n2c[b], jdx, wj);
+
+            for (PetscInt i = 0; i < n1f[b]; i++) {
+                PetscInt idx[2];
+                PetscScalar wi[2];
+                const int ni = interp1D(i, n1f[b], n1c[b], idx, wi);
+
+                PetscInt row = of + j*n1f[b] + i, cols[4];
+                PetscScalar vals[4];
+                PetscInt n = 0;
+                for (int q = 0; q < nj; q++) {
+                    for (int p = 0; p < ni; p++, n++) {
+                        cols[n] = oc + jdx[q]*n1c[b] + idx[p];
+                        vals[n] = wj[q]*wi[p];
+                    }
+                }
+
+                MatSetValues(P, 1, &row, n, cols, vals, INSERT_VALUES);
+            }
+        }
+
+        of += n1f[b]*n2f[b];
+        oc += n1c[b]*n2c[b];
+    }
+
+    MatAssemblyBegin(P, MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(P, MAT_FINAL_ASSEMBLY);
+
+    return P;
+}
+
+/**
+ * Check whether the rows of the given split only couple to other
+ * rows of the split belonging to the same radius, i.e. whether
+ * the diagonal block of the split is block diagonal in radius.
+ *
+ * A: Matrix to check.
+ * s: Split to check.
+ */
+bool MIGMRES::IsRadiallyBlockDiagonal(Matrix *A, const struct split& s) {
+    // Radial block of each row in the split (-1 if not in split)
+    vector<PetscInt> block(this->xn, -1);
+    len_t k = 0;
+    for (len_t b = 0; b < s.radialBlocks.size(); b++)
+        for (PetscInt j = 0; j < s.radialBlocks[b]; j++, k++)
+            block[s.rows[k]] = b;
+
+    bool diagonal = true;
+    for (len_t i = 0; i < s.rows.size() && diagonal; i++) {
+        const PetscInt row = s.rows[i];
+
+        PetscInt ncols;
+        const PetscInt *cols;
+        MatGetRow(A->mat(), row, &ncols, &cols, nullptr);
+
+        for (PetscInt j = 0; j < ncols; j++) {
+            if (block[cols[j]] >= 0 && block[cols[j]] != block[row]) {
+                diagonal = false;
+                break;
+            }
+        }
+
+        MatRestoreRow(A->mat(), row, &ncols, &cols, nullptr);
+    }
+
+    return diagonal;
+}
+
+/**
+ * When running on a GPU, make the (ILU) solvers of the blocks of
+ * the block Jacobi preconditioner factorize and solve on the
+ * device, so that the vectors need not be copied to the host in
+ * every GMRES iteration.
+ */
+void MIGMRES::ConfigureBlockSolvers() {
+    PC pc;
+    KSPGetPC(this->ksp, &pc);
+
+    PetscInt n;
+    KSP *subksp;
+    PCBJacobiGetSubKSP(pc, &n, nullptr, &subksp);
+
+    for (PetscInt i = 0; i < n; i++) {
+        PC subpc;
+        KSPGetPC(subksp[i], &subpc);
+        PCSetType(subpc, PCILU);
+        PETScBackend::SetFactorSolverType(subpc);
+    }
+
+    this->blocksConfigured = true;
+}
+
+/**
+ * Set the relative tolerance of the GMRES solver, i.e. the required
+ * reduction of the (preconditioned) residual norm. The absolute and
+ * divergence tolerances, and the maximum number of iterations, are
+ * left unchanged.
+ */
+void MIGMRES::SetRelativeTolerance(const real_t rtol) {
+    KSPSetTolerances(this->ksp, rtol, PETSC_DEFAULT, PETSC_DEFAULT, PETSC_DEFAULT);
+}
+
 /*
  * Set the function to use for checking if the
  * solution is converged.
@@ -6,6 +6,8 @@
 #include <petscvec.h>
 #include "FVM/config.h"
 #include "FVM/Matrix.hpp"
+#include "FVM/PETScBackend.hpp"
+#include "FVM/PetscLog.hpp"
 #include "FVM/Solvers/MILU.hpp"
 
 using namespace DREAM::FVM;
@@ -16,7 +18,7 @@ using namespace DREAM::FVM;
  * n: Number of elements in solution vector.
  */
 MILU::MILU(const len_t n) {
-    KSPCreate(PETSC_COMM_WORLD, &this->ksp);
+    KSPCreate(PETSC_COMM_SELF, &this->ksp);
     this->xn = n;
 }
 
@@ -42,14 +44,29 @@ MILU::~MILU() {
  */
 void MILU::Invert(Matrix *A, Vec *b, Vec *x) {
     PC pc;
+    PetscLog::Event event("MILU::Invert");
 
     KSPSetOperators(this->ksp, A->mat(), A->mat());
     
     // Set direct LU factorization
     KSPGetPC(this->ksp, &pc);
     PCSetType(pc, PCLU);
+    PETScBackend::SetFactorSolverType(pc);
     KSPSetType(this->ksp, KSPPREONLY);
 
+    // Keep the ordering (and fill estimate) from the first
+    // factorization. PETSc then only redoes the numeric
+    // factorization as long as the non-zero pattern of the
+    // matrix is unchanged, and recomputes only the fill
+    // pattern if it changes.
+    if (this->reuseSymbolic) {
+        PCFactorSetReuseOrdering(pc, PETSC_TRUE);
+        PCFactorSetReuseFill(pc, PETSC_TRUE);
+    }
+
+    if (!this->factorOrdering.empty())
+        PCFactorSetMatOrderingType(pc, this->factorOrdering.c_str());
+
     // Solve
     this->errorcode = KSPSolve(this->ksp, *b, *x);
 }
@@ -8,6 +8,7 @@
 #include <petscvec.h>
 #include "FVM/config.h"
 #include "FVM/Matrix.hpp"
+#include "FVM/PetscLog.hpp"
 #include "FVM/Solvers/MIMKL.hpp"
 
 
@@ -21,7 +22,7 @@ using namespace DREAM::FVM;
 MIMKL::MIMKL(const len_t n, bool verbose) {
     this->verbose = verbose;
 
-    KSPCreate(PETSC_COMM_WORLD, &this->ksp);
+    KSPCreate(PETSC_COMM_SELF, &this->ksp);
     this->xn = n;
 }
 
@@ -52,6 +53,7 @@ MIMKL::~MIMKL() {
 void MIMKL::Invert(Matrix *A, Vec *b, Vec *x) {
     Mat F;
     PC pc;
+    PetscLog::Event event("MIMKL::Invert");
 
     KSPSetOperators(this->ksp, A->mat(), A->mat());
     
@@ -6,6 +6,7 @@
 #include <petscvec.h>
 #include "FVM/config.h"
 #include "FVM/Matrix.hpp"
+#include "FVM/PetscLog.hpp"
 #include "FVM/Solvers/MIMUMPS.hpp"
 
 using namespace DREAM::FVM;
@@ -16,7 +17,7 @@ using namespace DREAM::FVM;
  * n: Number of elements in solution vector.
  */
 MIMUMPS::MIMUMPS(const len_t n) {
-    KSPCreate(PETSC_COMM_WORLD, &this->ksp);
+    KSPCreate(PETSC_COMM_SELF, &this->ksp);
     this->xn = n;
 }
 
@@ -47,6 +48,7 @@ MIMUMPS::~MIMUMPS() {
 void MIMUMPS::Invert(Matrix *A, Vec *b, Vec *x) {
     PC pc;
     Mat F;
+    PetscLog::Event event("MIMUMPS::Invert");
 
     KSPSetOperators(this->ksp, A->mat(), A->mat());
     
@@ -57,6 +59,26 @@ void MIMUMPS::Invert(Matrix *A, Vec *b, Vec *x) {
     //PCFactorSetUpMatSolverType(pc);
     KSPSetType(this->ksp, KSPPREONLY);
 
+    // Keep the ordering (and fill estimate) from the first
+    // factorization. PETSc then only redoes the numeric
+    // factorization as long as the non-zero pattern of the
+    // matrix is unchanged, and recomputes only the fill
+    // pattern if it changes.
+    if (this->reuseSymbolic) {
+        PCFactorSetReuseOrdering(pc, PETSC_TRUE);
+        PCFactorSetReuseFill(pc, PETSC_TRUE);
+    }
+
+    // MUMPS normally computes its own ordering during the analysis
+    // phase, but can be told to use the PETSc ordering instead
+    // (ICNTL(7) = 1)
+    if (!this->factorOrdering.empty()) {
+        PCFactorSetMatOrderingType(pc, this->factorOrdering.c_str());
+        PCFactorSetUpMatSolverType(pc);
+        PCFactorGetMatrix(pc, &F);
+        MatMumpsSetIcntl(F, 7, 1);
+    }
+
     // Solve
     KSPSolve(this->ksp, *b, *x);
 
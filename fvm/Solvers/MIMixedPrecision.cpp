@@ -0,0 +1,114 @@
+/**
+ * Implementation of a mixed-precision matrix invertor, which factorizes
+ * the matrix to a reduced accuracy and recovers full (double precision)
+ * accuracy of the solution through iterative refinement, or through
+ * GMRES preconditioned by the low-precision factorization.
+ *
+ * Since PETSc is compiled for a single floating-point type, the
+ * low-precision factorization is computed with the block low-rank
+ * (BLR) compression of MUMPS, with the compression tolerance set to
+ * roughly single-precision accuracy (1e-7 by default). This reduces the
+ * memory and time required for factorization in the same way as a
+ * single-precision factorization would (and, for the large kinetic
+ * jacobians, usually substantially more), while the residuals of the
+ * refinement iterations are evaluated in double precision using the
+ * original matrix.
+ *
+ * If the refinement does not converge, the return code of the inverter
+ * is set so that the solver can switch to its backup inverter.
+ */
+
+#include <petscvec.h>
+#include "FVM/config.h"
+#include "FVM/Matrix.hpp"
+#include "FVM/PetscLog.hpp"
+#include "FVM/Solvers/MIMixedPrecision.hpp"
+
+using namespace DREAM::FVM;
+
+/**
+ * Constructor.
+ *
+ * n:    Number of elements in solution vector.
+ * opts: Options for the factorization and refinement.
+ */
+MIMixedPrecision::MIMixedPrecision(const len_t n, const struct options& opts)
+    : opts(opts), xn(n) {
+
+    KSPCreate(PETSC_COMM_SELF, &this->ksp);
+}
+
+/**
+ * Destructor.
+ */
+MIMixedPrecision::~MIMixedPrecision() {
+    KSPDestroy(&this->ksp);
+}
+
+/**
+ * Solves the linear equation system represented by
+ *
+ *   Ax = b
+ *
+ * where A is a matrix, and b and x are vectors. A
+ * pointer is returned to the solution, x.
+ *
+ * A: Matrix of size m-by-n representing the linear system.
+ * b: Right-hand-side vector containing n elements.
+ * x: Solution vector. Contains solution on return. Must be
+ *    of size n at least.
+ */
+#ifdef PETSC_HAVE_MUMPS
+void MIMixedPrecision::Invert(Matrix *A, Vec *b, Vec *x) {
+    PC pc;
+    Mat F;
+    PetscLog::Event event("MIMixedPrecision::Invert");
+
+    KSPSetOperators(this->ksp, A->mat(), A->mat());
+
+    // Low-precision LU factorization as preconditioner
+    KSPGetPC(this->ksp, &pc);
+    PCSetType(pc, PCLU);
+    PCFactorSetMatSolverType(pc, MATSOLVERMUMPS);
+    PCFactorSetUpMatSolverType(pc);
+    PCFactorGetMatrix(pc, &F);
+
+    // Enable BLR compression of the factors, with
+    // the requested accuracy
+    MatMumpsSetIcntl(F, 35, 2);
+    MatMumpsSetCntl(F, 7, this->opts.factortol);
+    // Disable the internal iterative refinement of MUMPS
+    // (refinement is done by the outer iteration instead)
+    MatMumpsSetIcntl(F, 10, 0);
+
+    if (this->reuseSymbolic) {
+        PCFactorSetReuseOrdering(pc, PETSC_TRUE);
+        PCFactorSetReuseFill(pc, PETSC_TRUE);
+    }
+
+    // Refinement iteration in double precision
+    if (this->opts.method == REFINEMENT_METHOD_GMRES)
+        KSPSetType(this->ksp, KSPGMRES);
+    else
+        KSPSetType(this->ksp, KSPRICHARDSON);
+
+    KSPSetTolerances(
+        this->ksp, this->opts.reltol, PETSC_DEFAULT,
+        PETSC_DEFAULT, this->opts.maxiter
+    );
+
+    // Solve
+    this->errorcode = KSPSolve(this->ksp, *b, *x);
+
+    if (this->errorcode == 0) {
+        KSPConvergedReason reason;
+        KSPGetConvergedReason(this->ksp, &reason);
+
+        // Signal failure so that the backup inverter is used
+        if (reason < 0)
+            this->errorcode = reason;
+    }
+#else
+void MIMixedPrecision::Invert(Matrix*, Vec*, Vec*) {
+#endif
+}
@@ -7,6 +7,7 @@
 #include <petscvec.h>
 #include "FVM/config.h"
 #include "FVM/Matrix.hpp"
+#include "FVM/PetscLog.hpp"
 #include "FVM/Solvers/MISuperLU.hpp"
 
 
@@ -18,7 +19,7 @@ using namespace DREAM::FVM;
  * n: Number of elements in solution vector.
  */
 MISuperLU::MISuperLU(const len_t n) {
-    KSPCreate(PETSC_COMM_WORLD, &this->ksp);
+    KSPCreate(PETSC_COMM_SELF, &this->ksp);
     this->xn = n;
 }
 
@@ -47,6 +48,7 @@ MISuperLU::~MISuperLU() {
  */
 void MISuperLU::Invert(Matrix *A, Vec *b, Vec *x) {
     PC pc;
+    PetscLog::Event event("MISuperLU::Invert");
 
     KSPSetOperators(this->ksp, A->mat(), A->mat());
     
@@ -0,0 +1,170 @@
+/**
+ * The TermTimings class attributes the cost of assembling the equation
+ * system to the individual equation terms. For every call to the
+ * 'Rebuild()', 'SetJacobianBlock()', 'SetMatrixElements()' and
+ * 'SetVectorElements()' methods of a term made by an 'Operator', the
+ * time spent is accumulated under the name of the term. Since the same
+ * term may appear in several equations, all terms with the same name
+ * are aggregated.
+ *
+ * The time recorded for a term excludes the time spent in any terms
+ * nested inside of it (such as the advection and diffusion terms making
+ * up an 'AdvectionDiffusionTerm'), so that the sum over all terms
+ * equals the total time spent in the terms.
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include "FVM/TermTimings.hpp"
+
+
+using namespace DREAM::FVM;
+using namespace std;
+
+
+/**
+ * Enable or disable term timing and clear all previously
+ * recorded statistics.
+ *
+ * enable: If true, enables term timing.
+ */
+void TermTimings::Configure(const bool enable) {
+    lock_guard<mutex> lock(mtx);
+
+    TermTimings::enabled = enable;
+    TermTimings::summaries.clear();
+}
+
+/**
+ * Returns the current time in nanoseconds.
+ */
+int64_t TermTimings::Now() {
+    return chrono::duration_cast<chrono::nanoseconds>(
+        chrono::steady_clock::now().time_since_epoch()
+    ).count();
+}
+
+/**
+ * Start timing a call to the named term on the calling thread.
+ *
+ * name: Name of the term.
+ * p:    Part of the assembly which is timed.
+ */
+void TermTimings::Begin(const string& name, const enum phase p) {
+    termStack.push_back({name, p, Now(), 0});
+}
+
+/**
+ * Stop timing the most recently started term on the
+ * calling thread.
+ */
+void TermTimings::End() {
+    if (termStack.empty())
+        return;
+
+    const int64_t duration = Now() - termStack.back().start;
+    struct frame f = std::move(termStack.back());
+    termStack.pop_back();
+
+    if (!termStack.empty())
+        termStack.back().children += duration;
+
+    lock_guard<mutex> lock(mtx);
+
+    struct summary& s = TermTimings::summaries[f.name];
+    s.count[f.ph]++;
+    s.time[f.ph] += duration - f.children;
+}
+
+/**
+ * Print a table of the 'n' terms in which the most time
+ * was spent.
+ *
+ * n: Maximum number of terms to print.
+ */
+void TermTimings::PrintSummary(const len_t n) {
+    lock_guard<mutex> lock(mtx);
+
+    vector<pair<string, int64_t>> totals;
+    int64_t sum = 0;
+    for (auto it = summaries.begin(); it != summaries.end(); it++) {
+        int64_t t = 0;
+        for (len_t i = 0; i < N_PHASES; i++)
+            t += it->second.time[i];
+
+        totals.push_back({it->first, t});
+        sum += t;
+    }
+
+    sort(totals.begin(), totals.end(),
+        [](const pair<string, int64_t>& a, const pair<string, int64_t>& b) {
+            return a.second > b.second;
+        }
+    );
+
+    int maxlen = 4;
+    for (len_t i = 0; i < totals.size() && i < n; i++)
+        maxlen = max(static_cast<int>(totals[i].first.length()), maxlen);
+
+    printf("[Timing for equation terms]\n");
+    printf(
+        "  %-*s  %10s  %10s  %10s  %10s  %10s  %6s\n", maxlen, "Term",
+        "rebuild", "jacobian", "matrix", "vector", "total", "share"
+    );
+
+    for (len_t i = 0; i < totals.size() && i < n; i++) {
+        const struct summary& s = summaries[totals[i].first];
+
+        printf("  %-*s", maxlen, totals[i].first.c_str());
+        for (len_t j = 0; j < N_PHASES; j++)
+            printf("  %8.2f ms", s.time[j]*1e-6);
+        printf("  %8.2f ms  %5.1f%%\n", totals[i].second*1e-6, (sum>0 ? 100.0*totals[i].second/sum : 0.0));
+    }
+}
+
+/**
+ * Save the accumulated term timings to the given SFile object.
+ * The names of the terms are stored as a ';'-separated list,
+ * together with the time spent in each part of the assembly (in
+ * microseconds) and the total number of calls made to each term.
+ *
+ * sf:   SFile object to save timings to.
+ * path: Path in SFile object to save timings to.
+ */
+void TermTimings::SaveSummary(SFile *sf, const string& path) {
+    lock_guard<mutex> lock(mtx);
+
+    const char *phaseNames[N_PHASES] = {"rebuild", "jacobian", "matrix", "vector"};
+    const char *phaseDescs[N_PHASES] = {
+        "Time spent rebuilding term (microseconds)",
+        "Time spent setting jacobian elements (microseconds)",
+        "Time spent setting linear operator matrix elements (microseconds)",
+        "Time spent evaluating term (microseconds)"
+    };
+
+    const len_t n = summaries.size();
+    string names;
+    real_t *count = new real_t[n];
+    real_t *times = new real_t[N_PHASES*n];
+
+    len_t i = 0;
+    for (auto it = summaries.begin(); it != summaries.end(); it++, i++) {
+        names += it->first + ";";
+        count[i] = 0;
+        for (len_t j = 0; j < N_PHASES; j++) {
+            count[i] += it->second.count[j];
+            times[j*n + i] = it->second.time[j] * 1e-3;
+        }
+    }
+
+    sf->CreateStruct(path);
+    sf->WriteString(path+"/names", names);
+    sf->WriteList(path+"/count", count, n);
+    for (len_t j = 0; j < N_PHASES; j++) {
+        sf->WriteList(path+"/"+phaseNames[j], times+j*n, n);
+        sf->WriteAttribute_string(path+"/"+phaseNames[j], "desc", phaseDescs[j]);
+    }
+
+    delete [] times;
+    delete [] count;
+}
@@ -2,10 +2,16 @@
  * The TimeKeeper class keeps a number of DurationTimer's which can be started
  * and stopped during a simulation. In the end, the timing information can be
  * printed in a formatted way, and stored to an SFile object.
+ *
+ * When tracing is enabled (see 'Tracer'), every timer also opens a scope
+ * in the trace while it is running. When hardware performance counters
+ * are enabled (see 'PerfCounters'), the events counted while each timer
+ * is running are accumulated alongside the time.
  */
 
 #include <softlib/SFile.h>
 #include "FVM/TimeKeeper.hpp"
+#include "FVM/Tracer.hpp"
 
 
 using namespace DREAM::FVM;
@@ -37,7 +43,7 @@ TimeKeeper::~TimeKeeper() {
  * RETURNS the ID of the new timer.
  */
 len_t TimeKeeper::AddTimer(const string& shortname, const string& longname) {
-    timers.push_back(new (struct tk){new DurationTimer(), longname, shortname});
+    timers.push_back(new (struct tk){new DurationTimer(), longname, shortname, 0, {}, {}});
     return timers.size()-1;
 }
 
@@ -48,6 +54,7 @@ len_t TimeKeeper::AddTimer(const string& shortname, const string& longname) {
  */
 void TimeKeeper::ResetTimer(const len_t timer) {
     timers[timer]->timer->Reset();
+    timers[timer]->counterAccum = PerfCounters::values();
 }
 
 /**
@@ -56,6 +63,11 @@ void TimeKeeper::ResetTimer(const len_t timer) {
  * timer: ID of timer to start.
  */
 void TimeKeeper::StartTimer(const len_t timer) {
+    if (Tracer::IsEnabled())
+        timers[timer]->traceDepth = Tracer::Begin(timers[timer]->longname, this->name.c_str());
+    if (PerfCounters::IsEnabled())
+        PerfCounters::Read(timers[timer]->counterStart);
+
     timers[timer]->timer->Start();
 }
 
@@ -66,6 +78,17 @@ void TimeKeeper::StartTimer(const len_t timer) {
  */
 void TimeKeeper::StopTimer(const len_t timer) {
     timers[timer]->timer->Stop();
+
+    if (PerfCounters::IsEnabled()) {
+        struct PerfCounters::values now;
+        if (PerfCounters::Read(now)) {
+            for (len_t i = 0; i < PerfCounters::N_COUNTERS; i++)
+                timers[timer]->counterAccum.v[i] += now.v[i] - timers[timer]->counterStart.v[i];
+        }
+    }
+
+    if (Tracer::IsEnabled())
+        Tracer::End(timers[timer]->traceDepth);
 }
 
 /**
@@ -102,7 +125,7 @@ void TimeKeeper::PrintTimings(bool printTitle, const int_t normalizeto) {
             if (s == nrm) continue;
 
             sum += s;
-            printf("  %-*s  %3.2f%%\n", maxlen+1, (tm->longname+":").c_str(), s/nrm*100);
+            printf("  %-*s  %3.2f%%", maxlen+1, (tm->longname+":").c_str(), s/nrm*100);
         } else {
             real_t ms = s/1000;
 
@@ -111,6 +134,19 @@ void TimeKeeper::PrintTimings(bool printTitle, const int_t normalizeto) {
             else
                 printf("  %-*s  %3.4f ms", maxlen+1, (tm->longname+":").c_str(), ms);
         }
+
+        // Instructions per cycle and fraction of last-level
+        // cache references which missed
+        const uint64_t *c = tm->counterAccum.v;
+        if (PerfCounters::IsEnabled() && c[PerfCounters::COUNTER_CYCLES] > 0)
+            printf(
+                "   (IPC %.2f, LLC misses %.1f%%)",
+                c[PerfCounters::COUNTER_INSTRUCTIONS] / (real_t)c[PerfCounters::COUNTER_CYCLES],
+                c[PerfCounters::COUNTER_LLC_REFERENCES] > 0 ?
+                    100.0*c[PerfCounters::COUNTER_LLC_MISSES] / c[PerfCounters::COUNTER_LLC_REFERENCES] : 0.0
+            );
+
+        printf("\n");
     }
 
     // Print residual (in normalized mode; otherwise people should easily
@@ -133,5 +169,37 @@ void TimeKeeper::SaveTimings(SFile *sf, const std::string& path) {
         sf->WriteScalar(dsetname, dt->GetMicroseconds());
         sf->WriteAttribute_string(dsetname, "desc", tm->longname);
     }
+
+    if (PerfCounters::IsEnabled())
+        this->SaveCounters(sf, path+"/counters");
+}
+
+/**
+ * Save the hardware counter values accumulated by each timer to
+ * the given SFile object. The short names of the timers are stored
+ * as a ';'-separated list, with one list of counts per counter.
+ *
+ * sf:   SFile object to save counters to.
+ * path: Path in SFile object to save counters to.
+ */
+void TimeKeeper::SaveCounters(SFile *sf, const std::string& path) {
+    const len_t n = timers.size();
+    string names;
+    real_t *counts = new real_t[n];
+
+    for (auto tm : timers)
+        names += tm->shortname + ";";
+
+    sf->CreateStruct(path);
+    sf->WriteString(path+"/names", names);
+
+    for (len_t j = 0; j < PerfCounters::N_COUNTERS; j++) {
+        for (len_t i = 0; i < n; i++)
+            counts[i] = timers[i]->counterAccum.v[j];
+
+        sf->WriteList(path+"/"+PerfCounters::GetName(j), counts, n);
+    }
+
+    delete [] counts;
 }
 
@@ -0,0 +1,217 @@
+/**
+ * The Tracer records nested, timed scopes (time steps, iterations,
+ * rebuilds of individual equation terms, linear solves etc.) during a
+ * simulation. Unlike the 'TimeKeeper', which only accumulates the time
+ * spent in a number of flat timers, the Tracer keeps track of the
+ * hierarchy of scopes and can export the individual events as a
+ * Chrome/Perfetto trace ('chrome://tracing' or 'ui.perfetto.dev').
+ *
+ * Scopes are traced using the RAII helper 'Tracer::Scope', e.g.
+ *
+ *   {
+ *       FVM::Tracer::Scope trace("Rebuild terms");
+ *       ...
+ *   }
+ *
+ * which does nothing (apart from checking a flag) when tracing has
+ * not been enabled. The time spent in each scope, accumulated over
+ * all calls and identified by its full path in the scope hierarchy,
+ * is always recorded when tracing is enabled, while the individual
+ * events are only kept up to a maximum number (to limit the memory
+ * consumption of long simulations).
+ */
+
+#include <atomic>
+#include <cstdio>
+#include "FVM/FVMException.hpp"
+#include "FVM/Tracer.hpp"
+
+
+using namespace DREAM::FVM;
+using namespace std;
+
+
+/**
+ * Enable or disable tracing and clear all previously recorded
+ * events and statistics.
+ *
+ * enable:    If true, enables tracing.
+ * maxEvents: Maximum number of individual events to keep for
+ *            the Chrome trace export.
+ */
+void Tracer::Configure(const bool enable, const len_t maxEvents) {
+    lock_guard<mutex> lock(mtx);
+
+    Tracer::enabled = enable;
+    Tracer::maxEvents = maxEvents;
+    Tracer::eventsTruncated = false;
+    Tracer::events.clear();
+    Tracer::summaries.clear();
+    Tracer::t0 = chrono::steady_clock::now();
+}
+
+/**
+ * Returns the number of microseconds elapsed since
+ * tracing was configured.
+ */
+int64_t Tracer::Now() {
+    return chrono::duration_cast<chrono::microseconds>(
+        chrono::steady_clock::now() - Tracer::t0
+    ).count();
+}
+
+/**
+ * Returns a small integer identifying the calling thread.
+ */
+len_t Tracer::ThreadID() {
+    static atomic<len_t> nThreads(0);
+    thread_local len_t id = nThreads++;
+    return id;
+}
+
+/**
+ * Open a new scope with the given name on the calling thread.
+ *
+ * name:     Name of scope.
+ * category: Category of the scope (shown in the trace viewer).
+ *
+ * RETURNS the depth of the new scope, which must be passed to
+ * 'End()' when closing it.
+ */
+len_t Tracer::Begin(const string& name, const char *category) {
+    const len_t depth = scopeStack.size();
+    string path;
+    if (!scopeStack.empty())
+        path = scopeStack.back().path + "/";
+    path += name;
+
+    scopeStack.push_back({path, category, Now(), 0});
+    return depth;
+}
+
+/**
+ * Close the scope opened at the given depth on the calling thread.
+ * Any scopes nested inside of it which have not yet been closed
+ * (e.g. because an exception was thrown, or a timer was never
+ * stopped) are closed as well.
+ *
+ * depth: Depth of the scope to close (as returned by 'Begin()').
+ */
+void Tracer::End(const len_t depth) {
+    if (scopeStack.size() <= depth)
+        return;
+
+    const int64_t end = Now();
+    while (scopeStack.size() > depth) {
+        struct frame f = std::move(scopeStack.back());
+        scopeStack.pop_back();
+
+        Record(f, end);
+    }
+}
+
+/**
+ * Record the given (just closed) scope.
+ *
+ * f:   Scope to record.
+ * end: Time at which the scope was closed.
+ */
+void Tracer::Record(const struct frame& f, const int64_t end) {
+    const int64_t duration = end - f.start;
+    if (!scopeStack.empty())
+        scopeStack.back().children += duration;
+
+    const string& path = f.path;
+
+    lock_guard<mutex> lock(mtx);
+
+    struct summary& s = Tracer::summaries[path];
+    s.count++;
+    s.total += duration;
+    s.self += duration - f.children;
+
+    if (Tracer::events.size() < Tracer::maxEvents) {
+        size_t slash = path.rfind('/');
+        Tracer::events.push_back({
+            (slash == string::npos ? path : path.substr(slash+1)),
+            f.category, f.start, duration, ThreadID()
+        });
+    } else
+        Tracer::eventsTruncated = true;
+}
+
+/**
+ * Save a summary of the traced scopes to the given SFile object.
+ * The summary consists of the full path of each scope (as a
+ * ';'-separated list) together with the number of calls,
+ * the total time spent in the scope and the time spent in the
+ * scope itself (excluding nested scopes), in microseconds.
+ *
+ * sf:   SFile object to save summary to.
+ * path: Path in SFile object to save summary to.
+ */
+void Tracer::SaveSummary(SFile *sf, const string& path) {
+    lock_guard<mutex> lock(mtx);
+
+    const len_t n = Tracer::summaries.size();
+    string names;
+    real_t *count = new real_t[n];
+    real_t *total = new real_t[n];
+    real_t *self  = new real_t[n];
+
+    len_t i = 0;
+    for (auto it = Tracer::summaries.begin(); it != Tracer::summaries.end(); it++, i++) {
+        names += it->first + ";";
+        count[i] = it->second.count;
+        total[i] = it->second.total;
+        self[i]  = it->second.self;
+    }
+
+    sf->CreateStruct(path);
+    sf->WriteString(path+"/names", names);
+    sf->WriteList(path+"/count", count, n);
+    sf->WriteList(path+"/total", total, n);
+    sf->WriteList(path+"/self", self, n);
+
+    sf->WriteAttribute_string(path+"/total", "desc", "Total time spent in scope (microseconds)");
+    sf->WriteAttribute_string(path+"/self", "desc", "Time spent in scope, excluding nested scopes (microseconds)");
+
+    delete [] self;
+    delete [] total;
+    delete [] count;
+}
+
+/**
+ * Write all recorded events to the named file, in the Chrome
+ * trace event (JSON) format.
+ *
+ * filename: Name of file to write trace to.
+ */
+void Tracer::WriteChromeTrace(const string& filename) {
+    lock_guard<mutex> lock(mtx);
+
+    FILE *f = fopen(filename.c_str(), "w");
+    if (f == nullptr)
+        throw FVMException("Tracer: Unable to open file '%s' for writing.", filename.c_str());
+
+    fprintf(f, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n");
+    for (len_t i = 0; i < Tracer::events.size(); i++) {
+        const struct event& e = Tracer::events[i];
+
+        // Escape the characters which are not allowed in JSON strings
+        string name;
+        for (char c : e.name) {
+            if (c == '"' || c == '\\') name += '\\';
+            name += c;
+        }
+
+        fprintf(
+            f, "%s{\"name\":\"%s\",\"cat\":\"%s\",\"ph\":\"X\",\"ts\":%lld,\"dur\":%lld,\"pid\":0,\"tid\":%llu}",
+            (i==0 ? "" : ",\n"), name.c_str(), e.category.c_str(),
+            (long long)e.start, (long long)e.duration, (unsigned long long)e.thread
+        );
+    }
+    fprintf(f, "\n],\"otherData\":{\"truncated\":%s}}\n", (Tracer::eventsTruncated ? "true" : "false"));
+
+    fclose(f);
+}
@@ -2,6 +2,7 @@
  * Implementation of the FVM UnknownQuantity class.
  */
 
+#include <vector>
 #include "FVM/Equation/PrescribedParameter.hpp"
 #include "FVM/UnknownQuantity.hpp"
 #include "FVM/UnknownQuantityHandler.hpp"
@@ -25,6 +26,27 @@ void UnknownQuantity::SaveSFile(SFile *sf, const string& path, bool saveMeta) {
 
     sf->WriteAttribute_string(var, "description", this->description);
     sf->WriteAttribute_string(var, "equation", this->description_eqn);
+
+    this->SaveSFileTime(sf, path);
+}
+
+/**
+ * Save the times of the saved steps of this unknown quantity to
+ * the given SFile, if the quantity is not stored on the common time
+ * grid of the output (i.e. if only its final step is kept).
+ *
+ * sf:   SFile object to use for writing the file.
+ * path: Path in the SFile to save data to.
+ */
+void UnknownQuantity::SaveSFileTime(SFile *sf, const string& path) {
+    if (!this->data->IsFinalOnly())
+        return;
+
+    vector<real_t> t(this->data->GetNSavedSteps());
+    for (len_t i = 0; i < t.size(); i++)
+        t[i] = this->data->GetSavedTime(i);
+
+    sf->WriteList(path + "/" + this->name + "@t", t.data(), t.size());
 }
 
 /**
@@ -3,6 +3,7 @@
  * of unknowns).
  */
 
+#include <algorithm>
 #include <string>
 #include <softlib/SFile.h>
 #include "FVM/FVMException.hpp"
@@ -197,6 +198,29 @@ real_t *UnknownQuantityHandler::GetUnknownInitialData(const len_t qty) {
     return unknowns[qty]->GetInitialData();
 }
 
+/**
+ * Returns the data of the specified unknown which should be used as
+ * the "previous" value in a transient term discretized as
+ *
+ *   dx/dt ~ (x - x_prev) / dt_eff,
+ *
+ * where 'dt_eff' is given by 'GetTransientTimeStep()'. With backward
+ * Euler (BDF1), this is simply the data of the previous time step. With
+ * higher-order BDF methods, this is a linear combination of the data
+ * in several previous time steps.
+ *
+ * qty: ID of quantity to get data of.
+ * dt:  Time step taken.
+ */
+real_t *UnknownQuantityHandler::GetUnknownDataTransientPrevious(const len_t qty, const real_t dt) {
+    if (dt == 0 || this->bdfOrder == 1 || dt != this->bdfStep)
+        return GetUnknownDataPrevious(qty);
+    else
+        return unknowns[qty]->GetQuantityData()->GetOldStepCombination(
+            this->bdfVersion, this->bdfOrder, this->bdfIndices, this->bdfWeights
+        );
+}
+
 /**
  * Returns the ID of the named unknown.
  *
@@ -237,6 +261,7 @@ bool UnknownQuantityHandler::HasUnknown(const string& name) {
  */
 len_t UnknownQuantityHandler::InsertUnknown(const string& name, const string& desc, FVM::Grid *grid, const len_t nMultiples) {
     unknowns.push_back(new UnknownQuantity(name, desc, grid, nMultiples));
+    unknowns.back()->GetQuantityData()->SetNSaveOldSteps(GetNSaveOldSteps());
 
     // Return ID of quantity
     return (unknowns.size()-1);
@@ -250,13 +275,15 @@ len_t UnknownQuantityHandler::InsertUnknown(const string& name, const string& de
  * mayBeConstant: Indicates that the data might have not changed from the
  *                previous iteration and may thus warrant skipping 'Rebuild()'
  *                in certain external objects depending on this data.
+ *
+ * (the elements of the vector are accessed directly, rather than
+ * extracting the elements of each unknown with 'VecGetValues()')
  */
 void UnknownQuantityHandler::Store(vector<len_t> &unk, Vec &v, bool mayBeConstant) {
-    len_t offset = 0;
-    for (auto it = unk.begin(); it != unk.end(); it++) {
-        unknowns[*it]->Store(v, offset, mayBeConstant);
-        offset += unknowns[*it]->NumberOfElements();
-    }
+    const PetscScalar *vec;
+    VecGetArrayRead(v, &vec);
+    this->Store(unk, vec, mayBeConstant);
+    VecRestoreArrayRead(v, &vec);
 }
 void UnknownQuantityHandler::Store(vector<len_t> &unk, const real_t *v, bool mayBeConstant) {
     len_t offset = 0;
@@ -381,3 +408,177 @@ void UnknownQuantityHandler::SetInitialValue(
     this->unknowns[id]->SetInitialValue(val, t0);
 }
 
+
+/**
+ * Returns the effective time step 'dt_eff' to use in a transient
+ * term discretized as
+ *
+ *   dx/dt ~ (x - x_prev) / dt_eff,
+ *
+ * where 'x_prev' is given by 'GetUnknownDataTransientPrevious()'.
+ * If the BDF coefficients were not prepared for the given time step
+ * (or only BDF1 is used), backward Euler is used and 'dt_eff = dt'.
+ *
+ * dt: Time step taken.
+ */
+real_t UnknownQuantityHandler::GetTransientTimeStep(const real_t dt) {
+    if (dt == 0 || this->bdfOrder == 1 || dt != this->bdfStep)
+        return dt;
+    else
+        return this->bdfTimeStep;
+}
+
+/**
+ * Prepare the coefficients of the BDF approximation of the time
+ * derivative for the next time step. The order of the method is
+ * chosen as the highest order (not exceeding the maximum order set)
+ * allowed by the number of previous time steps available, and for
+ * which the ratio of consecutive time steps is small enough for the
+ * method to remain zero-stable.
+ *
+ * The derivative is obtained by differentiating the Lagrange
+ * polynomial through the nodes tau_0 = t+dt, tau_1 = t, ...,
+ * tau_k, giving
+ *
+ *   dx/dt ~ sum_j alpha_j x_j
+ *         = alpha_0 (x_0 - sum_{j>=1} (-alpha_j/alpha_0) x_j).
+ *
+ * dt:       Time step to take.
+ * maxOrder: Maximum order to use for this step (in addition to
+ *           the maximum order set for the handler).
+ */
+void UnknownQuantityHandler::PrepareTimeDerivative(const real_t dt, const len_t maxOrder) {
+    // Maximum ratio of two consecutive time steps allowed for
+    // BDF2, BDF3, ..., BDF5
+    const real_t MAX_STEP_RATIO[MAX_BDF_ORDER-1] = {2.4, 1.5, 1.2, 1.1};
+
+    this->bdfOrder = 1;
+    this->bdfStep = dt;
+    this->bdfTimeStep = dt;
+    this->bdfIndices[0] = 0;
+    this->bdfWeights[0] = 1;
+
+    const len_t order = min(this->maxBDFOrder, maxOrder);
+    if (order <= 1 || dt <= 0 || unknowns.empty())
+        return;
+
+    // Number of old time steps stored for all unknowns
+    len_t nOld = unknowns[0]->GetQuantityData()->GetNOldSaved();
+    for (UnknownQuantity *uqn : unknowns)
+        nOld = min(nOld, uqn->GetQuantityData()->GetNOldSaved());
+
+    if (nOld < 2)
+        return;
+
+    // Locate distinct old time steps (the same time may be stored
+    // several times by time steppers which push the current step
+    // temporarily)
+    QuantityData *qd = unknowns[0]->GetQuantityData();
+    real_t tau[MAX_BDF_ORDER+1];
+    len_t idx[MAX_BDF_ORDER];
+    tau[0] = qd->GetOldTime(0) + dt;
+
+    len_t k = 0;
+    real_t maxRatio = 1;
+    for (len_t i = 0; i < nOld && k < order; i++) {
+        real_t t = qd->GetOldTime(i);
+        if (t >= tau[k])
+            continue;
+
+        // Check that all time step ratios are acceptable
+        // for the resulting order
+        if (k >= 1) {
+            real_t hPrev = tau[k-1]-tau[k], h = tau[k]-t;
+            maxRatio = max(maxRatio, max(hPrev/h, h/hPrev));
+            if (maxRatio > MAX_STEP_RATIO[k-1])
+                break;
+        }
+
+        idx[k] = i;
+        tau[++k] = t;
+    }
+
+    if (k < 2)
+        return;
+
+    // Coefficients of the Lagrange derivative at tau_0
+    real_t alpha0 = 0;
+    for (len_t m = 1; m <= k; m++)
+        alpha0 += 1/(tau[0]-tau[m]);
+
+    for (len_t j = 1; j <= k; j++) {
+        real_t num = 1, den = 1;
+        for (len_t m = 1; m <= k; m++) {
+            if (m != j)
+                num *= tau[0]-tau[m];
+        }
+        for (len_t m = 0; m <= k; m++) {
+            if (m != j)
+                den *= tau[j]-tau[m];
+        }
+
+        this->bdfIndices[j-1] = idx[j-1];
+        this->bdfWeights[j-1] = -(num/den) / alpha0;
+    }
+
+    this->bdfOrder = k;
+    this->bdfTimeStep = 1/alpha0;
+
+    // Start at 1 (0 means "no combination stored")
+    this->bdfVersion++;
+    if (this->bdfVersion == 0)
+        this->bdfVersion = 1;
+}
+
+/**
+ * Set the maximum order of the BDF method used to discretize
+ * the time derivative in transient terms. This also sets the
+ * number of old time steps kept in memory for all unknowns.
+ *
+ * k: Maximum order to use (1 = backward Euler).
+ */
+void UnknownQuantityHandler::SetMaximumBDFOrder(const len_t k) {
+    if (k < 1 || k > MAX_BDF_ORDER)
+        throw FVMException(
+            "The maximum BDF order must be between 1 and " LEN_T_PRINTF_FMT ".",
+            MAX_BDF_ORDER
+        );
+
+    this->maxBDFOrder = k;
+    UpdateNSaveOldSteps();
+}
+
+/**
+ * Set the number of old time steps which the time stepper needs
+ * to keep in memory (for rolling back rejected steps). This also
+ * sets the number of old time steps kept in memory for all unknowns.
+ *
+ * n: Number of old time steps needed by the time stepper.
+ */
+void UnknownQuantityHandler::SetTimeStepperHistoryDepth(const len_t n) {
+    this->nOldStepsTimeStepper = n;
+    UpdateNSaveOldSteps();
+}
+
+/**
+ * Returns the number of old time steps to keep in memory for
+ * every unknown quantity. Higher-order BDF methods need the
+ * k most recent distinct time steps, which may be interleaved
+ * with temporarily pushed copies of the current step.
+ */
+len_t UnknownQuantityHandler::GetNSaveOldSteps() const {
+    if (this->maxBDFOrder == 1)
+        return max(this->nOldStepsTimeStepper, (len_t)1);
+    else
+        return max(this->nOldStepsTimeStepper, 2*this->maxBDFOrder+2);
+}
+
+/**
+ * Update the number of old time steps kept in memory
+ * for all unknown quantities.
+ */
+void UnknownQuantityHandler::UpdateNSaveOldSteps() {
+    const len_t nSteps = GetNSaveOldSteps();
+    for (UnknownQuantity *uqn : unknowns)
+        uqn->GetQuantityData()->SetNSaveOldSteps(nSteps);
+}
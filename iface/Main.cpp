@@ -4,8 +4,10 @@
 
 
 #include <cmath>
+#include <fstream>
 #include <iostream>
 #include <H5Cpp.h>
+#include <map>
 #include <string>
 #include <unistd.h>
 
@@ -19,27 +21,51 @@
 
 #include <softlib/SOFTLibException.h>
 
+#include "DREAM/AtomicDataImage.hpp"
 #include "DREAM/config.h"
 #include "DREAM/Init.h"
 #include "DREAM/IO.hpp"
 #include "DREAM/QuitException.hpp"
+#include "DREAM/ResultCache.hpp"
 #include "DREAM/Settings/Settings.hpp"
 #include "DREAM/Settings/SFile.hpp"
 #include "DREAM/Settings/SimulationGenerator.hpp"
 #include "DREAM/Simulation.hpp"
+#include "FVM/DurationTimer.hpp"
 #include "FVM/FVMException.hpp"
 
 
 using namespace std;
 
 struct cmd_args {
+    bool batch=false;
     bool display_settings=false;
+    bool estimate=false;
+    bool generate_image=false;
     bool print_adas=false;
+    bool resume=false;
     bool splash=true;
+    bool verbose=false;
     string
         input_filename;
 };
 
+/**
+ * Atomic databases shared by all simulations run in batch mode
+ * (the ADAS database is stored per interpolation method), as well
+ * as the grids of the most recent simulation (reused by subsequent
+ * simulations with identical grid settings).
+ */
+struct shared_databases {
+    map<int_t, DREAM::ADAS*> adas;
+    DREAM::NIST *nist=nullptr;
+    DREAM::AMJUEL *amjuel=nullptr;
+    DREAM::SimulationGenerator::shared_grids grids;
+};
+
+// Set if the user requested execution to stop
+bool quit_requested = false;
+
 void display_settings(DREAM::Settings *s=nullptr) {
     if (s == nullptr)
         s = DREAM::SimulationGenerator::CreateSettings();
@@ -64,9 +90,23 @@ void print_help() {
 
     cout << "OPTIONS" << endl;
     cout << "  -a           Print list of elements in ADAS database." << endl;
+    cout << "  -b           Batch mode: 'INPUT' is a text file listing one settings" << endl;
+    cout << "               file per line, and the simulations are run one after" << endl;
+    cout << "               another in this process, sharing the atomic databases." << endl;
+    cout << "               Under MPI, every process takes simulations from the list" << endl;
+    cout << "               until all have been run." << endl;
+    cout << "  -e           Estimate the cost of the simulation (matrix size, memory and" << endl;
+    cout << "               time per step) from one Newton iteration, without running it." << endl;
+    cout << "  -g           Generate an image of precomputed atomic data, which can be" << endl;
+    cout << "               shared by simulations via the setting 'atomic/adas_image'," << endl;
+    cout << "               and write it to the file 'INPUT'." << endl;
     cout << "  -h           Print this help." << endl;
     cout << "  -l           List all available settings in DREAM." << endl;
+    cout << "  -r           Resume the simulation from the checkpoint file specified" << endl;
+    cout << "               by the setting 'output/checkpoint' (the output file then" << endl;
+    cout << "               contains the time evolution from the checkpoint onwards)." << endl;
     cout << "  -s           Do not show the splash screen." << endl;
+    cout << "  -v           Print a breakdown of the time spent starting the simulation." << endl;
 }
 
 /**
@@ -81,20 +121,35 @@ struct cmd_args *parse_args(int argc, char *argv[]) {
     struct cmd_args *a = new struct cmd_args;
     a->display_settings = false;
 
-    while ((c = getopt(argc, argv, "ahls")) != -1) {
+    while ((c = getopt(argc, argv, "abeghlrsv")) != -1) {
         switch (c) {
             case 'a':
                 a->print_adas = true;
                 break;
+            case 'b':
+                a->batch = true;
+                break;
+            case 'e':
+                a->estimate = true;
+                break;
+            case 'g':
+                a->generate_image = true;
+                break;
             case 'h':
                 print_help();
                 break;
             case 'l':
                 display_settings();
                 break;
+            case 'r':
+                a->resume = true;
+                break;
             case 's':
                 a->splash = false;
                 break;
+            case 'v':
+                a->verbose = true;
+                break;
             case '?':
                 cout << "Unrecognized option: " << optopt << endl;
                 return nullptr;
@@ -166,6 +221,322 @@ char ***construct_fake_args(vector<string> &args, int &argc) {
 }
 
 
+/**
+ * Generate an image of precomputed atomic data and write
+ * it to the named file.
+ *
+ * RETURNS the exit code of the program.
+ */
+int generate_image(const string& filename) {
+    try {
+        DREAM::AtomicDataImage::Generate(filename);
+        DREAM::IO::PrintInfo("Wrote atomic data image to '%s'.", filename.c_str());
+    } catch (DREAM::FVM::FVMException &ex) {
+        DREAM::IO::PrintError(ex.what());
+        return 1;
+    }
+
+    return 0;
+}
+
+/**
+ * Returns the given file name with "_window<rank>" inserted before
+ * the file extension. Every process of a parareal simulation writes
+ * the output of its own time window to such a file.
+ *
+ * filename: Name of file.
+ * rank:     Rank of the process.
+ */
+string window_filename(const string& filename, const int rank) {
+    const string suffix = "_window" + to_string(rank);
+    size_t dot = filename.find_last_of('.'), slash = filename.find_last_of('/');
+    if (dot == string::npos || (slash != string::npos && dot < slash))
+        return filename + suffix;
+    else
+        return filename.substr(0, dot) + suffix + filename.substr(dot);
+}
+
+/**
+ * Run the simulation specified by the given settings file.
+ *
+ * filename: Name of file containing the simulation settings.
+ * a:        Command-line arguments.
+ * shared:   Atomic databases and grids to share with other simulations
+ *           (if 'nullptr', the simulation loads its own databases).
+ *
+ * RETURNS the exit code of the simulation.
+ */
+int run_simulation(const string& filename, struct cmd_args *a, struct shared_databases *shared=nullptr) {
+    int exit_code = 0;
+    DREAM::Settings *settings = nullptr;
+    DREAM::Simulation *sim = nullptr;
+    DREAM::ResultCache *cache = nullptr;
+    string outfile;
+    PetscMPIInt rank = 0, nproc = 1;
+    bool distributed = false;
+    try {
+        DREAM::FVM::DurationTimer tSettings;
+        tSettings.Start();
+        settings = DREAM::SimulationGenerator::CreateSettings();
+        
+        DREAM::SettingsSFile::LoadSettings(settings, filename);
+        tSettings.Stop();
+
+        if (a->verbose)
+            DREAM::IO::PrintInfo("Loading settings       %10.3f ms", tSettings.GetMilliseconds());
+
+        // A single simulation can be run on several MPI processes either
+        // with the parareal method, where every process solves (and writes
+        // the output of) its own time window, or with distributed linear
+        // systems, where all processes solve the same time steps together
+        // and only the first process writes output (in batch mode, each
+        // process instead runs its own simulations)
+        MPI_Comm_rank(PETSC_COMM_WORLD, &rank);
+        MPI_Comm_size(PETSC_COMM_WORLD, &nproc);
+        const bool parallel = (shared == nullptr && nproc > 1);
+        distributed = (parallel && settings->GetBool("solver/distributed", false));
+        const bool windowed = (parallel && !distributed);
+        string checkpoint;
+        if (parallel)
+            checkpoint = settings->GetString("output/checkpoint", false);
+
+        if (windowed) {
+            if (settings->GetInteger("timestep/pararealcoarsesteps", false) <= 0)
+                throw DREAM::FVM::FVMException(
+                    "DREAM only supports distributed-memory parallelism for individual "
+                    "simulations with the parareal method ('timestep/pararealcoarsesteps') "
+                    "or with distributed linear systems ('solver/distributed'). Run on a "
+                    "single MPI process (shared-memory parallelism is enabled with "
+                    "'solver/nthreads'), or run an ensemble of simulations in batch "
+                    "mode ('-b')."
+                );
+
+            settings->SetSetting("output/filename", window_filename(settings->GetString("output/filename", false), rank));
+
+            const string statusfile = settings->GetString("output/statusfile", false);
+            if (!statusfile.empty())
+                settings->SetSetting("output/statusfile", window_filename(statusfile, rank));
+        } else if (distributed) {
+            if (settings->GetInteger("timestep/pararealcoarsesteps", false) > 0)
+                throw DREAM::FVM::FVMException(
+                    "The parareal method can not be combined with distributed linear systems."
+                );
+
+            // Only the first process writes output and prints messages
+            // (all processes hold the same solution)
+            if (rank > 0) {
+                settings->SetSetting("output/checkpoint", (string)"");
+                settings->SetSetting("output/statusfile", (string)"");
+                settings->SetSetting("output/tracefile", (string)"");
+                settings->SetSetting("output/loglevel", (int_t)DREAM::IO::LEVEL_ERROR);
+            }
+        }
+
+        // If an identical simulation has been run before,
+        // return its output instead of rerunning it
+        const string resultcache = settings->GetString("output/resultcache");
+        outfile = settings->GetString("output/filename");
+        if (!resultcache.empty() && !a->estimate && !a->resume && !parallel) {
+            cache = new DREAM::ResultCache(resultcache, settings);
+            if (cache->Restore(outfile)) {
+                DREAM::IO::PrintInfo("Output restored from result cache '%s'.", cache->GetFilename().c_str());
+
+                delete cache;
+                if (shared != nullptr && settings != shared->grids.owner)
+                    delete settings;
+                return 0;
+            }
+        }
+
+        if (shared != nullptr) {
+            int_t intp = settings->GetInteger("atomic/adas_interpolation");
+            if (shared->adas.find(intp) == shared->adas.end())
+                shared->adas[intp] = DREAM::SimulationGenerator::LoadADAS(settings);
+            if (shared->nist == nullptr)
+                shared->nist = DREAM::SimulationGenerator::LoadNIST(settings);
+            if (shared->amjuel == nullptr)
+                shared->amjuel = DREAM::SimulationGenerator::LoadAMJUEL(settings);
+
+            sim = DREAM::SimulationGenerator::ProcessSettings(
+                settings, a->verbose, shared->adas[intp], shared->nist, shared->amjuel,
+                &shared->grids
+            );
+        } else
+            sim = DREAM::SimulationGenerator::ProcessSettings(settings, a->verbose);
+
+        if (a->print_adas)
+            display_adas(sim);
+
+        if (a->estimate) {
+            // Only estimate the cost of the simulation (no output is written)
+            sim->GetEquationSystem()->PrintCostEstimate();
+        } else {
+            if (a->resume) {
+                if (!parallel)
+                    checkpoint = settings->GetString("output/checkpoint");
+                if (checkpoint.empty())
+                    throw DREAM::FVM::FVMException(
+                        "Unable to resume simulation: no checkpoint file specified in the settings ('output/checkpoint')."
+                    );
+
+                sim->GetEquationSystem()->SetResumeFile(checkpoint);
+            }
+
+            sim->Run();
+        }
+    } catch (DREAM::QuitException &ex) {
+        DREAM::IO::PrintInfo(ex.what());
+        quit_requested = true;
+        exit_code = 0;
+    } catch (DREAM::FVM::FVMException &ex) {
+        DREAM::IO::PrintError(ex.what());
+        exit_code = 1;
+    } catch (SOFTLibException &ex) {
+        DREAM::IO::PrintError(ex.what());
+        exit_code = 2;
+    } catch (H5::FileIException &ex) {
+        DREAM::IO::PrintError(ex.getDetailMsg().c_str());
+        exit_code = 3;
+    }
+
+    if (sim != nullptr && !a->estimate && !(distributed && rank > 0)) {
+        try {
+            sim->Save();
+        } catch (H5::FileIException &ex) {
+            DREAM::IO::PrintError(ex.getDetailMsg().c_str());
+            exit_code = 4;
+        }
+    }
+
+    // Store the output for later simulations with identical settings
+    if (cache != nullptr) {
+        if (exit_code == 0 && !quit_requested && sim->IsFinished() && !cache->Store(outfile))
+            DREAM::IO::PrintWarning("Unable to store output in result cache '%s'.", cache->GetFilename().c_str());
+
+        delete cache;
+    }
+
+    // Only release resources in batch mode (in single-simulation
+    // mode, the process exits right after this). If the grids of this
+    // simulation are kept for later simulations, the settings they
+    // were constructed from are kept as well.
+    if (shared != nullptr) {
+        delete sim;
+        if (settings != shared->grids.owner)
+            delete settings;
+    }
+
+    return exit_code;
+}
+
+/**
+ * Run all simulations listed in the batch file 'a->input_filename'.
+ * The batch file contains the name of one settings file per line
+ * (empty lines and lines starting with '#' are ignored). Each
+ * simulation writes output to the file specified in its settings.
+ *
+ * When run on several MPI processes, every process runs one simulation
+ * at a time (all PETSc objects live on PETSC_COMM_SELF, so that each
+ * process forms its own sub-communicator). The simulations are handed
+ * out through a shared counter on the first process, so that processes
+ * finishing early take on the remaining simulations.
+ *
+ * a: Command-line arguments.
+ *
+ * RETURNS zero if all simulations succeeded, and the exit code of
+ * the last failing simulation otherwise.
+ */
+int run_batch(struct cmd_args *a) {
+    ifstream batch(a->input_filename);
+    if (!batch.is_open()) {
+        DREAM::IO::PrintError("Unable to open batch file '%s'.", a->input_filename.c_str());
+        return 5;
+    }
+
+    vector<string> files;
+    string line;
+    while (getline(batch, line)) {
+        size_t b = line.find_first_not_of(" \t\r");
+        if (b == string::npos || line[b] == '#')
+            continue;
+
+        size_t e = line.find_last_not_of(" \t\r");
+        files.push_back(line.substr(b, e-b+1));
+    }
+
+    PetscMPIInt rank, nproc;
+    MPI_Comm_rank(PETSC_COMM_WORLD, &rank);
+    MPI_Comm_size(PETSC_COMM_WORLD, &nproc);
+
+    // Work queue: index of the next simulation to run
+    int64_t *next;
+    MPI_Win queue;
+    MPI_Win_allocate(
+        (rank == 0 ? sizeof(int64_t) : 0), sizeof(int64_t),
+        MPI_INFO_NULL, PETSC_COMM_WORLD, &next, &queue
+    );
+    if (rank == 0)
+        *next = 0;
+    MPI_Barrier(PETSC_COMM_WORLD);
+
+    struct shared_databases shared;
+    int exit_code = 0;
+    int64_t nRun = 0, nFailed = 0;
+    while (!quit_requested) {
+        const int64_t one = 1;
+        int64_t i;
+        MPI_Win_lock(MPI_LOCK_SHARED, 0, 0, queue);
+        MPI_Fetch_and_op(&one, &i, MPI_INT64_T, 0, 0, MPI_SUM, queue);
+        MPI_Win_unlock(0, queue);
+
+        if (i >= (int64_t)files.size())
+            break;
+
+        if (nproc > 1)
+            DREAM::IO::PrintInfo(
+                "Batch simulation " INT_T_PRINTF_FMT "/" LEN_T_PRINTF_FMT " (process %d): %s",
+                (int_t)i+1, files.size(), rank, files[i].c_str()
+            );
+        else
+            DREAM::IO::PrintInfo(
+                "Batch simulation " INT_T_PRINTF_FMT "/" LEN_T_PRINTF_FMT ": %s",
+                (int_t)i+1, files.size(), files[i].c_str()
+            );
+
+        int ec = run_simulation(files[i], a, &shared);
+        nRun++;
+        if (ec != 0) {
+            exit_code = ec;
+            nFailed++;
+        }
+    }
+
+    // Simulations which were never started (because the
+    // user requested execution to stop) count as failed
+    int64_t nRunTotal, nFailedTotal;
+    int exitCodeTotal;
+    MPI_Allreduce(&nRun, &nRunTotal, 1, MPI_INT64_T, MPI_SUM, PETSC_COMM_WORLD);
+    MPI_Allreduce(&nFailed, &nFailedTotal, 1, MPI_INT64_T, MPI_SUM, PETSC_COMM_WORLD);
+    MPI_Allreduce(&exit_code, &exitCodeTotal, 1, MPI_INT, MPI_MAX, PETSC_COMM_WORLD);
+    nFailedTotal += (int64_t)files.size() - nRunTotal;
+
+    MPI_Win_free(&queue);
+
+    if (rank == 0)
+        DREAM::IO::PrintInfo(
+            "Batch finished: " INT_T_PRINTF_FMT " of " LEN_T_PRINTF_FMT " simulations succeeded.",
+            (int_t)((int64_t)files.size()-nFailedTotal), files.size()
+        );
+
+    for (auto it = shared.adas.begin(); it != shared.adas.end(); it++)
+        delete it->second;
+    delete shared.nist;
+    delete shared.amjuel;
+    delete shared.grids.owner;
+
+    return exitCodeTotal;
+}
+
 /**
  * Program entry point.
  *
@@ -198,54 +569,31 @@ int main(int argc, char *argv[]) {
     if (a == nullptr)
         return -1;
 
+    PetscMPIInt rank;
+    MPI_Comm_rank(PETSC_COMM_WORLD, &rank);
+
     // Make sure that anything written to stdio/stderr is
     // written immediately
     cout.setf(ios_base::unitbuf);
 
-    if (a->splash)
-        splash();
+    if (rank == 0) {
+        if (a->splash)
+            splash();
 
-    cout << "commit " << DREAM_GIT_SHA1 << endl;
+        cout << "commit " << DREAM_GIT_SHA1 << endl;
+    }
 
     // Except on NaN (but only in debug mode)
 #if !defined(NDEBUG) && defined(__linux__)
     feenableexcept(FE_INVALID | FE_DIVBYZERO | FE_OVERFLOW);
 #endif
 
-    DREAM::Simulation *sim = nullptr;
-    try {
-        DREAM::Settings *settings = DREAM::SimulationGenerator::CreateSettings();
-        
-        DREAM::SettingsSFile::LoadSettings(settings, a->input_filename);
-
-        sim = DREAM::SimulationGenerator::ProcessSettings(settings);
-
-        if (a->print_adas)
-            display_adas(sim);
-
-        sim->Run();
-    } catch (DREAM::QuitException &ex) {
-        DREAM::IO::PrintInfo(ex.what());
-        exit_code = 0;
-    } catch (DREAM::FVM::FVMException &ex) {
-        DREAM::IO::PrintError(ex.what());
-        exit_code = 1;
-    } catch (SOFTLibException &ex) {
-        DREAM::IO::PrintError(ex.what());
-        exit_code = 2;
-    } catch (H5::FileIException &ex) {
-        DREAM::IO::PrintError(ex.getDetailMsg().c_str());
-        exit_code = 3;
-    }
-
-    if (sim != nullptr) {
-        try {
-            sim->Save();
-        } catch (H5::FileIException &ex) {
-            DREAM::IO::PrintError(ex.getDetailMsg().c_str());
-            exit_code = 4;
-        }
-    }
+    if (a->generate_image)
+        exit_code = generate_image(a->input_filename);
+    else if (a->batch)
+        exit_code = run_batch(a);
+    else
+        exit_code = run_simulation(a->input_filename, a);
 
     // De-initialize the DREAM library
     dream_finalize();
@@ -1,29 +1,58 @@
 #ifndef _DREAM_ADAS_HPP
 #define _DREAM_ADAS_HPP
 
+#include <mutex>
 #include <unordered_map>
 #include <gsl/gsl_interp.h>
 #include "DREAM/ADASRateInterpolator.hpp"
+#include "DREAM/AtomicDataImage.hpp"
+#include "FVM/DurationTimer.hpp"
 #include "FVM/FVMException.hpp"
 
+struct adas_rate;
+
 namespace DREAM {
     class ADAS {
     private:
-        std::unordered_map<len_t, ADASRateInterpolator**> intp;
+        static constexpr len_t N_ADAS_RATES = 5;
+
+        /**
+         * Rate data for a single element (isotope). The
+         * interpolation objects are only constructed the
+         * first time the element is requested.
+         */
+        struct adas_element {
+            const struct adas_rate *rate;
+            // Index of the element in the ADAS table
+            len_t tableIndex;
+            ADASRateInterpolator **intp=nullptr;
+        };
+        std::unordered_map<len_t, struct adas_element*> elements;
+        const gsl_interp2d_type *interp;
+        // Image of precomputed interpolation coefficients (optional)
+        const AtomicDataImage *image;
+
+        // Protects the construction of interpolation objects
+        // (since equations may be rebuilt in parallel)
+        mutable std::mutex buildMutex;
+        // Number of elements for which interpolation objects
+        // have been constructed, and time spent doing so
+        mutable len_t nBuiltElements=0;
+        mutable FVM::DurationTimer buildTimer;
 
         static const len_t
             IDX_ACD, IDX_CCD, IDX_SCD, IDX_PLT, IDX_PRB;
 
         len_t get_isotope_index(const len_t, const len_t A=0) const;
-        std::unordered_map<len_t, ADASRateInterpolator**>::const_iterator
-            get_element(const len_t, const len_t A=0) const;
+        ADASRateInterpolator *get_rate(const len_t, const len_t, const len_t) const;
+        void build_element(struct adas_element*) const;
 
         // Maximum possible atomic mass (or larger; should just be an
         // arbitrary large number to help with indexing...)
         static const len_t MAX_ATOMIC_MASS = 250;
 
     public:
-        ADAS(const gsl_interp2d_type *interp=gsl_interp2d_bicubic);
+        ADAS(const gsl_interp2d_type *interp=gsl_interp2d_bicubic, const AtomicDataImage *image=nullptr);
         ~ADAS();
 
         bool HasElement(const len_t Z, const len_t A=0) const;
@@ -34,6 +63,10 @@ namespace DREAM {
         ADASRateInterpolator *GetPLT(const len_t Z, const len_t A=0) const;
         ADASRateInterpolator *GetPRB(const len_t Z, const len_t A=0) const;
 
+        const AtomicDataImage *GetImage() const { return this->image; }
+        len_t GetNBuiltElements() const { return this->nBuiltElements; }
+        real_t GetBuildTime() const { return this->buildTimer.GetMilliseconds(); }
+
         void PrintElements() const;
     };
 
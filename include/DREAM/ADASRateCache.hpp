@@ -0,0 +1,64 @@
+#ifndef _DREAM_ADAS_RATE_CACHE_HPP
+#define _DREAM_ADAS_RATE_CACHE_HPP
+
+namespace DREAM { class ADASRateCache; }
+
+#include <map>
+#include <mutex>
+#include <utility>
+#include "FVM/config.h"
+#include "FVM/Grid/RadialGrid.hpp"
+#include "FVM/UnknownQuantityHandler.hpp"
+#include "DREAM/ADAS.hpp"
+
+namespace DREAM {
+    class ADASRateCache {
+    public:
+        enum rate_type {
+            RATE_ACD,
+            RATE_SCD,
+            RATE_PLT,
+            RATE_PRB
+        };
+
+        // Rate coefficients (and their derivatives with respect to
+        // n_cold and T_cold) of one element, for all charge states
+        // at all radii, stored as R[Z0][ir]
+        struct rates {
+            real_t **R=nullptr, **dRdn=nullptr, **dRdT=nullptr;
+        };
+
+    private:
+        struct entry {
+            struct rates r;
+            len_t Z, nr=0;
+            // Versions of n_cold and T_cold for which the stored
+            // rates were evaluated
+            bool valid = false;
+            len_t version_ncold = 0, version_Tcold = 0;
+            std::mutex evalMutex;
+        };
+
+        ADAS *adas;
+        FVM::RadialGrid *rGrid;
+        FVM::UnknownQuantityHandler *unknowns;
+        len_t id_ncold, id_Tcold;
+
+        std::map<std::pair<len_t, len_t>, struct entry*> entries;
+        // Protects the map of entries (since equations
+        // may be rebuilt in parallel)
+        std::mutex entriesMutex;
+
+        ADASRateInterpolator *GetInterpolator(const enum rate_type, const len_t) const;
+        void Allocate(struct entry*, const len_t);
+        void Deallocate(struct entry*);
+
+    public:
+        ADASRateCache(ADAS*, FVM::RadialGrid*, FVM::UnknownQuantityHandler*);
+        ~ADASRateCache();
+
+        const struct rates *Get(const enum rate_type, const len_t Z);
+    };
+}
+
+#endif/*_DREAM_ADAS_RATE_CACHE_HPP*/
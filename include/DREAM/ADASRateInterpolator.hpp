@@ -7,7 +7,21 @@
 #include "FVM/config.h"
 
 namespace DREAM {
-    class ADASRateInterpolator {
+    /**
+     * Interpolator for ADAS rate coefficients, storing its interpolation
+     * coefficients with type 'S'. The coefficients are the main read-only
+     * data of the atomic physics terms, and storing them in single
+     * precision halves the memory traffic of evaluating the rates (the
+     * interpolants are always evaluated in 'real_t'). Since single-precision
+     * coefficients limit the relative accuracy of the rates to about
+     * 1e-6, double precision is used unless DREAM is compiled with
+     * 'DREAM_ADAS_SINGLE_PRECISION' (see 'ADASRateInterpolator' below).
+     */
+    template<typename S>
+    class ADASRateInterpolatorT {
+    public:
+        typedef S storage_t;
+
     private:
         len_t Z, nn, nT;
         const real_t *logn, *logT, *data;
@@ -26,25 +40,76 @@ namespace DREAM {
          */
         bool shiftZ0=false;
 
-        // Interpolation objects
-        gsl_interp_accel **nacc, **Tacc;
-        //gsl_spline2d **splines;
-        gsl_interp2d **interp_c, **interp_l;
+        /**
+         * Polynomial coefficients of the interpolant in each cell
+         * of the (log n, log T) grid, so that in cell (in, iT)
+         *
+         *   log10(coeff) = sum_{k,l} a_kl t^k u^l,
+         *
+         * where t and u are the local coordinates (in [0,1]) in
+         * log n and log T respectively. The coefficients are stored
+         * contiguously as
+         *
+         *   coeffs[16*((idx*(nT-1) + iT)*(nn-1) + in) + 4*k + l].
+         *
+         * The coefficients are either computed when the object is
+         * constructed (and owned by it), or taken from an image of
+         * precomputed atomic data (see 'AtomicDataImage').
+         */
+        const S *coeffs;
+        bool ownsCoeffs=true;
+
+        // Location of a point in the (log n, log T) grid
+        struct grid_point {
+            len_t in, iT;
+            real_t t, u;
+            real_t dx, dy;
+            real_t n, T;
+            bool inside;
+        };
+
+        bool Locate(const real_t, const real_t, struct grid_point*) const;
+        real_t EvalPoint(const len_t, const struct grid_point*, real_t*, real_t*) const;
 
     public:
-        ADASRateInterpolator(
+        ADASRateInterpolatorT(
             const len_t, const len_t, const len_t,
             const real_t*, const real_t*, const real_t*,
             bool shiftZ0,
-            const gsl_interp2d_type *interp=gsl_interp2d_bicubic
+            const gsl_interp2d_type *interp=gsl_interp2d_bicubic,
+            const S *precomputed=nullptr
         );
-        virtual ~ADASRateInterpolator();
+        virtual ~ADASRateInterpolatorT();
+
+        static len_t GetNumberOfCoefficients(const len_t Z, const len_t nn, const len_t nT)
+        { return 16*Z*(nn-1)*(nT-1); }
+        len_t GetNumberOfCoefficients() const
+        { return GetNumberOfCoefficients(this->Z, this->nn, this->nT); }
+        const S *GetCoefficients() const { return this->coeffs; }
 
-        real_t Eval(const len_t Z0, const real_t n, const real_t T);
+        bool IsZero(const len_t Z0) const
+        { return ((shiftZ0 && Z0 == 0) || (!shiftZ0 && Z0 == Z)); }
 
-        real_t Eval_deriv_n(const len_t Z0, const real_t n, const real_t T);
-        real_t Eval_deriv_T(const len_t Z0, const real_t n, const real_t T);
+        real_t Eval(const len_t Z0, const real_t n, const real_t T) const;
+        void Eval(
+            const len_t Z0, const len_t N, const real_t *n, const real_t *T,
+            real_t *coeff, real_t *dcoeff_dn=nullptr, real_t *dcoeff_dT=nullptr
+        ) const;
+        void Eval(
+            const len_t N, const real_t *n, const real_t *T,
+            real_t **coeff, real_t **dcoeff_dn=nullptr, real_t **dcoeff_dT=nullptr
+        ) const;
+
+        real_t Eval_deriv_n(const len_t Z0, const real_t n, const real_t T) const;
+        real_t Eval_deriv_T(const len_t Z0, const real_t n, const real_t T) const;
     };
+
+    // Interpolator used for the ADAS data of DREAM
+#ifdef DREAM_ADAS_SINGLE_PRECISION
+    typedef ADASRateInterpolatorT<float> ADASRateInterpolator;
+#else
+    typedef ADASRateInterpolatorT<real_t> ADASRateInterpolator;
+#endif
 }
 
 #endif/*_DREAM_ADAS_RATE_INTERPOLATOR_HPP*/
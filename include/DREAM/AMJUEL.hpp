@@ -5,6 +5,15 @@
 
 namespace DREAM {
 	class AMJUEL {
+	public:
+		// Rate coefficients provided by this class
+		enum rate_coefficient {
+			REC_LY_OPAQUE=0,
+			REC_RAD_LY_OPAQUE=1,
+			IONIZ_LY_OPAQUE=2,
+			IONIZ_LOSS_LY_OPAQUE=3
+		};
+
 	private:
 	
 		/**
@@ -63,10 +72,24 @@ namespace DREAM {
 											2.115742192807E-04,3.847511359996E-04,-3.531396348434E-04,1.117507761644E-04,-1.626382515941E-05,1.138105849294E-06,-3.277550512167E-08,-2.762994890889E-11,1.306756395427E-11,
 											-9.909336050813E-06,-1.829769520002E-05,1.745121101762E-05,-5.935692251130E-06,9.750922276399E-07,-8.514634639125E-08,4.007910080852E-09,-9.447800370353E-11,8.488148236190E-13};
 
+		static const real_t *GetCoefficients(enum rate_coefficient);
+		static void EvalFit(const real_t*, const real_t, const real_t, real_t&, real_t&, real_t&);
+
 	public:
 		AMJUEL(){}
 		~AMJUEL(){}
 
+		static bool AppliesTo(enum rate_coefficient, const len_t);
+
+		void Eval(
+			const enum rate_coefficient, const len_t, const len_t, const real_t*, const real_t*,
+			real_t*, real_t *dRdn=nullptr, real_t *dRdT=nullptr
+		);
+		void Eval(
+			const len_t, const enum rate_coefficient*, const len_t, const len_t, const real_t*,
+			const real_t*, real_t *const*, real_t *const *dRdn=nullptr, real_t *const *dRdT=nullptr
+		);
+
         real_t getRecLyOpaque(len_t, real_t, real_t);
         real_t getRecLyOpaque_deriv_n(len_t, real_t, real_t);
         real_t getRecLyOpaque_deriv_T(len_t, real_t, real_t);
@@ -0,0 +1,55 @@
+#ifndef _DREAM_ATOMIC_DATA_IMAGE_HPP
+#define _DREAM_ATOMIC_DATA_IMAGE_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <tuple>
+#include <utility>
+#include <gsl/gsl_interp2d.h>
+#include "DREAM/ADASRateInterpolator.hpp"
+#include "FVM/config.h"
+#include "FVM/FVMException.hpp"
+
+namespace DREAM {
+    class AtomicDataImage {
+    public:
+        // Type of the stored interpolation coefficients
+        typedef ADASRateInterpolator::storage_t coeff_t;
+
+    private:
+        std::string filename;
+
+        // Memory-mapped image file
+        void *mapping = nullptr;
+        size_t mappingSize = 0;
+        // (index in ADAS table, rate, interpolation method) -> coefficients
+        std::map<std::tuple<len_t, len_t, len_t>, std::pair<const coeff_t*, len_t>> entries;
+
+        AtomicDataImage(const std::string&);
+        bool Load();
+
+    public:
+        ~AtomicDataImage();
+
+        static AtomicDataImage *Open(const std::string&);
+        static void Generate(const std::string&);
+
+        static uint64_t GetSourceKey();
+        static len_t GetInterpolationIndex(const gsl_interp2d_type*);
+
+        const std::string& GetFilename() const { return this->filename; }
+        const coeff_t *Get(const len_t, const len_t, const len_t, const len_t) const;
+    };
+
+    class AtomicDataImageException : public DREAM::FVM::FVMException {
+    public:
+        template<typename ... Args>
+        AtomicDataImageException(const std::string &msg, Args&& ... args)
+            : FVMException(msg, std::forward<Args>(args) ...) {
+            AddModule("AtomicDataImage");
+        }
+    };
+}
+
+#endif/*_DREAM_ATOMIC_DATA_IMAGE_HPP*/
@@ -0,0 +1,37 @@
+#ifndef _DREAM_C_INTERFACE_H
+#define _DREAM_C_INTERFACE_H
+/**
+ * C interface to DREAM, for coupling DREAM to external codes.
+ *
+ * A simulation is constructed from a settings file, and can then be
+ * advanced in time in arbitrary increments with 'dream_simulation_step()'.
+ * The data of unknown quantities is accessed through pointers into the
+ * simulation, and prescribed quantities can be updated in place between
+ * calls. All functions returning 'int' return 0 on success and a
+ * non-zero value on error, in which case 'dream_last_error()' returns
+ * a description of the error.
+ */
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct dream_simulation dream_simulation;
+
+dream_simulation *dream_simulation_new(const char *settingsfile);
+void dream_simulation_free(dream_simulation*);
+
+int dream_simulation_step(dream_simulation*, double tTarget, int *running);
+int dream_simulation_save(dream_simulation*);
+double dream_simulation_time(dream_simulation*);
+
+const double *dream_simulation_get_unknown(dream_simulation*, const char *name, long *n);
+double *dream_simulation_get_prescribed(dream_simulation*, const char *name, long *n);
+
+const char *dream_last_error();
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif/*_DREAM_C_INTERFACE_H*/
@@ -0,0 +1,43 @@
+#ifndef _DREAM_CHECKPOINT_HPP
+#define _DREAM_CHECKPOINT_HPP
+
+#include <map>
+#include <string>
+#include <vector>
+#include "FVM/config.h"
+#include "DREAM/DREAMException.hpp"
+
+namespace DREAM {
+    class Checkpoint {
+    private:
+        std::map<std::string, std::vector<real_t>> entries;
+
+    public:
+        // Version of the checkpoint file format
+        static const uint64_t VERSION = 1;
+
+        void Load(const std::string&);
+        void Save(const std::string&) const;
+
+        bool Has(const std::string& name) const
+        { return (this->entries.find(name) != this->entries.end()); }
+
+        const std::vector<real_t>& Get(const std::string&) const;
+        const real_t *Get(const std::string&, const len_t) const;
+        real_t GetScalar(const std::string&) const;
+
+        void Put(const std::string&, const real_t*, const len_t);
+        void Put(const std::string&, const real_t);
+    };
+
+    class CheckpointException : public DREAMException {
+    public:
+        template<typename ... Args>
+        CheckpointException(const std::string &msg, Args&& ... args)
+            : DREAMException(msg, std::forward<Args>(args) ...) {
+            AddModule("Checkpoint");
+        }
+    };
+}
+
+#endif/*_DREAM_CHECKPOINT_HPP*/
@@ -4,6 +4,7 @@
 #include <string>
 #include <unordered_map>
 #include <vector>
+#include "DREAM/Settings/OptionConstants.hpp"
 #include "FVM/NormEvaluator.hpp"
 #include "FVM/UnknownQuantityHandler.hpp"
 
@@ -16,12 +17,20 @@ namespace DREAM {
         void DefineAbsoluteTolerances();
         real_t GetDefaultAbsTol(const std::string&);
 
-        len_t dx_size = 0;
-        real_t *dx_buffer=nullptr;
+        enum OptionConstants::tolerance_norm norm = OptionConstants::TOLERANCE_NORM_2NORM;
 
         len_t nNontrivials;
         real_t *x_2norm=nullptr;
         real_t *dx_2norm=nullptr;
+        // Weighted RMS norms of 'dx' (only with TOLERANCE_NORM_WRMS),
+        // and the ratio of the error to the tolerance of each unknown
+        real_t *dx_wrms=nullptr;
+        real_t *err_ratio=nullptr;
+        // Tolerances, per non-trivial unknown
+        real_t *abstol=nullptr;
+        real_t *reltol=nullptr;
+
+        bool CheckNorms(bool);
 
     public:
         ConvergenceChecker(
@@ -30,9 +39,6 @@ namespace DREAM {
         );
         virtual ~ConvergenceChecker();
 
-        void AllocateBuffer(const len_t);
-        void DeallocateBuffer();
-
         const std::string &GetNonTrivialName(const len_t i)
         { return this->unknowns->GetUnknown(nontrivials[i])->GetName(); }
 
@@ -40,7 +46,14 @@ namespace DREAM {
         bool IsConverged(const real_t*, const real_t*, const real_t*, bool verbose=false);
 
         const real_t *GetErrorNorms() { return this->dx_2norm; }
+        const real_t *GetErrorRatios() { return this->err_ratio; }
+        const real_t *GetSolutionNorms() { return this->x_2norm; }
         const real_t GetErrorScale(const len_t);
+        real_t GetAbsoluteTolerance(const len_t uqty) { return this->absTols[uqty]; }
+        real_t GetRelativeTolerance(const len_t uqty) { return this->relTols[uqty]; }
+
+        enum OptionConstants::tolerance_norm GetNorm() const { return this->norm; }
+        void SetNorm(enum OptionConstants::tolerance_norm n) { this->norm = n; }
 
         void SetAbsoluteTolerance(const len_t, const real_t);
         void SetRelativeTolerance(const real_t);
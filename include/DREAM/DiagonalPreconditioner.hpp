@@ -1,8 +1,10 @@
 #ifndef _DREAM_DIAGONAL_PRECONDITIONER_HPP
 #define _DREAM_DIAGONAL_PRECONDITIONER_HPP
 
+#include <string>
 #include <unordered_map>
 #include <vector>
+#include <softlib/SFile.h>
 #include "FVM/Matrix.hpp"
 #include "FVM/UnknownQuantityHandler.hpp"
 
@@ -19,6 +21,20 @@ namespace DREAM {
         std::unordered_map<len_t, real_t> uqn_scales;   // Scaling factors for unknowns
         std::unordered_map<len_t, real_t> eqn_scales;   // Scaling factors for equations
 
+        // Automatic equilibration: the scalings built from 'eqn_scales'
+        // and 'uqn_scales' (kept in 'iuqn0' and 'eqn0') are refined
+        // using the row and column maxima of the matrix every
+        // 'equilibrateEvery' rescalings
+        bool equilibrate = false;
+        len_t equilibrateEvery = 1, nRescalings = 0;
+        Vec iuqn0, eqn0;
+        // Ratio of the largest to the smallest row maximum of the
+        // matrix before and after each equilibration
+        std::vector<real_t> rowRatioBefore, rowRatioAfter;
+
+        void Equilibrate(FVM::Matrix*);
+        static real_t RowMaxRatio(const real_t*, const len_t);
+
     public:
         DiagonalPreconditioner(
             FVM::UnknownQuantityHandler*, const std::vector<len_t>&
@@ -29,6 +45,9 @@ namespace DREAM {
         void SetEquationScale(const len_t, const real_t);
         void SetUnknownScale(const len_t, const real_t);
         void SetDefaultScalings();
+        void SetEquilibration(const bool, const len_t every=1);
+        bool IsEquilibrating() const { return this->equilibrate; }
+        void SaveEquilibrationStatistics(SFile*, const std::string&);
 
         void RescaleMatrix(FVM::Matrix*);
         void RescaleRHSVector(Vec);
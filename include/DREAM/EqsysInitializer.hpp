@@ -4,11 +4,13 @@
 namespace DREAM { class EquationSystem; }
 
 #include <string>
+#include <utility>
 #include <vector>
 #include <softlib/SFile.h>
 #include "DREAM/Equations/CollisionQuantityHandler.hpp"
 #include "DREAM/IonHandler.hpp"
 #include "DREAM/NotImplementedException.hpp"
+#include "DREAM/OutputSliceReader.hpp"
 #include "DREAM/Settings/OptionConstants.hpp"
 #include "DREAM/UnknownQuantityEquation.hpp"
 #include "FVM/config.h"
@@ -92,6 +94,18 @@ namespace DREAM {
         std::unordered_map<int_t, struct initrule*> rules;
 
         std::vector<int_t> ConstructExecutionOrder(struct initrule*);
+        std::vector<std::vector<int_t>> ConstructExecutionLevels(const std::vector<int_t>&);
+
+        // Time spent on initializing each quantity (name, milliseconds)
+        typedef std::vector<std::pair<std::string, real_t>> timings_t;
+
+        void ExecuteSerial(const real_t, const std::vector<int_t>&, const int_t, timings_t&);
+        void ExecuteParallel(const real_t, const std::vector<int_t>&, const int_t, timings_t&);
+        void ExecuteRule(const real_t, const int_t, const int_t, timings_t&);
+        void ExecuteSteadyStateSolve(const real_t, std::vector<len_t>&, timings_t&);
+        bool IsParallelizable(const struct initrule*) const;
+        real_t *ComputeInitialValue(const real_t, const struct initrule*);
+        void PrintTimings(const timings_t&, const real_t);
 
 		EquationSystem *eqsys=nullptr;
         FVM::Grid *fluidGrid, *hottailGrid, *runawayGrid;
@@ -107,6 +121,26 @@ namespace DREAM {
 		enum OptionConstants::linear_solver linear_solver;
 		enum OptionConstants::linear_solver backup_solver;
 		bool solver_verbose = false;
+		bool solver_pseudotransient = false;
+
+        // Number of threads to use for evaluating independent rules
+        len_t nThreads = 1;
+        // If 'true', prints the time spent on initializing each quantity
+        bool printTimings = false;
+
+        // If 'true', radial profiles loaded from output are remapped
+        // conservatively onto the radial grid of the simulation
+        bool conservativeRemap = false;
+        // Cells 'remapIndex[remapOffset[ir]]' to 'remapIndex[remapOffset[ir+1]-1]'
+        // of the radial grid of the output overlap cell 'ir' of the simulation,
+        // with the (normalized) volume weights 'remapWeight[remapOffset[ir]...]'
+        // (empty when profiles are interpolated instead)
+        std::vector<len_t> remapOffset, remapIndex;
+        std::vector<real_t> remapWeight;
+
+        void SetRadialRemap(const len_t, const real_t*, const real_t*);
+        bool CanRemapR(FVM::UnknownQuantity*) const;
+        void RemapR(const len_t, const real_t*, real_t*, const len_t, const len_t) const;
 
         void __InitTR(
             FVM::UnknownQuantity*, const real_t, const int_t,
@@ -177,22 +211,28 @@ namespace DREAM {
         void Execute(const real_t);
         bool HasRuleFor(const int_t uqtyId) const;
         void InitializeFromOutput(const std::string&, const real_t, int_t, IonHandler*, std::vector<std::string>&);
-        void InitializeFromOutput(SFile*, const real_t, int_t, IonHandler*, std::vector<std::string>&);
+        void InitializeFromOutput(SFile*, const real_t, int_t, IonHandler*, std::vector<std::string>&, OutputSliceReader *slices=nullptr);
         void VerifyAllInitialized() const;
 
 		void SetSolver(
 			const len_t maxiter, const real_t reltol,
 			enum OptionConstants::linear_solver linear_solver,
 			enum OptionConstants::linear_solver backup_solver,
-			bool verbose
+			bool verbose, bool pseudoTransient=false
 		) {
 			this->solver_maxiter = maxiter;
 			this->solver_reltol  = reltol;
 			this->solver_verbose = verbose;
+			this->solver_pseudotransient = pseudoTransient;
 			this->linear_solver  = linear_solver;
 			this->backup_solver  = backup_solver;
 		}
 
+        len_t GetNumberOfThreads() const { return this->nThreads; }
+        void SetNumberOfThreads(const len_t n) { this->nThreads = (n > 0 ? n : 1); }
+        void SetPrintTimings(const bool v) { this->printTimings = v; }
+        void SetConservativeRemap(const bool v) { this->conservativeRemap = v; }
+
         void SetHottailCollisionHandler(CollisionQuantityHandler *cqh)
         { this->cqhHottail = cqh; }
         void SetRunawayCollisionHandler(CollisionQuantityHandler *cqh)
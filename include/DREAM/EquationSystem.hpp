@@ -1,21 +1,25 @@
 #ifndef _DREAM_EQUATION_SYSTEM_HPP
 #define _DREAM_EQUATION_SYSTEM_HPP
 
-namespace DREAM { class EquationSystem; }
+namespace DREAM { class EquationSystem; class OutputGenerator; }
 
 #include <map>
 #include <string>
 #include <vector>
+#include <softlib/Timer.h>
+#include "DREAM/ADASRateCache.hpp"
 #include "DREAM/EqsysInitializer.hpp"
 #include "DREAM/Equations/CollisionQuantityHandler.hpp"
 #include "DREAM/Equations/RunawayFluid.hpp"
 #include "DREAM/Equations/AnalyticDistributionHottail.hpp"
 #include "DREAM/OtherQuantityHandler.hpp"
+#include "DREAM/OutputStream.hpp"
 #include "DREAM/PostProcessor.hpp"
 #include "DREAM/Settings/OptionConstants.hpp"
 #include "DREAM/Settings/Settings.hpp"
 #include "DREAM/Solver/Solver.hpp"
 #include "DREAM/TimeStepper/TimeStepper.hpp"
+#include "DREAM/TimeStepper/TimeStepperConstant.hpp"
 #include "DREAM/UnknownQuantityEquation.hpp"
 #include "DREAM/Equations/SPIHandler.hpp"
 #include "FVM/BlockMatrix.hpp"
@@ -52,7 +56,17 @@ namespace DREAM {
 
         CollisionQuantityHandler *cqh_hottail=nullptr;
         CollisionQuantityHandler *cqh_runaway=nullptr;
-
+        // Radial Coulomb logarithms shared by all collision handlers
+        CoulombLogarithmCache *lnLambdaCache=nullptr;
+        // Radial collision frequency parameters shared by all collision handlers
+        CollisionFrequencyCache *collFreqCache=nullptr;
+        // ADAS rate coefficients at n_cold and T_cold shared by the ion terms
+        ADASRateCache *adasRateCache=nullptr;
+
+        OutputStream *outputStream = nullptr;
+        // Output generator which writes saved steps during the simulation
+        // (owned by the parent 'Simulation' object)
+        OutputGenerator *stepOutput = nullptr;
         PostProcessor *postProcessor = nullptr;
         RunawayFluid *REFluid = nullptr;
         SPIHandler *SPI = nullptr;
@@ -69,12 +83,62 @@ namespace DREAM {
 
         real_t currentTime=0;
         std::vector<real_t> times;
+        // Fixed output time grid (if empty, every saved step is output;
+        // otherwise, saved steps are interpolated to these times)
+        std::vector<real_t> outputTimes;
+        len_t nextOutputTime = 0;
+
+        void InitOutputTimes();
 
         len_t matrix_size=0;
 
         real_t simulationTime = 0;
+        Timer *solveTimer = nullptr;
         bool timingStdout = false;
         bool timingFile = false;
+        // Name of file to write Chrome trace to (empty = don't write)
+        std::string traceFile;
+
+        // Name of checkpoint file (empty = don't write checkpoints),
+        // and the number of saved steps and the wall-clock time
+        // (in minutes) between two checkpoints (0 = unlimited)
+        std::string checkpointFile;
+        len_t checkpointSteps = 0;
+        real_t checkpointInterval = 0;
+        len_t stepsSinceCheckpoint = 0;
+        Timer checkpointTimer;
+        // Name of checkpoint file to resume the simulation from
+        std::string resumeFile;
+
+        void UpdateCheckpoint(const real_t);
+
+        // Name of status file (empty = don't write), and the shortest
+        // wall-clock time (in seconds) between two updates of it
+        std::string statusFile;
+        real_t statusInterval = 10;
+        real_t statusStartTime = 0;
+        len_t statusSteps = 0, statusStepsSinceWrite = 0, statusIterations = 0;
+        Timer statusTimer;
+
+        void UpdateStatus(const real_t, const real_t);
+        void WriteStatus(const char*, const real_t, const real_t);
+
+        // Parareal (parallel-in-time) solution: number of coarse time
+        // steps per time window (0 = disabled), maximum number of
+        // iterations, and relative tolerance on the window states
+        len_t pararealCoarseSteps = 0;
+        len_t pararealMaxIter = 10;
+        real_t pararealRelTol = 1e-6;
+        // If false, time steps are taken without being saved to the output
+        bool saveSteps = true;
+
+        void SolveParareal();
+        bool PararealPropagate(
+            TimeStepperConstant*, const real_t, const real_t, const len_t,
+            const len_t, const real_t*, real_t*, const bool
+        );
+        real_t PararealChange(const real_t*, const real_t*);
+        void SetState(const real_t, const real_t*);
 
     public:
         EqsysInitializer *initializer=nullptr;
@@ -97,7 +161,11 @@ namespace DREAM {
 
         CollisionQuantityHandler *GetHotTailCollisionHandler() { return this->cqh_hottail; }
         CollisionQuantityHandler *GetRunawayCollisionHandler() { return this->cqh_runaway; }
+        CoulombLogarithmCache *GetCoulombLogarithmCache() { return this->lnLambdaCache; }
+        CollisionFrequencyCache *GetCollisionFrequencyCache() { return this->collFreqCache; }
+        ADASRateCache *GetADASRateCache() { return this->adasRateCache; }
 
+        OutputStream *GetOutputStream() { return this->outputStream; }
         PostProcessor *GetPostProcessor() { return this->postProcessor; }
         RunawayFluid *GetREFluid() { return this->REFluid; }
         SPIHandler *GetSPIHandler() { return this->SPI; }
@@ -118,6 +186,7 @@ namespace DREAM {
         std::vector<real_t>& GetTimes() { return this->times; }
 
         real_t *GetUnknownData(const len_t i) { return unknowns.GetUnknownData(i); }
+        real_t *GetPrescribedData(const len_t);
         len_t GetUnknownID(const std::string& name) { return unknowns.GetUnknownID(name); }
         len_t GetNUnknowns() const { return this->unknowns.GetNUnknowns(); }
 
@@ -152,6 +221,18 @@ namespace DREAM {
             this->initializer->SetRunawayCollisionHandler(cqh);
         }
 
+        void SetCoulombLogarithmCache(CoulombLogarithmCache *c)
+        { this->lnLambdaCache = c; }
+        void SetCollisionFrequencyCache(CollisionFrequencyCache *c)
+        { this->collFreqCache = c; }
+        void SetADASRateCache(ADASRateCache *c)
+        { this->adasRateCache = c; }
+
+        void SetOutputStream(OutputStream *os)
+        { this->outputStream = os; }
+        void SetStepOutput(OutputGenerator *og)
+        { this->stepOutput = og; }
+
         void SetPostProcessor(PostProcessor *pp)
         { this->postProcessor = pp; }
 
@@ -184,11 +265,11 @@ namespace DREAM {
 			const len_t maxiter, const real_t reltol,
 			enum OptionConstants::linear_solver linear_solver,
 			enum OptionConstants::linear_solver backup_solver,
-			bool verbose
+			bool verbose, bool pseudoTransient=false
 		) {
 			this->initializer->SetSolver(
 				maxiter, reltol, linear_solver,
-				backup_solver, verbose
+				backup_solver, verbose, pseudoTransient
 			);
 		}
         void SetIonHandler(IonHandler *ih) { 
@@ -196,21 +277,57 @@ namespace DREAM {
             this->initializer->SetIonHandler(ih);
         }
         void SetOtherQuantityHandler(OtherQuantityHandler *oqh) { this->otherQuantityHandler = oqh; }
+        void SetOutputTimes(const std::vector<real_t>& t) { this->outputTimes = t; }
+        const std::vector<real_t>& GetOutputTimes() const { return this->outputTimes; }
         void SetSolver(Solver*);
-        void SetTimeStepper(TimeStepper *ts) { this->timestepper = ts; }
+        void SetTimeStepper(TimeStepper *ts) {
+            this->timestepper = ts;
+            this->unknowns.SetTimeStepperHistoryDepth(ts->GetHistoryDepth());
+        }
 
-        void SaveSolverData(SFile *sf, const std::string& n) { this->solver->WriteDataSFile(sf, n); }
+        void SaveSolverData(SFile*, const std::string&);
         void SaveTimings(SFile*, const std::string&);
 
         void Solve();
+        void BeginSolve();
+        void EndSolve();
+        bool IsFinished();
+        void TakeStep();
+        real_t GetCurrentTime() const { return this->currentTime; }
         // Info routines
         void PrintNonTrivialUnknowns();
         void PrintTrivialUnknowns();
+        void PrintCostEstimate();
+        void PrintMemoryEstimate();
 
         void SetTiming(bool stdout, bool file) {
             this->timingStdout = stdout;
             this->timingFile = file;
         }
+        void SetTraceFile(const std::string& filename) { this->traceFile = filename; }
+
+        // Checkpointing routines
+        void SetCheckpoint(const std::string& filename, const len_t nSteps, const real_t interval) {
+            this->checkpointFile = filename;
+            this->checkpointSteps = nSteps;
+            this->checkpointInterval = interval;
+        }
+        void SetResumeFile(const std::string& filename) { this->resumeFile = filename; }
+
+        void SetStatusFile(const std::string& filename, const real_t interval) {
+            this->statusFile = filename;
+            this->statusInterval = interval;
+        }
+        void SaveCheckpoint(const std::string&, const real_t);
+        real_t LoadCheckpoint(const std::string&);
+
+        // Parareal routines
+        void SetParareal(const len_t nCoarse, const len_t maxIter, const real_t reltol) {
+            this->pararealCoarseSteps = nCoarse;
+            this->pararealMaxIter = maxIter;
+            this->pararealRelTol = reltol;
+        }
+        bool IsParareal() const { return (this->pararealCoarseSteps > 0); }
     };
 
     class EquationSystemException : public DREAM::FVM::FVMException {
@@ -29,17 +29,34 @@ namespace DREAM {
             len_t id_nre;
             gsl_integration_workspace *gsl_ad_w;
 
-            gsl_spline **xi0OverXiSpline = nullptr;
-            gsl_interp_accel **xiSplineAcc = nullptr;
+            /**
+             * The exponent of the pitch distribution on passing orbits,
+             *   G(xi0) = int(xi0'/<xi>, xi0, 1),
+             * is tabulated on a uniform grid of N_XI_TABLE points on [xiT,1]
+             * at every radius, and stored as the cubic Hermite polynomial
+             * coefficients of each interval (4 per interval, ordered as
+             * [ir][interval][power]). xi0/<xi> is evaluated in N_SPLINE
+             * points and splined to construct the table.
+             */
             static const len_t N_SPLINE = 10; 
+            static constexpr len_t N_XI_TABLE = 4*(N_SPLINE-1)+1;
+            real_t *xiTable_Coeffs = nullptr;
             real_t *integralOverFullPassing = nullptr;
             
-            gsl_interp_accel **REDistNormFactor_Accel = nullptr;
-            gsl_spline **REDistNormFactor_Spline = nullptr;
+            /**
+             * The normalization factor VpRE is tabulated in X = X(A) on
+             * the same grid 'REDistNorm_X' at all radii, and stored in the
+             * same way as the pitch distribution exponent.
+             */
+            static constexpr len_t N_RE_DIST_SPLINE = 50;
+            real_t *REDistNorm_X = nullptr;
+            real_t *REDistNorm_Coeffs = nullptr;
 
             void Deallocate();
             void constructXiSpline();
             void constructVpSplines();
+
+            real_t evaluatePitchExponent(len_t ir, real_t xi0, real_t *dgdxi0);
         public:
             AnalyticDistributionRE(
                 FVM::RadialGrid*, FVM::UnknownQuantityHandler*, PitchScatterFrequency*, 
@@ -55,14 +72,11 @@ namespace DREAM {
             virtual real_t evaluateEnergyDistribution(len_t ir, real_t p, real_t *dfdp=nullptr, real_t *dfdr=nullptr) override;
             virtual real_t evaluatePitchDistribution(len_t ir, real_t xi0, real_t p, real_t *dfdxi0=nullptr, real_t *dfdp=nullptr, real_t *dfdr=nullptr) override;
 
-            real_t evaluateAnalyticPitchDistributionFromA(
-                len_t ir, real_t xi0, real_t A
-            );
-
-            real_t EvaluateVpREAtA(len_t ir, real_t A);
+            real_t EvaluateVpREAtA(len_t ir, real_t A, real_t *dVpREdA=nullptr);
 
-            real_t evaluateApproximatePitchDistributionFromA(len_t ir, real_t xi0, real_t A);
-            real_t evaluatePitchDistributionFromA(len_t ir, real_t xi0, real_t A);
+            real_t evaluatePitchDistributionFromA(
+                len_t ir, real_t xi0, real_t A, real_t *dfdxi0=nullptr, real_t *dfdA=nullptr
+            );
 
             FVM::RadialGrid *GetRadialGrid() {return this->rGrid;}
             void SetREFluid(RunawayFluid *REF){this->REFluid = REF;}
@@ -2,7 +2,9 @@
 #define _DREAM_EQUATIONS_COLLISION_FREQUENCY_HPP
 
 #include "CollisionQuantity.hpp"
+#include "DREAM/Equations/CollisionFrequencyCache.hpp"
 #include "DREAM/Equations/CoulombLogarithm.hpp"
+#include "DREAM/Equations/PsiFunctionTable.hpp"
 
 namespace DREAM {
     class CollisionFrequency : public CollisionQuantity {
@@ -20,6 +22,10 @@ namespace DREAM {
         
         CoulombLogarithm *lnLambdaEE;
         CoulombLogarithm *lnLambdaEI;
+
+        // Radial quantities shared with other collision frequencies
+        // (if 'nullptr', 'ionDensities' and 'K*Scaled' are owned by this object)
+        CollisionFrequencyCache *cache = nullptr;
         
         real_t **ionDensities = nullptr;
         real_t *Zs            = nullptr;
@@ -54,7 +60,12 @@ namespace DREAM {
         real_t *bremsTerm_fr = nullptr;
         real_t *bremsTerm_f1 = nullptr;
         real_t *bremsTerm_f2 = nullptr;
-        virtual real_t evaluateBremsstrahlungTermAtP(len_t iz, len_t Z0, real_t p, OptionConstants::eqterm_bremsstrahlung_mode brems_mode, OptionConstants::collqty_collfreq_type collfreq_type) = 0;
+        // The bremsstrahlung contribution of an ion factorizes into a
+        // charge dependent factor and a function of momentum only
+        virtual real_t evaluateBremsstrahlungShapeAtP(real_t p, OptionConstants::eqterm_bremsstrahlung_mode brems_mode, OptionConstants::collqty_collfreq_type collfreq_type) = 0;
+        virtual real_t GetBremsstrahlungChargeFactor(len_t iz, len_t Z0) = 0;
+        real_t evaluateBremsstrahlungTermAtP(len_t iz, len_t Z0, real_t p, OptionConstants::eqterm_bremsstrahlung_mode brems_mode, OptionConstants::collqty_collfreq_type collfreq_type)
+        { return GetBremsstrahlungChargeFactor(iz, Z0) * evaluateBremsstrahlungShapeAtP(p, brems_mode, collfreq_type); }
 
         real_t *ionPartialContribution    = nullptr;
         real_t *ionPartialContribution_fr = nullptr;
@@ -99,6 +110,10 @@ namespace DREAM {
 
         void setPreFactor(real_t *&preFactor, const real_t *pIn, len_t np1, len_t np2);
         void setElectronTerm(real_t **&nColdTerm, const real_t *pIn, len_t nr, len_t np1, len_t np2);
+        void setElectronTerms();
+        // The free-electron term only depends on the plasma in 'FULL' mode
+        bool electronTermDependsOnPlasma() const
+        { return collQtySettings->collfreq_mode==OptionConstants::COLLQTY_COLLISION_FREQUENCY_MODE_FULL; }
         void setScreenedTerm(real_t *&screenedTerm, const real_t *pIn, len_t np1, len_t np2);
         void setIonTerm(real_t *&ionTerm, const real_t *pIn, len_t np1, len_t np2);
         void setBremsTerm(real_t *&bremsTerm, const real_t *pIn, len_t np1, len_t np2);
@@ -136,8 +151,14 @@ namespace DREAM {
 
         void RebuildRadialTerms();
 
+        // Must be set before the first rebuild
+        void SetCache(CollisionFrequencyCache *c) { this->cache = c; }
+
         void AddNonlinearContribution();
         const real_t *GetUnknownPartialContribution(len_t id_unknown,FVM::fluxGridType) const;
+        // Same as 'GetUnknownPartialContribution()', but given on the
+        // collision momentum grid 'mg' at all radii
+        const real_t *GetCollisionGridPartialContribution(len_t id_unknown,FVM::fluxGridType) const;
         virtual real_t evaluateAtP(len_t ir, real_t p, struct collqty_settings *inSettings) override;
         virtual real_t evaluatePartialAtP(len_t ir, real_t p, len_t derivId, len_t nMultiple, struct collqty_settings *inSettings) override;
         using CollisionQuantity::evaluateAtP;
@@ -0,0 +1,50 @@
+#ifndef _DREAM_EQUATIONS_COLLISION_FREQUENCY_CACHE_HPP
+#define _DREAM_EQUATIONS_COLLISION_FREQUENCY_CACHE_HPP
+
+namespace DREAM { class CollisionFrequencyCache; }
+
+#include "FVM/config.h"
+#include "FVM/Grid/RadialGrid.hpp"
+#include "FVM/UnknownQuantityHandler.hpp"
+#include "DREAM/IonHandler.hpp"
+
+namespace DREAM {
+    class CollisionFrequencyCache {
+    private:
+        FVM::RadialGrid *rGrid;
+        FVM::UnknownQuantityHandler *unknowns;
+        IonHandler *ionHandler;
+        len_t id_Tcold, id_ni;
+
+        len_t nr = 0, nzs = 0;
+        // Ion densities (nr x nzs, indexed as in 'IonHandler::GetIndex()')
+        real_t **ionDensities = nullptr;
+        // Scaled modified Bessel functions of the second kind,
+        // exp(1/Theta)*Kn(1/Theta), with Theta = T_cold/mc^2
+        real_t *K0Scaled = nullptr;
+        real_t *K1Scaled = nullptr;
+        real_t *K2Scaled = nullptr;
+
+        // Versions of T_cold and n_i for which the stored
+        // quantities were evaluated
+        bool valid_ni = false, valid_Tcold = false;
+        len_t version_ni = 0, version_Tcold = 0;
+
+        void Allocate();
+        void Deallocate();
+
+    public:
+        CollisionFrequencyCache(FVM::RadialGrid*, FVM::UnknownQuantityHandler*, IonHandler*);
+        ~CollisionFrequencyCache();
+
+        bool Update();
+
+        len_t GetNr() const { return this->nr; }
+        real_t **GetIonDensities() { return this->ionDensities; }
+        real_t *GetK0Scaled() { return this->K0Scaled; }
+        real_t *GetK1Scaled() { return this->K1Scaled; }
+        real_t *GetK2Scaled() { return this->K2Scaled; }
+    };
+}
+
+#endif/*_DREAM_EQUATIONS_COLLISION_FREQUENCY_CACHE_HPP*/
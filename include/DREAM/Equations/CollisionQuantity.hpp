@@ -40,13 +40,20 @@ namespace DREAM {
         void AllocateCollisionQuantities();
         void DeallocateCollisionQuantity(real_t **&collisionQuantity, len_t nr);
         bool parametersHaveChanged();
+        void SetCollisionMomentumGrid(FVM::Grid*);
         
     protected:
         bool gridRebuilt = true;
-        // XXX we assume explicitly that CollisionQuantities have
-        // the same MomentumGrid at all radii 
+        // Momentum grid on which the collision quantities are evaluated
+        // at all radii. If the momentum grid of 'grid' varies with radius,
+        // all radii must share the same p grid, and 'mg' is the grid with
+        // the finest xi resolution (on p-xi grids the collision quantities
+        // are independent of xi, so that the values on a coarser xi grid
+        // are given by the first rows of the values on 'mg')
         FVM::MomentumGrid *mg;
         FVM::RadialGrid *rGrid;
+        FVM::Grid *grid;
+        bool isRadiallyUniform;
         bool isPXiGrid;
         bool isNonlinear;
         bool isNonScreened;
@@ -77,6 +84,12 @@ namespace DREAM {
         real_t **collisionQuantity_f1 = nullptr;
         real_t **collisionQuantity_f2 = nullptr;
 
+        // Partial contributions rearranged for the momentum grids of
+        // 'grid' (see 'PackPartialContribution()')
+        mutable real_t *packedPartialContribution[4] = {nullptr, nullptr, nullptr, nullptr};
+        mutable len_t packedPartialContributionSize[4] = {0, 0, 0, 0};
+        const real_t *PackPartialContribution(const real_t*, FVM::fluxGridType, const len_t nMultiples) const;
+
     public: 
 
         CollisionQuantity(FVM::Grid *g, FVM::UnknownQuantityHandler *u, IonHandler *ih,  
@@ -21,7 +21,9 @@ namespace DREAM {
         ParallelDiffusionFrequency *nuPar;
     public:
         CollisionQuantityHandler(FVM::Grid *g, FVM::UnknownQuantityHandler *u, IonHandler *ih,  
-                enum OptionConstants::momentumgrid_type mgtype,  CollisionQuantity::collqty_settings *cqset);
+                enum OptionConstants::momentumgrid_type mgtype,  CollisionQuantity::collqty_settings *cqset,
+                CoulombLogarithmCache *lnLambdaCache=nullptr,
+                CollisionFrequencyCache *collFreqCache=nullptr);
         ~CollisionQuantityHandler();
 
         void gridRebuilt();
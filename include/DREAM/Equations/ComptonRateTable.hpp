@@ -0,0 +1,47 @@
+#ifndef _DREAM_EQUATIONS_COMPTON_RATE_TABLE_HPP
+#define _DREAM_EQUATIONS_COMPTON_RATE_TABLE_HPP
+
+#include <gsl/gsl_integration.h>
+#include "FVM/config.h"
+
+namespace DREAM {
+    class ComptonRateTable {
+    private:
+        // Tabulated region in the critical momentum pc (outside
+        // of which quadrature is used)
+        static constexpr real_t PC_MIN = 1e-2;
+        static constexpr real_t PC_MAX = 1e2;
+
+        // Maximum relative interpolation error allowed (in the
+        // rate and in its derivative)
+        static constexpr real_t RELTOL = 1e-6;
+        // Relative tolerance of the quadrature used to build the table
+        static constexpr real_t QUADRATURE_RELTOL = 1e-8;
+        static constexpr len_t MAX_N = 4097;
+
+        // Number of grid points in x = ln(pc)
+        len_t n=0;
+        real_t h, x0;
+        // Value and derivative of ln(rate) at each node, stored
+        // as table[2*i + k] with k = (ln(R), d(ln R)/dx)
+        real_t *table = nullptr;
+        bool valid = false;
+
+        gsl_integration_workspace *gsl_ad_w;
+
+        ComptonRateTable();
+        ~ComptonRateTable();
+
+        void Build(const len_t);
+        real_t GetMaxMidpointError();
+        real_t Interpolate(const real_t, real_t*) const;
+
+    public:
+        static const ComptonRateTable *GetInstance();
+
+        bool IsTabulated(const real_t pc) const;
+        real_t Evaluate(const real_t pc, const real_t photonFlux, real_t *dRdpc=nullptr) const;
+    };
+}
+
+#endif/*_DREAM_EQUATIONS_COMPTON_RATE_TABLE_HPP*/
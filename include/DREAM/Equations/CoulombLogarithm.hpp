@@ -3,6 +3,7 @@
 
 #include "FVM/config.h"
 #include "CollisionQuantity.hpp"
+#include "CoulombLogarithmCache.hpp"
 #include "FVM/Grid/Grid.hpp"
 #include "FVM/Grid/RadialGrid.hpp"
 #include "FVM/Grid/MomentumGrid.hpp"
@@ -26,6 +27,12 @@ namespace DREAM {
 
         bool isLnEE = false;
         bool isLnEI = false;
+
+        // Cache of the radial logarithms shared with other
+        // CoulombLogarithm objects (not owned by this object)
+        CoulombLogarithmCache *cache = nullptr;
+
+        void UpdateRadialTerms();
         
         void AssembleConstantLnLambda(real_t **&lnLambda, len_t nr, len_t np1, len_t np2);
         void AssembleWithPXiGrid(real_t **&lnLambda,const real_t *pVec, len_t nr, len_t np1, len_t np2);
@@ -42,7 +49,7 @@ namespace DREAM {
     public:
         CoulombLogarithm(FVM::Grid *g, FVM::UnknownQuantityHandler *u, IonHandler *ih,  
                 enum OptionConstants::momentumgrid_type mgtype,  struct collqty_settings *cqset,
-                LnLambdaType lnLambdaType);
+                LnLambdaType lnLambdaType, CoulombLogarithmCache *cache=nullptr);
         ~CoulombLogarithm();
 
         void RebuildRadialTerms();
@@ -63,8 +70,10 @@ namespace DREAM {
 
         real_t evaluateLnLambdaC(len_t ir);
         real_t evaluateLnLambdaT(len_t ir);
-        real_t evaluateLnLambdaT(real_t T, real_t n);
         real_t evaluateLnLambdaII(len_t ir);
+        static real_t evaluateLnLambdaC(real_t T, real_t n);
+        static real_t evaluateLnLambdaT(real_t T, real_t n);
+        static real_t evaluateLnLambdaII(real_t T, real_t n);
     };
 }
 
@@ -0,0 +1,45 @@
+#ifndef _DREAM_EQUATIONS_COULOMB_LOGARITHM_CACHE_HPP
+#define _DREAM_EQUATIONS_COULOMB_LOGARITHM_CACHE_HPP
+
+namespace DREAM { class CoulombLogarithmCache; }
+
+#include "FVM/config.h"
+#include "FVM/Grid/RadialGrid.hpp"
+#include "FVM/UnknownQuantityHandler.hpp"
+#include "DREAM/IonHandler.hpp"
+
+namespace DREAM {
+    class CoulombLogarithmCache {
+    private:
+        FVM::RadialGrid *rGrid;
+        FVM::UnknownQuantityHandler *unknowns;
+        IonHandler *ionHandler;
+        len_t id_Tcold, id_ni;
+
+        len_t nr = 0;
+        real_t *lnLambda_c  = nullptr;
+        real_t *lnLambda_T  = nullptr;
+        real_t *lnLambda_ii = nullptr;
+
+        // Versions of T_cold and n_i for which the stored
+        // logarithms were evaluated
+        bool valid = false;
+        len_t version_Tcold = 0, version_ni = 0;
+
+        void Allocate();
+        void Deallocate();
+
+    public:
+        CoulombLogarithmCache(FVM::RadialGrid*, FVM::UnknownQuantityHandler*, IonHandler*);
+        ~CoulombLogarithmCache();
+
+        bool Update();
+
+        len_t GetNr() const { return this->nr; }
+        real_t *GetLnLambdaC() { return this->lnLambda_c; }
+        real_t *GetLnLambdaT() { return this->lnLambda_T; }
+        real_t *GetLnLambdaII() { return this->lnLambda_ii; }
+    };
+}
+
+#endif/*_DREAM_EQUATIONS_COULOMB_LOGARITHM_CACHE_HPP*/
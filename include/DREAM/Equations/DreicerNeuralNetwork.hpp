@@ -3,6 +3,7 @@
 
 namespace DREAM { class DreicerNeuralNetwork; }
 
+#include <vector>
 #include "DREAM/Equations/RunawayFluid.hpp"
 #include "FVM/config.h"
 
@@ -17,16 +18,33 @@ namespace DREAM {
         static const real_t b1[20],    b2[20],     b3[20],     b4[20],     b5[1];
         static const real_t W1[20*8], W2[20*20], W3[20*20], W4[20*20], W5[1*20];
 
+        // Work space for batched evaluation of the network
+        std::vector<real_t> batchWork;
+
         void nn_layer(
             const len_t, const len_t,
             const real_t*, const real_t*,
             const real_t*, real_t*, bool applyTransferFunction=true
         );
+        void nn_layer_batch(
+            const len_t, const len_t, const len_t,
+            const real_t*, const real_t*,
+            const real_t*, real_t*, bool applyTransferFunction=true
+        );
+        void nn_layer_batch_adjoint(
+            const len_t, const len_t, const len_t,
+            const real_t*, const real_t*, const real_t*, real_t*
+        );
 
     public:
         DreicerNeuralNetwork(RunawayFluid*);
 
         real_t RunawayRate(const len_t, const real_t, const real_t, const real_t);
+        void RunawayRate(
+            const len_t, const real_t*, const real_t*, const real_t*,
+            real_t*, real_t *dGamma_dE=nullptr, real_t *dGamma_dntot=nullptr,
+            real_t *dGamma_dT=nullptr
+        );
         real_t RunawayRate_derived_params(
             const real_t, const real_t, const real_t,
             const real_t, const real_t, const real_t,
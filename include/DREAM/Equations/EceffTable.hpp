@@ -0,0 +1,41 @@
+#ifndef _DREAM_EQUATIONS_ECEFF_TABLE_HPP
+#define _DREAM_EQUATIONS_ECEFF_TABLE_HPP
+
+#include "FVM/config.h"
+
+namespace DREAM {
+    class EceffTable {
+    private:
+        len_t nr, nZeff, nT;
+        // Grid in Zeff and ln(T)
+        real_t *Zeff, *lnT;
+        // Tabulated Eceff/Ectot and (estimated) relative error of
+        // the tabulated values, stored as v[(ir*nZeff + iZ)*nT + iT]
+        real_t *EceffOverEctot;
+        real_t *error;
+        // Largest relative error accepted in a table lookup
+        real_t tolerance;
+
+        // Lookup statistics
+        len_t nLookups=0, nHits=0;
+
+        len_t FindInterval(const real_t, const real_t*, const len_t) const;
+
+    public:
+        EceffTable(
+            const len_t nr, const len_t nZeff, const len_t nT,
+            const real_t *Zeff, const real_t *T, const real_t *EceffOverEctot,
+            const real_t *error=nullptr, const real_t tolerance=0
+        );
+        ~EceffTable();
+
+        len_t GetNr() const { return this->nr; }
+
+        bool Evaluate(const len_t ir, const real_t Zeff, const real_t T, real_t *EceffOverEctot);
+
+        len_t GetNLookups() const { return this->nLookups; }
+        len_t GetNHits() const { return this->nHits; }
+    };
+}
+
+#endif/*_DREAM_EQUATIONS_ECEFF_TABLE_HPP*/
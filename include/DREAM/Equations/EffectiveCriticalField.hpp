@@ -7,6 +7,7 @@ namespace DREAM { class EffectiveCriticalField; }
 
 #include "DREAM/Equations/REPitchDistributionAveragedBACoeff.hpp"
 #include "DREAM/Equations/AnalyticDistributionRE.hpp"
+#include "DREAM/Equations/EceffTable.hpp"
 #include "DREAM/Equations/PitchScatterFrequency.hpp"
 #include "DREAM/Equations/RunawayFluid.hpp"
 #include "DREAM/Equations/SlowingDownFrequency.hpp"
@@ -76,13 +77,21 @@ namespace DREAM {
         real_t *ECRIT_ECEFFOVERECTOT_PREV = nullptr; // Eceff / Ectot in previous time step, used to accelerate Eceff algorithm
         real_t *ECRIT_POPTIMUM_PREV=nullptr;         // value of p which minimizes -U(p,Eceff)
 
+        // Optional table of precomputed Eceff values
+        EceffTable *table = nullptr;
+
+        // Root finding statistics
+        len_t nEceffSolves=0, nEceffIterations=0, nEceffNotConverged=0;
+
     public:
         EffectiveCriticalField(ParametersForEceff*, AnalyticDistributionRE*);
         ~EffectiveCriticalField();
 
         bool GridRebuilt();
-        void CalculateEffectiveCriticalField(const real_t *Ec_tot, const real_t *Ec_free, real_t *effectiveCriticalField);
+        void CalculateEffectiveCriticalField(const real_t *Ec_tot, const real_t *Ec_free, real_t *effectiveCriticalField, const real_t *T_cold=nullptr);
+        void SetTable(EceffTable*);
         real_t CalculateEceffPPCFPaper(len_t ir);
+        void PrintRootFindingStatistics();
 
         static real_t FindUExtremumAtE(real_t Eterm, void *par);
         static real_t FindUExtremumAtE_df(real_t Eterm, void *par);
@@ -24,6 +24,9 @@ namespace DREAM::FVM::BC {
 
         virtual len_t GetNumberOfNonZerosPerRow() const override { return 1; }
 
+        // Reads the coefficients of another equation in 'Rebuild()'
+        virtual bool IsThreadSafe() const override { return false; }
+
         virtual bool Rebuild(const real_t, UnknownQuantityHandler*) override;
 
         virtual bool AddToJacobianBlock(const len_t, const len_t, DREAM::FVM::Matrix*, const real_t*) override;
@@ -29,6 +29,9 @@ namespace DREAM {
 
         virtual void SetMatrixElements(FVM::Matrix* mat, real_t*) override; 
         virtual void SetVectorElements(real_t* vec, const real_t* x) override;
+
+        // This term operates on the ion densities (not on the diagonal)
+        virtual bool IsFusable() const override { return false; }
     };
 }
 
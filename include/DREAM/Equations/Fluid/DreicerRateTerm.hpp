@@ -31,6 +31,9 @@ namespace DREAM {
         // Derivative of runaway rate w.r.t. E/E_D,
         // times E/E_D
         real_t *EED_dgamma_dEED;
+        // Derivatives of the neural network runaway rate
+        // w.r.t. E, n_tot and T_cold
+        real_t *dgamma_dE, *dgamma_dntot, *dgamma_dT;
 
         const real_t *data_E_field, *data_n_cold, *data_n_tot, *data_T_cold;
 
@@ -11,10 +11,11 @@ namespace DREAM {
         const len_t id_ions;
         real_t scaleFactor;
         
-        real_t dt;
+        real_t dt = 0;
         real_t *nions_prev;
     protected:
         virtual bool TermDependsOnUnknowns() override {return true;}
+        virtual bool IsJacobianConstant() const override { return false; }
         virtual len_t GetNumberOfWeightsElements() override
             {return ionHandler->GetNzs()*grid->GetNCells();}        
         virtual void SetWeights() override;
@@ -28,6 +29,9 @@ namespace DREAM {
         virtual void SetMatrixElements(FVM::Matrix*, real_t*) override;
         virtual void SetVectorElements(real_t*, const real_t*) override;
 
+        // This term operates on the ion densities (not on the diagonal)
+        virtual bool IsFusable() const override { return false; }
+
     };
 }
 #endif/*_DREAM_EQUATION_FLUID_FREE_ELECTRON_DENSITY_TRANSIENT_TERM_HPP*/
@@ -15,12 +15,20 @@ namespace DREAM {
 
         FVM::UnknownQuantityHandler *unknowns;
 
-        real_t *dD=nullptr;
+        // Geometric factor of the diffusion coefficient, which only
+        // changes with the grid (on the radial flux grid)
+        real_t *geometry=nullptr;
+        bool geometryValid=false;
+        // Derivatives of the diffusion coefficient with respect to
+        // n_cold and T_cold (evaluated together with the coefficient)
+        real_t *dD_dn=nullptr, *dD_dT=nullptr;
 
         // IDs of unknown quantities used by the operator...
         len_t id_n_cold, id_T_cold;
 
         void AllocateDiffCoeff();
+        void DeallocateDiffCoeff();
+        void SetGeometry();
         virtual void SetPartialDiffusionTerm(len_t, len_t) override;
 
     public:
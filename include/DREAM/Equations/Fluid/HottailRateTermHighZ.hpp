@@ -19,6 +19,9 @@ namespace DREAM {
             id_tau;
 
         real_t *pCrit_prev = nullptr;
+        // PcFunc and its derivative with respect to p, evaluated at pCrit
+        real_t *PcFuncAtPc = nullptr;
+        real_t *dPcFuncdpAtPc = nullptr;
 
         gsl_root_fdfsolver *fdfsolver;
         gsl_function_fdf gsl_func;
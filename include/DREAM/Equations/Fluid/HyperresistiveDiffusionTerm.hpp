@@ -13,9 +13,19 @@ namespace DREAM {
     private:
         FVM::Interpolator1D *Lambda; 
 
+        // Geometric factor multiplying Lambda in the diffusion
+        // coefficient (on the radial flux grid)
+        real_t *geometry=nullptr;
+        bool geometryValid=false;
+
+        void SetGeometry();
+
     public:
         HyperresistiveDiffusionTerm(FVM::Grid*, FVM::Interpolator1D*);
+        ~HyperresistiveDiffusionTerm();
         
+        virtual bool GridRebuilt() override;
+
         const real_t *GetLambda() const { return Lambda->GetBuffer(); }
         virtual void Rebuild(const real_t, const real_t, FVM::UnknownQuantityHandler*) override;
     };
@@ -4,6 +4,7 @@
 #include "DREAM/Equations/Fluid/IonEquationTerm.hpp"
 #include "DREAM/IonHandler.hpp"
 #include "FVM/Grid/Grid.hpp"
+#include <type_traits>
 #include "FVM/Equation/DiffusionTerm.hpp"
 
 namespace DREAM {
@@ -12,9 +13,16 @@ namespace DREAM {
     protected:
 		real_t **CoeffsAllCS = nullptr;
 		len_t Z0ForPartials;
+
+		// Diffusion coefficients of all charge states (excluding neutral)
+		// on the radial flux grid, with the charge state as the inner
+		// (contiguous) index; only used for diffusion terms on the fluid grid
+		real_t *DrrAllCS = nullptr;
 		
 		void Allocate();
 		void Deallocate();
+		void RebuildDrrAllCS();
+		void SetVectorElementsAllCS(real_t*, const real_t*);
 		virtual void SetCoeffs(const len_t Z0)=0;
 		virtual void SetCoeffsAllCS(const real_t t)=0;
 		virtual void SetDiffCoeffsAllCS(const real_t t)=0;
@@ -25,6 +33,8 @@ namespace DREAM {
 		virtual ~IonChargedAdvectionDiffusionTerm();
 		
 		virtual void Rebuild(const real_t, const real_t, FVM::UnknownQuantityHandler*) override;
+
+		virtual void SetVectorElements(real_t*, const real_t*) override;
 		
 		virtual bool SetCSJacobianBlock(
 		    const len_t uqtyId, const len_t derivId, FVM::Matrix *jac, const real_t *nions,
@@ -26,25 +26,117 @@ void IonChargedAdvectionDiffusionTerm<T>::Allocate(){
     const len_t nr = this->grid->GetNr();
 
 	// Allocate memory for one diffusion coefficient of every charged state (excluding neutral) 
-	// and every radial grid point
+	// and every radial grid point (in one contiguous block)
     this->CoeffsAllCS = new real_t*[this->Zion];
-    for(len_t Z0=1; Z0<=this->Zion; Z0++)
-        this->CoeffsAllCS[Z0-1] = new real_t[nr+1];
+    this->CoeffsAllCS[0] = new real_t[this->Zion*(nr+1)];
+    for(len_t Z0=2; Z0<=this->Zion; Z0++)
+        this->CoeffsAllCS[Z0-1] = this->CoeffsAllCS[Z0-2] + (nr+1);
+
+    // Charge-state-interleaved copy of the diffusion coefficients, used
+    // for evaluating all charge states in a single sweep over the radial
+    // grid (the momentum grid must then be trivial)
+    if constexpr (std::is_same<T, FVM::DiffusionTerm>::value) {
+        if (this->grid->GetNCells() == nr)
+            this->DrrAllCS = new real_t[this->Zion*(nr+1)];
+    }
 }
 
 template<class T>
 void IonChargedAdvectionDiffusionTerm<T>::Deallocate() {
+    if(DrrAllCS != nullptr){
+        delete [] this->DrrAllCS;
+        this->DrrAllCS = nullptr;
+    }
+
     if(CoeffsAllCS == nullptr)
         return;
-    for(len_t Z0=1; Z0<=this->Zion; Z0++)
-        delete [] this->CoeffsAllCS[Z0-1];
+    delete [] this->CoeffsAllCS[0];
     delete [] this->CoeffsAllCS;
+    this->CoeffsAllCS = nullptr;
 }
 
 template<class T>
 void IonChargedAdvectionDiffusionTerm<T>::Rebuild(const real_t t, const real_t, FVM::UnknownQuantityHandler*){
 	SetCoeffsAllCS(t);
 	SetDiffCoeffsAllCS(t);
+
+    if constexpr (std::is_same<T, FVM::DiffusionTerm>::value) {
+        if (this->DrrAllCS != nullptr)
+            RebuildDrrAllCS();
+    }
+}
+
+/**
+ * Gather the diffusion coefficients of all charge states, as set
+ * by 'SetCoeffs()', into the charge-state-interleaved array 'DrrAllCS'.
+ */
+template<class T>
+void IonChargedAdvectionDiffusionTerm<T>::RebuildDrrAllCS() {
+    if constexpr (std::is_same<T, FVM::DiffusionTerm>::value) {
+        const len_t nr = this->grid->GetNr();
+        const len_t nZ = this->Zion;
+
+        for(len_t Z0=1; Z0<=nZ; Z0++){
+            SetCoeffs(Z0);
+            for(len_t ir=0; ir<nr+1; ir++)
+                this->DrrAllCS[ir*nZ + Z0-1] = this->Drr(ir, 0, 0);
+        }
+    }
+}
+
+/**
+ * Set the function vector corresponding to this term. For diffusion
+ * terms on the fluid grid, all charge states are evaluated at once
+ * (instead of once per charge state via the generic DiffusionTerm).
+ */
+template<class T>
+void IonChargedAdvectionDiffusionTerm<T>::SetVectorElements(real_t *vec, const real_t *x) {
+    if constexpr (std::is_same<T, FVM::DiffusionTerm>::value) {
+        if (this->DrrAllCS != nullptr) {
+            SetVectorElementsAllCS(vec, x);
+            return;
+        }
+    }
+
+    this->IonEquationTerm<T>::SetVectorElements(vec, x);
+}
+
+/**
+ * Evaluate the radial diffusion term for all charge states of the ion
+ * in one sweep over the radial grid. This is the stencil of
+ * 'DiffusionTerm::SetVectorElements()' for a trivial momentum grid,
+ * with the geometric factors computed once per radius and the charge
+ * state as the inner loop.
+ */
+template<class T>
+void IonChargedAdvectionDiffusionTerm<T>::SetVectorElementsAllCS(real_t *vec, const real_t *x) {
+    const len_t nr = this->grid->GetNr();
+    const len_t nZ = this->Zion;
+    const real_t
+        *dr   = this->grid->GetRadialGrid()->GetDr(),
+        *dr_f = this->grid->GetRadialGrid()->GetDr_f();
+
+    // Offset to the first charged state of this ion
+    const len_t offset = this->ions->GetIndex(this->iIon, 1)*nr;
+    real_t *v = vec + offset;
+    const real_t *xZ = x + offset;
+
+    for(len_t ir=0; ir<nr; ir++){
+        const real_t Vp = this->grid->GetVp(ir)[0];
+
+        // Phi^(r)_{k-1/2} and Phi^(r)_{k+1/2} (no flux is set
+        // across the inner and outer boundaries)
+        const len_t kl = (ir > 0), ku = (ir < nr-1);
+        const real_t wl = kl ? this->grid->GetVp_fr(ir)[0] / (dr[ir]*dr_f[ir-1]*Vp) : 0;
+        const real_t wu = ku ? this->grid->GetVp_fr(ir+1)[0] / (dr[ir]*dr_f[ir]*Vp) : 0;
+
+        const real_t *Dl = this->DrrAllCS + ir*nZ;
+        const real_t *Du = Dl + nZ;
+        for(len_t iZ=0; iZ<nZ; iZ++){
+            const len_t k = iZ*nr + ir;
+            v[k] += wl*Dl[iZ]*(xZ[k]-xZ[k-kl]) + wu*Du[iZ]*(xZ[k]-xZ[k+ku]);
+        }
+    }
 }
 
 template<class T>
@@ -23,6 +23,10 @@ namespace DREAM {
         real_t **IntegrandAllCS = nullptr;
         len_t tableIndexIon;
         real_t *tmpVec;
+        // Distribution function multiplied by the moment quadrature weights
+        real_t *weightedF = nullptr;
+        // Ionization rates of all charge states (size Zion x nr)
+        real_t *rates = nullptr;
         
         // number of parameters used in the fit
         static const len_t nParamsForFit;
@@ -34,10 +38,13 @@ namespace DREAM {
         static real_t EvaluateIonizationCrossSection(real_t p, const real_t *params);
         static int_t GetTableIndex(len_t Z);
 
+        const FVM::MomentumGrid *GetIntegrandMomentumGrid() const;
         void Allocate();
         void Deallocate();
         void SetIntegrand(const len_t Z0);
         void RebuildIntegrand();
+        void RebuildRates(const real_t*);
+        void AddCSRates(real_t*, const len_t Z0);
 
         len_t Z0ForDiffIntegrand;
         len_t rOffsetForDiffIntegrand;
@@ -61,6 +68,9 @@ namespace DREAM {
         virtual bool GridRebuilt() override;
         virtual void Rebuild(const real_t, const real_t, FVM::UnknownQuantityHandler*) override{}
 
+        virtual bool SetJacobianBlock(const len_t, const len_t, FVM::Matrix*, const real_t*) override;
+        virtual void SetVectorElements(real_t*, const real_t*) override;
+
         virtual bool SetCSJacobianBlock(
             const len_t uqtyId, const len_t derivId, FVM::Matrix *jac, const real_t *nions,
             const len_t iIon, const len_t Z0, const len_t rOffset
@@ -2,6 +2,7 @@
 #define _DREAM_EQUATION_ION_RATE_EQUATION_HPP
 
 #include "DREAM/ADAS.hpp"
+#include "DREAM/ADASRateCache.hpp"
 #include "DREAM/Equations/Fluid/IonEquationTerm.hpp"
 #include "DREAM/IonHandler.hpp"
 #include "FVM/Grid/Grid.hpp"
@@ -12,6 +13,9 @@ namespace DREAM {
     protected:
         enum SetMode {MATRIX, JACOBIAN};
         ADAS *adas;
+        // Cache of the rate coefficients shared with other terms
+        // (only used if not 'nullptr')
+        ADASRateCache *rateCache;
         FVM::UnknownQuantityHandler *unknowns;
         len_t id_ions, id_n_cold, id_n_tot, id_T_cold;
         bool addFluidIonization; // the full ADAS ionization rate is added in this equation term
@@ -26,7 +30,8 @@ namespace DREAM {
     public:
         IonRateEquation(
             FVM::Grid*, IonHandler*, const len_t, ADAS*, 
-            FVM::UnknownQuantityHandler*,bool,bool,bool
+            FVM::UnknownQuantityHandler*,bool,bool,bool,
+            ADASRateCache *rateCache=nullptr
         );
         virtual ~IonRateEquation();
 
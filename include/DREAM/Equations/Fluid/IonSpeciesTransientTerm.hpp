@@ -25,8 +25,8 @@ namespace DREAM{
         virtual len_t GetNumberOfNonZerosPerRow() const override { return 1; }
         virtual len_t GetNumberOfNonZerosPerRow_jac() const override { return 1; }
         virtual void Rebuild(const real_t, const real_t dt, FVM::UnknownQuantityHandler *u) override {
-            this->dt = dt;
-            this->xPrev = u->GetUnknownDataPrevious(this->unknownId);
+            this->dt = u->GetTransientTimeStep(dt);
+            this->xPrev = u->GetUnknownDataTransientPrevious(this->unknownId, dt);
         }
 
         virtual bool SetJacobianBlock(const len_t uqtyId, const len_t derivId, FVM::Matrix *jac, const real_t*) override {
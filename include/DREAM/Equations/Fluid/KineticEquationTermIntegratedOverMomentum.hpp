@@ -41,6 +41,10 @@ namespace DREAM {
 
         virtual void Rebuild(const real_t, const real_t, FVM::UnknownQuantityHandler*) override;
         virtual bool GridRebuilt() override;
+        // Builds jacobian blocks of an operator belonging to another
+        // equation, as well as calls PETSc, and so cannot be built
+        // concurrently with other equations
+        virtual bool IsThreadSafe() const override { return false; }
         virtual void SetMatrixElements(FVM::Matrix*, real_t*) override;
         virtual bool SetJacobianBlock(const len_t uqtyId, const len_t derivId, FVM::Matrix*, const real_t*) override;
         virtual void SetVectorElements(real_t*, const real_t*) override;
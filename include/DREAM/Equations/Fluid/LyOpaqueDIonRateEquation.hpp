@@ -17,34 +17,30 @@ namespace DREAM {
     	virtual void Rebuild(const real_t, const real_t, FVM::UnknownQuantityHandler*) override{
     		const len_t Nr = this->grid->GetNr();
 
-			real_t *T = unknowns->GetUnknownData(id_T_cold);
-			real_t *n = unknowns->GetUnknownData(id_n_cold);
+			const real_t *T = unknowns->GetUnknownData(id_T_cold);
+			const real_t *n = unknowns->GetUnknownData(id_n_cold);
 
-			real_t eps = sqrt(std::numeric_limits<real_t>::epsilon());
-			// Iterate over charge state (0 ... Z)
-			for (len_t i = 0; i < Nr; i++){
-				real_t hn = eps*(1 + n[i]);
-				real_t hT = eps*(1 + T[i]);
-				for (len_t Z0 = 0; Z0 <= Zion; Z0++){
-					Rec[Z0][i]         = amjuel->getRecLyOpaque(Z0, n[i], T[i]);
-					PartialNRec[Z0][i] = (amjuel->getRecLyOpaque(Z0, n[i]+hn, T[i]) - amjuel->getRecLyOpaque(Z0, n[i], T[i]))/hn;
-					PartialTRec[Z0][i] = (amjuel->getRecLyOpaque(Z0, n[i], T[i]+hT) - amjuel->getRecLyOpaque(Z0, n[i], T[i]))/hT;
-					Ion[Z0][i]         = 0;
-					PartialNIon[Z0][i] = 0;
-					PartialTIon[Z0][i] = 0;
-				}
-			}
 			// if not covered by the kinetic ionization model, set fluid ionization rates
-			if(addFluidIonization || addFluidJacobian)
-				for (len_t i = 0; i < Nr; i++){
-					real_t hn = eps*(1 + n[i]);
-					real_t hT = eps*(1 + T[i]);
-					for (len_t Z0 = 0; Z0 <= Zion; Z0++){
-						Ion[Z0][i]         = amjuel->getIonizLyOpaque(Z0, n[i], T[i]);
-						PartialNIon[Z0][i] = (amjuel->getIonizLyOpaque(Z0, n[i]+hn, T[i]) - amjuel->getIonizLyOpaque(Z0, n[i], T[i]))/hn;
-						PartialTIon[Z0][i] = (amjuel->getIonizLyOpaque(Z0, n[i], T[i]+hT) - amjuel->getIonizLyOpaque(Z0, n[i], T[i]))/hT;
+			// (the recombination and ionization rates, and their derivatives, are
+			// evaluated together for each charge state)
+			const bool fluidIonization = (addFluidIonization || addFluidJacobian);
+			const enum AMJUEL::rate_coefficient r[2] = {
+				AMJUEL::REC_LY_OPAQUE, AMJUEL::IONIZ_LY_OPAQUE
+			};
+			// Iterate over charge state (0 ... Z)
+			for (len_t Z0 = 0; Z0 <= Zion; Z0++){
+				real_t *R[2]    = {Rec[Z0], Ion[Z0]};
+				real_t *dRdn[2] = {PartialNRec[Z0], PartialNIon[Z0]};
+				real_t *dRdT[2] = {PartialTRec[Z0], PartialTIon[Z0]};
+				amjuel->Eval(fluidIonization ? 2 : 1, r, Z0, Nr, n, T, R, dRdn, dRdT);
+
+				if (!fluidIonization)
+					for (len_t i = 0; i < Nr; i++){
+						Ion[Z0][i]         = 0;
+						PartialNIon[Z0][i] = 0;
+						PartialTIon[Z0][i] = 0;
 					}
-				}
+			}
 		}
 	};
 }
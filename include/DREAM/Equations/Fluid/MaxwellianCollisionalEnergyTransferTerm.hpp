@@ -1,6 +1,7 @@
 #ifndef _DREAM_EQUATION_FLUID_MAXWELLIAN_COLLISIONAL_ENERGY_TRANSFER_TERM_HPP
 #define _DREAM_EQUATION_FLUID_MAXWELLIAN_COLLISIONAL_ENERGY_TRANSFER_TERM_HPP
 
+#include <vector>
 #include "FVM/Equation/EvaluableEquationTerm.hpp"
 #include "FVM/Grid/Grid.hpp"
 #include "FVM/UnknownQuantityHandler.hpp"
@@ -25,7 +26,22 @@ namespace DREAM{
             id_Ni, id_Wi;
 
         struct CollisionQuantity::collqty_settings *lnLambda_settings;
-        void GetParametersForSpecies(len_t ir, len_t index, bool isIon, real_t &n, real_t &W, real_t &nZ2);
+
+        // Energy transfer rate in every radial grid point, and its partial
+        // derivatives with respect to n_i, n_j, W_i, W_j, as well as the
+        // rate divided by nZ2_i and nZ2_j (all zero where the rate vanishes
+        // identically, as indicated by 'active'). The rates are evaluated
+        // for all radii at once, and only when the plasma has changed
+        // ('versions' holds the versions of the unknowns they were
+        // evaluated for).
+        std::vector<real_t> nZ2_i, nZ2_j;
+        std::vector<real_t> Q, dQ_ni, dQ_nj, dQ_Wi, dQ_Wj, QOverNZ2_i, QOverNZ2_j;
+        std::vector<char> active;
+        len_t versions[5] = {0,0,0,0,0};
+        bool evaluated = false;
+
+        void Evaluate();
+        void GetParametersForSpecies(len_t index, bool isIon, const real_t *&n, const real_t *&W, real_t *nZ2);
     public:
         MaxwellianCollisionalEnergyTransferTerm(
             FVM::Grid *g, 
@@ -35,7 +51,8 @@ namespace DREAM{
         );
         ~MaxwellianCollisionalEnergyTransferTerm() {delete lnLambda_settings;}
         virtual len_t GetNumberOfNonZerosPerRow() const override { return 0; }
-        virtual void Rebuild(const real_t, const real_t, FVM::UnknownQuantityHandler*) override {}
+        // (the Coulomb logarithm may have changed)
+        virtual void Rebuild(const real_t, const real_t, FVM::UnknownQuantityHandler*) override { this->evaluated = false; }
 
         virtual bool SetJacobianBlock(const len_t uqtyI, const len_t derivId, FVM::Matrix*, const real_t*) override;
         virtual void SetVectorElements(real_t*, const real_t*) override;
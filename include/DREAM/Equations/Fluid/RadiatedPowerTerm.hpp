@@ -7,6 +7,7 @@
 #include "DREAM/Equations/RunawayFluid.hpp"
 #include "DREAM/IonHandler.hpp"
 #include "DREAM/ADAS.hpp"
+#include "DREAM/ADASRateCache.hpp"
 #include "DREAM/NIST.hpp"
 #include "DREAM/AMJUEL.hpp"
 
@@ -14,6 +15,9 @@ namespace DREAM {
     class RadiatedPowerTerm : public FVM::DiagonalComplexTerm {
     private:
         ADAS *adas;
+        // Cache of the ADAS rates shared with other terms
+        // (only used if not 'nullptr')
+        ADASRateCache *rateCache;
         NIST *nist;
         AMJUEL *amjuel;
         IonHandler *ionHandler;
@@ -30,6 +34,36 @@ namespace DREAM {
             bremsRel2;
             
         bool includePRB = true;
+
+        // Scratch buffers for ADAS rate coefficients (and their
+        // derivatives) of a single charge state in all cells
+        enum adas_rate_index {
+            RATE_PLT=0, RATE_PRB=1, RATE_ACD=2, RATE_SCD=3
+        };
+        // (the same buffers hold the AMJUEL rates for Ly-opaque species)
+        enum amjuel_rate_index {
+            RATE_LY_IONIZ_LOSS=0, RATE_LY_REC_RAD=1, RATE_LY_REC=2
+        };
+        real_t *rateBuffer = nullptr;
+        real_t *rates[4], *drates_dn[4], *drates_dT[4];
+        len_t nRateBuffer = 0;
+
+        // Radiated power per particle, L_i^(j) + B_i^(j), of each ion
+        // charge state in all cells (nZs x NCells), and its derivatives
+        // with respect to n_cold and T_cold. The tables are evaluated
+        // when the weights are set, and the derivatives are evaluated
+        // (together) the first time they are needed in the jacobian.
+        real_t *ionWeights = nullptr;
+        real_t *ionWeights_dn = nullptr;
+        real_t *ionWeights_dT = nullptr;
+        len_t nIonWeights = 0;
+        bool ionWeightsValid = false;
+        bool ionDiffWeightsValid = false;
+
+        void AllocateRateBuffer();
+        void EvaluateADASRates(const len_t, const len_t, const real_t*, const real_t*, bool);
+        void EvaluateAMJUELRates(const len_t, const real_t*, const real_t*, bool);
+        void EvaluateIonWeights(bool);
     protected:
         virtual len_t GetNumberOfWeightsElements() override 
             {return ionHandler->GetNzs() * grid->GetNCells();}
@@ -41,7 +75,8 @@ namespace DREAM {
         void SetDiffWeights(len_t derivId, len_t nMultiples, const real_t*);
 
     public:
-        RadiatedPowerTerm(FVM::Grid*, FVM::UnknownQuantityHandler*, IonHandler*, ADAS*, NIST*, AMJUEL*,enum OptionConstants::ion_opacity_mode*, bool);
+        RadiatedPowerTerm(FVM::Grid*, FVM::UnknownQuantityHandler*, IonHandler*, ADAS*, NIST*, AMJUEL*,enum OptionConstants::ion_opacity_mode*, bool, ADASRateCache *rateCache=nullptr);
+        virtual ~RadiatedPowerTerm();
     };
 }
 
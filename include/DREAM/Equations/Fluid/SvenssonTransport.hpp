@@ -31,7 +31,7 @@ namespace DREAM {
         real_t *coeffTRXiP,     // Size nParam1d*nr_f*nxi*np
             *coeffRP;           // Size nr_f*np
         real_t **coeff4dInput;  // Size nParam1d-by-(nr*np2*np1)
-        real_t *integrand;      // Size np
+        real_t *pWeights;       // Trapezoidal quadrature weights in p, size np
 
         // Type of momentum grid used for the input data
         enum FVM::Interpolator3D::momentumgrid_type inputMomentumGridType;
@@ -52,16 +52,18 @@ namespace DREAM {
         const len_t CountNxi(const len_t np2In){ return np2In; }
             
         void SetMomentumCoordinate();
+        void SetQuadratureWeights();
             
         void InterpolateCoefficient();
 
         void xiAverage(const real_t*);
 
-        virtual void EvaluateIntegrand(len_t)=0;
+        // Evaluate the p-integral of the coefficient at the given radius
+        virtual real_t EvaluatePIntegral(const len_t) const=0;
 
-        real_t GetPBarInv_f(len_t, real_t *dr_pBarInv_f=nullptr);
+        real_t GetPBarInv_f(len_t, real_t *dr_pBarInv_f=nullptr) const;
 
-        real_t EvalOnFluxGrid(len_t, const real_t*);
+        real_t EvalOnFluxGrid(len_t, const real_t*) const;
 
     public:
         // Constructor
@@ -90,10 +92,10 @@ namespace DREAM {
 
     
     /**
-     *  Classes for evaluating the integrand associated with the
+     *  Classes for evaluating the p-integral associated with the
      *  diffusion- and advection-like terms in the Svensson transport
      *  model. Each class contains a function for calculating the
-     *  integrand associated with each term and each coefficient,
+     *  integral associated with each term and each coefficient,
      *  respectively.
 
      *  
@@ -104,17 +106,17 @@ namespace DREAM {
      */
     class SvenssonTransportDiffusionTerm : public SvenssonTransport<FVM::DiffusionTerm>{
         using SvenssonTransport<FVM::DiffusionTerm>::SvenssonTransport;
-        void EvaluateIntegrand(len_t ir);
+        real_t EvaluatePIntegral(const len_t ir) const override;
     };
 
     class SvenssonTransportAdvectionTermA : public SvenssonTransport<FVM::AdvectionTerm>{
         using SvenssonTransport<FVM::AdvectionTerm>::SvenssonTransport;
-        void EvaluateIntegrand(len_t ir);
+        real_t EvaluatePIntegral(const len_t ir) const override;
     };
 
     class SvenssonTransportAdvectionTermD : public SvenssonTransport<FVM::AdvectionTerm>{
         using SvenssonTransport<FVM::AdvectionTerm>::SvenssonTransport;
-        void EvaluateIntegrand(len_t ir);
+        real_t EvaluatePIntegral(const len_t ir) const override;
     };
 }
 
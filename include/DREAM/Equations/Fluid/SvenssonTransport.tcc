@@ -52,10 +52,10 @@ DREAM::SvenssonTransport<T>::SvenssonTransport(
         xi=p2;
         SetMomentumCoordinate();
     }
+    SetQuadratureWeights();
 
     this->coeffTRXiP = new real_t[nParam1d * nr_f * np * nxi];
     this->coeffRP = new real_t[nr_f * np];
-    this->integrand = new real_t[np];
 
     InterpolateCoefficient();
 }
@@ -81,7 +81,7 @@ DREAM::SvenssonTransport<T>::~SvenssonTransport() {
     delete [] this->p;
     delete [] this->coeffTRXiP;
     delete [] this->coeffRP;
-    delete [] this->integrand;
+    delete [] this->pWeights;
 }
 
 
@@ -96,18 +96,25 @@ DREAM::SvenssonTransport<T>::~SvenssonTransport() {
 template<typename T>
 void DREAM::SvenssonTransport<T>::InterpolateCoefficient() {    
     const len_t N  =  this->nr_f * this->nxi * this->np;
-    
-    for (len_t it = 0, offset = 0; it < nParam1d; it++) {
+
+    // The input grid is the same for all time steps, so we
+    // only locate the (r_f, xi, p) points in it once
+    DREAM::FVM::Interpolator3D::Stencil *stencil;
+    {
         DREAM::FVM::Interpolator3D intp3d_tmp(
-            nr, np2, np1, r, p2, p1, coeff4dInput[it],
+            nr, np2, np1, r, p2, p1, coeff4dInput[0],
             inputMomentumGridType, inputInterp3dMethod, false
         );
-        // Interpolating the coefficients (of every supplied time
-        // step) onto the r_f grid used by DREAM.
-        intp3d_tmp.Eval(
+        stencil = intp3d_tmp.CreateStencil(
             nr_f, nxi, np, this->grid->GetRadialGrid()->GetR_f(), xi, p,
-            FVM::Interpolator3D::momentumgrid_type::GRID_PXI, coeffTRXiP+offset
+            FVM::Interpolator3D::momentumgrid_type::GRID_PXI
         );
+    }
+    
+    for (len_t it = 0, offset = 0; it < nParam1d; it++) {
+        // Interpolating the coefficients (of every supplied time
+        // step) onto the r_f grid used by DREAM.
+        stencil->Eval(coeff4dInput[it], coeffTRXiP+offset);
         // This is more memory intese, than doing the interpolation
         // onto the r_f grid in the xiAverage function. However, this
         // method gives faster simulation runtimes due to otherwise
@@ -115,6 +122,7 @@ void DREAM::SvenssonTransport<T>::InterpolateCoefficient() {
         // step.
         offset+=N;
     }
+    delete stencil;
     // Note that `coeffTRXiP` now contains r_f, xi and p data for _every_ time step.
 
     if (this->interp1dCoeff != nullptr)
@@ -160,21 +168,14 @@ void DREAM::SvenssonTransport<T>::Rebuild(
     // Make sure that there are enough p-points to do a trapz integration.
     if (np > 1) {
         // Iterate over the radial flux grid
+        // (each radius only writes its own coefficient)
+        #pragma omp parallel for if (nr_f*np > 10000)
         for (len_t ir = 0; ir < this->nr_f; ir++) {
-            // The variable to be added to
-            real_t pIntCoeff = 0;
-            
-            this->EvaluateIntegrand(ir);
-            
             // The trapz integration in p
-            for (len_t i = 0; i < this->np-1; i++) {
-                pIntCoeff += 0.5 * (this->integrand[i] + this->integrand[i+1])
-                    * (this->p[i+1] - this->p[i]);
-                // YYY We do not consider contributions to the jacobian to
-                // off-diagonal elements at the moment. This means that derivatives
-                // w.r.t. e.g. the electric field are neglected.
-            }
-            this->_setcoeff(ir, pIntCoeff);
+            // YYY We do not consider contributions to the jacobian to
+            // off-diagonal elements at the moment. This means that derivatives
+            // w.r.t. e.g. the electric field are neglected.
+            this->_setcoeff(ir, this->EvaluatePIntegral(ir));
         }
     } else {
         for (len_t ir = 0; ir < this->nr_f; ir++) {
@@ -204,7 +205,9 @@ void DREAM::SvenssonTransport<T>::xiAverage(const real_t *coeffRXiP){
         // Normalization factor  fot the E field
         const real_t normFactor = Constants::ec / (Constants::me * Constants::c);
         
-        for (len_t ir=0, offset=0; ir < nr_f; ir++){ 
+        #pragma omp parallel for if (nr_f*np*nxi > 10000)
+        for (len_t ir=0; ir < nr_f; ir++){ 
+            const len_t offset = ir*this->np;
             // Evaluate E and Zeff on the fluxgrid.
             real_t Zeff_f = this->EvalOnFluxGrid(ir,ZeffVec); // local Z_eff
             real_t tau_f = this->EvalOnFluxGrid(ir, tauVec); // local collision time
@@ -245,8 +248,6 @@ void DREAM::SvenssonTransport<T>::xiAverage(const real_t *coeffRXiP){
                 }
                 this->coeffRP[i+offset] = avg / (xi[nxi-1]-xi[0]);
             }
-
-            offset += this->np;
         }
     } else {
         // If there is only one xi-point, we simply take the
@@ -278,7 +279,7 @@ void DREAM::SvenssonTransport<T>::xiAverage(const real_t *coeffRXiP){
  *
  */
 template<typename T>
-real_t DREAM::SvenssonTransport<T>::GetPBarInv_f(len_t ir, real_t *dr_pBarInv_f){
+real_t DREAM::SvenssonTransport<T>::GetPBarInv_f(len_t ir, real_t *dr_pBarInv_f) const {
     // Need interpolation from cell grid to flux grid:
     // pBar_f[0]           = pBar[0]
     // pBar_f[0<ir<nr_f-1] = interpolate
@@ -352,7 +353,7 @@ real_t DREAM::SvenssonTransport<T>::GetPBarInv_f(len_t ir, real_t *dr_pBarInv_f)
  * end, and setting zero flux on the inner most point.
  */ 
 template<typename T>
-real_t DREAM::SvenssonTransport<T>::EvalOnFluxGrid(len_t ir, const real_t *vec){
+real_t DREAM::SvenssonTransport<T>::EvalOnFluxGrid(len_t ir, const real_t *vec) const {
     // Need interpolation from cell grid to flux grid:
     // vec_f[0]         = vec[0]
     // vec_f[0<ir<nr_f] = interpolate
@@ -433,3 +434,23 @@ void DREAM::SvenssonTransport<T>::SetMomentumCoordinate() {
         p[ip] = p1[np1+ip-np];
 }
 
+/**
+ * Set the weights of the trapezoidal rule on the momentum grid 'p',
+ * so that the p-integral of a function 'f' is evaluated as the dot
+ * product of 'pWeights' and 'f(p)'. The weights only depend on the
+ * momentum grid, and are therefore computed once.
+ */
+template<typename T>
+void DREAM::SvenssonTransport<T>::SetQuadratureWeights() {
+    pWeights = new real_t[np];
+
+    if (np < 2) {
+        pWeights[0] = 0;
+        return;
+    }
+
+    pWeights[0]    = 0.5*(p[1]-p[0]);
+    pWeights[np-1] = 0.5*(p[np-1]-p[np-2]);
+    for (len_t i = 1; i < np-1; i++)
+        pWeights[i] = 0.5*(p[i+1]-p[i-1]);
+}
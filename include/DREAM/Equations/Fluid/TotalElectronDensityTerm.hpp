@@ -27,6 +27,9 @@ namespace DREAM {
         virtual void SetMatrixElements(FVM::Matrix*, real_t*) override;
         virtual void SetVectorElements(real_t*, const real_t*) override;
 
+        // This term operates on the ion densities (not on the diagonal)
+        virtual bool IsFusable() const override { return false; }
+
     };
 }
 #endif/*_DREAM_EQUATION_FLUID_TOTAL_ELECTRON_DENSITY_TERM_HPP*/
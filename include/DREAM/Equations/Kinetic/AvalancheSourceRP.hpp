@@ -29,13 +29,34 @@ namespace DREAM {
         RPSourceMode sourceMode;
         RPSourcePitchMode sourceXiMode;
 
+        // Source-shape function S(r,p,xi) in all cells of the grid,
+        // which only changes with the grid and (in the adaptive pitch
+        // mode) with the sign of E. 'shapeSign[ir]' is the sign of
+        // RE pitch for which S was evaluated at radius ir (0 if S
+        // must be re-evaluated).
+        real_t *sourceShape = nullptr;
+        len_t *shapeOffset = nullptr;
+        int_t *shapeSign = nullptr;
+
+        void AllocateSourceShape();
+        void DeallocateSourceShape();
+        int_t GetRESign(len_t ir);
+        void RebuildSourceShape();
+
     protected:
         virtual real_t GetSourceFunction(len_t ir, len_t i, len_t j) override;
         virtual real_t GetSourceFunctionJacobian(len_t ir, len_t i, len_t j, const len_t derivId) override;
     public:
         AvalancheSourceRP(FVM::Grid*, FVM::UnknownQuantityHandler*, real_t, real_t, RPSourceMode sm = RP_SOURCE_MODE_KINETIC, RPSourcePitchMode sem = RP_SOURCE_PITCH_ADAPTIVE);
+        ~AvalancheSourceRP();
+
+        virtual void Rebuild(const real_t, const real_t, FVM::UnknownQuantityHandler*) override;
+        virtual bool GridRebuilt() override;
 
-        real_t EvaluateRPSource(len_t ir, len_t i, len_t j);
+        real_t EvaluateRPSource(len_t ir, len_t i, len_t j, int_t RESign);
+        // (with the pitch sign given by the current electric field)
+        real_t EvaluateRPSource(len_t ir, len_t i, len_t j)
+        { return EvaluateRPSource(ir, i, j, GetRESign(ir)); }
         static real_t EvaluateNormalizedTotalKnockOnNumber(real_t pLower, real_t pUpper=std::numeric_limits<real_t>::infinity());
     };
 }
@@ -16,6 +16,7 @@ namespace DREAM {
     private:
         enum OptionConstants::momentumgrid_type gridtype;
         ParallelDiffusionFrequency *nuPar;
+        CollisionQuantityHandler *cqh;
         virtual void SetPartialDiffusionTerm(len_t derivId, len_t nMultiples) override;
     public:
         EnergyDiffusionTerm(FVM::Grid*,CollisionQuantityHandler*,
@@ -23,6 +24,12 @@ namespace DREAM {
         
         
         virtual void Rebuild(const real_t, const real_t, FVM::UnknownQuantityHandler*) override;
+
+        // (the collision frequencies, and their partial derivatives, are
+        // evaluated in the work buffers of the collision quantity handler)
+        virtual bool IsThreadSafe() const override { return true; }
+        virtual void GetSharedObjects(std::vector<const void*>& objs) const override
+        { objs.push_back(this->cqh); }
     };
 }
 
@@ -19,6 +19,7 @@ namespace DREAM {
     private:
         enum OptionConstants::momentumgrid_type gridtype;
         PitchScatterFrequency *nuD;
+        CollisionQuantityHandler *cqh;
         virtual void SetPartialDiffusionTerm(len_t derivId, len_t nMultiples) override;
     public:
         PitchScatterTerm(FVM::Grid*,CollisionQuantityHandler*,
@@ -26,6 +27,12 @@ namespace DREAM {
         
         
         virtual void Rebuild(const real_t, const real_t, FVM::UnknownQuantityHandler*) override;
+
+        // (the collision frequencies, and their partial derivatives, are
+        // evaluated in the work buffers of the collision quantity handler)
+        virtual bool IsThreadSafe() const override { return true; }
+        virtual void GetSharedObjects(std::vector<const void*>& objs) const override
+        { objs.push_back(this->cqh); }
     };
 }
 
@@ -13,10 +13,19 @@ namespace DREAM {
         enum OptionConstants::momentumgrid_type mgtype;
         FVM::Interpolator1D *deltaBOverB;
 
+        // Time-independent part of the diffusion coefficient, i.e.
+        // Drr/(dB/B)^2, on the radial flux grid (size (nr+1)*np1*np2)
+        real_t *geometricFactor = nullptr;
+        bool geometricFactorValid = false;
+
+        void BuildGeometricFactor();
+
     public:
         RechesterRosenbluthTransport(FVM::Grid*, enum OptionConstants::momentumgrid_type, FVM::Interpolator1D*);
         ~RechesterRosenbluthTransport();
 
+        virtual bool GridRebuilt() override;
+
         virtual void Rebuild(const real_t, const real_t, FVM::UnknownQuantityHandler*) override;
     };
 }
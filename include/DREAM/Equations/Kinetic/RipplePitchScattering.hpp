@@ -18,6 +18,10 @@ namespace DREAM {
         DREAM::MultiInterpolator1D *dB_B;    
 
         real_t **p_mn=nullptr;          // Resonant momentum (size nModes-by-nr)
+        // Time- and mode-independent factor of the diffusion coefficient,
+        // D22 / ((dB_mn/B)^2 * H_mn), on the pitch flux grid
+        // (size nr-by-((nxi+1)*np))
+        real_t **prefactor=nullptr;
 
         // If 'true', includes the poloidal field component when
         // evaluating the resonant momentum
@@ -38,6 +42,8 @@ namespace DREAM {
         ~RipplePitchScattering();
 
         void Allocate();
+        void Deallocate();
+        void CalculatePrefactor();
         void CalculateResonantMomentum();
 
         const len_t GetNumberOfModes() { return this->nModes; }
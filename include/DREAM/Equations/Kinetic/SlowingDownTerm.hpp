@@ -18,6 +18,7 @@ namespace DREAM {
     private:
         enum OptionConstants::momentumgrid_type gridtype;
         SlowingDownFrequency *nuS;
+        CollisionQuantityHandler *cqh;
         virtual void SetPartialAdvectionTerm(len_t derivId, len_t nMultiples) override;
     public:
 
@@ -25,6 +26,12 @@ namespace DREAM {
                         FVM::UnknownQuantityHandler*, bool withKineticIonJacobian);
         
         virtual void Rebuild(const real_t, const real_t, FVM::UnknownQuantityHandler*) override;
+
+        // (the collision frequencies, and their partial derivatives, are
+        // evaluated in the work buffers of the collision quantity handler)
+        virtual bool IsThreadSafe() const override { return true; }
+        virtual void GetSharedObjects(std::vector<const void*>& objs) const override
+        { objs.push_back(this->cqh); }
     };
 }
 
@@ -19,10 +19,19 @@ namespace DREAM {
         const real_t constPrefactor = Constants::ec * Constants::ec * Constants::ec * Constants::ec / (
             6*M_PI * Constants::eps0 * Constants::me * Constants::me * Constants::me * 
             Constants::c * Constants::c * Constants::c);
+
+        // Tabulated advection coefficients (which only depend on the grid)
+        real_t **tableF1=nullptr, **tableF2=nullptr;
+        bool tablesValid=false;
+
+        void AllocateTables();
+        void DeallocateTables();
+        void BuildTables();
     public:
         SynchrotronTerm(FVM::Grid*, enum OptionConstants::momentumgrid_type);
-        
-        
+        virtual ~SynchrotronTerm();
+
+        virtual bool GridRebuilt() override;
         virtual void Rebuild(const real_t, const real_t, FVM::UnknownQuantityHandler*) override;
     };
 }
@@ -0,0 +1,52 @@
+#ifndef _DREAM_EQUATIONS_PSI_FUNCTION_TABLE_HPP
+#define _DREAM_EQUATIONS_PSI_FUNCTION_TABLE_HPP
+
+#include <gsl/gsl_integration.h>
+#include "FVM/config.h"
+
+namespace DREAM {
+    class PsiFunctionTable {
+    private:
+        // Tabulated region in Theta = T/mc^2 (outside of which the
+        // low-temperature expansion or quadrature is used)
+        static constexpr real_t THETA_MIN = 0.005;
+        static constexpr real_t THETA_MAX = 0.5;
+        // Tabulated region in x = sqrt((gamma-1)/Theta) (above which
+        // the superthermal expansion is used)
+        static constexpr real_t X_MAX = 3.1622776601683795;  // sqrt(10)
+
+        // Maximum relative interpolation error allowed
+        static constexpr real_t RELTOL = 1e-8;
+        static constexpr len_t MAX_NX = 513, MAX_NY = 257;
+
+        // Number of grid points in x and y = ln(Theta)
+        len_t nx=0, ny=0;
+        real_t hx, hy, y0;
+        // Value and derivatives of psi_n/sqrt(2*Theta) at each node,
+        // stored as table[n][4*(j*nx+i) + k] with k = (G, dG/dx, dG/dy, d2G/dxdy)
+        real_t *table[3] = {nullptr, nullptr, nullptr};
+        bool valid = false;
+
+        gsl_integration_workspace *gsl_ad_w;
+
+        PsiFunctionTable();
+        ~PsiFunctionTable();
+
+        void Build(const len_t, const len_t);
+        real_t EvaluateNode(const len_t, const real_t, const real_t, real_t*);
+        real_t Integrate(const len_t, const real_t, const real_t, bool);
+        real_t Interpolate(const len_t, const real_t, const real_t) const;
+        real_t GetMaxMidpointError();
+
+        static real_t psiIntegrand(real_t, void*);
+        static real_t psiThetaDerivativeIntegrand(real_t, void*);
+
+    public:
+        static const PsiFunctionTable *GetInstance();
+
+        bool IsTabulated(const real_t p, const real_t Theta) const;
+        real_t Evaluate(const len_t n, const real_t p, const real_t Theta) const;
+    };
+}
+
+#endif/*_DREAM_EQUATIONS_PSI_FUNCTION_TABLE_HPP*/
@@ -35,22 +35,33 @@ namespace DREAM {
         std::function<real_t(len_t,real_t)> BA_MomentumPrefactor;
 
         const gsl_interp_type *interp_mode; // interpolation method used by all splines
-        gsl_integration_workspace *gsl_ad_w;
         static constexpr len_t N_BA_SPLINE = 100;
         gsl_spline **BA_Spline = nullptr;
         gsl_interp_accel **BA_Accel = nullptr;
 
+        /**
+         * The RE pitch distribution averages are splined in X = X(A)
+         * on the same grid 'REDistAverage_X' at all radii, and stored
+         * as the cubic polynomial coefficients of each interval in the
+         * flat array 'REDistAverage_Coeffs' (4 per interval, ordered
+         * as [ir][interval][power]).
+         */
         static constexpr len_t N_RE_DIST_SPLINE = 50;
-        gsl_spline **REDistAverage_Spline = nullptr;
-        gsl_interp_accel **REDistAverage_Accel = nullptr;
+        real_t *REDistAverage_X = nullptr;
+        real_t *REDistAverage_Coeffs = nullptr;
 
         len_t nr;
 
         void generateREDistAverageSplines();
+        len_t FindREDistAverageInterval(real_t X) const;
         
         void Deallocate();
 
     public:
+        static void SetSplineCoefficients(
+            const real_t *x, const len_t N, gsl_spline*, gsl_interp_accel*, real_t *coeffs
+        );
+
         REPitchDistributionAveragedBACoeff(
             FVM::RadialGrid*, AnalyticDistributionRE*,
             real_t(*BA_Func)(real_t,real_t,real_t,real_t,void*),
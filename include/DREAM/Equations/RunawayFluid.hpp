@@ -10,8 +10,10 @@ namespace DREAM { class RunawayFluid; }
 #include <gsl/gsl_min.h>
 #include <string>
 #include "DREAM/Equations/AnalyticDistributionRE.hpp"
+#include "DREAM/Equations/ComptonRateTable.hpp"
 #include "DREAM/Equations/ConnorHastie.hpp"
 #include "DREAM/Equations/DreicerNeuralNetwork.hpp"
+#include "DREAM/Equations/EceffTable.hpp"
 #include "DREAM/Equations/EffectiveCriticalField.hpp"
 #include "DREAM/Equations/PitchScatterFrequency.hpp"
 #include "DREAM/Equations/SlowingDownFrequency.hpp"
@@ -53,6 +55,8 @@ namespace DREAM {
         OptionConstants::eqterm_avalanche_mode ava_mode;
         OptionConstants::eqterm_compton_mode compton_mode;
         real_t compton_photon_flux;
+        // Tabulated Compton runaway rate (shared by all instances)
+        const ComptonRateTable *comptonTable;
 
         len_t id_ncold;
         len_t id_ntot;
@@ -76,6 +80,8 @@ namespace DREAM {
         real_t *criticalREMomentumInvSq=nullptr; // Inverse square p_star
         real_t *pc_COMPLETESCREENING = nullptr;
         real_t *pc_NOSCREENING = nullptr;
+        real_t *pStar_PREV = nullptr;            // pStar obtained in previous rebuild, used to accelerate the root finding (0 if not available)
+        const real_t PSTAR_WARMSTART_MARGIN = 0.05; // relative half-width of the interval around pStar_PREV in which the root is first sought
         real_t *avalancheGrowthRate=nullptr;     // (dnRE/dt)_ava = nRE*Gamma_ava
         real_t *dreicerRunawayRate=nullptr;      // (dnRE/dt)_Dreicer = gamma_Dreicer
         real_t *tritiumRate=nullptr;             // (dnRE/dt)_Tritium = nTritium * ...
@@ -83,6 +89,11 @@ namespace DREAM {
         real_t *DComptonRateDpc=nullptr;         // d/dpc((dnRE/dt)_Compton)
         real_t *effectiveCriticalField=nullptr;  // Eceff: Gamma_ava(Eceff) = 0
         real_t *electricConductivity=nullptr;
+        // Partial derivatives of the conductivity (evaluated together with it)
+        real_t *dElectricConductivityDTcold=nullptr;
+        real_t *dElectricConductivityDZeff=nullptr;
+        real_t *dElectricConductivityDncold=nullptr;
+        real_t *dElectricConductivityDnfree=nullptr;
 
         EffectiveCriticalField *effectiveCriticalFieldObject = nullptr; 
         
@@ -93,6 +104,10 @@ namespace DREAM {
             timerNuS, timerNuD, timerDerived,
             timerEcEff, timerPCrit, timerGrowthrates;
 
+        // Root finding statistics for pStar
+        len_t nPStarSolves=0, nPStarWarmStarts=0,
+            nPStarIterations=0, nPStarNotConverged=0;
+
         bool gridRebuilt;
         bool parametersHaveChanged();
 
@@ -119,10 +134,13 @@ namespace DREAM {
         static const real_t conductivityBraams[];
         static const real_t conductivityTmc2[];   // list of T/mc2 
         static const real_t conductivityX[];      // where X = 1/(1+Zeff) 
-        
-        gsl_interp2d *gsl_cond;
-        gsl_interp_accel *gsl_xacc;
-        gsl_interp_accel *gsl_yacc;
+
+        static const real_t *GetConductivityCoefficients();
+        static real_t evaluateBraamsConductivityTable(real_t Tmc2, real_t X, real_t *dSdTmc2, real_t *dSdX);
+        real_t partialContributionConductivity(
+            len_t ir, len_t derivId, len_t n, real_t dSigmadTcold,
+            real_t dSigmadZeff, real_t dSigmadncold, real_t dSigmadnfree
+        );
         int QAG_KEY = GSL_INTEG_GAUSS31;
 
 
@@ -142,14 +160,14 @@ namespace DREAM {
         );
         ~RunawayFluid();
 
-        static void FindRoot(real_t x_lower, real_t x_upper, real_t *root, gsl_function gsl_func, gsl_root_fsolver *s, real_t epsrel=1e-3, real_t epsabs=0);
-        static void FindRoot_fdf(real_t &root, gsl_function_fdf gsl_func, gsl_root_fdfsolver *s, real_t epsrel=3e-3, real_t epsabs=0);
-        static void FindRoot_fdf_bounded(real_t x_lower, real_t x_upper, real_t &root, gsl_function_fdf gsl_func, gsl_root_fdfsolver *s, real_t epsrel=3e-3, real_t epsabs=0);
+        static bool FindRoot(real_t x_lower, real_t x_upper, real_t *root, gsl_function gsl_func, gsl_root_fsolver *s, real_t epsrel=1e-3, real_t epsabs=0, len_t *nIterations=nullptr);
+        static bool FindRoot_fdf(real_t &root, gsl_function_fdf gsl_func, gsl_root_fdfsolver *s, real_t epsrel=3e-3, real_t epsabs=0, len_t *nIterations=nullptr);
+        static bool FindRoot_fdf_bounded(real_t x_lower, real_t x_upper, real_t &root, gsl_function_fdf gsl_func, gsl_root_fdfsolver *s, real_t epsrel=3e-3, real_t epsabs=0, len_t *nIterations=nullptr);
         static void FindInterval(real_t *x_lower, real_t *x_upper, gsl_function gsl_func );
 
         static real_t evaluateTritiumRate(real_t gamma_c);
-        static real_t evaluateComptonRate(real_t pc, real_t photonFlux, gsl_integration_workspace *gsl_ad_w);
-        static real_t evaluateDComptonRateDpc(real_t pc, real_t photonFlux, gsl_integration_workspace *gsl_ad_w);
+        static real_t evaluateComptonRate(real_t pc, real_t photonFlux, gsl_integration_workspace *gsl_ad_w, real_t epsrel=1e-4);
+        static real_t evaluateDComptonRateDpc(real_t pc, real_t photonFlux, gsl_integration_workspace *gsl_ad_w, real_t epsrel=1e-4);
         static real_t evaluateComptonPhotonFluxSpectrum(real_t Eg, real_t photonFlux);
         static real_t evaluateComptonTotalCrossSectionAtP(real_t Eg, real_t pc);
         static real_t evaluateDSigmaComptonDpcAtP(real_t Eg, real_t pc);
@@ -230,20 +248,27 @@ namespace DREAM {
         PitchScatterFrequency* GetNuD(){return nuD;}
 
         real_t evaluateNeoclassicalConductivityCorrection(len_t ir, bool collisionless);
-        real_t evaluateNeoclassicalConductivityCorrection(len_t ir, real_t Tcold, real_t Zeff, real_t ncold, bool collisionless);
+        real_t evaluateNeoclassicalConductivityCorrection(len_t ir, real_t Tcold, real_t Zeff, real_t ncold, bool collisionless,
+            real_t *dKdTcold=nullptr, real_t *dKdZeff=nullptr, real_t *dKdncold=nullptr);
 
         real_t evaluateSauterElectricConductivity(len_t ir, bool collisionless);
         real_t evaluateSauterElectricConductivity(len_t ir, real_t Tcold, real_t Zeff, real_t ncold, bool collisionless);
         real_t evaluateBraamsElectricConductivity(len_t ir);
-        real_t evaluateBraamsElectricConductivity(len_t ir, real_t Tcold, real_t Zeff);
+        real_t evaluateBraamsElectricConductivity(len_t ir, real_t Tcold, real_t Zeff,
+            real_t *dSigmadTcold=nullptr, real_t *dSigmadZeff=nullptr, real_t *dSigmadnfree=nullptr);
+        void evaluateElectricConductivity(
+            real_t *sigma, real_t *dSigmadTcold=nullptr, real_t *dSigmadZeff=nullptr,
+            real_t *dSigmadncold=nullptr, real_t *dSigmadnfree=nullptr
+        );
 
         real_t evaluatePartialContributionConductivity(len_t ir, len_t derivId, len_t n); 
         real_t evaluatePartialContributionSauterConductivity(len_t ir, len_t derivId, len_t n, bool collisionless);
-        real_t evaluatePartialContributionBraamsConductivity(len_t ir, len_t derivId, len_t n);
         void evaluatePartialContributionAvalancheGrowthRate(real_t *dGamma, len_t derivId);
         void evaluatePartialContributionComptonGrowthRate(real_t *dGamma, len_t derivId);
 
 
+        void SetEceffTable(EceffTable*);
+
         void PrintTimings();
         void SaveTimings(SFile*, const std::string& path="");
     };
@@ -80,6 +80,20 @@ namespace DREAM{
         real_t *thetaCoordPNext=nullptr;
         real_t *phiCoordPNext=nullptr;
         len_t *irp=nullptr;
+
+        // Shard positions (and length scales used to set the tolerance)
+        // for which the flux surface coordinates above were last calculated
+        real_t *xpCoordsPrevious=nullptr;
+        real_t *xpCoordsNext=nullptr;
+        real_t *lengthScaleCoordsPrevious=nullptr;
+        real_t *lengthScaleCoordsNext=nullptr;
+
+        // Range of radial cells [irMin, irMax) in which the deposition
+        // and heat absorbtion profiles of each shard are non-zero
+        len_t *depositionIrMin=nullptr;
+        len_t *depositionIrMax=nullptr;
+        len_t *heatAbsorbtionIrMin=nullptr;
+        len_t *heatAbsorbtionIrMax=nullptr;
         real_t *qtot=nullptr;
         real_t *Eeff=nullptr;
         real_t *pelletMolarMass=nullptr;
@@ -104,10 +118,17 @@ namespace DREAM{
 
         real_t rSourceMax; 
         real_t rSourceMin;
-        void CalculateTimeAveragedDeltaSourceLocal(real_t *timeAveragedDeltaSource);
-        void CalculateGaussianSourceLocal(real_t *gaussianSource);
+        void CalculateTimeAveragedDeltaSourceLocal(real_t *timeAveragedDeltaSource, len_t *irMin, len_t *irMax);
+        void CalculateGaussianSourceLocal(real_t *gaussianSource, len_t *irMin, len_t *irMax);
+        void ShiftDepositionProfilesLastFluxTube();
+        void HeatAbsorbtionRange(len_t ip, len_t &irMin, len_t &irMax);
+
+        // Number of cloud radii beyond which the gaussian deposition profile is truncated
+        const real_t GAUSSIAN_SOURCE_CUTOFF = 6.0;
         real_t CalculateRDotDepositionLocal(len_t ir);
 
+        void UpdateShardCoordinates(len_t ip, real_t lengthScale);
+        len_t FindRadialCell(real_t r);
         void CalculateIrp();
         void CalculateRCld();
         real_t CalculateLambda(real_t X);
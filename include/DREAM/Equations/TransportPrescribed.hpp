@@ -10,10 +10,6 @@ namespace DREAM {
     template<typename T>
     class TransportPrescribed : public T {
     private:
-        // Diffusion coefficient data, prescribed in time and
-        // on the given computational grid.
-        FVM::Interpolator1D *prescribedCoeff=nullptr;
-
         len_t nt, nr, np1, np2;
         const real_t **coeff, *t, *r, *p1, *p2;
         enum FVM::Interpolator3D::momentumgrid_type
@@ -21,10 +17,34 @@ namespace DREAM {
             gridtype;   // Type of momentum grid used for 'grid'
         enum FVM::Interpolator3D::interp_method interpmethod = FVM::Interpolator3D::INTERP_LINEAR;
 
-        real_t **interpolateddata=nullptr;
+        // Number of elements of a coefficient time slice
+        // interpolated to the computational grid
+        len_t nInterpolated=0;
+        // Time slices of the coefficient interpolated to the
+        // computational grid (the interpolation is only done for
+        // the time slices actually needed, and only the two slices
+        // surrounding the current time are kept in memory)
+        real_t *slices[2] = {nullptr, nullptr};
+        // Index in 't' of the time slices in 'slices'
+        // (or 'nt' if not interpolated)
+        len_t sliceIndex[2];
+        // Coefficient evaluated at time 'blendTime' (blended from
+        // the two time slices surrounding it), which is reused when
+        // the term is rebuilt again for the same time
+        real_t *blended = nullptr;
+        real_t blendTime = 0;
+        bool blendValid = false;
+        // Precomputed interpolation from the input grid to
+        // the computational grid
+        FVM::Interpolator3D::Stencil *stencil=nullptr;
 
         void _setcoeff(const len_t, const len_t, const real_t);
 
+        len_t FindTimeIndex(const real_t) const;
+        void InterpolateSlice(const len_t, real_t*);
+        const real_t *GetSlice(const len_t);
+        void BlendSlices(const real_t);
+
     public:
         TransportPrescribed<T>(
             FVM::Grid*,
@@ -43,6 +63,10 @@ namespace DREAM {
 
         virtual bool GridRebuilt() override;
         virtual void Rebuild(const real_t, const real_t, FVM::UnknownQuantityHandler*) override;
+        // The coefficients only depend on time (flux limiters, which
+        // make the jacobian depend on the unknown, are accounted for
+        // in 'FVM::Operator::IsJacobianConstant()')
+        virtual bool IsJacobianConstant() const override { return true; }
     };
 
     template<>
@@ -5,6 +5,7 @@
  */
 
 #include <type_traits>
+#include <utility>
 #include "DREAM/Equations/TransportPrescribed.hpp"
 #include "FVM/Interpolator1D.hpp"
 #include "FVM/Interpolator3D.hpp"
@@ -28,8 +29,17 @@ DREAM::TransportPrescribed<T>::TransportPrescribed(
     momtype(inptype), gridtype(gridtype), interpmethod(interpmethod) {
 
     this->T::SetName("TransportPrescribed");
+    // The coefficients only depend on time (and not at
+    // all if only one time slice is given)
+    this->T::SetRebuildInputs({}, nt > 1);
+
+    for (len_t i = 1; i < nt; i++)
+        if (t[i] <= t[i-1])
+            throw DREAM::FVM::Interpolator1DException(
+                "TransportPrescribed: The time grid must be strictly increasing."
+            );
     
-    // Interpolate input coefficient onto 'grid'...
+    // Prepare interpolation of input coefficient onto 'grid'...
     InterpolateCoefficient();
 }
 
@@ -39,12 +49,11 @@ DREAM::TransportPrescribed<T>::TransportPrescribed(
 namespace DREAM {
 template<typename T>
 TransportPrescribed<T>::~TransportPrescribed() {
-    if (this->prescribedCoeff != nullptr)
-        delete this->prescribedCoeff;
-    if (this->interpolateddata != nullptr) {
-        delete [] this->interpolateddata[0];
-        delete [] this->interpolateddata;
-    }
+    delete [] this->slices[0];
+    delete [] this->slices[1];
+    delete [] this->blended;
+    if (this->stencil != nullptr)
+        delete this->stencil;
 }
 }
 
@@ -67,65 +76,155 @@ bool DREAM::TransportPrescribed<T>::GridRebuilt() {
 }
 
 /**
- * Interpolate the input coefficient onto the phase space
- * grid used by this EquationTerm.
+ * Prepare for interpolating the input coefficient onto the phase
+ * space grid used by this EquationTerm. Since prescribed coefficients
+ * can be given on very many time points, the time slices are only
+ * interpolated to the grid when they are needed (in 'Rebuild()').
  */
 template<typename T>
 void DREAM::TransportPrescribed<T>::InterpolateCoefficient() {
-    real_t **newdata = new real_t*[nt];
-    // Drr is defined on the radial flux grid so we
-    // XXX assume that all momentum grids are the same
-    // and one momentum grid's worth of cells to the total
-    // number of cells...
+    // Drr is defined on the radial flux grid, the outermost
+    // point of which uses the momentum grid of the last cell
     const len_t N  =
-        this->grid->GetNCells() + this->grid->GetMomentumGrid(0)->GetNCells();
+        this->grid->GetNCells() + this->grid->GetMomentumGrid_fr(this->grid->GetNr())->GetNCells();
+
+    if (N != this->nInterpolated) {
+        for (len_t k = 0; k < 2; k++) {
+            delete [] this->slices[k];
+            this->slices[k] = new real_t[N];
+        }
+        delete [] this->blended;
+        this->blended = new real_t[N];
+
+        this->nInterpolated = N;
+    }
 
-    newdata[0] = new real_t[nt*N];
+    // Invalidate previously interpolated time slices
+    this->sliceIndex[0] = this->sliceIndex[1] = this->nt;
+    this->blendValid = false;
 
-    for (len_t i = 0; i < nt; i++) {
-        if (i > 0)
-            newdata[i] = newdata[i-1] + N;
+    // The input grid is the same for all time slices, so the
+    // interpolation weights are computed once for the grid
+    if (this->stencil != nullptr)
+        delete this->stencil;
 
-        DREAM::FVM::Interpolator3D intp3(
-            nr, np2, np1, r, p2, p1, coeff[i],
-            momtype, interpmethod, false
-        );
-        intp3.Eval(this->grid, this->gridtype, FVM::FLUXGRIDTYPE_RADIAL, newdata[i]);
+    DREAM::FVM::Interpolator3D intp3(
+        nr, np2, np1, r, p2, p1, coeff[0],
+        momtype, interpmethod, false
+    );
+    this->stencil = intp3.CreateStencil(this->grid, this->gridtype, FVM::FLUXGRIDTYPE_RADIAL);
+}
+
+/**
+ * Locate the index of the last time point in 't' which precedes
+ * the given time (clamped so that at least one time point follows
+ * it, unless there is only one time point). This is the same
+ * search as is done by 'FVM::Interpolator1D'.
+ */
+template<typename T>
+len_t DREAM::TransportPrescribed<T>::FindTimeIndex(const real_t tv) const {
+    len_t a = 0, b = (nt > 0 ? nt-1 : 0);
+
+    while (b-a > 1) {
+        len_t c = (a+b)/2;
+        if (this->t[c] >= tv) b = c;
+        else a = c;
     }
 
-    if (this->prescribedCoeff != nullptr) {
-        delete this->prescribedCoeff;
-        delete [] this->interpolateddata[0];
-        delete [] this->interpolateddata;
+    return a;
+}
+
+/**
+ * Interpolate the time slice with index 'it' of the input
+ * coefficient onto the computational grid.
+ *
+ * it:   Index of time slice to interpolate.
+ * data: Array to store the interpolated coefficient in.
+ */
+template<typename T>
+void DREAM::TransportPrescribed<T>::InterpolateSlice(const len_t it, real_t *data) {
+    this->stencil->Eval(coeff[it], data);
+}
+
+/**
+ * Returns the time slice with index 'it' of the input coefficient,
+ * interpolated onto the computational grid. If it is not among the
+ * two most recently used slices, the least recently needed slice
+ * is replaced.
+ */
+template<typename T>
+const real_t *DREAM::TransportPrescribed<T>::GetSlice(const len_t it) {
+    if (this->sliceIndex[0] == it)
+        return this->slices[0];
+    else if (this->sliceIndex[1] == it) {
+        // Move to front
+        std::swap(this->slices[0], this->slices[1]);
+        std::swap(this->sliceIndex[0], this->sliceIndex[1]);
+        return this->slices[0];
     }
 
-    this->prescribedCoeff = new DREAM::FVM::Interpolator1D(
-        nt, N, t, newdata[0]
-    );
+    // Replace the other slice and move it to the front
+    std::swap(this->slices[0], this->slices[1]);
+    std::swap(this->sliceIndex[0], this->sliceIndex[1]);
+
+    InterpolateSlice(it, this->slices[0]);
+    this->sliceIndex[0] = it;
 
-    // This data is now used by 'prescribedCoeff', but we
-    // need to keep a pointer in this class so that we can
-    // clean it up later...
-    this->interpolateddata = newdata;
+    return this->slices[0];
+}
+
+/**
+ * Evaluate the coefficient at time 't' on the computational grid
+ * and store it in 'blended'. Linear interpolation in time is used
+ * (with linear extrapolation outside of the prescribed time
+ * interval), and the time slices are only interpolated onto the
+ * grid as the time moves into a new interval.
+ */
+template<typename T>
+void DREAM::TransportPrescribed<T>::BlendSlices(const real_t t) {
+    const len_t it = FindTimeIndex(t);
+    const real_t *c1 = GetSlice(it);
+
+    if (it+1 < this->nt) {
+        // ('c1' remains valid, since only the least recently
+        // used slice is replaced)
+        const real_t *c2 = GetSlice(it+1);
+        const real_t w = (t - this->t[it]) / (this->t[it+1] - this->t[it]);
+
+        for (len_t i = 0; i < this->nInterpolated; i++)
+            this->blended[i] = c1[i] + w*(c2[i]-c1[i]);
+    } else {
+        for (len_t i = 0; i < this->nInterpolated; i++)
+            this->blended[i] = c1[i];
+    }
+
+    this->blendTime = t;
+    this->blendValid = true;
 }
 
 /**
  * Rebuild this term by evaluating and setting the diffusion
- * coefficient for the next time step.
+ * coefficient for the next time step. Since the coefficient only
+ * depends on time, it is only re-evaluated when the time changes
+ * (the term may be rebuilt several times for the same time when it
+ * is part of an 'AdvectionDiffusionTerm' together with terms which
+ * depend on the solution).
  */
 template<typename T>
 void DREAM::TransportPrescribed<T>::Rebuild(
     const real_t t, const real_t, DREAM::FVM::UnknownQuantityHandler*
 ) {
-    const real_t *c = this->prescribedCoeff->Eval(t);
     const len_t nr = this->grid->GetNr();
-    // XXX here we assume that all momentum grids are the same...
-    const len_t N = this->grid->GetMomentumGrid(0)->GetNCells();
-    
+
+    // (with a single time slice, the coefficient is constant)
+    if (!this->blendValid || (this->nt > 1 && t != this->blendTime))
+        BlendSlices(t);
+
     // Iterate over the radial flux grid...
     for (len_t ir = 0, offset = 0; ir < nr+1; ir++) {
+        const len_t N = this->grid->GetMomentumGrid_fr(ir)->GetNCells();
         for (len_t j = 0; j < N; j++) {
-            this->_setcoeff(ir, j, c[offset+j]);
+            this->_setcoeff(ir, j, this->blended[offset+j]);
         }
 
         offset += N;
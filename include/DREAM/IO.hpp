@@ -2,10 +2,31 @@
 #define _DREAM_IO_HPP
 
 #include <string>
+#include "FVM/config.h"
+
+// Most verbose level of messages compiled into the code (messages
+// of higher levels are removed at compile time)
+#ifndef DREAM_LOG_MAX_LEVEL
+#   define DREAM_LOG_MAX_LEVEL 3
+#endif
 
 namespace DREAM {
     class IO {
     public:
+        // Levels of messages (messages with a higher level than
+        // the current level are not printed)
+        typedef enum {
+            LEVEL_ERROR=0,
+            LEVEL_WARNING=1,
+            LEVEL_INFO=2,
+            LEVEL_DEBUG=3
+        } level_t;
+
+        typedef enum {
+            FORMAT_TEXT=1,      // Plain text (default)
+            FORMAT_JSON=2       // One JSON object per message (JSON lines)
+        } format_t;
+
         typedef enum {
             MESSAGE_GENERAL,
 
@@ -23,6 +44,15 @@ namespace DREAM {
 
         static bool VerifyMessage(const message_t);
 
+        static bool IsEnabled(const level_t l)
+        { return (l <= DREAM_LOG_MAX_LEVEL && l <= level); }
+        static level_t GetLevel() { return level; }
+        static void SetLevel(const level_t l) { level = l; }
+        static format_t GetFormat() { return format; }
+        static void SetFormat(const format_t f) { format = f; }
+        static void SetAsynchronous(const bool);
+        static void Flush();
+
         static void PrintError(const char*);
         static void PrintError(const message_t, const char*);
         template<typename ... Args>
@@ -69,10 +99,26 @@ namespace DREAM {
         #endif
         ;
 
+        static void PrintDebug(const char*);
+        template<typename ... Args>
+        static void PrintDebug(const char*, Args&& ...)
+        #if defined(__GNUC__) || defined(__clang__)
+        __attribute__((format (printf, 1, 0)))
+        #endif
+        ;
+
+        static void PrintProgress(const std::string&);
+
         static const std::string PRINT_YES, PRINT_NO;
 
     private:
         static bool message_checklist[MESSAGE_LAST];
+        static level_t level;
+        static format_t format;
+
+        template<typename ... Args>
+        static std::string Format(const char*, Args&& ...);
+        static void Emit(const level_t, std::string&&, const bool newline=true);
 
     };
 }
@@ -1,9 +1,27 @@
 
+#include <cstdio>
 #include <string>
 #include "FVM/config.h"
 
 namespace DREAM {
 
+/**
+ * Format the given message (in printf-format).
+ */
+template<typename ... Args>
+std::string IO::Format(const char *msg, Args&& ... args) {
+    char buf[256];
+    const int n = snprintf(buf, sizeof(buf), msg, args ...);
+    if (n < 0)
+        return std::string(msg);
+    else if ((size_t)n < sizeof(buf))
+        return std::string(buf, n);
+
+    std::string s(n, '\0');
+    snprintf(&s[0], n+1, msg, args ...);
+    return s;
+}
+
 /**
  * Prints an error message to stderr.
  * Supports printf syntax.
@@ -18,16 +36,10 @@ void IO::PrintError(const char *msg, Args&& ... args) {
 
 template<typename ... Args>
 void IO::PrintError(const IO::message_t id, const char *msg, Args&& ... args) {
-    if (!IO::VerifyMessage(id))
+    if (!IO::IsEnabled(LEVEL_ERROR) || !IO::VerifyMessage(id))
         return;
 
-#ifdef COLOR_TERMINAL
-    fputs("\x1B[1;31m[ERROR]\x1B[0m ", stderr);
-#else
-    fputs("[ERROR] ", stderr);
-#endif
-    fprintf(stderr, msg, std::forward<Args>(args) ...);
-    fputc('\n', stderr);
+    Emit(LEVEL_ERROR, Format(msg, std::forward<Args>(args) ...));
 }
 
 /**
@@ -45,16 +57,10 @@ void IO::PrintWarning(const char *msg, Args&& ... args) {
 }
 template<typename ... Args>
 void IO::PrintWarning(const IO::message_t id, const char *msg, Args&& ... args) {
-    if (!IO::VerifyMessage(id))
+    if (!IO::IsEnabled(LEVEL_WARNING) || !IO::VerifyMessage(id))
         return;
 
-#ifdef COLOR_TERMINAL
-    fputs("\x1B[1;33m[WARNING]\x1B[0m ", stderr);
-#else
-    fputs("[WARNING] ", stderr);
-#endif
-    fprintf(stderr, msg, std::forward<Args>(args) ...);
-    fputc('\n', stderr);
+    Emit(LEVEL_WARNING, Format(msg, std::forward<Args>(args) ...));
 }
 
 /**
@@ -70,11 +76,25 @@ void IO::PrintInfo(const char *msg, Args&& ... args) {
 }
 template<typename ... Args>
 void IO::PrintInfo(const IO::message_t id, const char *msg, Args&& ... args) {
-    if (!IO::VerifyMessage(id))
+    if (!IO::IsEnabled(LEVEL_INFO) || !IO::VerifyMessage(id))
         return;
     
-    fprintf(stdout, msg, std::forward<Args>(args) ...);
-    fputc('\n', stdout);
+    Emit(LEVEL_INFO, Format(msg, std::forward<Args>(args) ...));
+}
+
+/**
+ * Prints a debug message to stdout (only if the
+ * current level is 'LEVEL_DEBUG').
+ * Supports printf syntax.
+ *
+ * msg: Message (in printf-format) to print.
+ */
+template<typename ... Args>
+void IO::PrintDebug(const char *msg, Args&& ... args) {
+    if (!IO::IsEnabled(LEVEL_DEBUG))
+        return;
+
+    Emit(LEVEL_DEBUG, Format(msg, std::forward<Args>(args) ...));
 }
 
 }//namespace DREAM
@@ -48,6 +48,10 @@ namespace DREAM {
         
         // mass of atomic species
         real_t *mi;
+
+        // Version of the ion densities for which the derived
+        // quantities were last evaluated
+        len_t rebuiltVersion = 0;
         
         
         virtual void DeallocateAll();
@@ -0,0 +1,66 @@
+#ifndef _DREAM_LOG_QUEUE_HPP
+#define _DREAM_LOG_QUEUE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <string>
+#include <thread>
+
+namespace DREAM {
+    class LogQueue {
+    public:
+        // Message to write
+        struct entry {
+            int level;
+            // If 'false', the message is a progress indicator which
+            // should not be terminated by a new-line character
+            bool newline;
+            // Wall-clock time (in seconds since the program started)
+            // and OpenMP thread at which the message was emitted
+            double time;
+            int thread;
+            std::string message;
+        };
+
+        typedef void (*write_function)(const struct entry&);
+        typedef void (*flush_function)();
+
+    private:
+        // Number of messages which can be queued (must be
+        // a power of two)
+        static constexpr size_t CAPACITY = 4096;
+
+        struct slot {
+            std::atomic<size_t> seq;
+            struct entry e;
+        };
+
+        struct slot *slots;
+        std::atomic<size_t> head{0}, tail{0};
+        // Number of messages written so far
+        std::atomic<size_t> nWritten{0};
+        std::atomic<bool> running{false};
+
+        std::thread writer;
+        write_function write;
+        flush_function flush;
+
+        bool Pop(struct entry&);
+        void Run();
+
+    public:
+        LogQueue();
+        ~LogQueue();
+
+        bool IsRunning() const { return this->running.load(std::memory_order_acquire); }
+
+        void Start(write_function, flush_function);
+        void Stop();
+
+        size_t Push(struct entry&&);
+        void Flush(const size_t ticket);
+        void Flush();
+    };
+}
+
+#endif/*_DREAM_LOG_QUEUE_HPP*/
@@ -0,0 +1,86 @@
+#ifndef _DREAM_MEMORY_SFILE_HPP
+#define _DREAM_MEMORY_SFILE_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <vector>
+#include <softlib/SFile.h>
+#include "FVM/config.h"
+#include "FVM/FVMException.hpp"
+
+namespace DREAM {
+    class MemorySFile : public SFile {
+    public:
+        // Variable (or struct) stored in the file
+        struct variable {
+            enum sfile_data_type type;
+            std::vector<sfilesize_t> dims;
+            std::vector<double> dbl;
+            std::vector<int64_t> ints;
+            std::string str;
+            std::map<std::string, std::string> strAttributes;
+            std::map<std::string, double> scalarAttributes;
+        };
+
+    private:
+        // Variables, indexed by their full path (without leading '/').
+        // Since the map is ordered, the members of a struct directly
+        // follow the struct itself.
+        std::map<std::string, struct variable> variables;
+
+        static std::string Normalize(const std::string&);
+        struct variable& Create(const std::string&, enum sfile_data_type, const sfilesize_t, const sfilesize_t*);
+        struct variable& Find(const std::string&);
+
+    public:
+        MemorySFile(const std::string& name="<memory>");
+        virtual ~MemorySFile() {}
+
+        const std::map<std::string, struct variable>& GetVariables() const
+        { return this->variables; }
+
+        void CopyTo(SFile*) const;
+        uint64_t GetContentHash() const;
+
+        virtual void Close() {}
+        virtual void Open(const std::string&, enum sfile_mode) {}
+
+        virtual void CreateStruct(const std::string&);
+        virtual bool HasVariable(const std::string&);
+        virtual enum sfile_data_type GetDataType(const std::string&);
+
+        virtual double **GetDoubles(const std::string&, sfilesize_t*);
+        virtual double *GetDoubles1D(const std::string&, sfilesize_t*);
+        virtual double *GetList(const std::string&, sfilesize_t*);
+        virtual int64_t *GetIntList(const std::string&, sfilesize_t*);
+        virtual int64_t GetInt(const std::string&);
+        virtual double GetScalar(const std::string&);
+        virtual std::string GetString(const std::string&);
+        virtual double *GetMultiArray_linear(const std::string&, const sfilesize_t, sfilesize_t&, sfilesize_t*);
+        virtual std::string GetAttributeString(const std::string&, const std::string&);
+        virtual double GetAttributeScalar(const std::string&, const std::string&);
+
+        virtual void WriteArray(const std::string&, const double *const*, const sfilesize_t, const sfilesize_t);
+        virtual void WriteAttribute_scalar(const std::string&, const std::string&, const double);
+        virtual void WriteAttribute_string(const std::string&, const std::string&, const std::string&);
+        virtual void WriteInt32List(const std::string&, const int32_t*, const sfilesize_t);
+        virtual void WriteInt64List(const std::string&, const int64_t*, const sfilesize_t);
+        virtual void WriteList(const std::string&, const double*, const sfilesize_t);
+        virtual void WriteMultiArray(const std::string&, const double*, const sfilesize_t, const sfilesize_t*);
+        virtual void WriteMultiInt64Array(const std::string&, const int64_t*, const sfilesize_t, const sfilesize_t*);
+        virtual void WriteScalar(const std::string&, const double);
+        virtual void WriteString(const std::string&, const std::string&);
+    };
+
+    class MemorySFileException : public DREAM::FVM::FVMException {
+    public:
+        template<typename ... Args>
+        MemorySFileException(const std::string &msg, Args&& ... args)
+            : FVMException(msg, std::forward<Args>(args) ...) {
+            AddModule("MemorySFile");
+        }
+    };
+}
+
+#endif/*_DREAM_MEMORY_SFILE_HPP*/
@@ -1,22 +1,48 @@
 #ifndef _DREAM_NIST_HPP
 #define _DREAM_NIST_HPP
 
-#include <unordered_map>
+#include <vector>
 #include "DREAM/nistdata.h"
 #include "FVM/config.h"
 
 namespace DREAM {
     class NIST {
     private:
-        std::unordered_map<len_t, struct nist_data*> binding;
-        std::unordered_map<len_t, struct nist_data*> ionization;
+        // Energies indexed directly by atomic charge Z
+        // ('nullptr' for elements without data)
+        std::vector<const real_t*> binding;
+        std::vector<const real_t*> ionization;
 
-        real_t _GetEnergy(const len_t, const len_t, const std::unordered_map<len_t, struct nist_data*>&) const;
+        static void _BuildTable(const struct nist_data*, const len_t, std::vector<const real_t*>&);
+        [[noreturn]] static void _ThrowMissing(const len_t);
+
+        /**
+         * General, internal method for retrieving NIST data.
+         */
+        real_t _GetEnergy(const len_t Z, const len_t Z0, const std::vector<const real_t*>& arr) const {
+            if (Z >= arr.size() || arr[Z] == nullptr)
+                _ThrowMissing(Z);
+
+            if (Z0 == Z)
+                return 0;
+            else
+                return arr[Z][Z0];
+        }
     public:
         NIST();
 
-        real_t GetBindingEnergy(const len_t Z, const len_t Z0) const;
-        real_t GetIonizationEnergy(const len_t Z, const len_t Z0) const;
+        /**
+         * Retrieve the total binding energy for the ion with
+         * atomic charge Z, in charge state Z0.
+         */
+        real_t GetBindingEnergy(const len_t Z, const len_t Z0) const
+        { return this->_GetEnergy(Z, Z0, this->binding); }
+        /**
+         * Retrieve the ionization energy for the ion with
+         * atomic charge Z, in charge state Z0.
+         */
+        real_t GetIonizationEnergy(const len_t Z, const len_t Z0) const
+        { return this->_GetEnergy(Z, Z0, this->ionization); }
     };
 }
 
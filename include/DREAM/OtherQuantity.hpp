@@ -2,6 +2,7 @@
 #define _DREAM_OTHER_QUANTITY_HPP
 
 #include <functional>
+#include <limits>
 #include <string>
 #include "FVM/Grid/Grid.hpp"
 #include "FVM/Grid/fluxGridType.enum.hpp"
@@ -11,7 +12,7 @@
 namespace DREAM {
     class OtherQuantity {
     private:
-        FVM::QuantityData *data;
+        FVM::QuantityData *data = nullptr;
 
         std::string name, description;
         FVM::Grid *grid;
@@ -19,6 +20,16 @@ namespace DREAM {
         enum FVM::fluxGridType fgt;
 
         bool active = false;
+        // If true, the quantity uses state shared with other quantities
+        // (e.g. scratch buffers or equation terms) and may not be
+        // evaluated concurrently with them
+        bool serial = false;
+
+        // Output cadence: the quantity is only evaluated and stored on
+        // every 'every'th save step with time in the window [tmin, tmax]
+        len_t every = 1, nCandidates = 0;
+        real_t tmin = -std::numeric_limits<real_t>::infinity();
+        real_t tmax = std::numeric_limits<real_t>::infinity();
 
         std::function<void(const real_t, FVM::QuantityData*)> storeFunc;
 
@@ -40,17 +51,67 @@ namespace DREAM {
             this->active = true;    
         }
         bool IsActive() { return this->active; }
+        bool IsSerial() { return this->serial; }
+        void SetSerial(bool s=true) { this->serial = s; }
         const std::string& GetName() { return this->name; }
+        const std::string& GetDescription() { return this->description; }
+        FVM::QuantityData *GetData() { return this->data; }
 
         FVM::Grid *GetGrid() { return this->grid; }
+        len_t GetNSavedSteps() { return (this->active ? this->data->GetNSavedSteps() : 0); }
+        size_t GetStepMemoryUsage() { return (this->active ? this->data->GetStepMemoryUsage() : 0); }
+
+        void SetCadence(const len_t every, const real_t tmin, const real_t tmax) {
+            this->every = every;
+            this->tmin = tmin;
+            this->tmax = tmax;
+        }
+        /**
+         * Returns true if this quantity is not stored on every
+         * save step (in which case its time grid must be saved
+         * alongside the data).
+         */
+        bool IsDecimated() {
+            return (this->every > 1 ||
+                this->tmin > -std::numeric_limits<real_t>::infinity() ||
+                this->tmax < std::numeric_limits<real_t>::infinity());
+        }
 
         void SaveSFile(SFile *sf, const std::string& path="") {
             this->data->SaveSFile(sf, this->name, path, this->description);
+
+            if (this->IsDecimated()) {
+                std::vector<real_t> t(this->data->GetNSavedSteps());
+                for (len_t i = 0; i < t.size(); i++)
+                    t[i] = this->data->GetSavedTime(i);
+
+                sf->WriteList(path + "/" + this->name + "@t", t.data(), t.size());
+            }
         }
-        void Store(const real_t t) {
+        /**
+         * Returns true if the quantity should be stored on the
+         * save step at time 't'. Must be called exactly once per
+         * save step, since it advances the output cadence.
+         */
+        bool IsDue(const real_t t) {
+            if (t < this->tmin || t > this->tmax)
+                return false;
+            else
+                return ((this->nCandidates++) % this->every == 0);
+        }
+        /**
+         * Evaluate and store the quantity at time 't'
+         * (regardless of the output cadence).
+         */
+        void Evaluate(const real_t t) {
             this->storeFunc(t, this->data);
             this->data->SaveStep(t, true);
         }
+        void Store(const real_t t) {
+            // Skip evaluation entirely if the quantity is not due for output
+            if (this->IsDue(t))
+                this->Evaluate(t);
+        }
     };
 }
 
@@ -25,6 +25,7 @@ namespace DREAM { class OtherQuantityHandler; }
 #include "DREAM/Equations/Fluid/HyperresistiveDiffusionTerm.hpp"
 #include "DREAM/Equations/Kinetic/RipplePitchScattering.hpp"
 #include "FVM/Equation/AdvectionDiffusionTerm.hpp"
+#include "FVM/Equation/BoundaryConditions/PXiExternalLoss.hpp"
 
 namespace DREAM {
     class OtherQuantityHandler {
@@ -47,6 +48,9 @@ namespace DREAM {
             DREAM::TransportDiffusiveBC *n_re_diffusive_bc=nullptr;
             DREAM::TransportAdvectiveBC *T_cold_advective_bc=nullptr;
             DREAM::TransportDiffusiveBC *T_cold_diffusive_bc=nullptr;
+            // Loss of particles through the upper momentum boundary
+            DREAM::FVM::BC::PXiExternalLoss *f_hot_pmax_bc=nullptr;
+            DREAM::FVM::BC::PXiExternalLoss *f_re_pmax_bc=nullptr;
             // Svensson transport coefficients
             DREAM::SvenssonTransportAdvectionTermA *svensson_A=nullptr;
             DREAM::SvenssonTransportDiffusionTerm  *svensson_D=nullptr;
@@ -80,9 +84,10 @@ namespace DREAM {
             id_Eterm, id_jtot, id_psip=0, id_Ip, id_psi_edge=0, id_psi_wall=0,
             id_n_re_neg=0;
 
-        // helper arrays with enough memory allocated to store the hottail and runaway grids 
-        real_t *kineticVectorHot; 
-        real_t *kineticVectorRE; 
+        // helper arrays with enough memory allocated to store the hottail and runaway grids
+        // (only allocated once a quantity is registered)
+        real_t *kineticVectorHot=nullptr;
+        real_t *kineticVectorRE=nullptr;
 
         // helper functions for evaluating other quantities
         real_t integratedKineticBoundaryTerm(
@@ -91,6 +96,17 @@ namespace DREAM {
             real_t *kineticVector
         );
         real_t evaluateMagneticEnergy();
+        // Reductions of distribution functions on p/xi grids
+        // (stored as [k][ir] on the fluid grid)
+        len_t nLegendreModes;
+        static bool isPXiGrid(FVM::Grid*);
+        static void evaluatePitchIntegral(FVM::Grid*, const real_t*, real_t*);
+        static void evaluateLegendreMoments(FVM::Grid*, const real_t*, const len_t, real_t*);
+        // Magnetic energy, and the versions of (jtot, psi_p, psi_wall, I_p)
+        // for which it was evaluated (it is needed by several quantities)
+        real_t magneticEnergy = 0;
+        len_t magneticEnergyVersions[4] = {0};
+        bool magneticEnergyValid = false;
         real_t integrateWeightedMaxwellian(len_t, real_t, real_t, std::function<real_t(len_t,real_t)>);
         struct eqn_terms *tracked_terms;
 
@@ -100,18 +116,22 @@ namespace DREAM {
             PostProcessor*, RunawayFluid*, FVM::UnknownQuantityHandler*,
             std::vector<UnknownQuantityEquation*>*, IonHandler*,
             FVM::Grid*, FVM::Grid*, FVM::Grid*, FVM::Grid*,
-            struct eqn_terms*
+            struct eqn_terms*, const len_t nLegendreModes=4
         );
         virtual ~OtherQuantityHandler();
 
         void DefineQuantities();
         OtherQuantity *GetByName(const std::string&);
         len_t GetNRegistered() const { return this->registered.size(); }
+        const std::vector<OtherQuantity*>& GetRegistered() const { return this->registered; }
+        size_t GetStepMemoryUsage() const;
 
         bool RegisterGroup(const std::string&);
         void RegisterQuantity(const std::string&, bool ignorefail=false);
         void RegisterQuantity(OtherQuantity*);
         void RegisterAllQuantities();
+        void ReleaseUnregistered();
+        void SetCadence(const std::string&, const len_t, const real_t, const real_t);
         void StoreAll(const real_t);
 
         void SaveSFile(SFile*, const std::string& path="other");
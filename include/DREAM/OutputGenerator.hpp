@@ -31,6 +31,9 @@ namespace DREAM {
 
 		virtual void Save(bool current=false);
         virtual void SaveCurrent() { this->Save(true); }
+        // Write the saved steps not yet written (only used by
+        // generators which write output during the simulation)
+        virtual void WriteSavedSteps() {}
 	};
 
     class OutputGeneratorException : public DREAM::FVM::FVMException {
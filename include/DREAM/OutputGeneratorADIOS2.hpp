@@ -0,0 +1,60 @@
+#ifndef _DREAM_OUTPUT_GENERATOR_ADIOS2_HPP
+#define _DREAM_OUTPUT_GENERATOR_ADIOS2_HPP
+
+#include "FVM/config.h"
+
+#ifdef DREAM_WITH_ADIOS2
+
+#include <adios2.h>
+#include <string>
+#include <vector>
+#include "DREAM/OutputGenerator.hpp"
+
+namespace DREAM {
+	class OutputGeneratorADIOS2 : public OutputGenerator {
+	protected:
+        std::string filename, engineType;
+
+        adios2::ADIOS *adios = nullptr;
+        adios2::IO io;
+        adios2::Engine engine;
+        // Number of saved time steps written so far
+        len_t nWritten = 0;
+        bool gridsWritten = false, closed = false;
+
+        // Work buffer for copying non-contiguous data
+        std::vector<real_t> buffer;
+
+		virtual void SaveGrids(const std::string&, bool) override;
+		virtual void SaveIonMetaData(const std::string&) override;
+		virtual void SaveOtherQuantities(const std::string&) override;
+		virtual void SaveSettings(const std::string&) override;
+        virtual void SaveSolverData(const std::string&) override;
+		virtual void SaveTimings(const std::string&) override;
+		virtual void SaveUnknowns(const std::string&, bool) override;
+
+        void Open();
+        void SaveMomentumGrid(const std::string&, FVM::Grid*, enum OptionConstants::momentumgrid_type);
+        template<typename T>
+        void WriteArray(const std::string&, const T*, const std::vector<size_t>&);
+        template<typename T>
+        void WriteScalar(const std::string&, const T);
+        void WriteString(const std::string&, const std::string&);
+        void WriteAttribute(const std::string&, const std::string&, const std::string&);
+        void WriteQuantitySteps(const std::string&, FVM::QuantityData*, const len_t, const std::string&);
+        std::vector<size_t> GetStepShape(FVM::QuantityData*);
+	public:
+		OutputGeneratorADIOS2(
+            EquationSystem*, const std::string&, const std::string& engine="BP5",
+            bool savesettings=true
+        );
+        virtual ~OutputGeneratorADIOS2();
+
+        virtual void Save(bool current=false) override;
+        virtual void WriteSavedSteps() override;
+	};
+}
+
+#endif/*DREAM_WITH_ADIOS2*/
+
+#endif/*_DREAM_OUTPUT_GENERATOR_ADIOS2_HPP*/
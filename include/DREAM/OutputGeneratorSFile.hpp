@@ -10,6 +10,18 @@ namespace DREAM {
 	protected:
         std::string filename;
 		SFile *sf=nullptr;
+        // If 'true', the unknown quantities have already been
+        // written to the output file by an 'OutputStream'
+        bool unknownsStreamed=false;
+        // If 'true', the unknown quantities are written in a chunked
+        // layout (using an 'OutputStream'), compressed at the given
+        // deflate level
+        bool chunkedLayout=false;
+        int_t compression=0;
+        // Directory in which to store the grids (by the hash of their
+        // contents), shared between outputs with identical grids
+        // (empty = store the grids in the output file)
+        std::string gridStore;
 
 		virtual void SaveGrids(const std::string&, bool) override;
 		virtual void SaveIonMetaData(const std::string&) override;
@@ -19,6 +31,8 @@ namespace DREAM {
 		virtual void SaveTimings(const std::string&) override;
 		virtual void SaveUnknowns(const std::string&, bool) override;
 
+        void SaveGridData(SFile*, const std::string&);
+        std::string StoreGrids();
         void SaveMomentumGrid(SFile*, const std::string&, FVM::Grid*, enum OptionConstants::momentumgrid_type);
         void WriteCopyArray(SFile*, const std::string&, const real_t *const*, const len_t, const len_t);
         void WriteCopyMultiArray(SFile*, const std::string&, const real_t *const*, const sfilesize_t, const sfilesize_t[]);
@@ -28,6 +42,10 @@ namespace DREAM {
         virtual ~OutputGeneratorSFile();
 
         virtual void Save(bool current=false) override;
+        void SetChunkedLayout(int_t compression=0)
+        { this->chunkedLayout = true; this->compression = compression; }
+        void SetGridStore(const std::string& directory)
+        { this->gridStore = directory; }
 	};
 }
 
@@ -0,0 +1,28 @@
+#ifndef _DREAM_OUTPUT_SLICE_READER_HPP
+#define _DREAM_OUTPUT_SLICE_READER_HPP
+
+#include <H5Cpp.h>
+#include <string>
+#include <softlib/SFile.h>
+#include "FVM/config.h"
+
+namespace DREAM {
+    class OutputSliceReader {
+    private:
+        H5::H5File *file;
+
+    public:
+        OutputSliceReader(const std::string&);
+        ~OutputSliceReader();
+
+        static bool IsHDF5(const std::string&);
+
+        sfilesize_t GetDimensions(const std::string&, const sfilesize_t, sfilesize_t*);
+        real_t *GetTimeSlice(
+            const std::string&, const len_t, const sfilesize_t,
+            sfilesize_t&, sfilesize_t*
+        );
+    };
+}
+
+#endif/*_DREAM_OUTPUT_SLICE_READER_HPP*/
@@ -0,0 +1,87 @@
+#ifndef _DREAM_OUTPUT_STREAM_HPP
+#define _DREAM_OUTPUT_STREAM_HPP
+
+#include <condition_variable>
+#include <deque>
+#include <H5Cpp.h>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "FVM/UnknownQuantity.hpp"
+#include "FVM/UnknownQuantityHandler.hpp"
+
+namespace DREAM {
+    class OutputStream {
+    private:
+        struct stream_dataset {
+            FVM::UnknownQuantity *uqn;
+            H5::DataSet dataset;
+            // Number of dimensions (including time)
+            len_t ndims;
+            hsize_t dims[5];
+            // Number of saved steps handed to the writer thread so far
+            len_t nQueued;
+            // If true, the quantity is stored in single precision
+            bool single;
+        };
+
+        // A single saved step to write
+        struct stream_step {
+            struct stream_dataset *ds;
+            len_t index;
+            const real_t *data;
+            // Data of the step, if stored in single precision
+            // (in which case 'data' is 'nullptr')
+            const float *fdata;
+            // If true, 'data'/'fdata' is deleted once written
+            bool owned;
+        };
+
+        // Maximum number of batches of saved steps waiting to be
+        // written (when full, the solver waits for the writer)
+        static constexpr len_t MAX_QUEUED_BATCHES = 8;
+
+        std::string filename;
+        FVM::UnknownQuantityHandler *unknowns;
+
+        // If true, datasets of kinetic quantities are chunked by
+        // radius as well as by time step
+        bool radialChunks;
+        // Deflate compression level (0 = no compression)
+        int_t compression;
+
+        H5::H5File *file = nullptr;
+        std::vector<struct stream_dataset*> datasets;
+
+        // Background writer
+        std::thread writer;
+        std::mutex queueMutex;
+        std::condition_variable queueCond;
+        std::deque<std::vector<struct stream_step>> queue;
+        bool stopWriter = false;
+        // Error message from the writer thread (if any)
+        std::string writerError;
+
+        void Open();
+        void RunWriter();
+        void StopWriter();
+        void WriteBatch(std::vector<struct stream_step>&);
+        void WriteStringAttribute(H5::DataSet&, const std::string&, const std::string&);
+
+    public:
+        OutputStream(
+            FVM::UnknownQuantityHandler*, const std::string&,
+            bool radialChunks=false, int_t compression=0
+        );
+        ~OutputStream();
+
+        void Close();
+        const std::string& GetFilename() const { return this->filename; }
+        bool IsOpen() const { return (this->file != nullptr); }
+        bool HasWritten() const { return !this->datasets.empty(); }
+        void WriteSavedSteps();
+    };
+}
+
+#endif/*_DREAM_OUTPUT_STREAM_HPP*/
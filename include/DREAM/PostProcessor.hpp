@@ -22,6 +22,8 @@ namespace DREAM {
         // IDs
         len_t id_n_re;
 
+        void ProcessRunawayRate(const real_t);
+
     public:
         PostProcessor(
             FVM::Grid*, FVM::UnknownQuantityHandler*, real_t pThreshold, 
@@ -34,7 +36,7 @@ namespace DREAM {
         const real_t GetPThreshold() const {return pThreshold;}
         const FVM::MomentQuantity::pThresholdMode GetPThresholdMode() const {return pThresholdMode;}
         
-        void Process(const real_t t);
+        void Process(const real_t t, const bool saveStep=true);
     };
 }
 
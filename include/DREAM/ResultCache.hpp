@@ -0,0 +1,32 @@
+#ifndef _DREAM_RESULT_CACHE_HPP
+#define _DREAM_RESULT_CACHE_HPP
+
+#include <cstdint>
+#include <string>
+#include "DREAM/Settings/Settings.hpp"
+#include "FVM/Grid/GeometryCache.hpp"
+
+namespace DREAM {
+    class ResultCache {
+    private:
+        std::string filename;
+        uint64_t key;
+
+        static bool CopyFile(const std::string&, const std::string&);
+
+    public:
+        ResultCache(const std::string& directory, Settings*);
+
+        static uint64_t ComputeKey(Settings*);
+        static void AddToHash(FVM::GeometryCache::Hash&, const Settings::setting_t*);
+        static bool IsIgnoredSetting(const std::string&);
+
+        uint64_t GetKey() const { return this->key; }
+        const std::string& GetFilename() const { return this->filename; }
+
+        bool Restore(const std::string&) const;
+        bool Store(const std::string&) const;
+    };
+}
+
+#endif/*_DREAM_RESULT_CACHE_HPP*/
@@ -65,6 +65,17 @@ enum adas_interp_type {
     ADAS_INTERP_BICUBIC=2
 };
 
+// HDF5 layout of unknown quantities in the output file
+enum output_layout {
+    OUTPUT_LAYOUT_CONTIGUOUS=1,     // One contiguous dataset per quantity (default)
+    OUTPUT_LAYOUT_CHUNKED=2         // Chunked by time step (and radius, for kinetic quantities)
+};
+
+enum output_backend {
+    OUTPUT_BACKEND_SFILE=1,         // HDF5 (or MATLAB) file written at the end of the simulation (default)
+    OUTPUT_BACKEND_ADIOS2=2         // ADIOS2 output, written as the simulation progresses
+};
+
 /////////////////////////////////////
 ///
 /// GRID OPTIONS
@@ -87,7 +98,8 @@ enum momentumgrid_type {
 enum pxigrid_ptype {
     PXIGRID_PTYPE_UNIFORM=1,
     PXIGRID_PTYPE_BIUNIFORM=2,
-    PXIGRID_PTYPE_CUSTOM=3
+    PXIGRID_PTYPE_CUSTOM=3,
+    PXIGRID_PTYPE_ADAPTIVE=4
 };
 
 // Type of xi grid
@@ -97,7 +109,8 @@ enum pxigrid_xitype {
     PXIGRID_XITYPE_UNIFORM_THETA=3,
     PXIGRID_XITYPE_BIUNIFORM_THETA=4,
     PXIGRID_XITYPE_CUSTOM=5,
-    PXIGRID_XITYPE_TRAPPED=6
+    PXIGRID_XITYPE_TRAPPED=6,
+    PXIGRID_XITYPE_GAUSS_LEGENDRE_NODES=7
 };
 
 // Type of advection interpolation coefficient for jacobian
@@ -128,7 +141,81 @@ enum linear_solver {
     LINEAR_SOLVER_MUMPS=2,
     LINEAR_SOLVER_MKL=3,
     LINEAR_SOLVER_SUPERLU=4,
-    LINEAR_SOLVER_GMRES=5
+    LINEAR_SOLVER_GMRES=5,
+    LINEAR_SOLVER_MIXED_PRECISION=6
+};
+// Backend used for the matrices, vectors and linear solves
+// (must match 'FVM::PETScBackend::backend')
+enum solver_backend {
+    SOLVER_BACKEND_CPU=1,
+    SOLVER_BACKEND_CUDA=2,
+    SOLVER_BACKEND_HIP=3,
+    SOLVER_BACKEND_KOKKOS=4
+};
+// Method used to refine the solution of the mixed-precision
+// linear solver
+enum mixed_precision_refinement {
+    MIXED_PRECISION_REFINEMENT_RICHARDSON=1,
+    MIXED_PRECISION_REFINEMENT_GMRES=2
+};
+// Preconditioner used with the GMRES linear solver
+enum gmres_preconditioner {
+    GMRES_PC_BLOCK_JACOBI=1,    // One block per unknown (no coupling between unknowns)
+    GMRES_PC_FIELDSPLIT=2,      // Split unknowns into groups coupled via a Schur complement
+    GMRES_PC_KINETIC_GRIDS=3    // One split per kinetic grid, plus one for fluid unknowns (block Gauss-Seidel)
+};
+// Preconditioner used for the kinetic split(s) of the
+// field-split GMRES preconditioner
+enum gmres_kinetic_pc {
+    GMRES_KINETIC_PC_ILU=1,
+    GMRES_KINETIC_PC_GAMG=2,
+    GMRES_KINETIC_PC_LU=3,
+    GMRES_KINETIC_PC_RADIAL_LU=4,   // One LU factorization per radius (requires no radial transport)
+    GMRES_KINETIC_PC_MG=5           // Geometric multigrid on the momentum grids, with line smoothing
+};
+// Lines along which the smoother of the kinetic multigrid
+// preconditioner relaxes
+enum gmres_mg_lines {
+    GMRES_MG_LINES_P=1,             // Lines of constant xi (along p)
+    GMRES_MG_LINES_XI=2,            // Lines of constant p (along xi)
+    GMRES_MG_LINES_ALTERNATING=3    // Lines along p followed by lines along xi
+};
+// Strategy for updating the jacobian matrix in the
+// non-linear solver
+enum solver_jacobian_update {
+    SOLVER_JACOBIAN_UPDATE_ALWAYS=1,            // Rebuild and factorize the jacobian in every iteration
+    SOLVER_JACOBIAN_UPDATE_MODIFIED_NEWTON=2,   // Reuse the factorized jacobian while the iteration contracts sufficiently
+    SOLVER_JACOBIAN_UPDATE_NEWTON_KRYLOV=3,     // Solve with GMRES, preconditioned by the most recently factorized jacobian
+    SOLVER_JACOBIAN_UPDATE_JFNK=4               // Jacobian-free Newton-Krylov, preconditioned by the most recently factorized jacobian
+};
+// Globalization of the Newton iteration in the non-linear solver
+enum solver_line_search {
+    SOLVER_LINE_SEARCH_NONE=1,                  // Only damp steps which would make unknowns unphysical
+    SOLVER_LINE_SEARCH_BACKTRACKING=2           // Backtracking line search on the norm of the residual
+};
+// Predictor of the initial guess of the non-linear solver
+enum solver_predictor {
+    SOLVER_PREDICTOR_NONE=1,                    // Start from the solution in the previous time step
+    SOLVER_PREDICTOR_LINEAR=2,                  // Linear extrapolation from the two most recent time steps
+    SOLVER_PREDICTOR_QUADRATIC=3                // Quadratic extrapolation from the three most recent time steps
+};
+// Ordering of the unknowns in the factorization of the matrix
+enum solver_factor_ordering {
+    SOLVER_FACTOR_ORDERING_DEFAULT=1,           // Default ordering of the linear solver
+    SOLVER_FACTOR_ORDERING_RADIAL=2,            // Unknowns interleaved by radius
+    SOLVER_FACTOR_ORDERING_RCM=3,               // Reverse Cuthill-McKee
+    SOLVER_FACTOR_ORDERING_ND=4                 // Nested dissection
+};
+// Splitting of the equation system into kinetic and fluid parts
+enum solver_splitting {
+    SOLVER_SPLITTING_NONE=1,                    // Solve the fully coupled system
+    SOLVER_SPLITTING_LIE=2,                     // Kinetic step followed by fluid step
+    SOLVER_SPLITTING_STRANG=3                   // Kinetic half-step, fluid step, kinetic half-step
+};
+// Format of the matrices saved for debugging
+enum solver_debug_format {
+    SOLVER_DEBUG_FORMAT_PETSC=1,                // PETSc binary format (readable by 'PetscBinaryIO')
+    SOLVER_DEBUG_FORMAT_CSR=2                   // Memory-mappable CSR format with an index of the unknown blocks
 };
 
 /////////////////////////////////////
@@ -139,7 +226,18 @@ enum linear_solver {
 enum timestepper_type {
     TIMESTEPPER_TYPE_CONSTANT=1,
     TIMESTEPPER_TYPE_ADAPTIVE=2,
-	TIMESTEPPER_TYPE_IONIZATION=3
+	TIMESTEPPER_TYPE_IONIZATION=3,
+    TIMESTEPPER_TYPE_EMBEDDED=4
+};
+
+enum timestepper_ionization_controller {
+    TIMESTEPPER_IONIZATION_CONTROLLER_SCALE=1,  // Time step proportional to the time scale
+    TIMESTEPPER_IONIZATION_CONTROLLER_PI=2      // PI controller, limited by the time scale
+};
+
+enum tolerance_norm {
+    TOLERANCE_NORM_2NORM=1,     // |dx| <= abstol + reltol*|x| (2-norms of each unknown)
+    TOLERANCE_NORM_WRMS=2       // Weighted RMS norm of dx/(abstol + reltol*|x_i|) <= 1
 };
 
 /////////////////////////////////////
@@ -1,8 +1,8 @@
 #ifndef _DREAM_SETTINGS_HPP
 #define _DREAM_SETTINGS_HPP
 
-#include <map>
 #include <string>
+#include <unordered_map>
 #include <vector>
 #include "FVM/config.h"
 #include "FVM/FVMException.hpp"
@@ -28,6 +28,7 @@ namespace DREAM {
             SETTING_TYPE_STRING
         };
         typedef struct _setting {
+            std::string name;
             std::string description;
             enum setting_type type;
             len_t ndims, *dims=nullptr;
@@ -52,8 +53,14 @@ namespace DREAM {
             }
         } setting_t;
 
+        // Handle to a defined setting, which can be used to access
+        // the setting repeatedly without looking up its name. Handles
+        // remain valid until the setting is undefined (or the Settings
+        // object is deleted).
+        typedef setting_t *handle_t;
+
     private:
-        std::map<std::string, setting_t*> settings;
+        std::unordered_map<std::string, setting_t*> settings;
 
         const char *GetTypeName(enum setting_type s) {
             switch (s) {
@@ -77,6 +84,9 @@ namespace DREAM {
         template<typename T>
         T *_GetArray(const std::string&, const len_t, len_t[], enum setting_type, bool markused=true);
         setting_t *_GetSetting(const std::string&, enum setting_type, bool markused=true);
+        setting_t *_CheckSetting(setting_t*, enum setting_type, bool markused=true);
+        template<typename T>
+        T *_GetArray(setting_t*, const len_t, len_t[], enum setting_type, bool markused=true);
 
         template<typename T>
         void _SetSetting(const std::string& name, const T& value, enum setting_type type);
@@ -88,7 +98,7 @@ namespace DREAM {
         Settings();
         ~Settings();
 
-        const std::map<std::string, setting_t*> GetSettings() const { return this->settings; }
+        const std::unordered_map<std::string, setting_t*>& GetSettings() const { return this->settings; }
 
         // DEFINE SETTINGS
         void DefineSetting(const std::string& name, const std::string& desc, bool defaultValue, bool mandatory=false);
@@ -113,6 +123,14 @@ namespace DREAM {
         const std::string GetString(const std::string&, bool markused=true);
         std::vector<std::string> GetStringList(const std::string&, const char delim=';', bool markused=true);
 
+        handle_t GetHandle(const std::string&, enum setting_type);
+        bool GetBool(handle_t, bool markused=true);
+        int_t GetInteger(handle_t, bool markused=true);
+        const int_t *GetIntegerArray(handle_t, const len_t nExpectedDims, len_t dims[], bool markused=true);
+        real_t GetReal(handle_t, bool markused=true);
+        const real_t *GetRealArray(handle_t, const len_t nExpectedDims, len_t dims[], bool markused=true);
+        const std::string& GetString(handle_t, bool markused=true);
+
         void MarkUsed(const std::string&);
 
         // SETTERS
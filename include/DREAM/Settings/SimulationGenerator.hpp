@@ -1,6 +1,9 @@
 #ifndef _DREAM_PROCESS_SETTINGS_HPP
 #define _DREAM_PROCESS_SETTINGS_HPP
 
+#include <cstdint>
+#include <string>
+#include <vector>
 #include "DREAM/ADAS.hpp"
 #include "DREAM/AMJUEL.hpp"
 #include "DREAM/ConvergenceChecker.hpp"
@@ -19,9 +22,11 @@
 #include "DREAM/Solver/Solver.hpp"
 #include "DREAM/Solver/SolverLinearlyImplicit.hpp"
 #include "DREAM/Solver/SolverNonLinear.hpp"
+#include "DREAM/Solver/SolverSplit.hpp"
 #include "DREAM/TimeStepper/TimeStepper.hpp"
 #include "DREAM/TimeStepper/TimeStepperAdaptive.hpp"
 #include "DREAM/TimeStepper/TimeStepperConstant.hpp"
+#include "DREAM/TimeStepper/TimeStepperEmbedded.hpp"
 #include "DREAM/TimeStepper/TimeStepperIonization.hpp"
 #include "FVM/Grid/Grid.hpp"
 #include "FVM/Grid/PXiGrid/PXiMomentumGrid.hpp"
@@ -32,6 +37,40 @@
 namespace DREAM {
     class SimulationGenerator {
     public:
+        /**
+         * Time spent constructing the parts of the equation
+         * system (reported by 'ProcessSettings()' in verbose mode).
+         */
+        struct construction_timings {
+            FVM::DurationTimer
+                initializer, unknowns, ions, collisions, runawayFluid,
+                equations, otherQuantities, processSystem, timeStepper, solver;
+        };
+
+        /**
+         * Grids constructed by 'ProcessSettings()', which are reused by
+         * later simulations with identical grid settings (such as the
+         * members of a parameter scan run in batch mode). Only one set
+         * of grids is kept (the most recently constructed).
+         */
+        struct shared_grids {
+            // Hash of the grid settings which the grids were constructed from
+            uint64_t key = 0;
+            // Grid settings read when constructing the grids (which are
+            // marked as used in the settings of simulations reusing them)
+            std::vector<std::string> used;
+            // Settings which the grids were constructed from. The grid
+            // generators may keep references to its data, so it is owned
+            // by this object (and must not be deleted by the caller)
+            Settings *owner = nullptr;
+
+            FVM::Grid *scalarGrid=nullptr, *fluidGrid=nullptr,
+                *hottailGrid=nullptr, *runawayGrid=nullptr;
+            enum OptionConstants::momentumgrid_type
+                ht_type=OptionConstants::MOMENTUMGRID_TYPE_PXI,
+                re_type=OptionConstants::MOMENTUMGRID_TYPE_PXI;
+        };
+
         // PUBLIC INTERFACE
         static Settings *CreateSettings() {
             Settings *s = new Settings();
@@ -40,10 +79,14 @@ namespace DREAM {
             return s;
         }
         static void DefineOptions(Settings*);
-        static Simulation *ProcessSettings(Settings*);
+        static Simulation *ProcessSettings(
+            Settings*, bool verbose=false, ADAS *adas=nullptr,
+            NIST *nist=nullptr, AMJUEL *amjuel=nullptr,
+            struct shared_grids *grids=nullptr
+        );
 
         // FOR INTERNAL USE
-        static EquationSystem *ConstructEquationSystem(Settings*, FVM::Grid*, FVM::Grid*,  enum OptionConstants::momentumgrid_type, FVM::Grid*, enum OptionConstants::momentumgrid_type, FVM::Grid*, ADAS*, NIST*, AMJUEL*);
+        static EquationSystem *ConstructEquationSystem(Settings*, FVM::Grid*, FVM::Grid*,  enum OptionConstants::momentumgrid_type, FVM::Grid*, enum OptionConstants::momentumgrid_type, FVM::Grid*, ADAS*, NIST*, AMJUEL*, struct construction_timings *timings=nullptr);
         static FVM::Grid *ConstructScalarGrid();
         static FVM::Grid *ConstructHotTailGrid(Settings*, FVM::RadialGrid*, enum OptionConstants::momentumgrid_type*);
         static FVM::Grid *ConstructRunawayGrid(Settings*, FVM::RadialGrid*, FVM::Grid*, enum OptionConstants::momentumgrid_type*);
@@ -54,6 +97,7 @@ namespace DREAM {
             FVM::Grid *g, FVM::UnknownQuantityHandler *unknowns, IonHandler *ih,
             OptionConstants::momentumgrid_type, EquationSystem*, Settings*
         );
+        static EceffTable *ConstructEceffTable(const len_t, Settings*);
         static RunawaySourceTermHandler *ConstructRunawaySourceTermHandler(
             FVM::Grid*, FVM::Grid*, FVM::Grid*, FVM::Grid*, FVM::UnknownQuantityHandler*,
             RunawayFluid*, IonHandler*, AnalyticDistributionHottail*, 
@@ -67,6 +111,10 @@ namespace DREAM {
         static FVM::RadialGrid *ConstructRadialGrid_Numerical(const int_t, Settings*);
 
         static FVM::PXiGrid::PXiMomentumGrid *Construct_PXiGrid(
+            Settings*, const std::string&, const real_t, FVM::RadialGrid*,
+            const int_t nxi=-1
+        );
+        static FVM::Grid *Construct_PXiKineticGrid(
             Settings*, const std::string&, const real_t, FVM::RadialGrid*
         );
 
@@ -115,11 +163,16 @@ namespace DREAM {
         static ADAS *LoadADAS(Settings*);
         static AMJUEL *LoadAMJUEL(Settings*);
         static NIST *LoadNIST(Settings*);
+        static void LoadLogging(Settings*);
+        static void LoadNumberOfThreads(Settings*);
         static void LoadOutput(Settings*, Simulation*);
-        static CollisionQuantityHandler *ConstructCollisionQuantityHandler(enum OptionConstants::momentumgrid_type, FVM::Grid *,FVM::UnknownQuantityHandler *, IonHandler *,  Settings*);
-        static void ConstructEquations(EquationSystem*, Settings*, ADAS*, NIST*, AMJUEL*, struct OtherQuantityHandler::eqn_terms*);
+        static void RunGridContinuation(Settings*, bool, ADAS*, NIST*, AMJUEL*);
+        static void RunRadialGridAdaptation(Settings*, bool, ADAS*, NIST*, AMJUEL*);
+        static CollisionQuantityHandler *ConstructCollisionQuantityHandler(enum OptionConstants::momentumgrid_type, FVM::Grid *,FVM::UnknownQuantityHandler *, IonHandler *,  Settings*, CoulombLogarithmCache *lnLambdaCache=nullptr, CollisionFrequencyCache *collFreqCache=nullptr);
+        static void ConstructEquations(EquationSystem*, Settings*, ADAS*, NIST*, AMJUEL*, struct OtherQuantityHandler::eqn_terms*, struct construction_timings*);
         static real_t ConstructInitializer(EquationSystem*, Settings*);
         static void ConstructOtherQuantityHandler(EquationSystem*, Settings*, struct OtherQuantityHandler::eqn_terms*);
+        static void ConstructOtherQuantityCadence(OtherQuantityHandler*, Settings*);
         static void ConstructSolver(EquationSystem*, Settings*);
         static void ConstructTimeStepper(EquationSystem*, Settings*);
         static void ConstructUnknowns(EquationSystem*, Settings*, FVM::Grid*, FVM::Grid*, FVM::Grid*, FVM::Grid*);
@@ -138,7 +191,8 @@ namespace DREAM {
             enum OptionConstants::momentumgrid_type, DREAM::CollisionQuantityHandler*,
             bool, bool, DREAM::FVM::Operator **transport=nullptr,
             DREAM::TransportAdvectiveBC **abc=nullptr, DREAM::TransportDiffusiveBC **dbc=nullptr, 
-            DREAM::RipplePitchScattering **rps=nullptr, bool rescaleMaxwellian=false
+            DREAM::RipplePitchScattering **rps=nullptr, bool rescaleMaxwellian=false,
+            DREAM::FVM::BC::PXiExternalLoss **ebc=nullptr
         );
         static DREAM::RipplePitchScattering *ConstructEquation_f_ripple(Settings*, const std::string&, FVM::Grid*, enum OptionConstants::momentumgrid_type);
         static void ConstructEquation_S_particle_explicit(EquationSystem*, Settings*, struct OtherQuantityHandler::eqn_terms*);
@@ -229,7 +283,9 @@ namespace DREAM {
         // Routines for constructing time steppers
         static TimeStepperAdaptive *ConstructTimeStepper_adaptive(Settings*, FVM::UnknownQuantityHandler*, std::vector<len_t>*);
         static TimeStepperConstant *ConstructTimeStepper_constant(Settings*, FVM::UnknownQuantityHandler*);
+        static TimeStepperEmbedded *ConstructTimeStepper_embedded(Settings*, FVM::UnknownQuantityHandler*, std::vector<len_t>*);
         static TimeStepperIonization *ConstructTimeStepper_ionization(Settings*, FVM::UnknownQuantityHandler*);
+        static std::vector<real_t> LoadTimeStepEvents(Settings*);
 
         // Data loading routines
         static void DefineDataR(const std::string&, Settings*, const std::string& name="data");
@@ -263,6 +319,11 @@ namespace DREAM {
         // Routines for constructing solvers
         static SolverLinearlyImplicit *ConstructSolver_linearly_implicit(Settings*, FVM::UnknownQuantityHandler*, std::vector<UnknownQuantityEquation*>*, EquationSystem*);
         static SolverNonLinear *ConstructSolver_nonlinear(Settings*, FVM::UnknownQuantityHandler*, std::vector<UnknownQuantityEquation*>*, EquationSystem*);
+        static SolverSplit *ConstructSolver_split(Settings*, FVM::UnknownQuantityHandler*, std::vector<UnknownQuantityEquation*>*, EquationSystem*);
+        static void ConfigureSolver(Settings*, Solver*, FVM::UnknownQuantityHandler*, const len_t, const std::vector<len_t>&);
+        static std::vector<FVM::MIGMRES::split> ConstructGMRESFieldSplits(Settings*, FVM::UnknownQuantityHandler*, std::vector<len_t>);
+        static FVM::MIMixedPrecision::options LoadMixedPrecisionOptions(Settings*);
+        static void ConstructSolverBackend(Settings*);
     };
 }
 
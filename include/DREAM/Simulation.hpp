@@ -32,11 +32,28 @@ namespace DREAM {
         EquationSystem *eqsys;
 		OutputGenerator *outgen=nullptr;
 
+        // If false, the atomic databases are shared with other
+        // simulations and must not be deleted with this one
+        bool ownsAtomicData = true;
+
+        // State of a simulation advanced with 'Step()'
+        bool started = false, finished = false;
+
+        void BeginStep();
+        void FinishStep();
+
     public:
         Simulation();
         ~Simulation();
 
         void Run();
+        bool Step();
+        bool Step(const real_t);
+        bool IsFinished() const { return this->finished; }
+        real_t GetCurrentTime() const { return this->eqsys->GetCurrentTime(); }
+
+        real_t *GetUnknownData(const std::string&, len_t *n=nullptr);
+        real_t *GetPrescribedData(const std::string&, len_t *n=nullptr);
 
         ADAS *GetADAS() { return this->adas; }
         AMJUEL *GetAMJUEL() {return this->amjuel;}
@@ -46,9 +63,11 @@ namespace DREAM {
         void SetADAS(ADAS *a) { this->adas = a; }
         void SetAMJUEL(AMJUEL *amjuel) {this->amjuel=amjuel;}
         void SetNIST(NIST *n) { this->nist = n; }
+        void SetOwnsAtomicData(bool o) { this->ownsAtomicData = o; }
         void SetEquationSystem(EquationSystem *e) { this->eqsys = e; }
 
         void Save();
+        void Save(SFile*);
         void SetOutputGenerator(OutputGenerator*);
     };
 }
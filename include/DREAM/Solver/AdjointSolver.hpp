@@ -0,0 +1,100 @@
+#ifndef _DREAM_SOLVER_ADJOINT_SOLVER_HPP
+#define _DREAM_SOLVER_ADJOINT_SOLVER_HPP
+
+namespace DREAM { class AdjointSolver; }
+
+#include "FVM/config.h"
+
+#include <petsc.h>
+#include <string>
+#include <vector>
+#include <softlib/SFile.h>
+#include "DREAM/Solver/Solver.hpp"
+#include "FVM/BlockMatrix.hpp"
+#include "FVM/FVMException.hpp"
+#include "FVM/UnknownQuantityHandler.hpp"
+
+namespace DREAM {
+    class AdjointSolver {
+    public:
+        struct options {
+            // Name of the (non-trivial) unknown quantity defining the
+            // objective (empty if adjoint sensitivities are disabled)
+            std::string objective;
+            // Index of element of the unknown quantity to use
+            len_t index = 0;
+            // Measured time evolution of the element to fit (if
+            // empty, the objective is the value at the final time)
+            std::vector<real_t> data_t, data_x;
+            // Names of predetermined unknown quantities whose scale
+            // factors are the parameters of the objective
+            std::vector<std::string> parameters;
+        };
+
+    private:
+        // Data stored for each time step of the simulation
+        struct step {
+            // Time of the solution
+            real_t t;
+            // Jacobian dF_n/dx_n in the solution
+            Mat jacobian;
+            // Non-zero elements of dF_n/dx_{n-1}
+            std::vector<PetscInt> prevRows, prevCols;
+            std::vector<real_t> prevValues;
+            // dF_n/dp_k for every parameter (parameter-by-N array)
+            std::vector<real_t> dFdp;
+            // Value of the objective element, and of the
+            // data to fit it to (if available at this time)
+            real_t value, data;
+            bool hasData;
+        };
+
+        Solver *solver;
+        FVM::UnknownQuantityHandler *unknowns;
+        std::vector<len_t> nontrivials;
+        // Offset of each non-trivial unknown in the solution vector
+        std::vector<len_t> offsets;
+        len_t matrixSize;
+
+        struct options opts;
+        len_t objectiveId, objectiveRow;
+        std::vector<len_t> parameterIds;
+
+        std::vector<struct step> steps;
+        real_t *F0, *Fh;
+
+        bool computed = false;
+        real_t objective = 0;
+        std::vector<real_t> gradient;
+
+        bool InterpolateData(const real_t, real_t*);
+        void RecordPreviousStepDerivative(const real_t, const real_t, FVM::BlockMatrix*, struct step&);
+        void RecordParameterDerivative(const real_t, const real_t, FVM::BlockMatrix*, struct step&);
+
+    public:
+        AdjointSolver(
+            Solver*, FVM::UnknownQuantityHandler*,
+            const std::vector<len_t>&, const struct options&
+        );
+        ~AdjointSolver();
+
+        void Compute();
+        void RecordStep(const real_t, const real_t, FVM::BlockMatrix*);
+
+        real_t GetObjective() const { return this->objective; }
+        const std::vector<real_t>& GetGradient() const { return this->gradient; }
+
+        void WriteDataSFile(SFile*, const std::string&);
+    };
+
+    class AdjointSolverException : public DREAM::FVM::FVMException {
+    public:
+        template<typename ... Args>
+        AdjointSolverException(const std::string &msg, Args&& ... args)
+            : FVMException(msg, std::forward<Args>(args) ...) {
+            AddModule("AdjointSolver");
+        }
+    };
+}
+
+#endif/*_DREAM_SOLVER_ADJOINT_SOLVER_HPP*/
@@ -0,0 +1,64 @@
+#ifndef _DREAM_SOLVER_ALGEBRAIC_ELIMINATION_HPP
+#define _DREAM_SOLVER_ALGEBRAIC_ELIMINATION_HPP
+
+#include "FVM/config.h"
+
+#include <petsc.h>
+#include <vector>
+#include "FVM/Matrix.hpp"
+
+namespace DREAM {
+    class AlgebraicElimination {
+    public:
+        // Block of rows of the jacobian belonging to one unknown
+        struct block {
+            len_t id;           // ID of unknown quantity
+            PetscInt offset;    // Index of first row in jacobian
+            PetscInt n;         // Number of rows
+        };
+
+    private:
+        PetscInt N;
+        // Unknowns which may be eliminated, and those which are
+        std::vector<struct block> candidates, eliminated;
+        bool analyzed = false;
+
+        // Rows of eliminated ('A') and remaining ('D') unknowns
+        IS isA = nullptr, isD = nullptr;
+        PetscInt nA = 0, nD = 0;
+
+        // Blocks of the jacobian, the product J_DA*J_AA^-1*J_AD and
+        // the reduced matrix S = J_DD - J_DA*J_AA^-1*J_AD
+        Mat Jaa = nullptr, Jad = nullptr, Jda = nullptr, Jdd = nullptr;
+        Mat P = nullptr, S = nullptr;
+        PetscObjectState jacobianState = 0;
+        FVM::Matrix *reduced = nullptr;
+
+        // Inverse of the diagonal of J_AA, and work vectors
+        Vec Dinv = nullptr, Fa = nullptr, w = nullptr, xa = nullptr;
+        Vec Fd = nullptr, xd = nullptr, yd = nullptr;
+
+        void Analyze(Mat);
+        bool Build(Mat);
+        bool IsDiagonal();
+        void DestroyMatrices();
+        void DestroyVectors();
+
+    public:
+        AlgebraicElimination(const PetscInt, const std::vector<struct block>&);
+        ~AlgebraicElimination();
+
+        const std::vector<struct block>& GetEliminated() const { return this->eliminated; }
+        PetscInt GetNumberOfEliminatedRows() const { return this->nA; }
+
+        FVM::Matrix *GetReducedMatrix() { return this->reduced; }
+        Vec *GetReducedRHS() { return &this->Fd; }
+        Vec *GetReducedSolution() { return &this->xd; }
+
+        bool Reduce(FVM::Matrix*, Vec);
+        void Expand(Vec);
+        void Reset();
+    };
+}
+
+#endif/*_DREAM_SOLVER_ALGEBRAIC_ELIMINATION_HPP*/
@@ -0,0 +1,69 @@
+#ifndef _DREAM_SOLVER_BORDERED_SYSTEM_HPP
+#define _DREAM_SOLVER_BORDERED_SYSTEM_HPP
+
+#include "FVM/config.h"
+
+#include <petsc.h>
+#include <vector>
+#include "FVM/Matrix.hpp"
+#include "FVM/FVMException.hpp"
+#include "FVM/MatrixInverter.hpp"
+
+namespace DREAM {
+    class BorderedSystem {
+    public:
+        // Block of rows of the jacobian belonging to one unknown
+        struct block {
+            len_t id;           // ID of unknown quantity
+            PetscInt offset;    // Index of first row in jacobian
+            PetscInt n;         // Number of rows
+        };
+
+    private:
+        PetscInt N;
+        // Unknowns forming the border of the system
+        std::vector<struct block> border;
+
+        // Rows of interior ('I') and border ('B') unknowns
+        IS isI = nullptr, isB = nullptr;
+        PetscInt nI = 0, nB = 0;
+
+        // Blocks of the jacobian
+        Mat Jii = nullptr, Jib = nullptr, Jbi = nullptr, Jbb = nullptr;
+        PetscObjectState jacobianState = 0;
+        FVM::Matrix *interior = nullptr;
+
+        // Columns of J_II^-1*J_IB, and work vectors
+        std::vector<Vec> Z;
+        Vec Fi = nullptr, w = nullptr, xi = nullptr, col = nullptr;
+        Vec Fb = nullptr, yb = nullptr, xb = nullptr;
+
+        // Schur complement J_BB - J_BI*J_II^-1*J_IB (row-major)
+        std::vector<real_t> S, Sfac;
+
+        void Build(Mat);
+        void DestroyMatrices();
+        void DestroyVectors();
+
+    public:
+        BorderedSystem(const PetscInt, const std::vector<struct block>&);
+        ~BorderedSystem();
+
+        const std::vector<struct block>& GetBorder() const { return this->border; }
+        PetscInt GetNumberOfBorderRows() const { return this->nB; }
+
+        bool Solve(FVM::Matrix*, Vec, Vec, FVM::MatrixInverter*);
+        void Reset();
+    };
+
+    class BorderedSystemException : public DREAM::FVM::FVMException {
+    public:
+        template<typename ... Args>
+        BorderedSystemException(const std::string &msg, Args&& ... args)
+            : FVMException(msg, std::forward<Args>(args) ...) {
+            AddModule("BorderedSystem");
+        }
+    };
+}
+
+#endif/*_DREAM_SOLVER_BORDERED_SYSTEM_HPP*/
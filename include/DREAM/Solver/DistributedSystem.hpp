@@ -0,0 +1,62 @@
+#ifndef _DREAM_SOLVER_DISTRIBUTED_SYSTEM_HPP
+#define _DREAM_SOLVER_DISTRIBUTED_SYSTEM_HPP
+
+#include "FVM/config.h"
+
+#include <petsc.h>
+#include <vector>
+#include "DREAM/Settings/OptionConstants.hpp"
+#include "FVM/Matrix.hpp"
+
+namespace DREAM {
+    class DistributedSystem {
+    private:
+        PetscInt N;
+        len_t nr;
+        PetscMPIInt rank, nproc;
+        enum OptionConstants::linear_solver linearSolver;
+
+        // Position of every row of the (sequential) jacobian in the
+        // distributed system, and the row of the jacobian placed at
+        // every position
+        std::vector<PetscInt> position, row;
+        // Positions owned by this process, and the first radius
+        // owned by each process (with 'firstRadius[nproc] = nr')
+        PetscInt rstart = 0, rend = 0;
+        std::vector<len_t> firstRadius;
+        // Non-zero for the rows of the (sequential) jacobian which
+        // are owned by this process (see 'FVM::Matrix::SetRowMask()')
+        std::vector<char> ownedRows;
+
+        // Distributed jacobian, right-hand side and solution, and the
+        // scatter of the solution to all processes
+        Mat Jd = nullptr;
+        Vec Fd = nullptr, xd = nullptr, xall = nullptr;
+        VecScatter gather = nullptr;
+        KSP ksp = nullptr;
+        PetscObjectState jacobianState = 0;
+        PetscInt nIterations = 0;
+
+        void Allocate(Mat);
+        void Destroy();
+        void SetSolver();
+
+    public:
+        DistributedSystem(
+            const PetscInt, const len_t, const std::vector<len_t>&,
+            enum OptionConstants::linear_solver
+        );
+        ~DistributedSystem();
+
+        PetscInt GetNumberOfLocalRows() const { return this->rend-this->rstart; }
+        len_t GetFirstRadius() const { return this->firstRadius[this->rank]; }
+        len_t GetLastRadius() const { return this->firstRadius[this->rank+1]; }
+        PetscInt GetIterationNumber() const { return this->nIterations; }
+        const std::vector<char>& GetOwnedRows() const { return this->ownedRows; }
+
+        bool Solve(FVM::Matrix*, Vec, Vec);
+        void Reset();
+    };
+}
+
+#endif/*_DREAM_SOLVER_DISTRIBUTED_SYSTEM_HPP*/
@@ -0,0 +1,67 @@
+#ifndef _DREAM_SOLVER_LOCALIZED_NEWTON_HPP
+#define _DREAM_SOLVER_LOCALIZED_NEWTON_HPP
+
+#include "FVM/config.h"
+
+#include <petsc.h>
+#include <vector>
+#include "DREAM/ConvergenceChecker.hpp"
+#include "FVM/Matrix.hpp"
+
+namespace DREAM {
+    class LocalizedNewton {
+    private:
+        PetscInt N;
+        len_t nr;
+        // Radius of each row of the jacobian ('nr' for rows of
+        // unknowns which are not resolved radially, which are
+        // always active), and the index of the non-trivial
+        // unknown the row belongs to
+        std::vector<len_t> rowRadius, rowUnknown;
+        std::vector<len_t> nontrivials;
+
+        // Number of neighbouring radii activated on each side of an
+        // unconverged radius, and maximum fraction of active radii
+        // for which the reduced system is solved
+        len_t width;
+        real_t maxFraction;
+
+        // If true, the next Newton step is restricted to the active radii
+        bool local = false;
+        std::vector<bool> activeRadius;
+        len_t nActiveRadii = 0;
+
+        // Rows of the active radii, the corresponding block of the
+        // jacobian, work vectors and the solver for the reduced system
+        IS isActive = nullptr;
+        PetscInt nActive = 0;
+        bool activeChanged = true;
+        Mat Jaa = nullptr;
+        Vec Fa = nullptr, xa = nullptr;
+        KSP ksp = nullptr;
+        PetscObjectState jacobianState = 0;
+
+        // Per-radius norms of the solution and Newton step
+        std::vector<real_t> x2, dx2;
+
+        void DestroySystem();
+        void SetActiveRows();
+
+    public:
+        LocalizedNewton(
+            const PetscInt, const len_t, const std::vector<len_t>&,
+            const std::vector<len_t>&, const std::vector<len_t>&,
+            const len_t width=1, const real_t maxFraction=0.5
+        );
+        ~LocalizedNewton();
+
+        bool IsLocal() const { return this->local; }
+        len_t GetNumberOfActiveRadii() const { return this->nActiveRadii; }
+
+        void Reset();
+        bool Solve(FVM::Matrix*, Vec, Vec);
+        bool Update(const real_t*, const real_t*, ConvergenceChecker*, const bool);
+    };
+}
+
+#endif/*_DREAM_SOLVER_LOCALIZED_NEWTON_HPP*/
@@ -0,0 +1,54 @@
+#ifndef _DREAM_SOLVER_REDUCED_BASIS_HPP
+#define _DREAM_SOLVER_REDUCED_BASIS_HPP
+
+#include "FVM/config.h"
+
+#include <petsc.h>
+#include <string>
+#include <vector>
+#include "FVM/FVMException.hpp"
+#include "FVM/UnknownQuantityHandler.hpp"
+
+namespace DREAM {
+    class ReducedBasis {
+    private:
+        // Number of modes and number of elements of the full solution
+        len_t nModes, N;
+
+        // Mean of the training snapshots (N elements)
+        real_t *mean = nullptr;
+        // Trial basis V = S*U and test basis W = S^-1*U (both
+        // stored mode by mode, nModes-by-N), where the columns of
+        // U are the (orthonormal) POD modes of the scaled snapshots
+        // and S contains the scale of each unknown quantity
+        real_t *trial = nullptr, *test = nullptr;
+
+        // Work vectors
+        Vec petsc_v, petsc_Jv;
+        real_t *Jv = nullptr;
+
+    public:
+        ReducedBasis(const std::string&, FVM::UnknownQuantityHandler*, const std::vector<len_t>&);
+        ~ReducedBasis();
+
+        len_t GetNumberOfModes() const { return this->nModes; }
+
+        void Project(const real_t*, real_t*) const;
+        void Expand(const real_t*, real_t*) const;
+        void ProjectResidual(const real_t*, real_t*) const;
+        void ProjectJacobian(Mat, real_t*);
+
+        static bool SolveDense(const len_t, real_t*, real_t*);
+    };
+
+    class ReducedBasisException : public DREAM::FVM::FVMException {
+    public:
+        template<typename ... Args>
+        ReducedBasisException(const std::string &msg, Args&& ... args)
+            : FVMException(msg, std::forward<Args>(args) ...) {
+            AddModule("ReducedBasis");
+        }
+    };
+}
+
+#endif/*_DREAM_SOLVER_REDUCED_BASIS_HPP*/
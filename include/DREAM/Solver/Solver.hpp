@@ -16,6 +16,8 @@
 #include "FVM/BlockMatrix.hpp"
 #include "FVM/FVMException.hpp"
 #include "FVM/MatrixInverter.hpp"
+#include "FVM/Solvers/MIGMRES.hpp"
+#include "FVM/Solvers/MIMixedPrecision.hpp"
 #include "FVM/TimeKeeper.hpp"
 #include "FVM/UnknownQuantityHandler.hpp"
 
@@ -53,16 +55,110 @@ namespace DREAM {
         FVM::MatrixInverter *mainInverter=nullptr;
         // Robust backup inverter to use if necessary
         FVM::MatrixInverter *backupInverter=nullptr;
+        // If true, direct linear solvers keep the symbolic factorization
+        // of the matrix between iterations and time steps
+        bool reuseSymbolic = false;
+        // Ordering of the unknowns used when direct linear solvers
+        // factorize the matrix, and the corresponding permutation of
+        // the matrix rows (for orderings computed by DREAM)
+        enum OptionConstants::solver_factor_ordering factorOrdering =
+            OptionConstants::SOLVER_FACTOR_ORDERING_DEFAULT;
+        std::vector<PetscInt> factorPermutation;
+        // If true, write matrix elements directly into the
+        // value arrays of the PETSc matrices (see
+        // 'FVM::Matrix::SetDirectAssembly()')
+        bool directAssembly = true;
+        // If true, the residual of each equation is evaluated together
+        // with its block row of the jacobian (see 'BuildJacobian()')
+        bool fusedAssembly = false;
+        // Groups of unknowns to use for the field-split preconditioner
+        // of the GMRES solver (block Jacobi is used if empty)
+        std::vector<FVM::MIGMRES::split> gmresSplits;
+        // Options for the mixed-precision linear solver
+        FVM::MIMixedPrecision::options mixedPrecisionOptions;
+        // If true, convergence telemetry is recorded for every
+        // iteration and saved to the output
+        bool telemetry = false;
+        // Format in which to save matrices for debugging
+        enum OptionConstants::solver_debug_format debugFormat =
+            OptionConstants::SOLVER_DEBUG_FORMAT_PETSC;
+
+        // Factors by which the data of predetermined unknowns
+        // is multiplied (indexed by unknown ID; used for evaluating
+        // sensitivities with respect to prescribed quantities)
+        std::map<len_t, real_t> predeterminedScaleFactors;
+        std::vector<real_t> predeterminedBuffer;
 
         SPIHandler *SPI;
 
+        // Number of threads to use when rebuilding equation terms
+        // and building the jacobian matrix
+        len_t nThreads = 1;
+        // Thread-local element buffers used for parallel jacobian assembly
+        std::vector<std::vector<FVM::Matrix::buffered_element>> jacobianBuffers;
+
+        // Jacobian coupling graph: the (operator, derivative) pairs
+        // which contribute to the block row of each unknown (indexed
+        // by unknown ID). Built during the first jacobian assembly.
+        struct jacobian_coupling {
+            len_t uqtyId;       // ID of unknown the operator is applied to
+            FVM::Operator *op;
+            len_t derivId;      // ID of unknown to differentiate with respect to
+            bool constant;      // Contribution is constant during a time step
+        };
+        std::vector<std::vector<jacobian_coupling>> jacobianCouplings;
+        bool jacobianCouplingsBuilt = false;
+
+        // Boundary conditions which overwrite jacobian elements: the
+        // (block row, operator, derivative) triples for which
+        // 'FVM::Operator::SetJacobianBlockBC()' sets any elements.
+        // Recorded together with the jacobian coupling graph.
+        struct jacobian_bc_coupling {
+            len_t uqnId;        // ID of unknown whose equation the operator is part of
+            len_t uqtyId;       // ID of unknown the operator is applied to
+            FVM::Operator *op;
+            len_t derivId;      // ID of unknown to differentiate with respect to
+        };
+        std::vector<jacobian_bc_coupling> jacobianBCCouplings;
+
+        // Base jacobian: the contributions of the couplings which are
+        // constant during the time step (see 'BuildJacobian()'). The
+        // base is discarded by 'InvalidateJacobianBase()' at the start
+        // of every time step.
+        enum jacobian_selection {
+            JACOBIAN_ALL,           // Build all couplings
+            JACOBIAN_CONSTANT,      // Only build constant couplings
+            JACOBIAN_VARYING        // Only build non-constant couplings
+        };
+        bool hasConstantJacobianCouplings = false;
+        FVM::Matrix::value_snapshot jacobianBase;
+        FVM::BlockMatrix *jacobianBaseMatrix = nullptr;
+        bool jacobianBaseValid = false;
+
         /*FVM::DurationTimer
             timerTot, timerCqh, timerREFluid, timerRebuildTerms;*/
         FVM::TimeKeeper *solver_timeKeeper;
         len_t timerTot, timerCqh, timerREFluid, timerSPIHandler, timerRebuildTerms;
+        // Timers for rebuilding the terms of each non-trivial unknown
+        // (indexed in the same way as 'nontrivial_unknowns')
+        std::vector<len_t> timerRebuildEquation;
 
         virtual void initialize_internal(const len_t, std::vector<len_t>&) {}
 
+        void BuildJacobianBlockRow(const len_t, FVM::BlockMatrix*, enum jacobian_selection sel=JACOBIAN_ALL, real_t *vec=nullptr);
+        void BuildJacobianBlockRow_discover(const len_t, FVM::BlockMatrix*);
+        void BuildJacobianBlockRows(FVM::BlockMatrix*, enum jacobian_selection sel=JACOBIAN_ALL, real_t *vec=nullptr);
+        void BuildJacobianBlockRows_parallel(FVM::BlockMatrix*, enum jacobian_selection sel=JACOBIAN_ALL, real_t *vec=nullptr);
+        void BuildJacobianBC_discover(FVM::BlockMatrix*);
+        void InvalidateJacobianBase() { this->jacobianBaseValid = false; }
+        void RebuildEquation(const len_t, const real_t, const real_t, const bool);
+        void RebuildEquations_parallel(const real_t, const real_t);
+        std::vector<std::vector<len_t>> GroupBySharedObjects(const std::vector<len_t>&);
+
+        void ApplyFactorOrdering(FVM::Matrix*);
+        void SaveDebugMatrix(FVM::Matrix*, const std::string&);
+        void ComputeRadialOrdering(std::vector<PetscInt>&);
+
     public:
         Solver(
             FVM::UnknownQuantityHandler*, std::vector<UnknownQuantityEquation*>*,
@@ -71,15 +167,30 @@ namespace DREAM {
         );
         virtual ~Solver();
 
-        void BuildJacobian(const real_t, const real_t, FVM::BlockMatrix*);
+        void BuildJacobian(const real_t, const real_t, FVM::BlockMatrix*, real_t *vec=nullptr);
         void BuildMatrix(const real_t, const real_t, FVM::BlockMatrix*, real_t*);
         void BuildVector(const real_t, const real_t, real_t*, FVM::BlockMatrix*);
+        void BuildVector_parallel(const real_t, const real_t, real_t*, FVM::BlockMatrix*);
+        void CheckVector(const real_t*, FVM::BlockMatrix*);
         void RebuildTerms(const real_t, const real_t);
 
         void CalculateNonTrivial2Norm(const real_t*, real_t*);
 
         ConvergenceChecker *GetConvergenceChecker() { return convChecker; }
         len_t GetMatrixSize() { return this->matrix_size; }
+        len_t GetNumberOfThreads() const { return this->nThreads; }
+        void SetNumberOfThreads(const len_t n) { this->nThreads = (n > 0 ? n : 1); }
+        void SetReuseSymbolicFactorization(const bool v) { this->reuseSymbolic = v; }
+        void SetFactorOrdering(enum OptionConstants::solver_factor_ordering o) { this->factorOrdering = o; }
+        void SetDirectAssembly(const bool v) { this->directAssembly = v; }
+        bool IsFusedAssemblyEnabled() const { return this->fusedAssembly; }
+        void SetFusedAssembly(const bool v) { this->fusedAssembly = v; }
+        void SetGMRESFieldSplits(const std::vector<FVM::MIGMRES::split>& s) { this->gmresSplits = s; }
+        void SetMixedPrecisionOptions(const FVM::MIMixedPrecision::options& o) { this->mixedPrecisionOptions = o; }
+        bool IsTelemetryEnabled() const { return this->telemetry; }
+        void SetTelemetry(const bool v) { this->telemetry = v; }
+        void SetDebugFormat(enum OptionConstants::solver_debug_format f) { this->debugFormat = f; }
+        void SetPredeterminedScaleFactor(const len_t, const real_t);
 
         //virtual const real_t *GetSolution() const = 0;
         virtual void Initialize(const len_t, std::vector<len_t>&);
@@ -101,6 +212,9 @@ namespace DREAM {
             {this->ionHandler = ih;}
         virtual void SetInitialGuess(const real_t*) = 0;
         virtual void Solve(const real_t t, const real_t dt) = 0;
+        // Number of iterations taken in the most recent call to 'Solve()'
+        virtual len_t GetNumberOfIterations() const { return 1; }
+        virtual void PrintCostEstimate(const real_t, const real_t, const len_t);
 
         void Precondition(FVM::Matrix*, Vec);
         void UnPrecondition(Vec);
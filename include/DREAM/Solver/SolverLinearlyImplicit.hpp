@@ -25,6 +25,13 @@ namespace DREAM {
         real_t t, dt;
         len_t nTimeStep=0;
 
+        // If true, the factorization of the matrix is reused in time
+        // steps where the (preconditioned) matrix is identical to the
+        // one most recently factorized
+        bool reuseFactorization = true;
+        FVM::Matrix::value_snapshot factorizedMatrix;
+        len_t nFactorizationsReused=0;
+
         FVM::TimeKeeper *timeKeeper;
         len_t timerTot, timerRebuild, timerMatrix, timerInvert;
 
@@ -55,6 +62,7 @@ namespace DREAM {
 
         void SaveDebugInfo(len_t, FVM::Matrix*, const real_t*);
         void SetDebugMode(bool, bool, bool, int_t, bool);
+        void SetReuseFactorization(const bool v) { this->reuseFactorization = v; }
 
         virtual void WriteDataSFile(SFile*, const std::string&) override;
     };
@@ -7,7 +7,14 @@
 #include <vector>
 #include "DREAM/ConvergenceChecker.hpp"
 #include "DREAM/EquationSystem.hpp"
+#include "DREAM/Solver/AdjointSolver.hpp"
+#include "DREAM/Solver/AlgebraicElimination.hpp"
+#include "DREAM/Solver/BorderedSystem.hpp"
+#include "DREAM/Solver/DistributedSystem.hpp"
+#include "DREAM/Solver/LocalizedNewton.hpp"
+#include "DREAM/Solver/ReducedBasis.hpp"
 #include "DREAM/Solver/Solver.hpp"
+#include "DREAM/Solver/WarmStart.hpp"
 #include "DREAM/UnknownQuantityEquation.hpp"
 #include "FVM/BlockMatrix.hpp"
 #include "FVM/TimeKeeper.hpp"
@@ -27,25 +34,174 @@ namespace DREAM {
 		len_t iteration=0, nTimeStep=0;
 		real_t t, dt;
 		real_t *x0, *x1, *dx, *xinit;
+		// If true, 'petsc_dx' stores its elements in 'dx'
+		bool dxShared = false;
 		real_t *x_2norm, *dx_2norm;
 
+        // Jacobian update strategy
+        enum OptionConstants::solver_jacobian_update jacobianUpdate =
+            OptionConstants::SOLVER_JACOBIAN_UPDATE_ALWAYS;
+        // Maximum allowed ratio |dx_k| / |dx_{k-1}| when reusing the jacobian
+        real_t maxContraction = 0.5;
+        // Tolerance and maximum number of iterations for Newton-Krylov solves
+        real_t krylovRelTol = 1e-4;
+        len_t krylovMaxIter = 50;
+        KSP nkKSP;
+        bool nkKSPAllocated = false;
+        // Matrix-free jacobian operator (JFNK mode), and the point
+        // (and residual at that point) around which it is evaluated
+        Mat jfnkMat;
+        real_t *jfnkX=nullptr, *jfnkF0=nullptr, *jfnkXh=nullptr, *jfnkFh=nullptr;
+
+        // Line search
+        enum OptionConstants::solver_line_search lineSearch =
+            OptionConstants::SOLVER_LINE_SEARCH_NONE;
+        len_t lineSearchMaxSteps = 8;
+        // (Rescaled) residual norm in the current point and work
+        // vector for residuals in trial points
+        real_t residualNorm = 0;
+        Vec petsc_Ftrial;
+
+        // Extrapolation of the initial guess of each time step from
+        // the solutions in the most recent time steps
+        enum OptionConstants::solver_predictor predictor =
+            OptionConstants::SOLVER_PREDICTOR_NONE;
+
+        // Pseudo-transient continuation: the diagonal of the jacobian
+        // is augmented by |J_ii|/ptcTau, where the (relative) pseudo
+        // time step ptcTau grows as the residual decreases
+        bool ptcEnabled = false;
+        real_t ptcTau0 = 1, ptcTauMax = 1e6;
+        real_t ptcTau = 1, ptcResidualPrev = 0;
+
+        // Inexact Newton: the relative tolerance of iterative linear
+        // solves follows the Eisenstat-Walker forcing term 'ewEta',
+        // which is determined by the reduction of the residual norm
+        // in the most recent Newton iteration
+        bool ewEnabled = false;
+        real_t ewEtaMin = 1e-5, ewEtaMax = 0.9;
+        real_t ewEta = 0, ewResidualPrev = 0;
+
+        // Inverter holding the most recently factorized jacobian
+        // (or 'nullptr' if no valid factorization exists)
+        FVM::MatrixInverter *factorizedInverter = nullptr;
+        real_t factorizedDt = 0;
+        bool forceJacobianUpdate = true;
+        real_t dxNormPrev = 0;
+        len_t nFactorizationsStep = 0;
+
+        // Reference run to warm-start from (see 'WarmStart'), and whether
+        // the jacobian was preallocated with the reference non-zero pattern
+        std::string warmStartFile;
+        WarmStart *warmStart = nullptr;
+        bool jacobianPreallocated = false;
+        // If true, saves the non-zero pattern of the jacobian to the output
+        bool saveJacobianPattern = false;
+
+        // Adjoint sensitivities of an objective (see 'AdjointSolver')
+        AdjointSolver::options adjointOptions;
+        AdjointSolver *adjoint = nullptr;
+
+        // Reduced-order model (see 'ReducedBasis'), with the maximum
+        // allowed ratio between the residual of the reduced solution
+        // and of the initial guess before the step is retaken with
+        // the full model
+        std::string reducedBasisFile;
+        real_t reducedTolerance = 1e-2;
+        ReducedBasis *reducedBasis = nullptr;
+        std::vector<bool> usedReducedModel;
+
+        // Elimination of algebraic unknowns from the linear
+        // systems of the Newton iteration
+        bool eliminateAlgebraic = false;
+        AlgebraicElimination *elimination = nullptr;
+
+        // Solution of the linear systems of the Newton iteration
+        // as bordered systems, with the scalar unknowns as border
+        bool borderScalars = false;
+        BorderedSystem *bordered = nullptr;
+
+        // Newton iterations restricted to the radii which have not yet
+        // converged (see 'LocalizedNewton'), and the number of such
+        // iterations in each time step
+        bool localizedNewton = false;
+        len_t localizedWidth = 1;
+        real_t localizedMaxFraction = 0.5;
+        LocalizedNewton *localized = nullptr;
+        len_t nLocalizedStep = 0;
+        std::vector<len_t> nLocalizedIterations;
+
+        // Solution of the linear systems of the Newton iteration with
+        // the radial grid distributed over all MPI processes
+        bool distributedSystem = false;
+        DistributedSystem *distributed = nullptr;
+        // Set once the full jacobian has been assembled after it was
+        // (re)allocated, so that its non-zero structure is complete and
+        // each process may only assemble its own rows; and set when the
+        // current iteration must assemble (and solve) the full jacobian
+        // sequentially, after the distributed solve has failed
+        bool jacobianStructureComplete = false;
+        bool fullJacobianRequired = false;
+
         FVM::TimeKeeper *timeKeeper;
         len_t timerTot, timerRebuild, timerResidual, timerJacobian, timerInvert;
 
         // Debug settings
         bool printjacobianinfo = false, savejacobian = false, savesolution = false,
-            savevector = false, savenumjac = false, savesystem = false, debugrescaled = false;
+            savevector = false, savenumjac = false, savesystem = false, debugrescaled = false,
+            printsparsity = false, numjaccoloring = false;
         len_t savetimestep = 0, saveiteration = 1;
 
         std::vector<len_t> nIterations;
+        std::vector<len_t> nFactorizations;
         std::vector<bool> usedBackupInverter;
 
+        // Choice of matrix inverter based on its failure history: after
+        // the main inverter fails, subsequent time steps start with the
+        // backup inverter for 'backupHold' steps, with the hold doubled
+        // every time the main inverter fails again (up to 'maxBackupHold'
+        // steps; 0 = always start with the main inverter)
+        len_t maxBackupHold = 0, backupHoldLength = 0, backupHold = 0;
+        bool startedOnMain = true, mainInverterFailed = false;
+        len_t nMainInverterFailures = 0, nMainInverterSkipped = 0;
+
+        void SelectInverter();
+        void UpdateInverterHistory();
+
+        // Convergence telemetry (see 'RecordTelemetry()'), stored
+        // for every Newton iteration...
+        real_t telDamping = 1;
+        len_t telKSPIterations = 0;
+        std::vector<len_t> telStep, telIteration, telKSP;
+        std::vector<real_t> telDampingFactors, telResidual, telSolution;
+        // ...and for every time step
+        real_t telFillStep = 0;
+        std::vector<real_t> telFill;
+
 	protected:
 		virtual void initialize_internal(const len_t, std::vector<len_t>&) override;
 
         void _EvaluateF(const real_t*, real_t*, FVM::BlockMatrix*);
         void _EvaluateJacobianNumerically(FVM::BlockMatrix*);
         void _InternalSolve();
+        bool SolveReduced();
+        bool Predict(const real_t, real_t*);
+
+        bool IsJacobianUpdateNeeded();
+        void InvertJacobian(bool);
+        bool SolveNewtonKrylov();
+        bool SolveJacobianFreeNewtonKrylov();
+
+        real_t BacktrackingLineSearch(const real_t*, const real_t);
+        real_t EvaluateResidualNorm(const real_t*);
+
+        void RecordTelemetry();
+        void WriteTelemetry(SFile*, const std::string&);
+
+        void UpdateForcingTerm();
+        void UpdatePseudoTimeStep();
+        void AddPseudoTransientShift();
+        bool IsPseudoTransientActive() const { return (this->ptcEnabled && this->ptcTau < this->ptcTauMax); }
 
 	public:
 		SolverNonLinear(
@@ -68,14 +224,29 @@ namespace DREAM {
 
 		// GETTERS
 		len_t GetIteration() const { return this->iteration; }
+        virtual len_t GetNumberOfIterations() const override { return this->iteration; }
 		len_t MaxIter() const { return this->maxiter; }
 		real_t RelTol() const { return this->reltol; }
 		bool Verbose() const  { return this->verbose; }
 
 		// Setters
 		void SetIteration(const len_t i) { this->iteration = i; }
+        void SetJacobianUpdate(
+            enum OptionConstants::solver_jacobian_update,
+            const real_t maxContraction=0.5, const real_t krylovRelTol=1e-4,
+            const len_t krylovMaxIter=50
+        );
+
+        void SetLineSearch(enum OptionConstants::solver_line_search, const len_t maxSteps=8);
+        void SetPredictor(enum OptionConstants::solver_predictor p) { this->predictor = p; }
+        void SetPseudoTransient(const bool, const real_t tau0=1, const real_t tauMax=1e6);
+        void SetEisenstatWalker(const bool, const real_t etaMin=1e-5, const real_t etaMax=0.9);
+
+        void ApplyFactorizedJacobian(Vec, Vec);
+        void ApplyJacobianFree(Vec, Vec);
 
 		bool IsConverged(const real_t*, const real_t*);
+        real_t EvaluateResidualNorm(const real_t, const real_t, const real_t*);
 
 		virtual void SetInitialGuess(const real_t*) override;
 		virtual void Solve(const real_t, const real_t) override;
@@ -91,12 +262,34 @@ namespace DREAM {
 		const real_t *TakeNewtonStep();
 		const real_t *UpdateSolution(const real_t*);
 
+        virtual void PrintCostEstimate(const real_t, const real_t, const len_t) override;
         virtual void PrintTimings() override;
         virtual void SaveTimings(SFile*, const std::string& path="") override;
 
         void SaveDebugInfoBefore(len_t, len_t);
         void SaveDebugInfoAfter(len_t, len_t);
         void SetDebugMode(bool, bool, bool, bool, bool, int_t, int_t, bool, bool);
+        void SetPrintSparsity(bool v) { this->printsparsity = v; }
+        void SetNumericalJacobianColoring(bool v) { this->numjaccoloring = v; }
+        void SetWarmStart(const std::string& filename) { this->warmStartFile = filename; }
+        void SetSaveJacobianPattern(bool v) { this->saveJacobianPattern = v; }
+        void SetAdjointOptions(const AdjointSolver::options& o) { this->adjointOptions = o; }
+        AdjointSolver *GetAdjointSolver() { return this->adjoint; }
+        void SetAlgebraicElimination(const bool v) { this->eliminateAlgebraic = v; }
+        void SetBorderedSystem(const bool v) { this->borderScalars = v; }
+        void SetLocalizedNewton(const bool v, const len_t width=1, const real_t maxFraction=0.5) {
+            this->localizedNewton = v;
+            this->localizedWidth = width;
+            this->localizedMaxFraction = maxFraction;
+        }
+        void SetDistributedSystem(const bool v) { this->distributedSystem = v; }
+        void SetBackupHold(const len_t n) { this->maxBackupHold = n; }
+        void SetReducedModel(const std::string& filename, const real_t tolerance=1e-2) {
+            this->reducedBasisFile = filename;
+            this->reducedTolerance = tolerance;
+        }
+
+        void PrintJacobianSparsity();
 
         virtual void SwitchToBackupInverter() override;
 
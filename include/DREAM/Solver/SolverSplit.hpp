@@ -0,0 +1,99 @@
+#ifndef _DREAM_SOLVER_SPLIT_HPP
+#define _DREAM_SOLVER_SPLIT_HPP
+
+#include "FVM/config.h"
+
+#include <vector>
+#include "DREAM/Settings/OptionConstants.hpp"
+#include "DREAM/Solver/Solver.hpp"
+#include "DREAM/Solver/SolverNonLinear.hpp"
+#include "DREAM/UnknownQuantityEquation.hpp"
+#include "FVM/TimeKeeper.hpp"
+#include "FVM/UnknownQuantityHandler.hpp"
+
+namespace DREAM {
+	class SolverSplit : public Solver {
+	private:
+        // Solvers for the kinetic unknowns (with the fluid unknowns
+        // frozen), for the fluid unknowns (with the kinetic unknowns
+        // frozen) and for the fully coupled system (used as fallback)
+        SolverNonLinear *kineticSolver, *fluidSolver, *coupledSolver;
+        std::vector<len_t> kineticUnknowns, fluidUnknowns;
+
+        enum OptionConstants::solver_splitting scheme;
+        // Maximum allowed ratio between the residual of the coupled
+        // system in the split solution and in the initial guess
+        real_t tolerance;
+        // Number of substeps taken by the fluid subsystem
+        // in every kinetic step
+        len_t fluidSubsteps;
+
+        // Initial guess for the time step, and solution of the
+        // split step (in the ordering of the coupled system)
+        real_t *xguess=nullptr, *xsplit=nullptr;
+        // Previous values of the kinetic unknowns (temporarily
+        // replaced during the second kinetic Strang half-step) and
+        // of the fluid unknowns (replaced during fluid substeps)
+        real_t *kineticPrevious=nullptr, *fluidPrevious=nullptr;
+        bool kineticPreviousReplaced = false, fluidPreviousReplaced = false;
+
+        bool lastUsedFallback = false;
+        len_t lastIterations = 0;
+
+        std::vector<len_t> nIterations;
+        std::vector<bool> usedFallback;
+        std::vector<real_t> splittingError;
+
+        FVM::TimeKeeper *timeKeeper;
+        len_t timerTot, timerKinetic, timerFluid, timerError, timerCoupled;
+
+        void SolveSubsystem(SolverNonLinear*, std::vector<len_t>&, const real_t, const real_t);
+        void SolveLie(const real_t, const real_t);
+        void SolveStrang(const real_t, const real_t);
+        void SolveFluid(const real_t, const real_t);
+        void AdvancePrevious(const std::vector<len_t>&, real_t*, bool&);
+        void RestorePrevious(const std::vector<len_t>&, const real_t*, bool&);
+
+	protected:
+		virtual void initialize_internal(const len_t, std::vector<len_t>&) override;
+
+	public:
+		SolverSplit(
+			FVM::UnknownQuantityHandler*, std::vector<UnknownQuantityEquation*>*,
+            SolverNonLinear*, SolverNonLinear*, SolverNonLinear*,
+            std::vector<len_t>&, std::vector<len_t>&,
+            enum OptionConstants::solver_splitting, const real_t tolerance=1e-3,
+            const len_t fluidSubsteps=1
+		);
+		virtual ~SolverSplit();
+
+        static void PartitionUnknowns(
+            FVM::UnknownQuantityHandler*, const std::vector<len_t>&,
+            std::vector<len_t>&, std::vector<len_t>&
+        );
+
+        SolverNonLinear *GetKineticSolver() { return this->kineticSolver; }
+        SolverNonLinear *GetFluidSolver() { return this->fluidSolver; }
+        SolverNonLinear *GetCoupledSolver() { return this->coupledSolver; }
+        std::vector<len_t>& GetKineticUnknowns() { return this->kineticUnknowns; }
+        std::vector<len_t>& GetFluidUnknowns() { return this->fluidUnknowns; }
+
+        virtual void SetCollisionHandlers(
+            CollisionQuantityHandler*, CollisionQuantityHandler*, RunawayFluid*
+        ) override;
+        virtual void SetSPIHandler(SPIHandler*) override;
+        virtual void SetIonHandler(IonHandler*) override;
+
+        virtual len_t GetNumberOfIterations() const override { return this->lastIterations; }
+
+		virtual void SetInitialGuess(const real_t*) override;
+		virtual void Solve(const real_t, const real_t) override;
+
+        virtual void PrintTimings() override;
+        virtual void SaveTimings(SFile*, const std::string& path="") override;
+
+        virtual void WriteDataSFile(SFile*, const std::string&) override;
+	};
+}
+
+#endif/*_DREAM_SOLVER_SPLIT_HPP*/
@@ -0,0 +1,47 @@
+#ifndef _DREAM_SOLVER_WARM_START_HPP
+#define _DREAM_SOLVER_WARM_START_HPP
+
+#include "FVM/config.h"
+
+#include <petsc.h>
+#include <string>
+#include <vector>
+#include "FVM/FVMException.hpp"
+#include "FVM/UnknownQuantityHandler.hpp"
+
+namespace DREAM {
+    class WarmStart {
+    private:
+        FVM::UnknownQuantityHandler *unknowns;
+        std::vector<len_t> nontrivials;
+
+        // Time points of the reference solution
+        std::vector<real_t> times;
+        // Reference solution of each non-trivial unknown (as an
+        // nt-by-N array), or 'nullptr' if not available in the output
+        std::vector<real_t*> data;
+
+        // Number of non-zeros in each row of the jacobian
+        // of the reference run (if available)
+        PetscInt *jacobianPattern = nullptr;
+        len_t jacobianPatternSize = 0;
+
+    public:
+        WarmStart(const std::string&, FVM::UnknownQuantityHandler*, const std::vector<len_t>&);
+        ~WarmStart();
+
+        bool GetGuess(const real_t, real_t*);
+        const PetscInt *GetJacobianPattern(const len_t) const;
+    };
+
+    class WarmStartException : public DREAM::FVM::FVMException {
+    public:
+        template<typename ... Args>
+        WarmStartException(const std::string &msg, Args&& ... args)
+            : FVMException(msg, std::forward<Args>(args) ...) {
+            AddModule("WarmStart");
+        }
+    };
+}
+
+#endif/*_DREAM_SOLVER_WARM_START_HPP*/
@@ -1,6 +1,10 @@
 #ifndef _DREAM_TIME_STEPPER_HPP
 #define _DREAM_TIME_STEPPER_HPP
 
+#include <string>
+#include <vector>
+#include <softlib/SFile.h>
+#include "DREAM/Checkpoint.hpp"
 #include "DREAM/Solver/Solver.hpp"
 #include "FVM/FVMException.hpp"
 #include "FVM/UnknownQuantityHandler.hpp"
@@ -13,22 +17,53 @@ namespace DREAM {
         // Pointer to Solver object used for inverting equation system
         Solver *solver;
 
+        // Number of attempts rejected due to a too large error, or
+        // due to the solver failing, before each accepted time step
+        // (only recorded by adaptive time steppers)
+        len_t nRejectedStep = 0, nExceptionsStep = 0;
+        std::vector<len_t> nRejected, nExceptions;
+
+        // Times (in increasing order) which time steps should land
+        // exactly on, such as discontinuities in prescribed data
+        std::vector<real_t> eventTimes;
+
+        real_t LimitStepToEvents(const real_t, const real_t) const;
+        void RecordAcceptedStep();
+
     public:
         TimeStepper(FVM::UnknownQuantityHandler *u)
             : unknowns(u) {}
         virtual ~TimeStepper() {}
 
         virtual bool CheckNegative(const std::string&);
+        // Number of old time steps which must be kept in memory
+        // by all unknowns for rolling back rejected steps
+        virtual len_t GetHistoryDepth() const { return 4; }
+        // Number of time steps which will be saved to the output
+        // (or 0 if not known in advance)
+        virtual len_t GetNumberOfSaveSteps() const { return 0; }
+        // Total number of time steps to take (or 0 if not known)
+        virtual len_t GetNumberOfSteps() const { return 0; }
         virtual void HandleException(FVM::FVMException&);
 
         virtual real_t CurrentTime() const = 0;
+        virtual real_t GetMaxTime() const = 0;
         virtual bool IsFinished() = 0;
         virtual bool IsSaveStep() = 0;
         virtual real_t NextTime() = 0;
         virtual void PrintProgress() = 0;
         virtual void ValidateStep() = 0;
 
+        // Save/restore the state of the time stepper (must only
+        // be called after a step which was saved to the output)
+        virtual void SaveCheckpoint(Checkpoint&) const;
+        virtual void LoadCheckpoint(const Checkpoint&);
+
+        const std::vector<real_t>& GetEventTimes() const { return this->eventTimes; }
+        virtual void SetEventTimes(const std::vector<real_t>&);
         void SetSolver(Solver *s) { this->solver = s; }
+
+        void WriteTelemetry(SFile*, const std::string&);
     };
 
     class TimeStepperException : public DREAM::FVM::FVMException {
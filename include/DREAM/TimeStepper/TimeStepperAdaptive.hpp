@@ -96,12 +96,19 @@ namespace DREAM {
         ~TimeStepperAdaptive();
 
         virtual real_t CurrentTime() const override;
+        virtual real_t GetMaxTime() const override { return this->tMax; }
+        // (the two half steps, and the pushed copy of
+        // the initial state, are rolled back)
+        virtual len_t GetHistoryDepth() const override { return 3; }
         virtual void HandleException(FVM::FVMException&) override;
         virtual bool IsFinished() override;
         virtual bool IsSaveStep() override;
         virtual real_t NextTime() override;
         virtual void ValidateStep() override;
 
+        virtual void SaveCheckpoint(Checkpoint&) const override;
+        virtual void LoadCheckpoint(const Checkpoint&) override;
+
         virtual void PrintProgress() override;
     };
 }
@@ -2,6 +2,7 @@
 #define _DREAM_TIME_STEPPER_CONSTANT_HPP
 
 #include <iostream>
+#include <vector>
 #include "DREAM/TimeStepper/TimeStepper.hpp"
 #include "FVM/FVMException.hpp"
 #include "FVM/UnknownQuantityHandler.hpp"
@@ -15,6 +16,12 @@ namespace DREAM {
         real_t tMax;
         len_t Nt;
 
+        // End times of all time steps, if event times have been
+        // inserted between the (otherwise uniformly spaced) steps
+        std::vector<real_t> times;
+
+        real_t TimeAt(const len_t) const;
+
         // Number of time steps to save to output...
         len_t nSaveSteps = 0, nextSaveStep_l = 0;
         real_t dSaveStep = 0, nextSaveStep = 0;
@@ -26,11 +33,23 @@ namespace DREAM {
         void InitSaveSteps();
 
         virtual real_t CurrentTime() const override;
+        virtual real_t GetMaxTime() const override { return this->tMax; }
+        // (steps are never rolled back)
+        virtual len_t GetHistoryDepth() const override { return 1; }
+        virtual len_t GetNumberOfSaveSteps() const override
+        { return (this->nSaveSteps == 0 ? this->Nt : this->nSaveSteps); }
+        virtual len_t GetNumberOfSteps() const override { return this->Nt; }
+        real_t GetTimeStep() const { return this->dt; }
         virtual bool IsFinished() override;
         virtual bool IsSaveStep() override;
         virtual real_t NextTime() override;
         virtual void PrintProgress() override;
+        virtual void SetEventTimes(const std::vector<real_t>&) override;
+        void SetWindow(const real_t, const real_t, const len_t, const len_t nSaveSteps=0);
         virtual void ValidateStep() override;
+
+        virtual void SaveCheckpoint(Checkpoint&) const override;
+        virtual void LoadCheckpoint(const Checkpoint&) override;
     };
 }
 
@@ -0,0 +1,91 @@
+#ifndef _DREAM_TIME_STEPPER_EMBEDDED_HPP
+#define _DREAM_TIME_STEPPER_EMBEDDED_HPP
+
+#include <vector>
+#include "DREAM/ConvergenceChecker.hpp"
+#include "DREAM/TimeStepper/TimeStepper.hpp"
+
+namespace DREAM {
+    class TimeStepperEmbedded : public TimeStepper {
+    private:
+        real_t tMax, dt, dtMax;
+        // Length of the most recently accepted time step
+        real_t dtOld=0;
+        real_t currentTime=0, nextTime=0;
+        len_t currentStep = 1;
+
+        // List of non-trivial unknowns
+        std::vector<len_t> nontrivials;
+        // Object used to evaluate norms of solution vectors
+        ConvergenceChecker *convChecker;
+        // Number of time steps taken which have resulted in an exception (in a row)
+        len_t stepsWithException = 0;
+
+        // Maximum number of times the solver may throw an exception
+        // without us rethrowing it
+        const len_t MAX_STEPS_WITH_EXCEPTION=5;
+        // Factor by which the time step is reduced when an exception
+        // is caught.
+        const real_t STEP_REDUCTION_AT_EXCEPTION=0.2;
+        // Safety factor, and limits on the factor by which the time
+        // step may change between two consecutive steps
+        const real_t SAFETY_FACTOR=0.9;
+        const real_t MIN_STEP_FACTOR=0.2, MAX_STEP_FACTOR=5.0;
+
+        // Set to true if the most recently taken time step was
+        // accepted
+        bool stepSucceeded = false;
+        // If true, the previous step was rejected and the initial
+        // solution must be restored before taking the next step
+        bool restoreSolution = false;
+
+        // If true, generates excessive output to stdout
+        bool verbose = false;
+
+        // Total length of progress bar (including percentage)
+        const len_t PROGRESSBAR_LENGTH = 80;
+
+        len_t sol_size=0;
+        // Solutions at the two most recently accepted time steps
+        real_t *sol_prev=nullptr, *sol_curr=nullptr;
+        // Most recently obtained solution
+        real_t *sol_new=nullptr;
+        // Estimate of the local truncation error in 'sol_new'
+        real_t *sol_err=nullptr;
+        // Number of accepted solutions stored in 'sol_prev' and 'sol_curr'
+        len_t nHistory=0;
+
+        // PRIVATE METHODS
+        void AllocateSolutions(const len_t);
+        void CopySolution(real_t*);
+        void DeallocateSolutions();
+        void RestoreInitialSolution(const len_t);
+        bool UpdateStep();
+
+    public:
+        TimeStepperEmbedded(
+            const real_t tMax, const real_t dt0, const real_t dtMax,
+            FVM::UnknownQuantityHandler*, std::vector<len_t>&,
+            ConvergenceChecker*, bool verbose=false
+        );
+        ~TimeStepperEmbedded();
+
+        virtual real_t CurrentTime() const override;
+        virtual real_t GetMaxTime() const override { return this->tMax; }
+        // (a rejected step, and the pushed copy of
+        // the initial state, are rolled back)
+        virtual len_t GetHistoryDepth() const override { return 2; }
+        virtual void HandleException(FVM::FVMException&) override;
+        virtual bool IsFinished() override;
+        virtual bool IsSaveStep() override;
+        virtual real_t NextTime() override;
+        virtual void ValidateStep() override;
+
+        virtual void SaveCheckpoint(Checkpoint&) const override;
+        virtual void LoadCheckpoint(const Checkpoint&) override;
+
+        virtual void PrintProgress() override;
+    };
+}
+
+#endif/*_DREAM_TIME_STEPPER_EMBEDDED_HPP*/
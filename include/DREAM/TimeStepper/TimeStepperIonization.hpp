@@ -1,7 +1,9 @@
 #ifndef _DREAM_TIME_STEPPER_IONIZATION_HPP
 #define _DREAM_TIME_STEPPER_IONIZATION_HPP
 
+#include <string>
 #include <vector>
+#include "DREAM/Settings/OptionConstants.hpp"
 #include "DREAM/TimeStepper/TimeStepper.hpp"
 #include "FVM/UnknownQuantityHandler.hpp"
 
@@ -19,8 +21,29 @@ namespace DREAM {
 		len_t id_n_cold;
 		len_t currentStep = 0;
 
-		len_t nr;
-		real_t *timescales, *ncold;
+		// Unknowns whose time scales limit the time step (the
+		// first of which is always the cold electron density),
+		// their values at the start of the most recent step, and
+		// the (smoothed) relative rates of change of each element
+		std::vector<len_t> ids;
+		std::vector<std::vector<real_t>> previous, rates;
+		// Weight of the previous rate when smoothing the rates
+		// (0 = no smoothing)
+		real_t smoothing = 0;
+
+		enum OptionConstants::timestepper_ionization_controller controller =
+			OptionConstants::TIMESTEPPER_IONIZATION_CONTROLLER_SCALE;
+		// Ratio of the previous time step to the time step
+		// allowed by the time scale (used by the PI controller)
+		real_t oldRatio = 0;
+
+		// Largest and smallest factor by which the PI controller
+		// may change the time step, and its gains
+		const real_t PI_FAC_MAX = 2, PI_FAC_MIN = 0.2;
+		const real_t PI_KI = 0.3, PI_KP = 0.4;
+		// Values of an unknown smaller than this fraction of its
+		// largest magnitude are not resolved by the time scale
+		const real_t TIMESCALE_FLOOR = 1e-3;
 		
 		const len_t PROGRESSBAR_LENGTH = 80;
 	public:
@@ -32,13 +55,23 @@ namespace DREAM {
 		~TimeStepperIonization();
 
 		virtual real_t CurrentTime() const { return this->currentTime; }
+		virtual real_t GetMaxTime() const { return this->tMax; }
+		// (steps are never rolled back)
+		virtual len_t GetHistoryDepth() const override { return 1; }
 		virtual bool IsFinished() override { return (this->currentTime >= this->tMax); }
 		virtual bool IsSaveStep() override { return true; }
 		virtual real_t NextTime() override;
 		virtual void ValidateStep() override;
 
+		virtual void SaveCheckpoint(Checkpoint&) const override;
+		virtual void LoadCheckpoint(const Checkpoint&) override;
+
 		real_t GetIonizationTimeScale();
 
+		void AddTimeScaleUnknown(const std::string&);
+		void SetController(enum OptionConstants::timestepper_ionization_controller c) { this->controller = c; }
+		void SetSmoothing(const real_t s) { this->smoothing = s; }
+
 		virtual void PrintProgress() override;
 	};
 }
@@ -3,6 +3,7 @@
 
 #include <map>
 #include <string>
+#include <vector>
 #include "FVM/BlockMatrix.hpp"
 #include "FVM/Equation/Operator.hpp"
 #include "FVM/Equation/PredeterminedParameter.hpp"
@@ -43,6 +44,8 @@ namespace DREAM {
         bool IsEvaluable();
         FVM::PredeterminedParameter *GetPredetermined();
         bool IsPredetermined();
+        bool IsThreadSafe() const;
+        void GetSharedObjects(std::vector<const void*>&) const;
         void RebuildEquations(const real_t, const real_t, FVM::UnknownQuantityHandler*);
 
         void SetDescription(const std::string& desc) { this->description = desc; }
@@ -55,6 +58,7 @@ namespace DREAM {
         void SetVectorElements(
             real_t*, FVM::UnknownQuantityHandler*
         );
+        std::string FindNonFiniteTerm(const len_t, FVM::UnknownQuantityHandler*);
     };
 }
 
@@ -11,6 +11,16 @@ namespace DREAM::FVM { class BlockMatrix; }
 
 namespace DREAM::FVM {
     class BlockMatrix : public Matrix {
+        public:
+            // Sparsity statistics for one block row of the matrix
+            struct block_sparsity {
+                len_t n;                     // Number of rows in block row
+                len_t nnzEstimated;          // Number of non-zeros preallocated in block row
+                len_t nnzUsed;               // Number of non-zeros stored in block row
+                len_t rowsExceeded;          // Number of rows with more non-zeros than preallocated
+                std::vector<len_t> nnzBlock; // Number of non-zeros stored in each block of the row
+            };
+
         private:
             struct _subeq {
                 PetscInt id;    // Externally set ID which can be used to identify the block
@@ -28,7 +38,8 @@ namespace DREAM::FVM {
             virtual ~BlockMatrix();
 
             // Block API
-            void ConstructSystem();
+            void ConstructSystem(const PetscInt *nnzRow=nullptr);
+            BlockMatrix *CreateBufferedView(std::vector<struct buffered_element>*);
             len_t CreateSubEquation(const PetscInt, const PetscInt, const PetscInt id=-1);
             PetscInt GetOffset(const PetscInt);
             PetscInt GetOffsetById(const PetscInt);
@@ -36,6 +47,10 @@ namespace DREAM::FVM {
             void RestoreSubEquation(Matrix*, const PetscInt, const PetscInt);
 
             len_t GetNNZInBlock(const len_t i) const { return subeqs.at(i).nnz; }
+            len_t GetNSubEquations() const { return subeqs.size(); }
+            PetscInt GetSubEquationId(const len_t i) const { return subeqs.at(i).id; }
+            std::vector<struct block_sparsity> GetSparsity();
+            void GetNonZeroPattern(PetscInt*);
 
             virtual void IMinusDtA(const PetscScalar) override;
 
@@ -0,0 +1,211 @@
+#ifndef _DREAM_FVM_DEVICE_HPP
+#define _DREAM_FVM_DEVICE_HPP
+/**
+ * Helpers for the parts of DREAM which may execute on a GPU.
+ *
+ * When DREAM is compiled with Kokkos ('DREAM_WITH_KOKKOS'), kernels
+ * given to 'Device::For()' are executed in the default Kokkos execution
+ * space (i.e. on the GPU when Kokkos has been built with CUDA or HIP).
+ * Otherwise, they are executed as ordinary loops on the calling thread.
+ * The helpers in this file are:
+ *
+ *   Device::For()        Loop over a range of indices. The body must be
+ *                        given as a 'DREAM_DEVICE_LAMBDA', and may only
+ *                        access memory allocated with the routines below
+ *                        (captured by value).
+ *   Device::Any()        Returns 'true' if a predicate (given as for
+ *                        'Device::For()') holds for any index in a range.
+ *   Device::Allocate()   Allocate memory which is accessible from both
+ *                        the host and the device (Kokkos 'SharedSpace'),
+ *                        for data which is computed on the host and then
+ *                        used in a kernel.
+ *   Device::AllocateDevice()
+ *                        Allocate memory which is only accessible from
+ *                        the device, for data which is only accessed in
+ *                        kernels (and handed to PETSc).
+ *
+ * Calls to 'Device::For()' are synchronous: the kernel has finished when
+ * the call returns, so that shared memory may then be accessed on the
+ * host again.
+ *
+ * Kokkos must be initialized before and finalized after PETSc (so that
+ * PETSc uses the same Kokkos instance). This is done by
+ * 'dream_initialize()' and 'dream_finalize()'.
+ */
+
+#include <cstring>
+#include "FVM/config.h"
+
+#ifdef DREAM_WITH_KOKKOS
+#   include <Kokkos_Core.hpp>
+#   define DREAM_DEVICE_LAMBDA KOKKOS_LAMBDA
+#else
+#   define DREAM_DEVICE_LAMBDA [=]
+#endif
+
+namespace DREAM::FVM::Device {
+    void Initialize(int *argc=nullptr, char **argv[]=nullptr);
+    void Finalize();
+
+    /**
+     * Returns 'true' if kernels are executed on a device
+     * (i.e. if DREAM was compiled with Kokkos, and Kokkos
+     * has been initialized).
+     */
+    inline bool IsEnabled() {
+#ifdef DREAM_WITH_KOKKOS
+        return Kokkos::is_initialized();
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * Execute the kernel 'f(i)' for all indices 0 <= i < n.
+     */
+    template<typename F>
+    void For(const len_t n, const F& f) {
+        if (n == 0)
+            return;
+
+#ifdef DREAM_WITH_KOKKOS
+        if (IsEnabled()) {
+            Kokkos::parallel_for(
+                "DREAM::FVM::Device::For",
+                Kokkos::RangePolicy<Kokkos::DefaultExecutionSpace, Kokkos::IndexType<len_t>>(0, n),
+                f
+            );
+            Kokkos::fence();
+            return;
+        }
+#endif
+        for (len_t i = 0; i < n; i++)
+            f(i);
+    }
+
+    /**
+     * Returns 'true' if 'f(i)' is true for any index 0 <= i < n.
+     */
+    template<typename F>
+    bool Any(const len_t n, const F& f) {
+        if (n == 0)
+            return false;
+
+#ifdef DREAM_WITH_KOKKOS
+        if (IsEnabled()) {
+            len_t count = 0;
+            Kokkos::parallel_reduce(
+                "DREAM::FVM::Device::Any",
+                Kokkos::RangePolicy<Kokkos::DefaultExecutionSpace, Kokkos::IndexType<len_t>>(0, n),
+                KOKKOS_LAMBDA (const len_t i, len_t &c) { if (f(i)) c++; },
+                count
+            );
+            return (count > 0);
+        }
+#endif
+        for (len_t i = 0; i < n; i++)
+            if (f(i))
+                return true;
+
+        return false;
+    }
+
+    /**
+     * Allocate an array of 'n' elements which can be accessed
+     * from both the host and the device.
+     */
+    template<typename T>
+    T *Allocate(const len_t n) {
+#ifdef DREAM_WITH_KOKKOS
+        if (IsEnabled())
+            return static_cast<T*>(Kokkos::kokkos_malloc<Kokkos::SharedSpace>("DREAM::FVM::Device", n*sizeof(T)));
+#endif
+        return new T[n];
+    }
+
+    /**
+     * Allocate an array of 'n' elements, set to zero, which
+     * (with Kokkos) can only be accessed from the device.
+     */
+    template<typename T>
+    T *AllocateDevice(const len_t n) {
+#ifdef DREAM_WITH_KOKKOS
+        if (IsEnabled()) {
+            T *p = static_cast<T*>(Kokkos::kokkos_malloc<Kokkos::DefaultExecutionSpace::memory_space>("DREAM::FVM::Device", n*sizeof(T)));
+            For(n, DREAM_DEVICE_LAMBDA (const len_t i) { p[i] = 0; });
+            return p;
+        }
+#endif
+        T *p = new T[n];
+        memset(p, 0, n*sizeof(T));
+        return p;
+    }
+
+    /**
+     * Copy 'n' elements from the host array 'src' to the
+     * array 'dst' allocated with 'AllocateDevice()'.
+     */
+    template<typename T>
+    void CopyToDevice(T *dst, const T *src, const len_t n) {
+#ifdef DREAM_WITH_KOKKOS
+        if (IsEnabled()) {
+            Kokkos::View<T*, Kokkos::DefaultExecutionSpace::memory_space, Kokkos::MemoryUnmanaged> d(dst, n);
+            Kokkos::View<const T*, Kokkos::HostSpace, Kokkos::MemoryUnmanaged> s(src, n);
+            Kokkos::deep_copy(d, s);
+            return;
+        }
+#endif
+        memcpy(dst, src, n*sizeof(T));
+    }
+
+    /**
+     * Copy 'n' elements from the array 'src' allocated with
+     * 'AllocateDevice()' to the host array 'dst'.
+     */
+    template<typename T>
+    void CopyToHost(T *dst, const T *src, const len_t n) {
+#ifdef DREAM_WITH_KOKKOS
+        if (IsEnabled()) {
+            Kokkos::View<T*, Kokkos::HostSpace, Kokkos::MemoryUnmanaged> d(dst, n);
+            Kokkos::View<const T*, Kokkos::DefaultExecutionSpace::memory_space, Kokkos::MemoryUnmanaged> s(src, n);
+            Kokkos::deep_copy(d, s);
+            return;
+        }
+#endif
+        memcpy(dst, src, n*sizeof(T));
+    }
+
+    /**
+     * Free memory allocated with 'Allocate()'.
+     */
+    template<typename T>
+    void Free(T *p) {
+        if (p == nullptr)
+            return;
+#ifdef DREAM_WITH_KOKKOS
+        if (IsEnabled()) {
+            Kokkos::kokkos_free<Kokkos::SharedSpace>(p);
+            return;
+        }
+#endif
+        delete [] p;
+    }
+
+    /**
+     * Free memory allocated with 'AllocateDevice()'.
+     */
+    template<typename T>
+    void FreeDevice(T *p) {
+        if (p == nullptr)
+            return;
+#ifdef DREAM_WITH_KOKKOS
+        if (IsEnabled()) {
+            Kokkos::kokkos_free<Kokkos::DefaultExecutionSpace::memory_space>(p);
+            return;
+        }
+#endif
+        delete [] p;
+    }
+}
+
+#endif/*_DREAM_FVM_DEVICE_HPP*/
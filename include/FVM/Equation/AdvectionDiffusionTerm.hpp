@@ -5,6 +5,7 @@
 #include "FVM/Equation/AdvectionTerm.hpp"
 #include "FVM/Equation/DiffusionTerm.hpp"
 #include "FVM/Equation/EquationTerm.hpp"
+#include "FVM/TermTimings.hpp"
 #include "FVM/UnknownQuantityHandler.hpp"
 
 
@@ -28,9 +29,31 @@ namespace DREAM::FVM {
         virtual void Rebuild(const real_t, const real_t, UnknownQuantityHandler*) override;
         virtual void ResetCoefficients() override;
 
+        virtual bool HasRebuildInputs() const override;
+        virtual bool NeedsRebuild(const real_t, const real_t, UnknownQuantityHandler*) const override;
+
         const std::vector<AdvectionTerm*>& GetAdvectionTerms() const { return advectionterms; }
         const std::vector<DiffusionTerm*>& GetDiffusionTerms() const { return diffusionterms; }
 
+        // (the advection and diffusion terms are rebuilt and
+        // differentiated through this term)
+        virtual bool IsThreadSafe() const override {
+            for (auto it = advectionterms.begin(); it != advectionterms.end(); it++)
+                if (!(*it)->IsThreadSafe())
+                    return false;
+            for (auto it = diffusionterms.begin(); it != diffusionterms.end(); it++)
+                if (!(*it)->IsThreadSafe())
+                    return false;
+
+            return true;
+        }
+        virtual void GetSharedObjects(std::vector<const void*>& objs) const override {
+            for (auto it = advectionterms.begin(); it != advectionterms.end(); it++)
+                (*it)->GetSharedObjects(objs);
+            for (auto it = diffusionterms.begin(); it != diffusionterms.end(); it++)
+                (*it)->GetSharedObjects(objs);
+        }
+
         virtual const real_t *GetRadialJacobianInterpolationCoeffs() const override {
             if (this->advectionterms.size() > 0)
                 return this->advectionterms[0]->GetRadialJacobianInterpolationCoeffs();
@@ -64,24 +87,50 @@ namespace DREAM::FVM {
                     this->DiffusionTerm::SetMatrixElements(jac, nullptr);
             }
 
-            // Handle any off-diagonal blocks and/or non-linear coefficients
+            // Handle any off-diagonal blocks and/or non-linear coefficients.
+            // The differentiation coefficients of all terms depending on
+            // 'derivId' are summed, so that the jacobian stencil only needs
+            // to be applied once for the advection terms and once for the
+            // diffusion terms.
+            std::vector<std::pair<AdvectionTerm*, len_t>> cadv;
             for (auto it = advectionterms.begin(); it != advectionterms.end(); it++) {
-                bool c = (*it)->SetJacobianBlock(uqtyId, derivId, jac, x);
-                contributes |= c;
+                TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_JACOBIAN);
+                len_t nMultiples;
+                if ((*it)->SetDifferentiationCoefficients(derivId, &nMultiples)) {
+                    cadv.push_back({*it, nMultiples});
 #ifndef NDEBUG
-                if (c && printTerms) printf("Contribution from %s", (*it)->GetName().c_str());
+                    if (printTerms) printf("Contribution from %s", (*it)->GetName().c_str());
 #endif
+                }
             }
 
+            std::vector<std::pair<DiffusionTerm*, len_t>> cdiff;
             for (auto it = diffusionterms.begin(); it != diffusionterms.end(); it++) {
-                bool c = (*it)->SetJacobianBlock(uqtyId, derivId, jac, x);
-                contributes |= c;
+                TermTimings::Scope timing((*it)->GetName(), TermTimings::PHASE_JACOBIAN);
+                len_t nMultiples;
+                if ((*it)->SetDifferentiationCoefficients(derivId, &nMultiples)) {
+                    cdiff.push_back({*it, nMultiples});
 #ifndef NDEBUG
-                if (c && printTerms) printf("Contribution from %s", (*it)->GetName().c_str());
+                    if (printTerms) printf("Contribution from %s", (*it)->GetName().c_str());
 #endif
+                }
+            }
+
+            if (cadv.size() == 1)
+                cadv[0].first->SetJacobianContributions(cadv[0].second, jac, x);
+            else if (cadv.size() > 1) {
+                this->AdvectionTerm::SumDifferentiationCoefficients(cadv);
+                this->AdvectionTerm::SetJacobianContributions(this->AdvectionTerm::nDiffMultiples, jac, x);
+            }
+
+            if (cdiff.size() == 1)
+                cdiff[0].first->SetJacobianContributions(cdiff[0].second, jac, x);
+            else if (cdiff.size() > 1) {
+                this->DiffusionTerm::SumDifferentiationCoefficients(cdiff);
+                this->DiffusionTerm::SetJacobianContributions(this->DiffusionTerm::nDiffMultiples, jac, x);
             }
 
-            return contributes;
+            return contributes || !cadv.empty() || !cdiff.empty();
         }
         virtual void SetMatrixElements(Matrix *mat, real_t *rhs) override {
             if (this->advectionterms.size() > 0)
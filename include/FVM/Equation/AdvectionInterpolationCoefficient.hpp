@@ -84,40 +84,49 @@ namespace DREAM::FVM {
     private:
         /**
          * Functions that return the unknown quantity y evaluated 
-         * at index ind (with the other indices given by ir, i and/or j)
+         * at index ind (with the other indices given by ir, i and/or j).
+         * Along the radial flux grid, the unknown at radius 'ind' is
+         * mapped onto the momentum grid of flux grid point 'ir' if the
+         * two use different momentum grids.
          */
-        struct YFunc_params {real_t *f; len_t *n1; len_t *n2; len_t ir; len_t i; len_t j;};
+        struct YFunc_params {real_t *f; len_t *n1; len_t *n2; const len_t *fOffset; const Grid *grid; len_t ir; len_t i; len_t j;};
         static real_t YFunc_fr(int_t ind, void *par){
             YFunc_params *params = (struct YFunc_params*) par;
-            len_t offset = 0;
-            for(int_t k=0; k<ind;k++)
-                offset += params->n1[k]*params->n2[k];
-            return params->f[offset + params->j*params->n1[ind] + params->i];
+            const MomentumGridMapping *map = params->grid->GetMomentumGridMapping(
+                params->grid->GetMomentumGrid(ind), params->grid->GetMomentumGrid_fr(params->ir)
+            );
+            if (map != nullptr)
+                return map->Interpolate(params->f + params->fOffset[ind], params->i, params->j);
+            else
+                return params->f[params->fOffset[ind] + params->j*params->n1[ind] + params->i];
         } 
         static real_t YFunc_f1(int_t ind, void *par){
             YFunc_params *params = (struct YFunc_params*) par;
-            len_t offset=0;
-            for(len_t k=0; k<params->ir;k++)
-                offset += (params->n1[k]-1)*params->n2[k];
-            return params->f[offset + params->j*(params->n1[params->ir]-1) + ind];            
+            return params->f[params->fOffset[params->ir] + params->j*(params->n1[params->ir]-1) + ind];            
         }
         static real_t YFunc_f2(int_t ind, void *par){
             YFunc_params *params = (struct YFunc_params*) par;
-            len_t offset=0;
-            for(len_t k=0; k<params->ir;k++)
-                offset += params->n1[k]*(params->n2[k]-1);
-            return params->f[offset + ind*params->n1[params->ir] + params->i];            
+            return params->f[params->fOffset[params->ir] + ind*params->n1[params->ir] + params->i];            
         }
 
         fluxGridType fgType;
         Grid *grid;
-        const len_t STENCIL_WIDTH = 2;
+        static constexpr len_t STENCIL_WIDTH = 2;
         len_t nnzPerRow_offDiag = 2;
         len_t nr;
         len_t *n1 = nullptr;
         len_t *n2 = nullptr;
-        real_t ***deltas = nullptr;
-        real_t ***deltas_jac = nullptr;
+        // Index of the first cell at radius 'ir' in 'deltas'
+        len_t *cellOffset = nullptr;
+        // Index of the first element at radius 'ir' in the (cell grid)
+        // unknown quantity, used when evaluating flux limiters
+        len_t *fOffset = nullptr;
+        // Total number of flux grid cells
+        len_t nCells = 0;
+        // Interpolation coefficients, stored contiguously as
+        // deltas[(cellOffset[ir] + j*n1[ir]+i)*2*STENCIL_WIDTH + k]
+        real_t *deltas = nullptr;
+        real_t *deltas_jac = nullptr;
         real_t *delta_prev;
         real_t *delta_tmp;
         len_t id_unknown;
@@ -142,6 +151,12 @@ namespace DREAM::FVM {
 
         void Deallocate();
 
+        // Returns the interpolation coefficients for the given cell
+        real_t *GetDelta(const len_t ir, const len_t pind)
+        { return deltas + (cellOffset[ir]+pind)*2*STENCIL_WIDTH; }
+        real_t *GetDeltaJacobian(const len_t ir, const len_t pind)
+        { return deltas_jac + (cellOffset[ir]+pind)*2*STENCIL_WIDTH; }
+
         // Returns the "active" index of this interpolation term
         len_t GetIndex(len_t ir, len_t i, len_t j, int_t *N)
         {
@@ -170,10 +185,16 @@ namespace DREAM::FVM {
 
         void SetNNZ(adv_interpolation);
 
-        bool IsFluxLimiterMethod(adv_interpolation method){
+        template<adv_interpolation method>
+        void SetCoefficientsAtRadius(
+            const len_t, real_t**, const real_t*, const real_t*,
+            real_t(*)(int_t,void*), YFunc_params&, const real_t
+        );
+
+        static constexpr bool IsFluxLimiterMethod(adv_interpolation method){
             return method==AD_INTERP_TCDF || method==AD_INTERP_OSPRE || method==AD_INTERP_SMART || method==AD_INTERP_MUSCL; 
         }
-        bool IsSmoothFluxLimiter(adv_interpolation method) {
+        static constexpr bool IsSmoothFluxLimiter(adv_interpolation method) {
             return method==AD_INTERP_TCDF || method==AD_INTERP_OSPRE;
         }
     public:
@@ -185,6 +206,7 @@ namespace DREAM::FVM {
         ~AdvectionInterpolationCoefficient();
 
         void Allocate();
+        size_t GetMemoryUsage() const;
 
         void ApplyBoundaryCondition();
         void SetCoefficient(real_t **A, real_t **D=nullptr, UnknownQuantityHandler* unknowns=nullptr, real_t damping_factor=1.0);
@@ -196,6 +218,7 @@ namespace DREAM::FVM {
             adv_i = intp;
             SetNNZ(adv_i);
         } 
+        bool UsesFluxLimiter() const { return IsFluxLimiterMethod(adv_i); }
 
         void ResetCoefficient();
 
@@ -208,31 +231,31 @@ namespace DREAM::FVM {
         ////////////////////////////////////////////
         // Getters for interpolation coefficients //
         ////////////////////////////////////////////
-        real_t ***GetCoefficient(adv_interp_mode interp_mode = AD_INTERP_MODE_FULL) { 
-            if(interp_mode == AD_INTERP_MODE_FULL)
-                return deltas; 
-            else if (interp_mode == AD_INTERP_MODE_JACOBIAN)
-                return deltas_jac;
-            else
-                throw FVMException("Invalid advection interpolation mode requested.");
-        }
         real_t *GetCoefficient(len_t ir, len_t i, len_t j,adv_interp_mode interp_mode = AD_INTERP_MODE_FULL) { 
             if(interp_mode == AD_INTERP_MODE_FULL)
-                return deltas[ir][j*n1[ir]+i]; 
+                return GetDelta(ir, j*n1[ir]+i);
             else if (interp_mode == AD_INTERP_MODE_JACOBIAN)
-                return deltas_jac[ir][j*n1[ir]+i];
+                return GetDeltaJacobian(ir, j*n1[ir]+i);
             else
                 throw FVMException("Invalid advection interpolation mode requested.");
         }
         const real_t GetCoefficient(len_t ir, len_t i, len_t j, len_t n,adv_interp_mode interp_mode = AD_INTERP_MODE_FULL) const { 
+            const len_t idx = (cellOffset[ir] + j*n1[ir]+i)*2*STENCIL_WIDTH + n;
             if(interp_mode == AD_INTERP_MODE_FULL)
-                return deltas[ir][j*n1[ir]+i][n]; 
+                return deltas[idx]; 
             else if (interp_mode == AD_INTERP_MODE_JACOBIAN)
-                return deltas_jac[ir][j*n1[ir]+i][n];
+                return deltas_jac[idx];
             else
                 throw FVMException("Invalid advection interpolation mode requested.");
         }
 
+        // Returns all interpolation coefficients, and the index in this
+        // array of the first coefficient of the given cell
+        const real_t *GetCoefficients(adv_interp_mode interp_mode = AD_INTERP_MODE_FULL) const
+        { return (interp_mode == AD_INTERP_MODE_JACOBIAN ? deltas_jac : deltas); }
+        len_t GetCoefficientIndex(len_t ir, len_t i, len_t j) const
+        { return (cellOffset[ir] + j*n1[ir]+i)*2*STENCIL_WIDTH; }
+
         len_t GetKmin(len_t ind, len_t *n);
         len_t GetKmax(len_t ind, len_t N);
         
@@ -3,10 +3,13 @@
 
 namespace DREAM::FVM { class AdvectionTerm; }
 
+#include <utility>
+#include <vector>
 #include <softlib/SFile.h>
 #include "FVM/config.h"
 #include "FVM/Equation/EquationTerm.hpp"
 #include "FVM/Equation/AdvectionInterpolationCoefficient.hpp"
+#include "FVM/Equation/DeviceStencil.hpp"
 #include "FVM/Grid/Grid.hpp"
 
 namespace DREAM::FVM {
@@ -36,6 +39,8 @@ namespace DREAM::FVM {
         real_t **f1pSqAtZero   = nullptr;
         real_t **df1pSqAtZero  = nullptr;
         real_t *JacobianColumn = nullptr;
+        // Number of multiples for which differentiation coefficients are allocated
+        len_t nDiffMultiples = 0;
 
         bool coefficientsShared = false;
 
@@ -50,9 +55,17 @@ namespace DREAM::FVM {
         real_t dampingWithIteration = 1.0, t_prev = -1.0, dt_prev = -1.0;
         len_t iteration=0;
 
+        // Stencil applied on the device (see 'SetMatrixElementsDevice()'),
+        // rebuilt whenever the grid or the coefficient arrays change
+        DeviceStencil deviceStencil;
+        bool deviceStencilValid = false, deviceStencilSupported = false;
+        bool BuildDeviceStencil();
+        bool SetMatrixElementsDevice(Matrix*);
+
         // Memory allocation for various coefficients
         void AllocateCoefficients();
         void AllocateDifferentiationCoefficients();
+        void AllocateDifferentiationCoefficients(const len_t);
         void AllocateInterpolationCoefficients();
         void DeallocateCoefficients();
         void DeallocateDifferentiationCoefficients();
@@ -84,10 +97,16 @@ namespace DREAM::FVM {
         virtual const real_t *GetRadialJacobianInterpolationCoeffs() const { return deltaRadialFlux; }
 
         // Returns nnz per row (assuming that this AdvectionTerm contains non-zero
-        // elements in all three components)
+        // elements in all three components). When radii use different momentum
+        // grids, every radial stencil point may couple to several cells (on
+        // the outer face, through several face cells).
         virtual len_t GetNumberOfNonZerosPerRow() const override {
-            return 1 +
-                deltar->GetOffDiagonalNNZPerRow() +
+            const len_t m = this->grid->GetMaxMomentumGridOverlap();
+            const len_t nnzr = (m > 1) ?
+                m*m*(deltar->GetOffDiagonalNNZPerRow()+1) :
+                deltar->GetOffDiagonalNNZPerRow();
+
+            return 1 + nnzr +
                 delta1->GetOffDiagonalNNZPerRow() +
                 delta2->GetOffDiagonalNNZPerRow();
         }
@@ -166,6 +185,13 @@ namespace DREAM::FVM {
         AdvectionInterpolationCoefficient *GetInterpolationCoeff1() { return this->delta1; }
         AdvectionInterpolationCoefficient *GetInterpolationCoeff2() { return this->delta2; }
 
+        // Returns 'true' if any of the interpolation coefficients use a flux limiter
+        bool UsesFluxLimiter() const {
+            return (deltar != nullptr && deltar->UsesFluxLimiter()) ||
+                (delta1 != nullptr && delta1->UsesFluxLimiter()) ||
+                (delta2 != nullptr && delta2->UsesFluxLimiter());
+        }
+
         void RebuildFluxLimiterDamping(const real_t, const real_t);
         void RebuildInterpolationCoefficients(UnknownQuantityHandler*, real_t**, real_t**, real_t**);
 
@@ -174,6 +200,10 @@ namespace DREAM::FVM {
 
         virtual void SetPartialAdvectionTerm(len_t /*derivId*/, len_t /*nMultiples*/){}
 
+        bool SetDifferentiationCoefficients(const len_t, len_t*);
+        void SumDifferentiationCoefficients(const std::vector<std::pair<AdvectionTerm*, len_t>>&);
+        void SetJacobianContributions(const len_t, Matrix*, const real_t*);
+
         // set the interpolation
         void SetAdvectionInterpolationMethod(
             AdvectionInterpolationCoefficient::adv_interpolation intp,
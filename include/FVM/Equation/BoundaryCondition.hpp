@@ -2,6 +2,7 @@
 #define _DREAM_FVM_BOUNDARY_CONDITION_HPP
 
 #include <string>
+#include <vector>
 #include "FVM/config.h"
 #include "FVM/Grid/Grid.hpp"
 #include "FVM/Matrix.hpp"
@@ -29,6 +30,15 @@ namespace DREAM::FVM::BC {
 
         virtual bool GridRebuilt() { return false; }
 
+        // Returns 'true' if this boundary condition may be rebuilt
+        // and evaluated concurrently with the terms of other equations
+        // (see 'EquationTerm::IsThreadSafe()'; audited boundary
+        // conditions must override this)
+        virtual bool IsThreadSafe() const { return false; }
+        // Objects shared with other equations which are modified by
+        // this boundary condition (see 'EquationTerm::GetSharedObjects()')
+        virtual void GetSharedObjects(std::vector<const void*>&) const {}
+
         virtual bool Rebuild(const real_t t, UnknownQuantityHandler*) = 0;
 
         virtual bool AddToJacobianBlock(const len_t, const len_t, Matrix*, const real_t*) = 0;
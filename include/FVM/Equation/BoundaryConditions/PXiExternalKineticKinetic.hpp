@@ -20,6 +20,8 @@ namespace DREAM::FVM::BC {
 
         const real_t *fLow, *fUpp;
 
+        void GetMaxNp2(len_t&, len_t&) const;
+
         void __SetElements(
             std::function<void(const len_t, const len_t, const real_t)>,
             std::function<void(const len_t, const len_t, const real_t)>
@@ -57,10 +57,16 @@ namespace DREAM::FVM::BC {
         enum bc_type boundaryCondition = BC_PHI_CONST;
         enum boundary_type boundary    = BOUNDARY_KINETIC;
 
+        // Particle flux through the boundary at each radius, recorded
+        // in the most recent residual evaluation
+        real_t *boundaryFlux;
+        bool boundaryFluxValid = false;
+
         void __SetElements(std::function<void(const len_t, const len_t, const real_t)>);
         void __SetElements(
             std::function<void(const len_t, const len_t, const real_t)>,
-            const real_t *const*, const real_t *const*, const real_t *const*
+            const real_t *const*, const real_t *const*, const real_t *const*,
+            real_t *flux=nullptr, const real_t *x=nullptr
         );
 
     public:
@@ -69,6 +75,9 @@ namespace DREAM::FVM::BC {
             DREAM::FVM::Grid *distributionGrid=nullptr,
             enum boundary_type=BOUNDARY_KINETIC, enum bc_type bc=BC_PHI_CONST
         );
+        virtual ~PXiExternalLoss();
+
+        const real_t *GetBoundaryFlux(const real_t*);
 
         virtual len_t GetNumberOfNonZerosPerRow() const override;
         virtual len_t GetNumberOfNonZerosPerRow_jac() const override;
@@ -25,10 +25,24 @@ namespace DREAM::FVM::BC {
         PetscInt **trappedPosXiRadial_indices=nullptr;   // size nr x nTrappedNegXi_indices[ir]
 
         
+        // Number of radial grid points for which the index arrays were built
+        len_t nr = 0;
+
         // Total number of rows in Matrix and Jacobian that should be reset
         len_t nRowsToReset;
         // Indices of all rows that should be reset in Matrix and Jacobian
         PetscInt *rowsToReset = nullptr;
+
+        // Precomputed map setting f(xi0) = f(-xi0) in the trapped region,
+        // stored contiguously for all radii. Element 'k' of the map
+        // adds 'mirrorWeights[k]' to the matrix element
+        // (mirrorRows[k], mirrorCols[k]). The elements for radius 'ir'
+        // are found in [mirrorOffsets[ir], mirrorOffsets[ir+1]).
+        len_t *mirrorOffsets = nullptr;     // size nr+1
+        PetscInt *mirrorRows = nullptr;     // size mirrorOffsets[nr]
+        PetscInt *mirrorCols = nullptr;     // size mirrorOffsets[nr]
+        real_t *mirrorWeights = nullptr;    // size mirrorOffsets[nr]
+
         void _addElements(
             std::function<void(const len_t, const len_t, const real_t)>,
             const real_t *const*, const real_t *const*, const real_t *const*,
@@ -53,6 +67,7 @@ namespace DREAM::FVM::BC {
         
         void DeallocateTrappedIndices();
         void LocateTrappedRegion();
+        void BuildMirrorMap();
 
         virtual bool AddToJacobianBlock(const len_t, const len_t, Matrix*, const real_t*) override;
         virtual void AddToMatrixElements(Matrix*, real_t*) override;
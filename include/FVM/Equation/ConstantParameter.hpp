@@ -11,6 +11,8 @@ namespace DREAM::FVM {
         virtual ~ConstantParameter();
 
         virtual void Rebuild(const real_t, const real_t, UnknownQuantityHandler*) override {}
+        virtual bool IsJacobianConstant() const override { return true; }
+        virtual bool IsThreadSafe() const override { return true; }
     };
 }
 
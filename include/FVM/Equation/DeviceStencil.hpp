@@ -0,0 +1,76 @@
+#ifndef _DREAM_FVM_EQUATION_DEVICE_STENCIL_HPP
+#define _DREAM_FVM_EQUATION_DEVICE_STENCIL_HPP
+
+#include <vector>
+#include "FVM/config.h"
+#include "FVM/Matrix.hpp"
+
+namespace DREAM::FVM {
+    class DeviceStencil {
+    public:
+        // Maximum number of coefficient (and interpolation
+        // coefficient) arrays referred to by a stencil
+        static constexpr len_t MAX_ARRAYS = 5;
+
+        // Arrays of coefficients, given to 'Apply()' in the order
+        // of the array indices used when building the stencil. All
+        // arrays must be allocated with 'Device::Allocate()'.
+        struct arrays {
+            const real_t *p[MAX_ARRAYS];
+        };
+
+    private:
+        // Stencil entries, stored row by row: entry 'e' adds
+        //
+        //   weight[e] * C[coef[e]] * D[delta[e]]
+        //
+        // to element (row, col[e]) of the matrix, where 'C' is the
+        // coefficient array 'array[e]' and 'D' the interpolation
+        // coefficient array 'deltaArray[e]' (or 1 if 'delta[e] < 0')
+        std::vector<PetscInt> rows, rowStart, cols;
+        std::vector<int> array, deltaArray;
+        std::vector<len_t> coef;
+        std::vector<PetscInt> delta;
+        std::vector<real_t> weight;
+
+        // Copies of the entries on the device
+        len_t nRows = 0, nEntries = 0;
+        PetscInt *d_rowStart = nullptr, *d_delta = nullptr;
+        int *d_array = nullptr, *d_deltaArray = nullptr;
+        len_t *d_coef = nullptr;
+        real_t *d_weight = nullptr;
+        bool finalized = false;
+
+        // Locations of the entries in the value array of a matrix
+        // (or -1 for entries outside of the recorded structure)
+        struct device_slots {
+            const Matrix *mat;
+            len_t csrRevision;
+            PetscInt rowOffset, colOffset;
+            len_t nMissing;
+            PetscInt *slots;
+        };
+        std::vector<struct device_slots> deviceSlots;
+
+        void DeallocateDevice();
+        struct device_slots *GetDeviceSlots(const Matrix*);
+        void Finalize();
+
+    public:
+        DeviceStencil() {}
+        DeviceStencil(const DeviceStencil&) = delete;
+        DeviceStencil& operator=(const DeviceStencil&) = delete;
+        ~DeviceStencil();
+
+        void Clear();
+        void BeginRow(const PetscInt);
+        void Add(
+            const PetscInt col, const int array, const len_t coef,
+            const real_t weight, const int deltaArray=0, const PetscInt delta=-1
+        );
+
+        bool Apply(Matrix*, const struct arrays&, const struct arrays&);
+    };
+}
+
+#endif/*_DREAM_FVM_EQUATION_DEVICE_STENCIL_HPP*/
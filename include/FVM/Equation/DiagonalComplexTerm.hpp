@@ -40,6 +40,12 @@ namespace DREAM::FVM {
         
         virtual void SetMatrixElements(Matrix*, real_t*) override;
         virtual void SetVectorElements(real_t*, const real_t*) override;
+
+        // Only terms operating on the quantity of the equation
+        // (i.e. on the same grid) have square, diagonal matrices
+        virtual bool IsFusable() const override
+        { return (this->operandGrid == nullptr || this->operandGrid == this->grid); }
+        virtual void AddToDiagonal(real_t*) override;
     };
 }
 
@@ -26,6 +26,9 @@ namespace DREAM::FVM {
         virtual void SetMatrixElements(Matrix*, real_t*) override;
         virtual void SetVectorElements(real_t*, const real_t*) override;
 
+        virtual bool IsFusable() const override { return true; }
+        virtual void AddToDiagonal(real_t*) override;
+
         /**
          * The following methods are to be inherited from DiagonalTerm
          */
@@ -34,6 +37,9 @@ namespace DREAM::FVM {
         virtual void Rebuild(const real_t t, const real_t dt, UnknownQuantityHandler *u) override { this->DiagonalTerm::Rebuild(t,dt,u); };
         virtual bool SetJacobianBlock(const len_t uqtyId, const len_t derivId, Matrix *jac, const real_t* x) override
             {return this->DiagonalTerm::SetJacobianBlock(uqtyId,derivId,jac,x);}
+        // Derived terms whose weights depend on the
+        // unknowns must override this and return 'false'
+        virtual bool IsJacobianConstant() const override { return true; }
 
     };
 }
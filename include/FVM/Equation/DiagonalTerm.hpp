@@ -33,6 +33,21 @@ namespace DREAM::FVM {
         virtual void Rebuild(const real_t, const real_t, UnknownQuantityHandler*) override;
         virtual bool GridRebuilt() override;
         virtual bool SetJacobianBlock(const len_t, const len_t, Matrix*, const real_t*) override;
+
+        /**
+         * Returns 'true' if the matrix of this term is described
+         * completely by the elements added by 'AddToDiagonal()', so
+         * that the term can be assembled together with the other
+         * diagonal terms of an operator (see 'Operator::GroupTerms()').
+         * Derived classes which override 'SetMatrixElements()' or
+         * 'SetVectorElements()' must override this and return 'false'.
+         */
+        virtual bool IsFusable() const { return false; }
+        // Add the diagonal matrix elements of this term to 'diag'
+        virtual void AddToDiagonal(real_t*) {}
+        // Add the contribution from differentiating the weights to 'jac'
+        bool AddWeightsJacobianBlock(const len_t uqtyId, const len_t derivId, Matrix *jac, const real_t *x)
+            { return AddWeightsJacobian(uqtyId, derivId, jac, x); }
     };
 }
 
@@ -1,7 +1,11 @@
 namespace DREAM::FVM { class DiffusionTerm; }
 
+#include <algorithm>
+#include <utility>
+#include <vector>
 #include <softlib/SFile.h>
 #include "FVM/config.h"
+#include "FVM/Equation/DeviceStencil.hpp"
 #include "FVM/Equation/EquationTerm.hpp"
 #include "FVM/Grid/Grid.hpp"
 
@@ -32,10 +36,18 @@ namespace DREAM::FVM {
             **dd11=nullptr, **dd12=nullptr,
             **dd21=nullptr, **dd22=nullptr;
         real_t *JacobianColumn = nullptr;
-
+        // Number of multiples for which differentiation coefficients are allocated
+        len_t nDiffMultiples = 0;
 
         bool coefficientsShared = false;
 
+        // Stencil applied on the device (see 'SetMatrixElementsDevice()'),
+        // rebuilt whenever the grid or the coefficient arrays change
+        DeviceStencil deviceStencil;
+        bool deviceStencilValid = false, deviceStencilSupported = false;
+        bool BuildDeviceStencil();
+        bool SetMatrixElementsDevice(Matrix*);
+
         void SetPartialJacobianContribution(int_t, jacobian_interp_mode, len_t, Matrix*, const real_t*);
         void ResetJacobianColumn();
 
@@ -45,6 +57,7 @@ namespace DREAM::FVM {
 
         void AllocateCoefficients();
         void AllocateDifferentiationCoefficients();
+        void AllocateDifferentiationCoefficients(const len_t);
         void DeallocateCoefficients();
         void DeallocateDifferentiationCoefficients();
         void SetCoefficients(
@@ -80,11 +93,17 @@ namespace DREAM::FVM {
         virtual len_t GetNumberOfNonZerosPerRow() const override {
             len_t nnz = 1;
 
-            len_t np1 = this->grid->GetMomentumGrid(0)->GetNp1();
-            len_t np2 = this->grid->GetMomentumGrid(0)->GetNp2();
-
-            if (this->grid->GetNr() > 1) nnz += 2;      // Drr
-            // XXX here we assume that all momentum grids are the same
+            len_t np1 = 0, np2 = 0;
+            for (len_t ir = 0; ir < this->grid->GetNr(); ir++) {
+                np1 = std::max(np1, this->grid->GetNp1(ir));
+                np2 = std::max(np2, this->grid->GetNp2(ir));
+            }
+
+            // With different momentum grids at different radii, the
+            // radial stencil couples to several cells at each radius
+            const len_t m = this->grid->GetMaxMomentumGridOverlap();
+            if (this->grid->GetNr() > 1)                // Drr
+                nnz += (m > 1) ? 3*m*m : 2;
             if (np1 > 1) nnz += 2;      // Dpp
             if (np2 > 1) nnz += 2;      // Dxx
             if (np1 > 1 && np2 > 1) nnz += 2*8;   // Dpx & Dxp
@@ -95,8 +114,8 @@ namespace DREAM::FVM {
         // Accessors to diffusion coefficients
         real_t& Drr(const len_t ir, const len_t i1, const len_t i2)
         { return Drr(ir, i1, i2, this->drr); }
-        // XXX here we explicitly assume that the momentum
-        // grids are the same at all radii
+        // (radial flux grid point 'ir' uses the momentum grid of
+        // cell 'ir', and the outermost point that of the last cell)
         real_t& Drr(const len_t ir, const len_t i1, const len_t i2, real_t **drr) {
             len_t np1 = (ir==nr) ? n1[ir-1] : n1[ir];
             return drr[ir][i2*np1 + i1];
@@ -135,8 +154,6 @@ namespace DREAM::FVM {
         { return d22[ir][i2_f*n1[ir] + i1]; }
 
         real_t& dDrr(const len_t ir, const len_t i1, const len_t i2, const len_t nMultiple=0) {
-            // XXX here we explicitly assume that the momentum
-            // grids are the same at all radii
             len_t np1 = (ir==nr) ? n1[ir-1] : n1[ir];
             return ddrr[ir+nMultiple*(nr+1)][i2*np1 + i1];
         }
@@ -169,6 +186,10 @@ namespace DREAM::FVM {
         // the 2-point stencil given by deltaRadialFlux.
         virtual void SetPartialDiffusionTerm(len_t /*derivId*/, len_t /*nMultiples*/){}
 
+        bool SetDifferentiationCoefficients(const len_t, len_t*);
+        void SumDifferentiationCoefficients(const std::vector<std::pair<DiffusionTerm*, len_t>>&);
+        void SetJacobianContributions(const len_t, Matrix*, const real_t*);
+
         virtual void SaveCoefficientsSFile(const std::string&);
         virtual void SaveCoefficientsSFile(SFile*);
     };
@@ -2,8 +2,10 @@
 #define _DREAM_FVM_EQUATION_TERM_HPP
 
 #include <string>
+#include <vector>
 #include "FVM/Grid/Grid.hpp"
 #include "FVM/Matrix.hpp"
+#include "FVM/ScratchArena.hpp"
 #include "FVM/UnknownQuantityHandler.hpp"
 
 namespace DREAM::FVM {
@@ -12,6 +14,17 @@ namespace DREAM::FVM {
         std::vector<len_t> derivIdsJacobian;
         std::vector<len_t> derivNMultiplesJacobian;
 
+        // Inputs on which the coefficients built by 'Rebuild()' depend
+        // (used to skip rebuilding the term when no input has changed)
+        std::vector<len_t> rebuildInputs;
+        bool rebuildInputsDeclared = false;
+        bool rebuildTimeDependent = true;
+        bool rebuildPending = true;
+        real_t rebuildTime = 0, rebuildTimeStep = 0;
+
+        // Number of rebuilds done/skipped by 'RebuildIfNeeded()'
+        len_t nRebuilds = 0, nRebuildsSkipped = 0;
+
     protected:
         std::string name = "<NOT SET>";
 
@@ -21,6 +34,11 @@ namespace DREAM::FVM {
         void AllocateMemory();
         void DeallocateMemory();
 
+        // Allocate temporary memory which is released automatically
+        // at the end of the current solver iteration
+        template<typename T>
+        static T *AllocateScratch(const len_t n) { return ScratchArena::Get().Allocate<T>(n); }
+
         // Adds derivId to list of unknown quantities that contributes to Jacobian of this advection term
         void AddUnknownForJacobian(FVM::UnknownQuantityHandler *u, len_t derivId){
             derivIdsJacobian.push_back(derivId);
@@ -36,6 +54,27 @@ namespace DREAM::FVM {
                 nnz += derivNMultiplesJacobian[i];
             return nnz;
         }
+        /**
+         * Declare that the coefficients built by 'Rebuild()' only depend
+         * on the grid, the time (and time step) and the unknown quantities
+         * with the given IDs. Rebuilding the term is then skipped whenever
+         * none of these inputs have changed since the previous rebuild.
+         *
+         * ids:           IDs of unknown quantities used by 'Rebuild()'.
+         * timeDependent: If 'false', the coefficients do not depend
+         *                explicitly on time either.
+         */
+        void SetRebuildInputs(const std::vector<len_t>& ids={}, bool timeDependent=true) {
+            rebuildInputs = ids;
+            rebuildInputsDeclared = true;
+            rebuildTimeDependent = timeDependent;
+        }
+        void AddUnknownForRebuild(len_t id) {
+            rebuildInputs.push_back(id);
+            rebuildInputsDeclared = true;
+        }
+        bool IsRebuildPending() const { return rebuildPending; }
+
         len_t GetMaxNumberOfMultiplesJacobian() const {
             len_t maxN = 0; 
             for(len_t i = 0; i<derivIdsJacobian.size(); i++)
@@ -61,7 +100,48 @@ namespace DREAM::FVM {
 
         bool HasJacobianContribution(len_t derivId, len_t *nMultiples=nullptr);
 
+        /**
+         * Returns 'true' if 'Rebuild()' and 'SetJacobianBlock()' may be
+         * called on this term at the same time as they are called on
+         * terms in other equations (i.e. from another thread). This is
+         * only the case if the term modifies no state other than its own
+         * (many terms evaluate their coefficients in work buffers owned
+         * by shared objects, such as the collision frequencies), which
+         * must be verified for each term. Terms are therefore assumed not
+         * to be thread-safe, and audited terms override this method.
+         */
+        virtual bool IsThreadSafe() const { return false; }
+
+        /**
+         * Adds to 'objs' the objects shared with terms of other equations
+         * (such as the collision quantity handlers, or the RunawayFluid)
+         * whose state is modified when this term is rebuilt or builds its
+         * jacobian blocks. Thread-safe terms which share an object are
+         * never built concurrently.
+         */
+        virtual void GetSharedObjects(std::vector<const void*>&) const {}
+
+        /**
+         * Returns 'true' if the jacobian contribution of this term
+         * does not change during a time step (i.e. if it does not
+         * depend on any of the unknowns being solved for). The
+         * contributions of such terms are only assembled once per
+         * time step (see 'DREAM::Solver::BuildJacobian()'). Terms must
+         * only override this method if they are certain to satisfy it.
+         */
+        virtual bool IsJacobianConstant() const { return false; }
+
         virtual void Rebuild(const real_t, const real_t, UnknownQuantityHandler*) = 0;
+
+        virtual bool HasRebuildInputs() const { return rebuildInputsDeclared; }
+        virtual bool NeedsRebuild(const real_t, const real_t, UnknownQuantityHandler*) const;
+        bool RebuildIfNeeded(const real_t, const real_t, UnknownQuantityHandler*);
+        void SetRebuilt(const real_t, const real_t);
+        void InvalidateRebuild() { rebuildPending = true; }
+
+        len_t GetNRebuilds() const { return nRebuilds; }
+        len_t GetNRebuildsSkipped() const { return nRebuildsSkipped; }
+
         /**
          * Sets the block specified by 'uqtyId' and 'derivId' in the
          * given Jacobian matrix. Note that 'uqtyId' and 'derivId' do
@@ -0,0 +1,44 @@
+#ifndef _DREAM_FVM_EQUATION_FUSED_MOMENT_EVALUATOR_HPP
+#define _DREAM_FVM_EQUATION_FUSED_MOMENT_EVALUATOR_HPP
+
+#include <memory>
+#include <vector>
+#include "FVM/config.h"
+#include "FVM/Grid/Grid.hpp"
+#include "FVM/UnknownQuantityHandler.hpp"
+
+namespace DREAM::FVM {
+    class MomentQuantity;
+
+    class FusedMomentEvaluator {
+    private:
+        Grid *fGrid;
+        len_t fId;
+        UnknownQuantityHandler *unknowns;
+
+        std::vector<MomentQuantity*> moments;
+
+        // Values of all moments ('values[m*nr + ir]'), and the state
+        // of the distribution function and the quadrature weights
+        // for which they were last evaluated
+        std::vector<real_t> values;
+        std::vector<len_t> weightsRevision;
+        const real_t *evaluatedF = nullptr;
+        len_t evaluatedVersion = 0;
+        bool valid = false;
+
+        void Evaluate(const real_t*);
+
+    public:
+        FusedMomentEvaluator(Grid*, const len_t, UnknownQuantityHandler*);
+
+        static std::shared_ptr<FusedMomentEvaluator> Get(Grid*, const len_t, UnknownQuantityHandler*);
+
+        len_t Add(MomentQuantity*);
+        void Remove(MomentQuantity*);
+
+        const real_t *GetMoment(const len_t, const real_t*);
+    };
+}
+
+#endif/*_DREAM_FVM_EQUATION_FUSED_MOMENT_EVALUATOR_HPP*/
@@ -21,6 +21,8 @@ namespace DREAM::FVM {
         IdentityTerm(Grid* g, const real_t scaleFactor=1.0) 
             : DiagonalLinearTerm(g), scaleFactor(scaleFactor) {}
 
+        virtual bool IsThreadSafe() const override { return true; }
+
     };
 }
 
@@ -25,6 +25,11 @@ namespace DREAM::FVM {
         virtual void Rebuild(const real_t, const real_t dt, UnknownQuantityHandler *uqty) override;
         virtual void SetMatrixElements(Matrix*, real_t*) override;
         virtual void SetVectorElements(real_t*, const real_t*) override;
+        // (only depends on the time step length)
+        virtual bool IsJacobianConstant() const override { return true; }
+        // (only reads the unknown at the previous time step; derived
+        // terms reading other state from 'SetWeights()' must override)
+        virtual bool IsThreadSafe() const override { return true; }
     };
 }
 
@@ -1,7 +1,10 @@
 #ifndef _DREAM_FVM_EQUATION_MOMENT_QUANTITY_HPP
 #define _DREAM_FVM_EQUATION_MOMENT_QUANTITY_HPP
 
+#include <memory>
+#include <vector>
 #include "FVM/Equation/EquationTerm.hpp"
+#include "FVM/Equation/FusedMomentEvaluator.hpp"
 #include "FVM/Equation/PredeterminedParameter.hpp"
 #include "FVM/Grid/Grid.hpp"
 
@@ -51,8 +54,12 @@ namespace DREAM::FVM {
         virtual void SetDiffIntegrand(len_t){}
 
         void AllocateDiffIntegrand();
+        void SetWeightedDistribution(const real_t*, real_t*);
+        void EnableFusedEvaluation();
 
     private:
+        friend class FusedMomentEvaluator;
+
         real_t pThreshold;
         pThresholdMode pMode;
         xiIntegralMode xiMode;
@@ -61,6 +68,53 @@ namespace DREAM::FVM {
         std::vector<len_t> derivIds;
         std::vector<len_t> derivNMultiples;
 
+        // Quadrature weights of the moment, such that the moment in
+        // radial grid point 'ir' is given by the sum of
+        // 'weights[k]*integrand[k]*f[k]' over 'weightsLength[ir]'
+        // consecutive cells, starting at 'weightsFirst[ir]'. The
+        // weights only change when the grid is rebuilt, or when the
+        // threshold is given in terms of the thermal momentum and
+        // the temperature changes ('weightsTcold' is the temperature
+        // for which the weights were last evaluated).
+        real_t *weights = nullptr;
+        len_t *weightsFirst = nullptr, *weightsLength = nullptr;
+        real_t *weightsTcold = nullptr;
+        len_t weightsNr = 0;
+        bool weightsValid = false;
+        // Incremented whenever the weights change
+        len_t weightsRevision = 0;
+        // Column indices of all cells, and values of one matrix row
+        PetscInt *weightsColumns = nullptr;
+        PetscScalar *rowValues = nullptr;
+
+        // Location in the value array of a matrix of the element set
+        // for each cell (or -1 for cells outside of the moment), used
+        // for device assembly (see 'Matrix::BeginDeviceAssembly()').
+        // The locations depend on the structure and offset of the
+        // matrix, and on the extent of the quadrature weights.
+        struct device_slots {
+            const Matrix *mat;
+            len_t csrRevision, weightsRevision;
+            PetscInt rowOffset, colOffset;
+            // 'false' if some element is outside of the structure
+            bool complete;
+            PetscInt *slots;
+        };
+        std::vector<struct device_slots> deviceSlots;
+
+        // Evaluator shared with other moments of the same distribution
+        // function (if fused evaluation is enabled)
+        std::shared_ptr<FusedMomentEvaluator> fused;
+        len_t fusedIndex = 0;
+
+        void AllocateWeights();
+        void DeallocateWeights();
+        void DeallocateDeviceSlots();
+        const PetscInt *GetDeviceSlots(const Matrix*);
+        bool SetMatrixElementsDevice(Matrix*);
+        bool ThresholdDependsOnTemperature() const;
+        void UpdateWeights();
+
         static constexpr real_t smoothEnvelopeStepWidth = 2; // for use with P_THRESHOLD_MODE 'SMOOTH'
 
         real_t ThresholdEnvelope(len_t ir, len_t i);
@@ -5,6 +5,7 @@
 #include <unordered_map>
 #include "FVM/Equation/AdvectionDiffusionTerm.hpp"
 #include "FVM/Equation/BoundaryCondition.hpp"
+#include "FVM/Equation/DiagonalTerm.hpp"
 #include "FVM/Equation/EquationTerm.hpp"
 #include "FVM/Equation/EvaluableEquationTerm.hpp"
 #include "FVM/Equation/PredeterminedParameter.hpp"
@@ -29,6 +30,15 @@ namespace DREAM::FVM {
         AdvectionDiffusionTerm *adterm = nullptr;
         Grid *grid;
 
+        // Diagonal terms (from 'terms' and 'eval_terms') which are
+        // assembled together into a single diagonal, and the terms
+        // of 'terms' and 'eval_terms' which are assembled separately
+        // (see 'GroupTerms()')
+        std::vector<DiagonalTerm*> diagonalTerms;
+        std::vector<EquationTerm*> otherTerms;
+        std::vector<EvaluableEquationTerm*> otherEvalTerms;
+        std::vector<real_t> diagonal;
+
         // List of pointers to terms which can be identified with a
         // numeric value and returned separately...
         std::unordered_map<int_t, EquationTerm*> identifiableTerms;
@@ -36,6 +46,10 @@ namespace DREAM::FVM {
         real_t *vectorElementsSingleTerm=nullptr;
 
         void MakeIdentifiable(int_t, EquationTerm*);
+        void CheckJacobianElements(const std::string&, const len_t, const Matrix*) const;
+
+        void GroupTerms();
+        const real_t *BuildDiagonal();
 
     public:
         Operator(Grid*);
@@ -76,6 +90,8 @@ namespace DREAM::FVM {
         const real_t *GetDiffusionCoeff22(const len_t i) const { return this->adterm->GetDiffusionCoeff22(i); }
 
         bool IsEmpty() const;
+        bool HasBoundaryConditions() const { return !boundaryConditions.empty(); }
+        bool HasJacobianContribution(const len_t) const;
 
 /*
         const real_t *GetInterpolationCoeffR(const len_t i) const { return this->adterm->GetInterpolationCoeffR(i); }
@@ -109,10 +125,17 @@ namespace DREAM::FVM {
          */
         bool IsPredetermined() const { return (predetermined != nullptr); }
         bool IsEvaluable() const;
+        bool IsThreadSafe() const;
+        void GetSharedObjects(std::vector<const void*>&) const;
+        // Number of terms assembled together by the diagonal executor
+        len_t GetNFusedDiagonalTerms() const { return this->diagonalTerms.size(); }
+        bool IsJacobianConstant() const;
 
         void RebuildTerms(const real_t, const real_t, UnknownQuantityHandler*);
+        void PrintRebuildStatistics(const std::string&) const;
 
         bool SetJacobianBlock(const len_t uqtyId, const len_t derivId, Matrix*, const real_t*, bool printTerms=false);
+        std::string FindNonFiniteTerm(const len_t, const len_t, const real_t*);
         bool SetJacobianBlockBC(const len_t uqtyId, const len_t derivId, Matrix*, const real_t*, bool printTerms=false);
         void SetMatrixElements(Matrix*, real_t*);
         void SetVectorElements(real_t*, const real_t*);
@@ -21,6 +21,10 @@ namespace DREAM::FVM {
         real_t currentTime=0;
         const real_t *interpolatedData=nullptr;
 
+        // Data set externally (e.g. by a code coupled to DREAM), which
+        // replaces the prescribed time evolution when non-null
+        real_t *externalData=nullptr;
+
         enum Interpolator1D::interp_method interp_method;
 
     public:
@@ -32,9 +36,14 @@ namespace DREAM::FVM {
 
         const real_t *GetData() override { return interpolatedData; }
         void SetData(const len_t, real_t*, real_t*, bool copy=true);
+
+        real_t *GetExternalData();
+        void ReleaseExternalData();
         virtual void Rebuild(const real_t, const real_t, UnknownQuantityHandler*) override;
         virtual void SetMatrixElements(FVM::Matrix*, real_t*) override;
         virtual void SetVectorElements(real_t*, const real_t*) override;
+        // (only interpolates its own data in time)
+        virtual bool IsThreadSafe() const override { return true; }
     };
 }
 
@@ -38,6 +38,9 @@ namespace DREAM::FVM {
         virtual void Rebuild(const real_t, const real_t, UnknownQuantityHandler*) override;
         virtual bool SetJacobianBlock(const len_t uqtyId, const len_t derivId, Matrix *jac, const real_t* x) override;
         virtual bool GridRebuilt() override;
+        // Derived terms whose weights depend on the
+        // unknowns must override this and return 'false'
+        virtual bool IsJacobianConstant() const override { return true; }
 
     };
 }
@@ -37,6 +37,21 @@ namespace DREAM::FVM {
 
         bool R0IsInf;
 
+        // cos(theta) and sin(theta) in the poloidal angles most recently
+        // passed to 'EvaluateGeometricQuantitiesOnTheta()' (which are
+        // typically the same for all flux surfaces)
+        len_t ntheta_trig = 0;
+        real_t *theta_trig = nullptr, *cosTheta = nullptr, *sinTheta = nullptr;
+
+        void SetTrigonometricFunctions(const len_t, const real_t*);
+        void EvaluateGeometryKernel(
+            const real_t r, const real_t kappa, const real_t kappaPrime,
+            const real_t delta, const real_t deltaPrime,
+            const real_t Delta, const real_t DeltaPrime,
+            const real_t GOverR0, const real_t psiPrime,
+            const len_t ntheta, real_t*, real_t*, real_t*, real_t*
+        );
+
         void InterpolateInputProfileToGrid(
             const len_t, const real_t*, const real_t*,
             const len_t, const real_t*, const real_t*,
@@ -93,6 +108,8 @@ namespace DREAM::FVM {
         virtual real_t NablaR2AtTheta_f(const len_t ir, const real_t theta) override;
         virtual void EvaluateGeometricQuantities(const len_t ir, const real_t theta, real_t &B, real_t &Jacobian, real_t &ROverR0, real_t &NablaR2) override;
         virtual void EvaluateGeometricQuantities_fr(const len_t ir, const real_t theta, real_t &B, real_t &Jacobian, real_t &ROverR0, real_t &NablaR2) override;
+        virtual void EvaluateGeometricQuantitiesOnTheta(const len_t ir, const len_t ntheta, const real_t *theta, real_t *B, real_t *Jacobian, real_t *ROverR0, real_t *NablaR2) override;
+        virtual void EvaluateGeometricQuantitiesOnTheta_fr(const len_t ir, const len_t ntheta, const real_t *theta, real_t *B, real_t *Jacobian, real_t *ROverR0, real_t *NablaR2) override;
         
 		virtual void GetRThetaPhiFromCartesian(real_t*, real_t*, real_t*, real_t, real_t, real_t, real_t, real_t ) override;
 		virtual void GetGradRCartesian(real_t*, real_t , real_t, real_t ) override;
@@ -0,0 +1,40 @@
+#ifndef _DREAM_FVM_BICUBIC_SPLINE_HPP
+#define _DREAM_FVM_BICUBIC_SPLINE_HPP
+
+#include "FVM/config.h"
+
+namespace DREAM::FVM {
+    class BicubicSpline {
+    public:
+        // Location of a point in the interpolation grid
+        struct point {
+            len_t i=0, j=0;     // Indices of patch
+            real_t t=0, u=0;    // Normalized coordinates within patch
+        };
+
+    private:
+        len_t nx, ny;
+        real_t *x, *y;
+        // Inverse widths of patches
+        real_t *idx, *idy;
+        // Bicubic coefficients (16 per patch)
+        real_t *coeffs;
+
+        len_t FindInterval(const real_t, const real_t*, const len_t, const len_t) const;
+
+    public:
+        BicubicSpline(const real_t*, const len_t, const real_t*, const len_t, const real_t*);
+        ~BicubicSpline();
+
+        void Locate(const real_t, const real_t, struct point&) const;
+
+        real_t Eval(const struct point&) const;
+        void Eval(const struct point&, real_t&, real_t&, real_t&) const;
+
+        real_t Eval(const real_t, const real_t) const;
+        real_t EvalDerivX(const real_t, const real_t) const;
+        real_t EvalDerivY(const real_t, const real_t) const;
+    };
+}
+
+#endif/*_DREAM_FVM_BICUBIC_SPLINE_HPP*/
@@ -9,6 +9,28 @@
 
 namespace DREAM::FVM {
     class BounceAverager {
+    public:
+        // Fixed quadrature rule used for evaluating the bounce
+        // integral in a single grid point:
+        //   BounceIntegral = scaleFactor * sum_k weights[k]*Metric[k]*F(...)
+        struct fixed_quadrature {
+            len_t ntheta;
+            const real_t
+                *BOverBmin, *ROverR0, *NablaR2,
+                *Metric, *weights;
+            real_t xi0;
+            real_t scaleFactor;
+            // If 'true', the function must be summed over both
+            // directions of motion (xi and -xi)
+            bool isTrapped;
+        };
+
+        // Adapter for calling a callable object 'Kernel' (passed as 'par')
+        // through the function pointer interface of the bounce averages
+        template<typename Kernel>
+        static real_t KernelFunction(real_t xiOverXi0, real_t BOverBmin, real_t ROverR0, real_t NablaR2, void *par)
+        { return (*(const Kernel*)par)(xiOverXi0, BOverBmin, ROverR0, NablaR2); }
+
     private:
         // Pointer to the grid which owns this BounceAverager.
         Grid *grid;
@@ -20,6 +42,11 @@ namespace DREAM::FVM {
 
         bool geometryIsSymmetric;
 
+        // True if the magnetic field is uniform on the flux surfaces
+        // (as in cylindrical geometry). In this case, no bounce data is
+        // stored and V' and all bounce averages are evaluated in closed form.
+        bool fieldIsUniform;
+
         // Pointer to the FluxSurfaceAverager owned by grid->radialgrid.
         FluxSurfaceAverager *fluxSurfaceAverager;
 
@@ -40,8 +67,6 @@ namespace DREAM::FVM {
         bool integratePassingAdaptive = false; //...for passing orbits
 
         gsl_integration_fixed_workspace *gsl_w = nullptr;
-        gsl_integration_workspace *gsl_adaptive = nullptr;
-        gsl_root_fsolver *gsl_fsolver = nullptr;
         gsl_integration_qaws_table *qaws_table;
         int QAG_KEY = GSL_INTEG_GAUSS41;
         
@@ -70,17 +95,26 @@ namespace DREAM::FVM {
                 **theta_b2_f2 = nullptr; // on p2 flux grid
 
         real_t EvaluateBounceIntegralOverP2(len_t ir, len_t i, len_t j, fluxGridType, real_t(*F)(real_t,real_t,real_t,real_t,void*), void *par, const int_t *F_list=nullptr);
+        bool GetFixedQuadrature(len_t ir, len_t i, len_t j, fluxGridType, struct fixed_quadrature&);
+        void SetFixedQuadrature(len_t ir, len_t i, len_t j, fluxGridType, bool isTrapped, real_t xi0, real_t theta_b1, real_t theta_b2, real_t correction, struct fixed_quadrature&);
+        real_t GetBounceAverageNormalization(len_t ir, len_t i, len_t j, fluxGridType);
         void InitializeQuadrature(FluxSurfaceAverager::quadrature_method);
-        bool SetIsTrapped(bool**&, real_t**&, real_t**&, fluxGridType);
+        bool SetIsTrapped(bool**&, real_t**&, real_t**&, fluxGridType, GeometryCache*, const std::string&);
 
-        bool InitializeBounceIntegralQuantities();
+        bool InitializeBounceIntegralQuantities(GeometryCache*);
         void SetVp(real_t**&, fluxGridType);
         void SetVpsPXi(real_t**&,real_t**&,real_t**&);
+        void SetVpsUniform(real_t**&,real_t**&,real_t**&,real_t**&,real_t**&);
+        bool GetUniformGeometry(len_t ir, fluxGridType, real_t &ROverR0, real_t &NablaR2);
 
         void AllocateBounceIntegralQuantities();
 
         real_t GetXi0(len_t ir, len_t i, len_t j, fluxGridType);
         real_t GetVp(len_t ir, len_t i, len_t j, fluxGridType);
+        // True if the pitch is not resolved (Nxi = 1) on the momentum
+        // grid of the given flux grid at radius 'ir', in which case the
+        // bounce averages are also averaged over xi0
+        bool HasSinglePitchCell(len_t ir, fluxGridType fgt) const;
         real_t GetBmin(len_t ir, fluxGridType);
         real_t GetBmax(len_t ir, fluxGridType);
         
@@ -95,7 +129,60 @@ namespace DREAM::FVM {
         ~BounceAverager();
 
         real_t CalculateBounceAverage(len_t ir, len_t i, len_t j, fluxGridType fluxGridType, real_t(*F)(real_t,real_t,real_t,real_t,void*), void *par, const int_t *F_list=nullptr);
-        void Rebuild();
+
+        /**
+         * Evaluates the bounce average {F} of the function
+         *      F = F(xi/xi0, B/Bmin, R/R0, |nabla r|^2)
+         * on grid point (ir,i,j), where 'F' is any callable object (such
+         * as a lambda). When the bounce integral is evaluated with the
+         * fixed quadrature (i.e. in all but a few special grid points),
+         * 'F' is inlined into the quadrature sum instead of being called
+         * through a function pointer for every poloidal angle. In the
+         * special points, the general method above is used.
+         *
+         * F_list: Optional representation of 'F' as a list of exponents
+         *         (see 'RadialGrid::BA_PARAM_*'), which is required in
+         *         a few special cases (such as when Nxi = 1).
+         */
+        template<typename Kernel>
+        real_t CalculateBounceAverage(len_t ir, len_t i, len_t j, fluxGridType fluxGridType, const Kernel &F, const int_t *F_list=nullptr) {
+            if (fieldIsUniform && !HasSinglePitchCell(ir, fluxGridType)) {
+                real_t ROverR0, NablaR2;
+                if (!GetUniformGeometry(ir, fluxGridType, ROverR0, NablaR2))
+                    return 0;
+                return F(1, 1, ROverR0, NablaR2);
+            }
+
+            struct fixed_quadrature q;
+            if (!GetFixedQuadrature(ir, i, j, fluxGridType, q))
+                return CalculateBounceAverage(ir, i, j, fluxGridType, &KernelFunction<Kernel>, (void*)&F, F_list);
+
+            const real_t norm = GetBounceAverageNormalization(ir, i, j, fluxGridType);
+            if (norm == 0)
+                return 0;
+
+            real_t BI = 0;
+            if (q.isTrapped) {
+                for (len_t it = 0; it < q.ntheta; it++) {
+                    const real_t xiOverXi0 = MomentumGrid::evaluateXiOverXi0(q.xi0, q.BOverBmin[it]);
+                    BI += q.weights[it]*q.Metric[it] * (
+                        F( xiOverXi0, q.BOverBmin[it], q.ROverR0[it], q.NablaR2[it]) +
+                        F(-xiOverXi0, q.BOverBmin[it], q.ROverR0[it], q.NablaR2[it])
+                    );
+                }
+            } else {
+                for (len_t it = 0; it < q.ntheta; it++) {
+                    const real_t xiOverXi0 = MomentumGrid::evaluateXiOverXi0(q.xi0, q.BOverBmin[it]);
+                    BI += q.weights[it]*q.Metric[it] *
+                        F(xiOverXi0, q.BOverBmin[it], q.ROverR0[it], q.NablaR2[it]);
+                }
+            }
+
+            return norm * q.scaleFactor * BI;
+        }
+
+        void Rebuild(GeometryCache *cache=nullptr);
+        void AddToHash(GeometryCache::Hash&) const;
 
         BounceSurfaceQuantity *GetBOverBmin(){return BOverBmin;}
         BounceSurfaceQuantity *GetROverR0(){return ROverR0;}
@@ -11,12 +11,11 @@ namespace DREAM::FVM {
     protected:
         FluxSurfaceQuantity *BOverBmin;
         FluxSurfaceAverager *fluxSurfaceAverager;
-        virtual void InterpolateToBounceGrid(real_t ***&bounceData, fluxGridType fluxGridType) override;
+        virtual void InterpolateToBounceGrid(struct bouncedata &bounceData, fluxGridType fluxGridType) override;
         
         void InterpolateToFluxGrid(
-            real_t ***&bounceData, fluxGridType fluxGridType,
+            struct bouncedata &bounceData, fluxGridType fluxGridType,
             len_t ntheta_interp_passing, const real_t *theta_passing);
-        virtual void DeleteData(real_t ***&data, len_t nr, len_t np1, len_t np2, fluxGridType) override;
     public:
         BounceSurfaceMetric(Grid *grid, FluxSurfaceQuantity *Jacobian, FluxSurfaceQuantity *B, FluxSurfaceAverager *FSA);
         virtual ~BounceSurfaceMetric();
@@ -11,11 +11,29 @@ namespace DREAM::FVM {
     class BounceSurfaceQuantity {
     
     protected:
-        real_t
-            ***bounceData      = nullptr,
-            ***bounceData_fr   = nullptr,
-            ***bounceData_f1   = nullptr,
-            ***bounceData_f2   = nullptr;
+        /**
+         * Values of the quantity on the poloidal grid of every
+         * phase-space point, stored in a single contiguous array.
+         * The values for point (ir,i,j) start at element
+         * 'offset[cellOffset[ir]+j*n1[ir]+i]' of 'data' and end where
+         * the values of the next point start (trapped and passing points
+         * may use different numbers of poloidal angles, and points for
+         * which no data is stored have no elements).
+         */
+        struct bouncedata {
+            len_t nr=0;
+            len_t *n1 = nullptr;            // Number of points along p1 at each radius
+            len_t *cellOffset = nullptr;    // Index of first point at each radius (size nr+1)
+            len_t *offset = nullptr;
+            real_t *data = nullptr;
+
+            real_t *At(const len_t ir, const len_t i, const len_t j) const
+            { return data + offset[cellOffset[ir]+j*n1[ir]+i]; }
+        };
+
+        struct bouncedata
+            bounceData, bounceData_fr,
+            bounceData_f1, bounceData_f2;
 
         // Size NR+ x (NP1+ x NP2+).
         // If isTrapped, contains bounce point theta_b1 or theta_b2,
@@ -43,20 +61,25 @@ namespace DREAM::FVM {
         real_t *quad_x_ref;
 
         gsl_interp_accel *gsl_acc;
-        virtual void InterpolateToBounceGrid(real_t ***&bounceData, fluxGridType fluxGridType);
+        virtual void InterpolateToBounceGrid(struct bouncedata &bounceData, fluxGridType fluxGridType);
         
         real_t ThetaBounceAtIt(len_t ir, len_t i, len_t j, len_t it, fluxGridType fluxGridType);
 
         const real_t *GetBounceData(len_t ir, len_t i, len_t j, fluxGridType) const;
-        virtual void DeleteData(real_t ***&data, len_t nr, len_t np1, len_t np2, fluxGridType fluxGrid);
+        void DeleteData(struct bouncedata &data);
     public:
         BounceSurfaceQuantity(Grid *grid, FluxSurfaceQuantity *fluxSurfaceQuantity);
         virtual ~BounceSurfaceQuantity();
 
 
+        size_t GetMemoryUsage() const;
+
         void DeallocateData();
-        void AllocateData();
-        void AllocateSingle(real_t ***&bounceData, len_t nr, len_t n1, len_t n2);
+        void AllocateData(len_t ntheta_trapped, len_t ntheta_passing=0);
+        void AllocateSingle(
+            struct bouncedata &bounceData, len_t nr,
+            fluxGridType, len_t ntheta_trapped, len_t ntheta_passing
+        );
         
         virtual const real_t *GetData(len_t ir, len_t i, len_t j, fluxGridType) const;
         virtual const real_t evaluateAtTheta(len_t ir, real_t theta, fluxGridType) const;
@@ -24,6 +24,7 @@ namespace DREAM::FVM {
 
         virtual bool NeedsRebuild(const real_t) const override { return (!isBuilt); }
         virtual bool Rebuild(const real_t, RadialGrid*) override;
+        virtual bool IsFieldUniform() const override { return true; }
 
         virtual void GetRThetaPhiFromCartesian(real_t*, real_t*, real_t*, real_t, real_t, real_t, real_t, real_t) override;
         virtual void GetGradRCartesian(real_t*, real_t, real_t, real_t);
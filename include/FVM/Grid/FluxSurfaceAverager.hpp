@@ -6,6 +6,7 @@
 namespace DREAM::FVM { class FluxSurfaceAverager; }
 
 #include "FVM/Grid/FluxSurfaceQuantity.hpp"
+#include "FVM/Grid/GeometryCache.hpp"
 #include "gsl/gsl_integration.h"
 #include "gsl/gsl_roots.h"
 
@@ -41,6 +42,16 @@ namespace DREAM::FVM {
             real_t Bmin; real_t(*F_ref)(real_t,real_t,real_t,real_t,void*); real_t(*F_eval)(real_t,real_t,real_t,real_t,void*); void *F_ref_par; int_t *Flist_eval; 
             FluxSurfaceAverager *fsAvg; bool integrateQAWS;
         };
+
+        // GSL workspaces used by a single thread when evaluating
+        // adaptive integrals and finding bounce points
+        struct thread_workspace {
+            gsl_integration_workspace *adaptive, *adaptive_outer;
+            gsl_root_fsolver *fsolver;
+
+            thread_workspace();
+            ~thread_workspace();
+        };
         static real_t BA_FUNC_PASSING(real_t xiOverXi0, real_t BOverBmin, real_t ROverR0, real_t NablaR2, void* par){
             BounceIntegralParams *params = (BounceIntegralParams*)par;
             return params->F_ref(xiOverXi0, BOverBmin, ROverR0, NablaR2, params->F_ref_par);
@@ -59,6 +70,11 @@ namespace DREAM::FVM {
 
         bool geometryIsSymmetric;
 
+        // True if the magnetic field is uniform on the flux surfaces
+        // (see 'RadialGridGenerator::IsFieldUniform()'), in which case
+        // flux surface averages are evaluated in closed form
+        bool fieldIsUniform = false;
+
         /**
          * Is true if FluSurfaceAverager is constructed with 
          * QUAD_ADAPTIVE. Overrides a bunch of stuff and evaluates
@@ -66,6 +82,9 @@ namespace DREAM::FVM {
          */ 
         bool integrateAdaptive = false;
 
+        // Method used to interpolate magnetic data to the theta grid
+        interp_method interpMethod;
+
         // Number of radial grid points on distribution grid
         len_t nr;
 
@@ -76,10 +95,10 @@ namespace DREAM::FVM {
             *NablaR2 = nullptr;
         
         gsl_integration_fixed_workspace *gsl_w = nullptr;
-        gsl_integration_workspace *gsl_adaptive;
-        gsl_integration_workspace *gsl_adaptive_outer;
-        gsl_root_fsolver *gsl_fsolver;
         gsl_integration_qaws_table *qaws_table;
+        // Gauss-Legendre rules used for averaging bounce integrals
+        // over pitch cells near the trapped-passing boundary
+        gsl_integration_glfixed_table *xiCellTable_lo, *xiCellTable_hi;
         int QAG_KEY = GSL_INTEG_GAUSS41;
 
         len_t ntheta_interp; // number of poloidal grid points
@@ -88,6 +107,14 @@ namespace DREAM::FVM {
             *weights = nullptr, // corresponding quadrature weights
             theta_max;
 
+        // Products 2*pi*w_i*J(theta_i) of the quadrature weights and
+        // the spatial jacobian on all flux surfaces (size nr*ntheta_interp
+        // and (nr+1)*ntheta_interp), so that the flux surface integrals
+        // evaluated with the fixed quadrature are simple dot products.
+        real_t
+            *weightedJacobian   = nullptr,
+            *weightedJacobian_f = nullptr;
+
         // poloidal angles of minimum and maximum magnetic field strength.
         real_t 
             *theta_Bmin = nullptr,
@@ -97,6 +124,9 @@ namespace DREAM::FVM {
 
         void InitializeQuadrature(quadrature_method);
         void DeallocateQuadrature();
+        void InterpolateMagneticDataToTheta();
+        void SetWeightedJacobian();
+        void DeallocateWeightedJacobian();
 
         void InitializeReferenceData(
             real_t *theta_Bmin, real_t *theta_Bmin_f,
@@ -109,6 +139,8 @@ namespace DREAM::FVM {
         real_t GetVpVol(len_t ir, fluxGridType);
 
     static real_t evaluatePXiBounceIntegralAtXi(real_t,void*);
+    static real_t evaluateClusteredIntegrand(real_t,void*);
+    real_t IntegrateBounceIntegralOverXi(gsl_function*, real_t xi_l, real_t xi_u, real_t xiT, bool singular);
 
     public:
         FluxSurfaceAverager(
@@ -117,10 +149,15 @@ namespace DREAM::FVM {
         );
         ~FluxSurfaceAverager();
 
-        void Rebuild();
+        void Rebuild(GeometryCache *cache=nullptr);
+        void AddToHash(GeometryCache::Hash&) const;
+
+        static struct thread_workspace &GetWorkspace();
 
         real_t EvaluateFluxSurfaceIntegral(len_t ir, fluxGridType, real_t(*F)(real_t,real_t,real_t,void*), void *par=nullptr, const int_t *F_list=nullptr);
         real_t CalculateFluxSurfaceAverage(len_t ir, fluxGridType, real_t(*F)(real_t,real_t,real_t,void*), void *par=nullptr, const int_t *F_list=nullptr);
+        void EvaluateFluxSurfaceIntegrals(len_t ir, fluxGridType, const len_t nF, const int_t *const* F_lists, real_t *I);
+        void CalculateFluxSurfaceAverages(len_t ir, fluxGridType, const len_t nF, const int_t *const* F_lists, real_t *FSA);
         real_t EvaluatePXiBounceIntegralAtP(len_t ir, real_t xi0, fluxGridType, real_t(*F)(real_t,real_t,real_t,real_t,void*), void *par=nullptr, const int_t *F_list=nullptr);
         real_t CalculatePXiBounceAverageAtP(len_t ir, real_t xi0, fluxGridType, real_t(*F)(real_t,real_t,real_t,real_t,void*), void *par=nullptr, const int_t *F_list=nullptr);
 
@@ -184,6 +221,7 @@ namespace DREAM::FVM {
 
         bool isGeometrySymmetric(){return geometryIsSymmetric;}
         bool isIntegrationAdaptive(){return integrateAdaptive;}
+        bool isFieldUniform(){return fieldIsUniform;}
 
 
         static void FindThetas(real_t theta_Bmin, real_t theta_Bmax, real_t *theta1, real_t *theta2, gsl_function, gsl_root_fsolver*, bool isSymmetric=false);
@@ -42,6 +42,7 @@ namespace DREAM::FVM {
         const real_t evaluateAtTheta(len_t ir, real_t theta, fluxGridType) const;
         
         void InterpolateMagneticDataToTheta(real_t *theta, len_t ntheta_interp);
+        void SetInterpolatedData(real_t **data, real_t **data_fr);
 
         real_t *const* GetData() const {return quantityData;}
         real_t *const* GetData_fr() const {return quantityData_fr;}
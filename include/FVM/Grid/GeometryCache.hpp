@@ -0,0 +1,68 @@
+#ifndef _DREAM_FVM_GEOMETRY_CACHE_HPP
+#define _DREAM_FVM_GEOMETRY_CACHE_HPP
+
+#include <cstdint>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+#include "FVM/config.h"
+
+namespace DREAM::FVM {
+    class GeometryCache {
+    public:
+        /**
+         * 64-bit FNV-1a hash used to build the key
+         * identifying a geometry.
+         */
+        class Hash {
+        private:
+            uint64_t h = 14695981039346656037ull;
+        public:
+            void Add(const void*, const size_t);
+            void Add(const std::string& s) { Add(s.c_str(), s.size()); }
+            template<typename T>
+            void Add(const T v) { Add(&v, sizeof(T)); }
+            template<typename T>
+            void Add(const T *v, const len_t n) { if (v != nullptr) Add((const void*)v, n*sizeof(T)); }
+
+            uint64_t Get() const { return h; }
+        };
+
+    private:
+        std::string filename;
+        uint64_t key;
+
+        // Memory-mapped cache file (if loaded)
+        void *mapping = nullptr;
+        size_t mappingSize = 0;
+        std::map<std::string, std::pair<const real_t*, len_t>> entries;
+
+        // Data to write to the cache file
+        std::map<std::string, std::vector<real_t>> pending;
+
+        const real_t *Find(const std::string&, const len_t) const;
+
+    public:
+        GeometryCache(const std::string& directory, const uint64_t key);
+        ~GeometryCache();
+
+        bool IsLoaded() const { return (this->mapping != nullptr); }
+        const std::string& GetFilename() const { return this->filename; }
+
+        bool Load();
+        void Save();
+
+        bool Get(const std::string&, real_t*&, const len_t);
+        bool Get(const std::string&, real_t**&, const len_t, const len_t);
+        bool Get(const std::string&, bool**&, const len_t, const len_t);
+        bool Fill(const std::string&, real_t**, const len_t, const len_t);
+        bool Fill(const std::string&, bool**, const len_t, const len_t);
+
+        void Put(const std::string&, const real_t*, const len_t);
+        void Put(const std::string&, real_t**, const len_t, const len_t);
+        void Put(const std::string&, bool**, const len_t, const len_t);
+    };
+}
+
+#endif/*_DREAM_FVM_GEOMETRY_CACHE_HPP*/
@@ -5,9 +5,13 @@ namespace DREAM::FVM { class Grid; }
 
 #include "FVM/config.h"
 #include "FVM/Grid/MomentumGrid.hpp"
+#include "FVM/Grid/MomentumGridMapping.hpp"
 #include "FVM/Grid/RadialGrid.hpp"
 #include "FVM/Grid/BounceAverager.hpp"
+#include <cmath>
 #include <limits>
+#include <string>
+#include <vector>
 
 namespace DREAM::FVM {
     class Grid {
@@ -65,9 +69,20 @@ namespace DREAM::FVM {
         void DeallocateVprime();
         void DeallocateBounceParameters();
 
-        void RebuildBounceAveragedQuantities();
-        void SetBounceAverage(real_t **&BA_quantity, fluxGridType fluxGridType, real_t(*F)(real_t,real_t,real_t,real_t,void*), void *par=nullptr, const int_t *Flist=nullptr);
-        void SetBounceAveragePXi(real_t **&BA_quantity, fluxGridType fluxGridType, real_t(*F)(real_t,real_t,real_t,real_t,void*), void *par=nullptr, const int_t *Flist=nullptr);
+        // Directory in which geometry cache files are stored
+        // (if empty, the geometry cache is disabled)
+        std::string geometryCacheDirectory;
+
+        // Revision of the radial grid jacobians for which the
+        // bounce averages of this grid were last calculated
+        len_t rgridRevision = 0;
+
+        GeometryCache *CreateGeometryCache();
+        void RebuildBounceAveragedQuantities(GeometryCache *cache=nullptr);
+        template<typename Kernel>
+        void SetBounceAverage(real_t **&BA_quantity, fluxGridType fluxGridType, const Kernel &F, const int_t *Flist=nullptr);
+        template<typename Kernel>
+        void SetBounceAveragePXi(real_t **&BA_quantity, fluxGridType fluxGridType, const Kernel &F, const int_t *Flist=nullptr);
         void DeallocateBAvg();
         void InitializeBAvg(
             real_t **xiAvg_fr, real_t **xiAvg_f1, real_t **xiAvg_f2,
@@ -75,6 +90,21 @@ namespace DREAM::FVM {
             real_t **B3_f1, real_t **B3_f2,
             real_t **xi2B2_f1, real_t **xi2B2_f2);
 
+        // Index of the first cell at each radius (size nr+1)
+        len_t *cellOffsets = nullptr;
+
+        // Distinct momentum grids used at the different radii, and
+        // the mappings between them (with 'gridMappings[a*n+b]' mapping
+        // from 'distinctGrids[a]' to 'distinctGrids[b]', and 'nullptr'
+        // on the diagonal)
+        std::vector<MomentumGrid*> distinctGrids;
+        std::vector<MomentumGridMapping*> gridMappings;
+        len_t maxMomentumGridOverlap = 1;
+
+        void Initialize(RadialGrid*, FluxSurfaceAverager::quadrature_method, len_t);
+        void RebuildMomentumGridMappings();
+        void DeallocateMomentumGridMappings();
+
         const real_t realeps = std::numeric_limits<real_t>::epsilon();    
     protected:
         BounceAverager *bounceAverager;
@@ -84,19 +114,34 @@ namespace DREAM::FVM {
     public:
         Grid(RadialGrid*, MomentumGrid*, const real_t t0=0, 
             FluxSurfaceAverager::quadrature_method qm = FluxSurfaceAverager::QUAD_FIXED_CHEBYSHEV, len_t ntheta = 0);
+        Grid(RadialGrid*, MomentumGrid**, const real_t t0=0, 
+            FluxSurfaceAverager::quadrature_method qm = FluxSurfaceAverager::QUAD_FIXED_CHEBYSHEV, len_t ntheta = 0);
         ~Grid();
 
         bool Rebuild(const real_t);
         void RebuildJacobians();
 
+        void SetGeometryCacheDirectory(const std::string& dir) { this->geometryCacheDirectory = dir; }
+
         real_t Integral(const real_t*) const;
         real_t *IntegralMomentum(const real_t*, real_t *I=nullptr) const;
         real_t IntegralMomentumAtRadius(const len_t, const real_t*) const;
 
         // Returns pointer to the momentum grid with the specified index
         MomentumGrid *GetMomentumGrid(const len_t i) const { return this->momentumGrids[i]; }
+        // Returns pointer to the momentum grid used on radial flux grid
+        // point 'ir'. The inner face of every cell uses the momentum grid
+        // of the cell, and the outermost face uses that of the last cell.
+        MomentumGrid *GetMomentumGrid_fr(const len_t ir) const
+            { return this->momentumGrids[ir < GetNr() ? ir : GetNr()-1]; }
+        MomentumGrid *GetMomentumGrid(const len_t ir, fluxGridType fgt) const
+            { return (fgt==FLUXGRIDTYPE_RADIAL ? GetMomentumGrid_fr(ir) : this->momentumGrids[ir]); }
         RadialGrid *GetRadialGrid() const { return this->rgrid; }
 
+        bool HasRadiallyUniformMomentumGrid() const;
+        const MomentumGridMapping *GetMomentumGridMapping(const MomentumGrid*, const MomentumGrid*) const;
+        len_t GetMaxMomentumGridOverlap() const { return this->maxMomentumGridOverlap; }
+
         /**
          * Grid size getters
          */
@@ -109,6 +154,19 @@ namespace DREAM::FVM {
             { return this->momentumGrids[ir]->GetNp1(); }
         const len_t GetNp2(const len_t ir) const 
             { return this->momentumGrids[ir]->GetNp2(); }
+        const len_t GetNp1_fr(const len_t ir) const 
+            { return GetMomentumGrid_fr(ir)->GetNp1(); }
+        const len_t GetNp2_fr(const len_t ir) const 
+            { return GetMomentumGrid_fr(ir)->GetNp2(); }
+        // Number of points of the given flux grid at radial index 'ir'
+        const len_t GetNp1(const len_t ir, fluxGridType fgt) const 
+            { return GetMomentumGrid(ir, fgt)->GetNp1() + (fgt==FLUXGRIDTYPE_P1); }
+        const len_t GetNp2(const len_t ir, fluxGridType fgt) const 
+            { return GetMomentumGrid(ir, fgt)->GetNp2() + (fgt==FLUXGRIDTYPE_P2); }
+        // Index of the first cell at radius 'ir' in a vector of
+        // distribution function values (such as an unknown quantity)
+        const len_t GetCellOffset(const len_t ir) const 
+            { return this->cellOffsets[ir]; }
 
         /**
          * Getters of bounce-averaged metric
@@ -120,7 +178,7 @@ namespace DREAM::FVM {
         real_t *const* GetVp_fr() const { return this->Vp_fr; }
         const real_t  *GetVp_fr(const len_t ir) const { return this->Vp_fr[ir]; }
         const real_t GetVp_fr(const len_t ir, const len_t i, const len_t j) const 
-            { return Vp_fr[ir][GetNp1(0)*j+i]; }
+            { return Vp_fr[ir][GetNp1_fr(ir)*j+i]; }
         real_t *const* GetVp_f1() const { return this->Vp_f1; }
         const real_t  *GetVp_f1(const len_t ir) const { return this->Vp_f1[ir]; }
         const real_t GetVp_f1(const len_t ir, const len_t i, const len_t j) const 
@@ -145,17 +203,17 @@ namespace DREAM::FVM {
         
         /**
          * Getters of isTrapped: true if phase-space point represents a trapped orbit
+         * (the isTrapped arrays are not allocated if there are no trapped orbits)
          */
         bool HasTrapped() {return hasTrapped;}
         const bool IsTrapped(const len_t ir, const len_t i, const len_t j) const 
-            {return isTrapped[ir][GetNp1(ir)*j+i];}
-        // XXX: Assumes the same momentum grid at all radii 
+            {return hasTrapped && isTrapped[ir][GetNp1(ir)*j+i];}
         const bool IsTrapped_fr(const len_t ir, const len_t i, const len_t j) const 
-            {return isTrapped_fr[ir][GetNp1(0)*j+i];}
+            {return hasTrapped && isTrapped_fr[ir][GetNp1_fr(ir)*j+i];}
         const bool IsTrapped_f1(const len_t ir, const len_t i, const len_t j) const 
-            {return isTrapped_f1[ir][(GetNp1(ir)+1)*j+i];}
+            {return hasTrapped && isTrapped_f1[ir][(GetNp1(ir)+1)*j+i];}
         const bool IsTrapped_f2(const len_t ir, const len_t i, const len_t j) const 
-            {return isTrapped_f2[ir][GetNp1(ir)*j+i];}
+            {return hasTrapped && isTrapped_f2[ir][GetNp1(ir)*j+i];}
 
         /**
          * Returns true if the cell with index radial index ir and xi0 index j
@@ -168,18 +226,25 @@ namespace DREAM::FVM {
         /**
          * Returns true if the radial flux into this cell should be added
          * into the cell containing -xi0 instead, because of trapping.
+         * (if the outer radial face uses a different momentum grid, the
+         * pitch of the cell is compared to the trapped-passing boundary
+         * on the face, since the cell then has no counterpart there)
          */
-        const bool IsNegativePitchTrappedIgnorableRadialFluxCell(const len_t ir, const len_t j) const 
-        { return (IsTrapped_fr(ir+1,0,j) && momentumGrids[ir]->GetP2_f(j+1) <= 100*realeps) || IsNegativePitchTrappedIgnorableCell(ir,j);}
+        const bool IsNegativePitchTrappedIgnorableRadialFluxCell(const len_t ir, const len_t j) const {
+            const MomentumGrid *mg = momentumGrids[ir];
+            const bool trapped_fr = (GetMomentumGrid_fr(ir+1) == mg) ?
+                IsTrapped_fr(ir+1,0,j) :
+                (hasTrapped && std::abs(mg->GetP2(j)) < rgrid->GetXi0TrappedBoundary_fr(ir+1));
+            return (trapped_fr && mg->GetP2_f(j+1) <= 100*realeps) || IsNegativePitchTrappedIgnorableCell(ir,j);
+        }
 
         /**
          * Getters of lower poloidal-angle bounce points
          */
         const real_t GetThetaBounce1(const len_t ir, const len_t i, const len_t j) const
             {return theta_b1[ir][GetNp1(ir)*j+i];}
-        // XXX: Assumes the same momentum grid at all radii 
         const real_t GetThetaBounce1_fr(const len_t ir, const len_t i, const len_t j) const
-            {return theta_b1_fr[ir][GetNp1(0)*j+i];}
+            {return theta_b1_fr[ir][GetNp1_fr(ir)*j+i];}
         const real_t GetThetaBounce1_f1(const len_t ir, const len_t i, const len_t j) const
             {return theta_b1_f1[ir][(GetNp1(ir)+1)*j+i];}
         const real_t GetThetaBounce1_f2(const len_t ir, const len_t i, const len_t j) const
@@ -190,9 +255,8 @@ namespace DREAM::FVM {
          */
         const real_t GetThetaBounce2(const len_t ir, const len_t i, const len_t j) const
             {return theta_b2[ir][GetNp1(ir)*j+i];}
-        // XXX: Assumes the same momentum grid at all radii 
         const real_t GetThetaBounce2_fr(const len_t ir, const len_t i, const len_t j) const
-            {return theta_b2_fr[ir][GetNp1(0)*j+i];}
+            {return theta_b2_fr[ir][GetNp1_fr(ir)*j+i];}
         const real_t GetThetaBounce2_f1(const len_t ir, const len_t i, const len_t j) const
             {return theta_b2_f1[ir][(GetNp1(ir)+1)*j+i];}
         const real_t GetThetaBounce2_f2(const len_t ir, const len_t i, const len_t j) const
@@ -232,7 +296,7 @@ namespace DREAM::FVM {
             else
                 return avalancheDeltaHatNegativePitch[ir][pind];
     }
-        void CalculateAvalancheDeltaHat();
+        void CalculateAvalancheDeltaHat(GeometryCache *cache=nullptr);
 
         real_t CalculateBounceAverage(len_t ir, len_t i, len_t j, fluxGridType fluxGridType, real_t(*F)(real_t,real_t,real_t,real_t,void*), void *par=nullptr, const int_t *Flist=nullptr);
         real_t CalculateFluxSurfaceAverage(len_t ir, fluxGridType fluxGridType, real_t(*F)(real_t,real_t,real_t,void*), void *par=nullptr, const int_t *Flist=nullptr);
@@ -245,4 +309,6 @@ namespace DREAM::FVM {
     };
 }
 
+#include "FVM/Grid/Grid.tcc"
+
 #endif/*_DREAM_FVM_GRID_HPP*/
@@ -0,0 +1,75 @@
+/**
+ * Implementation of the template methods of the 'Grid' class.
+ */
+
+namespace DREAM::FVM {
+
+/**
+ * Helper method to set one bounce averaged coefficient on the entire grid.
+ *
+ * BA_quantity: On return, contains the bounce average in every grid point.
+ * F:           Function to bounce average, F(xi/xi0, B/Bmin, R/R0, |nabla r|^2),
+ *              given as any callable object (see
+ *              'BounceAverager::CalculateBounceAverage()').
+ * Flist:       Optional representation of 'F' as a list of exponents.
+ */
+template<typename Kernel>
+void Grid::SetBounceAverage(real_t **&BA_quantity, fluxGridType fluxGridType, const Kernel &F, const int_t *Flist){
+    len_t nr = GetNr() + (fluxGridType==FLUXGRIDTYPE_RADIAL);
+    len_t np1, np2;
+    BA_quantity = new real_t*[nr];
+    for(len_t ir=0; ir<nr; ir++){
+        MomentumGrid *mg = GetMomentumGrid(ir, fluxGridType);
+        np1 = mg->GetNp1() + (fluxGridType==FLUXGRIDTYPE_P1);
+        np2 = mg->GetNp2() + (fluxGridType==FLUXGRIDTYPE_P2);
+        bool pIsZero; // set to 1 if p(0,0)=0 since metric is singular
+        if(fluxGridType==FLUXGRIDTYPE_P1)
+            pIsZero = (mg->GetP_f1(0,0)==0);
+        else if(fluxGridType==FLUXGRIDTYPE_P2)
+            pIsZero = (mg->GetP_f2(0,0)==0);
+        else
+            pIsZero = (mg->GetP(0,0)==0);
+
+        BA_quantity[ir] = new real_t[np1*np2];
+        for(len_t j=0;j<np2;j++){
+            if(pIsZero){
+                real_t xi0;
+                if(fluxGridType==FLUXGRIDTYPE_P1)
+                    xi0 = mg->GetXi0_f1(0,j);
+                else if(fluxGridType==FLUXGRIDTYPE_P2)
+                    xi0 = mg->GetXi0_f2(0,j);
+                else
+                    xi0 = mg->GetXi0(0,j);
+                BA_quantity[ir][j*np1] = this->rgrid->CalculatePXiBounceAverageAtP(
+                    ir,xi0,fluxGridType,&BounceAverager::KernelFunction<Kernel>,(void*)&F,Flist
+                );
+            }
+            for(len_t i=pIsZero;i<np1;i++)
+                BA_quantity[ir][j*np1+i] = bounceAverager->CalculateBounceAverage(ir,i,j,fluxGridType,F,Flist);
+        }
+    }
+}
+
+/**
+ * Optimized helper method to set one bounce averaged coefficient on the entire grid,
+ * assuming that the grid uses p-xi coordinates and the bounce average is independent
+ * of p
+ */
+template<typename Kernel>
+void Grid::SetBounceAveragePXi(real_t **&BA_quantity, fluxGridType fluxGridType, const Kernel &F, const int_t *Flist){
+    len_t nr = GetNr() + (fluxGridType==FLUXGRIDTYPE_RADIAL);
+    len_t np1, np2;
+    BA_quantity = new real_t*[nr];
+    for(len_t ir=0; ir<nr; ir++){
+        np1 = GetNp1(ir, fluxGridType);
+        np2 = GetNp2(ir, fluxGridType);
+        BA_quantity[ir] = new real_t[np1*np2];
+        for(len_t j=0;j<np2;j++){
+            real_t BA = bounceAverager->CalculateBounceAverage(ir,0,j,fluxGridType,F,Flist);
+            for(len_t i=0;i<np1;i++)
+                BA_quantity[ir][j*np1+i] = BA;
+        }
+    }
+}
+
+}
@@ -0,0 +1,84 @@
+#ifndef _DREAM_FVM_MOMENTUM_GRID_MAPPING_HPP
+#define _DREAM_FVM_MOMENTUM_GRID_MAPPING_HPP
+
+namespace DREAM::FVM { class MomentumGridMapping; }
+
+#include "FVM/config.h"
+#include "FVM/Grid/MomentumGrid.hpp"
+
+namespace DREAM::FVM {
+    /**
+     * Conservative mapping between two p-xi momentum grids covering the
+     * same momentum space (i.e. with the same pmin, pmax and xi in [-1,1]),
+     * used for coupling radii with different momentum grids.
+     *
+     * The overlap between the cells of the grids 'from' and 'to' is a
+     * tensor product of the overlaps in p (weighted by p^2, i.e. by the
+     * momentum-space volume) and in xi. For every cell (i,j) of 'to', the
+     * weight W(i,j; a,b) is the fraction of the volume of (i,j) covered
+     * by cell (a,b) of 'from', so that
+     *
+     *   sum_{a,b} W(i,j; a,b) = 1.
+     *
+     * These weights are used for projecting a function defined on 'from'
+     * onto 'to' (as a volume average). Conversely, R(i,j; a,b) is the
+     * fraction of the volume of cell (a,b) of 'from' covered by cell (i,j)
+     * of 'to', so that the sum of R over all cells (i,j) overlapping (a,b)
+     * is one. These weights are used for distributing a quantity (such as
+     * a particle flux) given in the cells of 'from' over the cells of 'to',
+     * in which case the quantity is conserved exactly.
+     */
+    class MomentumGridMapping {
+    private:
+        const MomentumGrid *from, *to;
+
+        // Cells 'index1[offset1[i]]' to 'index1[offset1[i+1]-1]' along
+        // p1 of 'from' overlap cell 'i' along p1 of 'to', and cover the
+        // fractions 'weight1[offset1[i]...]' of its volume, while cell 'i'
+        // covers the fractions 'rweight1[offset1[i]...]' of the volumes
+        // of the overlapping cells (and similarly along p2)
+        len_t *offset1 = nullptr, *index1 = nullptr;
+        len_t *offset2 = nullptr, *index2 = nullptr;
+        real_t *weight1 = nullptr, *weight2 = nullptr;
+        real_t *rweight1 = nullptr, *rweight2 = nullptr;
+
+        len_t maxOverlap = 0;
+
+        static void SetOverlap(
+            const len_t nTo, const real_t *xTo, const len_t nFrom,
+            const real_t *xFrom, real_t (*measure)(const real_t, const real_t),
+            len_t *&offset, len_t *&index, real_t *&weight, real_t *&rweight,
+            len_t &maxOverlap
+        );
+
+    public:
+        MomentumGridMapping(const MomentumGrid *from, const MomentumGrid *to);
+        ~MomentumGridMapping();
+
+        const MomentumGrid *GetFrom() const { return this->from; }
+        const MomentumGrid *GetTo() const { return this->to; }
+
+        // Maximum number of cells of 'from' overlapping a single cell of 'to'
+        len_t GetMaxOverlap() const { return this->maxOverlap; }
+
+        /**
+         * Call 'f(a, b, W, R)' for every cell (a,b) of 'from' which
+         * overlaps cell (i,j) of 'to', with the weights W = W(i,j; a,b)
+         * and R = R(i,j; a,b).
+         */
+        template<typename F>
+        void ForEachOverlap(const len_t i, const len_t j, const F& f) const {
+            for (len_t kb = offset2[j]; kb < offset2[j+1]; kb++)
+                for (len_t ka = offset1[i]; ka < offset1[i+1]; ka++)
+                    f(
+                        index1[ka], index2[kb],
+                        weight1[ka]*weight2[kb], rweight1[ka]*rweight2[kb]
+                    );
+        }
+
+        real_t Interpolate(const real_t *fFrom, const len_t i, const len_t j) const;
+        void Interpolate(const real_t *fFrom, real_t *fTo) const;
+    };
+}
+
+#endif/*_DREAM_FVM_MOMENTUM_GRID_MAPPING_HPP*/
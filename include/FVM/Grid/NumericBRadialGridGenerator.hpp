@@ -2,9 +2,10 @@
 #define _DREAM_FVM_NUMERIC_B_RADIAL_GRID_GENERATOR_HPP
 
 #include <gsl/gsl_interp.h>
-#include <gsl/gsl_spline2d.h>
+#include <gsl/gsl_spline.h>
 #include <string>
 #include <softlib/SFile.h>
+#include "FVM/Grid/BicubicSpline.hpp"
 #include "FVM/Grid/RadialGridGenerator.hpp"
 
 namespace DREAM::FVM {
@@ -34,11 +35,14 @@ namespace DREAM::FVM {
         std::string name;
 
         // Interpolation objects for interpolating in input data
-        gsl_spline *spline_psi;
-        gsl_spline2d
-            *spline_R, *spline_Z, *spline_BR, *spline_BZ, *spline_Bphi,
-            *spline_B;
-        gsl_interp_accel *acc_r, *acc_theta;
+        gsl_spline *spline_psi = nullptr;
+        BicubicSpline
+            *spline_R = nullptr, *spline_Z = nullptr,
+            *spline_Bphi = nullptr, *spline_B = nullptr;
+        gsl_interp_accel *acc_r;
+
+        gsl_interp_accel *AccR() const;
+        void DeallocateSplines();
 
 		real_t *addR0DataPoint(const real_t*, const real_t*, const len_t, const len_t, real_t c=std::numeric_limits<real_t>::quiet_NaN());
 		real_t *addThetaDataPoint(const real_t*, const len_t, const len_t);
@@ -65,6 +69,7 @@ namespace DREAM::FVM {
 
         virtual bool NeedsRebuild(const real_t) const override { return (!isBuilt); }
         virtual bool Rebuild(const real_t, RadialGrid*) override;
+        virtual bool HashGeometry(GeometryCache::Hash&) override;
 
 		real_t EvalB(const real_t, const real_t);
         
@@ -107,6 +112,20 @@ namespace DREAM::FVM {
             real_t &Jacobian, real_t &ROverR0, real_t &NablaR2
         );
 
+        virtual void EvaluateGeometricQuantitiesOnTheta(
+            const len_t ir, const len_t ntheta, const real_t *theta, real_t *B,
+            real_t *Jacobian, real_t *ROverR0, real_t *NablaR2
+        ) override { EvaluateGeometricQuantitiesOnTheta(r[ir], ntheta, theta, B, Jacobian, ROverR0, NablaR2); }
+        virtual void EvaluateGeometricQuantitiesOnTheta_fr(
+            const len_t ir, const len_t ntheta, const real_t *theta, real_t *B,
+            real_t *Jacobian, real_t *ROverR0, real_t *NablaR2
+        ) override { EvaluateGeometricQuantitiesOnTheta(r_f[ir], ntheta, theta, B, Jacobian, ROverR0, NablaR2); }
+
+        void EvaluateGeometricQuantitiesOnTheta(
+            const real_t r, const len_t ntheta, const real_t *theta, real_t *B,
+            real_t *Jacobian, real_t *ROverR0, real_t *NablaR2
+        );
+
         // Debugging method
         void __SaveB(const char*);
     };
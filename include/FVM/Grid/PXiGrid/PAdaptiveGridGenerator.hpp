@@ -0,0 +1,32 @@
+#ifndef _DREAM_FVM_P_XI_GRID_P_ADAPTIVE_GRID_GENERATOR_HPP
+#define _DREAM_FVM_P_XI_GRID_P_ADAPTIVE_GRID_GENERATOR_HPP
+
+#include "FVM/FVMException.hpp"
+#include "FVM/Grid/MomentumGrid.hpp"
+#include "FVM/Grid/RadialGrid.hpp"
+#include "FVM/Grid/PXiGrid/PGridGenerator.hpp"
+
+namespace DREAM::FVM::PXiGrid {
+    class PAdaptiveGridGenerator : public PGridGenerator {
+    private:
+        len_t np;
+        real_t pMin, pMax;
+        // Reference temperature (normalized to mc^2)
+        real_t Theta;
+        // Ratio between the largest and smallest cell on the grid
+        real_t dpRatio;
+
+        bool initialized = false;
+
+        real_t EvaluateGradient(const real_t) const;
+    public:
+        PAdaptiveGridGenerator(const len_t, const real_t, const real_t, const real_t, const real_t);
+
+        virtual len_t GetNp() const { return this->np; }
+
+        virtual bool NeedsRebuild(const real_t, const bool) { return (!initialized); }
+        virtual bool Rebuild(const real_t, const len_t, MomentumGrid*, const RadialGrid*);
+    };
+}
+
+#endif/*_DREAM_FVM_P_XI_GRID_P_ADAPTIVE_GRID_GENERATOR_HPP*/
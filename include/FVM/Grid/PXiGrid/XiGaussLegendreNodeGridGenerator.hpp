@@ -0,0 +1,26 @@
+#ifndef _DREAM_FVM_P_XI_GRID_XI_GAUSS_LEGENDRE_NODE_GRID_GENERATOR_HPP
+#define _DREAM_FVM_P_XI_GRID_XI_GAUSS_LEGENDRE_NODE_GRID_GENERATOR_HPP
+
+#include "FVM/Grid/MomentumGrid.hpp"
+#include "FVM/Grid/RadialGrid.hpp"
+#include "FVM/Grid/PXiGrid/XiGridGenerator.hpp"
+
+namespace DREAM::FVM::PXiGrid {
+    class XiGaussLegendreNodeGridGenerator : public XiGridGenerator {
+    private:
+        len_t nxi;
+
+        bool initialized = false;
+    public:
+        XiGaussLegendreNodeGridGenerator(const len_t);
+
+        len_t GetNxi() const { return this->nxi; }
+
+        static void GetGaussLegendreNodes(const len_t, real_t*, real_t*);
+
+        virtual bool NeedsRebuild(const real_t, const bool) { return (!initialized); }
+        virtual bool Rebuild(const real_t, const len_t, MomentumGrid*, const RadialGrid*);
+    };
+}
+
+#endif/*_DREAM_FVM_P_XI_GRID_XI_GAUSS_LEGENDRE_NODE_GRID_GENERATOR_HPP*/
@@ -140,8 +140,9 @@ namespace DREAM::FVM {
             delete [] xi0TrappedBoundary_f;
         }
         void SetFluxSurfaceAverage(real_t *&FSA_quantity, real_t *&FSA_quantity_f, real_t(*F)(real_t,real_t,real_t,void*), void *par=nullptr, const int_t *Flist = nullptr);
+        void SetFluxSurfaceAverages(const len_t nF, real_t **FSA_quantities[], real_t **FSA_quantities_f[], const int_t *const* Flists);
 
-        virtual void RebuildFluxSurfaceAveragedQuantities();
+        virtual void RebuildFluxSurfaceAveragedQuantities(GeometryCache *cache=nullptr);
         void SetEffectivePassingFraction(real_t*&, real_t*&, real_t*, real_t*);
         static real_t effectivePassingFractionIntegrand(real_t x, void *p);
 
@@ -158,6 +159,14 @@ namespace DREAM::FVM {
         FluxSurfaceAverager *fluxSurfaceAverager;
         RadialGridGenerator *generator;
 
+        // 'true' if the grid has been rebuilt since the flux surface
+        // averages were last calculated
+        bool jacobiansOutdated = true;
+        // Number of times the flux surface averages have been
+        // calculated (used by the grids sharing this radial grid to
+        // detect when their bounce averages must be recalculated)
+        len_t jacobianRevision = 0;
+
     public:
         RadialGrid(RadialGridGenerator*, const real_t t0=0, 
             FluxSurfaceAverager::interp_method im = FluxSurfaceAverager::INTERP_STEFFEN,
@@ -200,7 +209,7 @@ namespace DREAM::FVM {
 
         bool Rebuild(const real_t);
 
-        virtual void RebuildJacobians();
+        virtual void RebuildJacobians(GeometryCache *cache=nullptr);
         
         real_t CalculateFluxSurfaceAverage(len_t ir, fluxGridType fluxGridType, real_t(*F)(real_t,real_t,real_t,void*), void *par=nullptr, const int_t *F_list=nullptr);
         real_t EvaluateFluxSurfaceIntegral(len_t ir, fluxGridType fluxGridType, real_t(*F)(real_t,real_t,real_t,void*), void *par=nullptr, const int_t *F_list=nullptr);
@@ -327,8 +336,11 @@ namespace DREAM::FVM {
         const real_t   GetFSA_NablaR2OverR2_f(const len_t ir) const { return this->FSA_nablaR2OverR2_f[ir]; }
 
         FluxSurfaceAverager *GetFluxSurfaceAverager(){return fluxSurfaceAverager;}
+        RadialGridGenerator *GetGenerator(){return generator;}
 
         bool NeedsRebuild(const real_t t) const { return this->generator->NeedsRebuild(t); }
+        bool JacobiansOutdated() const { return this->jacobiansOutdated; }
+        len_t GetJacobianRevision() const { return this->jacobianRevision; }
 
 	};
 
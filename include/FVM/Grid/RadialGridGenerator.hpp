@@ -1,6 +1,7 @@
 //namespace DREAM::FVM { class RadialGridGenerator; }
 
 #include "FVM/config.h"
+#include "FVM/Grid/GeometryCache.hpp"
 #include "FVM/Grid/MomentumGrid.hpp"
 #include "FVM/Grid/RadialGrid.hpp"
 #include "FVM/Grid/fluxGridType.enum.hpp"
@@ -85,6 +86,17 @@ namespace DREAM::FVM {
         virtual void RebuildJacobians(RadialGrid*);
         bool IsFieldSymmetric(){return isUpDownSymmetric;}
 
+        // Returns 'true' if B, R/R0 and |nabla r|^2 are independent of
+        // the poloidal angle on every flux surface (so that there are no
+        // trapped orbits, and all flux-surface and bounce averages can be
+        // evaluated in closed form)
+        virtual bool IsFieldUniform() const { return false; }
+
+        // Add the magnetic equilibrium to the given hash. Returns
+        // 'false' if the geometric quantities generated by this
+        // generator should not be cached
+        virtual bool HashGeometry(GeometryCache::Hash&) { return false; }
+
         virtual real_t BAtTheta(const len_t ir, const real_t theta);
         virtual real_t BAtTheta_f(const len_t ir, const real_t theta);
         
@@ -98,6 +110,12 @@ namespace DREAM::FVM {
         
         virtual void EvaluateGeometricQuantities(const len_t ir, const real_t theta, real_t &B, real_t &Jacobian, real_t &ROverR0, real_t &NablaR2) = 0;
         virtual void EvaluateGeometricQuantities_fr(const len_t ir, const real_t theta, real_t &B, real_t &Jacobian, real_t &ROverR0, real_t &NablaR2) = 0;
+
+        // Evaluate B, Jacobian, R/R0 and |nabla r|^2 in all the given
+        // poloidal angles on one flux surface (may be overridden by
+        // generators which can do this more efficiently than point-by-point)
+        virtual void EvaluateGeometricQuantitiesOnTheta(const len_t ir, const len_t ntheta, const real_t *theta, real_t *B, real_t *Jacobian, real_t *ROverR0, real_t *NablaR2);
+        virtual void EvaluateGeometricQuantitiesOnTheta_fr(const len_t ir, const len_t ntheta, const real_t *theta, real_t *B, real_t *Jacobian, real_t *ROverR0, real_t *NablaR2);
     };
 }
 
@@ -24,8 +24,17 @@ namespace DREAM::FVM {
 
         bool xIncreasing;
 
+        // Index of the most recently located interval of 'x'. This
+        // is checked first when locating a new 'x' value, so that
+        // monotonically evolving 'x' (such as time) is located
+        // without a binary search. Interpolators defined on the
+        // same 'x' grid can share this index.
+        len_t ownIndex=0;
+        len_t *lastIndex;
+
+        bool _in_interval(const real_t, const len_t) const;
         len_t _find_x(const real_t);
-        const real_t *_eval_linear(const real_t);
+        const real_t *_eval_linear(const real_t, real_t*);
         const real_t *_eval_nearest(const real_t);
 
         enum interp_method method;
@@ -35,6 +44,9 @@ namespace DREAM::FVM {
         ~Interpolator1D();
 
         const real_t *Eval(const real_t);
+        void Eval(const real_t, real_t*);
+
+        void ShareIndex(Interpolator1D*);
 
         const real_t *GetBuffer() const { return this->buffer; }
         const real_t *GetX() const { return this->x; }
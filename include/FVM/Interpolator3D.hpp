@@ -17,6 +17,33 @@ namespace DREAM::FVM {
             GRID_PPARPPERP
         };
 
+        /**
+         * Precomputed interpolation stencil for a fixed set of
+         * target points. Each target point is given by a weighted
+         * sum of a few elements of the data to interpolate, so that
+         * (repeatedly) interpolating data given on the same input
+         * grid to the same target grid does not require any search.
+         */
+        class Stencil {
+        private:
+            len_t nPoints;
+            // Number of weights per target point
+            len_t nWeights;
+            len_t *index;
+            real_t *weight;
+
+        public:
+            Stencil(const len_t nPoints, const len_t nWeights);
+            ~Stencil();
+
+            len_t GetNPoints() const { return this->nPoints; }
+            len_t GetNWeights() const { return this->nWeights; }
+            len_t *GetIndices() { return this->index; }
+            real_t *GetWeights() { return this->weight; }
+
+            void Eval(const real_t*, real_t*) const;
+        };
+
     private:
         len_t nx1, nx2, nx3;
 
@@ -36,6 +63,21 @@ namespace DREAM::FVM {
         len_t _find_x3(const real_t x) { return _find_x(x, this->nx3, this->x3, this->acc3); }
         real_t _eval_nearest(const real_t, const real_t, const real_t);
         real_t _eval_linear(const real_t, const real_t, const real_t);
+        void _stencil_nearest(const real_t, const real_t, const real_t, len_t*, real_t*);
+        void _stencil_linear(const real_t, const real_t, const real_t, len_t*, real_t*);
+        void _target_point(
+            const enum momentumgrid_type, const real_t, const real_t, const real_t,
+            real_t&, real_t&, real_t&
+        ) const;
+        void _fill_stencil(
+            const len_t, const len_t, const len_t,
+            const real_t*, const real_t*, const real_t*,
+            enum momentumgrid_type, len_t*, real_t*
+        );
+
+        static const real_t *_radial_points(FVM::Grid*, enum fluxGridType);
+        static void _momentum_points(const MomentumGrid*, enum fluxGridType, const real_t*&, const real_t*&);
+        static len_t _n_points(FVM::Grid*, enum fluxGridType);
 
     public:
         Interpolator3D(
@@ -53,6 +95,14 @@ namespace DREAM::FVM {
             const real_t*, const real_t*, const real_t*,
             enum momentumgrid_type, real_t *out=nullptr
         );
+        const real_t *Eval(const Stencil*, real_t *out=nullptr) const;
+
+        Stencil *CreateStencil(FVM::Grid*, enum momentumgrid_type, enum fluxGridType fgt=FLUXGRIDTYPE_DISTRIBUTION);
+        Stencil *CreateStencil(
+            const len_t, const len_t, const len_t,
+            const real_t*, const real_t*, const real_t*,
+            enum momentumgrid_type
+        );
 
         const real_t *GetX1(){ return this->x1; }
         const real_t *GetX2(){ return this->x2; }
@@ -9,6 +9,27 @@
 
 namespace DREAM::FVM {
     class Matrix {
+        public:
+            // Matrix element which has been set, but not yet
+            // inserted into the PETSc matrix (see 'elementBuffer')
+            struct buffered_element {
+                PetscInt i, j;
+                PetscScalar v;
+            };
+            // Element set during direct assembly, together with its
+            // location in the value array of the matrix (see 'csrTrace')
+            struct trace_element {
+                PetscInt i, j, idx;
+            };
+            // Copy of the values of the matrix, used to detect whether
+            // the matrix has changed between assemblies (see
+            // 'HasChangedSince()'), or to restore the values later
+            // (see 'SaveValues()' and 'RestoreValues()')
+            struct value_snapshot {
+                PetscObjectState nonzeroState=0;
+                std::vector<PetscScalar> values;
+            };
+
         protected:
             Mat petsc_mat;
             PetscInt m, n;
@@ -18,6 +39,84 @@ namespace DREAM::FVM {
 
             bool allocated=false;
 
+            // If not 'nullptr', elements set in this matrix are
+            // appended to this buffer instead of being inserted
+            // directly into the PETSc matrix. This allows several
+            // threads to build different parts of the same matrix
+            // concurrently (PETSc itself is not thread-safe).
+            std::vector<struct buffered_element> *elementBuffer=nullptr;
+
+            // If not 'nullptr', only elements in rows 'i' for which
+            // 'rowMask[i] != 0' are set in this matrix, and elements in
+            // all other rows are ignored. This allows each MPI process
+            // of a distributed system to only assemble the rows which it
+            // owns (see 'DREAM::DistributedSystem').
+            const std::vector<char> *rowMask=nullptr;
+            bool IsRowMasked(const PetscInt i) const
+            { return (this->rowMask != nullptr && !(*this->rowMask)[i]); }
+
+            // Direct (CSR) assembly: if enabled, the non-zero structure
+            // of the (sequential AIJ) matrix is recorded after each final
+            // assembly, and elements which fall within this structure are
+            // then written directly into the value array of the PETSc
+            // matrix, bypassing 'MatSetValues()'.
+            bool directAssembly=false;
+            bool csrValid=false;
+            PetscObjectState csrNonzeroState=0;
+            std::vector<PetscInt> csrRowPtr, csrCols;
+            // Value array of PETSc matrix (while being written directly)
+            PetscScalar *csrValues=nullptr;
+            // Sequence of elements set since the last call to 'Zero()',
+            // with their locations in the value array. Since the stencils
+            // of the equation terms are static, the same sequence is
+            // normally repeated in every assembly, and the locations can
+            // then be reused instead of being searched for again.
+            std::vector<struct trace_element> csrTrace;
+            size_t csrTracePos=0;
+            // Identifies the recorded non-zero structure (unique
+            // among all matrices, see 'nextCSRRevision')
+            len_t csrRevision=0;
+            static inline len_t nextCSRRevision=0;
+
+            // Device assembly: if the matrix is stored on a GPU (the
+            // matrix type of the current 'PETScBackend'), the recorded
+            // structure is instead used by kernels (see 'FVM::Device')
+            // which add values to the device array 'deviceValues', in
+            // the order of the structure. The array is added to the
+            // matrix with 'MatSetValuesCOO()' when the matrix is
+            // assembled, so that the values never pass through the host.
+            bool csrOnDevice=false;
+            PetscScalar *deviceValues=nullptr;
+            len_t deviceValuesSize=0;
+            bool deviceValuesPending=false;
+            // Non-zero state for which the COO preallocation was made
+            bool cooValid=false;
+            PetscObjectState cooNonzeroState=0;
+
+            // First element given a non-finite value (NaN or Inf) since
+            // the last call to 'Zero()' (see 'HasNonFiniteElement()')
+            bool nonFinite=false;
+            PetscInt nonFiniteRow=0, nonFiniteCol=0;
+            void RecordNonFinite(const PetscInt i, const PetscInt j) {
+                if (!this->nonFinite) {
+                    this->nonFinite = true;
+                    this->nonFiniteRow = i;
+                    this->nonFiniteCol = j;
+                }
+            }
+
+            // Work vectors used for matrix-vector multiplications
+            // (created on the first multiplication)
+            Vec mulX=nullptr, mulY=nullptr;
+            void DestroyWorkVectors();
+
+            bool BeginDirectAssembly();
+            PetscInt FindCSRIndex(const PetscInt, const PetscInt) const;
+            PetscInt LocateDirect(const PetscInt, const PetscInt);
+            void UpdateCSRStructure();
+            void EndDeviceAssembly();
+            void SetupCOO();
+
             void Construct(
                 const PetscInt, const PetscInt,
                 const PetscInt, const PetscInt* nnzl=nullptr
@@ -34,6 +133,11 @@ namespace DREAM::FVM {
                 NON_ZERO_STRUCT   = 1337
             };
 
+            // Name of the PETSc matrix ordering which applies the
+            // permutation given to 'SetFactorOrdering()'
+            static const char *FACTOR_ORDERING;
+            static void RegisterFactorOrdering();
+
             Matrix();
             Matrix(const PetscInt, const PetscInt, Mat);
             Matrix(
@@ -45,22 +149,35 @@ namespace DREAM::FVM {
             void Assemble();
             void PartialAssemble();
             bool ContainsNaNOrInf(len_t *I=nullptr, len_t *J=nullptr);
+            bool HasNonFiniteElement(PetscInt *I=nullptr, PetscInt *J=nullptr) const;
             void DiagonalScale(Vec, Vec);
             virtual void Destroy();
             void GetOwnershipRange(PetscInt*, PetscInt*);
+            void InsertBufferedElements(const std::vector<struct buffered_element>&);
             virtual void IMinusDtA(const PetscScalar);
             real_t *Multiply(const len_t, const real_t*);
+            void Multiply(const real_t*, real_t*, const real_t alpha=1, const real_t beta=0);
+            void Multiply(
+                const len_t, const real_t *const*, real_t *const*,
+                const real_t alpha=1, const real_t beta=0
+            );
 
             real_t GetElement(const PetscInt, const PetscInt);
             void GetRow(const PetscInt, PetscScalar*);
             void GetRow(const PetscInt, const PetscInt*, PetscScalar*);
             void GetColumn(const PetscInt, PetscScalar*);
             void GetColumn(const PetscInt, const PetscInt*, PetscScalar*);
+            void GetSparsityPattern(std::vector<std::vector<PetscInt>>&);
             real_t *GetRowMaxAbs();
             void GetRowMaxAbs(real_t*);
             len_t GetNRows() const { return this->m; }
             len_t GetNCols() const { return this->n; }
             len_t GetNNZ();
+            size_t GetMemoryUsage() const;
+            static size_t GetMemoryUsage(Mat);
+            bool HasChangedSince(struct value_snapshot&);
+            bool SaveValues(struct value_snapshot&);
+            bool RestoreValues(const struct value_snapshot&);
 
             PetscInt GetRowOffset() const { return this->rowOffset; }
             PetscInt GetColOffset() const { return this->colOffset; }
@@ -76,8 +193,19 @@ namespace DREAM::FVM {
 			);
 
             void ResetOffset();
+            void SetDirectAssembly(const bool);
+            void EndDirectAssembly();
+            PetscScalar *BeginDeviceAssembly();
+            PetscInt GetCSRIndex(const PetscInt irow, const PetscInt icol) const
+            { return this->FindCSRIndex(this->rowOffset+irow, this->colOffset+icol); }
+            len_t GetCSRRevision() const { return this->csrRevision; }
+            void SetElementBuffer(std::vector<struct buffered_element> *buf) { this->elementBuffer = buf; }
+            void SetFactorOrdering(const std::vector<PetscInt>&);
+            void SetRowMask(const std::vector<char> *m) { this->rowMask = m; }
+            bool HasRowMask() const { return (this->rowMask != nullptr); }
             void SetOffset(const PetscInt, const PetscInt);
             void View(enum view_format vf=ASCII_MATLAB, const std::string& filename="petsc_matrix");
+            void SaveCSR(const std::string& filename, const std::string& index="");
             void Zero(bool nzKeep = true);
 			void ZeroRows(const PetscInt, const PetscInt[]);
 			void ZeroRowsColumns(const PetscInt, const PetscInt[]);
@@ -85,7 +213,7 @@ namespace DREAM::FVM {
 
             void PrintInfo();
 
-            Mat &mat() { return this->petsc_mat; }
+            Mat &mat() { this->EndDirectAssembly(); return this->petsc_mat; }
     };
 
     class MatrixException : public FVMException {
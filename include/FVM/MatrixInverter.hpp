@@ -3,22 +3,50 @@
 
 #include <petscksp.h>
 #include <petscvec.h>
+#include <string>
 #include "FVM/Matrix.hpp"
 
 namespace DREAM::FVM {
 	class MatrixInverter {
 	protected:
 		Vec *solution = nullptr;
-        KSP ksp;
+        KSP ksp = nullptr;
 
         PetscInt errorcode=0;
+
+        // If 'true', the symbolic factorization (ordering and fill
+        // pattern) of the matrix is kept between calls to 'Invert()'
+        // and only the numeric factorization is redone
+        bool reuseSymbolic=false;
+        // If 'true', the factorization (or preconditioner) computed in
+        // the most recent call to 'Invert()' is applied again, even if
+        // the matrix has changed since
+        bool reuseFactorization=false;
+        // Name of the PETSc matrix ordering to use for the factorization
+        // of the matrix (empty = default ordering of the solver)
+        std::string factorOrdering;
+
+        Mat GetFactorMatrix() const;
 	public:
-		MatrixInverter() {}
-        virtual ~MatrixInverter() {}
+		MatrixInverter();
+        virtual ~MatrixInverter();
+
+        size_t GetMemoryUsage() const;
+        real_t GetFactorizationFill() const;
+        len_t GetIterationNumber() const;
 
         virtual int_t GetReturnCode() { return this->errorcode; }
 		virtual void Invert(Matrix*, Vec*, Vec*) = 0;
 
+        bool GetReuseSymbolicFactorization() const { return this->reuseSymbolic; }
+        virtual void SetReuseSymbolicFactorization(const bool v) { this->reuseSymbolic = v; }
+        bool GetReuseFactorization() const { return this->reuseFactorization; }
+        virtual void SetReuseFactorization(const bool);
+        const std::string& GetFactorOrdering() const { return this->factorOrdering; }
+        void SetFactorOrdering(const std::string& o) { this->factorOrdering = o; }
+        // Relative tolerance of iterative solvers (ignored by direct solvers)
+        virtual void SetRelativeTolerance(const real_t) {}
+
         virtual void PrintInfo();
 	};
 }
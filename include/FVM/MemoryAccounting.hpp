@@ -0,0 +1,44 @@
+#ifndef _DREAM_FVM_MEMORY_ACCOUNTING_HPP
+#define _DREAM_FVM_MEMORY_ACCOUNTING_HPP
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <softlib/SFile.h>
+#include "FVM/config.h"
+
+namespace DREAM::FVM {
+    class MemoryAccounting {
+    private:
+        // Object reporting its memory usage to the registry
+        struct source {
+            std::string category;
+            std::function<size_t()> usage;
+        };
+
+        static inline bool enabled = false;
+
+        static inline std::mutex mtx;
+        static inline std::multimap<const void*, struct source> sources;
+        // Largest memory usage observed in each category
+        static inline std::map<std::string, size_t> peak;
+
+    public:
+        static void Configure(const bool enable);
+        static bool IsEnabled() { return enabled; }
+
+        static void Register(const void*, const std::string&, std::function<size_t()>);
+        static void Unregister(const void*);
+
+        static std::map<std::string, size_t> Sample();
+        static size_t GetResidentMemory();
+        static size_t GetPeakResidentMemory();
+        static std::string FormatBytes(const real_t);
+
+        static void PrintSummary(const std::string& title);
+        static void SaveSummary(SFile*, const std::string& path);
+    };
+}
+
+#endif/*_DREAM_FVM_MEMORY_ACCOUNTING_HPP*/
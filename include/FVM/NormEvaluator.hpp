@@ -24,6 +24,12 @@ namespace DREAM::FVM {
         void Norm2(const real_t*, real_t*);
         const real_t *Norm2Diff(const real_t*, const real_t*);
         void Norm2Diff(const real_t*, const real_t*, real_t*);
+
+        void Norms(
+            const real_t*, const real_t*, const real_t*, real_t*, real_t*,
+            const real_t *abstol=nullptr, const real_t *reltol=nullptr,
+            real_t *wrms=nullptr
+        );
     };
 }
 
@@ -0,0 +1,41 @@
+#ifndef _DREAM_FVM_PETSC_BACKEND_HPP
+#define _DREAM_FVM_PETSC_BACKEND_HPP
+
+#include <petscksp.h>
+#include <petscmat.h>
+#include <petscvec.h>
+#include "FVM/config.h"
+
+namespace DREAM::FVM {
+    class PETScBackend {
+    public:
+        // NOTE: These values must match those of
+        // 'OptionConstants::solver_backend'
+        enum backend {
+            BACKEND_CPU=1,
+            BACKEND_CUDA=2,
+            BACKEND_HIP=3,
+            BACKEND_KOKKOS=4
+        };
+
+    private:
+        static inline enum backend current = BACKEND_CPU;
+
+    public:
+        static void SetBackend(enum backend);
+        static enum backend GetBackend() { return current; }
+        static bool IsAvailable(enum backend);
+        static bool IsGPU() { return (current != BACKEND_CPU); }
+        static const char *GetName(enum backend);
+
+        static MatType GetMatType();
+        static VecType GetVecType();
+
+        static PetscErrorCode CreateMatrix(const PetscInt, const PetscInt, const PetscInt, const PetscInt*, Mat*);
+        static PetscErrorCode CreateVector(const PetscInt, Vec*);
+        static bool CreateVectorWithArray(const PetscInt, PetscScalar*, Vec*);
+        static void SetFactorSolverType(PC);
+    };
+}
+
+#endif/*_DREAM_FVM_PETSC_BACKEND_HPP*/
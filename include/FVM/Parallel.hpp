@@ -0,0 +1,329 @@
+#ifndef _DREAM_FVM_PARALLEL_HPP
+#define _DREAM_FVM_PARALLEL_HPP
+/**
+ * Helpers for the thread-parallel parts of DREAM.
+ *
+ * All parallelism in DREAM is expressed with OpenMP, so that the threads
+ * are shared by all parallel loops (and with PETSc and the linear algebra
+ * libraries) instead of each part of the code starting its own. The
+ * helpers in this file capture the patterns used throughout the code:
+ *
+ *   Parallel::For()   Dynamically scheduled loop over a range of tasks,
+ *                     which rethrows the first exception thrown by a task
+ *                     once the loop has finished (exceptions may not
+ *                     propagate out of OpenMP parallel regions).
+ *   Parallel::ForWithScratch()
+ *                     As 'For()', but also giving every task a scratch
+ *                     object (such as a GSL workspace, spline or work
+ *                     array) owned by the thread executing it.
+ *   Parallel::Sum()   Reduction evaluated in fixed blocks, and combined
+ *                     in a fixed order, so that the result does not
+ *                     depend on the number of threads (unless the
+ *                     reproducible mode is disabled, see below).
+ *   Parallel::GetNumberOfThreads()
+ *                     Number of threads configured for the simulation,
+ *                     used by the loops which are not given a number of
+ *                     threads explicitly (such as the radial loops of the
+ *                     flux surface and bounce averagers).
+ *   Parallel::FirstTouch()
+ *                     Initialization of large arrays, which distributes
+ *                     the memory of the array over the NUMA nodes of the
+ *                     threads when the threads are bound to cores.
+ *
+ * By default (in the reproducible mode, 'solver/reproducible'), the
+ * results of DREAM are bitwise identical regardless of the number of
+ * threads used (which is verified by the 'reproducibility' physics test,
+ * and is required for comparisons against golden outputs). Parallel loops must therefore only write to disjoint outputs (as
+ * the rows of the jacobian, which are merged in a fixed order), and may
+ * accumulate floating-point sums across tasks with 'Parallel::Sum()'
+ * (and never with OpenMP 'reduction' clauses, whose order of summation
+ * depends on the number of threads). State which may not be shared
+ * between threads (such as GSL workspaces) is taken from the scratch
+ * objects of 'Parallel::ForWithScratch()', or kept in 'thread_local'
+ * objects (see e.g. 'FluxSurfaceAverager::GetWorkspace()'). Both are
+ * distinct for every thread also in nested parallel regions (unlike
+ * state indexed by 'omp_get_thread_num()').
+ *
+ * If the reproducible mode is disabled, 'Parallel::Sum()' instead sums
+ * one contiguous range per thread and combines the partial sums in the
+ * order in which the threads finish, which avoids the storage and the
+ * fixed-size blocks of the reproducible reduction, but makes the
+ * round-off error (and hence the solution, at the level of the solver
+ * tolerances) depend on the number of threads and on the scheduling.
+ * The cost of the reproducible mode is reported by the 'fvm/parallelsum'
+ * benchmark of 'dreambench'.
+ *
+ * Apart from the configured number of threads and reproducible mode, no
+ * state is kept between
+ * calls, and so the helpers may also be used when DREAM is called from
+ * another program (e.g. through the C interface). If DREAM is compiled
+ * without OpenMP, all loops are run on the calling thread.
+ */
+
+#include <algorithm>
+#include <exception>
+#include <memory>
+#include <vector>
+#ifdef _OPENMP
+#   include <omp.h>
+#endif
+#include "FVM/config.h"
+
+namespace DREAM::FVM::Parallel {
+    /**
+     * Returns the index of the calling thread within the
+     * current parallel region (0 outside of parallel regions).
+     */
+    inline len_t GetThreadIndex() {
+#ifdef _OPENMP
+        return (len_t)omp_get_thread_num();
+#else
+        return 0;
+#endif
+    }
+
+    /**
+     * Returns the maximum number of threads which may
+     * execute a parallel region.
+     */
+    inline len_t GetMaxThreads() {
+#ifdef _OPENMP
+        return (len_t)omp_get_max_threads();
+#else
+        return 1;
+#endif
+    }
+
+    /**
+     * Number of threads configured for the simulation (storage
+     * for 'GetNumberOfThreads()' and 'SetNumberOfThreads()').
+     */
+    inline len_t& ConfiguredThreads() {
+        static len_t nThreads = GetMaxThreads();
+        return nThreads;
+    }
+
+    /**
+     * Returns the number of threads to use in the parallel loops
+     * which are not given a number of threads by their caller.
+     */
+    inline len_t GetNumberOfThreads() { return ConfiguredThreads(); }
+
+    /**
+     * Set the number of threads to use in the parallel loops which
+     * are not given a number of threads by their caller.
+     */
+    inline void SetNumberOfThreads(const len_t n) { ConfiguredThreads() = (n > 0 ? n : 1); }
+
+    /**
+     * Whether reductions are evaluated in a fixed order (storage
+     * for 'IsReproducible()' and 'SetReproducible()').
+     */
+    inline bool& ConfiguredReproducible() {
+        static bool reproducible = true;
+        return reproducible;
+    }
+
+    /**
+     * Returns 'true' if reductions (see 'Sum()') are evaluated in
+     * an order which does not depend on the number of threads.
+     */
+    inline bool IsReproducible() { return ConfiguredReproducible(); }
+
+    /**
+     * Enable or disable the reproducible mode of the reductions.
+     */
+    inline void SetReproducible(const bool r) { ConfiguredReproducible() = r; }
+
+    /**
+     * Returns 'true' if the OpenMP threads are bound to places (i.e.
+     * if 'OMP_PROC_BIND' is set), so that memory first touched by a
+     * thread stays on the NUMA node of the thread.
+     */
+    inline bool ThreadsAreBound() {
+#ifdef _OPENMP
+        return (omp_get_proc_bind() != omp_proc_bind_false);
+#else
+        return false;
+#endif
+    }
+
+    /**
+     * Set all elements of the newly allocated array 'p' to 'v'. Memory
+     * pages are placed on the NUMA node of the thread which first writes
+     * to them, and so if the threads are bound to cores (see
+     * 'ThreadsAreBound()'), large arrays are initialized by all threads,
+     * each writing one contiguous slab of the array (for quantities
+     * defined on the kinetic grids, this corresponds to a range of radii).
+     * The memory of the array is then spread over the sockets, instead of
+     * being placed on the node of the main thread, which allows memory-bound
+     * loops to use the memory bandwidth of every socket. Otherwise, the
+     * array is initialized on the calling thread.
+     *
+     * p: Array to initialize.
+     * n: Number of elements in array.
+     * v: Value to set all elements to.
+     */
+    template<typename T>
+    void FirstTouch(T *p, const len_t n, const T v=T()) {
+        // Arrays smaller than this are not worth distributing
+        // (corresponds to a few memory pages per thread)
+        constexpr len_t FIRST_TOUCH_MIN_SIZE = 1 << 20;
+
+        const bool distribute = (n*sizeof(T) >= FIRST_TOUCH_MIN_SIZE && ThreadsAreBound());
+
+        #pragma omp parallel for schedule(static) if (distribute)
+        for (len_t i = 0; i < n; i++)
+            p[i] = v;
+    }
+
+    /**
+     * Evaluate 'f(i)' for i = 0, 1, ..., n-1, distributed dynamically
+     * over (at most) 'nThreads' threads. If any evaluation throws an
+     * exception, the first exception caught is rethrown once all
+     * tasks have finished.
+     *
+     * n:        Number of tasks.
+     * nThreads: Maximum number of threads to use.
+     * f:        Function to evaluate for each task.
+     */
+    template<typename F>
+    void For(const len_t n, const len_t nThreads, F&& f) {
+        std::exception_ptr exc = nullptr;
+
+        #pragma omp parallel for num_threads(nThreads) schedule(dynamic) if (n > 1 && nThreads > 1)
+        for (len_t i = 0; i < n; i++) {
+            try {
+                f(i);
+            } catch (...) {
+                #pragma omp critical
+                if (exc == nullptr)
+                    exc = std::current_exception();
+            }
+        }
+
+        if (exc != nullptr)
+            std::rethrow_exception(exc);
+    }
+
+    /**
+     * Evaluate 'f(i, scratch)' for i = 0, 1, ..., n-1, distributed
+     * dynamically over (at most) 'nThreads' threads, as 'For()'. Each
+     * thread constructs its own scratch object of type 'S' (from the
+     * arguments 'args') before evaluating its first task, and destroys
+     * it once the loop has finished, so that a scratch object is never
+     * used by two tasks at the same time. The scratch objects are local
+     * to the parallel region, and so remain distinct for every thread
+     * also when this function is called from within another parallel
+     * region.
+     *
+     * n:        Number of tasks.
+     * nThreads: Maximum number of threads to use.
+     * f:        Function to evaluate for each task, taking the index of
+     *           the task and a reference to the scratch object.
+     * args:     Arguments to give to the constructor of 'S'.
+     */
+    template<typename S, typename F, typename ... Args>
+    void ForWithScratch(const len_t n, const len_t nThreads, F&& f, Args&& ... args) {
+        std::exception_ptr exc = nullptr;
+
+        #pragma omp parallel num_threads(nThreads) if (n > 1 && nThreads > 1)
+        {
+            std::unique_ptr<S> scratch;
+
+            #pragma omp for schedule(dynamic)
+            for (len_t i = 0; i < n; i++) {
+                try {
+                    if (scratch == nullptr)
+                        scratch.reset(new S(args...));
+
+                    f(i, *scratch);
+                } catch (...) {
+                    #pragma omp critical
+                    if (exc == nullptr)
+                        exc = std::current_exception();
+                }
+            }
+        }
+
+        if (exc != nullptr)
+            std::rethrow_exception(exc);
+    }
+
+    /**
+     * Evaluate the sum of the terms i = 0, 1, ..., n-1 using (at most)
+     * 'nThreads' threads. The range is divided into blocks of
+     * 'SUM_BLOCK_SIZE' terms (independently of the number of threads),
+     * and the block sums, evaluated by 'f(i0, i1)' for the terms
+     * i0 <= i < i1, are then combined pairwise in a fixed order. The
+     * result is therefore bitwise identical for any number of threads
+     * (and ranges shorter than one block are summed by a single call to
+     * 'f', as in a serial loop).
+     *
+     * If the reproducible mode is disabled (see 'SetReproducible()'),
+     * each thread instead calls 'f' once for a contiguous part of the
+     * range, and the partial sums are added in the order in which the
+     * threads finish. As in 'For()', the first exception thrown by 'f'
+     * is rethrown once all threads have finished.
+     *
+     * n:        Number of terms.
+     * nThreads: Maximum number of threads to use.
+     * zero:     Value of an empty sum (determines the type of the sum,
+     *           which must support 'operator+').
+     * f:        Function evaluating the sum of the terms in a block.
+     */
+    constexpr len_t SUM_BLOCK_SIZE = 4096;
+
+    template<typename T, typename F>
+    T Sum(const len_t n, const len_t nThreads, const T zero, F&& f) {
+        const len_t nBlocks = (n + SUM_BLOCK_SIZE-1) / SUM_BLOCK_SIZE;
+        if (nBlocks == 0)
+            return zero;
+        else if (nBlocks == 1 || (nThreads <= 1 && !IsReproducible()))
+            return f(0, n);
+
+        if (!IsReproducible()) {
+            T sum = zero;
+            std::exception_ptr exc = nullptr;
+
+            #pragma omp parallel num_threads(nThreads)
+            {
+#ifdef _OPENMP
+                const len_t nt = (len_t)omp_get_num_threads();
+#else
+                const len_t nt = 1;
+#endif
+                const len_t t = GetThreadIndex();
+                try {
+                    const T s = f((n*t)/nt, (n*(t+1))/nt);
+
+                    #pragma omp critical
+                    sum = sum + s;
+                } catch (...) {
+                    #pragma omp critical
+                    if (exc == nullptr)
+                        exc = std::current_exception();
+                }
+            }
+
+            if (exc != nullptr)
+                std::rethrow_exception(exc);
+
+            return sum;
+        }
+
+        std::vector<T> partial(nBlocks, zero);
+        For(nBlocks, nThreads, [&partial,&f,n](const len_t b) {
+            partial[b] = f(b*SUM_BLOCK_SIZE, std::min(n, (b+1)*SUM_BLOCK_SIZE));
+        });
+
+        // Pairwise (tree) combination of the block sums
+        for (len_t stride = 1; stride < nBlocks; stride *= 2)
+            for (len_t b = 0; b+stride < nBlocks; b += 2*stride)
+                partial[b] = partial[b] + partial[b+stride];
+
+        return partial[0];
+    }
+}
+
+#endif/*_DREAM_FVM_PARALLEL_HPP*/
@@ -0,0 +1,42 @@
+#ifndef _DREAM_FVM_PERF_COUNTERS_HPP
+#define _DREAM_FVM_PERF_COUNTERS_HPP
+
+#include <cstdint>
+#include "FVM/config.h"
+
+namespace DREAM::FVM {
+    class PerfCounters {
+    public:
+        // Hardware events counted
+        enum counter {
+            COUNTER_CYCLES,
+            COUNTER_INSTRUCTIONS,
+            COUNTER_LLC_REFERENCES,
+            COUNTER_LLC_MISSES,
+            N_COUNTERS
+        };
+
+        struct values {
+            uint64_t v[N_COUNTERS] = {0};
+        };
+
+    private:
+        static inline bool enabled = false;
+
+        // File descriptors of the counters opened for this thread
+        // (-1 if not yet opened; the leader is set to -2 if the
+        // counters are not available)
+        static inline thread_local int fds[N_COUNTERS] = {-1, -1, -1, -1};
+
+        static bool Open();
+
+    public:
+        static bool Configure(const bool enable);
+        static bool IsEnabled() { return enabled; }
+
+        static bool Read(struct values&);
+        static const char *GetName(const len_t);
+    };
+}
+
+#endif/*_DREAM_FVM_PERF_COUNTERS_HPP*/
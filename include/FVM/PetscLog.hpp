@@ -0,0 +1,65 @@
+#ifndef _DREAM_FVM_PETSC_LOG_HPP
+#define _DREAM_FVM_PETSC_LOG_HPP
+
+#include <map>
+#include <string>
+#include <petscsys.h>
+#include <softlib/SFile.h>
+#include "FVM/config.h"
+
+namespace DREAM::FVM {
+    class PetscLog {
+    public:
+        /**
+         * RAII helper for pushing a PETSc log stage for the duration
+         * of a scope. All PETSc operations (such as 'KSPSolve' or
+         * 'MatLUFactorNumeric') carried out inside the scope are then
+         * attributed to the stage in the PETSc log summary. The cost
+         * of a scope when PETSc logging is disabled is a single branch.
+         */
+        class Stage {
+        private:
+            bool active;
+        public:
+            Stage(const char *name)
+                : active(PetscLog::enabled) { if (active) PetscLogStagePush(PetscLog::GetStage(name)); }
+            ~Stage() { if (active) PetscLogStagePop(); }
+        };
+
+        /**
+         * RAII helper for logging a PETSc event for the duration of
+         * a scope.
+         */
+        class Event {
+        private:
+            bool active;
+            PetscLogEvent event;
+        public:
+            Event(const char *name) : active(PetscLog::enabled) {
+                if (active) {
+                    event = PetscLog::GetEvent(name);
+                    PetscLogEventBegin(event, 0, 0, 0, 0);
+                }
+            }
+            ~Event() { if (active) PetscLogEventEnd(event, 0, 0, 0, 0); }
+        };
+
+    private:
+        static inline bool enabled = false;
+
+        static inline PetscClassId classId;
+        static inline std::map<std::string, PetscLogStage> stages;
+        static inline std::map<std::string, PetscLogEvent> events;
+
+    public:
+        static void Configure(const bool enable);
+        static bool IsEnabled() { return enabled; }
+
+        static PetscLogStage GetStage(const char*);
+        static PetscLogEvent GetEvent(const char*);
+
+        static void SaveSummary(SFile*, const std::string& path);
+    };
+}
+
+#endif/*_DREAM_FVM_PETSC_LOG_HPP*/
@@ -14,6 +14,30 @@ namespace DREAM::FVM {
         Grid *grid;
         std::vector<real_t> times;
         std::vector<real_t*> store;
+        // Saved steps following the initial step, if these are stored
+        // in single precision (in which case 'store' only contains the
+        // initial step, i.e. 'storeSingle[i]' holds saved step 'i+1'
+        // (plus 'nReleasedSteps'))
+        std::vector<float*> storeSingle;
+        bool singlePrecision = false;
+        // If true, only the initial value and the most recent saved
+        // step are kept (each saved step replaces the previous one)
+        bool finalOnly = false;
+        // Buffer for saved steps converted back to double precision
+        real_t *stepBuffer = nullptr;
+        // Number of saved steps (following the initial step) which have
+        // been removed from 'store' after being written to file (i.e.
+        // 'store[i]' holds saved step 'i+nReleasedSteps' for i > 0)
+        len_t nReleasedSteps = 0;
+        // If not 'nullptr', saved steps are only produced in these times,
+        // by interpolating between the (true) saved steps around them
+        const std::vector<real_t> *outputTimes = nullptr;
+        // Index of next output time to produce
+        len_t nextOutputTime = 0;
+        // Data and time of the most recent (true) saved step, and a
+        // buffer for the interpolated data (only used with 'outputTimes')
+        real_t *lastSaved = nullptr, *interpBuffer = nullptr;
+        real_t lastSavedTime = 0;
         enum FVM::fluxGridType fluxGridType = FLUXGRIDTYPE_DISTRIBUTION;
 
         len_t nMultiples=1;
@@ -26,11 +50,22 @@ namespace DREAM::FVM {
         // solutions to a previous state, we can increase the number of old solutions
         // stored here. This is necessary for the adaptive time stepper, but also
         // implies a higher memory consumption)
+        // The buffers are used as a ring buffer: on 'SaveStep()' and
+        // 'RollbackSaveStep()' only the pointers are rotated, so that
+        // olddata[i] always refers to the i'th most recent old step.
         real_t **olddata=nullptr;
         real_t *oldtime = nullptr;
-        const len_t N_SAVE_OLD_STEPS = 4;   // Can roll back N-1 steps (TimeStepperAdaptive needs N >= 3 (so that we can also restore the "initial" time derivative))
+        // Memory block holding all 'olddata' buffers
+        real_t *oldblock = nullptr;
+        len_t N_SAVE_OLD_STEPS = 4;   // Can roll back N-1 steps (TimeStepperAdaptive needs N >= 3 (so that we can also restore the "initial" time derivative); set by the time stepper via 'UnknownQuantityHandler')
         len_t nOldSaved = 0;      // Number of old steps currently stored
 
+        // Linear combination of old steps (used by multi-step time
+        // integration methods), and the "version" of the combination
+        // currently stored (0 = none)
+        real_t *oldcomb = nullptr;
+        len_t oldcombVersion = 0;
+
         // Data from time step before the previous (even in step was not saved to 'store')
         // (this variable is one time step older than 'olddata' and is used when
         // rolling back saved steps)
@@ -39,10 +74,15 @@ namespace DREAM::FVM {
         PetscInt *idxVec = nullptr;
 
         bool hasChanged = true;
+        // Incremented every time the current data may have been modified
+        // (so that derived quantities can be cached until it changes)
+        len_t version = 1;
 
         void AllocateData();
+        void AppendSavedStep(const real_t*, const real_t);
+        void SaveOutputTimes(const real_t);
 
-        void SaveSFile_internal(SFile*, const std::string& name, const std::string&, const std::string&, bool saveMeta, std::vector<real_t>&, std::vector<real_t*>&);
+        void SaveSFile_internal(SFile*, const std::string& name, const std::string&, const std::string&, bool saveMeta, std::vector<real_t>&, std::vector<real_t*>&, const std::vector<float*> *storef=nullptr);
 
     public:
         QuantityData(
@@ -55,8 +95,37 @@ namespace DREAM::FVM {
         //real_t *GetPrevious() { return this->store.back(); }
         real_t *GetPrevious() { return this->olddata[0]; }
         real_t GetPreviousTime() { return this->oldtime[0]; }
+        real_t GetOldTime(const len_t i) const { return this->oldtime[i]; }
+        const real_t *GetOldData(const len_t i) const { return this->olddata[i]; }
+        real_t *GetOldStepCombination(const len_t, const len_t, const len_t*, const real_t*);
         real_t *GetInitialData() { return this->store.front(); }
         len_t Size() { return this->nElements; }
+        len_t GetNMultiples() const { return this->nMultiples; }
+
+        size_t GetMemoryUsage() const;
+        size_t GetSavedStepsMemoryUsage() const;
+        /**
+         * Returns the number of bytes needed to save one more time step.
+         */
+        size_t GetStepMemoryUsage() const {
+            if (this->finalOnly && this->times.size() >= 2) return 0;
+            else return this->nElements * (this->singlePrecision ? sizeof(float) : sizeof(real_t)) + sizeof(real_t);
+        }
+
+        len_t GetNSavedSteps() const { return this->times.size(); }
+        const real_t *GetSavedStep(const len_t);
+        real_t GetSavedTime(const len_t i) const { return this->times[i]; }
+        len_t GetStepDimensions(sfilesize_t*) const;
+        void ReleaseSavedSteps();
+        void TakeSavedSteps(std::vector<real_t*>&);
+        void TakeSavedSteps(std::vector<float*>&);
+
+        bool IsSinglePrecision() const { return this->singlePrecision; }
+        void SetSinglePrecision(bool);
+        bool IsFinalOnly() const { return this->finalOnly; }
+        void SetFinalOnly(bool);
+        bool HasOutputTimes() const { return (this->outputTimes != nullptr); }
+        void SetOutputTimes(const std::vector<real_t>*);
 
         /**
          * Returns 'true' if the data stored by this quantity
@@ -64,8 +133,11 @@ namespace DREAM::FVM {
          */
         bool HasChanged() const { return this->hasChanged; }
         bool HasInitialValue() const { return (this->store.size()>=1); }
+        len_t GetVersion() const { return this->version; }
 
         len_t GetNOldSaved() const { return this->nOldSaved; }
+        len_t GetNSaveOldSteps() const { return this->N_SAVE_OLD_STEPS; }
+        void SetNSaveOldSteps(const len_t);
 
         bool CanRollbackSaveStep() const;
         void RollbackSaveStep();
@@ -80,6 +152,7 @@ namespace DREAM::FVM {
 		void SaveSFileCurrent(SFile*, const std::string& name, const std::string& path="", const std::string& desc="", bool saveMeta=false);
 
         void SetInitialValue(const real_t*, const real_t t0=0);
+        void RestoreState(const real_t*, const real_t, const real_t*, const real_t*, const len_t, const len_t);
     };
 }
 
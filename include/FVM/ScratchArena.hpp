@@ -0,0 +1,56 @@
+#ifndef _DREAM_FVM_SCRATCH_ARENA_HPP
+#define _DREAM_FVM_SCRATCH_ARENA_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <type_traits>
+#include <vector>
+#include "FVM/config.h"
+
+namespace DREAM::FVM {
+    class ScratchArena {
+    private:
+        // Block of memory to hand out scratch space from
+        struct chunk {
+            char *data;
+            size_t size, used;
+        };
+        std::vector<struct chunk> chunks;
+        // Iteration in which memory was last handed out by this arena
+        len_t iteration = 0;
+
+        static inline std::atomic<len_t> currentIteration{0};
+        // Number of heap allocations made by all arenas
+        static inline std::atomic<len_t> nHeapAllocations{0};
+
+        void *AllocateBytes(const size_t);
+        void Reset();
+
+    public:
+        ScratchArena() {}
+        ScratchArena(const ScratchArena&) = delete;
+        ScratchArena& operator=(const ScratchArena&) = delete;
+        ~ScratchArena();
+
+        static ScratchArena& Get();
+        static void NextIteration() { currentIteration++; }
+        static len_t GetNHeapAllocations() { return nHeapAllocations; }
+
+        /**
+         * Allocate scratch space for 'n' elements of type 'T'. The
+         * memory is NOT initialized, never needs to be free'd and
+         * remains valid until the end of the current solver
+         * iteration (see 'NextIteration()').
+         */
+        template<typename T>
+        T *Allocate(const len_t n) {
+            static_assert(std::is_trivially_destructible<T>::value,
+                "Only trivially destructible types may be allocated in the scratch arena.");
+            return static_cast<T*>(AllocateBytes(n*sizeof(T)));
+        }
+
+        size_t GetCapacity() const;
+    };
+}
+
+#endif/*_DREAM_FVM_SCRATCH_ARENA_HPP*/
@@ -2,6 +2,7 @@
 #define _DREAM_FVM_MATRIX_INVERTER_GMRES_HPP
 
 #include <petscksp.h>
+#include <string>
 #include <vector>
 #include "FVM/config.h"
 #include "FVM/MatrixInverter.hpp"
@@ -9,6 +10,42 @@
 
 namespace DREAM::FVM {
 	class MIGMRES : public MatrixInverter {
+    public:
+        // Solver to use for a split of the field-split preconditioner
+        enum split_solver {
+            SPLIT_SOLVER_LU=1,
+            SPLIT_SOLVER_ILU=2,
+            SPLIT_SOLVER_GAMG=3,
+            SPLIT_SOLVER_RADIAL_LU=4,       // Separate LU factorization for each radius
+            SPLIT_SOLVER_RADIAL_DENSE=5,    // Inverse of the dense block of each radius (fluid unknowns)
+            SPLIT_SOLVER_MG=6               // Geometric multigrid on the momentum grid of each radius
+        };
+        // Lines relaxed by the smoother of the multigrid split solver
+        enum mg_lines {
+            MG_LINES_P=1,
+            MG_LINES_XI=2,
+            MG_LINES_ALTERNATING=3
+        };
+        // Group of unknowns forming one split of the
+        // field-split preconditioner
+        struct split {
+            std::string name;
+            std::vector<len_t> unknowns;    // IDs of unknown quantities in split
+            enum split_solver solver;
+            enum mg_lines mgLines=MG_LINES_ALTERNATING;
+
+            // Set up internally by the solver
+            std::vector<PetscInt> rows={};      // Matrix rows belonging to split (in split order)
+            std::vector<PetscInt> radialBlocks={}; // Number of rows in each radial block of split
+            std::vector<PetscInt> radialNp1={};    // Number of cells along p (first momentum coordinate) in each radial block
+        };
+
+        // Maximum number of levels of the multigrid split solver, and
+        // minimum number of cells along a momentum coordinate for the
+        // coordinate to be coarsened
+        static constexpr len_t MG_MAX_LEVELS = 8;
+        static constexpr PetscInt MG_MIN_COARSEN = 6;
+
     private:
         Vec x;
 
@@ -17,10 +54,27 @@ namespace DREAM::FVM {
 
         PetscInt *blocks;
         len_t nBlocks;
+
+        std::vector<struct split> splits;
+        bool splitsConfigured = false, blocksConfigured = false;
+
+        void ConfigureFieldSplit(std::vector<len_t>&, UnknownQuantityHandler*);
+        void OrderByRadius(struct split&, const std::vector<PetscInt>&, UnknownQuantityHandler*);
+        void ConfigureSplitSolvers();
+        void ConfigureBlockSolvers();
+        void ConfigureRadialBlocks(KSP, struct split&);
+        void ConfigureDenseBlocks(KSP, struct split&);
+        void ConfigureMultigrid(KSP, struct split&);
+        void ConfigureLineSmoother(KSP, const std::vector<PetscInt>&, const std::vector<PetscInt>&, enum mg_lines);
+        Mat CreateProlongation(
+            const std::vector<PetscInt>&, const std::vector<PetscInt>&,
+            const std::vector<PetscInt>&, const std::vector<PetscInt>&
+        );
+        bool IsRadiallyBlockDiagonal(Matrix*, const struct split&);
 	public:
 		MIGMRES(const len_t, std::vector<len_t>&, UnknownQuantityHandler*,
             PetscErrorCode (*)(KSP, PetscInt, PetscReal, KSPConvergedReason*, void*),
-            void*
+            void*, const std::vector<struct split>& splits={}
         );
         ~MIGMRES();
 
@@ -29,6 +83,7 @@ namespace DREAM::FVM {
             PetscErrorCode (*)(KSP, PetscInt, PetscReal, KSPConvergedReason*, void*),
             void*
         );
+        virtual void SetRelativeTolerance(const real_t) override;
 	};
 }
 
@@ -0,0 +1,40 @@
+#ifndef _DREAM_FVM_MATRIX_INVERTER_MIXED_PRECISION_HPP
+#define _DREAM_FVM_MATRIX_INVERTER_MIXED_PRECISION_HPP
+
+#include <petscksp.h>
+#include "FVM/config.h"
+#include "FVM/MatrixInverter.hpp"
+
+namespace DREAM::FVM {
+	class MIMixedPrecision : public MatrixInverter {
+    public:
+        // Method used to recover full accuracy from the
+        // low-precision factorization
+        enum refinement_method {
+            REFINEMENT_METHOD_RICHARDSON=1,     // Classical iterative refinement
+            REFINEMENT_METHOD_GMRES=2           // GMRES preconditioned by the factorization
+        };
+
+        struct options {
+            enum refinement_method method = REFINEMENT_METHOD_RICHARDSON;
+            // Relative accuracy of the (compressed) factorization
+            real_t factortol = 1e-7;
+            // Relative tolerance and maximum number of iterations
+            // of the refinement
+            real_t reltol = 1e-12;
+            len_t maxiter = 20;
+        };
+
+    private:
+        struct options opts;
+        len_t xn;
+
+	public:
+		MIMixedPrecision(const len_t, const struct options&);
+        ~MIMixedPrecision();
+
+		virtual void Invert(Matrix*, Vec*, Vec*) override;
+	};
+}
+
+#endif/*_DREAM_FVM_MATRIX_INVERTER_MIXED_PRECISION_HPP*/
@@ -0,0 +1,75 @@
+#ifndef _DREAM_FVM_TERM_TIMINGS_HPP
+#define _DREAM_FVM_TERM_TIMINGS_HPP
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <softlib/SFile.h>
+#include "FVM/config.h"
+
+namespace DREAM::FVM {
+    class TermTimings {
+    public:
+        // Part of the equation system assembly being timed
+        enum phase {
+            PHASE_REBUILD,
+            PHASE_JACOBIAN,
+            PHASE_MATRIX,
+            PHASE_VECTOR,
+            N_PHASES
+        };
+
+        // Accumulated statistics for all terms with a given name.
+        // Times (in nanoseconds) exclude time spent in nested terms.
+        struct summary {
+            len_t count[N_PHASES] = {0};
+            int64_t time[N_PHASES] = {0};
+        };
+
+        /**
+         * RAII helper for timing one call to an equation term. The
+         * cost of a scope when term timing is disabled is a single
+         * branch.
+         */
+        class Scope {
+        private:
+            bool active;
+        public:
+            Scope(const std::string& name, const enum phase p)
+                : active(TermTimings::enabled) { if (active) TermTimings::Begin(name, p); }
+            ~Scope() { if (active) TermTimings::End(); }
+        };
+
+    private:
+        // Term currently being timed on this thread
+        struct frame {
+            std::string name;
+            enum phase ph;
+            int64_t start, children;
+        };
+
+        static inline bool enabled = false;
+
+        static inline std::mutex mtx;
+        static inline std::map<std::string, struct summary> summaries;
+
+        // Stack of currently timed (nested) terms on each thread
+        static inline thread_local std::vector<struct frame> termStack;
+
+        static int64_t Now();
+
+    public:
+        static void Configure(const bool enable);
+        static bool IsEnabled() { return enabled; }
+
+        static void Begin(const std::string&, const enum phase);
+        static void End();
+
+        static void PrintSummary(const len_t n);
+        static void SaveSummary(SFile*, const std::string& path);
+    };
+}
+
+#endif/*_DREAM_FVM_TERM_TIMINGS_HPP*/
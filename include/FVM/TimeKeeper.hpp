@@ -5,6 +5,7 @@
 #include <string>
 #include <vector>
 #include "FVM/DurationTimer.hpp"
+#include "FVM/PerfCounters.hpp"
 
 namespace DREAM::FVM {
     class TimeKeeper {
@@ -13,6 +14,11 @@ namespace DREAM::FVM {
             DurationTimer *timer;
             std::string longname;
             std::string shortname;
+            // Depth of the corresponding scope in the 'Tracer'
+            len_t traceDepth;
+            // Hardware counter values when the timer was started, and
+            // accumulated counts while running (see 'PerfCounters')
+            struct PerfCounters::values counterStart, counterAccum;
 
             ~tk() { delete timer; }
         };
@@ -30,6 +36,7 @@ namespace DREAM::FVM {
 
         void PrintTimings(bool printTitle=true, const int_t normalizeto=0);
         void SaveTimings(SFile*, const std::string& path="");
+        void SaveCounters(SFile*, const std::string& path);
     };
 }
 
@@ -0,0 +1,80 @@
+#ifndef _DREAM_FVM_TRACER_HPP
+#define _DREAM_FVM_TRACER_HPP
+
+#include <chrono>
+#include <map>
+#include <mutex>
+#include <string>
+#include <vector>
+#include <softlib/SFile.h>
+#include "FVM/config.h"
+
+namespace DREAM::FVM {
+    class Tracer {
+    public:
+        // Completed trace event
+        struct event {
+            std::string name, category;
+            int64_t start, duration;   // Microseconds
+            len_t thread;
+        };
+        // Accumulated statistics for a scope (identified by its
+        // full path in the scope hierarchy)
+        struct summary {
+            len_t count = 0;
+            int64_t total = 0, self = 0;
+        };
+
+        /**
+         * RAII helper for tracing a scope. The cost of a scope
+         * when tracing is disabled is a single branch.
+         */
+        class Scope {
+        private:
+            bool active;
+            len_t depth = 0;
+        public:
+            Scope(const char *name, const char *category="dream")
+                : active(Tracer::enabled) { if (active) depth = Tracer::Begin(name, category); }
+            Scope(const std::string& name, const char *category="dream")
+                : active(Tracer::enabled) { if (active) depth = Tracer::Begin(name, category); }
+            ~Scope() { if (active) Tracer::End(depth); }
+        };
+
+    private:
+        // Open (not yet completed) scope
+        struct frame {
+            std::string path;
+            const char *category;
+            int64_t start, children;
+        };
+
+        static inline bool enabled = false;
+        static inline len_t maxEvents = 0;
+        static inline bool eventsTruncated = false;
+
+        static inline std::mutex mtx;
+        static inline std::vector<struct event> events;
+        static inline std::map<std::string, struct summary> summaries;
+        static inline std::chrono::steady_clock::time_point t0;
+
+        // Stack of currently open (nested) scopes on each thread
+        static inline thread_local std::vector<struct frame> scopeStack;
+
+        static int64_t Now();
+        static len_t ThreadID();
+        static void Record(const struct frame&, const int64_t);
+
+    public:
+        static void Configure(const bool enable, const len_t maxEvents);
+        static bool IsEnabled() { return enabled; }
+
+        static len_t Begin(const std::string&, const char*);
+        static void End(const len_t);
+
+        static void SaveSummary(SFile*, const std::string& path);
+        static void WriteChromeTrace(const std::string& filename);
+    };
+}
+
+#endif/*_DREAM_FVM_TRACER_HPP*/
@@ -43,12 +43,14 @@ namespace DREAM::FVM {
         real_t *GetData() { return this->data->Get(); }
         real_t *GetDataPrevious() { return this->data->GetPrevious(); }
         real_t *GetInitialData() { return this->data->GetInitialData(); }
+        QuantityData *GetQuantityData() { return this->data; }
         Grid *GetGrid() { return this->grid; }
         const std::string& GetDescription() const { return this->description; }
         const std::string& GetEquationDescription() const { return this->description_eqn; }
         const std::string& GetName() const { return this->name; }
 
         bool HasChanged() const { return data->HasChanged(); }
+        len_t GetVersion() const { return data->GetVersion(); }
         bool HasInitialValue() const { return data->HasInitialValue(); }
 
         len_t NumberOfElements() const { return grid->GetNCells() * this->nMultiples; }
@@ -63,6 +65,7 @@ namespace DREAM::FVM {
 
         void SaveSFile(SFile *sf, const std::string& path="", bool saveMeta=false);
         void SaveSFileCurrent(SFile *sf, const std::string& path="", bool saveMeta=false);
+        void SaveSFileTime(SFile *sf, const std::string& path="");
 
         void SetInitialValue(const real_t*, const real_t t0=0);
     };
@@ -14,6 +14,26 @@ namespace DREAM::FVM {
     private:
         std::vector<UnknownQuantity*> unknowns;
 
+        // Variable-order BDF time derivative
+        static constexpr len_t MAX_BDF_ORDER = 5;
+        len_t maxBDFOrder = 1, bdfOrder = 1;
+        // Version of the currently prepared BDF coefficients
+        // (passed on to 'QuantityData::GetOldStepCombination()')
+        len_t bdfVersion = 0;
+        // Time step for which the BDF coefficients were prepared,
+        // and the corresponding effective time step 1/alpha_0
+        real_t bdfStep = 0, bdfTimeStep = 0;
+        // Old steps combined into the effective "previous" value,
+        // and their weights
+        len_t bdfIndices[MAX_BDF_ORDER];
+        real_t bdfWeights[MAX_BDF_ORDER];
+        // Number of old time steps which the time stepper needs
+        // to be able to roll back
+        len_t nOldStepsTimeStepper = 4;
+
+        len_t GetNSaveOldSteps() const;
+        void UpdateNSaveOldSteps();
+
     public:
         UnknownQuantityHandler();
         ~UnknownQuantityHandler();
@@ -39,9 +59,11 @@ namespace DREAM::FVM {
         real_t *GetUnknownDataPrevious(const len_t);
         real_t *GetUnknownDataPrevious(const std::string&);
         real_t *GetUnknownInitialData(const len_t);
+        real_t *GetUnknownDataTransientPrevious(const len_t, const real_t);
         const std::vector<UnknownQuantity*>& GetUnknowns() const { return this->unknowns; }
 
         bool HasChanged(const len_t id) const { return unknowns[id]->HasChanged(); }
+        len_t GetVersion(const len_t id) const { return unknowns[id]->GetVersion(); }
         bool HasInitialValue(const len_t id) const { return unknowns[id]->HasInitialValue(); }
         bool HasUnknown(const std::string&);
         len_t InsertUnknown(const std::string&, const std::string&, Grid*, const len_t nMultiples=1);
@@ -55,6 +77,13 @@ namespace DREAM::FVM {
         void RollbackSaveStep();
         void SaveStep(const real_t t, bool trueSave);
 
+        len_t GetBDFOrder() const { return this->bdfOrder; }
+        len_t GetMaximumBDFOrder() const { return this->maxBDFOrder; }
+        real_t GetTransientTimeStep(const real_t);
+        void PrepareTimeDerivative(const real_t, const len_t maxOrder=MAX_BDF_ORDER);
+        void SetMaximumBDFOrder(const len_t);
+        void SetTimeStepperHistoryDepth(const len_t);
+
         void SaveSFile(const std::string& filename, bool saveMeta=false);
         void SaveSFile(SFile*, const std::string& path="", bool saveMeta=false);
         void SaveSFileCurrent(const std::string& filename, bool saveMeta=false);
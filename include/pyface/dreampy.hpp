@@ -6,6 +6,15 @@
 
 extern "C" {
     static PyObject *dreampy_run(PyObject*, PyObject*);
+    static PyObject *dreampy_simulation_new(PyObject*, PyObject*);
+    static PyObject *dreampy_simulation_step(PyObject*, PyObject*);
+    static PyObject *dreampy_simulation_solve(PyObject*, PyObject*);
+    static PyObject *dreampy_simulation_save(PyObject*, PyObject*);
+    static PyObject *dreampy_simulation_output(PyObject*, PyObject*);
+    static PyObject *dreampy_simulation_time(PyObject*, PyObject*);
+    static PyObject *dreampy_simulation_unknowns(PyObject*, PyObject*);
+    static PyObject *dreampy_simulation_get_unknown(PyObject*, PyObject*);
+    static PyObject *dreampy_simulation_get_prescribed(PyObject*, PyObject*);
 }
 
 #endif/*_DREAM_PYFACE_HPP*/
@@ -14,7 +14,7 @@ class ConvergenceScan:
 
 
     def __init__(self, settings, inparams=None, outparams=None, scanUntilConvergence=False,
-                 verbose=True):
+                 verbose=True, warmstart=None, nprocesses=1):
         """
         Creates a new ConvergenceScan object with 'settings' representing
         the settings for the baseline scenario.
@@ -24,6 +24,8 @@ class ConvergenceScan:
         :param list outparams:            Either a string (or a list of strings), specifying the set(s) of parameters to measure for convergence. Alternatively, ``None`` clears all output parameters (which must then be explicitly set using ``addOutputParameter()`` later).
         :param bool scanUntilConvergence: If ``True``, does not limit the number of runs to do and updates the value of each parameter until the output parameter changes less than the given tolerance.
         :param bool verbose:              If ``True``, prints progress message to stdout when running.
+        :param str warmstart:             If not ``None``, name of file to save the baseline output to. All scan runs are then warm-started from the baseline solution (see :py:meth:`DREAM.Settings.Solver.Solver.setWarmStart`).
+        :param int nprocesses:            Number of DREAM processes to run concurrently. If larger than one, all runs of non-adaptive scan parameters are run at the same time, and adaptive scan parameters are run speculatively ``nprocesses`` indices at a time.
         """
         self.settings = settings
         self.scanParameters = dict()
@@ -32,6 +34,8 @@ class ConvergenceScan:
         self.result = {}
         self.baselineOutput = None
         self.verbose = verbose
+        self.warmstart = warmstart
+        self.nprocesses = int(nprocesses)
 
         # Maximum number of iterations if running scan adaptively
         self.NMAX = 10
@@ -200,9 +204,16 @@ class ConvergenceScan:
         """
         self.result = {}
 
+        if self.nprocesses > 1:
+            self._runParallel()
+            return
+
         # Run baseline case
         self._status(':: Running baseline case...')
-        self.baselineOutput = runiface.runiface(self.settings, quiet=not self.verbose)
+        if self.warmstart is not None:
+            self.settings.solver.setSaveJacobianPattern(True)
+
+        self.baselineOutput = runiface.runiface(self.settings, outfile=self.warmstart, quiet=not self.verbose)
 
         # Iterate over scan parameters
         for scanParameter, sp in self.scanParameters.items():
@@ -224,21 +235,102 @@ class ConvergenceScan:
                     self._processOutput(i, scanParameter, scanValue, output)
                     
 
-    def _runScan(self, index, scanParameter):
+    def _runParallel(self):
         """
-        Run an individual DREAM simulation corresponding to index
-        'index' in the scan parameter 'scanParameter'.
+        Run the convergence scan with 'self.nprocesses' concurrent
+        DREAM processes. Since the convergence of a scan parameter is
+        determined by comparing consecutive runs, the outputs are always
+        processed in order of increasing index.
+        """
+        runs = []
+        if self.warmstart is None:
+            runs.append((None, 0))
+        else:
+            # The baseline must be available as reference for the other runs
+            self._status(':: Running baseline case...')
+            self.settings.solver.setSaveJacobianPattern(True)
+            self.baselineOutput = runiface.runiface(self.settings, outfile=self.warmstart, quiet=not self.verbose)
 
-        index:         Index in scan of this simulation.
-        scanParameter: Name of scan parameter settings specifying the scan.
+        # Next index to run and last index allowed for each scan parameter
+        pending = {}
+        for scanParameter, sp in self.scanParameters.items():
+            s = sp['startindex']
+            if sp['scanUntilConvergence']:
+                pending[scanParameter] = [s, self.NMAX + s]
+            else:
+                runs += [(scanParameter, i) for i in range(s, sp['nvalues']+s)]
+
+        converged = {}
+        while len(runs) > 0 or len(pending) > 0:
+            # Schedule the next indices of the adaptive scans
+            for scanParameter, (i, n) in pending.items():
+                k = min(i + self.nprocesses, n)
+                runs += [(scanParameter, j) for j in range(i, k)]
+                pending[scanParameter][0] = k
+
+            settings, scanValues = [], []
+            for scanParameter, index in runs:
+                if scanParameter is None:
+                    ns, scanValue = self.settings, None
+                else:
+                    ns, scanValue = self._prepareScan(index, scanParameter)
+
+                if ns is not None:
+                    settings.append(ns)
+                scanValues.append(scanValue)
+
+            def report(i, output):
+                self._status(':: Finished simulation {}/{}'.format(i+1, len(settings)))
+
+            self._status(':: Running {} simulations in {} processes...'.format(len(settings), min(self.nprocesses, len(settings))))
+            outputs = runiface.runiface_parallel(settings, quiet=not self.verbose, nprocesses=self.nprocesses, callback=report)
+
+            # Assign outputs to runs (the baseline case is not re-run)
+            j = 0
+            results = []
+            for (scanParameter, index), scanValue in zip(runs, scanValues):
+                if scanParameter is None:
+                    self.baselineOutput = outputs[j]
+                    j += 1
+                elif index == 0:
+                    results.append((scanParameter, index, self.scanParameters[scanParameter]['baseline'], None))
+                else:
+                    results.append((scanParameter, index, scanValue, outputs[j]))
+                    j += 1
+
+            for scanParameter, index, scanValue, output in results:
+                if scanParameter in converged:
+                    continue
+
+                if output is None:
+                    output = self.baselineOutput
+
+                cv = self._processOutput(index, scanParameter, scanValue, output)
+                if scanParameter in pending and cv:
+                    converged[scanParameter] = True
+
+            # Remove finished adaptive scans
+            for scanParameter in list(pending.keys()):
+                i, n = pending[scanParameter]
+                if scanParameter in converged or i >= n:
+                    del pending[scanParameter]
+
+            runs = []
+
+
+    def _prepareScan(self, index, scanParameter):
+        """
+        Construct the settings for the DREAM simulation corresponding
+        to index 'index' in the scan parameter 'scanParameter'.
+
+        RETURNS a tuple consisting of the settings object (or ``None``
+        for the baseline case) and the value of the scan parameter.
         """
         sp = self.scanParameters[scanParameter]
-        self._status(':: Scan {} ({}/{}) in parameter {}'.format(index, index-sp['startindex']+1, sp['nvalues'], scanParameter))
 
         # Skip the baseline case
         if index == 0:
-            self._status(':: Skipping baseline case')
-            return self.baselineOutput, sp['baseline']
+            return None, sp['baseline']
 
         f = sp['f']
         # Copy DREAMSettings object
@@ -247,6 +339,30 @@ class ConvergenceScan:
         # Modify the settings
         ns, scanValue = f(index, ns, sp['baseline'])
 
+        # Unknowns whose size is changed by the scan parameter
+        # are ignored when warm-starting the simulation
+        if self.warmstart is not None:
+            ns.solver.setWarmStart(self.warmstart)
+
+        return ns, scanValue
+
+
+    def _runScan(self, index, scanParameter):
+        """
+        Run an individual DREAM simulation corresponding to index
+        'index' in the scan parameter 'scanParameter'.
+
+        index:         Index in scan of this simulation.
+        scanParameter: Name of scan parameter settings specifying the scan.
+        """
+        sp = self.scanParameters[scanParameter]
+        self._status(':: Scan {} ({}/{}) in parameter {}'.format(index, index-sp['startindex']+1, sp['nvalues'], scanParameter))
+
+        ns, scanValue = self._prepareScan(index, scanParameter)
+        if ns is None:
+            self._status(':: Skipping baseline case')
+            return self.baselineOutput, scanValue
+
         return runiface.runiface(ns), scanValue
 
 
@@ -76,6 +76,33 @@ class DREAMOutput:
             self.h5handle.close()
 
 
+    def _loadGridStore(self, grid, name):
+        """
+        Load the grid data which has been stored in a separate grid
+        file (see :py:meth:`DREAM.Settings.Output.Output.setGridStore`)
+        and merge it with the time grid stored in the output.
+
+        :param dict grid: Grid data stored in the output file.
+        :param str name:  Name of the output file.
+        """
+        gsname = grid['gridstore'][:]
+
+        # A relative path is taken relative to the directory in which
+        # the simulation was run, which is usually the directory of the
+        # output file
+        if not os.path.isfile(gsname) and not os.path.isabs(gsname):
+            alt = os.path.join(os.path.dirname(name), gsname)
+            if os.path.isfile(alt):
+                gsname = alt
+
+        if not os.path.isfile(gsname):
+            print("WARNING: The grid file '{}' referenced by '{}' does not exist.".format(gsname, name))
+            return grid
+
+        gdata = DREAMIO.LoadHDF5AsDict(gsname, lazy=False)
+        return merge_dicts(gdata, {k: v for k, v in grid.items() if k != 'gridstore'})
+
+
     def _getsolver(self, solverdata, output):
         if 'type' in solverdata:
             if solverdata['type'] == SettingsSolver.LINEAR_IMPLICIT:
@@ -102,7 +129,27 @@ class DREAMOutput:
 
         od, self.h5handle, self.filesize = DREAMIO.LoadHDF5AsDict(filename, path=path, returnhandle=True, returnsize=True, lazy=lazy)
 
+        return self.loadDict(od, loadsettings=loadsettings, lazy=lazy, name=filename)
+
+
+    def loadDict(self, od, loadsettings=True, lazy=False, name='<memory>'):
+        """
+        Loads DREAM output from the given dictionary, which has the same
+        structure as the output file (e.g. as returned by
+        :py:meth:`DREAM.pyface.DREAMSimulation.getOutput`, which generates
+        the output in memory without writing it to disk).
+
+        :param dict od:           Dictionary containing the output.
+        :param bool loadsettings: If ``True``, load the settings stored in the output object.
+        :param bool lazy:         If ``True``, the data in ``od`` consists of ``DataObject`` objects.
+        :param str name:          Name of the output (used in warning messages).
+        """
+        filename = name
+
         if 'grid' in od:
+            if 'gridstore' in od['grid']:
+                od['grid'] = self._loadGridStore(od['grid'], name)
+
             self.grid = Grid(od['grid'])
         else:
             print("WARNING: No grid found in '{}'.".format(filename))
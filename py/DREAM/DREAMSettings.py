@@ -6,6 +6,7 @@ import copy
 import numpy as np
 import os
 from . import DREAMIO as DREAMIO
+from .DREAMException import DREAMException
 from . helpers import merge_dicts
 
 # Settings objects
@@ -166,7 +167,7 @@ class DREAMSettings:
         self.init['eqsysignore'] = []
 
 
-    def fromOutput(self, filename, relpath=False, ignore=list(), timeindex=-1):
+    def fromOutput(self, filename, relpath=False, ignore=list(), timeindex=-1, conservative=None):
         """
         Specify that the simulation should be initialized from the
         DREAM output stored in the named file. Some unknown quantities
@@ -181,6 +182,9 @@ class DREAMSettings:
         ignore:    List of unknown quantities to initialize as usual, and
                    thus NOT from the specified output file.
         timeindex: Index of time point to use for initializing the simulation.
+        conservative: If 'True', radial profiles are remapped conservatively
+                   (instead of being interpolated linearly) when the
+                   radial grid differs from that of the output.
         """
         # Input as relative or absolute path?
         if relpath:
@@ -196,6 +200,49 @@ class DREAMSettings:
         self.init['fromfile']   = fname
         self.init['eqsysignore'] = ignore
         self.init['timeindex']  = timeindex
+        if conservative is not None:
+            self.init['conservative'] = bool(conservative)
+
+
+    def setGridContinuation(self, nt, factor=2):
+        """
+        Solve the first time steps of the simulation on coarser grids,
+        and initialize the simulation from the coarse solution. The
+        coarse solution is written to a separate output file (named
+        as the regular output file, with '_coarse' appended to the
+        base name), and the output of the simulation starts where the
+        coarse simulation ended (with the time axis restarting at zero).
+        Requires the constant time stepper.
+
+        nt:     Number of time steps to solve on the coarse grids
+                (0 = disable).
+        factor: Factor by which the number of grid points in each
+                dimension is reduced on the coarse grids.
+        """
+        if nt < 0:
+            raise DREAMException("The number of time steps on the coarse grids must be non-negative.")
+        if factor < 1:
+            raise DREAMException("The grid continuation factor must be at least 1.")
+
+        self.init['continuation_nt'] = int(nt)
+        self.init['continuation_factor'] = int(factor)
+
+
+    def setInitializationThreads(self, nthreads=1, printtimings=None):
+        """
+        Set the number of threads to use for initializing unknown
+        quantities which do not depend on each other.
+
+        nthreads:     Number of threads to use (default: 1).
+        printtimings: If 'True', prints the time spent on initializing
+                      each unknown quantity.
+        """
+        if nthreads < 1:
+            raise DREAMException("The number of threads must be at least 1.")
+
+        self.init['nthreads'] = int(nthreads)
+        if printtimings is not None:
+            self.init['printtimings'] = bool(printtimings)
 
 
     def load(self, filename, path="", lazy=False):
@@ -238,6 +285,16 @@ class DREAMSettings:
             data['init']['filetimeindex'] = self.init['timeindex']
         if 'fromfile' in self.init:
             data['init']['fromfile'] = self.init['fromfile']
+        if 'conservative' in self.init:
+            data['init']['conservative'] = self.init['conservative']
+        if 'nthreads' in self.init:
+            data['init']['nthreads'] = self.init['nthreads']
+        if 'printtimings' in self.init:
+            data['init']['printtimings'] = self.init['printtimings']
+        if 'continuation_nt' in self.init:
+            data['init']['continuation_nt'] = self.init['continuation_nt']
+        if 'continuation_factor' in self.init:
+            data['init']['continuation_factor'] = self.init['continuation_factor']
 
         return data
 
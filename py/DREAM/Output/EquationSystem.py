@@ -125,8 +125,8 @@ class EquationSystem:
         Add a list of unknowns to this equation system.
         """
         for uqn in unknowns:
-            # Skip attributes
-            if uqn[-2:] == '@@': continue
+            # Skip attributes and time grids
+            if uqn[-2:] == '@@' or uqn[-2:] == '@t': continue
 
             attr = []
             if uqn+'@@' in unknowns:
@@ -134,6 +134,11 @@ class EquationSystem:
 
             self.setUnknown(name=uqn, data=unknowns[uqn], attr=attr)
 
+            # Unknowns of which only the final step was stored
+            # have their own time grid
+            if uqn+'@t' in unknowns:
+                self.unknowns[uqn].time = np.atleast_1d(unknowns[uqn+'@t'][:])
+
 
     def resetUnknown(self, unknown, datatype):
         """
@@ -2,6 +2,7 @@
 import numpy as np
 
 from .. Settings.MomentumGrid import TYPE_PXI, TYPE_PPARPPERP
+from .OutputException import OutputException
 
 
 class MomentumGrid:
@@ -32,6 +33,13 @@ class MomentumGrid:
         self.dp1  = data['dp1']
         self.dp2  = data['dp2']
 
+        # If the p2 grid varies with radius, the p2 grids of all radii
+        # are stored one after the other (with 'np2' cells at each
+        # radius), and 'Vprime' is a flat array
+        self.np2 = None
+        if 'np2' in data:
+            self.np2 = np.array(data['np2'][:], dtype=np.int64).flatten()
+            return
 
         self.Vprime_VpVol = np.copy(self.Vprime[:])
         for i in range(0, self.rgrid.r.size):
@@ -50,6 +58,7 @@ class MomentumGrid:
         """
         if len(axes) != 3:
             raise OutputException("Invalid 'axes' parameter provided to 'integrate3D()'.")
+        self._checkRadiallyUniform('integrate3D')
 
         return (data * self.Vprime * self.DR * self.DP1 * self.DP2).sum(axes)
 
@@ -64,9 +73,26 @@ class MomentumGrid:
         """
         if len(axes) != 2:
             raise OutputException("Invalid 'axes' parameter provided to 'integrate2D()'.")
+        self._checkRadiallyUniform('integrate2D')
         return (data * self.Vprime_VpVol * self.DP1 * self.DP2).sum(axes)
 
 
+    def isRadiallyUniform(self):
+        """
+        Returns ``True`` if the same momentum grid is used at all radii.
+        """
+        return self.np2 is None
+
+
+    def _checkRadiallyUniform(self, method):
+        """
+        Raise an exception if the momentum grid varies with radius
+        (in which case the named method is not supported).
+        """
+        if not self.isRadiallyUniform():
+            raise OutputException("'{}()' is not supported for momentum grids which vary with radius.".format(method))
+
+
     def getGamma(self):
         """
         Returns a meshgrid representing the relativistic factor on
@@ -118,6 +118,12 @@ class OtherQuantities:
                 #raise Exception("Unrecognized number of dimensions of other quantity '{}': {}.".format(name, data.ndim))
                 o = OtherQuantity(name=name, data=data, description=desc, grid=self.grid, output=self.output)
 
+        # The Legendre moments are stored with the mode and
+        # momentum indices as a single dimension
+        if name == 'f_legendre' and self.momentumgrid is not None and o.data.ndim == 3:
+            np1 = self.momentumgrid.p1.size
+            o.data = o.data[:].reshape((o.data.shape[0], -1, np1, o.data.shape[2]))
+
         setattr(self, name, o)
         self.quantities[name] = o
 
@@ -127,8 +133,8 @@ class OtherQuantities:
         Add a list of other quantities to this handler.
         """
         for oqn in quantities:
-            # Skip attribute containers
-            if oqn[-2:] == '@@': continue
+            # Skip attribute containers and time grids
+            if oqn[-2:] == '@@' or oqn[-2:] == '@t': continue
 
             # Is there an attribute container for this quantity?
             if oqn+'@@' in quantities:
@@ -136,6 +142,10 @@ class OtherQuantities:
             else:
                 self.setQuantity(name=oqn, data=quantities[oqn])
 
+            # Quantities with a custom output cadence have their own time grid
+            if oqn+'@t' in quantities:
+                self.quantities[oqn].time = np.atleast_1d(quantities[oqn+'@t'][:])
+
 
     def resetQuantity(self, quantity, datatype):
         """
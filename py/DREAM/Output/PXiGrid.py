@@ -28,6 +28,9 @@ class PXiGrid(MomentumGrid):
         self.dp = data['dp1']
         self.dxi = data['dp2']
 
+        if not self.isRadiallyUniform():
+            return
+
         self.P, self.XI = np.meshgrid(self.p[:], self.xi[:])
         self.PPAR = self.P*self.XI
         self.PPERP = self.P*np.sqrt(1-self.XI**2)
@@ -18,6 +18,98 @@ class SolverNonLinear(Solver):
         self.iterations = [int(x) for x in solverdata['iterations'][:]]
         self.backupinverter = [x==1 for x in solverdata['backupinverter'][:]]
 
+        if 'factorizations' in solverdata:
+            self.factorizations = [int(x) for x in solverdata['factorizations'][:]]
+        else:
+            self.factorizations = None
+
+        if 'equilibration' in solverdata:
+            eq = solverdata['equilibration']
+            self.equilibration = {
+                'rowratio_before': np.array(eq['rowratio_before'][:]).flatten(),
+                'rowratio_after': np.array(eq['rowratio_after'][:]).flatten()
+            }
+        else:
+            self.equilibration = None
+
+        if 'telemetry' in solverdata:
+            self.telemetry = self.loadTelemetry(solverdata['telemetry'])
+        else:
+            self.telemetry = None
+
+        if 'reducedmodel' in solverdata:
+            self.reducedmodel = [x==1 for x in solverdata['reducedmodel'][:]]
+        else:
+            self.reducedmodel = None
+
+        if 'localizediterations' in solverdata:
+            self.localizediterations = [int(x) for x in solverdata['localizediterations'][:]]
+        else:
+            self.localizediterations = None
+
+        if 'adjoint' in solverdata:
+            self.adjoint = self.loadAdjoint(solverdata['adjoint'])
+        else:
+            self.adjoint = None
+
+
+    def loadTelemetry(self, tel):
+        """
+        Load the convergence telemetry of the solver. Per-iteration
+        quantities are returned as 1D arrays, except ``residual`` and
+        ``solution`` which are indexed as ``[iteration, unknown]``,
+        with the names of the unknowns given in ``unknowns``.
+        """
+        names = tel['unknowns']
+        if type(names) == bytes:
+            names = names.decode('utf-8')
+        elif not isinstance(names, str):
+            names = names[:]
+            if type(names) == bytes:
+                names = names.decode('utf-8')
+
+        d = {'unknowns': [n for n in str(names).split(';') if n != '']}
+        for key in ['step', 'iteration', 'kspiterations']:
+            d[key] = np.array(tel[key][:], dtype=int).flatten()
+        for key in ['damping', 'fill']:
+            d[key] = np.array(tel[key][:]).flatten()
+
+        nu = len(d['unknowns'])
+        for key in ['residual', 'solution']:
+            d[key] = np.array(tel[key][:]).reshape((-1, nu))
+
+        if 'timestepper' in tel:
+            ts = tel['timestepper']
+            d['rejected'] = np.array(ts['rejected'][:], dtype=int).flatten()
+            d['exceptions'] = np.array(ts['exceptions'][:], dtype=int).flatten()
+
+        return d
+
+
+    def loadAdjoint(self, adj):
+        """
+        Load the objective and the gradient evaluated with the
+        adjoint method. The gradient is returned both as an array
+        (``gradient``) and as a dictionary mapping parameter names
+        to derivatives (``sensitivities``).
+        """
+        names = adj['parameters']
+        if not isinstance(names, (str, bytes)):
+            names = names[:]
+        if type(names) == bytes:
+            names = names.decode('utf-8')
+
+        params = [n for n in str(names).split(';') if n != '']
+        objective = float(np.array(adj['objective'][:]).flatten()[0])
+        gradient = np.array(adj['gradient'][:]).flatten() if len(params) > 0 else np.array([])
+
+        return {
+            'parameters': params,
+            'objective': objective,
+            'gradient': gradient,
+            'sensitivities': {p: gradient[i] for i, p in enumerate(params)}
+        }
+
 
     def __str__(self):
         """
@@ -28,6 +120,13 @@ class SolverNonLinear(Solver):
         s += "Max. iterations: {}\n".format(max(self.iterations))
         s += "Avg. iterations: {}\n".format(sum(self.iterations)/len(self.iterations))
         s += "Min. iterations: {}\n\n".format(min(self.iterations))
+
+        if self.factorizations is not None:
+            s += "Jacobian factorizations: {}\n\n".format(sum(self.factorizations))
+
+        if self.equilibration is not None and self.equilibration['rowratio_before'].size > 0:
+            s += "Max. row scaling ratio before equilibration: {:.3e}\n".format(np.max(self.equilibration['rowratio_before']))
+            s += "Max. row scaling ratio after equilibration:  {:.3e}\n\n".format(np.max(self.equilibration['rowratio_after']))
         
         bi = sum(self.backupinverter)
         if bi == 0:
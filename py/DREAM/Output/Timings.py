@@ -19,6 +19,11 @@ class Timings:
         self.output  = output
         self.descriptions = {}
         self.subtimers = []
+        self.trace = None
+        self.terms = None
+        self.memory = None
+        self.counters = None
+        self.petsclog = None
 
         if timings is not None:
             self.loadTimingInformation(timings)
@@ -83,7 +88,17 @@ class Timings:
         tim = {}
 
         for key in timings:
-            if key[-2:] == '@@':
+            if key == 'trace':
+                self.loadTraceSummary(timings[key])
+            elif key == 'terms':
+                self.loadTermTimings(timings[key])
+            elif key == 'memory':
+                self.loadMemoryUsage(timings[key])
+            elif key == 'counters':
+                self.loadCounters(timings[key])
+            elif key == 'petsclog':
+                self.loadPETScLog(timings[key])
+            elif key[-2:] == '@@':
                 self.descriptions[key[:-2]] = timings[key]['desc']
             elif type(timings[key]) == float:
                 setattr(self, key, timings[key])
@@ -104,6 +119,157 @@ class Timings:
         self.subtimers = sorted(self.subtimers)
         
 
+    def loadTraceSummary(self, trace):
+        """
+        Load the trace summary from the given dict. The summary is stored
+        in ``self.trace`` as a dict mapping the full path of each traced
+        scope to a dict with the number of calls (``count``), the total
+        time spent in the scope (``total``) and the time spent in the
+        scope excluding nested scopes (``self``), in microseconds.
+        """
+        names = trace['names']
+        if type(names) == DataObject:
+            names = names[:]
+        if type(names) == bytes:
+            names = names.decode('utf-8')
+        names = [n for n in str(names).split(';') if n != '']
+
+        count = np.atleast_1d(trace['count'][:])
+        total = np.atleast_1d(trace['total'][:])
+        slf   = np.atleast_1d(trace['self'][:])
+
+        self.trace = {}
+        for i in range(len(names)):
+            self.trace[names[i]] = {'count': int(count[i]), 'total': total[i], 'self': slf[i]}
+
+
+    def getTraceHotspots(self, n=10):
+        """
+        Returns the ``n`` traced scopes with the largest amount of time
+        spent in the scope itself (i.e. excluding nested scopes), as a
+        list of ``(path, summary)`` tuples.
+        """
+        if self.trace is None:
+            raise DREAMException("No trace information stored in the output.")
+
+        return sorted(self.trace.items(), key=lambda x: x[1]['self'], reverse=True)[:n]
+
+
+    def loadTermTimings(self, terms):
+        """
+        Load the equation term timings from the given dict. The timings
+        are stored in ``self.terms`` as a dict mapping the name of each
+        equation term to a dict with the total number of calls
+        (``count``) and the time spent rebuilding the term (``rebuild``),
+        setting jacobian elements (``jacobian``), setting linear operator
+        matrix elements (``matrix``) and evaluating the term (``vector``),
+        in microseconds.
+        """
+        names = terms['names']
+        if type(names) == DataObject:
+            names = names[:]
+        if type(names) == bytes:
+            names = names.decode('utf-8')
+        names = [n for n in str(names).split(';') if n != '']
+
+        phases = ['rebuild', 'jacobian', 'matrix', 'vector']
+        count = np.atleast_1d(terms['count'][:])
+        data  = {p: np.atleast_1d(terms[p][:]) for p in phases}
+
+        self.terms = {}
+        for i in range(len(names)):
+            self.terms[names[i]] = {'count': int(count[i])}
+            for p in phases:
+                self.terms[names[i]][p] = data[p][i]
+
+            self.terms[names[i]]['total'] = sum([data[p][i] for p in phases])
+
+
+    def loadMemoryUsage(self, memory):
+        """
+        Load the memory usage summary from the given dict. The summary
+        is stored in ``self.memory`` as a dict mapping the name of each
+        category to a dict with the memory used at the end of the
+        simulation (``current``) and the peak memory usage (``peak``),
+        in bytes. The resident memory of the process is stored under
+        the keys ``resident`` and ``peakresident``.
+        """
+        names = memory['names']
+        if type(names) == DataObject:
+            names = names[:]
+        if type(names) == bytes:
+            names = names.decode('utf-8')
+        names = [n for n in str(names).split(';') if n != '']
+
+        current = np.atleast_1d(memory['current'][:])
+        peak    = np.atleast_1d(memory['peak'][:])
+
+        self.memory = {}
+        for i in range(len(names)):
+            self.memory[names[i]] = {'current': current[i], 'peak': peak[i]}
+
+        for key in ['resident', 'peakresident']:
+            v = memory[key]
+            if type(v) == DataObject:
+                v = v[:]
+            self.memory[key] = float(np.atleast_1d(v)[0])
+
+
+    def loadCounters(self, counters):
+        """
+        Load the hardware performance counters accumulated by the timers
+        of this group. The counters are stored in ``self.counters`` as a
+        dict mapping the name of each timer to a dict with the number of
+        ``cycles``, ``instructions``, ``llcreferences`` and ``llcmisses``,
+        together with the derived instructions per cycle (``ipc``) and
+        last-level cache miss ratio (``llcmissratio``).
+        """
+        names = counters['names']
+        if type(names) == DataObject:
+            names = names[:]
+        if type(names) == bytes:
+            names = names.decode('utf-8')
+        names = [n for n in str(names).split(';') if n != '']
+
+        events = ['cycles', 'instructions', 'llcreferences', 'llcmisses']
+        data = {e: np.atleast_1d(counters[e][:]) for e in events}
+
+        self.counters = {}
+        for i in range(len(names)):
+            c = {e: data[e][i] for e in events}
+            c['ipc'] = c['instructions'] / c['cycles'] if c['cycles'] > 0 else 0
+            c['llcmissratio'] = c['llcmisses'] / c['llcreferences'] if c['llcreferences'] > 0 else 0
+
+            self.counters[names[i]] = c
+
+
+    def loadPETScLog(self, petsclog):
+        """
+        Load the PETSc performance summary (as printed with ``-log_view``)
+        and store it as a string in ``self.petsclog``.
+        """
+        if type(petsclog) == DataObject:
+            petsclog = petsclog[:]
+        if type(petsclog) == bytes:
+            petsclog = petsclog.decode('utf-8')
+
+        self.petsclog = str(petsclog)
+
+
+    def getTermHotspots(self, n=10, phase='total'):
+        """
+        Returns the ``n`` equation terms in which the most time was spent,
+        as a list of ``(name, timings)`` tuples.
+
+        :param int n:     Number of terms to return.
+        :param str phase: Part of the assembly to rank terms by (``rebuild``, ``jacobian``, ``matrix``, ``vector`` or ``total``).
+        """
+        if self.terms is None:
+            raise DREAMException("No equation term timings stored in the output.")
+
+        return sorted(self.terms.items(), key=lambda x: x[1][phase], reverse=True)[:n]
+
+
     def getTotal(self):
         """
         Get total simulation time.
@@ -0,0 +1,58 @@
+# Merging of the output written by the processes of a simulation
+# solved with the parareal method (see 'TimeStepper.setParareal()').
+
+
+import numpy as np
+from .DREAMException import DREAMException
+from .DREAMIO import LoadHDF5AsDict, SaveDictAsHDF5
+
+
+def _concatenate(a, b, skip):
+    """
+    Concatenate the time-dependent data of two output dictionaries,
+    skipping the first ``skip`` time points of ``b``.
+    """
+    for name, d in b.items():
+        if name not in a:
+            continue
+        elif type(d) == dict:
+            if type(a[name]) == dict:
+                _concatenate(a[name], d, skip)
+            continue
+
+        d, x = np.asarray(d), np.asarray(a[name])
+        if d.ndim < 1 or x.ndim < 1 or not np.issubdtype(d.dtype, np.number) or d.shape[1:] != x.shape[1:]:
+            continue
+
+        a[name] = np.concatenate((x, d[skip:]), axis=0)
+
+
+def mergeWindows(outputs, filename):
+    """
+    Merge the output files written by the processes of a simulation solved
+    with the parareal method (named ``<output>_window<rank>.h5``) into a
+    single output file, covering the full simulation time. Since every
+    time window begins where the previous one ends, the first time point of
+    all windows but the first is dropped. Data which is not time-dependent
+    (such as grids and settings) is taken from the first window.
+
+    :param list outputs: List of names of the output files of the time windows, in order.
+    :param str filename: Name of file to save the merged output to.
+    """
+    if len(outputs) == 0:
+        raise DREAMException("Parareal: At least one output file is required.")
+
+    data = LoadHDF5AsDict(outputs[0], lazy=False)
+    for fname in outputs[1:]:
+        out = LoadHDF5AsDict(fname, lazy=False)
+
+        t0, t1 = np.asarray(data['grid']['t']).flatten(), np.asarray(out['grid']['t']).flatten()
+        if not np.isclose(t1[0], t0[-1], rtol=1e-10, atol=0):
+            raise DREAMException("Parareal: The time window of '{}' does not begin where the previous window ends.".format(fname))
+
+        data['grid']['t'] = np.concatenate((t0, t1[1:]))
+        _concatenate(data['eqsys'], out['eqsys'], 1)
+        if 'other' in data and 'other' in out:
+            _concatenate(data['other'], out['other'], 0)
+
+    SaveDictAsHDF5(filename, data)
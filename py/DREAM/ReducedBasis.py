@@ -0,0 +1,88 @@
+# Construction of the reduced basis used by the reduced-order model
+# of the non-linear solver (see 'Solver.setReducedModel()').
+
+
+import numpy as np
+from .DREAMException import DREAMException
+from .DREAMIO import LoadHDF5AsDict, SaveDictAsHDF5
+
+
+def buildReducedBasis(outputs, filename, nmodes=None, energy=0.9999):
+    """
+    Construct a reduced basis from the solutions of a set of training runs,
+    using proper orthogonal decomposition (POD), and save it to the named
+    file. Every saved time step of every training run is used as a
+    snapshot. Before the decomposition, the mean of the snapshots is
+    subtracted and each unknown quantity is normalized by the RMS value of
+    its deviation from the mean, so that all quantities contribute to the
+    basis regardless of their units.
+
+    All training runs must have been performed on the same grids, and with
+    the same unknown quantities, as the simulations using the basis.
+
+    :param list outputs:  List of names of DREAM output files from the training runs.
+    :param str filename:  Name of file to save the reduced basis to.
+    :param int nmodes:    Number of modes to keep. If ``None``, the number of modes is chosen according to ``energy``.
+    :param float energy:  Fraction of the snapshot variance to be captured by the modes kept (if ``nmodes`` is ``None``).
+
+    :return: Singular values of the (scaled) snapshot matrix.
+    """
+    if len(outputs) == 0:
+        raise DREAMException("ReducedBasis: At least one training run is required.")
+
+    snapshots = {}
+    for fname in outputs:
+        out = LoadHDF5AsDict(fname, lazy=False)
+        nt = np.asarray(out['grid']['t']).size
+
+        for name, d in out['eqsys'].items():
+            if type(d) == dict:
+                continue
+
+            d = np.asarray(d)
+            if d.ndim < 1 or d.shape[0] != nt or not np.issubdtype(d.dtype, np.number):
+                continue
+
+            snapshots.setdefault(name, []).append(d.reshape((nt, -1)).T)
+
+    names = [n for n in snapshots if len(snapshots[n]) == len(outputs)]
+    if len(names) == 0:
+        raise DREAMException("ReducedBasis: No unknown quantities found in the training runs.")
+
+    # Mean and scale of each unknown quantity
+    means, scales, blocks = {}, {}, []
+    for name in names:
+        try:
+            X = np.hstack(snapshots[name])
+        except ValueError:
+            raise DREAMException("ReducedBasis: The size of '{}' differs between training runs.".format(name))
+
+        m = np.mean(X, axis=1)
+        dev = X - m[:,None]
+        s = np.sqrt(np.mean(dev**2))
+        if s == 0:
+            s = max(np.max(np.abs(m)), 1.0)
+
+        means[name], scales[name] = m, s
+        blocks.append(dev / s)
+
+    U, sv, _ = np.linalg.svd(np.vstack(blocks), full_matrices=False)
+    if nmodes is None:
+        cumulative = np.cumsum(sv**2) / max(np.sum(sv**2), np.finfo(float).tiny)
+        nmodes = int(np.searchsorted(cumulative, energy) + 1)
+
+    nmodes = max(1, min(int(nmodes), U.shape[1]))
+
+    data = {'mean': {}, 'scale': {}, 'basis': {}}
+    offset = 0
+    for name in names:
+        n = means[name].size
+        data['mean'][name] = means[name]
+        data['scale'][name] = float(scales[name])
+        data['basis'][name] = np.ascontiguousarray(U[offset:offset+n, :nmodes].T)
+        offset += n
+
+    data['nmodes'] = nmodes
+    SaveDictAsHDF5(filename, data)
+
+    return sv
@@ -10,17 +10,35 @@ ADAS_INTERP_BICUBIC = 2
 
 class Atomics:
     def __init__(self,
-            adas_interpolation = ADAS_INTERP_BICUBIC):
+            adas_interpolation = ADAS_INTERP_BICUBIC, adas_image = None):
         """
         Constructor.
         """
         self.adas_interpolation = adas_interpolation
+        self.adas_image = adas_image
+
+
+    def setADASImage(self, filename):
+        """
+        Take the ADAS interpolation coefficients from the named image
+        of precomputed atomic data (generated with ``dreami -g FILE``),
+        instead of computing them when the simulation starts. The image
+        is memory-mapped read-only, so that all simulations using it
+        share a single copy of the coefficients. If the image is
+        missing or out of date, the coefficients are computed as usual.
+
+        :param str filename: Name of the image file (``None`` = compute the coefficients).
+        """
+        self.adas_image = filename
+
     
     def fromdict(self, data):
         """
         Load settings from dictionary.
         """
         self.adas_interpolation = data['adas_interpolation']
+        if 'adas_image' in data and len(data['adas_image']) > 0:
+            self.adas_image = data['adas_image']
 
     def todict(self, verify=True):
         """
@@ -29,6 +47,8 @@ class Atomics:
         if verify:
             self.verifySettings()
         data = { 'adas_interpolation' : self.adas_interpolation }
+        if self.adas_image is not None:
+            data['adas_image'] = self.adas_image
         
         return data
         
@@ -71,6 +71,12 @@ class RunawayElectrons(UnknownQuantity,PrescribedInitialParameter):
         self.hottail   = hottail
         self.negative_re = False
 
+        self.EceffTable_Zeff = None
+        self.EceffTable_T = None
+        self.EceffTable_EceffOverEctot = None
+        self.EceffTable_error = None
+        self.EceffTable_tolerance = 1e-2
+
         self.advectionInterpolation = AdvectionInterpolation.AdvectionInterpolation(kinetic=False)
         self.transport = TransportSettings(kinetic=False)
 
@@ -138,6 +144,27 @@ class RunawayElectrons(UnknownQuantity,PrescribedInitialParameter):
         self.Eceff = int(Eceff)
 
 
+    def setEceffTable(self, Zeff, T, EceffOverEctot, error=None, tolerance=1e-2):
+        """
+        Provide a table of precomputed values of Eceff/Ectot, which is
+        used instead of solving for Eceff in every radius and time step
+        whenever the plasma parameters fall inside the table (and the
+        estimated error of the interpolated value is below the given
+        tolerance). Only applies to the 'SIMPLE' and 'FULL' Eceff models.
+
+        :param Zeff:           Effective charge grid of the table.
+        :param T:              Temperature grid (in eV) of the table.
+        :param EceffOverEctot: Tabulated Eceff/Ectot, of shape (nr, nZeff, nT).
+        :param error:          Estimated relative error of each table entry (same shape as ``EceffOverEctot``).
+        :param tolerance:      Largest estimated relative error accepted for an interpolated value.
+        """
+        self.EceffTable_Zeff = np.asarray(Zeff, dtype=float).flatten()
+        self.EceffTable_T = np.asarray(T, dtype=float).flatten()
+        self.EceffTable_EceffOverEctot = np.asarray(EceffOverEctot, dtype=float)
+        self.EceffTable_error = None if error is None else np.asarray(error, dtype=float)
+        self.EceffTable_tolerance = float(tolerance)
+
+
     def setTritium(self, tritium):
         """
         Specifices whether or not to include runaway generation
@@ -211,6 +238,16 @@ class RunawayElectrons(UnknownQuantity,PrescribedInitialParameter):
         if 'transport' in data:
             self.transport.fromdict(data['transport'])
 
+        if 'Eceff_table' in data:
+            tbl = data['Eceff_table']
+            self.EceffTable_Zeff = np.asarray(tbl['Zeff']).flatten()
+            self.EceffTable_T = np.asarray(tbl['T']).flatten()
+            self.EceffTable_EceffOverEctot = np.asarray(tbl['EceffOverEctot'])
+            if 'error' in tbl:
+                self.EceffTable_error = np.asarray(tbl['error'])
+            if 'tolerance' in tbl:
+                self.EceffTable_tolerance = float(tbl['tolerance'])
+
 
     def todict(self):
         """
@@ -236,6 +273,16 @@ class RunawayElectrons(UnknownQuantity,PrescribedInitialParameter):
             'r': self.radius
         }
 
+        if self.EceffTable_Zeff is not None:
+            data['Eceff_table'] = {
+                'Zeff': self.EceffTable_Zeff,
+                'T': self.EceffTable_T,
+                'EceffOverEctot': self.EceffTable_EceffOverEctot,
+                'tolerance': self.EceffTable_tolerance
+            }
+            if self.EceffTable_error is not None:
+                data['Eceff_table']['error'] = self.EceffTable_error
+
         # Flux limiter settings
         data['adv_interp'] = self.advectionInterpolation.todict()
 
@@ -264,6 +311,12 @@ class RunawayElectrons(UnknownQuantity,PrescribedInitialParameter):
             raise EquationException("n_re: Invalid setting combination: when hottail is enabled, the 'mode' of f_hot cannot be NUMERICAL. Enable ANALYTICAL f_hot distribution or disable hottail.")
         if type(self.negative_re) != bool:
             raise EquationException("n_re: Invalid value assigned to 'negative_re'. Expected bool.")
+        if self.EceffTable_Zeff is not None:
+            shp = (self.EceffTable_Zeff.size, self.EceffTable_T.size)
+            if self.EceffTable_EceffOverEctot.ndim != 3 or self.EceffTable_EceffOverEctot.shape[1:] != shp:
+                raise EquationException("n_re: Invalid shape of 'Eceff_table/EceffOverEctot'. Expected (nr, nZeff, nT).")
+            if self.EceffTable_error is not None and self.EceffTable_error.shape != self.EceffTable_EceffOverEctot.shape:
+                raise EquationException("n_re: The shape of 'Eceff_table/error' must be the same as that of 'EceffOverEctot'.")
 
         self.advectionInterpolation.verifySettings()
         self.transport.verifySettings()
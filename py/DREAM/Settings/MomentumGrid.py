@@ -5,7 +5,7 @@ from DREAM.DREAMException import DREAMException
 
 
 from DREAM.Settings.PGrid import PGrid
-from DREAM.Settings.XiGrid import XiGrid
+from DREAM.Settings.XiGrid import XiGrid, TYPE_GAUSS_LEGENDRE_NODES as XI_TYPE_GAUSS_LEGENDRE_NODES
 
 
 TYPE_PXI = 1
@@ -45,6 +45,8 @@ class MomentumGrid:
         Set all settings for this hot-tail grid.
         """
         self.enabled = enabled
+        self.radialzones_r = None
+        self.radialzones_nxi = None
 
         self.type = ttype
         if self.type == TYPE_PXI:
@@ -128,6 +130,18 @@ class MomentumGrid:
         if xi_f is not None:
             self.xigrid.setCustomGridPoints(xi_f=xi_f)
 
+    def setAdaptiveGrid(self, Tref, dpratio=10):
+        """
+        Distributes the 'np' momentum grid points so that the gradient
+        of a Maxwellian with temperature 'Tref' is resolved, i.e. with
+        fine cells in the thermal bulk and up to 'dpratio' times wider
+        cells in the tail.
+
+        :param float Tref:    Reference temperature (eV) to adapt the grid to.
+        :param float dpratio: Ratio between the largest and smallest grid cell.
+        """
+        self.pgrid.setAdaptive(Tref=Tref, dpratio=dpratio)
+
     def setTrappedPassingBoundaryLayerGrid(self, xi0Trapped=None, dxiMax=2, NxiPass=1, NxiTrap=1, boundaryLayerWidth=1e-3):
         """
         Designs a custom pitch grid which places tight grid cells 
@@ -179,6 +193,51 @@ class MomentumGrid:
 
             self.setCustomGrid(xi_f=np.sort(xi_f))
 
+    def setGaussLegendreNodeXiGrid(self, nxi=None):
+        """
+        Use a pitch grid with cells centred in the nodes of a Gauss-Legendre
+        quadrature, and cell widths equal to the quadrature weights, so that
+        the cells are clustered towards xi = +-1. The grid is an ordinary
+        finite volume grid (the pitch dependence is not represented in a
+        Legendre basis).
+
+        :param int nxi: Number of pitch grid cells (if ``None``, the
+                        currently set resolution is kept).
+        """
+        if nxi is not None:
+            self.setNxi(nxi)
+
+        self.xigrid.setType(XI_TYPE_GAUSS_LEGENDRE_NODES)
+
+    def setRadialZones(self, r, nxi):
+        """
+        Use a different pitch resolution in different radial zones (for
+        example a coarse pitch grid at the edge and a fine one in the
+        core). The p grid is the same in all zones, and the pitch grid
+        of each zone is of the type set with ``setXiType()`` (which must
+        be uniform in xi or theta, or Gauss-Legendre).
+
+        :param list r:   Radii separating the zones (strictly increasing).
+                         Zone ``k`` contains the radii ``r[k-1] <= r < r[k]``.
+        :param list nxi: Number of pitch grid points in each zone
+                         (``len(r)+1`` values, each at least 2).
+        """
+        r = np.atleast_1d(np.asarray(r, dtype=np.float64))
+        nxi = np.atleast_1d(np.asarray(nxi, dtype=np.int64))
+
+        if r.size == 0:
+            raise DREAMException("{}: At least one radial zone boundary must be given.".format(self.name))
+        if nxi.size != r.size+1:
+            raise DREAMException("{}: Expected {} values of 'nxi' for {} zone boundaries, but got {}.".format(self.name, r.size+1, r.size, nxi.size))
+        if np.any(np.diff(r) <= 0):
+            raise DREAMException("{}: The radial zone boundaries must be strictly increasing.".format(self.name))
+        if np.any(nxi < 2):
+            raise DREAMException("{}: The number of pitch grid points in each radial zone must be at least 2.".format(self.name))
+
+        self.radialzones_r = r
+        self.radialzones_nxi = nxi
+
+
     def setXiType(self,ttype):
         """
         Set type of xi grid. 
@@ -197,6 +256,12 @@ class MomentumGrid:
             if self.type == TYPE_PXI:
                 self.pgrid = PGrid(name, parent=self, data=data)
                 self.xigrid = XiGrid(name, parent=self, data=data)
+
+                self.radialzones_r = None
+                self.radialzones_nxi = None
+                if 'radialzones' in data and np.size(data['radialzones']['r']) > 0:
+                    self.radialzones_r = np.atleast_1d(data['radialzones']['r'])
+                    self.radialzones_nxi = np.atleast_1d(data['radialzones']['nxi']).astype(np.int64)
             elif self.type == TYPE_PPARPPERP:
                 raise DREAMException("No support implemented yet for loading 'ppar/pperp' grids.")
             else:
@@ -225,6 +290,11 @@ class MomentumGrid:
 
         if self.type == TYPE_PXI:
             data = {**data, **(self.pgrid.todict()), **(self.xigrid.todict())}
+            if self.radialzones_r is not None:
+                data['radialzones'] = {
+                    'r': self.radialzones_r,
+                    'nxi': self.radialzones_nxi
+                }
         elif self.type == TYPE_PPARPPERP:
             raise DREAMException("No support implemented yet for saving 'ppar/pperp' grids.")
         else:
@@ -21,6 +21,7 @@ class OtherQuantities:
         'fluid/Lambda_hypres',
         'fluid/lnLambdaC', 'fluid/lnLambdaT',
         'fluid/pCrit', 'fluid/pCritHottail',
+        'fluid/pmaxflux_f_hot', 'fluid/pmaxflux_f_re',
         'fluid/qR0',
         'fluid/radiation',
         'fluid/runawayRate',
@@ -36,6 +37,7 @@ class OtherQuantities:
         'energy',
         'hottail/Ar', 'hottail/Ap1', 'hottail/Ap2',
         'hottail/Drr', 'hottail/Dpp', 'hottail/Dpx', 'hottail/Dxp', 'hottail/Dxx',
+        'hottail/f_legendre', 'hottail/f_pitchint',
         'hottail/lnLambda_ee_f1', 'hottail/lnLambda_ee_f2',
         'hottail/lnLambda_ei_f1', 'hottail/lnLambda_ei_f2',
         'hottail/nu_D_f1', 'hottail/nu_D_f2',
@@ -47,6 +49,7 @@ class OtherQuantities:
         'nu_D',
         'runaway/Ar', 'runaway/Ap1', 'runaway/Ap2',
         'runaway/Drr', 'runaway/Dpp', 'runaway/Dpx', 'runaway/Dxp', 'runaway/Dxx',
+        'runaway/f_legendre', 'runaway/f_pitchint',
         'runaway/lnLambda_ee_f1', 'runaway/lnLambda_ee_f2',
         'runaway/lnLambda_ei_f1', 'runaway/lnLambda_ei_f2',
         'runaway/nu_D_f1', 'runaway/nu_D_f2',
@@ -73,6 +76,8 @@ class OtherQuantities:
         Constructor.
         """
         self._include = list()
+        self._decimation = dict()
+        self.legendre_nmodes = 4
 
     
     def include(self, *args):
@@ -91,6 +96,35 @@ class OtherQuantities:
                 raise DREAMException("other: Unrecognized type of argument: '{}'.".format(type(a)))
 
 
+    def setDecimation(self, name, every=1, tmin=None, tmax=None):
+        """
+        Set a custom output cadence for the named other quantity (or
+        group of quantities). The quantity will then only be evaluated
+        and stored on every ``every``'th save step with a time in the
+        window ``[tmin, tmax]``.
+
+        :param str name:    Name of quantity or group of quantities.
+        :param int every:   Store the quantity on every N'th save step.
+        :param float tmin:  Earliest time at which to store the quantity.
+        :param float tmax:  Latest time at which to store the quantity.
+        """
+        if tmin is None: tmin = -np.inf
+        if tmax is None: tmax = np.inf
+
+        self._decimation[name] = (int(every), float(tmin), float(tmax))
+
+
+    def setLegendreModes(self, nmodes):
+        """
+        Set the number of Legendre modes of the distribution functions
+        to store in the ``hottail/f_legendre`` and ``runaway/f_legendre``
+        quantities (which are stored with shape ``(nt, nmodes, np, nr)``).
+
+        :param int nmodes: Number of Legendre modes to store.
+        """
+        self.legendre_nmodes = int(nmodes)
+
+
     def fromdict(self, data):
         """
         Load these settings from the given dictionary.
@@ -104,6 +138,21 @@ class OtherQuantities:
 
         self.include(inc)
 
+        if 'legendre_nmodes' in data:
+            self.legendre_nmodes = int(data['legendre_nmodes'])
+
+        self._decimation = dict()
+        if 'decimation_names' in data:
+            names = data['decimation_names'].split(';')
+            if len(names) > 0 and names[-1] == '':
+                names = names[:-1]
+
+            every = np.atleast_1d(data['decimation_every'])
+            tmin  = np.atleast_1d(data['decimation_tmin'])
+            tmax  = np.atleast_1d(data['decimation_tmax'])
+            for i in range(len(names)):
+                self.setDecimation(names[i], every=every[i], tmin=tmin[i], tmax=tmax[i])
+
 
     def todict(self, verify=True):
         """
@@ -112,16 +161,31 @@ class OtherQuantities:
         if verify:
             self.verifySettings()
 
-        if len(self._include) == 0:
-            return {}
-        else:
-            return {'include': ';'.join(self._include)}
+        data = {'legendre_nmodes': self.legendre_nmodes}
+        if len(self._include) > 0:
+            data['include'] = ';'.join(self._include)
+
+        if len(self._decimation) > 0:
+            names = list(self._decimation.keys())
+            data['decimation_names'] = ';'.join(names)
+            data['decimation_every'] = np.array([self._decimation[n][0] for n in names], dtype=np.int64)
+            data['decimation_tmin'] = np.array([self._decimation[n][1] for n in names])
+            data['decimation_tmax'] = np.array([self._decimation[n][2] for n in names])
+
+        return data
 
 
     def verifySettings(self):
         """
         Verify that these settings are consistent.
         """
-        pass
+        if type(self.legendre_nmodes) != int or self.legendre_nmodes < 1:
+            raise DREAMException("other: Invalid number of Legendre modes: {}. At least one mode must be stored.".format(self.legendre_nmodes))
+
+        for name, (every, tmin, tmax) in self._decimation.items():
+            if every < 1:
+                raise DREAMException("other: Invalid output cadence for '{}': {}. The cadence must be at least 1.".format(name, every))
+            elif tmax < tmin:
+                raise DREAMException("other: Invalid output time window for '{}': tmax < tmin.".format(name))
 
 
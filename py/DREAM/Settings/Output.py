@@ -3,10 +3,26 @@
 # ################################################
 
 import numpy as np
+import os
 
 from .. DREAMException import DREAMException
 
 
+LAYOUT_CONTIGUOUS = 1
+LAYOUT_CHUNKED = 2
+
+BACKEND_SFILE = 1
+BACKEND_ADIOS2 = 2
+
+LOG_LEVEL_ERROR = 0
+LOG_LEVEL_WARNING = 1
+LOG_LEVEL_INFO = 2
+LOG_LEVEL_DEBUG = 3
+
+LOG_FORMAT_TEXT = 1
+LOG_FORMAT_JSON = 2
+
+
 class Output:
     
     
@@ -14,10 +30,34 @@ class Output:
         """
         Constructor.
         """
+        self.adios2engine = 'BP5'
+        self.backend = BACKEND_SFILE
+        self.checkpoint = ''
+        self.checkpointinterval = 0
+        self.checkpointsteps = 0
+        self.statusfile = ''
+        self.statusinterval = 10
+        self.compression = 0
         self.filename = filename
+        self.finalonly = []
+        self.gridstore = ''
+        self.layout = LAYOUT_CONTIGUOUS
+        self.logasync = False
+        self.logformat = LOG_FORMAT_TEXT
+        self.loglevel = LOG_LEVEL_INFO
+        self.resultcache = None
         self.savesettings = True
+        self.singleprecision = []
+        self.streaming = False
         self.timingstdout = False
         self.timingfile = True
+        self.trace = False
+        self.tracefile = ''
+        self.tracemaxevents = 1000000
+        self.termtimings = False
+        self.memory = False
+        self.perfcounters = False
+        self.petsclog = False
 
 
     ############################
@@ -32,6 +72,183 @@ class Output:
         self.filename = filename
 
 
+    def setBackend(self, backend, engine=None):
+        """
+        Set the backend used for writing the simulation output. With
+        ``BACKEND_ADIOS2``, every saved time step is written with ADIOS2 as
+        soon as it has been computed, either to a BP file (engines ``BP4``
+        and ``BP5``) or directly to a running analysis process (engine
+        ``SST``). The ADIOS2 backend requires DREAM to be compiled with
+        ``-DDREAM_WITH_ADIOS2=ON``, and does not write the settings, solver
+        statistics or timing information. Cannot be combined with streaming
+        output or the chunked layout.
+
+        :param int backend: Backend to use (``BACKEND_SFILE`` or ``BACKEND_ADIOS2``).
+        :param str engine:  ADIOS2 engine to use.
+        """
+        if backend not in [BACKEND_SFILE, BACKEND_ADIOS2]:
+            raise DREAMException("Output: Unrecognized output backend: {}".format(backend))
+
+        self.backend = int(backend)
+
+        if engine is not None:
+            self.adios2engine = engine
+
+
+    def setCheckpoint(self, filename, nsteps=None, interval=None):
+        """
+        Periodically write a checkpoint of the simulation state to the
+        named file. A checkpoint is written after every ``nsteps`` saved
+        time steps and/or whenever ``interval`` minutes have passed since
+        the previous checkpoint (if neither is given, a checkpoint is
+        written after every saved time step). The simulation can later be
+        resumed from the checkpoint by running ``dreami -r`` with the
+        same settings. The file is replaced atomically, so that a valid
+        checkpoint is always available should the simulation be killed.
+
+        :param str filename: Name of checkpoint file (empty = don't write checkpoints).
+        :param int nsteps:   Number of saved time steps between two checkpoints.
+        :param float interval: Wall-clock time (in minutes) between two checkpoints.
+        """
+        self.checkpoint = filename
+
+        if nsteps is not None:
+            self.checkpointsteps = int(nsteps)
+        if interval is not None:
+            self.checkpointinterval = float(interval)
+
+
+    def setStatusFile(self, filename, interval=None):
+        """
+        Periodically write the progress of the simulation to the named
+        file, for monitoring simulations run under batch schedulers. The
+        file contains the current simulation time, the most recent time
+        step, the number of time steps taken per second, the average
+        number of solver iterations per time step, the memory used by the
+        process and an estimate of the remaining wall-clock time. If the
+        file name ends with ``.prom``, the Prometheus text format is used;
+        otherwise, the file is written as a JSON object.
+
+        :param str filename:   Name of status file (empty = don't write a status file).
+        :param float interval: Shortest wall-clock time (in seconds) between two updates of the file.
+        """
+        self.statusfile = filename
+
+        if interval is not None:
+            self.statusinterval = float(interval)
+
+
+    def setFinalOnly(self, unknowns):
+        """
+        Only store the initial value and the final saved time step of the
+        named unknown quantities in the output (the most recent saved step
+        is kept in memory, and replaces the previous one). The times of the
+        stored steps are written to ``eqsys/NAME@t``. This is mainly useful
+        for distribution functions in long kinetic simulations, for which
+        reductions such as the ``hottail/f_pitchint`` and
+        ``hottail/f_legendre`` "other" quantities can be stored at every
+        saved time step instead. Cannot be combined with streaming output.
+
+        :param list unknowns: Name, or list of names, of unknown quantities to only store the final step of.
+        """
+        if type(unknowns) == str:
+            unknowns = [unknowns]
+
+        self.finalonly = list(unknowns)
+
+
+    def setGridStore(self, directory):
+        """
+        Store the grid data (radial and momentum grids, and geometric
+        quantities) in the given directory, in a file named after the hash
+        of its contents, instead of in the output file. Simulations with
+        identical grids (e.g. in a parameter scan) then share a single grid
+        file, and their output files only contain the time grid together
+        with the name of the grid file (``grid/gridstore``), which is
+        resolved when the output is loaded with ``DREAMOutput``.
+
+        :param str directory: Directory in which to store grid files (empty = store the grids in the output file).
+        """
+        self.gridstore = directory
+
+
+    def setLogging(self, level=None, format=None, asynchronous=None):
+        """
+        Set how messages are written to the terminal by the kernel.
+        Messages of a level higher than ``level`` are not printed (note
+        that debug messages may also have been disabled when compiling
+        DREAM, with ``-DDREAM_LOG_MAX_LEVEL``). With ``LOG_FORMAT_JSON``,
+        every message is written as a JSON object on a separate line
+        (containing the time, level, OpenMP thread and message), which
+        is convenient for log collectors. With ``asynchronous=True``,
+        messages are written by a background thread, so that a slow
+        terminal (e.g. under batch schedulers) does not slow down the
+        simulation.
+
+        :param int level:          Most verbose level of messages to print (``LOG_LEVEL_ERROR``, ``LOG_LEVEL_WARNING``, ``LOG_LEVEL_INFO`` or ``LOG_LEVEL_DEBUG``).
+        :param int format:         Format of messages (``LOG_FORMAT_TEXT`` or ``LOG_FORMAT_JSON``).
+        :param bool asynchronous:  If ``True``, writes messages from a background thread.
+        """
+        if level is not None:
+            if level not in [LOG_LEVEL_ERROR, LOG_LEVEL_WARNING, LOG_LEVEL_INFO, LOG_LEVEL_DEBUG]:
+                raise DREAMException("Output: Invalid log level: {}".format(level))
+            self.loglevel = int(level)
+        if format is not None:
+            if format not in [LOG_FORMAT_TEXT, LOG_FORMAT_JSON]:
+                raise DREAMException("Output: Unrecognized log format: {}".format(format))
+            self.logformat = int(format)
+        if asynchronous is not None:
+            self.logasync = bool(asynchronous)
+
+
+    def setLayout(self, layout=LAYOUT_CHUNKED, compression=None):
+        """
+        Set the HDF5 layout used for unknown quantities in the output
+        file. With ``LAYOUT_CHUNKED``, every dataset is chunked by time
+        step (and kinetic quantities also by radius), so that individual
+        time slices or radii can be read efficiently (for example with
+        lazily loaded ``DREAMOutput`` objects).
+
+        :param int layout:      Layout to use (``LAYOUT_CONTIGUOUS`` or ``LAYOUT_CHUNKED``).
+        :param int compression: Deflate compression level (0-9) of chunked datasets (0 = no compression).
+        """
+        if layout not in [LAYOUT_CONTIGUOUS, LAYOUT_CHUNKED]:
+            raise DREAMException("Output: Unrecognized output layout: {}".format(layout))
+
+        self.layout = int(layout)
+
+        if compression is not None:
+            self.setCompression(compression)
+
+
+    def setCompression(self, compression):
+        """
+        Set the deflate compression level (0-9) of unknown quantities in
+        the output file. Compression requires either the chunked output
+        layout or streaming output.
+
+        :param int compression: Compression level (0 = no compression).
+        """
+        if compression < 0 or compression > 9:
+            raise DREAMException("Output: Invalid compression level: {}. Must be between 0 and 9.".format(compression))
+
+        self.compression = int(compression)
+
+
+    def setResultCache(self, directory):
+        """
+        Cache the output of the simulation in the given directory. A later
+        simulation with identical settings (apart from the names of output
+        files), run with the same version of DREAM, then copies the cached
+        output to its output file instead of rerunning the simulation.
+        Files referenced by the settings (e.g. numerical magnetic fields)
+        are only identified by their names.
+
+        :param str directory: Directory in which to store cached outputs (``None`` disables the cache).
+        """
+        self.resultcache = directory
+
+
     def setSaveSettings(self, save=True):
         """
         Specify whether or not to save a copy of the input settings to the
@@ -42,6 +259,39 @@ class Output:
         self.savesettings = save
 
 
+    def setSinglePrecision(self, unknowns):
+        """
+        Store the saved time steps of the named unknown quantities in
+        single precision (both in memory and in the output file), which
+        halves the memory and disk space needed for them. This is mainly
+        useful for large kinetic quantities, such as distribution
+        functions. The initial value is always stored in double precision.
+
+        Note that the output is only written in single precision when
+        either the chunked layout or streaming output is used.
+
+        :param list unknowns: Name, or list of names, of unknown quantities to store in single precision.
+        """
+        if type(unknowns) == str:
+            unknowns = [unknowns]
+
+        self.singleprecision = list(unknowns)
+
+
+    def setStreaming(self, stream=True):
+        """
+        Specify whether or not to write the saved time steps of all unknown
+        quantities to the output file during the simulation, rather than
+        keeping them in memory until the simulation has finished. This
+        reduces the memory usage of long simulations with many saved time
+        steps, and ensures that the time evolution computed so far is
+        available in the output file should the simulation be interrupted.
+
+        :param bool stream: If ``True``, stream unknown quantities to the output file.
+        """
+        self.streaming = stream
+
+
     def setTiming(self, stdout=None, file=None):
         """
         Specifies whether to print timing information and/or include
@@ -56,6 +306,83 @@ class Output:
             self.timingfile = file
 
 
+    def setTrace(self, trace=True, filename=None, maxevents=None):
+        """
+        Specify whether to record a hierarchical trace of the time spent
+        in the different parts of the simulation (time steps, iterations,
+        rebuilds of individual equation terms, linear solves etc.). A
+        summary of the trace is stored with the timing information in the
+        output file, and the individual events can optionally be written
+        to a separate file in the Chrome trace event format (which can be
+        opened in ``chrome://tracing`` or ``ui.perfetto.dev``).
+
+        :param bool trace:    If ``True``, records a trace during the simulation.
+        :param str filename:  Name of file to write trace events to (empty = don't write).
+        :param int maxevents: Maximum number of individual trace events to keep.
+        """
+        self.trace = trace
+
+        if filename is not None:
+            self.tracefile = filename
+        if maxevents is not None:
+            self.tracemaxevents = int(maxevents)
+
+
+    def setTermTimings(self, termtimings=True):
+        """
+        Specify whether to record the time spent in each equation term
+        when rebuilding the terms, setting the jacobian and linear operator
+        matrix elements, and evaluating the terms. The timings are aggregated
+        by term name and stored with the timing information in the output
+        file. If timing information is printed to stdout, a table with the
+        most expensive terms is printed at the end of the simulation.
+
+        :param bool termtimings: If ``True``, records the time spent in each equation term.
+        """
+        self.termtimings = termtimings
+
+
+    def setMemoryAccounting(self, memory=True):
+        """
+        Specify whether to record the memory used by the main data
+        structures of the simulation (quantity data, grid data, PETSc
+        matrices and factorizations). A summary of the current and peak
+        memory usage is printed at the start and end of the simulation,
+        together with an estimate of the peak memory usage of the run,
+        and is stored with the timing information in the output file.
+
+        :param bool memory: If ``True``, records the memory usage of the simulation.
+        """
+        self.memory = memory
+
+
+    def setPerformanceCounters(self, perfcounters=True):
+        """
+        Specify whether to count hardware events (cycles, instructions,
+        last-level cache references and misses) while each of the timers
+        of the kernel is running. The counters are printed next to the
+        timing information and saved with it to the output file. Only
+        available on Linux, and only if access to the performance counters
+        is permitted (see ``/proc/sys/kernel/perf_event_paranoid``).
+
+        :param bool perfcounters: If ``True``, records hardware performance counters.
+        """
+        self.perfcounters = perfcounters
+
+
+    def setPETScLog(self, petsclog=True):
+        """
+        Specify whether to log the phases of the non-linear solver
+        (rebuild, residual, jacobian and inversion) as separate PETSc log
+        stages, and the matrix inverters as PETSc events. The PETSc
+        performance summary (as printed with ``-log_view``) is then saved
+        with the timing information to the output file.
+
+        :param bool petsclog: If ``True``, enables PETSc logging.
+        """
+        self.petsclog = petsclog
+
+
     def fromdict(self, data):
         """
         Load settings from the given dictionary.
@@ -66,8 +393,56 @@ class Output:
         self.timingstdout = bool(data['timingstdout'])
         self.timingfile = bool(data['timingfile'])
 
+        if 'adios2engine' in data:
+            self.adios2engine = data['adios2engine']
+        if 'backend' in data:
+            self.backend = int(data['backend'])
+        if 'checkpoint' in data:
+            self.checkpoint = data['checkpoint']
+        if 'checkpointinterval' in data:
+            self.checkpointinterval = float(data['checkpointinterval'])
+        if 'checkpointsteps' in data:
+            self.checkpointsteps = int(data['checkpointsteps'])
+        if 'statusfile' in data:
+            self.statusfile = data['statusfile']
+        if 'statusinterval' in data:
+            self.statusinterval = float(data['statusinterval'])
+        if 'compression' in data:
+            self.compression = int(data['compression'])
+        if 'finalonly' in data:
+            self.finalonly = [n for n in data['finalonly'].split(';') if n != '']
+        if 'gridstore' in data:
+            self.gridstore = data['gridstore']
+        if 'layout' in data:
+            self.layout = int(data['layout'])
+        if 'logasync' in data:
+            self.logasync = bool(data['logasync'])
+        if 'logformat' in data:
+            self.logformat = int(data['logformat'])
+        if 'loglevel' in data:
+            self.loglevel = int(data['loglevel'])
+        if 'resultcache' in data and len(data['resultcache']) > 0:
+            self.resultcache = data['resultcache']
         if 'savesettings' in data:
             self.savesettings = bool(data['savesettings'])
+        if 'singleprecision' in data:
+            self.singleprecision = [n for n in data['singleprecision'].split(';') if n != '']
+        if 'streaming' in data:
+            self.streaming = bool(data['streaming'])
+        if 'trace' in data:
+            self.trace = bool(data['trace'])
+        if 'tracefile' in data:
+            self.tracefile = data['tracefile']
+        if 'tracemaxevents' in data:
+            self.tracemaxevents = int(data['tracemaxevents'])
+        if 'termtimings' in data:
+            self.termtimings = bool(data['termtimings'])
+        if 'memory' in data:
+            self.memory = bool(data['memory'])
+        if 'perfcounters' in data:
+            self.perfcounters = bool(data['perfcounters'])
+        if 'petsclog' in data:
+            self.petsclog = bool(data['petsclog'])
 
         self.verifySettings()
 
@@ -83,12 +458,38 @@ class Output:
             self.verifySettings()
 
         data = {
+            'adios2engine': self.adios2engine,
+            'backend': self.backend,
+            'checkpoint': self.checkpoint,
+            'checkpointinterval': self.checkpointinterval,
+            'checkpointsteps': self.checkpointsteps,
+            'compression': self.compression,
             'filename': self.filename,
+            'finalonly': ';'.join(self.finalonly),
+            'gridstore': self.gridstore,
+            'layout': self.layout,
+            'logasync': self.logasync,
+            'logformat': self.logformat,
+            'loglevel': self.loglevel,
             'savesettings': self.savesettings,
+            'singleprecision': ';'.join(self.singleprecision),
+            'statusfile': self.statusfile,
+            'statusinterval': self.statusinterval,
+            'streaming': self.streaming,
             'timingfile': self.timingfile,
-            'timingstdout': self.timingstdout
+            'timingstdout': self.timingstdout,
+            'trace': self.trace,
+            'tracefile': self.tracefile,
+            'tracemaxevents': self.tracemaxevents,
+            'termtimings': self.termtimings,
+            'memory': self.memory,
+            'perfcounters': self.perfcounters,
+            'petsclog': self.petsclog
         }
 
+        if self.resultcache is not None:
+            data['resultcache'] = self.resultcache
+
         return data
 
 
@@ -98,11 +499,67 @@ class Output:
         """
         if type(self.filename) != str:
             raise DREAMException("The output file name must be string.")
+        elif type(self.checkpoint) != str:
+            raise DREAMException("The checkpoint file name must be a string.")
+        elif type(self.checkpointsteps) != int or self.checkpointsteps < 0:
+            raise DREAMException("The option 'checkpointsteps' must be a non-negative integer.")
+        elif self.checkpointinterval < 0:
+            raise DREAMException("The option 'checkpointinterval' must be non-negative.")
+        elif type(self.statusfile) != str:
+            raise DREAMException("The status file name must be a string.")
+        elif self.statusinterval < 0:
+            raise DREAMException("The option 'statusinterval' must be non-negative.")
+        elif self.backend not in [BACKEND_SFILE, BACKEND_ADIOS2]:
+            raise DREAMException("Unrecognized output backend: {}.".format(self.backend))
+        elif type(self.adios2engine) != str:
+            raise DREAMException("The ADIOS2 engine must be a string.")
+        elif self.backend == BACKEND_ADIOS2 and (self.streaming or self.layout != LAYOUT_CONTIGUOUS):
+            raise DREAMException("The ADIOS2 output backend cannot be combined with streaming or a chunked layout.")
+        elif self.layout not in [LAYOUT_CONTIGUOUS, LAYOUT_CHUNKED]:
+            raise DREAMException("Unrecognized output layout: {}.".format(self.layout))
+        elif type(self.compression) != int or self.compression < 0 or self.compression > 9:
+            raise DREAMException("The option 'compression' must be an integer between 0 and 9.")
+        elif self.compression > 0 and self.layout != LAYOUT_CHUNKED and not self.streaming:
+            raise DREAMException("Output compression requires either the chunked layout or streaming output.")
+        elif type(self.gridstore) != str:
+            raise DREAMException("The grid store directory must be a string.")
+        elif self.gridstore != '' and not os.path.isdir(self.gridstore):
+            raise DREAMException("The specified grid store directory does not exist: '{}'.".format(self.gridstore))
+        elif self.resultcache is not None and not os.path.isdir(self.resultcache):
+            raise DREAMException("The specified result cache directory does not exist: '{}'.".format(self.resultcache))
         elif type(self.savesettings) != bool:
             raise DREAMException("The option 'savesettings' must be a bool.")
+        elif type(self.singleprecision) != list or any([type(n) != str for n in self.singleprecision]):
+            raise DREAMException("The option 'singleprecision' must be a list of unknown quantity names.")
+        elif type(self.streaming) != bool:
+            raise DREAMException("The option 'streaming' must be a bool.")
+        elif type(self.finalonly) != list or any([type(n) != str for n in self.finalonly]):
+            raise DREAMException("The option 'finalonly' must be a list of unknown quantity names.")
+        elif len(self.finalonly) > 0 and self.streaming:
+            raise DREAMException("Storing only the final time step of unknown quantities is not supported with streaming output.")
+        elif self.loglevel not in [LOG_LEVEL_ERROR, LOG_LEVEL_WARNING, LOG_LEVEL_INFO, LOG_LEVEL_DEBUG]:
+            raise DREAMException("Invalid log level: {}.".format(self.loglevel))
+        elif self.logformat not in [LOG_FORMAT_TEXT, LOG_FORMAT_JSON]:
+            raise DREAMException("Unrecognized log format: {}.".format(self.logformat))
+        elif type(self.logasync) != bool:
+            raise DREAMException("The option 'logasync' must be a bool.")
         elif type(self.timingfile) != bool:
             raise DREAMException("The option 'timingfile' must be a bool.")
         elif type(self.timingstdout) != bool:
             raise DREAMException("The option 'timingstdout' must be a bool.")
+        elif type(self.trace) != bool:
+            raise DREAMException("The option 'trace' must be a bool.")
+        elif type(self.tracefile) != str:
+            raise DREAMException("The trace file name must be a string.")
+        elif type(self.tracemaxevents) != int or self.tracemaxevents < 0:
+            raise DREAMException("The option 'tracemaxevents' must be a non-negative integer.")
+        elif type(self.termtimings) != bool:
+            raise DREAMException("The option 'termtimings' must be a bool.")
+        elif type(self.memory) != bool:
+            raise DREAMException("The option 'memory' must be a bool.")
+        elif type(self.perfcounters) != bool:
+            raise DREAMException("The option 'perfcounters' must be a bool.")
+        elif type(self.petsclog) != bool:
+            raise DREAMException("The option 'petsclog' must be a bool.")
 
 
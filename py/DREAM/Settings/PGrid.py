@@ -7,6 +7,7 @@ from DREAM.Settings.Equations.EquationException import EquationException
 TYPE_UNIFORM = 1
 TYPE_BIUNIFORM = 2
 TYPE_CUSTOM = 3
+TYPE_ADAPTIVE = 4
 
 class PGrid:
 
@@ -31,6 +32,8 @@ class PGrid:
         self.npsep_frac = None
         self.psep  = None
         self.p_f = None
+        self.tref = None
+        self.dpratio = None
         if data is not None:
             self.fromdict(data)
         else:
@@ -78,6 +81,16 @@ class PGrid:
         else:
             raise DREAMException("PGrid biuniform {}: npsep or npsep_frac must be set.")
 
+    def setAdaptive(self, Tref, dpratio=10):
+        """
+        Adapt the momentum grid to the gradient of a Maxwellian
+        with the reference temperature 'Tref' (eV). The largest
+        grid cell will be 'dpratio' times wider than the smallest.
+        """
+        self.type = TYPE_ADAPTIVE
+        self.tref = float(Tref)
+        self.dpratio = float(dpratio)
+
     def setCustomGridPoints(self, p_f):
         """
         Set an arbitrary custom grid point distribution
@@ -115,7 +128,7 @@ class PGrid:
         """
         Set the type of p grid generator.
         """
-        if ttype == TYPE_UNIFORM or ttype == TYPE_BIUNIFORM:
+        if ttype == TYPE_UNIFORM or ttype == TYPE_BIUNIFORM or ttype == TYPE_ADAPTIVE:
             self.type = ttype
         else:
             raise DREAMException("PGrid {}: Unrecognized grid type specified: {}.".format(self.name, self.type))
@@ -138,6 +151,9 @@ class PGrid:
             self.psep  = data['psep']
         elif self.type == TYPE_CUSTOM:
             self.p_f = data['p_f']
+        elif self.type == TYPE_ADAPTIVE:
+            self.tref = float(data['tref'])
+            self.dpratio = float(data['dpratio'])
 
         self.verifySettings()
 
@@ -165,6 +181,9 @@ class PGrid:
             data['psep'] = self.psep
         elif self.type == TYPE_CUSTOM:
             data['p_f'] = self.p_f
+        elif self.type == TYPE_ADAPTIVE:
+            data['tref'] = self.tref
+            data['dpratio'] = self.dpratio
         return data
 
 
@@ -175,7 +194,7 @@ class PGrid:
         if not self.parent.enabled:
             return
 
-        if self.type in [TYPE_UNIFORM, TYPE_BIUNIFORM, TYPE_CUSTOM]:
+        if self.type in [TYPE_UNIFORM, TYPE_BIUNIFORM, TYPE_CUSTOM, TYPE_ADAPTIVE]:
             if self.np is None or self.np <= 0:
                 raise DREAMException("PGrid {}: Invalid value assigned to 'np': {}. Must be > 0.".format(self.name, self.np))
             elif self.pmax is None or self.pmax <= 0:
@@ -191,5 +210,9 @@ class PGrid:
                 raise DREAMException("PGrid {}: Neither 'npsep' nor 'npsep_frac' have been set.".format(self.name))
             elif self.psep is None or self.psep <= 0 or self.psep >= self.pmax:
                 raise DREAMException("PGrid {}: Invalid value assigned to 'psep': {}. Must be > 0 and < pmax.".format(self.name, self.psep))
-        
+        elif self.type == TYPE_ADAPTIVE:
+            if self.tref is None or self.tref <= 0:
+                raise DREAMException("PGrid {}: Invalid value assigned to 'tref': {}. Must be > 0.".format(self.name, self.tref))
+            elif self.dpratio is None or self.dpratio < 1:
+                raise DREAMException("PGrid {}: Invalid value assigned to 'dpratio': {}. Must be >= 1.".format(self.name, self.dpratio))
 
@@ -13,6 +13,8 @@ class Preconditioner:
         Constructor.
         """
         self.enabled = True
+        self.equilibrate = False
+        self.equilibrate_every = 1
         self.overrides = []
 
 
@@ -20,8 +22,16 @@ class Preconditioner:
         """
         Load preconditioner settings from a dictionary.
         """
+        def scal(v):
+            if type(v) == np.ndarray: return v[0]
+            else: return v
+
         if 'enabled' in data:
             self.enabled = bool(data['enabled'])
+        if 'equilibrate' in data:
+            self.equilibrate = bool(data['equilibrate'])
+        if 'equilibrate_every' in data:
+            self.equilibrate_every = int(scal(data['equilibrate_every']))
 
         if 'names' in data:
             if 'equation_scales' not in data:
@@ -90,11 +100,29 @@ class Preconditioner:
         self.enabled = enabled
 
 
+    def setEquilibration(self, enabled=True, every=1):
+        """
+        Enable/disable automatic equilibration of the jacobian matrix.
+        When enabled, the scalings of the preconditioner are refined so
+        that the largest element in each row and column of the rescaled
+        jacobian has magnitude one.
+
+        :param bool enabled: Indicates whether to enable/disable equilibration.
+        :param int every:    Number of jacobian evaluations between each update of the equilibration scalings.
+        """
+        self.equilibrate = enabled
+        self.equilibrate_every = int(every)
+
+
     def todict(self):
         """
         Convert this object to a dict.
         """
-        data = {'enabled': self.enabled}
+        data = {
+            'enabled': self.enabled,
+            'equilibrate': self.equilibrate,
+            'equilibrate_every': self.equilibrate_every
+        }
 
         if len(self.overrides) > 0:
             data['names'] = ''
@@ -115,6 +143,10 @@ class Preconditioner:
         """
         if type(self.enabled) is not bool:
             raise DREAMException("Invalid type of option 'enabled': {}. Expected bool.".format(type(self.enabled)))
+        if type(self.equilibrate) is not bool:
+            raise DREAMException("Invalid type of option 'equilibrate': {}. Expected bool.".format(type(self.equilibrate)))
+        if type(self.equilibrate_every) is not int or self.equilibrate_every <= 0:
+            raise DREAMException("Invalid value of option 'equilibrate_every': {}. Expected positive integer.".format(self.equilibrate_every))
 
         for i in range(len(self.overrides)):
             u = self.overrides[i]
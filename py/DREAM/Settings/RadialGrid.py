@@ -61,10 +61,15 @@ class RadialGrid:
         self.num_filename = None
         self.num_fileformat = None
         self.num_magneticfield = None   # Magnetic field class parsing data
+        self.geometrycache = None       # Directory to cache geometric quantities in
 
         # prescribed arbitrary grid
         self.r_f = None 
 
+        # Adaptation of the grid to the solution
+        self.adapt_nsegments = 0
+        self.adapt_ratio = 10.0
+
 
     #######################
     # SETTERS
@@ -98,6 +103,33 @@ class RadialGrid:
             raise EquationException("RadialGrid: Custom grid points must be non-negative.")
         self.r_f = r_f
 
+    def setAdaptive(self, nsegments, ratio=10):
+        """
+        Adapt the radial grid to steep gradients in the cold electron
+        temperature and density during the simulation. The time steps
+        are divided into ``nsegments`` segments, and at the end of each
+        segment, the radial grid points are moved so that cells are up to
+        ``ratio`` times smaller at steep fronts than where the profiles
+        are flat (the number of grid points is unchanged). The next
+        segment is initialized by remapping the solution conservatively
+        onto the new grid. The output of all segments but the last is
+        written to separate files (named as the regular output file, with
+        '_adapt<k>' appended to the base name), and the time axis of the
+        output restarts at zero in every segment. Requires the constant
+        time stepper.
+
+        :param int nsegments: Number of segments (0 or 1 = disable adaptation).
+        :param float ratio:   Ratio between the largest and smallest cell of the adapted grids.
+        """
+        if nsegments < 0:
+            raise DREAMException("RadialGrid: The number of adaptation segments must be non-negative.")
+        if ratio < 1:
+            raise DREAMException("RadialGrid: The adaptation ratio must be at least 1.")
+
+        self.adapt_nsegments = int(nsegments)
+        self.adapt_ratio = float(ratio)
+
+
     def setB0(self, B0):
         """
         (Cylindrical)
@@ -293,6 +325,18 @@ class RadialGrid:
         self.a = self.num_magneticfield.a
 
 
+    def setGeometryCache(self, directory):
+        """
+        Cache the flux surface averages, bounce points and bounce averages
+        calculated for a numerical magnetic field in the given directory.
+        Simulations using the same magnetic field and grids then load these
+        quantities from the cache instead of recalculating them.
+
+        :param str directory: Directory in which to store cache files (``None`` disables the cache).
+        """
+        self.geometrycache = directory
+
+
     def setType(self, ttype):
         """
         Set the type of radial grid to use.
@@ -445,9 +489,16 @@ class RadialGrid:
 
             if 'fileformat' in data:
                 self.num_fileformat = data['fileformat']
+
+            if 'geometrycache' in data and len(data['geometrycache']) > 0:
+                self.geometrycache = data['geometrycache']
         else:
             raise DREAMException("RadialGrid: Unrecognized grid type specified: {}.".format(self.type))
 
+        if 'adapt' in data:
+            self.adapt_nsegments = int(scal(data['adapt']['nsegments']))
+            self.adapt_ratio = float(scal(data['adapt']['ratio']))
+
         if 'ripple' in data:
             self.ripple_ncoils = int(scal(data['ripple']['ncoils']))
             self.ripple_deltacoils = float(scal(data['ripple']['deltacoils']))
@@ -494,9 +545,18 @@ class RadialGrid:
 
             if self.num_fileformat is not None:
                 data['fileformat'] = self.num_fileformat
+
+            if self.geometrycache is not None:
+                data['geometrycache'] = self.geometrycache
         else:
             raise DREAMException("RadialGrid: Unrecognized grid type specified: {}.".format(self.type))
 
+        if self.adapt_nsegments > 1:
+            data['adapt'] = {
+                'nsegments': self.adapt_nsegments,
+                'ratio': self.adapt_ratio
+            }
+
         if self.ripple_ncoils > 0 or self.ripple_deltacoils > 0:
             data['ripple'] = {
                 'ncoils': self.ripple_ncoils,
@@ -558,6 +618,8 @@ class RadialGrid:
                 raise DREAMException("RadialGrid: No numerical magnetic field file specified.")
             elif not pathlib.Path(self.num_filename).is_file():
                 raise DREAMException("RadialGrid: The specified numerical magnetic field file does not exist.")
+            elif self.geometrycache is not None and not pathlib.Path(self.geometrycache).is_dir():
+                raise DREAMException("RadialGrid: The specified geometry cache directory does not exist: '{}'.".format(self.geometrycache))
             elif self.ntheta <= 0:
                 raise DREAMException("RadialGrid: Invalid value assigned to 'ntheta': {}. Must be > 0.".format(self.ntheta))
 
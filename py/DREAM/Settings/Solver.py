@@ -2,6 +2,7 @@
 # Solver settings object
 #################################
 
+import os
 import numpy as np
 from .. DREAMException import DREAMException
 from . ToleranceSettings import ToleranceSettings
@@ -17,6 +18,53 @@ LINEAR_SOLVER_MUMPS   = 2
 LINEAR_SOLVER_MKL     = 3
 LINEAR_SOLVER_SUPERLU = 4
 LINEAR_SOLVER_GMRES   = 5
+LINEAR_SOLVER_MIXED_PRECISION = 6
+
+BACKEND_CPU    = 1
+BACKEND_CUDA   = 2
+BACKEND_HIP    = 3
+BACKEND_KOKKOS = 4
+
+MIXED_PRECISION_REFINEMENT_RICHARDSON = 1
+MIXED_PRECISION_REFINEMENT_GMRES      = 2
+
+GMRES_PC_BLOCK_JACOBI  = 1
+GMRES_PC_FIELDSPLIT    = 2
+GMRES_PC_KINETIC_GRIDS = 3
+
+GMRES_KINETIC_PC_ILU  = 1
+GMRES_KINETIC_PC_GAMG = 2
+GMRES_KINETIC_PC_LU   = 3
+GMRES_KINETIC_PC_RADIAL_LU = 4
+GMRES_KINETIC_PC_MG   = 5
+
+GMRES_MG_LINES_P           = 1
+GMRES_MG_LINES_XI          = 2
+GMRES_MG_LINES_ALTERNATING = 3
+
+JACOBIAN_UPDATE_ALWAYS          = 1
+JACOBIAN_UPDATE_MODIFIED_NEWTON = 2
+JACOBIAN_UPDATE_NEWTON_KRYLOV   = 3
+JACOBIAN_UPDATE_JFNK            = 4
+
+LINE_SEARCH_NONE         = 1
+LINE_SEARCH_BACKTRACKING = 2
+
+FACTOR_ORDERING_DEFAULT = 1
+FACTOR_ORDERING_RADIAL  = 2
+FACTOR_ORDERING_RCM     = 3
+FACTOR_ORDERING_ND      = 4
+
+PREDICTOR_NONE      = 1
+PREDICTOR_LINEAR    = 2
+PREDICTOR_QUADRATIC = 3
+
+SPLITTING_NONE   = 1
+SPLITTING_LIE    = 2
+SPLITTING_STRANG = 3
+
+DEBUG_FORMAT_PETSC = 1
+DEBUG_FORMAT_CSR   = 2
 
 
 class Solver:
@@ -30,18 +78,71 @@ class Solver:
 
         self.debug_printmatrixinfo = False
         self.debug_printjacobianinfo = False
+        self.debug_printsparsity = False
         self.debug_savejacobian = False
         self.debug_savesolution = False
         self.debug_savematrix = False
         self.debug_savenumericaljacobian = False
+        self.debug_numericaljacobiancoloring = False
         self.debug_saverhs = False
         self.debug_saveresidual = False
         self.debug_savesystem = False
         self.debug_timestep = 0
         self.debug_iteration = 1
         self.debug_rescaled = False
+        self.debug_format = DEBUG_FORMAT_PETSC
 
+        self.backend = BACKEND_CPU
         self.backupsolver = None
+        self.backuphold = 0
+        self.nthreads = 1
+        self.reproducible = True
+        self.reusesymbolic = False
+        self.reusefactorization = True
+        self.factorordering = FACTOR_ORDERING_DEFAULT
+        self.directassembly = True
+        self.fusedassembly = False
+        self.telemetry = False
+        self.savejacobianpattern = False
+        self.warmstart = None
+        self.adjoint_objective = None
+        self.adjoint_index = 0
+        self.adjoint_data_t = np.array([])
+        self.adjoint_data_x = np.array([])
+        self.adjoint_parameters = []
+        self.reducedmodel_basis = None
+        self.reducedmodel_tolerance = 1e-2
+        self.jacobianupdate = JACOBIAN_UPDATE_ALWAYS
+        self.maxcontraction = 0.5
+        self.krylovreltol = 1e-4
+        self.krylovmaxiter = 50
+        self.linesearch = LINE_SEARCH_NONE
+        self.linesearchmaxsteps = 8
+        self.predictor = PREDICTOR_NONE
+        self.pseudotransient = False
+        self.pseudotransient_tau0 = 1.0
+        self.pseudotransient_taumax = 1e6
+        self.eliminatealgebraic = False
+        self.borderscalars = False
+        self.localized = False
+        self.localized_width = 1
+        self.localized_maxfraction = 0.5
+        self.distributed = False
+        self.eisenstatwalker = False
+        self.eisenstatwalker_etamin = 1e-5
+        self.eisenstatwalker_etamax = 0.9
+        self.splitting_scheme = SPLITTING_NONE
+        self.splitting_tolerance = 1e-3
+        self.splitting_fluidsubsteps = 1
+        self.gmres_pc = GMRES_PC_BLOCK_JACOBI
+        self.gmres_splits = []
+        self.gmres_kineticpc = GMRES_KINETIC_PC_ILU
+        self.gmres_ionsplit = False
+        self.gmres_mglines = GMRES_MG_LINES_ALTERNATING
+        self.mixedprecision_method = MIXED_PRECISION_REFINEMENT_RICHARDSON
+        self.mixedprecision_factortol = 1e-7
+        self.mixedprecision_reltol = 1e-12
+        self.mixedprecision_maxiter = 20
         self.tolerance = ToleranceSettings()
         self.preconditioner = Preconditioner()
         self.setOption(linsolv=linsolv, maxiter=maxiter, verbose=verbose)
@@ -49,12 +150,14 @@ class Solver:
 
     def setDebug(self, printmatrixinfo=False, printjacobianinfo=False, savejacobian=False,
                  savesolution=False, savematrix=False, savenumericaljacobian=False, saverhs=False,
-                 saveresidual=False, savesystem=False, rescaled=False, timestep=0, iteration=1):
+                 saveresidual=False, savesystem=False, rescaled=False, timestep=0, iteration=1,
+                 printsparsity=False, format=DEBUG_FORMAT_PETSC, numericaljacobiancoloring=False):
         """
         Enable output of debug information.
 
         :param int timestep:   Index of time step to generate debug info for. If ``0``, debug info is generated in every (iteration of every) time step.
         :param int savesystem: Save full equation system as a DREAMOutput file in the most recent iteration/time step.
+        :param int format:     Format of saved matrices. Either ``DEBUG_FORMAT_PETSC`` (PETSc MATLAB binary viewer) or ``DEBUG_FORMAT_CSR`` (memory-mappable CSR file with an index of the unknown blocks; see ``dreamdebug.loadcsr()``).
 
         LINEAR SOLVER
         :param bool printmatrixinfo: If ``True``, calls ``PrintInfo()`` on the linear operator matrix.
@@ -63,34 +166,525 @@ class Solver:
 
         NON-LINEAR SOLVER
         :param bool printjacobianinfo:     If ``True``, calls ``PrintInfo()`` on the jacobian matrix.
+        :param bool printsparsity:         If ``True``, prints the estimated and actual number of non-zeros in each block of the jacobian matrix, and the fill of its factorization.
         :param bool savejacobian:          If ``True``, saves the jacobian matrix using a PETSc viewer.
         :param bool savesolution:          If ``True``, saves the solution vector to a ``.mat`` file.
         :param bool savenumericaljacobian: If ``True``, evaluates the jacobian matrix numerically and saves it using a PETSc viewer.
+        :param bool numericaljacobiancoloring: If ``True``, perturbs several columns at a time when evaluating the numerical jacobian, grouped using the non-zero pattern of the analytical jacobian. Elements outside of that pattern are then not resolved.
         :param bool saveresidual:          If ``True``, saves the residual vector to a ``.mat`` file.
         :param bool rescaled:              If ``True``, saves the rescaled versions of the jacobian/solution/residual.
         :param int iteration:              Index of iteration to save debug info for. If ``0``, saves in all iterations. If ``timestep`` is ``0``, this parameter is always ignored.
         """
         self.debug_printmatrixinfo = printmatrixinfo
         self.debug_printjacobianinfo = printjacobianinfo
+        self.debug_printsparsity = printsparsity
         self.debug_savejacobian = savejacobian
         self.debug_savesolution = savesolution
         self.debug_savematrix = savematrix
         self.debug_savenumericaljacobian = savenumericaljacobian
+        self.debug_numericaljacobiancoloring = numericaljacobiancoloring
         self.debug_saverhs = saverhs
         self.debug_saveresidual = saveresidual
         self.debug_savesystem = savesystem
         self.debug_rescaled = rescaled
         self.debug_timestep = timestep
         self.debug_iteration = iteration
+        self.debug_format = format
+
+
+    def setBackend(self, backend):
+        """
+        Set the backend to use for the matrices, vectors and linear
+        solves of the equation system. The GPU backends (``BACKEND_CUDA``,
+        ``BACKEND_HIP`` and ``BACKEND_KOKKOS``) require DREAM to have been
+        compiled with ``DREAM_WITH_GPU`` against a PETSc with support for
+        the corresponding backend, and can only be used with the
+        ``LINEAR_SOLVER_LU`` and ``LINEAR_SOLVER_GMRES`` linear solvers.
+        """
+        self.backend = int(backend)
+        self.verifySettings()
 
 
-    def setBackupSolver(self, backup):
+    def setBackupSolver(self, backup, hold=None):
         """
         Set the backup linear solver to use in case the main linear
         solver fails. Set to ``None`` to disable (default).
+
+        :param int backup: Backup linear solver to use.
+        :param int hold:   Maximum number of time steps to start with the backup solver after the main solver has failed (0 = always start with the main solver). The number of steps doubles with every renewed failure of the main solver, and is reset once the main solver succeeds.
         """
         self.backupsolver = backup
 
+        if hold is not None:
+            if hold < 0:
+                raise DREAMException("Solver: Invalid backup solver hold: {}. Must be non-negative.".format(hold))
+            self.backuphold = int(hold)
+
+
+    def setNumberOfThreads(self, nthreads):
+        """
+        Set the number of threads to use when rebuilding the grids and the
+        equation terms, when evaluating other quantities, and when building
+        the jacobian matrix of the non-linear solver. Requires DREAM to have
+        been compiled with OpenMP support.
+        """
+        self.nthreads = int(nthreads)
+        self.verifySettings()
+
+
+    def setReproducible(self, reproducible=True):
+        """
+        If ``True`` (default), parallel sums are evaluated in a fixed order,
+        so that the results are bitwise identical regardless of the number
+        of threads. If ``False``, the partial sums of the threads are
+        combined in the order in which the threads finish, which is faster
+        but makes the solution depend (within the solver tolerances) on the
+        number of threads.
+        """
+        self.reproducible = bool(reproducible)
+
+
+    def setReuseSymbolicFactorization(self, reuse=True):
+        """
+        If ``True``, the direct linear solvers (LU and MUMPS) keep the
+        ordering and fill pattern computed in the first factorization
+        of the matrix, so that only the numeric factorization is redone
+        in later iterations and time steps.
+        """
+        self.reusesymbolic = bool(reuse)
+
+
+    def setReuseFactorization(self, reuse=True):
+        """
+        If ``True`` (default), the linearly implicit solver reuses the
+        factorization of the matrix in time steps where the matrix is
+        identical to the one most recently factorized (as is typically
+        the case with constant prescribed parameters and time step), so
+        that only the triangular solves are redone. The solution is
+        unaffected.
+        """
+        self.reusefactorization = bool(reuse)
+
+
+    def setFactorOrdering(self, ordering=FACTOR_ORDERING_RADIAL):
+        """
+        Set the ordering of the unknowns used when the direct linear
+        solvers (LU and MUMPS) factorize the matrix. The ordering does
+        not affect the solution, but can considerably reduce the fill
+        (memory use) and time of the factorization of large fluid
+        systems, in particular with many ion charge states.
+
+        :param int ordering: Either ``FACTOR_ORDERING_DEFAULT`` (ordering chosen by the linear solver; default), ``FACTOR_ORDERING_RADIAL`` (all unknowns at one radius are ordered together), ``FACTOR_ORDERING_RCM`` (reverse Cuthill-McKee) or ``FACTOR_ORDERING_ND`` (nested dissection).
+        """
+        self.factorordering = int(ordering)
+        self.verifySettings()
+
+
+    def setDirectAssembly(self, direct=True):
+        """
+        If ``True`` (default), the matrix elements which fall within the
+        non-zero pattern of the previous assembly are written directly
+        into the PETSc matrix storage, rather than through one call to
+        ``MatSetValues()`` per element. The resulting matrix is identical
+        in both cases.
+        """
+        self.directassembly = bool(direct)
+
+
+    def setFusedAssembly(self, fused=True):
+        """
+        If ``True``, the non-linear solver evaluates the residual of each
+        equation together with its block row of the jacobian (in the same
+        thread), in the iterations where the jacobian is rebuilt. The terms
+        of each equation are then only traversed once while their data is
+        in cache, and the residual is evaluated in parallel along with the
+        jacobian. The residual and jacobian are identical in both cases.
+        """
+        self.fusedassembly = bool(fused)
+
+
+    def setTelemetry(self, telemetry=True):
+        """
+        If ``True``, convergence information about every Newton iteration
+        (norms of the solution and Newton step for each unknown, damping
+        factor, number of linear solver iterations), the fill of the
+        jacobian factorization in each time step and the number of
+        rejected time steps of adaptive time steppers are saved to the
+        output.
+        """
+        self.telemetry = bool(telemetry)
+
+
+    def setSaveJacobianPattern(self, save=True):
+        """
+        If ``True``, the non-zero pattern of the jacobian matrix is saved
+        to the output, so that the output can later be used to warm-start
+        another simulation (see :py:meth:`setWarmStart`).
+        """
+        self.savejacobianpattern = bool(save)
+
+
+    def setPredictor(self, predictor=PREDICTOR_QUADRATIC):
+        """
+        Set how the initial guess of the non-linear solver is obtained in
+        each time step. By default, the Newton iteration starts from the
+        solution in the previous time step. With a predictor, the solutions
+        in the most recent time steps are instead extrapolated to the new
+        time, which typically saves one or two Newton iterations per time
+        step when the solution evolves smoothly. Densities, temperatures and
+        energies are never extrapolated to negative values.
+
+        :param int predictor: Either ``PREDICTOR_NONE`` (start from the previous solution; default), ``PREDICTOR_LINEAR`` (linear extrapolation from the two most recent solutions) or ``PREDICTOR_QUADRATIC`` (quadratic extrapolation from the three most recent solutions).
+        """
+        self.predictor = int(predictor)
+        self.verifySettings()
+
+
+    def setWarmStart(self, filename):
+        """
+        Warm-start the simulation from the solution saved in the given
+        DREAM output file. In every time step, the solution of the
+        reference simulation (interpolated in time) is used as the initial
+        guess of the non-linear solver. If the reference output contains
+        the jacobian non-zero pattern (see :py:meth:`setSaveJacobianPattern`)
+        it is used to preallocate the jacobian matrix. Only unknowns with
+        the same number of elements in both simulations are taken from the
+        reference solution.
+
+        :param str filename: Name of reference output file, or ``None`` to disable warm-starting.
+        """
+        if filename is None:
+            self.warmstart = None
+        else:
+            self.warmstart = os.path.abspath(filename)
+
+
+    def setAdjoint(self, objective, index=0, t=None, data=None, parameters=[]):
+        """
+        Evaluate the sensitivities of an objective with respect to a set
+        of parameters, using the discrete adjoint of the time stepping.
+        The objective is either the value of one element of a non-trivial
+        unknown quantity at the final time or, if ``t`` and ``data`` are
+        given, half the sum of the squared differences between that
+        element and the data (at the time steps closest to the given
+        times). The parameters are multiplicative scale factors of
+        prescribed unknown quantities (evaluated around 1). The objective
+        and its gradient are saved in the solver output.
+
+        Adjoint sensitivities require the non-linear solver with a
+        jacobian updated in every iteration, and a first-order (backward
+        Euler) time stepper.
+
+        :param str objective:   Name of unknown quantity defining the objective, or ``None`` to disable adjoint sensitivities.
+        :param int index:       Index of the element of the unknown quantity to use.
+        :param t:               Times at which the data to fit is given.
+        :param data:            Data to fit the element to.
+        :param list parameters: Names of prescribed unknown quantities whose scale factors to differentiate with respect to.
+        """
+        self.adjoint_objective = objective
+        self.adjoint_index = int(index)
+        self.adjoint_parameters = list(parameters)
+
+        if t is None or data is None:
+            self.adjoint_data_t = np.array([])
+            self.adjoint_data_x = np.array([])
+        else:
+            self.adjoint_data_t = np.atleast_1d(np.asarray(t, dtype=float))
+            self.adjoint_data_x = np.atleast_1d(np.asarray(data, dtype=float))
+
+
+    def setReducedModel(self, basis, tolerance=None):
+        """
+        Take the time steps with a projection-based reduced-order model.
+        The solution is approximated in a reduced basis, constructed from
+        a set of training runs with :py:func:`DREAM.ReducedBasis.buildReducedBasis`,
+        and the equations are projected onto the basis. The residual of the
+        full model is evaluated for the reduced solution, and if it has not
+        decreased by at least the factor ``tolerance`` compared to the initial
+        guess, the time step is retaken with the full model. The first time
+        step is always taken with the full model.
+
+        :param str basis:       Name of file containing the reduced basis, or ``None`` to disable the reduced-order model.
+        :param float tolerance: Maximum allowed ratio between the residual of the reduced solution and of the initial guess.
+        """
+        if basis is None:
+            self.reducedmodel_basis = None
+        else:
+            self.reducedmodel_basis = os.path.abspath(basis)
+
+        if tolerance is not None:
+            self.reducedmodel_tolerance = float(tolerance)
+
+
+    def setJacobianUpdate(self, mode, maxcontraction=None, krylovreltol=None, krylovmaxiter=None):
+        """
+        Set the strategy for updating the jacobian matrix in the
+        non-linear solver.
+
+        :param int mode:             One of ``JACOBIAN_UPDATE_ALWAYS`` (standard Newton), ``JACOBIAN_UPDATE_MODIFIED_NEWTON`` (reuse the factorized jacobian while the iteration converges sufficiently fast) ``JACOBIAN_UPDATE_NEWTON_KRYLOV`` (solve with GMRES, preconditioned by the most recently factorized jacobian) and ``JACOBIAN_UPDATE_JFNK`` (Jacobian-free Newton-Krylov, preconditioned by the most recently factorized jacobian).
+        :param float maxcontraction: Largest ratio between the lengths of two consecutive Newton steps allowed before the jacobian is refactorized.
+        :param float krylovreltol:   Relative tolerance of the Krylov solver (Newton-Krylov and JFNK modes only).
+        :param int krylovmaxiter:    Maximum number of Krylov iterations per Newton step (Newton-Krylov and JFNK modes only).
+        """
+        self.jacobianupdate = int(mode)
+
+        if maxcontraction is not None:
+            self.maxcontraction = float(maxcontraction)
+        if krylovreltol is not None:
+            self.krylovreltol = float(krylovreltol)
+        if krylovmaxiter is not None:
+            self.krylovmaxiter = int(krylovmaxiter)
+
+        self.verifySettings()
+
+
+    def setLineSearch(self, method=LINE_SEARCH_BACKTRACKING, maxsteps=None):
+        """
+        Set the globalization strategy of the Newton iteration in the
+        non-linear solver.
+
+        :param int method:   Either ``LINE_SEARCH_NONE`` (only damp steps which would make unknowns unphysical; default) or ``LINE_SEARCH_BACKTRACKING`` (backtracking line search on the norm of the residual).
+        :param int maxsteps: Maximum number of backtracking steps per Newton iteration.
+        """
+        self.linesearch = int(method)
+
+        if maxsteps is not None:
+            self.linesearchmaxsteps = int(maxsteps)
+
+        self.verifySettings()
+
+
+    def setPseudoTransient(self, enabled=True, tau0=None, taumax=None):
+        """
+        Enable pseudo-transient continuation in the non-linear solver.
+        A pseudo time derivative, with a pseudo time step which grows as
+        the residual decreases, is then added to the equations, which
+        makes the iteration considerably more robust when the initial
+        guess is far from the solution (e.g. when taking very long
+        time steps towards a steady state).
+
+        :param bool enabled: Whether or not to use pseudo-transient continuation.
+        :param float tau0:   Initial pseudo time step, relative to the characteristic time of each unknown (``|J_ii|^-1``).
+        :param float taumax: Relative pseudo time step above which the pseudo time derivative is dropped.
+        """
+        self.pseudotransient = bool(enabled)
+
+        if tau0 is not None:
+            self.pseudotransient_tau0 = float(tau0)
+        if taumax is not None:
+            self.pseudotransient_taumax = float(taumax)
+
+        self.verifySettings()
+
+
+    def setAlgebraicElimination(self, eliminate=True):
+        """
+        If ``True``, unknowns which are given by algebraic relations
+        (such as the ohmic current density or the total electron density)
+        are eliminated from the linear systems of the Newton iteration.
+        Only the remaining (smaller) system is then factorized, and the
+        eliminated unknowns are evaluated from its solution, which gives
+        the same Newton step as solving the full system. Requires the
+        jacobian to be updated in every iteration, and can not be used
+        with the ``LINEAR_SOLVER_GMRES`` linear solver.
+        """
+        self.eliminatealgebraic = bool(eliminate)
+        self.verifySettings()
+
+
+    def setBorderedSystem(self, enabled=True):
+        """
+        If ``True``, the linear systems of the Newton iteration are solved
+        as bordered systems, with the scalar unknowns (such as the plasma
+        current and the wall flux of the circuit equations) forming the
+        border. Only the remaining (sparse) block of the jacobian is then
+        factorized, and the scalar unknowns are solved for with a small
+        dense system, which gives the same Newton step as solving the full
+        system. Requires the jacobian to be updated in every iteration,
+        and can neither be used with the ``LINEAR_SOLVER_GMRES`` linear
+        solver nor be combined with algebraic elimination.
+        """
+        self.borderscalars = bool(enabled)
+        self.verifySettings()
+
+
+    def setLocalizedNewton(self, enabled=True, width=None, maxfraction=None):
+        """
+        If ``True``, the Newton steps are restricted to the radii which
+        have not yet converged. After each Newton iteration, the step is
+        compared to the tolerances in every radius separately, and in the
+        following iterations only the linear system for the unconverged
+        radii (and ``width`` neighbouring radii on each side of them) is
+        solved, while the remaining radii are kept fixed. Unknowns which
+        are not resolved radially are always solved for. Convergence is
+        always verified with a final Newton iteration for the full system.
+        Requires the jacobian to be updated in every iteration, and can
+        not be combined with algebraic elimination or bordered systems.
+
+        :param bool enabled:      Whether or not to use localized Newton iterations.
+        :param int width:         Number of neighbouring radii on each side of an unconverged radius to also solve for.
+        :param float maxfraction: Maximum fraction of active radii for which the step is restricted (with more active radii, the full system is solved).
+        """
+        self.localized = bool(enabled)
+
+        if width is not None:
+            self.localized_width = int(width)
+        if maxfraction is not None:
+            self.localized_maxfraction = float(maxfraction)
+
+        self.verifySettings()
+
+
+    def setDistributed(self, enabled=True):
+        """
+        If ``True``, the linear systems of the Newton iteration are solved
+        with the radial grid distributed over all MPI processes that DREAM
+        is run on (e.g. with ``mpirun -n 4 dreami settings.h5``). Every
+        process evaluates the full residual and jacobian, but only inserts
+        the rows of its own radii into the distributed matrix, and the
+        Newton step is gathered on all processes after the parallel solve.
+        Only the first process writes output. Requires the
+        ``LINEAR_SOLVER_MUMPS`` or ``LINEAR_SOLVER_GMRES`` linear solver,
+        the CPU backend and the jacobian to be updated in every iteration,
+        and can not be combined with algebraic elimination, bordered
+        systems, localized Newton iterations, operator splitting, the
+        reduced-order model or adjoint sensitivities.
+
+        :param bool enabled: Whether or not to distribute the linear systems.
+        """
+        self.distributed = bool(enabled)
+        self.verifySettings()
+
+
+    def setEisenstatWalker(self, enabled=True, etamin=None, etamax=None):
+        """
+        Solve the linear systems of the Newton iteration inexactly, with a
+        relative tolerance given by the Eisenstat-Walker forcing terms. The
+        tolerance is relaxed while the residual of the non-linear equations
+        decreases slowly, and tightened as the Newton iteration converges,
+        which greatly reduces the number of linear solver iterations in the
+        first Newton iterations of each time step. Only affects iterative
+        linear solvers (``LINEAR_SOLVER_GMRES``, and the Krylov solves of
+        the ``JACOBIAN_UPDATE_NEWTON_KRYLOV`` and ``JACOBIAN_UPDATE_JFNK``
+        modes, where the forcing term replaces ``krylovreltol``).
+
+        :param bool enabled:  Whether or not to use Eisenstat-Walker forcing terms.
+        :param float etamin:  Smallest relative tolerance of the linear solves.
+        :param float etamax:  Largest relative tolerance of the linear solves.
+        """
+        self.eisenstatwalker = bool(enabled)
+
+        if etamin is not None:
+            self.eisenstatwalker_etamin = float(etamin)
+        if etamax is not None:
+            self.eisenstatwalker_etamax = float(etamax)
+
+        self.verifySettings()
+
+
+    def setSplitting(self, scheme=SPLITTING_STRANG, tolerance=None, fluidsubsteps=None):
+        """
+        Split the equation system into its kinetic and fluid parts in the
+        non-linear solver. In each time step, the kinetic unknowns are
+        then advanced with the fluid unknowns frozen (reusing the
+        factorized kinetic jacobian between time steps), and the fluid
+        unknowns are advanced with the kinetic unknowns frozen. If the
+        splitting error is too large, the time step is retaken with the
+        fully coupled solver.
+
+        :param int scheme:        Either ``SPLITTING_NONE`` (solve the coupled system; default), ``SPLITTING_LIE`` (kinetic step followed by fluid step) or ``SPLITTING_STRANG`` (kinetic half-step, fluid step and kinetic half-step).
+        :param float tolerance:   Maximum ratio between the residual of the coupled system in the split solution and in the initial guess of the time step.
+        :param int fluidsubsteps: Number of substeps taken by the fluid subsystem in every (kinetic) time step.
+        """
+        self.splitting_scheme = int(scheme)
+
+        if tolerance is not None:
+            self.splitting_tolerance = float(tolerance)
+        if fluidsubsteps is not None:
+            self.splitting_fluidsubsteps = int(fluidsubsteps)
+
+        self.verifySettings()
+
+
+    def setGMRESPreconditioner(self, pc=GMRES_PC_FIELDSPLIT, splits=None, kineticpc=None, ionsplit=None, mglines=None):
+        """
+        Set the preconditioner to use with the GMRES linear solver.
+
+        With ``GMRES_PC_FIELDSPLIT``, the unknowns are divided into groups
+        ("splits"). With two splits, the second split is coupled to the
+        first through a (approximate) Schur complement, which is
+        factorized with LU. By default, all kinetic unknowns are placed in
+        the first split and all fluid and scalar unknowns in the second.
+        Splits containing kinetic unknowns are preconditioned with
+        ``kineticpc`` (ILU, algebraic multigrid or LU), while other splits
+        are solved with LU.
+
+        With ``GMRES_PC_KINETIC_GRIDS``, the unknowns on each kinetic grid
+        (e.g. ``f_hot`` and ``f_re``) form one split each, and all other
+        unknowns a final split. The splits are applied as a block
+        Gauss-Seidel preconditioner, so that each kinetic block is
+        factorized separately rather than as part of one large matrix.
+
+        :param int pc:         Preconditioner to use (``GMRES_PC_BLOCK_JACOBI``, ``GMRES_PC_FIELDSPLIT`` or ``GMRES_PC_KINETIC_GRIDS``).
+        :param list splits:    List of lists of names of unknowns in each split (e.g. ``[['f_hot', 'f_re'], ['E_field', 'psi_p', 'j_tot', 'T_cold']]``). Unlisted unknowns are added to the last split.
+        With ``GMRES_KINETIC_PC_RADIAL_LU``, the momentum-space block of
+        each radius of a kinetic split is factorized separately. This is
+        exact when the kinetic equations contain no radial transport (if
+        the matrix is found to couple different radii, a single LU
+        factorization of the split is used instead).
+
+        With ``GMRES_KINETIC_PC_MG``, a kinetic split is preconditioned
+        with one V-cycle of geometric multigrid, which coarsens the momentum
+        grid of each radius and requires memory and time proportional to
+        the number of grid cells. The smoother relaxes grid lines along p
+        (``GMRES_MG_LINES_P``), along xi (``GMRES_MG_LINES_XI``) or along
+        both (``GMRES_MG_LINES_ALTERNATING``, default), as given by
+        ``mglines``.
+
+        With ``ionsplit=True``, the ion densities are placed in a split of
+        their own (before the split of the fluid unknowns), which is
+        preconditioned with the inverse of the dense block coupling the
+        charge states at each radius. This is exact without radial
+        transport of the ions. The ion split is only formed when the
+        splits are not given explicitly.
+
+        :param int kineticpc:  Preconditioner to use for kinetic splits (``GMRES_KINETIC_PC_ILU``, ``GMRES_KINETIC_PC_GAMG``, ``GMRES_KINETIC_PC_LU``, ``GMRES_KINETIC_PC_RADIAL_LU`` or ``GMRES_KINETIC_PC_MG``).
+        :param bool ionsplit:  If ``True``, place the ion densities in a separate split.
+        :param int mglines:    Lines relaxed by the multigrid smoother (``GMRES_MG_LINES_P``, ``GMRES_MG_LINES_XI`` or ``GMRES_MG_LINES_ALTERNATING``).
+        """
+        self.gmres_pc = int(pc)
+
+        if splits is not None:
+            self.gmres_splits = [list(s) for s in splits]
+        if kineticpc is not None:
+            self.gmres_kineticpc = int(kineticpc)
+        if ionsplit is not None:
+            self.gmres_ionsplit = bool(ionsplit)
+        if mglines is not None:
+            self.gmres_mglines = int(mglines)
+
+
+    def setMixedPrecision(self, method=None, factortol=None, reltol=None, maxiter=None):
+        """
+        Set options for the mixed-precision linear solver
+        (``LINEAR_SOLVER_MIXED_PRECISION``), which factorizes the matrix to
+        a reduced accuracy and recovers full accuracy via iterative
+        refinement (or GMRES preconditioned by the factorization).
+
+        :param int method:      Refinement method (``MIXED_PRECISION_REFINEMENT_RICHARDSON`` or ``MIXED_PRECISION_REFINEMENT_GMRES``).
+        :param float factortol: Relative accuracy of the low-precision factorization.
+        :param float reltol:    Relative tolerance of the refinement.
+        :param int maxiter:     Maximum number of refinement iterations.
+        """
+        if method is not None:
+            self.mixedprecision_method = int(method)
+        if factortol is not None:
+            self.mixedprecision_factortol = float(factortol)
+        if reltol is not None:
+            self.mixedprecision_reltol = float(reltol)
+        if maxiter is not None:
+            self.mixedprecision_maxiter = int(maxiter)
+
 
     def setLinearSolver(self, linsolv):
         """
@@ -165,6 +759,63 @@ class Solver:
         if 'verbose' in data:
             self.verbose = bool(data['verbose'])
 
+        if 'backend' in data:
+            self.backend = int(scal(data['backend']))
+
+        if 'nthreads' in data:
+            self.nthreads = int(scal(data['nthreads']))
+        if 'reproducible' in data:
+            self.reproducible = bool(data['reproducible'])
+
+        if 'reusesymbolic' in data:
+            self.reusesymbolic = bool(data['reusesymbolic'])
+        if 'reusefactorization' in data:
+            self.reusefactorization = bool(data['reusefactorization'])
+        if 'factorordering' in data:
+            self.factorordering = int(scal(data['factorordering']))
+
+        if 'directassembly' in data:
+            self.directassembly = bool(data['directassembly'])
+
+        if 'fusedassembly' in data:
+            self.fusedassembly = bool(scal(data['fusedassembly']))
+
+        if 'telemetry' in data:
+            self.telemetry = bool(data['telemetry'])
+
+        if 'savejacobianpattern' in data:
+            self.savejacobianpattern = bool(data['savejacobianpattern'])
+
+        if 'warmstart' in data and len(data['warmstart']) > 0:
+            self.warmstart = data['warmstart']
+
+        if 'adjoint' in data and len(data['adjoint']['objective']) > 0:
+            self.adjoint_objective = data['adjoint']['objective']
+            self.adjoint_index = int(scal(data['adjoint']['index']))
+            self.adjoint_data_t = np.atleast_1d(data['adjoint']['data_t'])
+            self.adjoint_data_x = np.atleast_1d(data['adjoint']['data_x'])
+            self.adjoint_parameters = [p for p in data['adjoint']['parameters'].split(';') if p != '']
+
+        if 'reducedmodel' in data:
+            if len(data['reducedmodel']['basis']) > 0:
+                self.reducedmodel_basis = data['reducedmodel']['basis']
+            self.reducedmodel_tolerance = float(scal(data['reducedmodel']['tolerance']))
+
+        if 'jacobianupdate' in data:
+            self.jacobianupdate = int(scal(data['jacobianupdate']))
+        if 'maxcontraction' in data:
+            self.maxcontraction = float(scal(data['maxcontraction']))
+        if 'krylovreltol' in data:
+            self.krylovreltol = float(scal(data['krylovreltol']))
+        if 'krylovmaxiter' in data:
+            self.krylovmaxiter = int(scal(data['krylovmaxiter']))
+        if 'linesearch' in data:
+            self.linesearch = int(scal(data['linesearch']))
+        if 'linesearchmaxsteps' in data:
+            self.linesearchmaxsteps = int(scal(data['linesearchmaxsteps']))
+        if 'predictor' in data:
+            self.predictor = int(scal(data['predictor']))
+
         if 'tolerance' in data:
             self.tolerance.fromdict(data['tolerance'])
 
@@ -174,8 +825,79 @@ class Solver:
         if 'backupsolver' in data:
             self.backupsolver = int(data['backupsolver'])
 
+        if 'backuphold' in data:
+            self.backuphold = int(scal(data['backuphold']))
+
+        if 'mixedprecision' in data:
+            mp = data['mixedprecision']
+            if 'method' in mp:
+                self.mixedprecision_method = int(scal(mp['method']))
+            if 'factortol' in mp:
+                self.mixedprecision_factortol = float(scal(mp['factortol']))
+            if 'reltol' in mp:
+                self.mixedprecision_reltol = float(scal(mp['reltol']))
+            if 'maxiter' in mp:
+                self.mixedprecision_maxiter = int(scal(mp['maxiter']))
+
+        if 'eliminatealgebraic' in data:
+            self.eliminatealgebraic = bool(scal(data['eliminatealgebraic']))
+
+        if 'borderscalars' in data:
+            self.borderscalars = bool(scal(data['borderscalars']))
+
+        if 'localized' in data:
+            lc = data['localized']
+            if 'enabled' in lc:
+                self.localized = bool(scal(lc['enabled']))
+            if 'width' in lc:
+                self.localized_width = int(scal(lc['width']))
+            if 'maxfraction' in lc:
+                self.localized_maxfraction = float(scal(lc['maxfraction']))
+
+        if 'distributed' in data:
+            self.distributed = bool(scal(data['distributed']))
+
+        if 'eisenstatwalker' in data:
+            ew = data['eisenstatwalker']
+            if 'enabled' in ew:
+                self.eisenstatwalker = bool(scal(ew['enabled']))
+            if 'etamin' in ew:
+                self.eisenstatwalker_etamin = float(scal(ew['etamin']))
+            if 'etamax' in ew:
+                self.eisenstatwalker_etamax = float(scal(ew['etamax']))
+
+        if 'pseudotransient' in data:
+            pt = data['pseudotransient']
+            if 'enabled' in pt:
+                self.pseudotransient = bool(scal(pt['enabled']))
+            if 'tau0' in pt:
+                self.pseudotransient_tau0 = float(scal(pt['tau0']))
+            if 'taumax' in pt:
+                self.pseudotransient_taumax = float(scal(pt['taumax']))
+
+        if 'splitting' in data:
+            sp = data['splitting']
+            if 'scheme' in sp:
+                self.splitting_scheme = int(scal(sp['scheme']))
+            if 'tolerance' in sp:
+                self.splitting_tolerance = float(scal(sp['tolerance']))
+            if 'fluidsubsteps' in sp:
+                self.splitting_fluidsubsteps = int(scal(sp['fluidsubsteps']))
+
+        if 'gmres' in data:
+            if 'pc' in data['gmres']:
+                self.gmres_pc = int(scal(data['gmres']['pc']))
+            if 'kineticpc' in data['gmres']:
+                self.gmres_kineticpc = int(scal(data['gmres']['kineticpc']))
+            if 'ionsplit' in data['gmres']:
+                self.gmres_ionsplit = bool(scal(data['gmres']['ionsplit']))
+            if 'mglines' in data['gmres']:
+                self.gmres_mglines = int(scal(data['gmres']['mglines']))
+            if 'splits' in data['gmres']:
+                self.gmres_splits = [s.split(',') for s in data['gmres']['splits'].split(';') if s != '']
+
         if 'debug' in data:
-            flags = ['printmatrixinfo', 'printjacobianinfo', 'savejacobian', 'savesolution', 'savematrix', 'savenumericaljacobian', 'saverhs', 'saveresidual', 'savesystem', 'rescaled']
+            flags = ['printmatrixinfo', 'printjacobianinfo', 'printsparsity', 'savejacobian', 'savesolution', 'savematrix', 'savenumericaljacobian', 'numericaljacobiancoloring', 'saverhs', 'saveresidual', 'savesystem', 'rescaled']
 
             for f in flags:
                 if f in data['debug']:
@@ -185,6 +907,8 @@ class Solver:
                 self.debug_timestep = int(data['debug']['timestep'])
             if 'iteration' in data['debug']:
                 self.debug_iteration = int(data['debug']['iteration'])
+            if 'format' in data['debug']:
+                self.debug_format = int(scal(data['debug']['format']))
 
         self.verifySettings()
 
@@ -201,10 +925,51 @@ class Solver:
             'type': self.type,
             'linsolv': self.linsolv,
             'maxiter': self.maxiter,
-            'verbose': self.verbose
+            'verbose': self.verbose,
+            'backend': self.backend,
+            'nthreads': self.nthreads,
+            'reproducible': self.reproducible,
+            'reusesymbolic': self.reusesymbolic,
+            'reusefactorization': self.reusefactorization,
+            'factorordering': self.factorordering,
+            'directassembly': self.directassembly,
+            'fusedassembly': self.fusedassembly,
+            'telemetry': self.telemetry,
+            'savejacobianpattern': self.savejacobianpattern
         }
 
+        if self.warmstart is not None:
+            data['warmstart'] = self.warmstart
+
+        if self.adjoint_objective is not None:
+            data['adjoint'] = {
+                'objective': self.adjoint_objective,
+                'index': self.adjoint_index,
+                'data_t': self.adjoint_data_t,
+                'data_x': self.adjoint_data_x,
+                'parameters': ';'.join(self.adjoint_parameters)
+            }
+
+        if self.reducedmodel_basis is not None:
+            data['reducedmodel'] = {
+                'basis': self.reducedmodel_basis,
+                'tolerance': self.reducedmodel_tolerance
+            }
+
         data['preconditioner'] = self.preconditioner.todict()
+        data['mixedprecision'] = {
+            'method': self.mixedprecision_method,
+            'factortol': self.mixedprecision_factortol,
+            'reltol': self.mixedprecision_reltol,
+            'maxiter': self.mixedprecision_maxiter
+        }
+        data['gmres'] = {
+            'pc': self.gmres_pc,
+            'kineticpc': self.gmres_kineticpc,
+            'ionsplit': self.gmres_ionsplit,
+            'mglines': self.gmres_mglines,
+            'splits': ';'.join([','.join(s) for s in self.gmres_splits])
+        }
 
         if self.type == LINEAR_IMPLICIT:
             data['debug'] = {
@@ -212,24 +977,60 @@ class Solver:
                 'savematrix': self.debug_savematrix,
                 'saverhs': self.debug_saverhs,
                 'savesystem': self.debug_savesystem,
-                'timestep': self.debug_timestep
+                'timestep': self.debug_timestep,
+                'format': self.debug_format
             }
         elif self.type == NONLINEAR:
             data['tolerance'] = self.tolerance.todict()
             data['debug'] = {
                 'printjacobianinfo': self.debug_printjacobianinfo,
+                'printsparsity': self.debug_printsparsity,
                 'savejacobian': self.debug_savejacobian,
                 'savesolution': self.debug_savesolution,
                 'savenumericaljacobian': self.debug_savenumericaljacobian,
+                'numericaljacobiancoloring': self.debug_numericaljacobiancoloring,
                 'saveresidual': self.debug_saveresidual,
                 'savesystem': self.debug_savesystem,
                 'rescaled': self.debug_rescaled,
                 'timestep': self.debug_timestep,
-                'iteration': self.debug_iteration
+                'iteration': self.debug_iteration,
+                'format': self.debug_format
             }
 
             if self.backupsolver is not None:
                 data['backupsolver'] = self.backupsolver
+            data['backuphold'] = self.backuphold
+
+            data['jacobianupdate'] = self.jacobianupdate
+            data['maxcontraction'] = self.maxcontraction
+            data['krylovreltol'] = self.krylovreltol
+            data['krylovmaxiter'] = self.krylovmaxiter
+            data['linesearch'] = self.linesearch
+            data['linesearchmaxsteps'] = self.linesearchmaxsteps
+            data['predictor'] = self.predictor
+            data['eliminatealgebraic'] = self.eliminatealgebraic
+            data['borderscalars'] = self.borderscalars
+            data['localized'] = {
+                'enabled': self.localized,
+                'width': self.localized_width,
+                'maxfraction': self.localized_maxfraction
+            }
+            data['distributed'] = self.distributed
+            data['eisenstatwalker'] = {
+                'enabled': self.eisenstatwalker,
+                'etamin': self.eisenstatwalker_etamin,
+                'etamax': self.eisenstatwalker_etamax
+            }
+            data['pseudotransient'] = {
+                'enabled': self.pseudotransient,
+                'tau0': self.pseudotransient_tau0,
+                'taumax': self.pseudotransient_taumax
+            }
+            data['splitting'] = {
+                'scheme': self.splitting_scheme,
+                'tolerance': self.splitting_tolerance,
+                'fluidsubsteps': self.splitting_fluidsubsteps
+            }
 
         return data
 
@@ -249,6 +1050,8 @@ class Solver:
                 raise DREAMException("Solver: Invalid type of parameter 'debug_saverhs': {}. Expected boolean.".format(type(self.debug_saverhs)))
             elif type(self.debug_timestep) != int:
                 raise DREAMException("Solver: Invalid type of parameter 'debug_timestep': {}. Expected integer.".format(type(self.debug_timestep)))
+            elif self.debug_format not in [DEBUG_FORMAT_PETSC, DEBUG_FORMAT_CSR]:
+                raise DREAMException("Solver: Unrecognized debug matrix format: {}.".format(self.debug_format))
 
         elif self.type == NONLINEAR:
             if type(self.maxiter) != int:
@@ -258,12 +1061,16 @@ class Solver:
 
             if type(self.debug_printjacobianinfo) != bool:
                 raise DREAMException("Solver: Invalid type of parameter 'debug_printjacobianinfo': {}. Expected boolean.".format(type(self.debug_printjacobianinfo)))
+            elif type(self.debug_printsparsity) != bool:
+                raise DREAMException("Solver: Invalid type of parameter 'debug_printsparsity': {}. Expected boolean.".format(type(self.debug_printsparsity)))
             elif type(self.debug_savejacobian) != bool:
                 raise DREAMException("Solver: Invalid type of parameter 'debug_savejacobian': {}. Expected boolean.".format(type(self.debug_savejacobian)))
             elif type(self.debug_savesolution) != bool:
                 raise DREAMException("Solver: Invalid type of parameter 'debug_savesolution': {}. Expected boolean.".format(type(self.debug_savesolution)))
             elif type(self.debug_saverhs) != bool:
                 raise DREAMException("Solver: Invalid type of parameter 'debug_saverhs': {}. Expected boolean.".format(type(self.debug_saverhs)))
+            elif type(self.debug_numericaljacobiancoloring) != bool:
+                raise DREAMException("Solver: Invalid type of parameter 'debug_numericaljacobiancoloring': {}. Expected boolean.".format(type(self.debug_numericaljacobiancoloring)))
             elif type(self.debug_saveresidual) != bool:
                 raise DREAMException("Solver: Invalid type of parameter 'debug_saveresidual': {}. Expected boolean.".format(type(self.debug_saveresidual)))
             elif type(self.debug_rescaled) != bool:
@@ -272,24 +1079,150 @@ class Solver:
                 raise DREAMException("Solver: Invalid type of parameter 'debug_timestep': {}. Expected integer.".format(type(self.debug_timestep)))
             elif type(self.debug_iteration) != int:
                 raise DREAMException("Solver: Invalid type of parameter 'debug_iteration': {}. Expected boolean.".format(type(self.debug_iteration)))
+            elif self.debug_format not in [DEBUG_FORMAT_PETSC, DEBUG_FORMAT_CSR]:
+                raise DREAMException("Solver: Unrecognized debug matrix format: {}.".format(self.debug_format))
+
+            if self.jacobianupdate not in [JACOBIAN_UPDATE_ALWAYS, JACOBIAN_UPDATE_MODIFIED_NEWTON, JACOBIAN_UPDATE_NEWTON_KRYLOV, JACOBIAN_UPDATE_JFNK]:
+                raise DREAMException("Solver: Unrecognized jacobian update strategy: {}.".format(self.jacobianupdate))
+            elif self.maxcontraction <= 0:
+                raise DREAMException("Solver: Invalid value of parameter 'maxcontraction': {}. Expected positive number.".format(self.maxcontraction))
+            elif self.krylovreltol <= 0:
+                raise DREAMException("Solver: Invalid value of parameter 'krylovreltol': {}. Expected positive number.".format(self.krylovreltol))
+            elif type(self.krylovmaxiter) != int or self.krylovmaxiter < 1:
+                raise DREAMException("Solver: Invalid value of parameter 'krylovmaxiter': {}. Expected positive integer.".format(self.krylovmaxiter))
+            elif self.linesearch not in [LINE_SEARCH_NONE, LINE_SEARCH_BACKTRACKING]:
+                raise DREAMException("Solver: Unrecognized line search method: {}.".format(self.linesearch))
+            elif type(self.linesearchmaxsteps) != int or self.linesearchmaxsteps < 1:
+                raise DREAMException("Solver: Invalid value of parameter 'linesearchmaxsteps': {}. Expected positive integer.".format(self.linesearchmaxsteps))
+            elif self.predictor not in [PREDICTOR_NONE, PREDICTOR_LINEAR, PREDICTOR_QUADRATIC]:
+                raise DREAMException("Solver: Unrecognized predictor: {}.".format(self.predictor))
+            elif self.eliminatealgebraic and self.jacobianupdate != JACOBIAN_UPDATE_ALWAYS:
+                raise DREAMException("Solver: Algebraic unknowns can only be eliminated when the jacobian is updated in every iteration.")
+            elif self.eliminatealgebraic and LINEAR_SOLVER_GMRES in [self.linsolv, self.backupsolver]:
+                raise DREAMException("Solver: Algebraic unknowns can not be eliminated when using the GMRES linear solver.")
+            elif self.borderscalars and self.eliminatealgebraic:
+                raise DREAMException("Solver: Bordered systems can not be combined with the elimination of algebraic unknowns.")
+            elif self.borderscalars and self.jacobianupdate != JACOBIAN_UPDATE_ALWAYS:
+                raise DREAMException("Solver: Bordered systems can only be used when the jacobian is updated in every iteration.")
+            elif self.borderscalars and LINEAR_SOLVER_GMRES in [self.linsolv, self.backupsolver]:
+                raise DREAMException("Solver: Bordered systems can not be used with the GMRES linear solver.")
+            elif self.localized and (self.eliminatealgebraic or self.borderscalars):
+                raise DREAMException("Solver: Localized Newton iterations can not be combined with the elimination of algebraic unknowns or bordered systems.")
+            elif self.localized and self.jacobianupdate != JACOBIAN_UPDATE_ALWAYS:
+                raise DREAMException("Solver: Localized Newton iterations can only be used when the jacobian is updated in every iteration.")
+            elif self.localized and (type(self.localized_width) != int or self.localized_width < 0):
+                raise DREAMException("Solver: Invalid value of parameter 'localized_width': {}. Expected non-negative integer.".format(self.localized_width))
+            elif self.localized and (self.localized_maxfraction <= 0 or self.localized_maxfraction > 1):
+                raise DREAMException("Solver: Invalid value of parameter 'localized_maxfraction': {}. Expected 0 < maxfraction <= 1.".format(self.localized_maxfraction))
+            elif self.distributed and self.linsolv not in [LINEAR_SOLVER_MUMPS, LINEAR_SOLVER_GMRES]:
+                raise DREAMException("Solver: Distributed linear systems can only be solved with the MUMPS or GMRES linear solvers.")
+            elif self.distributed and self.jacobianupdate != JACOBIAN_UPDATE_ALWAYS:
+                raise DREAMException("Solver: Distributed linear systems can only be used when the jacobian is updated in every iteration.")
+            elif self.distributed and (self.eliminatealgebraic or self.borderscalars or self.localized):
+                raise DREAMException("Solver: Distributed linear systems can not be combined with the elimination of algebraic unknowns, bordered systems or localized Newton iterations.")
+            elif self.distributed and (self.reducedmodel_basis is not None or self.adjoint_objective is not None):
+                raise DREAMException("Solver: Distributed linear systems can not be combined with the reduced-order model or adjoint sensitivities.")
+            elif self.distributed and self.splitting_scheme != SPLITTING_NONE:
+                raise DREAMException("Solver: Distributed linear systems can not be combined with operator splitting.")
+            elif self.distributed and self.backend != BACKEND_CPU:
+                raise DREAMException("Solver: Distributed linear systems are only supported on the CPU backend.")
+            elif self.eisenstatwalker and (self.eisenstatwalker_etamin <= 0 or self.eisenstatwalker_etamax < self.eisenstatwalker_etamin or self.eisenstatwalker_etamax >= 1):
+                raise DREAMException("Solver: Invalid Eisenstat-Walker tolerances: etamin = {}, etamax = {}. Expected 0 < etamin <= etamax < 1.".format(self.eisenstatwalker_etamin, self.eisenstatwalker_etamax))
+            elif self.pseudotransient and (self.pseudotransient_tau0 <= 0 or self.pseudotransient_taumax < self.pseudotransient_tau0):
+                raise DREAMException("Solver: Invalid pseudo time steps: tau0 = {}, taumax = {}. Expected 0 < tau0 <= taumax.".format(self.pseudotransient_tau0, self.pseudotransient_taumax))
+            elif self.pseudotransient and self.jacobianupdate != JACOBIAN_UPDATE_ALWAYS:
+                raise DREAMException("Solver: Pseudo-transient continuation requires the jacobian to be updated in every iteration.")
+            elif self.splitting_scheme not in [SPLITTING_NONE, SPLITTING_LIE, SPLITTING_STRANG]:
+                raise DREAMException("Solver: Unrecognized splitting scheme: {}.".format(self.splitting_scheme))
+            elif self.splitting_tolerance <= 0:
+                raise DREAMException("Solver: Invalid value of parameter 'splitting_tolerance': {}. Expected positive number.".format(self.splitting_tolerance))
+            elif type(self.splitting_fluidsubsteps) != int or self.splitting_fluidsubsteps < 1:
+                raise DREAMException("Solver: Invalid value of parameter 'splitting_fluidsubsteps': {}. Expected positive integer.".format(self.splitting_fluidsubsteps))
 
             self.tolerance.verifySettings()
             self.verifyLinearSolverSettings()
         else:
             raise DREAMException("Solver: Unrecognized solver type: {}.".format(self.type))
 
+        if self.backend not in [BACKEND_CPU, BACKEND_CUDA, BACKEND_HIP, BACKEND_KOKKOS]:
+            raise DREAMException("Solver: Unrecognized backend: {}.".format(self.backend))
+        elif self.backend != BACKEND_CPU and (self.linsolv not in [LINEAR_SOLVER_LU, LINEAR_SOLVER_GMRES] or self.backupsolver not in [None, BACKUP_SOLVER_NONE, LINEAR_SOLVER_LU, LINEAR_SOLVER_GMRES]):
+            raise DREAMException("Solver: Only the LU and GMRES linear solvers can be used with GPU backends.")
+        elif type(self.nthreads) != int or self.nthreads < 1:
+            raise DREAMException("Solver: Invalid value of parameter 'nthreads': {}. Expected positive integer.".format(self.nthreads))
+        elif type(self.reproducible) != bool:
+            raise DREAMException("Solver: Invalid type of parameter 'reproducible': {}. Expected boolean.".format(type(self.reproducible)))
+        elif type(self.reusesymbolic) != bool:
+            raise DREAMException("Solver: Invalid type of parameter 'reusesymbolic': {}. Expected boolean.".format(type(self.reusesymbolic)))
+        elif type(self.reusefactorization) != bool:
+            raise DREAMException("Solver: Invalid type of parameter 'reusefactorization': {}. Expected boolean.".format(type(self.reusefactorization)))
+        elif self.factorordering not in [FACTOR_ORDERING_DEFAULT, FACTOR_ORDERING_RADIAL, FACTOR_ORDERING_RCM, FACTOR_ORDERING_ND]:
+            raise DREAMException("Solver: Unrecognized factorization ordering: {}.".format(self.factorordering))
+        elif type(self.directassembly) != bool:
+            raise DREAMException("Solver: Invalid type of parameter 'directassembly': {}. Expected boolean.".format(type(self.directassembly)))
+        elif type(self.fusedassembly) != bool:
+            raise DREAMException("Solver: Invalid type of parameter 'fusedassembly': {}. Expected boolean.".format(type(self.fusedassembly)))
+        elif type(self.telemetry) != bool:
+            raise DREAMException("Solver: Invalid type of parameter 'telemetry': {}. Expected boolean.".format(type(self.telemetry)))
+        elif type(self.savejacobianpattern) != bool:
+            raise DREAMException("Solver: Invalid type of parameter 'savejacobianpattern': {}. Expected boolean.".format(type(self.savejacobianpattern)))
+        elif self.warmstart is not None and self.type != NONLINEAR:
+            raise DREAMException("Solver: Warm-starting is only supported by the non-linear solver.")
+        elif self.adjoint_objective is not None:
+            self.verifyAdjointSettings()
+
+        if self.reducedmodel_basis is not None:
+            if self.type != NONLINEAR or self.splitting_scheme != SPLITTING_NONE:
+                raise DREAMException("Solver: The reduced-order model is only supported by the (unsplit) non-linear solver.")
+            elif self.adjoint_objective is not None:
+                raise DREAMException("Solver: Adjoint sensitivities can not be evaluated with the reduced-order model.")
+            elif self.reducedmodel_tolerance <= 0:
+                raise DREAMException("Solver: Invalid reduced-order model tolerance: {}. Must be positive.".format(self.reducedmodel_tolerance))
+
         self.preconditioner.verifySettings()
 
 
+    def verifyAdjointSettings(self):
+        """
+        Verifies the settings for the adjoint sensitivities.
+        """
+        if self.type != NONLINEAR or self.splitting_scheme != SPLITTING_NONE:
+            raise DREAMException("Solver: Adjoint sensitivities are only supported by the (unsplit) non-linear solver.")
+        elif self.jacobianupdate != JACOBIAN_UPDATE_ALWAYS:
+            raise DREAMException("Solver: Adjoint sensitivities require the jacobian to be updated in every iteration.")
+        elif type(self.adjoint_objective) != str or len(self.adjoint_objective) == 0:
+            raise DREAMException("Solver: Invalid adjoint objective: {}. Expected name of unknown quantity.".format(self.adjoint_objective))
+        elif self.adjoint_index < 0:
+            raise DREAMException("Solver: Invalid index of adjoint objective element: {}.".format(self.adjoint_index))
+        elif self.adjoint_data_t.shape != self.adjoint_data_x.shape:
+            raise DREAMException("Solver: The adjoint data times and values must have the same shape.")
+        elif np.any(np.diff(self.adjoint_data_t) <= 0):
+            raise DREAMException("Solver: The adjoint data times must be strictly increasing.")
+
+
     def verifyLinearSolverSettings(self):
         """
         Verifies the settings for the linear solver (which is used
         by both the 'LINEAR_IMPLICIT' and 'NONLINEAR' solvers).
         """
-        solv = [LINEAR_SOLVER_LU, LINEAR_SOLVER_MUMPS, LINEAR_SOLVER_MKL, LINEAR_SOLVER_SUPERLU, LINEAR_SOLVER_GMRES]
+        solv = [LINEAR_SOLVER_LU, LINEAR_SOLVER_MUMPS, LINEAR_SOLVER_MKL, LINEAR_SOLVER_SUPERLU, LINEAR_SOLVER_GMRES, LINEAR_SOLVER_MIXED_PRECISION]
         if self.linsolv not in solv:
             raise DREAMException("Solver: Unrecognized linear solver type: {}.".format(self.linsolv))
         elif self.backupsolver is not None and (self.backupsolver not in solv and self.backupsolver != BACKUP_SOLVER_NONE):
             raise DREAMException("Solver: Unrecognized backup linear solver type: {}.".format(self.backupsolver))
+        elif self.gmres_pc not in [GMRES_PC_BLOCK_JACOBI, GMRES_PC_FIELDSPLIT, GMRES_PC_KINETIC_GRIDS]:
+            raise DREAMException("Solver: Unrecognized GMRES preconditioner: {}.".format(self.gmres_pc))
+        elif self.gmres_kineticpc not in [GMRES_KINETIC_PC_ILU, GMRES_KINETIC_PC_GAMG, GMRES_KINETIC_PC_LU, GMRES_KINETIC_PC_RADIAL_LU, GMRES_KINETIC_PC_MG]:
+            raise DREAMException("Solver: Unrecognized preconditioner for kinetic GMRES splits: {}.".format(self.gmres_kineticpc))
+        elif self.gmres_mglines not in [GMRES_MG_LINES_P, GMRES_MG_LINES_XI, GMRES_MG_LINES_ALTERNATING]:
+            raise DREAMException("Solver: Unrecognized multigrid smoother lines: {}.".format(self.gmres_mglines))
+        elif self.mixedprecision_method not in [MIXED_PRECISION_REFINEMENT_RICHARDSON, MIXED_PRECISION_REFINEMENT_GMRES]:
+            raise DREAMException("Solver: Unrecognized refinement method for the mixed-precision linear solver: {}.".format(self.mixedprecision_method))
+        elif self.mixedprecision_factortol <= 0 or self.mixedprecision_factortol >= 1:
+            raise DREAMException("Solver: Invalid accuracy of the mixed-precision factorization: {}. Expected a value in (0, 1).".format(self.mixedprecision_factortol))
+        elif self.mixedprecision_reltol <= 0:
+            raise DREAMException("Solver: Invalid relative tolerance of the mixed-precision linear solver: {}.".format(self.mixedprecision_reltol))
+        elif type(self.mixedprecision_maxiter) != int or self.mixedprecision_maxiter < 1:
+            raise DREAMException("Solver: Invalid maximum number of refinement iterations: {}. Expected positive integer.".format(self.mixedprecision_maxiter))
 
 
@@ -11,6 +11,10 @@ from . ToleranceSettings import ToleranceSettings
 TYPE_CONSTANT = 1
 TYPE_ADAPTIVE = 2
 TYPE_IONIZATION = 3
+TYPE_EMBEDDED = 4
+
+IONIZATION_CONTROLLER_SCALE = 1
+IONIZATION_CONTROLLER_PI = 2
 
 
 class TimeStepper:
@@ -41,6 +45,16 @@ class TimeStepper:
         self.dtmax = None
         self.automaticstep = None
         self.safetyfactor = None
+        self.controller = IONIZATION_CONTROLLER_SCALE
+        self.smoothing = 0
+        self.timescaleunknowns = []
+        self.bdforder = 1
+        self.eventtimes = np.array([])
+        self.prescribedevents = False
+        self.outputtimes = np.array([])
+        self.pararealcoarsesteps = 0
+        self.pararealmaxiter = 10
+        self.pararealreltol = 1e-6
 
 
     def __contains__(self, item):
@@ -54,6 +68,20 @@ class TimeStepper:
     ######################
     # SETTERS
     ######################
+    def setBDFOrder(self, order):
+        """
+        Sets the maximum order of the variable-order BDF method used
+        to discretize time derivatives (1 = backward Euler, max 5).
+        The order actually used in each time step is limited by the
+        number of previous time steps available and by the ratio of
+        consecutive time steps.
+        """
+        if order < 1 or order > 5:
+            raise DREAMException("TimeStepper: Invalid value assigned to 'bdforder': {}. Must be between 1 and 5.".format(order))
+
+        self.bdforder = int(order)
+
+
     def setCheckInterval(self, checkevery):
         if checkevery < 0:
             raise DREAMException("TimeStepper: Invalid value assigned to 'checkevery': {}".format(checkevery))
@@ -78,6 +106,27 @@ class TimeStepper:
         self.dt = float(dt)
 
 
+    def setEvents(self, times=None, prescribed=False):
+        """
+        Sets the times which time steps should land exactly on. Any time
+        step which would straddle one of these times is shortened to end
+        on it (the constant time stepper instead inserts the events as
+        additional time steps).
+
+        :param list times:       Explicit list of event times.
+        :param bool prescribed:  If ``True``, also use the times at which the time-dependent prescribed data is not smooth as events.
+        """
+        if times is None:
+            times = []
+
+        times = np.asarray(times, dtype=float).flatten()
+        if np.any(times < 0):
+            raise DREAMException("TimeStepper: Event times must be non-negative.")
+
+        self.eventtimes = times
+        self.prescribedevents = bool(prescribed)
+
+
     def setNt(self, nt):
         if nt is None:
             self.nt = None
@@ -99,6 +148,55 @@ class TimeStepper:
         self.nSaveSteps = nSaveSteps
 
 
+    def setOutputTimes(self, times=None):
+        """
+        Sets the times at which to output the solution. Instead of saving
+        every time step, the solution in the given times is obtained by
+        linearly interpolating between the time steps surrounding them,
+        so that the size of the output does not depend on the number of
+        time steps taken (which is useful with the adaptive time
+        steppers). The initial state is always saved; include ``tmax``
+        in the list to also save the final state.
+
+        :param list times: List of output times (``None`` or empty = save every time step).
+        """
+        if times is None:
+            times = []
+
+        times = np.asarray(times, dtype=float).flatten()
+        if np.any(times < 0):
+            raise DREAMException("TimeStepper: Output times must be non-negative.")
+
+        self.outputtimes = np.unique(times)
+
+
+    def setParareal(self, coarsesteps=10, maxiter=10, reltol=1e-6):
+        """
+        Solve the simulation in parallel in time with the parareal method,
+        when run on several MPI processes. The simulation time is divided
+        into one time window per process, and the states at the start of
+        the windows are found iteratively, with a coarse propagator taking
+        ``coarsesteps`` time steps per window. Every process writes the
+        output of its own time window to a separate file (see
+        ``DREAM.Parareal.mergeWindows()``). Requires the constant time
+        stepper.
+
+        :param int coarsesteps: Number of time steps per time window taken by the coarse propagator (0 = disable parareal).
+        :param int maxiter:     Maximum number of parareal iterations.
+        :param float reltol:    Relative tolerance on the change of the time window states.
+        """
+        if coarsesteps < 0:
+            raise DREAMException("TimeStepper: Invalid number of parareal coarse steps: {}.".format(coarsesteps))
+        elif maxiter < 1:
+            raise DREAMException("TimeStepper: Invalid maximum number of parareal iterations: {}.".format(maxiter))
+        elif reltol <= 0:
+            raise DREAMException("TimeStepper: The parareal tolerance must be positive.")
+
+        self.pararealcoarsesteps = int(coarsesteps)
+        self.pararealmaxiter = int(maxiter)
+        self.pararealreltol = float(reltol)
+
+
     def setRelTol(self, reltol): self.setRelativeTolerance(reltol=reltol)
 
 
@@ -121,10 +219,10 @@ class TimeStepper:
 
 
     def setType(self, ttype, *args, **kwargs):
-        if ttype not in [TYPE_CONSTANT, TYPE_ADAPTIVE, TYPE_IONIZATION]:
+        if ttype not in [TYPE_CONSTANT, TYPE_ADAPTIVE, TYPE_IONIZATION, TYPE_EMBEDDED]:
             raise DREAMException("TimeStepper: Unrecognized time stepper type specified: {}".format(ttype))
 
-        if ttype in [TYPE_ADAPTIVE, TYPE_IONIZATION]:
+        if ttype in [TYPE_ADAPTIVE, TYPE_IONIZATION, TYPE_EMBEDDED]:
             self.nt = None
 
         self.type = int(ttype)
@@ -133,15 +231,36 @@ class TimeStepper:
             self.setIonization(*args, **kwargs)
     
 
-    def setIonization(self, dt0=0, dtmax=0, tmax=None, automaticstep=1e-12, safetyfactor=50):
+    def setEmbedded(self, dt0, dtmax=0, tmax=None):
+        """
+        Select and set parameters for the adaptive time stepper
+        which estimates the error from a single time step.
+        """
+        self.type = TYPE_EMBEDDED
+        self.nt = None
+        self.dt = dt0
+        self.dtmax = dtmax
+
+        if tmax is not None:
+            self.tmax = tmax
+
+
+    def setIonization(self, dt0=0, dtmax=0, tmax=None, automaticstep=1e-12, safetyfactor=50, unknowns=None, controller=IONIZATION_CONTROLLER_SCALE, smoothing=0):
         """
         Select and set parameters for the ionization time stepper.
+
+        :param list unknowns:    Names of additional unknowns (besides ``n_cold``) whose time scales limit the time step (e.g. ``['T_cold', 'E_field', 'n_re']``).
+        :param int controller:   Either ``IONIZATION_CONTROLLER_SCALE`` (time step proportional to the time scale) or ``IONIZATION_CONTROLLER_PI`` (PI controller limited by the time scale).
+        :param float smoothing:  Weight (between 0 and 1) of the previous rates of change when smoothing the estimated rates (0 = no smoothing).
         """
         self.type = TYPE_IONIZATION
         self.dt = dt0
         self.dtmax = dtmax
         self.automaticstep = automaticstep
         self.safetyfactor = safetyfactor
+        self.timescaleunknowns = list(unknowns) if unknowns is not None else []
+        self.controller = int(controller)
+        self.smoothing = float(smoothing)
 
         if tmax is not None:
             self.tmax = tmax
@@ -166,14 +285,24 @@ class TimeStepper:
         if type(self.tmax) == np.ndarray: self.tmax = float(self.tmax.flatten()[0])
 
         if 'automaticstep' in data: self.automaticstep = float(scal(data['automaticstep']))
+        if 'bdforder' in data: self.bdforder = int(scal(data['bdforder']))
         if 'checkevery' in data: self.checkevery = int(scal(data['checkevery']))
         if 'constantstep' in data: self.constantstep = bool(scal(data['constantstep']))
+        if 'controller' in data: self.controller = int(scal(data['controller']))
         if 'dt' in data: self.dt = float(scal(data['dt']))
         if 'dtmax' in data: self.dtmax = float(scal(data['dtmax']))
+        if 'eventtimes' in data: self.eventtimes = np.asarray(data['eventtimes'], dtype=float).flatten()
         if 'nt' in data: self.nt = int(scal(data['nt']))
         if 'nsavesteps' in data: self.nSaveSteps = int(scal(data['nsavesteps']))
+        if 'outputtimes' in data: self.outputtimes = np.asarray(data['outputtimes'], dtype=float).flatten()
+        if 'pararealcoarsesteps' in data: self.pararealcoarsesteps = int(scal(data['pararealcoarsesteps']))
+        if 'pararealmaxiter' in data: self.pararealmaxiter = int(scal(data['pararealmaxiter']))
+        if 'pararealreltol' in data: self.pararealreltol = float(scal(data['pararealreltol']))
+        if 'prescribedevents' in data: self.prescribedevents = bool(scal(data['prescribedevents']))
         if 'verbose' in data: self.verbose = bool(scal(data['verbose']))
         if 'safetyfactor' in data: self.safetyfactor = float(scal(data['safetyfactor']))
+        if 'smoothing' in data: self.smoothing = float(scal(data['smoothing']))
+        if 'timescaleunknowns' in data: self.timescaleunknowns = [n for n in data['timescaleunknowns'].split(';') if n != '']
         if 'tolerance' in data: self.tolerance.fromdict(data['tolerance'])
         
         self.verifySettings()
@@ -193,19 +322,34 @@ class TimeStepper:
         }
 
         if self.dt is not None: data['dt'] = self.dt
+        if self.bdforder != 1: data['bdforder'] = self.bdforder
+        if self.eventtimes.size > 0: data['eventtimes'] = self.eventtimes
+        if self.prescribedevents: data['prescribedevents'] = self.prescribedevents
+        if self.outputtimes.size > 0: data['outputtimes'] = self.outputtimes
 
         if self.type == TYPE_CONSTANT:
             if self.nt is not None: data['nt'] = self.nt
             data['nsavesteps'] = int(self.nSaveSteps)
+            if self.pararealcoarsesteps > 0:
+                data['pararealcoarsesteps'] = self.pararealcoarsesteps
+                data['pararealmaxiter'] = self.pararealmaxiter
+                data['pararealreltol'] = self.pararealreltol
         elif self.type == TYPE_ADAPTIVE:
             data['checkevery'] = self.checkevery
             data['constantstep'] = self.constantstep
             data['tolerance'] = self.tolerance.todict()
             data['verbose'] = self.verbose
+        elif self.type == TYPE_EMBEDDED:
+            if self.dtmax is not None: data['dtmax'] = self.dtmax
+            data['tolerance'] = self.tolerance.todict()
+            data['verbose'] = self.verbose
         elif self.type == TYPE_IONIZATION:
             if self.dtmax is not None: data['dtmax'] = self.dtmax
             data['automaticstep'] = self.automaticstep
             data['safetyfactor'] = self.safetyfactor
+            data['controller'] = self.controller
+            data['smoothing'] = self.smoothing
+            data['timescaleunknowns'] = ';'.join(self.timescaleunknowns)
 
         return data
 
@@ -214,6 +358,9 @@ class TimeStepper:
         """
         Verify that the TimeStepper settings are consistent.
         """
+        if type(self.bdforder) != int or self.bdforder < 1 or self.bdforder > 5:
+            raise DREAMException("TimeStepper: 'bdforder' must be an integer between 1 and 5.")
+
         if self.type == TYPE_CONSTANT:
             if self.tmax is None or self.tmax <= 0:
                 raise DREAMException("TimeStepper constant: 'tmax' must be set to a value > 0.")
@@ -228,6 +375,13 @@ class TimeStepper:
 
             if self.nSaveSteps < 0 or (ntSet and self.nSaveSteps > self.nt):
                 raise DREAMException("TimeStepper constant: Invalid value assigned to 'nSaveSteps'. Must between 0 and nt.")
+
+            if self.pararealcoarsesteps > 0 and (self.eventtimes.size > 0 or self.prescribedevents):
+                raise DREAMException("TimeStepper constant: The parareal method can not be combined with time step events.")
+            elif self.pararealcoarsesteps > 0 and self.outputtimes.size > 0:
+                raise DREAMException("TimeStepper constant: The parareal method can not be combined with a fixed output time grid.")
+            elif self.nSaveSteps > 0 and self.outputtimes.size > 0:
+                raise DREAMException("TimeStepper constant: 'nSaveSteps' may not be set together with the output times.")
         elif self.type == TYPE_ADAPTIVE:
             if self.tmax is None or self.tmax <= 0:
                 raise DREAMException("TimeStepper adaptive: 'tmax' must be set to a value > 0.")
@@ -241,6 +395,18 @@ class TimeStepper:
             elif type(self.constantstep) != bool:
                 raise DREAMException("TimeStepper adaptive: 'constantstep' must be a boolean.")
             self.tolerance.verifySettings()
+        elif self.type == TYPE_EMBEDDED:
+            if self.tmax is None or self.tmax <= 0:
+                raise DREAMException("TimeStepper embedded: 'tmax' must be set to a value > 0.")
+            elif self.nt is not None:
+                raise DREAMException("TimeStepper embedded: 'nt' cannot be used with the embedded time stepper.")
+            elif self.dt is None or self.dt <= 0:
+                raise DREAMException("TimeStepper embedded: 'dt' must be set to a value > 0.")
+            elif self.dtmax is not None and self.dtmax < 0:
+                raise DREAMException("TimeStepper embedded: 'dtmax' must be non-negative.")
+            elif type(self.verbose) != bool:
+                raise DREAMException("TimeStepper embedded: 'verbose' must be a boolean.")
+            self.tolerance.verifySettings()
         elif self.type == TYPE_IONIZATION:
             if self.tmax is None or self.tmax <= 0:
                 raise DREAMException("TimeStepper ionization: 'tmax' must be set to a value > 0.")
@@ -248,6 +414,10 @@ class TimeStepper:
                 raise DREAMException("TimeStepper ionization: 'dt' must be set to a non-negative value.")
             elif self.dtmax is None or self.dtmax < 0:
                 raise DREAMException("TimeStepper ionization: 'dtmax' must be set to a non-negative value.")
+            elif self.controller not in [IONIZATION_CONTROLLER_SCALE, IONIZATION_CONTROLLER_PI]:
+                raise DREAMException("TimeStepper ionization: Unrecognized controller: {}.".format(self.controller))
+            elif self.smoothing < 0 or self.smoothing >= 1:
+                raise DREAMException("TimeStepper ionization: 'smoothing' must be in the interval [0, 1).")
         else:
             raise DREAMException("Unrecognized time stepper type selected: {}.".format(self.type))
 
@@ -5,6 +5,10 @@ from .. DREAMException import DREAMException
 from . import EquationSystem
 
 
+NORM_2NORM = 1
+NORM_WRMS = 2
+
+
 class ToleranceSettings:
     
     def __init__(self):
@@ -15,6 +19,7 @@ class ToleranceSettings:
         # unknowns without explicit tolerances)
         self.reltol = 1e-6
         self.overrides = []
+        self.norm = NORM_2NORM
 
 
     def disable(self, unknown=None):
@@ -56,6 +61,11 @@ class ToleranceSettings:
             if type(r) == float: self.reltol = r
             else: self.reltol = float(r[0])
 
+        if 'norm' in data:
+            n = data['norm']
+            if type(n) == np.ndarray: self.norm = int(n.flatten()[0])
+            else: self.norm = int(n)
+
         overrides = []
 
         if 'names' in data:
@@ -125,11 +135,27 @@ class ToleranceSettings:
             raise DREAMException("ToleranceSettings.set(): Unrecognized type of parameter 'unknown': {}.".format(type(unknown)))
 
 
+    def setNorm(self, norm):
+        """
+        Set the norm used to compare the step of each unknown quantity to
+        its tolerances: either the 2-norm (``NORM_2NORM``), requiring
+        ``|dx| <= abstol + reltol*|x|``, or the weighted RMS norm
+        (``NORM_WRMS``), requiring the RMS value of ``dx_i/(abstol + reltol*|x_i|)``
+        to be at most one.
+
+        :param int norm: Norm to use.
+        """
+        if norm not in [NORM_2NORM, NORM_WRMS]:
+            raise DREAMException("ToleranceSettings.setNorm(): Unrecognized norm: {}.".format(norm))
+
+        self.norm = int(norm)
+
+
     def todict(self):
         """
         Convert this object to a dict.
         """
-        data = {'reltol': self.reltol}
+        data = {'reltol': self.reltol, 'norm': self.norm}
 
         if len(self.overrides) > 0:
             data['names'] = ''
@@ -149,6 +175,8 @@ class ToleranceSettings:
         """
         if type(self.reltol) is not float:
             raise DREAMException("Invalid type of general relative tolerance: {}. Expected float.".format(type(self.reltol)))
+        elif self.norm not in [NORM_2NORM, NORM_WRMS]:
+            raise DREAMException("Unrecognized norm: {}.".format(self.norm))
 
 
         for i in range(len(self.overrides)):
@@ -11,6 +11,7 @@ TYPE_UNIFORM_THETA = 3
 TYPE_BIUNIFORM_THETA = 4
 TYPE_CUSTOM = 5
 TYPE_TRAPPED = 6
+TYPE_GAUSS_LEGENDRE_NODES = 7
 
 
 class XiGrid:
@@ -131,7 +132,7 @@ class XiGrid:
         """
         Set the type of xi grid generator.
         """
-        if ttype in [TYPE_UNIFORM,TYPE_BIUNIFORM,TYPE_UNIFORM_THETA,TYPE_BIUNIFORM_THETA,TYPE_CUSTOM,TYPE_TRAPPED]:
+        if ttype in [TYPE_UNIFORM,TYPE_BIUNIFORM,TYPE_UNIFORM_THETA,TYPE_BIUNIFORM_THETA,TYPE_CUSTOM,TYPE_TRAPPED,TYPE_GAUSS_LEGENDRE_NODES]:
             self.type = ttype
         else:
             raise DREAMException("XiGrid {}: Unrecognized grid type specified: {}.".format(self.name, ttype))
@@ -216,7 +217,7 @@ class XiGrid:
         if not self.parent.enabled:
             return
 
-        if self.type in [TYPE_UNIFORM,TYPE_BIUNIFORM,TYPE_UNIFORM_THETA,TYPE_BIUNIFORM_THETA,TYPE_CUSTOM]:
+        if self.type in [TYPE_UNIFORM,TYPE_BIUNIFORM,TYPE_UNIFORM_THETA,TYPE_BIUNIFORM_THETA,TYPE_CUSTOM,TYPE_GAUSS_LEGENDRE_NODES]:
             if self.nxi is None or self.nxi <= 0:
                 raise DREAMException("XiGrid {}: Invalid value assigned to 'nxi': {}. Must be > 0.".format(self.name, self.nxi))
         elif self.type in [TYPE_TRAPPED]:
@@ -0,0 +1,111 @@
+# In-process interface to DREAM (via the 'libdreampy' extension module)
+
+from . DREAMException import DREAMException
+from . DREAMOutput import DREAMOutput
+from . DREAMSettings import DREAMSettings
+
+
+def _loadlib():
+    """
+    Import the 'libdreampy' extension module (which is only
+    available if it has been built and is on the Python path).
+    """
+    try:
+        import libdreampy
+        return libdreampy
+    except ImportError:
+        raise DREAMException("Unable to import 'libdreampy'. Make sure that DREAM was built with the Python interface and that 'build/pyface' is on the Python path.")
+
+
+class DREAMSimulation:
+    
+    def __init__(self, settings):
+        """
+        Construct a DREAM simulation in this process.
+
+        settings: 'DREAMSettings' object or settings dictionary.
+        """
+        self.lib = _loadlib()
+
+        if isinstance(settings, DREAMSettings):
+            settings = settings.todict()
+
+        self.sim = self.lib.simulation(settings)
+
+
+    def __getitem__(self, name):
+        return self.getUnknown(name)
+
+
+    def getUnknown(self, name):
+        """
+        Returns the most recent data of the named unknown quantity.
+        The returned (read-only) NumPy array shares memory with the
+        simulation and is therefore updated as the simulation advances
+        (use 'copy()' to keep the data of a particular time step).
+        """
+        return self.lib.get_unknown(self.sim, name)
+
+
+    def getPrescribed(self, name):
+        """
+        Returns the value of the named prescribed quantity as a
+        writeable NumPy array sharing memory with the simulation.
+        Values assigned to the array (e.g. ``arr[:] = ...``) between
+        time steps replace the prescribed time evolution of the
+        quantity in all subsequent time steps.
+        """
+        return self.lib.get_prescribed(self.sim, name)
+
+
+    def getTime(self):
+        """
+        Returns the current simulation time.
+        """
+        return self.lib.time(self.sim)
+
+
+    def getUnknownNames(self):
+        """
+        Returns a list with the names of all unknown quantities.
+        """
+        return self.lib.unknowns(self.sim)
+
+
+    def save(self):
+        """
+        Save the output of the simulation to the file specified
+        by the settings.
+        """
+        self.lib.save(self.sim)
+
+
+    def getOutput(self, loadsettings=True):
+        """
+        Returns the output of the simulation as a ``DREAMOutput``
+        object. The output is generated in memory and handed over
+        directly, without writing (or reading) any file.
+        """
+        do = DREAMOutput()
+        do.loadDict(self.lib.output(self.sim), loadsettings=loadsettings)
+        return do
+
+
+    def solve(self):
+        """
+        Take all remaining time steps.
+        """
+        self.lib.solve(self.sim)
+
+
+    def step(self, t=None):
+        """
+        Take a single time step or, if ``t`` is given, advance the
+        simulation to the time ``t`` (i.e. to the first time step
+        on or after ``t``). Returns 'False' when the simulation has
+        reached its final time.
+        """
+        if t is None:
+            return self.lib.step(self.sim)
+        else:
+            return self.lib.step(self.sim, float(t))
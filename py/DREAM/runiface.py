@@ -4,6 +4,7 @@ import os
 import pathlib
 import subprocess
 import tempfile
+from concurrent.futures import ThreadPoolExecutor, as_completed
 
 from . DREAMException import DREAMException
 from . DREAMOutput import DREAMOutput
@@ -88,5 +89,136 @@ def runiface(settings, outfile=None, quiet=False):
     else:
         return obj
 
+def runiface_batch(settings, outfiles=None, quiet=False):
+    """
+    Run several simulations in a single 'dreami' process (batch mode),
+    so that the atomic databases are only loaded once.
+
+    settings: List of 'DREAMSettings' objects or names of files
+              containing settings.
+    outfiles: List of names of files to write output to (one per
+              simulation). If 'None', the output is only returned.
+
+    Returns a list containing one 'DREAMOutput' object per simulation
+    (or 'None' for simulations which did not produce any output).
+    """
+    global DREAMPATH
+
+    if outfiles is None:
+        outfiles = [None]*len(settings)
+    elif len(outfiles) != len(settings):
+        raise DREAMException("runiface_batch: 'outfiles' must have the same number of elements as 'settings'.")
+
+    infiles, outputs, deleteFiles = [], [], []
+    for s, o in zip(settings, outfiles):
+        if isinstance(s, DREAMSettings):
+            if o is None:
+                o = next(tempfile._get_candidate_names())+'.h5'
+                deleteFiles.append(o)
+
+            infile = next(tempfile._get_candidate_names())+'.h5'
+            s.output.setFilename(o)
+            s.save(infile)
+            deleteFiles.append(infile)
+        else:
+            infile = s
+            if o is not None:
+                raise DREAMException("runiface_batch: The output file name cannot be overridden for settings given as file names.")
+
+        infiles.append(infile)
+        outputs.append(o)
+
+    batchfile = next(tempfile._get_candidate_names())+'.txt'
+    with open(batchfile, 'w') as f:
+        f.write('\n'.join(infiles)+'\n')
+
+    errorOnExit = 0
+    p = None
+    stderr_data = None
+    objs = []
+    try:
+        cmd = ['{}/build/iface/dreami'.format(DREAMPATH), '-b', batchfile]
+        if quiet:
+            p = subprocess.Popen(cmd, stderr=subprocess.PIPE, stdout=subprocess.PIPE)
+        else:
+            p = subprocess.Popen(cmd, stderr=subprocess.PIPE)
+
+        stderr_data = p.communicate()[1].decode('utf-8')
+
+        if p.returncode != 0:
+            errorOnExit = 1
+
+        for o in outputs:
+            if o is not None and os.path.isfile(o):
+                objs.append(DREAMOutput(o))
+            else:
+                objs.append(None)
+    except KeyboardInterrupt:
+        errorOnExit = 2
+    finally:
+        os.remove(batchfile)
+        for f in deleteFiles:
+            if os.path.isfile(f):
+                os.remove(f)
+
+    if errorOnExit == 1:
+        print(stderr_data)
+        print("WARNING: At least one DREAMi simulation exited with a non-zero exit code: {}".format(p.returncode))
+    elif errorOnExit == 2:
+        raise DREAMException("DREAMi simulation was cancelled by the user.")
+
+    return objs
+
+
+def runiface_parallel(settings, outfiles=None, quiet=False, nprocesses=None, callback=None):
+    """
+    Run several simulations in 'nprocesses' concurrent 'dreami'
+    processes. The simulations are distributed evenly over the
+    processes, and each process runs its share in batch mode (see
+    'runiface_batch()'), so that the atomic databases are only loaded
+    once per process.
+
+    settings:   List of 'DREAMSettings' objects or names of files
+                containing settings.
+    outfiles:   List of names of files to write output to (one per
+                simulation). If 'None', the output is only returned.
+    nprocesses: Number of 'dreami' processes to run concurrently
+                (default: number of CPUs).
+    callback:   Function 'callback(index, output)' called for every
+                simulation (in the order in which the processes finish).
+
+    Returns a list containing one 'DREAMOutput' object per simulation
+    (or 'None' for simulations which did not produce any output).
+    """
+    n = len(settings)
+    if outfiles is None:
+        outfiles = [None]*n
+    elif len(outfiles) != n:
+        raise DREAMException("runiface_parallel: 'outfiles' must have the same number of elements as 'settings'.")
+
+    if nprocesses is None:
+        nprocesses = os.cpu_count() or 1
+    nprocesses = max(1, min(int(nprocesses), n))
+
+    objs = [None]*n
+    if n == 0:
+        return objs
+
+    chunks = [list(range(i, n, nprocesses)) for i in range(nprocesses)]
+    with ThreadPoolExecutor(max_workers=nprocesses) as ex:
+        futures = {}
+        for c in chunks:
+            f = ex.submit(runiface_batch, [settings[i] for i in c], [outfiles[i] for i in c], quiet)
+            futures[f] = c
+
+        for f in as_completed(futures):
+            for i, o in zip(futures[f], f.result()):
+                objs[i] = o
+                if callback is not None:
+                    callback(i, o)
+
+    return objs
+
+
 locatedream()
 
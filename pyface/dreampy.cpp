@@ -1,21 +1,58 @@
 /**
  * Python interface to DREAM.
+ *
+ * Simulations are constructed in-process from a settings dictionary
+ * (as returned by 'DREAMSettings.todict()') and are returned to Python
+ * as opaque capsule objects. The data of unknown quantities can then be
+ * accessed as NumPy arrays which share memory with the simulation, and
+ * prescribed quantities can be updated in place between time steps.
  */
 
 #ifndef PY_SSIZE_T_CLEAN
 #   define PY_SSIZE_T_CLEAN
 #endif
 #include <Python.h>
+#include "pyface/numpy.h"
+#include <cstring>
 #include <iostream>
+#include <map>
+#include <string>
+#include <softlib/SOFTLibException.h>
 #include "DREAM/Init.h"
+#include "DREAM/MemorySFile.hpp"
+#include "DREAM/QuitException.hpp"
+#include "DREAM/ResultCache.hpp"
 #include "DREAM/Settings/Settings.hpp"
 #include "DREAM/Settings/SimulationGenerator.hpp"
+#include "DREAM/Simulation.hpp"
 #include "pyface/dreampy.hpp"
 #include "pyface/settings.hpp"
 
 
+#define DREAMPY_CAPSULE_NAME "libdreampy.Simulation"
+
+/**
+ * Simulation object (and its state) wrapped in a
+ * Python capsule.
+ */
+struct dreampy_simulation {
+    // The settings are needed when saving the output,
+    // and are deleted together with the simulation
+    DREAM::Settings *settings=nullptr;
+    DREAM::Simulation *sim=nullptr;
+};
+
 static PyMethodDef dreampyMethods[] = {
     {"run", dreampy_run, METH_VARARGS, "Run DREAM."},
+    {"simulation", dreampy_simulation_new, METH_VARARGS, "Construct a DREAM simulation from a settings dictionary."},
+    {"step", dreampy_simulation_step, METH_VARARGS, "Take a single time step with the given simulation (or, if a target time is given, advance the simulation to that time). Returns False when the simulation is finished."},
+    {"solve", dreampy_simulation_solve, METH_VARARGS, "Take all remaining time steps with the given simulation."},
+    {"save", dreampy_simulation_save, METH_VARARGS, "Save the output of the given simulation."},
+    {"output", dreampy_simulation_output, METH_VARARGS, "Returns the output of the given simulation as a dictionary (in the same format as the output file), without writing it to disk."},
+    {"time", dreampy_simulation_time, METH_VARARGS, "Returns the current time of the given simulation."},
+    {"unknowns", dreampy_simulation_unknowns, METH_VARARGS, "Returns a list with the names of all unknown quantities of the given simulation."},
+    {"get_unknown", dreampy_simulation_get_unknown, METH_VARARGS, "Returns the most recent data of the named unknown quantity, as a read-only NumPy array sharing memory with the simulation."},
+    {"get_prescribed", dreampy_simulation_get_prescribed, METH_VARARGS, "Returns the value of the named prescribed quantity, as a writeable NumPy array which replaces the prescribed time evolution of the quantity."},
     {NULL, NULL, 0, NULL}
 };
 
@@ -36,55 +73,472 @@ static struct PyModuleDef dreampyModule = {
  * Module initialization.
  */
 PyMODINIT_FUNC PyInit_libdreampy() {
+    // Initialize the DREAM kernel (PETSc can only be
+    // initialized once per process)
+    dream_initialize();
+    Py_AtExit(dream_finalize);
+
     return PyModule_Create(&dreampyModule);
 }
 
+/**
+ * Translate a C++ exception raised while running DREAM into
+ * a Python exception.
+ */
+#define DREAMPY_CATCH(retval) \
+    catch (DREAM::QuitException& ex) { \
+        PyErr_SetString(PyExc_KeyboardInterrupt, ex.what()); \
+        return retval; \
+    } catch (DREAM::FVM::FVMException& ex) { \
+        PyErr_SetString(PyExc_RuntimeError, ex.what()); \
+        return retval; \
+    } catch (SOFTLibException& ex) { \
+        PyErr_SetString(PyExc_RuntimeError, ex.what()); \
+        return retval; \
+    }
+
+/**
+ * Destructor of simulation capsules.
+ */
+static void dreampy_simulation_free(PyObject *capsule) {
+    struct dreampy_simulation *ds = reinterpret_cast<struct dreampy_simulation*>(
+        PyCapsule_GetPointer(capsule, DREAMPY_CAPSULE_NAME)
+    );
+
+    if (ds != nullptr) {
+        delete ds->sim;
+        delete ds->settings;
+        delete ds;
+    }
+}
+
+/**
+ * Returns the simulation wrapped by the first argument
+ * in 'args' (or 'nullptr' on error).
+ */
+static struct dreampy_simulation *dreampy_get_simulation(PyObject *args) {
+    PyObject *capsule;
+    if (!PyArg_ParseTuple(args, "O", &capsule))
+        return nullptr;
+
+    return reinterpret_cast<struct dreampy_simulation*>(
+        PyCapsule_GetPointer(capsule, DREAMPY_CAPSULE_NAME)
+    );
+}
+
 /**
  * Run a DREAM simulation. This function takes a Python
- * dictionary with the simulation settings as input.
+ * dictionary with the simulation settings as input, and
+ * saves the output to the file specified in the settings. If a
+ * result cache is enabled ('output/resultcache') and contains the
+ * output of a simulation with identical settings, that output is
+ * copied to the output file instead.
  */
 extern "C" {
-static PyObject *dreampy_run(PyObject* /*self*/, PyObject *args) {
-    bool success = true;
-
+static PyObject *dreampy_run(PyObject *self, PyObject *args) {
     PyObject *dict;
     if (!PyArg_ParseTuple(args, "O", &dict))
         return NULL;
 
-    // Initialize the DREAM kernel
-    dream_initialize();
-
+    DREAM::ResultCache *cache = nullptr;
+    std::string outfile;
     try {
-        DREAM::Settings *settings = dreampy_loadsettings(dict);
-        //DREAM::Simulation *sim = DREAM::SimulationGenerator::ProcessSettings(settings);
-        //sim->Run();
+        DREAM::Settings *s = dreampy_loadsettings(dict);
+        const std::string dir = s->GetString("output/resultcache");
+        outfile = s->GetString("output/filename");
+        if (!dir.empty())
+            cache = new DREAM::ResultCache(dir, s);
+        delete s;
+    } DREAMPY_CATCH(NULL)
 
-        // TODO save output
+    if (cache != nullptr && cache->Restore(outfile)) {
+        delete cache;
+        Py_RETURN_NONE;
+    }
+
+    // The simulation is deleted together with the capsule
+    PyObject *capsule = dreampy_simulation_new(self, args);
+    if (capsule == NULL) {
+        delete cache;
+        return NULL;
+    }
+
+    PyObject *targs = PyTuple_Pack(1, capsule);
+    PyObject *r = dreampy_simulation_solve(self, targs);
+    if (r != NULL) {
+        Py_DECREF(r);
+        r = dreampy_simulation_save(self, targs);
+    }
+
+    // Failing to store the output in the cache is not an error
+    if (r != NULL && cache != nullptr)
+        cache->Store(outfile);
+    delete cache;
+
+    Py_DECREF(targs);
+    Py_DECREF(capsule);
+
+    return r;
+}
+
+/**
+ * Construct a new DREAM simulation from the given settings
+ * dictionary. The simulation is returned as a capsule which
+ * should be passed to the other functions of this module.
+ */
+static PyObject *dreampy_simulation_new(PyObject* /*self*/, PyObject *args) {
+    PyObject *dict;
+    if (!PyArg_ParseTuple(args, "O", &dict))
+        return NULL;
+
+    struct dreampy_simulation *ds = new struct dreampy_simulation;
+    try {
+        ds->settings = dreampy_loadsettings(dict);
+        ds->sim = DREAM::SimulationGenerator::ProcessSettings(ds->settings);
     } catch (DREAM::FVM::FVMException& ex) {
+        delete ds->settings;
+        delete ds;
+        PyErr_SetString(PyExc_RuntimeError, ex.what());
+        return NULL;
+    } catch (SOFTLibException& ex) {
+        delete ds->settings;
+        delete ds;
         PyErr_SetString(PyExc_RuntimeError, ex.what());
-        success = false;
+        return NULL;
     }
 
-    // De-initialize the DREAM kernel
-    dream_finalize();
+    return PyCapsule_New(ds, DREAMPY_CAPSULE_NAME, dreampy_simulation_free);
+}
 
-    /*printf("Step 1\n");
-    PyObject *keys = PyDict_Keys(dict);
-    Py_ssize_t len = PyList_Size(keys);
+/**
+ * Take a single time step or, if a target time is given as
+ * the second argument, advance the simulation to that time.
+ * Returns 'False' once the simulation has reached its final time.
+ */
+static PyObject *dreampy_simulation_step(PyObject* /*self*/, PyObject *args) {
+    PyObject *capsule;
+    PyObject *target = Py_None;
+    if (!PyArg_ParseTuple(args, "O|O", &capsule, &target))
+        return NULL;
 
-    printf("Keys:\n");
-    for (Py_ssize_t i = 0; i < len; i++) {
-        PyObject *obj = PyList_GetItem(keys, i);
-        Py_ssize_t slen;
-        const char *s = PyUnicode_AsUTF8AndSize(obj, &slen);
+    struct dreampy_simulation *ds = reinterpret_cast<struct dreampy_simulation*>(
+        PyCapsule_GetPointer(capsule, DREAMPY_CAPSULE_NAME)
+    );
+    if (ds == nullptr)
+        return NULL;
 
-        std::cout << "  " << s << std::endl;
-    }*/
+    real_t tTarget = 0;
+    if (target != Py_None) {
+        tTarget = PyFloat_AsDouble(target);
+        if (PyErr_Occurred())
+            return NULL;
+    }
 
-    if (success)
-        Py_RETURN_NONE;
+    bool running;
+    try {
+        if (target == Py_None)
+            running = ds->sim->Step();
+        else
+            running = ds->sim->Step(tTarget);
+    } DREAMPY_CATCH(NULL)
+
+    if (running)
+        Py_RETURN_TRUE;
     else
+        Py_RETURN_FALSE;
+}
+
+/**
+ * Take all remaining time steps.
+ */
+static PyObject *dreampy_simulation_solve(PyObject *self, PyObject *args) {
+    struct dreampy_simulation *ds = dreampy_get_simulation(args);
+    if (ds == nullptr)
+        return NULL;
+
+    while (!ds->sim->IsFinished()) {
+        PyObject *r = dreampy_simulation_step(self, args);
+        if (r == NULL)
+            return NULL;
+
+        Py_DECREF(r);
+    }
+
+    Py_RETURN_NONE;
+}
+
+/**
+ * Save the output of the simulation to the file
+ * specified in its settings.
+ */
+static PyObject *dreampy_simulation_save(PyObject* /*self*/, PyObject *args) {
+    struct dreampy_simulation *ds = dreampy_get_simulation(args);
+    if (ds == nullptr)
+        return NULL;
+
+    try {
+        ds->sim->Save();
+    } DREAMPY_CATCH(NULL)
+
+    Py_RETURN_NONE;
+}
+
+/**
+ * Returns the dictionary in 'root' corresponding to the group
+ * 'path' (which is created, together with any missing parent
+ * groups, if it does not exist). 'groups' maps the paths of all
+ * previously created groups to their dictionaries.
+ */
+static PyObject *dreampy_output_group(
+    std::map<std::string, PyObject*>& groups, const std::string& path
+) {
+    auto it = groups.find(path);
+    if (it != groups.end())
+        return it->second;
+
+    std::string parent, key = path;
+    size_t p = path.rfind('/');
+    if (p != std::string::npos) {
+        parent = path.substr(0, p);
+        key = path.substr(p+1);
+    }
+
+    PyObject *pd = dreampy_output_group(groups, parent);
+    PyObject *d = PyDict_New();
+    PyDict_SetItemString(pd, key.c_str(), d);
+    Py_DECREF(d);   // Reference held by parent
+
+    groups[path] = d;
+    return d;
+}
+
+/**
+ * Convert a variable stored in a 'MemorySFile' to a
+ * Python object (NumPy array or string).
+ */
+static PyObject *dreampy_output_variable(const DREAM::MemorySFile::variable& v) {
+    if (v.type == SFILE_DATA_STRING)
+        return PyUnicode_FromString(v.str.c_str());
+
+    const int nd = v.dims.size();
+    npy_intp *dims = new npy_intp[nd > 0 ? nd : 1];
+    for (int i = 0; i < nd; i++)
+        dims[i] = (npy_intp)v.dims[i];
+
+    PyObject *arr;
+    if (v.type == SFILE_DATA_DOUBLE) {
+        arr = PyArray_SimpleNew(nd, dims, NPY_DOUBLE);
+        if (arr != NULL)
+            memcpy(PyArray_DATA(reinterpret_cast<PyArrayObject*>(arr)), v.dbl.data(), sizeof(double)*v.dbl.size());
+    } else if (v.type == SFILE_DATA_INT32) {
+        arr = PyArray_SimpleNew(nd, dims, NPY_INT32);
+        if (arr != NULL) {
+            int32_t *d = reinterpret_cast<int32_t*>(PyArray_DATA(reinterpret_cast<PyArrayObject*>(arr)));
+            for (len_t i = 0; i < v.ints.size(); i++)
+                d[i] = (int32_t)v.ints[i];
+        }
+    } else {
+        arr = PyArray_SimpleNew(nd, dims, NPY_INT64);
+        if (arr != NULL)
+            memcpy(PyArray_DATA(reinterpret_cast<PyArrayObject*>(arr)), v.ints.data(), sizeof(int64_t)*v.ints.size());
+    }
+
+    delete [] dims;
+    return arr;
+}
+
+/**
+ * Returns the output of the simulation as a dictionary with the same
+ * structure as the dictionary obtained when loading an output file
+ * with 'DREAMIO.LoadHDF5AsDict()' (attributes of a variable 'x' are
+ * stored in the dictionary 'x@@'). The output is generated in memory
+ * and is never written to disk.
+ */
+static PyObject *dreampy_simulation_output(PyObject* /*self*/, PyObject *args) {
+    struct dreampy_simulation *ds = dreampy_get_simulation(args);
+    if (ds == nullptr)
         return NULL;
+
+    DREAM::MemorySFile msf;
+    try {
+        ds->sim->Save(&msf);
+    } DREAMPY_CATCH(NULL)
+
+    PyObject *root = PyDict_New();
+    std::map<std::string, PyObject*> groups;
+    groups[""] = root;
+
+    const std::map<std::string, DREAM::MemorySFile::variable>& vars = msf.GetVariables();
+    for (auto it = vars.begin(); it != vars.end(); it++) {
+        const std::string& path = it->first;
+        const DREAM::MemorySFile::variable& v = it->second;
+
+        if (v.type == SFILE_DATA_STRUCT) {
+            dreampy_output_group(groups, path);
+            continue;
+        }
+
+        std::string parent, key = path;
+        size_t p = path.rfind('/');
+        if (p != std::string::npos) {
+            parent = path.substr(0, p);
+            key = path.substr(p+1);
+        }
+
+        PyObject *pd = dreampy_output_group(groups, parent);
+        PyObject *obj = dreampy_output_variable(v);
+        if (obj == NULL) {
+            Py_DECREF(root);
+            return NULL;
+        }
+
+        PyDict_SetItemString(pd, key.c_str(), obj);
+        Py_DECREF(obj);
+
+        // Attributes
+        if (!v.strAttributes.empty() || !v.scalarAttributes.empty()) {
+            PyObject *attr = PyDict_New();
+            for (auto a = v.strAttributes.begin(); a != v.strAttributes.end(); a++) {
+                PyObject *s = PyUnicode_FromString(a->second.c_str());
+                PyDict_SetItemString(attr, a->first.c_str(), s);
+                Py_DECREF(s);
+            }
+            for (auto a = v.scalarAttributes.begin(); a != v.scalarAttributes.end(); a++) {
+                PyObject *s = PyFloat_FromDouble(a->second);
+                PyDict_SetItemString(attr, a->first.c_str(), s);
+                Py_DECREF(s);
+            }
+
+            PyDict_SetItemString(pd, (key+"@@").c_str(), attr);
+            Py_DECREF(attr);
+        }
+    }
+
+    return root;
 }
+
+/**
+ * Returns the current simulation time.
+ */
+static PyObject *dreampy_simulation_time(PyObject* /*self*/, PyObject *args) {
+    struct dreampy_simulation *ds = dreampy_get_simulation(args);
+    if (ds == nullptr)
+        return NULL;
+
+    return PyFloat_FromDouble(ds->sim->GetCurrentTime());
 }
 
+/**
+ * Returns a list of the names of all unknown quantities.
+ */
+static PyObject *dreampy_simulation_unknowns(PyObject* /*self*/, PyObject *args) {
+    struct dreampy_simulation *ds = dreampy_get_simulation(args);
+    if (ds == nullptr)
+        return NULL;
+
+    const std::vector<DREAM::FVM::UnknownQuantity*>& unknowns =
+        ds->sim->GetEquationSystem()->GetUnknownHandler()->GetUnknowns();
+
+    PyObject *list = PyList_New(unknowns.size());
+    for (len_t i = 0; i < unknowns.size(); i++)
+        PyList_SET_ITEM(list, i, PyUnicode_FromString(unknowns[i]->GetName().c_str()));
+
+    return list;
+}
+
+/**
+ * Returns the most recent data of the named unknown quantity as a
+ * NumPy array. The array shares memory with the simulation (which is
+ * kept alive for as long as the array exists) and is therefore updated
+ * as the simulation advances. The array has the shape
+ * (nMultiples, N), where N is the number of elements per multiple.
+ */
+static PyObject *dreampy_simulation_get_unknown(PyObject* /*self*/, PyObject *args) {
+    PyObject *capsule;
+    const char *name;
+    if (!PyArg_ParseTuple(args, "Os", &capsule, &name))
+        return NULL;
+
+    struct dreampy_simulation *ds = reinterpret_cast<struct dreampy_simulation*>(
+        PyCapsule_GetPointer(capsule, DREAMPY_CAPSULE_NAME)
+    );
+    if (ds == nullptr)
+        return NULL;
+
+    DREAM::FVM::QuantityData *qd;
+    try {
+        DREAM::FVM::UnknownQuantityHandler *uqh = ds->sim->GetEquationSystem()->GetUnknownHandler();
+        qd = uqh->GetUnknown(uqh->GetUnknownID(name))->GetQuantityData();
+    } DREAMPY_CATCH(NULL)
+
+    npy_intp dims[2] = {
+        (npy_intp)qd->GetNMultiples(),
+        (npy_intp)(qd->Size() / qd->GetNMultiples())
+    };
+
+    PyObject *arr = PyArray_New(
+        &PyArray_Type, 2, dims, NPY_DOUBLE, nullptr,
+        qd->Get(), 0, NPY_ARRAY_CARRAY_RO, nullptr
+    );
+    if (arr == NULL)
+        return NULL;
+
+    // Keep the simulation alive for as long as the array exists
+    Py_INCREF(capsule);
+    if (PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(arr), capsule) < 0) {
+        Py_DECREF(arr);
+        return NULL;
+    }
+
+    return arr;
+}
+
+/**
+ * Returns the value of the named prescribed quantity as a writeable
+ * NumPy array (of shape (nMultiples, N)). Values assigned to the
+ * array between time steps replace the prescribed time evolution of
+ * the quantity, which allows data to be passed to the simulation from
+ * a coupled code without restarting it.
+ */
+static PyObject *dreampy_simulation_get_prescribed(PyObject* /*self*/, PyObject *args) {
+    PyObject *capsule;
+    const char *name;
+    if (!PyArg_ParseTuple(args, "Os", &capsule, &name))
+        return NULL;
+
+    struct dreampy_simulation *ds = reinterpret_cast<struct dreampy_simulation*>(
+        PyCapsule_GetPointer(capsule, DREAMPY_CAPSULE_NAME)
+    );
+    if (ds == nullptr)
+        return NULL;
+
+    real_t *data;
+    len_t n, nMultiples;
+    try {
+        DREAM::FVM::UnknownQuantityHandler *uqh = ds->sim->GetEquationSystem()->GetUnknownHandler();
+        nMultiples = uqh->GetUnknown(uqh->GetUnknownID(name))->NumberOfMultiples();
+        data = ds->sim->GetPrescribedData(name, &n);
+    } DREAMPY_CATCH(NULL)
+
+    npy_intp dims[2] = {
+        (npy_intp)nMultiples,
+        (npy_intp)(n / nMultiples)
+    };
+
+    PyObject *arr = PyArray_New(
+        &PyArray_Type, 2, dims, NPY_DOUBLE, nullptr,
+        data, 0, NPY_ARRAY_CARRAY, nullptr
+    );
+    if (arr == NULL)
+        return NULL;
+
+    // Keep the simulation alive for as long as the array exists
+    Py_INCREF(capsule);
+    if (PyArray_SetBaseObject(reinterpret_cast<PyArrayObject*>(arr), capsule) < 0) {
+        Py_DECREF(arr);
+        return NULL;
+    }
+
+    return arr;
+}
+}
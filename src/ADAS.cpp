@@ -21,35 +21,31 @@ const len_t
     ADAS::IDX_PRB=4;
 
 
-#define N_ADAS_RATES 5
-
 /**
  * Constructor.
+ *
+ * The interpolation objects for an element are constructed
+ * the first time any of its rate coefficients are requested,
+ * so that the startup cost only depends on the elements that
+ * are actually used in the simulation.
+ *
+ * interp: Interpolation method to use.
+ * image:  Image of precomputed interpolation coefficients to take
+ *         the coefficients from (if 'nullptr', the coefficients are
+ *         computed when the element is first requested).
  */
-ADAS::ADAS(const gsl_interp2d_type *interp) {
-    // Generate interpolator objects
+ADAS::ADAS(const gsl_interp2d_type *interp, const AtomicDataImage *image)
+    : interp(interp), image(image) {
+
     for (len_t i = 0; i < adas_rate_n; i++) {
         struct adas_rate *ar = (adas_rate_table+i);
 
-        ADASRateInterpolator **ari = new ADASRateInterpolator*[N_ADAS_RATES];
-
-        #define INITADAS(type,shiftZ0) \
-            new ADASRateInterpolator( \
-                ar->Z, ar-> type ## _nn, ar-> type ## _nT, \
-                ar-> type ## _n, ar-> type ## _T, \
-                ar-> type , shiftZ0, interp \
-            )
-
-        ari[IDX_ACD] = INITADAS(acd, true);
-        ari[IDX_CCD] = INITADAS(ccd, false);
-        ari[IDX_SCD] = INITADAS(scd, false);
-        ari[IDX_PLT] = INITADAS(plt, false);
-        ari[IDX_PRB] = INITADAS(prb, true);
+        struct adas_element *el = new struct adas_element;
+        el->rate = ar;
+        el->tableIndex = i;
 
         len_t idx = get_isotope_index(ar->Z, ar->A);
-        intp[idx] = ari;
-
-        #undef INITADAS
+        elements[idx] = el;
     }
 }
 
@@ -58,16 +54,57 @@ ADAS::ADAS(const gsl_interp2d_type *interp) {
  * Destructor.
  */
 ADAS::~ADAS() {
-    for (auto it = intp.begin(); it != intp.end(); it++) {
-        // Iterate over data types
-        for (len_t i = 0; i < N_ADAS_RATES; i++)
-            delete it->second[i];
+    for (auto it = elements.begin(); it != elements.end(); it++) {
+        struct adas_element *el = it->second;
+
+        if (el->intp != nullptr) {
+            // Iterate over data types
+            for (len_t i = 0; i < N_ADAS_RATES; i++)
+                delete el->intp[i];
 
-        delete [] it->second;
+            delete [] el->intp;
+        }
+
+        delete el;
     }
 }
 
 
+/**
+ * (private)
+ * Construct the interpolation objects for the given element. If an
+ * image of precomputed atomic data is available, the interpolation
+ * coefficients are taken directly from it.
+ */
+void ADAS::build_element(struct adas_element *el) const {
+    const struct adas_rate *ar = el->rate;
+    const len_t intp = AtomicDataImage::GetInterpolationIndex(this->interp);
+
+    ADASRateInterpolator **ari = new ADASRateInterpolator*[N_ADAS_RATES];
+
+    #define INITADAS(IDX,type,shiftZ0) \
+        new ADASRateInterpolator( \
+            ar->Z, ar-> type ## _nn, ar-> type ## _nT, \
+            ar-> type ## _n, ar-> type ## _T, \
+            ar-> type , shiftZ0, this->interp, \
+            (this->image == nullptr ? nullptr : this->image->Get( \
+                el->tableIndex, IDX, intp, \
+                ADASRateInterpolator::GetNumberOfCoefficients(ar->Z, ar-> type ## _nn, ar-> type ## _nT) \
+            )) \
+        )
+
+    ari[IDX_ACD] = INITADAS(IDX_ACD, acd, true);
+    ari[IDX_CCD] = INITADAS(IDX_CCD, ccd, false);
+    ari[IDX_SCD] = INITADAS(IDX_SCD, scd, false);
+    ari[IDX_PLT] = INITADAS(IDX_PLT, plt, false);
+    ari[IDX_PRB] = INITADAS(IDX_PRB, prb, true);
+
+    #undef INITADAS
+
+    el->intp = ari;
+}
+
+
 /**
  * (private)
  * Returns the index into the ADAS rate array for the specified
@@ -84,22 +121,26 @@ len_t ADAS::get_isotope_index(const len_t Z, const len_t A) const {
  */
 bool ADAS::HasElement(const len_t Z, const len_t A) const {
     len_t idx = get_isotope_index(Z, A);
-    return (intp.find(idx) != intp.end());
+    return (elements.find(idx) != elements.end());
 }
 
 
 /**
  * (private)
- * Returns an iterator to the entry in the interpolator list
- * for the element with the specified charge.
+ * Returns the interpolation object for the specified rate
+ * coefficient of the element with the specified charge,
+ * constructing the interpolation objects for the element
+ * if they have not been constructed yet.
  *
- * Z: Charge of element to get iterator to.
+ * Z:    Charge of element to get rate coefficient for.
+ * A:    Atomic mass of the isotope (0 = default isotope).
+ * type: Index of rate coefficient to return.
  */
-unordered_map<len_t, ADASRateInterpolator**>::const_iterator ADAS::get_element(const len_t Z, const len_t A) const {
+ADASRateInterpolator *ADAS::get_rate(const len_t Z, const len_t A, const len_t type) const {
     len_t idx = get_isotope_index(Z, A);
 
-    unordered_map<len_t, ADASRateInterpolator**>::const_iterator it = intp.find(idx);
-    if (it == intp.end()) {
+    auto it = elements.find(idx);
+    if (it == elements.end()) {
         if (A == 0)
             throw ADASException(
                 "Element with charge Z=" LEN_T_PRINTF_FMT " not in DREAM ADAS database.",
@@ -112,26 +153,37 @@ unordered_map<len_t, ADASRateInterpolator**>::const_iterator ADAS::get_element(c
             );
     }
 
-    return it;
+    struct adas_element *el = it->second;
+
+    std::lock_guard<std::mutex> lock(this->buildMutex);
+    if (el->intp == nullptr) {
+        this->buildTimer.Start();
+        build_element(el);
+        this->buildTimer.Stop();
+
+        this->nBuiltElements++;
+    }
+
+    return el->intp[type];
 }
 
 /**
  * Getters for ADAS data.
  */
 ADASRateInterpolator *ADAS::GetACD(const len_t Z, const len_t A) const {
-    return get_element(Z, A)->second[IDX_ACD];
+    return get_rate(Z, A, IDX_ACD);
 }
 ADASRateInterpolator *ADAS::GetCCD(const len_t Z, const len_t A) const {
-    return get_element(Z, A)->second[IDX_CCD];
+    return get_rate(Z, A, IDX_CCD);
 }
 ADASRateInterpolator *ADAS::GetSCD(const len_t Z, const len_t A) const {
-    return get_element(Z, A)->second[IDX_SCD];
+    return get_rate(Z, A, IDX_SCD);
 }
 ADASRateInterpolator *ADAS::GetPLT(const len_t Z, const len_t A) const {
-    return get_element(Z, A)->second[IDX_PLT];
+    return get_rate(Z, A, IDX_PLT);
 }
 ADASRateInterpolator *ADAS::GetPRB(const len_t Z, const len_t A) const {
-    return get_element(Z, A)->second[IDX_PRB];
+    return get_rate(Z, A, IDX_PRB);
 }
 
 /**
@@ -0,0 +1,146 @@
+/**
+ * Implementation of a cache for the ADAS rate coefficients evaluated
+ * at the cold electron density and temperature of the fluid grid.
+ *
+ * The same rate coefficients (e.g. the ionization rate SCD and the
+ * recombination rate ACD of every ion species, for all charge states)
+ * are needed by several equation terms, such as the ion rate equation
+ * and the radiated power term of the energy balance, which are all
+ * rebuilt with the same n_cold and T_cold in every Newton iteration.
+ * The cache evaluates each requested rate (together with its
+ * derivatives with respect to n_cold and T_cold) for all charge states
+ * and radii the first time it is requested after n_cold or T_cold has
+ * changed, and the terms then read the rates from the cache, so that
+ * every rate is only evaluated once per rebuild.
+ */
+
+#include "DREAM/ADASRateCache.hpp"
+#include "DREAM/Settings/OptionConstants.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Constructor.
+ */
+ADASRateCache::ADASRateCache(
+    ADAS *adas, FVM::RadialGrid *rGrid, FVM::UnknownQuantityHandler *u
+) : adas(adas), rGrid(rGrid), unknowns(u) {
+    this->id_ncold = u->GetUnknownID(OptionConstants::UQTY_N_COLD);
+    this->id_Tcold = u->GetUnknownID(OptionConstants::UQTY_T_COLD);
+}
+
+/**
+ * Destructor.
+ */
+ADASRateCache::~ADASRateCache() {
+    for (auto &it : this->entries) {
+        Deallocate(it.second);
+        delete it.second;
+    }
+}
+
+
+/**
+ * Returns the interpolator for the named rate of the given element.
+ */
+ADASRateInterpolator *ADASRateCache::GetInterpolator(
+    const enum rate_type rate, const len_t Z
+) const {
+    switch (rate) {
+        case RATE_ACD: return adas->GetACD(Z);
+        case RATE_SCD: return adas->GetSCD(Z);
+        case RATE_PLT: return adas->GetPLT(Z);
+        case RATE_PRB: return adas->GetPRB(Z);
+
+        default:
+            throw ADASException("ADASRateCache: Unrecognized rate coefficient: %d.", rate);
+    }
+}
+
+/**
+ * (Re-)allocate the stored rates of the given entry for
+ * the given number of radial grid points.
+ */
+void ADASRateCache::Allocate(struct entry *e, const len_t nr) {
+    Deallocate(e);
+
+    const len_t Z = e->Z;
+    real_t ***arr[3] = { &e->r.R, &e->r.dRdn, &e->r.dRdT };
+    for (real_t ***a : arr) {
+        *a = new real_t*[Z+1];
+        (*a)[0] = new real_t[(Z+1)*nr];
+        for (len_t Z0 = 1; Z0 <= Z; Z0++)
+            (*a)[Z0] = (*a)[Z0-1] + nr;
+    }
+
+    e->nr = nr;
+    e->valid = false;
+}
+
+/**
+ * Deallocate the stored rates of the given entry.
+ */
+void ADASRateCache::Deallocate(struct entry *e) {
+    real_t ***arr[3] = { &e->r.R, &e->r.dRdn, &e->r.dRdT };
+    for (real_t ***a : arr) {
+        if (*a != nullptr) {
+            delete [] (*a)[0];
+            delete [] *a;
+        }
+        *a = nullptr;
+    }
+}
+
+
+/**
+ * Returns the named rate coefficient of the given element, for all
+ * charge states at all radii, evaluated at the current cold electron
+ * density and temperature. The rates are only evaluated if n_cold or
+ * T_cold has changed since they were last requested. Note that the
+ * arrays may be reallocated if the radial grid has changed, and so
+ * the returned rates must be requested again in every rebuild.
+ *
+ * rate: Rate coefficient to return.
+ * Z:    Atomic number of the element.
+ */
+const struct ADASRateCache::rates *ADASRateCache::Get(
+    const enum rate_type rate, const len_t Z
+) {
+    struct entry *e;
+    {
+        lock_guard<mutex> lock(this->entriesMutex);
+
+        auto key = make_pair((len_t)rate, Z);
+        auto it = this->entries.find(key);
+        if (it == this->entries.end()) {
+            e = new struct entry;
+            e->Z = Z;
+            this->entries[key] = e;
+        } else
+            e = it->second;
+    }
+
+    lock_guard<mutex> lock(e->evalMutex);
+
+    const len_t nr = rGrid->GetNr();
+    if (e->nr != nr || e->r.R == nullptr)
+        Allocate(e, nr);
+
+    const len_t vn = unknowns->GetVersion(id_ncold);
+    const len_t vT = unknowns->GetVersion(id_Tcold);
+    if (e->valid && vn == e->version_ncold && vT == e->version_Tcold)
+        return &e->r;
+
+    const real_t *n = unknowns->GetUnknownData(id_ncold);
+    const real_t *T = unknowns->GetUnknownData(id_Tcold);
+    GetInterpolator(rate, Z)->Eval(nr, n, T, e->r.R, e->r.dRdn, e->r.dRdT);
+
+    e->version_ncold = vn;
+    e->version_Tcold = vT;
+    e->valid = true;
+
+    return &e->r;
+}
@@ -1,6 +1,17 @@
 /**
  * Implementation of an object that interpolates in ADAS
  * rate coefficients.
+ *
+ * The interpolation is carried out in the logarithm of the rate
+ * coefficient, on the (log10 n, log10 T) grid of the ADAS data. For
+ * efficiency, the (bicubic or bilinear) polynomial representing the
+ * interpolant in each grid cell is computed once, when the object is
+ * constructed, so that the interpolant and its derivatives can be
+ * evaluated directly from a flat array of coefficients. Outside of the
+ * grid, the data is extrapolated bilinearly from the nearest cell.
+ *
+ * The coefficients are stored with the precision given by the template
+ * parameter 'S' (see 'ADASRateInterpolator.hpp').
  */
 
 #include <cmath>
@@ -21,52 +32,225 @@ using namespace DREAM;
  * logT:   Logarithm of plasma temperature (size nT).
  * coeff:  ADAS rate coefficient to interpolate (size Z*nn*nT).
  * interp: 2D interpolation method to use.
+ * precomputed: Interpolation coefficients computed previously with
+ *         the same data and interpolation method (e.g. taken from an
+ *         'AtomicDataImage'; size 'GetNumberOfCoefficients()'), or
+ *         'nullptr' to compute them. The array must remain valid for
+ *         the lifetime of this object.
  */
-ADASRateInterpolator::ADASRateInterpolator(
+template<typename S>
+ADASRateInterpolatorT<S>::ADASRateInterpolatorT(
     const len_t Z, const len_t nn, const len_t nT,
     const real_t *logn, const real_t *logT, const real_t *coeff,
-    bool shiftZ0, const gsl_interp2d_type *interp
+    bool shiftZ0, const gsl_interp2d_type *interp, const S *precomputed
 ) : Z(Z), nn(nn), nT(nT), logn(logn), logT(logT), data(coeff), shiftZ0(shiftZ0) {
 
-    this->interp_c = new gsl_interp2d*[Z];
-    this->interp_l = new gsl_interp2d*[Z];
-    this->nacc = new gsl_interp_accel*[Z];
-    this->Tacc = new gsl_interp_accel*[Z];
+    if (precomputed != nullptr) {
+        this->coeffs = precomputed;
+        this->ownsCoeffs = false;
+        return;
+    }
+
     const len_t stride = nn*nT;
+    const bool bilinear = (interp == gsl_interp2d_bilinear);
+
+    S *cf = new S[GetNumberOfCoefficients()];
+    this->coeffs = cf;
+
+    // The node derivatives of the bicubic interpolant are
+    // taken from GSL, so that the polynomials constructed
+    // below reproduce the GSL interpolant exactly.
+    gsl_interp2d *intp = nullptr;
+    real_t *zx = nullptr, *zy = nullptr, *zxy = nullptr;
+    if (!bilinear) {
+        intp = gsl_interp2d_alloc(interp, nn, nT);
+        zx  = new real_t[stride];
+        zy  = new real_t[stride];
+        zxy = new real_t[stride];
+    }
+
+    // Conversion from (cubic) Hermite data to polynomial coefficients
+    const real_t C[4][4] = {
+        { 1, 0, 0, 0},
+        { 0, 0, 1, 0},
+        {-3, 3,-2,-1},
+        { 2,-2, 1, 1}
+    };
+
+    for (len_t idx = 0; idx < Z; idx++) {
+        const real_t *z = this->data + idx*stride;
 
-    for (len_t i = 0; i < Z; i++) {
-        this->interp_c[i] = gsl_interp2d_alloc(interp, nn, nT);
-        gsl_interp2d_init(this->interp_c[i], this->logn, this->logT, this->data + i*stride, nn, nT);
+        if (!bilinear) {
+            gsl_interp2d_init(intp, this->logn, this->logT, z, nn, nT);
 
-        if (interp == gsl_interp2d_bilinear)
-            this->interp_l[i] = this->interp_c[i];
-        else {
-            this->interp_l[i] = gsl_interp2d_alloc(gsl_interp2d_bilinear, nn, nT);
-            gsl_interp2d_init(this->interp_l[i], this->logn, this->logT, this->data + i*stride, nn, nT);
+            for (len_t iT = 0; iT < nT; iT++)
+                for (len_t in = 0; in < nn; in++) {
+                    const len_t k = iT*nn + in;
+                    zx[k]  = gsl_interp2d_eval_deriv_x(intp, logn, logT, z, logn[in], logT[iT], nullptr, nullptr);
+                    zy[k]  = gsl_interp2d_eval_deriv_y(intp, logn, logT, z, logn[in], logT[iT], nullptr, nullptr);
+                    zxy[k] = gsl_interp2d_eval_deriv_xy(intp, logn, logT, z, logn[in], logT[iT], nullptr, nullptr);
+                }
         }
 
-        this->nacc[i] = gsl_interp_accel_alloc();
-        this->Tacc[i] = gsl_interp_accel_alloc();
+        for (len_t iT = 0; iT+1 < nT; iT++) {
+            const real_t dy = logT[iT+1] - logT[iT];
+            for (len_t in = 0; in+1 < nn; in++) {
+                const real_t dx = logn[in+1] - logn[in];
+                S *a = cf + 16*((idx*(nT-1) + iT)*(nn-1) + in);
+
+                for (len_t k = 0; k < 16; k++)
+                    a[k] = 0;
+
+                // Node indices of the cell corners (t,u)
+                const len_t
+                    k00 = iT*nn + in, k10 = k00 + 1,
+                    k01 = k00 + nn,   k11 = k01 + 1;
+
+                if (bilinear) {
+                    a[0] = z[k00];
+                    a[1] = z[k01] - z[k00];
+                    a[4] = z[k10] - z[k00];
+                    a[5] = z[k11] - z[k10] - z[k01] + z[k00];
+                } else {
+                    // Hermite data F[r][c], with r = (f(0), f(1), f_t(0), f_t(1))
+                    // in t and c the corresponding quantities in u
+                    const real_t F[4][4] = {
+                        {z[k00],       z[k01],       dy*zy[k00],       dy*zy[k01]},
+                        {z[k10],       z[k11],       dy*zy[k10],       dy*zy[k11]},
+                        {dx*zx[k00],   dx*zx[k01],   dx*dy*zxy[k00],   dx*dy*zxy[k01]},
+                        {dx*zx[k10],   dx*zx[k11],   dx*dy*zxy[k10],   dx*dy*zxy[k11]}
+                    };
+
+                    // a = C F C^T
+                    for (len_t k = 0; k < 4; k++)
+                        for (len_t l = 0; l < 4; l++) {
+                            real_t s = 0;
+                            for (len_t r = 0; r < 4; r++)
+                                for (len_t c = 0; c < 4; c++)
+                                    s += C[k][r] * F[r][c] * C[l][c];
+                            a[4*k+l] = s;
+                        }
+                }
+            }
+        }
+    }
+
+    if (!bilinear) {
+        delete [] zxy;
+        delete [] zy;
+        delete [] zx;
+        gsl_interp2d_free(intp);
     }
 }
 
 /**
  * Destructor.
  */
-ADASRateInterpolator::~ADASRateInterpolator() {
-    for (len_t i = 0; i < Z; i++) {
-        if (this->interp_c[i] != this->interp_l[i])
-            gsl_interp2d_free(this->interp_l[i]);
-
-        gsl_interp2d_free(this->interp_c[i]);
-        gsl_interp_accel_free(this->nacc[i]);
-        gsl_interp_accel_free(this->Tacc[i]);
+template<typename S>
+ADASRateInterpolatorT<S>::~ADASRateInterpolatorT() {
+    if (this->ownsCoeffs)
+        delete [] this->coeffs;
+}
+
+/**
+ * Locate the given point in the (log10 n, log10 T) grid.
+ *
+ * n: Density.
+ * T: Temperature.
+ * p: On return, contains the location of the point.
+ *
+ * RETURNS false if the rate coefficient should be
+ * taken to vanish at the point (i.e. if n or T is
+ * non-positive).
+ */
+template<typename S>
+bool ADASRateInterpolatorT<S>::Locate(
+    const real_t n, const real_t T, struct grid_point *p
+) const {
+    // presumably these are expected to be 0 within numerical errors.
+    if((n<=0) || (T<=0))
+        return false;
+
+    const real_t ln = log10(n);
+    const real_t lT = log10(T);
+
+    p->inside = !(
+        ln < this->logn[0] || lT < this->logT[0] ||
+        ln > this->logn[this->nn-1] || lT > this->logT[this->nT-1]
+    );
+
+    // Outside of the grid, the nearest cell is returned
+    // (and the local coordinates fall outside [0,1])
+    p->in = gsl_interp_bsearch(this->logn, ln, 0, this->nn-1);
+    p->iT = gsl_interp_bsearch(this->logT, lT, 0, this->nT-1);
+
+    p->dx = this->logn[p->in+1] - this->logn[p->in];
+    p->dy = this->logT[p->iT+1] - this->logT[p->iT];
+    p->t  = (ln - this->logn[p->in]) / p->dx;
+    p->u  = (lT - this->logT[p->iT]) / p->dy;
+
+    p->n = n;
+    p->T = T;
+
+    return true;
+}
+
+/**
+ * Evaluate the rate coefficient, and optionally its derivatives
+ * with respect to density and temperature, in the given point.
+ *
+ * idx:       Index of charge state in the ADAS data.
+ * p:         Location of the point to evaluate in.
+ * dcoeff_dn: If not 'nullptr', contains the derivative of the
+ *            rate coefficient with respect to n on return.
+ * dcoeff_dT: If not 'nullptr', contains the derivative of the
+ *            rate coefficient with respect to T on return.
+ */
+template<typename S>
+real_t ADASRateInterpolatorT<S>::EvalPoint(
+    const len_t idx, const struct grid_point *p,
+    real_t *dcoeff_dn, real_t *dcoeff_dT
+) const {
+    const real_t t = p->t, u = p->u;
+    real_t f, ft, fu;
+
+    if (p->inside) {
+        const S *a = this->coeffs + 16*((idx*(nT-1) + p->iT)*(nn-1) + p->in);
+
+        // (the polynomials are always evaluated in 'real_t')
+        real_t b[4], db[4];
+        for (len_t k = 0; k < 4; k++) {
+            const S *ak = a + 4*k;
+            b[k]  = ((ak[3]*u + ak[2])*u + ak[1])*u + ak[0];
+            db[k] = (3*ak[3]*u + 2*ak[2])*u + ak[1];
+        }
+
+        f  = ((b[3]*t + b[2])*t + b[1])*t + b[0];
+        ft = (3*b[3]*t + 2*b[2])*t + b[1];
+        fu = ((db[3]*t + db[2])*t + db[1])*t + db[0];
+    } else {
+        // Bilinear extrapolation from the nearest cell
+        const real_t *z = this->data + idx*nn*nT + p->iT*nn + p->in;
+        const real_t
+            c10 = z[1] - z[0],
+            c01 = z[nn] - z[0],
+            c11 = z[nn+1] - z[1] - z[nn] + z[0];
+
+        f  = z[0] + c10*t + c01*u + c11*t*u;
+        ft = c10 + c11*u;
+        fu = c01 + c11*t;
     }
 
-    delete [] this->Tacc;
-    delete [] this->nacc;
-    delete [] this->interp_l;
-    delete [] this->interp_c;
+    // coeff = 10^ADASDATA
+    const real_t v = exp(LN10 * f);
+
+    // d(coeff)/dn = coeff * ln(10) * df/dlog10(n) * dlog10(n)/dn
+    if (dcoeff_dn != nullptr)
+        *dcoeff_dn = v * ft / (p->dx * p->n);
+    if (dcoeff_dT != nullptr)
+        *dcoeff_dT = v * fu / (p->dy * p->T);
+
+    return v;
 }
 
 /**
@@ -76,50 +260,124 @@ ADASRateInterpolator::~ADASRateInterpolator() {
  * n:  Density.
  * T   Temperature.
  */
-real_t ADASRateInterpolator::Eval(const len_t Z0, const real_t n, const real_t T) {
-    if ((shiftZ0 && Z0 == 0) || (!shiftZ0 && Z0 == Z))
+template<typename S>
+real_t ADASRateInterpolatorT<S>::Eval(const len_t Z0, const real_t n, const real_t T) const {
+    struct grid_point p;
+    if (IsZero(Z0) || !Locate(n, T, &p))
         return 0;
 
-    // presumably these are expected to be 0 within numerical errors.
-    if((n<=0) || (T<=0))
-        return 0;
+    return EvalPoint(shiftZ0 ? Z0-1 : Z0, &p, nullptr, nullptr);
+}
 
+/**
+ * Evaluate the rate coefficient for a single charge state in
+ * a number of points (typically at all radii), optionally
+ * together with its derivatives with respect to n and T.
+ *
+ * Z0:        Ion charge state to evaluate coefficient for.
+ * N:         Number of points to evaluate in.
+ * n:         Densities (size N).
+ * T:         Temperatures (size N).
+ * coeff:     On return, contains the rate coefficient (size N).
+ * dcoeff_dn: If not 'nullptr', contains the derivative of the
+ *            rate coefficient with respect to n on return (size N).
+ * dcoeff_dT: If not 'nullptr', contains the derivative of the
+ *            rate coefficient with respect to T on return (size N).
+ */
+template<typename S>
+void ADASRateInterpolatorT<S>::Eval(
+    const len_t Z0, const len_t N, const real_t *n, const real_t *T,
+    real_t *coeff, real_t *dcoeff_dn, real_t *dcoeff_dT
+) const {
+    const bool zero = IsZero(Z0);
     const len_t idx = (shiftZ0 ? Z0-1 : Z0);
-    const len_t stride = this->nn*this->nT;
-    const real_t lT = log10(T);
-    const real_t ln = log10(n);
 
-    // coeff = 10^ADASDATA
-    gsl_interp2d *spln;
-    if (ln < this->logn[0] || lT < this->logT[0] || ln > this->logn[this->nn-1] || lT > this->logT[this->nT-1])
-        spln = this->interp_l[idx];
-    else
-        spln = this->interp_c[idx];
-
-    return exp(LN10 * gsl_interp2d_eval_extrap(
-        // GSL interpolation 2D object
-        spln,
-        // Input data
-        this->logn, this->logT, this->data+idx*stride,
-        // Point to evaluate data in
-        ln, lT,
-        // Accelerator objects (for quicker table lookup)
-        this->nacc[idx], this->Tacc[idx]
-    ));
+    for (len_t i = 0; i < N; i++) {
+        struct grid_point p;
+        if (zero || !Locate(n[i], T[i], &p)) {
+            coeff[i] = 0;
+            if (dcoeff_dn != nullptr) dcoeff_dn[i] = 0;
+            if (dcoeff_dT != nullptr) dcoeff_dT[i] = 0;
+        } else
+            coeff[i] = EvalPoint(
+                idx, &p,
+                (dcoeff_dn==nullptr ? nullptr : dcoeff_dn+i),
+                (dcoeff_dT==nullptr ? nullptr : dcoeff_dT+i)
+            );
+    }
 }
 
-real_t ADASRateInterpolator::Eval_deriv_n(const len_t Z0, const real_t n, const real_t T) {
-    real_t eps = std::numeric_limits<real_t>::epsilon();
-    real_t dn = sqrt(eps)*n + eps;
-    return ( Eval(Z0,n+dn,T) - Eval(Z0,n,T) ) / dn;
+/**
+ * Evaluate the rate coefficient for all charge states Z0 = 0,...,Z
+ * in a number of points (typically at all radii), optionally together
+ * with its derivatives with respect to n and T. Since all charge states
+ * share the same grid, each point only needs to be located once.
+ *
+ * N:         Number of points to evaluate in.
+ * n:         Densities (size N).
+ * T:         Temperatures (size N).
+ * coeff:     On return, contains the rate coefficient, indexed
+ *            as coeff[Z0][i] (size (Z+1) x N).
+ * dcoeff_dn: If not 'nullptr', contains the derivative of the
+ *            rate coefficient with respect to n on return.
+ * dcoeff_dT: If not 'nullptr', contains the derivative of the
+ *            rate coefficient with respect to T on return.
+ */
+template<typename S>
+void ADASRateInterpolatorT<S>::Eval(
+    const len_t N, const real_t *n, const real_t *T,
+    real_t **coeff, real_t **dcoeff_dn, real_t **dcoeff_dT
+) const {
+    for (len_t i = 0; i < N; i++) {
+        struct grid_point p;
+        const bool located = Locate(n[i], T[i], &p);
+
+        for (len_t Z0 = 0; Z0 <= Z; Z0++) {
+            if (!located || IsZero(Z0)) {
+                coeff[Z0][i] = 0;
+                if (dcoeff_dn != nullptr) dcoeff_dn[Z0][i] = 0;
+                if (dcoeff_dT != nullptr) dcoeff_dT[Z0][i] = 0;
+            } else
+                coeff[Z0][i] = EvalPoint(
+                    shiftZ0 ? Z0-1 : Z0, &p,
+                    (dcoeff_dn==nullptr ? nullptr : dcoeff_dn[Z0]+i),
+                    (dcoeff_dT==nullptr ? nullptr : dcoeff_dT[Z0]+i)
+                );
+        }
+    }
 }
 
+/**
+ * Evaluate the derivative of the rate coefficient
+ * with respect to density.
+ */
+template<typename S>
+real_t ADASRateInterpolatorT<S>::Eval_deriv_n(const len_t Z0, const real_t n, const real_t T) const {
+    struct grid_point p;
+    if (IsZero(Z0) || !Locate(n, T, &p))
+        return 0;
 
-real_t ADASRateInterpolator::Eval_deriv_T(const len_t Z0, const real_t n, const real_t T) {
-    real_t eps = std::numeric_limits<real_t>::epsilon();
-    real_t dT = sqrt(eps)*T + eps;
-    return ( Eval(Z0,n,T+dT) - Eval(Z0,n,T) ) / dT;
+    real_t d;
+    EvalPoint(shiftZ0 ? Z0-1 : Z0, &p, &d, nullptr);
+    return d;
 }
 
+/**
+ * Evaluate the derivative of the rate coefficient
+ * with respect to temperature.
+ */
+template<typename S>
+real_t ADASRateInterpolatorT<S>::Eval_deriv_T(const len_t Z0, const real_t n, const real_t T) const {
+    struct grid_point p;
+    if (IsZero(Z0) || !Locate(n, T, &p))
+        return 0;
+
+    real_t d;
+    EvalPoint(shiftZ0 ? Z0-1 : Z0, &p, nullptr, &d);
+    return d;
+}
 
 
+// Explicit instantiations
+template class DREAM::ADASRateInterpolatorT<double>;
+template class DREAM::ADASRateInterpolatorT<float>;
@@ -1,11 +1,159 @@
-
 #include <cmath>
 #include "DREAM/AMJUEL.hpp"
+#include "DREAM/DREAMException.hpp"
 
 using namespace DREAM;
 using namespace std;
 
 
+/**
+ * Returns the fit coefficients of the given rate coefficient.
+ */
+const real_t *AMJUEL::GetCoefficients(enum rate_coefficient r) {
+    switch (r) {
+        case REC_LY_OPAQUE:        return recLyOpaque;
+        case REC_RAD_LY_OPAQUE:    return recRadLyOpaque;
+        case IONIZ_LY_OPAQUE:      return ionizLyOpaque;
+        case IONIZ_LOSS_LY_OPAQUE: return ionizLossLyOpaque;
+
+        default:
+            throw DREAMException("AMJUEL: Unrecognized rate coefficient: %d.", r);
+    }
+}
+
+/**
+ * Returns true if the given rate coefficient is non-zero for
+ * the given charge state (the rates only apply to hydrogen isotopes,
+ * with recombination from Z0=1 and ionization from Z0=0).
+ */
+bool AMJUEL::AppliesTo(enum rate_coefficient r, const len_t Z0) {
+    if (r == REC_LY_OPAQUE || r == REC_RAD_LY_OPAQUE)
+        return (Z0 == 1);
+    else
+        return (Z0 == 0);
+}
+
+/**
+ * Evaluate the double polynomial fit
+ *
+ *   F = sum_i sum_j C_{ij} lnT^i lnn^j
+ *
+ * together with its derivatives with respect to lnn and lnT,
+ * using Horner's scheme in both variables.
+ *
+ * C:      Fit coefficients (inner index j).
+ * lnn:    ln(n/1e14).
+ * lnT:    ln(T).
+ * F:      On return, contains the value of the fit.
+ * dFdlnn: On return, contains dF/dlnn.
+ * dFdlnT: On return, contains dF/dlnT.
+ */
+void AMJUEL::EvalFit(
+    const real_t *C, const real_t lnn, const real_t lnT,
+    real_t &F, real_t &dFdlnn, real_t &dFdlnT
+) {
+    F = 0; dFdlnn = 0; dFdlnT = 0;
+    for (len_t i = maxTempCoeffsIndex; i-- > 0;) {
+        const real_t *Ci = C + i*maxDensCoeffsIndex;
+
+        // P_i(lnn) = sum_j C_{ij} lnn^j, and its derivative
+        real_t P = 0, dP = 0;
+        for (len_t j = maxDensCoeffsIndex; j-- > 0;) {
+            dP = dP*lnn + P;
+            P  = P*lnn + Ci[j];
+        }
+
+        dFdlnT = dFdlnT*lnT + F;
+        F      = F*lnT + P;
+        dFdlnn = dFdlnn*lnT + dP;
+    }
+}
+
+
+/**
+ * Evaluate several rate coefficients (and optionally their
+ * derivatives with respect to density and temperature) for the given
+ * charge state at a set of points. The logarithms of the density and
+ * temperature are evaluated once per point for all rates, and the
+ * derivatives are obtained from the same polynomial evaluation as
+ * the rates themselves.
+ *
+ * nRates: Number of rate coefficients to evaluate.
+ * rates:  Rate coefficients to evaluate (list of 'nRates' elements).
+ * Z0:     Charge state.
+ * N:      Number of points to evaluate the rates at.
+ * n:      Background electron density in each point.
+ * T:      Background electron temperature in each point.
+ * R:      On return, contains the rates (R[k][i] is rate 'k' in point 'i').
+ * dRdn:   If not 'nullptr', contains the derivatives of the rates
+ *         with respect to density on return (same layout as 'R').
+ * dRdT:   If not 'nullptr', contains the derivatives of the rates
+ *         with respect to temperature on return (same layout as 'R').
+ */
+void AMJUEL::Eval(
+    const len_t nRates, const enum rate_coefficient *rates, const len_t Z0,
+    const len_t N, const real_t *n, const real_t *T, real_t *const* R,
+    real_t *const* dRdn, real_t *const* dRdT
+) {
+    // Rates which vanish for this charge state
+    bool anyActive = false;
+    for (len_t k = 0; k < nRates; k++) {
+        if (AppliesTo(rates[k], Z0)) {
+            anyActive = true;
+            continue;
+        }
+
+        for (len_t i = 0; i < N; i++) {
+            R[k][i] = 0;
+            if (dRdn != nullptr) dRdn[k][i] = 0;
+            if (dRdT != nullptr) dRdT[k][i] = 0;
+        }
+    }
+
+    if (!anyActive)
+        return;
+
+    for (len_t i = 0; i < N; i++) {
+        const real_t lnn = log(n[i]/1e14);
+        const real_t lnT = log(T[i]);
+
+        for (len_t k = 0; k < nRates; k++) {
+            if (!AppliesTo(rates[k], Z0))
+                continue;
+
+            real_t F, dFdlnn, dFdlnT;
+            EvalFit(GetCoefficients(rates[k]), lnn, lnT, F, dFdlnn, dFdlnT);
+
+            // Factor 1e6 converts from cm^3 to m^3 (and the energies
+            // of the radiation coefficients are given in eV)
+            real_t r = exp(F)/1e6;
+            if (rates[k] == REC_RAD_LY_OPAQUE || rates[k] == IONIZ_LOSS_LY_OPAQUE)
+                r *= Constants::ec;
+
+            R[k][i] = r;
+            if (dRdn != nullptr) dRdn[k][i] = r*dFdlnn/n[i];
+            if (dRdT != nullptr) dRdT[k][i] = r*dFdlnT/T[i];
+        }
+    }
+}
+
+/**
+ * Evaluate a single rate coefficient (and optionally its
+ * derivatives) for the given charge state at a set of points.
+ * See the multi-rate version of this method for details.
+ */
+void AMJUEL::Eval(
+    const enum rate_coefficient rate, const len_t Z0, const len_t N,
+    const real_t *n, const real_t *T, real_t *R, real_t *dRdn, real_t *dRdT
+) {
+    this->Eval(
+        1, &rate, Z0, N, n, T, &R,
+        (dRdn != nullptr ? &dRdn : nullptr),
+        (dRdT != nullptr ? &dRdT : nullptr)
+    );
+}
+
+
 /**
  * Lyman-opaque recombination rate coefficient [m^3 s^{-1}]
  *
@@ -14,26 +162,9 @@ using namespace std;
  * T:  Background electron temperature.
  */
 real_t AMJUEL::getRecLyOpaque(len_t Z0, real_t n, real_t T){
-    if(Z0==1){
-        real_t lnRecAMJUEL=0;
-        
-        real_t lnT=log(T);
-        real_t lnn=log(n/1e14);
-        real_t lnTi=1.0;
-        real_t lnnj=1.0;
-        
-        for(len_t i=0;i<maxTempCoeffsIndex;i++){
-            lnnj=1.0;
-            for(len_t j=0;j<maxDensCoeffsIndex;j++){
-                lnRecAMJUEL+=recLyOpaque[i*maxDensCoeffsIndex+j]*lnTi*lnnj;
-                lnnj*=lnn;
-            }
-            lnTi*=lnT;
-        }
-        return exp(lnRecAMJUEL)/1e6; // Factor 1e6 converts from cm^3 to m^3
-    }else{
-        return 0;
-    }        			
+    real_t R;
+    Eval(REC_LY_OPAQUE, Z0, 1, &n, &T, &R);
+    return R;
 }
 
 /**
@@ -45,30 +176,9 @@ real_t AMJUEL::getRecLyOpaque(len_t Z0, real_t n, real_t T){
  * T:  Background electron temperature.
  */
 real_t AMJUEL::getRecLyOpaque_deriv_n(len_t Z0, real_t n, real_t T){
-    if(Z0==1){
-        real_t lnRecAMJUEL=0;
-        real_t derivFactor=0;
-        
-        real_t lnT=log(T);
-        real_t lnn=log(n/1e14);
-        real_t lnTi=1.0;
-        real_t lnnj=1.0;
-        
-        for(len_t i=0;i<maxTempCoeffsIndex;i++){
-            lnnj=1.0;
-            for(len_t j=0;j<maxDensCoeffsIndex;j++){
-                lnRecAMJUEL+=recLyOpaque[i*maxDensCoeffsIndex+j]*lnTi*lnnj;
-                if(j>0)
-                    derivFactor+=recLyOpaque[i*maxDensCoeffsIndex+j]*lnTi*j*lnnj/lnn/n;
-                
-                lnnj*=lnn;
-            }
-            lnTi*=lnT;
-        }
-        return derivFactor*exp(lnRecAMJUEL)/1e6; // Factor 1e6 converts from cm^3 to m^3
-    }else{
-        return 0;
-    }        			
+    real_t R, dRdn;
+    Eval(REC_LY_OPAQUE, Z0, 1, &n, &T, &R, &dRdn);
+    return dRdn;
 }
 
 /**
@@ -80,30 +190,9 @@ real_t AMJUEL::getRecLyOpaque_deriv_n(len_t Z0, real_t n, real_t T){
  * T:  Background electron temperature.
  */
 real_t AMJUEL::getRecLyOpaque_deriv_T(len_t Z0, real_t n, real_t T){
-    if(Z0==1){
-        real_t lnRecAMJUEL=0;
-        real_t derivFactor=0;
-        
-        real_t lnT=log(T);
-        real_t lnn=log(n/1e14);
-        real_t lnTi=1.0;
-        real_t lnnj=1.0;
-        
-        for(len_t i=0;i<maxTempCoeffsIndex;i++){
-        	lnnj=1.0;
-            for(len_t j=0;j<maxDensCoeffsIndex;j++){
-                lnRecAMJUEL+=recLyOpaque[i*maxDensCoeffsIndex+j]*lnTi*lnnj;
-                if(i>0)
-                    derivFactor+=recLyOpaque[i*maxDensCoeffsIndex+j]*i*lnTi/lnT/T*lnnj;
-                    
-                lnnj*=lnn;
-            }
-            lnTi*=lnT;
-        }
-        return derivFactor*exp(lnRecAMJUEL)/1e6; // Factor 1e6 converts from cm^3 to m^3
-    }else{
-        return 0;
-    }        			
+    real_t R, dRdT;
+    Eval(REC_LY_OPAQUE, Z0, 1, &n, &T, &R, nullptr, &dRdT);
+    return dRdT;
 }
 
 /**
@@ -114,26 +203,9 @@ real_t AMJUEL::getRecLyOpaque_deriv_T(len_t Z0, real_t n, real_t T){
  * T:  Background electron temperature.
  */
 real_t AMJUEL::getRecRadLyOpaque(len_t Z0, real_t n, real_t T){
-    if(Z0==1){
-        real_t lnRecRadAMJUEL=0;
-        
-        real_t lnT=log(T);
-        real_t lnn=log(n/1e14);
-        real_t lnTi=1.0;
-        real_t lnnj=1.0;
-        
-        for(len_t i=0;i<maxTempCoeffsIndex;i++){
-            lnnj=1.0;
-            for(len_t j=0;j<maxDensCoeffsIndex;j++){
-                lnRecRadAMJUEL+=recRadLyOpaque[i*maxDensCoeffsIndex+j]*lnTi*lnnj;
-                lnnj*=lnn;
-            }
-            lnTi*=lnT;
-        }
-        return Constants::ec*exp(lnRecRadAMJUEL)/1e6; // Factor 1e6 converts from cm^3 to m^3
-    }else{
-        return 0;
-    }        			
+    real_t R;
+    Eval(REC_RAD_LY_OPAQUE, Z0, 1, &n, &T, &R);
+    return R;
 }
 
 /**
@@ -145,30 +217,9 @@ real_t AMJUEL::getRecRadLyOpaque(len_t Z0, real_t n, real_t T){
  * T:  Background electron temperature.
  */
 real_t AMJUEL::getRecRadLyOpaque_deriv_n(len_t Z0, real_t n, real_t T){
-    if(Z0==1){
-        real_t lnRecRadAMJUEL=0;
-        real_t derivFactor=0;
-        
-        real_t lnT=log(T);
-        real_t lnn=log(n/1e14);
-        real_t lnTi=1.0;
-        real_t lnnj=1.0;
-        
-        for(len_t i=0;i<maxTempCoeffsIndex;i++){
-            lnnj=1.0;
-            for(len_t j=0;j<maxDensCoeffsIndex;j++){
-                lnRecRadAMJUEL+=recRadLyOpaque[i*maxDensCoeffsIndex+j]*lnTi*lnnj;
-                if(j>0)
-                    derivFactor+=recRadLyOpaque[i*maxDensCoeffsIndex+j]*lnTi*j*lnnj/lnn/n;
-                    
-                lnnj*=lnn;
-            }
-            lnTi*=lnT;
-        }
-        return Constants::ec*derivFactor*exp(lnRecRadAMJUEL)/1e6; // Factor 1e6 converts from cm^3 to m^3
-    }else{
-        return 0;
-    }        			
+    real_t R, dRdn;
+    Eval(REC_RAD_LY_OPAQUE, Z0, 1, &n, &T, &R, &dRdn);
+    return dRdn;
 }
 
 /**
@@ -180,30 +231,9 @@ real_t AMJUEL::getRecRadLyOpaque_deriv_n(len_t Z0, real_t n, real_t T){
  * T:  Background electron temperature.
  */
 real_t AMJUEL::getRecRadLyOpaque_deriv_T(len_t Z0, real_t n, real_t T){
-    if(Z0==1){
-        real_t lnRecRadAMJUEL=0;
-        real_t derivFactor=0;
-        
-        real_t lnT=log(T);
-        real_t lnn=log(n/1e14);
-        real_t lnTi=1.0;
-        real_t lnnj=1.0;
-        
-        for(len_t i=0;i<maxTempCoeffsIndex;i++){
-            lnnj=1.0;
-            for(len_t j=0;j<maxDensCoeffsIndex;j++){
-                lnRecRadAMJUEL+=recRadLyOpaque[i*maxDensCoeffsIndex+j]*lnTi*lnnj;
-                if(i>0)
-                    derivFactor+=recRadLyOpaque[i*maxDensCoeffsIndex+j]*i*lnTi/lnT/T*lnnj;
-                    
-                lnnj*=lnn;
-            }
-            lnTi*=lnT;
-        }
-        return Constants::ec*derivFactor*exp(lnRecRadAMJUEL)/1e6; // Factor 1e6 converts from cm^3 to m^3
-    }else{
-        return 0;
-    }        			
+    real_t R, dRdT;
+    Eval(REC_RAD_LY_OPAQUE, Z0, 1, &n, &T, &R, nullptr, &dRdT);
+    return dRdT;
 }
 
 /**
@@ -214,26 +244,9 @@ real_t AMJUEL::getRecRadLyOpaque_deriv_T(len_t Z0, real_t n, real_t T){
  * T:  Background electron temperature.
  */
 real_t AMJUEL::getIonizLyOpaque(len_t Z0, real_t n, real_t T){
-    if(Z0==0){
-        real_t lnIonizAMJUEL=0;
-        
-        real_t lnT=log(T);
-        real_t lnn=log(n/1e14);
-        real_t lnTi=1.0;
-        real_t lnnj=1.0;
-        
-        for(len_t i=0;i<maxTempCoeffsIndex;i++){
-            lnnj=1.0;
-            for(len_t j=0;j<maxDensCoeffsIndex;j++){
-                lnIonizAMJUEL+=ionizLyOpaque[i*maxDensCoeffsIndex+j]*lnTi*lnnj;
-                lnnj*=lnn;
-            }
-            lnTi*=lnT;
-        }
-        return exp(lnIonizAMJUEL)/1e6; // Factor 1e6 converts from cm^3 to m^3
-    }else{
-        return 0;
-    }			
+    real_t R;
+    Eval(IONIZ_LY_OPAQUE, Z0, 1, &n, &T, &R);
+    return R;
 }
 
 /**
@@ -245,30 +258,9 @@ real_t AMJUEL::getIonizLyOpaque(len_t Z0, real_t n, real_t T){
  * T:  Background electron temperature.
  */
 real_t AMJUEL::getIonizLyOpaque_deriv_n(len_t Z0, real_t n, real_t T){
-    if(Z0==0){
-        real_t lnIonizAMJUEL=0;
-        real_t derivFactor=0;
-        
-        real_t lnT=log(T);
-        real_t lnn=log(n/1e14);
-        real_t lnTi=1.0;
-        real_t lnnj=1.0;
-        
-        for(len_t i=0;i<maxTempCoeffsIndex;i++){
-            lnnj=1.0;
-            for(len_t j=0;j<maxDensCoeffsIndex;j++){
-                lnIonizAMJUEL+=ionizLyOpaque[i*maxDensCoeffsIndex+j]*lnTi*lnnj;
-                if(j>0)
-                    derivFactor+=ionizLyOpaque[i*maxDensCoeffsIndex+j]*lnTi*j*lnnj/lnn/n;
-                    
-                lnnj*=lnn;
-            }
-            lnTi=lnT;
-        }
-        return derivFactor*exp(lnIonizAMJUEL)/1e6; // Factor 1e6 converts from cm^3 to m^3
-    }else{
-        return 0;
-    }			
+    real_t R, dRdn;
+    Eval(IONIZ_LY_OPAQUE, Z0, 1, &n, &T, &R, &dRdn);
+    return dRdn;
 }
 
 /**
@@ -280,62 +272,23 @@ real_t AMJUEL::getIonizLyOpaque_deriv_n(len_t Z0, real_t n, real_t T){
  * T:  Background electron temperature.
  */
 real_t AMJUEL::getIonizLyOpaque_deriv_T(len_t Z0, real_t n, real_t T){
-    if(Z0==0){
-        real_t lnIonizAMJUEL=0;
-        real_t derivFactor=0;
-        
-        real_t lnT=log(T);
-        real_t lnn=log(n/1e14);
-        real_t lnTi=1.0;
-        real_t lnnj=1.0;
-        
-        for(len_t i=0;i<maxTempCoeffsIndex;i++){
-            lnnj=1.0;
-            for(len_t j=0;j<maxDensCoeffsIndex;j++){
-                lnIonizAMJUEL+=ionizLyOpaque[i*maxDensCoeffsIndex+j]*lnTi*lnnj;
-                if(i>0)
-                    derivFactor+=ionizLyOpaque[i*maxDensCoeffsIndex+j]*i*lnTi/lnT/T*lnnj;
-                    
-                lnnj*=lnn;
-            }
-            lnTi*=lnT;
-        }
-        return derivFactor*exp(lnIonizAMJUEL)/1e6; // Factor 1e6 converts from cm^3 to m^3
-    }else{
-        return 0;
-    }			
+    real_t R, dRdT;
+    Eval(IONIZ_LY_OPAQUE, Z0, 1, &n, &T, &R, nullptr, &dRdT);
+    return dRdT;
 }
 
 /**
- * Lyman-opaque ionization loss coefficient, including both the potential energy difference 
- * and line radiation during one effective ionization event (which can include several
- * excitation-deexcitation events before the ion/atom is eventually ionized) [m^3 W]
+ * Lyman-opaque ionization loss coefficient [m^3 W], including both
+ * line radiation and the potential energy difference
  *
  * Z0: Charge state (either 0 or 1 as these rates only applies to hydrogen isotopes).
  * n:  Background electron density.
  * T:  Background electron temperature.
  */
 real_t AMJUEL::getIonizLossLyOpaque(len_t Z0, real_t n, real_t T){
-    if(Z0==0){
-        real_t lnIonizLossAMJUEL=0;
-        
-        real_t lnT=log(T);
-        real_t lnn=log(n/1e14);
-        real_t lnTi=1.0;
-        real_t lnnj=1.0;
-        
-        for(len_t i=0;i<maxTempCoeffsIndex;i++){
-            lnnj=1.0;
-            for(len_t j=0;j<maxDensCoeffsIndex;j++){
-                lnIonizLossAMJUEL+=ionizLossLyOpaque[i*maxDensCoeffsIndex+j]*lnTi*lnnj;
-                lnnj*=lnn;
-            }
-            lnTi*=lnT;
-        }
-        return Constants::ec*exp(lnIonizLossAMJUEL)/1e6; // Factor 1e6 converts from cm^3 to m^3
-    }else{
-        return 0;
-    }        			
+    real_t R;
+    Eval(IONIZ_LOSS_LY_OPAQUE, Z0, 1, &n, &T, &R);
+    return R;
 }
 
 /**
@@ -347,30 +300,9 @@ real_t AMJUEL::getIonizLossLyOpaque(len_t Z0, real_t n, real_t T){
  * T:  Background electron temperature.
  */
 real_t AMJUEL::getIonizLossLyOpaque_deriv_n(len_t Z0, real_t n, real_t T){
-    if(Z0==0){
-        real_t lnIonizLossAMJUEL=0;
-        real_t derivFactor=0;
-        
-        real_t lnT=log(T);
-        real_t lnn=log(n/1e14);
-        real_t lnTi=1.0;
-        real_t lnnj=1.0;
-        
-        for(len_t i=0;i<maxTempCoeffsIndex;i++){
-            lnnj=1.0;
-            for(len_t j=0;j<maxDensCoeffsIndex;j++){
-                lnIonizLossAMJUEL+=ionizLossLyOpaque[i*maxDensCoeffsIndex+j]*lnTi*lnnj;
-                if(j>0)
-                    derivFactor+=ionizLossLyOpaque[i*maxDensCoeffsIndex+j]*lnTi*j*lnnj/lnn/n;
-                    
-                lnnj*=lnn;
-            }
-            lnTi*=lnT;
-        }
-        return Constants::ec*derivFactor*exp(lnIonizLossAMJUEL)/1e6; // Factor 1e6 converts from cm^3 to m^3
-    }else{
-        return 0;
-    }        			
+    real_t R, dRdn;
+    Eval(IONIZ_LOSS_LY_OPAQUE, Z0, 1, &n, &T, &R, &dRdn);
+    return dRdn;
 }
 
 /**
@@ -382,29 +314,7 @@ real_t AMJUEL::getIonizLossLyOpaque_deriv_n(len_t Z0, real_t n, real_t T){
  * T:  Background electron temperature.
  */
 real_t AMJUEL::getIonizLossLyOpaque_deriv_T(len_t Z0, real_t n, real_t T){
-    if(Z0==0){
-        real_t lnIonizLossAMJUEL=0;
-        real_t derivFactor=0;
-        
-        real_t lnT=log(T);
-        real_t lnn=log(n/1e14);
-        real_t lnTi=1.0;
-        real_t lnnj=1.0;
-        
-        for(len_t i=0;i<maxTempCoeffsIndex;i++){
-            lnnj=1.0;
-            for(len_t j=0;j<maxDensCoeffsIndex;j++){
-                lnIonizLossAMJUEL+=ionizLossLyOpaque[i*maxDensCoeffsIndex+j]*lnTi*lnnj;
-                if(i>0)
-                    derivFactor+=ionizLossLyOpaque[i*maxDensCoeffsIndex+j]*i*lnTi/lnT/T*lnnj;
-                    
-                lnnj*=lnn;
-            }
-            lnTi*=lnT;
-        }
-        return Constants::ec*derivFactor*exp(lnIonizLossAMJUEL)/1e6; // Factor 1e6 converts from cm^3 to m^3
-    }else{
-        return 0;
-    }        			
+    real_t R, dRdT;
+    Eval(IONIZ_LOSS_LY_OPAQUE, Z0, 1, &n, &T, &R, nullptr, &dRdT);
+    return dRdT;
 }
-
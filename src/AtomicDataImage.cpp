@@ -0,0 +1,313 @@
+/**
+ * Implementation of a precomputed, read-only image of the atomic data
+ * used by DREAM, which can be shared by all simulations running on a
+ * machine.
+ *
+ * The raw ADAS, NIST and AMJUEL tables are compiled into the executable
+ * as constant data, and are therefore already shared between processes
+ * by the operating system. The ADAS rate interpolators however expand
+ * the tables into polynomial coefficients for every cell of the
+ * (log n, log T) grid, which is both the dominant startup cost of a
+ * simulation with impurities and the dominant memory use of the atomic
+ * data (each process otherwise holds its own copy). The image contains
+ * these coefficients for every element and both interpolation methods,
+ * stored as
+ *
+ *   [magic (8 bytes)] [key] [number of entries]
+ *   For each entry:
+ *     [index in ADAS table] [rate] [interpolation method]
+ *     [number of coefficients] [coefficients]
+ *
+ * where all integers are 64-bit. The key identifies the atomic data
+ * tables, the version of DREAM which generated the image and the
+ * precision of the coefficients (see 'ADASRateInterpolator'). The file
+ * is memory-mapped read-only, and the interpolators use the coefficients
+ * directly from the mapping, so that all processes using the same image
+ * share a single copy of the coefficients in physical memory.
+ *
+ * The image is generated with 'dreami -g FILE'.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "DREAM/ADAS.hpp"
+#include "DREAM/adasdata.h"
+#include "DREAM/AtomicDataImage.hpp"
+#include "DREAM/config.h"
+#include "DREAM/nistdata.h"
+#include "FVM/Grid/GeometryCache.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+static const char ATOMIC_DATA_IMAGE_MAGIC[8] = {'D','R','E','A','M','A','D','1'};
+
+// Number of rate coefficients per element (ACD, CCD, SCD, PLT, PRB)
+static const len_t ATOMIC_DATA_IMAGE_NRATES = 5;
+
+
+/**
+ * Constructor.
+ *
+ * filename: Name of the image file.
+ */
+AtomicDataImage::AtomicDataImage(const string& filename)
+    : filename(filename) { }
+
+/**
+ * Destructor.
+ */
+AtomicDataImage::~AtomicDataImage() {
+    if (this->mapping != nullptr)
+        munmap(this->mapping, this->mappingSize);
+}
+
+
+/**
+ * Open the named image file. Every image is only mapped once per
+ * process, and remains mapped until the process exits, so that all
+ * ADAS objects created in the process (e.g. by the simulations of a
+ * batch run) can refer to the same mapping.
+ *
+ * RETURNS the image, or 'nullptr' if the file does not exist or was
+ * not generated from the atomic data tables of this executable.
+ */
+AtomicDataImage *AtomicDataImage::Open(const string& filename) {
+    static mutex registryMutex;
+    static map<string, unique_ptr<AtomicDataImage>> registry;
+
+    lock_guard<mutex> lock(registryMutex);
+
+    auto it = registry.find(filename);
+    if (it != registry.end())
+        return it->second.get();
+
+    unique_ptr<AtomicDataImage> img(new AtomicDataImage(filename));
+    if (!img->Load())
+        return nullptr;
+
+    AtomicDataImage *p = img.get();
+    registry[filename] = std::move(img);
+
+    return p;
+}
+
+
+/**
+ * Returns the key identifying the atomic data tables which are
+ * generated when DREAM is compiled (and are therefore not
+ * identified by the DREAM version). Since the tables never change
+ * while the program is running, the key is only computed once.
+ */
+uint64_t AtomicDataImage::GetSourceKey() {
+    static uint64_t sourceKey = 0;
+    static once_flag computed;
+
+    call_once(computed, []() {
+        FVM::GeometryCache::Hash a;
+        for (len_t i = 0; i < adas_rate_n; i++) {
+            const struct adas_rate &r = adas_rate_table[i];
+            a.Add(string(r.name));
+            a.Add(r.Z); a.Add(r.A);
+
+            a.Add(r.acd_nn); a.Add(r.acd_nT);
+            a.Add(r.acd_n, r.acd_nn); a.Add(r.acd_T, r.acd_nT); a.Add(r.acd, r.Z*r.acd_nn*r.acd_nT);
+            a.Add(r.ccd_nn); a.Add(r.ccd_nT);
+            a.Add(r.ccd_n, r.ccd_nn); a.Add(r.ccd_T, r.ccd_nT); a.Add(r.ccd, r.Z*r.ccd_nn*r.ccd_nT);
+            a.Add(r.scd_nn); a.Add(r.scd_nT);
+            a.Add(r.scd_n, r.scd_nn); a.Add(r.scd_T, r.scd_nT); a.Add(r.scd, r.Z*r.scd_nn*r.scd_nT);
+            a.Add(r.plt_nn); a.Add(r.plt_nT);
+            a.Add(r.plt_n, r.plt_nn); a.Add(r.plt_T, r.plt_nT); a.Add(r.plt, r.Z*r.plt_nn*r.plt_nT);
+            a.Add(r.prb_nn); a.Add(r.prb_nT);
+            a.Add(r.prb_n, r.prb_nn); a.Add(r.prb_T, r.prb_nT); a.Add(r.prb, r.Z*r.prb_nn*r.prb_nT);
+        }
+
+        for (len_t i = 0; i < nist_binding_n; i++) {
+            a.Add(nist_binding_table[i].Z);
+            a.Add(nist_binding_table[i].data, nist_binding_table[i].Z);
+        }
+        for (len_t i = 0; i < nist_ionization_n; i++) {
+            a.Add(nist_ionization_table[i].Z);
+            a.Add(nist_ionization_table[i].data, nist_ionization_table[i].Z);
+        }
+
+        sourceKey = a.Get();
+    });
+
+    return sourceKey;
+}
+
+/**
+ * Returns the key which an image generated by this executable
+ * has. Since the coefficients are computed by DREAM, the key
+ * also identifies the version of DREAM.
+ */
+static uint64_t atomic_data_image_key() {
+    FVM::GeometryCache::Hash h;
+    h.Add(AtomicDataImage::GetSourceKey());
+    h.Add(string(DREAM_GIT_SHA1));
+    h.Add((uint64_t)sizeof(AtomicDataImage::coeff_t));
+
+    return h.Get();
+}
+
+/**
+ * Returns the index identifying the given interpolation
+ * method in the image.
+ */
+len_t AtomicDataImage::GetInterpolationIndex(const gsl_interp2d_type *interp) {
+    return (interp == gsl_interp2d_bilinear ? 0 : 1);
+}
+
+
+/**
+ * (private)
+ * Map the image file into memory and build the index of entries.
+ *
+ * RETURNS true if the image exists and is valid.
+ */
+bool AtomicDataImage::Load() {
+    int fd = open(this->filename.c_str(), O_RDONLY);
+    if (fd < 0)
+        return false;
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < (off_t)(sizeof(ATOMIC_DATA_IMAGE_MAGIC) + 2*sizeof(uint64_t))) {
+        close(fd);
+        return false;
+    }
+
+    // The mapping is shared (and never written), so that all
+    // processes use the same pages of the page cache
+    size_t size = (size_t)st.st_size;
+    void *m = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+
+    if (m == MAP_FAILED)
+        return false;
+
+    const char *p = (const char*)m, *end = p + size;
+    auto readU64 = [&p,&end](uint64_t &v) {
+        if (end-p < (ptrdiff_t)sizeof(uint64_t)) return false;
+        memcpy(&v, p, sizeof(uint64_t));
+        p += sizeof(uint64_t);
+        return true;
+    };
+
+    bool valid = (memcmp(p, ATOMIC_DATA_IMAGE_MAGIC, sizeof(ATOMIC_DATA_IMAGE_MAGIC)) == 0);
+    p += sizeof(ATOMIC_DATA_IMAGE_MAGIC);
+
+    uint64_t fileKey = 0, nEntries = 0;
+    valid = valid && readU64(fileKey) && readU64(nEntries) && (fileKey == atomic_data_image_key());
+
+    map<tuple<len_t, len_t, len_t>, pair<const coeff_t*, len_t>> index;
+    for (uint64_t i = 0; valid && i < nEntries; i++) {
+        uint64_t table, rate, interp, n;
+        if (!readU64(table) || !readU64(rate) || !readU64(interp) || !readU64(n) ||
+            table >= adas_rate_n || rate >= ATOMIC_DATA_IMAGE_NRATES ||
+            (uint64_t)(end-p) < n*sizeof(coeff_t)) {
+            valid = false;
+            break;
+        }
+
+        index[make_tuple((len_t)table, (len_t)rate, (len_t)interp)] = {(const coeff_t*)p, (len_t)n};
+        p += n*sizeof(coeff_t);
+    }
+
+    if (!valid) {
+        munmap(m, size);
+        return false;
+    }
+
+    this->mapping = m;
+    this->mappingSize = size;
+    this->entries = std::move(index);
+
+    return true;
+}
+
+/**
+ * Returns the coefficients of the given rate of the element with
+ * the given index in the ADAS table.
+ *
+ * table:  Index of the element in the ADAS table.
+ * rate:   Index of the rate coefficient (same as in 'ADAS').
+ * interp: Interpolation method (see 'GetInterpolationIndex()').
+ * n:      Expected number of coefficients.
+ *
+ * RETURNS a pointer to the coefficients, or 'nullptr' if they are
+ * not in the image.
+ */
+const AtomicDataImage::coeff_t *AtomicDataImage::Get(
+    const len_t table, const len_t rate, const len_t interp, const len_t n
+) const {
+    auto it = this->entries.find(make_tuple(table, rate, interp));
+    if (it == this->entries.end() || it->second.second != n)
+        return nullptr;
+    else
+        return it->second.first;
+}
+
+
+/**
+ * Generate an image containing the interpolation coefficients of all
+ * rates of all elements in the ADAS database, for both interpolation
+ * methods, and write it to the named file. The data is first written
+ * to a temporary file, which is then moved into place, so that
+ * simulations running simultaneously never see a partially written
+ * image.
+ */
+void AtomicDataImage::Generate(const string& filename) {
+    const gsl_interp2d_type *methods[] = { gsl_interp2d_bilinear, gsl_interp2d_bicubic };
+
+    const string tmpname = filename + "." + to_string(getpid()) + ".tmp";
+    ofstream f(tmpname, ios::binary);
+    if (!f.good())
+        throw AtomicDataImageException("Unable to create image file '%s'.", tmpname.c_str());
+
+    const uint64_t key = atomic_data_image_key();
+    const uint64_t nEntries = 2*adas_rate_n*ATOMIC_DATA_IMAGE_NRATES;
+    f.write(ATOMIC_DATA_IMAGE_MAGIC, sizeof(ATOMIC_DATA_IMAGE_MAGIC));
+    f.write((const char*)&key, sizeof(uint64_t));
+    f.write((const char*)&nEntries, sizeof(uint64_t));
+
+    for (const gsl_interp2d_type *m : methods) {
+        ADAS adas(m);
+        const uint64_t interp = GetInterpolationIndex(m);
+
+        for (len_t i = 0; i < adas_rate_n; i++) {
+            const len_t Z = adas_rate_table[i].Z, A = adas_rate_table[i].A;
+            // Same order as the rate indices in 'ADAS'
+            ADASRateInterpolator *rates[ATOMIC_DATA_IMAGE_NRATES] = {
+                adas.GetACD(Z, A), adas.GetCCD(Z, A), adas.GetSCD(Z, A),
+                adas.GetPLT(Z, A), adas.GetPRB(Z, A)
+            };
+
+            for (len_t r = 0; r < ATOMIC_DATA_IMAGE_NRATES; r++) {
+                const uint64_t table = i, rate = r;
+                const uint64_t n = rates[r]->GetNumberOfCoefficients();
+
+                f.write((const char*)&table, sizeof(uint64_t));
+                f.write((const char*)&rate, sizeof(uint64_t));
+                f.write((const char*)&interp, sizeof(uint64_t));
+                f.write((const char*)&n, sizeof(uint64_t));
+                f.write((const char*)rates[r]->GetCoefficients(), n*sizeof(coeff_t));
+            }
+        }
+    }
+
+    f.close();
+    if (!f.good() || rename(tmpname.c_str(), filename.c_str()) != 0) {
+        remove(tmpname.c_str());
+        throw AtomicDataImageException("Unable to write image file '%s'.", filename.c_str());
+    }
+}
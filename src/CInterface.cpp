@@ -0,0 +1,162 @@
+/**
+ * Implementation of the C interface to DREAM.
+ */
+
+#include <string>
+#include <softlib/SOFTLibException.h>
+#include "DREAM/CInterface.h"
+#include "DREAM/QuitException.hpp"
+#include "DREAM/Settings/SFile.hpp"
+#include "DREAM/Settings/Settings.hpp"
+#include "DREAM/Settings/SimulationGenerator.hpp"
+#include "DREAM/Simulation.hpp"
+
+
+using namespace std;
+
+/**
+ * Simulation object (and its settings) handed out
+ * through the C interface.
+ */
+struct dream_simulation {
+    DREAM::Settings *settings=nullptr;
+    DREAM::Simulation *sim=nullptr;
+};
+
+// Description of the most recent error
+static string dream_error;
+
+/**
+ * Evaluate the given statement, and translate any
+ * C++ exception raised into an error code.
+ */
+#define DREAM_CAPI_TRY(stmt, retval) \
+    try { \
+        stmt; \
+    } catch (DREAM::QuitException& ex) { \
+        dream_error = ex.what(); \
+        return retval; \
+    } catch (DREAM::FVM::FVMException& ex) { \
+        dream_error = ex.what(); \
+        return retval; \
+    } catch (SOFTLibException& ex) { \
+        dream_error = ex.what(); \
+        return retval; \
+    }
+
+/**
+ * Construct a new simulation from the named settings file
+ * (note that 'dream_initialize()' must have been called first).
+ *
+ * RETURNS the simulation, or NULL on error.
+ */
+dream_simulation *dream_simulation_new(const char *settingsfile) {
+    dream_simulation *ds = new dream_simulation;
+
+    try {
+        ds->settings = DREAM::SimulationGenerator::CreateSettings();
+        DREAM::SettingsSFile::LoadSettings(ds->settings, settingsfile);
+        ds->sim = DREAM::SimulationGenerator::ProcessSettings(ds->settings);
+    } catch (DREAM::FVM::FVMException& ex) {
+        dream_error = ex.what();
+        delete ds->settings;
+        delete ds;
+        return nullptr;
+    } catch (SOFTLibException& ex) {
+        dream_error = ex.what();
+        delete ds->settings;
+        delete ds;
+        return nullptr;
+    }
+
+    return ds;
+}
+
+/**
+ * Release all resources used by the given simulation.
+ */
+void dream_simulation_free(dream_simulation *ds) {
+    if (ds == nullptr)
+        return;
+
+    delete ds->sim;
+    delete ds->settings;
+    delete ds;
+}
+
+/**
+ * Advance the simulation to the time 'tTarget' (i.e. to the first
+ * time step on or after 'tTarget').
+ *
+ * running: If not NULL, set to 0 if the simulation has reached its
+ *          final time, and to 1 otherwise.
+ */
+int dream_simulation_step(dream_simulation *ds, double tTarget, int *running) {
+    bool r = false;
+    DREAM_CAPI_TRY(r = ds->sim->Step(tTarget), 1);
+
+    if (running != nullptr)
+        *running = (r ? 1 : 0);
+
+    return 0;
+}
+
+/**
+ * Save the output of the simulation to the file
+ * specified in its settings.
+ */
+int dream_simulation_save(dream_simulation *ds) {
+    DREAM_CAPI_TRY(ds->sim->Save(), 1);
+    return 0;
+}
+
+/**
+ * Returns the current time of the simulation.
+ */
+double dream_simulation_time(dream_simulation *ds) {
+    return ds->sim->GetCurrentTime();
+}
+
+/**
+ * Returns a pointer to the most recent data of the named unknown
+ * quantity (which is updated in place as the simulation advances),
+ * or NULL on error.
+ *
+ * n: If not NULL, set to the number of elements of the data.
+ */
+const double *dream_simulation_get_unknown(dream_simulation *ds, const char *name, long *n) {
+    len_t N = 0;
+    const real_t *data = nullptr;
+    DREAM_CAPI_TRY(data = ds->sim->GetUnknownData(name, &N), nullptr);
+
+    if (n != nullptr)
+        *n = static_cast<long>(N);
+
+    return data;
+}
+
+/**
+ * Returns a pointer to the value of the named prescribed quantity,
+ * or NULL on error. Values written to the data between calls to
+ * 'dream_simulation_step()' replace the prescribed time evolution
+ * of the quantity.
+ *
+ * n: If not NULL, set to the number of elements of the data.
+ */
+double *dream_simulation_get_prescribed(dream_simulation *ds, const char *name, long *n) {
+    len_t N = 0;
+    real_t *data = nullptr;
+    DREAM_CAPI_TRY(data = ds->sim->GetPrescribedData(name, &N), nullptr);
+
+    if (n != nullptr)
+        *n = static_cast<long>(N);
+
+    return data;
+}
+
+/**
+ * Returns a description of the most recent error.
+ */
+const char *dream_last_error() {
+    return dream_error.c_str();
+}
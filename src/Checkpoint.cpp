@@ -0,0 +1,162 @@
+/**
+ * Implementation of a compact binary checkpoint of the state of a
+ * simulation, from which the simulation can later be resumed.
+ *
+ * A checkpoint consists of a list of named arrays of real numbers
+ * (the current and old data of all unknown quantities, the state of
+ * the time stepper etc.), stored as
+ *
+ *   [magic (8 bytes)] [format version] [number of entries]
+ *   For each entry:
+ *     [length of name] [name (padded to a multiple of 8 bytes)]
+ *     [number of elements] [elements]
+ *
+ * where all integers are 64-bit. The checkpoint is first written to a
+ * temporary file, which is then moved into place, so that an existing
+ * checkpoint is never replaced by a partially written one (e.g. if the
+ * simulation is killed while writing).
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <unistd.h>
+#include "DREAM/Checkpoint.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+static const char CHECKPOINT_MAGIC[8] = {'D','R','E','A','M','C','P','1'};
+
+
+/**
+ * Load the named checkpoint file.
+ */
+void Checkpoint::Load(const string& filename) {
+    ifstream f(filename, ios::binary);
+    if (!f.good())
+        throw CheckpointException("Unable to open checkpoint file '%s'.", filename.c_str());
+
+    auto readU64 = [&f]() {
+        uint64_t v = 0;
+        f.read((char*)&v, sizeof(uint64_t));
+        return v;
+    };
+
+    char magic[sizeof(CHECKPOINT_MAGIC)];
+    f.read(magic, sizeof(magic));
+    if (!f.good() || memcmp(magic, CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC)) != 0)
+        throw CheckpointException("'%s' is not a DREAM checkpoint file.", filename.c_str());
+
+    uint64_t version = readU64();
+    if (version != VERSION)
+        throw CheckpointException(
+            "Unsupported checkpoint file format version: %llu (expected %llu).",
+            (unsigned long long)version, (unsigned long long)VERSION
+        );
+
+    uint64_t nEntries = readU64();
+    this->entries.clear();
+    for (uint64_t i = 0; f.good() && i < nEntries; i++) {
+        uint64_t nameLength = readU64();
+        string name(8*((nameLength+7)/8), '\0');
+        f.read(&name[0], name.size());
+        name.resize(nameLength);
+
+        uint64_t n = readU64();
+        if (!f.good())
+            break;
+
+        vector<real_t> &v = this->entries[name];
+        v.resize(n);
+        f.read((char*)v.data(), n*sizeof(real_t));
+    }
+
+    if (!f.good())
+        throw CheckpointException("The checkpoint file '%s' is truncated or corrupt.", filename.c_str());
+}
+
+/**
+ * Write this checkpoint to the named file.
+ */
+void Checkpoint::Save(const string& filename) const {
+    const string tmpname = filename + "." + to_string(getpid()) + ".tmp";
+    ofstream f(tmpname, ios::binary);
+    if (!f.good())
+        throw CheckpointException("Unable to create checkpoint file '%s'.", tmpname.c_str());
+
+    uint64_t version = VERSION, nEntries = this->entries.size();
+    f.write(CHECKPOINT_MAGIC, sizeof(CHECKPOINT_MAGIC));
+    f.write((const char*)&version, sizeof(uint64_t));
+    f.write((const char*)&nEntries, sizeof(uint64_t));
+
+    const char zeros[8] = {0};
+    for (auto it = this->entries.begin(); it != this->entries.end(); it++) {
+        uint64_t nameLength = it->first.size();
+        uint64_t n = it->second.size();
+
+        f.write((const char*)&nameLength, sizeof(uint64_t));
+        f.write(it->first.c_str(), nameLength);
+        f.write(zeros, 8*((nameLength+7)/8) - nameLength);
+        f.write((const char*)&n, sizeof(uint64_t));
+        f.write((const char*)it->second.data(), n*sizeof(real_t));
+    }
+
+    f.close();
+    if (!f.good() || rename(tmpname.c_str(), filename.c_str()) != 0) {
+        remove(tmpname.c_str());
+        throw CheckpointException("Unable to write checkpoint file '%s'.", filename.c_str());
+    }
+}
+
+
+/**
+ * Returns the named array of the checkpoint.
+ */
+const vector<real_t>& Checkpoint::Get(const string& name) const {
+    auto it = this->entries.find(name);
+    if (it == this->entries.end())
+        throw CheckpointException("No entry named '%s' in checkpoint.", name.c_str());
+
+    return it->second;
+}
+
+/**
+ * Returns the named array of the checkpoint, verifying that
+ * it contains exactly 'n' elements.
+ */
+const real_t *Checkpoint::Get(const string& name, const len_t n) const {
+    const vector<real_t> &v = Get(name);
+    if (v.size() != n)
+        throw CheckpointException(
+            "Invalid size of checkpoint entry '%s': " LEN_T_PRINTF_FMT
+            " elements (expected " LEN_T_PRINTF_FMT ").",
+            name.c_str(), (len_t)v.size(), n
+        );
+
+    return v.data();
+}
+
+/**
+ * Returns the named scalar of the checkpoint.
+ */
+real_t Checkpoint::GetScalar(const string& name) const {
+    return *Get(name, 1);
+}
+
+
+/**
+ * Add the given array to the checkpoint.
+ */
+void Checkpoint::Put(const string& name, const real_t *data, const len_t n) {
+    this->entries[name].assign(data, data+n);
+}
+
+/**
+ * Add the given scalar to the checkpoint.
+ */
+void Checkpoint::Put(const string& name, const real_t v) {
+    Put(name, &v, 1);
+}
@@ -1,6 +1,7 @@
 /**
  * Class for comparing solution vector to tolerances (both absolute and
- * relative).
+ * relative). The norms of the solution and of the step are evaluated in
+ * a single pass over the vectors (see 'FVM::NormEvaluator::Norms()').
  */
 
 #include <string>
@@ -28,8 +29,12 @@ ConvergenceChecker::ConvergenceChecker(
     : NormEvaluator(uqh, nontrivials) {
 
     this->nNontrivials = nontrivials.size();
-    this->x_2norm  = new real_t[nNontrivials];
-    this->dx_2norm = new real_t[nNontrivials];
+    this->x_2norm   = new real_t[nNontrivials];
+    this->dx_2norm  = new real_t[nNontrivials];
+    this->dx_wrms   = new real_t[nNontrivials];
+    this->err_ratio = new real_t[nNontrivials];
+    this->abstol    = new real_t[nNontrivials];
+    this->reltol    = new real_t[nNontrivials];
 
     // Set relative tolerance for all
     this->SetRelativeTolerance(reltol);
@@ -42,29 +47,12 @@ ConvergenceChecker::ConvergenceChecker(
  * Destructor.
  */
 ConvergenceChecker::~ConvergenceChecker() {
-    DeallocateBuffer();
-
     delete [] this->x_2norm;
     delete [] this->dx_2norm;
-}
-
-
-/**
- * Allocate memory for the 'dx' buffer.
- */
-void ConvergenceChecker::AllocateBuffer(const len_t size) {
-    if (this->dx_buffer != nullptr)
-        DeallocateBuffer();
-
-    this->dx_buffer = new real_t[size];
-}
-
-/**
- * Deallocate memory for the 'dx' buffer.
- */
-void ConvergenceChecker::DeallocateBuffer() {
-    if (this->dx_buffer != nullptr)
-        delete [] this->dx_buffer;
+    delete [] this->dx_wrms;
+    delete [] this->err_ratio;
+    delete [] this->abstol;
+    delete [] this->reltol;
 }
 
 /**
@@ -115,8 +103,8 @@ const real_t ConvergenceChecker::GetErrorScale(const len_t uqty) {
     len_t idx = std::distance(this->nontrivials.begin(), it);
 
     return
-        this->absTols[idx] +
-        this->relTols[idx]*x_2norm[idx];
+        this->absTols[uqty] +
+        this->relTols[uqty]*x_2norm[idx];
 }
 
 /**
@@ -125,25 +113,39 @@ const real_t ConvergenceChecker::GetErrorScale(const len_t uqty) {
  *
  *   |dx| <= abstol + reltol*|x|
  *
- * where |.| denotes the 2-norm.
+ * where |.| denotes the 2-norm or, with the weighted RMS norm,
+ *
+ *   sqrt[ 1/N sum_i[ (dx_i / (abstol + reltol*|x_i|))^2 ] ] <= 1.
+ *
+ * The step is either given directly, or as the difference 'x1-x2'
+ * between two solutions.
  *
  * x:  Solution vector.
  * dx: Last step 
  */
 bool ConvergenceChecker::IsConverged(const real_t *x, const real_t *x1, const real_t *x2, bool verbose) {
-    const len_t SSIZE = this->unknowns->GetLongVectorSize(this->nontrivials);
-    if (this->dx_size != SSIZE)
-        AllocateBuffer(SSIZE);
+    for (len_t i = 0; i < this->nNontrivials; i++) {
+        this->abstol[i] = this->absTols[this->nontrivials[i]];
+        this->reltol[i] = this->relTols[this->nontrivials[i]];
+    }
 
-    for (len_t i = 0; i < SSIZE; i++)
-        this->dx_buffer[i] = x1[i]-x2[i];
+    this->Norms(
+        x, x1, x2, this->x_2norm, this->dx_2norm, this->abstol, this->reltol,
+        (this->norm == OptionConstants::TOLERANCE_NORM_WRMS ? this->dx_wrms : nullptr)
+    );
 
-    return IsConverged(x, this->dx_buffer, verbose);
+    return CheckNorms(verbose);
 }
 bool ConvergenceChecker::IsConverged(const real_t *x, const real_t *dx, bool verbose) {
-    this->Norm2(x, this->x_2norm);
-    this->Norm2(dx, this->dx_2norm);
+    return IsConverged(x, dx, nullptr, verbose);
+}
 
+/**
+ * Compare the most recently evaluated norms to the tolerances,
+ * and evaluate the ratio of the error to the tolerance for
+ * each unknown.
+ */
+bool ConvergenceChecker::CheckNorms(bool verbose) {
     // Iterate over norms and ensure that all are small
     const len_t N = this->nontrivials.size();
     bool converged = true;
@@ -151,15 +153,25 @@ bool ConvergenceChecker::IsConverged(const real_t *x, const real_t *dx, bool ver
     for (len_t i = 0; i < N; i++) {
 		bool conv = true;
 
-        const real_t epsr = this->relTols[this->nontrivials[i]];
-        const real_t epsa = this->absTols[this->nontrivials[i]];
+        const real_t epsr = this->reltol[i];
+        const real_t epsa = this->abstol[i];
 
         // Is tolerance checking disabled for this quantity?
+        this->err_ratio[i] = 0;
         if (epsr == 0 && epsa == 0)
             continue;
 
-		//if(x_2norm[i]>0)
-        conv = (dx_2norm[i] <= (epsa + epsr*x_2norm[i])); 
+        if (this->norm == OptionConstants::TOLERANCE_NORM_WRMS) {
+            conv = (dx_wrms[i] <= 1);
+            this->err_ratio[i] = dx_wrms[i];
+        } else {
+            const real_t scale = epsa + epsr*x_2norm[i];
+            conv = (dx_2norm[i] <= scale);
+
+            // scale = 0 indicates that |x| = 0, which could be ok
+            if (scale != 0)
+                this->err_ratio[i] = dx_2norm[i] / scale;
+        }
 
         // Guard against infinity...
         if (std::isinf(dx_2norm[i]) || std::isinf(x_2norm[i]))
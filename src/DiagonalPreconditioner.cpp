@@ -10,13 +10,22 @@
  *
  * where 'P' and 'Q' are diagonal matrices. Here, 'P' can be used to rescale
  * equations, while 'Q' is used to normalize the values of unknowns.
+ *
+ * By default, 'P' and 'Q' are built from fixed, characteristic scales of
+ * each unknown quantity and its equation. Optionally, these scalings can
+ * be refined by equilibrating the matrix, i.e. by rescaling each row and
+ * column of the (already rescaled) matrix so that its largest element
+ * has magnitude one.
  */
 
+#include <cmath>
+#include <limits>
 #include <string>
 #include "DREAM/DiagonalPreconditioner.hpp"
 #include "DREAM/DREAMException.hpp"
 #include "DREAM/IO.hpp"
 #include "DREAM/Settings/OptionConstants.hpp"
+#include "FVM/PETScBackend.hpp"
 
 
 using namespace DREAM;
@@ -36,8 +45,8 @@ DiagonalPreconditioner::DiagonalPreconditioner(
     
     const len_t N = unknowns->GetLongVectorSize(nontrivials);
 
-    VecCreateSeq(MPI_COMM_WORLD, N, &this->iuqn);
-    VecCreateSeq(MPI_COMM_WORLD, N, &this->eqn);
+    FVM::PETScBackend::CreateVector(N, &this->iuqn);
+    FVM::PETScBackend::CreateVector(N, &this->eqn);
 
     this->SetDefaultScalings();
 }
@@ -46,6 +55,11 @@ DiagonalPreconditioner::DiagonalPreconditioner(
  * Destructor.
  */
 DiagonalPreconditioner::~DiagonalPreconditioner() {
+    if (this->equilibrate) {
+        VecDestroy(&this->eqn0);
+        VecDestroy(&this->iuqn0);
+    }
+
     VecDestroy(&this->eqn);
     VecDestroy(&this->iuqn);
 }
@@ -76,6 +90,11 @@ void DiagonalPreconditioner::Build() {
 
     VecRestoreArray(this->iuqn, &iq);
     VecRestoreArray(this->eqn, &p);
+
+    if (this->equilibrate) {
+        VecCopy(this->iuqn, this->iuqn0);
+        VecCopy(this->eqn, this->eqn0);
+    }
 }
 
 /**
@@ -206,7 +225,124 @@ void DiagonalPreconditioner::SetDefaultScalings() {
  * unknown rescaling matrix.
  */
 void DiagonalPreconditioner::RescaleMatrix(FVM::Matrix *mat) {
-    mat->DiagonalScale(this->eqn, this->iuqn);
+    if (this->equilibrate && (this->nRescalings++ % this->equilibrateEvery) == 0)
+        this->Equilibrate(mat);
+    else
+        mat->DiagonalScale(this->eqn, this->iuqn);
+}
+
+/**
+ * Enable or disable automatic equilibration of the matrix. Must be
+ * called before 'Build()'.
+ *
+ * enabled: If 'true', enables equilibration.
+ * every:   Number of rescalings after which the equilibration
+ *          scalings are recomputed (in between, the most recently
+ *          computed scalings are reused).
+ */
+void DiagonalPreconditioner::SetEquilibration(const bool enabled, const len_t every) {
+    if (enabled && !this->equilibrate) {
+        VecDuplicate(this->iuqn, &this->iuqn0);
+        VecDuplicate(this->eqn, &this->eqn0);
+    } else if (!enabled && this->equilibrate) {
+        VecDestroy(&this->iuqn0);
+        VecDestroy(&this->eqn0);
+    }
+
+    this->equilibrate = enabled;
+    this->equilibrateEvery = (every == 0 ? 1 : every);
+}
+
+/**
+ * Compute new equilibration scalings from the given matrix and
+ * rescale it. The matrix is first rescaled using the fixed scales
+ * of the unknowns and equations, after which each row is divided
+ * by its largest element (in magnitude), followed by each column.
+ * The resulting scalings are combined with the fixed scales, and
+ * are used for the right-hand side and solution vectors until the
+ * next equilibration.
+ *
+ * mat: Matrix to compute scalings from (and to rescale).
+ */
+void DiagonalPreconditioner::Equilibrate(FVM::Matrix *mat) {
+    const len_t m = mat->GetNRows(), n = mat->GetNCols();
+    mat->DiagonalScale(this->eqn0, this->iuqn0);
+
+    // Row scaling
+    real_t *r = new real_t[m];
+    mat->GetRowMaxAbs(r);
+    this->rowRatioBefore.push_back(RowMaxRatio(r, m));
+
+    for (len_t i = 0; i < m; i++)
+        r[i] = (r[i] == 0 ? 1 : 1/fabs(r[i]));
+
+    real_t *p;
+    VecCopy(this->eqn0, this->eqn);
+    VecGetArray(this->eqn, &p);
+    for (len_t i = 0; i < m; i++)
+        p[i] *= r[i];
+    VecRestoreArray(this->eqn, &p);
+
+    // Column scaling (of the row-equilibrated matrix)
+    Vec rv;
+    VecDuplicate(this->eqn, &rv);
+    VecGetArray(rv, &p);
+    for (len_t i = 0; i < m; i++)
+        p[i] = r[i];
+    VecRestoreArray(rv, &p);
+    mat->DiagonalScale(rv, nullptr);
+    VecDestroy(&rv);
+
+    real_t *c = new real_t[n];
+    MatGetColumnNorms(mat->mat(), NORM_INFINITY, c);
+    for (len_t j = 0; j < n; j++)
+        c[j] = (c[j] == 0 ? 1 : 1/c[j]);
+
+    Vec cv;
+    VecDuplicate(this->iuqn, &cv);
+    VecGetArray(cv, &p);
+    for (len_t j = 0; j < n; j++)
+        p[j] = c[j];
+    VecRestoreArray(cv, &p);
+    mat->DiagonalScale(nullptr, cv);
+    VecPointwiseMult(this->iuqn, this->iuqn0, cv);
+    VecDestroy(&cv);
+
+    mat->GetRowMaxAbs(r);
+    this->rowRatioAfter.push_back(RowMaxRatio(r, m));
+
+    delete [] c;
+    delete [] r;
+}
+
+/**
+ * Returns the ratio of the largest to the smallest (non-zero) element
+ * of the given array of row maxima. This is a (lower bound) estimate
+ * of the condition number of the matrix due to poor scaling alone.
+ */
+real_t DiagonalPreconditioner::RowMaxRatio(const real_t *r, const len_t m) {
+    real_t rmin = std::numeric_limits<real_t>::infinity(), rmax = 0;
+    for (len_t i = 0; i < m; i++) {
+        const real_t v = fabs(r[i]);
+        if (v == 0) continue;
+        if (v < rmin) rmin = v;
+        if (v > rmax) rmax = v;
+    }
+
+    return (rmax == 0 ? 1 : rmax/rmin);
+}
+
+/**
+ * Save the conditioning estimates computed in each
+ * equilibration to the given SFile object.
+ *
+ * sf:   SFile object to save data to.
+ * path: Path in file to save data to.
+ */
+void DiagonalPreconditioner::SaveEquilibrationStatistics(SFile *sf, const string& path) {
+    sf->CreateStruct(path);
+    sf->WriteList(path+"/rowratio_before", this->rowRatioBefore.data(), this->rowRatioBefore.size());
+    sf->WriteList(path+"/rowratio_after", this->rowRatioAfter.data(), this->rowRatioAfter.size());
 }
 
 /**
@@ -2,12 +2,16 @@
  * Equation system initializer.
  */
 
+#include <algorithm>
+#include <cmath>
 #include <gsl/gsl_interp.h>
 #include "DREAM/Equations/CollisionQuantityHandler.hpp"
 #include "DREAM/EqsysInitializer.hpp"
 #include "DREAM/IO.hpp"
 #include "DREAM/Settings/SimulationGenerator.hpp"
+#include "FVM/DurationTimer.hpp"
 #include "FVM/Interpolator3D.hpp"
+#include "FVM/Parallel.hpp"
 
 
 using namespace DREAM;
@@ -113,6 +117,36 @@ void EqsysInitializer::Execute(const real_t t0) {
         order.insert(order.end(), tmp.begin(), tmp.end());
     }
 
+    timings_t timings;
+    FVM::DurationTimer totalTimer;
+    totalTimer.Start();
+
+    if (this->nThreads > 1)
+        this->ExecuteParallel(t0, order, id_ions, timings);
+    else
+        this->ExecuteSerial(t0, order, id_ions, timings);
+
+    totalTimer.Stop();
+    if (this->printTimings)
+        this->PrintTimings(timings, totalTimer.GetMilliseconds());
+
+    // Verfiy that all unknown quantities have now been initialized
+    this->VerifyAllInitialized();
+}
+
+/**
+ * Execute the given initialization rules one by one, in the
+ * order given.
+ *
+ * t0:      Time for which the system should be initialized.
+ * order:   Order in which to execute the rules.
+ * id_ions: ID of the ion density unknown quantity.
+ * timings: List to add the time spent on each rule to.
+ */
+void EqsysInitializer::ExecuteSerial(
+    const real_t t0, const vector<int_t>& order, const int_t id_ions,
+    timings_t& timings
+) {
 	// Vector to store quantities for which a non-linear steady-state
 	// solution should be obtained...
 	vector<len_t> ssQty;
@@ -120,82 +154,262 @@ void EqsysInitializer::Execute(const real_t t0) {
     for (int_t uqtyId : order) {
         struct initrule *rule = this->rules[uqtyId];
 
-        // Verify that all dependences are initialized...
-        /*for (int_t dep : rule->dependencies) {
-            if (dep < 0) continue;
+		// If all equations have been gathered for the next non-linear
+		// solve, it's time to solve the system of equations...
+		if (rule->type != INITRULE_STEADY_STATE_SOLVE && ssQty.size() > 0)
+			this->ExecuteSteadyStateSolve(t0, ssQty, timings);
+
+        if (uqtyId >= 0 && rule->type == INITRULE_STEADY_STATE_SOLVE)
+			ssQty.push_back(uqtyId);
+        else
+            this->ExecuteRule(t0, uqtyId, id_ions, timings);
+    }
+
+	// Non-linear equations to solve before finishing?
+	if (ssQty.size() > 0)
+		this->ExecuteSteadyStateSolve(t0, ssQty, timings);
+}
+
+/**
+ * Execute the given initialization rules using 'nThreads' threads.
+ * The rules are grouped into levels, such that the rules of a level
+ * only depend on rules of preceding levels. Within each level, the
+ * initial values of all unknowns which can be evaluated concurrently
+ * (see 'IsParallelizable()') are first computed in parallel and stored
+ * in the order of 'order'. The remaining rules of the level (special
+ * objects, equations with terms which are not thread-safe, and
+ * steady-state solves) are then executed sequentially.
+ *
+ * t0:      Time for which the system should be initialized.
+ * order:   Order in which the rules would be executed sequentially
+ *          (used to resolve dependencies).
+ * id_ions: ID of the ion density unknown quantity.
+ * timings: List to add the time spent on each rule to.
+ */
+void EqsysInitializer::ExecuteParallel(
+    const real_t t0, const vector<int_t>& order, const int_t id_ions,
+    timings_t& timings
+) {
+    vector<vector<int_t>> levels = this->ConstructExecutionLevels(order);
+
+    for (const vector<int_t>& level : levels) {
+        vector<struct initrule*> par;
+        vector<int_t> ser;
+        vector<len_t> ssQty;
+
+        for (int_t uqtyId : level) {
+            struct initrule *rule = this->rules[uqtyId];
+
+            if (uqtyId >= 0 && rule->type == INITRULE_STEADY_STATE_SOLVE)
+                ssQty.push_back(uqtyId);
+            else if (this->IsParallelizable(rule))
+                par.push_back(rule);
+            else
+                ser.push_back(uqtyId);
+        }
+
+        // Evaluate independent rules concurrently...
+        const len_t nPar = par.size();
+        vector<real_t*> values(nPar, nullptr);
+        vector<real_t> duration(nPar, 0);
+
+        try {
+            FVM::Parallel::For(nPar, this->nThreads, [&](const len_t i) {
+                FVM::DurationTimer timer;
+                timer.Start();
+                values[i] = this->ComputeInitialValue(t0, par[i]);
+                timer.Stop();
+                duration[i] = timer.GetMilliseconds();
+            });
+        } catch (...) {
+            for (real_t *v : values)
+                if (v != nullptr)
+                    delete [] v;
+
+            throw;
+        }
+
+        // ...and store the resulting initial values
+        for (len_t i = 0; i < nPar; i++) {
+            const int_t uqtyId = par[i]->uqtyId;
+            this->unknowns->SetInitialValue(uqtyId, values[i], t0);
+            delete [] values[i];
+
+            timings.push_back({GetQuantityName(uqtyId), duration[i]});
+
+            if (uqtyId == id_ions)
+                ionHandler->Rebuild();
+        }
+
+        for (int_t uqtyId : ser)
+            this->ExecuteRule(t0, uqtyId, id_ions, timings);
+
+        if (ssQty.size() > 0)
+            this->ExecuteSteadyStateSolve(t0, ssQty, timings);
+    }
+}
+
+/**
+ * Execute the specified initialization rule, which must not be of
+ * type 'INITRULE_STEADY_STATE_SOLVE' (unless it applies to a special
+ * object).
+ *
+ * t0:      Time for which the system should be initialized.
+ * uqtyId:  ID of the rule to execute.
+ * id_ions: ID of the ion density unknown quantity.
+ * timings: List to add the time spent on the rule to.
+ */
+void EqsysInitializer::ExecuteRule(
+    const real_t t0, const int_t uqtyId, const int_t id_ions,
+    timings_t& timings
+) {
+    struct initrule *rule = this->rules[uqtyId];
+    FVM::DurationTimer timer;
+    timer.Start();
+
+    // Special object?
+    if (uqtyId < 0) {
+        switch (uqtyId) {
+            case COLLQTYHDL_HOTTAIL:
+                this->cqhHottail->Rebuild();
+                break;
 
-            if (!this->unknowns->HasInitialValue(dep))
+            case COLLQTYHDL_RUNAWAY:
+                this->cqhRunaway->Rebuild();
+                break;
+
+            case RUNAWAY_FLUID:
+                this->runawayFluid->Rebuild();
+                break;
+
+            default:
                 throw EqsysInitializerException(
-                    "Bug in EqsysInitializer: dependency '%s' for '%s' not satisfied.",
-                    this->unknowns->GetUnknown(dep)->GetName().c_str(),
-                    this->unknowns->GetUnknown(uqtyId)->GetName().c_str()
+                    "Unrecognizd ID of special object to initialize: " INT_T_PRINTF_FMT ".",
+                    uqtyId
                 );
-        }*/
+        }
 
-		// If all equations have been gathered for the next non-linear
-		// solve, it's time to solve the system of equations...
-		if (rule->type != INITRULE_STEADY_STATE_SOLVE && ssQty.size() > 0) {
-			this->NonLinearSolve(t0, ssQty);
-			ssQty.clear();
-		}
+    // Regular unknown quantities...
+    } else {
+        switch (rule->type) {
+            case INITRULE_EVAL_EQUATION:
+                this->EvaluateEquation(t0, uqtyId);
+                break;
 
-        // Special object?
-        if (uqtyId < 0) {
-            switch (uqtyId) {
-                case COLLQTYHDL_HOTTAIL:
-                    this->cqhHottail->Rebuild();
-                    break;
+            case INITRULE_EVAL_FUNCTION:
+                this->EvaluateFunction(t0, uqtyId);
+                break;
 
-                case COLLQTYHDL_RUNAWAY:
-                    this->cqhRunaway->Rebuild();
-                    break;
+            default:
+                throw EqsysInitializerException(
+                    "Unrecognized initialization rule type: %d.",
+                    rule->type
+                );
+        }
+        // when ions have been initialized, initialize the ionHandler
+        if(uqtyId==id_ions) 
+            ionHandler->Rebuild();
+    }
 
-                case RUNAWAY_FLUID:
-                    this->runawayFluid->Rebuild();
-                    break;
+    timer.Stop();
+    timings.push_back({GetQuantityName(uqtyId), timer.GetMilliseconds()});
+}
 
-                default:
-                    throw EqsysInitializerException(
-                        "Unrecognizd ID of special object to initialize: " INT_T_PRINTF_FMT ".",
-                        uqtyId
-                    );
-            }
+/**
+ * Solve for the steady state of the given unknown quantities
+ * and clear the list.
+ */
+void EqsysInitializer::ExecuteSteadyStateSolve(
+    const real_t t0, vector<len_t>& ssQty, timings_t& timings
+) {
+    FVM::DurationTimer timer;
+    timer.Start();
 
-        // Regular unknown quantities...
-        } else {
-            switch (rule->type) {
-                case INITRULE_EVAL_EQUATION:
-                    this->EvaluateEquation(t0, uqtyId);
-                    break;
+    this->NonLinearSolve(t0, ssQty);
 
-                case INITRULE_EVAL_FUNCTION:
-                    this->EvaluateFunction(t0, uqtyId);
-                    break;
+    timer.Stop();
 
-                case INITRULE_STEADY_STATE_SOLVE:
-					ssQty.push_back(uqtyId);
-                    break;
+    string name = "steady state (";
+    for (len_t i = 0; i < ssQty.size(); i++)
+        name += (i > 0 ? ", " : "") + string(GetQuantityName((int_t)ssQty[i]));
+    name += ")";
 
-                default:
-                    throw EqsysInitializerException(
-                        "Unrecognized initialization rule type: %d.",
-                        rule->type
-                    );
-            }
-            // when ions have been initialized, initialize the ionHandler
-            if(uqtyId==id_ions) 
-                ionHandler->Rebuild();
+    timings.push_back({name, timer.GetMilliseconds()});
+    ssQty.clear();
+}
+
+/**
+ * Group the rules of the given execution order into levels, so
+ * that each rule is placed in the level following the last of its
+ * dependencies. Only dependencies which appear earlier in 'order'
+ * are considered (the remaining dependencies have already been
+ * given an initial value). Within each level, the rules appear in
+ * the same order as in 'order'.
+ *
+ * order: Sequential execution order (as constructed by
+ *        'ConstructExecutionOrder()').
+ */
+vector<vector<int_t>> EqsysInitializer::ConstructExecutionLevels(
+    const vector<int_t>& order
+) {
+    vector<vector<int_t>> levels;
+    unordered_map<int_t, len_t> levelOf;
+
+    for (int_t uqtyId : order) {
+        len_t lvl = 0;
+        for (int_t dep : this->rules[uqtyId]->dependencies) {
+            auto it = levelOf.find(dep);
+            if (it != levelOf.end() && it->second+1 > lvl)
+                lvl = it->second+1;
         }
+
+        levelOf[uqtyId] = lvl;
+        if (lvl >= levels.size())
+            levels.resize(lvl+1);
+        levels[lvl].push_back(uqtyId);
     }
 
-	// Non-linear equations to solve before finishing?
-	if (ssQty.size() > 0) {
-		this->NonLinearSolve(t0, ssQty);
-		ssQty.clear();
-	}
+    return levels;
+}
 
-    // Verfiy that all unknown quantities have now been initialized
-    this->VerifyAllInitialized();
+/**
+ * Returns 'true' if the initial value given by the specified rule
+ * can be evaluated concurrently with those of other rules. This is
+ * the case for initialization functions, and for equations which
+ * only consist of thread-safe terms (i.e. terms which do not modify
+ * any state shared with other equations when rebuilt). Equations
+ * whose terms modify shared objects (see
+ * 'FVM::EquationTerm::GetSharedObjects()') are evaluated serially.
+ */
+bool EqsysInitializer::IsParallelizable(const struct initrule *rule) const {
+    if (rule->uqtyId < 0)
+        return false;
+    else if (rule->type == INITRULE_EVAL_FUNCTION)
+        return true;
+    else if (rule->type == INITRULE_EVAL_EQUATION) {
+        const UnknownQuantityEquation *eqn = this->unknown_equations->at(rule->uqtyId);
+        if (!eqn->IsThreadSafe())
+            return false;
+
+        vector<const void*> objs;
+        eqn->GetSharedObjects(objs);
+        return objs.empty();
+    }
+    else
+        return false;
+}
+
+/**
+ * Print the time spent on initializing each quantity.
+ *
+ * timings: Time spent on each rule.
+ * total:   Total time spent on executing the rules (in ms).
+ */
+void EqsysInitializer::PrintTimings(const timings_t& timings, const real_t total) {
+    DREAM::IO::PrintInfo("Initialization timings (" LEN_T_PRINTF_FMT " threads):", this->nThreads);
+    for (auto &t : timings)
+        DREAM::IO::PrintInfo("  %-40s %10.3f ms", t.first.c_str(), t.second);
+    DREAM::IO::PrintInfo("  %-40s %10.3f ms", "Total", total);
 }
 
 /**
@@ -282,14 +496,30 @@ void EqsysInitializer::InitializeFromOutput(
 ) {
     SFile *sf = SFile::Create(filename, SFILE_MODE_READ);
 
-    this->InitializeFromOutput(sf, t0, tidx, ions, ignoreList);
+    // From HDF5 files, only read the time step to initialize from
+    OutputSliceReader *slices = nullptr;
+    if (OutputSliceReader::IsHDF5(filename))
+        slices = new OutputSliceReader(filename);
+
+    this->InitializeFromOutput(sf, t0, tidx, ions, ignoreList, slices);
+
+    if (slices != nullptr)
+        delete slices;
 
     sf->Close();
     delete sf;
 }
+
+/**
+ * Initialize the unknown quantities from the given output file.
+ *
+ * slices: If not 'nullptr', used to read only the requested time
+ *         step of each quantity from the file (instead of reading
+ *         all time steps with 'sf').
+ */
 void EqsysInitializer::InitializeFromOutput(
     SFile *sf, const real_t t0, int_t tidx, IonHandler *ions,
-    vector<string>& ignoreList
+    vector<string>& ignoreList, OutputSliceReader *slices
 ) {
     sfilesize_t nr, nt, np1_hot, np2_hot, np1_re, np2_re;
     enum OptionConstants::momentumgrid_type
@@ -297,7 +527,12 @@ void EqsysInitializer::InitializeFromOutput(
 
     // Load grids
     real_t *r = sf->GetList("grid/r", &nr);
-    real_t *t = sf->GetList("grid/t", &nt);
+    // (only the number of time steps is needed)
+    real_t *t = nullptr;
+    if (slices != nullptr)
+        slices->GetDimensions("grid/t", 1, &nt);
+    else
+        t = sf->GetList("grid/t", &nt);
     real_t *hot_p1 = nullptr, *hot_p2 = nullptr;
     real_t *re_p1  = nullptr, *re_p2  = nullptr;
 
@@ -312,6 +547,32 @@ void EqsysInitializer::InitializeFromOutput(
         momtype_re = (enum OptionConstants::momentumgrid_type)sf->GetInt("grid/runaway/type");
     }
 
+    // Remap radial profiles conservatively?
+    this->remapOffset.clear();
+    this->remapIndex.clear();
+    this->remapWeight.clear();
+    if (this->conservativeRemap && nr > 1) {
+        if (!sf->HasVariable("grid/r_f") || !sf->HasVariable("grid/VpVol"))
+            throw EqsysInitializerException(
+                "Initializing from output: Conservative remapping requires the "
+                "radial flux grid and volume elements ('grid/r_f' and 'grid/VpVol') "
+                "to be stored in the output."
+            );
+
+        sfilesize_t nr_f, nVpVol;
+        real_t *r_f   = sf->GetList("grid/r_f", &nr_f);
+        real_t *VpVol = sf->GetList("grid/VpVol", &nVpVol);
+        if (nr_f != nr+1 || nVpVol != nr)
+            throw EqsysInitializerException(
+                "Initializing from output: Invalid size of 'grid/r_f' or 'grid/VpVol'."
+            );
+
+        this->SetRadialRemap(nr, r_f, VpVol);
+
+        delete [] VpVol;
+        delete [] r_f;
+    }
+
     // Shift time index if negative
     if (tidx < 0)
         tidx = nt+tidx;
@@ -343,13 +604,20 @@ void EqsysInitializer::InitializeFromOutput(
                 uqn->GetName().c_str(), sf->filename.c_str()
             );
 
-        // Get data
+        // Get data (if only the requested time step is
+        // read, it is at index 0 of the data)
         sfilesize_t dims[4], ndims;
-        real_t *data = sf->GetMultiArray_linear(name, 4, ndims, dims);
+        real_t *data;
+        int_t didx = tidx;
+        if (slices != nullptr) {
+            data = slices->GetTimeSlice(name, (len_t)tidx, 4, ndims, dims);
+            didx = 0;
+        } else
+            data = sf->GetMultiArray_linear(name, 4, ndims, dims);
 
         // Time + radius
         if (ndims == 2) {
-            this->__InitTR(uqn, t0, tidx, nr, r, data, dims);
+            this->__InitTR(uqn, t0, didx, nr, r, data, dims);
 
         // Time + multiples + radius
         } else if (ndims == 3) {
@@ -381,11 +649,11 @@ void EqsysInitializer::InitializeFromOutput(
             // many points in the third dimension as there are points on
             // the input radial grid), treat it as (time, multiples, radius)
             if (nr == 1 || dims[2] == nr)
-                this->__InitTRmult(uqn, t0, tidx, nr, r, data, dims);
+                this->__InitTRmult(uqn, t0, didx, nr, r, data, dims);
             // Else, if this is a set of scalar quantities (such as SPI
             // shard quantities), treat it as (time, multiples, 1)
             else if (dims[2] == 1)
-                this->__InitTRmult(uqn, t0, tidx, 1, r, data, dims);
+                this->__InitTRmult(uqn, t0, didx, 1, r, data, dims);
 
         // Time + radius + momentum
         } else if (ndims == 4) {
@@ -399,7 +667,7 @@ void EqsysInitializer::InitializeFromOutput(
                     throw EqsysInitializerException("Initializing from output '%s': invalid size of dimension 3. Size was " LEN_T_PRINTF_FMT ", expected " LEN_T_PRINTF_FMT ".", name.c_str(), dims[3], np1_hot);
 
                 this->__InitTR2P(
-                    uqn, t0, tidx, r, hot_p1, hot_p2,
+                    uqn, t0, didx, r, hot_p1, hot_p2,
                     data, dims, momtype_hot, this->hottail_type
                 );
             // Runaway
@@ -412,7 +680,7 @@ void EqsysInitializer::InitializeFromOutput(
                     throw EqsysInitializerException("Initializing from output '%s': invalid size of dimension 3. Size was " LEN_T_PRINTF_FMT ", expected " LEN_T_PRINTF_FMT ".", name.c_str(), dims[3], np1_re);
 
                 this->__InitTR2P(
-                    uqn, t0, tidx, r, re_p1, re_p2,
+                    uqn, t0, didx, r, re_p1, re_p2,
                     data, dims, momtype_re, this->runaway_type
                 );
             } else
@@ -433,8 +701,12 @@ void EqsysInitializer::InitializeFromOutput(
         delete [] data;
     }
 
+    this->remapOffset.clear();
+    this->remapIndex.clear();
+    this->remapWeight.clear();
+
     delete [] r;
-    delete [] t;
+    if (t != nullptr) delete [] t;
 
     if (hot_p1 != nullptr) delete [] hot_p1;
     if (hot_p2 != nullptr) delete [] hot_p2;
@@ -515,6 +787,11 @@ void EqsysInitializer::__InitTR(
                     intpdata[j*NR + i] = d[j];
         }
 
+    // Remap conservatively in radius
+    } else if (CanRemapR(uqn)) {
+        intpdata = new real_t[nmult*NR];
+        this->RemapR(nr, d, intpdata, nmult, 1);
+
     // Interpolate in radius
     } else {
         // Regular fluid quantities...
@@ -579,6 +856,10 @@ void EqsysInitializer::__InitTRmult(
         for (len_t j = 0; j < nmult; j++)
             for (len_t i = 0; i < NR; i++)
                 intpdata[j*NR + i] = d[j];
+    // Remap conservatively in radius
+    } else if (CanRemapR(uqn)) {
+        intpdata = new real_t[nmult*NR];
+        this->RemapR(nr, d, intpdata, nmult, 1);
     // Interpolate in radius
     } else {
         intpdata = SimulationGenerator::InterpolateIonR(
@@ -622,6 +903,28 @@ void EqsysInitializer::__InitTR2P(
     const real_t
         *d = data + tidx*(nr*np1*np2);
 
+    // If the momentum grid is unchanged, remap conservatively in
+    // radius (separately in every momentum cell)
+    FVM::Grid *grid = uqn->GetGrid();
+    if (CanRemapR(uqn) && momtype == uqn_momtype && grid->HasRadiallyUniformMomentumGrid()) {
+        const FVM::MomentumGrid *mg = grid->GetMomentumGrid(0);
+        const real_t tol = 1e-10;
+        bool sameGrid = (mg->GetNp1() == np1 && mg->GetNp2() == np2);
+        for (len_t i = 0; sameGrid && i < np1; i++)
+            sameGrid = (fabs(mg->GetP1(i)-p1[i]) <= tol*std::max((real_t)1, fabs(p1[i])));
+        for (len_t j = 0; sameGrid && j < np2; j++)
+            sameGrid = (fabs(mg->GetP2(j)-p2[j]) <= tol*std::max((real_t)1, fabs(p2[j])));
+
+        if (sameGrid) {
+            real_t *intp = new real_t[grid->GetNr()*np1*np2];
+            this->RemapR(nr, d, intp, 1, np1*np2);
+            uqn->SetInitialValue(intp, t0);
+
+            delete [] intp;
+            return;
+        }
+    }
+
     enum FVM::Interpolator3D::interp_method interp_meth =
         FVM::Interpolator3D::INTERP_LINEAR;
 
@@ -648,6 +951,106 @@ void EqsysInitializer::__InitTR2P(
     delete interp;
 }
 
+/**
+ * Set up the weights for conservatively remapping radial profiles
+ * from the given radial grid onto the radial grid of the simulation.
+ * Every cell of the simulation is assigned the volume average of the
+ * profile over the cells it overlaps, with the volume of each overlap
+ * taken from the volume elements of the input grid, so that the
+ * volume integral of the profile is conserved. Cells lying outside
+ * the input grid take the value of the nearest input cell.
+ *
+ * nr:    Number of cells on the input radial grid.
+ * r_f:   Radial flux grid of the input (size nr+1).
+ * VpVol: Volume elements of the input radial grid (size nr).
+ */
+void EqsysInitializer::SetRadialRemap(
+    const len_t nr, const real_t *r_f, const real_t *VpVol
+) {
+    const FVM::RadialGrid *rgrid = this->fluidGrid->GetRadialGrid();
+    const len_t NR = rgrid->GetNr();
+    const real_t *R_f = rgrid->GetR_f();
+
+    this->remapOffset.resize(NR+1);
+    for (len_t ir = 0, k = 0; ir < NR; ir++) {
+        const len_t i0 = this->remapIndex.size();
+        this->remapOffset[ir] = i0;
+
+        // Skip input cells lying entirely below this cell
+        while (k+1 < nr && r_f[k+1] <= R_f[ir])
+            k++;
+
+        real_t wsum = 0;
+        for (len_t kk = k; kk < nr && r_f[kk] < R_f[ir+1]; kk++) {
+            const real_t l = std::min(R_f[ir+1], r_f[kk+1]) - std::max(R_f[ir], r_f[kk]);
+            if (l <= 0)
+                continue;
+
+            this->remapIndex.push_back(kk);
+            this->remapWeight.push_back(l*VpVol[kk]);
+            wsum += l*VpVol[kk];
+        }
+
+        if (wsum > 0) {
+            for (len_t i = i0; i < this->remapWeight.size(); i++)
+                this->remapWeight[i] /= wsum;
+        } else {
+            this->remapIndex.resize(i0);
+            this->remapWeight.resize(i0);
+            this->remapIndex.push_back(k);
+            this->remapWeight.push_back(1);
+        }
+    }
+    this->remapOffset[NR] = this->remapIndex.size();
+}
+
+/**
+ * Returns 'true' if the given unknown quantity can be
+ * remapped conservatively in radius.
+ */
+bool EqsysInitializer::CanRemapR(FVM::UnknownQuantity *uqn) const {
+    return (
+        !this->remapOffset.empty() &&
+        uqn->GetGrid()->GetRadialGrid() == this->fluidGrid->GetRadialGrid()
+    );
+}
+
+/**
+ * Remap the given data conservatively from the radial grid of
+ * the output onto the radial grid of the simulation (using the
+ * weights set up by 'SetRadialRemap()').
+ *
+ * nr:         Number of cells on the input radial grid.
+ * x:          Data to remap, of size nMultiples*nr*blockSize.
+ * y:          On return, contains the remapped data (of size
+ *             nMultiples*NR*blockSize, with NR the number of
+ *             cells on the radial grid of the simulation).
+ * nMultiples: Number of radial profiles in 'x' (e.g. the number
+ *             of ion charge states).
+ * blockSize:  Number of values per radius in every profile (e.g.
+ *             the number of momentum cells).
+ */
+void EqsysInitializer::RemapR(
+    const len_t nr, const real_t *x, real_t *y,
+    const len_t nMultiples, const len_t blockSize
+) const {
+    const len_t NR = this->remapOffset.size()-1;
+    for (len_t j = 0; j < nMultiples; j++) {
+        for (len_t ir = 0; ir < NR; ir++) {
+            real_t *yr = y + (j*NR + ir)*blockSize;
+            for (len_t m = 0; m < blockSize; m++)
+                yr[m] = 0;
+
+            for (len_t i = this->remapOffset[ir]; i < this->remapOffset[ir+1]; i++) {
+                const real_t *xk = x + (j*nr + this->remapIndex[i])*blockSize;
+                const real_t w = this->remapWeight[i];
+                for (len_t m = 0; m < blockSize; m++)
+                    yr[m] += w*xk[m];
+            }
+        }
+    }
+}
+
 /**
  * Remove any initialization rule for the specified quantity
  * if it exists.
@@ -698,23 +1101,7 @@ void EqsysInitializer::VerifyAllInitialized() const {
  * uqtyId: ID of unknown quantity to evaluate equation for.
  */
 void EqsysInitializer::EvaluateEquation(const real_t t0, const int_t uqtyId) {
-    UnknownQuantityEquation *eqn = this->unknown_equations->at(uqtyId);
-
-    if (!eqn->IsEvaluable())
-        throw EqsysInitializerException(
-            "Unable to initialize '%s': equation is not evaluable.",
-            this->unknowns->GetUnknown(uqtyId)->GetName().c_str()
-        );
-    
-    // Construct vector for temporary storage of quantity value
-    const len_t N = eqn->NumberOfElements();
-    real_t *vec = new real_t[N];
-    for (len_t i = 0; i < N; i++)
-        vec[i] = 0.0;
-
-    // Evaluate equation
-    eqn->RebuildEquations(t0, 0, unknowns);
-    eqn->Evaluate(uqtyId, vec, unknowns);
+    real_t *vec = this->ComputeInitialValue(t0, this->rules[uqtyId]);
 
     // Store initial value
     this->unknowns->SetInitialValue(uqtyId, vec, t0);
@@ -730,10 +1117,37 @@ void EqsysInitializer::EvaluateEquation(const real_t t0, const int_t uqtyId) {
  * uqtyId: ID of the unknown quantity to initialize.
  */
 void EqsysInitializer::EvaluateFunction(const real_t t0, const int_t uqtyId) {
-    struct initrule *rule = this->rules[uqtyId];
+    real_t *vec = this->ComputeInitialValue(t0, this->rules[uqtyId]);
+
+    // Store initial value
+    this->unknowns->SetInitialValue(uqtyId, vec, t0);
+
+    delete [] vec;
+}
+
+/**
+ * Compute the initial value of the unknown quantity to which the
+ * given rule applies, either by evaluating its equation or its
+ * initialization function. The value is not stored in the
+ * unknown quantity handler, so that this method may be called
+ * concurrently for independent rules (see 'IsParallelizable()').
+ *
+ * t0:   Time for which the system should be initialized.
+ * rule: Rule of type 'INITRULE_EVAL_EQUATION' or 'INITRULE_EVAL_FUNCTION'
+ *       to compute the initial value for.
+ *
+ * RETURNS a newly allocated array containing the initial value.
+ */
+real_t *EqsysInitializer::ComputeInitialValue(const real_t t0, const struct initrule *rule) {
+    const int_t uqtyId = rule->uqtyId;
     UnknownQuantityEquation *eqn = this->unknown_equations->at(uqtyId);
 
-    if (!rule->init)
+    if (rule->type == INITRULE_EVAL_EQUATION && !eqn->IsEvaluable())
+        throw EqsysInitializerException(
+            "Unable to initialize '%s': equation is not evaluable.",
+            this->unknowns->GetUnknown(uqtyId)->GetName().c_str()
+        );
+    else if (rule->type == INITRULE_EVAL_FUNCTION && !rule->init)
         throw EqsysInitializerException(
             "Unable to initialize '%s': no initialization function given.",
             this->unknowns->GetUnknown(uqtyId)->GetName().c_str()
@@ -744,13 +1158,16 @@ void EqsysInitializer::EvaluateFunction(const real_t t0, const int_t uqtyId) {
     real_t *vec = new real_t[N];
     for (len_t i = 0; i < N; i++)
         vec[i] = 0.0;
-    
-    // Evaluate the unknown quantity
-    rule->init(this->unknowns, vec);
 
-    // Store initial value
-    this->unknowns->SetInitialValue(uqtyId, vec, t0);
+    if (rule->type == INITRULE_EVAL_EQUATION) {
+        // Evaluate equation
+        eqn->RebuildEquations(t0, 0, unknowns);
+        eqn->Evaluate(uqtyId, vec, unknowns);
+    } else {
+        // Evaluate the unknown quantity
+        rule->init(this->unknowns, vec);
+    }
 
-    delete [] vec;
+    return vec;
 }
 
@@ -27,6 +27,9 @@ void EqsysInitializer::NonLinearSolve(const real_t t0, vector<len_t>& ssQty) {
 	);
 	snl->SetSPIHandler(eqsys->GetSPIHandler());
 	snl->SetIonHandler(eqsys->GetIonHandler());
+	// Steady-state solves often fail to converge from a poor
+	// initial guess with plain Newton iterations
+	snl->SetPseudoTransient(this->solver_pseudotransient);
 
 	// Calculate number of rows in matrix...
 	len_t matrix_size = 0;
@@ -0,0 +1,124 @@
+/**
+ * This file implements member methods of 'EquationSystem' used for
+ * writing checkpoints of the simulation state, and for resuming
+ * simulations from such checkpoints.
+ *
+ * A checkpoint contains the current data of all unknown quantities,
+ * together with the old time steps needed for evaluating time
+ * derivatives (and for rolling back steps), as well as the state of
+ * the time stepper. All other state of the simulation (e.g. the shard
+ * positions and radii of an SPI, which are unknown quantities) is
+ * derived from these when the equation system is rebuilt. Checkpoints
+ * are only written after time steps which are saved to the output,
+ * since the time steppers are then in a well-defined state.
+ */
+
+#include <string>
+#include <vector>
+#include "DREAM/Checkpoint.hpp"
+#include "DREAM/EquationSystem.hpp"
+#include "DREAM/IO.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Write a checkpoint if enough saved steps have been taken, or
+ * enough time has passed, since the previous checkpoint. Failing to
+ * write a checkpoint is not considered an error.
+ *
+ * t: Time of the most recently saved step.
+ */
+void EquationSystem::UpdateCheckpoint(const real_t t) {
+    this->stepsSinceCheckpoint++;
+
+    bool write =
+        (this->checkpointSteps > 0 && this->stepsSinceCheckpoint >= this->checkpointSteps) ||
+        (this->checkpointInterval > 0 && this->checkpointTimer.GetMicroseconds() >= this->checkpointInterval*60e6);
+
+    if (!write)
+        return;
+
+    try {
+        this->SaveCheckpoint(this->checkpointFile, t);
+    } catch (FVM::FVMException& ex) {
+        DREAM::IO::PrintWarning("Unable to write checkpoint: %s", ex.what());
+    }
+
+    this->stepsSinceCheckpoint = 0;
+    this->checkpointTimer.Reset();
+}
+
+/**
+ * Write a checkpoint of the current state of the simulation.
+ *
+ * filename: Name of checkpoint file to write.
+ * t:        Current simulation time.
+ */
+void EquationSystem::SaveCheckpoint(const string& filename, const real_t t) {
+    Checkpoint cp;
+    cp.Put("time", t);
+
+    for (len_t i = 0; i < this->unknowns.Size(); i++) {
+        FVM::UnknownQuantity *uqn = this->unknowns[i];
+        FVM::QuantityData *qd = uqn->GetQuantityData();
+        const string prefix = "unknowns/" + uqn->GetName() + "/";
+        const len_t N = qd->Size(), nBuffers = qd->GetNSaveOldSteps();
+
+        vector<real_t> olddata(nBuffers*N), oldtime(nBuffers);
+        for (len_t j = 0; j < nBuffers; j++) {
+            const real_t *od = qd->GetOldData(j);
+            for (len_t k = 0; k < N; k++)
+                olddata[j*N + k] = od[k];
+
+            oldtime[j] = qd->GetOldTime(j);
+        }
+
+        cp.Put(prefix + "data", qd->Get(), N);
+        cp.Put(prefix + "olddata", olddata.data(), nBuffers*N);
+        cp.Put(prefix + "oldtime", oldtime.data(), nBuffers);
+        cp.Put(prefix + "nold", (real_t)qd->GetNOldSaved());
+    }
+
+    this->timestepper->SaveCheckpoint(cp);
+
+    cp.Save(filename);
+}
+
+/**
+ * Restore the state of the simulation from the named checkpoint
+ * file. The checkpoint must have been written by a simulation
+ * with the same settings (in particular the same grids and
+ * time stepper).
+ *
+ * RETURNS the simulation time of the checkpoint.
+ */
+real_t EquationSystem::LoadCheckpoint(const string& filename) {
+    Checkpoint cp;
+    cp.Load(filename);
+
+    const real_t t = cp.GetScalar("time");
+    for (len_t i = 0; i < this->unknowns.Size(); i++) {
+        FVM::UnknownQuantity *uqn = this->unknowns[i];
+        FVM::QuantityData *qd = uqn->GetQuantityData();
+        const string prefix = "unknowns/" + uqn->GetName() + "/";
+        const len_t N = qd->Size();
+
+        const vector<real_t> &oldtime = cp.Get(prefix + "oldtime");
+        const len_t nBuffers = oldtime.size();
+
+        qd->RestoreState(
+            cp.Get(prefix + "data", N), t,
+            cp.Get(prefix + "olddata", nBuffers*N), oldtime.data(),
+            nBuffers, (len_t)cp.GetScalar(prefix + "nold")
+        );
+    }
+
+    this->timestepper->LoadCheckpoint(cp);
+
+    DREAM::IO::PrintInfo("Resuming simulation from checkpoint '%s' at t = %.6e s.", filename.c_str(), t);
+
+    return t;
+}
@@ -2,15 +2,21 @@
  * Implementation the EquationSystem class.
  */
 
+#include <algorithm>
 #include <iostream>
 #include <string>
 #include <softlib/Timer.h>
 #include "DREAM/EquationSystem.hpp"
 #include "DREAM/IO.hpp"
+#include "DREAM/OutputGenerator.hpp"
 #include "DREAM/QuitException.hpp"
 #include "DREAM/Settings/OptionConstants.hpp"
 #include "DREAM/Solver/SolverLinearlyImplicit.hpp"
+#include "FVM/Equation/PrescribedParameter.hpp"
+#include "FVM/MemoryAccounting.hpp"
 #include "FVM/QuantityData.hpp"
+#include "FVM/TermTimings.hpp"
+#include "FVM/Tracer.hpp"
 
 
 using namespace DREAM;
@@ -46,11 +52,19 @@ EquationSystem::~EquationSystem() {
         delete this->solver;
     if (this->timestepper != nullptr)
         delete this->timestepper;
+    if (this->solveTimer != nullptr)
+        delete this->solveTimer;
 
     if (this->cqh_hottail != nullptr)
         delete this->cqh_hottail;
     if (this->cqh_runaway != nullptr)
         delete this->cqh_runaway;
+    if (this->lnLambdaCache != nullptr)
+        delete this->lnLambdaCache;
+    if (this->collFreqCache != nullptr)
+        delete this->collFreqCache;
+    if (this->adasRateCache != nullptr)
+        delete this->adasRateCache;
 
     if (this->REFluid != nullptr)
         delete this->REFluid;
@@ -61,6 +75,8 @@ EquationSystem::~EquationSystem() {
     
     if (this->postProcessor != nullptr)
         delete this->postProcessor;
+    if (this->outputStream != nullptr)
+        delete this->outputStream;
 }
 
 /**
@@ -156,6 +172,28 @@ void EquationSystem::SetInitialValue(const len_t id, const real_t *val, const re
     this->unknowns.SetInitialValue(id, val, t0);
 }
 
+/**
+ * Returns a pointer to the externally settable data of the specified
+ * prescribed unknown quantity. Values written to the returned buffer
+ * replace the prescribed time evolution of the quantity in all
+ * subsequent time steps (see 'PrescribedParameter::GetExternalData()').
+ *
+ * id: ID of the prescribed unknown quantity.
+ */
+real_t *EquationSystem::GetPrescribedData(const len_t id) {
+    FVM::PrescribedParameter *pp = dynamic_cast<FVM::PrescribedParameter*>(
+        this->unknown_equations.at(id)->GetPredetermined()
+    );
+
+    if (pp == nullptr)
+        throw EquationSystemException(
+            "The unknown quantity '%s' is not a prescribed parameter.",
+            this->unknowns.GetUnknown(id)->GetName().c_str()
+        );
+
+    return pp->GetExternalData();
+}
+
 /**
  * Set the equation solver for this system.
  * Note that this method must be called only AFTER 'ProcessSystem()'
@@ -172,76 +210,229 @@ void EquationSystem::SetSolver(Solver *solver) {
 }
 
 /**
- * Solve this equation system.
+ * Solve this equation system (in parallel in time, with the
+ * parareal method, if enabled and run on several MPI processes).
  */
 void EquationSystem::Solve() {
+    if (this->IsParareal()) {
+        PetscMPIInt nproc;
+        MPI_Comm_size(PETSC_COMM_WORLD, &nproc);
+
+        if (nproc > 1) {
+            this->SolveParareal();
+            return;
+        }
+    }
+
+    this->BeginSolve();
+
+    try {
+        while (!this->IsFinished())
+            this->TakeStep();
+    } catch (...) {
+        if (!this->statusFile.empty())
+            this->WriteStatus("failed", this->currentTime, 0);
+
+        throw;
+    }
+
+    this->EndSolve();
+}
+
+/**
+ * Prepare for advancing this equation system in time. This method
+ * must be called before the first call to 'TakeStep()'.
+ */
+void EquationSystem::BeginSolve() {
     this->currentTime = 0;
-    this->times.push_back(this->currentTime);
     this->timestepper->SetSolver(solver);
 
+    if (!this->resumeFile.empty())
+        this->currentTime = this->LoadCheckpoint(this->resumeFile);
+
+    this->times.push_back(this->currentTime);
+    this->InitOutputTimes();
+
     this->PrintNonTrivialUnknowns();
     this->PrintTrivialUnknowns();
 
+    if (FVM::MemoryAccounting::IsEnabled()) {
+        FVM::MemoryAccounting::PrintSummary("at start of simulation");
+        this->PrintMemoryEstimate();
+    }
+
     // TODO Set initial state (or ensure that it has been set?)
 
     // Set initial guess in solver
     const real_t *guess = unknowns.GetLongVector(this->nontrivial_unknowns);
     solver->SetInitialGuess(guess);
     delete [] guess;
+
+    // Write initial state to the output stream (if enabled)
+    if (this->outputStream != nullptr)
+        this->outputStream->WriteSavedSteps();
+    if (this->stepOutput != nullptr)
+        this->stepOutput->WriteSavedSteps();
     
     cout << "Beginning time advance..." << endl;
 
-    Timer tim;
-    len_t istep = 0;    // Number of times 'solver->Solve()' has been called...
-    while (!timestepper->IsFinished()) {
-        // Take step
-        real_t tNext = timestepper->NextTime();
-        this->currentTime = timestepper->CurrentTime();
-        real_t dt = tNext - this->currentTime;
+    this->stepsSinceCheckpoint = 0;
+    this->checkpointTimer.Reset();
 
-        this->fluidGrid->Rebuild(tNext);
+    if (this->solveTimer != nullptr)
+        delete this->solveTimer;
+    this->solveTimer = new Timer();
 
-        try {
-            istep++;
-            solver->Solve(tNext, dt);
+    this->statusStartTime = this->currentTime;
+    if (!this->statusFile.empty())
+        this->WriteStatus("running", this->currentTime, 0);
+}
 
-            timestepper->ValidateStep();
+/**
+ * Prepare the fixed output time grid (if any) for the solve. Only
+ * output times following the start time are kept (the initial state
+ * is always output), and all unknowns and other quantities are set
+ * to produce their saved steps in these times.
+ */
+void EquationSystem::InitOutputTimes() {
+    if (this->outputTimes.empty())
+        return;
+
+    std::sort(this->outputTimes.begin(), this->outputTimes.end());
+    auto last = std::unique(this->outputTimes.begin(), this->outputTimes.end());
+    this->outputTimes.erase(last, this->outputTimes.end());
+    this->outputTimes.erase(
+        this->outputTimes.begin(),
+        std::upper_bound(this->outputTimes.begin(), this->outputTimes.end(), this->currentTime)
+    );
+    this->nextOutputTime = 0;
+
+    for (len_t i = 0; i < this->unknowns.Size(); i++)
+        this->unknowns.GetUnknown(i)->GetQuantityData()->SetOutputTimes(&this->outputTimes);
+
+    if (this->otherQuantityHandler != nullptr) {
+        for (OtherQuantity *oq : this->otherQuantityHandler->GetRegistered())
+            oq->GetData()->SetOutputTimes(&this->outputTimes);
+    }
+}
 
-            // Post-process solution (should be done before saving any
-            // time step)
-            this->postProcessor->Process(tNext);
+/**
+ * Returns true when the time stepper has reached the
+ * end of the simulation.
+ */
+bool EquationSystem::IsFinished() {
+    return timestepper->IsFinished();
+}
 
-            if (timestepper->IsSaveStep()) {
-                // true = Really save the step (if it's false, we just
-                // indicate that we have taken another timestep). This
-                // should only be true for time steps which we want to
-                // push to the output file.
-                unknowns.SaveStep(tNext, true);
+/**
+ * Take a single step with the time stepper (which may also be an
+ * attempt which the time stepper rejects and retakes in the next
+ * call).
+ */
+void EquationSystem::TakeStep() {
+    FVM::Tracer::Scope trace("Time step", "timestep");
+
+    // Record the memory usage after the previous step
+    if (FVM::MemoryAccounting::IsEnabled())
+        FVM::MemoryAccounting::Sample();
+
+    real_t tNext = timestepper->NextTime();
+    this->currentTime = timestepper->CurrentTime();
+    real_t dt = tNext - this->currentTime;
+
+    this->fluidGrid->Rebuild(tNext);
+
+    try {
+        // Select the time integration method for this step
+        // (based on the history of previous steps)
+        unknowns.PrepareTimeDerivative(dt);
+        solver->Solve(tNext, dt);
+
+        timestepper->ValidateStep();
+
+        // Post-process solution (should be done before saving any
+        // time step)
+        const bool saveStep = this->saveSteps && timestepper->IsSaveStep();
+        this->postProcessor->Process(tNext, saveStep);
+
+        if (saveStep) {
+            // true = Really save the step (if it's false, we just
+            // indicate that we have taken another timestep). This
+            // should only be true for time steps which we want to
+            // push to the output file.
+            unknowns.SaveStep(tNext, true);
+            if (this->outputTimes.empty())
                 this->times.push_back(tNext);
+            else {
+                // Output times passed in this step
+                for (; this->nextOutputTime < this->outputTimes.size() &&
+                       this->outputTimes[this->nextOutputTime] <= tNext; this->nextOutputTime++)
+                    this->times.push_back(this->outputTimes[this->nextOutputTime]);
+            }
 
-                otherQuantityHandler->StoreAll(tNext);
-            } else
-                unknowns.SaveStep(tNext, false);
-            
+            otherQuantityHandler->StoreAll(tNext);
+
+            if (this->outputStream != nullptr)
+                this->outputStream->WriteSavedSteps();
+            if (this->stepOutput != nullptr)
+                this->stepOutput->WriteSavedSteps();
+
+            if (!this->checkpointFile.empty())
+                this->UpdateCheckpoint(tNext);
+        } else
+            unknowns.SaveStep(tNext, false);
+        
+        if (this->saveSteps)
             timestepper->PrintProgress();
-        } catch (DREAM::QuitException& ex) {
-            // Rethrow quit exception
-            throw ex;
-        } catch (FVM::FVMException& ex) {
-            timestepper->HandleException(ex);
-        }
+        this->currentTime = timestepper->CurrentTime();
+
+        if (!this->statusFile.empty())
+            this->UpdateStatus(tNext, dt);
+    } catch (DREAM::QuitException& ex) {
+        // Rethrow quit exception
+        throw ex;
+    } catch (FVM::FVMException& ex) {
+        timestepper->HandleException(ex);
     }
+}
 
+/**
+ * Finish advancing this equation system in time, and
+ * print timing information.
+ */
+void EquationSystem::EndSolve() {
     cout << endl;
 
-    this->simulationTime = tim.GetMicroseconds();
-    string duration = tim.ToString();
+    if (!this->statusFile.empty())
+        this->WriteStatus("finished", this->timestepper->CurrentTime(), 0);
+
+    if (this->solveTimer != nullptr) {
+        this->simulationTime = this->solveTimer->GetMicroseconds();
+        string duration = this->solveTimer->ToString();
 
-    DREAM::IO::PrintInfo("Solved equation system in %s.", duration.c_str());
+        DREAM::IO::PrintInfo("Solved equation system in %s.", duration.c_str());
+
+        delete this->solveTimer;
+        this->solveTimer = nullptr;
+    }
 
     if (this->timingStdout) {
         this->solver->PrintTimings();
         this->REFluid->PrintTimings();
+
+        if (FVM::TermTimings::IsEnabled())
+            FVM::TermTimings::PrintSummary(20);
+    }
+
+    if (FVM::MemoryAccounting::IsEnabled())
+        FVM::MemoryAccounting::PrintSummary("at end of simulation");
+
+    if (FVM::Tracer::IsEnabled() && !this->traceFile.empty()) {
+        try {
+            FVM::Tracer::WriteChromeTrace(this->traceFile);
+        } catch (FVM::FVMException& ex) {
+            DREAM::IO::PrintError(ex.what());
+        }
     }
 }
 
@@ -6,7 +6,9 @@
 #include <cstdio>
 #include "DREAM/EquationSystem.hpp"
 #include "DREAM/IO.hpp"
+#include "DREAM/OtherQuantityHandler.hpp"
 #include "DREAM/UnknownQuantityEquation.hpp"
+#include "FVM/MemoryAccounting.hpp"
 
 
 using namespace DREAM;
@@ -59,3 +61,66 @@ void EquationSystem::PrintTrivialUnknowns() {
     IO::PrintInfo();
 }
 
+
+/**
+ * Prints an estimate of the peak memory needed by the simulation,
+ * consisting of the memory currently used by the process and the
+ * memory needed for storing all time steps which will be saved to
+ * the output. Since the fill of the jacobian factorization is not
+ * known before the matrix has been factorized, the estimate is a
+ * lower bound.
+ */
+void EquationSystem::PrintMemoryEstimate() {
+    size_t perStep = 0;
+    for (len_t i = 0; i < unknowns.Size(); i++)
+        perStep += unknowns[i]->GetQuantityData()->GetStepMemoryUsage();
+    if (this->otherQuantityHandler != nullptr)
+        perStep += this->otherQuantityHandler->GetStepMemoryUsage();
+
+    const size_t resident = FVM::MemoryAccounting::GetResidentMemory();
+    const len_t nSaveSteps = (this->timestepper == nullptr ? 0 : this->timestepper->GetNumberOfSaveSteps());
+
+    // Saved steps are released after being written to a streamed output file
+    if (this->outputStream != nullptr)
+        IO::PrintInfo(
+            "Estimated peak memory usage: %s (saved time steps are streamed to file).",
+            FVM::MemoryAccounting::FormatBytes(resident).c_str()
+        );
+    else if (nSaveSteps > 0)
+        IO::PrintInfo(
+            "Estimated peak memory usage: %s (%s now + %s for " LEN_T_PRINTF_FMT " saved time steps).",
+            FVM::MemoryAccounting::FormatBytes(resident + nSaveSteps*perStep).c_str(),
+            FVM::MemoryAccounting::FormatBytes(resident).c_str(),
+            FVM::MemoryAccounting::FormatBytes(nSaveSteps*perStep).c_str(), nSaveSteps
+        );
+    else
+        IO::PrintInfo(
+            "Memory usage: %s now + %s per saved time step.",
+            FVM::MemoryAccounting::FormatBytes(resident).c_str(),
+            FVM::MemoryAccounting::FormatBytes(perStep).c_str()
+        );
+
+    IO::PrintInfo("(excluding the fill of the jacobian factorization)");
+    IO::PrintInfo();
+}
+
+/**
+ * Print an estimate of the cost of the simulation (size of the
+ * equation system, memory usage and time per step), without
+ * advancing the system in time.
+ */
+void EquationSystem::PrintCostEstimate() {
+    this->timestepper->SetSolver(solver);
+    this->PrintNonTrivialUnknowns();
+
+    const real_t t0 = this->timestepper->CurrentTime();
+    const real_t dt = this->timestepper->NextTime() - t0;
+
+    const real_t *guess = unknowns.GetLongVector(this->nontrivial_unknowns);
+    solver->SetInitialGuess(guess);
+    delete [] guess;
+
+    this->solver->PrintCostEstimate(t0+dt, dt, this->timestepper->GetNumberOfSteps());
+    IO::PrintInfo();
+    this->PrintMemoryEstimate();
+}
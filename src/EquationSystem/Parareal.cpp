@@ -0,0 +1,303 @@
+/**
+ * This file implements member methods of 'EquationSystem' used for
+ * solving the equation system in parallel in time, with the parareal
+ * method.
+ *
+ * The simulation time is divided into one time window per MPI process,
+ * each containing (nearly) the same number of the time steps of the
+ * constant time stepper. Two propagators advance a state across a
+ * window: the fine propagator 'F', which takes the time steps requested
+ * by the user, and the coarse propagator 'G', which takes a small number
+ * of large time steps. Starting from a serial sweep of the coarse
+ * propagator across all windows, the states U_p at the start of each
+ * window are iteratively corrected according to
+ *
+ *   U_{p+1}^{k+1} = G(U_p^{k+1}) + F(U_p^k) - G(U_p^k),
+ *
+ * where the (expensive) fine propagations of all windows are solved
+ * concurrently, and only the (cheap) coarse propagations are solved
+ * serially. After k iterations, the states at the start of the first
+ * k+1 windows agree with the serial solution, so that at most P-1
+ * iterations are needed with P processes, but the iteration usually
+ * converges to the requested tolerance in far fewer. Finally, every
+ * process advances its window with the fine propagator once more, and
+ * writes the time steps of its window to its own output file.
+ *
+ * The states exchanged between windows contain all unknown quantities,
+ * together with a flag indicating whether the sending process succeeded
+ * so that a failure on one process stops all of them. Since the old
+ * time steps used by time derivatives are not exchanged, every window
+ * begins with a backward Euler step.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+#include <petsc.h>
+#include "DREAM/EquationSystem.hpp"
+#include "DREAM/IO.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Receive the state at the start of the time window of this process
+ * from the previous process (the first process always keeps its
+ * initial state).
+ *
+ * U:    Buffer to receive the state in (of size N+1).
+ * N:    Number of elements of the state.
+ * rank: Rank of this process.
+ *
+ * RETURNS false if the previous process failed.
+ */
+static bool parareal_receive(vector<real_t>& U, const len_t N, const PetscMPIInt rank) {
+    if (rank == 0)
+        return true;
+
+    MPI_Recv(U.data(), (int)(N+1), MPI_DOUBLE, rank-1, 0, PETSC_COMM_WORLD, MPI_STATUS_IGNORE);
+    return (U[N] != 0);
+}
+
+/**
+ * Send the state at the end of the time window of this process to
+ * the next process (the last process sends nothing).
+ *
+ * U:     State to send (of size N+1).
+ * N:     Number of elements of the state.
+ * ok:    If false, this process failed and 'U' is not valid.
+ * rank:  Rank of this process.
+ * nproc: Number of processes.
+ */
+static void parareal_send(
+    vector<real_t>& U, const len_t N, const bool ok,
+    const PetscMPIInt rank, const PetscMPIInt nproc
+) {
+    if (rank+1 == nproc)
+        return;
+
+    U[N] = (ok ? 1 : 0);
+    MPI_Send(U.data(), (int)(N+1), MPI_DOUBLE, rank+1, 0, PETSC_COMM_WORLD);
+}
+
+
+/**
+ * Solve this equation system with the parareal method (see the
+ * description at the top of this file).
+ */
+void EquationSystem::SolveParareal() {
+    TimeStepperConstant *ts = dynamic_cast<TimeStepperConstant*>(this->timestepper);
+    if (ts == nullptr)
+        throw EquationSystemException("Parareal: The parareal method requires the constant time stepper.");
+    else if (!ts->GetEventTimes().empty())
+        throw EquationSystemException("Parareal: The parareal method can not be combined with time step events.");
+    else if (!this->resumeFile.empty())
+        throw EquationSystemException("Parareal: Simulations solved with the parareal method can not be resumed from a checkpoint.");
+    else if (!this->checkpointFile.empty())
+        throw EquationSystemException("Parareal: Checkpoints can not be written by simulations solved with the parareal method.");
+    else if (this->outputStream != nullptr)
+        throw EquationSystemException("Parareal: Streaming output is not supported by the parareal method.");
+
+    PetscMPIInt rank, nproc;
+    MPI_Comm_rank(PETSC_COMM_WORLD, &rank);
+    MPI_Comm_size(PETSC_COMM_WORLD, &nproc);
+
+    const len_t Nt = ts->GetNumberOfSteps(), P = (len_t)nproc, p = (len_t)rank;
+    if (Nt < P)
+        throw EquationSystemException(
+            "Parareal: The number of time steps (" LEN_T_PRINTF_FMT ") must be at "
+            "least the number of processes (" LEN_T_PRINTF_FMT ").", Nt, P
+        );
+
+    // Time window of this process (with the same time steps as
+    // in a serial simulation)
+    const real_t dt = ts->GetTimeStep();
+    const len_t nbase = Nt / P, nrem = Nt % P;
+    const len_t iStart = p*nbase + min(p, nrem);
+    const len_t nFine = nbase + (p < nrem ? 1 : 0);
+    const len_t nCoarse = min(this->pararealCoarseSteps, nFine);
+    const real_t tStart = iStart*dt, tEnd = (iStart+nFine)*dt;
+
+    const len_t nSaveTotal = ts->GetNumberOfSaveSteps();
+    const len_t nSave = (nSaveTotal >= Nt ? 0 :
+        max((len_t)1, (len_t)llround(real_t(nSaveTotal)*nFine/Nt)));
+
+    this->BeginSolve();
+
+    if (P > 1)
+        DREAM::IO::PrintInfo(
+            "Parareal: Process %d solves t = [%.6e, %.6e] s with " LEN_T_PRINTF_FMT
+            " fine and " LEN_T_PRINTF_FMT " coarse steps.", rank, tStart, tEnd, nFine, nCoarse
+        );
+
+    // State at the start of the window (and the state from which 'F' was
+    // last computed), the results of the coarse and fine propagators, and
+    // the state at the end of the window (before and after the correction)
+    const len_t N = this->unknowns.GetLongVectorSizeAll();
+    vector<real_t> U0(N+1), U0prev(N), U0fine(N), G(N), Gnew(N), F(N), U1(N+1), U1prev(N);
+    this->unknowns.GetLongVectorAll(U0.data());
+
+    // Initial serial sweep of the coarse propagator
+    bool ok = parareal_receive(U0, N, rank);
+    if (ok)
+        ok = this->PararealPropagate(ts, tStart, tEnd, nCoarse, 0, U0.data(), G.data(), false);
+    copy(G.begin(), G.end(), U1.begin());
+    parareal_send(U1, N, ok, rank, nproc);
+
+    int okAll, okLocal = ok;
+    MPI_Allreduce(&okLocal, &okAll, 1, MPI_INT, MPI_MIN, PETSC_COMM_WORLD);
+
+    const len_t maxIter = min(this->pararealMaxIter, P-1);
+    bool hasFine = false, converged = (P == 1);
+    for (len_t iter = 1; okAll && !converged && iter <= maxIter; iter++) {
+        // Fine propagation (concurrently on all windows; if the state
+        // at the start of the window has converged, so has 'F')
+        if (!hasFine || !equal(U0fine.begin(), U0fine.end(), U0.begin())) {
+            ok = this->PararealPropagate(ts, tStart, tEnd, nFine, 0, U0.data(), F.data(), false);
+            copy(U0.begin(), U0.begin()+N, U0fine.begin());
+            hasFine = true;
+        }
+
+        // Serial correction sweep
+        copy(U0.begin(), U0.begin()+N, U0prev.begin());
+        ok = parareal_receive(U0, N, rank) && ok;
+        if (ok) {
+            if (equal(U0prev.begin(), U0prev.end(), U0.begin()))
+                Gnew = G;
+            else
+                ok = this->PararealPropagate(ts, tStart, tEnd, nCoarse, 0, U0.data(), Gnew.data(), false);
+
+            copy(U1.begin(), U1.begin()+N, U1prev.begin());
+            for (len_t i = 0; i < N; i++)
+                U1[i] = Gnew[i] + F[i] - G[i];
+            G = Gnew;
+        }
+        parareal_send(U1, N, ok, rank, nproc);
+
+        real_t changeAll, change = (ok ? this->PararealChange(U1.data(), U1prev.data()) : 0);
+        okLocal = ok;
+        MPI_Allreduce(&okLocal, &okAll, 1, MPI_INT, MPI_MIN, PETSC_COMM_WORLD);
+        MPI_Allreduce(&change, &changeAll, 1, MPI_DOUBLE, MPI_MAX, PETSC_COMM_WORLD);
+
+        converged = (changeAll <= this->pararealRelTol || iter == P-1);
+        if (rank == 0 && okAll)
+            DREAM::IO::PrintInfo(
+                "Parareal: Iteration " LEN_T_PRINTF_FMT ", maximum relative change %.3e.",
+                iter, changeAll
+            );
+    }
+
+    if (okAll && !converged && rank == 0)
+        DREAM::IO::PrintWarning(
+            "Parareal: The iteration did not converge to a relative change of %.3e "
+            "within " LEN_T_PRINTF_FMT " iterations.", this->pararealRelTol, maxIter
+        );
+
+    // Final fine propagation, saving the time steps of the window
+    if (okAll) {
+        this->times[0] = tStart;
+        ok = this->PararealPropagate(ts, tStart, tEnd, nFine, nSave, U0.data(), F.data(), true);
+
+        okLocal = ok;
+        MPI_Allreduce(&okLocal, &okAll, 1, MPI_INT, MPI_MIN, PETSC_COMM_WORLD);
+    }
+
+    if (!okAll) {
+        if (!this->statusFile.empty())
+            this->WriteStatus("failed", this->currentTime, 0);
+
+        throw EquationSystemException("Parareal: The solution failed on at least one time window.");
+    }
+
+    this->EndSolve();
+}
+
+/**
+ * Advance the given state across a time window with the constant time
+ * stepper. Any exception thrown while solving is caught (and printed),
+ * so that the failure can be communicated to the other processes.
+ *
+ * ts:     Time stepper to advance the system with.
+ * t0:     Time at which the window begins.
+ * t1:     Time at which the window ends.
+ * nt:     Number of time steps to take across the window.
+ * nSave:  Number of time steps to save to output (0 = all; only
+ *         used if 'save' is true).
+ * x0:     State (of all unknowns) at the start of the window.
+ * x1:     On return, contains the state at the end of the window.
+ * save:   If true, saves the time steps to the output.
+ *
+ * RETURNS false if the system could not be solved.
+ */
+bool EquationSystem::PararealPropagate(
+    TimeStepperConstant *ts, const real_t t0, const real_t t1, const len_t nt,
+    const len_t nSave, const real_t *x0, real_t *x1, const bool save
+) {
+    bool ok = true;
+    try {
+        ts->SetWindow(t0, t1, nt, (save ? nSave : 0));
+        this->SetState(t0, x0);
+
+        this->saveSteps = save;
+        while (!ts->IsFinished())
+            this->TakeStep();
+
+        this->unknowns.GetLongVectorAll(x1);
+    } catch (FVM::FVMException& ex) {
+        DREAM::IO::PrintError("Parareal: %s", ex.what());
+        ok = false;
+    }
+
+    this->saveSteps = true;
+    return ok;
+}
+
+/**
+ * Returns the relative change between two states, defined as the
+ * largest relative change (in the 2-norm) of any unknown quantity.
+ *
+ * x:     New state (of all unknowns).
+ * xprev: Previous state.
+ */
+real_t EquationSystem::PararealChange(const real_t *x, const real_t *xprev) {
+    real_t change = 0;
+    for (len_t i = 0, offset = 0; i < this->unknowns.Size(); i++) {
+        const len_t N = this->unknowns[i]->NumberOfElements();
+
+        real_t dx2 = 0, x2 = 0;
+        for (len_t j = offset; j < offset+N; j++) {
+            dx2 += (x[j]-xprev[j])*(x[j]-xprev[j]);
+            x2  += x[j]*x[j];
+        }
+
+        if (dx2 > 0)
+            change = max(change, (x2 > 0 ? sqrt(dx2/x2) : (real_t)INFINITY));
+
+        offset += N;
+    }
+
+    return change;
+}
+
+/**
+ * Set the state of all unknown quantities at the given time, discarding
+ * their time history (so that the next time step is taken with backward
+ * Euler), and use it as the initial guess of the solver.
+ *
+ * t: Time of the state.
+ * x: State of all unknowns (as returned by 'GetLongVectorAll()').
+ */
+void EquationSystem::SetState(const real_t t, const real_t *x) {
+    for (len_t i = 0, offset = 0; i < this->unknowns.Size(); i++) {
+        this->unknowns.SetInitialValue(i, x+offset, t);
+        offset += this->unknowns[i]->NumberOfElements();
+    }
+
+    this->currentTime = t;
+
+    const real_t *guess = this->unknowns.GetLongVector(this->nontrivial_unknowns);
+    this->solver->SetInitialGuess(guess);
+    delete [] guess;
+}
@@ -5,6 +5,10 @@
 #include <string>
 #include <softlib/SFile.h>
 #include "DREAM/EquationSystem.hpp"
+#include "FVM/MemoryAccounting.hpp"
+#include "FVM/PetscLog.hpp"
+#include "FVM/TermTimings.hpp"
+#include "FVM/Tracer.hpp"
 
 
 using namespace DREAM;
@@ -33,5 +37,28 @@ void EquationSystem::SaveTimings(SFile *sf, const string& name) {
     path = name + "/runawayfluid";
     sf->CreateStruct(path);
     this->REFluid->SaveTimings(sf, path);
+
+    if (FVM::Tracer::IsEnabled())
+        FVM::Tracer::SaveSummary(sf, name + "/trace");
+    if (FVM::TermTimings::IsEnabled())
+        FVM::TermTimings::SaveSummary(sf, name + "/terms");
+    if (FVM::MemoryAccounting::IsEnabled())
+        FVM::MemoryAccounting::SaveSummary(sf, name + "/memory");
+    if (FVM::PetscLog::IsEnabled())
+        FVM::PetscLog::SaveSummary(sf, name + "/petsclog");
 }
 
+
+/**
+ * Save statistics about the solution (from the solver and
+ * time stepper).
+ *
+ * sf:   SFile object to save solver data to.
+ * name: Name of group to store information in.
+ */
+void EquationSystem::SaveSolverData(SFile *sf, const string& name) {
+    this->solver->WriteDataSFile(sf, name);
+
+    if (this->solver->IsTelemetryEnabled() && this->timestepper != nullptr)
+        this->timestepper->WriteTelemetry(sf, name+"/telemetry/timestepper");
+}
@@ -0,0 +1,123 @@
+/**
+ * This file implements member methods of 'EquationSystem' used for
+ * writing a status file, which is periodically rewritten during the
+ * simulation with its current progress (simulation time, time step,
+ * throughput, number of solver iterations, memory usage and an estimate
+ * of the remaining wall-clock time). The status file is intended for
+ * monitoring simulations run under batch schedulers, where the progress
+ * bars printed to stdout are not available.
+ *
+ * If the name of the status file ends with '.prom', the status is
+ * written in the Prometheus text exposition format (suitable for e.g.
+ * the textfile collector of the Prometheus node exporter). Otherwise,
+ * the status is written as a JSON object. The file is replaced
+ * atomically, so that readers never see a partially written file.
+ */
+
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <string>
+#include "DREAM/EquationSystem.hpp"
+#include "DREAM/IO.hpp"
+#include "FVM/MemoryAccounting.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Record the most recent time step, and rewrite the status file
+ * if enough time has passed since it was last written.
+ *
+ * t:  Time reached by the most recent step.
+ * dt: Length of the most recent step.
+ */
+void EquationSystem::UpdateStatus(const real_t t, const real_t dt) {
+    this->statusSteps++;
+    this->statusIterations += this->solver->GetNumberOfIterations();
+    this->statusStepsSinceWrite++;
+
+    if (this->statusTimer.GetMicroseconds() < this->statusInterval*1e6)
+        return;
+
+    this->WriteStatus("running", t, dt);
+}
+
+/**
+ * Write the status file.
+ *
+ * state: State of the simulation ("running", "finished" or "failed").
+ * t:     Current simulation time.
+ * dt:    Length of the most recent time step.
+ */
+void EquationSystem::WriteStatus(const char *state, const real_t t, const real_t dt) {
+    const real_t tMax = this->timestepper->GetMaxTime();
+    const real_t elapsed = (this->solveTimer == nullptr ? 0 : this->solveTimer->GetMicroseconds()*1e-6);
+    const real_t progress = (tMax > this->statusStartTime ? (t-this->statusStartTime) / (tMax-this->statusStartTime) : 1);
+    const real_t stepsPerSecond = (elapsed > 0 ? this->statusSteps / elapsed : 0);
+    const real_t eta = (progress > 0 ? elapsed * (1-progress) / progress : -1);
+    const real_t itersPerStep = (this->statusStepsSinceWrite > 0 ?
+        this->statusIterations / (real_t)this->statusStepsSinceWrite : 0);
+    const size_t memory = FVM::MemoryAccounting::GetResidentMemory();
+
+    const string tmpname = this->statusFile + ".tmp";
+    FILE *f = fopen(tmpname.c_str(), "w");
+    if (f == nullptr) {
+        DREAM::IO::PrintWarning("Unable to write status file '%s'.", this->statusFile.c_str());
+        // Don't try again
+        this->statusFile = "";
+        return;
+    }
+
+    const bool prometheus = (
+        this->statusFile.length() > 5 &&
+        this->statusFile.compare(this->statusFile.length()-5, 5, ".prom") == 0
+    );
+
+    if (prometheus) {
+        #define METRIC(name, desc, fmt, value) \
+            fprintf(f, "# HELP dream_" name " " desc "\n# TYPE dream_" name " gauge\ndream_" name " " fmt "\n", value)
+
+        METRIC("running", "Whether the simulation is running (1) or has stopped (0)", "%d", (strcmp(state, "running") == 0 ? 1 : 0));
+        METRIC("failed", "Whether the simulation has failed", "%d", (strcmp(state, "failed") == 0 ? 1 : 0));
+        METRIC("updated_timestamp_seconds", "Time at which the status was written", "%lld", (long long)time(nullptr));
+        METRIC("simulation_time_seconds", "Current simulation time", "%.12e", t);
+        METRIC("simulation_end_time_seconds", "Final simulation time", "%.12e", tMax);
+        METRIC("timestep_seconds", "Length of the most recent time step", "%.12e", dt);
+        METRIC("progress_ratio", "Fraction of the simulation completed", "%.6f", progress);
+        METRIC("steps_total", "Number of time steps taken", "%llu", (unsigned long long)this->statusSteps);
+        METRIC("steps_per_second", "Average number of time steps taken per second", "%.6e", stepsPerSecond);
+        METRIC("iterations_per_step", "Average number of solver iterations per time step since the last update", "%.4f", itersPerStep);
+        METRIC("resident_memory_bytes", "Resident memory of the process", "%llu", (unsigned long long)memory);
+        METRIC("elapsed_seconds", "Wall-clock time spent in the simulation", "%.3f", elapsed);
+        METRIC("eta_seconds", "Estimated remaining wall-clock time (-1 if unknown)", "%.3f", eta);
+
+        #undef METRIC
+    } else {
+        fprintf(f, "{\n");
+        fprintf(f, "  \"state\": \"%s\",\n", state);
+        fprintf(f, "  \"updated\": %lld,\n", (long long)time(nullptr));
+        fprintf(f, "  \"time\": %.12e,\n", t);
+        fprintf(f, "  \"tmax\": %.12e,\n", tMax);
+        fprintf(f, "  \"dt\": %.12e,\n", dt);
+        fprintf(f, "  \"progress\": %.6f,\n", progress);
+        fprintf(f, "  \"steps\": " LEN_T_PRINTF_FMT ",\n", this->statusSteps);
+        fprintf(f, "  \"stepspersecond\": %.6e,\n", stepsPerSecond);
+        fprintf(f, "  \"iterationsperstep\": %.4f,\n", itersPerStep);
+        fprintf(f, "  \"memory\": %llu,\n", (unsigned long long)memory);
+        fprintf(f, "  \"elapsed\": %.3f,\n", elapsed);
+        fprintf(f, "  \"eta\": %.3f\n", eta);
+        fprintf(f, "}\n");
+    }
+
+    fclose(f);
+
+    if (rename(tmpname.c_str(), this->statusFile.c_str()) != 0)
+        DREAM::IO::PrintWarning("Unable to replace status file '%s'.", this->statusFile.c_str());
+
+    this->statusIterations = 0;
+    this->statusStepsSinceWrite = 0;
+    this->statusTimer.Reset();
+}
@@ -75,10 +75,12 @@ real_t AnalyticDistributionHottail::evaluateEnergyDistribution(len_t ir, real_t
 real_t AnalyticDistributionHottail::evaluateEnergyDistributionFromTau(len_t ir, real_t p, real_t tau, real_t *dfdp, real_t *dfdr, real_t *dFdpOverF, real_t *dFdTau){
     if(type != OptionConstants::UQTY_F_HOT_DIST_MODE_NONREL)
         throw DREAMException("AnalyticDistributionHottail: Invalid type %d", type);
+    // s = x^(2/3), and its derivative ds/dx = 2/(3*sqrt(s))
     real_t x = p*p*p + 3*tau;
-    real_t s = cbrt(x*x);
-    real_t exponent = - s / (betaTh[ir]*betaTh[ir]);
-    real_t f = preFactor[ir] * exp(exponent);
+    real_t cx = cbrt(x);
+    real_t s = cx*cx;
+    real_t invBeta2 = 1.0 / (betaTh[ir]*betaTh[ir]);
+    real_t f = preFactor[ir] * exp(-s*invBeta2);
 
     if(dfdr != nullptr){
         if(nr==1)
@@ -91,24 +93,20 @@ real_t AnalyticDistributionHottail::evaluateEnergyDistributionFromTau(len_t ir,
         }
     }
 
-    if(dfdp != nullptr){
-        if(s==0)
-            *dfdp = 0;
-        else
-            *dfdp = - f * 2*p*p / ( sqrt(s)*betaTh[ir]*betaTh[ir] );
-    }
+    // d(ln f)/dx
+    real_t dlnfdx = (s==0) ? 0 : -2*invBeta2 / (3*cx);
+
+    if(dfdp != nullptr)
+        *dfdp = 3*p*p * dlnfdx * f;
+
+    if(dFdpOverF != nullptr)
+        *dFdpOverF = 3*p*p * dlnfdx;
 
-    if(dFdpOverF != nullptr){
-        if(s==0)
-            *dFdpOverF = 0;
-        else
-            *dFdpOverF = - 2*p*p / ( sqrt(s)*betaTh[ir]*betaTh[ir] );
-    }
     if(dFdTau != nullptr){
         if(s==0)
             *dFdTau = std::numeric_limits<real_t>::infinity();
         else
-            *dFdTau = - 2*f / ( sqrt(s)*betaTh[ir]*betaTh[ir] );
+            *dFdTau = 3 * dlnfdx * f;
     }
     return f;
 }
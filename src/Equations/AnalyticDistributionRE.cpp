@@ -1,8 +1,17 @@
 /**
  * Functions to evaluate the analytic pitch-angle distribution. 
+ *
+ * The radially varying shape functions of the distribution (the exponent
+ * of the pitch distribution, and its normalization factor as a function
+ * of the width parameter A) are tabulated when the grid is (re)built, and
+ * stored as piecewise cubic polynomials in flat arrays, so that the
+ * distribution and its derivatives can be evaluated without the state
+ * (and lookups) of GSL interpolation accelerators.
  */
 
+#include <algorithm>
 #include "DREAM/Equations/AnalyticDistributionRE.hpp"
+#include "DREAM/Equations/REPitchDistributionAveragedBACoeff.hpp"
 
 using namespace DREAM;
 
@@ -25,25 +34,16 @@ AnalyticDistributionRE::AnalyticDistributionRE(
 
 
 void AnalyticDistributionRE::Deallocate(){
-    if(xi0OverXiSpline != nullptr){
-        for(len_t ir=0; ir<nr; ir++){
-            gsl_spline_free(xi0OverXiSpline[ir]);
-            gsl_interp_accel_free(xiSplineAcc[ir]);
-        }
-        delete [] xi0OverXiSpline;
-        delete [] xiSplineAcc;
+    if(xiTable_Coeffs != nullptr){
+        delete [] xiTable_Coeffs;
         delete [] integralOverFullPassing;
+        xiTable_Coeffs = nullptr;
     }
-    if(REDistNormFactor_Spline != nullptr){
-        for(len_t ir=0; ir<nr; ir++){
-            gsl_spline_free(REDistNormFactor_Spline[ir]);
-            gsl_interp_accel_free(REDistNormFactor_Accel[ir]);
-        }
-        delete [] REDistNormFactor_Spline;
-        delete [] REDistNormFactor_Accel;
+    if(REDistNorm_Coeffs != nullptr){
+        delete [] REDistNorm_Coeffs;
+        delete [] REDistNorm_X;
+        REDistNorm_Coeffs = nullptr;
     }
-
-    
 }
 /**
  * Destructor
@@ -76,16 +76,16 @@ bool AnalyticDistributionRE::GridRebuilt(){
 void AnalyticDistributionRE::constructVpSplines(){
     std::function<real_t(real_t)> identityFunc = [](real_t){return 1.0;};
     const len_t N_VP_SPLINE = 100;
-    const len_t N_RE_DIST_SPLINE = 50;
 
-    real_t 
-        *xArray = new real_t[N_RE_DIST_SPLINE],
-        *REDistIntegralArray = new real_t[N_RE_DIST_SPLINE];
+    real_t *REDistIntegralArray = new real_t[N_RE_DIST_SPLINE];
 
-    REPitchDistributionAveragedBACoeff::GenerateNonUniformXArray(xArray, N_RE_DIST_SPLINE);
+    REDistNorm_X = new real_t[N_RE_DIST_SPLINE];
+    REPitchDistributionAveragedBACoeff::GenerateNonUniformXArray(REDistNorm_X, N_RE_DIST_SPLINE);
+    const real_t *xArray = REDistNorm_X;
 
-    REDistNormFactor_Accel  = new gsl_interp_accel*[nr];
-    REDistNormFactor_Spline = new gsl_spline*[nr];
+    REDistNorm_Coeffs = new real_t[4*(N_RE_DIST_SPLINE-1)*nr];
+    gsl_spline *spline = gsl_spline_alloc(gsl_interp_steffen, N_RE_DIST_SPLINE);
+    gsl_interp_accel *acc = gsl_interp_accel_alloc();
     for(len_t ir=0; ir<nr; ir++){
         real_t xiT = rGrid->GetXi0TrappedBoundary(ir);
         // Create a temporary spline over Vp:
@@ -97,8 +97,6 @@ void AnalyticDistributionRE::constructVpSplines(){
         );
 
         // Generate spline in A of the normalization factor
-        REDistNormFactor_Accel[ir] = gsl_interp_accel_alloc();
-        REDistNormFactor_Spline[ir] = gsl_spline_alloc(gsl_interp_steffen, N_RE_DIST_SPLINE);
         REPitchDistributionAveragedBACoeff::ParametersForREPitchDistributionIntegral params 
             = {ir, xiT, 0, this, VpSpline, VpAcc, identityFunc};
         for(len_t i=0; i<N_RE_DIST_SPLINE; i++){
@@ -106,31 +104,45 @@ void AnalyticDistributionRE::constructVpSplines(){
             params.A = A;
             REDistIntegralArray[i] = REPitchDistributionAveragedBACoeff::EvaluateREDistBounceIntegral(params, gsl_ad_w);
         }
-        gsl_spline_init(REDistNormFactor_Spline[ir], xArray, REDistIntegralArray, N_RE_DIST_SPLINE);
+        gsl_spline_init(spline, xArray, REDistIntegralArray, N_RE_DIST_SPLINE);
+        gsl_interp_accel_reset(acc);
+        REPitchDistributionAveragedBACoeff::SetSplineCoefficients(
+            xArray, N_RE_DIST_SPLINE, spline, acc,
+            REDistNorm_Coeffs + 4*(N_RE_DIST_SPLINE-1)*ir
+        );
 
         gsl_spline_free(VpSpline);
         gsl_interp_accel_free(VpAcc);
     }
-    delete [] xArray;
+    gsl_interp_accel_free(acc);
+    gsl_spline_free(spline);
     delete [] REDistIntegralArray;
 }
 
 /**
- * Generates splines over xi0/<xi0> on a xi0 grid 
+ * Tabulates the exponent G(xi0) = int(xi0'/<xi>, xi0, 1) of the pitch
+ * distribution on passing orbits. xi0/<xi> is splined in N_SPLINE points
+ * (since the flux surface average is expensive to evaluate), and the
+ * spline integrated to give the values G and derivatives G' = -xi0/<xi>
+ * of the table.
  */
 void AnalyticDistributionRE::constructXiSpline(){
-    xi0OverXiSpline = new gsl_spline*[nr];
-    xiSplineAcc     = new gsl_interp_accel*[nr];
     real_t *xiArr   = new real_t[N_SPLINE];
     real_t *FuncArr = new real_t[N_SPLINE];
+    xiTable_Coeffs = new real_t[4*(N_XI_TABLE-1)*nr];
     integralOverFullPassing = new real_t[nr];
-    // generate pitch grid for the spline
+
+    gsl_spline *spline = gsl_spline_alloc(gsl_interp_steffen, N_SPLINE);
+    gsl_interp_accel *acc = gsl_interp_accel_alloc();
     for(len_t ir=0; ir<nr; ir++){
-        xiSplineAcc[ir]     = gsl_interp_accel_alloc();
-        xi0OverXiSpline[ir] = gsl_spline_alloc (gsl_interp_steffen, N_SPLINE);
+        real_t *c = xiTable_Coeffs + 4*(N_XI_TABLE-1)*ir;
         real_t xiT  = rGrid->GetXi0TrappedBoundary(ir);
-        if(xiT==0) // cylindrical geometry - skip remainder since these splines will not be used
+        if(xiT==0){ // cylindrical geometry - skip remainder since the table will not be used
+            for(len_t k=0; k<4*(N_XI_TABLE-1); k++)
+                c[k] = 0;
+            integralOverFullPassing[ir] = 0;
             continue;
+        }
         for(len_t k=0; k<N_SPLINE; k++){
             // create uniform xi0 grid on [xiT,1] 
             real_t xi0 = xiT + k*(1.0-xiT)/(N_SPLINE-1.0);
@@ -141,76 +153,109 @@ void AnalyticDistributionRE::constructXiSpline(){
             );
         }
         xiArr[N_SPLINE-1] = 1.0;
-        gsl_spline_init (xi0OverXiSpline[ir], xiArr, FuncArr, N_SPLINE);
-        // the integral int( xi0/<xi>, xiT, 1 ) over the entire spline 
+        gsl_spline_init(spline, xiArr, FuncArr, N_SPLINE);
+        gsl_interp_accel_reset(acc);
+
+        // Cubic Hermite polynomials matching G and G' at the table points
+        const real_t h = (1.0-xiT)/(N_XI_TABLE-1);
+        real_t G0 = gsl_spline_eval_integ(spline, xiT, 1.0, acc);
+        real_t d0 = -gsl_spline_eval(spline, xiT, acc);
+        for(len_t i=0; i<N_XI_TABLE-1; i++){
+            real_t xi1 = (i==N_XI_TABLE-2) ? 1.0 : xiT + (i+1)*h;
+            real_t G1 = gsl_spline_eval_integ(spline, xi1, 1.0, acc);
+            real_t d1 = -gsl_spline_eval(spline, xi1, acc);
+            real_t s  = (G1-G0)/h;
+
+            c[4*i]   = G0;
+            c[4*i+1] = d0;
+            c[4*i+2] = (3*s - 2*d0 - d1)/h;
+            c[4*i+3] = (d0 + d1 - 2*s)/(h*h);
+
+            G0 = G1;
+            d0 = d1;
+        }
+        // the integral int( xi0/<xi>, xiT, 1 ) over the entire passing region
         // will appear repeatedly and is therefore stored 
-        integralOverFullPassing[ir] = gsl_spline_eval_integ(xi0OverXiSpline[ir],xiArr[0],1.0,xiSplineAcc[ir]);
+        integralOverFullPassing[ir] = c[0];
     }
+    gsl_interp_accel_free(acc);
+    gsl_spline_free(spline);
     delete [] xiArr;
     delete [] FuncArr;
 }
 
 /**
- * Same as evaluatePitchDistribution but takes A (width parameter) instead of p, E 
- * and inSettings used to create look-up-table in the Eceff calculation.
+ * Evaluates the exponent g of the pitch distribution exp(-A*g(xi0))
+ * and its derivative with respect to xi0. In the 'full' mode, g is
+ * the (semi-)analytic result predicted in the near-threshold regime,
+ * where the momentum flux is small compared to the characteristic
+ * pitch flux and we obtain the approximate kinetic equation phi_xi = 0.
+ * In the 'simple' mode, xi0/<xi> is approximated by 1 for passing
+ * and 0 for trapped particles.
+ *
+ * dgdxi0: On return, contains the derivative of g with respect to xi0.
  */
-real_t AnalyticDistributionRE::evaluatePitchDistributionFromA(
-    len_t ir, real_t xi0, real_t A
-){
-    if(mode == RE_PITCH_DIST_SIMPLE)
-        return evaluateApproximatePitchDistributionFromA(ir,xi0,A);
-    else
-        return evaluateAnalyticPitchDistributionFromA(ir,xi0,A);
+real_t AnalyticDistributionRE::evaluatePitchExponent(len_t ir, real_t xi0, real_t *dgdxi0){
+    real_t xiT = rGrid->GetXi0TrappedBoundary(ir); 
+    if(xiT<this->thresholdToNeglectTrappedContribution){
+        *dgdxi0 = -1;
+        return 1-xi0;
+    }
+
+    // The exponent is symmetric about the trapped region, where it is
+    // constant: for xi0 < -xiT, we mirror the interval [xi0, -xiT] 
+    // to the positive pitch side
+    real_t x = fabs(xi0);
+    if(x<=xiT){
+        *dgdxi0 = 0;
+        return (mode==RE_PITCH_DIST_SIMPLE) ? 1-xiT : integralOverFullPassing[ir];
+    }
+
+    real_t G, dGdx;
+    if(mode==RE_PITCH_DIST_SIMPLE){
+        G = 1-x;
+        dGdx = -1;
+    } else {
+        const real_t h = (1.0-xiT)/(N_XI_TABLE-1);
+        len_t i = (len_t)((x-xiT)/h);
+        if(i > N_XI_TABLE-2) i = N_XI_TABLE-2;
+        const real_t *c = xiTable_Coeffs + 4*((N_XI_TABLE-1)*ir + i);
+        real_t dx = x - (xiT + i*h);
+        G    = ((c[3]*dx + c[2])*dx + c[1])*dx + c[0];
+        dGdx = (3*c[3]*dx + 2*c[2])*dx + c[1];
+    }
+
+    *dgdxi0 = dGdx;
+    if(xi0>0)
+        return G;
+    else {
+        // g = int(xi0/<xi>, xiT, 1) + int(xi0/<xi>, xiT, -xi0)
+        real_t Gfull = (mode==RE_PITCH_DIST_SIMPLE) ? 1-xiT : integralOverFullPassing[ir];
+        return 2*Gfull - G;
+    }
 }
 
 /**
- * Calculates the (semi-)analytic pitch-angle distribution predicted in the 
- * near-threshold regime, where the momentum flux is small compared 
- * to the characteristic pitch flux, and we obtain the approximate 
- * kinetic equation phi_xi = 0.
+ * Same as evaluatePitchDistribution but takes A (width parameter) instead of p, E 
+ * and inSettings used to create look-up-table in the Eceff calculation.
+ * The distribution is not normalized.
+ *
+ * dfdxi0: If not 'nullptr', contains the derivative with respect to xi0 on return.
+ * dfdA:   If not 'nullptr', contains the derivative with respect to A on return.
  */
-real_t AnalyticDistributionRE::evaluateAnalyticPitchDistributionFromA(
-    len_t ir, real_t xi0, real_t A
+real_t AnalyticDistributionRE::evaluatePitchDistributionFromA(
+    len_t ir, real_t xi0, real_t A, real_t *dfdxi0, real_t *dfdA
 ){
-    real_t xiT = rGrid->GetXi0TrappedBoundary(ir); 
-    if(xiT<this->thresholdToNeglectTrappedContribution)
-        return exp(-A*(1-xi0));
-
-    real_t dist1 = 0; // contribution to exponent from positive pitch 
-    real_t dist2 = 0; // contribution to exponent from negative pitch
-
-    if (xi0>xiT)
-        dist1 = gsl_spline_eval_integ(xi0OverXiSpline[ir],xi0,1.0,xiSplineAcc[ir]);
-    else 
-        dist1 = integralOverFullPassing[ir]; // equivalent to F(xiT,1.0,&dist1)
-    
-    if(xi0<-xiT) // add [xi0, -xiT] part but mirror the interval: spline is 
-                 // only defined for positive pitch since it's symmetric
-        dist2 = gsl_spline_eval_integ(xi0OverXiSpline[ir],xiT,-xi0,xiSplineAcc[ir]);
-    
-    return exp(-A*(dist1+dist2));
-}
+    real_t dgdxi0;
+    real_t g = evaluatePitchExponent(ir, xi0, &dgdxi0);
+    real_t f = exp(-A*g);
 
-/**
- * Same as evaluteAnalyticPitchDistribution, but approximating
- * xi0/<xi> = 1 for passing and 0 for trapped (thus avoiding the 
- * need for the numerical integration).
- */
-real_t AnalyticDistributionRE::evaluateApproximatePitchDistributionFromA(len_t ir, real_t xi0, real_t A){
-    real_t xiT = rGrid->GetXi0TrappedBoundary(ir);
-    if(xiT<this->thresholdToNeglectTrappedContribution)
-        return exp(-A*(1-xi0));
-    real_t dist1 = 0;
-    real_t dist2 = 0;
-
-    if(xi0>xiT)
-        dist1 = 1-xi0;
-    else 
-        dist1 = 1-xiT;
-    if(xi0<-xiT)
-        dist2 = -xiT - xi0;
-
-    return exp(-A*(dist1+dist2));
+    if(dfdxi0 != nullptr)
+        *dfdxi0 = -A*dgdxi0*f;
+    if(dfdA != nullptr)
+        *dfdA = -g*f;
+
+    return f;
 }
 
 /**
@@ -240,28 +285,21 @@ real_t AnalyticDistributionRE::evaluateEnergyDistribution(len_t ir, real_t p, re
  */
 real_t AnalyticDistributionRE::evaluatePitchDistribution(
     len_t ir, real_t xi0, real_t p, 
-    real_t * /*dfdxi0*/, real_t * /*dfdp*/, real_t * /*dfdr*/
-    /*, real_t *dfdA */
+    real_t *dfdxi0, real_t * /*dfdp*/, real_t * /*dfdr*/
 ){
     real_t A = GetAatP(ir,p);
 
-    real_t D = evaluatePitchDistributionFromA(ir, xi0, A) * rGrid->GetVpVol(ir) / EvaluateVpREAtA(ir, A);
-    /* // Implement as need arises
-    if(dfdxi0!=nullptr){
-        // evaluate pitch derivative
-    }
+    real_t norm = rGrid->GetVpVol(ir) / EvaluateVpREAtA(ir, A);
+    real_t D = evaluatePitchDistributionFromA(ir, xi0, A, dfdxi0) * norm;
+    if(dfdxi0!=nullptr)
+        *dfdxi0 *= norm;
+    /* // Implement as need arises (requires the p derivative of nuD)
     if(dfdp!=nullptr){
         //evaluate p derivative
     }
     if(dfdr!=nullptr){
         //evaluate r derivative
     }
-    if(dfdA!=nullptr){
-        //evaluate derivative with respect to A
-        real_t h = 1e-3*A;
-        real_t Dshift = evaluatePitchDistributionFromA(ir, xi0, A+h) * rGrid->GetVpVol(ir) / EvaluateVpREAtA(ir, A+h);
-        *dfdA = (Dshift - D) / h;
-    }
     */
     return D;
 }
@@ -280,11 +318,24 @@ real_t AnalyticDistributionRE::GetAatP(len_t ir,real_t p, CollisionQuantity::col
 /**
  * Evaluates the "pitch-distribution-bounce jacobian"
  *   VpRE = int((Vp/p^2) * exp(-A*g) dxi0,-1,1)
+ *
+ * dVpREdA: If not 'nullptr', contains the derivative of VpRE
+ *          with respect to A on return.
  */
-real_t AnalyticDistributionRE::EvaluateVpREAtA(len_t ir, real_t A){
-    return gsl_spline_eval(
-        REDistNormFactor_Spline[ir], 
-        REPitchDistributionAveragedBACoeff::GetXFromA(A),
-        REDistNormFactor_Accel[ir]
-    );
+real_t AnalyticDistributionRE::EvaluateVpREAtA(len_t ir, real_t A, real_t *dVpREdA){
+    const real_t *x = REDistNorm_X;
+    real_t X = REPitchDistributionAveragedBACoeff::GetXFromA(A);
+    len_t k = std::upper_bound(x, x+N_RE_DIST_SPLINE, X) - x;
+    len_t i = (k==0) ? 0 : std::min(k-1, N_RE_DIST_SPLINE-2);
+
+    const real_t *c = REDistNorm_Coeffs + 4*((N_RE_DIST_SPLINE-1)*ir + i);
+    real_t dX = X - x[i];
+
+    if(dVpREdA != nullptr){
+        // dX/dA = 2*A/(1+A)^3
+        real_t dXdA = isinf(A) ? 0 : 2*A/((1+A)*(1+A)*(1+A));
+        *dVpREdA = ((3*c[3]*dX + 2*c[2])*dX + c[1]) * dXdA;
+    }
+
+    return ((c[3]*dX + c[2])*dX + c[1])*dX + c[0];
 }
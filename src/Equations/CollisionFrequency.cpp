@@ -12,6 +12,7 @@
 #include "FVM/UnknownQuantityHandler.hpp"
 #include "DREAM/NotImplementedException.hpp"
 #include "FVM/FVMException.hpp"
+#include "FVM/ScratchArena.hpp"
 #include <string>
 #include "gsl/gsl_sf_bessel.h"
 
@@ -91,29 +92,34 @@ real_t CollisionFrequency::evaluateAtP(len_t ir, real_t p,collqty_settings *inSe
  *  Calculates and stores partial terms which depend on unknown quantities (density and temperature).
  */
 void CollisionFrequency::RebuildPlasmaDependentTerms(){
-    len_t indZ;
-    for(len_t iz = 0; iz<nZ; iz++)
-        for(len_t Z0=0; Z0<=Zs[iz]; Z0++)
-            for(len_t ir=0; ir<nr; ir++){
-                indZ = ionIndex[iz][Z0];            
-                ionDensities[ir][indZ] = ionHandler->GetIonDensity(ir,iz,Z0);
-            }
-    
-    for(len_t ir=0; ir<nr; ir++){
-        const real_t Theta = unknowns->GetUnknownData(id_Tcold)[ir] / Constants::mc2inEV;
-        K0Scaled[ir] = evaluateExp1OverThetaK(Theta,0.0);
-        K1Scaled[ir] = evaluateExp1OverThetaK(Theta,1.0);
-        K2Scaled[ir] = evaluateExp1OverThetaK(Theta,2.0);
+    if(cache != nullptr){
+        // radial quantities are shared with the other collision frequencies
+        cache->Update();
+        ionDensities = cache->GetIonDensities();
+        K0Scaled = cache->GetK0Scaled();
+        K1Scaled = cache->GetK1Scaled();
+        K2Scaled = cache->GetK2Scaled();
+    } else {
+        len_t indZ;
+        for(len_t iz = 0; iz<nZ; iz++)
+            for(len_t Z0=0; Z0<=Zs[iz]; Z0++)
+                for(len_t ir=0; ir<nr; ir++){
+                    indZ = ionIndex[iz][Z0];            
+                    ionDensities[ir][indZ] = ionHandler->GetIonDensity(ir,iz,Z0);
+                }
+        
+        for(len_t ir=0; ir<nr; ir++){
+            const real_t Theta = unknowns->GetUnknownData(id_Tcold)[ir] / Constants::mc2inEV;
+            K0Scaled[ir] = evaluateExp1OverThetaK(Theta,0.0);
+            K1Scaled[ir] = evaluateExp1OverThetaK(Theta,1.0);
+            K2Scaled[ir] = evaluateExp1OverThetaK(Theta,2.0);
+        }
     }
     
-    if(collQtySettings->collfreq_mode==OptionConstants::COLLQTY_COLLISION_FREQUENCY_MODE_FULL)
+    if(electronTermDependsOnPlasma()){
         InitializeGSLWorkspace();
-    if (!buildOnlyF1F2){
-        setElectronTerm(nColdTerm,mg->GetP(),nr,np1,np2_store);
-        setElectronTerm(nColdTerm_fr,mg->GetP(),nr/*+1*/,np1,np2_store);
+        setElectronTerms();
     }
-    setElectronTerm(nColdTerm_f1,mg->GetP_f1(),nr,np1+1,np2_store);
-    setElectronTerm(nColdTerm_f2,mg->GetP_f2(),nr,np1,np2_store+1);
 }
 
 
@@ -137,10 +143,15 @@ void CollisionFrequency::RebuildRadialTerms(){
             indZ = ionHandler->GetIndex(iz,Z0);
             ionIndex[iz][Z0] = indZ; 
             atomicParameter[indZ] = GetAtomicParameter(iz,Z0);
-            for(len_t ir=0; ir<nr; ir++)
-                ionDensities[ir][indZ] = ionHandler->GetIonDensity(ir,iz,Z0);
+            if(cache == nullptr)
+                for(len_t ir=0; ir<nr; ir++)
+                    ionDensities[ir][indZ] = ionHandler->GetIonDensity(ir,iz,Z0);
         }
     }
+    if(cache != nullptr){
+        cache->Update();
+        ionDensities = cache->GetIonDensities();
+    }
     if(collQtySettings->collfreq_mode==OptionConstants::COLLQTY_COLLISION_FREQUENCY_MODE_FULL)
         InitializeGSLWorkspace();
 }
@@ -154,14 +165,15 @@ void CollisionFrequency::AllocateRadialQuantities(){
     InitializeGSLWorkspace();
     Zs = new real_t[nZ];
     ionIndex = new real_t*[nZ];
-    ionDensities = new real_t*[nr];
     atomicParameter = new real_t[nzs];
 
     for(len_t iz=0;iz<nZ;iz++)
         ionIndex[iz] = new real_t[ionHandler->GetZ(iz)+1];
-    for(len_t ir=0; ir<nr;ir++)
-        ionDensities[ir] = new real_t[nzs];
-
+    if(cache == nullptr){
+        ionDensities = new real_t*[nr];
+        for(len_t ir=0; ir<nr;ir++)
+            ionDensities[ir] = new real_t[nzs];
+    }
 }
 
 
@@ -175,10 +187,12 @@ void CollisionFrequency::DeallocateRadialQuantities(){
 
         for(len_t iz=0;iz<nZ;iz++)
             delete [] ionIndex[iz];
-        for(len_t ir=0; ir<nr;ir++)
-            delete [] ionDensities[ir];
         delete [] ionIndex;
-        delete [] ionDensities;
+        if(cache == nullptr){
+            for(len_t ir=0; ir<nr;ir++)
+                delete [] ionDensities[ir];
+            delete [] ionDensities;
+        }
     }
 }
 
@@ -205,8 +219,10 @@ void CollisionFrequency::RebuildConstantTerms(){
         setIonTerm(ionTerm,mg->GetP(),np1,np2_store);
         setIonTerm(ionTerm_fr,mg->GetP(),np1,np2_store);
         if(isBrems){
+            // Evaluated on the same momentum grid
             setBremsTerm(bremsTerm,mg->GetP(),np1,np2_store);
-            setBremsTerm(bremsTerm_fr,mg->GetP(),np1,np2_store);
+            for(len_t i = 0; i<nzs*np1*np2_store; i++)
+                bremsTerm_fr[i] = bremsTerm[i];
         }
         if(isPartiallyScreened){
             setScreenedTerm(screenedTerm,mg->GetP(),np1,np2_store);
@@ -225,6 +241,10 @@ void CollisionFrequency::RebuildConstantTerms(){
         setScreenedTerm(screenedTerm_f1,mg->GetP_f1(),np1+1,np2_store);
         setScreenedTerm(screenedTerm_f2,mg->GetP_f2(),np1,np2_store+1);
     }
+    // Outside of 'FULL' mode, the free-electron term only depends on momentum
+    if(!electronTermDependsOnPlasma())
+        setElectronTerms();
+
     if(isNonlinear)
         calculateIsotropicNonlinearOperatorMatrix();
 }
@@ -262,7 +282,6 @@ void CollisionFrequency::SetPartialContributions(FVM::fluxGridType fluxGridType)
  * and puts them together to get the full thing.
  */
 void CollisionFrequency::AssembleQuantity(real_t **&collisionQuantity,  len_t nr, len_t np1, len_t np2, enum FVM::fluxGridType fluxGridType){
-    real_t collQty;
     real_t *ncold = unknowns->GetUnknownData(id_ncold);
 
     SetPartialContributions(fluxGridType);
@@ -273,18 +292,25 @@ void CollisionFrequency::AssembleQuantity(real_t **&collisionQuantity,  len_t nr
 
     len_t Nc = np1*np2;
     len_t nrNc = nr*Nc;
-    for(len_t ir=0; ir<nr; ir++)
-        for(len_t pind=0; pind<Nc; pind++){
-            // the collision frequencies are linear in ncold
-            collQty = ncold[ir]*nColdContribution[Nc*ir + pind];
-            len_t ind0 = ir*Nc + pind;
-            for(len_t indZ = 0; indZ<nzs; indZ++){
-                len_t ind = ind0 + indZ*nrNc;
-                // when subtracting the lnLambda terms, the collision frequencies are linear in ion densities
-                collQty += ionDensities[ir][indZ]*(ionContribution[ind] - ionLnLContrib[ind]);
-            }
-            collisionQuantity[ir][pind] = collQty; 
+    // The contributions are stored contiguously in momentum, so we
+    // accumulate one ion species at a time over all momenta (which
+    // allows the inner loops to be vectorized)
+    for(len_t ir=0; ir<nr; ir++){
+        real_t *cq = collisionQuantity[ir];
+        // the collision frequencies are linear in ncold
+        const real_t *nc = nColdContribution + Nc*ir;
+        for(len_t pind=0; pind<Nc; pind++)
+            cq[pind] = ncold[ir]*nc[pind];
+
+        for(len_t indZ = 0; indZ<nzs; indZ++){
+            const real_t ni = ionDensities[ir][indZ];
+            const real_t *ic = ionContribution + indZ*nrNc + ir*Nc;
+            const real_t *il = ionLnLContrib + indZ*nrNc + ir*Nc;
+            // when subtracting the lnLambda terms, the collision frequencies are linear in ion densities
+            for(len_t pind=0; pind<Nc; pind++)
+                cq[pind] += ni*(ic[pind] - il[pind]);
         }
+    }
 }
 
 
@@ -295,6 +321,13 @@ void CollisionFrequency::AssembleQuantity(real_t **&collisionQuantity,  len_t nr
  * for how it is used.
  */
 const real_t* CollisionFrequency::GetUnknownPartialContribution(len_t id_unknown, FVM::fluxGridType fluxGridType) const{
+    return PackPartialContribution(
+        GetCollisionGridPartialContribution(id_unknown, fluxGridType),
+        fluxGridType, (id_unknown == id_ni ? nzs : 1)
+    );
+}
+
+const real_t* CollisionFrequency::GetCollisionGridPartialContribution(len_t id_unknown, FVM::fluxGridType fluxGridType) const{
     if(id_unknown == id_ncold)
         return GetNColdPartialContribution(fluxGridType);
     else if(id_unknown == id_ni)
@@ -445,28 +478,36 @@ void CollisionFrequency::setScreenedTerm(real_t *&screenedTerm, const real_t *pI
 
 /**
  * Calculates and stores the bremsstrahlung contribution to the collision frequency.
+ * The momentum dependence is evaluated once per grid point and then scaled
+ * by the charge factor of each ion charge state.
  */
 void CollisionFrequency::setBremsTerm(real_t *&bremsTerm, const real_t *pIn, len_t np1, len_t np2){
     len_t ind;
     len_t N = np1*np2;
 
+    real_t *chargeFactor = new real_t[nzs];
+    for(len_t iz = 0; iz<nZ; iz++)
+        for(len_t Z0=0; Z0<=Zs[iz]; Z0++)
+            chargeFactor[(len_t)ionIndex[iz][Z0]] = GetBremsstrahlungChargeFactor(iz, Z0);
+
     if(isPXiGrid){
-        for(len_t i = 0; i<np1; i++)
-            for(len_t iz = 0; iz<nZ; iz++)
-                for(len_t Z0=0; Z0<=Zs[iz]; Z0++){
-                    ind = ionIndex[iz][Z0];
-                    real_t bremsAtP = evaluateBremsstrahlungTermAtP(iz, Z0, pIn[i], collQtySettings->bremsstrahlung_mode, collQtySettings->collfreq_type);
-                    for (len_t j = 0; j<np2; j++)
-                        bremsTerm[ind*N + np1*j + i] = bremsAtP;
-                }
+        for(len_t i = 0; i<np1; i++){
+            real_t shape = evaluateBremsstrahlungShapeAtP(pIn[i], collQtySettings->bremsstrahlung_mode, collQtySettings->collfreq_type);
+            for(ind = 0; ind<nzs; ind++){
+                real_t bremsAtP = chargeFactor[ind]*shape;
+                for (len_t j = 0; j<np2; j++)
+                    bremsTerm[ind*N + np1*j + i] = bremsAtP;
+            }
+        }
     } else {
-        for (len_t pind = 0; pind<N; pind++)
-            for(len_t iz = 0; iz<nZ; iz++)
-                for(len_t Z0=0; Z0<=Zs[iz]; Z0++){
-                    ind = ionIndex[iz][Z0];
-                    bremsTerm[ind*N + pind] = evaluateBremsstrahlungTermAtP(iz, Z0, pIn[pind], collQtySettings->bremsstrahlung_mode, collQtySettings->collfreq_type);
-                }
+        for (len_t pind = 0; pind<N; pind++){
+            real_t shape = evaluateBremsstrahlungShapeAtP(pIn[pind], collQtySettings->bremsstrahlung_mode, collQtySettings->collfreq_type);
+            for(ind = 0; ind<nzs; ind++)
+                bremsTerm[ind*N + pind] = chargeFactor[ind]*shape;
+        }
     }
+
+    delete [] chargeFactor;
 }
 
 
@@ -488,6 +529,18 @@ void CollisionFrequency::setElectronTerm(real_t **&nColdTerm, const real_t *pIn,
             
 }
 
+/**
+ * Calculates and stores the free-electron contribution on all grids.
+ */
+void CollisionFrequency::setElectronTerms(){
+    if (!buildOnlyF1F2){
+        setElectronTerm(nColdTerm,mg->GetP(),nr,np1,np2_store);
+        setElectronTerm(nColdTerm_fr,mg->GetP(),nr/*+1*/,np1,np2_store);
+    }
+    setElectronTerm(nColdTerm_f1,mg->GetP_f1(),nr,np1+1,np2_store);
+    setElectronTerm(nColdTerm_f2,mg->GetP_f2(),nr,np1,np2_store+1);
+}
+
 
 // PSI FUNCTIONS FOR EVALUATION OF "FULL" COLLFREQ_MODE 
 // Is the relativistic generalisation of the Chandrasekhar functions,
@@ -570,6 +623,8 @@ real_t CollisionFrequency::evaluatePsi0(len_t ir, real_t p) {
 
     bool superthermalLimit = isSuperthermalLimit(p,Theta);  
     bool lowenergyLimit = isLowEnergyLimit(p,Theta);
+    // (the table is only constructed the first time it is needed)
+    const PsiFunctionTable *psiTable = PsiFunctionTable::GetInstance();
     if(superthermalLimit){
         // asymptotic expansion described in doc/notes/psi0psi1evaluation
         real_t gamma = sqrt(1+p*p);
@@ -581,6 +636,8 @@ real_t CollisionFrequency::evaluatePsi0(len_t ir, real_t p) {
         return Term0 + Theta*Term1 + Theta*Theta*Term2; 
     } else if (lowenergyLimit){
         return evaluatePsiLowenergyLimit(0,p,Theta);
+    } else if (psiTable->IsTabulated(p,Theta)){
+        return psiTable->Evaluate(0,p,Theta);
     } else {
         gsl_function F;
         F.function = &(CollisionFrequency::psi0Integrand); 
@@ -602,6 +659,8 @@ real_t CollisionFrequency::evaluatePsi1(len_t ir, real_t p) {
 
     bool superthermalLimit = isSuperthermalLimit(p,Theta);  
     bool lowenergyLimit = isLowEnergyLimit(p,Theta);
+    // (the table is only constructed the first time it is needed)
+    const PsiFunctionTable *psiTable = PsiFunctionTable::GetInstance();
     if(superthermalLimit){
         // asymptotic expansion described in doc/notes/psi0psi1evaluation
         real_t gamma = sqrt(1+p*p);
@@ -613,7 +672,9 @@ real_t CollisionFrequency::evaluatePsi1(len_t ir, real_t p) {
         return Term0 + Theta*Term1 + Theta*Theta*Term2; 
     } else if (lowenergyLimit){
         return evaluatePsiLowenergyLimit(1,p,Theta);
-    }  else {
+    } else if (psiTable->IsTabulated(p,Theta)){
+        return psiTable->Evaluate(1,p,Theta);
+    } else {
         gsl_function F;
         F.function = &(CollisionFrequency::psi1Integrand); 
         F.params = &Theta;
@@ -631,6 +692,8 @@ real_t CollisionFrequency::evaluatePsi2(len_t ir, real_t p) {
 
     bool superthermalLimit = isSuperthermalLimit(p,Theta);  
     bool lowenergyLimit = isLowEnergyLimit(p,Theta);
+    // (the table is only constructed the first time it is needed)
+    const PsiFunctionTable *psiTable = PsiFunctionTable::GetInstance();
     if(superthermalLimit){
         // asymptotic expansion described in doc/notes/psi0psi1evaluation
         real_t gamma = sqrt(1+p*p);
@@ -642,7 +705,9 @@ real_t CollisionFrequency::evaluatePsi2(len_t ir, real_t p) {
         return Term0 + Theta*Term1 + Theta*Theta*Term2; 
     } else if (lowenergyLimit){
         return evaluatePsiLowenergyLimit(2,p,Theta);
-    }  else {
+    } else if (psiTable->IsTabulated(p,Theta)){
+        return psiTable->Evaluate(2,p,Theta);
+    } else {
         gsl_function F;
         F.function = &(CollisionFrequency::psi2Integrand); 
         F.params = &Theta;
@@ -676,11 +741,12 @@ void CollisionFrequency::SetNiPartialContribution(real_t **nColdTerm, real_t *io
     }
     
 
-    real_t **lnLEE_partialNi = new real_t*[nr];
-    real_t **lnLEI_partialNi = new real_t*[nr];
+    FVM::ScratchArena &scratch = FVM::ScratchArena::Get();
+    real_t **lnLEE_partialNi = scratch.Allocate<real_t*>(nr);
+    real_t **lnLEI_partialNi = scratch.Allocate<real_t*>(nr);
     for(len_t ir=0; ir<nr; ir++){
-        lnLEE_partialNi[ir] = new real_t[nzs];
-        lnLEI_partialNi[ir] = new real_t[nzs];
+        lnLEE_partialNi[ir] = scratch.Allocate<real_t>(nzs);
+        lnLEI_partialNi[ir] = scratch.Allocate<real_t>(nzs);
         for(len_t iz=0; iz<nZ; iz++)
             for(len_t Z0=0; Z0<=Zs[iz]; Z0++){
                 len_t indZ = ionIndex[iz][Z0]; 
@@ -711,20 +777,19 @@ void CollisionFrequency::SetNiPartialContribution(real_t **nColdTerm, real_t *io
             }      
         }
     else {
-        for(len_t i = 0; i<np1; i++)
-            for(len_t j = 0; j<np2; j++){
-                pind = np1*j+i;                
-                for(len_t ir = 0; ir<nr; ir++){
-                    real_t ntarget = GetNTarget(ir, isNonScreened);
-                    electronTerm = ntarget*nColdTerm[ir][pind]*preFactor[pind];
-                    for(len_t indZ=0; indZ<nzs; indZ++){
-                        len_t ind = (indZ*nr+ir)*N + pind;
-                        real_t lnLContrib = electronTerm * lnLEE_partialNi[ir][indZ];
-                        ionLnLContrib[ind] += lnLContrib; 
-                        partQty[ind] += lnLContrib;
-                    }
+        for(len_t ir = 0; ir<nr; ir++){
+            real_t ntarget = GetNTarget(ir, isNonScreened);
+            for(len_t indZ=0; indZ<nzs; indZ++){
+                const real_t dLnL = lnLEE_partialNi[ir][indZ];
+                real_t *pq = partQty + (indZ*nr+ir)*N;
+                real_t *pl = ionLnLContrib + (indZ*nr+ir)*N;
+                for(len_t pind = 0; pind<N; pind++){
+                    real_t lnLContrib = ntarget*nColdTerm[ir][pind]*preFactor[pind] * dLnL;
+                    pl[pind] += lnLContrib; 
+                    pq[pind] += lnLContrib;
                 }
-            }           
+            }
+        }
     }
     if(hasIonTerm){
         if(isPXiGrid){
@@ -754,24 +819,26 @@ void CollisionFrequency::SetNiPartialContribution(real_t **nColdTerm, real_t *io
                 }
             }
         } else {
-            for(len_t pind = 0; pind<N; pind++)
-                for(len_t ir = 0; ir<nr; ir++){
-                    partContrib = preFactor[pind]*lnLei[ir][pind];
-                    for(len_t iz=0; iz<nZ; iz++)
-                        for(len_t Z0=0; Z0<=Zs[iz]; Z0++){
-                            indZ = ionIndex[iz][Z0]; 
-                            len_t ind = (indZ*nr+ir)*N + pind;
-                            real_t DpartContrib = ionDensities[ir][indZ] * preFactor[pind] * lnLEI_partialNi[ir][indZ];
-                            len_t Zfact;
-                            if(isNonScreened)
-                                Zfact = Zs[iz]*Zs[iz]*ionTerm[indZ*N+pind];
-                            else 
-                                Zfact = Z0*Z0*ionTerm[indZ*N+pind];
+            for(len_t ir = 0; ir<nr; ir++)
+                for(len_t iz=0; iz<nZ; iz++)
+                    for(len_t Z0=0; Z0<=Zs[iz]; Z0++){
+                        indZ = ionIndex[iz][Z0]; 
+                        const len_t Z2 = isNonScreened ? Zs[iz]*Zs[iz] : Z0*Z0;
+                        const real_t ni = ionDensities[ir][indZ];
+                        const real_t dLnL = lnLEI_partialNi[ir][indZ];
+                        const real_t *iT = ionTerm + indZ*N;
+                        const real_t *lnL = lnLei[ir];
+                        real_t *pq = partQty + (indZ*nr+ir)*N;
+                        real_t *pl = ionLnLContrib + (indZ*nr+ir)*N;
+                        for(len_t pind = 0; pind<N; pind++){
+                            partContrib = preFactor[pind]*lnL[pind];
+                            real_t DpartContrib = ni * preFactor[pind] * dLnL;
+                            len_t Zfact = Z2*iT[pind];
                             real_t lnLContrib = Zfact*DpartContrib;
-                            ionLnLContrib[ind] += lnLContrib;
-                            partQty[ind] += Zfact*partContrib + lnLContrib;
+                            pl[pind] += lnLContrib;
+                            pq[pind] += Zfact*partContrib + lnLContrib;
                         }
-                }
+                    }
         }
     }
     if(isBrems){
@@ -781,40 +848,42 @@ void CollisionFrequency::SetNiPartialContribution(real_t **nColdTerm, real_t *io
         else 
             np2_store = np2;
         len_t N_store = np1*np2_store;
-        for(len_t i = 0; i<np1; i++)
-            for(len_t j = 0; j<np2; j++){
-                pind = np1*j+i;
-                if(isPXiGrid) 
-                    pindStore = i;
-                else 
-                    pindStore = pind;
-                for(len_t indZ=0; indZ<nzs; indZ++){
-                    real_t bT = bremsTerm[indZ*N_store+pindStore];
-                    len_t indN = indZ*nr*N + pind;
-                    len_t Nmax = indN + nr*N;
-                    for(len_t ir = indN; ir<Nmax; ir+=N)
-                        partQty[ir] += bT;
-                }
-            }       
-    } if(isNonScreened)
-        for(len_t i = 0; i<np1; i++)
-            for(len_t j = 0; j<np2; j++){
-                pind = np1*j+i;
-                if(isPXiGrid)
-                    pindStore = i;
-                else
-                    pindStore = pind;
-                
-                for(len_t ir = 0; ir<nr; ir++){
-                    electronTerm = nColdTerm[ir][pindStore]*preFactor[pindStore]*lnLee[ir][pind];
-                    for(len_t iz=0; iz<nZ; iz++)
-                        for(len_t Z0=0; Z0<=Zs[iz]; Z0++){
-                            indZ = ionIndex[iz][Z0]; 
-                            partQty[(indZ*nr+ir)*N + pind] += (Zs[iz]-Z0)*electronTerm;
-                        }
+        for(len_t indZ=0; indZ<nzs; indZ++){
+            const real_t *bT = bremsTerm + indZ*N_store;
+            for(len_t ir = 0; ir<nr; ir++){
+                real_t *pq = partQty + (indZ*nr+ir)*N;
+                for(len_t j = 0; j<np2; j++){
+                    const real_t *bTj = isPXiGrid ? bT : (bT + np1*j);
+                    for(len_t i = 0; i<np1; i++)
+                        pq[np1*j+i] += bTj[i];
                 }
             }
-    else if(isPartiallyScreened){
+        }
+    } if(isNonScreened){
+        // Electron term, evaluated once per radius and then
+        // added to the contribution of each ion charge state
+        real_t *eTerm = scratch.Allocate<real_t>(N);
+        for(len_t ir = 0; ir<nr; ir++){
+            for(len_t j = 0; j<np2; j++)
+                for(len_t i = 0; i<np1; i++){
+                    pind = np1*j+i;
+                    if(isPXiGrid)
+                        pindStore = i;
+                    else
+                        pindStore = pind;
+                    eTerm[pind] = nColdTerm[ir][pindStore]*preFactor[pindStore]*lnLee[ir][pind];
+                }
+
+            for(len_t iz=0; iz<nZ; iz++)
+                for(len_t Z0=0; Z0<=Zs[iz]; Z0++){
+                    indZ = ionIndex[iz][Z0]; 
+                    const len_t nBound = Zs[iz]-Z0;
+                    real_t *pq = partQty + (indZ*nr+ir)*N;
+                    for(len_t pind = 0; pind<N; pind++)
+                        pq[pind] += nBound*eTerm[pind];
+                }
+        }
+    } else if(isPartiallyScreened){
         if(isPXiGrid){
             len_t np2_store = 1 + np2 - this->np2; // account for the +1 on p2 flux grid
             for(len_t i = 0; i<np1; i++)
@@ -827,18 +896,15 @@ void CollisionFrequency::SetNiPartialContribution(real_t **nColdTerm, real_t *io
                             partQty[j] += tmpQty;
                     }
         } else 
-            for(len_t pind = 0; pind<N; pind++)
-                for(len_t indZ=0; indZ<nzs; indZ++)
-                    for(len_t ir = 0; ir<nr; ir++)
-                        partQty[(indZ*nr + ir)*N + pind] += preFactor[pind]*screenedTerm[indZ*N + pind];
-    }
-    
-    for(len_t ir=0; ir<nr; ir++){
-        delete [] lnLEE_partialNi[ir];
-        delete [] lnLEI_partialNi[ir];
+            for(len_t indZ=0; indZ<nzs; indZ++){
+                const real_t *sT = screenedTerm + indZ*N;
+                for(len_t ir = 0; ir<nr; ir++){
+                    real_t *pq = partQty + (indZ*nr + ir)*N;
+                    for(len_t pind = 0; pind<N; pind++)
+                        pq[pind] += preFactor[pind]*sT[pind];
+                }
+            }
     }
-    delete [] lnLEE_partialNi;
-    delete [] lnLEI_partialNi;
 }
 
 
@@ -846,23 +912,20 @@ void CollisionFrequency::SetNColdPartialContribution(real_t **nColdTerm,real_t *
     len_t N = np1*np2*nr;
     if(partQty==nullptr)
         partQty = new real_t[N];
-    for(len_t it=0; it < N; it++)
-        partQty[it] = 0;
 
-    len_t pind, pindStore;
     N = np1*np2;
-    for(len_t i = 0; i<np1; i++)
-        for(len_t j = 0; j<np2; j++){
-            pind = np1*j+i;
-            if(isPXiGrid)
-                pindStore = i;
-            else
-                pindStore = pind;
-            
-            // TODO: Possible optimization: if(isPXiGrid), calculate RHS outside the j loop
-            for(len_t ir = 0; ir<nr; ir++)
-                partQty[N*ir + pind] = nColdTerm[ir][pindStore]*preFactor[pindStore]*lnLee[ir][pind];
-        }
+    for(len_t ir = 0; ir<nr; ir++){
+        const real_t *nC = nColdTerm[ir];
+        const real_t *lnL = lnLee[ir];
+        real_t *pq = partQty + N*ir;
+        if(isPXiGrid)
+            for(len_t j = 0; j<np2; j++)
+                for(len_t i = 0; i<np1; i++)
+                    pq[np1*j+i] = nC[i]*preFactor[i]*lnL[np1*j+i];
+        else
+            for(len_t pind = 0; pind<N; pind++)
+                pq[pind] = nC[pind]*preFactor[pind]*lnL[pind];
+    }
 }
 
 
@@ -894,8 +957,8 @@ void CollisionFrequency::SetTColdPartialContribution(real_t **nColdTerm, real_t
                 }
             }
     else
-        for(len_t pind=0;pind<N;pind++)
-            for(len_t ir=0; ir<nr; ir++){
+        for(len_t ir=0; ir<nr; ir++)
+            for(len_t pind=0;pind<N;pind++){
                 real_t dLnL = lnLambdaEE->evaluatePartialAtP(ir,pIn[pind],id_Tcold,0);
                 TColdPartialContribution[N*ir + pind] = ncold[ir]*preFactor[pind] * 
                     (lnLee[ir][pind]*evaluateDDTElectronTermAtP(ir,pIn[pind],collQtySettings->collfreq_mode) + dLnL * nColdTerm[ir][pind]);
@@ -922,23 +985,34 @@ void CollisionFrequency::SetTColdPartialContribution(real_t **nColdTerm, real_t
                                 TColdPartialContribution[j] += TCold_tmp;
                         }
                 }
-        } else
-            for(len_t i=0;i<np1;i++)
-                for(len_t j=0;j<np2;j++){
-                    pind = np1*j+i;
-                    for(len_t iz = 0; iz<nZ; iz++)
-                        for(len_t Z0=0; Z0<=Zs[iz]; Z0++){
-                            indZ = ionIndex[iz][Z0];
-                            if(isNonScreened)
-                                Zfact = Zs[iz]*Zs[iz];
-                            else
-                                Zfact = Z0*Z0;
-                            real_t PZFactor = Zfact * preFactor[pind] * ionTerm[indZ*N+pind];
-                            for(len_t ir=0; ir<nr; ir++)
-                                TColdPartialContribution[N*ir + pind] += PZFactor * lnLambdaEI->evaluatePartialAtP(ir, pIn[pind], id_Tcold, 0) * ionDensities[ir][indZ];
+        } else {
+            // The lnLambda derivative does not depend on the ion species,
+            // so it is tabulated once rather than for every charge state
+            real_t *lnLEI_partialT = FVM::ScratchArena::Get().Allocate<real_t>(nr*N);
+            for(len_t ir=0; ir<nr; ir++)
+                for(len_t pind=0; pind<N; pind++)
+                    lnLEI_partialT[N*ir + pind] = lnLambdaEI->evaluatePartialAtP(ir, pIn[pind], id_Tcold, 0);
+
+            for(len_t iz = 0; iz<nZ; iz++)
+                for(len_t Z0=0; Z0<=Zs[iz]; Z0++){
+                    indZ = ionIndex[iz][Z0];
+                    if(isNonScreened)
+                        Zfact = Zs[iz]*Zs[iz];
+                    else
+                        Zfact = Z0*Z0;
+                    const real_t *iT = ionTerm + indZ*N;
+                    for(len_t ir=0; ir<nr; ir++){
+                        const real_t ni = ionDensities[ir][indZ];
+                        const real_t *dLnL = lnLEI_partialT + N*ir;
+                        real_t *TC = TColdPartialContribution + N*ir;
+                        for(len_t pind=0; pind<N; pind++){
+                            real_t PZFactor = Zfact * preFactor[pind] * iT[pind];
+                            TC[pind] += PZFactor * dLnL[pind] * ni;
                         }
+                    }
                 }
-            }
+        }
+    }
 }
 
 /**
@@ -980,17 +1054,20 @@ void CollisionFrequency::AllocatePartialQuantities(){
     InitializeGSLWorkspace();
     Zs = new real_t[nZ];
     ionIndex = new real_t*[nZ];
-    ionDensities = new real_t*[nr];
     atomicParameter = new real_t[nzs];
 
-    K0Scaled = new real_t[nr];
-    K1Scaled = new real_t[nr];
-    K2Scaled = new real_t[nr];
+    // (owned by the cache, if used)
+    if(cache == nullptr){
+        ionDensities = new real_t*[nr];
+        K0Scaled = new real_t[nr];
+        K1Scaled = new real_t[nr];
+        K2Scaled = new real_t[nr];
+        for(len_t ir=0; ir<nr;ir++)
+            ionDensities[ir] = new real_t[nzs];
+    }
 
     for(len_t iz=0;iz<nZ;iz++)
         ionIndex[iz] = new real_t[ionHandler->GetZ(iz)+1];
-    for(len_t ir=0; ir<nr;ir++)
-        ionDensities[ir] = new real_t[nzs];
     if(!buildOnlyF1F2){
         preFactor    = new real_t[np1*np2_store];
         preFactor_fr = new real_t[np1*np2_store];
@@ -1075,13 +1152,15 @@ void CollisionFrequency::DeallocatePartialQuantities(){
         delete [] Zs;
         for(len_t iz=0; iz<nZ; iz++)
             delete [] ionIndex[iz];
-        for(len_t ir=0; ir<nr;ir++)
-            delete [] ionDensities[ir];
-        
         delete [] ionIndex;
-        delete [] ionDensities; 
+
+        if(cache == nullptr){
+            for(len_t ir=0; ir<nr;ir++)
+                delete [] ionDensities[ir];
+            delete [] ionDensities; 
+        }
     }
-    if(K0Scaled != nullptr){
+    if(K0Scaled != nullptr && cache == nullptr){
         delete [] K0Scaled;
         delete [] K1Scaled;
         delete [] K2Scaled;
@@ -0,0 +1,128 @@
+/**
+ * Implementation of a cache for the radial (momentum-independent)
+ * plasma parameters used by the collision frequencies, namely the ion
+ * densities (stored per radius) and the scaled Bessel functions of the
+ * inverse normalized temperature appearing in the collision frequencies
+ * of thermal electrons.
+ *
+ * These quantities are identical in all 'CollisionFrequency' objects of
+ * a simulation (slowing-down and pitch-angle scattering frequencies, on
+ * the hot-tail and runaway grids, as well as those of 'RunawayFluid').
+ * The cache is shared between those objects, and the quantities are only
+ * re-evaluated when the versions of 'T_cold' or 'n_i' change. The
+ * momentum-dependent parts of the collision frequencies differ between
+ * grids, and are still evaluated by each object.
+ */
+
+#include "DREAM/Constants.hpp"
+#include "DREAM/Equations/CollisionFrequencyCache.hpp"
+#include "DREAM/Settings/OptionConstants.hpp"
+#include "gsl/gsl_sf_bessel.h"
+
+
+using namespace DREAM;
+
+
+/**
+ * Constructor.
+ */
+CollisionFrequencyCache::CollisionFrequencyCache(
+    FVM::RadialGrid *rGrid, FVM::UnknownQuantityHandler *u, IonHandler *ih
+) : rGrid(rGrid), unknowns(u), ionHandler(ih) {
+    this->id_Tcold = u->GetUnknownID(OptionConstants::UQTY_T_COLD);
+    this->id_ni    = u->GetUnknownID(OptionConstants::UQTY_ION_SPECIES);
+}
+
+/**
+ * Destructor.
+ */
+CollisionFrequencyCache::~CollisionFrequencyCache() {
+    Deallocate();
+}
+
+
+/**
+ * (Re-)allocate the stored quantities for the current
+ * number of radial grid points and ion charge states.
+ */
+void CollisionFrequencyCache::Allocate() {
+    Deallocate();
+
+    this->nr  = rGrid->GetNr();
+    this->nzs = ionHandler->GetNzs();
+
+    this->ionDensities = new real_t*[nr];
+    for (len_t ir = 0; ir < nr; ir++)
+        this->ionDensities[ir] = new real_t[nzs];
+
+    this->K0Scaled = new real_t[nr];
+    this->K1Scaled = new real_t[nr];
+    this->K2Scaled = new real_t[nr];
+
+    this->valid_ni = this->valid_Tcold = false;
+}
+
+/**
+ * Deallocate the stored quantities.
+ */
+void CollisionFrequencyCache::Deallocate() {
+    if (this->ionDensities != nullptr) {
+        for (len_t ir = 0; ir < nr; ir++)
+            delete [] this->ionDensities[ir];
+        delete [] this->ionDensities;
+
+        delete [] this->K0Scaled;
+        delete [] this->K1Scaled;
+        delete [] this->K2Scaled;
+    }
+
+    this->ionDensities = nullptr;
+    this->K0Scaled = this->K1Scaled = this->K2Scaled = nullptr;
+}
+
+
+/**
+ * Make sure that the stored quantities correspond to the
+ * current plasma parameters, re-evaluating them if necessary.
+ * Note that the arrays may be reallocated if the grid has
+ * changed, and so pointers obtained from 'Get*()' must be
+ * refreshed after each call to this method.
+ *
+ * RETURNS true if any of the quantities were re-evaluated.
+ */
+bool CollisionFrequencyCache::Update() {
+    if (this->nr != rGrid->GetNr() || this->nzs != ionHandler->GetNzs() || this->ionDensities == nullptr)
+        Allocate();
+
+    bool updated = false;
+
+    const len_t vni = unknowns->GetVersion(id_ni);
+    if (!this->valid_ni || vni != this->version_ni) {
+        // (n_i is stored with radius as the fastest index)
+        const real_t *ni = unknowns->GetUnknownData(id_ni);
+        for (len_t indZ = 0; indZ < nzs; indZ++)
+            for (len_t ir = 0; ir < nr; ir++)
+                this->ionDensities[ir][indZ] = ni[indZ*nr + ir];
+
+        this->version_ni = vni;
+        this->valid_ni = true;
+        updated = true;
+    }
+
+    const len_t vT = unknowns->GetVersion(id_Tcold);
+    if (!this->valid_Tcold || vT != this->version_Tcold) {
+        const real_t *T_cold = unknowns->GetUnknownData(id_Tcold);
+        for (len_t ir = 0; ir < nr; ir++) {
+            const real_t Theta = T_cold[ir] / Constants::mc2inEV;
+            this->K0Scaled[ir] = gsl_sf_bessel_Kn_scaled(0, 1.0/Theta);
+            this->K1Scaled[ir] = gsl_sf_bessel_Kn_scaled(1, 1.0/Theta);
+            this->K2Scaled[ir] = gsl_sf_bessel_Kn_scaled(2, 1.0/Theta);
+        }
+
+        this->version_Tcold = vT;
+        this->valid_Tcold = true;
+        updated = true;
+    }
+
+    return updated;
+}
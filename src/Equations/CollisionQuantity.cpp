@@ -2,6 +2,8 @@
  * Implementation of a class from which the Coulomb logarithms and collision frequencies are derived.
  */
 
+#include <algorithm>
+#include <cmath>
 #include "DREAM/Equations/CollisionQuantity.hpp"
 //#include "DREAM/Constants.hpp"
 //#include "DREAM/Settings/OptionConstants.hpp"
@@ -17,6 +19,8 @@ CollisionQuantity::CollisionQuantity(FVM::Grid *g, FVM::UnknownQuantityHandler *
                 enum OptionConstants::momentumgrid_type mgtype,  struct collqty_settings *cqset){
     mg = g->GetMomentumGrid(0);
     rGrid = g->GetRadialGrid();
+    grid = g;
+    isRadiallyUniform = g->HasRadiallyUniformMomentumGrid();
 
     collQtySettings = cqset;
     ionHandler = ih;
@@ -28,6 +32,10 @@ CollisionQuantity::CollisionQuantity(FVM::Grid *g, FVM::UnknownQuantityHandler *
     isNonScreened = (collQtySettings->collfreq_type==OptionConstants::COLLQTY_COLLISION_FREQUENCY_TYPE_NON_SCREENED);
     isNonlinear = (collQtySettings->nonlinear_mode == OptionConstants::EQTERM_NONLINEAR_MODE_NON_REL_ISOTROPIC);
     isBrems = (collQtySettings->bremsstrahlung_mode != OptionConstants::EQTERM_BREMSSTRAHLUNG_MODE_NEGLECT);
+
+    if (!isRadiallyUniform)
+        SetCollisionMomentumGrid(g);
+
     // ID of quantities that contribute to collision frequencies
     id_ncold = unknowns->GetUnknownID(OptionConstants::UQTY_N_COLD);
     id_ni    = unknowns->GetUnknownID(OptionConstants::UQTY_ION_SPECIES);
@@ -53,6 +61,45 @@ CollisionQuantity::CollisionQuantity(FVM::Grid *g, FVM::UnknownQuantityHandler *
  */
 CollisionQuantity::~CollisionQuantity(){
     DeallocateCollisionQuantities();
+
+    for (len_t i = 0; i < 4; i++)
+        delete [] packedPartialContribution[i];
+}
+
+/**
+ * Select the momentum grid on which to evaluate the collision
+ * quantities when the momentum grid of 'g' varies with radius.
+ * The collision quantities are then evaluated on the grid with
+ * the most xi cells, which requires all radii to use p-xi grids
+ * with the same p grid.
+ */
+void CollisionQuantity::SetCollisionMomentumGrid(FVM::Grid *g){
+    if (!isPXiGrid)
+        throw NotImplementedException(
+            "Collision quantities: Radially varying momentum grids are only supported for p-xi grids."
+        );
+    if (isNonlinear)
+        throw NotImplementedException(
+            "Collision quantities: Non-linear collisions are not supported with radially varying momentum grids."
+        );
+
+    const len_t np = mg->GetNp1();
+    const real_t *pf = mg->GetP1_f();
+    for (len_t ir = 1; ir < g->GetNr(); ir++) {
+        FVM::MomentumGrid *m = g->GetMomentumGrid(ir);
+        bool sameP = (m->GetNp1() == np);
+        for (len_t i = 0; sameP && i <= np; i++)
+            sameP = (std::abs(m->GetP1_f(i)-pf[i]) <= 1e-12*std::max(1.0, std::abs(pf[i])));
+
+        if (!sameP)
+            throw NotImplementedException(
+                "Collision quantities: The momentum grids at different radii must "
+                "use the same p grid (only the xi grid may vary with radius)."
+            );
+
+        if (m->GetNp2() > mg->GetNp2())
+            mg = m;
+    }
 }
 
 /**
@@ -122,6 +169,55 @@ real_t CollisionQuantity::evaluatePartialAtP(len_t ir, real_t p, len_t derivId,
 }
 
 
+/**
+ * Rearrange a partial contribution to the collision quantity, given
+ * on the collision momentum grid 'mg' at all radii, to follow the
+ * layout of the (radially varying) momentum grids of 'grid', so that
+ * the values at radius 'ir' start right after those at 'ir-1'. This
+ * amounts to keeping the first xi rows at each radius (see the comment
+ * on 'mg' in the header). The returned array is only valid until the
+ * next call to this method with the same flux grid type.
+ *
+ * partQty:       Partial contribution, with 'nMultiples' blocks of
+ *                'nr' radii of values on 'mg'.
+ * fluxGridType:  Flux grid on which the contribution is given.
+ * nMultiples:    Number of blocks in 'partQty' (e.g. one per ion
+ *                charge state).
+ */
+const real_t *CollisionQuantity::PackPartialContribution(
+    const real_t *partQty, FVM::fluxGridType fluxGridType, const len_t nMultiples
+) const {
+    if (partQty == nullptr || isRadiallyUniform)
+        return partQty;
+
+    const len_t n1 = np1 + (fluxGridType==FVM::FLUXGRIDTYPE_P1);
+    const len_t N  = n1 * (np2 + (fluxGridType==FVM::FLUXGRIDTYPE_P2));
+
+    len_t Ntot = 0;
+    for (len_t ir = 0; ir < nr; ir++)
+        Ntot += n1 * grid->GetNp2(ir, fluxGridType);
+
+    real_t *&packed = packedPartialContribution[fluxGridType];
+    len_t &size = packedPartialContributionSize[fluxGridType];
+    if (size < nMultiples*Ntot) {
+        delete [] packed;
+        size = nMultiples*Ntot;
+        packed = new real_t[size];
+    }
+
+    real_t *out = packed;
+    for (len_t n = 0; n < nMultiples; n++)
+        for (len_t ir = 0; ir < nr; ir++) {
+            const len_t Nr = n1 * grid->GetNp2(ir, fluxGridType);
+            const real_t *in = partQty + (n*nr+ir)*N;
+            std::copy(in, in+Nr, out);
+            out += Nr;
+        }
+
+    return packed;
+}
+
+
 /**
  * Allocate quantities
  */
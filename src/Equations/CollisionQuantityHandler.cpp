@@ -11,13 +11,16 @@ using namespace DREAM;
  * Constructor
  */ 
 CollisionQuantityHandler::CollisionQuantityHandler(FVM::Grid *grid, FVM::UnknownQuantityHandler *u, 
-    IonHandler *ih,  enum OptionConstants::momentumgrid_type gridtype,  CollisionQuantity::collqty_settings *cqset)
+    IonHandler *ih,  enum OptionConstants::momentumgrid_type gridtype,  CollisionQuantity::collqty_settings *cqset,
+    CoulombLogarithmCache *lnLambdaCache, CollisionFrequencyCache *collFreqCache)
         : unknowns(u), ionHandler(ih),collQtySettings(cqset) 
 {
-    lnLambdaEE = new CoulombLogarithm(grid, unknowns, ionHandler, gridtype, collQtySettings,CollisionQuantity::LNLAMBDATYPE_EE);
-    lnLambdaEI = new CoulombLogarithm(grid, unknowns, ionHandler, gridtype, collQtySettings,CollisionQuantity::LNLAMBDATYPE_EI);
+    lnLambdaEE = new CoulombLogarithm(grid, unknowns, ionHandler, gridtype, collQtySettings,CollisionQuantity::LNLAMBDATYPE_EE,lnLambdaCache);
+    lnLambdaEI = new CoulombLogarithm(grid, unknowns, ionHandler, gridtype, collQtySettings,CollisionQuantity::LNLAMBDATYPE_EI,lnLambdaCache);
     nuS   = new SlowingDownFrequency(grid, unknowns, ionHandler, lnLambdaEE,lnLambdaEI,gridtype, collQtySettings);
     nuD   = new PitchScatterFrequency(grid, unknowns, ionHandler, lnLambdaEI,lnLambdaEE,gridtype, collQtySettings);
+    nuS->SetCache(collFreqCache);
+    nuD->SetCache(collFreqCache);
     nuPar = new ParallelDiffusionFrequency(grid, unknowns, ionHandler, nuS,lnLambdaEE, gridtype, collQtySettings);
 }
 
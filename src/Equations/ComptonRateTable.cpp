@@ -0,0 +1,195 @@
+/**
+ * Implementation of a table of the runaway rate due to Compton
+ * scattering of gamma photons,
+ *
+ *   R(pc) = int_{Eg_min(pc)}^inf Gamma_flux(Eg) sigma(Eg, pc) dEg,
+ *
+ * (see 'RunawayFluid::evaluateComptonRate()'), which would otherwise
+ * be evaluated with adaptive quadrature at every radius, together with
+ * its derivative with respect to pc, every time the runaway growth
+ * rates are rebuilt. The photon spectrum is fixed (and the rate is
+ * proportional to the total photon flux), so that R/flux is a smooth
+ * function of pc alone.
+ *
+ * The table is built in the coordinate x = ln(pc), in which ln(R) varies
+ * slowly. Since the derivative of R is known (as a quadrature), we use
+ * cubic Hermite interpolation of ln(R), and the derivative returned is
+ * that of the interpolant (so that the jacobian stays consistent with
+ * the tabulated rate). The resolution of the table is increased until
+ * the interpolation error of both the rate and its derivative, measured
+ * against quadrature in the middle of every table cell, is below
+ * 'RELTOL'. Points outside of the table are evaluated using quadrature.
+ *
+ * The table does not depend on the plasma and is therefore constructed
+ * once, the first time it is requested, and then shared by all
+ * 'RunawayFluid' objects.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "DREAM/Equations/ComptonRateTable.hpp"
+#include "DREAM/Equations/RunawayFluid.hpp"
+#include "DREAM/IO.hpp"
+#include "FVM/FVMException.hpp"
+
+
+using namespace DREAM;
+
+
+/**
+ * Constructor.
+ */
+ComptonRateTable::ComptonRateTable() {
+    this->gsl_ad_w = gsl_integration_workspace_alloc(1000);
+
+    len_t n = 65;
+    real_t err = INFINITY;
+    try {
+        while (true) {
+            this->Build(n);
+
+            err = this->GetMaxMidpointError();
+            if (err <= RELTOL) {
+                this->valid = true;
+                break;
+            } else if (2*n-1 > MAX_N)
+                break;
+
+            n = 2*n-1;
+        }
+    } catch (FVM::FVMException&) {
+        // (the quadrature failed to reach the requested accuracy)
+        this->valid = false;
+    }
+
+    if (!this->valid)
+        DREAM::IO::PrintWarning(
+            "Unable to tabulate the Compton runaway rate to a relative accuracy of %e "
+            "(reached %e). Falling back to quadrature.", RELTOL, err
+        );
+}
+
+/**
+ * Destructor.
+ */
+ComptonRateTable::~ComptonRateTable() {
+    if (this->table != nullptr)
+        delete [] this->table;
+
+    gsl_integration_workspace_free(this->gsl_ad_w);
+}
+
+/**
+ * Returns the (shared) Compton rate table, constructing
+ * it the first time this method is called.
+ */
+const ComptonRateTable *ComptonRateTable::GetInstance() {
+    // Initialization of local statics is thread-safe
+    static ComptonRateTable instance;
+    return &instance;
+}
+
+/**
+ * Build the table using the given number of points in x.
+ */
+void ComptonRateTable::Build(const len_t n) {
+    this->n = n;
+    this->x0 = log(PC_MIN);
+    this->h = (log(PC_MAX) - this->x0) / (n-1);
+
+    if (this->table != nullptr)
+        delete [] this->table;
+
+    this->table = new real_t[2*n];
+    for (len_t i = 0; i < n; i++) {
+        const real_t pc = exp(x0 + i*h);
+        const real_t R = RunawayFluid::evaluateComptonRate(pc, 1, this->gsl_ad_w, QUADRATURE_RELTOL);
+        const real_t dR = RunawayFluid::evaluateDComptonRateDpc(pc, 1, this->gsl_ad_w, QUADRATURE_RELTOL);
+
+        this->table[2*i]   = log(R);
+        this->table[2*i+1] = pc*dR / R;
+    }
+}
+
+/**
+ * Returns the largest relative interpolation error of the rate and
+ * its derivative in the middle of the table cells (where the error
+ * is expected to be largest).
+ */
+real_t ComptonRateTable::GetMaxMidpointError() {
+    real_t maxerr = 0;
+    for (len_t i = 0; i+1 < n; i++) {
+        const real_t x = x0 + (i+0.5)*h;
+        const real_t pc = exp(x);
+        const real_t R = RunawayFluid::evaluateComptonRate(pc, 1, this->gsl_ad_w, QUADRATURE_RELTOL);
+        const real_t dR = RunawayFluid::evaluateDComptonRateDpc(pc, 1, this->gsl_ad_w, QUADRATURE_RELTOL);
+
+        real_t dRi;
+        const real_t Ri = this->Evaluate(pc, 1, &dRi);
+
+        const real_t err = std::max(fabs(Ri - R)/R, fabs(dRi - dR)/fabs(dR));
+        if (!std::isfinite(err))
+            return err;
+        else if (err > maxerr)
+            maxerr = err;
+    }
+
+    return maxerr;
+}
+
+/**
+ * Evaluate the interpolated value of ln(R) at x = ln(pc).
+ *
+ * x:     Point to evaluate the interpolant at.
+ * dydx:  On return, contains the derivative of the interpolant
+ *        with respect to x.
+ */
+real_t ComptonRateTable::Interpolate(const real_t x, real_t *dydx) const {
+    len_t i = (len_t)((x-x0)/h);
+    if (i > n-2) i = n-2;
+
+    const real_t t = (x-x0)/h - i;
+    const real_t *N = this->table + 2*i;
+
+    // Cubic Hermite basis functions, and their derivatives
+    const real_t ht[4] = {
+        (1+2*t)*(1-t)*(1-t), t*(1-t)*(1-t)*h,
+        t*t*(3-2*t),         t*t*(t-1)*h
+    };
+    const real_t dht[4] = {
+        6*t*(t-1)/h,         (1-t)*(1-3*t),
+        6*t*(1-t)/h,         t*(3*t-2)
+    };
+
+    *dydx = dht[0]*N[0] + dht[1]*N[1] + dht[2]*N[2] + dht[3]*N[3];
+    return ht[0]*N[0] + ht[1]*N[1] + ht[2]*N[2] + ht[3]*N[3];
+}
+
+/**
+ * Returns true if the Compton rate at the given critical
+ * momentum is covered by the table.
+ */
+bool ComptonRateTable::IsTabulated(const real_t pc) const {
+    return (this->valid && pc >= PC_MIN && pc <= PC_MAX);
+}
+
+/**
+ * Evaluate the Compton runaway rate at the given critical momentum
+ * (which must be covered by the table; see 'IsTabulated()').
+ *
+ * pc:         Critical runaway momentum.
+ * photonFlux: Total flux of gamma photons.
+ * dRdpc:      If not 'nullptr', contains the derivative of the
+ *             rate with respect to pc on return.
+ */
+real_t ComptonRateTable::Evaluate(
+    const real_t pc, const real_t photonFlux, real_t *dRdpc
+) const {
+    real_t dydx;
+    const real_t R = photonFlux * exp(Interpolate(log(pc), &dydx));
+
+    if (dRdpc != nullptr)
+        *dRdpc = R * dydx / pc;
+
+    return R;
+}
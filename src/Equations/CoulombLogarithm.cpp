@@ -21,7 +21,8 @@ using namespace DREAM;
  */
 CoulombLogarithm::CoulombLogarithm(FVM::Grid *g, FVM::UnknownQuantityHandler *u, IonHandler *ih,  
                 enum OptionConstants::momentumgrid_type mgtype,  struct collqty_settings *cqset,
-                CollisionQuantity::LnLambdaType lnLambdaType):CollisionQuantity(g,u,ih,mgtype,cqset){
+                CollisionQuantity::LnLambdaType lnLambdaType, CoulombLogarithmCache *cache)
+                :CollisionQuantity(g,u,ih,mgtype,cqset), cache(cache) {
     if(lnLambdaType==CollisionQuantity::LNLAMBDATYPE_EE)
         isLnEE = true;
     else if(lnLambdaType==CollisionQuantity::LNLAMBDATYPE_EI)
@@ -44,11 +45,7 @@ CoulombLogarithm::~CoulombLogarithm(){
  * evaluated at p=mc)
  */
 void CoulombLogarithm::RebuildPlasmaDependentTerms(){
-    for(len_t ir=0; ir<nr; ir++){
-        lnLambda_T[ir] = evaluateLnLambdaT(ir);
-        lnLambda_c[ir] = evaluateLnLambdaC(ir);
-        lnLambda_ii[ir] = evaluateLnLambdaII(ir);
-    }
+    UpdateRadialTerms();
 }
 
 /**
@@ -60,6 +57,25 @@ void CoulombLogarithm::RebuildRadialTerms(){
         nr  = rGrid->GetNr();
         AllocatePartialQuantities();
     }
+    UpdateRadialTerms();
+}
+
+/**
+ * Evaluates lnLambda_T, lnLambda_c and lnLambda_ii in all radii, or
+ * takes them from the shared cache (which only re-evaluates them when
+ * T_cold or the ion densities have changed) if one has been set.
+ */
+void CoulombLogarithm::UpdateRadialTerms(){
+    if(cache != nullptr){
+        cache->Update();
+        // The cached arrays are owned by the cache and may
+        // have been reallocated
+        lnLambda_T  = cache->GetLnLambdaT();
+        lnLambda_c  = cache->GetLnLambdaC();
+        lnLambda_ii = cache->GetLnLambdaII();
+        return;
+    }
+
     for(len_t ir=0; ir<nr; ir++){
         lnLambda_T[ir] = evaluateLnLambdaT(ir);
         lnLambda_c[ir] = evaluateLnLambdaC(ir);
@@ -75,6 +91,12 @@ real_t CoulombLogarithm::evaluateLnLambdaC(len_t ir){
     real_t T_cold = unknowns->GetUnknownData(id_Tcold)[ir];
     //real_t n_cold = unknowns->GetUnknownData(id_ncold)[ir];
     real_t n_free = ionHandler->GetFreeElectronDensityFromQuasiNeutrality(ir);
+    return evaluateLnLambdaC(T_cold,n_free);
+}
+/**
+ * Evaluates the relativistic lnLambda at temperature T and density n
+ */
+real_t CoulombLogarithm::evaluateLnLambdaC(real_t T_cold, real_t n_free){
     if(n_free==0)
         return 0;
     return 14.6 + 0.5*log( T_cold/(n_free/1e20) );
@@ -107,6 +129,12 @@ real_t CoulombLogarithm::evaluateLnLambdaT(real_t T, real_t n){
 real_t CoulombLogarithm::evaluateLnLambdaII(len_t ir){
     real_t T_cold = unknowns->GetUnknownData(id_Tcold)[ir];
     real_t n_free = ionHandler->GetFreeElectronDensityFromQuasiNeutrality(ir);
+    return evaluateLnLambdaII(T_cold,n_free);
+}
+/**
+ * Evaluates the ion-ion lnLambda at temperature T and density n
+ */
+real_t CoulombLogarithm::evaluateLnLambdaII(real_t T_cold, real_t n_free){
     if(n_free == 0)
         return 0;
     return 17.3 - 0.5*log(n_free/1e20) + 1.5*log(T_cold/1e3);
@@ -283,6 +311,9 @@ void CoulombLogarithm::AssembleWithGeneralGrid(real_t **&lnLambda,const real_t *
  */
 void CoulombLogarithm::AllocatePartialQuantities(){
     DeallocatePartialQuantities();
+    if(cache != nullptr)
+        return;
+
     lnLambda_c = new real_t[nr];
     lnLambda_T = new real_t[nr];  
     lnLambda_ii = new real_t[nr]; 
@@ -293,6 +324,11 @@ void CoulombLogarithm::AllocatePartialQuantities(){
  * Deallocate quantities
  */
 void CoulombLogarithm::DeallocatePartialQuantities(){
+    if(cache != nullptr){
+        lnLambda_c = lnLambda_T = lnLambda_ii = nullptr;
+        return;
+    }
+
     if(lnLambda_c != nullptr)
         delete [] lnLambda_c;
     if(lnLambda_T != nullptr)
@@ -0,0 +1,101 @@
+/**
+ * Implementation of a cache for the radial (momentum-independent)
+ * Coulomb logarithms lnLambda_c, lnLambda_T and lnLambda_ii.
+ *
+ * These logarithms only depend on the cold electron temperature and
+ * the free electron density (which is obtained from the ion densities
+ * via quasi-neutrality), and are therefore identical in all
+ * 'CoulombLogarithm' objects of a simulation (electron-electron and
+ * electron-ion, on the hot-tail, runaway and fluid grids). The cache
+ * is shared between those objects, and the logarithms are only
+ * re-evaluated when the versions of 'T_cold' or 'n_i' change.
+ */
+
+#include "DREAM/Equations/CoulombLogarithm.hpp"
+#include "DREAM/Equations/CoulombLogarithmCache.hpp"
+#include "DREAM/Settings/OptionConstants.hpp"
+
+
+using namespace DREAM;
+
+
+/**
+ * Constructor.
+ */
+CoulombLogarithmCache::CoulombLogarithmCache(
+    FVM::RadialGrid *rGrid, FVM::UnknownQuantityHandler *u, IonHandler *ih
+) : rGrid(rGrid), unknowns(u), ionHandler(ih) {
+    this->id_Tcold = u->GetUnknownID(OptionConstants::UQTY_T_COLD);
+    this->id_ni    = u->GetUnknownID(OptionConstants::UQTY_ION_SPECIES);
+}
+
+/**
+ * Destructor.
+ */
+CoulombLogarithmCache::~CoulombLogarithmCache() {
+    Deallocate();
+}
+
+
+/**
+ * (Re-)allocate the stored logarithms for the current
+ * number of radial grid points.
+ */
+void CoulombLogarithmCache::Allocate() {
+    Deallocate();
+
+    this->nr = rGrid->GetNr();
+    this->lnLambda_c  = new real_t[nr];
+    this->lnLambda_T  = new real_t[nr];
+    this->lnLambda_ii = new real_t[nr];
+    this->valid = false;
+}
+
+/**
+ * Deallocate the stored logarithms.
+ */
+void CoulombLogarithmCache::Deallocate() {
+    if (this->lnLambda_c != nullptr) {
+        delete [] this->lnLambda_c;
+        delete [] this->lnLambda_T;
+        delete [] this->lnLambda_ii;
+    }
+
+    this->lnLambda_c  = nullptr;
+    this->lnLambda_T  = nullptr;
+    this->lnLambda_ii = nullptr;
+}
+
+
+/**
+ * Make sure that the stored logarithms correspond to the
+ * current plasma parameters, re-evaluating them if necessary.
+ * Note that the arrays may be reallocated if the radial grid
+ * has changed, and so pointers obtained from 'GetLnLambda*()'
+ * must be refreshed after each call to this method.
+ *
+ * RETURNS true if the logarithms were re-evaluated.
+ */
+bool CoulombLogarithmCache::Update() {
+    if (this->nr != rGrid->GetNr() || this->lnLambda_c == nullptr)
+        Allocate();
+
+    const len_t vT  = unknowns->GetVersion(id_Tcold);
+    const len_t vni = unknowns->GetVersion(id_ni);
+    if (this->valid && vT == this->version_Tcold && vni == this->version_ni)
+        return false;
+
+    const real_t *T_cold = unknowns->GetUnknownData(id_Tcold);
+    for (len_t ir = 0; ir < nr; ir++) {
+        real_t n_free = ionHandler->GetFreeElectronDensityFromQuasiNeutrality(ir);
+        this->lnLambda_T[ir]  = CoulombLogarithm::evaluateLnLambdaT(T_cold[ir], n_free);
+        this->lnLambda_c[ir]  = CoulombLogarithm::evaluateLnLambdaC(T_cold[ir], n_free);
+        this->lnLambda_ii[ir] = CoulombLogarithm::evaluateLnLambdaII(T_cold[ir], n_free);
+    }
+
+    this->version_Tcold = vT;
+    this->version_ni    = vni;
+    this->valid = true;
+
+    return true;
+}
@@ -6,6 +6,12 @@
  *
  * This implementation is based on the original Matlab implementation of the
  * neural network: https://github.com/unnerfelt/dreicer-nn
+ *
+ * Besides the evaluation in a single point, a batched evaluation is provided
+ * which runs the network for all radii at once (so that each layer becomes a
+ * small matrix-matrix product, vectorizable over the radial index) and which
+ * optionally also returns the derivatives of the runaway rate, obtained by
+ * propagating the output sensitivity backwards through the network.
  */
 
 #include "DREAM/Equations/DreicerNeuralNetwork.hpp"
@@ -91,6 +97,114 @@ real_t DreicerNeuralNetwork::RunawayRate(
     return 4.0/(3.0*M_SQRTPI)*(nfree/tauEE) * rr;
 }
 
+/**
+ * Evaluate the runaway rate at all radii simultaneously, optionally
+ * also evaluating its derivatives with respect to the electric field,
+ * total electron density and electron temperature (keeping all other
+ * plasma parameters fixed).
+ *
+ * nr:           Number of radial points.
+ * E:            Electric field strength.
+ * ntot:         Total electron density.
+ * T:            Electron temperature.
+ * gamma:        On return, contains the runaway rate.
+ * dGamma_dE:    If not 'nullptr', contains d(gamma)/dE on return.
+ * dGamma_dntot: If not 'nullptr', contains d(gamma)/dntot on return.
+ * dGamma_dT:    If not 'nullptr', contains d(gamma)/dT on return.
+ */
+void DreicerNeuralNetwork::RunawayRate(
+    const len_t nr, const real_t *E, const real_t *ntot, const real_t *T,
+    real_t *gamma, real_t *dGamma_dE, real_t *dGamma_dntot, real_t *dGamma_dT
+) {
+    IonHandler *ions = REFluid->GetIonHandler();
+    const bool deriv = (dGamma_dE != nullptr || dGamma_dntot != nullptr || dGamma_dT != nullptr);
+
+    // Work space: input (8 rows), four hidden layers (20 rows each),
+    // output (1 row) and, for the derivatives, two adjoint buffers
+    // (20 rows each). Row 'i' of a layer holds element 'i' at all radii.
+    this->batchWork.resize((8 + 4*20 + 1 + (deriv ? 2*20 : 0))*nr);
+    real_t *input = this->batchWork.data();
+    real_t *x[4];
+    for (len_t k = 0; k < 4; k++)
+        x[k] = input + 8*nr + k*20*nr;
+    real_t *logGamma = x[3] + 20*nr;
+
+    for (len_t ir = 0; ir < nr; ir++) {
+        real_t nfree = ions->GetFreeElectronDensityFromQuasiNeutrality(ir);
+        real_t ED    = REFluid->GetDreicerElectricField(ir);
+
+        input[0*nr + ir] = ions->GetZeff(ir);
+        input[1*nr + ir] = ions->evaluateZeff0(ir);
+        input[2*nr + ir] = ions->evaluateZ0_Z(ir);
+        input[3*nr + ir] = ions->evaluateZ0Z(ir);
+        input[4*nr + ir] = log(nfree);
+        input[5*nr + ir] = nfree / ntot[ir];
+        input[6*nr + ir] = fabs(E[ir])/ED;
+        input[7*nr + ir] = log(T[ir]/Constants::mc2inEV);
+    }
+
+    // Normalize input
+    for (len_t i = 0; i < 8; i++)
+        for (len_t ir = 0; ir < nr; ir++)
+            input[i*nr + ir] = (input[i*nr + ir] - input_mean[i]) / input_std[i];
+
+    nn_layer_batch(nr, 20, 8,  W1, input, b1, x[0]);
+    nn_layer_batch(nr, 20, 20, W2, x[0], b2, x[1]);
+    nn_layer_batch(nr, 20, 20, W3, x[1], b3, x[2]);
+    nn_layer_batch(nr, 20, 20, W4, x[2], b4, x[3]);
+    nn_layer_batch(nr, 1,  20, W5, x[3], b5, logGamma, false);
+
+    // Denormalize output
+    for (len_t ir = 0; ir < nr; ir++) {
+        real_t nfree = ions->GetFreeElectronDensityFromQuasiNeutrality(ir);
+        real_t tauEE = REFluid->GetElectronCollisionTimeThermal(ir);
+        real_t rr    = exp(logGamma[ir]*output_std[0] + output_mean[0]);
+
+        gamma[ir] = 4.0/(3.0*M_SQRTPI)*(nfree/tauEE) * rr;
+    }
+
+    if (!deriv)
+        return;
+
+    // Propagate the sensitivity of the (normalized) output
+    // backwards through the network
+    real_t *g1 = logGamma + nr, *g2 = g1 + 20*nr;
+    for (len_t i = 0; i < 20; i++)
+        for (len_t ir = 0; ir < nr; ir++)
+            g1[i*nr + ir] = W5[i];
+
+    nn_layer_batch_adjoint(nr, 20, 20, W4, x[3], g1, g2);
+    nn_layer_batch_adjoint(nr, 20, 20, W3, x[2], g2, g1);
+    nn_layer_batch_adjoint(nr, 20, 20, W2, x[1], g1, g2);
+    // (the input adjoint overwrites the input, which is no longer needed)
+    nn_layer_batch_adjoint(nr, 20, 8,  W1, x[0], g2, input);
+
+    for (len_t ir = 0; ir < nr; ir++) {
+        // d(gamma)/d(normalized output)
+        real_t dg = gamma[ir] * output_std[0];
+
+        if (dGamma_dE != nullptr) {
+            real_t ED = REFluid->GetDreicerElectricField(ir);
+            real_t s  = (E[ir] > 0 ? 1 : (E[ir] < 0 ? -1 : 0));
+            dGamma_dE[ir] = dg * input[6*nr + ir] / input_std[6] * s/ED;
+        }
+        if (dGamma_dntot != nullptr) {
+            if (ntot[ir] == 0)
+                dGamma_dntot[ir] = 0;
+            else {
+                real_t nfree = ions->GetFreeElectronDensityFromQuasiNeutrality(ir);
+                dGamma_dntot[ir] = -dg * input[5*nr + ir] / input_std[5] * nfree/(ntot[ir]*ntot[ir]);
+            }
+        }
+        if (dGamma_dT != nullptr) {
+            if (T[ir] == 0)
+                dGamma_dT[ir] = 0;
+            else
+                dGamma_dT[ir] = dg * input[7*nr + ir] / input_std[7] / T[ir];
+        }
+    }
+}
+
 /**
  * Inner function for evaluating neural network, taking a number of
  * "derived" parameters as input.
@@ -160,3 +274,71 @@ void DreicerNeuralNetwork::nn_layer(
     }
 }
 
+/**
+ * Evaluate one layer of the neural network for 'n' input vectors
+ * simultaneously. The input and output are stored row by row, so
+ * that element 'j' of input vector 'k' is located at x[j*n + k].
+ *
+ * n:     Number of input vectors.
+ * (remaining arguments are the same as for 'nn_layer()')
+ */
+void DreicerNeuralNetwork::nn_layer_batch(
+    const len_t n, const len_t nrows, const len_t ncols,
+    const real_t *W, const real_t *x,
+    const real_t *b, real_t *out,
+    bool applyTransferFunction
+) {
+    for (len_t i = 0; i < nrows; i++) {
+        real_t *o = out + i*n;
+        for (len_t k = 0; k < n; k++)
+            o[k] = b[i];
+
+        for (len_t j = 0; j < ncols; j++) {
+            const real_t w = W[i*ncols + j];
+            const real_t *xj = x + j*n;
+            for (len_t k = 0; k < n; k++)
+                o[k] += w * xj[k];
+        }
+
+        if (applyTransferFunction)
+            for (len_t k = 0; k < n; k++)
+                o[k] = tanh(o[k]);
+    }
+}
+
+/**
+ * Propagate the sensitivity with respect to the output of a
+ * (tanh) layer of the network backwards to its input, i.e.
+ *
+ *   gin_j = sum_i W_ij * (1 - out_i^2) * gout_i,
+ *
+ * for 'n' input vectors simultaneously.
+ *
+ * n:     Number of input vectors.
+ * nrows: Number of rows in weight matrix (elements of output).
+ * ncols: Number of columns in weight matrix (elements of input).
+ * W:     Weight matrix.
+ * out:   Output of the layer (after applying 'tanh()').
+ * gout:  Sensitivity with respect to the layer output.
+ * gin:   On return, contains the sensitivity with respect to the
+ *        layer input (must NOT be the same as 'gout').
+ */
+void DreicerNeuralNetwork::nn_layer_batch_adjoint(
+    const len_t n, const len_t nrows, const len_t ncols,
+    const real_t *W, const real_t *out, const real_t *gout, real_t *gin
+) {
+    for (len_t j = 0; j < ncols; j++)
+        for (len_t k = 0; k < n; k++)
+            gin[j*n + k] = 0;
+
+    for (len_t i = 0; i < nrows; i++) {
+        const real_t *oi = out + i*n;
+        const real_t *gi = gout + i*n;
+        for (len_t j = 0; j < ncols; j++) {
+            const real_t w = W[i*ncols + j];
+            real_t *gj = gin + j*n;
+            for (len_t k = 0; k < n; k++)
+                gj[k] += w * (1 - oi[k]*oi[k]) * gi[k];
+        }
+    }
+}
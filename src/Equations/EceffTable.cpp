@@ -0,0 +1,135 @@
+/**
+ * Implementation of a table of the effective critical electric field,
+ * normalized to the Connor-Hastie field Ectot, as a function of the
+ * effective charge Zeff and the electron temperature T, at each radius.
+ * The magnetic geometry enters the effective critical field through
+ * flux-surface averages which differ between radii, and so the table
+ * is given separately for each point of the radial grid.
+ *
+ * The table is generated offline (for example from previous simulations,
+ * or with the exact solver over a parameter scan) and is bilinearly
+ * interpolated in (Zeff, ln T). Each tabulated value may be accompanied
+ * by an estimate of its relative error, and points at which the
+ * (interpolated) error exceeds the given tolerance, or which lie outside
+ * of the tabulated domain, are rejected so that the caller can fall back
+ * to the exact solver.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "DREAM/Equations/EceffTable.hpp"
+#include "DREAM/DREAMException.hpp"
+
+
+using namespace DREAM;
+
+
+/**
+ * Constructor.
+ *
+ * nr:             Number of radial grid points.
+ * nZeff:          Number of Zeff grid points (at least 2).
+ * nT:             Number of temperature grid points (at least 2).
+ * Zeff:           Effective charge grid (strictly increasing).
+ * T:              Temperature grid, in eV (strictly increasing).
+ * EceffOverEctot: Tabulated Eceff/Ectot (nr x nZeff x nT).
+ * error:          Estimated relative error of the tabulated values
+ *                 (nr x nZeff x nT). If 'nullptr', the values are
+ *                 assumed to be exact.
+ * tolerance:      Largest relative error accepted in a lookup.
+ */
+EceffTable::EceffTable(
+    const len_t nr, const len_t nZeff, const len_t nT,
+    const real_t *Zeff, const real_t *T, const real_t *EceffOverEctot,
+    const real_t *error, const real_t tolerance
+) : nr(nr), nZeff(nZeff), nT(nT), tolerance(tolerance) {
+
+    if (nZeff < 2 || nT < 2)
+        throw DREAMException("EceffTable: The table must contain at least two points in both Zeff and T.");
+
+    this->Zeff = new real_t[nZeff];
+    this->lnT  = new real_t[nT];
+    for (len_t i = 0; i < nZeff; i++) {
+        if (i > 0 && Zeff[i] <= Zeff[i-1])
+            throw DREAMException("EceffTable: The Zeff grid must be strictly increasing.");
+        this->Zeff[i] = Zeff[i];
+    }
+    for (len_t i = 0; i < nT; i++) {
+        if (T[i] <= 0 || (i > 0 && T[i] <= T[i-1]))
+            throw DREAMException("EceffTable: The temperature grid must be positive and strictly increasing.");
+        this->lnT[i] = log(T[i]);
+    }
+
+    const len_t N = nr*nZeff*nT;
+    this->EceffOverEctot = new real_t[N];
+    this->error = new real_t[N];
+    std::copy(EceffOverEctot, EceffOverEctot+N, this->EceffOverEctot);
+    if (error != nullptr)
+        std::copy(error, error+N, this->error);
+    else
+        std::fill(this->error, this->error+N, 0);
+}
+
+/**
+ * Destructor.
+ */
+EceffTable::~EceffTable() {
+    delete [] this->error;
+    delete [] this->EceffOverEctot;
+    delete [] this->lnT;
+    delete [] this->Zeff;
+}
+
+
+/**
+ * Locate the interval of the grid 'v' (with 'n' points)
+ * containing 'a', which must lie within the grid.
+ */
+len_t EceffTable::FindInterval(const real_t a, const real_t *v, const len_t n) const {
+    len_t k = std::upper_bound(v, v+n, a) - v;
+    return (k >= n ? n-2 : k-1);
+}
+
+/**
+ * Evaluate Eceff/Ectot at the given radius for the given effective
+ * charge and electron temperature.
+ *
+ * ir:             Radial grid point.
+ * Zeff:           Effective charge.
+ * T:              Electron temperature (eV).
+ * EceffOverEctot: On return, contains the interpolated value (if the
+ *                 point could be evaluated with the table).
+ *
+ * RETURNS true if the point lies within the table and the estimated
+ * error of the interpolated value is within the tolerance.
+ */
+bool EceffTable::Evaluate(const len_t ir, const real_t Zeff, const real_t T, real_t *EceffOverEctot) {
+    this->nLookups++;
+
+    if (ir >= this->nr || T <= 0)
+        return false;
+
+    const real_t lT = log(T);
+    if (Zeff < this->Zeff[0] || Zeff > this->Zeff[nZeff-1] ||
+        lT < this->lnT[0] || lT > this->lnT[nT-1])
+        return false;
+
+    const len_t iZ = FindInterval(Zeff, this->Zeff, nZeff);
+    const len_t iT = FindInterval(lT, this->lnT, nT);
+    const real_t t = (Zeff - this->Zeff[iZ]) / (this->Zeff[iZ+1] - this->Zeff[iZ]);
+    const real_t u = (lT - this->lnT[iT]) / (this->lnT[iT+1] - this->lnT[iT]);
+
+    auto interp = [this,ir,iZ,iT,t,u](const real_t *v) {
+        const real_t *v0 = v + (ir*nZeff + iZ)*nT + iT;
+        const real_t *v1 = v0 + nT;
+        return (1-t)*((1-u)*v0[0] + u*v0[1]) + t*((1-u)*v1[0] + u*v1[1]);
+    };
+
+    if (interp(this->error) > this->tolerance)
+        return false;
+
+    *EceffOverEctot = interp(this->EceffOverEctot);
+    this->nHits++;
+
+    return true;
+}
@@ -11,6 +11,8 @@
  * 
  */
 #include "DREAM/Equations/EffectiveCriticalField.hpp"
+#include "DREAM/DREAMException.hpp"
+#include "DREAM/IO.hpp"
 
 
 using namespace DREAM;
@@ -58,6 +60,9 @@ EffectiveCriticalField::~EffectiveCriticalField(){
     delete AveragedEFieldTerm;
     delete AveragedSynchrotronTerm; 
     gsl_root_fdfsolver_free(fdfsolve);
+
+    if (this->table != nullptr)
+        delete this->table;
 }
 
 /**
@@ -78,6 +83,13 @@ void EffectiveCriticalField::DeallocateQuantities(){
 bool EffectiveCriticalField::GridRebuilt(){
     DeallocateQuantities();
     nr = rGrid->GetNr();
+    if (this->table != nullptr && this->table->GetNr() != nr)
+        throw DREAMException(
+            "EffectiveCriticalField: The Eceff table has " LEN_T_PRINTF_FMT " radial points, "
+            "but the radial grid has " LEN_T_PRINTF_FMT ".",
+            this->table->GetNr(), nr
+        );
+
     ECRIT_ECEFFOVERECTOT_PREV = new real_t[nr];
     ECRIT_POPTIMUM_PREV = new real_t[nr];
     // Initial guess: Eceff/Ectot \approx 1.0
@@ -109,8 +121,12 @@ bool EffectiveCriticalField::GridRebuilt(){
  * for which the maximum (with respect to p) of U(p) equals 0. Here, U
  * is the net momentum advection term averaged over an analytic pitch
  * angle distribution.
+ *
+ * If a table of precomputed values has been provided (see 'SetTable()'),
+ * the numerical calculation is only carried out at radii where the
+ * (Zeff, T_cold) point can not be accurately evaluated with the table.
  */
-void EffectiveCriticalField::CalculateEffectiveCriticalField(const real_t *Ec_tot, const real_t *Ec_free, real_t *effectiveCriticalField){
+void EffectiveCriticalField::CalculateEffectiveCriticalField(const real_t *Ec_tot, const real_t *Ec_free, real_t *effectiveCriticalField, const real_t *T_cold){
     switch (Eceff_mode)
     {
         case OptionConstants::COLLQTY_ECEFF_MODE_EC_TOT : { // or COLLQTY_ECEFF_MODE_NOSCREENING to be consistent with 
@@ -132,6 +148,16 @@ void EffectiveCriticalField::CalculateEffectiveCriticalField(const real_t *Ec_to
         case OptionConstants::COLLQTY_ECEFF_MODE_FULL : {  
             gsl_function_fdf UExtremumFunc;
             for (len_t ir=0; ir<nr; ir++){
+                real_t EceffOverEctot;
+                if (this->table != nullptr && T_cold != nullptr &&
+                    this->table->Evaluate(ir, ions->GetZeff(ir), T_cold[ir], &EceffOverEctot)) {
+                    effectiveCriticalField[ir] = EceffOverEctot * Ec_tot[ir];
+                    // (starting point for the solver, should the
+                    // table not be applicable in the next rebuild)
+                    ECRIT_ECEFFOVERECTOT_PREV[ir] = EceffOverEctot;
+                    continue;
+                }
+
                 gsl_parameters.ir = ir;
                 // it was found empirically that with a 4% margin, typical simulations
                 // will seldom end up outside of the interval
@@ -144,7 +170,9 @@ void EffectiveCriticalField::CalculateEffectiveCriticalField(const real_t *Ec_to
                 UExtremumFunc.params = &gsl_parameters; 
 
                 real_t E_root = ECRIT_ECEFFOVERECTOT_PREV[ir] * Ec_tot[ir];
-                RunawayFluid::FindRoot_fdf(E_root, UExtremumFunc,fdfsolve, 2e-3, 0);
+                this->nEceffSolves++;
+                if (!RunawayFluid::FindRoot_fdf(E_root, UExtremumFunc,fdfsolve, 2e-3, 0, &this->nEceffIterations))
+                    this->nEceffNotConverged++;
                 effectiveCriticalField[ir] = E_root;
 
                 ECRIT_ECEFFOVERECTOT_PREV[ir] = effectiveCriticalField[ir]/Ec_tot[ir];
@@ -157,6 +185,47 @@ void EffectiveCriticalField::CalculateEffectiveCriticalField(const real_t *Ec_to
     }
 }
 
+/**
+ * Set a table of precomputed values of Eceff/Ectot to use instead
+ * of the numerical calculation wherever possible. This object takes
+ * ownership of the table.
+ */
+void EffectiveCriticalField::SetTable(EceffTable *t) {
+    if (t != nullptr && t->GetNr() != nr)
+        throw DREAMException(
+            "EffectiveCriticalField: The Eceff table has " LEN_T_PRINTF_FMT " radial points, "
+            "but the radial grid has " LEN_T_PRINTF_FMT ".",
+            t->GetNr(), nr
+        );
+
+    if (this->table != nullptr)
+        delete this->table;
+
+    this->table = t;
+}
+
+/**
+ * Print statistics about the root finding carried out when
+ * evaluating the effective critical field.
+ */
+void EffectiveCriticalField::PrintRootFindingStatistics() {
+    if (this->table != nullptr)
+        DREAM::IO::PrintInfo(
+            "  Eceff table lookups: %6llu lookups, %llu within table",
+            (unsigned long long)this->table->GetNLookups(),
+            (unsigned long long)this->table->GetNHits()
+        );
+
+    if (nEceffSolves == 0)
+        return;
+
+    DREAM::IO::PrintInfo(
+        "  Eceff root finding:  %6llu solves, %.2f iterations/solve, %llu not converged",
+        (unsigned long long)nEceffSolves, ((real_t)nEceffIterations)/nEceffSolves,
+        (unsigned long long)nEceffNotConverged
+    );
+}
+
 /**
  * Calculates the effective critical field using Eqs (23)-(24) in Hesslow et al, PPCF 60, 074010 (2018),
  * which is also the formula published on GitHub.
@@ -25,6 +25,9 @@ CurrentDensityFromDistributionFunction::CurrentDensityFromDistributionFunction(
     this->scaleFactor = scaleFactor;
     // Build moment integrand
     this->GridRebuilt();
+
+    // (the integrand only depends on the grid)
+    this->EnableFusedEvaluation();
 }
 
 /**
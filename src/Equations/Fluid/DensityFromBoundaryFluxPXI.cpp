@@ -11,6 +11,7 @@
  * and applied to the distribution function (i.e. the matrix column representing 'fRE').
  */
 
+#include <algorithm>
 #include <functional>
 #include "DREAM/Equations/Fluid/DensityFromBoundaryFluxPXI.hpp"
 #include "DREAM/NotImplementedException.hpp"
@@ -42,8 +43,9 @@ DensityFromBoundaryFluxPXI::~DensityFromBoundaryFluxPXI() {}
  * linearized operator matrix.
  */
 len_t DensityFromBoundaryFluxPXI::GetNumberOfNonZerosPerRow() const {
-    // XXX Here we assume that all momentum grids are the same
-    const len_t nXi = this->distributionGrid->GetMomentumGrid(0)->GetNp2();
+    len_t nXi = 0;
+    for (len_t ir = 0; ir < this->distributionGrid->GetNr(); ir++)
+        nXi = std::max(nXi, this->distributionGrid->GetNp2(ir));
 
     return (nXi*3);
 }
@@ -55,8 +57,9 @@ len_t DensityFromBoundaryFluxPXI::GetNumberOfNonZerosPerRow() const {
  * TODO calculate correctly by taking 'equation' into account.
  */
 len_t DensityFromBoundaryFluxPXI::GetNumberOfNonZerosPerRow_jac() const {
-    // XXX Here we assume that all momentum grids are the same
-    const len_t nXi = this->distributionGrid->GetMomentumGrid(0)->GetNp2();
+    len_t nXi = 0;
+    for (len_t ir = 0; ir < this->distributionGrid->GetNr(); ir++)
+        nXi = std::max(nXi, this->distributionGrid->GetNp2(ir));
 
     return (nXi*3);
 }
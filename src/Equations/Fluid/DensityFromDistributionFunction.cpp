@@ -24,6 +24,9 @@ DensityFromDistributionFunction::DensityFromDistributionFunction(
 
     // Build moment integrand
     this->GridRebuilt();
+
+    // (the integrand only depends on the grid)
+    this->EnableFusedEvaluation();
 }
 
 /**
@@ -41,12 +41,18 @@ DreicerRateTerm::~DreicerRateTerm() {
 void DreicerRateTerm::AllocateGamma() {
     this->gamma           = new real_t[this->grid->GetNr()];
     this->EED_dgamma_dEED = new real_t[this->grid->GetNr()];
+    this->dgamma_dE       = new real_t[this->grid->GetNr()];
+    this->dgamma_dntot    = new real_t[this->grid->GetNr()];
+    this->dgamma_dT       = new real_t[this->grid->GetNr()];
 }
 
 /**
  * Free memory for the runaway rate.
  */
 void DreicerRateTerm::DeallocateGamma() {
+    delete [] this->dgamma_dT;
+    delete [] this->dgamma_dntot;
+    delete [] this->dgamma_dE;
     delete [] this->EED_dgamma_dEED;
     delete [] this->gamma;
 }
@@ -82,18 +88,21 @@ void DreicerRateTerm::Rebuild(const real_t, const real_t, FVM::UnknownQuantityHa
 
             this->EED_dgamma_dEED[ir] = EED * ch->Diff_EED(ir, E[ir], n[ir], Zeff);
         }
-    }/* else if (this->type == NEURAL_NETWORK) {
+    } else if (this->type == NEURAL_NETWORK) {
         DreicerNeuralNetwork *dnn = REFluid->GetDreicerNeuralNetwork();
 
         const real_t *E      = uqn->GetUnknownData(id_E_field);
         const real_t *ntot   = uqn->GetUnknownData(id_n_tot);
         const real_t *T_cold = uqn->GetUnknownData(id_T_cold);
 
-        for (len_t ir = 0; ir < nr; ir++) {
-            real_t EED  = E[ir] / REFluid->GetDreicerElectricField(ir);
-            this->EED_dgamma_dEED[ir] = EED * dnn->Diff_EED(ir, E[ir], ntot[ir], T_cold[ir]);
-        }
-    }*/
+        // Evaluate the derivatives at all radii together with the rate
+        // (which is otherwise taken from RunawayFluid)
+        real_t *g = AllocateScratch<real_t>(nr);
+        dnn->RunawayRate(
+            nr, E, ntot, T_cold, g,
+            this->dgamma_dE, this->dgamma_dntot, this->dgamma_dT
+        );
+    }
 
     this->data_E_field = uqn->GetUnknownData(id_E_field);
     this->data_n_cold  = uqn->GetUnknownData(id_n_cold);
@@ -111,27 +120,16 @@ bool DreicerRateTerm::SetJacobianBlock(
     const len_t nr = this->grid->GetNr();
 
     if (type == NEURAL_NETWORK) {
-        // Numerical derivative
+        // Derivatives evaluated with the network in 'Rebuild()'
         if (derivId == id_E_field || derivId == id_n_tot || derivId == id_T_cold) {
-            const real_t h = 1e-3;
             contributes = true;
 
-            for (len_t ir = 0; ir < nr; ir++) {
-                DreicerNeuralNetwork *dnn = this->REFluid->GetDreicerNeuralNetwork();
-
-                real_t g0 = this->gamma[ir], g1, v;
-                if (derivId == id_E_field) {
-                    v = data_E_field[ir]*h;
-                    g1 = dnn->RunawayRate(ir, data_E_field[ir]+v, data_n_tot[ir], data_T_cold[ir]);
-                } else if (derivId == id_n_tot) {
-                    v  = data_n_tot[ir]*h;
-                    g1 = dnn->RunawayRate(ir, data_E_field[ir], data_n_tot[ir]+v, data_T_cold[ir]);
-                } else if (derivId == id_T_cold) {
-                    v  = data_T_cold[ir]*h;
-                    g1 = dnn->RunawayRate(ir, data_E_field[ir], data_n_tot[ir], data_T_cold[ir]+v);
-                } else  /* No effect (due to earlier if) -- but keeps LLVM from complaining */
-                    break;
+            const real_t *dgamma;
+            if (derivId == id_E_field)    dgamma = this->dgamma_dE;
+            else if (derivId == id_n_tot) dgamma = this->dgamma_dntot;
+            else                          dgamma = this->dgamma_dT;
 
+            for (len_t ir = 0; ir < nr; ir++) {
                 const len_t xiIndex = this->GetXiIndexForEDirection(ir);
                 const len_t np1 = this->grid->GetMomentumGrid(ir)->GetNp1();
                 real_t V = GetVolumeScaleFactor(ir);
@@ -144,9 +142,7 @@ bool DreicerRateTerm::SetJacobianBlock(
                     xiIndex_op = 0;
                 }
 
-                real_t dg;
-                if (v == 0) dg = 0;
-                else dg = (g1-g0)/v;
+                real_t dg = dgamma[ir];
 
                 // Place particles in p=0, xi=1
                 jac->SetElement(ir + np1*xiIndex, ir + np1_op*xiIndex_op, this->scaleFactor * dg * V);
@@ -24,9 +24,14 @@ FreeElectronDensityTransientTerm::FreeElectronDensityTransientTerm(FVM::Grid *g,
  * dt: Length of next time step to take.
  */
 void FreeElectronDensityTransientTerm::Rebuild(const real_t t, const real_t dt, FVM::UnknownQuantityHandler *uqty) {
-    this->dt = dt;
-    this->nions_prev = uqty->GetUnknownDataPrevious(this->id_ions);
+    const real_t dtPrev = this->dt;
+    this->dt = uqty->GetTransientTimeStep(dt);
+    this->nions_prev = uqty->GetUnknownDataTransientPrevious(this->id_ions, dt);
     this->DiagonalLinearTerm::Rebuild(t,dt,uqty);
+
+    // The weights depend on the (effective) time step
+    if (this->dt != dtPrev)
+        this->SetWeights();
 }
 
 
@@ -36,16 +36,31 @@ HeatTransportRechesterRosenbluth::HeatTransportRechesterRosenbluth(
  */
 HeatTransportRechesterRosenbluth::~HeatTransportRechesterRosenbluth() {
     delete this->deltaBOverB;
-    delete [] this->dD;
+    DeallocateDiffCoeff();
 }
 
 
 /**
- * Allocate memory for the differentiation coefficient.
+ * Allocate memory for the geometric factor and
+ * differentiation coefficients.
  */
 void HeatTransportRechesterRosenbluth::AllocateDiffCoeff() {
     const len_t nr = this->grid->GetNr();
-    this->dD = new real_t[nr+1];
+    this->geometry = new real_t[nr+1];
+    this->dD_dn = new real_t[nr+1];
+    this->dD_dT = new real_t[nr+1];
+
+    this->geometryValid = false;
+}
+
+/**
+ * Free the memory of the geometric factor and
+ * differentiation coefficients.
+ */
+void HeatTransportRechesterRosenbluth::DeallocateDiffCoeff() {
+    delete [] this->geometry;
+    delete [] this->dD_dn;
+    delete [] this->dD_dT;
 }
 
 /**
@@ -54,18 +69,42 @@ void HeatTransportRechesterRosenbluth::AllocateDiffCoeff() {
 bool HeatTransportRechesterRosenbluth::GridRebuilt() {
     this->FVM::DiffusionTerm::GridRebuilt();
 
-    delete [] this->dD;
+    DeallocateDiffCoeff();
     AllocateDiffCoeff();
     
     return true;
 }
 
 /**
- * Rebuild the coefficients for this equation term.
+ * Evaluate the geometric factor of the diffusion coefficient,
+ * which only changes when the grid is rebuilt.
+ */
+void HeatTransportRechesterRosenbluth::SetGeometry() {
+    const len_t nr = this->grid->GetNr();
+    FVM::RadialGrid *rg = this->grid->GetRadialGrid();
+
+    const real_t PREFAC = 3.0 * sqrt(2.0*M_PI) * Constants::c * Constants::ec;
+    for (len_t ir = 0; ir < nr+1; ir++) {
+        const real_t B_Bmin = rg->GetFSA_B_f(ir);
+        const real_t xiT0   = rg->GetXi0TrappedBoundary_fr(ir);
+
+        this->geometry[ir] = PREFAC * B_Bmin * (1-xiT0*xiT0); // mc2;
+    }
+
+    this->geometryValid = true;
+}
+
+/**
+ * Rebuild the coefficients for this equation term. The
+ * derivatives of the coefficient with respect to n_cold and
+ * T_cold are evaluated in the same pass.
  */
 void HeatTransportRechesterRosenbluth::Rebuild(
     const real_t t, const real_t, FVM::UnknownQuantityHandler *unknowns
 ) {
+    if (!this->geometryValid)
+        SetGeometry();
+
     const real_t *dB_B = this->deltaBOverB->Eval(t);
     const len_t nr = this->grid->GetNr();
     const real_t mc2 = Constants::mc2inEV;
@@ -73,9 +112,6 @@ void HeatTransportRechesterRosenbluth::Rebuild(
     const real_t *ncold = unknowns->GetUnknownData(this->id_n_cold);
     const real_t *Tcold = unknowns->GetUnknownData(this->id_T_cold);
 
-    FVM::RadialGrid *rg = this->grid->GetRadialGrid();
-
-    const real_t PREFAC = 3.0 * sqrt(2.0*M_PI) * Constants::c * Constants::ec;
     for (len_t ir = 0; ir < nr+1; ir++) {
         real_t T=0, n=0;
         if(ir<nr){
@@ -87,15 +123,16 @@ void HeatTransportRechesterRosenbluth::Rebuild(
             n += (1-deltaRadialFlux[ir]) * ncold[ir-1];
         }
         real_t Theta = T / mc2;
+        real_t sqrtTheta = sqrt(Theta);
         
-        const real_t B_Bmin = rg->GetFSA_B_f(ir);
-        const real_t xiT0   = rg->GetXi0TrappedBoundary_fr(ir);
         const real_t qR0 = 1.0;       // TODO (safety factor)
 
-        real_t D = PREFAC * dB_B[ir]*dB_B[ir] * B_Bmin * (1-xiT0*xiT0); // mc2;
-        this->dD[ir] = D;
+        real_t D = qR0 * this->geometry[ir] * dB_B[ir]*dB_B[ir];
         
-        Drr(ir, 0, 0) += qR0 * D * n * sqrt(Theta) * (1 - 5.0/8.0*Theta);
+        this->dD_dn[ir] = D * sqrtTheta * (1 - 5.0/8.0*Theta);
+        this->dD_dT[ir] = D/mc2 * n * (0.5 - 15.0/16.0*Theta) / sqrtTheta;
+
+        Drr(ir, 0, 0) += this->dD_dn[ir] * n;
     }
 }
 
@@ -112,27 +149,13 @@ void HeatTransportRechesterRosenbluth::SetPartialDiffusionTerm(
     ResetDifferentiationCoefficients();
 
     const len_t nr = this->grid->GetNr();
-    const real_t mc2 = Constants::mc2inEV;
 
-    const real_t *ncold = unknowns->GetUnknownData(this->id_n_cold);
-    const real_t *Tcold = unknowns->GetUnknownData(this->id_T_cold);
-
-    for (len_t ir = 0; ir < nr+1; ir++) {
-        real_t T=0, n=0;
-        if(ir<nr){
-            T += deltaRadialFlux[ir] * Tcold[ir];
-            n += deltaRadialFlux[ir] * ncold[ir];
-        } 
-        if(ir>0){
-            T += (1-deltaRadialFlux[ir]) * Tcold[ir-1];
-            n += (1-deltaRadialFlux[ir]) * ncold[ir-1];
-        }
-        real_t Theta = T / mc2;
-        const real_t qR0 = 1.0; // TODO: safety factor with j_tot jacobian
-
-        if (derivId == this->id_n_cold)
-            dDrr(ir, 0, 0) = qR0 * this->dD[ir] * sqrt(Theta) * (1 - 5.0/8.0*Theta);
-        else if (derivId == this->id_T_cold)
-            dDrr(ir, 0, 0) = qR0 * this->dD[ir]/mc2 * n * (0.5 - 15.0/16.0*Theta) / sqrt(Theta);
-    }
+    // (the derivatives were evaluated in 'Rebuild()')
+    // TODO: safety factor with j_tot jacobian
+    if (derivId == this->id_n_cold)
+        for (len_t ir = 0; ir < nr+1; ir++)
+            dDrr(ir, 0, 0) = this->dD_dn[ir];
+    else if (derivId == this->id_T_cold)
+        for (len_t ir = 0; ir < nr+1; ir++)
+            dDrr(ir, 0, 0) = this->dD_dT[ir];
 }
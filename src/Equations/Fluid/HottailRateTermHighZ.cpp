@@ -63,6 +63,10 @@ bool HottailRateTermHighZ::GridRebuilt(){
 
     Deallocate();
     pCrit_prev = new real_t[nr];
+    PcFuncAtPc = new real_t[nr];
+    dPcFuncdpAtPc = new real_t[nr];
+    for(len_t ir=0; ir<nr; ir++)
+        pCrit_prev[ir] = 0;
 
     return true;
 }
@@ -84,6 +88,11 @@ void HottailRateTermHighZ::Rebuild(const real_t t, const real_t dt, FVM::Unknown
 
         real_t fAtPc, dfdpAtPc;
         pCrit[ir] = evaluateCriticalMomentum(ir, fAtPc, dfdpAtPc);
+
+        // store PcFunc and dPcFunc/dp at the root for the jacobian
+        real_t h = pCrit[ir]*sqrt(RELTOL_FOR_PC);
+        PcFuncAtPc[ir] = PcFunc(pCrit[ir], &gsl_params);
+        dPcFuncdpAtPc[ir] = (h==0) ? 0 : (PcFunc(pCrit[ir]+h, &gsl_params) - PcFuncAtPc[ir]) / h;
         real_t dotPc = (pCrit[ir] - pCrit_prev[ir]) / dt;
         if (dotPc > 0) // ensure non-negative runaway rate
             dotPc = 0;
@@ -153,7 +162,15 @@ real_t HottailRateTermHighZ::evaluateCriticalMomentum(len_t ir, real_t &f, real_
     gsl_params.Eterm = unknowns->GetUnknownData(id_Efield)[ir];
     gsl_params.tau   = unknowns->GetUnknownData(id_tau)[ir];
     
-    real_t root = (pCrit_prev[ir] == 0) ? 5*distHT->GetInitialThermalMomentum(ir) : pCrit_prev[ir];
+    // start from the latest solution (i.e. from the previous iteration,
+    // or the previous time step in the first iteration of a time step)
+    real_t root;
+    if(pCrit[ir] != 0)
+        root = pCrit[ir];
+    else if(pCrit_prev[ir] != 0)
+        root = pCrit_prev[ir];
+    else
+        root = 5*distHT->GetInitialThermalMomentum(ir);
     RunawayFluid::FindRoot_fdf_bounded(0,std::numeric_limits<real_t>::infinity(),root, gsl_func, fdfsolver, RELTOL_FOR_PC, ABSTOL_FOR_PC);
     f = gsl_params.F;
     dfdp = gsl_params.dFdp;
@@ -162,7 +179,13 @@ real_t HottailRateTermHighZ::evaluateCriticalMomentum(len_t ir, real_t &f, real_
 
 /**
  * Evaluates the jacobian of CriticalMomentum with 
- * respect to the unknown with id 'derivId'
+ * respect to the unknown with id 'derivId'. Since pc is 
+ * defined by PcFunc(pc; x) = 0, the derivative is obtained 
+ * from the implicit function theorem,
+ *
+ *   dpc/dx = -(dPcFunc/dx) / (dPcFunc/dp),
+ *
+ * which avoids solving for the root again.
  */
 real_t HottailRateTermHighZ::evaluatePartialCriticalMomentum(len_t ir, len_t derivId){
     gsl_params.ir = ir;
@@ -183,9 +206,11 @@ real_t HottailRateTermHighZ::evaluatePartialCriticalMomentum(len_t ir, len_t der
         gsl_params.tau += h;
     }
 
-    real_t root = pCrit[ir];
-    RunawayFluid::FindRoot_fdf_bounded(0,std::numeric_limits<real_t>::infinity(),root, gsl_func, fdfsolver, RELTOL_FOR_PC, ABSTOL_FOR_PC);
-    return (root - pCrit[ir])/h;
+    if(h==0 || dPcFuncdpAtPc[ir]==0)
+        return 0;
+
+    real_t dPcFuncdx = (PcFunc(pCrit[ir], &gsl_params) - PcFuncAtPc[ir]) / h;
+    return -dPcFuncdx / dPcFuncdpAtPc[ir];
 }
 
 
@@ -230,6 +255,9 @@ bool HottailRateTermHighZ::SetJacobianBlock(const len_t /*uqtyId*/, const len_t
  * Deallocator
  */
 void HottailRateTermHighZ::Deallocate(){
-    if(pCrit_prev != nullptr)
+    if(pCrit_prev != nullptr){
         delete [] pCrit_prev;
+        delete [] PcFuncAtPc;
+        delete [] dPcFuncdpAtPc;
+    }
 }
@@ -19,16 +19,34 @@ HyperresistiveDiffusionTerm::HyperresistiveDiffusionTerm(
 }
 
 /**
- * Build the coefficients of this diffusion term.
+ * Destructor.
  */
-void HyperresistiveDiffusionTerm::Rebuild(const real_t t, const real_t, FVM::UnknownQuantityHandler *){
+HyperresistiveDiffusionTerm::~HyperresistiveDiffusionTerm() {
+    delete [] this->geometry;
+}
+
+/**
+ * Called whenever the grid is rebuilt.
+ */
+bool HyperresistiveDiffusionTerm::GridRebuilt() {
+    this->FVM::DiffusionTerm::GridRebuilt();
+    this->geometryValid = false;
+
+    return true;
+}
+
+/**
+ * Evaluate the geometric factor of the diffusion coefficient,
+ * which only changes when the grid is rebuilt.
+ */
+void HyperresistiveDiffusionTerm::SetGeometry() {
     FVM::RadialGrid *rGrid = grid->GetRadialGrid(); 
-    const real_t *Lmbd  = this->Lambda->Eval(t);
 
-    // XXX: here we assume that all radii have the same momentum grids
-    const len_t np1 = n1[0], np2 = n2[0];
+    delete [] this->geometry;
+    this->geometry = new real_t[nr+1];
 
     // (skip ir=0 since psi_t=0 there, and to avoid 1/psitPrime = 1/0)
+    this->geometry[0] = 0;
     for (len_t ir = 1; ir < nr+1; ir++) {
         real_t Bmin = rGrid->GetBmin_f(ir);
         real_t BdotPhi = rGrid->GetBTorG_f(ir)*rGrid->GetFSA_1OverR2_f(ir);
@@ -45,8 +63,27 @@ void HyperresistiveDiffusionTerm::Rebuild(const real_t t, const real_t, FVM::Unk
         //
         // Also, we divide by 'Bmin' since this operator is applied to
         // 'j_tot / (B/Bmin)'.
-        real_t drr = 
-            2*M_PI*rGrid->GetToroidalFlux_f(ir)*Lmbd[ir] / (VpVol*psitPrime*Bmin);
+        this->geometry[ir] =
+            2*M_PI*rGrid->GetToroidalFlux_f(ir) / (VpVol*psitPrime*Bmin);
+    }
+
+    this->geometryValid = true;
+}
+
+/**
+ * Build the coefficients of this diffusion term.
+ */
+void HyperresistiveDiffusionTerm::Rebuild(const real_t t, const real_t, FVM::UnknownQuantityHandler *){
+    if (!this->geometryValid)
+        SetGeometry();
+
+    const real_t *Lmbd  = this->Lambda->Eval(t);
+
+    // XXX: here we assume that all radii have the same momentum grids
+    const len_t np1 = n1[0], np2 = n2[0];
+
+    for (len_t ir = 1; ir < nr+1; ir++) {
+        real_t drr = this->geometry[ir]*Lmbd[ir];
 
         for (len_t j = 0; j < np2; j++) 
             for (len_t i = 0; i < np1; i++) 
@@ -11,6 +11,11 @@
  *
  * Note that this equation is applied to a single _ion species_,
  * (and to all its charge states).
+ *
+ * The cross sections are evaluated once on the momentum grid when the
+ * grid is rebuilt. The ionization rates of all charge states are then
+ * evaluated together, as the product of the (Z0 x p) matrix of cross
+ * sections and the (p x r) matrix of the weighted distribution function.
  */
 
 #include "DREAM/ADAS.hpp"
@@ -19,6 +24,7 @@
 #include "DREAM/IonHandler.hpp"
 #include "DREAM/NotImplementedException.hpp"
 #include "FVM/Grid/Grid.hpp"
+#include <gsl/gsl_blas.h>
 
 
 using namespace DREAM;
@@ -67,28 +73,48 @@ IonKineticIonizationTerm::~IonKineticIonizationTerm() {
  */
 void IonKineticIonizationTerm::Allocate() {
     Deallocate();
-    // XXX: assumes same momentum grid at all radii
-    const len_t n1n2 = this->fGrid->GetNp1(0)*this->fGrid->GetNp2(0);
+    const len_t n1n2 = GetIntegrandMomentumGrid()->GetNCells();
 
+    // store all charge states contiguously, for use in 'RebuildRates()'
     this->IntegrandAllCS = new real_t*[Zion+1];
-    for(len_t Z0=0; Z0<=Zion; Z0++)
-        this->IntegrandAllCS[Z0] = new real_t[n1n2];
+    this->IntegrandAllCS[0] = new real_t[(Zion+1)*n1n2];
+    for(len_t Z0=1; Z0<=Zion; Z0++)
+        this->IntegrandAllCS[Z0] = this->IntegrandAllCS[0] + Z0*n1n2;
 
     tmpVec = new real_t[nr];
+    weightedF = new real_t[this->fGrid->GetNCells()];
+    rates = new real_t[Zion*nr];
 }
 
 
+/**
+ * Returns the momentum grid on which the ionization cross sections
+ * are stored. If the momentum grid varies with radius, this is the
+ * grid with the most cells; since the cross sections only depend on
+ * p, and the radii then share the same p grid (p-xi grids only), the
+ * values at each radius are given by the first cells of the arrays.
+ */
+const FVM::MomentumGrid *IonKineticIonizationTerm::GetIntegrandMomentumGrid() const {
+    const FVM::MomentumGrid *mg = this->fGrid->GetMomentumGrid(0);
+    for (len_t ir = 1; ir < this->fGrid->GetNr(); ir++)
+        if (this->fGrid->GetMomentumGrid(ir)->GetNCells() > mg->GetNCells())
+            mg = this->fGrid->GetMomentumGrid(ir);
+
+    return mg;
+}
+
 /**
  * Deallocate memory for the ionization rate coefficients.
  */
 void IonKineticIonizationTerm::Deallocate() {
     if(IntegrandAllCS == nullptr)
         return;
-    for(len_t Z0=0; Z0<=Zion; Z0++)
-        delete [] this->IntegrandAllCS[Z0];
+    delete [] this->IntegrandAllCS[0];
     delete [] this->IntegrandAllCS;
 
     delete [] tmpVec;
+    delete [] weightedF;
+    delete [] rates;
 }
 
 
@@ -149,8 +175,7 @@ void IonKineticIonizationTerm::SetDiffIntegrand(len_t){
  * Evaluates and stores the cross section for all charge states and momenta.
  */
 void IonKineticIonizationTerm::RebuildIntegrand(){
-    // XXX: assumes same momentum grid at all radii
-    FVM::MomentumGrid *mg = this->fGrid->GetMomentumGrid(0);
+    const FVM::MomentumGrid *mg = GetIntegrandMomentumGrid();
     len_t np1 = mg->GetNp1();
     len_t np2 = mg->GetNp2();
     if(isPXiGrid)
@@ -181,6 +206,56 @@ void IonKineticIonizationTerm::RebuildIntegrand(){
         IntegrandAllCS[Zion][i]=0;
 }
 
+/**
+ * Evaluates the ionization rates 'rates[Z0*nr+ir] = int( v*sigma_ion*f dp )'
+ * of all (not fully ionized) charge states Z0 of the ion, as the matrix 
+ * product of the cross sections (Zion x np) and the weighted distribution
+ * function (np x nr).
+ */
+void IonKineticIonizationTerm::RebuildRates(const real_t *f){
+    this->FVM::MomentQuantity::SetWeightedDistribution(f, weightedF);
+
+    // With a radially varying momentum grid, the integrand at
+    // each radius is given by the first cells of 'IntegrandAllCS'
+    // (see 'GetIntegrandMomentumGrid()')
+    if (!this->fGrid->HasRadiallyUniformMomentumGrid()) {
+        len_t offset = 0;
+        for (len_t ir = 0; ir < nr; ir++) {
+            const len_t N = this->fGrid->GetMomentumGrid(ir)->GetNCells();
+            for (len_t Z0 = 0; Z0 < Zion; Z0++) {
+                real_t r = 0;
+                for (len_t pind = 0; pind < N; pind++)
+                    r += IntegrandAllCS[Z0][pind] * weightedF[offset+pind];
+                rates[Z0*nr+ir] = r;
+            }
+            offset += N;
+        }
+        return;
+    }
+
+    const len_t n1n2 = this->fGrid->GetNp1(0)*this->fGrid->GetNp2(0);
+
+    gsl_matrix_const_view CS = gsl_matrix_const_view_array(IntegrandAllCS[0], Zion, n1n2);
+    gsl_matrix_const_view WF = gsl_matrix_const_view_array(weightedF, nr, n1n2);
+    gsl_matrix_view R = gsl_matrix_view_array(rates, Zion, nr);
+    gsl_blas_dgemm(CblasNoTrans, CblasTrans, 1.0, &CS.matrix, &WF.matrix, 0.0, &R.matrix);
+}
+
+/**
+ * Adds the net ionization rate of charge state Z0, as
+ * evaluated in the latest call to 'RebuildRates()', to 'vec'.
+ */
+void IonKineticIonizationTerm::AddCSRates(real_t *vec, const len_t Z0){
+    for(len_t ir=0; ir<nr; ir++){
+        real_t v = 0;
+        if(Z0<Zion)
+            v -= ions->GetIonDensity(ir,iIon,Z0) * rates[Z0*nr+ir];
+        if(Z0>0)
+            v += ions->GetIonDensity(ir,iIon,Z0-1) * rates[(Z0-1)*nr+ir];
+        vec[ir] += v;
+    }
+}
+
 /**
  * Evaluate electron impact ionization cross section [m^2]
  * using fitted parameters.
@@ -247,6 +322,19 @@ int_t IonKineticIonizationTerm::GetTableIndex(len_t Z){
 }
 
 
+/**
+ * Sets the jacobian block for all charge states of the ion.
+ */
+bool IonKineticIonizationTerm::SetJacobianBlock(
+    const len_t uqtyId, const len_t derivId, FVM::Matrix *jac, const real_t *f
+) {
+    // the approximate fast-electron jacobian is given by the ionization rates
+    if(derivId == id_nfast && HasJacobianContribution(derivId))
+        RebuildRates(f);
+
+    return this->IonEquationTerm<FVM::MomentQuantity>::SetJacobianBlock(uqtyId, derivId, jac, f);
+}
+
 /**
  * Sets the jacobian block for this equation term 
  * utilizing the functionality in MomentQuantity.
@@ -283,14 +371,14 @@ bool IonKineticIonizationTerm::SetCSJacobianBlock(
         // ionization equation term is directly proportional to the fast density:
         // if hot, integrate over hot region and divide by fast density (n_hot)
         // if re, integrate over entire distribution and divide by fast density (n_re)
-        SetIntegrand(Z0);
+        // (the rates were evaluated in 'SetJacobianBlock()')
         const real_t *n = unknowns->GetUnknownData(id_nfast);
 
         // Reset column vector
         for (len_t ir=0; ir < nr; ir++)
             tmpVec[ir] = 0;
 
-        this->MomentQuantity::SetVectorElements(tmpVec, f);
+        AddCSRates(tmpVec, Z0);
         for(len_t ir=0; ir<nr; ir++)
             if (n[ir] != 0)
                 jac->SetElement(ir, ir, tmpVec[ir] / n[ir]);
@@ -317,6 +405,18 @@ void IonKineticIonizationTerm::SetCSMatrixElements(
 }
 
 
+/**
+ * Sets the vector elements for all charge states of the ion,
+ * evaluating the ionization rates of all charge states at once.
+ */
+void IonKineticIonizationTerm::SetVectorElements(real_t *vec, const real_t *f) {
+    RebuildRates(f);
+
+    len_t idx = ions->GetIndex(iIon, 0);
+    for(len_t Z0=0; Z0<=Zion; Z0++, idx++)
+        AddCSRates(vec+idx*nr, Z0);
+}
+
 /**
  * Sets vector elements for this ion and charge state 
  */
@@ -102,13 +102,11 @@ void IonPrescribedParameter::Rebuild(const real_t t, const real_t, FVM::UnknownQ
     
     for (len_t i = 0, ionOffset = 0; i < nIons; i++) {
         for (len_t Z0 = 0; Z0 <= Z[i]; Z0++,ionOffset++) {
-            const real_t *n = iondata->Eval(ionOffset, t);
-            real_t *cd = currentData[i] + Z0*Nr;
-
-            for (len_t ir = 0; ir < Nr; ir++)
-                cd[ir] = n[ir];
+            iondata->Eval(ionOffset, t, currentData[i] + Z0*Nr);
         }
     }
+
+    this->lasttime = t;
 }
 
 /**
@@ -16,8 +16,13 @@
  * (and to all its charge states).
  * If using collfreq_mode FULL and kinetic ionization is used,
  * ionization rates will here be set to 0 to avoid double counting.
+ *
+ * The contributions to each row (i.e. to each charge state at a given
+ * radius) are accumulated locally and written to the matrix with a
+ * single insertion, rather than with one insertion per term.
  */
 
+#include <algorithm>
 #include "DREAM/ADAS.hpp"
 #include "DREAM/Equations/Fluid/IonRateEquation.hpp"
 #include "DREAM/IonHandler.hpp"
@@ -34,9 +39,10 @@ using namespace DREAM;
 IonRateEquation::IonRateEquation(
     FVM::Grid *g, IonHandler *ihdl, const len_t iIon,
     ADAS *adas, FVM::UnknownQuantityHandler *unknowns,
-    bool addFluidIonization, bool addFluidJacobian, bool isAbl = false 
+    bool addFluidIonization, bool addFluidJacobian, bool isAbl,
+    ADASRateCache *rateCache
 ) : IonEquationTerm<FVM::EquationTerm>(g, ihdl, iIon), adas(adas), 
-    addFluidIonization(addFluidIonization), addFluidJacobian(addFluidJacobian) {
+    rateCache(rateCache), addFluidIonization(addFluidIonization), addFluidJacobian(addFluidJacobian) {
     
     SetName("IonRateEquation");
 
@@ -45,6 +51,8 @@ IonRateEquation::IonRateEquation(
 		this->id_ions   = unknowns->GetUnknownID(OptionConstants::UQTY_ION_SPECIES_ABL);
 		this->id_n_cold = unknowns->GetUnknownID(OptionConstants::UQTY_N_ABL);
 		this->id_T_cold = unknowns->GetUnknownID(OptionConstants::UQTY_T_ABL);
+		// (the cached rates are evaluated at n_cold and T_cold)
+		this->rateCache = nullptr;
     }else{
 		this->id_ions   = unknowns->GetUnknownID(OptionConstants::UQTY_ION_SPECIES);
 		this->id_n_cold = unknowns->GetUnknownID(OptionConstants::UQTY_N_COLD);
@@ -135,34 +143,34 @@ void IonRateEquation::Rebuild(
     real_t *T = unknowns->GetUnknownData(id_T_cold);
     real_t *n = unknowns->GetUnknownData(id_n_cold);
 
-    ADASRateInterpolator *acd = adas->GetACD(Zion);
-    ADASRateInterpolator *scd = adas->GetSCD(Zion);
-
-    real_t eps = sqrt(std::numeric_limits<real_t>::epsilon());
-    // Iterate over charge state (0 ... Z)
-    for (len_t i = 0; i < Nr; i++){
-        real_t hn = eps*(1 + n[i]);
-        real_t hT = eps*(1 + T[i]);
-        for (len_t Z0 = 0; Z0 <= Zion; Z0++){
-            Rec[Z0][i]         = acd->Eval(Z0, n[i], T[i]);
-            PartialNRec[Z0][i] = (acd->Eval(Z0, n[i]+hn, T[i]) - Rec[Z0][i])/hn;
-            PartialTRec[Z0][i] = (acd->Eval(Z0, n[i], T[i]+hT) - Rec[Z0][i])/hT;
-            Ion[Z0][i]         = 0;
-            PartialNIon[Z0][i] = 0;
-            PartialTIon[Z0][i] = 0;
-        }
-    }
+    // Copy the rates (which have the same layout) from the cache
+    auto copyRates = [Nr,this](const struct ADASRateCache::rates *r, real_t **R, real_t **dRdn, real_t **dRdT) {
+        const len_t N = Nr*(this->Zion+1);
+        std::copy(r->R[0], r->R[0]+N, R[0]);
+        std::copy(r->dRdn[0], r->dRdn[0]+N, dRdn[0]);
+        std::copy(r->dRdT[0], r->dRdT[0]+N, dRdT[0]);
+    };
+
+    // Evaluate rate coefficients (and their derivatives)
+    // for all charge states (0 ... Z) at all radii
+    if (rateCache != nullptr)
+        copyRates(rateCache->Get(ADASRateCache::RATE_ACD, Zion), Rec, PartialNRec, PartialTRec);
+    else
+        adas->GetACD(Zion)->Eval(Nr, n, T, Rec, PartialNRec, PartialTRec);
+
     // if not covered by the kinetic ionization model, set fluid ionization rates
-    if(addFluidIonization || addFluidJacobian)
-        for (len_t i = 0; i < Nr; i++){
-            real_t hn = eps*(1 + n[i]);
-            real_t hT = eps*(1 + T[i]);
-            for (len_t Z0 = 0; Z0 <= Zion; Z0++){
-                Ion[Z0][i]         = scd->Eval(Z0, n[i], T[i]);
-                PartialNIon[Z0][i] = (scd->Eval(Z0, n[i]+hn, T[i]) - Ion[Z0][i])/hn;
-                PartialTIon[Z0][i] = (scd->Eval(Z0, n[i], T[i]+hT) - Ion[Z0][i])/hT;
+    if(addFluidIonization || addFluidJacobian) {
+        if (rateCache != nullptr)
+            copyRates(rateCache->Get(ADASRateCache::RATE_SCD, Zion), Ion, PartialNIon, PartialTIon);
+        else
+            adas->GetSCD(Zion)->Eval(Nr, n, T, Ion, PartialNIon, PartialTIon);
+    } else
+        for (len_t Z0 = 0; Z0 <= Zion; Z0++)
+            for (len_t i = 0; i < Nr; i++){
+                Ion[Z0][i]         = 0;
+                PartialNIon[Z0][i] = 0;
+                PartialTIon[Z0][i] = 0;
             }
-        }
 }
 
 
@@ -190,15 +198,21 @@ bool IonRateEquation::SetCSJacobianBlock(
     if (derivId == uqtyId) 
         this->SetCSMatrixElements(jac, nullptr, iIon, Z0, rOffset, JACOBIAN);
 
+    // All terms of a row are differentiated with respect to the
+    // same (radial) quantity, and so end up in the same column
+    real_t dRow;
+    bool hasRow;
+    #define NI_BEGIN_ROW() \
+        do { dRow = 0; hasRow = false; } while (false)
     #define NI(J,V) \
         do {\
             if (nions[rOffset+ir+(J)*Nr] > 1 && std::abs((V)) > 1e-40) { \
-                jac->SetElement(\
-                    rOffset+ir, ir, \
-                    (V) * nions[rOffset+ir+(J)*Nr] \
-                ); \
+                dRow += (V) * nions[rOffset+ir+(J)*Nr]; \
+                hasRow = true; \
             } \
         } while (false)
+    #define NI_END_ROW() \
+        do { if (hasRow) jac->SetElement(rOffset+ir, ir, dRow); } while (false)
     bool setIonization = addFluidIonization || addFluidJacobian;
 
     if(derivId == id_T_cold) {
@@ -210,7 +224,9 @@ bool IonRateEquation::SetCSJacobianBlock(
         contributes = true;
         #include "IonRateEquation.setDN.cpp"        
     }
+    #undef NI_END_ROW
     #undef NI
+    #undef NI_BEGIN_ROW
 
     return contributes;
 }
@@ -228,17 +244,37 @@ void IonRateEquation::SetCSMatrixElements(
     FVM::Matrix *mat, real_t*, const len_t iIon, const len_t Z0, const len_t rOffset, SetMode sm
 ) {
     bool setIonization = addFluidIonization || (sm==JACOBIAN&&addFluidJacobian);
+
+    // Row elements coupling to charge states Z0-1, Z0 and Z0+1
+    PetscInt cols[3];
+    PetscScalar vals[3];
+    bool hasCol[3];
+    #define NI_BEGIN_ROW() \
+        do { \
+            for (len_t k = 0; k < 3; k++) { vals[k] = 0; hasCol[k] = false; } \
+        } while (false)
     #define NI(J,V) \
         do { \
             if (std::abs((V)) > 1e-40) { \
-                mat->SetElement(\
-                    rOffset+ir, rOffset+ir+(J)*Nr, \
-                    (V) \
-                ); \
+                vals[(J)+1] += (V); \
+                hasCol[(J)+1] = true; \
+            } \
+        } while (false)
+    #define NI_END_ROW() \
+        do { \
+            PetscInt ncol = 0; \
+            for (len_t k = 0; k < 3; k++) { \
+                if (!hasCol[k]) continue; \
+                cols[ncol] = (PetscInt)(rOffset+ir) + ((PetscInt)k-1)*(PetscInt)Nr; \
+                vals[ncol++] = vals[k]; \
             } \
+            if (ncol > 0) \
+                mat->SetRow(rOffset+ir, ncol, cols, vals); \
         } while (false)
     #   include "IonRateEquation.set.cpp"
+    #undef NI_END_ROW
     #undef NI
+    #undef NI_BEGIN_ROW
 }
 
 /**
@@ -255,13 +291,20 @@ void IonRateEquation::SetCSVectorElements(
     const len_t iIon, const len_t Z0, const len_t rOffset
 ) {
     bool setIonization = addFluidIonization;
+    real_t fRow;
+    #define NI_BEGIN_ROW() \
+        do { fRow = 0; } while (false)
     #define NI(J,V) \
         do { \
             if (nions[rOffset+ir+(J)*Nr] > 1 && std::abs((V)) > 1e-40) { \
-                vec[rOffset+ir] += (V) * nions[rOffset+ir+(J)*Nr]; \
+                fRow += (V) * nions[rOffset+ir+(J)*Nr]; \
             } \
         } while (false)
+    #define NI_END_ROW() \
+        do { vec[rOffset+ir] += fRow; } while (false)
     #   include "IonRateEquation.set.cpp"
+    #undef NI_END_ROW
     #undef NI
+    #undef NI_BEGIN_ROW
 }
 
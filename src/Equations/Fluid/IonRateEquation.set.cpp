@@ -11,6 +11,8 @@
     //const len_t ionidx = this->ions->GetIndex(iIon, Z0);
 
     for (len_t ir = 0; ir < Nr; ir++) {
+        NI_BEGIN_ROW();
+
         if(setIonization){
             // I_i^(j-1) n_cold * n_i^(j-1)
             if (Z0 > 0)
@@ -25,4 +27,6 @@
 
         // -R_i^(j) n_cold * n_i^(j-1)
         NI(0, -Rec[Z0][ir] * n_cold[ir]);
+
+        NI_END_ROW();
     }
@@ -7,6 +7,8 @@
     const real_t *n_cold = this->unknowns->GetUnknownData(id_n_cold);
 
     for (len_t ir = 0; ir < Nr; ir++) {
+        NI_BEGIN_ROW();
+
         if(setIonization){
             // (I_i^(j-1) n_cold
             if (Z0 > 0) 
@@ -22,4 +24,6 @@
 
         // -R_i^(j) n_cold * n_i^(j-1)
         NI(0, -PartialTRec[Z0][ir] * n_cold[ir]);
+
+        NI_END_ROW();
     }
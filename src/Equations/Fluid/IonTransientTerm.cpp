@@ -28,8 +28,8 @@ IonTransientTerm::IonTransientTerm(FVM::Grid *g, IonHandler *ih, const len_t iIo
 void IonTransientTerm::Rebuild(
     const real_t, const real_t dt, FVM::UnknownQuantityHandler *uqty
 ) {
-    this->dt = dt;
-    this->xn = uqty->GetUnknownDataPrevious(this->unknownId);
+    this->dt = uqty->GetTransientTimeStep(dt);
+    this->xn = uqty->GetUnknownDataTransientPrevious(this->unknownId, dt);
 }
 
 /**
@@ -70,9 +70,9 @@ void IonisationHeatingTerm::SetWeights()
         ADASRateInterpolator *scd = adas->GetSCD(Zs[iz]);        
             for(len_t Z0 = 0; Z0<=Zs[iz]; Z0++){
             len_t nMultiple = ionHandler->GetIndex(iz,Z0);
+            const real_t I_energy = nist->GetIonizationEnergy(Zs[iz],Z0) * Constants::ec;
             for (len_t i = 0; i < NCells; i++){
                 real_t Ion =  scd->Eval(Z0, n_cold[i]+n_hot[i], T_cold_init[i]);
-                real_t I_energy = nist->GetIonizationEnergy(Zs[iz],Z0) * Constants::ec;
                 real_t ni = n_i[nMultiple*NCells + i];
                 weights[i] += -ni * I_energy * Ion;
             }
@@ -94,9 +94,9 @@ void IonisationHeatingTerm::SetDiffWeights(len_t derivId, len_t /*nMultiples*/){
             ADASRateInterpolator *scd = adas->GetSCD(Zs[iz]);        
             for(len_t Z0 = 0; Z0<=Zs[iz]; Z0++){
                 len_t nMultiple = ionHandler->GetIndex(iz,Z0);
+                const real_t I_energy = nist->GetIonizationEnergy(Zs[iz],Z0) * Constants::ec;
                 for (len_t i = 0; i < NCells; i++){
                     real_t Ion =  scd->Eval(Z0, n_cold[i]+n_hot[i], T_cold_init[i]);
-                    real_t I_energy = nist->GetIonizationEnergy(Zs[iz],Z0) * Constants::ec;
                     diffWeights[NCells*nMultiple + i] = -I_energy * Ion;
                 }
             }
@@ -106,9 +106,9 @@ void IonisationHeatingTerm::SetDiffWeights(len_t derivId, len_t /*nMultiples*/){
             ADASRateInterpolator *scd = adas->GetSCD(Zs[iz]);        
             for(len_t Z0 = 0; Z0<=Zs[iz]; Z0++){
                 len_t nMultiple = ionHandler->GetIndex(iz,Z0);
+                const real_t I_energy = nist->GetIonizationEnergy(Zs[iz],Z0) * Constants::ec;
                 for (len_t i = 0; i < NCells; i++){
                     real_t dIon =  scd->Eval_deriv_n(Z0, n_cold[i]+n_hot[i], T_cold_init[i]);
-                    real_t I_energy = nist->GetIonizationEnergy(Zs[iz],Z0) * Constants::ec;
                     real_t ni = n_i[nMultiple*NCells + i];
                     diffWeights[i] = -ni * I_energy * dIon;
                 }
@@ -21,6 +21,9 @@ KineticEnergyFromDistributionFunction::KineticEnergyFromDistributionFunction(
     this->scaleFactor = scaleFactor;
     // Build moment integrand
     this->GridRebuilt();
+
+    // (the integrand only depends on the grid)
+    this->EnableFusedEvaluation();
 }
 
 /**
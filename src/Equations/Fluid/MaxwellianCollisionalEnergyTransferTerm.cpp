@@ -69,26 +69,89 @@ MaxwellianCollisionalEnergyTransferTerm::MaxwellianCollisionalEnergyTransferTerm
 
 
 /**
- * Set vector elements of this equation term. The implementation mirrors the analytic
- * form that is given in doc/notes/theory, where we have rewritten it in terms of the
- * total ion densities Ni and heat Wi.
+ * Evaluate the energy transfer rate, and the factors needed for its
+ * jacobian, in all radial grid points. The implementation mirrors the
+ * analytic form that is given in doc/notes/theory, where we have
+ * rewritten it in terms of the total ion densities Ni and heat Wi.
+ * Since the rate only depends on the aggregate quantities n, W and nZ2
+ * of each species, the charge states enter only through nZ2, which is
+ * evaluated once per radius. The rates are only reevaluated when any
+ * of the unknowns they depend on have changed (or when the term has
+ * been rebuilt, as the Coulomb logarithm may then have changed).
  */
-void MaxwellianCollisionalEnergyTransferTerm::SetVectorElements(real_t *vec, const real_t*){
-    const real_t *lnL = isEI ? lnLambda->GetLnLambdaT() : lnLambda->GetLnLambdaII();
-    for(len_t ir=0; ir<nr; ir++){
-        real_t nZ2_i,nZ2_j,ni, nj, Wi, Wj;
-        GetParametersForSpecies(ir, index_i, isIon_i, ni, Wi, nZ2_i);
-        GetParametersForSpecies(ir, index_j, isIon_j, nj, Wj, nZ2_j);
+void MaxwellianCollisionalEnergyTransferTerm::Evaluate() {
+    const len_t ids[5] = { id_ions, id_Ni, id_Wi, id_ncold, id_Wcold };
+    bool changed = !this->evaluated;
+    for (len_t k = 0; k < 5; k++) {
+        const len_t v = unknowns->GetVersion(ids[k]);
+        if (v != this->versions[k]) {
+            this->versions[k] = v;
+            changed = true;
+        }
+    }
 
-        real_t njWi = nj*Wi;
-        real_t niWj = ni*Wj;
-        if(ni==0 || nj==0 || niWj==njWi)
-            continue;
-        real_t pre = sqrt(ni*nj)*nZ2_i*nZ2_j;
-        real_t up = niWj - njWi;
-        real_t down = mj*njWi + mi*niWj;
-        vec[index_i*nr + ir] += lnL[ir] * constPreFactor * pre * up / (down*sqrt(down));
+    if (!changed && this->Q.size() == nr)
+        return;
+
+    this->nZ2_i.resize(nr); this->nZ2_j.resize(nr);
+    this->Q.resize(nr);
+    this->dQ_ni.resize(nr); this->dQ_nj.resize(nr);
+    this->dQ_Wi.resize(nr); this->dQ_Wj.resize(nr);
+    this->QOverNZ2_i.resize(nr); this->QOverNZ2_j.resize(nr);
+    this->active.resize(nr);
+
+    const real_t *ni, *nj, *Wi, *Wj;
+    GetParametersForSpecies(index_i, isIon_i, ni, Wi, this->nZ2_i.data());
+    GetParametersForSpecies(index_j, isIon_j, nj, Wj, this->nZ2_j.data());
+
+    const real_t *lnL = isEI ? lnLambda->GetLnLambdaT() : lnLambda->GetLnLambdaII();
+    const real_t *Z2i = this->nZ2_i.data(), *Z2j = this->nZ2_j.data();
+    real_t
+        *q = this->Q.data(),
+        *q_ni = this->dQ_ni.data(), *q_nj = this->dQ_nj.data(),
+        *q_Wi = this->dQ_Wi.data(), *q_Wj = this->dQ_Wj.data(),
+        *qi = this->QOverNZ2_i.data(), *qj = this->QOverNZ2_j.data();
+    char *act = this->active.data();
+
+    #pragma omp simd
+    for (len_t ir = 0; ir < nr; ir++) {
+        const real_t njWi = nj[ir]*Wi[ir];
+        const real_t niWj = ni[ir]*Wj[ir];
+
+        // (the last condition (Ti=Tj) deals with Wi=Wj=0 which is singular below)
+        act[ir] = !(ni[ir]==0 || nj[ir]==0 || niWj==njWi);
+        if (!act[ir]) {
+            q[ir] = q_ni[ir] = q_nj[ir] = q_Wi[ir] = q_Wj[ir] = qi[ir] = qj[ir] = 0;
+        } else {
+            const real_t sq = sqrt(ni[ir]*nj[ir]);
+            const real_t up = niWj - njWi;
+            const real_t down = mj*njWi + mi*niWj;
+            const real_t v = lnL[ir] * constPreFactor * (sq*Z2i[ir]*Z2j[ir]) * up / (down*sqrt(down));
+            q[ir]    = v;
+            q_ni[ir] = v*( 0.5/ni[ir] + Wj[ir]*( 1.0/up - 1.5*mi/down) );
+            q_nj[ir] = v*( 0.5/nj[ir] + Wi[ir]*(-1.0/up - 1.5*mj/down) );
+            q_Wi[ir] = v*nj[ir]*(-1.0/up - 1.5*mj/down );
+            q_Wj[ir] = v*ni[ir]*( 1.0/up - 1.5*mi/down );
+            // (rebuild 'v' without the nZ2_i and nZ2_j factors, respectively)
+            qi[ir]   = lnL[ir] * constPreFactor * (sq*Z2j[ir]) * up / (down*sqrt(down));
+            qj[ir]   = lnL[ir] * constPreFactor * (sq*Z2i[ir]) * up / (down*sqrt(down));
+        }
     }
+
+    this->evaluated = true;
+}
+
+/**
+ * Set vector elements of this equation term.
+ */
+void MaxwellianCollisionalEnergyTransferTerm::SetVectorElements(real_t *vec, const real_t*){
+    Evaluate();
+
+    real_t *v = vec + index_i*nr;
+    const real_t *q = this->Q.data();
+    #pragma omp simd
+    for(len_t ir=0; ir<nr; ir++)
+        v[ir] += q[ir];
 }
 
 
@@ -99,55 +162,47 @@ bool MaxwellianCollisionalEnergyTransferTerm::SetJacobianBlock(const len_t /*uqt
     if( !HasJacobianContribution(derivId) ) 
         return false;
 
+    Evaluate();
+
     const real_t *lnL = isEI ? lnLambda->GetLnLambdaT() : lnLambda->GetLnLambdaII();
+
+    // Which of the partial derivatives contribute to this block
+    const bool
+        d_ni = (isIon_i && derivId==id_Ni) || (!isIon_i && derivId==id_ncold),
+        d_nj = (isIon_j && derivId==id_Ni) || (!isIon_j && derivId==id_ncold),
+        d_Wi = (isIon_i && derivId==id_Wi) || (!isIon_i && derivId==id_Wcold),
+        d_Wj = (isIon_j && derivId==id_Wi) || (!isIon_j && derivId==id_Wcold);
     
     for(len_t ir=0; ir<nr; ir++){
-        real_t nZ2_i,nZ2_j,ni, nj, Wi, Wj;
-        GetParametersForSpecies(ir, index_i, isIon_i, ni, Wi, nZ2_i);
-        GetParametersForSpecies(ir, index_j, isIon_j, nj, Wj, nZ2_j);
-
-        real_t njWi = nj*Wi;
-        real_t niWj = ni*Wj;
-        if(ni==0 || nj==0 || niWj==njWi) // last one (Ti=Tj) deals with Wi=Wj=0 which is singular below
+        if (!this->active[ir])
             continue;
-        real_t pre = sqrt(ni*nj)*nZ2_i*nZ2_j;
-        real_t up = niWj - njWi;
-        real_t down = mj*njWi + mi*niWj;
-        real_t vec = lnL[ir] * constPreFactor * pre * up / (down*sqrt(down));
 
+        const real_t vec = this->Q[ir];
         len_t ii = index_i*nr + ir;
         len_t jj = index_j*nr + ir;
         real_t val1 = 0, val2 = 0;
-        if( (isIon_i &&  derivId==id_Ni) || (!isIon_i && derivId==id_ncold) ) 
-            val1 += vec*( 0.5/ni + Wj*( 1.0/up - 1.5*mi/down) );
-        if( (isIon_j &&  derivId==id_Ni) || (!isIon_j && derivId==id_ncold) ) 
-            val2 += vec*( 0.5/nj + Wi*(-1.0/up - 1.5*mj/down) );
-        if( (isIon_i&&derivId==id_Wi) || (!isIon_i&&derivId==id_Wcold) )
-            val1 += vec*nj*(-1.0/up - 1.5*mj/down );
-        if( (isIon_j&&derivId==id_Wi) || (!isIon_j&&derivId==id_Wcold) )
-            val2 += vec*ni*( 1.0/up - 1.5*mi/down );
+        if (d_ni) val1 += this->dQ_ni[ir];
+        if (d_nj) val2 += this->dQ_nj[ir];
+        if (d_Wi) val1 += this->dQ_Wi[ir];
+        if (d_Wj) val2 += this->dQ_Wj[ir];
         jac->SetElement(ii, ii, val1);
         jac->SetElement(ii, jj, val2);
 
         // handle the nZ2 term:
         if(isIon_i && derivId==id_ions){
-            real_t preOverNZ2 = sqrt(ni*nj)*nZ2_j; // rebuild 'vec' without the nZ2_i factor
-            real_t vecOverNZ2 = lnL[ir] * constPreFactor * preOverNZ2 * up / (down*sqrt(down));
             for(len_t Z0=0; Z0<=Zi; Z0++){
                 len_t indZ = ionHandler->GetIndex(index_i, Z0);
-                jac->SetElement(ii, indZ*nr + ir, vecOverNZ2 * Z0*Z0);
+                jac->SetElement(ii, indZ*nr + ir, this->QOverNZ2_i[ir] * Z0*Z0);
             }
         } else if(!isIon_i && derivId == id_ncold)
-            jac->SetElement(ii,ir, vec/nZ2_i);
+            jac->SetElement(ii,ir, vec/nZ2_i[ir]);
         if(isIon_j && derivId==id_ions){
-            real_t preOverNZ2 = sqrt(ni*nj)*nZ2_i; // rebuild 'vec' without the nZ2_j factor
-            real_t vecOverNZ2 = lnL[ir] * constPreFactor * preOverNZ2 * up / (down*sqrt(down));
             for(len_t Z0=0; Z0<=Zj; Z0++){
                 len_t indZ = ionHandler->GetIndex(index_j, Z0);
-                jac->SetElement(ii, indZ*nr + ir, vecOverNZ2 * Z0*Z0);
+                jac->SetElement(ii, indZ*nr + ir, this->QOverNZ2_j[ir] * Z0*Z0);
             }
         } else if(!isIon_j && derivId == id_ncold)
-            jac->SetElement(ii,ir, vec/nZ2_j);
+            jac->SetElement(ii,ir, vec/nZ2_j[ir]);
         
         // Below: lnLambda derivatives
         if(derivId==id_Tcold || derivId==id_ions){
@@ -161,22 +216,38 @@ bool MaxwellianCollisionalEnergyTransferTerm::SetJacobianBlock(const len_t /*uqt
 }
 
 /**
- * Evaluates the density and heat content at radial grid point 'ir' for the specified species 
- * (ions if isIon and otherwise electrons). For ionz, nZ2 is defined as the weighted sum 
+ * Returns the density and heat content in all radial grid points for the specified
+ * species (ions if isIon and otherwise electrons), and evaluates nZ2. For ions, nZ2
+ * is defined as the weighted sum
  *  nZ2_i = sum_j n_i^(j)*Z_0j^2
  * which is essentially 'Zeff' of species 'i' (multiplied by N_i). For electrons it is simply
  * taken as n_cold.
+ *
+ * nZ2: Array (of size nr) to store nZ2 in.
  */
-void MaxwellianCollisionalEnergyTransferTerm::GetParametersForSpecies(len_t ir, len_t index,bool isIon, real_t &n, real_t &W, real_t &nZ2){
+void MaxwellianCollisionalEnergyTransferTerm::GetParametersForSpecies(
+    len_t index, bool isIon, const real_t *&n, const real_t *&W, real_t *nZ2
+) {
     if(isIon){
-        n = unknowns->GetUnknownData(id_Ni)[nr*index + ir];
-        W = unknowns->GetUnknownData(id_Wi)[nr*index + ir];
-        nZ2=ionHandler->GetNZ0Z0(index, ir);
+        n = unknowns->GetUnknownData(id_Ni) + nr*index;
+        W = unknowns->GetUnknownData(id_Wi) + nr*index;
+
+        // (summed over the charge states in the same order as
+        // 'IonHandler::GetNZ0Z0()', streaming over radius)
+        const len_t Z = ionHandler->GetZ(index);
+        const real_t *nions = unknowns->GetUnknownData(id_ions) + ionHandler->GetIndex(index, 0)*nr;
+        for (len_t ir = 0; ir < nr; ir++)
+            nZ2[ir] = 0;
+        for (len_t Z0 = 1; Z0 <= Z; Z0++) {
+            const real_t *nZ0 = nions + Z0*nr;
+            #pragma omp simd
+            for (len_t ir = 0; ir < nr; ir++)
+                nZ2[ir] += nZ0[ir]*Z0*Z0;
+        }
     } else {
-        n = unknowns->GetUnknownData(id_ncold)[ir];
-        nZ2 = n;
-        W = unknowns->GetUnknownData(id_Wcold)[ir];
+        n = unknowns->GetUnknownData(id_ncold);
+        W = unknowns->GetUnknownData(id_Wcold);
+        for (len_t ir = 0; ir < nr; ir++)
+            nZ2[ir] = n[ir];
     }
 }
-
-
@@ -1,3 +1,4 @@
+#include <algorithm>
 #include "DREAM/Equations/Fluid/RadiatedPowerTerm.hpp"
 
 
@@ -20,8 +21,9 @@ using namespace DREAM;
 RadiatedPowerTerm::RadiatedPowerTerm(
     FVM::Grid* g, FVM::UnknownQuantityHandler *u, IonHandler *ionHandler, 
 	ADAS *adas, NIST *nist, AMJUEL* amjuel,
-    enum OptionConstants::ion_opacity_mode *opacity_modes, bool includePRB
-) : FVM::DiagonalComplexTerm(g,u), includePRB(includePRB) {
+    enum OptionConstants::ion_opacity_mode *opacity_modes, bool includePRB,
+    ADASRateCache *rateCache
+) : FVM::DiagonalComplexTerm(g,u), rateCache(rateCache), includePRB(includePRB) {
 
     SetName("RadiatedPowerTerm");
 
@@ -50,6 +52,274 @@ RadiatedPowerTerm::RadiatedPowerTerm(
     this->bremsRel2 = 5.0/(8.0*M_SQRT2)*(44.0-3.0*M_PI*M_PI); // e-e brems correction
 }
 
+/**
+ * Destructor.
+ */
+RadiatedPowerTerm::~RadiatedPowerTerm() {
+    if (this->rateBuffer != nullptr)
+        delete [] this->rateBuffer;
+    if (this->ionWeights != nullptr) {
+        delete [] this->ionWeights;
+        delete [] this->ionWeights_dn;
+        delete [] this->ionWeights_dT;
+    }
+
+    delete [] this->opacity_modes;
+}
+
+/**
+ * Make sure the scratch buffers for the rate coefficients of a
+ * single charge state are allocated for the current grid.
+ */
+void RadiatedPowerTerm::AllocateRateBuffer() {
+    const len_t NCells = grid->GetNCells();
+    if (this->nRateBuffer == NCells)
+        return;
+
+    if (this->rateBuffer != nullptr)
+        delete [] this->rateBuffer;
+
+    this->rateBuffer = new real_t[12*NCells];
+    for (len_t k = 0; k < 4; k++) {
+        this->rates[k]     = this->rateBuffer + k*NCells;
+        this->drates_dn[k] = this->rateBuffer + (4+k)*NCells;
+        this->drates_dT[k] = this->rateBuffer + (8+k)*NCells;
+    }
+    this->nRateBuffer = NCells;
+}
+
+/**
+ * Evaluate the ADAS rate coefficients PLT, PRB, ACD and SCD
+ * (and optionally their derivatives with respect to n_cold and
+ * T_cold) for the given charge state in all cells, storing them
+ * in 'rates', 'drates_dn' and 'drates_dT'.
+ *
+ * If the term has a rate cache, the rates are instead read from the
+ * cache (which then evaluates them only once per rebuild for all
+ * terms using them).
+ *
+ * Z:      Atomic number of ion species.
+ * Z0:     Charge state.
+ * n_cold: Cold electron density.
+ * T_cold: Cold electron temperature.
+ * deriv:  If true, also evaluates the derivatives.
+ */
+void RadiatedPowerTerm::EvaluateADASRates(
+    const len_t Z, const len_t Z0, const real_t *n_cold, const real_t *T_cold,
+    bool deriv
+) {
+    const len_t NCells = grid->GetNCells();
+    AllocateRateBuffer();
+
+    if (rateCache != nullptr) {
+        // (same order as 'adas_rate_index')
+        const enum ADASRateCache::rate_type cached[4] = {
+            ADASRateCache::RATE_PLT, ADASRateCache::RATE_PRB,
+            ADASRateCache::RATE_ACD, ADASRateCache::RATE_SCD
+        };
+
+        for (len_t k = 0; k < 4; k++) {
+            if (!includePRB && (k == RATE_PRB || k == RATE_ACD))
+                continue;
+
+            const struct ADASRateCache::rates *r = rateCache->Get(cached[k], Z);
+            std::copy(r->R[Z0], r->R[Z0]+NCells, rates[k]);
+            if (deriv) {
+                std::copy(r->dRdn[Z0], r->dRdn[Z0]+NCells, drates_dn[k]);
+                std::copy(r->dRdT[Z0], r->dRdT[Z0]+NCells, drates_dT[k]);
+            }
+        }
+
+        return;
+    }
+
+    ADASRateInterpolator *interper[4];
+    interper[RATE_PLT] = adas->GetPLT(Z);
+    interper[RATE_PRB] = adas->GetPRB(Z);
+    interper[RATE_ACD] = adas->GetACD(Z);
+    interper[RATE_SCD] = adas->GetSCD(Z);
+
+    for (len_t k = 0; k < 4; k++) {
+        // PRB and ACD only contribute when including
+        // recombination radiation
+        if (!includePRB && (k == RATE_PRB || k == RATE_ACD))
+            continue;
+
+        // (the interpolation point is located only once
+        // for the value and both derivatives)
+        interper[k]->Eval(
+            Z0, NCells, n_cold, T_cold, rates[k],
+            (deriv ? drates_dn[k] : nullptr),
+            (deriv ? drates_dT[k] : nullptr)
+        );
+    }
+}
+
+/**
+ * Evaluate the Lyman-opaque AMJUEL rate coefficients for the
+ * ionization loss, recombination radiation and recombination (and
+ * optionally their derivatives) for the given charge state in all
+ * cells, in a single pass, storing them in 'rates', 'drates_dn' and
+ * 'drates_dT' (indexed by 'amjuel_rate_index').
+ *
+ * Z0:     Charge state.
+ * n_cold: Cold electron density.
+ * T_cold: Cold electron temperature.
+ * deriv:  If true, also evaluates the derivatives.
+ */
+void RadiatedPowerTerm::EvaluateAMJUELRates(
+    const len_t Z0, const real_t *n_cold, const real_t *T_cold, bool deriv
+) {
+    AllocateRateBuffer();
+
+    const enum AMJUEL::rate_coefficient r[3] = {
+        AMJUEL::IONIZ_LOSS_LY_OPAQUE,   // RATE_LY_IONIZ_LOSS
+        AMJUEL::REC_RAD_LY_OPAQUE,      // RATE_LY_REC_RAD
+        AMJUEL::REC_LY_OPAQUE           // RATE_LY_REC
+    };
+
+    amjuel->Eval(
+        3, r, Z0, grid->GetNCells(), n_cold, T_cold, rates,
+        (deriv ? drates_dn : nullptr), (deriv ? drates_dT : nullptr)
+    );
+}
+
+/**
+ * Evaluate the radiated power per particle, L_i^(j) + B_i^(j),
+ * for all ion charge states in all cells. If 'deriv' is true, the
+ * derivatives with respect to n_cold and T_cold are evaluated in
+ * the same pass.
+ */
+void RadiatedPowerTerm::EvaluateIonWeights(bool deriv) {
+    const len_t NCells = grid->GetNCells();
+    const len_t nZ = ionHandler->GetNZ();
+    const len_t *Zs = ionHandler->GetZs();
+
+    if (this->nIonWeights != NCells*ionHandler->GetNzs()) {
+        if (this->ionWeights != nullptr) {
+            delete [] this->ionWeights;
+            delete [] this->ionWeights_dn;
+            delete [] this->ionWeights_dT;
+        }
+
+        this->nIonWeights   = NCells*ionHandler->GetNzs();
+        this->ionWeights    = new real_t[this->nIonWeights];
+        this->ionWeights_dn = new real_t[this->nIonWeights];
+        this->ionWeights_dT = new real_t[this->nIonWeights];
+    }
+
+    const real_t *n_cold = unknowns->GetUnknownData(id_ncold);
+    const real_t *T_cold = unknowns->GetUnknownData(id_Tcold);
+
+    for (len_t iz = 0; iz < nZ; iz++) {
+        const len_t Z = Zs[iz];
+        bool lyOpaque = (Z==1 && opacity_modes[iz]==OptionConstants::OPACITY_MODE_GROUND_STATE_OPAQUE);
+
+        for (len_t Z0 = 0; Z0 <= Z; Z0++) {
+            const len_t indZ = ionHandler->GetIndex(iz,Z0);
+            real_t *W  = this->ionWeights + indZ*NCells;
+            real_t *Wn = this->ionWeights_dn + indZ*NCells;
+            real_t *WT = this->ionWeights_dT + indZ*NCells;
+
+            // Binding energies released in recombination and
+            // lost in ionization, respectively
+            const real_t dWrec = (Z0>0 ? Constants::ec * nist->GetIonizationEnergy(Z,Z0-1) : 0);
+            const real_t dWion = (Z0<Z ? Constants::ec * nist->GetIonizationEnergy(Z,Z0) : 0);
+
+            if (lyOpaque) {     // Ly-opaque deuterium radiation from AMJUEL
+                EvaluateAMJUELRates(Z0, n_cold, T_cold, deriv);
+
+                for (len_t i = 0; i < NCells; i++) {
+                    // Radiated power term (includes both line radiation and
+                    // ionization potential energy difference)
+                    //
+                    // The AMJUEL coefficients for recombination radiation do not contain bremsstrahlung,
+                    // but are on the other hand adjusted for repeated excitation/deexcitation and three-body recombination
+                    // Thus, the recombination radiation and recombination gain binding energy term should be included
+                    // regardless of wether includePRB is true or false
+                    real_t Li = rates[RATE_LY_IONIZ_LOSS][i] + rates[RATE_LY_REC_RAD][i];
+                    real_t Bi = 0;
+
+                    // Binding energy rate term (recombination gain)
+                    if (Z0 > 0) {
+                        Bi -= dWrec * rates[RATE_LY_REC][i];
+
+                        // As the AMJUEL coefficients do not include bremsstrahlung,
+                        // if this is expected to be a part of Li we need to add it explicitly.
+                        // We do this in a similar way as would have been done for all species if includePRB==false
+                        if (includePRB)
+                            Li += bremsPrefactor*sqrt(T_cold[i])*Z0*Z0*(1 + bremsRel1*T_cold[i]/Constants::mc2inEV);
+                    }
+                    W[i] = Li+Bi;
+
+                    if (!deriv)
+                        continue;
+
+                    real_t dLi_n = drates_dn[RATE_LY_IONIZ_LOSS][i] + drates_dn[RATE_LY_REC_RAD][i];
+                    real_t dLi_T = drates_dT[RATE_LY_IONIZ_LOSS][i] + drates_dT[RATE_LY_REC_RAD][i];
+                    real_t dBi_n = 0, dBi_T = 0;
+
+                    if (Z0 > 0) {
+                        dBi_n -= dWrec * drates_dn[RATE_LY_REC][i];
+                        dBi_T -= dWrec * drates_dT[RATE_LY_REC][i];
+                        if (includePRB)
+                            dLi_n += 0.5*bremsPrefactor/sqrt(T_cold[i])*Z0*Z0*(1 + 3.0*bremsRel1*T_cold[i]/Constants::mc2inEV);
+                    }
+
+                    Wn[i] = dLi_n + dBi_n;
+                    WT[i] = dLi_T + dBi_T;
+                }
+            } else {
+                EvaluateADASRates(Z, Z0, n_cold, T_cold, deriv);
+
+                for (len_t i = 0; i < NCells; i++) {
+                    // Radiated power term
+                    real_t Li = rates[RATE_PLT][i];
+                    if (includePRB)
+                        Li += rates[RATE_PRB][i];
+
+                    // Binding energy rate term
+                    real_t Bi = 0;
+                    if (Z0>0 && includePRB)     // Recombination gain
+                        Bi -= dWrec * rates[RATE_ACD][i];
+                    if (Z0<Z)                   // Ionization loss
+                        Bi += dWion * rates[RATE_SCD][i];
+
+                    W[i] = Li+Bi;
+                }
+
+                if (!deriv)
+                    continue;
+
+                for (len_t i = 0; i < NCells; i++) {
+                    real_t dLi_n = drates_dn[RATE_PLT][i];
+                    real_t dLi_T = drates_dT[RATE_PLT][i];
+                    if (includePRB) {
+                        dLi_n += drates_dn[RATE_PRB][i];
+                        dLi_T += drates_dT[RATE_PRB][i];
+                    }
+
+                    real_t dBi_n = 0, dBi_T = 0;
+                    if (Z0>0 && includePRB) {
+                        dBi_n -= dWrec * drates_dn[RATE_ACD][i];
+                        dBi_T -= dWrec * drates_dT[RATE_ACD][i];
+                    }
+                    if (Z0<Z) {
+                        dBi_n += dWion * drates_dn[RATE_SCD][i];
+                        dBi_T += dWion * drates_dT[RATE_SCD][i];
+                    }
+
+                    Wn[i] = dLi_n + dBi_n;
+                    WT[i] = dLi_T + dBi_T;
+                }
+            }
+        }
+    }
+
+    this->ionWeightsValid = true;
+    this->ionDiffWeightsValid = deriv;
+}
+
 
 /**
  * Set the weights of this term.
@@ -70,8 +340,7 @@ void RadiatedPowerTerm::SetWeights(){
  */
 void RadiatedPowerTerm::SetWeights(const real_t *ionScaleFactor, real_t *w) {
     len_t NCells = grid->GetNCells();
-    len_t nZ = ionHandler->GetNZ();
-    const len_t *Zs = ionHandler->GetZs();
+    len_t nZs = ionHandler->GetNzs();
 
     real_t *weights = (w==nullptr?this->weights : w);
     
@@ -79,70 +348,18 @@ void RadiatedPowerTerm::SetWeights(const real_t *ionScaleFactor, real_t *w) {
     real_t *T_cold = unknowns->GetUnknownData(id_Tcold);
     real_t *n_i    = unknowns->GetUnknownData(id_ni);
     
+    EvaluateIonWeights(false);
+
     for (len_t i = 0; i < NCells; i++)
             weights[i] = 0;
 
-    for(len_t iz = 0; iz<nZ; iz++){
-        ADASRateInterpolator *PLT_interper = adas->GetPLT(Zs[iz]);
-        ADASRateInterpolator *PRB_interper = adas->GetPRB(Zs[iz]);
-        ADASRateInterpolator *ACD_interper = adas->GetACD(Zs[iz]);
-        ADASRateInterpolator *SCD_interper = adas->GetSCD(Zs[iz]);
-        real_t dWi = 0;
-        real_t Li = 0;
-        real_t Bi = 0;
-        for(len_t Z0 = 0; Z0<=Zs[iz]; Z0++){
-            len_t indZ = ionHandler->GetIndex(iz,Z0);
-            for (len_t i = 0; i < NCells; i++){
-
-            	if(Zs[iz]==1 && opacity_modes[iz]==OptionConstants::OPACITY_MODE_GROUND_STATE_OPAQUE){//Ly-opaque deuterium radiation from AMJUEL
-		            // Radiated power term
-		            Li = amjuel->getIonizLossLyOpaque(Z0, n_cold[i], T_cold[i]);// includes both line radiation and ionization potential energy difference
-		            
-		            // The AMJUEL coefficients for recombination radiation do not contain bremsstrahlung,
-		            // but are on the other hand adjusted for repeated excitation/deexcitation and three-body recombination
-		            // Thus, the recombination radiation and recombination gain binding energy term should be included
-		            // regardless of wether includePRB is true or false
-		            Li += amjuel->getRecRadLyOpaque(Z0, n_cold[i], T_cold[i]);
-		            
-		            Bi = 0;
-		            // Binding energy rate term
-		            if(Z0>0){       // Recombination gain
-		            	dWi = Constants::ec * nist->GetIonizationEnergy(Zs[iz],Z0-1);
-		                Bi -= dWi * amjuel->getRecLyOpaque(Z0, n_cold[i], T_cold[i]);
-		                
-		                // As the AMJUEL coefficients do not include bremsstrahlung,
-		                // if this is expected to be a part of Li we need to add it explicitly.
-		                // We do this in a similar way as would have been done for all species if includePRB==false
-    	                if(includePRB)
-	                        Li+=bremsPrefactor*sqrt(T_cold[i])*Z0*Z0*(1 + bremsRel1*T_cold[i]/Constants::mc2inEV);
-	                }
-            	}else{
-		            // Radiated power term
-		            Li =  PLT_interper->Eval(Z0, n_cold[i], T_cold[i]);
-		            if (includePRB) 
-		                Li += PRB_interper->Eval(Z0, n_cold[i], T_cold[i]);
-		            Bi = 0;
-		            // Binding energy rate term
-		            if(Z0>0 && includePRB) {     // Recombination gain
-                        // Not needed as dWi was evaluated at the correct Z0 in the
-                        // previous iteration (when the if's are put in this order...)
-		                //dWi = Constants::ec * nist->GetIonizationEnergy(Zs[iz],Z0-1);
-		                Bi -= dWi * ACD_interper->Eval(Z0, n_cold[i], T_cold[i]);
-                    }
-		            if(Z0<Zs[iz]){ // Ionization loss
-		                dWi = Constants::ec * nist->GetIonizationEnergy(Zs[iz],Z0);
-		                Bi += dWi * SCD_interper->Eval(Z0, n_cold[i], T_cold[i]);
-		            }
-
-                }
+    for (len_t indZ = 0; indZ < nZs; indZ++) {
+        const real_t *W = this->ionWeights + indZ*NCells;
+        const real_t *ni = n_i + indZ*NCells;
+        const real_t s = (ionScaleFactor != nullptr ? ionScaleFactor[indZ] : 1);
 
-                real_t cont = n_i[indZ*NCells + i]*(Li+Bi);
-                if (ionScaleFactor != nullptr)
-                    weights[i] += ionScaleFactor[indZ] * cont;
-                else
-                    weights[i] += cont;
-            }
-        }
+        for (len_t i = 0; i < NCells; i++)
+            weights[i] += s * ni[i]*W[i];
     }
 
     /**
@@ -168,66 +385,26 @@ void RadiatedPowerTerm::SetDiffWeights(len_t derivId, len_t indZs){
 void RadiatedPowerTerm::SetDiffWeights(len_t derivId, len_t, const real_t *ionScaleFactor) {
     len_t NCells = grid->GetNCells();
     len_t nZ = ionHandler->GetNZ();
+    len_t nZs = ionHandler->GetNzs();
     const len_t *Zs = ionHandler->GetZs();
 
     real_t *n_cold = unknowns->GetUnknownData(id_ncold);
     real_t *T_cold = unknowns->GetUnknownData(id_Tcold);
     real_t *n_i    = unknowns->GetUnknownData(id_ni);
 
+    if (derivId == id_ni) {
+        if (!this->ionWeightsValid)
+            EvaluateIonWeights(false);
+    } else if (!this->ionDiffWeightsValid)
+        EvaluateIonWeights(true);
+
     if(derivId == id_ni){
-        for(len_t iz = 0; iz<nZ; iz++){
-            ADASRateInterpolator *PLT_interper = adas->GetPLT(Zs[iz]);
-            ADASRateInterpolator *PRB_interper = adas->GetPRB(Zs[iz]);
-            ADASRateInterpolator *ACD_interper = adas->GetACD(Zs[iz]);
-            ADASRateInterpolator *SCD_interper = adas->GetSCD(Zs[iz]);
-            
-            real_t dWi = 0;
-            real_t Li = 0;
-            real_t Bi = 0;
-            
-            for(len_t Z0 = 0; Z0<=Zs[iz]; Z0++){
-                len_t indZ = ionHandler->GetIndex(iz,Z0);
-                if(Zs[iz]==1 && opacity_modes[iz]==OptionConstants::OPACITY_MODE_GROUND_STATE_OPAQUE){
-		            for (len_t i = 0; i < NCells; i++){
-		                Li =  amjuel->getIonizLossLyOpaque(Z0, n_cold[i], T_cold[i]);
-	                    Li += amjuel->getRecRadLyOpaque(Z0, n_cold[i], T_cold[i]);
-				        
-				        Bi = 0;
-				        // Binding energy rate term
-				        if(Z0>0){       // Recombination gain
-				        	dWi = Constants::ec * nist->GetIonizationEnergy(Zs[iz],Z0-1);
-				            Bi -= dWi * amjuel->getRecLyOpaque(Z0, n_cold[i], T_cold[i]);
-        	                if(includePRB)
-	                            Li+=bremsPrefactor*sqrt(T_cold[i])*Z0*Z0*(1 + bremsRel1*T_cold[i]/Constants::mc2inEV);
-			            }
-
-                        real_t cont = Li+Bi;
-                        if (ionScaleFactor != nullptr)
-                            diffWeights[NCells*indZ + i] = ionScaleFactor[indZ] * cont;
-                        else
-                            diffWeights[NCells*indZ + i] = cont;
-	                }
-	            }else{
-		            for (len_t i = 0; i < NCells; i++){
-		                Li =  PLT_interper->Eval(Z0, n_cold[i], T_cold[i]);
-		                if (includePRB)
-		                    Li += PRB_interper->Eval(Z0, n_cold[i], T_cold[i]);
-		                Bi = 0;
-		                if(Z0>0 && includePRB)
-		                    Bi -= dWi * ACD_interper->Eval(Z0, n_cold[i], T_cold[i]);
-		                if(Z0<Zs[iz]){
-		                    dWi = Constants::ec * nist->GetIonizationEnergy(Zs[iz],Z0);
-		                    Bi += dWi * SCD_interper->Eval(Z0, n_cold[i], T_cold[i]);
-		                }
-
-                        real_t cont = Li+Bi;
-                        if (ionScaleFactor != nullptr)
-                            diffWeights[NCells*indZ + i] = ionScaleFactor[indZ] * cont;
-                        else
-                            diffWeights[NCells*indZ + i] = cont;
-		            }
-                }
-            }
+        for (len_t indZ = 0; indZ < nZs; indZ++) {
+            const real_t *W = this->ionWeights + indZ*NCells;
+            const real_t s = (ionScaleFactor != nullptr ? ionScaleFactor[indZ] : 1);
+
+            for (len_t i = 0; i < NCells; i++)
+                diffWeights[NCells*indZ + i] = s * W[i];
         }
         if(!includePRB){ //bremsstrahlung contribution
             for(len_t i=0; i<NCells; i++){
@@ -245,118 +422,21 @@ void RadiatedPowerTerm::SetDiffWeights(len_t derivId, len_t, const real_t *ionSc
                     }
             }
         }
-    } else if(derivId == id_ncold){
-        for(len_t iz = 0; iz<nZ; iz++){
-            ADASRateInterpolator *PLT_interper = adas->GetPLT(Zs[iz]);
-            ADASRateInterpolator *PRB_interper = adas->GetPRB(Zs[iz]);
-            ADASRateInterpolator *ACD_interper = adas->GetACD(Zs[iz]);
-            ADASRateInterpolator *SCD_interper = adas->GetSCD(Zs[iz]);
-            
-            real_t dWi = 0;
-            real_t dLi = 0;
-            real_t dBi = 0;
-            
-            for(len_t Z0 = 0; Z0<=Zs[iz]; Z0++){
-                len_t indZ = ionHandler->GetIndex(iz,Z0);
-                if(Zs[iz]==1 && opacity_modes[iz]==OptionConstants::OPACITY_MODE_GROUND_STATE_OPAQUE){
-		            for (len_t i = 0; i < NCells; i++){
-		                dLi =  amjuel->getIonizLossLyOpaque_deriv_n(Z0, n_cold[i], T_cold[i]);
-	                    dLi += amjuel->getRecRadLyOpaque_deriv_n(Z0, n_cold[i], T_cold[i]);
-				        
-				        dBi = 0;
-				        // Binding energy rate term
-				        if(Z0>0){       // Recombination gain
-				        	dWi = Constants::ec * nist->GetIonizationEnergy(Zs[iz],Z0-1);
-				            dBi -= dWi * amjuel->getRecLyOpaque_deriv_n(Z0, n_cold[i], T_cold[i]);
-				            if(includePRB)
-				                dLi+=0.5*bremsPrefactor/sqrt(T_cold[i])*Z0*Z0*(1 + 3.0*bremsRel1*T_cold[i]/Constants::mc2inEV);
-			            }
-                        
-                        real_t cont = n_i[indZ*NCells + i]*(dLi+dBi);
-                        if (ionScaleFactor != nullptr)
-                            diffWeights[i] += ionScaleFactor[indZ] * cont;
-                        else
-                            diffWeights[i] += cont;
-	                }
-                }else{                
-		            for (len_t i = 0; i < NCells; i++){
-		                real_t dLi = PLT_interper->Eval_deriv_n(Z0, n_cold[i], T_cold[i]);
-		                if (includePRB)
-		                    dLi += PRB_interper->Eval_deriv_n(Z0, n_cold[i], T_cold[i]);
-		                real_t dBi = 0;
-		                if(Z0>0 && includePRB)
-		                    dBi -= dWi * ACD_interper->Eval_deriv_n(Z0, n_cold[i], T_cold[i]);
-		                if(Z0<Zs[iz]){
-		                    dWi = Constants::ec * nist->GetIonizationEnergy(Zs[iz],Z0);
-		                    dBi += dWi * SCD_interper->Eval_deriv_n(Z0, n_cold[i], T_cold[i]);
-		                }
-
-                        real_t cont = n_i[indZ*NCells + i]*(dLi+dBi);
-                        if (ionScaleFactor != nullptr)
-                            diffWeights[i] += ionScaleFactor[indZ] * cont;
-                        else
-                            diffWeights[i] += cont;
-		            }
-                }
-            }
+    } else if(derivId == id_ncold || derivId == id_Tcold){
+        const real_t *dW = (derivId == id_ncold ? this->ionWeights_dn : this->ionWeights_dT);
+        for (len_t indZ = 0; indZ < nZs; indZ++) {
+            const real_t *dWi = dW + indZ*NCells;
+            const real_t *ni = n_i + indZ*NCells;
+            const real_t s = (ionScaleFactor != nullptr ? ionScaleFactor[indZ] : 1);
+
+            for (len_t i = 0; i < NCells; i++)
+                diffWeights[i] += s * ni[i]*dWi[i];
         }
-        if(!includePRB) //bremsstrahlung contribution
+
+        if(!includePRB && derivId == id_ncold) //bremsstrahlung contribution
             for(len_t i=0; i<NCells; i++)
                 diffWeights[i] += bremsPrefactor*sqrt(T_cold[i])*bremsRel2*T_cold[i]/Constants::mc2inEV;
-    } else if (derivId == id_Tcold){
-        for(len_t iz = 0; iz<nZ; iz++){
-            ADASRateInterpolator *PLT_interper = adas->GetPLT(Zs[iz]);
-            ADASRateInterpolator *PRB_interper = adas->GetPRB(Zs[iz]);
-            ADASRateInterpolator *ACD_interper = adas->GetACD(Zs[iz]);
-            ADASRateInterpolator *SCD_interper = adas->GetSCD(Zs[iz]);
-            
-            real_t dWi = 0;
-            real_t dLi = 0;
-            real_t dBi = 0;
-            
-            for(len_t Z0 = 0; Z0<=Zs[iz]; Z0++){
-                len_t indZ = ionHandler->GetIndex(iz,Z0);
-                if(Zs[iz]==1 && opacity_modes[iz]==OptionConstants::OPACITY_MODE_GROUND_STATE_OPAQUE){
-		            for (len_t i = 0; i < NCells; i++){
-		                dLi =  amjuel->getIonizLossLyOpaque_deriv_T(Z0, n_cold[i], T_cold[i]);
-		                dLi += amjuel->getRecRadLyOpaque_deriv_T(Z0, n_cold[i], T_cold[i]);
-				        
-				        dBi = 0;
-				        // Binding energy rate term
-				        if(Z0>0){       // Recombination gain
-				        	dWi = Constants::ec * nist->GetIonizationEnergy(Zs[iz],Z0-1);
-				            dBi -= dWi * amjuel->getRecLyOpaque_deriv_T(Z0, n_cold[i], T_cold[i]);
-			            }
-
-                        real_t cont = n_i[indZ*NCells + i]*(dLi+dBi);
-                        if (ionScaleFactor != nullptr)
-                            diffWeights[i] += ionScaleFactor[indZ] * cont;
-                        else
-                            diffWeights[i] += cont;
-	                }
-                }else{ 
-		            for (len_t i = 0; i < NCells; i++){
-		                real_t dLi = PLT_interper->Eval_deriv_T(Z0, n_cold[i], T_cold[i]);
-		                if (includePRB)
-		                    dLi += PRB_interper->Eval_deriv_T(Z0, n_cold[i], T_cold[i]);
-		                real_t dBi = 0;
-		                if(Z0>0 && includePRB)
-		                    dBi -= dWi * ACD_interper->Eval_deriv_T(Z0, n_cold[i], T_cold[i]);
-		                if(Z0<Zs[iz]){
-		                    dWi = Constants::ec * nist->GetIonizationEnergy(Zs[iz],Z0);
-		                    dBi += dWi * SCD_interper->Eval_deriv_T(Z0, n_cold[i], T_cold[i]);
-		                }
-                        
-                        real_t cont = n_i[indZ*NCells + i]*(dLi+dBi);
-                        if (ionScaleFactor != nullptr)
-                            diffWeights[i] += ionScaleFactor[indZ] * cont;
-                        else
-                            diffWeights[i] += cont;
-		            }
-                }
-            }
-        }
-        if(!includePRB){ //bremsstrahlung contribution
+        else if(!includePRB){ //bremsstrahlung contribution
             for(len_t i=0; i<NCells; i++){
                 real_t ionTerm = ionHandler->GetZeff(i)*ionHandler->GetFreeElectronDensityFromQuasiNeutrality(i);
                 real_t relativisticCorrection = bremsRel1*ionTerm + bremsRel2*n_cold[i]; 
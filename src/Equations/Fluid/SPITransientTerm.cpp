@@ -24,8 +24,8 @@ SPITransientTerm::SPITransientTerm(FVM::Grid *grid, const len_t unknownId, len_t
  * dt: Length of next time step to take.
  */
 void SPITransientTerm::Rebuild(const real_t, const real_t dt, FVM::UnknownQuantityHandler *uqty) {
-    this->dt = dt;
-    this->xn = uqty->GetUnknownDataPrevious(this->unknownId);
+    this->dt = uqty->GetTransientTimeStep(dt);
+    this->xn = uqty->GetUnknownDataTransientPrevious(this->unknownId, dt);
 }
 
 bool SPITransientTerm::SetJacobianBlock(const len_t, const len_t derivId, FVM::Matrix *jac, const real_t*){
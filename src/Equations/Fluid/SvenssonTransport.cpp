@@ -37,47 +37,52 @@ void SvenssonTransport<FVM::DiffusionTerm>::_setcoeff(
 
 
 
-void SvenssonTransportDiffusionTerm::EvaluateIntegrand(len_t ir){
+/**
+ * The p-integrals below are evaluated as dot products of the
+ * integrand with the (grid constant) quadrature weights 'pWeights',
+ * and only read the state of the term, so that they can be evaluated
+ * for several radii in parallel.
+ */
+real_t SvenssonTransportDiffusionTerm::EvaluatePIntegral(const len_t ir) const {
     // Inverse of p-bar on the Flux grid
-    real_t pBarInv_f = this->GetPBarInv_f(ir);
+    const real_t pBarInv_f = this->GetPBarInv_f(ir);
     
     const len_t offset = ir*this->np;
-    // Calculating the integrand
-    for( len_t i=0; i < this->np; i++){
-        real_t p_tmp = p[i];
-        real_t coeff_tmp = this->coeffRP[i+offset];
-        real_t exp_tmp = exp( -(p_tmp - this->pStar) * pBarInv_f );
-        real_t tmp = coeff_tmp * exp_tmp * pBarInv_f ;
-        this->integrand[i] = tmp;
-    }
+    real_t I = 0;
+    for (len_t i = 0; i < this->np; i++)
+        I += this->pWeights[i] * this->coeffRP[i+offset]
+            * exp( -(this->p[i] - this->pStar) * pBarInv_f );
+
+    return I * pBarInv_f;
 }
 
 
-void SvenssonTransportAdvectionTermA::EvaluateIntegrand(len_t ir){
+real_t SvenssonTransportAdvectionTermA::EvaluatePIntegral(const len_t ir) const {
     // Inverse of p-bar on the Flux grid
-    real_t pBarInv_f = this->GetPBarInv_f(ir);
+    const real_t pBarInv_f = this->GetPBarInv_f(ir);
     
     const len_t offset = ir * this->np;
-    // Calculating the integrand
-    for( len_t i=0; i < this->np; i++){
-        this->integrand[i] = this->coeffRP[i+offset] * pBarInv_f
+    real_t I = 0;
+    for (len_t i = 0; i < this->np; i++)
+        I += this->pWeights[i] * this->coeffRP[i+offset]
             * exp( -(this->p[i] - this->pStar) * pBarInv_f );
-    }
     
+    return I * pBarInv_f;
 }
 
 
-void SvenssonTransportAdvectionTermD::EvaluateIntegrand(len_t ir){
+real_t SvenssonTransportAdvectionTermD::EvaluatePIntegral(const len_t ir) const {
     // Inverse of p-bar on the Flux grid
     real_t pBarInv_f, dr_pBarInv_f;
     pBarInv_f = this->GetPBarInv_f(ir, &dr_pBarInv_f);
     
     const len_t offset = ir * this->np;
-    // Calculating the integrand
-    for( len_t i=0; i < this->np; i++){
+    real_t I = 0;
+    for (len_t i = 0; i < this->np; i++) {
         real_t pPrime = this->p[i] - this->pStar;
-        this->integrand[i] = -this->coeffRP[i+offset]
-            * dr_pBarInv_f * (1 - pPrime*pBarInv_f)
-            * exp(-pPrime * pBarInv_f);
+        I += this->pWeights[i] * this->coeffRP[i+offset]
+            * (1 - pPrime*pBarInv_f) * exp(-pPrime * pBarInv_f);
     }
+
+    return -dr_pBarInv_f * I;
 }
@@ -3,6 +3,12 @@
  * source term, which takes the quadratic form
  *     T = S(r,p) * n_tot(r,t) * n_re(r,t),
  * where S is only a function of phase-space coordinates.
+ *
+ * Since S only changes with the grid (and with the sign of E, which
+ * determines the pitch of the knock-on electrons), it is tabulated
+ * in all cells and only re-evaluated at radii where E changes sign.
+ * The source and its n_tot jacobian are then obtained directly from
+ * the table.
  */
 
 #include "DREAM/Equations/Kinetic/AvalancheSourceRP.hpp"
@@ -30,12 +36,103 @@ AvalancheSourceRP::AvalancheSourceRP(
     real_t e = Constants::ec;
     real_t epsmc = 4*M_PI*Constants::eps0 * Constants::me * Constants::c;
     this->preFactor = (e*e*e*e)/(epsmc*epsmc*Constants::c);
+
+    AllocateSourceShape();
+}
+
+/**
+ * Destructor.
+ */
+AvalancheSourceRP::~AvalancheSourceRP(){
+    DeallocateSourceShape();
+}
+
+/**
+ * Allocate the source-shape table (and mark it as needing
+ * to be evaluated).
+ */
+void AvalancheSourceRP::AllocateSourceShape(){
+    DeallocateSourceShape();
+
+    this->sourceShape = new real_t[grid->GetNCells()];
+    this->shapeOffset = new len_t[nr];
+    this->shapeSign   = new int_t[nr];
+
+    len_t offset = 0;
+    for(len_t ir=0; ir<nr; ir++){
+        shapeOffset[ir] = offset;
+        shapeSign[ir] = 0;
+        offset += n1[ir]*n2[ir];
+    }
+}
+
+/**
+ * Free the source-shape table.
+ */
+void AvalancheSourceRP::DeallocateSourceShape(){
+    if(sourceShape == nullptr)
+        return;
+
+    delete [] sourceShape;
+    delete [] shapeOffset;
+    delete [] shapeSign;
+    sourceShape = nullptr;
+}
+
+/**
+ * Method called whenever the grid is rebuilt.
+ */
+bool AvalancheSourceRP::GridRebuilt(){
+    FluidSourceTerm::GridRebuilt();
+    AllocateSourceShape();
+    return true;
+}
+
+/**
+ * Returns the sign of the pitch of the knock-on
+ * electrons at radius ir.
+ */
+int_t AvalancheSourceRP::GetRESign(len_t ir){
+    if (this->sourceXiMode == RP_SOURCE_PITCH_ADAPTIVE) {
+        const real_t E = unknowns->GetUnknownData(id_Efield)[ir];
+        return (E>=0) ? 1: -1;
+    } else if (this->sourceXiMode == RP_SOURCE_PITCH_POSITIVE)
+        return 1;
+    else
+        return -1;
+}
+
+/**
+ * Evaluates the source-shape function at all radii where it
+ * has not been evaluated yet, or where E has changed sign.
+ */
+void AvalancheSourceRP::RebuildSourceShape(){
+    for(len_t ir=0; ir<nr; ir++){
+        int_t RESign = GetRESign(ir);
+        if(RESign == shapeSign[ir])
+            continue;
+
+        real_t *S = sourceShape + shapeOffset[ir];
+        for(len_t j=0; j<n2[ir]; j++)
+            for(len_t i=0; i<n1[ir]; i++)
+                S[j*n1[ir]+i] = EvaluateRPSource(ir,i,j,RESign);
+        shapeSign[ir] = RESign;
+    }
+}
+
+/**
+ * Rebuild the source term.
+ */
+void AvalancheSourceRP::Rebuild(const real_t t, const real_t dt, FVM::UnknownQuantityHandler *u){
+    RebuildSourceShape();
+    FluidSourceTerm::Rebuild(t, dt, u);
 }
 
 /**
  * Evaluates the constant (only grid dependent) source-shape function S(r,p)
+ * for knock-on electrons with the pitch sign 'RESign'.
  */
-real_t AvalancheSourceRP::EvaluateRPSource(len_t ir, len_t i, len_t j){
+real_t AvalancheSourceRP::EvaluateRPSource(len_t ir, len_t i, len_t j, int_t RESign){
     if(sourceMode == RP_SOURCE_MODE_FLUID)
         return scaleFactor*EvaluateNormalizedTotalKnockOnNumber(pCutoff);
 
@@ -54,15 +151,6 @@ real_t AvalancheSourceRP::EvaluateRPSource(len_t ir, len_t i, len_t j){
     real_t gm = sqrt(1+pm*pm);
     real_t pPart = ( 1/(gm-1) - 1/(gp-1) ) / dp;
     
-    int_t RESign;
-    if (this->sourceXiMode == RP_SOURCE_PITCH_ADAPTIVE) {
-        const real_t E = unknowns->GetUnknownData(id_Efield)[ir];
-        RESign = (E>=0) ? 1: -1;
-    } else if (this->sourceXiMode == RP_SOURCE_PITCH_POSITIVE)
-        RESign = 1;
-    else
-        RESign = -1;
-
     const real_t deltaHat = grid->GetAvalancheDeltaHat(ir,i,j, RESign);
     return scaleFactor * preFactor * pPart * deltaHat;
 }
@@ -71,7 +159,7 @@ real_t AvalancheSourceRP::EvaluateRPSource(len_t ir, len_t i, len_t j){
  * Returns the source at grid point (ir,i,j).
  */
 real_t AvalancheSourceRP::GetSourceFunction(len_t ir, len_t i, len_t j){
-    real_t S = EvaluateRPSource(ir,i,j);
+    real_t S = sourceShape[shapeOffset[ir] + n1[ir]*j + i];
     const real_t ntot = unknowns->GetUnknownData(id_ntot)[ir];
     return S * ntot;
 }
@@ -81,7 +169,7 @@ real_t AvalancheSourceRP::GetSourceFunction(len_t ir, len_t i, len_t j){
  */
 real_t AvalancheSourceRP::GetSourceFunctionJacobian(len_t ir, len_t i, len_t j, const len_t derivId){
     if(derivId==id_ntot)
-        return EvaluateRPSource(ir,i,j);
+        return sourceShape[shapeOffset[ir] + n1[ir]*j + i];
     else
         return 0;
 }
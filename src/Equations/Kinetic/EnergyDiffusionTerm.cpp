@@ -21,6 +21,7 @@ EnergyDiffusionTerm::EnergyDiffusionTerm(FVM::Grid *g, CollisionQuantityHandler
     SetName("EnergyDiffusionTerm");
 
     this->gridtype = mgtype;
+    this->cqh      = cqh;
     this->nuPar    = cqh->GetNuPar();
     AddUnknownForJacobian(unknowns, unknowns->GetUnknownID(OptionConstants::UQTY_N_COLD));
     AddUnknownForJacobian(unknowns, unknowns->GetUnknownID(OptionConstants::UQTY_T_COLD));
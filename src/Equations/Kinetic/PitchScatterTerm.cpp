@@ -19,6 +19,7 @@ PitchScatterTerm::PitchScatterTerm(FVM::Grid *g, CollisionQuantityHandler *cqh,
     SetName("PitchScatterTerm");
 
     this->gridtype  = mgtype;
+    this->cqh       = cqh;
     this->nuD       = cqh->GetNuD();
     AddUnknownForJacobian(unknowns, unknowns->GetUnknownID(OptionConstants::UQTY_N_COLD));
     AddUnknownForJacobian(unknowns, unknowns->GetUnknownID(OptionConstants::UQTY_T_COLD));
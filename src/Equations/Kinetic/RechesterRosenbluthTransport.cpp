@@ -31,6 +31,8 @@ RechesterRosenbluthTransport::RechesterRosenbluthTransport(
 ) : DiffusionTerm(grid), mgtype(mgtype), deltaBOverB(dB_B) {
 
     SetName("RechesterRosenbluthTransport");
+    // The coefficient only depends on time
+    SetRebuildInputs();
 }
 
 /**
@@ -38,29 +40,26 @@ RechesterRosenbluthTransport::RechesterRosenbluthTransport(
  */
 RechesterRosenbluthTransport::~RechesterRosenbluthTransport() {
     delete this->deltaBOverB;
+    delete [] this->geometricFactor;
 }
 
-
 /**
- * Rebuild this equation term.
+ * Called when the grid has been rebuilt.
  */
-void RechesterRosenbluthTransport::Rebuild(
-    const real_t t, const real_t, FVM::UnknownQuantityHandler*
-) {
-    const real_t *dB_B = this->deltaBOverB->Eval(t);
+bool RechesterRosenbluthTransport::GridRebuilt() {
+    this->DiffusionTerm::GridRebuilt();
+    this->geometricFactorValid = false;
 
-    // XXX Here we assume that all momentum grids are the same
-    // at all radii...
-    const len_t nr = this->grid->GetNr();
-    auto mg = this->grid->GetMomentumGrid(0);
+    return true;
+}
 
+/**
+ * Evaluate the part of the diffusion coefficient which only
+ * depends on the grid, i.e. Drr / (dB/B)^2.
+ */
+void RechesterRosenbluthTransport::BuildGeometricFactor() {
+    const len_t nr = this->grid->GetNr();
     real_t R0  = this->grid->GetRadialGrid()->GetR0();
-    const real_t
-        *p1 = mg->GetP1(),
-        *p2 = mg->GetP2();
-    const len_t
-        np1 = mg->GetNp1(),
-        np2 = mg->GetNp2();
 
     // Major radius is set to 'inf' in cylindrical geometry.
     // If so, we instead set it to 1 and effectively remove
@@ -70,17 +69,32 @@ void RechesterRosenbluthTransport::Rebuild(
     if (isinf(R0))
         R0 = 1.0;
 
+    len_t N = 0;
+    for (len_t ir = 0; ir < nr+1; ir++)
+        N += this->grid->GetMomentumGrid_fr(ir)->GetNCells();
+
+    delete [] this->geometricFactor;
+    this->geometricFactor = new real_t[N];
+
+    real_t *G = this->geometricFactor;
     for (len_t ir = 0; ir < nr+1; ir++) {
         const real_t q = 1.0;   // TODO (safety factor)
         const real_t *BA_xi = grid->GetBA_xi_fr(ir);
+        auto mg = this->grid->GetMomentumGrid_fr(ir);
+        const real_t
+            *p1 = mg->GetP1(),
+            *p2 = mg->GetP2();
+        const len_t
+            np1 = mg->GetNp1(),
+            np2 = mg->GetNp2();
+
         for (len_t i = 0; i < np1; i++)
             if(np2==1 && (mgtype == OptionConstants::MOMENTUMGRID_TYPE_PXI)){
                 // ISOTROPIC mode: set pitch-angle averaged diffusion coefficient
                 real_t v = Constants::c * p1[i] / sqrt(1+p1[i]*p1[i]);
                 real_t xiT = grid->GetRadialGrid()->GetXi0TrappedBoundary_fr(ir);
                 real_t geometricFactor = 0.5 * grid->GetRadialGrid()->GetFSA_B_f(ir) * (1 - xiT*xiT);
-                real_t D = M_PI * q * R0 * dB_B[ir]*dB_B[ir] * v * geometricFactor;
-                Drr(ir,i,0) += D;
+                G[i] = M_PI * q * R0 * v * geometricFactor;
             } else {
                 for (len_t j = 0; j < np2; j++) {
                     real_t vpar=1;
@@ -89,11 +103,41 @@ void RechesterRosenbluthTransport::Rebuild(
                     else if (mgtype == OptionConstants::MOMENTUMGRID_TYPE_PPARPPERP)
                         vpar = Constants::c * p1[i] / sqrt(1 + p1[i]*p1[i] + p2[j]*p2[j]);
 
-                    // Set diffusion coefficient...
-                    real_t D = M_PI * q * R0 * dB_B[ir]*dB_B[ir] * fabs(vpar) * BA_xi[j*np1+i];
-                    Drr(ir, i, j) += D;
+                    G[j*np1+i] = M_PI * q * R0 * fabs(vpar) * BA_xi[j*np1+i];
                 }
             }
-        }
+
+        G += np1*np2;
+    }
+
+    this->geometricFactorValid = true;
 }
 
+/**
+ * Rebuild this equation term. Since only the magnetic perturbation
+ * amplitude depends on time, the (grid-constant) remainder of the
+ * diffusion coefficient is evaluated once, and is only rescaled here.
+ */
+void RechesterRosenbluthTransport::Rebuild(
+    const real_t t, const real_t, FVM::UnknownQuantityHandler*
+) {
+    if (!this->geometricFactorValid)
+        this->BuildGeometricFactor();
+
+    const real_t *dB_B = this->deltaBOverB->Eval(t);
+
+    const len_t nr = this->grid->GetNr();
+    const real_t *G = this->geometricFactor;
+    for (len_t ir = 0; ir < nr+1; ir++) {
+        const real_t dB2 = dB_B[ir]*dB_B[ir];
+        const len_t
+            np1 = this->grid->GetNp1_fr(ir),
+            np2 = this->grid->GetNp2_fr(ir);
+
+        for (len_t j = 0; j < np2; j++)
+            for (len_t i = 0; i < np1; i++)
+                Drr(ir, i, j) += dB2 * G[j*np1+i];
+
+        G += np1*np2;
+    }
+}
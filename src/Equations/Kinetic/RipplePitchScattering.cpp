@@ -52,6 +52,8 @@ RipplePitchScattering::RipplePitchScattering(
 ) : DiffusionTerm(grid), mode(mode), deltaCoils(deltaCoils), nModes(nModes), m(m), n(n), dB_B(dB_B) {
     
     SetName("RipplePitchScattering");
+    // The coefficient only depends on time
+    SetRebuildInputs();
 
     if (mgtype != OptionConstants::MOMENTUMGRID_TYPE_PXI)
         throw DREAMException("PitchScatterTerm: Only p-xi grids are supported.");
@@ -65,8 +67,7 @@ RipplePitchScattering::RipplePitchScattering(
 RipplePitchScattering::~RipplePitchScattering() {
     delete [] this->m;
     delete [] this->n;
-    delete [] this->p_mn[0];
-    delete [] this->p_mn;
+    Deallocate();
 
     delete this->dB_B;
 }
@@ -83,7 +84,72 @@ void RipplePitchScattering::Allocate() {
     for (len_t k = 1; k < this->nModes; k++)
         this->p_mn[k] = this->p_mn[k-1] + nr;
 
+    len_t N = 0;
+    for (len_t ir = 0; ir < nr; ir++) {
+        auto mg = this->grid->GetMomentumGrid(ir);
+        N += mg->GetNp1() * (mg->GetNp2()+1);
+    }
+
+    this->prefactor = new real_t*[nr];
+    this->prefactor[0] = new real_t[N];
+    for (len_t ir = 1; ir < nr; ir++) {
+        auto mg = this->grid->GetMomentumGrid(ir-1);
+        this->prefactor[ir] = this->prefactor[ir-1] + mg->GetNp1() * (mg->GetNp2()+1);
+    }
+
     CalculateResonantMomentum();
+    CalculatePrefactor();
+}
+
+/**
+ * Release memory used by this term.
+ */
+void RipplePitchScattering::Deallocate() {
+    delete [] this->p_mn[0];
+    delete [] this->p_mn;
+    delete [] this->prefactor[0];
+    delete [] this->prefactor;
+}
+
+/**
+ * Evaluate the part of the diffusion coefficient which depends
+ * neither on time nor on the perturbation mode, i.e.
+ *
+ *   pi/32 * e*B/me * v_||/c * (1-xi0^2)/p^2,
+ *
+ * so that each rebuild only needs to evaluate the resonance
+ * function H_mn and the perturbation amplitudes.
+ */
+void RipplePitchScattering::CalculatePrefactor() {
+    const len_t nr = this->grid->GetNr();
+
+    const real_t e  = Constants::ec;
+    const real_t me = Constants::me;
+
+    for (len_t ir = 0; ir < nr; ir++) {
+        auto mg = this->grid->GetMomentumGrid(ir);
+        const len_t np    = mg->GetNp1();
+        const len_t nxi   = mg->GetNp2();
+        const real_t *p   = mg->GetP1();
+        const real_t *xi0 = mg->GetP2_f();
+
+        // Magnetic field strength
+        //const real_t B = this->grid->GetRadialGrid()->GetFSA_B(ir);
+        const real_t B = this->grid->GetRadialGrid()->GetBmin(ir);
+
+        for (len_t j_f = 0; j_f < nxi+1; j_f++) {
+            const real_t absxi = min(fabs(xi0[j_f]),1.0); // handles precision errors in fabs
+            for (len_t i = 0; i < np; i++) {
+                const real_t ppar  = p[i]*absxi;
+                const real_t p2    = p[i]*p[i];
+                const real_t gamma = sqrt(1+p2);
+
+                real_t betapar = ppar/gamma;
+                this->prefactor[ir][j_f*np + i] =
+                    M_PI/32.0 * e*B/me * betapar * (1-xi0[j_f]*xi0[j_f])/p2;
+            }
+        }
+    }
 }
 
 /**
@@ -115,9 +181,9 @@ void RipplePitchScattering::CalculateResonantMomentum() {
  * Called when the grid is rebuilt.
  */
 bool RipplePitchScattering::GridRebuilt() {
-    delete [] this->p_mn[0];
-    delete [] this->p_mn;
+    this->DiffusionTerm::GridRebuilt();
 
+    Deallocate();
     Allocate();
 
     return true;
@@ -131,8 +197,10 @@ bool RipplePitchScattering::GridRebuilt() {
 void RipplePitchScattering::Rebuild(const real_t t, const real_t, FVM::UnknownQuantityHandler*) {
     const len_t nr = this->grid->GetNr();
 
-    const real_t e  = Constants::ec;
-    const real_t me = Constants::me;
+    // Beyond this many widths from the resonance, the difference of
+    // error functions making up the Gaussian resonance function
+    // vanishes to double precision
+    const real_t ERF_CUTOFF = 6.0;
 
     for (len_t k = 0; k < this->nModes; k++) {
         const real_t *dB_mn_B =this->dB_B->Eval(k, t);
@@ -141,45 +209,53 @@ void RipplePitchScattering::Rebuild(const real_t t, const real_t, FVM::UnknownQu
             auto mg = this->grid->GetMomentumGrid(ir);
             const len_t np    = mg->GetNp1();
             const len_t nxi   = mg->GetNp2();
-            const real_t *p   = mg->GetP1();
             const real_t *p_f = mg->GetP1_f();
             const real_t *dp  = mg->GetDp1();
             const real_t *xi0 = mg->GetP2_f();
 
-            // Magnetic field strength
-            //const real_t B = this->grid->GetRadialGrid()->GetFSA_B(ir);
-            const real_t B = this->grid->GetRadialGrid()->GetBmin(ir);
+            const real_t dB2 = dB_mn_B[ir]*dB_mn_B[ir];
 
             for (len_t j_f = 0; j_f < nxi+1; j_f++){
                 const real_t absxi = min(fabs(xi0[j_f]),1.0); // handles precision errors in fabs
+                const real_t *G = this->prefactor[ir] + j_f*np;
+
+                // Resonant momentum and width of the resonance
+                real_t p_resonance_lo=0, p_resonance_hi=0, p0=0, deltaP=0;
+                if (mode == OptionConstants::EQTERM_RIPPLE_MODE_BOX) {
+                    // Solve for the p width of the resonant region
+                    const real_t a = sqrt( dB_mn_B[ir] * absxi * sqrt(1-absxi*absxi) );
+                    p_resonance_lo = p_mn[k][ir] / (absxi+a); // lower limit
+                    p_resonance_hi = p_mn[k][ir] / (absxi-a); // upper limit
+                } else if (mode == OptionConstants::EQTERM_RIPPLE_MODE_GAUSSIAN) {
+                    p0 = p_mn[k][ir] / absxi;
+                    deltaP = p0 * sqrt( dB_mn_B[ir]*sqrt(1-absxi*absxi) );
+                }
+
                 for (len_t i = 0; i < np; i++) {
-                    const real_t ppar  = p[i]*absxi;
-                    const real_t p2    = p[i]*p[i];
-                    const real_t gamma = sqrt(1+p2);
-                    
+                    // No contribution from cells where v_|| = 0
+                    if (G[i] == 0)
+                        continue;
+
                     real_t Hmn = 0.0;
                     if(mode == OptionConstants::EQTERM_RIPPLE_MODE_BOX){
-                        // Solve for the p width of the resonant region
-                        const real_t a = sqrt( dB_mn_B[ir] * absxi * sqrt(1-absxi*absxi) );
-                        const real_t p_resonance_lo = p_mn[k][ir] / (absxi+a); // lower limit
-                        const real_t p_resonance_hi = p_mn[k][ir] / (absxi-a); // upper limit
                         real_t dpBar = min(p_f[i+1], p_resonance_hi ) - max(p_f[i], p_resonance_lo);
                         // Is resonant momentum interval outside of current cell?
                         if (dpBar <= 0)
                             continue;
                         Hmn     = dpBar / (dp[i]*(p_resonance_hi-p_resonance_lo));
                     } else if (mode == OptionConstants::EQTERM_RIPPLE_MODE_GAUSSIAN){
-                        real_t p0 = p_mn[k][ir] / absxi;
-                        real_t deltaP = p0 * sqrt( dB_mn_B[ir]*sqrt(1-absxi*absxi) );
-                        if(deltaP)
-                            Hmn = 1.0 / (absxi*dp[i]) * ( gsl_sf_erf( (p_f[i+1]-p0)/deltaP ) - gsl_sf_erf( (p_f[i]-p0)/deltaP ) );
-                        else if ( p_f[i+1]>p0 && p_f[i]<=p0 )
+                        if(deltaP) {
+                            const real_t x1 = (p_f[i]-p0)/deltaP, x2 = (p_f[i+1]-p0)/deltaP;
+                            // Cell far away from the resonance?
+                            if (x1 > ERF_CUTOFF || x2 < -ERF_CUTOFF)
+                                continue;
+
+                            Hmn = 1.0 / (absxi*dp[i]) * ( gsl_sf_erf(x2) - gsl_sf_erf(x1) );
+                        } else if ( p_f[i+1]>p0 && p_f[i]<=p0 )
                             Hmn = 2.0 / (absxi*dp[i]);
                     }
-                    real_t betapar = ppar/gamma;
-                    real_t Dperp   = M_PI/32.0 * e*B/me * betapar * dB_mn_B[ir]*dB_mn_B[ir] * Hmn;
 
-                    D22(ir, i, j_f) += (1-xi0[j_f]*xi0[j_f])/p2 * Dperp;
+                    D22(ir, i, j_f) += G[i] * dB2 * Hmn;
                 }
             }
         }
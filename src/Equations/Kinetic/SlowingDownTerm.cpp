@@ -20,6 +20,7 @@ SlowingDownTerm::SlowingDownTerm(
     SetName("SlowingDownTerm");
 
     this->gridtype = mgtype;
+    this->cqh = cqh;
     this->nuS = cqh->GetNuS();
     AddUnknownForJacobian(unknowns, unknowns->GetUnknownID(OptionConstants::UQTY_N_COLD));
     AddUnknownForJacobian(unknowns, unknowns->GetUnknownID(OptionConstants::UQTY_T_COLD));
@@ -100,5 +101,4 @@ void SlowingDownTerm::SetPartialAdvectionTerm(len_t derivId, len_t nMultiples){
             offset1 += (np1+1)*np2;
             offset2 += np1*(np2+1);
         }
-    delete [] dp3nuSAtZero;
 }
@@ -21,15 +21,83 @@ SynchrotronTerm::SynchrotronTerm(FVM::Grid *g, enum OptionConstants::momentumgri
     SetName("SynchrotronTerm");
 
     this->gridtype  = mgtype;
+
+    // The coefficients only depend on the grid
+    SetRebuildInputs({}, false);
+
+    AllocateTables();
 }
 
+/**
+ * Destructor.
+ */
+SynchrotronTerm::~SynchrotronTerm() {
+    DeallocateTables();
+}
 
 /**
- * Build the coefficients of this advection (or diffusion) term.
+ * Allocate memory for the tabulated coefficients.
  */
-void SynchrotronTerm::Rebuild(const real_t, const real_t, FVM::UnknownQuantityHandler*){
+void SynchrotronTerm::AllocateTables() {
+    const len_t nr = grid->GetNr();
+
+    len_t N1 = 0, N2 = 0;
+    for (len_t ir = 0; ir < nr; ir++) {
+        auto *mg = grid->GetMomentumGrid(ir);
+        N1 += (mg->GetNp1()+1) * mg->GetNp2();
+        N2 += mg->GetNp1() * (mg->GetNp2()+1);
+    }
+
+    this->tableF1 = new real_t*[nr];
+    this->tableF2 = new real_t*[nr];
+    this->tableF1[0] = new real_t[N1];
+    this->tableF2[0] = new real_t[N2];
+    for (len_t ir = 1; ir < nr; ir++) {
+        auto *mg = grid->GetMomentumGrid(ir-1);
+        this->tableF1[ir] = this->tableF1[ir-1] + (mg->GetNp1()+1) * mg->GetNp2();
+        this->tableF2[ir] = this->tableF2[ir-1] + mg->GetNp1() * (mg->GetNp2()+1);
+    }
+
+    this->tablesValid = false;
+}
+
+/**
+ * Release memory used by the tabulated coefficients.
+ */
+void SynchrotronTerm::DeallocateTables() {
+    if (this->tableF1 == nullptr)
+        return;
+
+    delete [] this->tableF1[0];
+    delete [] this->tableF2[0];
+    delete [] this->tableF1;
+    delete [] this->tableF2;
+
+    this->tableF1 = nullptr;
+    this->tableF2 = nullptr;
+}
+
+/**
+ * Method called when the grid has been rebuilt.
+ */
+bool SynchrotronTerm::GridRebuilt() {
+    this->FVM::AdvectionTerm::GridRebuilt();
+
+    DeallocateTables();
+    AllocateTables();
+
+    return true;
+}
+
+
+/**
+ * Evaluate the advection coefficients of this term. Since the
+ * coefficients only depend on the grid (through the magnetic field),
+ * they are tabulated once and then re-used in every rebuild.
+ */
+void SynchrotronTerm::BuildTables() {
     const len_t nr = grid->GetNr();
-    
+
     bool gridtypePXI, gridtypePPARPPERP;
     real_t xi0, gamma, p;
     real_t Bmin;
@@ -48,6 +116,12 @@ void SynchrotronTerm::Rebuild(const real_t, const real_t, FVM::UnknownQuantityHa
         BA2_f1 = grid->GetBA_xi2B2_f1(ir);
         BA2_f2 = grid->GetBA_xi2B2_f2(ir);
         
+        // Coefficients not set below vanish
+        for (len_t i = 0; i < (np1+1)*np2; i++)
+            tableF1[ir][i] = 0;
+        for (len_t i = 0; i < np1*(np2+1); i++)
+            tableF2[ir][i] = 0;
+
         Bmin = rGrid->GetBmin(ir);
         real_t preFactor = Bmin*Bmin*constPrefactor;
         if (gridtypePXI) {
@@ -55,7 +129,7 @@ void SynchrotronTerm::Rebuild(const real_t, const real_t, FVM::UnknownQuantityHa
                 for(len_t i=0; i<np1+1; i++){
                     p = mg->GetP_f1(i,0);
                     gamma = mg->GetGamma_f1(i,0);
-                    F1(ir,i,0) += -2.0/3.0*preFactor*p*gamma*rGrid->GetFSA_B2(ir);
+                    tableF1[ir][i] = -2.0/3.0*preFactor*p*gamma*rGrid->GetFSA_B2(ir);
                 }
                 continue;
             }
@@ -65,7 +139,7 @@ void SynchrotronTerm::Rebuild(const real_t, const real_t, FVM::UnknownQuantityHa
                     xi0 = mg->GetP2(j);
                     p = mg->GetP1_f(i);
 
-                    F1(ir, i, j)  += -preFactor * p*sqrt(1+p*p)*(1-xi0*xi0) * BA1_f1[j*(np1+1)+i] ;
+                    tableF1[ir][j*(np1+1)+i] = -preFactor * p*sqrt(1+p*p)*(1-xi0*xi0) * BA1_f1[j*(np1+1)+i] ;
                 }
 
             for (len_t j = 0; j < np2+1; j++)
@@ -74,7 +148,7 @@ void SynchrotronTerm::Rebuild(const real_t, const real_t, FVM::UnknownQuantityHa
                     p = mg->GetP1(i);
                     gamma = sqrt(1+p*p);
 
-                    F2(ir, i, j)  += +preFactor * (1-xi0*xi0)*xi0/gamma * BA2_f2[j*np1+i] ;
+                    tableF2[ir][j*np1+i] = +preFactor * (1-xi0*xi0)*xi0/gamma * BA2_f2[j*np1+i] ;
                 }
         } else if (gridtypePPARPPERP) {
             for (len_t j = 0; j < np2; j++)
@@ -83,7 +157,7 @@ void SynchrotronTerm::Rebuild(const real_t, const real_t, FVM::UnknownQuantityHa
                     p     = mg->GetP_f1(i,j);
                     gamma = sqrt(1+p*p);
 
-                    F1(ir, i, j)  += -preFactor * (1-xi0*xi0) *( xi0*p*p*BA1_f1[j*(np1+1)+i] - p*xi0/gamma * BA2_f1[j*(np1+1)+i] ); 
+                    tableF1[ir][j*(np1+1)+i] = -preFactor * (1-xi0*xi0) *( xi0*p*p*BA1_f1[j*(np1+1)+i] - p*xi0/gamma * BA2_f1[j*(np1+1)+i] ); 
                 }
 
             for (len_t j = 0; j < np2+1; j++) 
@@ -92,8 +166,33 @@ void SynchrotronTerm::Rebuild(const real_t, const real_t, FVM::UnknownQuantityHa
                     p     = mg->GetP_f2(i,j);
                     gamma = sqrt(1+p*p);
 
-                    F2(ir, i, j)  += -preFactor * sqrt(1-xi0*xi0) *( (1-xi0*xi0)*p*p*BA1_f2[j*np1+i] + xi0*xi0*p/gamma*BA2_f2[j*np1+i] );
+                    tableF2[ir][j*np1+i] = -preFactor * sqrt(1-xi0*xi0) *( (1-xi0*xi0)*p*p*BA1_f2[j*np1+i] + xi0*xi0*p/gamma*BA2_f2[j*np1+i] );
                 }
         }
     }
+
+    this->tablesValid = true;
+}
+
+/**
+ * Build the coefficients of this advection (or diffusion) term.
+ */
+void SynchrotronTerm::Rebuild(const real_t, const real_t, FVM::UnknownQuantityHandler*){
+    if (!this->tablesValid)
+        BuildTables();
+
+    const len_t nr = grid->GetNr();
+    for (len_t ir = 0; ir < nr; ir++) {
+        auto *mg = grid->GetMomentumGrid(ir);
+        const len_t np1 = mg->GetNp1();
+        const len_t np2 = mg->GetNp2();
+
+        real_t *f1 = this->f1[ir], *f2 = this->f2[ir];
+        const real_t *T1 = this->tableF1[ir], *T2 = this->tableF2[ir];
+
+        for (len_t i = 0; i < (np1+1)*np2; i++)
+            f1[i] += T1[i];
+        for (len_t i = 0; i < np1*(np2+1); i++)
+            f2[i] += T2[i];
+    }
 }
@@ -65,7 +65,7 @@ void ParallelDiffusionFrequency::AssembleQuantity(real_t **&collisionQuantity, l
                     collisionQuantity[ir][pind] = nuSQty[ir][pind] * rescaleFactor(ir,gammaVec[pind]);
                 }
     } else if(collQtySettings->screened_diffusion==OptionConstants::COLLQTY_SCREENED_DIFFUSION_MODE_ZERO){
-        const real_t *partialNuS = nuS->GetUnknownPartialContribution(id_ncold,fluxGridType);
+        const real_t *partialNuS = nuS->GetCollisionGridPartialContribution(id_ncold,fluxGridType);
         const real_t *ncold = unknowns->GetUnknownData(id_ncold);
         len_t offset = 0;
         for(len_t ir=0; ir<nr; ir++){
@@ -295,7 +295,7 @@ const real_t* ParallelDiffusionFrequency::GetUnknownPartialContribution(len_t id
             numZs = nzs;
 
 
-        const real_t *partContribNuS = nuS->GetUnknownPartialContribution(id_unknown,fluxGridType);
+        const real_t *partContribNuS = nuS->GetCollisionGridPartialContribution(id_unknown,fluxGridType);
         for(len_t pind=0; pind<np1*np2; pind++)
             for(len_t ir=0; ir<nr; ir++){
                 real_t rescaleFact =  rescaleFactor(ir,gammaVec[pind]);
@@ -312,7 +312,7 @@ const real_t* ParallelDiffusionFrequency::GetUnknownPartialContribution(len_t id
                     partContrib[ir*np1*np2 + pind] += nuS0[ir][pind] * partRescaleFact;
             }
         }
-        return partContrib;
+        return PackPartialContribution(partContrib, fluxGridType, numZs);
     } 
     else if(id_unknown == unknowns->GetUnknownID(OptionConstants::UQTY_F_HOT)){
         if(!( (fluxGridType==FVM::FLUXGRIDTYPE_P1)&&(np2==1)&&(isPXiGrid) ) ){
@@ -0,0 +1,278 @@
+/**
+ * Implementation of a table of the relativistic Chandrasekhar functions
+ *
+ *   psi_n(p, Theta) = int_0^p gamma(s)^(n-1) exp(-(gamma(s)-1)/Theta) ds,
+ *
+ * for n = 0, 1, 2, which appear in the "full" collision frequencies.
+ * The functions are tabulated in the region between the low-temperature
+ * and superthermal asymptotic expansions (see 'CollisionFrequency'),
+ * where they would otherwise have to be evaluated with adaptive
+ * quadrature every time the collision frequencies are rebuilt.
+ *
+ * The table is built in the coordinates
+ *
+ *   x = sqrt((gamma-1)/Theta),     y = ln(Theta),
+ *
+ * in which G_n = psi_n/sqrt(2*Theta) is a smooth function of order
+ * unity. Since the derivatives of G_n are (almost) known analytically,
+ * we use bicubic Hermite interpolation. The resolution of the table is
+ * increased until the interpolation error, measured against quadrature
+ * in the middle of every table cell, is below 'RELTOL'. Points outside
+ * of the table are evaluated using quadrature.
+ *
+ * The table is independent of the plasma parameters and is therefore
+ * constructed once, the first time it is requested, and then shared
+ * by all collision frequencies.
+ */
+
+#include <cmath>
+#include "DREAM/Equations/PsiFunctionTable.hpp"
+#include "DREAM/IO.hpp"
+
+
+using namespace DREAM;
+
+struct psi_params { len_t n; real_t Theta; };
+
+
+/**
+ * Constructor.
+ */
+PsiFunctionTable::PsiFunctionTable() {
+    this->gsl_ad_w = gsl_integration_workspace_alloc(1000);
+
+    len_t nx = 33, ny = 17;
+    real_t err;
+    while (true) {
+        this->Build(nx, ny);
+
+        err = this->GetMaxMidpointError();
+        if (err <= RELTOL) {
+            this->valid = true;
+            break;
+        } else if (2*nx-1 > MAX_NX || 2*ny-1 > MAX_NY)
+            break;
+
+        nx = 2*nx-1;
+        ny = 2*ny-1;
+    }
+
+    if (!this->valid)
+        DREAM::IO::PrintWarning(
+            "Unable to tabulate the psi functions to a relative accuracy of %e "
+            "(reached %e). Falling back to quadrature.", RELTOL, err
+        );
+}
+
+/**
+ * Destructor.
+ */
+PsiFunctionTable::~PsiFunctionTable() {
+    for (len_t n = 0; n < 3; n++)
+        if (this->table[n] != nullptr)
+            delete [] this->table[n];
+
+    gsl_integration_workspace_free(this->gsl_ad_w);
+}
+
+/**
+ * Returns the (shared) psi function table, constructing
+ * it the first time this method is called.
+ */
+const PsiFunctionTable *PsiFunctionTable::GetInstance() {
+    // Initialization of local statics is thread-safe
+    static PsiFunctionTable instance;
+    return &instance;
+}
+
+/**
+ * Build the table using the given number of points in x and y.
+ */
+void PsiFunctionTable::Build(const len_t nx, const len_t ny) {
+    this->nx = nx;
+    this->ny = ny;
+    this->hx = X_MAX / (nx-1);
+    this->y0 = log(THETA_MIN);
+    this->hy = (log(THETA_MAX) - this->y0) / (ny-1);
+
+    for (len_t n = 0; n < 3; n++) {
+        if (this->table[n] != nullptr)
+            delete [] this->table[n];
+
+        this->table[n] = new real_t[4*nx*ny];
+
+        for (len_t j = 0; j < ny; j++)
+            for (len_t i = 0; i < nx; i++)
+                this->EvaluateNode(n, i*hx, y0+j*hy, this->table[n] + 4*(j*nx+i));
+    }
+}
+
+/**
+ * Evaluate G_n = psi_n/sqrt(2*Theta), as well as its derivatives
+ * dG/dx, dG/dy and d^2G/dxdy, at the given point.
+ *
+ * n:   Index of psi function to evaluate.
+ * x:   Value of x = sqrt((gamma-1)/Theta).
+ * y:   Value of y = ln(Theta).
+ * val: Array of length 4 to store values in.
+ *
+ * RETURNS the value of G_n.
+ */
+real_t PsiFunctionTable::EvaluateNode(
+    const len_t n, const real_t x, const real_t y, real_t *val
+) {
+    const real_t Theta = exp(y);
+    const real_t gammaMinusOne = Theta*x*x;
+    const real_t gamma = 1 + gammaMinusOne;
+    const real_t p = sqrt(gammaMinusOne*(gamma+1));
+    const real_t sqrt2Theta = sqrt(2*Theta);
+    const real_t expX2 = exp(-x*x);
+
+    // phi = gamma^n / sqrt(gamma+1), and its derivative wrt gamma
+    const real_t gn = (n==0 ? 1 : (n==1 ? gamma : gamma*gamma));
+    const real_t dgn = (n==0 ? 0 : (n==1 ? 1 : 2*gamma));
+    const real_t phi = gn / sqrt(gamma+1);
+    const real_t dphi = dgn/sqrt(gamma+1) - 0.5*gn/((gamma+1)*sqrt(gamma+1));
+
+    const real_t G = Integrate(n, p, Theta, false) / sqrt2Theta;
+
+    // d(psi_n)/dTheta at fixed x (with contributions from both the
+    // integrand and the upper integration limit)
+    const real_t dpdTheta = gamma*x / sqrt(Theta*(gammaMinusOne+2));
+    const real_t integrandAtP = gn/gamma * expX2;
+    const real_t dPsidTheta = Integrate(n, p, Theta, true) + integrandAtP*dpdTheta;
+
+    val[0] = G;
+    val[1] = M_SQRT2 * expX2 * phi;
+    val[2] = Theta*dPsidTheta / sqrt2Theta - 0.5*G;
+    val[3] = M_SQRT2 * expX2 * x*x * Theta * dphi;
+
+    return G;
+}
+
+/**
+ * Evaluate psi_n (or its derivative with respect to Theta,
+ * if 'dTheta' is true) using adaptive quadrature.
+ */
+real_t PsiFunctionTable::Integrate(
+    const len_t n, const real_t p, const real_t Theta, bool dTheta
+) {
+    if (p == 0)
+        return 0;
+
+    struct psi_params params = {n, Theta};
+    gsl_function F;
+    F.function = dTheta ? &psiThetaDerivativeIntegrand : &psiIntegrand;
+    F.params = &params;
+
+    real_t v, error;
+    gsl_integration_qag(
+        &F, 0, p, 0, 1e-11, this->gsl_ad_w->limit,
+        GSL_INTEG_GAUSS31, this->gsl_ad_w, &v, &error
+    );
+
+    return v;
+}
+
+real_t PsiFunctionTable::psiIntegrand(real_t s, void *par) {
+    struct psi_params *params = (struct psi_params*)par;
+    real_t gs = sqrt(1+s*s);
+    real_t gsMinusOne = s*s/(1+gs); // = gs - 1
+    real_t w = (params->n==0 ? 1/gs : (params->n==1 ? 1 : gs));
+    return w*exp(-gsMinusOne/params->Theta);
+}
+real_t PsiFunctionTable::psiThetaDerivativeIntegrand(real_t s, void *par) {
+    struct psi_params *params = (struct psi_params*)par;
+    real_t gs = sqrt(1+s*s);
+    real_t gsMinusOne = s*s/(1+gs); // = gs - 1
+    real_t Theta = params->Theta;
+    return psiIntegrand(s, par) * gsMinusOne/(Theta*Theta);
+}
+
+/**
+ * Returns the largest relative interpolation error in the middle
+ * of the table cells (where the error is expected to be largest).
+ * Cells which are only used for p < 0.15 (where the low-energy
+ * expansion is used instead) are skipped.
+ */
+real_t PsiFunctionTable::GetMaxMidpointError() {
+    real_t maxerr = 0;
+    for (len_t j = 0; j+1 < ny; j++)
+        for (len_t i = 0; i+1 < nx; i++) {
+            real_t x = (i+0.5)*hx, y = y0 + (j+0.5)*hy;
+            real_t Theta = exp(y);
+            real_t gammaMinusOne = Theta*x*x;
+            real_t p = sqrt(gammaMinusOne*(gammaMinusOne+2));
+            if (p < 0.15)
+                continue;
+
+            for (len_t n = 0; n < 3; n++) {
+                real_t G = Integrate(n, p, Theta, false) / sqrt(2*Theta);
+                real_t err = fabs(Interpolate(n, x, y) - G) / G;
+                if (err > maxerr)
+                    maxerr = err;
+            }
+        }
+
+    return maxerr;
+}
+
+/**
+ * Evaluate the interpolated value of G_n at the point (x, y).
+ */
+real_t PsiFunctionTable::Interpolate(
+    const len_t n, const real_t x, const real_t y
+) const {
+    len_t i = (len_t)(x/hx), j = (len_t)((y-y0)/hy);
+    if (i > nx-2) i = nx-2;
+    if (j > ny-2) j = ny-2;
+
+    const real_t t = x/hx - i, u = (y-y0)/hy - j;
+
+    // Cubic Hermite basis functions
+    const real_t ht[4] = {
+        (1+2*t)*(1-t)*(1-t), t*(1-t)*(1-t)*hx,
+        t*t*(3-2*t),         t*t*(t-1)*hx
+    };
+    const real_t hu[4] = {
+        (1+2*u)*(1-u)*(1-u), u*(1-u)*(1-u)*hy,
+        u*u*(3-2*u),         u*u*(u-1)*hy
+    };
+
+    real_t v = 0;
+    for (len_t dj = 0; dj < 2; dj++)
+        for (len_t di = 0; di < 2; di++) {
+            const real_t *N = this->table[n] + 4*((j+dj)*nx + i+di);
+            const real_t a0 = ht[2*di], a1 = ht[2*di+1];
+            const real_t b0 = hu[2*dj], b1 = hu[2*dj+1];
+
+            v += a0*b0*N[0] + a1*b0*N[1] + a0*b1*N[2] + a1*b1*N[3];
+        }
+
+    return v;
+}
+
+/**
+ * Returns true if the psi functions at the given momentum
+ * and normalized temperature are covered by the table.
+ */
+bool PsiFunctionTable::IsTabulated(const real_t p, const real_t Theta) const {
+    if (!this->valid || Theta < THETA_MIN || Theta > THETA_MAX)
+        return false;
+
+    real_t gammaMinusOne = p*p/(1+sqrt(1+p*p));
+    return (gammaMinusOne <= X_MAX*X_MAX*Theta);
+}
+
+/**
+ * Evaluate the psi function with index n at the given momentum
+ * and normalized temperature (which must be covered by the table;
+ * see 'IsTabulated()').
+ */
+real_t PsiFunctionTable::Evaluate(const len_t n, const real_t p, const real_t Theta) const {
+    real_t gammaMinusOne = p*p/(1+sqrt(1+p*p));
+    real_t x = sqrt(gammaMinusOne/Theta);
+    real_t y = log(Theta);
+
+    return sqrt(2*Theta) * Interpolate(n, x, y);
+}
@@ -1,5 +1,7 @@
 
+#include <algorithm>
 #include "DREAM/Equations/REPitchDistributionAveragedBACoeff.hpp"
+#include "FVM/Parallel.hpp"
 
 using namespace DREAM;
 
@@ -32,8 +34,45 @@ using namespace DREAM;
  *  3) The final averaged coefficient is obtained ('EvaluateREPitchDistAverage(...)') by 
  *     evaluating the spline from step 2), multiplied by the pitch-independent weight 
  *     function 'BA_MomentumPrefactor'.
+ *
+ * The splines of steps 1) and 2) are generated in parallel over radii.
+ * Since the spline of step 2) is evaluated very frequently (for every
+ * momentum in the Eceff and avalanche calculations), its polynomial
+ * coefficients are precomputed and stored in a flat array, so that an
+ * evaluation only consists of locating the interval and evaluating a 
+ * cubic polynomial.
  */
 
+namespace {
+    /**
+     * GSL objects used for generating the splines of step 2) at one
+     * radius, which cannot be shared between threads (and are
+     * therefore allocated once per thread by 'Parallel::ForWithScratch()').
+     */
+    struct REDistAverageScratch {
+        gsl_integration_workspace *gsl_ad_w;
+        gsl_spline *spline;
+        gsl_interp_accel *acc;
+        real_t *REDistAverageArray;
+
+        REDistAverageScratch(const gsl_interp_type *t, const len_t N) {
+            gsl_ad_w = gsl_integration_workspace_alloc(1000);
+            spline = gsl_spline_alloc(t, N);
+            acc = gsl_interp_accel_alloc();
+            REDistAverageArray = new real_t[N];
+        }
+        ~REDistAverageScratch() {
+            delete [] REDistAverageArray;
+            gsl_interp_accel_free(acc);
+            gsl_spline_free(spline);
+            gsl_integration_workspace_free(gsl_ad_w);
+        }
+
+        REDistAverageScratch(const REDistAverageScratch&) = delete;
+        REDistAverageScratch &operator=(const REDistAverageScratch&) = delete;
+    };
+}
+
 
 REPitchDistributionAveragedBACoeff::REPitchDistributionAveragedBACoeff(
     FVM::RadialGrid *rg, AnalyticDistributionRE *dist,
@@ -44,13 +83,10 @@ REPitchDistributionAveragedBACoeff::REPitchDistributionAveragedBACoeff(
     const gsl_interp_type *t
 ) : rGrid(rg), distRE(dist), BA_Func(func), BA_Func_par(par), BA_Param(list), 
     BA_PitchPrefactor(pitchfunc), BA_MomentumPrefactor(momfunc), interp_mode(t) 
-{
-    gsl_ad_w = gsl_integration_workspace_alloc(1000);
-}
+{}
 
 REPitchDistributionAveragedBACoeff::~ REPitchDistributionAveragedBACoeff(){
     Deallocate();
-    gsl_integration_workspace_free(gsl_ad_w);
 }
 
 bool REPitchDistributionAveragedBACoeff::GridRebuilt(){
@@ -59,14 +95,14 @@ bool REPitchDistributionAveragedBACoeff::GridRebuilt(){
 
     BA_Spline = new gsl_spline*[nr];
     BA_Accel  = new gsl_interp_accel*[nr];
-    for(len_t ir=0; ir<nr; ir++){
+    FVM::Parallel::For(nr, FVM::Parallel::GetNumberOfThreads(), [&](const len_t ir) {
         BA_Accel[ir] = gsl_interp_accel_alloc();
         GenerateBASpline(
             ir, rGrid, rGrid->GetXi0TrappedBoundary(ir),
             N_BA_SPLINE, BA_Func, BA_Func_par, BA_Param,
             BA_Spline[ir], interp_mode
         );
-    }
+    });
     generateREDistAverageSplines();
 
     return true;
@@ -151,23 +187,27 @@ void REPitchDistributionAveragedBACoeff::GenerateNonUniformXArray(
         xArray[N1-1+i] = 1.0 - fracUpperInterval + i*fracUpperInterval/N2;
 }
 
+/**
+ * Generates the splines of the RE pitch distribution averages [[X]]
+ * as a function of X(A) at all radii (in parallel), and stores their
+ * polynomial coefficients.
+ */
 void REPitchDistributionAveragedBACoeff::generateREDistAverageSplines(){
-    real_t 
-        *xArray = new real_t[N_RE_DIST_SPLINE],
-        *REDistAverageArray = new real_t[N_RE_DIST_SPLINE];
+    REDistAverage_X = new real_t[N_RE_DIST_SPLINE];
+    GenerateNonUniformXArray(REDistAverage_X, N_RE_DIST_SPLINE);
 
-    GenerateNonUniformXArray(xArray, N_RE_DIST_SPLINE);
+    REDistAverage_Coeffs = new real_t[4*(N_RE_DIST_SPLINE-1)*nr];
+    FVM::Parallel::ForWithScratch<REDistAverageScratch>(nr, FVM::Parallel::GetNumberOfThreads(), [&](const len_t ir, REDistAverageScratch &s) {
+        gsl_integration_workspace *gsl_ad_w = s.gsl_ad_w;
+        gsl_spline *spline = s.spline;
+        gsl_interp_accel *acc = s.acc;
+        real_t *REDistAverageArray = s.REDistAverageArray;
 
-    REDistAverage_Spline = new gsl_spline*[nr];
-    REDistAverage_Accel  = new gsl_interp_accel*[nr];
-    for(len_t ir=0; ir<nr; ir++){
-        REDistAverage_Accel[ir] = gsl_interp_accel_alloc();
-        REDistAverage_Spline[ir] = gsl_spline_alloc(interp_mode, N_RE_DIST_SPLINE);
         real_t xiT = rGrid->GetXi0TrappedBoundary(ir);
         ParametersForREPitchDistributionIntegral params = 
             {ir, xiT, 0, distRE, BA_Spline[ir], BA_Accel[ir], BA_PitchPrefactor};
         for(len_t i=0; i<N_RE_DIST_SPLINE-1; i++){
-            real_t A = GetAFromX(xArray[i]);
+            real_t A = GetAFromX(REDistAverage_X[i]);
             params.A = A;
             REDistAverageArray[i] = EvaluateREDistBounceIntegral(params, gsl_ad_w) 
                                     / distRE->EvaluateVpREAtA(ir, A);
@@ -179,10 +219,62 @@ void REPitchDistributionAveragedBACoeff::generateREDistAverageSplines(){
         );
         REDistAverageArray[N_RE_DIST_SPLINE-1] = params.PitchFunc(1.0)*BAAtUnityXi; //gsl_spline_eval(params.spline, 1.0, params.acc);
 
-        gsl_spline_init(REDistAverage_Spline[ir], xArray, REDistAverageArray, N_RE_DIST_SPLINE);
+        gsl_spline_init(spline, REDistAverage_X, REDistAverageArray, N_RE_DIST_SPLINE);
+        gsl_interp_accel_reset(acc);
+        SetSplineCoefficients(
+            REDistAverage_X, N_RE_DIST_SPLINE, spline, acc,
+            REDistAverage_Coeffs + 4*(N_RE_DIST_SPLINE-1)*ir
+        );
+    }, interp_mode, N_RE_DIST_SPLINE);
+}
+
+/**
+ * Stores the cubic polynomial coefficients, in each of the N-1 intervals 
+ * of the grid 'x', of the given (initialized) spline. The spline is 
+ * represented by the cubic Hermite polynomial matching the values and
+ * first derivatives of the spline at the end points of each interval,
+ * which is exact for all of the C1-continuous cubic interpolation 
+ * methods of GSL (cspline, akima and steffen).
+ *
+ * coeffs: Array of size 4*(N-1). On return, contains the coefficients
+ *         c[4*i+k] of (x-x[i])^k in the interval [x[i], x[i+1]].
+ */
+void REPitchDistributionAveragedBACoeff::SetSplineCoefficients(
+    const real_t *x, const len_t N, gsl_spline *spline, gsl_interp_accel *acc, real_t *coeffs
+){
+    real_t y0 = gsl_spline_eval(spline, x[0], acc);
+    real_t d0 = gsl_spline_eval_deriv(spline, x[0], acc);
+    for(len_t i=0; i<N-1; i++){
+        real_t h  = x[i+1]-x[i];
+        real_t y1 = gsl_spline_eval(spline, x[i+1], acc);
+        real_t d1 = gsl_spline_eval_deriv(spline, x[i+1], acc);
+        real_t s  = (y1-y0)/h;
+
+        real_t *c = coeffs + 4*i;
+        c[0] = y0;
+        c[1] = d0;
+        c[2] = (3*s - 2*d0 - d1)/h;
+        c[3] = (d0 + d1 - 2*s)/(h*h);
+
+        y0 = y1;
+        d0 = d1;
     }
-    delete [] xArray;
-    delete [] REDistAverageArray;
+}
+
+/**
+ * Returns the index of the interval of the 'REDistAverage_X' grid 
+ * containing X. Values outside the grid are assigned to the first
+ * or last interval.
+ */
+len_t REPitchDistributionAveragedBACoeff::FindREDistAverageInterval(real_t X) const {
+    const real_t *x = REDistAverage_X;
+    len_t k = std::upper_bound(x, x+N_RE_DIST_SPLINE, X) - x;
+    if(k==0)
+        return 0;
+    else if(k >= N_RE_DIST_SPLINE-1)
+        return N_RE_DIST_SPLINE-2;
+    else 
+        return k-1;
 }
 
 /**
@@ -242,7 +334,10 @@ real_t REPitchDistributionAveragedBACoeff::EvaluateREPitchDistAverage(len_t ir,
     real_t preFactor = BA_MomentumPrefactor(ir,p);
     real_t A = (A_in == nullptr) ? distRE->GetAatP(ir,p) : *A_in;
     real_t X = GetXFromA(A);
-    real_t distAverage = gsl_spline_eval(REDistAverage_Spline[ir], X, REDistAverage_Accel[ir]);
+    len_t i = FindREDistAverageInterval(X);
+    const real_t *c = REDistAverage_Coeffs + 4*((N_RE_DIST_SPLINE-1)*ir + i);
+    real_t dX = X - REDistAverage_X[i];
+    real_t distAverage = ((c[3]*dX + c[2])*dX + c[1])*dX + c[0];
     real_t Y = preFactor * distAverage;
     
     /*if(dYdp != nullptr){ TODO: p derivative (if need be)
@@ -268,12 +363,8 @@ void REPitchDistributionAveragedBACoeff::Deallocate(){
         delete [] BA_Spline;
         delete [] BA_Accel;
     }
-    if(REDistAverage_Spline != nullptr){
-        for(len_t ir=0; ir<nr; ir++){
-            gsl_spline_free(REDistAverage_Spline[ir]);
-            gsl_interp_accel_free(REDistAverage_Accel[ir]);
-        }
-        delete [] REDistAverage_Spline;
-        delete [] REDistAverage_Accel;
+    if(REDistAverage_Coeffs != nullptr){
+        delete [] REDistAverage_Coeffs;
+        delete [] REDistAverage_X;
     }
 }
@@ -13,6 +13,7 @@
 #include "DREAM/NotImplementedException.hpp"
 #include "FVM/TimeKeeper.hpp"
 #include <limits>
+#include <vector>
 
 using namespace DREAM;
 
@@ -58,6 +59,7 @@ RunawayFluid::RunawayFluid(
     id_jtot  = this->unknowns->GetUnknownID(OptionConstants::UQTY_J_TOT);
 
     this->gsl_ad_w = gsl_integration_workspace_alloc(1000);
+    this->comptonTable = ComptonRateTable::GetInstance();
     this->fsolve = gsl_root_fsolver_alloc(gsl_root_fsolver_brent);
     this->fmin = gsl_min_fminimizer_alloc(gsl_min_fminimizer_brent);
 
@@ -81,13 +83,6 @@ RunawayFluid::RunawayFluid(
      || dreicer_mode == OptionConstants::EQTERM_DREICER_MODE_NONE)
         this->dreicer_nn = new DreicerNeuralNetwork(this);
 
-    const gsl_interp2d_type *gsl_T = gsl_interp2d_bilinear; 
-    gsl_cond = gsl_interp2d_alloc(gsl_T, conductivityLenT,conductivityLenZ);
-    gsl_xacc = gsl_interp_accel_alloc();
-    gsl_yacc = gsl_interp_accel_alloc();
-
-    gsl_interp2d_init(gsl_cond, conductivityTmc2, conductivityX, conductivityBraams,conductivityLenT,conductivityLenZ);
-
     // Initialize timers
     this->timeKeeper = new FVM::TimeKeeper("RunawayFluid");
     this->timerTot = this->timeKeeper->AddTimer("total", "Total time");
@@ -112,9 +107,6 @@ RunawayFluid::~RunawayFluid(){
     gsl_root_fsolver_free(fsolve);
     gsl_min_fminimizer_free(fmin);
 
-    gsl_interp2d_free(gsl_cond);
-    gsl_interp_accel_free(gsl_xacc);
-    gsl_interp_accel_free(gsl_yacc);
     
     if (dreicer_ConnorHastie != nullptr)
         delete dreicer_ConnorHastie;
@@ -162,7 +154,7 @@ void RunawayFluid::Rebuild(){
     TIME(NuD, nuD->RebuildRadialTerms());
 
     TIME(Derived, CalculateDerivedQuantities());
-    TIME(EcEff, effectiveCriticalFieldObject->CalculateEffectiveCriticalField(Ec_tot, Ec_free,effectiveCriticalField));
+    TIME(EcEff, effectiveCriticalFieldObject->CalculateEffectiveCriticalField(Ec_tot, Ec_free,effectiveCriticalField, Tcold));
     TIME(PCrit, CalculateCriticalMomentum());
     TIME(Growthrates, CalculateGrowthRates());
 
@@ -202,21 +194,12 @@ void RunawayFluid::CalculateDerivedQuantities(){
             tauEERel[ir] = std::numeric_limits<real_t>::infinity();
             tauEETh[ir]  = std::numeric_limits<real_t>::infinity();
         }
-
-        switch(cond_mode) {
-            case OptionConstants::CONDUCTIVITY_MODE_BRAAMS: 
-                electricConductivity[ir] = evaluateBraamsElectricConductivity(ir);
-                break;
-            case OptionConstants::CONDUCTIVITY_MODE_SAUTER_COLLISIONLESS: 
-                electricConductivity[ir] = evaluateSauterElectricConductivity(ir, true);
-                break;
-            case OptionConstants::CONDUCTIVITY_MODE_SAUTER_COLLISIONAL: 
-                electricConductivity[ir] = evaluateSauterElectricConductivity(ir, false);
-                break;
-            default:
-                break; // throw exception?            
-        }
     }
+
+    evaluateElectricConductivity(
+        electricConductivity, dElectricConductivityDTcold, dElectricConductivityDZeff,
+        dElectricConductivityDncold, dElectricConductivityDnfree
+    );
 }
 
 /**
@@ -234,12 +217,17 @@ void RunawayFluid::GridRebuilt(){
 /**
  * Finds the root of the provided gsl_function in the interval x_lower < root < x_upper. 
  * Is used both in the Eceff and pCrit calculations. 
+ *
+ * nIterations: If not 'nullptr', the number of iterations taken
+ *              is added to this counter.
+ *
+ * RETURNS true if the solver converged.
  */
-void RunawayFluid::FindRoot(real_t x_lower, real_t x_upper, real_t *root, gsl_function gsl_func, gsl_root_fsolver *s, real_t epsrel, real_t epsabs){
+bool RunawayFluid::FindRoot(real_t x_lower, real_t x_upper, real_t *root, gsl_function gsl_func, gsl_root_fsolver *s, real_t epsrel, real_t epsabs, len_t *nIterations){
     gsl_root_fsolver_set(s, &gsl_func, x_lower, x_upper); 
-    int status;
-    len_t max_iter = 30;
-    for (len_t iteration = 0; iteration < max_iter; iteration++ ){
+    int status = GSL_CONTINUE;
+    len_t max_iter = 30, iteration;
+    for (iteration = 0; iteration < max_iter; iteration++ ){
         gsl_root_fsolver_iterate (s);
         *root   = gsl_root_fsolver_root (s);
         x_lower = gsl_root_fsolver_x_lower (s);
@@ -248,18 +236,24 @@ void RunawayFluid::FindRoot(real_t x_lower, real_t x_upper, real_t *root, gsl_fu
         if (status == GSL_SUCCESS)
             break;
     }
+
+    if (nIterations != nullptr)
+        *nIterations += (status == GSL_SUCCESS ? iteration+1 : iteration);
+    return (status == GSL_SUCCESS);
 }
 
 /**
  * Finds the root of the provided gsl_function_fdf using the provided
  * derivative-based solver.
  *  root: guess for the solution (and is overwritten by the obtained numerical solution)
+ *
+ * RETURNS true if the solver converged.
  */
-void RunawayFluid::FindRoot_fdf(real_t &root, gsl_function_fdf gsl_func, gsl_root_fdfsolver *s, real_t epsrel, real_t epsabs){
+bool RunawayFluid::FindRoot_fdf(real_t &root, gsl_function_fdf gsl_func, gsl_root_fdfsolver *s, real_t epsrel, real_t epsabs, len_t *nIterations){
     gsl_root_fdfsolver_set (s, &gsl_func, root);
-    int status;
-    len_t max_iter = 30;
-    for (len_t iteration = 0; iteration < max_iter; iteration++ ){
+    int status = GSL_CONTINUE;
+    len_t max_iter = 30, iteration;
+    for (iteration = 0; iteration < max_iter; iteration++ ){
         gsl_root_fdfsolver_iterate (s);
         real_t root_prev = root;
         root    = gsl_root_fdfsolver_root (s);
@@ -267,18 +261,24 @@ void RunawayFluid::FindRoot_fdf(real_t &root, gsl_function_fdf gsl_func, gsl_roo
         if (status == GSL_SUCCESS)
             break;
     }
+
+    if (nIterations != nullptr)
+        *nIterations += (status == GSL_SUCCESS ? iteration+1 : iteration);
+    return (status == GSL_SUCCESS);
 }
 
 /**
  * Finds the root of the provided gsl_function_fdf using the provided
  * derivative-based solver.
  *  root: guess for the solution (and is overwritten by the obtained numerical solution)
+ *
+ * RETURNS true if the solver converged.
  */
-void RunawayFluid::FindRoot_fdf_bounded(real_t x_lower, real_t x_upper, real_t &root, gsl_function_fdf gsl_func, gsl_root_fdfsolver *s, real_t epsrel, real_t epsabs){
+bool RunawayFluid::FindRoot_fdf_bounded(real_t x_lower, real_t x_upper, real_t &root, gsl_function_fdf gsl_func, gsl_root_fdfsolver *s, real_t epsrel, real_t epsabs, len_t *nIterations){
     gsl_root_fdfsolver_set (s, &gsl_func, root);
-    int status;
-    len_t max_iter = 30;
-    for (len_t iteration = 0; iteration < max_iter; iteration++ ){
+    int status = GSL_CONTINUE;
+    len_t max_iter = 30, iteration;
+    for (iteration = 0; iteration < max_iter; iteration++ ){
         gsl_root_fdfsolver_iterate (s);
         real_t root_prev = root;
         root    = gsl_root_fdfsolver_root (s);
@@ -294,6 +294,10 @@ void RunawayFluid::FindRoot_fdf_bounded(real_t x_lower, real_t x_upper, real_t &
         if (status == GSL_SUCCESS)
             break;
     }
+
+    if (nIterations != nullptr)
+        *nIterations += (status == GSL_SUCCESS ? iteration+1 : iteration);
+    return (status == GSL_SUCCESS);
 }
 
 
@@ -334,25 +338,34 @@ void RunawayFluid::CalculateGrowthRates(){
     real_t *n_tot  = unknowns->GetUnknownData(id_ntot); 
     real_t *T_cold = unknowns->GetUnknownData(id_Tcold);
 
+    // Evaluate the Dreicer neural network for all radii at once (points
+    // where it is not applicable are overwritten below)
+    bool useNN = (dreicer_nn != nullptr && (
+        dreicer_mode == OptionConstants::EQTERM_DREICER_MODE_NEURAL_NETWORK ||
+        dreicer_mode == OptionConstants::EQTERM_DREICER_MODE_NONE
+    ));
+    if (useNN)
+        dreicer_nn->RunawayRate(this->nr, E, n_tot, T_cold, dreicerRunawayRate);
+
     for (len_t ir = 0; ir<this->nr; ir++){
         avalancheGrowthRate[ir] = n_tot[ir] * constPreFactor * criticalREMomentumInvSq[ir];
         real_t pc = criticalREMomentum[ir]; 
         tritiumRate[ir] = evaluateTritiumRate(pc);
-        comptonRate[ir] = evaluateComptonRate(pc, compton_photon_flux, gsl_ad_w);
-        DComptonRateDpc[ir] = evaluateDComptonRateDpc(pc,compton_photon_flux, gsl_ad_w);
+        if (comptonTable->IsTabulated(pc))
+            comptonRate[ir] = comptonTable->Evaluate(pc, compton_photon_flux, DComptonRateDpc+ir);
+        else {
+            comptonRate[ir] = evaluateComptonRate(pc, compton_photon_flux, gsl_ad_w);
+            DComptonRateDpc[ir] = evaluateDComptonRateDpc(pc,compton_photon_flux, gsl_ad_w);
+        }
 
         // Dreicer runaway rate
         bool nnapp = false;
         if (dreicer_nn != nullptr)
             nnapp = dreicer_nn->IsApplicable(T_cold[ir]);  // Is neural network applicable?
 
-        // Neural network
-        if (nnapp && (dreicer_mode == OptionConstants::EQTERM_DREICER_MODE_NEURAL_NETWORK
-                   || dreicer_mode == OptionConstants::EQTERM_DREICER_MODE_NONE))
-            dreicerRunawayRate[ir] = dreicer_nn->RunawayRate(ir, E[ir], n_tot[ir], T_cold[ir]);
-
-        // Connor-Hastie formula
-        else {
+        // Connor-Hastie formula (unless using the
+        // neural network, evaluated above)
+        if (!nnapp || !useNN) {
             real_t Zeff = this->ions->GetZeff(ir);
             dreicerRunawayRate[ir] = dreicer_ConnorHastie->RunawayRate(ir, E[ir], n_cold[ir], Zeff);
 
@@ -458,8 +471,10 @@ real_t DComptonDpcIntegrandFunc(real_t Eg, void *par){
 /**
  * Returns the runaway rate due to Compton scattering on gamma rays. The net runaway rate
  * dnRE/dt is obtained after multiplication by the total electron density n_tot.
+ * The integral is evaluated to the relative tolerance 'epsrel'. (In the growth
+ * rates, the tabulated rate is used wherever possible; see 'ComptonRateTable')
  */
-real_t RunawayFluid::evaluateComptonRate(real_t pc, real_t photonFlux, gsl_integration_workspace *gsl_ad_w){
+real_t RunawayFluid::evaluateComptonRate(real_t pc, real_t photonFlux, gsl_integration_workspace *gsl_ad_w, real_t epsrel){
     if(isinf(pc))
         return 0;
     real_t gamma_c = sqrt(1+pc*pc);
@@ -472,7 +487,6 @@ real_t RunawayFluid::evaluateComptonRate(real_t pc, real_t photonFlux, gsl_integ
     real_t Eg_min = (pc + gammacMinusOne) /2;
     real_t valIntegral;
     // qagiu assumes an infinite upper boundary
-    real_t epsrel = 1e-4;
     real_t error;
     gsl_integration_qagiu(&ComptonFunc, Eg_min , 0, epsrel, gsl_ad_w->limit, gsl_ad_w, &valIntegral, &error);
     return valIntegral;
@@ -481,7 +495,7 @@ real_t RunawayFluid::evaluateComptonRate(real_t pc, real_t photonFlux, gsl_integ
 /**
  * Returns the derivative of the runaway rate due to Compton scattering on gamma rays w r t pc (factor n_tot NOT included). 
  */
-real_t RunawayFluid::evaluateDComptonRateDpc(real_t pc,real_t photonFlux, gsl_integration_workspace *gsl_ad_w){
+real_t RunawayFluid::evaluateDComptonRateDpc(real_t pc,real_t photonFlux, gsl_integration_workspace *gsl_ad_w, real_t epsrel){
     if(isinf(pc))
         return 0;
     real_t gamma_c = sqrt(1+pc*pc);
@@ -494,7 +508,6 @@ real_t RunawayFluid::evaluateDComptonRateDpc(real_t pc,real_t photonFlux, gsl_in
     real_t Eg_min = (pc + gammacMinusOne) /2;
     real_t valIntegral;
     // qagiu assumes an infinite upper boundary
-    real_t epsrel = 1e-4;
     real_t error;
     gsl_integration_qagiu(&ComptonFunc, Eg_min , 0, epsrel, gsl_ad_w->limit, gsl_ad_w, &valIntegral, &error);
     return valIntegral;
@@ -538,6 +551,12 @@ real_t RunawayFluid::pStarFunctionAlt(real_t p, void *par){
 /**
  * Calculates pStar with a root finding algorithm for 
  * a given electric field E and radial grid point ir.
+ *
+ * If pStar was obtained in a previous rebuild, the root is
+ * first sought in a narrow interval around the previous solution,
+ * which typically brackets the new root during both Newton
+ * iterations and consecutive time steps. Otherwise, the interval
+ * is estimated from the limits of complete and no screening.
  */
 real_t RunawayFluid::evaluatePStar(len_t ir, real_t E, gsl_function gsl_func, real_t *nuSHat_COMPSCREEN){
     real_t pStar;
@@ -556,11 +575,30 @@ real_t RunawayFluid::evaluatePStar(len_t ir, real_t E, gsl_function gsl_func, re
     pc_COMPLETESCREENING[ir] = sqrt(sqrt(*nuSHat_COMPSCREEN*(nuDHat_COMPSCREEN+4**nuSHat_COMPSCREEN))/E);
     pc_NOSCREENING[ir] = sqrt( sqrt(nuSHat_NOSCREEN*(nuDHat_NOSCREEN+4*nuSHat_NOSCREEN)) /E );
 
-    real_t pLo = pc_COMPLETESCREENING[ir];
-    real_t pUp = pc_NOSCREENING[ir];
-    FindInterval(&pLo,&pUp, gsl_func);
-    FindRoot(pLo,pUp, &pStar, gsl_func,fsolve);
+    this->nPStarSolves++;
+
+    real_t pLo, pUp;
+    bool bracketed = false;
+    if (pStar_PREV[ir] > 0) {
+        pLo = (1-PSTAR_WARMSTART_MARGIN) * pStar_PREV[ir];
+        pUp = (1+PSTAR_WARMSTART_MARGIN) * pStar_PREV[ir];
+        bracketed = (gsl_func.function(pLo, gsl_func.params) > 0)
+                 && (gsl_func.function(pUp, gsl_func.params) < 0);
+
+        if (bracketed)
+            this->nPStarWarmStarts++;
+    }
 
+    if (!bracketed) {
+        pLo = pc_COMPLETESCREENING[ir];
+        pUp = pc_NOSCREENING[ir];
+        FindInterval(&pLo,&pUp, gsl_func);
+    }
+
+    if (!FindRoot(pLo,pUp, &pStar, gsl_func,fsolve, 1e-3, 0, &this->nPStarIterations))
+        this->nPStarNotConverged++;
+
+    pStar_PREV[ir] = pStar;
     return pStar;
 }
 
@@ -660,6 +698,7 @@ void RunawayFluid::AllocateQuantities(){
     criticalREMomentumInvSq = new real_t[nr];
     pc_COMPLETESCREENING    = new real_t[nr];
     pc_NOSCREENING          = new real_t[nr];
+    pStar_PREV              = new real_t[nr];
     avalancheGrowthRate     = new real_t[nr];
     dreicerRunawayRate      = new real_t[nr];
 
@@ -668,6 +707,14 @@ void RunawayFluid::AllocateQuantities(){
     DComptonRateDpc = new real_t[nr];
 
     electricConductivity = new real_t[nr];
+    dElectricConductivityDTcold = new real_t[nr];
+    dElectricConductivityDZeff  = new real_t[nr];
+    dElectricConductivityDncold = new real_t[nr];
+    dElectricConductivityDnfree = new real_t[nr];
+
+    // No previous solutions available for warm-starting
+    for (len_t ir = 0; ir < nr; ir++)
+        pStar_PREV[ir] = 0;
 }
 
 /**
@@ -685,12 +732,72 @@ void RunawayFluid::DeallocateQuantities(){
         delete [] criticalREMomentumInvSq;
         delete [] pc_COMPLETESCREENING;
         delete [] pc_NOSCREENING;
+        delete [] pStar_PREV;
         delete [] avalancheGrowthRate;
         delete [] dreicerRunawayRate;
         delete [] tritiumRate;
         delete [] comptonRate;
         delete [] DComptonRateDpc;
         delete [] electricConductivity;
+        delete [] dElectricConductivityDTcold;
+        delete [] dElectricConductivityDZeff;
+        delete [] dElectricConductivityDncold;
+        delete [] dElectricConductivityDnfree;
+    }
+}
+
+/**
+ * Evaluates the electric conductivity, with the formula selected by
+ * the 'cond_mode' setting, together with its partial derivatives, at
+ * all radii in one call. The derivatives are evaluated analytically
+ * (rather than with finite differences, which would require several
+ * additional evaluations of the conductivity per radius and unknown).
+ * No state is modified by this method, so that it may be called
+ * concurrently.
+ *
+ * sigma:        On return, contains the conductivity at each radius.
+ * dSigmadTcold: On return, contains d(sigma)/d(T_cold) (if not 'nullptr').
+ * dSigmadZeff:  On return, contains d(sigma)/d(Zeff) (if not 'nullptr').
+ * dSigmadncold: On return, contains d(sigma)/d(n_cold) (if not 'nullptr').
+ * dSigmadnfree: On return, contains the derivative of sigma with respect
+ *               to the free electron density (through the Coulomb
+ *               logarithm; if not 'nullptr').
+ */
+void RunawayFluid::evaluateElectricConductivity(
+    real_t *sigma, real_t *dSigmadTcold, real_t *dSigmadZeff,
+    real_t *dSigmadncold, real_t *dSigmadnfree
+) {
+    bool neoclassical, collisionless=false;
+    switch(cond_mode) {
+        case OptionConstants::CONDUCTIVITY_MODE_BRAAMS:
+            neoclassical = false;
+            break;
+        case OptionConstants::CONDUCTIVITY_MODE_SAUTER_COLLISIONLESS:
+            neoclassical = true;
+            collisionless = true;
+            break;
+        case OptionConstants::CONDUCTIVITY_MODE_SAUTER_COLLISIONAL:
+            neoclassical = true;
+            break;
+        default:
+            throw FVM::FVMException("Conductivity: Unrecognized conductivity mode: %d.", cond_mode);
+    }
+
+    for (len_t ir = 0; ir < nr; ir++) {
+        const real_t Zeff = ions->GetZeff(ir);
+
+        real_t dBdT, dBdZ, dBdnfree;
+        const real_t sigmaBraams = evaluateBraamsElectricConductivity(ir, Tcold[ir], Zeff, &dBdT, &dBdZ, &dBdnfree);
+
+        real_t K = 1, dKdT = 0, dKdZ = 0, dKdn = 0;
+        if (neoclassical)
+            K = evaluateNeoclassicalConductivityCorrection(ir, Tcold[ir], Zeff, ncold[ir], collisionless, &dKdT, &dKdZ, &dKdn);
+
+        sigma[ir] = sigmaBraams * K;
+        if (dSigmadTcold != nullptr) dSigmadTcold[ir] = dBdT*K + sigmaBraams*dKdT;
+        if (dSigmadZeff  != nullptr) dSigmadZeff[ir]  = dBdZ*K + sigmaBraams*dKdZ;
+        if (dSigmadncold != nullptr) dSigmadncold[ir] = sigmaBraams*dKdn;
+        if (dSigmadnfree != nullptr) dSigmadnfree[ir] = dBdnfree*K;
     }
 }
 
@@ -707,20 +814,117 @@ real_t RunawayFluid::evaluateSauterElectricConductivity(len_t ir, bool collision
     return evaluateSauterElectricConductivity(ir, Tcold[ir], ions->GetZeff(ir), ncold[ir], collisionless);
 }
 
+/**
+ * Returns the coefficients of the bilinear interpolation of the
+ * normalized Braams-Karney conductivity in every cell of the
+ * (T/mc^2, X) table, stored as a flat array with four coefficients
+ * per cell,
+ *
+ *   sigmaBar = c[0] + c[1]*t + c[2]*u + c[3]*t*u,
+ *
+ * where t and u are the normalized coordinates within the cell and
+ * the coefficients of cell (i,j) begin at index 4*(j*(LenT-1) + i).
+ * The table is constructed the first time it is requested and never
+ * modified afterwards (so that lookups require no shared state).
+ */
+const real_t *RunawayFluid::GetConductivityCoefficients() {
+    // Initialization of local statics is thread-safe
+    static const std::vector<real_t> coeffs = []() {
+        const len_t nT = conductivityLenT, nX = conductivityLenZ;
+        std::vector<real_t> c(4*(nT-1)*(nX-1));
+        for (len_t j = 0; j+1 < nX; j++)
+            for (len_t i = 0; i+1 < nT; i++) {
+                const real_t
+                    z00 = conductivityBraams[j*nT + i],
+                    z10 = conductivityBraams[j*nT + i+1],
+                    z01 = conductivityBraams[(j+1)*nT + i],
+                    z11 = conductivityBraams[(j+1)*nT + i+1];
+
+                real_t *cc = c.data() + 4*(j*(nT-1) + i);
+                cc[0] = z00;
+                cc[1] = z10 - z00;
+                cc[2] = z01 - z00;
+                cc[3] = z11 - z10 - z01 + z00;
+            }
+        return c;
+    }();
+
+    return coeffs.data();
+}
+
+/**
+ * Evaluates the (bilinearly interpolated) normalized Braams-Karney
+ * conductivity and its derivatives with respect to both coordinates.
+ *
+ * Tmc2:    Temperature, normalized to the electron rest energy.
+ * X:       1/(1+Zeff).
+ * dSdTmc2: On return, contains d(sigmaBar)/d(Tmc2) (if not 'nullptr').
+ * dSdX:    On return, contains d(sigmaBar)/d(X) (if not 'nullptr').
+ */
+real_t RunawayFluid::evaluateBraamsConductivityTable(real_t Tmc2, real_t X, real_t *dSdTmc2, real_t *dSdX) {
+    const len_t nT = conductivityLenT, nX = conductivityLenZ;
+    if (Tmc2 < conductivityTmc2[0] || Tmc2 > conductivityTmc2[nT-1] ||
+        X < conductivityX[0] || X > conductivityX[nX-1])
+        throw FVM::FVMException(
+            "Conductivity: (T/mc^2, 1/(1+Zeff)) = (%e, %e) is outside of the Braams-Karney table.",
+            Tmc2, X
+        );
+
+    // Index of the cell (the last point of each axis belongs to the last cell)
+    len_t i = std::upper_bound(conductivityTmc2, conductivityTmc2+nT, Tmc2) - conductivityTmc2;
+    len_t j = std::upper_bound(conductivityX, conductivityX+nX, X) - conductivityX;
+    i = std::min(i, nT-1) - 1;
+    j = std::min(j, nX-1) - 1;
+
+    const real_t hT = conductivityTmc2[i+1] - conductivityTmc2[i];
+    const real_t hX = conductivityX[j+1] - conductivityX[j];
+    const real_t t = (Tmc2 - conductivityTmc2[i]) / hT;
+    const real_t u = (X - conductivityX[j]) / hX;
+
+    const real_t *c = GetConductivityCoefficients() + 4*(j*(nT-1) + i);
+    if (dSdTmc2 != nullptr) *dSdTmc2 = (c[1] + c[3]*u) / hT;
+    if (dSdX != nullptr)    *dSdX    = (c[2] + c[3]*t) / hX;
+
+    return c[0] + c[1]*t + c[2]*u + c[3]*t*u;
+}
+
 /**
  * Returns the Braams-Karney electric conductivity of a relativistic plasma.
+ *
+ * dSigmadTcold: On return, contains d(sigma)/d(Tcold) (if not 'nullptr').
+ * dSigmadZeff:  On return, contains d(sigma)/d(Zeff) (if not 'nullptr').
+ * dSigmadnfree: On return, contains the derivative of sigma with respect
+ *               to the free electron density, entering through the
+ *               thermal Coulomb logarithm (if not 'nullptr').
  */
-real_t RunawayFluid::evaluateBraamsElectricConductivity(len_t ir, real_t Tcold, real_t Zeff){
+real_t RunawayFluid::evaluateBraamsElectricConductivity(
+    len_t ir, real_t Tcold, real_t Zeff,
+    real_t *dSigmadTcold, real_t *dSigmadZeff, real_t *dSigmadnfree
+){
     if(Zeff<0)
         throw FVM::FVMException("Conductivity: Negative Zeff provided, aborting.");
     const real_t T_SI = Tcold * Constants::ec;
+    const real_t mc2 = Constants::me * Constants::c * Constants::c;
+    const real_t X = 1.0/(1+Zeff);
 
-    real_t sigmaBar = gsl_interp2d_eval(gsl_cond, conductivityTmc2, conductivityX, conductivityBraams, 
-                T_SI / (Constants::me * Constants::c * Constants::c), 1.0/(1+Zeff), gsl_xacc, gsl_yacc  );
+    real_t dSdTmc2, dSdX;
+    real_t sigmaBar = evaluateBraamsConductivityTable(T_SI / mc2, X, &dSdTmc2, &dSdX);
     
     real_t nfree = ions->GetFreeElectronDensityFromQuasiNeutrality(ir);
-    real_t BraamsConductivity = 4*M_PI*Constants::eps0*Constants::eps0 * T_SI*sqrt(T_SI) / 
-            (Zeff * sqrt(Constants::me) * Constants::ec * Constants::ec * lnLambdaEE->evaluateLnLambdaT(Tcold,nfree)) * sigmaBar;
+    real_t lnLT = lnLambdaEE->evaluateLnLambdaT(Tcold,nfree);
+    real_t preFactor = 4*M_PI*Constants::eps0*Constants::eps0 * T_SI*sqrt(T_SI) / 
+            (Zeff * sqrt(Constants::me) * Constants::ec * Constants::ec * lnLT);
+    real_t BraamsConductivity = preFactor * sigmaBar;
+
+    // (with d(lnLambda_T)/dT = 1/T and d(lnLambda_T)/dnfree = -1/(2*nfree))
+    if (dSigmadTcold != nullptr)
+        *dSigmadTcold = BraamsConductivity * (1.5 - 1/lnLT)/Tcold
+            + preFactor * dSdTmc2 * Constants::ec / mc2;
+    if (dSigmadZeff != nullptr)
+        *dSigmadZeff = -BraamsConductivity/Zeff - preFactor * dSdX * X*X;
+    if (dSigmadnfree != nullptr)
+        *dSigmadnfree = (nfree > 0 ? 0.5*BraamsConductivity/(nfree*lnLT) : 0);
+
     return BraamsConductivity;
 }
 real_t RunawayFluid::evaluateBraamsElectricConductivity(len_t ir){
@@ -733,11 +937,22 @@ real_t RunawayFluid::evaluateBraamsElectricConductivity(len_t ir){
  * which generalizes the original
  *  study by
  *  O Sauter, C Angioni and Y R Lin-Liu, Phys Plasmas 6, 2834 (1999).
+ *
+ * dKdTcold: On return, contains the derivative of the correction with
+ *           respect to Tcold (if not 'nullptr').
+ * dKdZeff:  On return, contains the derivative of the correction with
+ *           respect to Zeff (if not 'nullptr').
+ * dKdncold: On return, contains the derivative of the correction with
+ *           respect to ncold (if not 'nullptr').
  */
-real_t RunawayFluid::evaluateNeoclassicalConductivityCorrection(len_t ir, real_t Tcold, real_t Zeff, real_t ncold, bool collisionLess){
+real_t RunawayFluid::evaluateNeoclassicalConductivityCorrection(
+    len_t ir, real_t Tcold, real_t Zeff, real_t ncold, bool collisionLess,
+    real_t *dKdTcold, real_t *dKdZeff, real_t *dKdncold
+){
     real_t ft = 1 - rGrid->GetEffPassFrac(ir);
     
     real_t X = ft;
+    real_t dXdT = 0, dXdZ = 0, dXdn = 0;
     const real_t R0 = rGrid->GetR0();
     if(isinf(R0))
         X = 0;
@@ -751,9 +966,34 @@ real_t RunawayFluid::evaluateNeoclassicalConductivityCorrection(len_t ir, real_t
         real_t nuEStar = 6.921e-18*ncold*lnLee*Zeff * qR0/(eps*sqrt(eps) * Tcold*Tcold);
 
         // SAUTER MODEL: X /= 1 + (0.55-0.1*ft)*sqrt(nuEStar) + 0.45*(1-ft)*nuEStar/(Zeff*sqrt(Zeff)) ;
-        X /= 1 + 0.25*(1.0 - 0.7*ft)*sqrt(nuEStar)*(1+0.45*sqrt(Zeff-1)) 
-            + 0.61*(1.0 - 0.41*ft) * nuEStar/sqrt(Zeff);
+        const real_t a = 0.25*(1.0 - 0.7*ft), b = 0.61*(1.0 - 0.41*ft);
+        const real_t sqrtNu = sqrt(nuEStar), sqrtZm1 = sqrt(Zeff-1);
+        const real_t D = 1 + a*sqrtNu*(1+0.45*sqrtZm1) + b*nuEStar/sqrt(Zeff);
+        X /= D;
+
+        // Derivatives of D with respect to nuEStar and (explicitly) Zeff
+        // (the dependence on sqrt(Zeff-1) is singular at Zeff = 1, where
+        // it is dropped)
+        const real_t dDdnu = (sqrtNu > 0 ? 0.5*a*(1+0.45*sqrtZm1)/sqrtNu : 0) + b/sqrt(Zeff);
+        real_t dDdZ = -0.5*b*nuEStar/(Zeff*sqrt(Zeff));
+        if (Zeff > 1)
+            dDdZ += 0.225*a*sqrtNu/sqrtZm1;
+
+        const real_t dnudT = nuEStar * (1/lnLee - 2) / Tcold;
+        const real_t dnudn = (ncold > 0 ? nuEStar * (1 - 0.5/lnLee) / ncold : 0);
+        const real_t dnudZ = nuEStar / Zeff;
+
+        dXdT = -X/D * dDdnu*dnudT;
+        dXdn = -X/D * dDdnu*dnudn;
+        dXdZ = -X/D * (dDdnu*dnudZ + dDdZ);
     }
+
+    const real_t dKdX = -(1 + 0.21/Zeff) + X*(1.08 - 0.99*X)/Zeff;
+    if (dKdTcold != nullptr) *dKdTcold = dKdX*dXdT;
+    if (dKdncold != nullptr) *dKdncold = dKdX*dXdn;
+    if (dKdZeff != nullptr)
+        *dKdZeff = dKdX*dXdZ + (0.21*X - X*X*(0.54-0.33*X))/(Zeff*Zeff);
+
     // SAUTER MODEL: return 1 - (1+0.36/Zeff)*X + X*X/Zeff * (0.59-0.23*X);
     return 1 - (1 + 0.21/Zeff)*X + X*X/Zeff * (0.54-0.33*X);
 }
@@ -764,80 +1004,58 @@ real_t RunawayFluid::evaluateNeoclassicalConductivityCorrection(len_t ir, bool c
 
 /**
  * Returns the partial derivative of the conductivity with respect to unknown derivId,
- * choosing conductivity formula based on cond_mode setting
+ * using the derivatives evaluated together with the conductivity (with the
+ * formula selected by the cond_mode setting).
  */
 real_t RunawayFluid::evaluatePartialContributionConductivity(len_t ir, len_t derivId, len_t n){
-    switch(cond_mode) {
-        case OptionConstants::CONDUCTIVITY_MODE_BRAAMS: 
-            return evaluatePartialContributionBraamsConductivity(ir, derivId, n);
-            break;
-        case OptionConstants::CONDUCTIVITY_MODE_SAUTER_COLLISIONLESS: 
-            return evaluatePartialContributionSauterConductivity(ir, derivId, n, true);
-            break;
-        case OptionConstants::CONDUCTIVITY_MODE_SAUTER_COLLISIONAL: 
-            return evaluatePartialContributionSauterConductivity(ir, derivId, n, false);
-            break;
-        default:
-            return std::numeric_limits<real_t>::infinity();
-            break; // throw exception?            
-    }
+    return partialContributionConductivity(
+        ir, derivId, n, dElectricConductivityDTcold[ir], dElectricConductivityDZeff[ir],
+        dElectricConductivityDncold[ir], dElectricConductivityDnfree[ir]
+    );
 }
 
 /**
- * Calculation of the partial derivative of Sauter conductivity
- */  
-real_t RunawayFluid::evaluatePartialContributionSauterConductivity(len_t ir, len_t derivId, len_t n, bool collisionless) {
-    real_t eps = std::numeric_limits<real_t>::epsilon();
-    real_t Zeff = ions->GetZeff(ir);
-    if(derivId==id_Tcold){
-        real_t h = Tcold[ir]*sqrt(eps);
-        return ( evaluateSauterElectricConductivity(ir,Tcold[ir]+h,Zeff,ncold[ir],collisionless)
-               - evaluateSauterElectricConductivity(ir,Tcold[ir]-h,Zeff,ncold[ir],collisionless) ) / (2*h);
-    } else if (derivId==id_ncold) {
-        real_t h = ncold[ir]*sqrt(eps);
-        return ( evaluateSauterElectricConductivity(ir,Tcold[ir],Zeff,ncold[ir]+h,collisionless)
-               - evaluateSauterElectricConductivity(ir,Tcold[ir],Zeff,ncold[ir]-h,collisionless) ) / (2*h);
-    } else if (derivId==id_ni){
-        // using dZeff/dni = Z0^2/nfree - Z0*<Z0^2>/nfree^2
-        len_t iz,Z0;
-        ions->GetIonIndices(n,iz,Z0);
-        real_t nfree = ions->GetFreeElectronDensityFromQuasiNeutrality(ir);
-        if(nfree==0)
-            return 0;
-        real_t nZ0Z0 = ions->GetNZ0Z0(ir);
-        real_t h = 1e-6*Zeff;
-        real_t sigma = evaluateSauterElectricConductivity(ir,Tcold[ir],Zeff+h,ncold[ir],collisionless);
-        real_t dsigma = Z0/nfree * (Z0 - nZ0Z0/nfree) * ( -sigma
-            + evaluateSauterElectricConductivity(ir,Tcold[ir],Zeff+h,ncold[ir],collisionless) ) / h;
-        real_t lnLT = lnLambdaEE->evaluateLnLambdaT(Tcold[ir],nfree);
-        dsigma -= sigma/lnLT *  Z0/nfree; // d/dni lnLambda
-        return dsigma;
-    } else 
-        return 0;
+ * Returns the partial derivative of the Sauter conductivity (regardless of
+ * the cond_mode setting) with respect to unknown derivId, evaluated with
+ * the analytic derivatives of the Braams conductivity and the neoclassical
+ * correction.
+ */
+real_t RunawayFluid::evaluatePartialContributionSauterConductivity(len_t ir, len_t derivId, len_t n, bool collisionless){
+    const real_t Zeff = ions->GetZeff(ir);
+
+    real_t dBdT, dBdZ, dBdnfree, dKdT, dKdZ, dKdn;
+    const real_t sigmaBraams = evaluateBraamsElectricConductivity(ir, Tcold[ir], Zeff, &dBdT, &dBdZ, &dBdnfree);
+    const real_t K = evaluateNeoclassicalConductivityCorrection(ir, Tcold[ir], Zeff, ncold[ir], collisionless, &dKdT, &dKdZ, &dKdn);
+
+    return partialContributionConductivity(
+        ir, derivId, n, dBdT*K + sigmaBraams*dKdT, dBdZ*K + sigmaBraams*dKdZ,
+        sigmaBraams*dKdn, dBdnfree*K
+    );
 }
 
 /**
- * Calculation of the partial derivative of Sauter conductivity
- */  
-real_t RunawayFluid::evaluatePartialContributionBraamsConductivity(len_t ir, len_t derivId, len_t n) {
-    real_t eps = std::numeric_limits<real_t>::epsilon();
-    real_t Zeff = ions->GetZeff(ir);
-    if(derivId==id_Tcold){
-        real_t h = Tcold[ir]*sqrt(eps);
-        return ( evaluateBraamsElectricConductivity(ir,Tcold[ir]+h,Zeff)
-               - evaluateBraamsElectricConductivity(ir,Tcold[ir]-h,Zeff) ) / (2*h);
-    } else if (derivId==id_ni){
-        // using dZeff/dni = Z0^2/nfree - Z0*<Z0^2>/nfree^2
+ * Returns the partial derivative of a conductivity with respect to unknown
+ * derivId, given its derivatives with respect to T_cold, Zeff, n_cold and
+ * the free electron density.
+ */
+real_t RunawayFluid::partialContributionConductivity(
+    len_t ir, len_t derivId, len_t n, real_t dSigmadTcold,
+    real_t dSigmadZeff, real_t dSigmadncold, real_t dSigmadnfree
+){
+    if(derivId==id_Tcold)
+        return dSigmadTcold;
+    else if (derivId==id_ncold)
+        return dSigmadncold;
+    else if (derivId==id_ni){
+        // using dZeff/dni = Z0^2/nfree - Z0*<Z0^2>/nfree^2 and dnfree/dni = Z0
         len_t iz,Z0;
         ions->GetIonIndices(n,iz,Z0);
         real_t nfree = ions->GetFreeElectronDensityFromQuasiNeutrality(ir);
         if(nfree==0)
             return 0;
         real_t nZ0Z0 = ions->GetNZ0Z0(ir);
-        real_t h = 1e-6*Zeff;
-        return Z0/nfree * (Z0 - nZ0Z0/nfree) * 
-            ( evaluateBraamsElectricConductivity(ir,Tcold[ir],Zeff+h)
-            - evaluateBraamsElectricConductivity(ir,Tcold[ir],Zeff-h) ) / (2*h);
+        return Z0/nfree * (Z0 - nZ0Z0/nfree) * dSigmadZeff
+            + Z0 * dSigmadnfree;
     } else 
         return 0;
 }
@@ -903,11 +1121,28 @@ void RunawayFluid::evaluatePartialContributionComptonGrowthRate(real_t *dGamma,
             dGamma[ir] = 0;
 }
 
+/**
+ * Set a table of precomputed values of the effective critical
+ * field, to use instead of the numerical calculation of Eceff
+ * wherever possible (see 'EceffTable').
+ */
+void RunawayFluid::SetEceffTable(EceffTable *t) {
+    this->effectiveCriticalFieldObject->SetTable(t);
+}
+
 /**
  * Printing timing information for this object.
  */
 void RunawayFluid::PrintTimings() {
     this->timeKeeper->PrintTimings(true, timerTot);
+
+    DREAM::IO::PrintInfo(
+        "  pStar root finding:  %6llu solves (%llu warm-started), %.2f iterations/solve, %llu not converged",
+        (unsigned long long)nPStarSolves, (unsigned long long)nPStarWarmStarts,
+        (nPStarSolves>0 ? ((real_t)nPStarIterations)/nPStarSolves : 0.0),
+        (unsigned long long)nPStarNotConverged
+    );
+    this->effectiveCriticalFieldObject->PrintRootFindingStatistics();
 }
 
 /**
@@ -4,6 +4,7 @@
 #include <iostream>
 #include <iomanip>
 #include <cmath>
+#include <algorithm>
 #include "DREAM/Equations/SPIHandler.hpp"
 
 using namespace DREAM;
@@ -178,6 +179,14 @@ void SPIHandler::AllocateQuantities(){
     thetaCoordPNext = new real_t[nShard];
     phiCoordPNext = new real_t[nShard];
     irp = new len_t[nShard];
+    xpCoordsPrevious = new real_t[3*nShard];
+    xpCoordsNext = new real_t[3*nShard];
+    lengthScaleCoordsPrevious = new real_t[nShard];
+    lengthScaleCoordsNext = new real_t[nShard];
+    depositionIrMin = new len_t[nShard];
+    depositionIrMax = new len_t[nShard];
+    heatAbsorbtionIrMin = new len_t[nShard];
+    heatAbsorbtionIrMax = new len_t[nShard];
     gradRCartesian = new real_t[3];
     gradRCartesianPrevious = new real_t[3];
     qtot = new real_t[nr];
@@ -187,6 +196,21 @@ void SPIHandler::AllocateQuantities(){
     pelletDensity = new real_t[nShard];
     lambda = new real_t[nShard];
     NGSConstantFactor = new real_t[nShard];
+
+    // No coordinates have been calculated yet (marked by a negative length scale),
+    // and all deposition and heat absorbtion profiles are empty
+    for(len_t ip=0;ip<nShard;ip++){
+        rCoordPPrevious[ip]=0;
+        rCoordPNext[ip]=0;
+        lengthScaleCoordsPrevious[ip]=-1;
+        lengthScaleCoordsNext[ip]=-1;
+        depositionIrMin[ip]=depositionIrMax[ip]=0;
+        heatAbsorbtionIrMin[ip]=heatAbsorbtionIrMax[ip]=0;
+    }
+    for(len_t i=0;i<nr*nShard;i++){
+        depositionProfilesAllShards[i]=0;
+        heatAbsorbtionProfilesAllShards[i]=0;
+    }
 }
 
 /**
@@ -206,6 +230,14 @@ void SPIHandler::DeallocateQuantities(){
     delete [] thetaCoordPNext;
     delete [] phiCoordPNext;
     delete [] irp;
+    delete [] xpCoordsPrevious;
+    delete [] xpCoordsNext;
+    delete [] lengthScaleCoordsPrevious;
+    delete [] lengthScaleCoordsNext;
+    delete [] depositionIrMin;
+    delete [] depositionIrMax;
+    delete [] heatAbsorbtionIrMin;
+    delete [] heatAbsorbtionIrMax;
     delete [] gradRCartesian;
     delete [] gradRCartesianPrevious;
     delete [] qtot;
@@ -268,16 +300,14 @@ void SPIHandler::Rebuild(real_t dt){
             if(distP<1e-20)
             	distP=0.01;
             	
-            rGrid->GetRThetaPhiFromCartesian(&rCoordPPrevious[ip], &thetaCoordPPrevious[ip], &phiCoordPPrevious[ip], xpPrevious[3*ip], xpPrevious[3*ip+1], xpPrevious[3*ip+2], distP, rCoordPPrevious[ip]);
-            rGrid->GetRThetaPhiFromCartesian(&rCoordPNext[ip], &thetaCoordPNext[ip], &phiCoordPNext[ip], xp[3*ip], xp[3*ip+1], xp[3*ip+2], distP, rCoordPPrevious[ip]);
+            UpdateShardCoordinates(ip, distP);
         }
     }else if(spi_velocity_mode==OptionConstants::EQTERM_SPI_VELOCITY_MODE_NONE){
         for(len_t ip=0;ip<nShard;ip++){
         	// If the shards do not move, we can not use the distance 
         	// the shards travel in one time step as a length scale to set the tolerance.
         	// Here we use a hardcoded length scale of 1 cm
-            rGrid->GetRThetaPhiFromCartesian(&rCoordPPrevious[ip], &thetaCoordPPrevious[ip], &phiCoordPPrevious[ip], xpPrevious[3*ip], xpPrevious[3*ip+1], xpPrevious[3*ip+2], 0.01, rCoordPPrevious[ip]);
-            rGrid->GetRThetaPhiFromCartesian(&rCoordPNext[ip], &thetaCoordPNext[ip], &phiCoordPNext[ip], xp[3*ip], xp[3*ip+1], xp[3*ip+2], 0.01, rCoordPPrevious[ip]);
+            UpdateShardCoordinates(ip, 0.01);
         }
     }else {throw DREAMException("SPIHandler: unrecognized SPI shard velocity mode");}
     
@@ -316,25 +346,14 @@ void SPIHandler::Rebuild(real_t dt){
 
     // Calculate deposition (if any)
     if(spi_deposition_mode==OptionConstants::EQTERM_SPI_DEPOSITION_MODE_LOCAL){
-        CalculateTimeAveragedDeltaSourceLocal(depositionProfilesAllShards);
+        CalculateTimeAveragedDeltaSourceLocal(depositionProfilesAllShards, depositionIrMin, depositionIrMax);
 
     }else if(spi_deposition_mode==OptionConstants::EQTERM_SPI_DEPOSITION_MODE_LOCAL_LAST_FLUX_TUBE){
-        CalculateTimeAveragedDeltaSourceLocal(depositionProfilesAllShards);
+        CalculateTimeAveragedDeltaSourceLocal(depositionProfilesAllShards, depositionIrMin, depositionIrMax);
+        ShiftDepositionProfilesLastFluxTube();
 
-        // Shift the deposition profile to the last grid cell (before the current one) to avoid "self-dilution"
-        for(len_t ip=0;ip<nShard;ip++){
-            if(rCoordPNext[ip]>rCoordPPrevious[ip]){
-                for(len_t ir=0;ir<nr-1;ir++){
-                    depositionProfilesAllShards[ir*nShard+ip]=rGrid->GetVpVol(ir+1)/rGrid->GetVpVol(ir)*depositionProfilesAllShards[(ir+1)*nShard+ip];
-                }
-            }else if(rCoordPNext[ip]<rCoordPPrevious[ip]){
-                for(len_t ir=nr-1;ir>0;ir--){
-                    depositionProfilesAllShards[ir*nShard+ip]=rGrid->GetVpVol(ir-1)/rGrid->GetVpVol(ir)*depositionProfilesAllShards[(ir-1)*nShard+ip];
-                }
-            }
-        }
     }else if(spi_deposition_mode==OptionConstants::EQTERM_SPI_DEPOSITION_MODE_LOCAL_GAUSSIAN){
-        CalculateGaussianSourceLocal(depositionProfilesAllShards);
+        CalculateGaussianSourceLocal(depositionProfilesAllShards, depositionIrMin, depositionIrMax);
 
     }else if(spi_deposition_mode==OptionConstants::EQTERM_SPI_DEPOSITION_MODE_NEGLECT){
         for(len_t ir=0;ir<nr;ir++)
@@ -343,11 +362,11 @@ void SPIHandler::Rebuild(real_t dt){
 
     // Calculate heat absorbtion
     if(spi_heat_absorbtion_mode==OptionConstants::EQTERM_SPI_HEAT_ABSORBTION_MODE_LOCAL_FLUID_NGS){
-        CalculateTimeAveragedDeltaSourceLocal(heatAbsorbtionProfilesAllShards);
+        CalculateTimeAveragedDeltaSourceLocal(heatAbsorbtionProfilesAllShards, heatAbsorbtionIrMin, heatAbsorbtionIrMax);
         CalculateAdiabaticHeatAbsorbtionRateMaxwellian();
 
     }else if(spi_heat_absorbtion_mode==OptionConstants::EQTERM_SPI_HEAT_ABSORBTION_MODE_LOCAL_FLUID_NGS_GAUSSIAN){
-        CalculateGaussianSourceLocal(heatAbsorbtionProfilesAllShards);
+        CalculateGaussianSourceLocal(heatAbsorbtionProfilesAllShards, heatAbsorbtionIrMin, heatAbsorbtionIrMax);
         CalculateAdiabaticHeatAbsorbtionRateMaxwellian();
 
     }else if(spi_heat_absorbtion_mode==OptionConstants::EQTERM_SPI_HEAT_ABSORBTION_MODE_NEGLECT){
@@ -356,6 +375,73 @@ void SPIHandler::Rebuild(real_t dt){
     }else {throw DREAMException("SPIHandler: unrecognized SPI heat absorbtion mode");}
 }
 
+/**
+ * Update the flux surface coordinates of shard 'ip' at the beginning
+ * (xpPrevious) and end (xp) of the time step. The numerical coordinate
+ * inversion is only carried out for positions which have not been
+ * transformed before with a tolerance at least as strict as required
+ * now: during the iterations of a time step xpPrevious does not change,
+ * and at the start of a new time step xpPrevious is usually the position
+ * for which the coordinates at the end of the last time step were found.
+ *
+ * lengthScale: length scale used to set the tolerance of the transformation
+ */
+void SPIHandler::UpdateShardCoordinates(len_t ip, real_t lengthScale){
+    auto isCached = [ip,lengthScale](const real_t *x, const real_t *xCached, const real_t lengthScaleCached){
+        return (lengthScaleCached>0 && lengthScaleCached<=lengthScale &&
+            x[3*ip]==xCached[3*ip] && x[3*ip+1]==xCached[3*ip+1] && x[3*ip+2]==xCached[3*ip+2]);
+    };
+
+    if(!isCached(xpPrevious, xpCoordsPrevious, lengthScaleCoordsPrevious[ip])){
+        if(isCached(xpPrevious, xpCoordsNext, lengthScaleCoordsNext[ip])){
+            rCoordPPrevious[ip]=rCoordPNext[ip];
+            thetaCoordPPrevious[ip]=thetaCoordPNext[ip];
+            phiCoordPPrevious[ip]=phiCoordPNext[ip];
+            lengthScaleCoordsPrevious[ip]=lengthScaleCoordsNext[ip];
+        }else{
+            rGrid->GetRThetaPhiFromCartesian(&rCoordPPrevious[ip], &thetaCoordPPrevious[ip], &phiCoordPPrevious[ip], xpPrevious[3*ip], xpPrevious[3*ip+1], xpPrevious[3*ip+2], lengthScale, rCoordPPrevious[ip]);
+            lengthScaleCoordsPrevious[ip]=lengthScale;
+        }
+        for(len_t i=0;i<3;i++)
+            xpCoordsPrevious[3*ip+i]=xpPrevious[3*ip+i];
+    }
+
+    if(!isCached(xp, xpCoordsNext, lengthScaleCoordsNext[ip])){
+        rGrid->GetRThetaPhiFromCartesian(&rCoordPNext[ip], &thetaCoordPNext[ip], &phiCoordPNext[ip], xp[3*ip], xp[3*ip+1], xp[3*ip+2], lengthScale, rCoordPPrevious[ip]);
+        lengthScaleCoordsNext[ip]=lengthScale;
+        for(len_t i=0;i<3;i++)
+            xpCoordsNext[3*ip+i]=xp[3*ip+i];
+    }
+}
+
+/**
+ * Shift the deposition profile of each shard to the last grid cell
+ * (before the current one) to avoid "self-dilution".
+ */
+void SPIHandler::ShiftDepositionProfilesLastFluxTube(){
+    for(len_t ip=0;ip<nShard;ip++){
+        len_t irMin=depositionIrMin[ip], irMax=depositionIrMax[ip];
+        if(irMin>=irMax)
+            continue;
+
+        // The profile in the outermost (innermost) cell is kept when shifting
+        // inwards (outwards), as in a shift over the full radial grid
+        if(rCoordPNext[ip]>rCoordPPrevious[ip]){
+            len_t irStart = (irMin>0) ? irMin-1 : 0;
+            for(len_t ir=irStart;ir<min(irMax,nr-1);ir++){
+                depositionProfilesAllShards[ir*nShard+ip]=rGrid->GetVpVol(ir+1)/rGrid->GetVpVol(ir)*depositionProfilesAllShards[(ir+1)*nShard+ip];
+            }
+            depositionIrMin[ip]=irStart;
+        }else if(rCoordPNext[ip]<rCoordPPrevious[ip]){
+            len_t irEnd = min(irMax+1,nr);
+            for(len_t ir=irEnd-1;ir>max(irMin,(len_t)1)-1;ir--){
+                depositionProfilesAllShards[ir*nShard+ip]=rGrid->GetVpVol(ir-1)/rGrid->GetVpVol(ir)*depositionProfilesAllShards[(ir-1)*nShard+ip];
+            }
+            depositionIrMax[ip]=irEnd;
+        }
+    }
+}
+
 /**
  * Deposition rate according to NGS formula from Parks TSDW presentation 2017
  */
@@ -399,12 +485,15 @@ real_t SPIHandler::CalculateBFieldDampingJOREK(len_t ir){
  * Calculate deposition corresponding to the ablation, with a density conserving discretisation
  */
 real_t *SPIHandler::CalculateDepositionRate(real_t *SPIMolarFraction){
-    for(len_t ir=0;ir<nr;ir++){
+    for(len_t ir=0;ir<nr;ir++)
         depositionRate[ir]=0;
-        for(len_t ip=0;ip<nShard;ip++){
-            if(YpPrevious[ip]>0 && irp[ip]<nr){
-                depositionRate[ir]+=-SPIMolarFraction[ip]*4.0*M_PI*(Yp[ip]/abs(Yp[ip])*pow(abs(Yp[ip]),9.0/5.0)-pow(YpPrevious[ip],9.0/5.0))/3.0/pelletMolarVolume[ip]*Constants::N_Avogadro/dt*depositionProfilesAllShards[ir*nShard+ip];
-            }
+
+    // Only the radial cells covered by the deposition profile of each shard are visited
+    for(len_t ip=0;ip<nShard;ip++){
+        if(YpPrevious[ip]>0 && irp[ip]<nr){
+            real_t prefactor = -SPIMolarFraction[ip]*4.0*M_PI*(Yp[ip]/abs(Yp[ip])*pow(abs(Yp[ip]),9.0/5.0)-pow(YpPrevious[ip],9.0/5.0))/3.0/pelletMolarVolume[ip]*Constants::N_Avogadro/dt;
+            for(len_t ir=depositionIrMin[ip];ir<depositionIrMax[ip];ir++)
+                depositionRate[ir]+=prefactor*depositionProfilesAllShards[ir*nShard+ip];
         }
     }
     return depositionRate;
@@ -414,12 +503,17 @@ real_t *SPIHandler::CalculateDepositionRate(real_t *SPIMolarFraction){
  * Calculate the total heat flux going into the pellet cloud assuming Maxwellian distribution for the insident electrons
  */
 void SPIHandler::CalculateAdiabaticHeatAbsorbtionRateMaxwellian(){
-    for(len_t ir=0;ir<nr;ir++){
+    for(len_t ir=0;ir<nr;ir++)
         heatAbsorbtionRate[ir]=0;
-        for(len_t ip=0;ip<nShard;ip++){
-            if(YpPrevious[ip]>0 && irp[ip]<nr){
-                real_t heatAbsorbtionPrefactor = M_PI*rCld[ip]*rCld[ip]*ncold[irp[ip]]*sqrt(8.0*Constants::ec*Tcold[irp[ip]]/(M_PI*Constants::me))*Constants::ec*Tcold[irp[ip]];
-                
+
+    for(len_t ip=0;ip<nShard;ip++){
+        if(YpPrevious[ip]>0 && irp[ip]<nr){
+            real_t heatAbsorbtionPrefactor = M_PI*rCld[ip]*rCld[ip]*ncold[irp[ip]]*sqrt(8.0*Constants::ec*Tcold[irp[ip]]/(M_PI*Constants::me))*Constants::ec*Tcold[irp[ip]];
+
+            // Cells in which the profile (or the re-deposition from a neighbouring cell) is non-zero
+            len_t irMin, irMax;
+            HeatAbsorbtionRange(ip, irMin, irMax);
+            for(len_t ir=irMin;ir<irMax;ir++){
                 heatAbsorbtionRate[ir]+=-heatAbsorbtionPrefactor*heatAbsorbtionProfilesAllShards[ir*nShard+ip];
                 
                 // Account for shifted re-deposition 
@@ -433,17 +527,37 @@ void SPIHandler::CalculateAdiabaticHeatAbsorbtionRateMaxwellian(){
     }
 }
 
+/**
+ * Range of radial cells [irMin, irMax) to which the heat absorbtion of
+ * shard 'ip' contributes, including the cells adjacent to its heat
+ * absorbtion profile (which receive the shifted re-deposition).
+ */
+void SPIHandler::HeatAbsorbtionRange(len_t ip, len_t &irMin, len_t &irMax){
+    irMin=heatAbsorbtionIrMin[ip];
+    irMax=heatAbsorbtionIrMax[ip];
+    if(irMin>=irMax)
+        return;
+
+    if(irMin>0)
+        irMin--;
+    if(irMax<nr)
+        irMax++;
+}
+
 /**
  * Calculate a delta function averaged over the current time step (which gives a "box"-function) 
  * and grid cell volume (splits the "box" between the cells passed during the time step
  * Derivation available on github in SPIDeltaSoure.pdf
  */
-void SPIHandler::CalculateTimeAveragedDeltaSourceLocal(real_t *timeAveragedDeltaSource){
+void SPIHandler::CalculateTimeAveragedDeltaSourceLocal(real_t *timeAveragedDeltaSource, len_t *irMin, len_t *irMax){
     for(len_t ip=0;ip<nShard;ip++){
 
-        // Reset the deposition profile
-        for(len_t ir=0;ir<nr;ir++)
+        // Reset the deposition profile (which is only non-zero in the cells
+        // passed by the shard during the previous evaluation)
+        for(len_t ir=irMin[ip];ir<irMax[ip];ir++)
             timeAveragedDeltaSource[ir*nShard+ip]=0.0;
+        irMin[ip]=nr;
+        irMax[ip]=0;
 
         if(irp[ip] < nr){
             // Find out if the shard has passed its turning point (where the radial coordinate goes from decreasing to increasing)
@@ -478,15 +592,24 @@ void SPIHandler::CalculateTimeAveragedDeltaSourceLocal(real_t *timeAveragedDelta
                     rSourceMin=min(rCoordPPrevious[ip],rCoordPNext[ip]);
                 }
         
-                for(len_t ir=0;ir<nr;ir++){
-                    if(!(rGrid->GetR_f(ir)>rSourceMax || rGrid->GetR_f(ir+1)<rSourceMin)){
+                // Only visit the cells overlapping [rSourceMin, rSourceMax]
+                const real_t *r_f = rGrid->GetR_f();
+                len_t ir0 = upper_bound(r_f, r_f+nr+1, rSourceMin) - r_f;
+                ir0 = (ir0>0) ? ir0-1 : 0;
+                for(len_t ir=ir0;ir<nr && !(r_f[ir]>rSourceMax);ir++){
+                    if(!(r_f[ir+1]<rSourceMin)){
                         timeAveragedDeltaSource[ir*nShard+ip]+=1.0/(rGrid->GetVpVol(ir)*VpVolNormFactor*(rSourceMax-rSourceMin))*
-                                                             (min(rGrid->GetR_f(ir+1),rSourceMax)-max(rGrid->GetR_f(ir),rSourceMin))/rGrid->GetDr(ir);
+                                                             (min(r_f[ir+1],rSourceMax)-max(r_f[ir],rSourceMin))/rGrid->GetDr(ir);
+                        irMin[ip]=min(irMin[ip],ir);
+                        irMax[ip]=max(irMax[ip],ir+1);
                     }
                 }
                 iSplit++;
             }
         }
+
+        if(irMin[ip]>=irMax[ip])
+            irMin[ip]=irMax[ip]=0;
     }
 }
 
@@ -496,9 +619,23 @@ void SPIHandler::CalculateTimeAveragedDeltaSourceLocal(real_t *timeAveragedDelta
  * to travel lengths comparable to the cloud radius! Also, this profile is gaussian in the radial coordinate,
  * not a 2D-gaussian in the poloidal plane!
  */
-void SPIHandler::CalculateGaussianSourceLocal(real_t *gaussianSource){
+void SPIHandler::CalculateGaussianSourceLocal(real_t *gaussianSource, len_t *irMin, len_t *irMax){
+    const real_t *r_f = rGrid->GetR_f();
     for(len_t ip=0;ip<nShard;ip++){
-        for(len_t ir=0;ir<nr;ir++){
+        for(len_t ir=irMin[ip];ir<irMax[ip];ir++)
+            gaussianSource[ir*nShard+ip]=0.0;
+
+        // Beyond GAUSSIAN_SOURCE_CUTOFF cloud radii from the shard, the
+        // differences of the error functions below vanish to machine precision
+        // (this also covers the contribution from the other side of the axis)
+        real_t rLower = rCoordPNext[ip]-GAUSSIAN_SOURCE_CUTOFF*rCld[ip];
+        real_t rUpper = rCoordPNext[ip]+GAUSSIAN_SOURCE_CUTOFF*rCld[ip];
+        len_t ir0 = upper_bound(r_f, r_f+nr+1, rLower) - r_f;
+        len_t ir1 = lower_bound(r_f, r_f+nr+1, rUpper) - r_f;
+        irMin[ip] = (ir0>0) ? ir0-1 : 0;
+        irMax[ip] = min(ir1, nr);
+
+        for(len_t ir=irMin[ip];ir<irMax[ip];ir++){
             gaussianSource[ir*nShard+ip]=((erf((rGrid->GetR_f(ir+1)-rCoordPNext[ip])/rCld[ip])-erf((rGrid->GetR_f(ir)-rCoordPNext[ip])/rCld[ip]))/2+
                                           (erf((-rGrid->GetR_f(ir+1)-rCoordPNext[ip])/rCld[ip])-erf((-rGrid->GetR_f(ir)-rCoordPNext[ip])/rCld[ip]))/2)/  //contribution on the "other" side of the magnetic axis
                                          (2*M_PI*M_PI*VpVolNormFactor*(rGrid->GetR_f(ir+1)*rGrid->GetR_f(ir+1)-rGrid->GetR_f(ir)*rGrid->GetR_f(ir)));
@@ -511,15 +648,22 @@ void SPIHandler::CalculateGaussianSourceLocal(real_t *gaussianSource){
  * This functionality could be moved to the radial grid generator-classes, and be optimised for every specific grid
  */
 void SPIHandler::CalculateIrp(){
-    for(len_t ip=0;ip<nShard;ip++){
-        for(len_t ir=0; ir<nr;ir++){
-            if(rCoordPNext[ip]<rGrid->GetR_f(ir+1) && rCoordPNext[ip]>rGrid->GetR_f(ir)){
-                irp[ip]=ir;
-                break;
-            }
-            irp[ip]=nr;
-        }
-    }
+    for(len_t ip=0;ip<nShard;ip++)
+        irp[ip]=FindRadialCell(rCoordPNext[ip]);
+}
+
+/**
+ * Find the index of the grid cell containing the radial coordinate 'r'
+ * by bisection of the cell faces. Returns 'nr' if 'r' lies outside the
+ * grid (or exactly on a cell face).
+ */
+len_t SPIHandler::FindRadialCell(real_t r){
+    const real_t *r_f = rGrid->GetR_f();
+    len_t ir = upper_bound(r_f, r_f+nr+1, r) - r_f;
+    if(ir==0 || ir>nr || !(r>r_f[ir-1]))
+        return nr;
+    else
+        return ir-1;
 }
 
 /**
@@ -697,9 +841,9 @@ bool SPIHandler::setJacobianYpdotNGSKinetic(FVM::Matrix *jac,len_t derivId, real
 bool SPIHandler::setJacobianDepositionRateDensCons(FVM::Matrix *jac,len_t derivId, real_t *scaleFactor, real_t *SPIMolarFraction, len_t rOffset){
     bool jacIsSet=false;
     if(derivId==id_Yp){
-        for(len_t ir=0;ir<nr;ir++){
-            for(len_t ip=0;ip<nShard;ip++){
-                if(YpPrevious[ip]>0){
+        for(len_t ip=0;ip<nShard;ip++){
+            if(YpPrevious[ip]>0){
+                for(len_t ir=depositionIrMin[ip];ir<depositionIrMax[ip];ir++){
                     jac->SetElement(ir+rOffset,ip,-scaleFactor[ir]*SPIMolarFraction[ip]*12.0/5.0*M_PI*pow(abs(Yp[ip]),4.0/5.0)/pelletMolarVolume[ip]*Constants::N_Avogadro/dt*depositionProfilesAllShards[ir*nShard+ip]);
                     jacIsSet=true;
                 }
@@ -721,8 +865,10 @@ bool SPIHandler::setJacobianAdiabaticHeatAbsorbtionRateMaxwellian(FVM::Matrix *j
     bool jacIsSet=false;
     if(derivId==id_Yp){
         if(spi_cloud_radius_mode==OptionConstants::EQTERM_SPI_CLOUD_RADIUS_MODE_SELFCONSISTENT){
-            for(len_t ir=0;ir<nr;ir++){
-                for(len_t ip=0;ip<nShard;ip++){
+            for(len_t ip=0;ip<nShard;ip++){
+                len_t irMin, irMax;
+                HeatAbsorbtionRange(ip, irMin, irMax);
+                for(len_t ir=irMin;ir<irMax;ir++){
                     if(YpPrevious[ip]>0 && irp[ip]<nr){
                         real_t prefactor = -scaleFactor*6.0/5.0/Yp[ip]*M_PI*rCld[ip]*rCld[ip]*ncold[irp[ip]]*sqrt(8.0*Constants::ec*Tcold[irp[ip]]/(M_PI*Constants::me))*Constants::ec*Tcold[irp[ip]];
                         real_t jacEl = prefactor*heatAbsorbtionProfilesAllShards[ir*nShard+ip];
@@ -740,8 +886,10 @@ bool SPIHandler::setJacobianAdiabaticHeatAbsorbtionRateMaxwellian(FVM::Matrix *j
             }
         }
     }else if(derivId==id_Tcold){
-        for(len_t ir=0;ir<nr;ir++){
-            for(len_t ip=0;ip<nShard;ip++){
+        for(len_t ip=0;ip<nShard;ip++){
+            len_t irMin, irMax;
+            HeatAbsorbtionRange(ip, irMin, irMax);
+            for(len_t ir=irMin;ir<irMax;ir++){
                 if(irp[ip]<nr){
                     real_t prefactor = -scaleFactor*3.0/2.0*M_PI*rCld[ip]*rCld[ip]*ncold[irp[ip]]*sqrt(8.0*Constants::ec*Tcold[irp[ip]]/(M_PI*Constants::me))*Constants::ec;
                     real_t jacEl = prefactor*heatAbsorbtionProfilesAllShards[ir*nShard+ip];
@@ -758,8 +906,10 @@ bool SPIHandler::setJacobianAdiabaticHeatAbsorbtionRateMaxwellian(FVM::Matrix *j
             }
         }
     }else if(derivId==id_ncold){
-        for(len_t ir=0;ir<nr;ir++){
-            for(len_t ip=0;ip<nShard;ip++){
+        for(len_t ip=0;ip<nShard;ip++){
+            len_t irMin, irMax;
+            HeatAbsorbtionRange(ip, irMin, irMax);
+            for(len_t ir=irMin;ir<irMax;ir++){
                 if(irp[ip]<nr){
                     real_t prefactor = -scaleFactor*M_PI*rCld[ip]*rCld[ip]*sqrt(8.0*Constants::ec*Tcold[irp[ip]]/(M_PI*Constants::me))*Constants::ec*Tcold[irp[ip]];
                     real_t jacEl = prefactor*heatAbsorbtionProfilesAllShards[ir*nShard+ip];
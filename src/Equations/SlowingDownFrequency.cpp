@@ -16,6 +16,7 @@
 #include "DREAM/Equations/SlowingDownFrequency.hpp"
 #include "DREAM/NotImplementedException.hpp"
 #include "FVM/FVMException.hpp"
+#include "FVM/ScratchArena.hpp"
 #include <cmath>
 
 using namespace DREAM;
@@ -176,20 +177,30 @@ real_t bremsIntegrand(real_t x, void*){
 */
 
 /**
- * Evaluates the bremsstrahlung stopping power formula. Using the non-screened 
- * formula given as (4BN) in H W Koch and J W Motz, Rev Mod Phys 31, 920 (1959).
+ * Returns the charge dependence of the bremsstrahlung stopping power,
+ * which in the non-screened limit is Z^2 (independent of the charge
+ * state Z0).
  */
-real_t SlowingDownFrequency::evaluateBremsstrahlungTermAtP(len_t iz, len_t /*Z0*/, real_t p, OptionConstants::eqterm_bremsstrahlung_mode brems_mode, OptionConstants::collqty_collfreq_type /*collfreq_type*/){
+real_t SlowingDownFrequency::GetBremsstrahlungChargeFactor(len_t iz, len_t /*Z0*/){
+    len_t Z = ionHandler->GetZ(iz);
+    return Z*Z;
+}
+
+/**
+ * Evaluates the bremsstrahlung stopping power formula (divided by Z^2).
+ * Using the non-screened formula given as (4BN) in H W Koch and
+ * J W Motz, Rev Mod Phys 31, 920 (1959).
+ */
+real_t SlowingDownFrequency::evaluateBremsstrahlungShapeAtP(real_t p, OptionConstants::eqterm_bremsstrahlung_mode brems_mode, OptionConstants::collqty_collfreq_type /*collfreq_type*/){
     if(brems_mode != OptionConstants::EQTERM_BREMSSTRAHLUNG_MODE_STOPPING_POWER)
         return 0;
     else if(p==0)
         return 0;
 
     real_t preFactor = constPreFactor * Constants::alpha / (4*M_PI);
-    len_t Z = ionHandler->GetZ(iz); 
     real_t gamma = sqrt(1+p*p);
     real_t beta = p/gamma;
-    preFactor *= Z*Z / beta;
+    preFactor /= beta;
 
     // The formula from ecritpaper Eq (18)
     // return preFactor * 4*M_PI*( 0.35+0.2*log(gamma) );
@@ -303,13 +314,15 @@ real_t SlowingDownFrequency::GetP3NuSAtZero(len_t ir){
 
 /**
  * Evaluates partial derivatives of lim_{p\to 0} p^3nu_s.
+ * The returned array is allocated in the scratch arena and
+ * is only valid until the end of the current iteration.
  */
 real_t* SlowingDownFrequency::GetPartialP3NuSAtZero(len_t derivId){
     real_t preFactor = constPreFactor;
     len_t nMultiples = 1;
     if(derivId == id_ni)
         nMultiples = nzs;
-    real_t *dP3nuS = new real_t[nr*nMultiples];
+    real_t *dP3nuS = FVM::ScratchArena::Get().Allocate<real_t>(nr*nMultiples);
     for(len_t i = 0; i<nr*nMultiples; i++)
         dP3nuS[i] = 0;
 
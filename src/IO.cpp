@@ -1,14 +1,35 @@
 /**
  * Implementation of some screen I/O helper routines.
+ *
+ * Messages are either written directly (the default), or handed to a
+ * 'LogQueue' and written by a background thread, so that a slow
+ * terminal (or file system, when the output is redirected) does not
+ * slow down the simulation. Error messages are always written before
+ * the call returns. Messages can be written as plain text, or as JSON
+ * lines for consumption by log collectors.
  */
 
+#include <chrono>
+#include <cstdio>
 #include <omp.h>
 #include "DREAM/IO.hpp"
+#include "DREAM/LogQueue.hpp"
 
 
 using namespace DREAM;
+using namespace std;
 
 bool IO::message_checklist[MESSAGE_LAST] = {false};
+IO::level_t IO::level = IO::LEVEL_INFO;
+IO::format_t IO::format = IO::FORMAT_TEXT;
+
+namespace {
+    const chrono::steady_clock::time_point startTime = chrono::steady_clock::now();
+
+    // (the queue is destroyed at exit, after writing
+    // all remaining messages)
+    LogQueue logQueue;
+}
 #ifdef COLOR_TERMINAL
     const std::string IO::PRINT_YES = "\x1B[1;32mYES\x1B[0m";
     const std::string IO::PRINT_NO  = "\x1B[1;32mNO\x1B[0m";
@@ -21,7 +42,8 @@ bool IO::message_checklist[MESSAGE_LAST] = {false};
  * Print a single new-line character in the 'Info' channel.
  */
 void IO::PrintInfo() {
-    fputc('\n', stdout);
+    if (IsEnabled(LEVEL_INFO))
+        Emit(LEVEL_INFO, "");
 }
 
 /**
@@ -54,6 +76,138 @@ void IO::PrintInfo(const IO::message_t id, const char *msg) {
     PrintInfo(id, "%s", msg);
 }
 
+/**
+ * Print a debug message with no format specifiers.
+ */
+void IO::PrintDebug(const char *msg) {
+    PrintDebug("%s", msg);
+}
+
+/**
+ * Print a progress indicator to stdout. Unlike other messages, the
+ * progress indicator is not terminated by a new-line character (and
+ * may contain e.g. carriage returns to overwrite previous progress
+ * indicators). Progress indicators are not written in JSON format.
+ */
+void IO::PrintProgress(const string& msg) {
+    if (IsEnabled(LEVEL_INFO) && format != FORMAT_JSON)
+        Emit(LEVEL_INFO, string(msg), false);
+}
+
+
+/**
+ * Write the given message to stdout (or to stderr, for warnings
+ * and errors) in the current format.
+ */
+static void WriteEntry(const struct LogQueue::entry& e) {
+    FILE *f = (e.level <= IO::LEVEL_WARNING ? stderr : stdout);
+
+    if (IO::GetFormat() == IO::FORMAT_JSON) {
+        if (e.message.empty())
+            return;
+
+        static const char *levels[] = {"error", "warning", "info", "debug"};
+
+        string msg;
+        msg.reserve(e.message.size());
+        for (char c : e.message) {
+            switch (c) {
+                case '"':  msg += "\\\""; break;
+                case '\\': msg += "\\\\"; break;
+                case '\n': msg += "\\n"; break;
+                case '\t': msg += "\\t"; break;
+                default:
+                    if ((unsigned char)c < 0x20) {
+                        char buf[8];
+                        snprintf(buf, sizeof(buf), "\\u%04x", (unsigned)c);
+                        msg += buf;
+                    } else
+                        msg += c;
+            }
+        }
+
+        fprintf(
+            f, "{\"time\": %.6f, \"level\": \"%s\", \"thread\": %d, \"message\": \"%s\"}\n",
+            e.time, levels[e.level], e.thread, msg.c_str()
+        );
+        return;
+    }
+
+    const char *prefix = "";
+#ifdef COLOR_TERMINAL
+    if (e.level == IO::LEVEL_ERROR) prefix = "\x1B[1;31m[ERROR]\x1B[0m ";
+    else if (e.level == IO::LEVEL_WARNING) prefix = "\x1B[1;33m[WARNING]\x1B[0m ";
+#else
+    if (e.level == IO::LEVEL_ERROR) prefix = "[ERROR] ";
+    else if (e.level == IO::LEVEL_WARNING) prefix = "[WARNING] ";
+#endif
+    else if (e.level == IO::LEVEL_DEBUG) prefix = "[DEBUG] ";
+
+    // (written with a single call, so that messages
+    // from different threads are not interleaved)
+    string line = prefix + e.message;
+    if (e.newline)
+        line += '\n';
+
+    fputs(line.c_str(), f);
+}
+
+/**
+ * Flush the output streams.
+ */
+static void FlushStreams() {
+    fflush(stdout);
+    fflush(stderr);
+}
+
+/**
+ * Write the given message (either directly, or through the
+ * background writer if asynchronous output is enabled).
+ *
+ * lvl:     Level of the message.
+ * msg:     Message to write.
+ * newline: If 'false', the message is not terminated by a new-line
+ *          character (and is written right away).
+ */
+void IO::Emit(const level_t lvl, string&& msg, const bool newline) {
+    struct LogQueue::entry e;
+    e.level = lvl;
+    e.newline = newline;
+    e.time = chrono::duration<double>(chrono::steady_clock::now() - startTime).count();
+    e.thread = omp_get_thread_num();
+    e.message = std::move(msg);
+
+    if (logQueue.IsRunning()) {
+        const size_t ticket = logQueue.Push(std::move(e));
+        if (lvl == LEVEL_ERROR)
+            logQueue.Flush(ticket);
+    } else {
+        WriteEntry(e);
+        if (!newline)
+            fflush(stdout);
+    }
+}
+
+/**
+ * Enable or disable asynchronous output. When enabled, messages are
+ * written by a background thread (in the order in which they were
+ * emitted), and emitting a message only requires formatting it.
+ */
+void IO::SetAsynchronous(const bool async) {
+    if (async)
+        logQueue.Start(WriteEntry, FlushStreams);
+    else
+        logQueue.Stop();
+}
+
+/**
+ * Wait until all messages emitted so far have been written.
+ */
+void IO::Flush() {
+    logQueue.Flush();
+    FlushStreams();
+}
+
 /**
  * Verify the given message ID against the checklist
  * that the message has not previously been emitted
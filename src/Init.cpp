@@ -4,6 +4,7 @@
 
 #include <petsc.h>
 #include "DREAM/Init.h"
+#include "FVM/Device.hpp"
 #include "FVM/Init.hpp"
 
 
@@ -14,6 +15,10 @@ void dream_initialize() {
     dream_initialize(nullptr, nullptr);
 }
 void dream_initialize(int *argc, char **argv[]) {
+    // Kokkos (if used) must be initialized before PETSc, so
+    // that PETSc and DREAM share the same Kokkos instance
+    DREAM::FVM::Device::Initialize(argc, argv);
+
     if (argc == nullptr)
         PetscInitializeNoArguments();
     else
@@ -31,5 +36,6 @@ void dream_initialize(int *argc, char **argv[]) {
 void dream_finalize() {
     dream_fvm_finalize();
     PetscFinalize();
+    DREAM::FVM::Device::Finalize();
 }
 
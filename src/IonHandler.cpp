@@ -177,6 +177,13 @@ void IonHandler::Initialize() {
  * ion densities have been initialized. 
  */
 void IonHandler::Rebuild(){
+    // The moments only depend on the ion densities
+    const len_t version = unknowns->GetVersion(niID);
+    if (this->rebuiltVersion == version)
+        return;
+
+    const real_t *n_i = unknowns->GetUnknownData(niID);
+
     for(len_t ir=0; ir<nr; ir++){
         nfree[ir]  = 0.0;
         ntot[ir]   = 0.0;
@@ -184,19 +191,38 @@ void IonHandler::Rebuild(){
         nZZ[ir]    = 0.0;
         nZ0Z[ir]   = 0.0;
         nZ0_Z[ir]  = 0.0;
+    }
+
+    // Accumulate the moments one charge state at a time, since the
+    // densities of each charge state are stored contiguously in radius
+    // (the terms are added in the same order as when summing over the
+    // charge states at each radius)
+    for (len_t iz = 0; iz < nZ; iz++)
+        for (len_t Z0 = 0; Z0<=Zs[iz]; Z0++){
+            const real_t *ni = n_i + nr*GetIndex(iz,Z0);
+            const real_t
+                wfree  = Z0,
+                wtot   = Zs[iz],
+                wZ0Z0  = Z0*Z0,
+                wZZ    = Zs[iz]*Zs[iz],
+                wZ0Z   = Z0*Zs[iz],
+                wZ0_Z  = Z0/Zs[iz];
+
+            #pragma omp simd
+            for (len_t ir = 0; ir < nr; ir++){
+                nfree[ir]  += wfree*ni[ir];
+                ntot[ir]   += wtot*ni[ir];
+                nZ0Z0[ir]  += wZ0Z0*ni[ir];
+                nZZ[ir]    += wZZ*ni[ir];
+                nZ0Z[ir]   += wZ0Z*ni[ir];
+                nZ0_Z[ir]  += wZ0_Z*ni[ir];
+            }
+        }
+
+    for(len_t ir=0; ir<nr; ir++){
         Zeff[ir]   = 1.0;
         Ztot[ir]   = 1.0;
 
-        for (len_t iz = 0; iz < nZ; iz++)
-            for (len_t Z0 = 0; Z0<=Zs[iz]; Z0++){
-                real_t ni = GetIonDensity(ir,iz,Z0);
-                nfree[ir]  += Z0*ni;
-                ntot[ir]   += Zs[iz]*ni;
-                nZ0Z0[ir]  += Z0*Z0*ni;
-                nZZ[ir]    += Zs[iz]*Zs[iz]*ni;
-                nZ0Z[ir]   += Z0*Zs[iz]*ni;
-                nZ0_Z[ir]  += (Z0/Zs[iz])*ni;
-            }
         nbound[ir] = ntot[ir] - nfree[ir];
         if(nfree[ir])
             Zeff[ir] = nZ0Z0[ir] / nfree[ir];
@@ -208,6 +234,8 @@ void IonHandler::Rebuild(){
         if(Ztot[ir]<1.0)
             Ztot[ir] = 1.0;
     }
+
+    this->rebuiltVersion = version;
 }
 
 
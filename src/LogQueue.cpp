@@ -0,0 +1,169 @@
+/**
+ * Implementation of a queue of log messages which are written to the
+ * terminal by a background thread (see 'IO::SetAsynchronous()').
+ *
+ * Messages may be emitted from any thread (including from inside OpenMP
+ * parallel regions), so the queue is a bounded multiple-producer,
+ * single-consumer ring buffer in which every slot carries a sequence
+ * number: a producer claims a slot by incrementing 'head', and publishes
+ * the message by setting the sequence number of the slot, after which
+ * the writer thread (the only consumer) can take it. Emitting a message
+ * thus never takes a lock, and never waits for the terminal. Only if the
+ * queue is full does the producer wait for the writer to catch up (so
+ * that no messages are lost).
+ *
+ * The writer sleeps briefly whenever the queue is empty, and flushes the
+ * output streams once per batch of messages rather than once per message.
+ */
+
+#include <chrono>
+#include <cstdint>
+#include "DREAM/LogQueue.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Constructor.
+ */
+LogQueue::LogQueue() {
+    this->slots = new struct slot[CAPACITY];
+    for (size_t i = 0; i < CAPACITY; i++)
+        this->slots[i].seq.store(i, memory_order_relaxed);
+}
+
+/**
+ * Destructor.
+ */
+LogQueue::~LogQueue() {
+    this->Stop();
+    delete [] this->slots;
+}
+
+
+/**
+ * Start the writer thread.
+ *
+ * write: Function to call for writing a message.
+ * flush: Function to call after a batch of messages has been written.
+ */
+void LogQueue::Start(write_function write, flush_function flush) {
+    if (this->IsRunning())
+        return;
+
+    this->write = write;
+    this->flush = flush;
+
+    this->running.store(true, memory_order_release);
+    this->writer = thread(&LogQueue::Run, this);
+}
+
+/**
+ * Write all queued messages and stop the writer thread.
+ */
+void LogQueue::Stop() {
+    if (!this->IsRunning())
+        return;
+
+    this->running.store(false, memory_order_release);
+    if (this->writer.joinable())
+        this->writer.join();
+}
+
+
+/**
+ * Add a message to the queue.
+ *
+ * RETURNS a ticket which can be given to 'Flush()' to wait
+ * until the message has been written.
+ */
+size_t LogQueue::Push(struct entry&& e) {
+    size_t pos = this->head.load(memory_order_relaxed);
+    while (true) {
+        struct slot& s = this->slots[pos & (CAPACITY-1)];
+        const size_t seq = s.seq.load(memory_order_acquire);
+        const intptr_t d = (intptr_t)seq - (intptr_t)pos;
+
+        if (d == 0) {
+            // The slot is free; try to claim it
+            if (this->head.compare_exchange_weak(pos, pos+1, memory_order_relaxed)) {
+                s.e = std::move(e);
+                s.seq.store(pos+1, memory_order_release);
+
+                return pos+1;
+            }
+        } else if (d < 0) {
+            // The queue is full; wait for the writer
+            this_thread::yield();
+            pos = this->head.load(memory_order_relaxed);
+        } else
+            // Another thread claimed the slot first
+            pos = this->head.load(memory_order_relaxed);
+    }
+}
+
+/**
+ * Take the next message from the queue (only called
+ * from the writer thread).
+ *
+ * RETURNS false if the queue is empty.
+ */
+bool LogQueue::Pop(struct entry& e) {
+    const size_t pos = this->tail.load(memory_order_relaxed);
+    struct slot& s = this->slots[pos & (CAPACITY-1)];
+    const size_t seq = s.seq.load(memory_order_acquire);
+
+    if ((intptr_t)seq - (intptr_t)(pos+1) < 0)
+        return false;
+
+    e = std::move(s.e);
+    s.seq.store(pos + CAPACITY, memory_order_release);
+    this->tail.store(pos+1, memory_order_relaxed);
+
+    return true;
+}
+
+/**
+ * Main loop of the writer thread. Runs until the queue has been
+ * stopped and all messages have been written.
+ */
+void LogQueue::Run() {
+    struct entry e;
+    while (true) {
+        bool any = false;
+        while (this->Pop(e)) {
+            this->write(e);
+            this->nWritten.fetch_add(1, memory_order_release);
+            any = true;
+        }
+
+        if (any)
+            this->flush();
+        else if (!this->IsRunning())
+            break;
+        else
+            this_thread::sleep_for(chrono::milliseconds(1));
+    }
+}
+
+
+/**
+ * Wait until the message with the given ticket (and all
+ * messages queued before it) has been written.
+ */
+void LogQueue::Flush(const size_t ticket) {
+    if (!this->IsRunning())
+        return;
+
+    while (this->nWritten.load(memory_order_acquire) < ticket)
+        this_thread::yield();
+}
+
+/**
+ * Wait until all messages queued so far have been written.
+ */
+void LogQueue::Flush() {
+    this->Flush(this->head.load(memory_order_acquire));
+}
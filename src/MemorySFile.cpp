@@ -0,0 +1,514 @@
+/**
+ * Implementation of the softlib SFile interface which keeps all data
+ * in memory. Together with 'OutputGeneratorSFile', this allows the
+ * output of a simulation to be handed over directly to the calling
+ * program (e.g. the Python interface) without writing it to disk.
+ *
+ * Variables are stored with the same shapes as they would be given in
+ * an HDF5 file: scalars as lists with one element, and strings as a
+ * single variable.
+ */
+
+#include <cstring>
+#include <string>
+#include "DREAM/MemorySFile.hpp"
+#include "FVM/Grid/GeometryCache.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Constructor.
+ *
+ * name: Name to use as file name of the object (in error messages).
+ */
+MemorySFile::MemorySFile(const string& name) {
+    this->filename = name;
+}
+
+/**
+ * Returns the given path without leading, trailing
+ * or repeated '/'.
+ */
+string MemorySFile::Normalize(const string& path) {
+    string p;
+    p.reserve(path.size());
+
+    for (char c : path) {
+        if (c == '/' && (p.empty() || p.back() == '/'))
+            continue;
+        p += c;
+    }
+
+    if (!p.empty() && p.back() == '/')
+        p.pop_back();
+
+    return p;
+}
+
+/**
+ * Create (or replace) the named variable.
+ *
+ * name:  Name of variable.
+ * type:  Type of data stored in the variable.
+ * ndims: Number of dimensions of the data.
+ * dims:  Number of elements in each dimension.
+ */
+struct MemorySFile::variable& MemorySFile::Create(
+    const string& name, enum sfile_data_type type,
+    const sfilesize_t ndims, const sfilesize_t *dims
+) {
+    struct variable& v = this->variables[Normalize(name)];
+
+    v.type = type;
+    v.dims.assign(dims, dims+ndims);
+    v.dbl.clear();
+    v.ints.clear();
+    v.str.clear();
+
+    return v;
+}
+
+/**
+ * Returns the named variable (or throws an exception if
+ * no such variable exists).
+ */
+struct MemorySFile::variable& MemorySFile::Find(const string& name) {
+    auto it = this->variables.find(Normalize(name));
+    if (it == this->variables.end())
+        throw MemorySFileException(
+            "%s: No variable named '%s'.",
+            this->filename.c_str(), name.c_str()
+        );
+
+    return it->second;
+}
+
+/**
+ * Create a new struct.
+ */
+void MemorySFile::CreateStruct(const string& name) {
+    const string n = Normalize(name);
+    if (n.empty() || this->variables.find(n) != this->variables.end())
+        return;
+
+    Create(n, SFILE_DATA_STRUCT, 0, nullptr);
+}
+
+/**
+ * Check whether the named variable exists.
+ */
+bool MemorySFile::HasVariable(const string& name) {
+    return (this->variables.find(Normalize(name)) != this->variables.end());
+}
+
+/**
+ * Returns the type of data stored in the named variable.
+ */
+enum sfile_data_type MemorySFile::GetDataType(const string& name) {
+    return Find(name).type;
+}
+
+
+/****************************
+ * READ FUNCTIONS           *
+ ****************************/
+/**
+ * Returns the named 2D array of doubles as a newly allocated
+ * array of rows. 'dims' is set to the size of the array.
+ */
+double **MemorySFile::GetDoubles(const string& name, sfilesize_t *dims) {
+    struct variable& v = Find(name);
+    if (v.type != SFILE_DATA_DOUBLE)
+        throw MemorySFileException(
+            "%s: Variable '%s' does not contain doubles.",
+            this->filename.c_str(), name.c_str()
+        );
+
+    sfilesize_t m = 1, n = v.dbl.size();
+    if (v.dims.size() == 2) {
+        m = v.dims[0];
+        n = v.dims[1];
+    }
+
+    double **d = new double*[m];
+    d[0] = new double[m*n];
+    for (sfilesize_t i = 1; i < m; i++)
+        d[i] = d[i-1] + n;
+    memcpy(d[0], v.dbl.data(), sizeof(double)*m*n);
+
+    dims[0] = m;
+    dims[1] = n;
+
+    return d;
+}
+
+/**
+ * Returns all elements of the named variable as a newly
+ * allocated 1D array. 'dims' is set to the number of
+ * elements in each dimension (at most two).
+ */
+double *MemorySFile::GetDoubles1D(const string& name, sfilesize_t *dims) {
+    struct variable& v = Find(name);
+    if (v.type != SFILE_DATA_DOUBLE)
+        throw MemorySFileException(
+            "%s: Variable '%s' does not contain doubles.",
+            this->filename.c_str(), name.c_str()
+        );
+
+    double *d = new double[v.dbl.size()];
+    memcpy(d, v.dbl.data(), sizeof(double)*v.dbl.size());
+
+    if (v.dims.size() == 2) {
+        dims[0] = v.dims[0];
+        dims[1] = v.dims[1];
+    } else {
+        dims[0] = 1;
+        dims[1] = v.dbl.size();
+    }
+
+    return d;
+}
+
+/**
+ * Returns the named list of doubles. 'n' is set to the
+ * number of elements in the list.
+ */
+double *MemorySFile::GetList(const string& name, sfilesize_t *n) {
+    sfilesize_t dims[2];
+    double *d = GetDoubles1D(name, dims);
+    *n = dims[0]*dims[1];
+    return d;
+}
+
+/**
+ * Returns the named list of integers. 'n' is set to the
+ * number of elements in the list.
+ */
+int64_t *MemorySFile::GetIntList(const string& name, sfilesize_t *n) {
+    struct variable& v = Find(name);
+    *n = 0;
+
+    int64_t *d;
+    if (v.type == SFILE_DATA_DOUBLE) {
+        d = new int64_t[v.dbl.size()];
+        for (sfilesize_t i = 0; i < v.dbl.size(); i++)
+            d[i] = (int64_t)v.dbl[i];
+        *n = v.dbl.size();
+    } else if (v.type == SFILE_DATA_INT32 || v.type == SFILE_DATA_INT64) {
+        d = new int64_t[v.ints.size()];
+        memcpy(d, v.ints.data(), sizeof(int64_t)*v.ints.size());
+        *n = v.ints.size();
+    } else
+        throw MemorySFileException(
+            "%s: Variable '%s' does not contain integers.",
+            this->filename.c_str(), name.c_str()
+        );
+
+    return d;
+}
+
+/**
+ * Returns the first element of the named integer variable.
+ */
+int64_t MemorySFile::GetInt(const string& name) {
+    sfilesize_t n;
+    int64_t *d = GetIntList(name, &n);
+    int64_t v = (n > 0 ? d[0] : 0);
+    delete [] d;
+
+    return v;
+}
+
+/**
+ * Returns the first element of the named variable.
+ */
+double MemorySFile::GetScalar(const string& name) {
+    struct variable& v = Find(name);
+    if (v.type == SFILE_DATA_DOUBLE && !v.dbl.empty())
+        return v.dbl[0];
+    else if ((v.type == SFILE_DATA_INT32 || v.type == SFILE_DATA_INT64) && !v.ints.empty())
+        return (double)v.ints[0];
+    else
+        throw MemorySFileException(
+            "%s: Variable '%s' is not a scalar.",
+            this->filename.c_str(), name.c_str()
+        );
+}
+
+/**
+ * Returns the named string.
+ */
+string MemorySFile::GetString(const string& name) {
+    struct variable& v = Find(name);
+    if (v.type != SFILE_DATA_STRING)
+        throw MemorySFileException(
+            "%s: Variable '%s' is not a string.",
+            this->filename.c_str(), name.c_str()
+        );
+
+    return v.str;
+}
+
+/**
+ * Returns the named N-dimensional array as a newly allocated
+ * 1D array (in row-major order).
+ *
+ * name:     Name of variable.
+ * maxndims: Maximum number of dimensions allowed.
+ * ndims:    On return, contains the number of dimensions of the array.
+ * dims:     On return, contains the number of elements in each dimension.
+ */
+double *MemorySFile::GetMultiArray_linear(
+    const string& name, const sfilesize_t maxndims,
+    sfilesize_t& ndims, sfilesize_t *dims
+) {
+    struct variable& v = Find(name);
+    if (v.type != SFILE_DATA_DOUBLE)
+        throw MemorySFileException(
+            "%s: Variable '%s' does not contain doubles.",
+            this->filename.c_str(), name.c_str()
+        );
+    else if (v.dims.size() > maxndims)
+        throw MemorySFileException(
+            "%s: Variable '%s' has too many dimensions: " LEN_T_PRINTF_FMT " > " LEN_T_PRINTF_FMT ".",
+            this->filename.c_str(), name.c_str(), (len_t)v.dims.size(), (len_t)maxndims
+        );
+
+    ndims = v.dims.size();
+    for (sfilesize_t i = 0; i < ndims; i++)
+        dims[i] = v.dims[i];
+
+    double *d = new double[v.dbl.size()];
+    memcpy(d, v.dbl.data(), sizeof(double)*v.dbl.size());
+
+    return d;
+}
+
+/**
+ * Returns the named string attribute of the given variable.
+ */
+string MemorySFile::GetAttributeString(const string& name, const string& attr) {
+    struct variable& v = Find(name);
+    auto it = v.strAttributes.find(attr);
+    if (it == v.strAttributes.end())
+        throw MemorySFileException(
+            "%s: Variable '%s' has no string attribute '%s'.",
+            this->filename.c_str(), name.c_str(), attr.c_str()
+        );
+
+    return it->second;
+}
+
+/**
+ * Returns the named scalar attribute of the given variable.
+ */
+double MemorySFile::GetAttributeScalar(const string& name, const string& attr) {
+    struct variable& v = Find(name);
+    auto it = v.scalarAttributes.find(attr);
+    if (it == v.scalarAttributes.end())
+        throw MemorySFileException(
+            "%s: Variable '%s' has no scalar attribute '%s'.",
+            this->filename.c_str(), name.c_str(), attr.c_str()
+        );
+
+    return it->second;
+}
+
+
+/****************************
+ * WRITE FUNCTIONS          *
+ ****************************/
+/**
+ * Write a 2D array of doubles (given as an array of rows).
+ */
+void MemorySFile::WriteArray(
+    const string& name, const double *const* arr,
+    const sfilesize_t m, const sfilesize_t n
+) {
+    const sfilesize_t dims[2] = {m, n};
+    struct variable& v = Create(name, SFILE_DATA_DOUBLE, 2, dims);
+
+    v.dbl.resize(m*n);
+    for (sfilesize_t i = 0; i < m; i++)
+        memcpy(v.dbl.data()+i*n, arr[i], sizeof(double)*n);
+}
+
+/**
+ * Set a scalar attribute on the named variable.
+ */
+void MemorySFile::WriteAttribute_scalar(const string& name, const string& attr, const double val) {
+    Find(name).scalarAttributes[attr] = val;
+}
+
+/**
+ * Set a string attribute on the named variable.
+ */
+void MemorySFile::WriteAttribute_string(const string& name, const string& attr, const string& val) {
+    Find(name).strAttributes[attr] = val;
+}
+
+/**
+ * Write a list of 32-bit integers.
+ */
+void MemorySFile::WriteInt32List(const string& name, const int32_t *arr, const sfilesize_t n) {
+    struct variable& v = Create(name, SFILE_DATA_INT32, 1, &n);
+    v.ints.assign(arr, arr+n);
+}
+
+/**
+ * Write a list of 64-bit integers.
+ */
+void MemorySFile::WriteInt64List(const string& name, const int64_t *arr, const sfilesize_t n) {
+    struct variable& v = Create(name, SFILE_DATA_INT64, 1, &n);
+    v.ints.assign(arr, arr+n);
+}
+
+/**
+ * Write a list of doubles.
+ */
+void MemorySFile::WriteList(const string& name, const double *arr, const sfilesize_t n) {
+    struct variable& v = Create(name, SFILE_DATA_DOUBLE, 1, &n);
+    v.dbl.assign(arr, arr+n);
+}
+
+/**
+ * Write an N-dimensional array of doubles (stored in row-major order).
+ */
+void MemorySFile::WriteMultiArray(
+    const string& name, const double *arr,
+    const sfilesize_t ndims, const sfilesize_t *dims
+) {
+    struct variable& v = Create(name, SFILE_DATA_DOUBLE, ndims, dims);
+
+    sfilesize_t n = 1;
+    for (sfilesize_t i = 0; i < ndims; i++)
+        n *= dims[i];
+
+    v.dbl.assign(arr, arr+n);
+}
+
+/**
+ * Write an N-dimensional array of 64-bit integers.
+ */
+void MemorySFile::WriteMultiInt64Array(
+    const string& name, const int64_t *arr,
+    const sfilesize_t ndims, const sfilesize_t *dims
+) {
+    struct variable& v = Create(name, SFILE_DATA_INT64, ndims, dims);
+
+    sfilesize_t n = 1;
+    for (sfilesize_t i = 0; i < ndims; i++)
+        n *= dims[i];
+
+    v.ints.assign(arr, arr+n);
+}
+
+/**
+ * Write a scalar (stored as a list with one element).
+ */
+void MemorySFile::WriteScalar(const string& name, const double val) {
+    WriteList(name, &val, 1);
+}
+
+/**
+ * Write a string.
+ */
+void MemorySFile::WriteString(const string& name, const string& val) {
+    struct variable& v = Create(name, SFILE_DATA_STRING, 0, nullptr);
+    v.str = val;
+}
+
+
+/****************************
+ * CONTENTS                 *
+ ****************************/
+/**
+ * Write all variables stored in this object to the given SFile.
+ *
+ * sf: SFile to write the variables to.
+ */
+void MemorySFile::CopyTo(SFile *sf) const {
+    // (structs are created before their members, since
+    // the variables are ordered by name)
+    for (auto it = this->variables.begin(); it != this->variables.end(); it++) {
+        const string& name = it->first;
+        const struct variable& v = it->second;
+        const sfilesize_t ndims = v.dims.size();
+
+        switch (v.type) {
+            case SFILE_DATA_STRUCT: sf->CreateStruct(name); break;
+            case SFILE_DATA_STRING: sf->WriteString(name, v.str); break;
+            case SFILE_DATA_DOUBLE:
+                if (ndims == 1)
+                    sf->WriteList(name, v.dbl.data(), v.dims[0]);
+                else
+                    sf->WriteMultiArray(name, v.dbl.data(), ndims, v.dims.data());
+                break;
+            case SFILE_DATA_INT32: {
+                vector<int32_t> i32(v.ints.begin(), v.ints.end());
+                sf->WriteInt32List(name, i32.data(), i32.size());
+            } break;
+            case SFILE_DATA_INT64:
+                if (ndims == 1)
+                    sf->WriteInt64List(name, v.ints.data(), v.dims[0]);
+                else
+                    sf->WriteMultiInt64Array(name, v.ints.data(), ndims, v.dims.data());
+                break;
+
+            default:
+                throw MemorySFileException(
+                    "%s: Unable to copy variable '%s' of unrecognized type.",
+                    this->filename.c_str(), name.c_str()
+                );
+        }
+
+        for (auto a = v.strAttributes.begin(); a != v.strAttributes.end(); a++)
+            sf->WriteAttribute_string(name, a->first, a->second);
+        for (auto a = v.scalarAttributes.begin(); a != v.scalarAttributes.end(); a++)
+            sf->WriteAttribute_scalar(name, a->first, a->second);
+    }
+}
+
+/**
+ * Returns a 64-bit hash of the names, shapes and values of all
+ * variables stored in this object (including their attributes).
+ * Two objects with identical contents have the same hash.
+ */
+uint64_t MemorySFile::GetContentHash() const {
+    FVM::GeometryCache::Hash h;
+
+    // Lengths are included to make the encoding of
+    // consecutive variables unambiguous
+    auto addString = [&h](const string& s) {
+        h.Add((uint64_t)s.size());
+        h.Add(s);
+    };
+
+    for (auto it = this->variables.begin(); it != this->variables.end(); it++) {
+        const struct variable& v = it->second;
+
+        addString(it->first);
+        h.Add((int)v.type);
+        h.Add((uint64_t)v.dims.size());
+        h.Add(v.dims.data(), v.dims.size());
+        h.Add((uint64_t)v.dbl.size());
+        h.Add(v.dbl.data(), v.dbl.size());
+        h.Add((uint64_t)v.ints.size());
+        h.Add(v.ints.data(), v.ints.size());
+        addString(v.str);
+
+        for (auto a = v.strAttributes.begin(); a != v.strAttributes.end(); a++) {
+            addString(a->first);
+            addString(a->second);
+        }
+        for (auto a = v.scalarAttributes.begin(); a != v.scalarAttributes.end(); a++) {
+            addString(a->first);
+            h.Add(a->second);
+        }
+    }
+
+    return h.Get();
+}
@@ -31,6 +31,10 @@ MultiInterpolator1D::MultiInterpolator1D(
         this->interps[i] = new FVM::Interpolator1D(
             nt, nr, t, x+(i*nt*nr),  meth
         );
+
+        // All interpolators share the same time grid
+        if (i > 0)
+            this->interps[i]->ShareIndex(this->interps[0]);
     }
 }
 
@@ -58,3 +62,12 @@ const real_t *MultiInterpolator1D::Eval(const len_t n, const real_t t) {
     return this->interps[n]->Eval(t);
 }
 
+/**
+ * Evaluate the radial density of the given parameter index,
+ * at the given time, and store it in 'out' (which must contain
+ * at least 'nr' elements).
+ */
+void MultiInterpolator1D::Eval(const len_t n, const real_t t, real_t *out) {
+    this->interps[n]->Eval(t, out);
+}
+
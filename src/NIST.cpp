@@ -1,8 +1,12 @@
 /**
  * Implementation of the NIST ADS data interface.
+ *
+ * The tables are indexed directly by atomic charge Z, so that
+ * retrieving an energy is a pair of array loads (consumers which
+ * evaluate the energies in loops over the grid should nevertheless
+ * look them up once per charge state).
  */
 
-#include <unordered_map>
 #include "DREAM/DREAMException.hpp"
 #include "DREAM/NIST.hpp"
 
@@ -16,59 +20,41 @@ using namespace std;
  */
 NIST::NIST() {
     // Add total binding energies
-    for (len_t i = 0; i < nist_binding_n; i++) {
-        struct nist_data *b = nist_binding_table+i;
-        this->binding[b->Z] = b;
-    }
-
+    _BuildTable(nist_binding_table, nist_binding_n, this->binding);
     // Add ionization energies
-    for (len_t i = 0; i < nist_ionization_n; i++) {
-        struct nist_data *b = nist_ionization_table+i;
-        this->ionization[b->Z] = b;
-    }
-}
-
-
-/**
- * Retrieve the total binding energy for the ion with
- * atomic charge Z, in charge state Z0.
- *
- * Z:  Atomic charge of ion.
- * Z0: Charge state of ion.
- */
-real_t NIST::GetBindingEnergy(const len_t Z, const len_t Z0) const {
-    return this->_GetEnergy(Z, Z0, this->binding);
+    _BuildTable(nist_ionization_table, nist_ionization_n, this->ionization);
 }
 
 /**
- * Retrieve the ionization energy for the ion with
- * atomic charge Z, in charge state Z0.
+ * Build a table of energies indexed by atomic charge Z from
+ * the given list of NIST data.
  *
- * Z:  Atomic charge of ion.
- * Z0: Charge state of ion.
+ * tbl: List of NIST data.
+ * n:   Number of elements in 'tbl'.
+ * arr: On return, contains the table indexed by Z.
  */
-real_t NIST::GetIonizationEnergy(const len_t Z, const len_t Z0) const {
-    return this->_GetEnergy(Z, Z0, this->ionization);
+void NIST::_BuildTable(
+    const struct nist_data *tbl, const len_t n,
+    vector<const real_t*>& arr
+) {
+    len_t Zmax = 0;
+    for (len_t i = 0; i < n; i++)
+        if (tbl[i].Z > Zmax)
+            Zmax = tbl[i].Z;
+
+    arr.assign(Zmax+1, nullptr);
+    for (len_t i = 0; i < n; i++)
+        arr[tbl[i].Z] = tbl[i].data;
 }
 
 /**
- * General, internal method for retrieving NIST data.
+ * Report that no data is available for the element
+ * with atomic charge Z.
  */
-real_t NIST::_GetEnergy(
-    const len_t Z, const len_t Z0,
-    const unordered_map<len_t, struct nist_data*>& arr
-) const {
-    auto it = arr.find(Z);
-    if (it == arr.end())
-        throw DREAMException(
-            "No binding energy available for ions with charge Z = "
-            LEN_T_PRINTF_FMT ".",
-            Z
-        );
-
-    if (Z0 == Z)
-        return 0;
-    else
-        return it->second->data[Z0];
+void NIST::_ThrowMissing(const len_t Z) {
+    throw DREAMException(
+        "No binding energy available for ions with charge Z = "
+        LEN_T_PRINTF_FMT ".",
+        Z
+    );
 }
-
@@ -21,6 +21,7 @@
  * appropriate structs in the output file.
  */
 
+#include <algorithm>
 #include <map>
 #include "DREAM/Equations/Scalar/WallCurrentTerms.hpp"
 #include "DREAM/OtherQuantity.hpp"
@@ -29,6 +30,8 @@
 #include "FVM/UnknownQuantityHandler.hpp"
 #include "DREAM/PostProcessor.hpp"
 #include "FVM/Grid/Grid.hpp"
+#include "FVM/Grid/PXiGrid/PXiMomentumGrid.hpp"
+#include "FVM/Parallel.hpp"
 #include "DREAM/Settings/Settings.hpp"
 #include "DREAM/Settings/OptionConstants.hpp"
 
@@ -46,11 +49,11 @@ OtherQuantityHandler::OtherQuantityHandler(
     PostProcessor *postProcessor, RunawayFluid *REFluid, FVM::UnknownQuantityHandler *unknowns,
     std::vector<UnknownQuantityEquation*> *unknown_equations, IonHandler *ions,
     FVM::Grid *fluidGrid, FVM::Grid *hottailGrid, FVM::Grid *runawayGrid,
-    FVM::Grid *scalarGrid, struct eqn_terms *oqty_terms
+    FVM::Grid *scalarGrid, struct eqn_terms *oqty_terms, const len_t nLegendreModes
 ) : cqtyHottail(cqtyHottail), cqtyRunaway(cqtyRunaway),
     postProcessor(postProcessor), REFluid(REFluid), unknowns(unknowns), unknown_equations(unknown_equations),
     ions(ions), fluidGrid(fluidGrid), hottailGrid(hottailGrid), runawayGrid(runawayGrid),
-    scalarGrid(scalarGrid), tracked_terms(oqty_terms) {
+    scalarGrid(scalarGrid), nLegendreModes(nLegendreModes), tracked_terms(oqty_terms) {
 
     id_Eterm = unknowns->GetUnknownID(OptionConstants::UQTY_E_FIELD);
     id_ncold = unknowns->GetUnknownID(OptionConstants::UQTY_N_COLD);
@@ -138,6 +141,12 @@ void OtherQuantityHandler::RegisterQuantity(const std::string& name, bool ignore
         RegisterQuantity(oq);
 }
 void OtherQuantityHandler::RegisterQuantity(OtherQuantity *oq) {
+    // The work arrays are only needed when quantities are evaluated
+    if (hottailGrid != nullptr && kineticVectorHot == nullptr)
+        kineticVectorHot = new real_t[hottailGrid->GetNCells()];
+    if (runawayGrid != nullptr && kineticVectorRE == nullptr)
+        kineticVectorRE  = new real_t[runawayGrid->GetNCells()];
+
     if (!oq->IsActive()) {
         oq->Activate();
         this->registered.push_back(oq);
@@ -152,15 +161,94 @@ void OtherQuantityHandler::RegisterAllQuantities() {
         RegisterQuantity(*it);
 }
 
+/**
+ * Delete the definitions of all quantities which have not been
+ * registered. Since the list of quantities to store is fixed once
+ * the simulation has been constructed, this releases the (many)
+ * unused definitions, and the groups, for the rest of the
+ * simulation. No quantities can be registered after calling this
+ * method.
+ */
+void OtherQuantityHandler::ReleaseUnregistered() {
+    vector<OtherQuantity*> kept;
+    kept.reserve(this->registered.size());
+
+    for (auto it = this->all_quantities.begin(); it != this->all_quantities.end(); it++) {
+        if ((*it)->IsActive())
+            kept.push_back(*it);
+        else
+            delete *it;
+    }
+
+    this->all_quantities = std::move(kept);
+    this->groups.clear();
+}
+
+/**
+ * Set the output cadence of the named quantity (or group of
+ * quantities). The quantity will only be evaluated and stored
+ * on every 'every'th save step with a time in [tmin, tmax].
+ *
+ * name:  Name of quantity or group of quantities.
+ * every: Store the quantity on every 'every'th save step.
+ * tmin:  Earliest time at which to store the quantity.
+ * tmax:  Latest time at which to store the quantity.
+ */
+void OtherQuantityHandler::SetCadence(
+    const std::string& name, const len_t every, const real_t tmin, const real_t tmax
+) {
+    OtherQuantity *oq = GetByName(name);
+
+    if (oq != nullptr)
+        oq->SetCadence(every, tmin, tmax);
+    else if (groups.find(name) != groups.end()) {
+        vector<string>& grp = groups[name];
+        for (auto it = grp.begin(); it != grp.end(); it++) {
+            oq = GetByName(*it);
+            if (oq != nullptr)
+                oq->SetCadence(every, tmin, tmax);
+        }
+    } else
+        throw OtherQuantityException("Unrecognized other quantity: '%s'.", name.c_str());
+}
+
+/**
+ * Returns the number of bytes needed to store all registered
+ * quantities in one more time step.
+ */
+size_t OtherQuantityHandler::GetStepMemoryUsage() const {
+    size_t n = 0;
+    for (auto it = registered.begin(); it != registered.end(); it++)
+        n += (*it)->GetStepMemoryUsage();
+
+    return n;
+}
+
 /**
  * Store the values of all registered quantities in the
- * current time step.
+ * current time step. Only quantities due for output are
+ * evaluated. Since most quantities merely copy values
+ * computed by the solver, they are independent of each
+ * other and are evaluated in parallel, while quantities
+ * marked as 'serial' (which share scratch buffers or
+ * evaluate equation terms) are evaluated afterwards, one
+ * at a time.
  *
  * t: Current (simulation) time.
  */
 void OtherQuantityHandler::StoreAll(const real_t t) {
-    for (auto it = this->registered.begin(); it != this->registered.end(); it++)
-        (*it)->Store(t);
+    vector<OtherQuantity*> parallel, serial;
+    for (auto it = this->registered.begin(); it != this->registered.end(); it++) {
+        if ((*it)->IsDue(t))
+            ((*it)->IsSerial() ? serial : parallel).push_back(*it);
+    }
+
+    FVM::Parallel::For(parallel.size(), FVM::Parallel::GetNumberOfThreads(), [&parallel,t](const len_t i) {
+        parallel[i]->Evaluate(t);
+    });
+
+    for (OtherQuantity *oq : serial)
+        oq->Evaluate(t);
 }
 
 /**
@@ -178,6 +266,10 @@ void OtherQuantityHandler::SaveSFile(SFile *sf, const std::string& path) {
     for (auto it = this->registered.begin(); it != this->registered.end(); it++) {
         OtherQuantity *oq = *it;
 
+        // Decimated quantities may not have been stored at all
+        if (oq->GetNSavedSteps() == 0)
+            continue;
+
         // Should we create a new group first?
         auto slash = oq->GetName().find('/');
         if (slash != string::npos) {
@@ -216,7 +308,10 @@ void OtherQuantityHandler::SaveSFile(SFile *sf, const std::string& path) {
  * description)
  */
 void OtherQuantityHandler::DefineQuantities() {
-    // XXX here we assume that all momentum grids are the same
+    // (if the momentum grid varies with radius, the sizes of kinetic
+    // quantities are instead taken from the momentum grid of each
+    // radius when storing, see 'QuantityData::Store()'; the p grid
+    // is then the same at all radii)
     const len_t nr_ht = (this->hottailGrid==nullptr ? 0 : this->hottailGrid->GetNr());
     const len_t n1_ht = (this->hottailGrid==nullptr ? 0 : this->hottailGrid->GetMomentumGrid(0)->GetNp1());
     const len_t n2_ht = (this->hottailGrid==nullptr ? 0 : this->hottailGrid->GetMomentumGrid(0)->GetNp2());
@@ -225,11 +320,6 @@ void OtherQuantityHandler::DefineQuantities() {
     const len_t n1_re = (this->runawayGrid==nullptr ? 0 : this->runawayGrid->GetMomentumGrid(0)->GetNp1());
     const len_t n2_re = (this->runawayGrid==nullptr ? 0 : this->runawayGrid->GetMomentumGrid(0)->GetNp2());
 
-    if(hottailGrid != nullptr)
-        kineticVectorHot = new real_t[hottailGrid->GetNCells()];
-    if(runawayGrid != nullptr)
-        kineticVectorRE  = new real_t[runawayGrid->GetNCells()];
-
     // HELPER MACROS (to make definitions more compact)
     // Define on scalar grid
     #define DEF_SC(NAME, DESC, FUNC) \
@@ -307,6 +397,17 @@ void OtherQuantityHandler::DefineQuantities() {
     if(tracked_terms->n_re_hottail_rate != nullptr){
         DEF_FL("fluid/pCritHottail", "Critical momentum for hottail (in units of mc)", qd->Store(tracked_terms->n_re_hottail_rate->GetHottailCriticalMomentum()););
     }
+    // (the boundary fluxes are recorded when the residual is evaluated)
+    if (tracked_terms->f_hot_pmax_bc != nullptr) {
+        DEF_FL("fluid/pmaxflux_f_hot", "Flux of particles through the upper momentum boundary of f_hot, per unit volume [s^-1 m^-3]",
+            qd->Store(this->tracked_terms->f_hot_pmax_bc->GetBoundaryFlux(this->unknowns->GetUnknownData(this->id_f_hot)));
+        );
+    }
+    if (tracked_terms->f_re_pmax_bc != nullptr) {
+        DEF_FL("fluid/pmaxflux_f_re", "Flux of particles through the upper momentum boundary of f_re, per unit volume [s^-1 m^-3]",
+            qd->Store(this->tracked_terms->f_re_pmax_bc->GetBoundaryFlux(this->unknowns->GetUnknownData(this->id_f_re)));
+        );
+    }
     DEF_FL("fluid/runawayRate", "Total runaway rate, dn_RE / dt [s^-1 m^-3]", qd->Store(this->postProcessor->GetRunawayRate()););
     DEF_FL("fluid/qR0", "Safety factor multiplied by major radius R0 [m]",
         real_t *vec = qd->StoreEmpty();
@@ -542,6 +643,17 @@ void OtherQuantityHandler::DefineQuantities() {
         }
     );
 
+    // In-situ reductions of the distribution function (stored on the
+    // fluid grid, with the momentum (and mode) index as multiple)
+    if (isPXiGrid(this->hottailGrid)) {
+        DEF_FL_MUL("hottail/f_pitchint", n1_ht, "Pitch-integrated distribution function, dn/dp, as [p][r] [m^-3 (mc)^-1]",
+            evaluatePitchIntegral(this->hottailGrid, this->unknowns->GetUnknownData(this->id_f_hot), qd->StoreEmpty());
+        );
+        DEF_FL_MUL("hottail/f_legendre", this->nLegendreModes*n1_ht, "Legendre moments f_l(p) of the distribution function in xi0, as [l][p][r] [m^-3 (mc)^-3]",
+            evaluateLegendreMoments(this->hottailGrid, this->unknowns->GetUnknownData(this->id_f_hot), this->nLegendreModes, qd->StoreEmpty());
+        );
+    }
+
     // runaway/...
     DEF_RE_FR("runaway/Ar", "Net radial advection on runaway electron grid [m/s]",
         const real_t *const* Ar = this->unknown_equations->at(this->id_f_re)->GetOperator(this->id_f_re)->GetAdvectionCoeffR();
@@ -599,6 +711,17 @@ void OtherQuantityHandler::DefineQuantities() {
         }
     );
 
+    // In-situ reductions of the distribution function (stored on the
+    // fluid grid, with the momentum (and mode) index as multiple)
+    if (isPXiGrid(this->runawayGrid)) {
+        DEF_FL_MUL("runaway/f_pitchint", n1_re, "Pitch-integrated distribution function, dn/dp, as [p][r] [m^-3 (mc)^-1]",
+            evaluatePitchIntegral(this->runawayGrid, this->unknowns->GetUnknownData(this->id_f_re), qd->StoreEmpty());
+        );
+        DEF_FL_MUL("runaway/f_legendre", this->nLegendreModes*n1_re, "Legendre moments f_l(p) of the distribution function in xi0, as [l][p][r] [m^-3 (mc)^-3]",
+            evaluateLegendreMoments(this->runawayGrid, this->unknowns->GetUnknownData(this->id_f_re), this->nLegendreModes, qd->StoreEmpty());
+        );
+    }
+
 
     // scalar/..
     DEF_SC("scalar/radialloss_n_re", "Rate of runaway number loss through plasma edge, normalized to R0 [s^-1 m^-1]",
@@ -704,6 +827,23 @@ void OtherQuantityHandler::DefineQuantities() {
             qd->Store(&v);
         );
     }
+
+    // Quantities which use the shared scratch buffers 'kineticVector*',
+    // evaluate equation terms (which may share state with other terms)
+    // or the cached magnetic energy are not safe to evaluate concurrently
+    const vector<string> serialQuantities = {
+        "fluid/Tcold_ohmic", "fluid/Tcold_fhot_coll", "fluid/Tcold_fre_coll",
+        "fluid/Tcold_nre_coll", "fluid/Tcold_transport", "fluid/Tcold_radiation",
+        "fluid/Tcold_ion_coll", "fluid/W_hot", "fluid/W_re",
+        "hottail/S_ava", "runaway/S_ava",
+        "scalar/radialloss_n_re", "scalar/energyloss_T_cold",
+        "scalar/radialloss_f_re", "scalar/energyloss_f_re",
+        "scalar/radialloss_f_hot", "scalar/energyloss_f_hot",
+        "scalar/E_mag", "scalar/L_i", "scalar/l_i"
+    };
+    for (auto qty : all_quantities)
+        if (std::find(serialQuantities.begin(), serialQuantities.end(), qty->GetName()) != serialQuantities.end())
+            qty->SetSerial();
     
     // Declare groups of parameters (for registering
     // multiple parameters in one go)
@@ -798,9 +938,19 @@ real_t OtherQuantityHandler::integratedKineticBoundaryTerm(
 
 /** 
  * Returns the total poloidal magnetic energy internal 
- * to the tokamak chamber normalized to R0
+ * to the tokamak chamber normalized to R0. The energy is
+ * only re-evaluated when any of the unknowns it depends
+ * on have changed.
  */
 real_t OtherQuantityHandler::evaluateMagneticEnergy(){
+    const len_t versions[4] = {
+        this->unknowns->GetVersion(id_jtot), this->unknowns->GetVersion(id_psip),
+        this->unknowns->GetVersion(id_psi_wall), this->unknowns->GetVersion(id_Ip)
+    };
+    if (this->magneticEnergyValid &&
+        std::equal(versions, versions+4, this->magneticEnergyVersions))
+        return this->magneticEnergy;
+
     FVM::RadialGrid *rGrid = this->fluidGrid->GetRadialGrid();
     const real_t *G_R0 = rGrid->GetBTorG();
     const real_t *VpVol = rGrid->GetVpVol();
@@ -815,6 +965,10 @@ real_t OtherQuantityHandler::evaluateMagneticEnergy(){
     real_t fourPiInv = 1/(4*M_PI);
     for(len_t ir=0; ir<rGrid->GetNr(); ir++)
         E_mag -= fourPiInv*dr[ir] * VpVol[ir] * G_R0[ir] * FSA_1OverR2[ir] * jtot[ir] * psi_p[ir] / Bmin[ir];
+
+    this->magneticEnergy = E_mag;
+    std::copy(versions, versions+4, this->magneticEnergyVersions);
+    this->magneticEnergyValid = true;
     
     return E_mag;
 }
@@ -848,3 +1002,99 @@ real_t OtherQuantityHandler::integrateWeightedMaxwellian(len_t ir, real_t n, rea
 
     return result;
 }
+
+/**
+ * Returns true if the momentum grids of the given kinetic
+ * grid are p/xi grids (on which the pitch-angle reductions of
+ * the distribution function are defined).
+ */
+bool OtherQuantityHandler::isPXiGrid(FVM::Grid *grid) {
+    return (grid != nullptr &&
+        dynamic_cast<FVM::PXiGrid::PXiMomentumGrid*>(grid->GetMomentumGrid(0)) != nullptr);
+}
+
+/**
+ * Integrate the given distribution function over pitch, i.e.
+ *
+ *   F(r, p) = 1/V'(r) * int V'(r, p, xi0) f(r, p, xi0) dxi0,
+ *
+ * so that the integral of F over p is the density. The result is
+ * stored as F[i*nr + ir] (i.e. with the momentum index as multiple
+ * on the fluid grid).
+ *
+ * grid: Kinetic grid (with p/xi momentum grids) on which 'f' is defined.
+ * f:    Distribution function to integrate.
+ * F:    Contains the pitch-integrated distribution on return.
+ */
+void OtherQuantityHandler::evaluatePitchIntegral(
+    FVM::Grid *grid, const real_t *f, real_t *F
+) {
+    const len_t nr = grid->GetNr();
+
+    len_t offset = 0;
+    for (len_t ir = 0; ir < nr; ir++) {
+        FVM::MomentumGrid *mg = grid->GetMomentumGrid(ir);
+        const len_t np = mg->GetNp1(), nxi = mg->GetNp2();
+        const real_t *dxi = mg->GetDp2();
+        const real_t *Vp = grid->GetVp(ir);
+        const real_t VpVol = grid->GetVpVol(ir);
+
+        for (len_t i = 0; i < np; i++) {
+            real_t s = 0;
+            for (len_t j = 0; j < nxi; j++)
+                s += Vp[j*np+i] * f[offset + j*np+i] * dxi[j];
+
+            F[i*nr + ir] = s / VpVol;
+        }
+
+        offset += np*nxi;
+    }
+}
+
+/**
+ * Evaluate the Legendre moments of the given distribution function
+ * in the pitch coordinate xi0,
+ *
+ *   f_l(r, p) = (2l+1)/2 * int f(r, p, xi0) P_l(xi0) dxi0,
+ *
+ * so that f = sum_l f_l(r, p) P_l(xi0). The result is stored as
+ * F[(l*np + i)*nr + ir], for l = 0, 1, ..., nl-1.
+ *
+ * grid: Kinetic grid (with p/xi momentum grids) on which 'f' is defined.
+ * f:    Distribution function to evaluate moments of.
+ * nl:   Number of Legendre modes to evaluate.
+ * F:    Contains the Legendre moments on return.
+ */
+void OtherQuantityHandler::evaluateLegendreMoments(
+    FVM::Grid *grid, const real_t *f, const len_t nl, real_t *F
+) {
+    const len_t nr = grid->GetNr();
+    // (all radii use the same p grid, but may use different xi grids)
+    const len_t np = grid->GetMomentumGrid(0)->GetNp1();
+
+    for (len_t k = 0; k < nl*np*nr; k++)
+        F[k] = 0;
+
+    len_t offset = 0;
+    for (len_t ir = 0; ir < nr; ir++) {
+        FVM::MomentumGrid *mg = grid->GetMomentumGrid(ir);
+        const len_t nxi = mg->GetNp2();
+        const real_t *xi = mg->GetP2(), *dxi = mg->GetDp2();
+
+        for (len_t j = 0; j < nxi; j++) {
+            // P_l(xi) from the Bonnet recursion
+            real_t Pm = 0, P = 1;
+            for (len_t l = 0; l < nl; l++) {
+                const real_t w = 0.5*(2*l+1) * P * dxi[j];
+                for (len_t i = 0; i < np; i++)
+                    F[(l*np + i)*nr + ir] += w * f[offset + j*np+i];
+
+                const real_t Pp = ((2*l+1)*xi[j]*P - l*Pm) / (l+1);
+                Pm = P;
+                P  = Pp;
+            }
+        }
+
+        offset += np*nxi;
+    }
+}
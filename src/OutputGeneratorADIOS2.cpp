@@ -0,0 +1,475 @@
+/**
+ * OutputGenerator implementation for saving output using ADIOS2.
+ *
+ * The output is written as a sequence of ADIOS2 steps: one step per saved
+ * time step of the simulation, containing the time 't' and the unknown
+ * quantities at that time ('eqsys/NAME', of the shape of a single time
+ * step), followed by a final step containing the full time grid and the
+ * "other" quantities (with the time as the first dimension, and with
+ * their time grids in 'other/NAME@t'). The grids
+ * and ion meta data are written with the first step. Unknowns for which
+ * only the final step is kept (see '/output/finalonly') are written in
+ * the final step, together with their time grid 'eqsys/NAME@t'.
+ *
+ * Since every saved time step is written as soon as it has been taken,
+ * the output can be analysed while the simulation is running, either
+ * from the file (with the BP4/BP5 engines) or by streaming it directly
+ * to a running analysis process (with the SST engine). The saved steps
+ * are released from memory once written.
+ *
+ * The settings, solver statistics and timing information are not written
+ * by this backend (since they are serialized through the SFile interface).
+ */
+
+#include "FVM/config.h"
+
+#ifdef DREAM_WITH_ADIOS2
+
+#include <petsc.h>
+#include <string>
+#include "DREAM/OutputGeneratorADIOS2.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Constructor.
+ *
+ * eqsys:        Equation system to save output from.
+ * filename:     Name of the ADIOS2 output (file or stream).
+ * engine:       ADIOS2 engine to use (e.g. "BP5" or "SST").
+ * savesettings: If true, saves the settings of the simulation.
+ */
+OutputGeneratorADIOS2::OutputGeneratorADIOS2(
+    EquationSystem *eqsys, const std::string& filename,
+    const std::string& engine, bool savesettings
+) : OutputGenerator(eqsys, savesettings), filename(filename), engineType(engine) {}
+
+/**
+ * Destructor.
+ */
+OutputGeneratorADIOS2::~OutputGeneratorADIOS2() {
+    if (this->engine && !this->closed)
+        this->engine.Close();
+
+    delete this->adios;
+}
+
+
+/**
+ * Open the ADIOS2 engine.
+ */
+void OutputGeneratorADIOS2::Open() {
+    try {
+        // Every DREAM simulation runs on a single process (MPI is
+        // only used for running several simulations in parallel), so
+        // the output is opened on the process' own communicator
+#ifdef ADIOS2_USE_MPI
+        this->adios = new adios2::ADIOS(PETSC_COMM_SELF);
+#else
+        this->adios = new adios2::ADIOS();
+#endif
+        this->io = this->adios->DeclareIO("DREAM");
+        this->io.SetEngine(this->engineType);
+        this->engine = this->io.Open(this->filename, adios2::Mode::Write);
+    } catch (std::exception& ex) {
+        throw OutputGeneratorException(
+            "Failed to open ADIOS2 output '%s' (engine '%s'): %s",
+            this->filename.c_str(), this->engineType.c_str(), ex.what()
+        );
+    }
+}
+
+/**
+ * Save all quantities. The saved steps which have not yet been written
+ * are written first, followed by a final step containing the remaining
+ * output. The output is closed afterwards.
+ */
+void OutputGeneratorADIOS2::Save(bool current) {
+    if (this->closed)
+        return;
+
+    this->WriteSavedSteps();
+
+    try {
+        this->engine.BeginStep();
+        this->OutputGenerator::Save(current);
+        this->engine.EndStep();
+
+        this->engine.Close();
+    } catch (std::exception& ex) {
+        throw OutputGeneratorException(
+            "Failed to write ADIOS2 output '%s': %s",
+            this->filename.c_str(), ex.what()
+        );
+    }
+
+    this->closed = true;
+}
+
+/**
+ * Write all saved time steps which have not yet been written, as one
+ * ADIOS2 step each, and release them from the unknown quantities.
+ */
+void OutputGeneratorADIOS2::WriteSavedSteps() {
+    if (this->closed)
+        return;
+    else if (!this->engine)
+        this->Open();
+
+    const vector<real_t>& times = this->eqsys->GetTimes();
+    const len_t N = this->unknowns->Size();
+
+    try {
+        for (; this->nWritten < times.size(); this->nWritten++) {
+            const len_t i = this->nWritten;
+
+            this->engine.BeginStep();
+            this->WriteScalar("t", times[i]);
+
+            if (!this->gridsWritten) {
+                this->SaveGrids("grid", false);
+                this->SaveIonMetaData("ionmeta");
+            }
+
+            for (len_t j = 0; j < N; j++) {
+                FVM::UnknownQuantity *uqn = this->unknowns->GetUnknown(j);
+                FVM::QuantityData *qd = uqn->GetQuantityData();
+                if (qd->IsFinalOnly() || i >= qd->GetNSavedSteps())
+                    continue;
+
+                const string var = "eqsys/" + uqn->GetName();
+                this->WriteArray(var, qd->GetSavedStep(i), this->GetStepShape(qd));
+                this->WriteAttribute(var, "description", uqn->GetDescription());
+                this->WriteAttribute(var, "equation", uqn->GetEquationDescription());
+            }
+
+            this->engine.EndStep();
+        }
+    } catch (std::exception& ex) {
+        throw OutputGeneratorException(
+            "Failed to write ADIOS2 output '%s': %s",
+            this->filename.c_str(), ex.what()
+        );
+    }
+
+    // The written steps need not be kept in memory (the quantities
+    // which only keep their final step are written at the end)
+    for (len_t j = 0; j < N; j++) {
+        FVM::QuantityData *qd = this->unknowns->GetUnknown(j)->GetQuantityData();
+        if (!qd->IsFinalOnly())
+            qd->ReleaseSavedSteps();
+    }
+}
+
+
+/**
+ * Returns the shape of a single saved step of the given quantity.
+ */
+vector<size_t> OutputGeneratorADIOS2::GetStepShape(FVM::QuantityData *qd) {
+    sfilesize_t dims[4];
+    const len_t ndims = qd->GetStepDimensions(dims);
+
+    return vector<size_t>(dims, dims+ndims);
+}
+
+/**
+ * Write the given (contiguous) array in the current step. If the
+ * variable has been written in a previous step with a different
+ * shape, the shape of the variable is changed.
+ *
+ * name:  Name of the variable.
+ * data:  Data to write.
+ * shape: Shape of the array.
+ */
+template<typename T>
+void OutputGeneratorADIOS2::WriteArray(
+    const string& name, const T *data, const vector<size_t>& shape
+) {
+    const adios2::Dims dims(shape.begin(), shape.end());
+    const adios2::Dims start(shape.size(), 0);
+
+    adios2::Variable<T> v = this->io.InquireVariable<T>(name);
+    if (!v)
+        v = this->io.DefineVariable<T>(name, dims, start, dims);
+    else if (v.Shape() != dims) {
+        v.SetShape(dims);
+        v.SetSelection({start, dims});
+    }
+
+    this->engine.Put(v, data, adios2::Mode::Sync);
+}
+
+/**
+ * Write the given scalar value in the current step.
+ */
+template<typename T>
+void OutputGeneratorADIOS2::WriteScalar(const string& name, const T value) {
+    adios2::Variable<T> v = this->io.InquireVariable<T>(name);
+    if (!v)
+        v = this->io.DefineVariable<T>(name);
+
+    this->engine.Put(v, value, adios2::Mode::Sync);
+}
+
+/**
+ * Write the given string in the current step.
+ */
+void OutputGeneratorADIOS2::WriteString(const string& name, const string& value) {
+    adios2::Variable<string> v = this->io.InquireVariable<string>(name);
+    if (!v)
+        v = this->io.DefineVariable<string>(name);
+
+    this->engine.Put(v, value, adios2::Mode::Sync);
+}
+
+/**
+ * Define a string attribute of the named variable (unless the
+ * attribute has already been defined).
+ */
+void OutputGeneratorADIOS2::WriteAttribute(
+    const string& var, const string& name, const string& value
+) {
+    if (!this->io.InquireAttribute<string>(name, var))
+        this->io.DefineAttribute<string>(name, value, var);
+}
+
+/**
+ * Write the first 'n' saved steps of the given quantity as a single
+ * array, with the time as the first dimension.
+ *
+ * var:  Name of the variable.
+ * qd:   Quantity to write.
+ * n:    Number of saved steps to write.
+ * desc: Description of the quantity.
+ */
+void OutputGeneratorADIOS2::WriteQuantitySteps(
+    const string& var, FVM::QuantityData *qd, const len_t n, const string& desc
+) {
+    vector<size_t> shape = this->GetStepShape(qd);
+    shape.insert(shape.begin(), n);
+
+    const len_t nElements = qd->Size();
+    this->buffer.resize(n*nElements);
+    for (len_t i = 0; i < n; i++) {
+        const real_t *v = qd->GetSavedStep(i);
+        for (len_t k = 0; k < nElements; k++)
+            this->buffer[i*nElements + k] = v[k];
+    }
+
+    this->WriteArray(var, this->buffer.data(), shape);
+    this->WriteAttribute(var, "description", desc);
+
+    // Time grid of the quantity
+    this->buffer.resize(n);
+    for (len_t i = 0; i < n; i++)
+        this->buffer[i] = qd->GetSavedTime(i);
+
+    this->WriteArray(var + "@t", this->buffer.data(), {n});
+}
+
+
+/**
+ * Save grid data. The grids are only written once (with the first
+ * step), while the time grid is written with the final step.
+ *
+ * name:    Name of section under which the grid data should be saved.
+ * current: If true, saves only data for the current iteration/time step.
+ */
+void OutputGeneratorADIOS2::SaveGrids(const std::string& name, bool current) {
+    const string group = (name.back() == '/' ? name : name + "/");
+
+    // Time grid (once the output is complete)
+    if (this->gridsWritten) {
+        const vector<real_t>& t = this->eqsys->GetTimes();
+        if (current)
+            this->WriteArray(group + "t", t.data()+(t.size()-1), {1});
+        else
+            this->WriteArray(group + "t", t.data(), {t.size()});
+
+        return;
+    }
+
+    FVM::RadialGrid *rgrid = this->fluidGrid->GetRadialGrid();
+    const size_t nr = this->fluidGrid->GetNr();
+
+    // Radial grid
+    this->WriteArray(group + "r", rgrid->GetR(), {nr});
+    this->WriteArray(group + "r_f", rgrid->GetR_f(), {nr+1});
+    this->WriteArray(group + "dr", rgrid->GetDr(), {nr});
+    this->WriteArray(group + "VpVol", this->fluidGrid->GetVpVol(), {nr});
+    this->WriteScalar(group + "R0", rgrid->GetR0());
+    this->WriteScalar(group + "a", rgrid->GetMinorRadius());
+
+    // Geometric quantities
+    const string geom = group + "geometry/";
+    this->WriteArray(geom + "effectivePassingFraction", rgrid->GetEffPassFrac(), {nr});
+    this->WriteArray(geom + "xi0TrappedBoundary", rgrid->GetXi0TrappedBoundary(), {nr});
+    this->WriteArray(geom + "toroidalFlux", rgrid->GetToroidalFlux(), {nr});
+    this->WriteArray(geom + "GR0", rgrid->GetBTorG(), {nr});
+    this->WriteArray(geom + "Bmin", rgrid->GetBmin(), {nr});
+    this->WriteArray(geom + "Bmax", rgrid->GetBmax(), {nr});
+    this->WriteArray(geom + "FSA_BOverBmin2", rgrid->GetFSA_B2(), {nr});
+    this->WriteArray(geom + "FSA_BOverBmin", rgrid->GetFSA_B(), {nr});
+    this->WriteArray(geom + "FSA_R02OverR2", rgrid->GetFSA_1OverR2(), {nr});
+    this->WriteArray(geom + "FSA_NablaR2_R02OverR2", rgrid->GetFSA_NablaR2OverR2(), {nr});
+
+    if (this->hottailGrid != nullptr)
+        this->SaveMomentumGrid(group + "hottail/", this->hottailGrid, this->eqsys->GetHotTailGridType());
+    if (this->runawayGrid != nullptr)
+        this->SaveMomentumGrid(group + "runaway/", this->runawayGrid, this->eqsys->GetRunawayGridType());
+
+    this->gridsWritten = true;
+}
+
+/**
+ * Save a momentum grid. If different radii use different momentum
+ * grids (which then share the same p1 grid), the p2 grids of all
+ * radii are written one after the other, together with the number
+ * of p2 cells at each radius ('np2'), and the grid volumes are
+ * written as flat arrays.
+ *
+ * gridname: Full path to grid data in output.
+ * g:        Grid to save.
+ * tp:       Type of the momentum grid.
+ */
+void OutputGeneratorADIOS2::SaveMomentumGrid(
+    const string& gridname, FVM::Grid *g,
+    enum OptionConstants::momentumgrid_type tp
+) {
+    FVM::MomentumGrid *mg = g->GetMomentumGrid(0);
+    const size_t np1 = mg->GetNp1(), np2 = mg->GetNp2();
+    const size_t nr  = g->GetNr();
+
+    this->WriteScalar(gridname + "type", (int64_t)tp);
+
+    if (!g->HasRadiallyUniformMomentumGrid()) {
+        vector<int64_t> n2(nr);
+        vector<real_t> p2, p2_f, dp2, Vp, Vp_f2;
+        for (len_t ir = 0; ir < nr; ir++) {
+            const FVM::MomentumGrid *m = g->GetMomentumGrid(ir);
+            const len_t n = m->GetNp2();
+            n2[ir] = n;
+            p2.insert(p2.end(), m->GetP2(), m->GetP2()+n);
+            p2_f.insert(p2_f.end(), m->GetP2_f(), m->GetP2_f()+n+1);
+            dp2.insert(dp2.end(), m->GetDp2(), m->GetDp2()+n);
+            Vp.insert(Vp.end(), g->GetVp(ir), g->GetVp(ir)+np1*n);
+            Vp_f2.insert(Vp_f2.end(), g->GetVp_f2(ir), g->GetVp_f2(ir)+np1*(n+1));
+        }
+
+        this->WriteArray(gridname + "np2", n2.data(), {nr});
+        this->WriteArray(gridname + "p1", mg->GetP1(), {np1});
+        this->WriteArray(gridname + "p2", p2.data(), {p2.size()});
+        this->WriteArray(gridname + "p1_f", mg->GetP1_f(), {np1+1});
+        this->WriteArray(gridname + "p2_f", p2_f.data(), {p2_f.size()});
+        this->WriteArray(gridname + "dp1", mg->GetDp1(), {np1});
+        this->WriteArray(gridname + "dp2", dp2.data(), {dp2.size()});
+        this->WriteArray(gridname + "Vprime", Vp.data(), {Vp.size()});
+        this->WriteArray(gridname + "Vprime_f2", Vp_f2.data(), {Vp_f2.size()});
+        return;
+    }
+
+    this->WriteArray(gridname + "p1", mg->GetP1(), {np1});
+    this->WriteArray(gridname + "p2", mg->GetP2(), {np2});
+    this->WriteArray(gridname + "p1_f", mg->GetP1_f(), {np1+1});
+    this->WriteArray(gridname + "p2_f", mg->GetP2_f(), {np2+1});
+    this->WriteArray(gridname + "dp1", mg->GetDp1(), {np1});
+    this->WriteArray(gridname + "dp2", mg->GetDp2(), {np2});
+
+    // Grid volumes (which are not contiguous in memory)
+    const real_t *const* Vp = g->GetVp();
+    this->buffer.resize(nr*np2*np1);
+    for (len_t ir = 0; ir < nr; ir++)
+        for (len_t k = 0; k < np1*np2; k++)
+            this->buffer[ir*np1*np2 + k] = Vp[ir][k];
+    this->WriteArray(gridname + "Vprime", this->buffer.data(), {nr, np2, np1});
+
+    const real_t *const* Vp_f2 = g->GetVp_f2();
+    this->buffer.resize(nr*(np2+1)*np1);
+    for (len_t ir = 0; ir < nr; ir++)
+        for (len_t k = 0; k < np1*(np2+1); k++)
+            this->buffer[ir*np1*(np2+1) + k] = Vp_f2[ir][k];
+    this->WriteArray(gridname + "Vprime_f2", this->buffer.data(), {nr, np2+1, np1});
+}
+
+/**
+ * Save ion meta data.
+ */
+void OutputGeneratorADIOS2::SaveIonMetaData(const std::string& name) {
+    // (written with the first step)
+    if (this->nWritten > 0)
+        return;
+
+    const string group = (name.back() == '/' ? name : name + "/");
+
+    const len_t nZ = this->ions->GetNZ();
+    const len_t *Z = this->ions->GetZs();
+    vector<int64_t> Zl(Z, Z+nZ);
+    this->WriteArray(group + "Z", Zl.data(), {nZ});
+
+    string names = "";
+    for (const string& n : this->ions->GetNameList())
+        names += n + ";";
+
+    this->WriteString(group + "names", names);
+}
+
+/**
+ * Save other quantities.
+ */
+void OutputGeneratorADIOS2::SaveOtherQuantities(const std::string& name) {
+    for (OtherQuantity *oq : this->oqty->GetRegistered()) {
+        FVM::QuantityData *qd = oq->GetData();
+        if (qd->GetNSavedSteps() == 0)
+            continue;
+
+        this->WriteQuantitySteps(
+            name + "/" + oq->GetName(), qd, qd->GetNSavedSteps(),
+            oq->GetDescription()
+        );
+    }
+}
+
+/**
+ * Save settings used for this simulation.
+ * (not supported by this backend)
+ */
+void OutputGeneratorADIOS2::SaveSettings(const std::string&) {}
+
+/**
+ * Save data from the solver.
+ * (not supported by this backend)
+ */
+void OutputGeneratorADIOS2::SaveSolverData(const std::string&) {}
+
+/**
+ * Save timing information.
+ * (not supported by this backend)
+ */
+void OutputGeneratorADIOS2::SaveTimings(const std::string&) {}
+
+/**
+ * Save unknown quantities. All saved steps have already been written
+ * (one per ADIOS2 step), except those of quantities which only keep
+ * their final step.
+ *
+ * name:    Name of section under which the unknown data should be saved.
+ * current: If true, saves only data for the current iteration/time step.
+ */
+void OutputGeneratorADIOS2::SaveUnknowns(const std::string& name, bool current) {
+    const len_t N = this->unknowns->Size();
+    for (len_t i = 0; i < N; i++) {
+        FVM::UnknownQuantity *uqn = this->unknowns->GetUnknown(i);
+        FVM::QuantityData *qd = uqn->GetQuantityData();
+        const string var = name + "/" + uqn->GetName();
+
+        if (current)
+            this->WriteArray(var, qd->Get(), this->GetStepShape(qd));
+        else if (qd->IsFinalOnly())
+            this->WriteQuantitySteps(var, qd, qd->GetNSavedSteps(), uqn->GetDescription());
+    }
+}
+
+#endif/*DREAM_WITH_ADIOS2*/
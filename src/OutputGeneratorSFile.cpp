@@ -3,8 +3,13 @@
  * SFile object.
  */
 
+#include <cstdio>
 #include <string>
+#include <unistd.h>
+#include <vector>
+#include "DREAM/MemorySFile.hpp"
 #include "DREAM/OutputGeneratorSFile.hpp"
+#include "DREAM/OutputStream.hpp"
 #include "DREAM/Settings/Settings.hpp"
 #include "DREAM/Settings/SFile.hpp"
 
@@ -37,7 +42,33 @@ OutputGeneratorSFile::~OutputGeneratorSFile() {}
 void OutputGeneratorSFile::Save(bool current) {
     bool close = false;
     if (this->sf == nullptr) {
-        this->sf = SFile::Create(this->filename, SFILE_MODE_WRITE);
+        // If the unknowns have been streamed to the output file
+        // during the simulation, we append the remaining output
+        // to that file
+        OutputStream *os = this->eqsys->GetOutputStream();
+        this->unknownsStreamed = (
+            !current && os != nullptr && os->HasWritten() &&
+            os->GetFilename() == this->filename
+        );
+
+        if (this->unknownsStreamed) {
+            os->Close();
+            this->sf = SFile::Create(this->filename, SFILE_MODE_UPDATE);
+        } else if (!current && this->chunkedLayout) {
+            // Write unknowns in a chunked layout, and append the
+            // remaining output to the same file (the stream must be
+            // destroyed first, so that the file is fully closed)
+            {
+                OutputStream cos(this->unknowns, this->filename, true, this->compression);
+                cos.WriteSavedSteps();
+                cos.Close();
+            }
+
+            this->unknownsStreamed = true;
+            this->sf = SFile::Create(this->filename, SFILE_MODE_UPDATE);
+        } else
+            this->sf = SFile::Create(this->filename, SFILE_MODE_WRITE);
+
         close = true;
     }
 
@@ -46,12 +77,16 @@ void OutputGeneratorSFile::Save(bool current) {
     if (close) {
         this->sf->Close();
         delete this->sf;
+        this->sf = nullptr;
     }
 }
 
 
 /**
- * Save grid data.
+ * Save grid data. If a grid store has been set (see 'SetGridStore()'),
+ * only the time grid is written to the output, together with the name
+ * of the file in the grid store containing the remaining grid data
+ * ('gridstore').
  *
  * name:    Name of section under which the grid data should be saved.
  * current: If true, saves only data for the current iteration/time step.
@@ -72,6 +107,58 @@ void OutputGeneratorSFile::SaveGrids(const std::string& name, bool current) {
     else
         this->sf->WriteList(group + "t", t, this->eqsys->GetTimes().size());
 
+    if (!current && !this->gridStore.empty())
+        this->sf->WriteString(group + "gridstore", this->StoreGrids());
+    else
+        this->SaveGridData(this->sf, group);
+}
+
+/**
+ * Store the grid data (apart from the time grid, which differs between
+ * simulations) in the grid store, in a file named after the hash of its
+ * contents. If the file already exists (i.e. if a previous simulation
+ * used identical grids), it is not rewritten. The file is first written
+ * under a temporary name and then moved into place, so that simulations
+ * running in parallel never see a partially written file.
+ *
+ * RETURNS the name of the file containing the grid data.
+ */
+string OutputGeneratorSFile::StoreGrids() {
+    MemorySFile msf;
+    this->SaveGridData(&msf, "");
+
+    char name[64];
+    snprintf(name, sizeof(name), "dream-grid-%016llx", (unsigned long long)msf.GetContentHash());
+
+    const string dir = (this->gridStore.back() == '/' ? this->gridStore : this->gridStore + "/");
+    const string filename = dir + name + ".h5";
+    if (access(filename.c_str(), R_OK) == 0)
+        return filename;
+
+    const string tmpname = dir + "." + name + "." + to_string(getpid()) + ".h5";
+    SFile *gsf = SFile::Create(tmpname, SFILE_MODE_WRITE);
+    msf.CopyTo(gsf);
+    gsf->Close();
+    delete gsf;
+
+    if (rename(tmpname.c_str(), filename.c_str()) != 0) {
+        remove(tmpname.c_str());
+        throw OutputGeneratorException(
+            "Unable to write grid data to the grid store: '%s'.",
+            filename.c_str()
+        );
+    }
+
+    return filename;
+}
+
+/**
+ * Save all grid data, except the time grid, to the given SFile.
+ *
+ * sf:    SFile object to write grids to.
+ * group: Path (ending with '/', or empty) under which to store the grids.
+ */
+void OutputGeneratorSFile::SaveGridData(SFile *sf, const string& group) {
     FVM::RadialGrid *rgrid = this->fluidGrid->GetRadialGrid();
 
     // Radial grid
@@ -79,63 +166,66 @@ void OutputGeneratorSFile::SaveGrids(const std::string& name, bool current) {
     const real_t *r   = rgrid->GetR();
     const real_t *r_f = rgrid->GetR_f();
     const real_t *dr  = rgrid->GetDr();
-    this->sf->WriteList(group + "r", r, nr);
-    this->sf->WriteList(group + "r_f", r_f, nr+1);
-    this->sf->WriteList(group + "dr", dr, nr);
+    sf->WriteList(group + "r", r, nr);
+    sf->WriteList(group + "r_f", r_f, nr+1);
+    sf->WriteList(group + "dr", dr, nr);
 
     // Volume elements
     const real_t *VpVol = this->fluidGrid->GetVpVol();
-    this->sf->WriteList(group + "VpVol", VpVol, nr);
+    sf->WriteList(group + "VpVol", VpVol, nr);
 
     // Plasma size
     const real_t R0 = rgrid->GetR0();
-    this->sf->WriteScalar(group + "R0", R0);
+    sf->WriteScalar(group + "R0", R0);
     const real_t a = rgrid->GetMinorRadius();
-    this->sf->WriteScalar(group + "a", a);
+    sf->WriteScalar(group + "a", a);
     
 
-    this->sf->CreateStruct(group + "geometry");
+    sf->CreateStruct(group + "geometry");
     string geom = group + "geometry/";
     // Geometric quantities
     const real_t *effectivePassingFraction = rgrid->GetEffPassFrac();
-    this->sf->WriteList(geom + "effectivePassingFraction", effectivePassingFraction, nr);
+    sf->WriteList(geom + "effectivePassingFraction", effectivePassingFraction, nr);
     const real_t *xi0TrappedBoundary = rgrid->GetXi0TrappedBoundary();
-    this->sf->WriteList(geom + "xi0TrappedBoundary", xi0TrappedBoundary, nr);
+    sf->WriteList(geom + "xi0TrappedBoundary", xi0TrappedBoundary, nr);
     const real_t *toroidalFlux = rgrid->GetToroidalFlux();
-    this->sf->WriteList(geom + "toroidalFlux", toroidalFlux, nr);
+    sf->WriteList(geom + "toroidalFlux", toroidalFlux, nr);
     const real_t *BTorGOverR0 = rgrid->GetBTorG();
-    this->sf->WriteList(geom + "GR0", BTorGOverR0, nr);
+    sf->WriteList(geom + "GR0", BTorGOverR0, nr);
     const real_t *Bmin = rgrid->GetBmin();
-    this->sf->WriteList(geom + "Bmin", Bmin, nr);
+    sf->WriteList(geom + "Bmin", Bmin, nr);
     const real_t *Bmax = rgrid->GetBmax();
-    this->sf->WriteList(geom + "Bmax", Bmax, nr);
+    sf->WriteList(geom + "Bmax", Bmax, nr);
     const real_t *FSA_B2 = rgrid->GetFSA_B2();
-    this->sf->WriteList(geom + "FSA_BOverBmin2", FSA_B2, nr);
+    sf->WriteList(geom + "FSA_BOverBmin2", FSA_B2, nr);
     const real_t *FSA_B = rgrid->GetFSA_B();
-    this->sf->WriteList(geom + "FSA_BOverBmin", FSA_B, nr);
+    sf->WriteList(geom + "FSA_BOverBmin", FSA_B, nr);
     const real_t *FSA_1OverR2 = rgrid->GetFSA_1OverR2();
-    this->sf->WriteList(geom + "FSA_R02OverR2", FSA_1OverR2, nr);
+    sf->WriteList(geom + "FSA_R02OverR2", FSA_1OverR2, nr);
     const real_t *FSA_NablaR2OverR2 = rgrid->GetFSA_NablaR2OverR2();
-    this->sf->WriteList(geom + "FSA_NablaR2_R02OverR2", FSA_NablaR2OverR2, nr);
+    sf->WriteList(geom + "FSA_NablaR2_R02OverR2", FSA_NablaR2OverR2, nr);
 
 
 
     // Hot-tail grid
     if (this->hottailGrid != nullptr) {
-        this->sf->CreateStruct(group + "hottail");
-        SaveMomentumGrid(this->sf, group + "hottail/", this->hottailGrid, this->eqsys->GetHotTailGridType());
+        sf->CreateStruct(group + "hottail");
+        SaveMomentumGrid(sf, group + "hottail/", this->hottailGrid, this->eqsys->GetHotTailGridType());
     }
 
     // Runaway grid
     if (this->runawayGrid != nullptr) {
-        this->sf->CreateStruct(group + "runaway");
-        SaveMomentumGrid(this->sf, group + "runaway/", this->runawayGrid, this->eqsys->GetRunawayGridType());
+        sf->CreateStruct(group + "runaway");
+        SaveMomentumGrid(sf, group + "runaway/", this->runawayGrid, this->eqsys->GetRunawayGridType());
     }
 }
 
 /**
- * XXX Here we assume that all momentum grids are the same
- * Save a momentum grid to the given SFile object.
+ * Save a momentum grid to the given SFile object. If different
+ * radii use different momentum grids (which then share the same
+ * p1 grid), the p2 grids of all radii are written one after the
+ * other, together with the number of p2 cells at each radius
+ * ('np2'), and the grid volumes are written as flat arrays.
  *
  * sf:       SFile object to write grids to.
  * gridname: Full path to grid data in output file.
@@ -158,6 +248,32 @@ void OutputGeneratorSFile::SaveMomentumGrid(
     // Write grid type
     sf->WriteInt32List(gridname + "type", (int32_t*)&tp, 1);
 
+    if (!g->HasRadiallyUniformMomentumGrid()) {
+        vector<len_t> n2(nr);
+        vector<real_t> vp2, vp2_f, vdp2, Vp, Vp_f2;
+        for (len_t ir = 0; ir < nr; ir++) {
+            const FVM::MomentumGrid *m = g->GetMomentumGrid(ir);
+            const len_t n = m->GetNp2();
+            n2[ir] = n;
+            vp2.insert(vp2.end(), m->GetP2(), m->GetP2()+n);
+            vp2_f.insert(vp2_f.end(), m->GetP2_f(), m->GetP2_f()+n+1);
+            vdp2.insert(vdp2.end(), m->GetDp2(), m->GetDp2()+n);
+            Vp.insert(Vp.end(), g->GetVp(ir), g->GetVp(ir)+np1*n);
+            Vp_f2.insert(Vp_f2.end(), g->GetVp_f2(ir), g->GetVp_f2(ir)+np1*(n+1));
+        }
+
+        sf->WriteList(gridname + "np2", n2.data(), nr);
+        sf->WriteList(gridname + "p1", p1, np1);
+        sf->WriteList(gridname + "p2", vp2.data(), vp2.size());
+        sf->WriteList(gridname + "p1_f", p1_f, np1+1);
+        sf->WriteList(gridname + "p2_f", vp2_f.data(), vp2_f.size());
+        sf->WriteList(gridname + "dp1", dp1, np1);
+        sf->WriteList(gridname + "dp2", vdp2.data(), vdp2.size());
+        sf->WriteList(gridname + "Vprime", Vp.data(), Vp.size());
+        sf->WriteList(gridname + "Vprime_f2", Vp_f2.data(), Vp_f2.size());
+        return;
+    }
+
     // Grid coordinates
     sf->WriteList(gridname + "p1", p1, np1);
     sf->WriteList(gridname + "p2", p2, np2);
@@ -243,6 +359,15 @@ void OutputGeneratorSFile::SaveTimings(const std::string& name) {
  * current: If true, saves only data for the current iteration/time step.
  */
 void OutputGeneratorSFile::SaveUnknowns(const std::string& name, bool current) {
+    // Unknowns have already been written by the output stream
+    // (which does not write the time grids of quantities which
+    // only keep their final step)
+    if (this->unknownsStreamed) {
+        for (len_t i = 0; i < this->unknowns->Size(); i++)
+            this->unknowns->GetUnknown(i)->SaveSFileTime(this->sf, name);
+        return;
+    }
+
     this->sf->CreateStruct(name);
     
     if (current)
@@ -0,0 +1,148 @@
+/**
+ * Implementation of a reader which loads single time slices of the
+ * datasets in a DREAM output file, using HDF5 hyperslab selection.
+ * When a simulation is restarted from a previous output, only the time
+ * step to initialize from is needed, and so the time required to read
+ * the output file does not grow with the number of time steps saved.
+ *
+ * Time is always assumed to be the first dimension of the datasets.
+ */
+
+#include "DREAM/DREAMException.hpp"
+#include "DREAM/OutputSliceReader.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Constructor.
+ *
+ * filename: Name of HDF5 output file to read from.
+ */
+OutputSliceReader::OutputSliceReader(const string& filename) {
+    try {
+        this->file = new H5::H5File(filename, H5F_ACC_RDONLY);
+    } catch (H5::Exception& ex) {
+        throw DREAMException(
+            "OutputSliceReader: Unable to open output file '%s': %s",
+            filename.c_str(), ex.getDetailMsg().c_str()
+        );
+    }
+}
+
+/**
+ * Destructor.
+ */
+OutputSliceReader::~OutputSliceReader() {
+    this->file->close();
+    delete this->file;
+}
+
+
+/**
+ * Returns true if the named file is an HDF5 file (which can
+ * be read by this class).
+ */
+bool OutputSliceReader::IsHDF5(const string& filename) {
+    try {
+        return H5::H5File::isHdf5(filename);
+    } catch (H5::Exception&) {
+        return false;
+    }
+}
+
+
+/**
+ * Get the dimensions of the named dataset, without reading it.
+ *
+ * name:     Name of dataset.
+ * maxndims: Maximum number of dimensions allowed.
+ * dims:     On return, contains the size of each dimension.
+ *
+ * RETURNS the number of dimensions of the dataset.
+ */
+sfilesize_t OutputSliceReader::GetDimensions(
+    const string& name, const sfilesize_t maxndims, sfilesize_t *dims
+) {
+    try {
+        H5::DataSpace space = this->file->openDataSet(name).getSpace();
+        const int ndims = space.getSimpleExtentNdims();
+
+        if (ndims < 0 || (sfilesize_t)ndims > maxndims)
+            throw DREAMException(
+                "OutputSliceReader: '%s': Dataset has too many dimensions: %d.",
+                name.c_str(), ndims
+            );
+
+        hsize_t hdims[H5S_MAX_RANK];
+        space.getSimpleExtentDims(hdims);
+        for (int i = 0; i < ndims; i++)
+            dims[i] = (sfilesize_t)hdims[i];
+
+        return (sfilesize_t)ndims;
+    } catch (H5::Exception& ex) {
+        throw DREAMException(
+            "OutputSliceReader: '%s': Unable to read dataset dimensions: %s",
+            name.c_str(), ex.getDetailMsg().c_str()
+        );
+    }
+}
+
+/**
+ * Read the given time slice of the named dataset. The slice
+ * is returned as a dataset with a single time step, so that
+ * it may be passed anywhere the full dataset is expected
+ * (with time index 0).
+ *
+ * name:     Name of dataset to read.
+ * tidx:     Index of time step to read.
+ * maxndims: Maximum number of dimensions allowed.
+ * ndims:    On return, contains the number of dimensions of
+ *           the dataset (including time).
+ * dims:     On return, contains the size of each dimension of
+ *           the dataset, except the first (time) dimension
+ *           which is set to 1.
+ */
+real_t *OutputSliceReader::GetTimeSlice(
+    const string& name, const len_t tidx, const sfilesize_t maxndims,
+    sfilesize_t &ndims, sfilesize_t *dims
+) {
+    ndims = GetDimensions(name, maxndims, dims);
+
+    if (ndims == 0 || tidx >= dims[0])
+        throw DREAMException(
+            "OutputSliceReader: '%s': Time index " LEN_T_PRINTF_FMT
+            " is out of bounds.", name.c_str(), tidx
+        );
+
+    hsize_t offset[H5S_MAX_RANK], count[H5S_MAX_RANK];
+    sfilesize_t size = 1;
+    offset[0] = tidx;
+    count[0]  = 1;
+    for (sfilesize_t i = 1; i < ndims; i++) {
+        offset[i] = 0;
+        count[i]  = dims[i];
+        size *= dims[i];
+    }
+
+    real_t *data = new real_t[size];
+    try {
+        H5::DataSet dataset = this->file->openDataSet(name);
+        H5::DataSpace filespace = dataset.getSpace();
+        filespace.selectHyperslab(H5S_SELECT_SET, count, offset);
+        H5::DataSpace memspace((int)ndims, count);
+
+        dataset.read(data, H5::PredType::NATIVE_DOUBLE, memspace, filespace);
+    } catch (H5::Exception& ex) {
+        delete [] data;
+        throw DREAMException(
+            "OutputSliceReader: '%s': Unable to read time slice: %s",
+            name.c_str(), ex.getDetailMsg().c_str()
+        );
+    }
+
+    dims[0] = 1;
+    return data;
+}
@@ -0,0 +1,325 @@
+/**
+ * Implementation of an output stream, which appends the saved time
+ * steps of all unknown quantities to extensible HDF5 datasets in the
+ * output file as the simulation progresses. Once written, the data is
+ * released from memory, so that memory usage does not grow with the
+ * number of saved time steps. Since the file is flushed after each
+ * write, the data saved so far is also kept if the simulation should
+ * crash.
+ *
+ * The datasets are created under '/eqsys' with the same layout as those
+ * written by 'OutputGeneratorSFile', which writes the remaining output
+ * to the same file at the end of the simulation.
+ *
+ * The data is written by a background thread, so that the solver does
+ * not have to wait for the file system. The saved steps are not copied;
+ * instead, ownership of the memory holding them is transferred from the
+ * 'QuantityData' objects to the writer, which frees the memory once the
+ * data has been written. At most 'MAX_QUEUED_BATCHES' calls to
+ * 'WriteSavedSteps()' may be waiting to be written at any time. Only the
+ * writer thread accesses the HDF5 file after it has been opened.
+ */
+
+#include <string>
+#include "DREAM/DREAMException.hpp"
+#include "DREAM/IO.hpp"
+#include "DREAM/OutputStream.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Constructor.
+ *
+ * unknowns:     List of unknown quantities to write.
+ * filename:     Name of output file.
+ * radialChunks: If true, the datasets of kinetic quantities are
+ *               chunked by (time step, radius), so that individual
+ *               slices can be read efficiently. Otherwise, all
+ *               datasets are chunked by time step only.
+ * compression:  Deflate compression level (0-9) of all datasets
+ *               (0 = no compression). If enabled, the datasets are
+ *               also byte-shuffled, which improves compression of
+ *               floating-point data.
+ */
+OutputStream::OutputStream(
+    FVM::UnknownQuantityHandler *unknowns, const string& filename,
+    bool radialChunks, int_t compression
+) : filename(filename), unknowns(unknowns), radialChunks(radialChunks),
+    compression(compression) { }
+
+/**
+ * Destructor.
+ */
+OutputStream::~OutputStream() {
+    this->Close();
+
+    for (auto ds : this->datasets)
+        delete ds;
+}
+
+/**
+ * Wait for all queued data to be written, and close the
+ * output file (if open). Errors which occurred while writing
+ * are reported here (without interrupting the simulation, so
+ * that the remaining output can still be saved).
+ */
+void OutputStream::Close() {
+    this->StopWriter();
+
+    if (this->file != nullptr) {
+        try {
+            this->file->close();
+        } catch (H5::Exception& ex) {
+            if (this->writerError.empty())
+                this->writerError = ex.getDetailMsg();
+        }
+
+        delete this->file;
+        this->file = nullptr;
+    }
+
+    if (!this->writerError.empty()) {
+        DREAM::IO::PrintError(
+            "OutputStream: Failed to write to '%s': %s",
+            this->filename.c_str(), this->writerError.c_str()
+        );
+        this->writerError.clear();
+    }
+}
+
+/**
+ * Stop the writer thread (after it has written all queued data).
+ */
+void OutputStream::StopWriter() {
+    if (!this->writer.joinable())
+        return;
+
+    {
+        std::lock_guard<std::mutex> lock(this->queueMutex);
+        this->stopWriter = true;
+    }
+    this->queueCond.notify_all();
+    this->writer.join();
+}
+
+/**
+ * Create the output file along with one extensible dataset
+ * per unknown quantity.
+ */
+void OutputStream::Open() {
+    this->file = new H5::H5File(this->filename, H5F_ACC_TRUNC);
+    this->file->createGroup("/eqsys");
+
+    const len_t N = this->unknowns->Size();
+    for (len_t i = 0; i < N; i++) {
+        FVM::UnknownQuantity *uqn = this->unknowns->GetUnknown(i);
+        struct stream_dataset *ds = new struct stream_dataset;
+
+        ds->uqn = uqn;
+        ds->nQueued = 0;
+        ds->single = uqn->GetQuantityData()->IsSinglePrecision();
+
+        sfilesize_t sdims[4];
+        ds->ndims = 1 + uqn->GetQuantityData()->GetStepDimensions(sdims);
+
+        hsize_t maxdims[5], chunk[5];
+        ds->dims[0] = 0;
+        maxdims[0]  = H5S_UNLIMITED;
+        chunk[0]    = 1;
+        for (len_t j = 1; j < ds->ndims; j++)
+            ds->dims[j] = maxdims[j] = chunk[j] = (hsize_t)sdims[j-1];
+
+        // The last two dimensions of kinetic quantities are momentum
+        // dimensions; all preceding dimensions (multiples and radius)
+        // are split into separate chunks
+        const len_t nMultiDims = (uqn->GetQuantityData()->GetNMultiples() > 1 ? 1 : 0);
+        const bool kinetic = (ds->ndims == 4+nMultiDims);
+        if (this->radialChunks && kinetic) {
+            for (len_t j = 1; j+2 < ds->ndims; j++)
+                chunk[j] = 1;
+        }
+
+        H5::DataSpace space(ds->ndims, ds->dims, maxdims);
+        H5::DSetCreatPropList plist;
+        plist.setChunk(ds->ndims, chunk);
+        if (this->compression > 0) {
+            plist.setShuffle();
+            plist.setDeflate((int)this->compression);
+        }
+
+        ds->dataset = this->file->createDataSet(
+            "/eqsys/" + uqn->GetName(),
+            ds->single ? H5::PredType::NATIVE_FLOAT : H5::PredType::NATIVE_DOUBLE,
+            space, plist
+        );
+
+        WriteStringAttribute(ds->dataset, "description", uqn->GetDescription());
+        WriteStringAttribute(ds->dataset, "equation", uqn->GetEquationDescription());
+
+        this->datasets.push_back(ds);
+    }
+}
+
+/**
+ * Write a string attribute to the given dataset.
+ */
+void OutputStream::WriteStringAttribute(
+    H5::DataSet& ds, const string& name, const string& value
+) {
+    H5::StrType st(H5::PredType::C_S1, value.size() > 0 ? value.size() : 1);
+    H5::Attribute attr = ds.createAttribute(name, st, H5::DataSpace(H5S_SCALAR));
+    attr.write(st, value);
+}
+
+/**
+ * Hand all saved steps which have not yet been written over to the
+ * writer thread (which appends them to the output file), and release
+ * them from the unknown quantities.
+ */
+void OutputStream::WriteSavedSteps() {
+    if (this->file == nullptr) {
+        try {
+            this->Open();
+        } catch (H5::Exception& ex) {
+            throw DREAMException(
+                "OutputStream: Failed to create '%s': %s",
+                this->filename.c_str(), ex.getDetailMsg().c_str()
+            );
+        }
+
+        this->stopWriter = false;
+        this->writer = std::thread(&OutputStream::RunWriter, this);
+    }
+
+    std::vector<struct stream_step> batch;
+    std::vector<real_t*> steps;
+    std::vector<float*> fsteps;
+    for (auto ds : this->datasets) {
+        FVM::QuantityData *qd = ds->uqn->GetQuantityData();
+
+        // The initial value is kept in memory by the quantity
+        if (ds->nQueued == 0 && qd->GetNSavedSteps() > 0) {
+            batch.push_back({ds, 0, qd->GetSavedStep(0), nullptr, false});
+            ds->nQueued++;
+        }
+
+        if (ds->single) {
+            fsteps.clear();
+            qd->TakeSavedSteps(fsteps);
+            for (float *step : fsteps)
+                batch.push_back({ds, ds->nQueued++, nullptr, step, true});
+        } else {
+            steps.clear();
+            qd->TakeSavedSteps(steps);
+            for (real_t *step : steps)
+                batch.push_back({ds, ds->nQueued++, step, nullptr, true});
+        }
+    }
+
+    std::unique_lock<std::mutex> lock(this->queueMutex);
+    if (!this->writerError.empty()) {
+        string err = this->writerError;
+        lock.unlock();
+
+        for (auto& st : batch)
+            if (st.owned) {
+                delete [] st.data;
+                delete [] st.fdata;
+            }
+
+        throw DREAMException(
+            "OutputStream: Failed to write to '%s': %s",
+            this->filename.c_str(), err.c_str()
+        );
+    }
+
+    // Wait for the writer if too much data is queued
+    this->queueCond.wait(lock, [this] { return this->queue.size() < MAX_QUEUED_BATCHES; });
+    this->queue.push_back(std::move(batch));
+    lock.unlock();
+
+    this->queueCond.notify_all();
+}
+
+/**
+ * Main loop of the writer thread.
+ */
+void OutputStream::RunWriter() {
+    std::unique_lock<std::mutex> lock(this->queueMutex);
+    while (true) {
+        this->queueCond.wait(lock, [this] { return (this->stopWriter || !this->queue.empty()); });
+
+        if (this->queue.empty()) {
+            if (this->stopWriter)
+                break;
+            else
+                continue;
+        }
+
+        std::vector<struct stream_step> batch = std::move(this->queue.front());
+        this->queue.pop_front();
+        bool failed = !this->writerError.empty();
+        lock.unlock();
+
+        // Notify solver that there is space in the queue
+        this->queueCond.notify_all();
+
+        string err;
+        if (!failed) {
+            try {
+                this->WriteBatch(batch);
+            } catch (H5::Exception& ex) {
+                err = ex.getDetailMsg();
+            }
+        }
+
+        for (auto& st : batch)
+            if (st.owned) {
+                delete [] st.data;
+                delete [] st.fdata;
+            }
+
+        lock.lock();
+        if (!err.empty() && this->writerError.empty())
+            this->writerError = err;
+    }
+}
+
+/**
+ * Append the given saved steps to the output file.
+ */
+void OutputStream::WriteBatch(std::vector<struct stream_step>& batch) {
+    hsize_t offset[5] = {0,0,0,0,0}, count[5];
+    for (auto& st : batch) {
+        struct stream_dataset *ds = st.ds;
+
+        count[0] = 1;
+        for (len_t j = 1; j < ds->ndims; j++)
+            count[j] = ds->dims[j];
+
+        H5::DataSpace memspace(ds->ndims, count);
+
+        ds->dims[0] = st.index+1;
+        ds->dataset.extend(ds->dims);
+
+        offset[0] = st.index;
+        H5::DataSpace filespace = ds->dataset.getSpace();
+        filespace.selectHyperslab(H5S_SELECT_SET, count, offset);
+
+        // (HDF5 converts double precision data to the type of
+        // the dataset if needed)
+        if (st.fdata != nullptr)
+            ds->dataset.write(
+                st.fdata, H5::PredType::NATIVE_FLOAT, memspace, filespace
+            );
+        else
+            ds->dataset.write(
+                st.data, H5::PredType::NATIVE_DOUBLE, memspace, filespace
+            );
+    }
+
+    this->file->flush(H5F_SCOPE_GLOBAL);
+}
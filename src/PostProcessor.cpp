@@ -4,6 +4,12 @@
  * The purpose of this class is to calculate and store the values of various
  * quantities derived from the unknown quantities solved for by DREAM. This
  * includes, for example, the runaway rate dn_RE/dt
+ *
+ * The post-processing quantities are only written to the output, and so
+ * only need to be evaluated for the time steps which are saved. They must
+ * however be evaluated when the step is taken, since they may depend on
+ * the solution in the preceding time step (which is not kept after the
+ * next step is taken).
  */
 
 #include "DREAM/PostProcessor.hpp"
@@ -41,9 +47,23 @@ PostProcessor::~PostProcessor() {
  * Process the equation system and calculate the
  * various post-processing quantities.
  *
+ * t:        Time of the most recently completed time step.
+ * saveStep: If true, the time step will be saved to the output.
+ *           Otherwise, no quantities need to be calculated.
+ */
+void PostProcessor::Process(const real_t t, const bool saveStep) {
+    if (!saveStep)
+        return;
+
+    this->ProcessRunawayRate(t);
+}
+
+/**
+ * Calculate the runaway rate.
+ *
  * t: Time of the most recently completed time step.
  */
-void PostProcessor::Process(const real_t t) {
+void PostProcessor::ProcessRunawayRate(const real_t t) {
     const len_t nr = this->fluidGrid->GetNr();
 
     // RUNAWAY RATE
@@ -0,0 +1,187 @@
+/**
+ * Implementation of a cache of simulation outputs, which allows a
+ * simulation with exactly the same settings as a previous simulation to
+ * return the output of the previous simulation instead of being rerun.
+ *
+ * A cached output is identified by a 64-bit key, computed by hashing the
+ * names, types and values of all settings (in alphabetical order),
+ * together with the version of DREAM and the ADAS/NIST atomic data tables
+ * compiled into the executable. Settings which only determine where files
+ * are written (such as the name of the output file) are excluded from the
+ * key, so that a repeated simulation is recognized regardless of where its
+ * output is stored. Files referenced by the settings (e.g. numerical
+ * magnetic equilibria) are only identified by their names.
+ *
+ * Failures when reading or writing the cache are never an error: the
+ * simulation is then simply run (and its output is not cached).
+ */
+
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <unistd.h>
+#include <vector>
+#include "DREAM/AtomicDataImage.hpp"
+#include "DREAM/config.h"
+#include "DREAM/ResultCache.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Constructor.
+ *
+ * directory: Directory in which cached outputs are stored.
+ * s:         Settings of the simulation.
+ */
+ResultCache::ResultCache(const string& directory, Settings *s)
+    : key(ComputeKey(s)) {
+
+    char name[64];
+    snprintf(name, sizeof(name), "dream-result-%016llx.h5", (unsigned long long)this->key);
+
+    if (directory.empty() || directory.back() == '/')
+        this->filename = directory + name;
+    else
+        this->filename = directory + "/" + name;
+}
+
+/**
+ * Returns true if the named setting should not be part of the
+ * cache key, i.e. if it only affects where files are written or
+ * read from (not what is written to the output).
+ */
+bool ResultCache::IsIgnoredSetting(const string& name) {
+    static const char *ignored[] = {
+        "atomic/adas_image", "output/checkpoint", "output/filename", "output/resultcache",
+        "output/statusfile", "output/tracefile", "radialgrid/geometrycache"
+    };
+
+    const string n = (!name.empty() && name[0] == '/') ? name.substr(1) : name;
+    for (const char *i : ignored)
+        if (n == i)
+            return true;
+
+    return false;
+}
+
+/**
+ * Compute the key identifying the output of a simulation with
+ * the given settings.
+ *
+ * s: Settings of the simulation.
+ */
+uint64_t ResultCache::ComputeKey(Settings *s) {
+    const auto& settings = s->GetSettings();
+
+    vector<const Settings::setting_t*> sorted;
+    sorted.reserve(settings.size());
+    for (auto it = settings.begin(); it != settings.end(); it++)
+        if (!IsIgnoredSetting(it->first))
+            sorted.push_back(it->second);
+
+    std::sort(sorted.begin(), sorted.end(), [](const Settings::setting_t *a, const Settings::setting_t *b) {
+        return (a->name < b->name);
+    });
+
+    FVM::GeometryCache::Hash h;
+    h.Add(string(DREAM_GIT_SHA1));
+    h.Add(AtomicDataImage::GetSourceKey());
+
+    for (const Settings::setting_t *st : sorted)
+        AddToHash(h, st);
+
+    return h.Get();
+}
+
+/**
+ * Add the name, type and value of the given setting to the hash.
+ */
+void ResultCache::AddToHash(FVM::GeometryCache::Hash& h, const Settings::setting_t *st) {
+    // Lengths are included to make the encoding of
+    // consecutive settings unambiguous
+    h.Add((uint64_t)st->name.size());
+    h.Add(st->name);
+    h.Add((int_t)st->type);
+
+    switch (st->type) {
+        case Settings::SETTING_TYPE_BOOL: h.Add(*(bool*)st->value); break;
+        case Settings::SETTING_TYPE_INT:  h.Add(*(int_t*)st->value); break;
+        case Settings::SETTING_TYPE_REAL: h.Add(*(real_t*)st->value); break;
+        case Settings::SETTING_TYPE_STRING: {
+            const string *v = (const string*)st->value;
+            h.Add((uint64_t)v->size());
+            h.Add(*v);
+        } break;
+
+        case Settings::SETTING_TYPE_INT_ARRAY:
+        case Settings::SETTING_TYPE_REAL_ARRAY: {
+            len_t ntot = (st->value == nullptr ? 0 : 1);
+            h.Add(st->ndims);
+            for (len_t i = 0; i < st->ndims; i++) {
+                const len_t d = (st->dims == nullptr ? 0 : st->dims[i]);
+                h.Add(d);
+                ntot *= d;
+            }
+
+            h.Add(ntot);
+            if (st->type == Settings::SETTING_TYPE_INT_ARRAY)
+                h.Add((const int_t*)st->value, ntot);
+            else
+                h.Add((const real_t*)st->value, ntot);
+        } break;
+
+        default: break;
+    }
+}
+
+/**
+ * Copy the file 'src' to 'dst'. The data is first written to a
+ * temporary file, which is then moved into place, so that other
+ * processes never see a partially written file.
+ *
+ * RETURNS true if the file was copied successfully.
+ */
+bool ResultCache::CopyFile(const string& src, const string& dst) {
+    ifstream in(src, ios::binary);
+    if (!in.good())
+        return false;
+
+    const string tmpname = dst + "." + to_string(getpid()) + ".tmp";
+    ofstream out(tmpname, ios::binary);
+    if (!out.good())
+        return false;
+
+    out << in.rdbuf();
+    out.close();
+
+    if (!out.good() || rename(tmpname.c_str(), dst.c_str()) != 0) {
+        remove(tmpname.c_str());
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Copy the cached output (if any) to the named output file.
+ *
+ * RETURNS true if a cached output existed and was copied.
+ */
+bool ResultCache::Restore(const string& outfile) const {
+    if (access(this->filename.c_str(), R_OK) != 0)
+        return false;
+
+    return CopyFile(this->filename, outfile);
+}
+
+/**
+ * Store the named output file in the cache.
+ *
+ * RETURNS true if the output was stored successfully.
+ */
+bool ResultCache::Store(const string& outfile) const {
+    return CopyFile(outfile, this->filename);
+}
@@ -42,10 +42,15 @@ void SimulationGenerator::DefineOptions_CollisionQuantityHandler(
  * grid:     Grid object for which to construct the collision handler.
  * unknowns: List of unknowns in the associated equation system.
  * s:        Settings describing how to construct the collision handler.
+ * lnLambdaCache: Cache of radial Coulomb logarithms to share with
+ *           other collision handlers (optional).
+ * collFreqCache: Cache of radial collision frequency parameters to
+ *           share with other collision handlers (optional).
  */
 CollisionQuantityHandler *SimulationGenerator::ConstructCollisionQuantityHandler(
     enum OptionConstants::momentumgrid_type gridtype, FVM::Grid *grid,
-    FVM::UnknownQuantityHandler *unknowns, IonHandler *ionHandler,  Settings *s
+    FVM::UnknownQuantityHandler *unknowns, IonHandler *ionHandler,  Settings *s,
+    CoulombLogarithmCache *lnLambdaCache, CollisionFrequencyCache *collFreqCache
 ) {
     struct CollisionQuantity::collqty_settings *cq =
         new CollisionQuantity::collqty_settings;
@@ -57,7 +62,7 @@ CollisionQuantityHandler *SimulationGenerator::ConstructCollisionQuantityHandler
     cq->pstar_mode          = (enum OptionConstants::collqty_pstar_mode)              s->GetInteger(MODNAME "/pstar_mode");
     cq->screened_diffusion  = (enum OptionConstants::collqty_screened_diffusion_mode) s->GetInteger(MODNAME "/screened_diffusion_mode");
 
-    CollisionQuantityHandler *cqh = new CollisionQuantityHandler(grid, unknowns, ionHandler,gridtype,cq);
+    CollisionQuantityHandler *cqh = new CollisionQuantityHandler(grid, unknowns, ionHandler,gridtype,cq,lnLambdaCache,collFreqCache);
 
     return cqh;
 }
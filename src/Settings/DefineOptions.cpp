@@ -3,6 +3,7 @@
  * defines all available options in DREAM.
  */
 
+#include "DREAM/IO.hpp"
 #include "DREAM/Settings/SimulationGenerator.hpp"
 
 
@@ -40,6 +41,7 @@ void SimulationGenerator::DefineOptions(Settings *s) {
  * Define options for the ADAS database.
  */
 void SimulationGenerator::DefineOptions_ADAS(Settings *s) {
+    s->DefineSetting("atomic/adas_image", "Name of image of precomputed ADAS interpolation coefficients to use (empty = compute the coefficients)", (std::string)"");
     s->DefineSetting("atomic/adas_interpolation", "Interpolation method for ADAS rate coefficients", (int_t)OptionConstants::ADAS_INTERP_BICUBIC);
 }
 
@@ -47,7 +49,31 @@ void SimulationGenerator::DefineOptions_ADAS(Settings *s) {
  * Define output options.
  */
 void SimulationGenerator::DefineOptions_Output(Settings *s) {
+    s->DefineSetting("/output/adios2engine", "ADIOS2 engine to use with the ADIOS2 output backend (e.g. 'BP5' or 'SST').", (std::string)"BP5");
+    s->DefineSetting("/output/backend", "Backend to use for writing the simulation output.", (int_t)OptionConstants::OUTPUT_BACKEND_SFILE);
+    s->DefineSetting("/output/compression", "Deflate compression level (0-9) of chunked unknown quantities in the output (0 = no compression).", (int_t)0);
+    s->DefineSetting("/output/checkpoint", "Name of file to periodically write checkpoints of the simulation state to (empty = don't write checkpoints).", (std::string)"");
+    s->DefineSetting("/output/checkpointinterval", "Wall-clock time (in minutes) after which to write a new checkpoint (0 = not used; if both this and 'checkpointsteps' are 0, a checkpoint is written after every saved step).", (real_t)0);
+    s->DefineSetting("/output/checkpointsteps", "Number of saved time steps after which to write a new checkpoint (0 = not used).", (int_t)0);
     s->DefineSetting("/output/filename", "File name of simulation output", (std::string)"output.h5");
+    s->DefineSetting("/output/finalonly", "List of unknown quantities for which to only store the initial value and the final saved time step.", (const std::string)"");
+    s->DefineSetting("/output/gridstore", "Directory in which to store the grid data, by the hash of its contents, so that outputs with identical grids share a single grid file (empty = store the grids in the output file).", (std::string)"");
+    s->DefineSetting("/output/layout", "HDF5 layout of unknown quantities in the output file.", (int_t)OptionConstants::OUTPUT_LAYOUT_CONTIGUOUS);
+    s->DefineSetting("/output/resultcache", "Directory in which to cache simulation outputs, so that a simulation with identical settings returns the cached output instead of being rerun (empty = disabled).", (std::string)"");
+    s->DefineSetting("/output/singleprecision", "List of unknown quantities for which to store saved time steps in single precision.", (const std::string)"");
+    s->DefineSetting("/output/statusfile", "Name of file to periodically write the progress of the simulation to (JSON, or Prometheus text format if the name ends with '.prom'; empty = don't write).", (std::string)"");
+    s->DefineSetting("/output/statusinterval", "Shortest wall-clock time (in seconds) between two updates of the status file.", (real_t)10);
+    s->DefineSetting("/output/streaming", "If true, writes saved time steps of unknown quantities to the output file during the simulation.", (bool)false);
+    s->DefineSetting("/output/trace", "Record a hierarchical trace of the time spent in the different parts of the simulation.", (bool)false);
+    s->DefineSetting("/output/tracefile", "Name of file to write the trace to, in the Chrome trace event format (empty = don't write).", (std::string)"");
+    s->DefineSetting("/output/tracemaxevents", "Maximum number of individual trace events to keep for the trace file.", (int_t)1000000);
+    s->DefineSetting("/output/logasync", "Write messages to the terminal from a background thread, so that a slow terminal does not slow down the simulation.", (bool)false);
+    s->DefineSetting("/output/logformat", "Format of messages written to the terminal (1 = plain text, 2 = JSON lines).", (int_t)IO::FORMAT_TEXT);
+    s->DefineSetting("/output/loglevel", "Most verbose level of messages to print (0 = errors, 1 = warnings, 2 = info, 3 = debug).", (int_t)IO::LEVEL_INFO);
+    s->DefineSetting("/output/petsclog", "Log the phases of the solver as PETSc stages and events, and save the PETSc performance summary to the output file.", (bool)false);
+    s->DefineSetting("/output/perfcounters", "Count hardware events (cycles, instructions, cache misses) while each timer is running (Linux only).", (bool)false);
+    s->DefineSetting("/output/memory", "Report the memory used by the main data structures of the simulation.", (bool)false);
+    s->DefineSetting("/output/termtimings", "Record the time spent in each equation term (aggregated by term name).", (bool)false);
     s->DefineSetting("/output/timingstdout", "Print timing info to stdout after the simulation.", (bool)false);
     s->DefineSetting("/output/timingfile", "Save timing info to the output file.", (bool)false);
 }
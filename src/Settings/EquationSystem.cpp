@@ -2,10 +2,16 @@
 #include <vector>
 #include <string>
 #include "DREAM/EquationSystem.hpp"
+#include "DREAM/IO.hpp"
 #include "DREAM/OtherQuantityHandler.hpp"
 #include "DREAM/PostProcessor.hpp"
 #include "DREAM/Settings/Settings.hpp"
 #include "DREAM/Settings/SimulationGenerator.hpp"
+#include "FVM/MemoryAccounting.hpp"
+#include "FVM/PerfCounters.hpp"
+#include "FVM/PetscLog.hpp"
+#include "FVM/TermTimings.hpp"
+#include "FVM/Tracer.hpp"
 
 
 using namespace DREAM;
@@ -33,12 +39,18 @@ void SimulationGenerator::DefineOptions_EquationSystem(Settings *s) {
  * Define options for initialization.
  */
 void SimulationGenerator::DefineOptions_Initializer(Settings *s) {
+    s->DefineSetting(INITIALIZATION "/conservative", "If true, radial profiles are remapped conservatively (instead of being interpolated linearly) when initializing from output on a different radial grid.", (bool)false);
+    s->DefineSetting(INITIALIZATION "/continuation_factor", "Factor by which to coarsen the grids when solving the first time steps on coarse grids.", (int_t)2);
+    s->DefineSetting(INITIALIZATION "/continuation_nt", "Number of time steps to solve on coarse grids before initializing the simulation from the coarse solution (0 = disabled).", (int_t)0);
     s->DefineSetting(INITIALIZATION "/eqsysignore", "List of unknown quantities to NOT initialize from output file.", (const string)"");
     s->DefineSetting(INITIALIZATION "/filetimeindex", "Time index to take initialization data for from output file.", (int_t)-1);
     s->DefineSetting(INITIALIZATION "/fromfile", "Name of DREAM output file from which simulation should be initialized.", (const string)"");
+    s->DefineSetting(INITIALIZATION "/nthreads", "Number of threads to use for initializing independent unknown quantities.", (int_t)1);
+    s->DefineSetting(INITIALIZATION "/printtimings", "Whether or not to print the time spent on initializing each unknown quantity.", (bool)false);
     s->DefineSetting(INITIALIZATION "/t0", "Simulation at which to initialize the simulation.", (real_t)0.0);
 
 	s->DefineSetting(INITIALIZATION "/solver_maxiter", "Maximum number of iterations for non-linear steady-state solver.", (int_t)100);
+	s->DefineSetting(INITIALIZATION "/solver_pseudotransient", "Whether or not to use pseudo-transient continuation in the non-linear steady-state solver.", (bool)false);
 	s->DefineSetting(INITIALIZATION "/solver_reltol", "Relative tolerance used for non-linear steady-state solver.", (real_t)1e-6);
 	s->DefineSetting(INITIALIZATION "/solver_verbose", "Whether or not to print convergence information for non-linear steady-state solver.", (bool)false);
 	s->DefineSetting(INITIALIZATION "/solver_linear", "Primary linear solver to use.", (int_t)OptionConstants::LINEAR_SOLVER_LU);
@@ -59,6 +71,9 @@ void SimulationGenerator::DefineOptions_Initializer(Settings *s) {
  * runawayGrid: Grid on which the runaway electron population
  *              is computed.
  *
+ * timings:     If not 'nullptr', on return contains the time spent
+ *              constructing the various parts of the equation system.
+ *
  * NOTE: The 'hottailGrid' and 'runawayGrid' will be 'nullptr'
  *       if disabled.
  */
@@ -66,31 +81,100 @@ EquationSystem *SimulationGenerator::ConstructEquationSystem(
     Settings *s, FVM::Grid *scalarGrid, FVM::Grid *fluidGrid,
     enum OptionConstants::momentumgrid_type ht_type, FVM::Grid *hottailGrid,
     enum OptionConstants::momentumgrid_type re_type, FVM::Grid *runawayGrid,
-    ADAS *adas, NIST *nist, AMJUEL *amjuel
+    ADAS *adas, NIST *nist, AMJUEL *amjuel, struct construction_timings *timings
 ) {
+    struct construction_timings localTimings;
+    if (timings == nullptr)
+        timings = &localTimings;
+
     EquationSystem *eqsys = new EquationSystem(scalarGrid, fluidGrid, ht_type, hottailGrid, re_type, runawayGrid, s);
     struct OtherQuantityHandler::eqn_terms *oqty_terms = new OtherQuantityHandler::eqn_terms;
 
     // Timing information
-    eqsys->SetTiming(s->GetBool("/output/timingstdout"), s->GetBool("/output/timingfile"));
+    const bool trace = s->GetBool("/output/trace");
+    const int_t traceMaxEvents = s->GetInteger("/output/tracemaxevents");
+    if (traceMaxEvents < 0)
+        throw SettingsException(
+            "output: Invalid maximum number of trace events: " INT_T_PRINTF_FMT ".",
+            traceMaxEvents
+        );
+
+    const bool termTimings = s->GetBool("/output/termtimings");
+    const bool memory = s->GetBool("/output/memory");
+    const bool perfCounters = s->GetBool("/output/perfcounters");
+    const bool petscLog = s->GetBool("/output/petsclog");
+
+    // (the trace summary, term timings, memory usage, hardware
+    // counters and PETSc log are stored with the timing information)
+    eqsys->SetTiming(
+        s->GetBool("/output/timingstdout"),
+        s->GetBool("/output/timingfile") || trace || termTimings || memory || perfCounters || petscLog
+    );
+    eqsys->SetTraceFile(s->GetString("/output/tracefile"));
+    FVM::Tracer::Configure(trace, (len_t)traceMaxEvents);
+    FVM::TermTimings::Configure(termTimings);
+    FVM::MemoryAccounting::Configure(memory);
+    FVM::PetscLog::Configure(petscLog);
+    if (!FVM::PerfCounters::Configure(perfCounters))
+        DREAM::IO::PrintWarning(
+            "Hardware performance counters are not available on this system "
+            "(check '/proc/sys/kernel/perf_event_paranoid'). Counters will not be recorded."
+        );
+
+    // Checkpoints
+    const int_t checkpointSteps = s->GetInteger("/output/checkpointsteps");
+    const real_t checkpointInterval = s->GetReal("/output/checkpointinterval");
+    if (checkpointSteps < 0)
+        throw SettingsException(
+            "output: Invalid number of saved steps between checkpoints: " INT_T_PRINTF_FMT ".",
+            checkpointSteps
+        );
+    else if (checkpointInterval < 0)
+        throw SettingsException(
+            "output: Invalid time between checkpoints: %e.", checkpointInterval
+        );
+
+    // (if neither limit is set, a checkpoint is written after every saved step)
+    eqsys->SetCheckpoint(
+        s->GetString("/output/checkpoint"),
+        (checkpointSteps == 0 && checkpointInterval == 0) ? 1 : (len_t)checkpointSteps,
+        checkpointInterval
+    );
+
+    // Status file
+    const real_t statusInterval = s->GetReal("/output/statusinterval");
+    if (statusInterval < 0)
+        throw SettingsException(
+            "output: Invalid time between status file updates: %e.", statusInterval
+        );
+
+    eqsys->SetStatusFile(s->GetString("/output/statusfile"), statusInterval);
 
     // Initialize from previous simulation output?
+    timings->initializer.Start();
     const real_t t0 = ConstructInitializer(eqsys, s);
+    timings->initializer.Stop();
 
     // Construct unknowns
+    timings->unknowns.Start();
     ConstructUnknowns(eqsys, s, scalarGrid, fluidGrid, hottailGrid, runawayGrid);
+    timings->unknowns.Stop();
 
 
     // Construct equations according to settings
-    ConstructEquations(eqsys, s, adas, nist, amjuel, oqty_terms);
+    ConstructEquations(eqsys, s, adas, nist, amjuel, oqty_terms, timings);
 
     // Construct the "other" quantity handler
+    timings->otherQuantities.Start();
     ConstructOtherQuantityHandler(eqsys, s, oqty_terms);
+    timings->otherQuantities.Stop();
 
     // Figure out which unknowns must be part of the matrix,
     // and set initial values for those quantities which don't
     // yet have an initial value.
+    timings->processSystem.Start();
     eqsys->ProcessSystem(t0);
+    timings->processSystem.Stop();
 
     // (these must be initialized AFTER calling 'ProcessSystem()' on
     // the equation system, since we need to which unknowns are
@@ -98,12 +182,16 @@ EquationSystem *SimulationGenerator::ConstructEquationSystem(
     // in order to build them)
     
     // Construct the time stepper
+    timings->timeStepper.Start();
     ConstructTimeStepper(eqsys, s);
+    timings->timeStepper.Stop();
 
     // Construct solver (must be done after processing equation system,
     // since we need to know which unknowns are "non-trivial",
     // i.e. need to show up in the solver matrices)
+    timings->solver.Start();
     ConstructSolver(eqsys, s);
+    timings->solver.Stop();
 
     return eqsys;
 }
@@ -117,13 +205,15 @@ EquationSystem *SimulationGenerator::ConstructEquationSystem(
  * adas:  ADAS database object.
  * nist:  NIST database object.
  * amjuel: AMJUEL database object.
+ * oqty_terms: Equation terms tracked by the "other" quantity handler.
+ * timings: Timers for the various parts of the equation system.
  *
  * NOTE: The 'hottailGrid' and 'runawayGrid' will be 'nullptr'
  *       if disabled.
  */
 void SimulationGenerator::ConstructEquations(
     EquationSystem *eqsys, Settings *s, ADAS *adas, NIST *nist, AMJUEL *amjuel,
-    struct OtherQuantityHandler::eqn_terms *oqty_terms
+    struct OtherQuantityHandler::eqn_terms *oqty_terms, struct construction_timings *timings
 ) {
     FVM::Grid *hottailGrid = eqsys->GetHotTailGrid();
     FVM::Grid *runawayGrid = eqsys->GetRunawayGrid();
@@ -138,21 +228,44 @@ void SimulationGenerator::ConstructEquations(
         eqsys->SetSPIHandler(SPI);
     }
     
+    // The ADAS rates at (n_cold, T_cold) are needed by several of the
+    // ion and energy balance terms, and are only evaluated once per
+    // rebuild and shared between those terms
+    eqsys->SetADASRateCache(new ADASRateCache(adas, fluidGrid->GetRadialGrid(), unknowns));
+
     // Fluid equations
+    timings->ions.Start();
     ConstructEquation_Ions(eqsys, s, adas, amjuel);
+    timings->ions.Stop();
 
 
     IonHandler *ionHandler = eqsys->GetIonHandler();
+    // The radial Coulomb logarithms are the same on all grids, and
+    // are evaluated only once and shared between the collision handlers
+    CoulombLogarithmCache *lnLambdaCache = new CoulombLogarithmCache(fluidGrid->GetRadialGrid(), unknowns, ionHandler);
+    eqsys->SetCoulombLogarithmCache(lnLambdaCache);
+    // Likewise for the ion densities and temperature-dependent
+    // parameters of the collision frequencies
+    CollisionFrequencyCache *collFreqCache = new CollisionFrequencyCache(fluidGrid->GetRadialGrid(), unknowns, ionHandler);
+    eqsys->SetCollisionFrequencyCache(collFreqCache);
+
     // Construct collision quantity handlers
+    timings->collisions.Start();
     if (hottailGrid != nullptr) {
-        CollisionQuantityHandler *cqh = ConstructCollisionQuantityHandler(ht_type, hottailGrid, unknowns, ionHandler, s);
+        CollisionQuantityHandler *cqh = ConstructCollisionQuantityHandler(ht_type, hottailGrid, unknowns, ionHandler, s, lnLambdaCache, collFreqCache);
         eqsys->SetHotTailCollisionHandler(cqh);
     }
 	if (runawayGrid != nullptr) {
-        CollisionQuantityHandler *cqh = ConstructCollisionQuantityHandler(re_type, runawayGrid, unknowns, ionHandler, s);
+        CollisionQuantityHandler *cqh = ConstructCollisionQuantityHandler(re_type, runawayGrid, unknowns, ionHandler, s, lnLambdaCache, collFreqCache);
         eqsys->SetRunawayCollisionHandler(cqh);
     }
+    timings->collisions.Stop();
+
+    timings->runawayFluid.Start();
     ConstructRunawayFluid(fluidGrid,unknowns,ionHandler,re_type,eqsys,s);
+    timings->runawayFluid.Stop();
+
+    timings->equations.Start();
 
     // Post processing handler
     FVM::MomentQuantity::pThresholdMode pMode = FVM::MomentQuantity::P_THRESHOLD_MODE_MIN_THERMAL;
@@ -223,6 +336,7 @@ void SimulationGenerator::ConstructEquations(
         ConstructEquation_tau_coll(eqsys);
     }
 
+    timings->equations.Stop();
 }
 
 /**
@@ -244,16 +358,35 @@ real_t SimulationGenerator::ConstructInitializer(
         vector<string> ignoreList = s->GetStringList(INITIALIZATION "/eqsysignore");
         eqsys->SetInitializerFile(filename, ignoreList, timeIndex);
     }
+    eqsys->initializer->SetConservativeRemap(s->GetBool(INITIALIZATION "/conservative"));
 
 	len_t maxiter = (len_t)s->GetInteger(INITIALIZATION "/solver_maxiter");
 	real_t reltol = s->GetReal(INITIALIZATION "/solver_reltol");
 	bool verbose  = s->GetBool(INITIALIZATION "/solver_verbose");
+	bool ptc      = s->GetBool(INITIALIZATION "/solver_pseudotransient");
 	enum OptionConstants::linear_solver linear_solver =
 		(enum OptionConstants::linear_solver)s->GetInteger(INITIALIZATION "/solver_linear");
 	enum OptionConstants::linear_solver backup_solver =
 		(enum OptionConstants::linear_solver)s->GetInteger(INITIALIZATION "/solver_backup");
 
-	eqsys->SetInitializerSolver(maxiter, reltol, linear_solver, backup_solver, verbose);
+	eqsys->SetInitializerSolver(maxiter, reltol, linear_solver, backup_solver, verbose, ptc);
+
+    int_t nthreads = s->GetInteger(INITIALIZATION "/nthreads");
+    if (nthreads < 1)
+        throw SettingsException(
+            "init: Invalid number of threads specified: " INT_T_PRINTF_FMT ". "
+            "The number of threads must be at least 1.", nthreads
+        );
+#ifndef _OPENMP
+    if (nthreads > 1) {
+        DREAM::IO::PrintWarning(
+            "DREAM was compiled without OpenMP support. Setting 'init/nthreads' has no effect."
+        );
+        nthreads = 1;
+    }
+#endif
+    eqsys->initializer->SetNumberOfThreads((len_t)nthreads);
+    eqsys->initializer->SetPrintTimings(s->GetBool(INITIALIZATION "/printtimings"));
 
     return t0;
 }
@@ -134,7 +134,8 @@ void SimulationGenerator::ConstructEquation_T_cold_selfconsistent(
         opacity_mode[i] = (enum OptionConstants::ion_opacity_mode)iopacity_modes[i];
         
     oqty_terms->T_cold_radiation = new RadiatedPowerTerm(
-        fluidGrid,unknowns,ionHandler,adas,nist,amjuel,opacity_mode,withRecombinationRadiation
+        fluidGrid,unknowns,ionHandler,adas,nist,amjuel,opacity_mode,withRecombinationRadiation,
+        eqsys->GetADASRateCache()
     );
     Op3->AddTerm(oqty_terms->T_cold_radiation);
 
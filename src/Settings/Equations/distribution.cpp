@@ -82,6 +82,7 @@ void SimulationGenerator::DefineOptions_f_general(Settings *s, const string& mod
  * diffusive_bc:      Pointer to an object in which to store the diffusive transport boundary condition (if enabled).
  * ripple_Dxx:        Pointer to an object in which to store the ripple pitch scattering term (if enabled).
  * rescaleMaxwellian: If true, rescales the initial distribution function so that it is consistent with the initial density.
+ * external_bc:       Pointer to an object in which to store the external boundary condition (if enabled).
  */
 FVM::Operator *SimulationGenerator::ConstructEquation_f_general(
     Settings *s, const string& mod, EquationSystem *eqsys,
@@ -89,7 +90,8 @@ FVM::Operator *SimulationGenerator::ConstructEquation_f_general(
     CollisionQuantityHandler *cqty, bool addExternalBC, bool addInternalBC,
     FVM::Operator **transport,
     TransportAdvectiveBC **advective_bc, TransportDiffusiveBC **diffusive_bc,
-    RipplePitchScattering **ripple_Dxx, bool rescaleMaxwellian
+    RipplePitchScattering **ripple_Dxx, bool rescaleMaxwellian,
+    FVM::BC::PXiExternalLoss **external_bc
 ) {
     FVM::Operator *eqn = new FVM::Operator(grid);
 
@@ -186,10 +188,14 @@ FVM::Operator *SimulationGenerator::ConstructEquation_f_general(
 		enum FVM::BC::PXiExternalLoss::bc_type bc =
 			(enum FVM::BC::PXiExternalLoss::bc_type)s->GetInteger(mod + "/boundarycondition");
 
-		eqn->AddBoundaryCondition(new FVM::BC::PXiExternalLoss(
+		FVM::BC::PXiExternalLoss *pxiloss = new FVM::BC::PXiExternalLoss(
 			grid, eqn, id_f, nullptr,
 			FVM::BC::PXiExternalLoss::BOUNDARY_KINETIC, bc
-		));
+		);
+		eqn->AddBoundaryCondition(pxiloss);
+
+        if (external_bc != nullptr)
+            *external_bc = pxiloss;
 	}
 
     // Set interpolation scheme for advection term
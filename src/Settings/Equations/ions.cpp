@@ -285,7 +285,8 @@ void SimulationGenerator::ConstructEquation_Ions(EquationSystem *eqsys, Settings
                 }else{
 		            eqn->AddTerm(new IonRateEquation(
 		                fluidGrid, ih, iZ, adas, eqsys->GetUnknownHandler(),
-		                addFluidIonization, addFluidJacobian, false
+		                addFluidIonization, addFluidJacobian, false,
+		                eqsys->GetADASRateCache()
 		            ));
                 }
                 if(includeKineticIonization){
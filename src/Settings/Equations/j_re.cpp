@@ -28,6 +28,7 @@ class RunawayFluidCurrentTerm : public FVM::DiagonalLinearTerm {
         len_t id_Efield;
         FVM::UnknownQuantityHandler *unknowns;
         virtual bool TermDependsOnUnknowns() override {return true;}
+        virtual bool IsJacobianConstant() const override { return false; }
         virtual void SetWeights() override{
             const real_t *Efield = unknowns->GetUnknownData(id_Efield);
             const real_t *FSA_B = this->grid->GetRadialGrid()->GetFSA_B();
@@ -35,6 +35,14 @@ void SimulationGenerator::DefineOptions_n_re(
     s->DefineSetting(MODULENAME "/pCutAvalanche", "Minimum momentum to which the avalanche source is applied", (real_t) 0.0);
     s->DefineSetting(MODULENAME "/dreicer", "Model to use for Dreicer generation.", (int_t)OptionConstants::EQTERM_DREICER_MODE_NONE);
     s->DefineSetting(MODULENAME "/Eceff", "Model to use for calculation of the effective critical field.", (int_t)OptionConstants::COLLQTY_ECEFF_MODE_FULL);
+
+    // Optional table of precomputed Eceff/Ectot
+    const len_t dims[3] = {0,0,0};
+    s->DefineSetting(MODULENAME "/Eceff_table/Zeff", "Effective charge grid of the Eceff table.", 0, (real_t*)nullptr);
+    s->DefineSetting(MODULENAME "/Eceff_table/T", "Temperature grid (eV) of the Eceff table.", 0, (real_t*)nullptr);
+    s->DefineSetting(MODULENAME "/Eceff_table/EceffOverEctot", "Tabulated Eceff/Ectot (nr x nZeff x nT).", 3, dims, (real_t*)nullptr);
+    s->DefineSetting(MODULENAME "/Eceff_table/error", "Estimated relative error of the tabulated Eceff/Ectot (nr x nZeff x nT).", 3, dims, (real_t*)nullptr);
+    s->DefineSetting(MODULENAME "/Eceff_table/tolerance", "Largest estimated relative error of the tabulated Eceff accepted.", (real_t)1e-2);
     s->DefineSetting(MODULENAME "/negative_re", "When in kinetic mode, properly account for runaways in both positive and negative pitch directions.", (bool)false);
 
     s->DefineSetting(MODULENAME "/adv_interp/r", "Type of interpolation method to use in r-component of advection term of kinetic equation.", (int_t)FVM::AdvectionInterpolationCoefficient::AD_INTERP_CENTRED);
@@ -3,17 +3,22 @@
  * grids.
  */
 
+#include <algorithm>
 #include <string>
+#include <vector>
+#include "DREAM/Constants.hpp"
 #include "DREAM/IO.hpp"
 #include "DREAM/Settings/SimulationGenerator.hpp"
 #include "FVM/Grid/PXiGrid/PXiMomentumGrid.hpp"
 #include "FVM/Grid/PXiGrid/PXiMomentumGridGenerator.hpp"
+#include "FVM/Grid/PXiGrid/PAdaptiveGridGenerator.hpp"
 #include "FVM/Grid/PXiGrid/PBiUniformGridGenerator.hpp"
 #include "FVM/Grid/PXiGrid/PCustomGridGenerator.hpp"
 #include "FVM/Grid/PXiGrid/PUniformGridGenerator.hpp"
 #include "FVM/Grid/PXiGrid/XiCustomGridGenerator.hpp"
 #include "FVM/Grid/PXiGrid/XiBiUniformGridGenerator.hpp"
 #include "FVM/Grid/PXiGrid/XiBiUniformThetaGridGenerator.hpp"
+#include "FVM/Grid/PXiGrid/XiGaussLegendreNodeGridGenerator.hpp"
 #include "FVM/Grid/PXiGrid/XiUniformGridGenerator.hpp"
 #include "FVM/Grid/PXiGrid/XiUniformThetaGridGenerator.hpp"
 #include "FVM/Grid/PXiGrid/XiTrappedPassingBoundaryLayerGridGenerator.hpp"
@@ -51,6 +56,10 @@ void SimulationGenerator::DefineOptions_KineticGrid(const string& mod, Settings
     s->DefineSetting(mod + "/npsep", "Number of distribution grid points for pmin<p<psep", (int_t)0);
     s->DefineSetting(mod + "/npsep_frac", "Fraction of distribution grid points for pmin<p<psep", (real_t)0.0);
     s->DefineSetting(mod + "/psep", "Separating momentum on the biuniform (flux) grid", (real_t)0.0);
+
+    // adaptive p grid
+    s->DefineSetting(mod + "/tref", "Temperature (eV) of the distribution to adapt the momentum grid to", (real_t)0.0);
+    s->DefineSetting(mod + "/dpratio", "Ratio between the largest and smallest cell of the adaptive momentum grid", (real_t)10.0);
     
     // nonuniform xi grid
     s->DefineSetting(mod + "/nxisep", "Number of distribution grid points for xisep<xi<1", (int_t)0);
@@ -66,6 +75,10 @@ void SimulationGenerator::DefineOptions_KineticGrid(const string& mod, Settings
    s->DefineSetting(mod + "/nxipass", "Number of grid points between xi0Trapped_max and +1", (int_t)1);
    s->DefineSetting(mod + "/nxitrap", "Number of grid points between 0 and xi0Trapped_min", (int_t)1);
    s->DefineSetting(mod + "/boundarylayerwidth", "Width of the grid cell containing each trapped-passing boundary (typically << 1)", (real_t)1e-3);
+
+    // radially varying pitch resolution
+    s->DefineSetting(mod + "/radialzones/r", "Radii separating the radial zones with different pitch resolution", 0, (real_t*)nullptr);
+    s->DefineSetting(mod + "/radialzones/nxi", "Number of distribution grid points in xi in each radial zone", 0, (int_t*)nullptr);
 }
 
 /**
@@ -111,10 +124,10 @@ FVM::Grid *SimulationGenerator::ConstructHotTailGrid(
 
     *type = (enum OptionConstants::momentumgrid_type)s->GetInteger(HOTTAILGRID "/type");
 
-    FVM::MomentumGrid *mg;
+    FVM::Grid *grid;
     switch (*type) {
         case OptionConstants::MOMENTUMGRID_TYPE_PXI:
-            mg = Construct_PXiGrid(s, HOTTAILGRID, 0.0, rgrid);
+            grid = Construct_PXiKineticGrid(s, HOTTAILGRID, 0.0, rgrid);
             break;
 
         // XXX WARNING: The runaway grid assumes that the first coordinate
@@ -127,7 +140,7 @@ FVM::Grid *SimulationGenerator::ConstructHotTailGrid(
             );
     }
 
-    return new FVM::Grid(rgrid, mg);
+    return grid;
 }
 
 /**
@@ -153,7 +166,7 @@ FVM::Grid *SimulationGenerator::ConstructRunawayGrid(
 
     *type = (enum OptionConstants::momentumgrid_type)s->GetInteger(RUNAWAYGRID "/type");
 
-    FVM::MomentumGrid *mg;
+    FVM::Grid *grid;
     real_t pmin;
     switch (*type) {
         case OptionConstants::MOMENTUMGRID_TYPE_PXI:
@@ -163,7 +176,7 @@ FVM::Grid *SimulationGenerator::ConstructRunawayGrid(
                 pmin = hottailGrid->GetMomentumGrid(0)->GetP1_f(
                     hottailGrid->GetMomentumGrid(0)->GetNp1()
                 );
-            mg = Construct_PXiGrid(s, RUNAWAYGRID, pmin, rgrid);
+            grid = Construct_PXiKineticGrid(s, RUNAWAYGRID, pmin, rgrid);
             break;
 
         default:
@@ -173,7 +186,97 @@ FVM::Grid *SimulationGenerator::ConstructRunawayGrid(
             );
     }
 
-    return new FVM::Grid(rgrid, mg);
+    return grid;
+}
+
+/**
+ * Construct a kinetic grid with p/xi momentum grids. If radial
+ * zones have been specified (via 'radialzones/r'), the pitch
+ * resolution is set separately in each zone (via 'radialzones/nxi'),
+ * while all zones share the same p grid. Zone 'k' contains the radii
+ * r with  radialzones/r[k-1] <= r < radialzones/r[k].
+ *
+ * s:     Settings object specifying how to construct the grid.
+ * mod:   Name of the module to load settings from.
+ * pmin:  Minimum momentum value on (flux) grid.
+ * rgrid: Radial grid to use for defining the kinetic grid.
+ */
+FVM::Grid *SimulationGenerator::Construct_PXiKineticGrid(
+    Settings *s, const string& mod, const real_t pmin,
+    FVM::RadialGrid *rgrid
+) {
+    len_t nzr, nznxi;
+    const real_t *zr = s->GetRealArray(mod + "/radialzones/r", 1, &nzr, false);
+    const int_t *znxi = s->GetIntegerArray(mod + "/radialzones/nxi", 1, &nznxi, false);
+
+    if (nzr == 0) {
+        if (nznxi > 0)
+            throw SettingsException(
+                "%s: 'radialzones/nxi' given without specifying the zone boundaries 'radialzones/r'.",
+                mod.c_str()
+            );
+
+        return new FVM::Grid(rgrid, Construct_PXiGrid(s, mod, pmin, rgrid));
+    }
+
+    s->MarkUsed(mod + "/radialzones/r");
+    s->MarkUsed(mod + "/radialzones/nxi");
+
+    if (nznxi != nzr+1)
+        throw SettingsException(
+            "%s: Expected 'radialzones/nxi' to have " LEN_T_PRINTF_FMT " elements "
+            "(one more than 'radialzones/r'), but it has " LEN_T_PRINTF_FMT ".",
+            mod.c_str(), nzr+1, nznxi
+        );
+
+    for (len_t k = 1; k < nzr; k++)
+        if (zr[k] <= zr[k-1])
+            throw SettingsException(
+                "%s: The radial zone boundaries 'radialzones/r' must be strictly increasing.",
+                mod.c_str()
+            );
+
+    // The number of pitch cells must be a free parameter of the
+    // pitch grid, and the collision quantities assume p-xi grids
+    // in all zones (i.e. nxi > 1)
+    enum OptionConstants::pxigrid_xitype xigrid = (enum OptionConstants::pxigrid_xitype)s->GetInteger(mod+"/xigrid");
+    if (xigrid != OptionConstants::PXIGRID_XITYPE_UNIFORM &&
+        xigrid != OptionConstants::PXIGRID_XITYPE_UNIFORM_THETA &&
+        xigrid != OptionConstants::PXIGRID_XITYPE_GAUSS_LEGENDRE_NODES)
+        throw SettingsException(
+            "%s: Radial zones are only supported with uniform (in xi or theta) "
+            "or Gauss-Legendre node pitch grids.",
+            mod.c_str()
+        );
+
+    for (len_t k = 0; k < nznxi; k++)
+        if (znxi[k] < 2)
+            throw SettingsException(
+                "%s: The number of pitch grid points in each radial zone must be at least 2.",
+                mod.c_str()
+            );
+
+    // Construct one momentum grid per zone
+    vector<FVM::MomentumGrid*> zoneGrids(nznxi);
+    for (len_t k = 0; k < nznxi; k++)
+        zoneGrids[k] = Construct_PXiGrid(s, mod, pmin, rgrid, znxi[k]);
+
+    const len_t nr = rgrid->GetNr();
+    const real_t *r = rgrid->GetR();
+    vector<FVM::MomentumGrid*> mgs(nr);
+    for (len_t ir = 0; ir < nr; ir++) {
+        len_t k = 0;
+        while (k < nzr && r[ir] >= zr[k])
+            k++;
+        mgs[ir] = zoneGrids[k];
+    }
+
+    // Delete grids of empty zones (which are not owned by the grid)
+    for (len_t k = 0; k < nznxi; k++)
+        if (find(mgs.begin(), mgs.end(), zoneGrids[k]) == mgs.end())
+            delete zoneGrids[k];
+
+    return new FVM::Grid(rgrid, mgs.data());
 }
 
 /**
@@ -182,13 +285,18 @@ FVM::Grid *SimulationGenerator::ConstructRunawayGrid(
  * s:    Settings object specifying how to construct the grid.
  * mod:  Name of the module to load settings from.
  * pmin: Minimum momentum value on (flux) grid.
+ * nxi:  If non-negative, number of xi grid points to use instead
+ *       of the value of the 'nxi' setting.
  */
 FVM::PXiGrid::PXiMomentumGrid *SimulationGenerator::Construct_PXiGrid(
     Settings *s, const string& mod, const real_t pmin,
-    FVM::RadialGrid *rgrid
+    FVM::RadialGrid *rgrid, int_t nxi
 ) {
     int_t  np   = s->GetInteger(mod + "/np");
-    int_t  nxi  = s->GetInteger(mod + "/nxi");
+    if (nxi < 0)
+        nxi = s->GetInteger(mod + "/nxi");
+    else
+        s->MarkUsed(mod + "/nxi");
     real_t pmax = s->GetReal(mod + "/pmax");
 
     enum OptionConstants::pxigrid_ptype pgrid   = (enum OptionConstants::pxigrid_ptype)s->GetInteger(mod+"/pgrid");
@@ -243,6 +351,16 @@ FVM::PXiGrid::PXiMomentumGrid *SimulationGenerator::Construct_PXiGrid(
                 pgg = new FVM::PXiGrid::PCustomGridGenerator(p_f, len_pf-1);
         } break;
 
+        case OptionConstants::PXIGRID_PTYPE_ADAPTIVE: {
+            real_t Tref = s->GetReal(mod + "/tref");
+            real_t dpRatio = s->GetReal(mod + "/dpratio");
+
+            if (Tref <= 0)
+                throw SettingsException("%s: The reference temperature 'tref' of the adaptive momentum grid must be positive.", mod.c_str());
+
+            pgg = new FVM::PXiGrid::PAdaptiveGridGenerator(np, pmin, pmax, Tref/Constants::mc2inEV, dpRatio);
+        } break;
+
         default:
             throw SettingsException(
                 "%s: Unrecognized P grid type specified: %d.",
@@ -305,6 +423,10 @@ FVM::PXiGrid::PXiMomentumGrid *SimulationGenerator::Construct_PXiGrid(
             xgg = new FVM::PXiGrid::XiTrappedPassingBoundaryLayerGridGenerator(dxiMax, nxiPass, nxiTrap, width);
         } break;
 
+        case OptionConstants::PXIGRID_XITYPE_GAUSS_LEGENDRE_NODES:
+            xgg = new FVM::PXiGrid::XiGaussLegendreNodeGridGenerator(nxi);
+            break;
+
         default:
             throw SettingsException(
                 "%s: Unrecognized XI grid type specified: %d.",
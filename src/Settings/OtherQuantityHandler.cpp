@@ -21,7 +21,12 @@ using namespace std;
  * Define all options available for the 'OtherQuantityHandler'.
  */
 void SimulationGenerator::DefineOptions_OtherQuantities(Settings *s) {
+    s->DefineSetting(MODULENAME "/decimation_every", "Store the corresponding quantity on every N'th save step", 0, (int_t*)nullptr);
+    s->DefineSetting(MODULENAME "/decimation_names", "List of names of other quantities (or groups) with a custom output cadence", (const string)"");
+    s->DefineSetting(MODULENAME "/decimation_tmax", "Latest time at which to store the corresponding quantity", 0, (real_t*)nullptr);
+    s->DefineSetting(MODULENAME "/decimation_tmin", "Earliest time at which to store the corresponding quantity", 0, (real_t*)nullptr);
     s->DefineSetting(MODULENAME "/include", "List of names of other quantities to include", (const string)"");
+    s->DefineSetting(MODULENAME "/legendre_nmodes", "Number of Legendre modes to store in the 'f_legendre' quantities", (int_t)4);
 }
 
 /**
@@ -31,12 +36,19 @@ void SimulationGenerator::ConstructOtherQuantityHandler(
     EquationSystem *eqsys, Settings *s,
     struct OtherQuantityHandler::eqn_terms *oqty_terms
 ) {
+    const int_t nLegendreModes = s->GetInteger(MODULENAME "/legendre_nmodes");
+    if (nLegendreModes < 1)
+        throw SettingsException(
+            "other: Invalid number of Legendre modes: " INT_T_PRINTF_FMT ". "
+            "At least one mode must be stored.", nLegendreModes
+        );
+
     OtherQuantityHandler *oqh = new OtherQuantityHandler(
         eqsys->GetHotTailCollisionHandler(), eqsys->GetRunawayCollisionHandler(),
         eqsys->GetPostProcessor(), eqsys->GetREFluid(), eqsys->GetUnknownHandler(),
         eqsys->GetEquations(), eqsys->GetIonHandler(), eqsys->GetFluidGrid(),
         eqsys->GetHotTailGrid(), eqsys->GetRunawayGrid(), eqsys->GetScalarGrid(),
-        oqty_terms
+        oqty_terms, (len_t)nLegendreModes
     );
 
     const vector<string> other = s->GetStringList(MODULENAME "/include");
@@ -48,6 +60,51 @@ void SimulationGenerator::ConstructOtherQuantityHandler(
             oqh->RegisterQuantity(*it);
     }
 
+    ConstructOtherQuantityCadence(oqh, s);
+
+    // The definitions of quantities which are not stored
+    // are not needed anymore
+    oqh->ReleaseUnregistered();
+
     eqsys->SetOtherQuantityHandler(oqh);
 }
 
+
+/**
+ * Apply the custom output cadences (if any) specified for
+ * the other quantities.
+ */
+void SimulationGenerator::ConstructOtherQuantityCadence(
+    OtherQuantityHandler *oqh, Settings *s
+) {
+    const vector<string> names = s->GetStringList(MODULENAME "/decimation_names");
+
+    len_t nEvery, nTmin, nTmax;
+    const int_t *every = s->GetIntegerArray(MODULENAME "/decimation_every", 1, &nEvery);
+    const real_t *tmin = s->GetRealArray(MODULENAME "/decimation_tmin", 1, &nTmin);
+    const real_t *tmax = s->GetRealArray(MODULENAME "/decimation_tmax", 1, &nTmax);
+
+    const len_t n = names.size();
+    if (nEvery != n || nTmin != n || nTmax != n)
+        throw SettingsException(
+            "other: Expected the decimation settings to have the same number of elements. "
+            "decimation_names: " LEN_T_PRINTF_FMT ", decimation_every: " LEN_T_PRINTF_FMT
+            ", decimation_tmin: " LEN_T_PRINTF_FMT ", decimation_tmax: " LEN_T_PRINTF_FMT ".",
+            n, nEvery, nTmin, nTmax
+        );
+
+    for (len_t i = 0; i < n; i++) {
+        if (every[i] < 1)
+            throw SettingsException(
+                "other: Invalid output cadence for '%s': " INT_T_PRINTF_FMT ". "
+                "The cadence must be at least 1.", names[i].c_str(), every[i]
+            );
+        else if (tmax[i] < tmin[i])
+            throw SettingsException(
+                "other: Invalid output time window for '%s': tmax < tmin.",
+                names[i].c_str()
+            );
+
+        oqh->SetCadence(names[i], (len_t)every[i], tmin[i], tmax[i]);
+    }
+}
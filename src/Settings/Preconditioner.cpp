@@ -19,6 +19,8 @@ using namespace std;
  */
 void SimulationGenerator::DefinePreconditionerSettings(Settings *s) {
     s->DefineSetting(MODULENAME "/enabled", "Enable physics-based preconditioning", (bool)true);
+    s->DefineSetting(MODULENAME "/equilibrate", "Refine the scalings by equilibrating the rows and columns of the matrix", (bool)false);
+    s->DefineSetting(MODULENAME "/equilibrate_every", "Number of iterations between each equilibration of the matrix", (int_t)1);
     s->DefineSetting(MODULENAME "/names", "Names of unknowns to override scales for.", (const string)"");
     s->DefineSetting(MODULENAME "/equation_scales", "List of equation scales to use.", 0, (real_t*)nullptr);
     s->DefineSetting(MODULENAME "/unknown_scales", "List of unknown scales to use.", 0, (real_t*)nullptr);
@@ -41,6 +43,15 @@ DiagonalPreconditioner *SimulationGenerator::LoadPreconditionerSettings(
     if (!enabled)
         return nullptr;
 
+    bool equilibrate = s->GetBool(MODULENAME "/equilibrate");
+    int_t equilibrateEvery = s->GetInteger(MODULENAME "/equilibrate_every");
+
+    if (equilibrateEvery <= 0)
+        throw SettingsException(
+            "DiagonalPreconditioner: Invalid value assigned to 'equilibrate_every': " INT_T_PRINTF_FMT ". "
+            "Value must be positive.", equilibrateEvery
+        );
+
     len_t neqn, nuqn;
 
     vector<string> uqtyNames = s->GetStringList(MODULENAME "/names");
@@ -73,6 +84,7 @@ DiagonalPreconditioner *SimulationGenerator::LoadPreconditionerSettings(
         dp->SetEquationScale(id, eqn_scales[i]);
         dp->SetUnknownScale(id, uqn_scales[i]);
     }
+    dp->SetEquilibration(equilibrate, (len_t)equilibrateEvery);
     dp->Build();
     return dp;
 }
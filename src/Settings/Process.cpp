@@ -2,14 +2,22 @@
  * Process settings and build a Simulation object.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <iostream>
+#include <vector>
 #include "DREAM/ADAS.hpp"
 #include "DREAM/AMJUEL.hpp"
 #include "DREAM/EquationSystem.hpp"
+#include "DREAM/IO.hpp"
 #include "DREAM/NIST.hpp"
+#include "DREAM/OutputGeneratorADIOS2.hpp"
 #include "DREAM/OutputGeneratorSFile.hpp"
+#include "DREAM/ResultCache.hpp"
 #include "DREAM/Settings/Settings.hpp"
 #include "DREAM/Settings/SimulationGenerator.hpp"
+#include "FVM/DurationTimer.hpp"
 #include "FVM/Grid/Grid.hpp"
 #include "FVM/Grid/RadialGrid.hpp"
 #include "FVM/Interpolator3D.hpp"
@@ -17,55 +25,635 @@
 
 using namespace DREAM;
 
+
+/**
+ * Returns 'true' if the named setting belongs to one of
+ * the modules describing the grids.
+ */
+static bool IsGridSetting(const std::string& name) {
+    const std::string n = (!name.empty() && name[0] == '/') ? name.substr(1) : name;
+    for (const char *mod : {"radialgrid/", "hottailgrid/", "runawaygrid/"})
+        if (n.compare(0, strlen(mod), mod) == 0)
+            return true;
+
+    return false;
+}
+
+/**
+ * Compute the key identifying the grids constructed from the given
+ * settings, by hashing the names, types and values of all grid
+ * settings (in alphabetical order).
+ */
+static uint64_t ComputeGridKey(Settings *s) {
+    const auto& settings = s->GetSettings();
+
+    std::vector<const Settings::setting_t*> sorted;
+    for (auto it = settings.begin(); it != settings.end(); it++)
+        if (IsGridSetting(it->first))
+            sorted.push_back(it->second);
+
+    std::sort(sorted.begin(), sorted.end(), [](const Settings::setting_t *a, const Settings::setting_t *b) {
+        return (a->name < b->name);
+    });
+
+    FVM::GeometryCache::Hash h;
+    for (const Settings::setting_t *st : sorted)
+        ResultCache::AddToHash(h, st);
+
+    return h.Get();
+}
+
+/**
+ * Returns 'true' if the given grid (which may be 'nullptr') is
+ * valid at time 't', i.e. if none of its radial and momentum grid
+ * generators would rebuild it.
+ */
+static bool IsGridCurrent(FVM::Grid *grid, const real_t t) {
+    if (grid == nullptr)
+        return true;
+    if (grid->GetRadialGrid()->NeedsRebuild(t))
+        return false;
+
+    for (len_t ir = 0; ir < grid->GetNr(); ir++)
+        if (grid->GetMomentumGrid(ir)->NeedsRebuild(t, false))
+            return false;
+
+    return true;
+}
+
 /**
  * Process the given settings and construct a
  * simulation object.
  *
- * s: Settings specifying how to construct the simulation.
+ * s:       Settings specifying how to construct the simulation.
+ * verbose: If true, prints a breakdown of the time spent
+ *          constructing the various parts of the simulation.
+ * adas:    ADAS database to use (if 'nullptr', a new database
+ *          is loaded according to the settings).
+ * nist:    NIST database to use (if 'nullptr', a new database
+ *          is loaded).
+ * amjuel:  AMJUEL database to use (if 'nullptr', a new database
+ *          is loaded).
+ * grids:   If not 'nullptr', grids to reuse if they were constructed
+ *          from identical grid settings. Otherwise, the grids of this
+ *          simulation are constructed and stored in 'grids' (which then
+ *          takes ownership of 's').
+ *
+ * Databases passed to this method are shared with the caller (and
+ * possibly other simulations) and are not deleted together with the
+ * simulation. The ADAS database must use the interpolation method
+ * requested in the settings.
+ *
+ * Reused grids are shared with the previous simulations which used
+ * them, and must therefore only be reused by simulations which run
+ * after those (grids are never modified by the equation system,
+ * other than when their generators rebuild them in time, in which
+ * case they are not reused).
  */
-Simulation *SimulationGenerator::ProcessSettings(Settings *s) {
+Simulation *SimulationGenerator::ProcessSettings(
+    Settings *s, bool verbose, ADAS *adas, NIST *nist, AMJUEL *amjuel,
+    struct shared_grids *grids
+) {
     const real_t t0 = 0;
-    // Construct grids
+    FVM::DurationTimer tGrids, tRadialGrid, tHottailGrid, tRunawayGrid, tDatabases, tEqsys, tOutput;
+    struct construction_timings tEqsysParts;
+
+    // Databases are only deleted with the simulation
+    // if they are loaded here
+    const bool sharedDatabases = (adas != nullptr || nist != nullptr || amjuel != nullptr);
+    if (sharedDatabases && (adas == nullptr || nist == nullptr || amjuel == nullptr))
+        throw SettingsException(
+            "ProcessSettings: Either all or none of the atomic databases must be given."
+        );
+
+    // Solve the first time steps on coarse grids (or on radial
+    // grids adapted to the solution) and initialize this
+    // simulation from the solution
+    const bool continuation = (s->GetInteger("init/continuation_nt") > 0);
+    const bool adaptation   = (s->GetInteger("radialgrid/adapt/nsegments") > 1);
+    if (continuation && adaptation)
+        throw SettingsException(
+            "Grid continuation cannot be combined with adaptation of the radial grid."
+        );
+
+    if (continuation || adaptation) {
+        if (!sharedDatabases) {
+            tDatabases.Start();
+            adas = LoadADAS(s);
+            nist = LoadNIST(s);
+            amjuel = LoadAMJUEL(s);
+            tDatabases.Stop();
+        }
+
+        if (continuation)
+            RunGridContinuation(s, verbose, adas, nist, amjuel);
+        else
+            RunRadialGridAdaptation(s, verbose, adas, nist, amjuel);
+    }
+
+    LoadLogging(s);
+    LoadNumberOfThreads(s);
+
+    // Construct grids (or reuse the grids of a previous
+    // simulation with identical grid settings)
+    tGrids.Start();
     enum OptionConstants::momentumgrid_type ht_type, re_type;
-    FVM::Grid *scalarGrid  = ConstructScalarGrid();
-    FVM::Grid *fluidGrid   = ConstructRadialGrid(s);
-    FVM::Grid *hottailGrid = ConstructHotTailGrid(s, fluidGrid->GetRadialGrid(), &ht_type);
-    
-    scalarGrid->Rebuild(t0);
-    fluidGrid->Rebuild(t0);
-    if (hottailGrid)
-        hottailGrid->Rebuild(t0);
-
-	// The runaway grid depends on the hot-tail grid (if it exists)
-    FVM::Grid *runawayGrid = ConstructRunawayGrid(s, fluidGrid->GetRadialGrid(), hottailGrid, &re_type);
-    if (runawayGrid)
-        runawayGrid->Rebuild(t0);
-
-    // Load ADAS database
-    ADAS *adas = LoadADAS(s);
-    // Load NIST database
-    NIST *nist = LoadNIST(s);
-    // Load AMJUEL database
-    AMJUEL *amjuel = LoadAMJUEL(s);
+    FVM::Grid *scalarGrid, *fluidGrid, *hottailGrid, *runawayGrid;
+
+    const uint64_t gridKey = (grids != nullptr ? ComputeGridKey(s) : 0);
+    const bool reuseGrids = (
+        grids != nullptr && grids->fluidGrid != nullptr && grids->key == gridKey &&
+        IsGridCurrent(grids->fluidGrid, t0) && IsGridCurrent(grids->hottailGrid, t0) &&
+        IsGridCurrent(grids->runawayGrid, t0)
+    );
+
+    if (reuseGrids) {
+        scalarGrid  = grids->scalarGrid;
+        fluidGrid   = grids->fluidGrid;
+        hottailGrid = grids->hottailGrid;
+        runawayGrid = grids->runawayGrid;
+        ht_type     = grids->ht_type;
+        re_type     = grids->re_type;
+
+        // (so that the grid settings are stored with the output)
+        for (const std::string& name : grids->used)
+            s->MarkUsed(name);
+    } else {
+        scalarGrid  = ConstructScalarGrid();
+
+        // Directory in which to cache geometric quantities
+        const std::string geometryCache = s->GetString("radialgrid/geometrycache");
+        
+        scalarGrid->Rebuild(t0);
+
+        tRadialGrid.Start();
+        fluidGrid   = ConstructRadialGrid(s);
+        fluidGrid->SetGeometryCacheDirectory(geometryCache);
+        fluidGrid->Rebuild(t0);
+        tRadialGrid.Stop();
+
+        tHottailGrid.Start();
+        hottailGrid = ConstructHotTailGrid(s, fluidGrid->GetRadialGrid(), &ht_type);
+        if (hottailGrid) {
+            hottailGrid->SetGeometryCacheDirectory(geometryCache);
+            hottailGrid->Rebuild(t0);
+        }
+        tHottailGrid.Stop();
+
+        // The runaway grid depends on the hot-tail grid (if it exists)
+        tRunawayGrid.Start();
+        runawayGrid = ConstructRunawayGrid(s, fluidGrid->GetRadialGrid(), hottailGrid, &re_type);
+        if (runawayGrid) {
+            runawayGrid->SetGeometryCacheDirectory(geometryCache);
+            runawayGrid->Rebuild(t0);
+        }
+        tRunawayGrid.Stop();
+
+        // Keep the grids for later simulations
+        if (grids != nullptr) {
+            if (grids->owner != nullptr && grids->owner != s)
+                delete grids->owner;
+
+            grids->key   = gridKey;
+            grids->owner = s;
+            grids->used.clear();
+            for (auto it : s->GetSettings())
+                if (it.second->used && IsGridSetting(it.first))
+                    grids->used.push_back(it.first);
+
+            grids->scalarGrid  = scalarGrid;
+            grids->fluidGrid   = fluidGrid;
+            grids->hottailGrid = hottailGrid;
+            grids->runawayGrid = runawayGrid;
+            grids->ht_type     = ht_type;
+            grids->re_type     = re_type;
+        }
+    }
+    tGrids.Stop();
+
+    tDatabases.Start();
+    if (adas == nullptr) {
+        // Load ADAS database
+        adas = LoadADAS(s);
+        // Load NIST database
+        nist = LoadNIST(s);
+        // Load AMJUEL database
+        amjuel = LoadAMJUEL(s);
+    }
+    tDatabases.Stop();
 
     // Construct equation system
+    tEqsys.Start();
     EquationSystem *eqsys = ConstructEquationSystem(
         s, scalarGrid, fluidGrid, ht_type, hottailGrid, re_type, runawayGrid,
-        adas, nist, amjuel
+        adas, nist, amjuel, &tEqsysParts
     );
+    tEqsys.Stop();
 
     // Set up simulation
     Simulation *sim = new Simulation();
     sim->SetADAS(adas);
     sim->SetNIST(nist);
     sim->SetAMJUEL(amjuel);
+    sim->SetOwnsAtomicData(!sharedDatabases);
     sim->SetEquationSystem(eqsys);
 
+    tOutput.Start();
     LoadOutput(s, sim);
+    tOutput.Stop();
+
+    if (verbose) {
+        DREAM::IO::PrintInfo("Simulation construction:");
+        if (reuseGrids)
+            DREAM::IO::PrintInfo("  Grids                %10.3f ms  (reused from previous simulation)", tGrids.GetMilliseconds());
+        else {
+            DREAM::IO::PrintInfo("  Grids                %10.3f ms", tGrids.GetMilliseconds());
+            DREAM::IO::PrintInfo("    Radial grid        %10.3f ms", tRadialGrid.GetMilliseconds());
+            if (hottailGrid)
+                DREAM::IO::PrintInfo("    Hot-tail grid      %10.3f ms", tHottailGrid.GetMilliseconds());
+            if (runawayGrid)
+                DREAM::IO::PrintInfo("    Runaway grid       %10.3f ms", tRunawayGrid.GetMilliseconds());
+        }
+        DREAM::IO::PrintInfo("  Atomic databases     %10.3f ms", tDatabases.GetMilliseconds());
+        DREAM::IO::PrintInfo(
+            "  Equation system      %10.3f ms  (incl. %.3f ms building ADAS interpolators for " LEN_T_PRINTF_FMT " elements)",
+            tEqsys.GetMilliseconds(), adas->GetBuildTime(), adas->GetNBuiltElements()
+        );
+        DREAM::IO::PrintInfo("    Initializer        %10.3f ms", tEqsysParts.initializer.GetMilliseconds());
+        DREAM::IO::PrintInfo("    Unknowns           %10.3f ms", tEqsysParts.unknowns.GetMilliseconds());
+        DREAM::IO::PrintInfo("    Ions               %10.3f ms", tEqsysParts.ions.GetMilliseconds());
+        DREAM::IO::PrintInfo("    Collision handlers %10.3f ms", tEqsysParts.collisions.GetMilliseconds());
+        DREAM::IO::PrintInfo("    Runaway fluid      %10.3f ms", tEqsysParts.runawayFluid.GetMilliseconds());
+        DREAM::IO::PrintInfo("    Other equations    %10.3f ms", tEqsysParts.equations.GetMilliseconds());
+        DREAM::IO::PrintInfo("    Other quantities   %10.3f ms", tEqsysParts.otherQuantities.GetMilliseconds());
+        DREAM::IO::PrintInfo("    Initial values     %10.3f ms", tEqsysParts.processSystem.GetMilliseconds());
+        DREAM::IO::PrintInfo("    Time stepper       %10.3f ms", tEqsysParts.timeStepper.GetMilliseconds());
+        DREAM::IO::PrintInfo("    Solver             %10.3f ms", tEqsysParts.solver.GetMilliseconds());
+        DREAM::IO::PrintInfo("  Output               %10.3f ms", tOutput.GetMilliseconds());
+    }
 
     return sim;
 }
 
+/**
+ * Divide the named grid resolution setting by the given factor
+ * (keeping at least one grid point), and store its original
+ * value in 'saved' so that it can later be restored.
+ */
+static void CoarsenResolution(
+    Settings *s, const std::string& name, const int_t factor,
+    std::vector<std::pair<std::string, int_t>>& saved
+) {
+    const int_t n = s->GetInteger(name, false);
+    saved.push_back({name, n});
+
+    if (n > 1)
+        s->SetSetting(name, std::max((int_t)1, n/factor));
+}
+
+/**
+ * Returns the given output file name with 'suffix' inserted
+ * before the file extension.
+ */
+static std::string InsertFilenameSuffix(const std::string& filename, const std::string& suffix) {
+    size_t dot = filename.find_last_of('.'), slash = filename.find_last_of('/');
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash))
+        return filename + suffix;
+    else
+        return filename.substr(0, dot) + suffix + filename.substr(dot);
+}
+
+/**
+ * Solve the first 'init/continuation_nt' time steps of the
+ * simulation on grids which are a factor 'init/continuation_factor'
+ * coarser than the grids of the simulation in every dimension, and
+ * modify the settings so that the simulation is initialized from
+ * the coarse solution instead. The coarse solution is prolongated
+ * onto the production grids by the regular initialization from
+ * output ('init/fromfile'), and the simulation continues from where
+ * the coarse simulation ended (with the time axis of the output
+ * restarting at zero, as when chaining simulations manually).
+ *
+ * Grids which are given explicitly (custom radial or momentum
+ * grids) are not coarsened. Only the constant time stepper is
+ * supported.
+ *
+ * s:       Settings of the simulation. On return, contains the
+ *          settings for continuing from the coarse solution.
+ * verbose: If true, prints a breakdown of the time spent
+ *          constructing the coarse simulation.
+ * adas:    ADAS database to use.
+ * nist:    NIST database to use.
+ * amjuel:  AMJUEL database to use.
+ */
+void SimulationGenerator::RunGridContinuation(
+    Settings *s, bool verbose, ADAS *adas, NIST *nist, AMJUEL *amjuel
+) {
+    const int_t ntCoarse = s->GetInteger("init/continuation_nt");
+    const int_t factor   = s->GetInteger("init/continuation_factor");
+
+    if (factor < 1)
+        throw SettingsException(
+            "init: Invalid grid continuation factor: " INT_T_PRINTF_FMT ". "
+            "The factor must be at least 1.", factor
+        );
+
+    enum OptionConstants::timestepper_type tstype =
+        (enum OptionConstants::timestepper_type)s->GetInteger("timestep/type", false);
+    if (tstype != OptionConstants::TIMESTEPPER_TYPE_CONSTANT)
+        throw SettingsException(
+            "init: Grid continuation is only supported with the constant time stepper."
+        );
+
+    const real_t tmax = s->GetReal("timestep/tmax", false);
+    const int_t nt    = s->GetInteger("timestep/nt", false);
+    real_t dt         = s->GetReal("timestep/dt", false);
+    if (dt <= 0 && nt > 0)
+        dt = tmax / nt;
+    if (dt <= 0 || ntCoarse >= (int_t)round(tmax/dt))
+        throw SettingsException(
+            "init: The number of time steps to solve on coarse grids ("
+            INT_T_PRINTF_FMT ") must be smaller than the total number of "
+            "time steps of the simulation.", ntCoarse
+        );
+
+    // Coarsen grids
+    std::vector<std::pair<std::string, int_t>> saved;
+    CoarsenResolution(s, "radialgrid/nr", factor, saved);
+    const std::string momentumgrids[] = {"hottailgrid", "runawaygrid"};
+    for (const std::string& mod : momentumgrids) {
+        if (!s->GetBool(mod + "/enabled", false) ||
+            s->GetInteger(mod + "/type", false) != OptionConstants::MOMENTUMGRID_TYPE_PXI)
+            continue;
+
+        int_t ptype = s->GetInteger(mod + "/pgrid", false);
+        if (ptype != OptionConstants::PXIGRID_PTYPE_CUSTOM) {
+            CoarsenResolution(s, mod + "/np", factor, saved);
+            CoarsenResolution(s, mod + "/npsep", factor, saved);
+        }
+
+        int_t xitype = s->GetInteger(mod + "/xigrid", false);
+        if (xitype != OptionConstants::PXIGRID_XITYPE_CUSTOM &&
+            xitype != OptionConstants::PXIGRID_XITYPE_TRAPPED) {
+            CoarsenResolution(s, mod + "/nxi", factor, saved);
+            CoarsenResolution(s, mod + "/nxisep", factor, saved);
+        }
+    }
+
+    // Name of coarse output file (inserting "_coarse"
+    // before the file extension)
+    const std::string filename = s->GetString("/output/filename", false);
+    const std::string checkpoint = s->GetString("/output/checkpoint", false);
+    const int_t nSaveSteps = s->GetInteger("timestep/nsavesteps", false);
+    const std::string coarseFilename = InsertFilenameSuffix(filename, "_coarse");
+
+    s->SetSetting("init/continuation_nt", (int_t)0);
+    s->SetSetting("timestep/tmax", ntCoarse*dt);
+    s->SetSetting("timestep/dt", dt);
+    s->SetSetting("timestep/nt", (int_t)0);
+    s->SetSetting("timestep/nsavesteps", (int_t)0);
+    s->SetSetting("/output/filename", coarseFilename);
+    s->SetSetting("/output/checkpoint", (std::string)"");
+
+    DREAM::IO::PrintInfo(
+        "Solving " INT_T_PRINTF_FMT " time steps on grids coarsened by a factor "
+        INT_T_PRINTF_FMT "...", ntCoarse, factor
+    );
+
+    Simulation *sim = ProcessSettings(s, verbose, adas, nist, amjuel);
+    sim->Run();
+    sim->Save();
+    delete sim;
+
+    // Restore settings and continue from the coarse solution
+    for (auto it = saved.begin(); it != saved.end(); it++)
+        s->SetSetting(it->first, it->second);
+
+    s->SetSetting("timestep/tmax", tmax - ntCoarse*dt);
+    if (nt > 0) {
+        s->SetSetting("timestep/dt", (real_t)0);
+        s->SetSetting("timestep/nt", nt - ntCoarse);
+    }
+    s->SetSetting("timestep/nsavesteps", nSaveSteps);
+    s->SetSetting("/output/filename", filename);
+    s->SetSetting("/output/checkpoint", checkpoint);
+
+    s->SetSetting("init/fromfile", coarseFilename);
+    s->SetSetting("init/filetimeindex", (int_t)-1);
+    s->SetSetting("init/eqsysignore", (std::string)"");
+}
+
+/**
+ * Generate a radial flux grid with the same number of cells and
+ * the same boundaries as the radial grid of the given equation
+ * system, adapted to the current cold electron temperature and
+ * density. The cell faces are placed so that the monitor function
+ *
+ *   M(r) = 1 + (ratio-1) * max( g_T(r)/max(g_T), g_n(r)/max(g_n) ),
+ *
+ * where g_T = |dT_cold/dr|/T_cold and g_n = |dn_cold/dr|/n_cold, is
+ * equidistributed, so that cells are up to 'ratio' times smaller at
+ * steep fronts than where the profiles are flat. The monitor function
+ * is smoothed before the grid is generated, which limits the change
+ * in size between neighbouring cells.
+ *
+ * eqsys: Equation system containing the solution to adapt to.
+ * ratio: Ratio between the largest and smallest cell of the grid.
+ *
+ * Returns the new radial flux grid (of size nr+1).
+ */
+static real_t *AdaptRadialGrid(EquationSystem *eqsys, const real_t ratio) {
+    const FVM::RadialGrid *rgrid = eqsys->GetFluidGrid()->GetRadialGrid();
+    const len_t nr = rgrid->GetNr();
+    const real_t *r = rgrid->GetR(), *r_f = rgrid->GetR_f();
+
+    FVM::UnknownQuantityHandler *unknowns = eqsys->GetUnknownHandler();
+    const real_t *profiles[] = {
+        unknowns->GetUnknownData(OptionConstants::UQTY_T_COLD),
+        unknowns->GetUnknownData(OptionConstants::UQTY_N_COLD)
+    };
+
+    // Monitor function on the interior cell faces
+    std::vector<real_t> M(nr+1, 1);
+    for (const real_t *x : profiles) {
+        std::vector<real_t> g(nr+1, 0);
+        real_t gmax = 0;
+        for (len_t ir = 1; ir < nr; ir++) {
+            const real_t xf = 0.5*(x[ir] + x[ir-1]);
+            if (xf > 0)
+                g[ir] = std::abs(x[ir]-x[ir-1]) / ((r[ir]-r[ir-1]) * xf);
+            gmax = std::max(gmax, g[ir]);
+        }
+
+        if (gmax > 0) {
+            for (len_t ir = 1; ir < nr; ir++)
+                M[ir] = std::max(M[ir], 1 + (ratio-1)*g[ir]/gmax);
+        }
+    }
+    M[0]  = M[1];
+    M[nr] = M[nr-1];
+
+    // Smooth monitor function
+    for (len_t pass = 0; pass < 2; pass++) {
+        std::vector<real_t> Ms(M);
+        for (len_t ir = 1; ir < nr; ir++)
+            Ms[ir] = 0.25*(M[ir-1] + 2*M[ir] + M[ir+1]);
+        M = Ms;
+    }
+
+    // Cumulative integral of the monitor function (trapezoidal rule)
+    std::vector<real_t> I(nr+1, 0);
+    for (len_t ir = 0; ir < nr; ir++)
+        I[ir+1] = I[ir] + 0.5*(r_f[ir+1]-r_f[ir])*(M[ir] + M[ir+1]);
+
+    // Build flux grid by inverting the cumulative integral
+    real_t *new_r_f = new real_t[nr+1];
+    const real_t dI = I[nr] / nr;
+    new_r_f[0] = r_f[0];
+    for (len_t i = 1, k = 0; i < nr; i++) {
+        const real_t target = i*dI;
+        while (k < nr-1 && I[k+1] < target)
+            k++;
+
+        new_r_f[i] = r_f[k] + (r_f[k+1]-r_f[k]) * (target-I[k]) / (I[k+1]-I[k]);
+    }
+    new_r_f[nr] = r_f[nr];
+
+    return new_r_f;
+}
+
+/**
+ * Solve the simulation in 'radialgrid/adapt/nsegments' segments of
+ * time steps, adapting the radial grid to the steep gradients of the
+ * cold electron temperature and density at the end of every segment
+ * (see 'AdaptRadialGrid()'). The number of radial grid points is kept
+ * fixed, and the points are moved to resolve fronts, such as cold
+ * fronts or radiative collapse, which would otherwise require a
+ * globally fine radial grid.
+ *
+ * Every segment but the last is solved in a separate simulation,
+ * with the output written to <output>_adapt<k>. The next segment is
+ * initialized from the end of the previous one through the regular
+ * initialization from output, with the radial profiles of all
+ * unknowns (and of the distribution functions in every momentum cell)
+ * remapped conservatively onto the new radial grid. On return, the
+ * settings describe the last segment (with the time axis of the
+ * output restarting at zero, as for the grid continuation). Only the
+ * constant time stepper is supported.
+ *
+ * s:       Settings of the simulation. On return, contains the
+ *          settings for solving the final segment.
+ * verbose: If true, prints a breakdown of the time spent
+ *          constructing the simulation of every segment.
+ * adas:    ADAS database to use.
+ * nist:    NIST database to use.
+ * amjuel:  AMJUEL database to use.
+ */
+void SimulationGenerator::RunRadialGridAdaptation(
+    Settings *s, bool verbose, ADAS *adas, NIST *nist, AMJUEL *amjuel
+) {
+    const int_t nSegments = s->GetInteger("radialgrid/adapt/nsegments");
+    const real_t ratio    = s->GetReal("radialgrid/adapt/ratio");
+
+    if (ratio < 1)
+        throw SettingsException(
+            "radialgrid: Invalid radial grid adaptation ratio: %e. The ratio "
+            "between the largest and smallest cell must be at least 1.", ratio
+        );
+
+    enum OptionConstants::timestepper_type tstype =
+        (enum OptionConstants::timestepper_type)s->GetInteger("timestep/type", false);
+    if (tstype != OptionConstants::TIMESTEPPER_TYPE_CONSTANT)
+        throw SettingsException(
+            "radialgrid: Adaptation of the radial grid is only supported with "
+            "the constant time stepper."
+        );
+
+    const int_t nr = s->GetInteger("radialgrid/nr", false);
+    len_t nr_f = 0;
+    s->GetRealArray("radialgrid/r_f", 1, &nr_f, false);
+    if ((nr == 0 && nr_f < 3) || nr == 1)
+        throw SettingsException(
+            "radialgrid: Adaptation of the radial grid requires at least two radial grid points."
+        );
+
+    const real_t tmax = s->GetReal("timestep/tmax", false);
+    const int_t nt    = s->GetInteger("timestep/nt", false);
+    real_t dt         = s->GetReal("timestep/dt", false);
+    if (dt <= 0 && nt > 0)
+        dt = tmax / nt;
+    const int_t nSteps = (dt > 0 ? (int_t)round(tmax/dt) : 0);
+    if (nSteps < nSegments)
+        throw SettingsException(
+            "radialgrid: The number of time steps of the simulation must be at least "
+            "the number of radial grid adaptation segments (" INT_T_PRINTF_FMT ").",
+            nSegments
+        );
+
+    const int_t segmentSteps = nSteps / nSegments;
+    const std::string filename = s->GetString("/output/filename", false);
+    const std::string checkpoint = s->GetString("/output/checkpoint", false);
+    const int_t nSaveSteps = s->GetInteger("timestep/nsavesteps", false);
+
+    s->SetSetting("radialgrid/adapt/nsegments", (int_t)0);
+    s->SetSetting("timestep/tmax", segmentSteps*dt);
+    s->SetSetting("timestep/dt", dt);
+    s->SetSetting("timestep/nt", (int_t)0);
+    s->SetSetting("timestep/nsavesteps", (int_t)0);
+    s->SetSetting("/output/checkpoint", (std::string)"");
+
+    for (int_t k = 0; k+1 < nSegments; k++) {
+        const std::string segmentFilename =
+            InsertFilenameSuffix(filename, "_adapt" + std::to_string(k));
+        s->SetSetting("/output/filename", segmentFilename);
+
+        DREAM::IO::PrintInfo(
+            "Solving radial grid adaptation segment " INT_T_PRINTF_FMT " of "
+            INT_T_PRINTF_FMT "...", k+1, nSegments
+        );
+
+        Simulation *sim = ProcessSettings(s, verbose, adas, nist, amjuel);
+        sim->Run();
+        sim->Save();
+
+        // Adapt the radial grid to the solution...
+        const len_t nrAdapt = sim->GetEquationSystem()->GetFluidGrid()->GetNr();
+        real_t *r_f = AdaptRadialGrid(sim->GetEquationSystem(), ratio);
+        delete sim;
+
+        real_t drmin = r_f[1]-r_f[0], drmax = drmin;
+        for (len_t ir = 1; ir < nrAdapt; ir++) {
+            drmin = std::min(drmin, r_f[ir+1]-r_f[ir]);
+            drmax = std::max(drmax, r_f[ir+1]-r_f[ir]);
+        }
+        DREAM::IO::PrintInfo(
+            "Adapted radial grid: smallest cell %.4e m, largest cell %.4e m.",
+            drmin, drmax
+        );
+
+        // ...and continue from the solution on the new grid
+        // (the settings object takes ownership of 'r_f')
+        s->SetSetting("radialgrid/nr", (int_t)0);
+        s->SetSetting("radialgrid/r_f", nrAdapt+1, r_f);
+
+        s->SetSetting("init/fromfile", segmentFilename);
+        s->SetSetting("init/filetimeindex", (int_t)-1);
+        s->SetSetting("init/eqsysignore", (std::string)"");
+        s->SetSetting("init/conservative", true);
+    }
+
+    // Settings for the final segment
+    const int_t stepsDone = (nSegments-1)*segmentSteps;
+    s->SetSetting("timestep/tmax", tmax - stepsDone*dt);
+    if (nt > 0) {
+        s->SetSetting("timestep/dt", (real_t)0);
+        s->SetSetting("timestep/nt", nt - stepsDone);
+    }
+    s->SetSetting("timestep/nsavesteps", nSaveSteps);
+    s->SetSetting("/output/filename", filename);
+    s->SetSetting("/output/checkpoint", checkpoint);
+}
+
 /**
  * Convert an 'enum OptionConstants::momentumgrid_type' to
  * an 'enum Interpolator3D::momentumgrid_type'.
@@ -86,17 +674,32 @@ enum FVM::Interpolator3D::momentumgrid_type SimulationGenerator::GetInterp3DMome
 }
 
 /**
- * Load ADAS database.
+ * Load ADAS database. If an image of precomputed atomic data is
+ * specified, the interpolation coefficients are taken from it
+ * (unless it is missing or out of date, in which case they are
+ * computed as usual).
  */
 ADAS *SimulationGenerator::LoadADAS(Settings *s) {
     enum OptionConstants::adas_interp_type intp =
         (enum OptionConstants::adas_interp_type)s->GetInteger("atomic/adas_interpolation");
+    const std::string imagefile = s->GetString("atomic/adas_image");
+
+    const AtomicDataImage *image = nullptr;
+    if (!imagefile.empty()) {
+        image = AtomicDataImage::Open(imagefile);
+        if (image == nullptr)
+            DREAM::IO::PrintWarning(
+                "Unable to use the atomic data image '%s' (the file is missing, or "
+                "was generated by a different version of DREAM). Regenerate it with "
+                "'dreami -g %s'.", imagefile.c_str(), imagefile.c_str()
+            );
+    }
 
     switch (intp) {
         case OptionConstants::ADAS_INTERP_BILINEAR:
-            return new ADAS(gsl_interp2d_bilinear);
+            return new ADAS(gsl_interp2d_bilinear, image);
         case OptionConstants::ADAS_INTERP_BICUBIC:
-            return new ADAS(gsl_interp2d_bicubic);
+            return new ADAS(gsl_interp2d_bicubic, image);
 
         default:
             throw SettingsException(
@@ -121,14 +724,135 @@ AMJUEL *SimulationGenerator::LoadAMJUEL(Settings*){
 	return new AMJUEL();
 }
 
+/**
+ * Load the settings for printing messages to the terminal.
+ */
+void SimulationGenerator::LoadLogging(Settings *s) {
+    const int_t level = s->GetInteger("/output/loglevel");
+    if (level < IO::LEVEL_ERROR || level > IO::LEVEL_DEBUG)
+        throw SettingsException(
+            "output: Invalid log level: " INT_T_PRINTF_FMT ". "
+            "The log level must be between %d (errors only) and %d (debug).",
+            level, IO::LEVEL_ERROR, IO::LEVEL_DEBUG
+        );
+    else if (level > DREAM_LOG_MAX_LEVEL)
+        IO::PrintWarning(
+            "Log level " INT_T_PRINTF_FMT " requested, but messages above level %d "
+            "have been disabled at compile time.", level, DREAM_LOG_MAX_LEVEL
+        );
+
+    IO::format_t format = (IO::format_t)s->GetInteger("/output/logformat");
+    if (format != IO::FORMAT_TEXT && format != IO::FORMAT_JSON)
+        throw SettingsException(
+            "output: Unrecognized log format: %d.", format
+        );
+
+    IO::SetLevel((IO::level_t)level);
+    IO::SetFormat(format);
+    IO::SetAsynchronous(s->GetBool("/output/logasync"));
+}
+
 /**
  * Load output settings.
  */
 void SimulationGenerator::LoadOutput(Settings *s, Simulation *sim) {
     std::string filename = s->GetString("/output/filename");
 
-    sim->SetOutputGenerator(new OutputGeneratorSFile(
-        sim->GetEquationSystem(), filename
-    ));
+    enum OptionConstants::output_layout layout =
+        (enum OptionConstants::output_layout)s->GetInteger("/output/layout");
+    if (layout != OptionConstants::OUTPUT_LAYOUT_CONTIGUOUS &&
+        layout != OptionConstants::OUTPUT_LAYOUT_CHUNKED)
+        throw SettingsException(
+            "output: Unrecognized output layout: %d.", layout
+        );
+
+    int_t compression = s->GetInteger("/output/compression");
+    if (compression < 0 || compression > 9)
+        throw SettingsException(
+            "output: Invalid compression level: " INT_T_PRINTF_FMT ". "
+            "The compression level must be between 0 and 9.", compression
+        );
+    else if (compression > 0 && layout != OptionConstants::OUTPUT_LAYOUT_CHUNKED && !s->GetBool("/output/streaming"))
+        throw SettingsException(
+            "output: Compression requires either a chunked output layout or streaming output."
+        );
+
+    enum OptionConstants::output_backend backend =
+        (enum OptionConstants::output_backend)s->GetInteger("/output/backend");
+    if (backend == OptionConstants::OUTPUT_BACKEND_ADIOS2) {
+#ifndef DREAM_WITH_ADIOS2
+        throw SettingsException(
+            "output: DREAM was not compiled with support for the ADIOS2 output backend."
+        );
+#endif
+        if (layout != OptionConstants::OUTPUT_LAYOUT_CONTIGUOUS || s->GetBool("/output/streaming"))
+            throw SettingsException(
+                "output: The ADIOS2 output backend always writes the output during the "
+                "simulation and cannot be combined with streaming or a chunked layout."
+            );
+    } else if (backend != OptionConstants::OUTPUT_BACKEND_SFILE)
+        throw SettingsException(
+            "output: Unrecognized output backend: %d.", backend
+        );
+
+    const bool chunked = (layout == OptionConstants::OUTPUT_LAYOUT_CHUNKED);
+    EquationSystem *eqsys = sim->GetEquationSystem();
+
+    // Unknowns to store in single precision
+    FVM::UnknownQuantityHandler *unknowns = eqsys->GetUnknownHandler();
+    std::vector<std::string> singleList = s->GetStringList("/output/singleprecision");
+    for (const std::string& name : singleList) {
+        if (!unknowns->HasUnknown(name))
+            throw SettingsException(
+                "output: Unrecognized unknown quantity in 'singleprecision': '%s'.",
+                name.c_str()
+            );
+
+        unknowns->GetUnknown(unknowns->GetUnknownID(name))->GetQuantityData()->SetSinglePrecision(true);
+    }
+
+    // Unknowns for which to only store the final time step
+    std::vector<std::string> finalList = s->GetStringList("/output/finalonly");
+    if (!finalList.empty() && s->GetBool("/output/streaming"))
+        throw SettingsException(
+            "output: Storing only the final time step of unknown quantities "
+            "is not supported with streaming output."
+        );
+
+    for (const std::string& name : finalList) {
+        if (!unknowns->HasUnknown(name))
+            throw SettingsException(
+                "output: Unrecognized unknown quantity in 'finalonly': '%s'.",
+                name.c_str()
+            );
+
+        unknowns->GetUnknown(unknowns->GetUnknownID(name))->GetQuantityData()->SetFinalOnly(true);
+    }
+    if (s->GetBool("/output/streaming")) {
+        eqsys->SetOutputStream(new OutputStream(
+            eqsys->GetUnknownHandler(), filename, chunked, compression
+        ));
+    }
+
+#ifdef DREAM_WITH_ADIOS2
+    if (backend == OptionConstants::OUTPUT_BACKEND_ADIOS2) {
+        OutputGeneratorADIOS2 *ogen = new OutputGeneratorADIOS2(
+            eqsys, filename, s->GetString("/output/adios2engine")
+        );
+        eqsys->SetStepOutput(ogen);
+        sim->SetOutputGenerator(ogen);
+        return;
+    }
+#endif
+
+    OutputGeneratorSFile *ogen = new OutputGeneratorSFile(eqsys, filename);
+    if (chunked)
+        ogen->SetChunkedLayout(compression);
+
+    const std::string gridstore = s->GetString("/output/gridstore");
+    if (!gridstore.empty())
+        ogen->SetGridStore(gridstore);
+
+    sim->SetOutputGenerator(ogen);
 }
 
@@ -37,6 +37,10 @@ void SimulationGenerator::DefineOptions_RadialGrid(Settings *s) {
 
     s->DefineSetting(RADIALGRID "/r_f", "Grid points of the radial flux grid", 0, (real_t*) nullptr);
 
+    // Adaptation of the radial grid to the solution
+    s->DefineSetting(RADIALGRID "/adapt/nsegments", "Number of time segments after each of which the radial grid is adapted to the solution (0 or 1 = disabled)", (int_t)0);
+    s->DefineSetting(RADIALGRID "/adapt/ratio", "Ratio between the largest and smallest cell of the adapted radial grid", (real_t)10.0);
+
     // CylindricalRadialGrid
     s->DefineSetting(RADIALGRID "/B0", "On-axis magnetic field strength", (real_t)1.0);
 
@@ -55,6 +59,9 @@ void SimulationGenerator::DefineOptions_RadialGrid(Settings *s) {
     // NumericBRadialGridGenerator
     s->DefineSetting(RADIALGRID "/filename", "Name of file containing the magnetic field data", (string)"");
     s->DefineSetting(RADIALGRID "/fileformat", "Format used for storing the magnetic field data", (int_t)OptionConstants::RADIALGRID_NUMERIC_FORMAT_LUKE);
+
+    // Geometry cache
+    s->DefineSetting(RADIALGRID "/geometrycache", "Directory in which to cache flux surface and bounce averages (empty = disabled)", (string)"");
 }
 
 /**
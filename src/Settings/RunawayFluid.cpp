@@ -48,10 +48,13 @@ void SimulationGenerator::ConstructRunawayFluid(FVM::Grid *g,
 
     // Note: these collision quantities will only be used for their evaluateAt(..., inSettings) 
     //       methods inside REFluid, and be called with other settings than 'cq'. 
-    CoulombLogarithm *lnLEE = new CoulombLogarithm(g,unknowns,ih,gridtype,cqsetForPc,CollisionQuantity::LNLAMBDATYPE_EE);
-    CoulombLogarithm *lnLEI = new CoulombLogarithm(g,unknowns,ih,gridtype,cqsetForPc,CollisionQuantity::LNLAMBDATYPE_EI);
+    CoulombLogarithmCache *lnLambdaCache = eqsys->GetCoulombLogarithmCache();
+    CoulombLogarithm *lnLEE = new CoulombLogarithm(g,unknowns,ih,gridtype,cqsetForPc,CollisionQuantity::LNLAMBDATYPE_EE,lnLambdaCache);
+    CoulombLogarithm *lnLEI = new CoulombLogarithm(g,unknowns,ih,gridtype,cqsetForPc,CollisionQuantity::LNLAMBDATYPE_EI,lnLambdaCache);
     SlowingDownFrequency *nuS  = new SlowingDownFrequency(g,unknowns,ih,lnLEE,lnLEI,gridtype,cqsetForPc);
     PitchScatterFrequency *nuD = new PitchScatterFrequency(g,unknowns,ih,lnLEI,lnLEE,gridtype,cqsetForPc);
+    nuS->SetCache(eqsys->GetCollisionFrequencyCache());
+    nuD->SetCache(eqsys->GetCollisionFrequencyCache());
 
     real_t thresholdToNeglectTrapped = 100*sqrt(std::numeric_limits<real_t>::epsilon());
     OptionConstants::uqty_f_hot_dist_mode ht_dist_mode = (enum OptionConstants::uqty_f_hot_dist_mode)s->GetInteger("eqsys/f_hot/dist_mode");
@@ -71,8 +74,54 @@ void SimulationGenerator::ConstructRunawayFluid(FVM::Grid *g,
         g, unknowns, nuS, nuD, lnLEE, lnLEI, ih, distRE, cqsetForPc, cqsetForEc,
         cond_mode,dreicer_mode,Eceff_mode,ava_mode,compton_mode,compton_photon_flux
     );
+    EceffTable *eceffTable = ConstructEceffTable(g->GetNr(), s);
+    if (eceffTable != nullptr)
+        REF->SetEceffTable(eceffTable);
+
     distRE->SetREFluid(REF);
     eqsys->SetAnalyticDists(distRE, distHT);
     eqsys->SetREFluid(REF);
 }
 
+/**
+ * Load the (optional) table of precomputed effective critical
+ * electric fields.
+ *
+ * nr: Number of radial grid points.
+ * s:  Settings object to load the table from.
+ *
+ * RETURNS a new EceffTable object, or 'nullptr' if no table
+ * was given in the settings.
+ */
+EceffTable *SimulationGenerator::ConstructEceffTable(const len_t nr, Settings *s) {
+    const std::string mod = "eqsys/n_re/Eceff_table";
+    len_t nZeff, nT, dims[3], edims[3];
+
+    const real_t *Zeff = s->GetRealArray(mod + "/Zeff", 1, &nZeff);
+    const real_t *T    = s->GetRealArray(mod + "/T", 1, &nT);
+    const real_t *v    = s->GetRealArray(mod + "/EceffOverEctot", 3, dims);
+    const real_t *err  = s->GetRealArray(mod + "/error", 3, edims);
+    real_t tolerance   = s->GetReal(mod + "/tolerance");
+
+    if (nZeff == 0 && nT == 0)
+        return nullptr;
+
+    if (dims[0] != nr || dims[1] != nZeff || dims[2] != nT)
+        throw SettingsException(
+            "%s: Invalid dimensions of 'EceffOverEctot': " LEN_T_PRINTF_FMT "x" LEN_T_PRINTF_FMT "x" LEN_T_PRINTF_FMT
+            ". Expected " LEN_T_PRINTF_FMT "x" LEN_T_PRINTF_FMT "x" LEN_T_PRINTF_FMT " (nr x nZeff x nT).",
+            mod.c_str(), dims[0], dims[1], dims[2], nr, nZeff, nT
+        );
+
+    bool hasError = (edims[0]*edims[1]*edims[2] > 0);
+    if (hasError && (edims[0] != dims[0] || edims[1] != dims[1] || edims[2] != dims[2]))
+        throw SettingsException(
+            "%s: The dimensions of 'error' must be the same as those of 'EceffOverEctot'.",
+            mod.c_str()
+        );
+
+    return new EceffTable(
+        nr, nZeff, nT, Zeff, T, v,
+        (hasError ? err : nullptr), tolerance
+    );
+}
@@ -4,8 +4,9 @@
  * i.e. from HDF5, MATLAB MAT or SDT files.
  */
 
-#include <map>
+#include <algorithm>
 #include <string>
+#include <unordered_map>
 #include <softlib/SFile.h>
 #include "DREAM/IO.hpp"
 #include "DREAM/Settings/SFile.hpp"
@@ -27,7 +28,7 @@ void DREAM::SettingsSFile::LoadSettings(Settings *settings, const string& filena
     LoadSettings(settings, sf);
 }
 void DREAM::SettingsSFile::LoadSettings(Settings *settings, SFile *sf) {
-    const map<string, Settings::setting_t*> allset = settings->GetSettings();
+    const unordered_map<string, Settings::setting_t*>& allset = settings->GetSettings();
     vector<string> missing;
 
     // Load settings
@@ -272,7 +273,7 @@ void DREAM::SettingsSFile::SaveSettings(
     if (path.back() != '/')
         group += '/';
 
-    const map<string, Settings::setting_t*> smap = s->GetSettings();
+    const unordered_map<string, Settings::setting_t*>& smap = s->GetSettings();
     vector<string> groups;
 
     for (auto const& [name, set] : smap) {
@@ -294,32 +295,32 @@ void DREAM::SettingsSFile::SaveSettings(
 
         switch (set->type) {
             case Settings::SETTING_TYPE_BOOL:
-                SettingsSFile::SaveBool(fullname, s->GetBool(name), sf);
+                SettingsSFile::SaveBool(fullname, s->GetBool(set), sf);
                 break;
             case Settings::SETTING_TYPE_INT:
-                SettingsSFile::SaveInteger(fullname, s->GetInteger(name), sf);
+                SettingsSFile::SaveInteger(fullname, s->GetInteger(set), sf);
                 break;
             case Settings::SETTING_TYPE_INT_ARRAY: {
                 len_t *dims = new len_t[set->ndims];
-                const int_t *arr = s->GetIntegerArray(name, set->ndims, dims);
+                const int_t *arr = s->GetIntegerArray(set, set->ndims, dims);
 
                 SettingsSFile::SaveIntegerArray(fullname, arr, set->ndims, dims, sf);
 
                 delete [] dims;
             } break;
             case Settings::SETTING_TYPE_REAL:
-                SettingsSFile::SaveReal(fullname, s->GetReal(name), sf);
+                SettingsSFile::SaveReal(fullname, s->GetReal(set), sf);
                 break;
             case Settings::SETTING_TYPE_REAL_ARRAY: {
                 len_t *dims = new len_t[set->ndims];
-                const real_t *arr = s->GetRealArray(name, set->ndims, dims);
+                const real_t *arr = s->GetRealArray(set, set->ndims, dims);
 
                 SettingsSFile::SaveRealArray(fullname, arr, set->ndims, dims, sf);
 
                 delete [] dims;
             } break;
             case Settings::SETTING_TYPE_STRING:
-                SettingsSFile::SaveString(fullname, s->GetString(name), sf);
+                SettingsSFile::SaveString(fullname, s->GetString(set), sf);
                 break;
             
             default:
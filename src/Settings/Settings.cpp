@@ -16,6 +16,9 @@ using namespace std;
  * Constructor.
  */
 Settings::Settings() {
+    // DREAM defines a few thousand settings, so we might as
+    // well avoid rehashing while they are being defined
+    this->settings.reserve(4096);
 }
 
 /**
@@ -50,6 +53,7 @@ void Settings::_DefineSetting(
         throw SettingsException("The setting '%s' has already been defined.", name.c_str());
 
     setting_t *s   = new setting_t;
+    s->name        = name;
     s->description = desc;
     s->type        = type;
     s->ndims       = 1;
@@ -86,6 +90,7 @@ void Settings::_DefineSetting(
         throw SettingsException("The setting '%s' has already been defined.", name.c_str());
 
     setting_t *s   = new setting_t;
+    s->name        = name;
     s->description = desc;
     s->type        = type;
     s->ndims       = ndims;
@@ -99,7 +104,7 @@ void Settings::_DefineSetting(
     }
 
     if (defaultValue != nullptr) {
-        T *a = new T;
+        T *a = new T[ntot];
         for (len_t i = 0; i < ntot; i++)
             a[i] = defaultValue[i];
         
@@ -118,7 +123,11 @@ void Settings::_DefineSetting(
  * name: Name of setting to remove.
  */
 void Settings::UndefineSetting(const string& name) {
-	settings.erase(name);
+    auto it = settings.find(name);
+    if (it != settings.end()) {
+        delete it->second;
+        settings.erase(it);
+    }
 }
 
 /**
@@ -133,11 +142,21 @@ Settings::setting_t *Settings::_GetSetting(const string& name, enum setting_type
     if (it == settings.end())
         throw SettingsException("The setting '%s' has not been defined.", name.c_str());
 
-    setting_t *s = it->second;
+    return _CheckSetting(it->second, type, markused);
+}
+
+/**
+ * Verify that the given setting is of the expected type.
+ *
+ * s:        Setting to check.
+ * type:     Expected setting data type.
+ * markused: If 'true', marks the setting as "used".
+ */
+Settings::setting_t *Settings::_CheckSetting(setting_t *s, enum setting_type type, bool markused) {
     if (s->type != type)
         throw SettingsException(
             "The setting '%s' is not %s as expected. It is %s.",
-            name.c_str(), GetTypeName(type), GetTypeName(s->type)
+            s->name.c_str(), GetTypeName(type), GetTypeName(s->type)
         );
 
     if (markused) s->used = true;
@@ -162,13 +181,26 @@ T *Settings::_GetArray(
     const len_t nExpectedDims, len_t ndims[],
     enum setting_type type, bool markused
 ) {
-    setting_t *s = _GetSetting(name, type, markused);
+    return _GetArray<T>(_GetSetting(name, type, markused), nExpectedDims, ndims, type, markused);
+}
+
+/**
+ * Returns the given setting as an array of the given type.
+ * (see above for arguments)
+ */
+template<typename T>
+T *Settings::_GetArray(
+    setting_t *s,
+    const len_t nExpectedDims, len_t ndims[],
+    enum setting_type type, bool markused
+) {
+    _CheckSetting(s, type, markused);
 
     if (nExpectedDims != s->ndims)
         throw SettingsException(
             "Setting '%s': Invalid number of dimensions of array. Expected "
-            LEN_T_PRINTF_FMT " dimensions. Array has %d dimensions.",
-            name.c_str(), nExpectedDims, s->ndims
+            LEN_T_PRINTF_FMT " dimensions. Array has " LEN_T_PRINTF_FMT " dimensions.",
+            s->name.c_str(), nExpectedDims, s->ndims
         );
 
     for (len_t i = 0; i < nExpectedDims; i++)
@@ -378,6 +410,36 @@ const real_t *Settings::GetRealArray(
     return _GetArray<real_t>(name, nExpectedDims, ndims, SETTING_TYPE_REAL_ARRAY, markused);
 }
 
+/**
+ * Returns a handle to the named setting, which can be passed
+ * to the getters instead of the name of the setting to avoid
+ * looking the setting up repeatedly.
+ *
+ * name: Name of setting to return handle for.
+ * type: Expected data type of the setting.
+ */
+Settings::handle_t Settings::GetHandle(const string& name, enum setting_type type) {
+    return _GetSetting(name, type, false);
+}
+
+bool Settings::GetBool(handle_t h, bool markused)
+{ return *((bool*)(_CheckSetting(h, SETTING_TYPE_BOOL, markused)->value)); }
+
+int_t Settings::GetInteger(handle_t h, bool markused)
+{ return *((int_t*)(_CheckSetting(h, SETTING_TYPE_INT, markused)->value)); }
+
+real_t Settings::GetReal(handle_t h, bool markused)
+{ return *((real_t*)(_CheckSetting(h, SETTING_TYPE_REAL, markused)->value)); }
+
+const string& Settings::GetString(handle_t h, bool markused)
+{ return *((string*)(_CheckSetting(h, SETTING_TYPE_STRING, markused)->value)); }
+
+const int_t *Settings::GetIntegerArray(handle_t h, const len_t nExpectedDims, len_t ndims[], bool markused)
+{ return _GetArray<int_t>(h, nExpectedDims, ndims, SETTING_TYPE_INT_ARRAY, markused); }
+
+const real_t *Settings::GetRealArray(handle_t h, const len_t nExpectedDims, len_t ndims[], bool markused)
+{ return _GetArray<real_t>(h, nExpectedDims, ndims, SETTING_TYPE_REAL_ARRAY, markused); }
+
 /**
  * Mark the specified setting as "used".
  *
@@ -421,9 +483,16 @@ void Settings::SetSetting(const string& name, const len_t ndims, const len_t dim
  * Print a list of all available settings.
  */
 void Settings::DisplaySettings() {
-    for (auto it = settings.begin(); it != settings.end(); it++) {
-        setting_t *s = it->second;
-        printf("%-40s -- %s\n", it->first.c_str(), s->description.c_str());
-    }
+    vector<const setting_t*> sorted;
+    sorted.reserve(settings.size());
+    for (auto it = settings.begin(); it != settings.end(); it++)
+        sorted.push_back(it->second);
+
+    std::sort(sorted.begin(), sorted.end(), [](const setting_t *a, const setting_t *b) {
+        return (a->name < b->name);
+    });
+
+    for (const setting_t *s : sorted)
+        printf("%-40s -- %s\n", s->name.c_str(), s->description.c_str());
 }
 
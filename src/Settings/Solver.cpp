@@ -2,13 +2,18 @@
  * Construct a time stepper object.
  */
 
+#include <algorithm>
+#include <sstream>
 #include "DREAM/IO.hpp"
 #include "DREAM/EquationSystem.hpp"
 #include "DREAM/Settings/SimulationGenerator.hpp"
 #include "DREAM/Solver/Solver.hpp"
 #include "DREAM/Solver/SolverLinearlyImplicit.hpp"
 #include "DREAM/Solver/SolverNonLinear.hpp"
+#include "DREAM/Solver/SolverSplit.hpp"
 #include "DREAM/UnknownQuantityEquation.hpp"
+#include "FVM/Parallel.hpp"
+#include "FVM/PETScBackend.hpp"
 #include "FVM/UnknownQuantityHandler.hpp"
 
 
@@ -27,11 +32,61 @@ using namespace std;
 void SimulationGenerator::DefineOptions_Solver(Settings *s) {
     s->DefineSetting(MODULENAME "/type", "Equation system solver type", (int_t)OptionConstants::SOLVER_TYPE_NONLINEAR);
 
+    s->DefineSetting(MODULENAME "/adjoint/data_t", "Times at which the data fitted by the adjoint objective is given", 0, (real_t*)nullptr);
+    s->DefineSetting(MODULENAME "/adjoint/data_x", "Data fitted by the adjoint objective (if empty, the objective is the final value)", 0, (real_t*)nullptr);
+    s->DefineSetting(MODULENAME "/adjoint/index", "Index of the element of the unknown quantity defining the adjoint objective", (int_t)0);
+    s->DefineSetting(MODULENAME "/adjoint/objective", "Name of the unknown quantity defining the adjoint objective (empty disables adjoint sensitivities)", (const string)"");
+    s->DefineSetting(MODULENAME "/adjoint/parameters", "Predetermined quantities whose scale factors are differentiated with respect to (';'-separated list)", (const string)"");
+    s->DefineSetting(MODULENAME "/backend", "Backend to use for matrices, vectors and linear solves (CPU, CUDA, HIP or Kokkos)", (int_t)OptionConstants::SOLVER_BACKEND_CPU);
+    s->DefineSetting(MODULENAME "/backuphold", "Maximum number of time steps to start with the backup linear solver after the main linear solver has failed (0 = always start with the main linear solver)", (int_t)0);
     s->DefineSetting(MODULENAME "/backupsolver", "Type of backup linear solver to use if the main linear solver fails", (int_t)OptionConstants::LINEAR_SOLVER_NONE);
+    s->DefineSetting(MODULENAME "/borderscalars", "Solve the linear systems of the non-linear solver as bordered systems, with the scalar unknowns forming the border", (bool)false);
+    s->DefineSetting(MODULENAME "/directassembly", "If true, matrix elements within the non-zero pattern of the previous assembly are written directly into the PETSc matrix", (bool)true);
+    s->DefineSetting(MODULENAME "/distributed", "Solve the linear systems of the non-linear solver with the radial grid distributed over all MPI processes", (bool)false);
+    s->DefineSetting(MODULENAME "/eisenstatwalker/enabled", "Adapt the tolerance of iterative linear solves in the non-linear solver using Eisenstat-Walker forcing terms", (bool)false);
+    s->DefineSetting(MODULENAME "/eisenstatwalker/etamax", "Largest relative tolerance of iterative linear solves with Eisenstat-Walker forcing terms", (real_t)0.9);
+    s->DefineSetting(MODULENAME "/eisenstatwalker/etamin", "Smallest relative tolerance of iterative linear solves with Eisenstat-Walker forcing terms", (real_t)1e-5);
+    s->DefineSetting(MODULENAME "/eliminatealgebraic", "Eliminate unknowns given by algebraic relations from the linear systems of the non-linear solver", (bool)false);
+    s->DefineSetting(MODULENAME "/factorordering", "Ordering of the unknowns used when factorizing the matrix with a direct linear solver", (int_t)OptionConstants::SOLVER_FACTOR_ORDERING_DEFAULT);
+    s->DefineSetting(MODULENAME "/fusedassembly", "If true, the residual of each equation is evaluated together with its block row of the jacobian in the non-linear solver", (bool)false);
+    s->DefineSetting(MODULENAME "/gmres/ionsplit", "Place the ion densities in a separate split of the field-split GMRES preconditioner, preconditioned with the inverse of the dense block of charge states at each radius", (bool)false);
+    s->DefineSetting(MODULENAME "/gmres/kineticpc", "Preconditioner to use for kinetic splits of the field-split GMRES preconditioner", (int_t)OptionConstants::GMRES_KINETIC_PC_ILU);
+    s->DefineSetting(MODULENAME "/gmres/mglines", "Lines along which to relax in the smoother of the kinetic multigrid preconditioner", (int_t)OptionConstants::GMRES_MG_LINES_ALTERNATING);
+    s->DefineSetting(MODULENAME "/gmres/pc", "Type of preconditioner to use with the GMRES linear solver", (int_t)OptionConstants::GMRES_PC_BLOCK_JACOBI);
+    s->DefineSetting(MODULENAME "/gmres/splits", "Groups of unknowns to use as splits in the field-split GMRES preconditioner (';'-separated groups of ','-separated unknowns)", (const string)"");
+    s->DefineSetting(MODULENAME "/jacobianupdate", "Strategy for updating the jacobian matrix in the non-linear solver", (int_t)OptionConstants::SOLVER_JACOBIAN_UPDATE_ALWAYS);
+    s->DefineSetting(MODULENAME "/krylovmaxiter", "Maximum number of Krylov iterations per Newton step (Newton-Krylov and JFNK modes)", (int_t)50);
+    s->DefineSetting(MODULENAME "/krylovreltol", "Relative tolerance of the Krylov solver (Newton-Krylov and JFNK modes)", (real_t)1e-4);
+    s->DefineSetting(MODULENAME "/linesearch", "Globalization strategy of the Newton iteration in the non-linear solver", (int_t)OptionConstants::SOLVER_LINE_SEARCH_NONE);
+    s->DefineSetting(MODULENAME "/linesearchmaxsteps", "Maximum number of backtracking steps per Newton iteration (backtracking line search)", (int_t)8);
     s->DefineSetting(MODULENAME "/linsolv", "Type of linear solver to use", (int_t)OptionConstants::LINEAR_SOLVER_LU);
+    s->DefineSetting(MODULENAME "/localized/enabled", "Restrict the Newton steps of the non-linear solver to the radii which have not yet converged", (bool)false);
+    s->DefineSetting(MODULENAME "/localized/maxfraction", "Maximum fraction of active radii for which the Newton step is restricted to the active radii", (real_t)0.5);
+    s->DefineSetting(MODULENAME "/localized/width", "Number of radii on each side of an unconverged radius which are also kept active in localized Newton iterations", (int_t)1);
+    s->DefineSetting(MODULENAME "/mixedprecision/factortol", "Relative accuracy of the low-precision factorization of the mixed-precision linear solver", (real_t)1e-7);
+    s->DefineSetting(MODULENAME "/mixedprecision/maxiter", "Maximum number of refinement iterations of the mixed-precision linear solver", (int_t)20);
+    s->DefineSetting(MODULENAME "/mixedprecision/method", "Method used to refine the solution of the mixed-precision linear solver", (int_t)OptionConstants::MIXED_PRECISION_REFINEMENT_RICHARDSON);
+    s->DefineSetting(MODULENAME "/mixedprecision/reltol", "Relative tolerance of the refinement in the mixed-precision linear solver", (real_t)1e-12);
+    s->DefineSetting(MODULENAME "/maxcontraction", "Maximum ratio between consecutive Newton step lengths allowed when reusing the jacobian", (real_t)0.5);
     s->DefineSetting(MODULENAME "/maxiter", "Maximum number of nonlinear iterations allowed", (int_t)100);
+    s->DefineSetting(MODULENAME "/nthreads", "Number of threads to use when rebuilding the grids and equation terms, evaluating other quantities and building the jacobian matrix", (int_t)1);
+    s->DefineSetting(MODULENAME "/predictor", "Extrapolation used for the initial guess of the non-linear solver in each time step", (int_t)OptionConstants::SOLVER_PREDICTOR_NONE);
+    s->DefineSetting(MODULENAME "/pseudotransient/enabled", "Use pseudo-transient continuation in the non-linear solver", (bool)false);
+    s->DefineSetting(MODULENAME "/pseudotransient/tau0", "Initial relative pseudo time step of the pseudo-transient continuation", (real_t)1.0);
+    s->DefineSetting(MODULENAME "/pseudotransient/taumax", "Relative pseudo time step above which the pseudo time derivative is dropped", (real_t)1e6);
     s->DefineSetting(MODULENAME "/reltol", "Relative tolerance for nonlinear solver", (real_t)1e-6);
+    s->DefineSetting(MODULENAME "/reproducible", "Evaluate parallel sums in a fixed order, so that the results are independent of the number of threads", (bool)true);
+    s->DefineSetting(MODULENAME "/splitting/fluidsubsteps", "Number of substeps taken by the fluid subsystem in every kinetic step with operator splitting", (int_t)1);
+    s->DefineSetting(MODULENAME "/splitting/scheme", "Scheme to use for splitting the equation system into kinetic and fluid parts in the non-linear solver", (int_t)OptionConstants::SOLVER_SPLITTING_NONE);
+    s->DefineSetting(MODULENAME "/splitting/tolerance", "Maximum ratio between the residual of the coupled system in the split solution and in the initial guess before falling back to a coupled solve", (real_t)1e-3);
+    s->DefineSetting(MODULENAME "/reusefactorization", "If true, the linearly implicit solver reuses the factorization of the matrix in time steps where the matrix is unchanged", (bool)true);
+    s->DefineSetting(MODULENAME "/reusesymbolic", "If true, direct linear solvers reuse the symbolic factorization of the matrix between iterations", (bool)false);
+    s->DefineSetting(MODULENAME "/reducedmodel/basis", "Name of file containing the reduced basis of the reduced-order model (empty = disabled)", (const string)"");
+    s->DefineSetting(MODULENAME "/reducedmodel/tolerance", "Maximum ratio between the residual of the reduced-order solution and of the initial guess before falling back to the full model", (real_t)1e-2);
+    s->DefineSetting(MODULENAME "/savejacobianpattern", "If true, saves the non-zero pattern of the jacobian matrix to the output (for warm-starting other runs)", (bool)false);
+    s->DefineSetting(MODULENAME "/telemetry", "If true, saves convergence information about every iteration of the solver to the output", (bool)false);
     s->DefineSetting(MODULENAME "/verbose", "If true, generates extra output during nonlinear solve", (bool)false);
+    s->DefineSetting(MODULENAME "/warmstart", "Name of DREAM output file of a reference run whose solution is used as initial guess in every time step", (const string)"");
 
     DefineToleranceSettings(MODULENAME, s);
     DefinePreconditionerSettings(s);
@@ -39,10 +94,13 @@ void SimulationGenerator::DefineOptions_Solver(Settings *s) {
     // Debug settings
     s->DefineSetting(MODULENAME "/debug/printmatrixinfo", "Print detailed information about the PETSc matrix", (bool)false);
     s->DefineSetting(MODULENAME "/debug/printjacobianinfo", "Print detailed information about the jacobian PETSc matrix", (bool)false);
+    s->DefineSetting(MODULENAME "/debug/printsparsity", "Print the estimated and actual number of non-zeros in each block of the jacobian, and the fill of its factorization", (bool)false);
+    s->DefineSetting(MODULENAME "/debug/format", "Format in which to save matrices (1 = PETSc binary, 2 = memory-mappable CSR with an index of the unknown blocks)", (int_t)OptionConstants::SOLVER_DEBUG_FORMAT_PETSC);
     s->DefineSetting(MODULENAME "/debug/savejacobian", "If true, saves the jacobian matrix in the specified iteration(s)", (bool)false);
     s->DefineSetting(MODULENAME "/debug/savesolution", "Saves the solution in the specified iteration, i.e. x = (J^-1)F", (bool)false);
     s->DefineSetting(MODULENAME "/debug/savematrix", "If true, saves the linear operator matrix in the specified time step(s)", (bool)false);
     s->DefineSetting(MODULENAME "/debug/savenumericaljacobian", "If true, evaluates the jacobian numerically and saves it for the specified iteration(s)", (bool)false);
+    s->DefineSetting(MODULENAME "/debug/numericaljacobiancoloring", "If true, perturbs several columns at a time when evaluating the jacobian numerically (grouped using the non-zero pattern of the analytical jacobian)", (bool)false);
     s->DefineSetting(MODULENAME "/debug/saverhs", "If true, saves the RHS vector in the specified iteration(s)", (bool)false);
     s->DefineSetting(MODULENAME "/debug/saveresidual", "If true, saves the residual vector in the specified iteration(s)", (bool)false);
     s->DefineSetting(MODULENAME "/debug/savesystem", "If true, saves the full equation system in the most recent iteration/time step", (bool)false);
@@ -63,14 +121,30 @@ void SimulationGenerator::ConstructSolver(EquationSystem *eqsys, Settings *s) {
     FVM::UnknownQuantityHandler *u = eqsys->GetUnknownHandler();
     vector<UnknownQuantityEquation*> *eqns = eqsys->GetEquations();
 
+    // The backend must be selected before any of the
+    // solver matrices and vectors are created
+    ConstructSolverBackend(s);
+
+    enum OptionConstants::solver_splitting splitting =
+        (enum OptionConstants::solver_splitting)s->GetInteger(MODULENAME "/splitting/scheme");
+
+    if (s->GetBool(MODULENAME "/distributed") && type != OptionConstants::SOLVER_TYPE_NONLINEAR)
+        throw SettingsException(
+            "solver: Distributed linear systems are only supported by the non-linear solver."
+        );
+
     Solver *solver;
+    SolverSplit *split = nullptr;
     switch (type) {
         case OptionConstants::SOLVER_TYPE_LINEARLY_IMPLICIT:
             solver = ConstructSolver_linearly_implicit(s, u, eqns, eqsys);
             break;
 
 		case OptionConstants::SOLVER_TYPE_NONLINEAR:
-			solver = ConstructSolver_nonlinear(s, u, eqns, eqsys);
+            if (splitting == OptionConstants::SOLVER_SPLITTING_NONE)
+                solver = ConstructSolver_nonlinear(s, u, eqns, eqsys);
+            else
+                solver = split = ConstructSolver_split(s, u, eqns, eqsys);
 			break;
 
         default:
@@ -79,6 +153,21 @@ void SimulationGenerator::ConstructSolver(EquationSystem *eqsys, Settings *s) {
             );
     }
 
+    // (configured by 'LoadNumberOfThreads()' before the grids are built)
+    const len_t nthreads = FVM::Parallel::GetNumberOfThreads();
+
+    // (the solver only learns about its non-trivial unknowns when
+    // it is assigned to the equation system)
+    vector<len_t> nontrivials = *eqsys->GetNonTrivialUnknowns();
+    if (split == nullptr)
+        ConfigureSolver(s, solver, u, nthreads, nontrivials);
+    else {
+        ConfigureSolver(s, split->GetKineticSolver(), u, nthreads, split->GetKineticUnknowns());
+        ConfigureSolver(s, split->GetFluidSolver(), u, nthreads, split->GetFluidUnknowns());
+        ConfigureSolver(s, split->GetCoupledSolver(), u, nthreads, nontrivials);
+        split->SetTelemetry(s->GetBool(MODULENAME "/telemetry"));
+    }
+
     eqsys->SetSolver(solver);
     solver->SetCollisionHandlers(
         eqsys->GetHotTailCollisionHandler(),
@@ -90,13 +179,63 @@ void SimulationGenerator::ConstructSolver(EquationSystem *eqsys, Settings *s) {
 
     solver->SetIonHandler(eqsys->GetIonHandler());
 
-    solver->SetConvergenceChecker(LoadToleranceSettings(
-        MODULENAME, s, u, solver->GetNonTrivials()
-    ));
+    if (split == nullptr) {
+        solver->SetConvergenceChecker(LoadToleranceSettings(
+            MODULENAME, s, u, solver->GetNonTrivials()
+        ));
+
+        solver->SetPreconditioner(LoadPreconditionerSettings(
+            s, u, solver->GetNonTrivials()
+        ));
+    } else {
+        SolverNonLinear *subsolvers[3] = {
+            split->GetKineticSolver(), split->GetFluidSolver(), split->GetCoupledSolver()
+        };
+        for (SolverNonLinear *sub : subsolvers) {
+            sub->SetConvergenceChecker(LoadToleranceSettings(
+                MODULENAME, s, u, sub->GetNonTrivials()
+            ));
+
+            sub->SetPreconditioner(LoadPreconditionerSettings(
+                s, u, sub->GetNonTrivials()
+            ));
+        }
+    }
+}
+
+/**
+ * Apply the settings which are common to all solver types to
+ * the given solver.
+ *
+ * s:           Settings object to load settings from.
+ * solver:      Solver to configure.
+ * u:           List of unknown quantities.
+ * nthreads:    Number of threads to use.
+ * nontrivials: Non-trivial unknowns which will be solved for
+ *              by the solver.
+ */
+void SimulationGenerator::ConfigureSolver(
+    Settings *s, Solver *solver, FVM::UnknownQuantityHandler *u,
+    const len_t nthreads, const vector<len_t>& nontrivials
+) {
+    solver->SetNumberOfThreads(nthreads);
+    solver->SetReuseSymbolicFactorization(s->GetBool(MODULENAME "/reusesymbolic"));
+    solver->SetFactorOrdering((enum OptionConstants::solver_factor_ordering)s->GetInteger(MODULENAME "/factorordering"));
+    solver->SetDirectAssembly(s->GetBool(MODULENAME "/directassembly"));
+    solver->SetFusedAssembly(s->GetBool(MODULENAME "/fusedassembly"));
+    solver->SetTelemetry(s->GetBool(MODULENAME "/telemetry"));
+
+    enum OptionConstants::solver_debug_format debugformat =
+        (enum OptionConstants::solver_debug_format)s->GetInteger(MODULENAME "/debug/format");
+    if (debugformat != OptionConstants::SOLVER_DEBUG_FORMAT_PETSC &&
+        debugformat != OptionConstants::SOLVER_DEBUG_FORMAT_CSR)
+        throw SettingsException(
+            "solver: Unrecognized debug matrix format: %d.", debugformat
+        );
+    solver->SetDebugFormat(debugformat);
 
-    solver->SetPreconditioner(LoadPreconditionerSettings(
-        s, u, solver->GetNonTrivials()
-    ));
+    solver->SetGMRESFieldSplits(ConstructGMRESFieldSplits(s, u, nontrivials));
+    solver->SetMixedPrecisionOptions(LoadMixedPrecisionOptions(s));
 }
 
 
@@ -125,6 +264,7 @@ SolverLinearlyImplicit *SimulationGenerator::ConstructSolver_linearly_implicit(
 
     auto sli = new SolverLinearlyImplicit(u, eqns, eqsys, linsolv);
     sli->SetDebugMode(printdebug, savematrix, saverhs, timestep, savesystem);
+    sli->SetReuseFactorization(s->GetBool(MODULENAME "/reusefactorization"));
 
     return sli;
 }
@@ -148,16 +288,673 @@ SolverNonLinear *SimulationGenerator::ConstructSolver_nonlinear(
     bool savejacobian = s->GetBool(MODULENAME "/debug/savejacobian");
     bool savesolution = s->GetBool(MODULENAME "/debug/savesolution");
     bool savenumjac   = s->GetBool(MODULENAME "/debug/savenumericaljacobian");
+    bool numjaccolor  = s->GetBool(MODULENAME "/debug/numericaljacobiancoloring");
     bool saveresidual = s->GetBool(MODULENAME "/debug/saveresidual");
     bool printdebug   = s->GetBool(MODULENAME "/debug/printjacobianinfo");
+    bool printsparsity = s->GetBool(MODULENAME "/debug/printsparsity");
     bool rescaled     = s->GetBool(MODULENAME "/debug/rescaled");
     int_t timestep    = s->GetInteger(MODULENAME "/debug/timestep");
     int_t iteration   = s->GetInteger(MODULENAME "/debug/iteration");
     bool savesystem   = s->GetBool(MODULENAME "/debug/savesystem");
 
+    enum OptionConstants::solver_jacobian_update jacupdate =
+        (enum OptionConstants::solver_jacobian_update)s->GetInteger(MODULENAME "/jacobianupdate");
+    real_t maxcontraction = s->GetReal(MODULENAME "/maxcontraction");
+    real_t krylovreltol   = s->GetReal(MODULENAME "/krylovreltol");
+    int_t krylovmaxiter   = s->GetInteger(MODULENAME "/krylovmaxiter");
+
+    switch (jacupdate) {
+        case OptionConstants::SOLVER_JACOBIAN_UPDATE_ALWAYS:
+        case OptionConstants::SOLVER_JACOBIAN_UPDATE_MODIFIED_NEWTON:
+        case OptionConstants::SOLVER_JACOBIAN_UPDATE_NEWTON_KRYLOV:
+        case OptionConstants::SOLVER_JACOBIAN_UPDATE_JFNK:
+            break;
+
+        default:
+            throw SettingsException(
+                "solver: Unrecognized jacobian update strategy: %d.", jacupdate
+            );
+    }
+
+    if (maxcontraction <= 0)
+        throw SettingsException(
+            "solver: Invalid value of 'maxcontraction': %e. Must be positive.", maxcontraction
+        );
+    if (krylovreltol <= 0 || krylovmaxiter < 1)
+        throw SettingsException(
+            "solver: Invalid Krylov solver settings: krylovreltol = %e, krylovmaxiter = " INT_T_PRINTF_FMT ".",
+            krylovreltol, krylovmaxiter
+        );
+
+    enum OptionConstants::solver_line_search linesearch =
+        (enum OptionConstants::solver_line_search)s->GetInteger(MODULENAME "/linesearch");
+    int_t linesearchmaxsteps = s->GetInteger(MODULENAME "/linesearchmaxsteps");
+
+    if (linesearch != OptionConstants::SOLVER_LINE_SEARCH_NONE &&
+        linesearch != OptionConstants::SOLVER_LINE_SEARCH_BACKTRACKING)
+        throw SettingsException(
+            "solver: Unrecognized line search method: %d.", linesearch
+        );
+    else if (linesearchmaxsteps < 1)
+        throw SettingsException(
+            "solver: Invalid maximum number of line search steps: " INT_T_PRINTF_FMT ". "
+            "At least one step is required.", linesearchmaxsteps
+        );
+
+    enum OptionConstants::solver_predictor predictor =
+        (enum OptionConstants::solver_predictor)s->GetInteger(MODULENAME "/predictor");
+
+    if (predictor != OptionConstants::SOLVER_PREDICTOR_NONE &&
+        predictor != OptionConstants::SOLVER_PREDICTOR_LINEAR &&
+        predictor != OptionConstants::SOLVER_PREDICTOR_QUADRATIC)
+        throw SettingsException(
+            "solver: Unrecognized predictor: %d.", predictor
+        );
+
+    bool ew = s->GetBool(MODULENAME "/eisenstatwalker/enabled");
+    real_t ewetamin = s->GetReal(MODULENAME "/eisenstatwalker/etamin");
+    real_t ewetamax = s->GetReal(MODULENAME "/eisenstatwalker/etamax");
+
+    if (ew && (ewetamin <= 0 || ewetamax < ewetamin || ewetamax >= 1))
+        throw SettingsException(
+            "solver: Invalid Eisenstat-Walker tolerances: etamin = %e, etamax = %e. "
+            "Expected 0 < etamin <= etamax < 1.", ewetamin, ewetamax
+        );
+
+    bool ptc = s->GetBool(MODULENAME "/pseudotransient/enabled");
+    real_t ptctau0 = s->GetReal(MODULENAME "/pseudotransient/tau0");
+    real_t ptctaumax = s->GetReal(MODULENAME "/pseudotransient/taumax");
+
+    if (ptc) {
+        if (ptctau0 <= 0 || ptctaumax < ptctau0)
+            throw SettingsException(
+                "solver: Invalid pseudo time steps: tau0 = %e, taumax = %e. "
+                "Both must be positive, with taumax >= tau0.", ptctau0, ptctaumax
+            );
+        // The pseudo time derivative modifies the jacobian
+        // anew in every iteration
+        else if (jacupdate != OptionConstants::SOLVER_JACOBIAN_UPDATE_ALWAYS)
+            throw SettingsException(
+                "solver: Pseudo-transient continuation can only be used when the "
+                "jacobian is updated in every iteration."
+            );
+    }
+
+    // The reduced system is formed from the jacobian of the
+    // current iteration, and its size does not match the blocks
+    // of the GMRES preconditioner
+    int_t backuphold = s->GetInteger(MODULENAME "/backuphold");
+    if (backuphold < 0)
+        throw SettingsException(
+            "solver: Invalid backup solver hold: " INT_T_PRINTF_FMT ". Must be non-negative.",
+            backuphold
+        );
+
+    bool eliminatealgebraic = s->GetBool(MODULENAME "/eliminatealgebraic");
+    if (eliminatealgebraic) {
+        if (jacupdate != OptionConstants::SOLVER_JACOBIAN_UPDATE_ALWAYS)
+            throw SettingsException(
+                "solver: Algebraic unknowns can only be eliminated when the "
+                "jacobian is updated in every iteration."
+            );
+        else if (linsolv == OptionConstants::LINEAR_SOLVER_GMRES ||
+                 backups == OptionConstants::LINEAR_SOLVER_GMRES)
+            throw SettingsException(
+                "solver: Algebraic unknowns can not be eliminated when using "
+                "the GMRES linear solver."
+            );
+    }
+
+    bool borderscalars = s->GetBool(MODULENAME "/borderscalars");
+    if (borderscalars) {
+        if (eliminatealgebraic)
+            throw SettingsException(
+                "solver: Bordered systems can not be combined with the "
+                "elimination of algebraic unknowns."
+            );
+        else if (jacupdate != OptionConstants::SOLVER_JACOBIAN_UPDATE_ALWAYS)
+            throw SettingsException(
+                "solver: Bordered systems can only be used when the "
+                "jacobian is updated in every iteration."
+            );
+        else if (linsolv == OptionConstants::LINEAR_SOLVER_GMRES ||
+                 backups == OptionConstants::LINEAR_SOLVER_GMRES)
+            throw SettingsException(
+                "solver: Bordered systems can not be used with the "
+                "GMRES linear solver."
+            );
+    }
+
+    bool localized = s->GetBool(MODULENAME "/localized/enabled");
+    int_t localizedwidth = s->GetInteger(MODULENAME "/localized/width");
+    real_t localizedmaxfraction = s->GetReal(MODULENAME "/localized/maxfraction");
+    if (localized) {
+        if (eliminatealgebraic || borderscalars)
+            throw SettingsException(
+                "solver: Localized Newton iterations can not be combined with the "
+                "elimination of algebraic unknowns or bordered systems."
+            );
+        else if (jacupdate != OptionConstants::SOLVER_JACOBIAN_UPDATE_ALWAYS)
+            throw SettingsException(
+                "solver: Localized Newton iterations can only be used when the "
+                "jacobian is updated in every iteration."
+            );
+        else if (localizedwidth < 0)
+            throw SettingsException(
+                "solver: Invalid width of localized Newton iterations: " INT_T_PRINTF_FMT ". "
+                "Must be non-negative.", localizedwidth
+            );
+        else if (localizedmaxfraction <= 0 || localizedmaxfraction > 1)
+            throw SettingsException(
+                "solver: Invalid maximum fraction of active radii in localized Newton "
+                "iterations: %e. Must be in the interval (0, 1].", localizedmaxfraction
+            );
+    }
+
+    AdjointSolver::options adjoint;
+    adjoint.objective = s->GetString(MODULENAME "/adjoint/objective");
+    adjoint.parameters = s->GetStringList(MODULENAME "/adjoint/parameters");
+    int_t adjointindex = s->GetInteger(MODULENAME "/adjoint/index");
+
+    len_t ndata_t, ndata_x;
+    const real_t *data_t = s->GetRealArray(MODULENAME "/adjoint/data_t", 1, &ndata_t);
+    const real_t *data_x = s->GetRealArray(MODULENAME "/adjoint/data_x", 1, &ndata_x);
+
+    if (!adjoint.objective.empty()) {
+        if (adjointindex < 0)
+            throw SettingsException(
+                "solver: Invalid index of adjoint objective element: " INT_T_PRINTF_FMT ".",
+                adjointindex
+            );
+        else if (ndata_t != ndata_x)
+            throw SettingsException(
+                "solver: The adjoint objective data has " LEN_T_PRINTF_FMT " time points "
+                "but " LEN_T_PRINTF_FMT " values.", ndata_t, ndata_x
+            );
+        // The jacobian stored in every time step must be
+        // the jacobian evaluated in the converged solution
+        else if (jacupdate != OptionConstants::SOLVER_JACOBIAN_UPDATE_ALWAYS)
+            throw SettingsException(
+                "solver: Adjoint sensitivities can only be evaluated when the "
+                "jacobian is updated in every iteration."
+            );
+
+        adjoint.index = (len_t)adjointindex;
+        adjoint.data_t.assign(data_t, data_t+ndata_t);
+        adjoint.data_x.assign(data_x, data_x+ndata_x);
+    }
+
+    const string rombasis = s->GetString(MODULENAME "/reducedmodel/basis");
+    real_t romtol = s->GetReal(MODULENAME "/reducedmodel/tolerance");
+    if (!rombasis.empty()) {
+        if (romtol <= 0)
+            throw SettingsException(
+                "solver: Invalid reduced-order model tolerance: %e. Must be positive.", romtol
+            );
+        else if (!adjoint.objective.empty())
+            throw SettingsException(
+                "solver: Adjoint sensitivities can not be evaluated with the reduced-order model."
+            );
+    }
+
+    // Every MPI process only assembles and factorizes the
+    // jacobian rows of its own radii
+    bool distributed = s->GetBool(MODULENAME "/distributed");
+    if (distributed) {
+        enum OptionConstants::solver_backend backend =
+            (enum OptionConstants::solver_backend)s->GetInteger(MODULENAME "/backend");
+        enum OptionConstants::solver_splitting splitting =
+            (enum OptionConstants::solver_splitting)s->GetInteger(MODULENAME "/splitting/scheme");
+
+        if (linsolv != OptionConstants::LINEAR_SOLVER_MUMPS &&
+            linsolv != OptionConstants::LINEAR_SOLVER_GMRES)
+            throw SettingsException(
+                "solver: Distributed linear systems can only be solved with the "
+                "MUMPS or GMRES linear solvers."
+            );
+        else if (jacupdate != OptionConstants::SOLVER_JACOBIAN_UPDATE_ALWAYS)
+            throw SettingsException(
+                "solver: Distributed linear systems can only be used when the "
+                "jacobian is updated in every iteration."
+            );
+        else if (eliminatealgebraic || borderscalars || localized)
+            throw SettingsException(
+                "solver: Distributed linear systems can not be combined with the "
+                "elimination of algebraic unknowns, bordered systems or localized "
+                "Newton iterations."
+            );
+        else if (!rombasis.empty() || !adjoint.objective.empty())
+            throw SettingsException(
+                "solver: Distributed linear systems can not be combined with the "
+                "reduced-order model or adjoint sensitivities."
+            );
+        else if (splitting != OptionConstants::SOLVER_SPLITTING_NONE)
+            throw SettingsException(
+                "solver: Distributed linear systems can not be combined with "
+                "operator splitting."
+            );
+        else if (backend != OptionConstants::SOLVER_BACKEND_CPU)
+            throw SettingsException(
+                "solver: Distributed linear systems are only supported on the CPU backend."
+            );
+    }
+
     auto snl = new SolverNonLinear(u, eqns, eqsys, linsolv, backups, maxiter, reltol, verbose);
     snl->SetDebugMode(printdebug, savesolution, savejacobian, saveresidual, savenumjac, timestep, iteration, savesystem, rescaled);
+    snl->SetPrintSparsity(printsparsity);
+    snl->SetNumericalJacobianColoring(numjaccolor);
+    snl->SetJacobianUpdate(jacupdate, maxcontraction, krylovreltol, (len_t)krylovmaxiter);
+    snl->SetLineSearch(linesearch, (len_t)linesearchmaxsteps);
+    snl->SetPredictor(predictor);
+    snl->SetPseudoTransient(ptc, ptctau0, ptctaumax);
+    snl->SetEisenstatWalker(ew, ewetamin, ewetamax);
+    snl->SetAlgebraicElimination(eliminatealgebraic);
+    snl->SetBorderedSystem(borderscalars);
+    snl->SetLocalizedNewton(localized, (len_t)localizedwidth, localizedmaxfraction);
+    snl->SetDistributedSystem(distributed);
+    snl->SetBackupHold((len_t)backuphold);
+    snl->SetWarmStart(s->GetString(MODULENAME "/warmstart"));
+    snl->SetSaveJacobianPattern(s->GetBool(MODULENAME "/savejacobianpattern"));
+    snl->SetAdjointOptions(adjoint);
+    snl->SetReducedModel(rombasis, romtol);
 
     return snl;
 }
 
+/**
+ * Construct a SolverSplit object according to the provided
+ * settings. The kinetic, fluid and coupled solvers are all non-linear
+ * solvers constructed from the same settings, except that the kinetic
+ * solver reuses its factorized jacobian for as long as possible.
+ */
+SolverSplit *SimulationGenerator::ConstructSolver_split(
+	Settings *s, FVM::UnknownQuantityHandler *u,
+	vector<UnknownQuantityEquation*> *eqns,
+    EquationSystem *eqsys
+) {
+    enum OptionConstants::solver_splitting scheme =
+        (enum OptionConstants::solver_splitting)s->GetInteger(MODULENAME "/splitting/scheme");
+    real_t tolerance = s->GetReal(MODULENAME "/splitting/tolerance");
+    int_t fluidsubsteps = s->GetInteger(MODULENAME "/splitting/fluidsubsteps");
+
+    if (scheme != OptionConstants::SOLVER_SPLITTING_LIE &&
+        scheme != OptionConstants::SOLVER_SPLITTING_STRANG)
+        throw SettingsException(
+            "solver: Unrecognized splitting scheme: %d.", scheme
+        );
+    else if (tolerance <= 0)
+        throw SettingsException(
+            "solver: Invalid splitting tolerance: %e. Must be positive.", tolerance
+        );
+    else if (fluidsubsteps < 1)
+        throw SettingsException(
+            "solver: Invalid number of fluid substeps: " INT_T_PRINTF_FMT ". "
+            "At least one substep is required.", fluidsubsteps
+        );
+
+    if (!s->GetString(MODULENAME "/adjoint/objective").empty())
+        throw SettingsException(
+            "solver: Adjoint sensitivities are not supported with operator splitting."
+        );
+    else if (!s->GetString(MODULENAME "/reducedmodel/basis").empty())
+        throw SettingsException(
+            "solver: The reduced-order model is not supported with operator splitting."
+        );
+
+    vector<len_t> kinetic, fluid;
+    SolverSplit::PartitionUnknowns(u, *eqsys->GetNonTrivialUnknowns(), kinetic, fluid);
+    if (kinetic.empty() || fluid.empty())
+        throw SettingsException(
+            "solver: Operator splitting requires the equation system to "
+            "contain both kinetic and fluid non-trivial unknowns."
+        );
+
+    SolverNonLinear *kineticSolver = ConstructSolver_nonlinear(s, u, eqns, eqsys);
+    // With the fluid unknowns frozen, the kinetic equations are
+    // (nearly) linear and the factorized jacobian can be reused
+    // between time steps
+    kineticSolver->SetPseudoTransient(false);
+    kineticSolver->SetJacobianUpdate(
+        OptionConstants::SOLVER_JACOBIAN_UPDATE_MODIFIED_NEWTON,
+        s->GetReal(MODULENAME "/maxcontraction")
+    );
+
+    SolverNonLinear *fluidSolver = ConstructSolver_nonlinear(s, u, eqns, eqsys);
+    SolverNonLinear *coupledSolver = ConstructSolver_nonlinear(s, u, eqns, eqsys);
+
+    return new SolverSplit(
+        u, eqns, kineticSolver, fluidSolver, coupledSolver,
+        kinetic, fluid, scheme, tolerance, (len_t)fluidsubsteps
+    );
+}
+
+
+/**
+ * Construct the list of splits to use for the field-split
+ * preconditioner of the GMRES linear solver. If no splits are
+ * explicitly given, the kinetic unknowns are placed in a first
+ * split and all other unknowns in a second split (coupled to the
+ * first through a Schur complement). With the 'kinetic grids'
+ * preconditioner, the unknowns living on each kinetic grid (e.g.
+ * f_hot and f_re in a two-grid simulation) instead form separate
+ * splits, so that each kinetic block is factorized on its own. The
+ * ion densities can additionally be given a split of their own.
+ *
+ * s:           Settings object to load settings from.
+ * u:           List of unknown quantities.
+ * nontrivials: List of IDs of the non-trivial unknowns.
+ */
+vector<FVM::MIGMRES::split> SimulationGenerator::ConstructGMRESFieldSplits(
+    Settings *s, FVM::UnknownQuantityHandler *u, vector<len_t> nontrivials
+) {
+    enum OptionConstants::gmres_preconditioner pc =
+        (enum OptionConstants::gmres_preconditioner)s->GetInteger(MODULENAME "/gmres/pc");
+    enum OptionConstants::gmres_kinetic_pc kpc =
+        (enum OptionConstants::gmres_kinetic_pc)s->GetInteger(MODULENAME "/gmres/kineticpc");
+    const vector<string> groups = s->GetStringList(MODULENAME "/gmres/splits");
+    const bool ionsplit = s->GetBool(MODULENAME "/gmres/ionsplit");
+
+    vector<FVM::MIGMRES::split> splits;
+    if (pc == OptionConstants::GMRES_PC_BLOCK_JACOBI)
+        return splits;
+    else if (pc != OptionConstants::GMRES_PC_FIELDSPLIT &&
+             pc != OptionConstants::GMRES_PC_KINETIC_GRIDS)
+        throw SettingsException(
+            "solver: Unrecognized GMRES preconditioner: %d.", pc
+        );
+
+    FVM::MIGMRES::split_solver kineticSolver;
+    switch (kpc) {
+        case OptionConstants::GMRES_KINETIC_PC_ILU: kineticSolver = FVM::MIGMRES::SPLIT_SOLVER_ILU; break;
+        case OptionConstants::GMRES_KINETIC_PC_GAMG: kineticSolver = FVM::MIGMRES::SPLIT_SOLVER_GAMG; break;
+        case OptionConstants::GMRES_KINETIC_PC_LU: kineticSolver = FVM::MIGMRES::SPLIT_SOLVER_LU; break;
+        case OptionConstants::GMRES_KINETIC_PC_RADIAL_LU: kineticSolver = FVM::MIGMRES::SPLIT_SOLVER_RADIAL_LU; break;
+        case OptionConstants::GMRES_KINETIC_PC_MG: kineticSolver = FVM::MIGMRES::SPLIT_SOLVER_MG; break;
+        default:
+            throw SettingsException(
+                "solver: Unrecognized preconditioner for kinetic GMRES splits: %d.", kpc
+            );
+    }
+
+    // Kinetic unknowns have more than one element per radius
+    auto isKinetic = [&u](const len_t id) {
+        FVM::Grid *g = u->GetUnknown(id)->GetGrid();
+        return (g->GetNCells() > g->GetNr());
+    };
+
+    vector<bool> assigned(nontrivials.size(), false);
+    if (pc == OptionConstants::GMRES_PC_KINETIC_GRIDS) {
+        if (!groups.empty())
+            DREAM::IO::PrintWarning(
+                "solver: Explicitly given GMRES field splits are ignored "
+                "with the kinetic grids preconditioner."
+            );
+
+        // One split per kinetic grid (in the order in which
+        // the grids appear in the matrix)
+        vector<FVM::Grid*> grids;
+        FVM::MIGMRES::split fluid = {"fluid", {}, FVM::MIGMRES::SPLIT_SOLVER_LU};
+        for (len_t id : nontrivials) {
+            if (!isKinetic(id)) {
+                fluid.unknowns.push_back(id);
+                continue;
+            }
+
+            FVM::Grid *g = u->GetUnknown(id)->GetGrid();
+            auto it = find(grids.begin(), grids.end(), g);
+            if (it == grids.end()) {
+                grids.push_back(g);
+                splits.push_back({"kinetic" + to_string(grids.size()-1), {}, kineticSolver});
+                splits.back().unknowns.push_back(id);
+            } else
+                splits[it-grids.begin()].unknowns.push_back(id);
+        }
+
+        if (!fluid.unknowns.empty()) splits.push_back(fluid);
+    } else if (groups.empty()) {
+        FVM::MIGMRES::split kinetic = {"kinetic", {}, kineticSolver};
+        FVM::MIGMRES::split fluid = {"fluid", {}, FVM::MIGMRES::SPLIT_SOLVER_LU};
+
+        for (len_t id : nontrivials) {
+            if (isKinetic(id)) kinetic.unknowns.push_back(id);
+            else fluid.unknowns.push_back(id);
+        }
+
+        if (!kinetic.unknowns.empty()) splits.push_back(kinetic);
+        if (!fluid.unknowns.empty()) splits.push_back(fluid);
+    } else {
+        for (len_t i = 0; i < groups.size(); i++) {
+            FVM::MIGMRES::split sp = {"split" + to_string(i), {}, FVM::MIGMRES::SPLIT_SOLVER_LU};
+
+            string name;
+            istringstream ss(groups[i]);
+            while (getline(ss, name, ',')) {
+                if (name.empty())
+                    continue;
+                else if (!u->HasUnknown(name))
+                    throw SettingsException(
+                        "solver: Unrecognized unknown quantity in GMRES field split: '%s'.",
+                        name.c_str()
+                    );
+
+                const len_t id = u->GetUnknownID(name);
+                auto it = find(nontrivials.begin(), nontrivials.end(), id);
+                if (it == nontrivials.end())
+                    throw SettingsException(
+                        "solver: The unknown quantity '%s' in the GMRES field split is not solved for in the matrix.",
+                        name.c_str()
+                    );
+                else if (assigned[it-nontrivials.begin()])
+                    throw SettingsException(
+                        "solver: The unknown quantity '%s' appears in more than one GMRES field split.",
+                        name.c_str()
+                    );
+
+                assigned[it-nontrivials.begin()] = true;
+                sp.unknowns.push_back(id);
+
+                if (isKinetic(id))
+                    sp.solver = kineticSolver;
+            }
+
+            if (!sp.unknowns.empty())
+                splits.push_back(sp);
+        }
+
+        // Every unknown must belong to a split; unknowns
+        // not listed explicitly are added to the last split
+        if (!splits.empty()) {
+            for (len_t i = 0; i < nontrivials.size(); i++) {
+                if (!assigned[i]) {
+                    splits.back().unknowns.push_back(nontrivials[i]);
+                    if (isKinetic(nontrivials[i]))
+                        splits.back().solver = kineticSolver;
+                }
+            }
+        }
+    }
+
+    // The ion densities couple all charge states at each radius through
+    // small dense blocks, and may be placed in a split of their own
+    // (before the fluid split), preconditioned with the inverse of the
+    // block of each radius
+    if (ionsplit && !groups.empty() && pc == OptionConstants::GMRES_PC_FIELDSPLIT)
+        DREAM::IO::PrintWarning(
+            "solver: The GMRES ion split is ignored with explicitly given field splits."
+        );
+    else if (ionsplit && u->HasUnknown(OptionConstants::UQTY_ION_SPECIES)) {
+        const len_t id = u->GetUnknownID(OptionConstants::UQTY_ION_SPECIES);
+        if (find(nontrivials.begin(), nontrivials.end(), id) != nontrivials.end()) {
+            for (auto &sp : splits)
+                sp.unknowns.erase(remove(sp.unknowns.begin(), sp.unknowns.end(), id), sp.unknowns.end());
+            splits.erase(
+                remove_if(splits.begin(), splits.end(), [](const FVM::MIGMRES::split &sp) { return sp.unknowns.empty(); }),
+                splits.end()
+            );
+
+            auto it = find_if(splits.begin(), splits.end(), [](const FVM::MIGMRES::split &sp) { return sp.name == "fluid"; });
+            splits.insert(it, {"ions", {id}, FVM::MIGMRES::SPLIT_SOLVER_RADIAL_DENSE});
+        }
+    }
+
+    if (kineticSolver == FVM::MIGMRES::SPLIT_SOLVER_MG) {
+        enum OptionConstants::gmres_mg_lines lines =
+            (enum OptionConstants::gmres_mg_lines)s->GetInteger(MODULENAME "/gmres/mglines");
+
+        FVM::MIGMRES::mg_lines mgLines;
+        switch (lines) {
+            case OptionConstants::GMRES_MG_LINES_P: mgLines = FVM::MIGMRES::MG_LINES_P; break;
+            case OptionConstants::GMRES_MG_LINES_XI: mgLines = FVM::MIGMRES::MG_LINES_XI; break;
+            case OptionConstants::GMRES_MG_LINES_ALTERNATING: mgLines = FVM::MIGMRES::MG_LINES_ALTERNATING; break;
+            default:
+                throw SettingsException(
+                    "solver: Unrecognized multigrid smoother lines: %d.", lines
+                );
+        }
+
+        for (auto &sp : splits)
+            if (sp.solver == FVM::MIGMRES::SPLIT_SOLVER_MG)
+                sp.mgLines = mgLines;
+    }
+
+    if (splits.size() < 2) {
+        DREAM::IO::PrintWarning(
+            "solver: The field-split GMRES preconditioner requires at least two splits. "
+            "Using block Jacobi instead."
+        );
+        splits.clear();
+    }
+
+    return splits;
+}
+
+/**
+ * Load the options for the mixed-precision linear solver.
+ *
+ * s: Settings object to load settings from.
+ */
+FVM::MIMixedPrecision::options SimulationGenerator::LoadMixedPrecisionOptions(Settings *s) {
+    FVM::MIMixedPrecision::options opts;
+
+    enum OptionConstants::mixed_precision_refinement method =
+        (enum OptionConstants::mixed_precision_refinement)s->GetInteger(MODULENAME "/mixedprecision/method");
+    switch (method) {
+        case OptionConstants::MIXED_PRECISION_REFINEMENT_RICHARDSON:
+            opts.method = FVM::MIMixedPrecision::REFINEMENT_METHOD_RICHARDSON; break;
+        case OptionConstants::MIXED_PRECISION_REFINEMENT_GMRES:
+            opts.method = FVM::MIMixedPrecision::REFINEMENT_METHOD_GMRES; break;
+        default:
+            throw SettingsException(
+                "solver: Unrecognized refinement method for the mixed-precision linear solver: %d.",
+                method
+            );
+    }
+
+    opts.factortol = s->GetReal(MODULENAME "/mixedprecision/factortol");
+    opts.reltol = s->GetReal(MODULENAME "/mixedprecision/reltol");
+    int_t maxiter = s->GetInteger(MODULENAME "/mixedprecision/maxiter");
+
+    if (opts.factortol <= 0 || opts.factortol >= 1)
+        throw SettingsException(
+            "solver: Invalid accuracy of the mixed-precision factorization: %e. "
+            "The accuracy must be in the interval (0, 1).", opts.factortol
+        );
+    else if (opts.reltol <= 0)
+        throw SettingsException(
+            "solver: Invalid relative tolerance of the mixed-precision linear solver: %e.",
+            opts.reltol
+        );
+    else if (maxiter < 1)
+        throw SettingsException(
+            "solver: Invalid maximum number of refinement iterations: " INT_T_PRINTF_FMT ". "
+            "At least one iteration is required.", maxiter
+        );
+
+    opts.maxiter = (len_t)maxiter;
+    return opts;
+}
+
+/**
+ * Load the number of threads to use in the simulation, and use it
+ * for all parallel loops (including those of the grid rebuilds and
+ * of the other quantities, which are not given a number of threads
+ * by the solver), together with the reproducible mode of the parallel
+ * sums. Must be called before the grids are constructed.
+ *
+ * s: Settings object to load settings from.
+ */
+void SimulationGenerator::LoadNumberOfThreads(Settings *s) {
+    int_t nthreads = s->GetInteger(MODULENAME "/nthreads");
+    if (nthreads < 1)
+        throw SettingsException(
+            "solver: Invalid number of threads specified: " INT_T_PRINTF_FMT ". "
+            "The number of threads must be at least 1.", nthreads
+        );
+#ifndef _OPENMP
+    if (nthreads > 1) {
+        DREAM::IO::PrintWarning(
+            "DREAM was compiled without OpenMP support. Setting 'solver/nthreads' has no effect."
+        );
+        nthreads = 1;
+    }
+#endif
+
+    FVM::Parallel::SetNumberOfThreads((len_t)nthreads);
+    FVM::Parallel::SetReproducible(s->GetBool(MODULENAME "/reproducible"));
+}
+
+/**
+ * Select the backend to use for the matrices, vectors and linear
+ * solves of the equation system. Only the PETSc LU and GMRES linear
+ * solvers support the GPU backends.
+ *
+ * s: Settings object to load settings from.
+ */
+void SimulationGenerator::ConstructSolverBackend(Settings *s) {
+    enum OptionConstants::solver_backend backend =
+        (enum OptionConstants::solver_backend)s->GetInteger(MODULENAME "/backend");
+
+    switch (backend) {
+        case OptionConstants::SOLVER_BACKEND_CPU:
+        case OptionConstants::SOLVER_BACKEND_CUDA:
+        case OptionConstants::SOLVER_BACKEND_HIP:
+        case OptionConstants::SOLVER_BACKEND_KOKKOS:
+            break;
+
+        default:
+            throw SettingsException(
+                "solver: Unrecognized backend: %d.", backend
+            );
+    }
+
+    enum FVM::PETScBackend::backend b = (enum FVM::PETScBackend::backend)backend;
+    if (!FVM::PETScBackend::IsAvailable(b))
+        throw SettingsException(
+            "solver: The '%s' backend is not available. DREAM must be compiled with "
+            "'DREAM_WITH_GPU' and linked against a PETSc built with support for '%s'.",
+            FVM::PETScBackend::GetName(b), FVM::PETScBackend::GetName(b)
+        );
+
+    if (backend != OptionConstants::SOLVER_BACKEND_CPU) {
+        enum OptionConstants::linear_solver linsolv =
+            (enum OptionConstants::linear_solver)s->GetInteger(MODULENAME "/linsolv");
+        enum OptionConstants::linear_solver backup =
+            (enum OptionConstants::linear_solver)s->GetInteger(MODULENAME "/backupsolver");
+
+        auto onDevice = [](enum OptionConstants::linear_solver ls) {
+            return (
+                ls == OptionConstants::LINEAR_SOLVER_NONE ||
+                ls == OptionConstants::LINEAR_SOLVER_LU ||
+                ls == OptionConstants::LINEAR_SOLVER_GMRES
+            );
+        };
+
+        if (!onDevice(linsolv) || !onDevice(backup))
+            throw SettingsException(
+                "solver: Only the LU and GMRES linear solvers can be used with the '%s' backend.",
+                FVM::PETScBackend::GetName(b)
+            );
+    }
+
+    FVM::PETScBackend::SetBackend(b);
+}
@@ -2,6 +2,7 @@
  * Construct a time stepper object.
  */
 
+#include <cmath>
 #include "DREAM/EquationSystem.hpp"
 #include "DREAM/Settings/SimulationGenerator.hpp"
 #include "DREAM/TimeStepper/TimeStepper.hpp"
@@ -23,13 +24,23 @@ using namespace std;
  */
 void SimulationGenerator::DefineOptions_TimeStepper(Settings *s) {
 	s->DefineSetting(MODULENAME "/automaticstep", "Step length for the automatic determination of the time step in the ionization time stepper.", (real_t)1e-12);
+    s->DefineSetting(MODULENAME "/bdforder", "Maximum order of the BDF method used to discretize time derivatives (1 = backward Euler)", (int_t)1);
     s->DefineSetting(MODULENAME "/checkevery", "Check the error every N'th step (0 = check error after _every_ time step)", (int_t)0);
     s->DefineSetting(MODULENAME "/constantstep", "Override the adaptive stepper and force a constant time step (DEBUG OPTION)", (bool)false);
+    s->DefineSetting(MODULENAME "/controller", "Controller used by the ionization time stepper to determine the time step from the time scale", (int_t)OptionConstants::TIMESTEPPER_IONIZATION_CONTROLLER_SCALE);
     s->DefineSetting(MODULENAME "/dt", "Length of each time step", (real_t)0.0);
-	s->DefineSetting(MODULENAME "/dtmax", "Maximum allowed time step for the adaptive ionization time stepper.", (real_t)0);
+	s->DefineSetting(MODULENAME "/dtmax", "Maximum allowed time step for the adaptive ionization and embedded time steppers.", (real_t)0);
+    s->DefineSetting(MODULENAME "/eventtimes", "Times which time steps should land exactly on", 0, (real_t*)nullptr);
     s->DefineSetting(MODULENAME "/nsavesteps", "Number of time steps to save to output (downsampling)", (int_t)0);
     s->DefineSetting(MODULENAME "/nt", "Number of time steps to take", (int_t)0);
+    s->DefineSetting(MODULENAME "/outputtimes", "Times at which to output the solution, interpolated between time steps (empty = output every saved time step)", 0, (real_t*)nullptr);
+    s->DefineSetting(MODULENAME "/pararealcoarsesteps", "Number of time steps per time window taken by the coarse propagator of the parareal method (0 = parareal disabled)", (int_t)0);
+    s->DefineSetting(MODULENAME "/pararealmaxiter", "Maximum number of parareal iterations", (int_t)10);
+    s->DefineSetting(MODULENAME "/pararealreltol", "Relative tolerance on the change of the time window states in the parareal iteration", (real_t)1e-6);
+    s->DefineSetting(MODULENAME "/prescribedevents", "If true, time steps land exactly on the times at which prescribed data is not smooth", (bool)false);
 	s->DefineSetting(MODULENAME "/safetyfactor", "Safety factor to use when automatically determining the baseline timestep for the adaptive ionization time stepper.", (real_t)50);
+    s->DefineSetting(MODULENAME "/smoothing", "Weight of the previous rates of change when smoothing the rates used by the ionization time stepper (0 = no smoothing)", (real_t)0);
+    s->DefineSetting(MODULENAME "/timescaleunknowns", "Additional unknowns (';'-separated) whose time scales limit the step of the ionization time stepper", (const string)"");
     s->DefineSetting(MODULENAME "/tmax", "Maximum simulation time", (real_t)0.0);
     s->DefineSetting(MODULENAME "/type", "Time step generator type", (int_t)OptionConstants::TIMESTEPPER_TYPE_CONSTANT);
     s->DefineSetting(MODULENAME "/verbose", "If true, generates excessive output", (bool)false);
@@ -63,13 +74,135 @@ void SimulationGenerator::ConstructTimeStepper(EquationSystem *eqsys, Settings *
 			ts = ConstructTimeStepper_ionization(s, u);
 			break;
 
+        case OptionConstants::TIMESTEPPER_TYPE_EMBEDDED:
+            ts = ConstructTimeStepper_embedded(s, u, nontrivials);
+            break;
+
         default:
             throw SettingsException(
                 "Unrecognized time stepper type: %d.", type
             );
     }
 
+    // Order of time integration
+    int_t bdfOrder = s->GetInteger(MODULENAME "/bdforder");
+    if (bdfOrder < 1 || bdfOrder > 5)
+        throw SettingsException(
+            "TimeStepper: Invalid maximum BDF order: " INT_T_PRINTF_FMT ". "
+            "The order must be between 1 and 5.", bdfOrder
+        );
+
+    u->SetMaximumBDFOrder((len_t)bdfOrder);
+
+    // Events which time steps should land on
+    ts->SetEventTimes(LoadTimeStepEvents(s));
+
     eqsys->SetTimeStepper(ts);
+
+    // Fixed output time grid
+    len_t nOutput;
+    const real_t *tOutput = s->GetRealArray(MODULENAME "/outputtimes", 1, &nOutput);
+    if (nOutput > 0) {
+        for (len_t i = 0; i < nOutput; i++) {
+            if (!std::isfinite(tOutput[i]) || tOutput[i] < 0)
+                throw SettingsException(
+                    "TimeStepper: Invalid output time: %e. Output times must be non-negative.",
+                    tOutput[i]
+                );
+        }
+
+        if (s->GetInteger(MODULENAME "/nsavesteps", false) > 0)
+            throw SettingsException(
+                "TimeStepper: The output times and the number of save steps "
+                "('nsavesteps') may not both be set."
+            );
+
+        eqsys->SetOutputTimes(vector<real_t>(tOutput, tOutput+nOutput));
+    }
+
+    // Parallel-in-time solution
+    int_t nCoarse = s->GetInteger(MODULENAME "/pararealcoarsesteps");
+    int_t maxIter = s->GetInteger(MODULENAME "/pararealmaxiter");
+    real_t reltol = s->GetReal(MODULENAME "/pararealreltol");
+    if (nCoarse < 0)
+        throw SettingsException(
+            "TimeStepper: Invalid number of parareal coarse steps: " INT_T_PRINTF_FMT ".",
+            nCoarse
+        );
+    else if (nCoarse > 0) {
+        if (type != OptionConstants::TIMESTEPPER_TYPE_CONSTANT)
+            throw SettingsException(
+                "TimeStepper: The parareal method requires the constant time stepper."
+            );
+        else if (!ts->GetEventTimes().empty())
+            throw SettingsException(
+                "TimeStepper: The parareal method can not be combined with time step events."
+            );
+        else if (nOutput > 0)
+            throw SettingsException(
+                "TimeStepper: The parareal method can not be combined with a fixed output time grid."
+            );
+        else if (maxIter < 1)
+            throw SettingsException(
+                "TimeStepper: Invalid maximum number of parareal iterations: " INT_T_PRINTF_FMT ". "
+                "At least one iteration must be allowed.", maxIter
+            );
+        else if (reltol <= 0)
+            throw SettingsException(
+                "TimeStepper: The parareal tolerance must be positive."
+            );
+
+        eqsys->SetParareal((len_t)nCoarse, (len_t)maxIter, reltol);
+    }
+}
+
+/**
+ * Collect the times which time steps should land exactly on. These
+ * are the explicitly specified event times, together with (if
+ * enabled) the times at which the time-dependent prescribed data
+ * is not smooth: the time points of linearly interpolated data, and
+ * the midpoints between the time points of data interpolated with
+ * the nearest value.
+ *
+ * s: Settings object to load events from.
+ */
+vector<real_t> SimulationGenerator::LoadTimeStepEvents(Settings *s) {
+    len_t n;
+    const real_t *t = s->GetRealArray(MODULENAME "/eventtimes", 1, &n);
+    vector<real_t> events(t, t+n);
+
+    if (!s->GetBool(MODULENAME "/prescribedevents"))
+        return events;
+
+    // All time-dependent prescribed data (see 'LoadPrescribedData.cpp')
+    // is accompanied by a setting specifying its time interpolation
+    const string SUFFIX = "/tinterp";
+    for (const auto& it : s->GetSettings()) {
+        const string& name = it.first;
+        if (name.size() <= SUFFIX.size() ||
+            name.compare(name.size()-SUFFIX.size(), SUFFIX.size(), SUFFIX) != 0)
+            continue;
+
+        const string tname = name.substr(0, name.size()-SUFFIX.size()) + "/t";
+        if (s->GetSettings().count(tname) == 0 || s->GetType(tname) != Settings::SETTING_TYPE_REAL_ARRAY)
+            continue;
+
+        len_t nt;
+        const real_t *tt = s->GetRealArray(tname, 1, &nt, false);
+        if (nt < 2)
+            continue;
+
+        enum OptionConstants::prescribed_data_interp tinterp =
+            (enum OptionConstants::prescribed_data_interp)s->GetInteger(name, false);
+
+        if (tinterp == OptionConstants::PRESCRIBED_DATA_INTERP_NEAREST) {
+            for (len_t i = 0; i+1 < nt; i++)
+                events.push_back(0.5*(tt[i]+tt[i+1]));
+        } else
+            events.insert(events.end(), tt, tt+nt);
+    }
+
+    return events;
 }
 
 
@@ -139,6 +272,34 @@ TimeStepperAdaptive *SimulationGenerator::ConstructTimeStepper_adaptive(
     return new TimeStepperAdaptive(tmax, dt, u, *nontrivials, cc, checkevery, verbose, conststep);
 }
 
+/**
+ * Construct a TimeStepperEmbedded object according to the
+ * provided settings.
+ *
+ * s: Settings object specifying how to construct the
+ *    TimeStepperEmbedded object.
+ */
+TimeStepperEmbedded *SimulationGenerator::ConstructTimeStepper_embedded(
+    Settings *s, FVM::UnknownQuantityHandler *u,
+    vector<len_t> *nontrivials
+) {
+    real_t tmax = s->GetReal(MODULENAME "/tmax");
+    real_t dt = s->GetReal(MODULENAME "/dt");
+    real_t dtmax = s->GetReal(MODULENAME "/dtmax");
+    bool verbose = s->GetBool(MODULENAME "/verbose");
+
+    if (dt <= 0)
+        throw SettingsException("TimeStepper embedded: Initial time step 'dt' must be positive.");
+    else if (dtmax < 0)
+        throw SettingsException("TimeStepper embedded: Maximum time step 'dtmax' must be non-negative.");
+
+    ConvergenceChecker *cc = LoadToleranceSettings(
+        MODULENAME, s, u, *nontrivials
+    );
+
+    return new TimeStepperEmbedded(tmax, dt, dtmax, u, *nontrivials, cc, verbose);
+}
+
 /**
  * Construct a TimeStepperIonization object according to the
  * provided settings.
@@ -155,9 +316,25 @@ TimeStepperIonization *SimulationGenerator::ConstructTimeStepper_ionization(
 	real_t safetyfactor = s->GetReal(MODULENAME "/safetyfactor");
 	real_t tmax = s->GetReal(MODULENAME "/tmax");
 
+	enum OptionConstants::timestepper_ionization_controller controller =
+		(enum OptionConstants::timestepper_ionization_controller)s->GetInteger(MODULENAME "/controller");
+	real_t smoothing = s->GetReal(MODULENAME "/smoothing");
+	vector<string> timescaleUnknowns = s->GetStringList(MODULENAME "/timescaleunknowns");
+
 	if (dt < 0)
 		throw SettingsException("TimeStepper ionization: Initial time step 'dt0' must be non-negative.");
+	else if (controller != OptionConstants::TIMESTEPPER_IONIZATION_CONTROLLER_SCALE &&
+		controller != OptionConstants::TIMESTEPPER_IONIZATION_CONTROLLER_PI)
+		throw SettingsException("TimeStepper ionization: Unrecognized controller: %d.", controller);
+	else if (smoothing < 0 || smoothing >= 1)
+		throw SettingsException("TimeStepper ionization: The smoothing weight must be in the interval [0, 1).");
+
+	auto ts = new TimeStepperIonization(tmax, dt, dtmax, u, automaticstep, safetyfactor);
+	ts->SetController(controller);
+	ts->SetSmoothing(smoothing);
+	for (const string& name : timescaleUnknowns)
+		ts->AddTimeScaleUnknown(name);
 
-	return new TimeStepperIonization(tmax, dt, dtmax, u, automaticstep, safetyfactor);
+	return ts;
 }
 
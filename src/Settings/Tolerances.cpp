@@ -25,6 +25,7 @@ void SimulationGenerator::DefineToleranceSettings(
 
     s->DefineSetting(n + "/reltol",  "General relative tolerance to apply.", (real_t)1e-6);
     s->DefineSetting(n + "/names",   "Names of unknowns to override tolerances for", (const string)"");
+    s->DefineSetting(n + "/norm",    "Norm used to compare the step to the tolerances (1 = 2-norm, 2 = weighted RMS norm)", (int_t)OptionConstants::TOLERANCE_NORM_2NORM);
     s->DefineSetting(n + "/abstols", "List of absolute tolerances to apply to the unknowns in 'names'.", 0, (real_t*)nullptr);
     s->DefineSetting(n + "/reltols", "List of relative tolerances to apply to the unknowns in 'names'.", 0, (real_t*)nullptr);
 }
@@ -52,9 +53,18 @@ ConvergenceChecker *SimulationGenerator::LoadToleranceSettings(
     const real_t *abstols = s->GetRealArray(n + "/abstols", 1, &nabstols);
     const real_t *reltols = s->GetRealArray(n + "/reltols", 1, &nreltols);
 
+    enum OptionConstants::tolerance_norm norm =
+        (enum OptionConstants::tolerance_norm)s->GetInteger(n + "/norm");
+    if (norm != OptionConstants::TOLERANCE_NORM_2NORM &&
+        norm != OptionConstants::TOLERANCE_NORM_WRMS)
+        throw SettingsException(
+            "%s: Unrecognized norm: %d.", n.c_str(), norm
+        );
+
     ConvergenceChecker *cc = new ConvergenceChecker(
         uqh, nontrivials, reltol
     );
+    cc->SetNorm(norm);
 
     // Set tolerances...
     for (len_t i = 0; i < uqtyNames.size(); i++) {
@@ -2,8 +2,10 @@
  * Implementation of various 'Simulation' helper routines.
  */
 
+#include <cmath>
 #include <string>
 #include <softlib/SFile.h>
+#include "DREAM/OutputGeneratorSFile.hpp"
 #include "DREAM/Simulation.hpp"
 
 
@@ -20,7 +22,11 @@ Simulation::Simulation() {}
  * Destructor.
  */
 Simulation::~Simulation() {
-    delete this->adas;
+    if (this->ownsAtomicData) {
+        delete this->adas;
+        delete this->nist;
+        delete this->amjuel;
+    }
 	delete this->outgen;
 }
 
@@ -31,6 +37,108 @@ void Simulation::Run() {
     eqsys->Solve();
 }
 
+/**
+ * Take a single time step with this simulation (which may be
+ * an attempt rejected by the time stepper). The first call prepares
+ * the equation system for advancing in time, and solver data (such
+ * as factorizations) is kept between calls, so that the simulation
+ * can be advanced in small increments (e.g. when coupling to an
+ * external code).
+ *
+ * RETURNS false once the simulation has reached its final time.
+ */
+bool Simulation::Step() {
+    BeginStep();
+
+    if (!this->finished) {
+        if (!eqsys->IsFinished())
+            eqsys->TakeStep();
+
+        FinishStep();
+    }
+
+    return !this->finished;
+}
+
+/**
+ * Advance this simulation until the time 'tTarget' has been reached
+ * (or the simulation is finished). Only complete time steps are
+ * taken, so the simulation ends up at the first time step on or
+ * after 'tTarget' (which coincides with 'tTarget' if the time step
+ * divides the interval to advance over).
+ *
+ * tTarget: Time to advance the simulation to.
+ *
+ * RETURNS false once the simulation has reached its final time.
+ */
+bool Simulation::Step(const real_t tTarget) {
+    // Tolerance for round-off in the accumulated time
+    const real_t tol = 1e-10 * std::abs(tTarget);
+
+    BeginStep();
+
+    while (!this->finished && eqsys->GetCurrentTime() < tTarget-tol)
+        Step();
+
+    return !this->finished;
+}
+
+/**
+ * Prepare the equation system for advancing in time
+ * (if not already done).
+ */
+void Simulation::BeginStep() {
+    if (!this->started) {
+        eqsys->BeginSolve();
+        this->started = true;
+    }
+}
+
+/**
+ * Finish the time advance if the final time has been reached.
+ */
+void Simulation::FinishStep() {
+    if (!this->finished && eqsys->IsFinished()) {
+        eqsys->EndSolve();
+        this->finished = true;
+    }
+}
+
+/**
+ * Returns a pointer to the most recent data of the named unknown
+ * quantity. The data is updated in place as the simulation advances.
+ *
+ * name: Name of unknown quantity.
+ * n:    If not 'nullptr', set to the number of elements of the data.
+ */
+real_t *Simulation::GetUnknownData(const string& name, len_t *n) {
+    FVM::UnknownQuantityHandler *uqh = eqsys->GetUnknownHandler();
+    const len_t id = uqh->GetUnknownID(name);
+
+    if (n != nullptr)
+        *n = uqh->GetUnknown(id)->NumberOfElements();
+
+    return uqh->GetUnknownData(id);
+}
+
+/**
+ * Returns a pointer to a buffer holding the value of the named
+ * prescribed unknown quantity. Values written to the buffer between
+ * time steps replace the prescribed time evolution of the quantity.
+ *
+ * name: Name of prescribed unknown quantity.
+ * n:    If not 'nullptr', set to the number of elements of the data.
+ */
+real_t *Simulation::GetPrescribedData(const string& name, len_t *n) {
+    FVM::UnknownQuantityHandler *uqh = eqsys->GetUnknownHandler();
+    const len_t id = uqh->GetUnknownID(name);
+
+    if (n != nullptr)
+        *n = uqh->GetUnknown(id)->NumberOfElements();
+
+    return eqsys->GetPrescribedData(id);
+}
+
 /**
  * Save the current state of this simulation.
  *
@@ -61,6 +169,19 @@ void Simulation::Save() {
     }*/
 }
 
+/**
+ * Save the output of this simulation to the given SFile object
+ * (rather than to the output file specified in the settings).
+ * This is used to hand over the output without writing it to
+ * disk (using a 'MemorySFile').
+ *
+ * sf: SFile object to save the output to.
+ */
+void Simulation::Save(SFile *sf) {
+    OutputGeneratorSFile ogen(this->eqsys, sf);
+    ogen.Save();
+}
+
 /**
  * Set the output generator to use for saving simulation data.
  *
@@ -0,0 +1,377 @@
+/**
+ * Discrete adjoint sensitivities of a scalar objective with respect to
+ * the scale factors of predetermined (prescribed) unknown quantities.
+ *
+ * With the backward Euler residual F_n(x_n, x_{n-1}, p) = 0 solved in
+ * every time step, and an objective J = sum_n g_n(x_n), the adjoint
+ * variables are obtained by solving, backwards in time,
+ *
+ *   (dF_n/dx_n)^T lambda_n = -dg_n/dx_n - (dF_{n+1}/dx_n)^T lambda_{n+1},
+ *
+ * after which the gradient dJ/dp_k = sum_n lambda_n^T dF_n/dp_k. The
+ * jacobian dF_n/dx_n is assembled by the solver in the converged
+ * solution of every time step and stored until the end of the
+ * simulation. The (sparse) derivatives with respect to the previous
+ * solution and the parameters are evaluated with finite differences
+ * of the residual, which costs one rebuild of the equation terms per
+ * non-trivial unknown and parameter in every time step.
+ *
+ * Two objectives are supported for an element 'x' of a non-trivial
+ * unknown quantity: the value at the final time, J = x(t_final), or a
+ * least-squares fit to measured data,
+ *
+ *   J = 1/2 * sum_n (x(t_n) - d(t_n))^2,
+ *
+ * where the data 'd' is interpolated linearly to the time steps of the
+ * simulation (time steps outside the data range are not included).
+ *
+ * The dependence of the residual on the previous solution is assumed to
+ * be local, i.e. element 'k' of the previous solution of an unknown only
+ * enters the residual of element 'k' of the equations which have the
+ * same number of elements (as is the case for all transient terms).
+ * Only backward Euler time stepping (BDF1) is supported.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include "DREAM/Solver/AdjointSolver.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Constructor.
+ *
+ * solver:      Solver used to advance the system in time.
+ * u:           List of unknown quantities.
+ * nontrivials: List of non-trivial unknowns solved for by the solver.
+ * opts:        Definition of the objective and parameters.
+ */
+AdjointSolver::AdjointSolver(
+    Solver *solver, FVM::UnknownQuantityHandler *u,
+    const vector<len_t>& nontrivials, const struct options& opts
+) : solver(solver), unknowns(u), nontrivials(nontrivials), opts(opts) {
+    if (u->GetMaximumBDFOrder() > 1)
+        throw AdjointSolverException(
+            "Adjoint sensitivities can only be evaluated with backward "
+            "Euler time stepping (maximum BDF order 1)."
+        );
+
+    len_t offset = 0;
+    for (len_t id : nontrivials) {
+        this->offsets.push_back(offset);
+        offset += u->GetUnknown(id)->NumberOfElements();
+    }
+    this->matrixSize = offset;
+
+    // Objective
+    this->objectiveId = u->GetUnknownID(opts.objective);
+    auto it = find(nontrivials.begin(), nontrivials.end(), this->objectiveId);
+    if (it == nontrivials.end())
+        throw AdjointSolverException(
+            "The objective quantity '%s' is not a non-trivial unknown.",
+            opts.objective.c_str()
+        );
+    
+    const len_t N = u->GetUnknown(this->objectiveId)->NumberOfElements();
+    if (opts.index >= N)
+        throw AdjointSolverException(
+            "Invalid index of objective element: " LEN_T_PRINTF_FMT ". "
+            "The quantity '%s' has " LEN_T_PRINTF_FMT " elements.",
+            opts.index, opts.objective.c_str(), N
+        );
+
+    this->objectiveRow = this->offsets[it-nontrivials.begin()] + opts.index;
+
+    if (opts.data_t.size() != opts.data_x.size())
+        throw AdjointSolverException(
+            "The time and value arrays of the objective data must "
+            "have the same number of elements."
+        );
+    for (len_t i = 1; i < opts.data_t.size(); i++) {
+        if (opts.data_t[i] <= opts.data_t[i-1])
+            throw AdjointSolverException(
+                "The time points of the objective data must be strictly increasing."
+            );
+    }
+
+    // Parameters
+    for (const string& p : opts.parameters) {
+        const len_t id = u->GetUnknownID(p);
+        if (find(nontrivials.begin(), nontrivials.end(), id) != nontrivials.end())
+            throw AdjointSolverException(
+                "The parameter quantity '%s' must be a prescribed quantity.",
+                p.c_str()
+            );
+
+        this->parameterIds.push_back(id);
+    }
+
+    this->F0 = new real_t[this->matrixSize];
+    this->Fh = new real_t[this->matrixSize];
+}
+
+/**
+ * Destructor.
+ */
+AdjointSolver::~AdjointSolver() {
+    for (struct step& s : this->steps) {
+        if (s.jacobian != nullptr)
+            MatDestroy(&s.jacobian);
+    }
+
+    delete [] this->Fh;
+    delete [] this->F0;
+}
+
+/**
+ * Interpolate the objective data to the given time.
+ *
+ * t: Time to interpolate data to.
+ * d: On return, contains the interpolated data.
+ *
+ * RETURNS false if 't' lies outside the range of the data.
+ */
+bool AdjointSolver::InterpolateData(const real_t t, real_t *d) {
+    const vector<real_t>& ts = this->opts.data_t;
+    const vector<real_t>& xs = this->opts.data_x;
+    if (ts.empty() || t < ts.front() || t > ts.back())
+        return false;
+    else if (ts.size() == 1) {
+        *d = xs[0];
+        return true;
+    }
+
+    len_t i = upper_bound(ts.begin(), ts.end(), t) - ts.begin();
+    if (i >= ts.size())
+        i = ts.size()-1;
+
+    const real_t w = (t - ts[i-1]) / (ts[i] - ts[i-1]);
+    *d = (1-w)*xs[i-1] + w*xs[i];
+
+    return true;
+}
+
+/**
+ * Record the data needed by the adjoint for the time step which has
+ * just been taken. This method must be called after the non-linear
+ * solver has converged, with the solution stored in the unknown
+ * quantity handler.
+ *
+ * t:   Time at the beginning of the step.
+ * dt:  Length of the time step.
+ * jac: Jacobian matrix of the solver (is overwritten).
+ */
+void AdjointSolver::RecordStep(const real_t t, const real_t dt, FVM::BlockMatrix *jac) {
+    // Discard steps from attempts rejected by the time stepper
+    while (!this->steps.empty() && this->steps.back().t > t + 1e-6*dt) {
+        MatDestroy(&this->steps.back().jacobian);
+        this->steps.pop_back();
+    }
+
+    struct step s;
+    s.t = t + dt;
+
+    // Jacobian and residual in the solution
+    solver->RebuildTerms(t, dt);
+    solver->BuildJacobian(t, dt, jac);
+    MatDuplicate(jac->mat(), MAT_COPY_VALUES, &s.jacobian);
+    solver->BuildVector(t, dt, this->F0, jac);
+
+    this->RecordPreviousStepDerivative(t, dt, jac, s);
+    this->RecordParameterDerivative(t, dt, jac, s);
+
+    // Restore the equation terms
+    solver->RebuildTerms(t, dt);
+
+    s.value = this->unknowns->GetUnknownData(this->objectiveId)[this->opts.index];
+    s.hasData = this->InterpolateData(s.t, &s.data);
+
+    this->steps.push_back(s);
+}
+
+/**
+ * Evaluate the derivative of the residual with respect to the
+ * solution in the previous time step. Each non-trivial unknown is
+ * perturbed in turn (in all of its elements at once), which is
+ * sufficient since the previous solution only enters locally
+ * (see the comment at the top of this file).
+ */
+void AdjointSolver::RecordPreviousStepDerivative(
+    const real_t t, const real_t dt, FVM::BlockMatrix *jac, struct step& s
+) {
+    const real_t delta = 1e-7;
+    vector<real_t> saved, h;
+
+    for (len_t j = 0; j < this->nontrivials.size(); j++) {
+        const len_t id = this->nontrivials[j];
+        const len_t Nj = this->unknowns->GetUnknown(id)->NumberOfElements();
+        real_t *xp = this->unknowns->GetUnknownDataPrevious(id);
+
+        real_t scale = 0;
+        for (len_t k = 0; k < Nj; k++)
+            scale = max(scale, fabs(xp[k]));
+        if (scale == 0)
+            scale = 1;
+
+        saved.assign(xp, xp+Nj);
+        h.resize(Nj);
+        for (len_t k = 0; k < Nj; k++) {
+            xp[k] = saved[k] + delta*(fabs(saved[k]) + 1e-6*scale);
+            h[k] = xp[k] - saved[k];
+        }
+
+        solver->RebuildTerms(t, dt);
+        solver->BuildVector(t, dt, this->Fh, jac);
+
+        for (len_t k = 0; k < Nj; k++)
+            xp[k] = saved[k];
+
+        for (len_t i = 0; i < this->nontrivials.size(); i++) {
+            const len_t Ni = this->unknowns->GetUnknown(this->nontrivials[i])->NumberOfElements();
+            if (Ni != Nj)
+                continue;
+
+            for (len_t k = 0; k < Ni; k++) {
+                const len_t r = this->offsets[i] + k;
+                const real_t d = this->Fh[r] - this->F0[r];
+                if (d == 0)
+                    continue;
+
+                s.prevRows.push_back(r);
+                s.prevCols.push_back(this->offsets[j] + k);
+                s.prevValues.push_back(d / h[k]);
+            }
+        }
+    }
+}
+
+/**
+ * Evaluate the derivative of the residual with respect to the
+ * scale factor of each parameter quantity.
+ */
+void AdjointSolver::RecordParameterDerivative(
+    const real_t t, const real_t dt, FVM::BlockMatrix *jac, struct step& s
+) {
+    const real_t delta = 1e-6;
+    const len_t N = this->matrixSize;
+
+    s.dFdp.resize(this->parameterIds.size() * N);
+    for (len_t k = 0; k < this->parameterIds.size(); k++) {
+        solver->SetPredeterminedScaleFactor(this->parameterIds[k], 1+delta);
+        solver->RebuildTerms(t, dt);
+        solver->BuildVector(t, dt, this->Fh, jac);
+        solver->SetPredeterminedScaleFactor(this->parameterIds[k], 1);
+
+        for (len_t r = 0; r < N; r++)
+            s.dFdp[k*N + r] = (this->Fh[r] - this->F0[r]) / delta;
+    }
+}
+
+/**
+ * Solve the adjoint equations backwards in time and evaluate
+ * the objective and its gradient. The stored jacobians are
+ * released as they are used, so this method can only be
+ * called once (at the end of the simulation).
+ */
+void AdjointSolver::Compute() {
+    if (this->computed)
+        return;
+    this->computed = true;
+
+    const len_t N = this->matrixSize, nP = this->parameterIds.size();
+    const len_t S = this->steps.size();
+    const bool fit = !this->opts.data_t.empty();
+
+    this->gradient.assign(nP, 0);
+    this->objective = 0;
+    if (S == 0)
+        return;
+
+    if (fit) {
+        for (const struct step& s : this->steps)
+            if (s.hasData)
+                this->objective += 0.5*(s.value-s.data)*(s.value-s.data);
+    } else
+        this->objective = this->steps.back().value;
+
+    KSP ksp;
+    PC pc;
+    KSPCreate(PETSC_COMM_SELF, &ksp);
+    KSPSetType(ksp, KSPPREONLY);
+    KSPGetPC(ksp, &pc);
+    PCSetType(pc, PCLU);
+
+    Vec rhs, lambda;
+    VecCreateSeq(PETSC_COMM_SELF, N, &rhs);
+    VecDuplicate(rhs, &lambda);
+
+    vector<real_t> lambdaNext(N, 0);
+    for (len_t n = S; n-- > 0;) {
+        struct step& s = this->steps[n];
+
+        real_t *r;
+        VecGetArray(rhs, &r);
+        for (len_t i = 0; i < N; i++)
+            r[i] = 0;
+
+        if (fit) {
+            if (s.hasData)
+                r[this->objectiveRow] -= s.value - s.data;
+        } else if (n == S-1)
+            r[this->objectiveRow] -= 1;
+
+        if (n+1 < S) {
+            const struct step& sn = this->steps[n+1];
+            for (len_t k = 0; k < sn.prevValues.size(); k++)
+                r[sn.prevCols[k]] -= sn.prevValues[k] * lambdaNext[sn.prevRows[k]];
+        }
+        VecRestoreArray(rhs, &r);
+
+        KSPSetOperators(ksp, s.jacobian, s.jacobian);
+        KSPSolveTranspose(ksp, rhs, lambda);
+
+        const real_t *l;
+        VecGetArrayRead(lambda, &l);
+        for (len_t k = 0; k < nP; k++)
+            for (len_t i = 0; i < N; i++)
+                this->gradient[k] += l[i] * s.dFdp[k*N + i];
+
+        for (len_t i = 0; i < N; i++)
+            lambdaNext[i] = l[i];
+        VecRestoreArrayRead(lambda, &l);
+
+        MatDestroy(&s.jacobian);
+        s.jacobian = nullptr;
+        s.dFdp.clear();
+        s.dFdp.shrink_to_fit();
+    }
+
+    VecDestroy(&lambda);
+    VecDestroy(&rhs);
+    KSPDestroy(&ksp);
+}
+
+/**
+ * Save the objective and its gradient to the given SFile object.
+ *
+ * sf:   SFile object to write data to.
+ * name: Name of group in which the data should be stored.
+ */
+void AdjointSolver::WriteDataSFile(SFile *sf, const string& name) {
+    this->Compute();
+
+    string params;
+    for (const string& p : this->opts.parameters)
+        params += p + ";";
+
+    sf->CreateStruct(name);
+    sf->WriteString(name+"/parameters", params);
+    sf->WriteScalar(name+"/objective", this->objective);
+    sf->WriteList(name+"/gradient", this->gradient.data(), this->gradient.size());
+
+    sf->WriteAttribute_string(name+"/objective", "desc", "Value of the objective");
+    sf->WriteAttribute_string(name+"/gradient", "desc", "Derivative of the objective with respect to the scale factor of each parameter quantity");
+}
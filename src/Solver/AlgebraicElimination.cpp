@@ -0,0 +1,341 @@
+/**
+ * Static elimination of algebraic unknowns from the linear systems of
+ * the Newton iteration.
+ *
+ * Many unknowns are defined by purely algebraic relations with an
+ * evaluable (identity or diagonal) term for the unknown itself, such as
+ * the ohmic current density or the total electron density. Ordering the
+ * rows of the jacobian as (D, A), where 'A' contains the rows of such
+ * unknowns, gives the Newton system
+ *
+ *   [ J_DD  J_DA ] [ x_D ]   [ F_D ]
+ *   [ J_AD  J_AA ] [ x_A ] = [ F_A ],
+ *
+ * and if J_AA is diagonal, the algebraic unknowns can be eliminated
+ * exactly, yielding the smaller system
+ *
+ *   (J_DD - J_DA*J_AA^-1*J_AD) x_D = F_D - J_DA*J_AA^-1*F_A,
+ *
+ * after which x_A = J_AA^-1*(F_A - J_AD*x_D). The solution is identical
+ * to that of the full system (up to round-off), but only the reduced
+ * matrix needs to be factorized.
+ *
+ * An unknown can be eliminated if its equation only depends on the
+ * unknown itself through the diagonal, and if its rows do not couple to
+ * other eliminated unknowns (so that J_AA stays diagonal). Since the
+ * latter is determined by the non-zero pattern of the jacobian, the
+ * unknowns to eliminate are selected from the candidates given when the
+ * jacobian is first reduced, and are selected anew whenever J_AA is
+ * found not to be diagonal.
+ */
+
+#include <set>
+#include "DREAM/Solver/AlgebraicElimination.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Constructor.
+ *
+ * N:          Number of rows in the jacobian matrix.
+ * candidates: Unknowns which may be eliminated from the system (i.e.
+ *             whose equations have an evaluable diagonal term).
+ */
+AlgebraicElimination::AlgebraicElimination(
+    const PetscInt N, const vector<struct block>& candidates
+) : N(N), candidates(candidates) { }
+
+/**
+ * Destructor.
+ */
+AlgebraicElimination::~AlgebraicElimination() {
+    this->DestroyMatrices();
+    this->DestroyVectors();
+
+    ISDestroy(&this->isA);
+    ISDestroy(&this->isD);
+}
+
+/**
+ * Destroy the blocks of the jacobian and the reduced matrix.
+ */
+void AlgebraicElimination::DestroyMatrices() {
+    delete this->reduced;
+    this->reduced = nullptr;
+
+    MatDestroy(&this->Jaa);
+    MatDestroy(&this->Jad);
+    MatDestroy(&this->Jda);
+    MatDestroy(&this->Jdd);
+    MatDestroy(&this->P);
+    MatDestroy(&this->S);
+
+    this->jacobianState = 0;
+}
+
+/**
+ * Destroy the work vectors.
+ */
+void AlgebraicElimination::DestroyVectors() {
+    VecDestroy(&this->Dinv);
+    VecDestroy(&this->Fa);
+    VecDestroy(&this->w);
+    VecDestroy(&this->xa);
+    VecDestroy(&this->Fd);
+    VecDestroy(&this->xd);
+    VecDestroy(&this->yd);
+}
+
+/**
+ * Discard the blocks of the jacobian (and the selection of
+ * unknowns to eliminate). Must be called whenever the
+ * jacobian matrix is reallocated.
+ */
+void AlgebraicElimination::Reset() {
+    this->DestroyMatrices();
+    this->analyzed = false;
+}
+
+
+/**
+ * Select the unknowns to eliminate, based on the non-zero elements
+ * of the given jacobian. Candidates are considered in order, and a
+ * candidate is eliminated if each of its rows has a non-zero diagonal
+ * element and no other non-zero elements in the columns of the
+ * candidate, and if it does not couple to any unknown which has
+ * already been selected for elimination (in either direction).
+ *
+ * J: Jacobian matrix (assembled).
+ */
+void AlgebraicElimination::Analyze(Mat J) {
+    this->DestroyMatrices();
+    this->DestroyVectors();
+
+    const len_t nc = this->candidates.size();
+    vector<PetscInt> blockOf(this->N, -1);
+    for (len_t k = 0; k < nc; k++)
+        for (PetscInt i = 0; i < this->candidates[k].n; i++)
+            blockOf[this->candidates[k].offset + i] = (PetscInt)k;
+
+    vector<char> eligible(nc, 1);
+    vector<set<PetscInt>> couples(nc);
+    for (len_t k = 0; k < nc; k++) {
+        const struct block &b = this->candidates[k];
+        for (PetscInt r = b.offset; r < b.offset+b.n && eligible[k]; r++) {
+            PetscInt ncols;
+            const PetscInt *cols;
+            const PetscScalar *vals;
+            MatGetRow(J, r, &ncols, &cols, &vals);
+
+            bool hasDiagonal = false;
+            for (PetscInt j = 0; j < ncols; j++) {
+                const PetscInt c = cols[j];
+                if (vals[j] == 0)
+                    continue;
+                else if (c == r)
+                    hasDiagonal = true;
+                else if (blockOf[c] == (PetscInt)k)
+                    eligible[k] = 0;
+                else if (blockOf[c] >= 0)
+                    couples[k].insert(blockOf[c]);
+            }
+
+            MatRestoreRow(J, r, &ncols, &cols, &vals);
+
+            if (!hasDiagonal)
+                eligible[k] = 0;
+        }
+    }
+
+    vector<char> selected(nc, 0);
+    vector<char> isEliminated(this->N, 0);
+    this->eliminated.clear();
+    for (len_t k = 0; k < nc; k++) {
+        if (!eligible[k])
+            continue;
+
+        bool independent = true;
+        for (len_t l = 0; l < nc && independent; l++)
+            if (selected[l] && (couples[k].count((PetscInt)l) || couples[l].count((PetscInt)k)))
+                independent = false;
+
+        if (!independent)
+            continue;
+
+        selected[k] = 1;
+        this->eliminated.push_back(this->candidates[k]);
+        for (PetscInt i = 0; i < this->candidates[k].n; i++)
+            isEliminated[this->candidates[k].offset + i] = 1;
+    }
+
+    vector<PetscInt> a, d;
+    for (PetscInt i = 0; i < this->N; i++)
+        (isEliminated[i] ? a : d).push_back(i);
+
+    ISDestroy(&this->isA);
+    ISDestroy(&this->isD);
+
+    // (at least one unknown must remain in the system)
+    if (a.empty() || d.empty()) {
+        this->eliminated.clear();
+        this->nA = 0;
+        this->nD = this->N;
+    } else {
+        this->nA = (PetscInt)a.size();
+        this->nD = (PetscInt)d.size();
+        ISCreateGeneral(PETSC_COMM_SELF, this->nA, a.data(), PETSC_COPY_VALUES, &this->isA);
+        ISCreateGeneral(PETSC_COMM_SELF, this->nD, d.data(), PETSC_COPY_VALUES, &this->isD);
+    }
+
+    this->analyzed = true;
+}
+
+/**
+ * Returns 'true' if the block J_AA of the jacobian is diagonal
+ * with non-zero diagonal elements.
+ */
+bool AlgebraicElimination::IsDiagonal() {
+    for (PetscInt i = 0; i < this->nA; i++) {
+        PetscInt ncols;
+        const PetscInt *cols;
+        const PetscScalar *vals;
+        MatGetRow(this->Jaa, i, &ncols, &cols, &vals);
+
+        PetscScalar diag = 0;
+        bool offDiagonal = false;
+        for (PetscInt j = 0; j < ncols; j++) {
+            if (cols[j] == i)
+                diag = vals[j];
+            else if (vals[j] != 0)
+                offDiagonal = true;
+        }
+
+        MatRestoreRow(this->Jaa, i, &ncols, &cols, &vals);
+
+        if (offDiagonal || diag == 0)
+            return false;
+    }
+
+    return true;
+}
+
+/**
+ * Extract the blocks of the given jacobian and construct the
+ * reduced matrix. As long as the non-zero pattern of the jacobian
+ * is unchanged, the matrices constructed in the previous call are
+ * reused.
+ *
+ * J: Jacobian matrix (assembled).
+ *
+ * RETURNS false if J_AA is not diagonal, i.e. if the currently
+ * selected unknowns can not be eliminated.
+ */
+bool AlgebraicElimination::Build(Mat J) {
+    PetscObjectState state;
+    MatGetNonzeroState(J, &state);
+
+    MatReuse reuse = MAT_REUSE_MATRIX;
+    if (this->Jaa == nullptr || state != this->jacobianState) {
+        this->DestroyMatrices();
+        reuse = MAT_INITIAL_MATRIX;
+    }
+
+    MatCreateSubMatrix(J, this->isA, this->isA, reuse, &this->Jaa);
+    this->jacobianState = state;
+    if (!this->IsDiagonal())
+        return false;
+
+    MatCreateSubMatrix(J, this->isA, this->isD, reuse, &this->Jad);
+    MatCreateSubMatrix(J, this->isD, this->isA, reuse, &this->Jda);
+    MatCreateSubMatrix(J, this->isD, this->isD, reuse, &this->Jdd);
+
+    if (this->Dinv == nullptr) {
+        MatCreateVecs(this->Jaa, &this->Dinv, nullptr);
+        VecDuplicate(this->Dinv, &this->Fa);
+        VecDuplicate(this->Dinv, &this->w);
+        VecDuplicate(this->Dinv, &this->xa);
+
+        MatCreateVecs(this->Jdd, &this->Fd, nullptr);
+        VecDuplicate(this->Fd, &this->xd);
+        VecDuplicate(this->Fd, &this->yd);
+    }
+
+    MatGetDiagonal(this->Jaa, this->Dinv);
+    VecReciprocal(this->Dinv);
+
+    // J_AA^-1*J_AD, and its product with J_DA
+    MatDiagonalScale(this->Jad, this->Dinv, nullptr);
+    MatMatMult(this->Jda, this->Jad, reuse, PETSC_DEFAULT, &this->P);
+
+    if (reuse == MAT_INITIAL_MATRIX) {
+        MatDuplicate(this->Jdd, MAT_COPY_VALUES, &this->S);
+        MatAXPY(this->S, -1, this->P, DIFFERENT_NONZERO_PATTERN);
+
+        this->reduced = new FVM::Matrix(this->nD, this->nD, this->S);
+    } else {
+        // (the non-zero pattern of S contains those of both J_DD and P)
+        MatZeroEntries(this->S);
+        MatAXPY(this->S, 1, this->Jdd, SUBSET_NONZERO_PATTERN);
+        MatAXPY(this->S, -1, this->P, SUBSET_NONZERO_PATTERN);
+    }
+
+    return true;
+}
+
+
+/**
+ * Reduce the Newton system J*dx = F, by eliminating the algebraic
+ * unknowns. After solving the reduced system, with the matrix
+ * 'GetReducedMatrix()' and right-hand side 'GetReducedRHS()', for
+ * 'GetReducedSolution()', the full solution is obtained with
+ * 'Expand()'.
+ *
+ * J: Jacobian matrix (assembled).
+ * F: Right-hand side of the full system.
+ *
+ * RETURNS false if no unknowns can be eliminated, in which case the
+ * full system should be solved instead.
+ */
+bool AlgebraicElimination::Reduce(FVM::Matrix *J, Vec F) {
+    if (!this->analyzed)
+        this->Analyze(J->mat());
+
+    if (this->nA == 0)
+        return false;
+
+    if (!this->Build(J->mat())) {
+        // The jacobian has acquired couplings between the
+        // eliminated unknowns (e.g. after its non-zero pattern
+        // changed), so the unknowns must be selected anew
+        this->Analyze(J->mat());
+        if (this->nA == 0 || !this->Build(J->mat()))
+            return false;
+    }
+
+    // F_D - J_DA*J_AA^-1*F_A
+    VecISCopy(F, this->isA, SCATTER_REVERSE, this->Fa);
+    VecISCopy(F, this->isD, SCATTER_REVERSE, this->Fd);
+    VecPointwiseMult(this->w, this->Dinv, this->Fa);
+    MatMult(this->Jda, this->w, this->yd);
+    VecAXPY(this->Fd, -1, this->yd);
+
+    return true;
+}
+
+/**
+ * Construct the solution of the full Newton system from the
+ * solution of the reduced system.
+ *
+ * dx: On return, contains the solution of the full system.
+ */
+void AlgebraicElimination::Expand(Vec dx) {
+    // x_A = J_AA^-1*F_A - (J_AA^-1*J_AD)*x_D
+    MatMult(this->Jad, this->xd, this->xa);
+    VecAYPX(this->xa, -1, this->w);
+
+    VecISCopy(dx, this->isD, SCATTER_FORWARD, this->xd);
+    VecISCopy(dx, this->isA, SCATTER_FORWARD, this->xa);
+}
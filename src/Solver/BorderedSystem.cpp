@@ -0,0 +1,259 @@
+/**
+ * Solution of the linear systems of the Newton iteration as bordered
+ * systems, with the scalar unknowns (such as the plasma current and
+ * the wall flux of the circuit equations) as the border.
+ *
+ * The scalar unknowns couple to every radius (e.g. through the
+ * boundary condition of Ampère's law at r = r_max), and so their rows
+ * and columns in the jacobian are dense. These dense rows and columns
+ * cause fill in the LU factorization, and make the matrix harder to
+ * order. Ordering the rows of the jacobian as (I, B), where 'B' contains
+ * the rows of the scalar unknowns, gives the Newton system
+ *
+ *   [ J_II  J_IB ] [ x_I ]   [ F_I ]
+ *   [ J_BI  J_BB ] [ x_B ] = [ F_B ],
+ *
+ * where J_II is the sparse, radially local, part of the jacobian. With
+ * Z = J_II^-1*J_IB (one solve with the factorization of J_II per border
+ * unknown), the border unknowns are obtained from the small dense system
+ *
+ *   (J_BB - J_BI*Z) x_B = F_B - J_BI*J_II^-1*F_I,
+ *
+ * after which x_I = J_II^-1*F_I - Z*x_B. Only J_II is factorized by the
+ * linear solver, while the Schur complement J_BB - J_BI*Z (of the size of
+ * the border) is solved with dense Gaussian elimination. The solution is
+ * identical to that of the full system (up to round-off).
+ */
+
+#include <algorithm>
+#include "DREAM/Solver/BorderedSystem.hpp"
+#include "DREAM/Solver/ReducedBasis.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Constructor.
+ *
+ * N:      Number of rows in the jacobian matrix.
+ * border: Unknowns forming the border of the system.
+ */
+BorderedSystem::BorderedSystem(
+    const PetscInt N, const vector<struct block>& border
+) : N(N), border(border) {
+    vector<char> isBorder(N, 0);
+    for (const struct block &b : border)
+        for (PetscInt i = 0; i < b.n; i++)
+            isBorder[b.offset + i] = 1;
+
+    vector<PetscInt> ii, bb;
+    for (PetscInt i = 0; i < N; i++)
+        (isBorder[i] ? bb : ii).push_back(i);
+
+    // (at least one unknown must remain in the interior)
+    if (ii.empty() || bb.empty()) {
+        this->border.clear();
+        return;
+    }
+
+    this->nI = (PetscInt)ii.size();
+    this->nB = (PetscInt)bb.size();
+    ISCreateGeneral(PETSC_COMM_SELF, this->nI, ii.data(), PETSC_COPY_VALUES, &this->isI);
+    ISCreateGeneral(PETSC_COMM_SELF, this->nB, bb.data(), PETSC_COPY_VALUES, &this->isB);
+
+    this->S.resize(this->nB*this->nB);
+    this->Sfac.resize(this->nB*this->nB);
+}
+
+/**
+ * Destructor.
+ */
+BorderedSystem::~BorderedSystem() {
+    this->DestroyMatrices();
+    this->DestroyVectors();
+
+    ISDestroy(&this->isI);
+    ISDestroy(&this->isB);
+}
+
+/**
+ * Destroy the blocks of the jacobian.
+ */
+void BorderedSystem::DestroyMatrices() {
+    delete this->interior;
+    this->interior = nullptr;
+
+    MatDestroy(&this->Jii);
+    MatDestroy(&this->Jib);
+    MatDestroy(&this->Jbi);
+    MatDestroy(&this->Jbb);
+
+    this->jacobianState = 0;
+}
+
+/**
+ * Destroy the work vectors.
+ */
+void BorderedSystem::DestroyVectors() {
+    for (Vec &z : this->Z)
+        VecDestroy(&z);
+    this->Z.clear();
+
+    VecDestroy(&this->Fi);
+    VecDestroy(&this->w);
+    VecDestroy(&this->xi);
+    VecDestroy(&this->col);
+    VecDestroy(&this->Fb);
+    VecDestroy(&this->yb);
+    VecDestroy(&this->xb);
+}
+
+/**
+ * Discard the blocks of the jacobian. Must be called whenever
+ * the jacobian matrix is reallocated.
+ */
+void BorderedSystem::Reset() {
+    this->DestroyMatrices();
+}
+
+
+/**
+ * Extract the blocks of the given jacobian. As long as the non-zero
+ * pattern of the jacobian is unchanged, the matrices constructed in
+ * the previous call are reused (so that the linear solver can also
+ * reuse the symbolic factorization of J_II).
+ *
+ * J: Jacobian matrix (assembled).
+ */
+void BorderedSystem::Build(Mat J) {
+    PetscObjectState state;
+    MatGetNonzeroState(J, &state);
+
+    MatReuse reuse = MAT_REUSE_MATRIX;
+    if (this->Jii == nullptr || state != this->jacobianState) {
+        this->DestroyMatrices();
+        reuse = MAT_INITIAL_MATRIX;
+    }
+
+    MatCreateSubMatrix(J, this->isI, this->isI, reuse, &this->Jii);
+    MatCreateSubMatrix(J, this->isI, this->isB, reuse, &this->Jib);
+    MatCreateSubMatrix(J, this->isB, this->isI, reuse, &this->Jbi);
+    MatCreateSubMatrix(J, this->isB, this->isB, reuse, &this->Jbb);
+    this->jacobianState = state;
+
+    if (this->interior == nullptr)
+        this->interior = new FVM::Matrix(this->nI, this->nI, this->Jii);
+
+    if (this->Fi == nullptr) {
+        MatCreateVecs(this->Jii, &this->w, &this->Fi);
+        VecDuplicate(this->w, &this->xi);
+        VecDuplicate(this->w, &this->col);
+
+        this->Z.resize(this->nB);
+        for (PetscInt j = 0; j < this->nB; j++)
+            VecDuplicate(this->w, &this->Z[j]);
+
+        MatCreateVecs(this->Jbb, &this->xb, &this->Fb);
+        VecDuplicate(this->Fb, &this->yb);
+    }
+}
+
+
+/**
+ * Solve the Newton system J*dx = F as a bordered system. The interior
+ * block J_II is factorized by the given inverter (unless the inverter
+ * has been told to reuse its factorization), and the factorization is
+ * then reused for the columns of J_IB.
+ *
+ * J:        Jacobian matrix (assembled).
+ * F:        Right-hand side of the system.
+ * dx:       On return, contains the solution of the system.
+ * inverter: Linear solver to use for the interior block.
+ *
+ * RETURNS false if the system has no border, in which case the full
+ * system should be solved instead. If the interior solve fails, 'true'
+ * is returned and the error is available from the return code of the
+ * inverter.
+ */
+bool BorderedSystem::Solve(
+    FVM::Matrix *J, Vec F, Vec dx, FVM::MatrixInverter *inverter
+) {
+    if (this->nB == 0)
+        return false;
+
+    this->Build(J->mat());
+
+    // w = J_II^-1*F_I
+    VecISCopy(F, this->isI, SCATTER_REVERSE, this->Fi);
+    VecISCopy(F, this->isB, SCATTER_REVERSE, this->Fb);
+    inverter->Invert(this->interior, &this->Fi, &this->w);
+    if (inverter->GetReturnCode() != 0)
+        return true;
+
+    // Z = J_II^-1*J_IB, with the factorization just computed
+    const bool reuse = inverter->GetReuseFactorization();
+    inverter->SetReuseFactorization(true);
+    for (PetscInt j = 0; j < this->nB; j++) {
+        MatGetColumnVector(this->Jib, this->col, j);
+        inverter->Invert(this->interior, &this->col, &this->Z[j]);
+        if (inverter->GetReturnCode() != 0)
+            break;
+    }
+    inverter->SetReuseFactorization(reuse);
+
+    if (inverter->GetReturnCode() != 0)
+        return true;
+
+    // S = J_BB - J_BI*Z
+    const PetscInt nB = this->nB;
+    vector<PetscInt> idx(nB);
+    for (PetscInt i = 0; i < nB; i++)
+        idx[i] = i;
+    MatGetValues(this->Jbb, nB, idx.data(), nB, idx.data(), this->S.data());
+
+    for (PetscInt j = 0; j < nB; j++) {
+        MatMult(this->Jbi, this->Z[j], this->yb);
+
+        const PetscScalar *y;
+        VecGetArrayRead(this->yb, &y);
+        for (PetscInt i = 0; i < nB; i++)
+            this->S[i*nB+j] -= y[i];
+        VecRestoreArrayRead(this->yb, &y);
+    }
+
+    // x_B = S^-1*(F_B - J_BI*w)
+    MatMult(this->Jbi, this->w, this->yb);
+    VecAYPX(this->yb, -1, this->Fb);
+
+    PetscScalar *xb;
+    VecGetArray(this->yb, &xb);
+    copy(this->S.begin(), this->S.end(), this->Sfac.begin());
+    const bool solved = ReducedBasis::SolveDense((len_t)nB, this->Sfac.data(), xb);
+    VecRestoreArray(this->yb, &xb);
+
+    if (!solved)
+        throw BorderedSystemException(
+            "The Schur complement of the %d border unknown(s) is singular.",
+            (int)nB
+        );
+
+    VecCopy(this->yb, this->xb);
+
+    // x_I = w - Z*x_B
+    vector<PetscScalar> alpha(nB);
+    const PetscScalar *y;
+    VecGetArrayRead(this->xb, &y);
+    for (PetscInt j = 0; j < nB; j++)
+        alpha[j] = -y[j];
+    VecRestoreArrayRead(this->xb, &y);
+
+    VecCopy(this->w, this->xi);
+    VecMAXPY(this->xi, nB, alpha.data(), this->Z.data());
+
+    VecISCopy(dx, this->isI, SCATTER_FORWARD, this->xi);
+    VecISCopy(dx, this->isB, SCATTER_FORWARD, this->xb);
+
+    return true;
+}
@@ -0,0 +1,278 @@
+/**
+ * Solution of the linear systems of the Newton iteration distributed
+ * over all MPI processes, with the radial grid partitioned between the
+ * processes.
+ *
+ * Every process rebuilds the equation terms and evaluates the residual of
+ * the full system, as in a sequential simulation (the equation terms, and
+ * quantities such as the plasma current or flux-surface integrals, operate
+ * on complete radial profiles). The jacobian is however only assembled in
+ * the rows owned by the process (once the non-zero structure of the full
+ * jacobian is known, see 'GetOwnedRows()' and 'FVM::Matrix::SetRowMask()'),
+ * and the linear system, which dominates both the run time and the memory
+ * use of large kinetic simulations, is solved with a distributed (MPI)
+ * matrix. Its rows are ordered by radius, with all
+ * elements of all unknowns at the first radius placed first (as in
+ * 'Solver::ComputeRadialOrdering()'), and each process owns a contiguous
+ * range of radii, selected so that all processes own approximately the
+ * same number of rows. Unknowns which are not resolved radially (such as
+ * the plasma current) are owned by the last process.
+ *
+ * Each process only inserts the rows of its own radii into the distributed
+ * matrix, so that no matrix elements are communicated during assembly. The
+ * system is then solved in parallel (with MUMPS or with GMRES, using one
+ * block Jacobi block per process), and the Newton step is gathered on all
+ * processes. Since every process rebuilds all equation terms from the full
+ * state, the complete step is needed on every process (and not only the
+ * ghost values of its own radii), and all processes then continue with
+ * identical solutions, so that the remainder of the simulation (convergence
+ * checks, time stepping, output) proceeds exactly as in a sequential
+ * simulation.
+ */
+
+#include <algorithm>
+#include "DREAM/Solver/DistributedSystem.hpp"
+#include "DREAM/Solver/Solver.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Constructor.
+ *
+ * N:            Number of rows in the jacobian matrix.
+ * nr:           Number of radial grid points.
+ * rowRadius:    Radial index of each row of the jacobian (or 'nr' for
+ *               rows of unknowns which are not resolved radially).
+ * linearSolver: Linear solver to use for the distributed system
+ *               (MUMPS or GMRES).
+ */
+DistributedSystem::DistributedSystem(
+    const PetscInt N, const len_t nr, const vector<len_t>& rowRadius,
+    enum OptionConstants::linear_solver linearSolver
+) : N(N), nr(nr), linearSolver(linearSolver) {
+    MPI_Comm_rank(PETSC_COMM_WORLD, &this->rank);
+    MPI_Comm_size(PETSC_COMM_WORLD, &this->nproc);
+
+    if (linearSolver != OptionConstants::LINEAR_SOLVER_MUMPS &&
+        linearSolver != OptionConstants::LINEAR_SOLVER_GMRES)
+        throw SolverException(
+            "Distributed linear systems can only be solved with the MUMPS "
+            "or GMRES linear solvers."
+        );
+#ifndef PETSC_HAVE_MUMPS
+    if (linearSolver == OptionConstants::LINEAR_SOLVER_MUMPS)
+        throw SolverException(
+            "Your version of PETSc does not include support for MUMPS. "
+            "To use this linear solver you must recompile PETSc."
+        );
+#endif
+
+    // Order the rows by radius (keeping the order of the
+    // rows at each radius)
+    vector<PetscInt> offset(nr+2, 0);
+    for (PetscInt i = 0; i < N; i++)
+        offset[rowRadius[i]+1]++;
+    for (len_t ir = 0; ir <= nr; ir++)
+        offset[ir+1] += offset[ir];
+
+    this->row.resize(N);
+    this->position.resize(N);
+    vector<PetscInt> next(offset.begin(), offset.end()-1);
+    for (PetscInt i = 0; i < N; i++) {
+        const PetscInt p = next[rowRadius[i]]++;
+        this->row[p] = i;
+        this->position[i] = p;
+    }
+
+    // Partition the radii so that every process owns
+    // approximately the same number of rows
+    const PetscInt R = offset[nr];
+    this->firstRadius.assign(this->nproc+1, nr);
+    this->firstRadius[0] = 0;
+    len_t ir = 0;
+    for (PetscMPIInt k = 1; k < this->nproc; k++) {
+        const PetscInt target = (R*k + this->nproc/2) / this->nproc;
+        while (ir < nr && offset[ir] < target)
+            ir++;
+
+        this->firstRadius[k] = ir;
+    }
+
+    this->rstart = offset[this->firstRadius[this->rank]];
+    this->rend = (this->rank == this->nproc-1 ? N : offset[this->firstRadius[this->rank+1]]);
+
+    this->ownedRows.assign(N, 0);
+    for (PetscInt p = this->rstart; p < this->rend; p++)
+        this->ownedRows[this->row[p]] = 1;
+}
+
+/**
+ * Destructor.
+ */
+DistributedSystem::~DistributedSystem() {
+    this->Destroy();
+}
+
+/**
+ * Destroy the distributed matrix, vectors and linear solver.
+ */
+void DistributedSystem::Destroy() {
+    MatDestroy(&this->Jd);
+    VecDestroy(&this->Fd);
+    VecDestroy(&this->xd);
+    VecDestroy(&this->xall);
+    VecScatterDestroy(&this->gather);
+    KSPDestroy(&this->ksp);
+
+    this->jacobianState = 0;
+}
+
+/**
+ * Discard the distributed matrix. Must be called whenever the
+ * jacobian matrix is reallocated.
+ */
+void DistributedSystem::Reset() {
+    this->Destroy();
+}
+
+/**
+ * Allocate the distributed matrix (preallocated with the non-zero
+ * pattern of the owned rows of the given jacobian), the vectors and
+ * the linear solver.
+ *
+ * J: Jacobian matrix (assembled).
+ */
+void DistributedSystem::Allocate(Mat J) {
+    this->Destroy();
+
+    const PetscInt n = this->rend - this->rstart;
+    vector<PetscInt> dnnz(n, 0), onnz(n, 0);
+    for (PetscInt p = this->rstart; p < this->rend; p++) {
+        PetscInt ncols;
+        const PetscInt *cols;
+        MatGetRow(J, this->row[p], &ncols, &cols, nullptr);
+
+        for (PetscInt j = 0; j < ncols; j++) {
+            const PetscInt c = this->position[cols[j]];
+            if (c >= this->rstart && c < this->rend)
+                dnnz[p-this->rstart]++;
+            else
+                onnz[p-this->rstart]++;
+        }
+
+        MatRestoreRow(J, this->row[p], &ncols, &cols, nullptr);
+    }
+
+    MatCreateAIJ(
+        PETSC_COMM_WORLD, n, n, this->N, this->N,
+        0, dnnz.data(), 0, onnz.data(), &this->Jd
+    );
+    MatSetOption(this->Jd, MAT_NEW_NONZERO_ALLOCATION_ERR, PETSC_FALSE);
+
+    MatCreateVecs(this->Jd, &this->xd, &this->Fd);
+    VecScatterCreateToAll(this->xd, &this->gather, &this->xall);
+
+    KSPCreate(PETSC_COMM_WORLD, &this->ksp);
+    this->SetSolver();
+}
+
+/**
+ * Configure the distributed linear solver.
+ */
+void DistributedSystem::SetSolver() {
+    PC pc;
+    KSPSetOperators(this->ksp, this->Jd, this->Jd);
+    KSPGetPC(this->ksp, &pc);
+
+    if (this->linearSolver == OptionConstants::LINEAR_SOLVER_MUMPS) {
+        PCSetType(pc, PCLU);
+        PCFactorSetMatSolverType(pc, MATSOLVERMUMPS);
+        KSPSetType(this->ksp, KSPPREONLY);
+    } else {
+        // (one block, factorized with ILU, per process)
+        PCSetType(pc, PCBJACOBI);
+        KSPSetType(this->ksp, KSPGMRES);
+    }
+}
+
+
+/**
+ * Solve the Newton system J*dx = F with the distributed matrix.
+ *
+ * J:  Jacobian matrix (assembled, at least in the rows owned by
+ *     this process).
+ * F:  Right-hand side of the system (identical on all processes).
+ * dx: On return, contains the solution of the system (on all
+ *     processes).
+ *
+ * RETURNS false if the linear solver failed.
+ */
+bool DistributedSystem::Solve(FVM::Matrix *J, Vec F, Vec dx) {
+    PetscObjectState state;
+    MatGetNonzeroState(J->mat(), &state);
+
+    // (the matrix must be reallocated on all processes together)
+    int changed = (this->Jd == nullptr || state != this->jacobianState), anyChanged;
+    MPI_Allreduce(&changed, &anyChanged, 1, MPI_INT, MPI_MAX, PETSC_COMM_WORLD);
+    if (anyChanged)
+        this->Allocate(J->mat());
+
+    this->jacobianState = state;
+
+    // Insert the owned rows of the jacobian
+    vector<PetscInt> pcols;
+    for (PetscInt p = this->rstart; p < this->rend; p++) {
+        PetscInt ncols;
+        const PetscInt *cols;
+        const PetscScalar *vals;
+        MatGetRow(J->mat(), this->row[p], &ncols, &cols, &vals);
+
+        pcols.resize(ncols);
+        for (PetscInt j = 0; j < ncols; j++)
+            pcols[j] = this->position[cols[j]];
+
+        MatSetValues(this->Jd, 1, &p, ncols, pcols.data(), vals, INSERT_VALUES);
+        MatRestoreRow(J->mat(), this->row[p], &ncols, &cols, &vals);
+    }
+
+    MatAssemblyBegin(this->Jd, MAT_FINAL_ASSEMBLY);
+    MatAssemblyEnd(this->Jd, MAT_FINAL_ASSEMBLY);
+
+    // ...and of the right-hand side
+    const PetscScalar *f;
+    PetscScalar *fd;
+    VecGetArrayRead(F, &f);
+    VecGetArray(this->Fd, &fd);
+    for (PetscInt p = this->rstart; p < this->rend; p++)
+        fd[p-this->rstart] = f[this->row[p]];
+    VecRestoreArray(this->Fd, &fd);
+    VecRestoreArrayRead(F, &f);
+
+    KSPSetOperators(this->ksp, this->Jd, this->Jd);
+    if (KSPSolve(this->ksp, this->Fd, this->xd) != 0)
+        return false;
+
+    KSPConvergedReason reason;
+    KSPGetConvergedReason(this->ksp, &reason);
+    KSPGetIterationNumber(this->ksp, &this->nIterations);
+    if (reason < 0)
+        return false;
+
+    // Gather the solution on all processes
+    VecScatterBegin(this->gather, this->xd, this->xall, INSERT_VALUES, SCATTER_FORWARD);
+    VecScatterEnd(this->gather, this->xd, this->xall, INSERT_VALUES, SCATTER_FORWARD);
+
+    const PetscScalar *xa;
+    PetscScalar *d;
+    VecGetArrayRead(this->xall, &xa);
+    VecGetArray(dx, &d);
+    for (PetscInt p = 0; p < this->N; p++)
+        d[this->row[p]] = xa[p];
+    VecRestoreArray(dx, &d);
+    VecRestoreArrayRead(this->xall, &xa);
+
+    return true;
+}
@@ -0,0 +1,270 @@
+/**
+ * Localized Newton iterations, in which the Newton steps are only
+ * taken in the radii which have not yet converged.
+ *
+ * In many simulations, the solution only changes rapidly in a small
+ * part of the plasma during a time step (e.g. near a cold front, or
+ * where impurities are deposited), while the remaining radii converge
+ * after one or two Newton iterations. After each global Newton
+ * iteration, the step dx is therefore compared to the tolerances of
+ * the convergence checker in every radius separately, and a radius
+ * is considered converged if, for every non-trivial unknown,
+ *
+ *   |dx(r)| <= abstol/sqrt(nr) + reltol*|x(r)|,
+ *
+ * where |.| denotes the 2-norm over the elements of the unknown in
+ * radius r (so that the global criterion is approximately satisfied
+ * if all radii satisfy this criterion). The unconverged radii, and
+ * 'width' neighbouring radii on each side of them (covering the
+ * radial stencil of the transport operators), are then kept active,
+ * and the next Newton steps solve only the corresponding rows and
+ * columns of the jacobian,
+ *
+ *   J_AA dx_A = F_A,
+ *
+ * with dx = 0 in the frozen radii. Unknowns which are not resolved
+ * radially (such as the plasma current) couple to all radii and are
+ * always active. The residual and jacobian are still evaluated for
+ * the full system, since the equation terms are built on the full
+ * grids, but the (much smaller) reduced system is the only one to be
+ * factorized.
+ *
+ * Since the frozen radii are affected by the changes in the active
+ * radii, a localized step is never accepted as the final step: once
+ * all active radii have converged, a global Newton iteration is taken
+ * to verify convergence of the full system (and to select new active
+ * radii if it has not converged).
+ */
+
+#include <cmath>
+#include "DREAM/Solver/LocalizedNewton.hpp"
+#include "FVM/PETScBackend.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Constructor.
+ *
+ * N:           Number of rows in the jacobian matrix.
+ * nr:          Number of radial grid points.
+ * rowRadius:   Radial index of each row of the jacobian (or 'nr' for
+ *              rows of unknowns which are not resolved radially).
+ * rowUnknown:  Index (into 'nontrivials') of the unknown of each row.
+ * nontrivials: IDs of the non-trivial unknowns.
+ * width:       Number of radii on each side of an unconverged radius
+ *              which are also kept active.
+ * maxFraction: Maximum fraction of active radii for which the reduced
+ *              system is solved (with more active radii, the full
+ *              system is solved instead).
+ */
+LocalizedNewton::LocalizedNewton(
+    const PetscInt N, const len_t nr, const vector<len_t>& rowRadius,
+    const vector<len_t>& rowUnknown, const vector<len_t>& nontrivials,
+    const len_t width, const real_t maxFraction
+) : N(N), nr(nr), rowRadius(rowRadius), rowUnknown(rowUnknown),
+    nontrivials(nontrivials), width(width), maxFraction(maxFraction),
+    activeRadius(nr, false), nActiveRadii(nr) { }
+
+/**
+ * Destructor.
+ */
+LocalizedNewton::~LocalizedNewton() {
+    this->DestroySystem();
+    ISDestroy(&this->isActive);
+}
+
+/**
+ * Destroy the reduced matrix, work vectors and linear solver.
+ */
+void LocalizedNewton::DestroySystem() {
+    MatDestroy(&this->Jaa);
+    VecDestroy(&this->Fa);
+    VecDestroy(&this->xa);
+    KSPDestroy(&this->ksp);
+
+    this->jacobianState = 0;
+}
+
+/**
+ * Make the next Newton iteration global. Must be called at the
+ * start of every time step, and whenever the jacobian matrix is
+ * reallocated.
+ */
+void LocalizedNewton::Reset() {
+    this->local = false;
+    this->nActiveRadii = this->nr;
+    this->activeChanged = true;
+
+    this->DestroySystem();
+}
+
+/**
+ * Construct the index set of the rows belonging to the active
+ * radii (and to the unknowns which are not resolved radially).
+ */
+void LocalizedNewton::SetActiveRows() {
+    vector<PetscInt> rows;
+    for (PetscInt i = 0; i < this->N; i++) {
+        const len_t ir = this->rowRadius[i];
+        if (ir == this->nr || this->activeRadius[ir])
+            rows.push_back(i);
+    }
+
+    ISDestroy(&this->isActive);
+    this->nActive = (PetscInt)rows.size();
+    ISCreateGeneral(PETSC_COMM_SELF, this->nActive, rows.data(), PETSC_COPY_VALUES, &this->isActive);
+}
+
+
+/**
+ * Solve the Newton system J*dx = F restricted to the active radii
+ * (if the current iteration is localized). As long as the active
+ * radii and the non-zero pattern of the jacobian are unchanged, the
+ * reduced matrix of the previous iteration is reused.
+ *
+ * J:  Jacobian matrix (assembled).
+ * F:  Right-hand side of the full system.
+ * dx: On return, contains the solution of the reduced system in the
+ *     active rows, and zero in all other rows.
+ *
+ * RETURNS false if the current iteration is not localized, or if the
+ * reduced system could not be solved, in which case the full system
+ * should be solved instead.
+ */
+bool LocalizedNewton::Solve(FVM::Matrix *J, Vec F, Vec dx) {
+    if (!this->local)
+        return false;
+
+    if (this->activeChanged) {
+        this->DestroySystem();
+        this->SetActiveRows();
+        this->activeChanged = false;
+    }
+
+    PetscObjectState state;
+    MatGetNonzeroState(J->mat(), &state);
+
+    MatReuse reuse = MAT_REUSE_MATRIX;
+    if (this->Jaa == nullptr || state != this->jacobianState) {
+        MatDestroy(&this->Jaa);
+        reuse = MAT_INITIAL_MATRIX;
+    }
+
+    MatCreateSubMatrix(J->mat(), this->isActive, this->isActive, reuse, &this->Jaa);
+    this->jacobianState = state;
+
+    if (this->Fa == nullptr)
+        MatCreateVecs(this->Jaa, &this->xa, &this->Fa);
+
+    PC pc;
+    if (this->ksp == nullptr)
+        KSPCreate(PETSC_COMM_SELF, &this->ksp);
+
+    KSPSetOperators(this->ksp, this->Jaa, this->Jaa);
+    KSPGetPC(this->ksp, &pc);
+    PCSetType(pc, PCLU);
+    FVM::PETScBackend::SetFactorSolverType(pc);
+    KSPSetType(this->ksp, KSPPREONLY);
+
+    VecISCopy(F, this->isActive, SCATTER_REVERSE, this->Fa);
+    if (KSPSolve(this->ksp, this->Fa, this->xa) != 0)
+        return false;
+
+    KSPConvergedReason reason;
+    KSPGetConvergedReason(this->ksp, &reason);
+    if (reason < 0)
+        return false;
+
+    VecSet(dx, 0);
+    VecISCopy(dx, this->isActive, SCATTER_FORWARD, this->xa);
+
+    return true;
+}
+
+/**
+ * Check the convergence of each radius after a Newton iteration,
+ * and select the radii which are active in the next iteration.
+ *
+ * x:         Solution after the Newton iteration.
+ * dx:        Newton step taken in the iteration.
+ * cc:        Convergence checker providing the tolerances.
+ * converged: Whether or not the full system satisfies the global
+ *            convergence criterion of 'cc'.
+ *
+ * RETURNS true if the Newton iteration has converged, i.e. if the
+ * iteration was global and the full system converged. Localized
+ * iterations never converge, but are followed by a global iteration
+ * once all active radii have converged.
+ */
+bool LocalizedNewton::Update(
+    const real_t *x, const real_t *dx, ConvergenceChecker *cc, const bool converged
+) {
+    if (!this->local && converged)
+        return true;
+
+    const len_t nu = this->nontrivials.size();
+    this->x2.assign(nu*this->nr, 0);
+    this->dx2.assign(nu*this->nr, 0);
+    for (PetscInt i = 0; i < this->N; i++) {
+        const len_t ir = this->rowRadius[i];
+        if (ir == this->nr)
+            continue;
+
+        const len_t idx = this->rowUnknown[i]*this->nr + ir;
+        this->x2[idx]  += x[i]*x[i];
+        this->dx2[idx] += dx[i]*dx[i];
+    }
+
+    // Radii which have not converged (in frozen radii, dx = 0)
+    vector<bool> unconverged(this->nr, false);
+    const real_t sqrtNr = sqrt((real_t)this->nr);
+    for (len_t k = 0; k < nu; k++) {
+        const real_t epsa = cc->GetAbsoluteTolerance(this->nontrivials[k]);
+        const real_t epsr = cc->GetRelativeTolerance(this->nontrivials[k]);
+        if (epsa == 0 && epsr == 0)
+            continue;
+
+        for (len_t ir = 0; ir < this->nr; ir++) {
+            const real_t dxn = sqrt(this->dx2[k*this->nr+ir]);
+            const real_t xn  = sqrt(this->x2[k*this->nr+ir]);
+            if (!(dxn <= epsa/sqrtNr + epsr*xn))
+                unconverged[ir] = true;
+        }
+    }
+
+    // Activate the unconverged radii and their neighbours
+    vector<bool> active(this->nr, false);
+    for (len_t ir = 0; ir < this->nr; ir++) {
+        if (!unconverged[ir])
+            continue;
+
+        const len_t i0 = (ir > this->width ? ir-this->width : 0);
+        const len_t i1 = min(ir+this->width, this->nr-1);
+        for (len_t j = i0; j <= i1; j++)
+            active[j] = true;
+    }
+
+    len_t n = 0;
+    for (len_t ir = 0; ir < this->nr; ir++)
+        if (active[ir])
+            n++;
+
+    // With no active radii, the next iteration verifies the
+    // convergence of the full system
+    if (n == 0 || n > this->maxFraction*this->nr) {
+        this->local = false;
+        this->nActiveRadii = this->nr;
+    } else {
+        this->local = true;
+        this->nActiveRadii = n;
+        if (active != this->activeRadius) {
+            this->activeRadius = active;
+            this->activeChanged = true;
+        }
+    }
+
+    return false;
+}
@@ -3,94 +3,179 @@
  * in the non-linear solver.
  */
 
+#include <algorithm>
 #include <iostream>
+#include <vector>
 #include "DREAM/Solver/SolverNonLinear.hpp"
 #include "FVM/BlockMatrix.hpp"
 #include "FVM/UnknownQuantity.hpp"
 
 
 using namespace DREAM;
+using namespace std;
 
 
 /**
  * Evaluate jacobian numerically using finite difference
  * of the residual function.
  *
+ * By default, the columns of the jacobian are perturbed one at a
+ * time, so that every element of the jacobian is resolved, regardless
+ * of the non-zero pattern of the analytical jacobian (which is what
+ * the numerical jacobian is normally compared to). This requires one
+ * residual evaluation per unknown.
+ *
+ * If colouring is enabled (setting 'debug/numericaljacobiancoloring'),
+ * the columns are instead grouped into "colors" such that no two
+ * columns of the same color have a non-zero element in the same row.
+ * All columns of a color are then perturbed simultaneously, so that
+ * the jacobian is obtained from one residual evaluation per color.
+ * The non-zero pattern used is that of the matrix 'jac' on entry,
+ * which is assumed to have been assembled. Elements outside of that
+ * pattern are not resolved (but contaminate the elements of the other
+ * columns of the same color in that row), and so colouring should
+ * only be used when the pattern of the analytical jacobian is known
+ * to be complete.
+ *
+ * The colours are evaluated one after the other, since each evaluation
+ * stores its perturbed state in the (shared) unknown quantity handler and
+ * rebuilds all equation terms from it. Each evaluation is however itself
+ * carried out with the configured number of threads (both the rebuild of
+ * the terms and the evaluation of the residual, see '_EvaluateF()').
+ *
  * jac: Jacobian matrix.
  */
 void SolverNonLinear::_EvaluateJacobianNumerically(
     FVM::BlockMatrix *jac
 ) {
-    printf("Evaluating Jacobian numerically...   0.00%%");
-
     len_t nSize = this->unknowns->GetLongVectorSize(this->nontrivial_unknowns);
     const real_t *iniVec = this->unknowns->GetLongVector(this->nontrivial_unknowns);
 
-    real_t *dFVec   = new real_t[nSize];
+    const bool coloring = this->numjaccoloring;
+    len_t nColors = 0;
+    vector<len_t> colColor(nSize);
+    vector<vector<PetscInt>> colRows;
+
+    if (coloring) {
+        // Determine which rows each column contributes to
+        vector<vector<PetscInt>> rowCols;
+        jac->SetOffset(0, 0);
+        jac->GetSparsityPattern(rowCols);
+
+        colRows.resize(nSize);
+        for (len_t i = 0; i < rowCols.size(); i++) {
+            for (PetscInt j : rowCols[i])
+                colRows[j].push_back(i);
+            // Always evaluate the diagonal
+            if (i < nSize && std::find(rowCols[i].begin(), rowCols[i].end(), (PetscInt)i) == rowCols[i].end()) {
+                rowCols[i].push_back(i);
+                colRows[i].push_back(i);
+            }
+        }
+
+        // Greedy colouring of the columns
+        vector<len_t> forbidden;    // 'forbidden[c] == j+1' <=> color 'c' not allowed for column 'j'
+        for (len_t j = 0; j < nSize; j++) {
+            for (PetscInt i : colRows[j])
+                for (PetscInt k : rowCols[i])
+                    if ((len_t)k < j)
+                        forbidden[colColor[k]] = j+1;
+
+            len_t c = 0;
+            while (c < nColors && forbidden[c] == j+1)
+                c++;
+
+            if (c == nColors) {
+                nColors++;
+                forbidden.push_back(0);
+            }
+            colColor[j] = c;
+        }
+    } else {
+        // One column at a time
+        nColors = nSize;
+        for (len_t j = 0; j < nSize; j++)
+            colColor[j] = j;
+    }
+
+    vector<vector<len_t>> colorCols(nColors);
+    for (len_t j = 0; j < nSize; j++)
+        colorCols[colColor[j]].push_back(j);
+
+    if (coloring)
+        printf("Evaluating Jacobian numerically (" LEN_T_PRINTF_FMT " colors)...   0.00%%", nColors);
+    else
+        printf("Evaluating Jacobian numerically...   0.00%%");
+
     real_t *FVec    = new real_t[nSize];
     real_t *iniFVec = new real_t[nSize];
     real_t *xhVec   = new real_t[nSize];
+    real_t *hSteps  = new real_t[nSize];
     
     // Copy initial vector to shifted solution vector
     for (len_t i = 0; i < nSize; i++)
         xhVec[i] = iniVec[i];
 
-    jac->SetOffset(0, 0);
     jac->Zero();
 
     this->_EvaluateF(iniVec, iniFVec, jac);
 
     const real_t h = 1e-6, hDefault = 10;
-    len_t index = 0;
-    for (auto uid : this->nontrivial_unknowns) {
-        FVM::UnknownQuantity *uqn = this->unknowns->GetUnknown(uid);
-        const len_t N = uqn->NumberOfElements();
-
-        // Differentiate w.r.t. index...
-        for (len_t _i = 0; _i < N; _i++, index++) {
-            // Restore previous element
-            if (index > 0)
-                xhVec[index-1] = iniVec[index-1];
-
+    for (len_t c = 0; c < nColors; c++) {
+        // Perturb all columns of this color
+        for (len_t j : colorCols[c]) {
             // Determine derivative step length
-            real_t hStep;
-            if (iniVec[index] == 0)
-                hStep = hDefault;
+            if (iniVec[j] == 0)
+                hSteps[j] = hDefault;
             else
-                hStep = h*iniVec[index];
-
-            xhVec[index] += hStep;
+                hSteps[j] = h*iniVec[j];
 
-            // Evaluate F(x+h)
-            this->_EvaluateF(xhVec, FVec, jac);
-
-            // Evaluate dF/dx_index
-            for (len_t j = 0; j < nSize; j++)
-                dFVec[j] = (FVec[j]-iniFVec[j]) / hStep;
+            xhVec[j] += hSteps[j];
+        }
 
-            // Set Jacobian column
-            for (len_t j = 0; j < nSize; j++) {
-                if (dFVec[j] != 0)
-                    jac->SetElement(j, index, dFVec[j], INSERT_VALUES);
+        // Evaluate F(x+h)
+        this->_EvaluateF(xhVec, FVec, jac);
+
+        // Set Jacobian columns (and restore solution vector)
+        for (len_t j : colorCols[c]) {
+            if (coloring) {
+                for (PetscInt i : colRows[j]) {
+                    real_t dF = (FVec[i]-iniFVec[i]) / hSteps[j];
+                    if (dF != 0)
+                        jac->SetElement(i, j, dF, INSERT_VALUES);
+                }
+            } else {
+                for (len_t i = 0; i < nSize; i++) {
+                    real_t dF = (FVec[i]-iniFVec[i]) / hSteps[j];
+                    if (dF != 0)
+                        jac->SetElement(i, j, dF, INSERT_VALUES);
+                }
             }
 
-            printf("\b\b\b\b\b\b\b%6.2f%%", double(index)/double(nSize-1)*100);
-            std::cout << std::flush;
+            xhVec[j] = iniVec[j];
         }
+
+        printf("\b\b\b\b\b\b\b%6.2f%%", double(c+1)/double(nColors)*100);
+        std::cout << std::flush;
     }
 
     printf("\n");
 
     jac->Assemble();
 
+    // Restore unknowns
+    this->_EvaluateF(iniVec, iniFVec, jac);
+
+    delete [] hSteps;
     delete [] xhVec;
     delete [] iniFVec;
     delete [] FVec;
-    delete [] dFVec;
+    delete [] iniVec;
 }
 
 /**
- * Evaluate the non-linear function 'F'.
+ * Evaluate the non-linear function 'F' (with the equations
+ * evaluated in parallel, see 'BuildVector_parallel()').
  *
  * xVec: Point in which to evaluate the function.
  * FVec: Contains function value on return.
@@ -104,6 +189,6 @@ void SolverNonLinear::_EvaluateF(const real_t *xVec, real_t *FVec, FVM::BlockMat
     }
 
     this->RebuildTerms(this->CurrentTime(), this->CurrentTimeStep());
-    this->BuildVector(this->CurrentTime(), this->CurrentTimeStep(), FVec, jac);
+    this->BuildVector_parallel(this->CurrentTime(), this->CurrentTimeStep(), FVec, jac);
 }
 
@@ -0,0 +1,274 @@
+/**
+ * Reduced basis for the projection-based reduced-order model (ROM) of
+ * the non-linear solver. The basis is obtained by proper orthogonal
+ * decomposition (POD) of the solutions of a set of training runs (see
+ * 'DREAM.ReducedBasis' in the Python interface), and the solution is
+ * approximated as
+ *
+ *   x = xm + S*U*q,
+ *
+ * where 'xm' is the mean of the training snapshots, 'S' is a diagonal
+ * matrix containing the scale of each unknown quantity (with which the
+ * snapshots were normalized before the decomposition), 'U' contains the
+ * orthonormal POD modes and 'q' are the reduced coordinates. The reduced
+ * equations are obtained by Galerkin projection of the scaled residual,
+ * U^T*S^-1*F(x) = 0, and are solved with Newton's method with the
+ * reduced jacobian U^T*S^-1*J*S*U.
+ *
+ * The basis file contains, for every non-trivial unknown quantity, the
+ * datasets 'mean/NAME' (N elements), 'scale/NAME' (scalar) and
+ * 'basis/NAME' (nModes-by-N).
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <softlib/SFile.h>
+#include "DREAM/Solver/ReducedBasis.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Constructor.
+ *
+ * filename:    Name of file to load the reduced basis from.
+ * u:           List of unknown quantities.
+ * nontrivials: List of non-trivial unknowns solved for by the solver.
+ */
+ReducedBasis::ReducedBasis(
+    const string& filename, FVM::UnknownQuantityHandler *u,
+    const vector<len_t>& nontrivials
+) {
+    SFile *sf = SFile::Create(filename, SFILE_MODE_READ);
+
+    this->N = 0;
+    for (len_t id : nontrivials)
+        this->N += u->GetUnknown(id)->NumberOfElements();
+
+    // Load the basis of each unknown (all quantities must be
+    // represented by the same number of modes)
+    vector<real_t*> bases;
+    vector<real_t> scales;
+    this->mean = new real_t[this->N];
+    this->nModes = 0;
+
+    len_t offset = 0;
+    for (len_t id : nontrivials) {
+        const string& name = u->GetUnknown(id)->GetName();
+        const len_t n = u->GetUnknown(id)->NumberOfElements();
+
+        if (!sf->HasVariable("basis/"+name) || !sf->HasVariable("mean/"+name) ||
+            !sf->HasVariable("scale/"+name))
+            throw ReducedBasisException(
+                "The reduced basis in '%s' does not contain the unknown quantity '%s'.",
+                filename.c_str(), name.c_str()
+            );
+
+        sfilesize_t ndims, dims[4];
+        real_t *m = sf->GetMultiArray_linear("mean/"+name, 4, ndims, dims);
+        sfilesize_t nm = 1;
+        for (sfilesize_t i = 0; i < ndims; i++)
+            nm *= dims[i];
+
+        real_t *b = sf->GetMultiArray_linear("basis/"+name, 4, ndims, dims);
+        sfilesize_t nb = 1;
+        for (sfilesize_t i = 1; i < ndims; i++)
+            nb *= dims[i];
+
+        if (nm != n || nb != n || (this->nModes > 0 && dims[0] != this->nModes)) {
+            delete [] m;
+            delete [] b;
+            throw ReducedBasisException(
+                "The size of the reduced basis of '%s' in '%s' does not match the simulation.",
+                name.c_str(), filename.c_str()
+            );
+        }
+
+        this->nModes = dims[0];
+        for (len_t i = 0; i < n; i++)
+            this->mean[offset+i] = m[i];
+
+        bases.push_back(b);
+        scales.push_back((real_t)sf->GetScalar("scale/"+name));
+
+        delete [] m;
+        offset += n;
+    }
+
+    sf->Close();
+    delete sf;
+
+    if (this->nModes == 0)
+        throw ReducedBasisException(
+            "The reduced basis in '%s' contains no modes.", filename.c_str()
+        );
+
+    // Assemble the trial and test bases
+    this->trial = new real_t[this->nModes*this->N];
+    this->test  = new real_t[this->nModes*this->N];
+
+    offset = 0;
+    for (len_t k = 0; k < nontrivials.size(); k++) {
+        const len_t n = u->GetUnknown(nontrivials[k])->NumberOfElements();
+        const real_t s = scales[k];
+        if (s <= 0)
+            throw ReducedBasisException(
+                "Invalid scale of unknown quantity '%s' in the reduced basis: %e.",
+                u->GetUnknown(nontrivials[k])->GetName().c_str(), s
+            );
+
+        for (len_t j = 0; j < this->nModes; j++)
+            for (len_t i = 0; i < n; i++) {
+                const real_t v = bases[k][j*n + i];
+                this->trial[j*this->N + offset+i] = s*v;
+                this->test[j*this->N + offset+i]  = v/s;
+            }
+
+        delete [] bases[k];
+        offset += n;
+    }
+
+    this->Jv = new real_t[this->N];
+    VecCreateSeqWithArray(PETSC_COMM_SELF, 1, this->N, nullptr, &this->petsc_v);
+    VecCreateSeqWithArray(PETSC_COMM_SELF, 1, this->N, this->Jv, &this->petsc_Jv);
+}
+
+/**
+ * Destructor.
+ */
+ReducedBasis::~ReducedBasis() {
+    VecDestroy(&this->petsc_Jv);
+    VecDestroy(&this->petsc_v);
+
+    delete [] this->Jv;
+    delete [] this->test;
+    delete [] this->trial;
+    delete [] this->mean;
+}
+
+/**
+ * Evaluate the reduced coordinates of the given solution,
+ * q = U^T*S^-1*(x - xm).
+ *
+ * x: Full-order solution (N elements).
+ * q: On return, contains the reduced coordinates (nModes elements).
+ */
+void ReducedBasis::Project(const real_t *x, real_t *q) const {
+    for (len_t j = 0; j < this->nModes; j++) {
+        const real_t *w = this->test + j*this->N;
+        real_t s = 0;
+        for (len_t i = 0; i < this->N; i++)
+            s += w[i] * (x[i] - this->mean[i]);
+
+        q[j] = s;
+    }
+}
+
+/**
+ * Evaluate the full-order solution corresponding to the given
+ * reduced coordinates, x = xm + S*U*q.
+ *
+ * q: Reduced coordinates (nModes elements).
+ * x: On return, contains the full-order solution (N elements).
+ */
+void ReducedBasis::Expand(const real_t *q, real_t *x) const {
+    for (len_t i = 0; i < this->N; i++)
+        x[i] = this->mean[i];
+
+    for (len_t j = 0; j < this->nModes; j++) {
+        const real_t *v = this->trial + j*this->N;
+        for (len_t i = 0; i < this->N; i++)
+            x[i] += v[i] * q[j];
+    }
+}
+
+/**
+ * Project the given full-order residual onto the
+ * reduced space, Fr = U^T*S^-1*F.
+ *
+ * F:  Full-order residual (N elements).
+ * Fr: On return, contains the reduced residual (nModes elements).
+ */
+void ReducedBasis::ProjectResidual(const real_t *F, real_t *Fr) const {
+    for (len_t j = 0; j < this->nModes; j++) {
+        const real_t *w = this->test + j*this->N;
+        real_t s = 0;
+        for (len_t i = 0; i < this->N; i++)
+            s += w[i] * F[i];
+
+        Fr[j] = s;
+    }
+}
+
+/**
+ * Project the given full-order jacobian onto the reduced space,
+ * Jr = U^T*S^-1*J*S*U.
+ *
+ * J:  Full-order jacobian (N-by-N).
+ * Jr: On return, contains the reduced jacobian (nModes-by-nModes,
+ *     row-major).
+ */
+void ReducedBasis::ProjectJacobian(Mat J, real_t *Jr) {
+    const len_t K = this->nModes;
+    for (len_t j = 0; j < K; j++) {
+        VecPlaceArray(this->petsc_v, this->trial + j*this->N);
+        MatMult(J, this->petsc_v, this->petsc_Jv);
+        VecResetArray(this->petsc_v);
+
+        for (len_t i = 0; i < K; i++) {
+            const real_t *w = this->test + i*this->N;
+            real_t s = 0;
+            for (len_t l = 0; l < this->N; l++)
+                s += w[l] * this->Jv[l];
+
+            Jr[i*K + j] = s;
+        }
+    }
+}
+
+/**
+ * Solve the dense linear system A*x = b using Gaussian
+ * elimination with partial pivoting. The reduced systems are
+ * small (a few tens of modes), so no library is needed for this.
+ *
+ * n: Number of unknowns.
+ * A: Matrix of the system (n-by-n, row-major; destroyed on return).
+ * b: Right-hand side (n elements). On return, contains the solution.
+ *
+ * RETURNS false if the matrix is singular.
+ */
+bool ReducedBasis::SolveDense(const len_t n, real_t *A, real_t *b) {
+    for (len_t k = 0; k < n; k++) {
+        len_t p = k;
+        for (len_t i = k+1; i < n; i++)
+            if (fabs(A[i*n+k]) > fabs(A[p*n+k]))
+                p = i;
+
+        if (A[p*n+k] == 0 || !std::isfinite(A[p*n+k]))
+            return false;
+
+        if (p != k) {
+            for (len_t j = 0; j < n; j++)
+                std::swap(A[k*n+j], A[p*n+j]);
+            std::swap(b[k], b[p]);
+        }
+
+        for (len_t i = k+1; i < n; i++) {
+            const real_t f = A[i*n+k] / A[k*n+k];
+            for (len_t j = k; j < n; j++)
+                A[i*n+j] -= f*A[k*n+j];
+            b[i] -= f*b[k];
+        }
+    }
+
+    for (len_t k = n; k-- > 0;) {
+        real_t s = b[k];
+        for (len_t j = k+1; j < n; j++)
+            s -= A[k*n+j]*b[j];
+        b[k] = s / A[k*n+k];
+    }
+
+    return true;
+}
@@ -2,14 +2,20 @@
  * Implementation of common routines for the 'Solver' routines.
  */
 
+#include <algorithm>
+#include <cmath>
+#include <exception>
 #include <iostream>
-
+#include <map>
 #include <vector>
 #include "DREAM/IO.hpp"
 #include "DREAM/Solver/Solver.hpp"
 #include "DREAM/UnknownQuantityEquation.hpp"
 #include "FVM/BlockMatrix.hpp"
 #include "FVM/Equation/PrescribedParameter.hpp"
+#include "FVM/NormEvaluator.hpp"
+#include "FVM/Parallel.hpp"
+#include "FVM/ScratchArena.hpp"
 #include "FVM/UnknownQuantity.hpp"
 
 // Linear solvers
@@ -59,68 +65,300 @@ Solver::~Solver() {
 /**
  * Build a jacobian matrix for the equation system.
  *
+ * The contributions of operators whose jacobian is constant during
+ * a time step (see 'FVM::Operator::IsJacobianConstant()') are only
+ * built in the first iteration of each time step, after which the
+ * assembled values are saved as the base jacobian. In the following
+ * iterations, the values of the base jacobian are copied back into
+ * the matrix, and only the remaining contributions are added to it.
+ * If the base can not be restored (e.g. because the non-zero
+ * structure of the matrix has changed), the full jacobian is built.
+ *
+ * Boundary conditions which overwrite elements of the jacobian are
+ * applied after all other contributions have been added (and the
+ * added values flushed to the matrix). Only the operators and
+ * derivatives for which this was found to set any elements during
+ * the first assembly are visited, and the flush is skipped entirely
+ * if there are none (which is the case for most equation systems).
+ *
+ * If a function vector is given, the residual of each equation is
+ * evaluated immediately before its block row of the jacobian, by the
+ * same thread, so that the coefficients of the terms of the equation
+ * are still in cache when they are used for the jacobian (and so that
+ * the residual is evaluated in parallel together with the jacobian).
+ * The vector is identical to the one built by 'BuildVector()'.
+ *
  * t:    Time to build the jacobian matrix for.
  * dt:   Length of time step to take.
  * mat:  Matrix to use for storing the jacobian.
+ * vec:  If not 'nullptr', vector to store evaluated equations in.
  */
-void Solver::BuildJacobian(const real_t, const real_t, FVM::BlockMatrix *jac) {
-    // Reset jacobian matrix
-    jac->Zero();
+void Solver::BuildJacobian(const real_t, const real_t, FVM::BlockMatrix *jac, real_t *vec) {
+    if (vec != nullptr)
+        for (len_t i = 0; i < matrix_size; i++)
+            vec[i] = 0;
+
+    const bool discover = !this->jacobianCouplingsBuilt;
 
     // Iterate over (non-trivial) unknowns (i.e. those which appear
     // in the matrix system), corresponding to blocks in F and
     // rows in the Jacobian matrix.
-    for (len_t uqnId : nontrivial_unknowns) {
-        UnknownQuantityEquation *eqn = unknown_equations->at(uqnId);
-        map<len_t, len_t>& utmm = this->unknownToMatrixMapping;
-        len_t matUqnId = utmm[uqnId];
-        // Iterate over each equation term
-        len_t operatorId = 0;
-        for (auto it = eqn->GetOperators().begin(); it != eqn->GetOperators().end(); it++) {
-            const real_t *x = unknowns->GetUnknownData(it->first);
-        
-            // "Differentiate with respect to the unknowns which
-            // appear in the matrix"
-            //   d (F_uqnId) / d x_derivId
-            for (len_t derivId : nontrivial_unknowns) {
-                len_t matDerivId = utmm[derivId];
-                jac->SelectSubEquation(matUqnId, matDerivId);
+    if (!this->jacobianCouplingsBuilt || !this->hasConstantJacobianCouplings) {
+        jac->Zero();
+        this->BuildJacobianBlockRows(jac, JACOBIAN_ALL, vec);
+    } else if (this->jacobianBaseValid && jac == this->jacobianBaseMatrix &&
+        jac->RestoreValues(this->jacobianBase)) {
+        this->BuildJacobianBlockRows(jac, JACOBIAN_VARYING, vec);
+    } else {
+        jac->Zero();
+        this->BuildJacobianBlockRows(jac, JACOBIAN_CONSTANT, vec);
+        jac->Assemble();
+
+        this->jacobianBaseValid = jac->SaveValues(this->jacobianBase);
+        this->jacobianBaseMatrix = jac;
+
+        this->BuildJacobianBlockRows(jac, JACOBIAN_VARYING);
+    }
 
-                // - in the equation for                           x_uqnId
-                // - differentiate the operator that is applied to x_it
-                // - with respect to                               x_derivId
-                it->second->SetJacobianBlock(it->first, derivId, jac, x);
-            }
+    if (!this->jacobianCouplingsBuilt) {
+        this->jacobianCouplingsBuilt = true;
 
-            operatorId++;
-        }
+        this->hasConstantJacobianCouplings = false;
+        for (len_t uqnId : nontrivial_unknowns)
+            for (const jacobian_coupling& c : this->jacobianCouplings[uqnId])
+                this->hasConstantJacobianCouplings |= c.constant;
+    }
 
-        //printf("operatorId = " LEN_T_PRINTF_FMT "\n", operatorId);
+    // Apply boundary conditions which overwrite elements
+    if (discover)
+        this->BuildJacobianBC_discover(jac);
+    else if (!this->jacobianBCCouplings.empty()) {
+        const map<len_t, len_t>& utmm = this->unknownToMatrixMapping;
+        jac->PartialAssemble();
+
+        for (const jacobian_bc_coupling& c : this->jacobianBCCouplings) {
+            jac->SelectSubEquation(utmm.at(c.uqnId), utmm.at(c.derivId));
+            c.op->SetJacobianBlockBC(c.uqtyId, c.derivId, jac, unknowns->GetUnknownData(c.uqtyId));
+        }
     }
+
+    jac->Assemble();
+}
+
+/**
+ * Apply the boundary conditions which overwrite elements of the
+ * jacobian matrix by differentiating every operator having boundary
+ * conditions with respect to every non-trivial unknown, and record
+ * the (block row, operator, derivative) triples for which any element
+ * is set (i.e. for which 'FVM::Operator::SetJacobianBlockBC()' returns
+ * 'true').
+ *
+ * jac: Matrix to use for storing the jacobian.
+ */
+void Solver::BuildJacobianBC_discover(FVM::BlockMatrix *jac) {
+    const map<len_t, len_t>& utmm = this->unknownToMatrixMapping;
+    this->jacobianBCCouplings.clear();
+
     jac->PartialAssemble();
 
-    // Apply boundary conditions which overwrite elements
     for (len_t uqnId : nontrivial_unknowns) {
         UnknownQuantityEquation *eqn = unknown_equations->at(uqnId);
-        map<len_t, len_t>& utmm = this->unknownToMatrixMapping;
-        len_t matUqnId = utmm[uqnId];
+        len_t matUqnId = utmm.at(uqnId);
 
         // Iterate over each equation
         for (auto it = eqn->GetOperators().begin(); it != eqn->GetOperators().end(); it++) {
+            if (!it->second->HasBoundaryConditions())
+                continue;
+
             const real_t *x = unknowns->GetUnknownData(it->first);
 
             // "Differentiate with respect to the unknowns which
             // appear in the matrix"
             //   d (eqn_uqnId) / d x_derivId
             for (len_t derivId : nontrivial_unknowns) {
-                len_t matDerivId = utmm[derivId];
+                len_t matDerivId = utmm.at(derivId);
                 jac->SelectSubEquation(matUqnId, matDerivId);
-                // For logic, see comment in the for-loop above
-                it->second->SetJacobianBlockBC(it->first, derivId, jac, x);
+                // For logic, see comment in 'BuildJacobianBlockRow_discover()'
+                if (it->second->SetJacobianBlockBC(it->first, derivId, jac, x))
+                    this->jacobianBCCouplings.push_back({uqnId, it->first, it->second, derivId});
             }
         }
     }
-    jac->Assemble();
+}
+
+/**
+ * Build the block rows of the jacobian matrix of all non-trivial
+ * unknowns (using several threads if enabled).
+ *
+ * jac: Matrix to use for storing the jacobian.
+ * sel: Which couplings to build (constant, non-constant or all).
+ * vec: If not 'nullptr', vector to store evaluated equations in.
+ */
+void Solver::BuildJacobianBlockRows(FVM::BlockMatrix *jac, enum jacobian_selection sel, real_t *vec) {
+    if (this->nThreads > 1)
+        this->BuildJacobianBlockRows_parallel(jac, sel, vec);
+    else {
+        for (len_t uqnId : nontrivial_unknowns)
+            this->BuildJacobianBlockRow(uqnId, jac, sel, vec);
+    }
+}
+
+/**
+ * Build the block row of the jacobian matrix corresponding to the
+ * equation for the specified unknown quantity (excluding the boundary
+ * conditions which overwrite elements).
+ *
+ * Only the (operator, derivative) pairs in the jacobian coupling
+ * graph are visited, in the same order as they would be visited
+ * when differentiating every operator with respect to every
+ * non-trivial unknown.
+ *
+ * uqnId: ID of unknown quantity whose equation to differentiate.
+ * jac:   Matrix to use for storing the jacobian.
+ * sel:   Which couplings to build (constant, non-constant or all).
+ * vec:   If not 'nullptr', the equation is also evaluated, and stored
+ *        in the corresponding block of this function vector.
+ */
+void Solver::BuildJacobianBlockRow(
+    const len_t uqnId, FVM::BlockMatrix *jac, enum jacobian_selection sel, real_t *vec
+) {
+    const map<len_t, len_t>& utmm = this->unknownToMatrixMapping;
+    len_t matUqnId = utmm.at(uqnId);
+
+    if (vec != nullptr)
+        unknown_equations->at(uqnId)->SetVectorElements(vec + jac->GetOffset(matUqnId), unknowns);
+
+    if (!this->jacobianCouplingsBuilt) {
+        this->BuildJacobianBlockRow_discover(uqnId, jac);
+        return;
+    }
+
+    for (const jacobian_coupling& c : this->jacobianCouplings[uqnId]) {
+        if ((sel == JACOBIAN_CONSTANT && !c.constant) ||
+            (sel == JACOBIAN_VARYING && c.constant))
+            continue;
+
+        jac->SelectSubEquation(matUqnId, utmm.at(c.derivId));
+        c.op->SetJacobianBlock(c.uqtyId, c.derivId, jac, unknowns->GetUnknownData(c.uqtyId));
+    }
+}
+
+/**
+ * Build the block row of the jacobian matrix corresponding to the
+ * equation for the specified unknown quantity by differentiating
+ * every operator with respect to every non-trivial unknown, and
+ * record the pairs which contribute in the jacobian coupling graph.
+ *
+ * An (operator, derivative) pair is kept if the operator is applied
+ * to the unknown to differentiate with respect to (so that the block
+ * contains the linear part of the operator), if any of its terms has
+ * declared a jacobian contribution with respect to the unknown (via
+ * 'FVM::EquationTerm::AddUnknownForJacobian()'), or if any element
+ * was set in the jacobian during this initial assembly.
+ *
+ * uqnId: ID of unknown quantity whose equation to differentiate.
+ * jac:   Matrix to use for storing the jacobian.
+ */
+void Solver::BuildJacobianBlockRow_discover(const len_t uqnId, FVM::BlockMatrix *jac) {
+    UnknownQuantityEquation *eqn = unknown_equations->at(uqnId);
+    const map<len_t, len_t>& utmm = this->unknownToMatrixMapping;
+    len_t matUqnId = utmm.at(uqnId);
+
+    vector<jacobian_coupling>& couplings = this->jacobianCouplings[uqnId];
+    couplings.clear();
+
+    // Iterate over each equation term
+    for (auto it = eqn->GetOperators().begin(); it != eqn->GetOperators().end(); it++) {
+        const real_t *x = unknowns->GetUnknownData(it->first);
+    
+        // "Differentiate with respect to the unknowns which
+        // appear in the matrix"
+        //   d (F_uqnId) / d x_derivId
+        for (len_t derivId : nontrivial_unknowns) {
+            len_t matDerivId = utmm.at(derivId);
+            jac->SelectSubEquation(matUqnId, matDerivId);
+
+            // - in the equation for                           x_uqnId
+            // - differentiate the operator that is applied to x_it
+            // - with respect to                               x_derivId
+            bool contributes = it->second->SetJacobianBlock(it->first, derivId, jac, x);
+
+            if (contributes || derivId == it->first || it->second->HasJacobianContribution(derivId))
+                couplings.push_back({it->first, it->second, derivId, it->second->IsJacobianConstant()});
+        }
+    }
+}
+
+/**
+ * Build all block rows of the jacobian matrix using 'nThreads'
+ * threads. Each block row is built into a separate element buffer,
+ * and the buffers are inserted into the PETSc matrix in block row
+ * order after all rows have been built. Since each matrix element
+ * belongs to exactly one block row, the elements are added in the
+ * same order as in a serial build, and the resulting matrix is
+ * identical to the one obtained with a single thread.
+ *
+ * Block rows containing terms which are not thread-safe (see
+ * 'FVM::EquationTerm::IsThreadSafe()') are built serially, after
+ * all other rows have been built. Rows whose terms modify the same
+ * shared objects (see 'GroupBySharedObjects()') are built one after
+ * the other, by the same thread.
+ *
+ * jac: Matrix to use for storing the jacobian.
+ * sel: Which couplings to build (constant, non-constant or all).
+ * vec: If not 'nullptr', vector to store evaluated equations in (each
+ *      equation only writes to its own block of the vector).
+ */
+void Solver::BuildJacobianBlockRows_parallel(FVM::BlockMatrix *jac, enum jacobian_selection sel, real_t *vec) {
+    vector<len_t> parallelRows, serialRows;
+    for (len_t uqnId : nontrivial_unknowns) {
+        if (unknown_equations->at(uqnId)->IsThreadSafe())
+            parallelRows.push_back(uqnId);
+        else
+            serialRows.push_back(uqnId);
+    }
+
+    const len_t nRows = parallelRows.size();
+    if (this->jacobianBuffers.size() < nRows)
+        this->jacobianBuffers.resize(nRows);
+
+    // Start with the groups of block rows having the most couplings,
+    // so that the expensive rows are not left until the end (the
+    // buffers are still inserted in block row order below)
+    vector<vector<len_t>> groups = this->GroupBySharedObjects(parallelRows);
+    if (this->jacobianCouplingsBuilt) {
+        auto cost = [this,&parallelRows](const vector<len_t>& g) {
+            len_t n = 0;
+            for (len_t i : g)
+                n += this->jacobianCouplings[parallelRows[i]].size();
+            return n;
+        };
+        stable_sort(groups.begin(), groups.end(), [&cost](const vector<len_t>& a, const vector<len_t>& b) {
+            return cost(a) > cost(b);
+        });
+    }
+
+    FVM::Parallel::For(groups.size(), this->nThreads, [&](const len_t k) {
+        for (const len_t i : groups[k]) {
+            vector<FVM::Matrix::buffered_element> *buf = &this->jacobianBuffers[i];
+            buf->clear();
+
+            FVM::BlockMatrix *view = jac->CreateBufferedView(buf);
+            try {
+                this->BuildJacobianBlockRow(parallelRows[i], view, sel, vec);
+            } catch (...) {
+                delete view;
+                throw;
+            }
+            delete view;
+        }
+    });
+
+    for (len_t i = 0; i < nRows; i++)
+        jac->InsertBufferedElements(this->jacobianBuffers[i]);
+
+    for (len_t uqnId : serialRows)
+        this->BuildJacobianBlockRow(uqnId, jac, sel, vec);
 }
 
 /**
@@ -183,6 +421,88 @@ void Solver::BuildVector(const real_t, const real_t, real_t *vec, FVM::BlockMatr
     }
 }
 
+/**
+ * Build a function vector for the equation system using 'nThreads'
+ * threads. As in 'BuildJacobianBlockRows_parallel()', the equations
+ * which are thread-safe are evaluated concurrently (equations modifying
+ * the same shared objects by the same thread), and the remaining
+ * equations serially afterwards. Since each equation only writes to
+ * its own block of the vector, the result is identical to that of
+ * 'BuildVector()'.
+ *
+ * t:   Time to build the function vector for.
+ * dt:  Length of time step to take.
+ * vec: Vector to store evaluated equations in.
+ * jac: Associated jacobian matrix.
+ */
+void Solver::BuildVector_parallel(const real_t t, const real_t dt, real_t *vec, FVM::BlockMatrix *jac) {
+    if (this->nThreads <= 1) {
+        this->BuildVector(t, dt, vec, jac);
+        return;
+    }
+
+    for (len_t i = 0; i < matrix_size; i++)
+        vec[i] = 0;
+
+    vector<len_t> parallelRows, serialRows;
+    for (len_t i = 0; i < nontrivial_unknowns.size(); i++) {
+        if (unknown_equations->at(nontrivial_unknowns[i])->IsThreadSafe())
+            parallelRows.push_back(i);
+        else
+            serialRows.push_back(i);
+    }
+
+    vector<len_t> parallelUqns(parallelRows.size());
+    for (len_t k = 0; k < parallelRows.size(); k++)
+        parallelUqns[k] = nontrivial_unknowns[parallelRows[k]];
+
+    const vector<vector<len_t>> groups = this->GroupBySharedObjects(parallelUqns);
+    FVM::Parallel::For(groups.size(), this->nThreads, [&](const len_t k) {
+        for (const len_t j : groups[k]) {
+            const len_t i = parallelRows[j];
+            unknown_equations->at(nontrivial_unknowns[i])->SetVectorElements(vec+jac->GetOffset(i), unknowns);
+        }
+    });
+
+    for (len_t i : serialRows)
+        unknown_equations->at(nontrivial_unknowns[i])->SetVectorElements(vec+jac->GetOffset(i), unknowns);
+}
+
+/**
+ * Verify that the given function vector only contains finite values,
+ * and if not, raise an exception naming the equation, element and term
+ * which produced the first non-finite (NaN or Inf) value. This should
+ * be called for function vectors which must be finite (such as the
+ * residual in the point of linearization), so that corrupted systems
+ * are reported immediately instead of after a failed factorization.
+ *
+ * vec: Function vector to check.
+ * jac: Associated jacobian matrix.
+ */
+void Solver::CheckVector(const real_t *vec, FVM::BlockMatrix *jac) {
+    len_t k = 0;
+    while (k < matrix_size && std::isfinite(vec[k]))
+        k++;
+
+    if (k == matrix_size)
+        return;
+
+    // Locate the unknown whose equation contains the element
+    len_t idx = 0;
+    while (idx+1 < nontrivial_unknowns.size() && (len_t)jac->GetOffset(idx+1) <= k)
+        idx++;
+
+    const len_t uqnId = nontrivial_unknowns[idx];
+    const len_t i = k - (len_t)jac->GetOffset(idx);
+    const string term = unknown_equations->at(uqnId)->FindNonFiniteTerm(i, unknowns);
+
+    throw SolverException(
+        "Non-finite value in element " LEN_T_PRINTF_FMT " of the equation for '%s'%s%s.",
+        i, unknowns->GetUnknown(uqnId)->GetName().c_str(),
+        (term.empty() ? "" : ", set by term "), term.c_str()
+    );
+}
+
 /**
  * Calculate the 2-norm of the given vector separately for each
  * non-trivial unknown in the equation system. Thus, if there are
@@ -197,20 +517,8 @@ void Solver::BuildVector(const real_t, const real_t, real_t *vec, FVM::BlockMatr
  *         non-trivial unknown quantities in the equation system.
  */
 void Solver::CalculateNonTrivial2Norm(const real_t *vec, real_t *retvec) {
-    len_t offset = 0, i = 0;
-    for (auto id : this->nontrivial_unknowns) {
-        FVM::UnknownQuantity *uqn = this->unknowns->GetUnknown(id);
-        const len_t N = uqn->NumberOfElements();
-
-        retvec[i] = 0;
-        for (len_t j = 0; j < N; j++)
-            retvec[i] += vec[offset+j]*vec[offset+j];
-
-        retvec[i] = sqrt(retvec[i]);
-
-        offset += N;
-        i++;
-    }
+    FVM::NormEvaluator ne(this->unknowns, this->nontrivial_unknowns);
+    ne.Norm2(vec, retvec);
 }
 
 /**
@@ -228,6 +536,24 @@ void Solver::Initialize(const len_t size, vector<len_t>& unknowns) {
     // appear in the matrices that are built later on)
     nontrivial_unknowns = unknowns;
 
+    // Add one rebuild timer per non-trivial unknown (only once,
+    // in case the solver is re-initialized)
+    if (this->timerRebuildEquation.empty()) {
+        for (len_t uqnId : nontrivial_unknowns) {
+            const string& name = this->unknowns->GetUnknown(uqnId)->GetName();
+            this->timerRebuildEquation.push_back(
+                this->solver_timeKeeper->AddTimer("eq_"+name, "Rebuild "+name)
+            );
+        }
+    }
+
+    // The jacobian coupling graph is rebuilt during
+    // the next jacobian assembly
+    this->jacobianCouplings.assign(this->unknowns->Size(), vector<jacobian_coupling>());
+    this->jacobianBCCouplings.clear();
+    this->jacobianCouplingsBuilt = false;
+    this->jacobianBaseValid = false;
+
     this->initialize_internal(size, unknowns);
 }
 
@@ -265,7 +591,19 @@ void Solver::RebuildTerms(const real_t t, const real_t dt) {
         if (eqn->IsPredetermined()) {
             eqn->RebuildEquations(t, dt, unknowns);
             FVM::PredeterminedParameter *pp = eqn->GetPredetermined();
-            uqty->Store(pp->GetData(), 0, true);
+
+            auto it = this->predeterminedScaleFactors.find(i);
+            if (it == this->predeterminedScaleFactors.end())
+                uqty->Store(pp->GetData(), 0, true);
+            else {
+                const len_t n = uqty->NumberOfElements();
+                const real_t *d = pp->GetData();
+                this->predeterminedBuffer.resize(n);
+                for (len_t j = 0; j < n; j++)
+                    this->predeterminedBuffer[j] = it->second * d[j];
+
+                uqty->Store(this->predeterminedBuffer.data(), 0, true);
+            }
         }
     }
 
@@ -275,29 +613,157 @@ void Solver::RebuildTerms(const real_t t, const real_t dt) {
     }
     solver_timeKeeper->StopTimer(timerSPIHandler);
 
-    for (len_t i = 0; i < nontrivial_unknowns.size(); i++) {
-        len_t uqnId = nontrivial_unknowns[i];
-        UnknownQuantityEquation *eqn = unknown_equations->at(uqnId);
+    if (this->nThreads > 1)
+        this->RebuildEquations_parallel(t, dt);
+    else {
+        for (len_t i = 0; i < nontrivial_unknowns.size(); i++)
+            this->RebuildEquation(i, t, dt, false);
+    }
 
-        for (auto it = eqn->GetOperators().begin(); it != eqn->GetOperators().end(); it++) {
+    solver_timeKeeper->StopTimer(timerRebuildTerms);
+    solver_timeKeeper->StopTimer(timerTot);
+}
+
+/**
+ * Set the factor by which the data of the given predetermined
+ * unknown quantity is multiplied when the equation terms are
+ * rebuilt. A factor of exactly 1 removes the scaling.
+ *
+ * id: ID of predetermined unknown quantity.
+ * s:  Scale factor.
+ */
+void Solver::SetPredeterminedScaleFactor(const len_t id, const real_t s) {
+    if (s == 1)
+        this->predeterminedScaleFactors.erase(id);
+    else
+        this->predeterminedScaleFactors[id] = s;
+}
+
+/**
+ * Rebuild the operators of the specified non-trivial unknown.
+ *
+ * i:              Index of the unknown in 'nontrivial_unknowns'.
+ * t:              Time for which to rebuild the equation.
+ * dt:             Length of time step to take next.
+ * threadSafeOnly: If 'true', only rebuilds operators which are
+ *                 thread-safe. Otherwise, only the operators which
+ *                 are NOT thread-safe are rebuilt if
+ *                 'nThreads > 1', and all operators if not.
+ */
+void Solver::RebuildEquation(
+    const len_t i, const real_t t, const real_t dt, const bool threadSafeOnly
+) {
+    len_t uqnId = nontrivial_unknowns[i];
+    UnknownQuantityEquation *eqn = unknown_equations->at(uqnId);
+    const bool allOps = (!threadSafeOnly && this->nThreads <= 1);
+
+    bool hasTimer = (i < this->timerRebuildEquation.size());
+    if (hasTimer)
+        solver_timeKeeper->StartTimer(this->timerRebuildEquation[i]);
+
+    for (auto it = eqn->GetOperators().begin(); it != eqn->GetOperators().end(); it++) {
+        if (allOps || it->second->IsThreadSafe() == threadSafeOnly)
             it->second->RebuildTerms(t, dt, unknowns);
+    }
+
+    if (hasTimer)
+        solver_timeKeeper->StopTimer(this->timerRebuildEquation[i]);
+}
+
+/**
+ * Rebuild the operators of all non-trivial unknowns using
+ * 'nThreads' threads. Operators which are thread-safe (i.e.
+ * which do not depend on the state of other equations) are
+ * rebuilt concurrently, after which the remaining operators are
+ * rebuilt sequentially in the usual order. Equations whose
+ * operators modify the same shared objects (such as a collision
+ * quantity handler) are rebuilt one after the other, in the
+ * same task.
+ */
+void Solver::RebuildEquations_parallel(const real_t t, const real_t dt) {
+    const len_t nEqs = nontrivial_unknowns.size();
+
+    const vector<vector<len_t>> groups = this->GroupBySharedObjects(nontrivial_unknowns);
+    FVM::Parallel::For(groups.size(), this->nThreads, [&](const len_t k) {
+        for (const len_t i : groups[k])
+            this->RebuildEquation(i, t, dt, true);
+    });
+
+    // Rebuild operators which depend on other equations
+    for (len_t i = 0; i < nEqs; i++)
+        this->RebuildEquation(i, t, dt, false);
+}
+
+/**
+ * Partition the given equations into groups which can be built
+ * concurrently, so that no two equations in different groups
+ * modify the same shared object (see
+ * 'FVM::EquationTerm::GetSharedObjects()'). Equations which share
+ * no objects form groups of their own.
+ *
+ * uqnIds: IDs of the unknowns whose equations should be grouped.
+ *
+ * RETURNS the groups, as lists of indices into 'uqnIds' (in
+ * increasing order).
+ */
+vector<vector<len_t>> Solver::GroupBySharedObjects(const vector<len_t>& uqnIds) {
+    const len_t n = uqnIds.size();
+
+    // Union-find over the equations, joining all equations
+    // which share an object with the first equation using it
+    vector<len_t> root(n);
+    for (len_t i = 0; i < n; i++)
+        root[i] = i;
+    auto find = [&root](len_t i) {
+        while (root[i] != i)
+            i = root[i] = root[root[i]];
+        return i;
+    };
+
+    map<const void*, len_t> firstUser;
+    vector<const void*> objs;
+    for (len_t i = 0; i < n; i++) {
+        objs.clear();
+        unknown_equations->at(uqnIds[i])->GetSharedObjects(objs);
+
+        for (const void *o : objs) {
+            auto it = firstUser.find(o);
+            if (it == firstUser.end())
+                firstUser[o] = i;
+            else {
+                const len_t a = find(it->second), b = find(i);
+                root[max(a,b)] = min(a,b);
+            }
         }
     }
 
-    solver_timeKeeper->StopTimer(timerRebuildTerms);
-    solver_timeKeeper->StopTimer(timerTot);
+    vector<vector<len_t>> groups;
+    vector<len_t> groupOf(n, n);
+    for (len_t i = 0; i < n; i++) {
+        const len_t r = find(i);
+        if (groupOf[r] == n) {
+            groupOf[r] = groups.size();
+            groups.push_back({});
+        }
+        groups[groupOf[r]].push_back(i);
+    }
+
+    return groups;
 }
 
 /**
  * Precondition the given matrix and RHS vector. This can improve
  * conditioning of the equation system to solve and should be called
- * on each solve (if enabled).
+ * on each solve (if enabled). If 'mat' is 'nullptr', only the RHS
+ * vector is rescaled (which is used when the matrix has already
+ * been rescaled in a previous iteration).
  */
 void Solver::Precondition(FVM::Matrix *mat, Vec rhs) {
     if (this->diag_prec == nullptr)
         return;
 
-    this->diag_prec->RescaleMatrix(mat);
+    if (mat != nullptr)
+        this->diag_prec->RescaleMatrix(mat);
     this->diag_prec->RescaleRHSVector(rhs);
 }
 
@@ -317,9 +783,27 @@ void Solver::UnPrecondition(Vec x) {
  * Print timing information for the 'Rebuild' stage of the solver.
  * This stage looks the same for all solvers, and so is conveniently
  * defined here in the base class.
+ *
+ * For terms which have declared their inputs (and may therefore skip
+ * being rebuilt when the inputs are unchanged), we also print the
+ * number of times they have been rebuilt and skipped.
  */
 void Solver::PrintTimings_rebuild() {
     this->solver_timeKeeper->PrintTimings(true, 0);
+
+    printf("[Term rebuilds]\n");
+    const len_t N = unknowns->Size();
+    for (len_t i = 0; i < N; i++) {
+        const string& name = unknowns->GetUnknown(i)->GetName();
+        UnknownQuantityEquation *eqn = unknown_equations->at(i);
+
+        for (auto it = eqn->GetOperators().begin(); it != eqn->GetOperators().end(); it++)
+            it->second->PrintRebuildStatistics(name);
+    }
+
+#ifndef NDEBUG
+    printf("[Scratch arena]\n  Heap allocations:  " LEN_T_PRINTF_FMT "\n", FVM::ScratchArena::GetNHeapAllocations());
+#endif
 }
 
 /**
@@ -341,11 +825,102 @@ void Solver::SelectLinearSolver(const len_t N) {
             "The main and backup linear solvers may not be the same."
         );
 
+    string ordering;
+    switch (this->factorOrdering) {
+        case OptionConstants::SOLVER_FACTOR_ORDERING_DEFAULT: break;
+        case OptionConstants::SOLVER_FACTOR_ORDERING_RADIAL:
+            FVM::Matrix::RegisterFactorOrdering();
+            ordering = FVM::Matrix::FACTOR_ORDERING;
+            break;
+        case OptionConstants::SOLVER_FACTOR_ORDERING_RCM: ordering = MATORDERINGRCM; break;
+        case OptionConstants::SOLVER_FACTOR_ORDERING_ND: ordering = MATORDERINGND; break;
+
+        default:
+            throw SolverException(
+                "Unrecognized factorization ordering: %d.", this->factorOrdering
+            );
+    }
+
     this->mainInverter = this->ConstructLinearSolver(N, this->linearSolver);
+    this->mainInverter->SetReuseSymbolicFactorization(this->reuseSymbolic);
+    this->mainInverter->SetFactorOrdering(ordering);
     this->inverter = this->mainInverter;
 
-    if (this->backupSolver != OptionConstants::LINEAR_SOLVER_NONE)
+    if (this->backupSolver != OptionConstants::LINEAR_SOLVER_NONE) {
         this->backupInverter = this->ConstructLinearSolver(N, this->backupSolver);
+        this->backupInverter->SetReuseSymbolicFactorization(this->reuseSymbolic);
+        this->backupInverter->SetFactorOrdering(ordering);
+    }
+}
+
+/**
+ * Attach the permutation of the selected factorization ordering
+ * to the given (newly constructed) matrix of the equation system.
+ * Only needed for orderings computed by DREAM; the orderings
+ * provided by PETSc are computed when the matrix is factorized.
+ *
+ * mat: Matrix to set the factorization ordering of.
+ */
+void Solver::ApplyFactorOrdering(FVM::Matrix *mat) {
+    if (this->factorOrdering != OptionConstants::SOLVER_FACTOR_ORDERING_RADIAL)
+        return;
+
+    // The layout of the matrix never changes, so the
+    // permutation only needs to be computed once
+    if (this->factorPermutation.empty())
+        this->ComputeRadialOrdering(this->factorPermutation);
+
+    mat->SetFactorOrdering(this->factorPermutation);
+}
+
+/**
+ * Compute a radius-interleaved ordering of the unknowns in the
+ * matrix. In the matrix, all elements of one unknown quantity are
+ * placed before those of the next, so that the (radially local)
+ * couplings between different quantities at the same radius lie far
+ * away from the diagonal. In the radial ordering, all elements of all
+ * quantities at the first radius are placed first, followed by all
+ * elements at the second radius, and so on, making the matrix
+ * block-banded with a bandwidth given by the number of elements per
+ * radius. Quantities which are not resolved radially (such as the
+ * plasma current) are coupled to all radii, and are placed last.
+ *
+ * perm: On return, contains the matrix row placed at each position
+ *       of the ordering.
+ */
+void Solver::ComputeRadialOrdering(vector<PetscInt>& perm) {
+    len_t nr = 0;
+    for (len_t id : this->nontrivial_unknowns)
+        nr = max(nr, this->unknowns->GetUnknown(id)->GetGrid()->GetNr());
+
+    vector<vector<PetscInt>> radial(nr);
+    vector<PetscInt> global;
+
+    PetscInt offset = 0;
+    for (len_t id : this->nontrivial_unknowns) {
+        FVM::UnknownQuantity *uqn = this->unknowns->GetUnknown(id);
+        FVM::Grid *g = uqn->GetGrid();
+        const len_t nCells = g->GetNCells();
+        const bool resolved = (nr > 1 && g->GetNr() == nr);
+
+        // Elements are stored as [multiple][radius][momentum]
+        for (len_t k = 0; k < uqn->NumberOfMultiples(); k++) {
+            PetscInt idx = offset + k*nCells;
+            for (len_t ir = 0; ir < g->GetNr(); ir++) {
+                const len_t np = g->GetNp1(ir)*g->GetNp2(ir);
+                for (len_t j = 0; j < np; j++, idx++)
+                    (resolved ? radial[ir] : global).push_back(idx);
+            }
+        }
+
+        offset += uqn->NumberOfElements();
+    }
+
+    perm.clear();
+    perm.reserve(offset);
+    for (const auto &r : radial)
+        perm.insert(perm.end(), r.begin(), r.end());
+    perm.insert(perm.end(), global.begin(), global.end());
 }
 
 /**
@@ -365,7 +940,7 @@ void Solver::SelectLinearSolver(const len_t N) {
     ConvergenceChecker *cc = solver->GetConvergenceChecker();
 
     Vec _x, _dx;
-    VecCreateSeq(PETSC_COMM_WORLD, solver->GetMatrixSize(), &_x);
+    VecCreateSeq(PETSC_COMM_SELF, solver->GetMatrixSize(), &_x);
 
     KSPBuildSolution(ksp, _x, &_x);
     KSPBuildResidual(ksp, NULL, NULL, &_dx);
@@ -395,7 +970,7 @@ void Solver::SelectLinearSolver(const len_t N) {
 FVM::MatrixInverter *Solver::ConstructLinearSolver(const len_t N, enum OptionConstants::linear_solver ls) {
     if (ls == OptionConstants::LINEAR_SOLVER_GMRES) {
        //return new FVM::MIGMRES(N, nontrivial_unknowns, unknowns, &CheckGMRESConverged, this);
-       return new FVM::MIGMRES(N, nontrivial_unknowns, unknowns, nullptr, nullptr);
+       return new FVM::MIGMRES(N, nontrivial_unknowns, unknowns, nullptr, nullptr, this->gmresSplits);
     } else if (ls == OptionConstants::LINEAR_SOLVER_LU)
         return new FVM::MILU(N);
     else if (ls == OptionConstants::LINEAR_SOLVER_MKL) {
@@ -415,6 +990,16 @@ FVM::MatrixInverter *Solver::ConstructLinearSolver(const len_t N, enum OptionCon
             "Your version of PETSc does not include support for MUMPS. "
             "To use this linear solver you must recompile PETSc."
         );
+#endif
+    } else if (ls == OptionConstants::LINEAR_SOLVER_MIXED_PRECISION) {
+#ifdef PETSC_HAVE_MUMPS
+        return new FVM::MIMixedPrecision(N, this->mixedPrecisionOptions);
+#else
+        throw SolverException(
+            "Your version of PETSc does not include support for MUMPS, which is "
+            "required by the mixed-precision linear solver. To use this linear "
+            "solver you must recompile PETSc."
+        );
 #endif
     } else if (ls == OptionConstants::LINEAR_SOLVER_SUPERLU) {
 #ifdef PETSC_HAVE_SUPERLU
@@ -452,6 +1037,15 @@ void Solver::SetPreconditioner(DiagonalPreconditioner *dp) {
     this->diag_prec = dp;
 }
 
+/**
+ * Print an estimate of the computational cost of the simulation
+ * (see 'SolverNonLinear::PrintCostEstimate()'). By default, no
+ * estimate is available.
+ */
+void Solver::PrintCostEstimate(const real_t, const real_t, const len_t) {
+    DREAM::IO::PrintInfo("A cost estimate is only available for the non-linear solver.");
+}
+
 /**
  * Switch to using the backup inverter instead of the main inverter.
  */
@@ -475,3 +1069,45 @@ void Solver::SwitchToMainInverter() {
  */
 void Solver::WriteDataSFile(SFile*, const std::string&) {}
 
+
+/**
+ * Save the given matrix for debugging, in the format selected with
+ * 'SetDebugFormat()'. In the CSR format, the file is given the
+ * extension '.csr' and contains an index (in JSON) of the blocks of
+ * the non-trivial unknowns, so that individual blocks can be read
+ * without loading the full matrix.
+ *
+ * mat:  Matrix to save.
+ * name: Name of the file to save the matrix to (without extension).
+ */
+void Solver::SaveDebugMatrix(FVM::Matrix *mat, const string& name) {
+    if (this->debugFormat != OptionConstants::SOLVER_DEBUG_FORMAT_CSR) {
+        mat->View(FVM::Matrix::BINARY_MATLAB, name);
+        return;
+    }
+
+    string index = "{\"unknowns\": [";
+    len_t offset = 0;
+    for (len_t i = 0; i < this->nontrivial_unknowns.size(); i++) {
+        FVM::UnknownQuantity *uqn = this->unknowns->GetUnknown(this->nontrivial_unknowns[i]);
+        FVM::Grid *g = uqn->GetGrid();
+        const len_t n = uqn->NumberOfElements();
+
+        if (i > 0)
+            index += ", ";
+
+        index +=
+            "{\"name\": \"" + uqn->GetName() + "\", " +
+            "\"offset\": " + to_string(offset) + ", " +
+            "\"size\": " + to_string(n) + ", " +
+            "\"nmultiples\": " + to_string(uqn->NumberOfMultiples()) + ", " +
+            "\"nr\": " + to_string(g->GetNr()) + ", " +
+            "\"np1\": " + to_string(g->GetMomentumGrid(0)->GetNp1()) + ", " +
+            "\"np2\": " + to_string(g->GetMomentumGrid(0)->GetNp2()) + "}";
+
+        offset += n;
+    }
+    index += "]}";
+
+    mat->SaveCSR(name + ".csr", index);
+}
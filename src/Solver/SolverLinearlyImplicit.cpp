@@ -32,6 +32,8 @@
 #include "DREAM/OutputGeneratorSFile.hpp"
 #include "DREAM/Settings/OptionConstants.hpp"
 #include "DREAM/Solver/SolverLinearlyImplicit.hpp"
+#include "FVM/PETScBackend.hpp"
+#include "FVM/ScratchArena.hpp"
 
 
 using namespace DREAM;
@@ -85,9 +87,11 @@ void SolverLinearlyImplicit::initialize_internal(
     }
 
     matrix->ConstructSystem();
+    matrix->SetDirectAssembly(this->directAssembly);
+    this->ApplyFactorOrdering(matrix);
 
-    VecCreateSeq(PETSC_COMM_WORLD, size, &this->petsc_S);
-    VecCreateSeq(PETSC_COMM_WORLD, size, &this->petsc_sol);
+    FVM::PETScBackend::CreateVector(size, &this->petsc_S);
+    FVM::PETScBackend::CreateVector(size, &this->petsc_sol);
 }
 
 /**
@@ -151,6 +155,14 @@ void SolverLinearlyImplicit::Solve(const real_t t, const real_t dt) {
     // Apply preconditioner (if enabled)
     this->Precondition(matrix, petsc_S);
 
+    // If the matrix is unchanged since it was last factorized (e.g. with
+    // constant prescribed parameters and time step), only the triangular
+    // solves need to be redone
+    bool reuse = (this->reuseFactorization && !matrix->HasChangedSince(this->factorizedMatrix));
+    if (reuse)
+        this->nFactorizationsReused++;
+    inverter->SetReuseFactorization(reuse);
+
     this->timeKeeper->StartTimer(timerInvert);
     inverter->Invert(matrix, &petsc_S, &petsc_S);
     this->timeKeeper->StopTimer(timerInvert);
@@ -161,6 +173,9 @@ void SolverLinearlyImplicit::Solve(const real_t t, const real_t dt) {
     // Store solution
     unknowns->Store(this->nontrivial_unknowns, petsc_S);
 
+    // Release temporary memory used by the equation terms
+    FVM::ScratchArena::NextIteration();
+
     this->timeKeeper->StopTimer(timerTot);
 }
 
@@ -170,6 +185,12 @@ void SolverLinearlyImplicit::Solve(const real_t t, const real_t dt) {
 void SolverLinearlyImplicit::PrintTimings() {
     this->timeKeeper->PrintTimings(true, 0);
     this->Solver::PrintTimings_rebuild();
+
+    if (this->reuseFactorization)
+        DREAM::IO::PrintInfo(
+            "Factorization reused in " LEN_T_PRINTF_FMT " of " LEN_T_PRINTF_FMT " time steps",
+            this->nFactorizationsReused, this->nTimeStep
+        );
 }
 
 /**
@@ -203,7 +224,7 @@ void SolverLinearlyImplicit::SaveDebugInfo(len_t it, FVM::Matrix *mat, const rea
             else
                 matname = "petsc_mat";
 
-            mat->View(FVM::Matrix::BINARY_MATLAB, matname);
+            this->SaveDebugMatrix(mat, matname);
         }
 
         if (this->saverhs) {
@@ -2,13 +2,22 @@
  * Implementation of a custom Newton solver which only utilizes
  * the linear solvers of PETSc.
  */
+#include <algorithm>
+#include <cmath>
 #include <iostream>
+#include <limits>
 
 #include <string>
 #include <vector>
 #include "DREAM/IO.hpp"
 #include "DREAM/OutputGeneratorSFile.hpp"
 #include "DREAM/Solver/SolverNonLinear.hpp"
+#include "FVM/DurationTimer.hpp"
+#include "FVM/MemoryAccounting.hpp"
+#include "FVM/PetscLog.hpp"
+#include "FVM/PETScBackend.hpp"
+#include "FVM/ScratchArena.hpp"
+#include "FVM/Tracer.hpp"
 
 
 using namespace DREAM;
@@ -59,6 +68,30 @@ void SolverNonLinear::AcceptSolution() {
 	this->StoreSolution(x);
 }
 
+/**
+ * Preconditioner routine used by the Krylov solver in Newton-Krylov
+ * mode. Applies the inverse of the most recently factorized jacobian.
+ */
+static PetscErrorCode SolverNonLinear_ApplyNewtonKrylovPC(PC pc, Vec x, Vec y) {
+    void *ctx;
+    PCShellGetContext(pc, &ctx);
+    static_cast<SolverNonLinear*>(ctx)->ApplyFactorizedJacobian(x, y);
+
+    return 0;
+}
+
+/**
+ * Matrix-vector product routine of the matrix-free jacobian
+ * operator used in Jacobian-free Newton-Krylov mode.
+ */
+static PetscErrorCode SolverNonLinear_JacobianFreeMult(Mat A, Vec x, Vec y) {
+    void *ctx;
+    MatShellGetContext(A, &ctx);
+    static_cast<SolverNonLinear*>(ctx)->ApplyJacobianFree(x, y);
+
+    return 0;
+}
+
 /**
  * Allocate memory for all objects used by this solver.
  */
@@ -70,16 +103,50 @@ void SolverNonLinear::Allocate() {
     // Select linear solver
     this->SelectLinearSolver(N);
 
-    VecCreateSeq(PETSC_COMM_WORLD, N, &this->petsc_F);
-    VecCreateSeq(PETSC_COMM_WORLD, N, &this->petsc_dx);
-
 	this->x0 = new real_t[N];
 	this->x1 = new real_t[N];
 	this->dx = new real_t[N];
     this->xinit = new real_t[N];
 
+    FVM::PETScBackend::CreateVector(N, &this->petsc_F);
+    FVM::PETScBackend::CreateVector(N, &this->petsc_Ftrial);
+    // (the Newton step is solved for directly in 'dx', if possible)
+    this->dxShared = FVM::PETScBackend::CreateVectorWithArray(N, this->dx, &this->petsc_dx);
+
 	this->x_2norm  = new real_t[this->unknown_equations->size()];
 	this->dx_2norm = new real_t[this->unknown_equations->size()];
+
+    // Krylov solver for Newton-Krylov iterations, preconditioned
+    // with the most recently factorized jacobian
+    if (this->jacobianUpdate == OptionConstants::SOLVER_JACOBIAN_UPDATE_NEWTON_KRYLOV ||
+        this->jacobianUpdate == OptionConstants::SOLVER_JACOBIAN_UPDATE_JFNK) {
+        PC pc;
+        KSPCreate(PETSC_COMM_SELF, &this->nkKSP);
+        KSPSetType(this->nkKSP, KSPGMRES);
+        KSPSetTolerances(
+            this->nkKSP, this->krylovRelTol, PETSC_DEFAULT, PETSC_DEFAULT,
+            (PetscInt)this->krylovMaxIter
+        );
+
+        KSPGetPC(this->nkKSP, &pc);
+        PCSetType(pc, PCSHELL);
+        PCShellSetContext(pc, this);
+        PCShellSetApply(pc, &SolverNonLinear_ApplyNewtonKrylovPC);
+
+        this->nkKSPAllocated = true;
+    }
+
+    // Matrix-free jacobian for Jacobian-free Newton-Krylov iterations
+    if (this->jacobianUpdate == OptionConstants::SOLVER_JACOBIAN_UPDATE_JFNK) {
+        MatCreateShell(PETSC_COMM_SELF, N, N, N, N, this, &this->jfnkMat);
+        MatShellSetOperation(this->jfnkMat, MATOP_MULT, (void(*)(void))&SolverNonLinear_JacobianFreeMult);
+        MatShellSetVecType(this->jfnkMat, FVM::PETScBackend::GetVecType());
+
+        this->jfnkX  = new real_t[N];
+        this->jfnkF0 = new real_t[N];
+        this->jfnkXh = new real_t[N];
+        this->jfnkFh = new real_t[N];
+    }
 }
 
 /**
@@ -107,6 +174,17 @@ void SolverNonLinear::AllocateJacobianMatrix() {
     if (this->jacobian != nullptr)
         delete this->jacobian;
 	this->jacobian = new FVM::BlockMatrix();
+    // Any existing factorization refers to the old matrix
+    this->factorizedInverter = nullptr;
+    if (this->elimination != nullptr)
+        this->elimination->Reset();
+    if (this->bordered != nullptr)
+        this->bordered->Reset();
+    if (this->localized != nullptr)
+        this->localized->Reset();
+    if (this->distributed != nullptr)
+        this->distributed->Reset();
+    this->jacobianStructureComplete = false;
 
 	for (len_t i = 0; i < nontrivial_unknowns.size(); i++) {
 		len_t id = nontrivial_unknowns[i];
@@ -116,7 +194,17 @@ void SolverNonLinear::AllocateJacobianMatrix() {
 			this->jacobian->CreateSubEquation(eqn->NumberOfElements(), eqn->NumberOfNonZeros_jac(), id);
 	}
 
-	this->jacobian->ConstructSystem();
+    // When warm-starting, the non-zero pattern of the reference
+    // jacobian is used directly (which should already be close to
+    // the pattern of the remainder of this simulation)
+    const PetscInt *pattern = nullptr;
+    if (this->warmStart != nullptr)
+        pattern = this->warmStart->GetJacobianPattern(this->matrix_size);
+
+	this->jacobian->ConstructSystem(pattern);
+    this->jacobianPreallocated = (pattern != nullptr);
+    this->jacobian->SetDirectAssembly(this->directAssembly);
+    this->ApplyFactorOrdering(this->jacobian);
 }
 
 /**
@@ -126,19 +214,40 @@ void SolverNonLinear::Deallocate() {
     if (backupInverter != nullptr)
         delete backupInverter;
 
+    delete this->warmStart;
+    delete this->adjoint;
+    delete this->reducedBasis;
+    delete this->elimination;
+    delete this->bordered;
+    delete this->localized;
+    delete this->distributed;
+
 	delete mainInverter;
 	delete jacobian;
 
 	delete [] this->x_2norm;
 	delete [] this->dx_2norm;
 
+	VecDestroy(&this->petsc_F);
+	VecDestroy(&this->petsc_dx);
+	VecDestroy(&this->petsc_Ftrial);
+
 	delete [] this->x0;
 	delete [] this->x1;
 	delete [] this->dx;
     delete [] this->xinit;
 
-	VecDestroy(&this->petsc_F);
-	VecDestroy(&this->petsc_dx);
+    if (this->nkKSPAllocated)
+        KSPDestroy(&this->nkKSP);
+
+    if (this->jfnkX != nullptr) {
+        MatDestroy(&this->jfnkMat);
+
+        delete [] this->jfnkX;
+        delete [] this->jfnkF0;
+        delete [] this->jfnkXh;
+        delete [] this->jfnkFh;
+    }
 }
 
 /**
@@ -157,6 +266,87 @@ const string& SolverNonLinear::GetNonTrivialName(const len_t idx) {
 void SolverNonLinear::initialize_internal(
 	const len_t, vector<len_t>&
 ) {
+    if (!this->warmStartFile.empty())
+        this->warmStart = new WarmStart(this->warmStartFile, this->unknowns, this->nontrivial_unknowns);
+    if (!this->adjointOptions.objective.empty())
+        this->adjoint = new AdjointSolver(this, this->unknowns, this->nontrivial_unknowns, this->adjointOptions);
+    if (!this->reducedBasisFile.empty())
+        this->reducedBasis = new ReducedBasis(this->reducedBasisFile, this->unknowns, this->nontrivial_unknowns);
+
+    // Unknowns with an evaluable equation may be eliminated
+    // from the linear systems
+    if (this->eliminateAlgebraic) {
+        vector<AlgebraicElimination::block> candidates;
+        PetscInt offset = 0;
+        for (len_t id : this->nontrivial_unknowns) {
+            UnknownQuantityEquation *eqn = this->unknown_equations->at(id);
+            const PetscInt n = eqn->NumberOfElements();
+            if (eqn->IsEvaluable())
+                candidates.push_back({id, offset, n});
+
+            offset += n;
+        }
+
+        this->elimination = new AlgebraicElimination(offset, candidates);
+    }
+
+    // Scalar unknowns (such as those of the circuit equations)
+    // couple to all radii, and are solved for as the border
+    // of the linear systems
+    if (this->borderScalars) {
+        vector<BorderedSystem::block> border;
+        PetscInt offset = 0;
+        for (len_t id : this->nontrivial_unknowns) {
+            const PetscInt n = this->unknown_equations->at(id)->NumberOfElements();
+            if (n == 1)
+                border.push_back({id, offset, n});
+
+            offset += n;
+        }
+
+        this->bordered = new BorderedSystem(offset, border);
+    }
+
+    // Map every row of the jacobian to its radius (with the same
+    // convention as in 'ComputeRadialOrdering()') for localized
+    // Newton iterations and distributed linear systems
+    if (this->localizedNewton || this->distributedSystem) {
+        len_t nr = 0;
+        for (len_t id : this->nontrivial_unknowns)
+            nr = max(nr, this->unknowns->GetUnknown(id)->GetGrid()->GetNr());
+
+        vector<len_t> rowRadius, rowUnknown;
+        for (len_t i = 0; i < this->nontrivial_unknowns.size(); i++) {
+            FVM::UnknownQuantity *uqn = this->unknowns->GetUnknown(this->nontrivial_unknowns[i]);
+            FVM::Grid *g = uqn->GetGrid();
+            const bool resolved = (nr > 1 && g->GetNr() == nr);
+
+            // Elements are stored as [multiple][radius][momentum]
+            for (len_t k = 0; k < uqn->NumberOfMultiples(); k++) {
+                for (len_t ir = 0; ir < g->GetNr(); ir++) {
+                    const len_t np = g->GetNp1(ir)*g->GetNp2(ir);
+                    for (len_t j = 0; j < np; j++) {
+                        rowRadius.push_back(resolved ? ir : nr);
+                        rowUnknown.push_back(i);
+                    }
+                }
+            }
+        }
+
+        // (nothing to localize without a radial grid)
+        if (this->localizedNewton && nr > 1)
+            this->localized = new LocalizedNewton(
+                (PetscInt)rowRadius.size(), nr, rowRadius, rowUnknown,
+                this->nontrivial_unknowns, this->localizedWidth,
+                this->localizedMaxFraction
+            );
+
+        if (this->distributedSystem)
+            this->distributed = new DistributedSystem(
+                (PetscInt)rowRadius.size(), nr, rowRadius, this->linearSolver
+            );
+    }
+
 	this->Allocate();
 
     if (this->convChecker == nullptr)
@@ -219,39 +409,98 @@ void SolverNonLinear::ResetSolution() {
  * (the obtained solution will correspond to time t'=t+dt)
  */
 void SolverNonLinear::Solve(const real_t t, const real_t dt) {
-    // Return to main matrix inverter (in case backup inverter
-    // was used to complete last time step)
-    this->SwitchToMainInverter();
+    // Select the matrix inverter to start with (the main inverter,
+    // unless it has recently failed)
+    this->SelectInverter();
 
     this->nTimeStep++;
+    this->nFactorizationsStep = 0;
+    this->nLocalizedStep = 0;
+    if (this->localized != nullptr)
+        this->localized->Reset();
+
+    // Terms which are constant during the time step may
+    // have changed since the previous step
+    this->InvalidateJacobianBase();
+    this->telFillStep = 0;
 
 	this->t  = t;
 	this->dt = dt;
 
     this->timeKeeper->StartTimer(timerTot);
 
-	try {
-        this->_InternalSolve();
-    } catch (FVM::FVMException &ex) {
-        // Retry with backup-solver (if allowed and not already used)
-        if (this->backupInverter != nullptr && this->inverter != this->backupInverter) {
-            if (this->Verbose()) {
-                DREAM::IO::PrintInfo(
-                    "Main inverter failed to converge. Switching to backup inverter."
-                );
-                DREAM::IO::PrintError(ex.what());
-            }
+    // Start the Newton iteration from the solution of
+    // the reference run (when warm-starting), or from an
+    // extrapolation of the most recent solutions
+    if (this->warmStart != nullptr) {
+        this->unknowns->GetLongVector(this->nontrivial_unknowns, this->x0);
+        if (this->warmStart->GetGuess(t, this->x0))
+            this->StoreSolution(this->x0);
+    } else if (this->predictor != OptionConstants::SOLVER_PREDICTOR_NONE) {
+        this->unknowns->GetLongVector(this->nontrivial_unknowns, this->x0);
+        if (this->Predict(t+dt, this->x0))
+            this->StoreSolution(this->x0);
+    }
 
-            // Retry solve
-            this->SwitchToBackupInverter();
+    // Take the step with the reduced-order model, if possible (the
+    // first time step is always taken with the full model, since it
+    // establishes the non-zero pattern of the jacobian)
+    bool reduced = false;
+    if (this->reducedBasis != nullptr && this->nTimeStep > 1)
+        reduced = this->SolveReduced();
+
+    if (!reduced) {
+        try {
             this->_InternalSolve();
-        } else  // Rethrow exception
-            throw ex;
+        } catch (FVM::FVMException &ex) {
+            // Retry with backup-solver (if allowed and not already used)
+            if (this->backupInverter != nullptr && this->inverter != this->backupInverter) {
+                if (this->Verbose()) {
+                    DREAM::IO::PrintInfo(
+                        "Main inverter failed to converge. Switching to backup inverter."
+                    );
+                    DREAM::IO::PrintError(ex.what());
+                }
+
+                // Retry solve
+                this->SwitchToBackupInverter();
+                this->_InternalSolve();
+            } else if (!this->startedOnMain) {
+                // The backup inverter was only selected because of
+                // earlier failures, so retry with the main inverter
+                if (this->Verbose()) {
+                    DREAM::IO::PrintInfo(
+                        "Backup inverter failed to converge. Switching to main inverter."
+                    );
+                    DREAM::IO::PrintError(ex.what());
+                }
+
+                this->backupHold = 0;
+                this->startedOnMain = true;
+                this->SwitchToMainInverter();
+                this->ResetSolution();
+                this->_InternalSolve();
+            } else  // Rethrow exception
+                throw ex;
+        }
     }
 
+    this->UpdateInverterHistory();
+
     // Save basic statistics for step
     this->nIterations.push_back(this->iteration);
+    this->nFactorizations.push_back(this->nFactorizationsStep);
+    if (this->localized != nullptr)
+        this->nLocalizedIterations.push_back(this->nLocalizedStep);
     this->usedBackupInverter.push_back(this->inverter == this->backupInverter);
+    if (this->reducedBasis != nullptr)
+        this->usedReducedModel.push_back(reduced);
+    if (this->telemetry)
+        this->telFill.push_back(this->telFillStep);
+
+    // Store the data needed for evaluating adjoint sensitivities
+    if (this->adjoint != nullptr)
+        this->adjoint->RecordStep(t, dt, this->jacobian);
 
     this->timeKeeper->StopTimer(timerTot);
 }
@@ -260,11 +509,16 @@ void SolverNonLinear::_InternalSolve() {
 	// Take Newton steps
 	len_t iter = 0;
 	const real_t *x, *dx;
+    bool converged;
 	do {
 		iter++;
 		this->SetIteration(iter);
 
+        FVM::Tracer::Scope trace("Newton iteration", "iteration");
+
 REDO_ITER:
+        this->telDamping = 1;
+        this->telKSPIterations = 0;
 		dx = this->TakeNewtonStep();
         // Solution rejected (solver likely switched)
         if (dx == nullptr) {
@@ -279,7 +533,150 @@ REDO_ITER:
 		// TODO backtracking...
 		
 		AcceptSolution();
-	} while (!IsConverged(x, dx));
+
+        // Release temporary memory used by the equation terms
+        FVM::ScratchArena::NextIteration();
+
+        converged = IsConverged(x, dx);
+
+        // Select the radii to solve for in the next iteration (a
+        // localized iteration is always followed by a global one
+        // before convergence is accepted)
+        if (this->localized != nullptr) {
+            if (this->localized->IsLocal())
+                this->nLocalizedStep++;
+
+            converged = this->localized->Update(x, dx, this->convChecker, converged);
+            if (this->Verbose() && this->localized->IsLocal())
+                DREAM::IO::PrintInfo(
+                    "Localized Newton iteration: " LEN_T_PRINTF_FMT " active radii",
+                    this->localized->GetNumberOfActiveRadii()
+                );
+        }
+
+        if (this->telemetry)
+            this->RecordTelemetry();
+	// (with pseudo-transient continuation, the step is artificially
+	// short until the pseudo time step has become large)
+	} while (!converged || this->IsPseudoTransientActive());
+}
+
+/**
+ * Take the time step with the reduced-order model. Newton's method is
+ * applied to the Galerkin projection of the equations onto the reduced
+ * basis (see 'ReducedBasis'), starting from the projection of the current
+ * initial guess. The residual and jacobian are still evaluated with the
+ * full model, but the linear systems solved are only of the size of the
+ * basis. The reduced solution is accepted if the (rescaled) residual of
+ * the full model has decreased by at least the factor 'reducedTolerance'
+ * compared to the initial guess.
+ *
+ * RETURNS true if the reduced solution was accepted. Otherwise, the
+ * initial guess is restored so that the step can be retaken with the
+ * full model.
+ */
+bool SolverNonLinear::SolveReduced() {
+    FVM::Tracer::Scope trace("Reduced-order solve", "solver");
+
+    const len_t K = this->reducedBasis->GetNumberOfModes();
+    real_t *q  = new real_t[K];
+    real_t *Fr = new real_t[K];
+    real_t *Jr = new real_t[K*K];
+    real_t *fvec;
+
+    const real_t F0 = this->EvaluateResidualNorm(this->x0);
+    this->reducedBasis->Project(this->x0, q);
+
+    bool converged = false;
+    len_t iter = 0;
+    while (!converged && iter < this->MaxIter()) {
+        iter++;
+        this->SetIteration(iter);
+
+        this->reducedBasis->Expand(q, this->x1);
+
+        this->timeKeeper->StartTimer(timerResidual);
+        VecGetArray(this->petsc_F, &fvec);
+        this->_EvaluateF(this->x1, fvec, this->jacobian);
+        this->reducedBasis->ProjectResidual(fvec, Fr);
+        VecRestoreArray(this->petsc_F, &fvec);
+        this->timeKeeper->StopTimer(timerResidual);
+
+        this->timeKeeper->StartTimer(timerJacobian);
+        this->BuildJacobian(this->t, this->dt, this->jacobian);
+        this->timeKeeper->StopTimer(timerJacobian);
+
+        this->timeKeeper->StartTimer(timerInvert);
+        this->reducedBasis->ProjectJacobian(this->jacobian->mat(), Jr);
+        bool solved = ReducedBasis::SolveDense(K, Jr, Fr);
+        this->timeKeeper->StopTimer(timerInvert);
+
+        if (!solved)
+            break;
+
+        // The reduced coordinates are dimensionless (the
+        // basis is normalized by the scale of the unknowns)
+        real_t dqNorm = 0, qNorm = 0;
+        for (len_t j = 0; j < K; j++) {
+            q[j] -= Fr[j];
+            dqNorm += Fr[j]*Fr[j];
+            qNorm  += q[j]*q[j];
+        }
+
+        converged = (sqrt(dqNorm) <= this->reltol*max(sqrt(qNorm), 1.0));
+    }
+
+    bool accepted = false;
+    real_t F = 0;
+    if (converged) {
+        this->reducedBasis->Expand(q, this->x1);
+        F = this->EvaluateResidualNorm(this->x1);
+        // (NaN residuals are rejected)
+        accepted = (F <= this->reducedTolerance*F0);
+    }
+
+    if (accepted)
+        this->AcceptSolution();
+    else
+        this->StoreSolution(this->x0);
+
+    if (this->Verbose()) {
+        if (accepted)
+            DREAM::IO::PrintInfo(
+                "Reduced-order model converged in " LEN_T_PRINTF_FMT " iterations "
+                "(residual reduced by a factor %e).", iter, (F0 > 0 ? F/F0 : 0.0)
+            );
+        else
+            DREAM::IO::PrintInfo(
+                "Reduced-order model rejected. Retaking step with the full model."
+            );
+    }
+
+    delete [] Jr;
+    delete [] Fr;
+    delete [] q;
+
+    return accepted;
+}
+
+/**
+ * Record convergence telemetry for the most recent Newton iteration.
+ * The norms of the solution and of the Newton step for each non-trivial
+ * unknown are taken from the convergence checker (and must therefore
+ * have been evaluated in the current iteration).
+ */
+void SolverNonLinear::RecordTelemetry() {
+    this->telStep.push_back(this->nTimeStep);
+    this->telIteration.push_back(this->iteration);
+    this->telKSP.push_back(this->telKSPIterations);
+    this->telDampingFactors.push_back(this->telDamping);
+
+    const real_t *dxn = this->convChecker->GetErrorNorms();
+    const real_t *xn  = this->convChecker->GetSolutionNorms();
+    for (len_t i = 0; i < this->nontrivial_unknowns.size(); i++) {
+        this->telResidual.push_back(dxn[i]);
+        this->telSolution.push_back(xn[i]);
+    }
 }
 
 /**
@@ -295,15 +692,15 @@ REDO_ITER:
  */
 void SolverNonLinear::SaveNumericalJacobian(const std::string& name) {
     this->_EvaluateJacobianNumerically(this->jacobian);
-    this->jacobian->View(FVM::Matrix::BINARY_MATLAB, name + "_num");
+    this->SaveDebugMatrix(this->jacobian, name + "_num");
     abort();
 }
 
 void SolverNonLinear::SaveJacobian() {
-    this->jacobian->View(FVM::Matrix::BINARY_MATLAB, "petsc_jacobian");
+    this->SaveDebugMatrix(this->jacobian, "petsc_jacobian");
 }
 void SolverNonLinear::SaveJacobian(const std::string& name) {
-    this->jacobian->View(FVM::Matrix::BINARY_MATLAB, name);
+    this->SaveDebugMatrix(this->jacobian, name);
 }
 
 /**
@@ -318,52 +715,155 @@ void SolverNonLinear::StoreSolution(const real_t *x) {
  */
 const real_t *SolverNonLinear::TakeNewtonStep() {
     this->timeKeeper->StartTimer(timerRebuild);
-	this->RebuildTerms(this->t, this->dt);
+    {
+        FVM::PetscLog::Stage stage("DREAM rebuild");
+        this->RebuildTerms(this->t, this->dt);
+    }
     this->timeKeeper->StopTimer(timerRebuild);
 
-	// Evaluate function vector
-    this->timeKeeper->StartTimer(timerResidual);
-	real_t *fvec;
-	VecGetArray(this->petsc_F, &fvec);
-	this->BuildVector(this->t, this->dt, fvec, this->jacobian);
-	VecRestoreArray(this->petsc_F, &fvec);
-    this->timeKeeper->StopTimer(timerResidual);
-    
     // Reconstruct the jacobian matrix after taking the first
     // iteration.
     // (See the comment above 'AllocateJacobianMatrix()' for
     // details about why we do this...)
-    if (this->nTimeStep == 1 && this->iteration == 2)
+    if (this->nTimeStep == 1 && this->iteration == 2 && !this->jacobianPreallocated)
         this->AllocateJacobianMatrix();
 
+    // In Newton-Krylov mode, the jacobian is always rebuilt (but
+    // not necessarily factorized), while in modified Newton and
+    // JFNK mode the previous jacobian is reused as-is
+    bool updateJacobian = this->IsJacobianUpdateNeeded();
+    bool buildJacobian = (
+        updateJacobian ||
+        this->jacobianUpdate == OptionConstants::SOLVER_JACOBIAN_UPDATE_NEWTON_KRYLOV
+    );
+
+    // With distributed linear systems, each process only assembles
+    // the jacobian rows which it owns, once the full non-zero structure
+    // is known (so that the full jacobian can later be assembled again
+    // without allocating new non-zeros, if the distributed solve fails)
+    if (this->distributed != nullptr) {
+        const bool owned = (
+            this->jacobianStructureComplete && !this->fullJacobianRequired &&
+            this->inverter == this->mainInverter && !this->savejacobian && !this->savenumjac && !this->savesystem
+        );
+        if (owned != this->jacobian->HasRowMask()) {
+            this->jacobian->SetRowMask(owned ? &this->distributed->GetOwnedRows() : nullptr);
+            // (the constant part of the jacobian saved by 'BuildJacobian()'
+            // may only contain the owned rows)
+            this->InvalidateJacobianBase();
+        }
+    }
+
+	// Evaluate function vector (together with the jacobian,
+    // with fused assembly)
+    real_t *fvec;
+    const bool fused = (buildJacobian && this->fusedAssembly);
+    this->timeKeeper->StartTimer(fused ? timerJacobian : timerResidual);
+    {
+        FVM::PetscLog::Stage stage(fused ? "DREAM residual+jacobian" : "DREAM residual");
+        VecGetArray(this->petsc_F, &fvec);
+        try {
+            if (fused)
+                this->BuildJacobian(this->t, this->dt, this->jacobian, fvec);
+            else
+                this->BuildVector(this->t, this->dt, fvec, this->jacobian);
+
+            this->CheckVector(fvec, this->jacobian);
+        } catch (...) {
+            VecRestoreArray(this->petsc_F, &fvec);
+            throw;
+        }
+
+        // Keep the point of linearization, and the (unscaled) residual in
+        // that point, for the matrix-free jacobian
+        if (this->jacobianUpdate == OptionConstants::SOLVER_JACOBIAN_UPDATE_JFNK) {
+            this->unknowns->GetLongVector(this->nontrivial_unknowns, this->jfnkX);
+            for (len_t i = 0; i < this->matrix_size; i++)
+                this->jfnkF0[i] = fvec[i];
+        }
+        VecRestoreArray(this->petsc_F, &fvec);
+    }
+    this->timeKeeper->StopTimer(fused ? timerJacobian : timerResidual);
+
 	// Evaluate jacobian
-    this->timeKeeper->StartTimer(timerJacobian);
-	this->BuildJacobian(this->t, this->dt, this->jacobian);
-    this->timeKeeper->StopTimer(timerJacobian);
+    if (buildJacobian && !fused) {
+        FVM::PetscLog::Stage stage("DREAM jacobian");
+        this->timeKeeper->StartTimer(timerJacobian);
+        this->BuildJacobian(this->t, this->dt, this->jacobian);
+        this->timeKeeper->StopTimer(timerJacobian);
+    }
+
+    if (buildJacobian && !this->jacobian->HasRowMask())
+        this->jacobianStructureComplete = true;
 
     // Print/save debug info and apply preconditioner (if enabled)
+    // (a reused jacobian has already been rescaled)
+    FVM::Matrix *precMat = (buildJacobian ? this->jacobian : nullptr);
     if (this->debugrescaled) {
-        this->Precondition(this->jacobian, this->petsc_F);
+        this->Precondition(precMat, this->petsc_F);
         this->SaveDebugInfoBefore(this->nTimeStep, this->iteration);
     } else {
         this->SaveDebugInfoBefore(this->nTimeStep, this->iteration);
-        this->Precondition(this->jacobian, this->petsc_F);
+        this->Precondition(precMat, this->petsc_F);
+    }
+
+    // Reference residual norm for the line search, pseudo-transient
+    // continuation and Eisenstat-Walker forcing terms
+    if (this->lineSearch == OptionConstants::SOLVER_LINE_SEARCH_BACKTRACKING ||
+        this->ptcEnabled || this->ewEnabled)
+        VecNorm(this->petsc_F, NORM_2, &this->residualNorm);
+
+    if (this->ewEnabled)
+        this->UpdateForcingTerm();
+
+    if (this->ptcEnabled) {
+        this->UpdatePseudoTimeStep();
+        if (buildJacobian && this->IsPseudoTransientActive())
+            this->AddPseudoTransientShift();
     }
 
 	// Solve J*dx = F
-    this->timeKeeper->StartTimer(timerInvert);
-    inverter->Invert(this->jacobian, &this->petsc_F, &this->petsc_dx);
+    {
+        FVM::PetscLog::Stage stage("DREAM invert");
+        this->timeKeeper->StartTimer(timerInvert);
+        if (updateJacobian) {
+            this->InvertJacobian(true);
+
+            // The distributed solve failed, and this process has not
+            // assembled all rows of the jacobian: redo the iteration with
+            // the full jacobian
+            if (this->fullJacobianRequired && this->jacobian->HasRowMask()) {
+                this->timeKeeper->StopTimer(timerInvert);
+                return nullptr;
+            }
+        } else if (this->jacobianUpdate == OptionConstants::SOLVER_JACOBIAN_UPDATE_NEWTON_KRYLOV) {
+            // Refactorize the new jacobian if the Krylov solver fails
+            if (!this->SolveNewtonKrylov())
+                this->InvertJacobian(true);
+        } else if (this->jacobianUpdate == OptionConstants::SOLVER_JACOBIAN_UPDATE_JFNK) {
+            // The jacobian has not been rebuilt in this iteration, so if
+            // the Krylov solver fails we redo the iteration with a new
+            // jacobian
+            if (!this->SolveJacobianFreeNewtonKrylov()) {
+                this->forceJacobianUpdate = true;
+                this->timeKeeper->StopTimer(timerInvert);
+
+                return nullptr;
+            }
+        } else
+            this->InvertJacobian(false);
 
-    if (inverter->GetReturnCode() != 0) {
-        if (this->Verbose())
-            DREAM::IO::PrintInfo("Switching to backup inverter... " INT_T_PRINTF_FMT, inverter->GetReturnCode());
+        if (inverter->GetReturnCode() != 0) {
+            if (this->Verbose())
+                DREAM::IO::PrintInfo("Switching to backup inverter... " INT_T_PRINTF_FMT, inverter->GetReturnCode());
 
-        this->SwitchToBackupInverter();
+            this->SwitchToBackupInverter();
 
-        return nullptr;
-    }
+            return nullptr;
+        }
 
-    this->timeKeeper->StopTimer(timerInvert);
+        this->timeKeeper->StopTimer(timerInvert);
+    }
 
     // Undo preconditioner and save additional debug info (if requested)
     if (this->debugrescaled) {
@@ -374,15 +874,288 @@ const real_t *SolverNonLinear::TakeNewtonStep() {
         this->SaveDebugInfoAfter(this->nTimeStep, this->iteration);
     }
 
-	// Copy dx
-	VecGetArray(this->petsc_dx, &fvec);
-	for (len_t i = 0; i < this->matrix_size; i++)
-		this->dx[i] = fvec[i];
-	VecRestoreArray(this->petsc_dx, &fvec);
+	// Copy dx (unless the solution vector already
+	// stores its elements in 'dx')
+    if (!this->dxShared) {
+        VecGetArray(this->petsc_dx, &fvec);
+        for (len_t i = 0; i < this->matrix_size; i++)
+            this->dx[i] = fvec[i];
+        VecRestoreArray(this->petsc_dx, &fvec);
+    }
+
+    // When an old jacobian was used, require the iteration to
+    // contract sufficiently fast (otherwise, refactorize the
+    // jacobian in the next iteration)
+    if (this->jacobianUpdate != OptionConstants::SOLVER_JACOBIAN_UPDATE_ALWAYS) {
+        real_t dxNorm = 0;
+        for (len_t i = 0; i < this->matrix_size; i++)
+            dxNorm += this->dx[i]*this->dx[i];
+        dxNorm = sqrt(dxNorm);
+
+        if (!updateJacobian && this->iteration > 1 &&
+            dxNorm > this->maxContraction*this->dxNormPrev)
+            this->forceJacobianUpdate = true;
+
+        this->dxNormPrev = dxNorm;
+    }
 	
+    this->fullJacobianRequired = false;
 	return this->dx;
 }
 
+/**
+ * Returns 'true' if the jacobian matrix should be rebuilt and
+ * factorized in the current iteration.
+ */
+bool SolverNonLinear::IsJacobianUpdateNeeded() {
+    if (this->jacobianUpdate == OptionConstants::SOLVER_JACOBIAN_UPDATE_ALWAYS)
+        return true;
+
+    // The jacobian depends explicitly on the time step length, and
+    // the factorization is only available in the inverter which
+    // computed it
+    return (
+        this->forceJacobianUpdate ||
+        this->factorizedInverter != this->inverter ||
+        this->factorizedDt != this->dt
+    );
+}
+
+/**
+ * Solve J*dx = F using the currently selected linear solver.
+ *
+ * refactorize: If 'true', the jacobian matrix is factorized anew.
+ *              Otherwise, the most recent factorization is reused.
+ */
+void SolverNonLinear::InvertJacobian(bool refactorize) {
+    this->inverter->SetReuseFactorization(!refactorize);
+
+    // In a localized iteration, only the block of the jacobian
+    // corresponding to the active radii is factorized (with a
+    // separate solver, since its size changes with the active radii)
+    if (this->localized != nullptr && this->localized->IsLocal()) {
+        if (this->localized->Solve(this->jacobian, this->petsc_F, this->petsc_dx)) {
+            this->nFactorizationsStep++;
+            this->forceJacobianUpdate = false;
+            this->factorizedInverter = nullptr;
+            return;
+        }
+
+        // Solve the full system instead
+        this->localized->Reset();
+    }
+
+    // Distributed systems are solved by all MPI processes together
+    // (if the distributed solve fails, the sequential solver is tried
+    // on every process, with the full jacobian, before switching to
+    // the backup solver; the distributed solve either fails or
+    // succeeds on all processes together)
+    if (this->distributed != nullptr && this->inverter == this->mainInverter &&
+        !this->fullJacobianRequired) {
+        if (this->distributed->Solve(this->jacobian, this->petsc_F, this->petsc_dx)) {
+            if (this->telemetry)
+                this->telKSPIterations += this->distributed->GetIterationNumber();
+
+            this->nFactorizationsStep++;
+            this->forceJacobianUpdate = false;
+            this->factorizedInverter = nullptr;
+            return;
+        }
+
+        this->fullJacobianRequired = true;
+        if (this->jacobian->HasRowMask())
+            return;
+    }
+
+    // In a bordered system, only the (sparse) interior block is
+    // factorized, and the border is solved for with its Schur
+    // complement
+    const bool solved = (
+        this->bordered != nullptr &&
+        this->bordered->Solve(this->jacobian, this->petsc_F, this->petsc_dx, this->inverter)
+    );
+
+    // With algebraic elimination, only the reduced system is
+    // factorized (so the reduced matrix must be refactorized in
+    // every iteration, which is ensured by the settings)
+    if (!solved && this->elimination != nullptr && this->elimination->Reduce(this->jacobian, this->petsc_F)) {
+        this->inverter->Invert(
+            this->elimination->GetReducedMatrix(),
+            this->elimination->GetReducedRHS(),
+            this->elimination->GetReducedSolution()
+        );
+
+        if (this->inverter->GetReturnCode() == 0)
+            this->elimination->Expand(this->petsc_dx);
+    } else if (!solved)
+        this->inverter->Invert(this->jacobian, &this->petsc_F, &this->petsc_dx);
+
+    if (this->telemetry)
+        this->telKSPIterations += this->inverter->GetIterationNumber();
+
+    if (refactorize) {
+        this->nFactorizationsStep++;
+        this->forceJacobianUpdate = false;
+
+        if (this->telemetry)
+            this->telFillStep = max(this->telFillStep, this->inverter->GetFactorizationFill());
+
+        if (this->inverter->GetReturnCode() == 0) {
+            this->factorizedInverter = this->inverter;
+            this->factorizedDt = this->dt;
+        } else
+            this->factorizedInverter = nullptr;
+    }
+}
+
+/**
+ * Solve J*dx = F using GMRES, preconditioned with the most recently
+ * factorized jacobian matrix. Returns 'false' if the Krylov solver
+ * did not converge within the allowed number of iterations.
+ */
+bool SolverNonLinear::SolveNewtonKrylov() {
+    KSPConvergedReason reason;
+
+    KSPSetOperators(this->nkKSP, this->jacobian->mat(), this->jacobian->mat());
+    KSPSolve(this->nkKSP, this->petsc_F, this->petsc_dx);
+    KSPGetConvergedReason(this->nkKSP, &reason);
+
+    if (this->telemetry) {
+        PetscInt its;
+        KSPGetIterationNumber(this->nkKSP, &its);
+        this->telKSPIterations += its;
+    }
+
+    if (reason < 0 && this->Verbose())
+        DREAM::IO::PrintInfo(
+            "Newton-Krylov solve did not converge (reason %d). Refactorizing jacobian.",
+            (int)reason
+        );
+
+    return (reason > 0);
+}
+
+/**
+ * Solve J*dx = F using GMRES, with the action of the jacobian
+ * approximated by finite differences of the residual function
+ * (see 'ApplyJacobianFree()'), and preconditioned with the most
+ * recently factorized jacobian matrix. Since the jacobian is only
+ * used in the preconditioner, it may be kept for a long time
+ * without degrading the convergence of the Newton iteration.
+ * Returns 'false' if the Krylov solver did not converge within the
+ * allowed number of iterations.
+ */
+bool SolverNonLinear::SolveJacobianFreeNewtonKrylov() {
+    KSPConvergedReason reason;
+
+    KSPSetOperators(this->nkKSP, this->jfnkMat, this->jacobian->mat());
+    KSPSolve(this->nkKSP, this->petsc_F, this->petsc_dx);
+    KSPGetConvergedReason(this->nkKSP, &reason);
+
+    if (this->telemetry) {
+        PetscInt its;
+        KSPGetIterationNumber(this->nkKSP, &its);
+        this->telKSPIterations += its;
+    }
+
+    // Restore unknowns and equation terms to the point of linearization
+    this->StoreSolution(this->jfnkX);
+    this->RebuildTerms(this->t, this->dt);
+
+    if (reason < 0 && this->Verbose())
+        DREAM::IO::PrintInfo(
+            "Jacobian-free Newton-Krylov solve did not converge (reason %d). Rebuilding jacobian.",
+            (int)reason
+        );
+
+    return (reason > 0);
+}
+
+/**
+ * Evaluate the action of the jacobian matrix on the vector 'v'
+ * using a finite difference of the residual function,
+ *
+ *   J*v ~ (F(x + h*v) - F(x)) / h,
+ *
+ * where x is the current point of linearization, and store the
+ * result in 'y'. The step length h is chosen so that the
+ * perturbation of x is of the order of the square root of the
+ * machine precision. Since the Krylov solver operates on the
+ * rescaled equation system (if the diagonal preconditioner is
+ * enabled), 'v' is first transformed back to the unscaled
+ * unknowns, and the result is rescaled like the residual.
+ */
+void SolverNonLinear::ApplyJacobianFree(Vec v, Vec y) {
+    real_t *yv;
+    const len_t N = this->matrix_size;
+
+    // Transform 'v' to unscaled unknowns (using 'y' as work vector)
+    VecCopy(v, y);
+    this->UnPrecondition(y);
+
+    VecGetArray(y, &yv);
+    real_t vnorm = 0, xnorm = 0;
+    for (len_t i = 0; i < N; i++) {
+        vnorm += yv[i]*yv[i];
+        xnorm += this->jfnkX[i]*this->jfnkX[i];
+    }
+    vnorm = sqrt(vnorm);
+    xnorm = sqrt(xnorm);
+
+    if (vnorm == 0) {
+        for (len_t i = 0; i < N; i++)
+            yv[i] = 0;
+        VecRestoreArray(y, &yv);
+        return;
+    }
+
+    const real_t h = sqrt(std::numeric_limits<real_t>::epsilon()) * (1 + xnorm) / vnorm;
+    for (len_t i = 0; i < N; i++)
+        this->jfnkXh[i] = this->jfnkX[i] + h*yv[i];
+    VecRestoreArray(y, &yv);
+
+    this->_EvaluateF(this->jfnkXh, this->jfnkFh, this->jacobian);
+
+    VecGetArray(y, &yv);
+    for (len_t i = 0; i < N; i++)
+        yv[i] = (this->jfnkFh[i] - this->jfnkF0[i]) / h;
+    VecRestoreArray(y, &yv);
+
+    // Rescale like the residual
+    this->Precondition(nullptr, y);
+}
+
+/**
+ * Apply the inverse of the most recently factorized jacobian
+ * matrix to the vector 'x', and store the result in 'y'.
+ */
+void SolverNonLinear::ApplyFactorizedJacobian(Vec x, Vec y) {
+    this->factorizedInverter->SetReuseFactorization(true);
+    this->factorizedInverter->Invert(this->jacobian, &x, &y);
+}
+
+/**
+ * Set the strategy to use for updating the jacobian matrix.
+ *
+ * mode:           Jacobian update strategy.
+ * maxContraction: Largest ratio between the lengths of two consecutive
+ *                 Newton steps allowed before an old jacobian is
+ *                 refactorized.
+ * krylovRelTol:   Relative tolerance of the Krylov solver (used in
+ *                 Newton-Krylov mode).
+ * krylovMaxIter:  Maximum number of Krylov iterations per Newton step.
+ */
+void SolverNonLinear::SetJacobianUpdate(
+    enum OptionConstants::solver_jacobian_update mode,
+    const real_t maxContraction, const real_t krylovRelTol,
+    const len_t krylovMaxIter
+) {
+    this->jacobianUpdate = mode;
+    this->maxContraction = maxContraction;
+    this->krylovRelTol = krylovRelTol;
+    this->krylovMaxIter = krylovMaxIter;
+}
+
 
 
 /**
@@ -504,18 +1277,497 @@ const real_t *SolverNonLinear::UpdateSolution(const real_t *dx) {
 		DREAM::IO::PrintInfo("to conserve positivity, by a factor: %e", dampingFactor);
         DREAM::IO::PrintInfo();
 	}
+
+    // Shorten the (physically allowed) step further until the
+    // residual decreases sufficiently
+    if (this->lineSearch == OptionConstants::SOLVER_LINE_SEARCH_BACKTRACKING)
+        dampingFactor = this->BacktrackingLineSearch(dx, dampingFactor);
+
+    this->telDamping = dampingFactor;
+
 	for (len_t i = 0; i < this->matrix_size; i++)
 		this->x1[i] = this->x0[i] - dampingFactor*dx[i];
 	
 	return this->x1;
 }
 
+/**
+ * Backtracking line search along the Newton direction. Starting
+ * from the given step length, the step is shortened until the
+ * (rescaled) residual norm satisfies the sufficient decrease
+ * condition
+ *
+ *   |F(x0 - lambda*dx)| <= (1 - ALPHA*lambda) |F(x0)|.
+ *
+ * In each backtracking step, the new step length is taken as the
+ * minimum of a quadratic model of |F|^2 along the Newton direction,
+ * safeguarded to lie within [0.1, 0.5] of the previous step length.
+ * If no sufficiently short step is found within the allowed number
+ * of backtracking steps, the shortest step is taken anyway (and the
+ * non-linear solver will eventually give up, allowing the time
+ * stepper to reduce the time step).
+ *
+ * dx:        Newton step.
+ * lambdaMax: Longest step length allowed (i.e. the step length
+ *            below which all unknowns remain physical).
+ *
+ * RETURNS the step length to use.
+ */
+real_t SolverNonLinear::BacktrackingLineSearch(const real_t *dx, const real_t lambdaMax) {
+    const real_t ALPHA = 1e-4;
+    const real_t n0 = this->residualNorm;
+    if (n0 == 0)
+        return lambdaMax;
+
+    FVM::Tracer::Scope trace("Line search", "solver");
+
+    real_t lambda = lambdaMax;
+    for (len_t k = 0; k < this->lineSearchMaxSteps; k++) {
+        for (len_t i = 0; i < this->matrix_size; i++)
+            this->x1[i] = this->x0[i] - lambda*dx[i];
+
+        const real_t n = this->EvaluateResidualNorm(this->x1);
+        if (n <= (1-ALPHA*lambda)*n0)
+            return lambda;
+
+        // Minimize the quadratic model
+        //   g(l) = |F(x0)|^2 (1 - 2l) + c*l^2
+        // passing through g(lambda) = n^2
+        const real_t g0 = n0*n0, g = n*n;
+        real_t lnew = g0*lambda*lambda / (g - g0 + 2*g0*lambda);
+        if (!std::isfinite(lnew) || lnew > 0.5*lambda)
+            lnew = 0.5*lambda;
+        else if (lnew < 0.1*lambda)
+            lnew = 0.1*lambda;
+
+        lambda = lnew;
+    }
+
+    if (this->Verbose())
+        DREAM::IO::PrintInfo(
+            "Line search did not reach sufficient decrease of the residual "
+            "within " LEN_T_PRINTF_FMT " steps. Taking step of length %e.",
+            this->lineSearchMaxSteps, lambda
+        );
+
+    return lambda;
+}
+
+/**
+ * Evaluate the norm of the (rescaled) residual in the given point.
+ * On return, the unknowns will have been set to the given point.
+ *
+ * x: Point in which to evaluate the residual.
+ */
+real_t SolverNonLinear::EvaluateResidualNorm(const real_t *x) {
+    real_t *fvec, norm;
+
+    FVM::PetscLog::Stage stage("DREAM residual");
+    this->timeKeeper->StartTimer(timerResidual);
+    VecGetArray(this->petsc_Ftrial, &fvec);
+    this->_EvaluateF(x, fvec, this->jacobian);
+    VecRestoreArray(this->petsc_Ftrial, &fvec);
+
+    this->Precondition(nullptr, this->petsc_Ftrial);
+    VecNorm(this->petsc_Ftrial, NORM_2, &norm);
+    this->timeKeeper->StopTimer(timerResidual);
+
+    return norm;
+}
+
+/**
+ * Evaluate the (rescaled) residual norm in the given point, for
+ * a time step 'dt' taken to time 't'. This is used to estimate the
+ * error of solutions obtained by other means than this solver (see
+ * 'SolverSplit').
+ *
+ * t:  Time to evaluate the residual for.
+ * dt: Length of time step.
+ * x:  Point in which to evaluate the residual.
+ */
+real_t SolverNonLinear::EvaluateResidualNorm(const real_t t, const real_t dt, const real_t *x) {
+    this->t  = t;
+    this->dt = dt;
+
+    return this->EvaluateResidualNorm(x);
+}
+
+/**
+ * Set the globalization strategy of the Newton iteration.
+ *
+ * ls:       Line search method.
+ * maxSteps: Maximum number of backtracking steps per iteration.
+ */
+void SolverNonLinear::SetLineSearch(
+    enum OptionConstants::solver_line_search ls, const len_t maxSteps
+) {
+    this->lineSearch = ls;
+    this->lineSearchMaxSteps = maxSteps;
+}
+
+/**
+ * Extrapolate the solutions in the most recent time steps (kept by
+ * the unknown quantities for computing time derivatives and rolling
+ * back steps) to the given time, using the Lagrange polynomial through
+ * the two (linear predictor) or three (quadratic predictor) most
+ * recent solutions. Fewer solutions are used if the history is not
+ * long enough (e.g. in the first time steps). Since a rejected step
+ * of the adaptive time stepper does not modify the history, a retried
+ * step is predicted in the same way with the shorter time step.
+ *
+ * Quantities which must be non-negative (densities, temperatures and
+ * energies) are not extrapolated below zero: such elements instead
+ * keep their value from the previous time step.
+ *
+ * t: Time to extrapolate the solution to.
+ * x: On input, the solution in the previous time step (as a long
+ *    vector of the non-trivial unknowns). On return, contains the
+ *    predicted solution.
+ *
+ * RETURNS true if any element of 'x' was changed.
+ */
+bool SolverNonLinear::Predict(const real_t t, real_t *x) {
+    const len_t order = (this->predictor == OptionConstants::SOLVER_PREDICTOR_QUADRATIC ? 2 : 1);
+
+    // Same quantities as are kept non-negative by the Newton damping
+    vector<len_t> nonNegative = {
+        this->unknowns->GetUnknownID(OptionConstants::UQTY_T_COLD),
+        this->unknowns->GetUnknownID(OptionConstants::UQTY_N_TOT),
+        this->unknowns->GetUnknownID(OptionConstants::UQTY_N_COLD),
+        this->unknowns->GetUnknownID(OptionConstants::UQTY_ION_SPECIES)
+    };
+    if (this->unknowns->HasUnknown(OptionConstants::UQTY_W_COLD))
+        nonNegative.push_back(this->unknowns->GetUnknownID(OptionConstants::UQTY_W_COLD));
+    if (this->unknowns->HasUnknown(OptionConstants::UQTY_WI_ENER))
+        nonNegative.push_back(this->unknowns->GetUnknownID(OptionConstants::UQTY_WI_ENER));
+    if (this->unknowns->HasUnknown(OptionConstants::UQTY_NI_DENS))
+        nonNegative.push_back(this->unknowns->GetUnknownID(OptionConstants::UQTY_NI_DENS));
+
+    bool changed = false;
+    len_t offset = 0;
+    for (len_t id : this->nontrivial_unknowns) {
+        FVM::UnknownQuantity *uqn = this->unknowns->GetUnknown(id);
+        FVM::QuantityData *qd = uqn->GetQuantityData();
+        const len_t N = uqn->NumberOfElements();
+
+        // Number of (distinct) solutions to extrapolate from
+        len_t n = min(order+1, qd->GetNOldSaved());
+        for (len_t k = 1; k < n; k++) {
+            if (!(qd->GetOldTime(k) < qd->GetOldTime(k-1))) {
+                n = k;
+                break;
+            }
+        }
+
+        if (n < 2) {
+            offset += N;
+            continue;
+        }
+
+        // Lagrange weights at time 't'
+        real_t w[3];
+        for (len_t k = 0; k < n; k++) {
+            w[k] = 1;
+            for (len_t j = 0; j < n; j++)
+                if (j != k)
+                    w[k] *= (t - qd->GetOldTime(j)) / (qd->GetOldTime(k) - qd->GetOldTime(j));
+        }
+
+        const bool positive = (std::find(nonNegative.begin(), nonNegative.end(), id) != nonNegative.end());
+        const real_t *x1 = qd->GetOldData(0);
+        for (len_t i = 0; i < N; i++) {
+            real_t v = 0;
+            for (len_t k = 0; k < n; k++)
+                v += w[k] * qd->GetOldData(k)[i];
+
+            if (!std::isfinite(v) || (positive && v < 0))
+                v = x1[i];
+
+            x[offset+i] = v;
+        }
+
+        changed = true;
+        offset += N;
+    }
+
+    return changed;
+}
+
+/**
+ * Update the pseudo time step according to the "switched evolution
+ * relaxation" (SER) strategy,
+ *
+ *   tau_k = tau_{k-1} * |F_{k-1}| / |F_k|,
+ *
+ * so that the pseudo time step grows as the residual decreases,
+ * and the iteration turns into an ordinary Newton iteration once
+ * the pseudo time step exceeds 'ptcTauMax'. The pseudo time step
+ * is reset in the first iteration of each time step.
+ */
+void SolverNonLinear::UpdatePseudoTimeStep() {
+    if (this->iteration == 1)
+        this->ptcTau = this->ptcTau0;
+    else if (this->residualNorm == 0)
+        this->ptcTau = this->ptcTauMax;
+    else {
+        this->ptcTau *= this->ptcResidualPrev / this->residualNorm;
+        this->ptcTau = max(this->ptcTau0, min(this->ptcTauMax, this->ptcTau));
+    }
+
+    this->ptcResidualPrev = this->residualNorm;
+}
+
+/**
+ * Add the pseudo time derivative term to the diagonal of the
+ * jacobian matrix. To avoid having to choose a pseudo time step
+ * for each unknown separately, the term added to each row is
+ * proportional to the magnitude of the diagonal element of the
+ * jacobian in that row, i.e. the pseudo time step of each
+ * unknown (element) is measured in units of its own
+ * characteristic time |J_ii|^-1. Rows with a vanishing diagonal
+ * (such as purely algebraic constraints) are left unchanged.
+ */
+void SolverNonLinear::AddPseudoTransientShift() {
+    Vec d;
+    Mat J = this->jacobian->mat();
+
+    MatCreateVecs(J, nullptr, &d);
+    MatGetDiagonal(J, d);
+    VecAbs(d);
+    VecScale(d, 1/this->ptcTau);
+    MatDiagonalSet(J, d, ADD_VALUES);
+
+    VecDestroy(&d);
+}
+
+/**
+ * Enable or disable pseudo-transient continuation.
+ *
+ * enabled: If 'true', enables pseudo-transient continuation.
+ * tau0:    Initial (relative) pseudo time step.
+ * tauMax:  Pseudo time step above which the pseudo time
+ *          derivative is dropped.
+ */
+void SolverNonLinear::SetPseudoTransient(
+    const bool enabled, const real_t tau0, const real_t tauMax
+) {
+    this->ptcEnabled = enabled;
+    this->ptcTau0 = tau0;
+    this->ptcTauMax = tauMax;
+}
+
+/**
+ * Update the Eisenstat-Walker forcing term, i.e. the relative
+ * tolerance to which the linear system J*dx = F is solved in the
+ * current Newton iteration, and pass it on to the iterative linear
+ * solvers. Far from the solution, an approximate Newton step is as
+ * good as an exact one, and so the tolerance is relaxed while the
+ * residual decreases slowly, and tightened as the iteration starts
+ * converging quadratically. We use choice 2 of Eisenstat & Walker
+ * (SIAM J. Sci. Comput. 17, 16, 1996),
+ *
+ *   eta_k = gamma * (|F_k| / |F_{k-1}|)^alpha,
+ *
+ * with gamma = 0.9 and alpha = (1+sqrt(5))/2, safeguarded against
+ * decreasing too rapidly and limited to [ewEtaMin, ewEtaMax]. Direct
+ * linear solvers ignore the tolerance.
+ */
+void SolverNonLinear::UpdateForcingTerm() {
+    const real_t gamma = 0.9, alpha = 0.5*(1+sqrt(5.0));
+
+    real_t eta;
+    if (this->iteration == 1)
+        eta = 0.3;
+    else if (this->ewResidualPrev == 0)
+        eta = this->ewEtaMin;
+    else {
+        eta = gamma * pow(this->residualNorm / this->ewResidualPrev, alpha);
+
+        // Do not let the tolerance drop much faster than the
+        // residual converges (unless it is small already)
+        const real_t etaSafe = gamma * pow(this->ewEta, alpha);
+        if (etaSafe > 0.1)
+            eta = max(eta, etaSafe);
+    }
+
+    this->ewEta = max(this->ewEtaMin, min(this->ewEtaMax, eta));
+    this->ewResidualPrev = this->residualNorm;
+
+    this->inverter->SetRelativeTolerance(this->ewEta);
+    if (this->nkKSPAllocated)
+        KSPSetTolerances(
+            this->nkKSP, this->ewEta, PETSC_DEFAULT, PETSC_DEFAULT,
+            (PetscInt)this->krylovMaxIter
+        );
+}
+
+/**
+ * Enable or disable Eisenstat-Walker forcing terms for the
+ * iterative linear solves of the Newton iteration.
+ *
+ * enabled: If 'true', the relative tolerance of the iterative linear
+ *          solvers is adapted to the convergence of the Newton iteration.
+ * etaMin:  Smallest relative tolerance to use.
+ * etaMax:  Largest relative tolerance to use.
+ */
+void SolverNonLinear::SetEisenstatWalker(
+    const bool enabled, const real_t etaMin, const real_t etaMax
+) {
+    this->ewEnabled = enabled;
+    this->ewEtaMin = etaMin;
+    this->ewEtaMax = etaMax;
+}
+
+/**
+ * Print an estimate of the computational cost of the simulation. The
+ * work of a single Newton iteration (rebuilding the terms, evaluating
+ * the residual, building and factorizing the jacobian) is carried out
+ * at the initial state and timed, and the size of the jacobian matrix
+ * and its factorization is reported. Note that in the first iteration,
+ * the jacobian may contain fewer non-zeros than in later iterations.
+ *
+ * t:      Time at which to evaluate the iteration.
+ * dt:     Time step to use.
+ * nSteps: Number of time steps to take (or 0 if not known).
+ */
+void SolverNonLinear::PrintCostEstimate(const real_t t, const real_t dt, const len_t nSteps) {
+    // Assumed average number of Newton iterations per time step
+    const len_t ITERATIONS_PER_STEP = 3;
+
+    // Number of non-zeros which are preallocated
+    len_t nnzEstimate = 0;
+    for (len_t id : this->nontrivial_unknowns) {
+        UnknownQuantityEquation *eqn = this->unknown_equations->at(id);
+        nnzEstimate += eqn->NumberOfElements() * eqn->NumberOfNonZeros_jac();
+    }
+
+    this->t = t;
+    this->dt = dt;
+    this->nTimeStep = 1;
+    this->SetIteration(1);
+
+    // Carry out the work of one Newton iteration (at the initial state)
+    FVM::DurationTimer tRebuild, tResidual, tJacobian, tInvert;
+
+    tRebuild.Start();
+    this->RebuildTerms(t, dt);
+    tRebuild.Stop();
+
+    tResidual.Start();
+    real_t *fvec;
+    VecGetArray(this->petsc_F, &fvec);
+    this->BuildVector(t, dt, fvec, this->jacobian);
+    VecRestoreArray(this->petsc_F, &fvec);
+    tResidual.Stop();
+
+    tJacobian.Start();
+    this->InvalidateJacobianBase();
+    this->BuildJacobian(t, dt, this->jacobian);
+    tJacobian.Stop();
+
+    tInvert.Start();
+    this->Precondition(this->jacobian, this->petsc_F);
+    this->InvertJacobian(true);
+    tInvert.Stop();
+
+    const real_t tIter =
+        tRebuild.GetMilliseconds() + tResidual.GetMilliseconds() +
+        tJacobian.GetMilliseconds() + tInvert.GetMilliseconds();
+
+    DREAM::IO::PrintInfo("Matrix size:                  " LEN_T_PRINTF_FMT, this->matrix_size);
+    DREAM::IO::PrintInfo("Jacobian non-zeros (prealloc): " LEN_T_PRINTF_FMT, nnzEstimate);
+    DREAM::IO::PrintInfo("Jacobian non-zeros (used):     " LEN_T_PRINTF_FMT, this->jacobian->GetNNZ());
+    DREAM::IO::PrintInfo("Jacobian memory:              %s",
+        FVM::MemoryAccounting::FormatBytes(this->jacobian->GetMemoryUsage()).c_str());
+
+    const size_t factorMem = this->inverter->GetMemoryUsage();
+    if (factorMem > 0)
+        DREAM::IO::PrintInfo("Factorization memory:         %s (fill ratio %.1f)",
+            FVM::MemoryAccounting::FormatBytes(factorMem).c_str(),
+            this->inverter->GetFactorizationFill());
+
+    DREAM::IO::PrintInfo();
+    DREAM::IO::PrintInfo("Cost of one Newton iteration: %.3f s", tIter/1000);
+    DREAM::IO::PrintInfo("  Rebuild terms:              %.3f s", tRebuild.GetMilliseconds()/1000);
+    DREAM::IO::PrintInfo("  Evaluate residual:          %.3f s", tResidual.GetMilliseconds()/1000);
+    DREAM::IO::PrintInfo("  Build jacobian:             %.3f s", tJacobian.GetMilliseconds()/1000);
+    DREAM::IO::PrintInfo("  Factorize and solve:        %.3f s", tInvert.GetMilliseconds()/1000);
+
+    DREAM::IO::PrintInfo(
+        "Estimated cost per time step: %.3f s (assuming " LEN_T_PRINTF_FMT " iterations per step)",
+        ITERATIONS_PER_STEP*tIter/1000, ITERATIONS_PER_STEP
+    );
+    if (nSteps > 0)
+        DREAM::IO::PrintInfo(
+            "Estimated total cost:         %.1f s (" LEN_T_PRINTF_FMT " time steps)",
+            nSteps*ITERATIONS_PER_STEP*tIter/1000, nSteps
+        );
+}
+
+/**
+ * Print the number of non-zeros preallocated for each block row of
+ * the jacobian matrix, as estimated by the equation terms, together
+ * with the number of non-zeros actually stored in each block, and the
+ * fill of the most recent factorization of the jacobian. The fill
+ * depends on the ordering used for the factorization, which can be
+ * selected with the PETSc option '-pc_factor_mat_ordering_type'.
+ */
+void SolverNonLinear::PrintJacobianSparsity() {
+    MatInfo info;
+    vector<struct FVM::BlockMatrix::block_sparsity> stats = this->jacobian->GetSparsity();
+    MatGetInfo(this->jacobian->mat(), MAT_LOCAL, &info);
+
+    int maxlen = 8;
+    for (len_t i = 0; i < stats.size(); i++)
+        maxlen = max(static_cast<int>(this->GetNonTrivialName(i).length()), maxlen);
+
+    printf(":: JACOBIAN SPARSITY (time step " LEN_T_PRINTF_FMT ", iteration " LEN_T_PRINTF_FMT ")\n",
+        this->nTimeStep, this->iteration);
+    printf("  %-*s  %10s  %12s  %12s  %7s  %12s\n", maxlen, "Unknown",
+        "rows", "estimated", "used", "used %", "rows exceed.");
+
+    len_t totEstimated = 0, totUsed = 0;
+    for (len_t i = 0; i < stats.size(); i++) {
+        const struct FVM::BlockMatrix::block_sparsity& s = stats[i];
+        printf("  %-*s  %10" LEN_T_PRINTF_FMT_PART "  %12" LEN_T_PRINTF_FMT_PART "  %12" LEN_T_PRINTF_FMT_PART "  %6.1f%%  %12" LEN_T_PRINTF_FMT_PART "\n",
+            maxlen, this->GetNonTrivialName(i).c_str(), s.n, s.nnzEstimated, s.nnzUsed,
+            (s.nnzEstimated > 0 ? 100.0*s.nnzUsed/s.nnzEstimated : 0.0), s.rowsExceeded);
+
+        // Couplings to other unknowns
+        for (len_t j = 0; j < s.nnzBlock.size(); j++) {
+            if (s.nnzBlock[j] == 0) continue;
+            printf("    %-*s  %12" LEN_T_PRINTF_FMT_PART "\n", maxlen+10,
+                ("d/d " + this->GetNonTrivialName(j)).c_str(), s.nnzBlock[j]);
+        }
+
+        totEstimated += s.nnzEstimated;
+        totUsed += s.nnzUsed;
+    }
+
+    printf("  %-*s  %10" LEN_T_PRINTF_FMT_PART "  %12" LEN_T_PRINTF_FMT_PART "  %12" LEN_T_PRINTF_FMT_PART "  %6.1f%%\n",
+        maxlen, "Total", this->matrix_size, totEstimated, totUsed,
+        (totEstimated > 0 ? 100.0*totUsed/totEstimated : 0.0));
+    printf("  Mallocs during assembly:  %.0f\n", info.mallocs);
+
+    if (this->factorizedInverter != nullptr) {
+        const real_t fill = this->factorizedInverter->GetFactorizationFill();
+        if (fill > 0)
+            printf("  Factorization fill ratio: %.2f\n", fill);
+    }
+}
+
 /**
  * Print timing information after the solve.
  */
 void SolverNonLinear::PrintTimings() {
     this->timeKeeper->PrintTimings(true, 0);
     this->Solver::PrintTimings_rebuild();
+
+    if (this->backupInverter != nullptr)
+        DREAM::IO::PrintInfo(
+            "Main inverter failed in " LEN_T_PRINTF_FMT " time steps, and was skipped in "
+            LEN_T_PRINTF_FMT " time steps.", this->nMainInverterFailures, this->nMainInverterSkipped
+        );
 }
 
 /**
@@ -621,6 +1873,10 @@ void SolverNonLinear::SaveDebugInfoAfter(
             VecRestoreArray(this->petsc_dx, &xvec);
         }
 
+        // (the jacobian has been factorized at this point)
+        if (this->printsparsity)
+            this->PrintJacobianSparsity();
+
         // Save full output?
         if (this->savesystem) {
             string outname = "debugout";
@@ -672,10 +1928,61 @@ void SolverNonLinear::SetDebugMode(
 }
 
 
+/**
+ * Select the matrix inverter to start a time step with. Unless the
+ * main inverter has failed recently, the main inverter is used (and
+ * the backup inverter only takes over if the main inverter fails).
+ * After a failure of the main inverter, the backup inverter is used
+ * directly for a number of time steps (see 'UpdateInverterHistory()'),
+ * avoiding the cost of repeatedly letting the main inverter fail and
+ * retrying the step. Both inverters keep their matrix setups (e.g.
+ * symbolic factorizations) while the other one is used.
+ */
+void SolverNonLinear::SelectInverter() {
+    this->mainInverterFailed = false;
+
+    if (this->backupInverter != nullptr && this->backupHold > 0) {
+        this->backupHold--;
+        this->nMainInverterSkipped++;
+        this->inverter = this->backupInverter;
+        this->startedOnMain = false;
+    } else {
+        this->SwitchToMainInverter();
+        this->startedOnMain = true;
+    }
+}
+
+/**
+ * Update the failure history of the main inverter after a
+ * completed time step. If the main inverter failed, the following
+ * time steps start with the backup inverter, for twice as many
+ * steps as after the previous failure (starting from one step, and
+ * up to 'maxBackupHold' steps). If the main inverter succeeded, the
+ * history is cleared.
+ */
+void SolverNonLinear::UpdateInverterHistory() {
+    if (!this->startedOnMain || this->maxBackupHold == 0)
+        return;
+
+    if (this->mainInverterFailed) {
+        this->backupHoldLength = min(
+            (this->backupHoldLength == 0 ? (len_t)1 : 2*this->backupHoldLength),
+            this->maxBackupHold
+        );
+        this->backupHold = this->backupHoldLength;
+    } else
+        this->backupHoldLength = 0;
+}
+
 /**
  * Override switch to backup inverter.
  */
 void SolverNonLinear::SwitchToBackupInverter() {
+    if (this->inverter == this->mainInverter) {
+        this->mainInverterFailed = true;
+        this->nMainInverterFailures++;
+    }
+
     // Switch inverter to use
     this->Solver::SwitchToBackupInverter();
 
@@ -699,6 +2006,9 @@ void SolverNonLinear::WriteDataSFile(SFile *sf, const std::string& name) {
     // Number of iterations per time step
     sf->WriteList(name+"/iterations", this->nIterations.data(), this->nIterations.size());
 
+    // Number of jacobian factorizations per time step
+    sf->WriteList(name+"/factorizations", this->nFactorizations.data(), this->nFactorizations.size());
+
     // Whether or not backup inverter was used for a given time step
     len_t nubi = this->usedBackupInverter.size();
     int32_t *ubi = new int32_t[nubi];
@@ -707,5 +2017,92 @@ void SolverNonLinear::WriteDataSFile(SFile *sf, const std::string& name) {
 
     sf->WriteList(name+"/backupinverter", ubi, nubi);
     delete [] ubi;
+
+    // Conditioning estimates from the equilibration of the jacobian
+    if (this->diag_prec != nullptr && this->diag_prec->IsEquilibrating())
+        this->diag_prec->SaveEquilibrationStatistics(sf, name+"/equilibration");
+
+    if (this->telemetry)
+        this->WriteTelemetry(sf, name+"/telemetry");
+
+    // Whether or not the reduced-order model was used for a given time step
+    if (this->reducedBasis != nullptr) {
+        len_t nurm = this->usedReducedModel.size();
+        int32_t *urm = new int32_t[nurm];
+        for (len_t i = 0; i < nurm; i++)
+            urm[i] = this->usedReducedModel[i] ? 1 : 0;
+
+        sf->WriteList(name+"/reducedmodel", urm, nurm);
+        sf->WriteAttribute_string(name+"/reducedmodel", "desc", "Whether or not the time step was taken with the reduced-order model");
+        delete [] urm;
+    }
+
+    // Number of localized Newton iterations per time step
+    if (this->localized != nullptr) {
+        sf->WriteList(name+"/localizediterations", this->nLocalizedIterations.data(), this->nLocalizedIterations.size());
+        sf->WriteAttribute_string(name+"/localizediterations", "desc", "Number of Newton iterations restricted to the unconverged radii in each time step");
+    }
+
+    // Objective and gradient from the adjoint equations
+    // (solved when the output is first written)
+    if (this->adjoint != nullptr)
+        this->adjoint->WriteDataSFile(sf, name+"/adjoint");
+
+    // Non-zero pattern of the jacobian (for warm-starting other runs)
+    if (this->saveJacobianPattern && this->jacobian != nullptr) {
+        const len_t N = this->jacobian->GetNRows();
+        PetscInt *nnz = new PetscInt[N];
+        this->jacobian->GetNonZeroPattern(nnz);
+
+        int32_t *pattern = new int32_t[N];
+        for (len_t i = 0; i < N; i++)
+            pattern[i] = (int32_t)nnz[i];
+
+        sf->WriteList(name+"/jacobianpattern", pattern, N);
+        sf->WriteAttribute_string(name+"/jacobianpattern", "desc", "Number of non-zero elements in each row of the jacobian matrix");
+
+        delete [] pattern;
+        delete [] nnz;
+    }
+}
+
+/**
+ * Write the recorded convergence telemetry to the given SFile.
+ * Per-iteration quantities are stored as flat lists, with the
+ * index of the time step that each iteration belongs to given in
+ * 'step'. The norms of the solution and Newton step are stored as
+ * (number of iterations)-by-(number of non-trivial unknowns) arrays.
+ *
+ * sf:   SFile object to use for writing.
+ * name: Name of group within file to store data in.
+ */
+void SolverNonLinear::WriteTelemetry(SFile *sf, const std::string& name) {
+    sf->CreateStruct(name);
+
+    const len_t nIter = this->telStep.size();
+    const len_t nNontrivials = this->nontrivial_unknowns.size();
+
+    string names;
+    for (len_t i = 0; i < nNontrivials; i++)
+        names += this->unknowns->GetUnknown(this->nontrivial_unknowns[i])->GetName() + ";";
+    sf->WriteString(name+"/unknowns", names);
+
+    sf->WriteList(name+"/step", this->telStep.data(), nIter);
+    sf->WriteList(name+"/iteration", this->telIteration.data(), nIter);
+    sf->WriteList(name+"/kspiterations", this->telKSP.data(), nIter);
+    sf->WriteList(name+"/damping", this->telDampingFactors.data(), nIter);
+
+    sfilesize_t dims[2] = {nIter, nNontrivials};
+    sf->WriteMultiArray(name+"/residual", this->telResidual.data(), 2, dims);
+    sf->WriteMultiArray(name+"/solution", this->telSolution.data(), 2, dims);
+
+    // Per time step
+    sf->WriteList(name+"/fill", this->telFill.data(), this->telFill.size());
+
+    sf->WriteAttribute_string(name+"/kspiterations", "desc", "Number of linear solver iterations in each Newton iteration");
+    sf->WriteAttribute_string(name+"/damping", "desc", "Damping factor applied to the Newton step");
+    sf->WriteAttribute_string(name+"/residual", "desc", "2-norm of the Newton step for each non-trivial unknown");
+    sf->WriteAttribute_string(name+"/solution", "desc", "2-norm of the solution for each non-trivial unknown");
+    sf->WriteAttribute_string(name+"/fill", "desc", "Fill ratio of the jacobian factorization in each time step (0 if not factorized)");
 }
 
@@ -0,0 +1,513 @@
+/**
+ * Implementation of a solver which splits the equation system into
+ * its kinetic and fluid parts. In every time step, the kinetic
+ * unknowns are first advanced with the fluid unknowns frozen, after
+ * which the fluid unknowns are advanced with the kinetic unknowns
+ * (and thereby all their moments) frozen. Since the kinetic equations
+ * are (nearly) linear in the distribution functions, the kinetic step
+ * usually converges in a single Newton iteration, and the factorized
+ * kinetic jacobian can be reused between time steps (the kinetic
+ * solver is set up with the modified Newton jacobian update).
+ *
+ * Two splitting schemes are available:
+ *
+ *   Lie:     K(dt) F(dt)
+ *   Strang:  K(dt/2) F(dt) K(dt/2)
+ *
+ * where K and F denote the kinetic and fluid updates respectively. The
+ * kinetic half-steps of the Strang scheme are taken with the backward
+ * Euler method.
+ *
+ * Since fast fluid dynamics (e.g. ablation of pellet shards, or
+ * ionization) often limit the time step of the whole system, the fluid
+ * update F(dt) may also be sub-cycled, i.e. divided into several
+ * shorter backward Euler steps taken with the kinetic unknowns frozen.
+ * The kinetic system, which dominates the cost of the simulation, can
+ * then use a much longer time step.
+ *
+ * To detect when the splitting error becomes too large, the residual
+ * of the fully coupled system is evaluated in the split solution and
+ * compared to the residual in the initial guess of the time step. If
+ * the ratio exceeds the given tolerance (or if any of the sub-solves
+ * fails), the split solution is discarded and the time step is instead
+ * taken with the fully coupled non-linear solver. When the fluid update
+ * is sub-cycled, only the residual of the kinetic equations is used.
+ */
+
+#include <algorithm>
+#include <vector>
+#include "DREAM/IO.hpp"
+#include "DREAM/Solver/SolverSplit.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Constructor.
+ *
+ * kineticSolver:   Solver to use for the kinetic subsystem.
+ * fluidSolver:     Solver to use for the fluid subsystem.
+ * coupledSolver:   Solver to use for the fully coupled system.
+ * kineticUnknowns: IDs of the non-trivial unknowns living on
+ *                  kinetic grids.
+ * fluidUnknowns:   IDs of all other non-trivial unknowns.
+ * scheme:          Splitting scheme to use.
+ * tolerance:       Maximum allowed splitting error.
+ * fluidSubsteps:   Number of substeps to divide each fluid
+ *                  step into.
+ */
+SolverSplit::SolverSplit(
+	FVM::UnknownQuantityHandler *unknowns,
+	vector<UnknownQuantityEquation*> *unknown_equations,
+    SolverNonLinear *kineticSolver, SolverNonLinear *fluidSolver,
+    SolverNonLinear *coupledSolver, vector<len_t>& kineticUnknowns,
+    vector<len_t>& fluidUnknowns, enum OptionConstants::solver_splitting scheme,
+    const real_t tolerance, const len_t fluidSubsteps
+) : Solver(unknowns, unknown_equations), kineticSolver(kineticSolver),
+    fluidSolver(fluidSolver), coupledSolver(coupledSolver),
+    kineticUnknowns(kineticUnknowns), fluidUnknowns(fluidUnknowns),
+    scheme(scheme), tolerance(tolerance),
+    fluidSubsteps(fluidSubsteps > 0 ? fluidSubsteps : 1) {
+
+    if (this->kineticUnknowns.empty() || this->fluidUnknowns.empty())
+        throw SolverException(
+            "Operator splitting requires both kinetic and fluid non-trivial unknowns."
+        );
+
+    this->timeKeeper = new FVM::TimeKeeper("Solver splitting");
+    this->timerTot = this->timeKeeper->AddTimer("total", "Total time");
+    this->timerKinetic = this->timeKeeper->AddTimer("kinetic", "Kinetic subsystem");
+    this->timerFluid = this->timeKeeper->AddTimer("fluid", "Fluid subsystem");
+    this->timerError = this->timeKeeper->AddTimer("error", "Splitting error");
+    this->timerCoupled = this->timeKeeper->AddTimer("coupled", "Coupled fallback");
+}
+
+/**
+ * Destructor.
+ */
+SolverSplit::~SolverSplit() {
+    delete this->kineticSolver;
+    delete this->fluidSolver;
+    delete this->coupledSolver;
+
+    if (this->xguess != nullptr) {
+        delete [] this->xguess;
+        delete [] this->xsplit;
+        delete [] this->kineticPrevious;
+        delete [] this->fluidPrevious;
+    }
+
+    delete this->timeKeeper;
+}
+
+/**
+ * Divide the given list of non-trivial unknowns into those which
+ * live on a kinetic (momentum space) grid and the remaining fluid
+ * unknowns.
+ *
+ * u:           List of unknown quantities.
+ * nontrivials: IDs of the non-trivial unknowns.
+ * kinetic:     On return, contains the IDs of the kinetic unknowns.
+ * fluid:       On return, contains the IDs of the fluid unknowns.
+ */
+void SolverSplit::PartitionUnknowns(
+    FVM::UnknownQuantityHandler *u, const vector<len_t>& nontrivials,
+    vector<len_t>& kinetic, vector<len_t>& fluid
+) {
+    kinetic.clear();
+    fluid.clear();
+
+    for (len_t id : nontrivials) {
+        FVM::Grid *g = u->GetUnknown(id)->GetGrid();
+        if (g->GetNCells() > g->GetNr())
+            kinetic.push_back(id);
+        else
+            fluid.push_back(id);
+    }
+}
+
+/**
+ * Initialize the solver.
+ */
+void SolverSplit::initialize_internal(const len_t size, vector<len_t>&) {
+    this->kineticSolver->Initialize(
+        this->unknowns->GetLongVectorSize(this->kineticUnknowns), this->kineticUnknowns
+    );
+    this->fluidSolver->Initialize(
+        this->unknowns->GetLongVectorSize(this->fluidUnknowns), this->fluidUnknowns
+    );
+    this->coupledSolver->Initialize(size, this->nontrivial_unknowns);
+
+    if (this->xguess != nullptr) {
+        delete [] this->xguess;
+        delete [] this->xsplit;
+        delete [] this->kineticPrevious;
+        delete [] this->fluidPrevious;
+    }
+
+    this->xguess = new real_t[size];
+    this->xsplit = new real_t[size];
+    this->kineticPrevious = new real_t[
+        this->unknowns->GetLongVectorSize(this->kineticUnknowns)
+    ];
+    this->fluidPrevious = new real_t[
+        this->unknowns->GetLongVectorSize(this->fluidUnknowns)
+    ];
+}
+
+/**
+ * Set the quantity handlers used by the solvers.
+ */
+void SolverSplit::SetCollisionHandlers(
+    CollisionQuantityHandler *cqh_hottail,
+    CollisionQuantityHandler *cqh_runaway,
+    RunawayFluid *REFluid
+) {
+    this->Solver::SetCollisionHandlers(cqh_hottail, cqh_runaway, REFluid);
+
+    this->kineticSolver->SetCollisionHandlers(cqh_hottail, cqh_runaway, REFluid);
+    this->fluidSolver->SetCollisionHandlers(cqh_hottail, cqh_runaway, REFluid);
+    this->coupledSolver->SetCollisionHandlers(cqh_hottail, cqh_runaway, REFluid);
+}
+void SolverSplit::SetSPIHandler(SPIHandler *SPI) {
+    this->Solver::SetSPIHandler(SPI);
+
+    this->kineticSolver->SetSPIHandler(SPI);
+    this->fluidSolver->SetSPIHandler(SPI);
+    this->coupledSolver->SetSPIHandler(SPI);
+}
+void SolverSplit::SetIonHandler(IonHandler *ih) {
+    this->Solver::SetIonHandler(ih);
+
+    this->kineticSolver->SetIonHandler(ih);
+    this->fluidSolver->SetIonHandler(ih);
+    this->coupledSolver->SetIonHandler(ih);
+}
+
+/**
+ * Set the initial guess for the solution of the next time step.
+ */
+void SolverSplit::SetInitialGuess(const real_t *guess) {
+    this->coupledSolver->SetInitialGuess(guess);
+}
+
+/**
+ * Advance the system to time 't', using a time step 'dt'.
+ *
+ * t:  Time to advance the system to.
+ * dt: Length of time step.
+ */
+void SolverSplit::Solve(const real_t t, const real_t dt) {
+    this->timeKeeper->StartTimer(timerTot);
+    this->lastIterations = 0;
+    this->lastUsedFallback = false;
+
+    // With fluid sub-cycling, the fluid solution does not solve the
+    // coupled system with time step 'dt' (by design), and so the
+    // splitting error is measured in the kinetic equations only
+    SolverNonLinear *errSolver = this->coupledSolver;
+    vector<len_t> *errUnknowns = &this->nontrivial_unknowns;
+    if (this->fluidSubsteps > 1) {
+        errSolver = this->kineticSolver;
+        errUnknowns = &this->kineticUnknowns;
+    }
+
+    // Residual in the initial guess (i.e. the solution
+    // of the previous time step)
+    this->unknowns->GetLongVector(this->nontrivial_unknowns, this->xguess);
+    this->unknowns->GetLongVector(*errUnknowns, this->xsplit);
+
+    this->timeKeeper->StartTimer(timerError);
+    const real_t F0 = errSolver->EvaluateResidualNorm(t, dt, this->xsplit);
+    this->timeKeeper->StopTimer(timerError);
+
+    real_t err = 0;
+    try {
+        if (this->scheme == OptionConstants::SOLVER_SPLITTING_STRANG)
+            this->SolveStrang(t, dt);
+        else
+            this->SolveLie(t, dt);
+
+        this->unknowns->GetLongVector(*errUnknowns, this->xsplit);
+
+        this->timeKeeper->StartTimer(timerError);
+        const real_t F = errSolver->EvaluateResidualNorm(t, dt, this->xsplit);
+        this->timeKeeper->StopTimer(timerError);
+
+        // (if the initial guess already solves the system, any
+        // non-zero residual indicates a splitting error)
+        err = (F0 > 0 ? F/F0 : F);
+        if (err > this->tolerance)
+            this->lastUsedFallback = true;
+    } catch (FVM::FVMException &ex) {
+        if (this->kineticSolver->Verbose())
+            DREAM::IO::PrintError(ex.what());
+
+        err = -1;
+        this->lastUsedFallback = true;
+    }
+
+    if (this->lastUsedFallback) {
+        if (this->coupledSolver->Verbose()) {
+            if (err < 0)
+                DREAM::IO::PrintInfo("Split step failed. Taking step with coupled solver.");
+            else
+                DREAM::IO::PrintInfo(
+                    "Splitting error too large (%e). Taking step with coupled solver.", err
+                );
+        }
+
+        this->timeKeeper->StartTimer(timerCoupled);
+        this->unknowns->Store(this->nontrivial_unknowns, this->xguess);
+        this->coupledSolver->SetInitialGuess(this->xguess);
+        this->coupledSolver->Solve(t, dt);
+        this->lastIterations += this->coupledSolver->GetNumberOfIterations();
+        this->timeKeeper->StopTimer(timerCoupled);
+    }
+
+    this->nIterations.push_back(this->lastIterations);
+    this->usedFallback.push_back(this->lastUsedFallback);
+    this->splittingError.push_back(err);
+
+    this->timeKeeper->StopTimer(timerTot);
+}
+
+/**
+ * Solve one of the subsystems, using the current values of the
+ * unknowns as initial guess.
+ *
+ * s:   Solver to use.
+ * ids: Non-trivial unknowns of the subsystem.
+ * t:   Time to advance the subsystem to.
+ * dt:  Length of time step.
+ */
+void SolverSplit::SolveSubsystem(
+    SolverNonLinear *s, vector<len_t>& ids, const real_t t, const real_t dt
+) {
+    const real_t *guess = this->unknowns->GetLongVector(ids);
+    s->SetInitialGuess(guess);
+    delete [] guess;
+
+    s->Solve(t, dt);
+    this->lastIterations += s->GetNumberOfIterations();
+}
+
+/**
+ * Take a time step using Lie splitting, i.e. first advancing the
+ * kinetic subsystem, followed by the fluid subsystem.
+ */
+void SolverSplit::SolveLie(const real_t t, const real_t dt) {
+    this->timeKeeper->StartTimer(timerKinetic);
+    this->SolveSubsystem(this->kineticSolver, this->kineticUnknowns, t, dt);
+    this->timeKeeper->StopTimer(timerKinetic);
+
+    this->SolveFluid(t, dt);
+}
+
+/**
+ * Take a time step using Strang splitting, i.e. advancing the kinetic
+ * subsystem half a time step, followed by a full step of the fluid
+ * subsystem and a final half-step of the kinetic subsystem.
+ */
+void SolverSplit::SolveStrang(const real_t t, const real_t dt) {
+    const real_t t0 = t - dt;
+
+    try {
+        this->timeKeeper->StartTimer(timerKinetic);
+        this->unknowns->PrepareTimeDerivative(dt/2, 1);
+        this->SolveSubsystem(this->kineticSolver, this->kineticUnknowns, t0+dt/2, dt/2);
+        this->timeKeeper->StopTimer(timerKinetic);
+
+        this->SolveFluid(t, dt);
+
+        // The second kinetic half-step starts from the midpoint
+        this->timeKeeper->StartTimer(timerKinetic);
+        this->AdvancePrevious(this->kineticUnknowns, this->kineticPrevious, this->kineticPreviousReplaced);
+        this->unknowns->PrepareTimeDerivative(dt/2, 1);
+        this->SolveSubsystem(this->kineticSolver, this->kineticUnknowns, t, dt/2);
+        this->timeKeeper->StopTimer(timerKinetic);
+    } catch (FVM::FVMException&) {
+        this->RestorePrevious(this->kineticUnknowns, this->kineticPrevious, this->kineticPreviousReplaced);
+        this->unknowns->PrepareTimeDerivative(dt);
+        throw;
+    }
+
+    this->RestorePrevious(this->kineticUnknowns, this->kineticPrevious, this->kineticPreviousReplaced);
+    this->unknowns->PrepareTimeDerivative(dt);
+}
+
+/**
+ * Advance the fluid subsystem to time 't', from time 't-dt'. If
+ * sub-cycling is enabled, the step is divided into 'fluidSubsteps'
+ * equally long substeps (taken with the backward Euler method), with
+ * the kinetic unknowns (and thereby their moments and the kinetic
+ * source terms of the fluid equations) frozen.
+ */
+void SolverSplit::SolveFluid(const real_t t, const real_t dt) {
+    this->timeKeeper->StartTimer(timerFluid);
+
+    if (this->fluidSubsteps <= 1) {
+        this->unknowns->PrepareTimeDerivative(dt);
+        this->SolveSubsystem(this->fluidSolver, this->fluidUnknowns, t, dt);
+        this->timeKeeper->StopTimer(timerFluid);
+        return;
+    }
+
+    const real_t t0 = t - dt;
+    const real_t h = dt / this->fluidSubsteps;
+    try {
+        this->unknowns->PrepareTimeDerivative(h, 1);
+        for (len_t k = 0; k < this->fluidSubsteps; k++) {
+            // Each substep starts from the end of the previous one
+            if (k > 0)
+                this->AdvancePrevious(this->fluidUnknowns, this->fluidPrevious, this->fluidPreviousReplaced);
+
+            const real_t tk = (k+1 == this->fluidSubsteps ? t : t0 + (k+1)*h);
+            this->SolveSubsystem(this->fluidSolver, this->fluidUnknowns, tk, h);
+        }
+    } catch (FVM::FVMException&) {
+        this->RestorePrevious(this->fluidUnknowns, this->fluidPrevious, this->fluidPreviousReplaced);
+        this->unknowns->PrepareTimeDerivative(dt);
+        this->timeKeeper->StopTimer(timerFluid);
+        throw;
+    }
+
+    this->RestorePrevious(this->fluidUnknowns, this->fluidPrevious, this->fluidPreviousReplaced);
+    this->unknowns->PrepareTimeDerivative(dt);
+    this->timeKeeper->StopTimer(timerFluid);
+}
+
+/**
+ * Replace the previous values of the given unknowns with their
+ * current values. The first time the previous values are replaced,
+ * a copy of them is kept in 'backup' so that they can be restored
+ * with 'RestorePrevious()'.
+ *
+ * ids:      Unknowns to replace the previous values of.
+ * backup:   Buffer to store the original previous values in.
+ * replaced: Flag indicating whether the original previous values
+ *           have already been stored in 'backup'.
+ */
+void SolverSplit::AdvancePrevious(
+    const vector<len_t>& ids, real_t *backup, bool& replaced
+) {
+    len_t offset = 0;
+    for (len_t id : ids) {
+        FVM::UnknownQuantity *uqn = this->unknowns->GetUnknown(id);
+        const len_t N = uqn->NumberOfElements();
+        const real_t *x = uqn->GetData();
+        real_t *prev = uqn->GetDataPrevious();
+
+        for (len_t i = 0; i < N; i++) {
+            if (!replaced)
+                backup[offset+i] = prev[i];
+            prev[i] = x[i];
+        }
+
+        offset += N;
+    }
+
+    replaced = true;
+}
+
+/**
+ * Restore the previous values of the given unknowns, if they
+ * have been replaced by 'AdvancePrevious()'.
+ *
+ * ids:      Unknowns to restore the previous values of.
+ * backup:   Buffer containing the original previous values.
+ * replaced: Flag indicating whether the previous values have
+ *           been replaced.
+ */
+void SolverSplit::RestorePrevious(
+    const vector<len_t>& ids, const real_t *backup, bool& replaced
+) {
+    if (!replaced)
+        return;
+
+    len_t offset = 0;
+    for (len_t id : ids) {
+        FVM::UnknownQuantity *uqn = this->unknowns->GetUnknown(id);
+        const len_t N = uqn->NumberOfElements();
+        real_t *prev = uqn->GetDataPrevious();
+
+        for (len_t i = 0; i < N; i++)
+            prev[i] = backup[offset+i];
+
+        offset += N;
+    }
+
+    replaced = false;
+}
+
+/**
+ * Print timing information for the solver.
+ */
+void SolverSplit::PrintTimings() {
+    this->timeKeeper->PrintTimings(true, 0);
+
+    printf("[Kinetic subsystem]\n");
+    this->kineticSolver->PrintTimings();
+    printf("[Fluid subsystem]\n");
+    this->fluidSolver->PrintTimings();
+    printf("[Coupled fallback]\n");
+    this->coupledSolver->PrintTimings();
+}
+
+/**
+ * Save timing information for the solver to the given SFile object.
+ *
+ * sf:   SFile object to save timing information to.
+ * path: Path in SFile object to save timing information to.
+ */
+void SolverSplit::SaveTimings(SFile *sf, const string& path) {
+    this->timeKeeper->SaveTimings(sf, path);
+
+    sf->CreateStruct(path+"/kinetic");
+    this->kineticSolver->SaveTimings(sf, path+"/kinetic");
+    sf->CreateStruct(path+"/fluid");
+    this->fluidSolver->SaveTimings(sf, path+"/fluid");
+    sf->CreateStruct(path+"/coupled");
+    this->coupledSolver->SaveTimings(sf, path+"/coupled");
+}
+
+/**
+ * Write solver statistics to the given SFile object. The statistics
+ * are stored in the same format as for the non-linear solver (with
+ * the iterations of all sub-solves of a time step summed), together
+ * with information about the splitting.
+ *
+ * sf:   SFile object to write data to.
+ * name: Name of group in SFile object to write data to.
+ */
+void SolverSplit::WriteDataSFile(SFile *sf, const string& name) {
+    sf->CreateStruct(name);
+
+    int32_t type = (int32_t)OptionConstants::SOLVER_TYPE_NONLINEAR;
+    sf->WriteList(name+"/type", &type, 1);
+
+    // Number of iterations per time step
+    sf->WriteList(name+"/iterations", this->nIterations.data(), this->nIterations.size());
+
+    // Whether or not the coupled solver was used for a given time step
+    len_t nstep = this->usedFallback.size();
+    int32_t *fb = new int32_t[nstep];
+    for (len_t i = 0; i < nstep; i++)
+        fb[i] = this->usedFallback[i] ? 1 : 0;
+
+    sf->WriteList(name+"/backupinverter", fb, nstep);
+
+    sf->CreateStruct(name+"/splitting");
+    int32_t sch = (int32_t)this->scheme;
+    sf->WriteList(name+"/splitting/scheme", &sch, 1);
+    sf->WriteList(name+"/splitting/fallback", fb, nstep);
+    sf->WriteList(name+"/splitting/error", this->splittingError.data(), this->splittingError.size());
+    sf->WriteAttribute_string(name+"/splitting/error", "desc", "Ratio of coupled residual in split solution to residual in initial guess (-1 if a sub-solve failed)");
+    delete [] fb;
+
+    this->kineticSolver->WriteDataSFile(sf, name+"/splitting/kinetic");
+    this->fluidSolver->WriteDataSFile(sf, name+"/splitting/fluid");
+    this->coupledSolver->WriteDataSFile(sf, name+"/splitting/coupled");
+}
@@ -0,0 +1,160 @@
+/**
+ * Warm start of a simulation from the output of a neighbouring
+ * (reference) run, e.g. a neighbouring point in a parameter scan.
+ * The solution history of the reference run is used as the initial
+ * guess of the non-linear solver in every time step, and the non-zero
+ * pattern of the reference jacobian (if saved) is used to preallocate
+ * the jacobian matrix of the new run.
+ *
+ * The reference run must have been performed on the same grids as the
+ * new run. Unknowns for which the size of the reference data does not
+ * match are initialized from the previous time step as usual.
+ */
+
+#include <algorithm>
+#include <softlib/SFile.h>
+#include "DREAM/IO.hpp"
+#include "DREAM/Solver/WarmStart.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Constructor.
+ *
+ * filename:    Name of DREAM output file to load reference run from.
+ * u:           List of unknown quantities.
+ * nontrivials: List of non-trivial unknowns solved for by the solver.
+ */
+WarmStart::WarmStart(
+    const string& filename, FVM::UnknownQuantityHandler *u,
+    const vector<len_t>& nontrivials
+) : unknowns(u), nontrivials(nontrivials) {
+    SFile *sf = SFile::Create(filename, SFILE_MODE_READ);
+
+    sfilesize_t nt;
+    real_t *t = sf->GetList("grid/t", &nt);
+    if (t == nullptr || nt == 0)
+        throw WarmStartException(
+            "No time grid found in reference output '%s'.", filename.c_str()
+        );
+
+    this->times.assign(t, t+nt);
+    delete [] t;
+
+    for (len_t id : this->nontrivials) {
+        FVM::UnknownQuantity *uqn = this->unknowns->GetUnknown(id);
+        const string name = "eqsys/" + uqn->GetName();
+
+        real_t *d = nullptr;
+        if (sf->HasVariable(name)) {
+            sfilesize_t dims[4], ndims;
+            d = sf->GetMultiArray_linear(name, 4, ndims, dims);
+
+            sfilesize_t N = 1;
+            for (sfilesize_t i = 1; i < ndims; i++)
+                N *= dims[i];
+
+            if (dims[0] != nt || N != uqn->NumberOfElements()) {
+                DREAM::IO::PrintWarning(
+                    "Warm start: size of '%s' in '%s' does not match the "
+                    "simulation. The quantity will not be warm-started.",
+                    uqn->GetName().c_str(), filename.c_str()
+                );
+
+                delete [] d;
+                d = nullptr;
+            }
+        }
+
+        this->data.push_back(d);
+    }
+
+    if (sf->HasVariable("solver/jacobianpattern")) {
+        sfilesize_t n;
+        int64_t *p = sf->GetIntList("solver/jacobianpattern", &n);
+
+        this->jacobianPatternSize = n;
+        this->jacobianPattern = new PetscInt[n];
+        for (sfilesize_t i = 0; i < n; i++)
+            this->jacobianPattern[i] = (PetscInt)p[i];
+
+        delete [] p;
+    }
+
+    sf->Close();
+    delete sf;
+}
+
+/**
+ * Destructor.
+ */
+WarmStart::~WarmStart() {
+    for (real_t *d : this->data)
+        delete [] d;
+
+    delete [] this->jacobianPattern;
+}
+
+/**
+ * Evaluate the reference solution at the given time (by linear
+ * interpolation between the saved time steps of the reference run).
+ * Unknowns which are not available in the reference run are left
+ * unchanged in 'x'.
+ *
+ * t: Time at which to evaluate the reference solution.
+ * x: On input, the default initial guess for the non-linear solver
+ *    (in the ordering of the non-trivial unknowns). On return,
+ *    contains the warm-started initial guess.
+ *
+ * RETURNS false if 't' lies outside the time interval of the
+ * reference run (in which case 'x' is not modified).
+ */
+bool WarmStart::GetGuess(const real_t t, real_t *x) {
+    const len_t nt = this->times.size();
+    if (t < this->times.front() || t > this->times.back())
+        return false;
+
+    // Locate the interval [times[i], times[i+1]] containing 't'
+    len_t i = upper_bound(this->times.begin(), this->times.end(), t) - this->times.begin();
+    i = (i == 0 ? 0 : i-1);
+    if (i >= nt-1)
+        i = (nt > 1 ? nt-2 : 0);
+
+    real_t w = 0;
+    if (nt > 1 && this->times[i+1] > this->times[i])
+        w = (t - this->times[i]) / (this->times[i+1] - this->times[i]);
+
+    len_t offset = 0;
+    for (len_t k = 0; k < this->nontrivials.size(); k++) {
+        const len_t N = this->unknowns->GetUnknown(this->nontrivials[k])->NumberOfElements();
+        const real_t *d = this->data[k];
+
+        if (d != nullptr) {
+            const real_t *d0 = d + i*N;
+            const real_t *d1 = (nt > 1 ? d0 + N : d0);
+            for (len_t j = 0; j < N; j++)
+                x[offset+j] = (1-w)*d0[j] + w*d1[j];
+        }
+
+        offset += N;
+    }
+
+    return true;
+}
+
+/**
+ * Returns the non-zero pattern of the jacobian of the reference run,
+ * or 'nullptr' if it is not available or was obtained for a jacobian
+ * of different size.
+ *
+ * n: Number of rows of the jacobian to preallocate.
+ */
+const PetscInt *WarmStart::GetJacobianPattern(const len_t n) const {
+    if (this->jacobianPattern == nullptr || this->jacobianPatternSize != n)
+        return nullptr;
+    else
+        return this->jacobianPattern;
+}
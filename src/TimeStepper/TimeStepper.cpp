@@ -1,4 +1,5 @@
 
+#include <algorithm>
 #include <string>
 #include "DREAM/IO.hpp"
 #include "DREAM/TimeStepper/TimeStepper.hpp"
@@ -46,3 +47,96 @@ void TimeStepper::HandleException(FVM::FVMException &ex) {
     throw ex;
 }
 
+
+/**
+ * Save the state of this time stepper to the given checkpoint.
+ * Time steppers which can be resumed from a checkpoint must
+ * override this method and 'LoadCheckpoint()'.
+ */
+void TimeStepper::SaveCheckpoint(Checkpoint&) const {
+    throw TimeStepperException("The selected time stepper does not support checkpoints.");
+}
+
+/**
+ * Restore the state of this time stepper from the given checkpoint.
+ */
+void TimeStepper::LoadCheckpoint(const Checkpoint&) {
+    throw TimeStepperException("The selected time stepper does not support checkpoints.");
+}
+
+/**
+ * Set the times which time steps should land exactly on (e.g. the
+ * times at which prescribed data changes abruptly). Steps which
+ * would otherwise straddle one of these times are truncated to end
+ * on it (see 'LimitStepToEvents()'). Times outside of the simulation
+ * interval are ignored.
+ *
+ * times: List of event times (in any order).
+ */
+void TimeStepper::SetEventTimes(const std::vector<real_t>& times) {
+    const real_t tMax = this->GetMaxTime();
+
+    this->eventTimes.clear();
+    for (real_t t : times)
+        if (t > 0 && t < tMax)
+            this->eventTimes.push_back(t);
+
+    std::sort(this->eventTimes.begin(), this->eventTimes.end());
+    this->eventTimes.erase(
+        std::unique(this->eventTimes.begin(), this->eventTimes.end()),
+        this->eventTimes.end()
+    );
+}
+
+/**
+ * Limit the time step taken from the given time, so that the
+ * step does not straddle any event time. Events which the step
+ * ends sufficiently close to (relative to the step length) are
+ * considered to be landed on.
+ *
+ * t:  Time at which the step starts.
+ * dt: Proposed time step.
+ *
+ * RETURNS the (possibly shortened) time step.
+ */
+real_t TimeStepper::LimitStepToEvents(const real_t t, const real_t dt) const {
+    const real_t EVENT_TOLERANCE = 1e-10;
+    const real_t tol = EVENT_TOLERANCE * dt;
+
+    auto it = std::upper_bound(this->eventTimes.begin(), this->eventTimes.end(), t+tol);
+    if (it != this->eventTimes.end() && *it < t+dt-tol)
+        return (*it - t);
+    else
+        return dt;
+}
+
+/**
+ * Record the number of rejected attempts made before the
+ * time step which was just accepted.
+ */
+void TimeStepper::RecordAcceptedStep() {
+    this->nRejected.push_back(this->nRejectedStep);
+    this->nExceptions.push_back(this->nExceptionsStep);
+
+    this->nRejectedStep = 0;
+    this->nExceptionsStep = 0;
+}
+
+/**
+ * Write the number of rejected attempts per accepted time
+ * step to the given SFile (if any were recorded).
+ *
+ * sf:   SFile object to use for writing.
+ * name: Name of group within file to store data in.
+ */
+void TimeStepper::WriteTelemetry(SFile *sf, const std::string& name) {
+    if (this->nRejected.empty())
+        return;
+
+    sf->CreateStruct(name);
+    sf->WriteList(name+"/rejected", this->nRejected.data(), this->nRejected.size());
+    sf->WriteList(name+"/exceptions", this->nExceptions.data(), this->nExceptions.size());
+
+    sf->WriteAttribute_string(name+"/rejected", "desc", "Number of attempts rejected due to a too large error before each accepted time step");
+    sf->WriteAttribute_string(name+"/exceptions", "desc", "Number of attempts in which the solver failed before each accepted time step");
+}
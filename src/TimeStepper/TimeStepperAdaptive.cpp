@@ -28,7 +28,8 @@
  * |___________________________________________________________________________________________|
  */
 
-#include <iostream>
+#include <cstdio>
+#include <string>
 #include <vector>
 #include "DREAM/IO.hpp"
 #include "DREAM/TimeStepper/TimeStepperAdaptive.hpp"
@@ -119,6 +120,7 @@ TimeStepperAdaptive::ts_stage TimeStepperAdaptive::AdvanceStage() {
             } else {
                 // Keep taking normal steps
                 this->stepsSinceCheck++;
+                this->dt = this->LimitStepToEvents(this->currentTime, this->dt);
                 this->currentTime += this->dt;
             }
             break;
@@ -160,6 +162,10 @@ TimeStepperAdaptive::ts_stage TimeStepperAdaptive::AdvanceStage() {
             throw TimeStepperException("Unrecognized stage: %d.");
     }
 
+    // Don't let the new step straddle any events
+    if (stg == STAGE_FIRST_HALF)
+        this->dt = this->LimitStepToEvents(this->initTime, this->dt);
+
     if (this->verbose)
         DREAM::IO::PrintInfo(
             "[TimeStepper] Advancing from stage %s -> %s",
@@ -254,6 +260,7 @@ void TimeStepperAdaptive::HandleException(FVM::FVMException &ex) {
 
     // Count the exception
     this->stepsWithException++;
+    this->nExceptionsStep++;
 
     // Determine how many steps to roll back...
     switch (this->currentStage) {
@@ -355,27 +362,26 @@ void TimeStepperAdaptive::PrintProgress() {
     const len_t EDGE_LENGTH = 1;
     const len_t PROG_LENGTH = PROGRESSBAR_LENGTH-2*EDGE_LENGTH - PERC_FMT_LENGTH - 1;
 
-    cout << "\r[";
+    string s = "\r[";
     real_t perc     = (CurrentTime() + this->oldDt)/this->tMax;
     len_t threshold = static_cast<len_t>(perc * PROG_LENGTH);
     
     for (len_t i = 0; i < PROG_LENGTH; i++) {
         if (i < threshold)
-            cout << '#';
+            s += '#';
         else
-            cout << '-';
+            s += '-';
     }
 
-    cout << "] ";
-    printf(
-        "%*.*f%% (step " LEN_T_PRINTF_FMT ", dt = %.5e)",
+    char buf[128];
+    snprintf(
+        buf, sizeof(buf), "] %*.*f%% (step " LEN_T_PRINTF_FMT ", dt = %.5e)",
         int(4+PERC_FMT_PREC), int(PERC_FMT_PREC),
         perc*100.0, this->currentStep, this->dt
     );
+    s += buf;
 
-    // Ensure that output is written right away (otherwise it may
-    // not be written until the end-of-line character is written)
-    cout << flush;
+    DREAM::IO::PrintProgress(s);
 }
 
 /**
@@ -390,10 +396,15 @@ void TimeStepperAdaptive::ValidateStep() {
     if (this->currentStage == STAGE_FULL) {
         if (UpdateStep())
             this->stepSucceeded = true;
-        else
+        else {
             this->stepSucceeded = false;
+            this->nRejectedStep++;
+        }
     } else
         this->stepSucceeded = (this->currentStage == STAGE_NORMAL);
+
+    if (this->stepSucceeded)
+        this->RecordAcceptedStep();
 }
 
 /**
@@ -442,17 +453,14 @@ bool TimeStepperAdaptive::UpdateStep() {
     CopySolution(&this->sol_full);
 
     bool converged = this->convChecker->IsConverged(this->sol_full, this->sol_full, this->sol_half);
-    const real_t *err = this->convChecker->GetErrorNorms();
+    const real_t *err = this->convChecker->GetErrorRatios();
 
-    // Calculate maximum error
+    // Calculate maximum error (relative to the tolerance)
     real_t maxErr = 0;
     len_t maxErri = 0;
     for (len_t i = 0; i < this->nontrivials.size(); i++) {
-        const real_t scale = this->convChecker->GetErrorScale(this->nontrivials[i]);
-
-        // scale = 0 indicates that |x| = 0, which could be ok
-        if (scale != 0 && maxErr < err[i]/scale) {
-            maxErr = err[i]/scale;
+        if (maxErr < err[i]) {
+            maxErr = err[i];
             maxErri = i;
         }
     }
@@ -498,3 +506,37 @@ bool TimeStepperAdaptive::UpdateStep() {
     return converged;
 }
 
+
+/**
+ * Save the state of this time stepper to the given checkpoint. The
+ * intermediate solutions used for estimating the error are not
+ * needed, since checkpoints are only written after saved steps
+ * (i.e. after a normal or full step has been accepted).
+ */
+void TimeStepperAdaptive::SaveCheckpoint(Checkpoint &cp) const {
+    cp.Put("timestepper/currentTime", this->currentTime);
+    cp.Put("timestepper/initTime", this->initTime);
+    cp.Put("timestepper/dt", this->dt);
+    cp.Put("timestepper/oldDt", this->oldDt);
+    cp.Put("timestepper/currentStep", (real_t)this->currentStep);
+    cp.Put("timestepper/currentStage", (real_t)this->currentStage);
+    cp.Put("timestepper/stepsSinceCheck", (real_t)this->stepsSinceCheck);
+    cp.Put("timestepper/stepSucceeded", this->stepSucceeded ? 1.0 : 0.0);
+    cp.Put("timestepper/oldMaxErr", this->oldMaxErr);
+}
+
+/**
+ * Restore the state of this time stepper from the given checkpoint.
+ */
+void TimeStepperAdaptive::LoadCheckpoint(const Checkpoint &cp) {
+    this->currentTime = cp.GetScalar("timestepper/currentTime");
+    this->initTime = cp.GetScalar("timestepper/initTime");
+    this->dt = cp.GetScalar("timestepper/dt");
+    this->oldDt = cp.GetScalar("timestepper/oldDt");
+    this->currentStep = (len_t)cp.GetScalar("timestepper/currentStep");
+    this->currentStage = (ts_stage)cp.GetScalar("timestepper/currentStage");
+    this->stepsSinceCheck = (len_t)cp.GetScalar("timestepper/stepsSinceCheck");
+    this->stepSucceeded = (cp.GetScalar("timestepper/stepSucceeded") != 0);
+    this->oldMaxErr = cp.GetScalar("timestepper/oldMaxErr");
+    this->stepsWithException = 0;
+}
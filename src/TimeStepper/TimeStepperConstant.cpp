@@ -2,6 +2,7 @@
  * Implementation of the constant time stepper module.
  */
 
+#include <string>
 #include "DREAM/IO.hpp"
 #include "DREAM/TimeStepper/TimeStepperConstant.hpp"
 
@@ -36,7 +37,20 @@ real_t TimeStepperConstant::CurrentTime() const {
     if (this->tIndex == 0)
         return this->t0;
     else
-        return (this->t0 + (this->tIndex-1)*this->dt);
+        return TimeAt(this->tIndex-1);
+}
+
+/**
+ * Returns the time at the end of the given time step
+ * (with step 0 corresponding to the initial time).
+ */
+real_t TimeStepperConstant::TimeAt(const len_t i) const {
+    if (i == 0)
+        return this->t0;
+    else if (this->times.empty())
+        return (this->t0 + i*this->dt);
+    else
+        return this->times[i-1];
 }
 
 /**
@@ -87,19 +101,81 @@ real_t TimeStepperConstant::NextTime() {
         this->nextSaveStep_l = round(this->nextSaveStep);
     }
 
-    return (this->t0 + this->tIndex*this->dt);
+    return TimeAt(this->tIndex);
 }
 
 /**
  * Print current progress to stdout.
  */
 void TimeStepperConstant::PrintProgress() {
+    std::string s;
     if (IsSaveStep())
-        std::cout << "\x1B[1;32m" << this->tIndex << "\x1B[0m... ";
+        s = "\x1B[1;32m" + std::to_string(this->tIndex) + "\x1B[0m... ";
     else
-        std::cout << this->tIndex << "... ";
+        s = std::to_string(this->tIndex) + "... ";
+
+    if (this->tIndex % 10 == 0) s += '\n';
+
+    DREAM::IO::PrintProgress(s);
+}
+
+/**
+ * Set the times which time steps should land exactly on. Since the
+ * constant time stepper never shortens its steps, the event times
+ * are instead inserted as additional steps between the uniformly
+ * spaced ones (which are left unchanged). Events lying very close
+ * to one of the uniformly spaced steps are ignored.
+ *
+ * times: List of event times.
+ */
+void TimeStepperConstant::SetEventTimes(const std::vector<real_t>& times) {
+    this->TimeStepper::SetEventTimes(times);
+    this->times.clear();
+
+    if (this->eventTimes.empty())
+        return;
+
+    const real_t tol = 1e-6 * this->dt;
+    auto ev = this->eventTimes.begin();
+    for (len_t i = 1; i <= this->Nt; i++) {
+        const real_t t = this->t0 + i*this->dt;
+        for (; ev != this->eventTimes.end() && *ev < t+tol; ev++)
+            if (*ev < t-tol && (this->times.empty() ? *ev > this->t0+tol : *ev > this->times.back()+tol))
+                this->times.push_back(*ev);
+
+        this->times.push_back(t);
+    }
+
+    this->Nt = this->times.size();
+    InitSaveSteps();
+}
 
-    if (this->tIndex % 10 == 0) std::cout << std::endl;
+/**
+ * Restart this time stepper on the time window [tStart, tEnd],
+ * which is divided into 'nt' uniformly spaced steps. This is used
+ * by the parareal method, which repeatedly advances the solution
+ * across the same window with different time steps. Any event
+ * times are discarded.
+ *
+ * tStart:     Time at which the window begins.
+ * tEnd:       Time at which the window ends.
+ * nt:         Number of time steps to take across the window.
+ * nSaveSteps: Number of time steps to save to output (0 = all).
+ */
+void TimeStepperConstant::SetWindow(
+    const real_t tStart, const real_t tEnd, const len_t nt,
+    const len_t nSaveSteps
+) {
+    this->tIndex = 0;
+    this->t0 = tStart;
+    this->Nt = nt;
+    this->dt = (tEnd-tStart) / nt;
+    this->times.clear();
+
+    this->nSaveSteps = nSaveSteps;
+    this->nextSaveStep = 0;
+    this->nextSaveStep_l = 0;
+    InitSaveSteps();
 }
 
 /**
@@ -108,3 +184,23 @@ void TimeStepperConstant::PrintProgress() {
  */
 void TimeStepperConstant::ValidateStep() {
 }
+
+/**
+ * Save the state of this time stepper to the given checkpoint.
+ */
+void TimeStepperConstant::SaveCheckpoint(Checkpoint &cp) const {
+    cp.Put("timestepper/tIndex", (real_t)this->tIndex);
+    cp.Put("timestepper/t0", this->t0);
+    cp.Put("timestepper/nextSaveStep", this->nextSaveStep);
+    cp.Put("timestepper/nextSaveStep_l", (real_t)this->nextSaveStep_l);
+}
+
+/**
+ * Restore the state of this time stepper from the given checkpoint.
+ */
+void TimeStepperConstant::LoadCheckpoint(const Checkpoint &cp) {
+    this->tIndex = (len_t)cp.GetScalar("timestepper/tIndex");
+    this->t0 = cp.GetScalar("timestepper/t0");
+    this->nextSaveStep = cp.GetScalar("timestepper/nextSaveStep");
+    this->nextSaveStep_l = (len_t)cp.GetScalar("timestepper/nextSaveStep_l");
+}
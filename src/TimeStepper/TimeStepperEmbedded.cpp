@@ -0,0 +1,412 @@
+/**
+ * Implementation of an adaptive time stepper for DREAM which estimates the
+ * truncation error from the solution of a single time step.
+ *
+ * Each step is taken with the backward Euler method (which is the method
+ * built into all equation terms in DREAM) and the result is compared with
+ * the second-order explicit prediction obtained by extrapolating linearly
+ * from the two most recently accepted solutions,
+ *
+ *   x_P = x_n + (dt/dt_old) * (x_n - x_{n-1}).
+ *
+ * Since the local truncation error of the backward Euler step is
+ * -dt^2 x''/2, while the error of the predictor is dt*(dt+dt_old) x''/2,
+ * the local truncation error of the backward Euler solution x_{n+1} can be
+ * estimated as
+ *
+ *   e = dt/(dt+dt_old) * (x_{n+1} - x_P)
+ *
+ * (Milne's device). Contrary to 'TimeStepperAdaptive', which estimates the
+ * error by step doubling, only one non-linear solve is therefore needed in
+ * each step. If the error is too large, the solution is rolled back and the
+ * step is retaken with a shorter time step.
+ *
+ * Since there is no history available for the very first step, the first
+ * step is always accepted and should therefore be chosen to be reasonably
+ * short.
+ */
+
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "DREAM/IO.hpp"
+#include "DREAM/TimeStepper/TimeStepperEmbedded.hpp"
+
+
+using namespace DREAM;
+using namespace std;
+
+
+/**
+ * Constructor.
+ *
+ * tMax:        Final simulation time.
+ * dt0:         Initial time step.
+ * dtMax:       Maximum allowed time step (0 = no limit).
+ * uqh:         UnknownQuantityHandler of solver.
+ * nontrivials: List of non-trivial unknowns.
+ * cc:          Object to use for checking time stepper convergence.
+ * verbose:     If true, generates excessive output.
+ */
+TimeStepperEmbedded::TimeStepperEmbedded(
+    const real_t tMax, const real_t dt0, const real_t dtMax,
+    FVM::UnknownQuantityHandler *uqh, vector<len_t>& nontrivials,
+    ConvergenceChecker *cc, bool verbose
+) : TimeStepper(uqh), tMax(tMax), dt(dt0), dtMax(dtMax),
+  nontrivials(nontrivials), verbose(verbose) {
+
+    if (cc == nullptr) {
+        const real_t RELTOL = 1e-6;
+        this->convChecker = new ConvergenceChecker(uqh, nontrivials, RELTOL);
+    } else
+        this->convChecker = cc;
+
+    if (this->dtMax > 0 && this->dt > this->dtMax)
+        this->dt = this->dtMax;
+    if (this->dt > this->tMax)
+        this->dt = this->tMax;
+
+    if (verbose)
+        DREAM::IO::PrintInfo(
+            "[TimeStepper] initial dt = %.6e", this->dt
+        );
+}
+
+/**
+ * Destructor.
+ */
+TimeStepperEmbedded::~TimeStepperEmbedded() {
+    DeallocateSolutions();
+
+    delete this->convChecker;
+}
+
+/**
+ * Allocate memory for storing solution vectors.
+ *
+ * size: Number of elements in each solution vector.
+ */
+void TimeStepperEmbedded::AllocateSolutions(const len_t size) {
+    DeallocateSolutions();
+
+    this->sol_size = size;
+    this->sol_prev = new real_t[size];
+    this->sol_curr = new real_t[size];
+    this->sol_new  = new real_t[size];
+    this->sol_err  = new real_t[size];
+}
+
+/**
+ * Copy the current solution to the given vector.
+ */
+void TimeStepperEmbedded::CopySolution(real_t *sol) {
+    this->unknowns->GetLongVector(this->nontrivials, sol);
+}
+
+/**
+ * Deallocate memory for the solution vectors.
+ */
+void TimeStepperEmbedded::DeallocateSolutions() {
+    if (this->sol_prev != nullptr)
+        delete [] this->sol_prev;
+    if (this->sol_curr != nullptr)
+        delete [] this->sol_curr;
+    if (this->sol_new != nullptr)
+        delete [] this->sol_new;
+    if (this->sol_err != nullptr)
+        delete [] this->sol_err;
+
+    this->sol_prev = this->sol_curr = this->sol_new = this->sol_err = nullptr;
+}
+
+/**
+ * Returns the current time.
+ */
+real_t TimeStepperEmbedded::CurrentTime() const {
+    return this->currentTime;
+}
+
+/**
+ * This method is called when an exception was thrown while
+ * the next time step was being taken.
+ *
+ * We rollback to the initial state (unless the exception has
+ * been caught too many times) and try again with a shorter
+ * time step.
+ *
+ * ex: The exception that was caught.
+ */
+void TimeStepperEmbedded::HandleException(FVM::FVMException &ex) {
+    // Maximum number of exceptions thrown?
+    if (this->stepsWithException >= MAX_STEPS_WITH_EXCEPTION) {
+        DREAM::IO::PrintError("TimeStepper: Caught exception for the last time. Rethrowing...");
+        throw ex;
+    }
+
+    this->stepsWithException++;
+    this->nExceptionsStep++;
+
+    // The step was never saved, so we only need to
+    // roll back the copy of the initial state
+    RestoreInitialSolution(1);
+    this->restoreSolution = false;
+    this->stepSucceeded = false;
+
+    this->dt *= STEP_REDUCTION_AT_EXCEPTION;
+
+    if (this->verbose)
+        DREAM::IO::PrintInfo("Caught exception. Reducing time step to %e", this->dt);
+}
+
+/**
+ * Returns 'true' if the simulation has reached the final
+ * time. Returns 'false' otherwise.
+ */
+bool TimeStepperEmbedded::IsFinished() {
+    return (this->stepSucceeded && this->currentTime >= this->tMax);
+}
+
+/**
+ * Returns 'true' if the result of the current time step
+ * should be saved to the output.
+ */
+bool TimeStepperEmbedded::IsSaveStep() {
+    return this->stepSucceeded;
+}
+
+/**
+ * Calculate and return the time of the next step to take.
+ */
+real_t TimeStepperEmbedded::NextTime() {
+    const len_t SSIZE = this->unknowns->GetLongVectorSize(this->nontrivials);
+    if (this->sol_size != SSIZE) {
+        AllocateSolutions(SSIZE);
+        this->nHistory = 0;
+    }
+
+    if (this->restoreSolution) {
+        // Last step was rejected: remove the rejected solution
+        // and the copy of the initial state
+        RestoreInitialSolution(2);
+        this->restoreSolution = false;
+    } else if (this->stepsWithException == 0) {
+        // Store a copy of the initial state, so that
+        // we can return to it if the step is rejected
+        this->unknowns->SaveStep(this->currentTime, false);
+
+        if (this->nHistory == 0) {
+            CopySolution(this->sol_curr);
+            this->nHistory = 1;
+        }
+    }
+
+    this->dt = this->LimitStepToEvents(this->currentTime, this->dt);
+    this->nextTime = this->currentTime + this->dt;
+    if (this->nextTime >= this->tMax) {
+        this->nextTime = this->tMax;
+        this->dt = this->tMax - this->currentTime;
+    }
+
+    return this->nextTime;
+}
+
+/**
+ * Print current time stepping progress.
+ */
+void TimeStepperEmbedded::PrintProgress() {
+    if (!this->stepSucceeded)
+        return;
+
+    const len_t PERC_FMT_PREC = 2;      // Precision (after decimal point) in percentage
+    //                          100 . XX            %
+    const len_t PERC_FMT_LENGTH = 3+1+PERC_FMT_PREC+1;
+    const len_t EDGE_LENGTH = 1;
+    const len_t PROG_LENGTH = PROGRESSBAR_LENGTH-2*EDGE_LENGTH - PERC_FMT_LENGTH - 1;
+
+    cout << "\r[";
+    real_t perc     = CurrentTime()/this->tMax;
+    len_t threshold = static_cast<len_t>(perc * PROG_LENGTH);
+    
+    for (len_t i = 0; i < PROG_LENGTH; i++) {
+        if (i < threshold)
+            cout << '#';
+        else
+            cout << '-';
+    }
+
+    cout << "] ";
+    printf(
+        "%*.*f%% (step " LEN_T_PRINTF_FMT ", dt = %.5e)",
+        int(4+PERC_FMT_PREC), int(PERC_FMT_PREC),
+        perc*100.0, this->currentStep, this->dtOld
+    );
+
+    // Ensure that output is written right away (otherwise it may
+    // not be written until the end-of-line character is written)
+    cout << flush;
+}
+
+/**
+ * Restore the solution at the beginning of the current step.
+ *
+ * nSteps: Number of saved steps to roll back.
+ */
+void TimeStepperEmbedded::RestoreInitialSolution(const len_t nSteps) {
+    for (len_t i = 0; i < nSteps; i++)
+        this->unknowns->RollbackSaveStep();
+
+    // Restore initial solution in solver
+    CopySolution(this->sol_new);
+    this->solver->SetInitialGuess(this->sol_new);
+
+    // Save a new copy of the initial state
+    this->unknowns->SaveStep(this->currentTime, false);
+}
+
+/**
+ * Estimate the error in the most recent step and decide whether
+ * to accept it.
+ */
+void TimeStepperEmbedded::ValidateStep() {
+    // Reset exception counter (because this method is only called
+    // if the solver succeeded)
+    this->stepsWithException = 0;
+
+    CopySolution(this->sol_new);
+
+    if (UpdateStep()) {
+        this->stepSucceeded = true;
+        this->currentTime = this->nextTime;
+        this->currentStep++;
+
+        // Shift solution history
+        real_t *tmp = this->sol_prev;
+        this->sol_prev = this->sol_curr;
+        this->sol_curr = this->sol_new;
+        this->sol_new  = tmp;
+
+        if (this->nHistory < 2)
+            this->nHistory++;
+
+        this->RecordAcceptedStep();
+    } else {
+        this->stepSucceeded = false;
+        this->restoreSolution = true;
+        this->nRejectedStep++;
+    }
+}
+
+/**
+ * Estimate the local truncation error of the most recent
+ * step and update the time step 'dt' accordingly.
+ *
+ * RETURNS true if the step should be accepted.
+ */
+bool TimeStepperEmbedded::UpdateStep() {
+    const real_t dtStep = this->dt;
+
+    // Without history, the error cannot be estimated
+    if (this->nHistory < 2) {
+        this->dtOld = dtStep;
+        return true;
+    }
+
+    const real_t r = dtStep / this->dtOld;
+    const real_t c = dtStep / (dtStep + this->dtOld);
+    for (len_t i = 0; i < this->sol_size; i++) {
+        real_t pred = this->sol_curr[i] + r*(this->sol_curr[i] - this->sol_prev[i]);
+        this->sol_err[i] = c*(this->sol_new[i] - pred);
+    }
+
+    bool converged = this->convChecker->IsConverged(this->sol_new, this->sol_err);
+    const real_t *err = this->convChecker->GetErrorRatios();
+
+    // Calculate maximum error (relative to the tolerance)
+    real_t maxErr = 0;
+    len_t maxErri = 0;
+    for (len_t i = 0; i < this->nontrivials.size(); i++) {
+        if (maxErr < err[i]) {
+            maxErr = err[i];
+            maxErri = i;
+        }
+    }
+
+    // The local error of backward Euler scales as dt^2
+    real_t fac;
+    if (maxErr == 0)
+        fac = MAX_STEP_FACTOR;
+    else
+        fac = SAFETY_FACTOR / sqrt(maxErr);
+
+    if (fac < MIN_STEP_FACTOR) fac = MIN_STEP_FACTOR;
+    else if (fac > MAX_STEP_FACTOR) fac = MAX_STEP_FACTOR;
+
+    real_t dt = fac * dtStep;
+    if (this->dtMax > 0 && dt > this->dtMax)
+        dt = this->dtMax;
+
+    if (this->verbose) {
+        DREAM::IO::PrintInfo(
+            "[TimeStepper] max error:  %.6e  (for unknown #" LEN_T_PRINTF_FMT ")\n"
+            "[TimeStepper] step %s:  %.6e  ->  %.6e",
+            maxErr, this->nontrivials[maxErri], (converged ? "ACCEPTED" : "REJECTED"),
+            dtStep, dt
+        );
+    }
+
+    if (converged)
+        this->dtOld = dtStep;
+
+    this->dt = dt;
+
+    return converged;
+}
+
+
+/**
+ * Save the state of this time stepper to the given checkpoint
+ * (including the history of accepted solutions used for
+ * predicting the next solution).
+ */
+void TimeStepperEmbedded::SaveCheckpoint(Checkpoint &cp) const {
+    cp.Put("timestepper/currentTime", this->currentTime);
+    cp.Put("timestepper/nextTime", this->nextTime);
+    cp.Put("timestepper/dt", this->dt);
+    cp.Put("timestepper/dtOld", this->dtOld);
+    cp.Put("timestepper/currentStep", (real_t)this->currentStep);
+    cp.Put("timestepper/stepSucceeded", this->stepSucceeded ? 1.0 : 0.0);
+    cp.Put("timestepper/nHistory", (real_t)this->nHistory);
+
+    if (this->sol_size > 0) {
+        cp.Put("timestepper/sol_prev", this->sol_prev, this->sol_size);
+        cp.Put("timestepper/sol_curr", this->sol_curr, this->sol_size);
+    }
+}
+
+/**
+ * Restore the state of this time stepper from the given checkpoint.
+ */
+void TimeStepperEmbedded::LoadCheckpoint(const Checkpoint &cp) {
+    this->currentTime = cp.GetScalar("timestepper/currentTime");
+    this->nextTime = cp.GetScalar("timestepper/nextTime");
+    this->dt = cp.GetScalar("timestepper/dt");
+    this->dtOld = cp.GetScalar("timestepper/dtOld");
+    this->currentStep = (len_t)cp.GetScalar("timestepper/currentStep");
+    this->stepSucceeded = (cp.GetScalar("timestepper/stepSucceeded") != 0);
+    this->restoreSolution = false;
+    this->stepsWithException = 0;
+    this->nHistory = 0;
+
+    if (cp.Has("timestepper/sol_curr")) {
+        const std::vector<real_t> &curr = cp.Get("timestepper/sol_curr");
+        const real_t *prev = cp.Get("timestepper/sol_prev", curr.size());
+
+        AllocateSolutions(curr.size());
+        for (len_t i = 0; i < this->sol_size; i++) {
+            this->sol_prev[i] = prev[i];
+            this->sol_curr[i] = curr[i];
+        }
+
+        this->nHistory = (len_t)cp.GetScalar("timestepper/nHistory");
+    }
+}
@@ -2,8 +2,21 @@
  * Implementation of an adaptive time stepper which gradually
  * rescales the time step to ensure that the ionization time
  * scale is (just barely) respected.
+ *
+ * The time scale is the shortest time scale |x|/|dx/dt| of all
+ * elements of a set of unknowns, which by default only contains
+ * the cold electron density, but may include any other unknown
+ * (e.g. the temperature, the electric field and the runaway
+ * density, which all evolve rapidly during a thermal quench). The
+ * rates of change are estimated from the most recent step, and may
+ * optionally be smoothed over previous steps. The time step is then
+ * either set proportional to the time scale, or adapted with a PI
+ * controller which lets the time step grow smoothly towards (but
+ * never beyond) the step allowed by the time scale.
  */
 
+#include <algorithm>
+#include <cmath>
 #include <iostream>
 #include "DREAM/IO.hpp"
 #include "DREAM/Settings/OptionConstants.hpp"
@@ -28,47 +41,85 @@ TimeStepperIonization::TimeStepperIonization(
 		throw TimeStepperException("TimeStepperIonization: Maximum time must be greater than initial time step.");
 	
 	this->id_n_cold = u->GetUnknownID(OptionConstants::UQTY_N_COLD);
-	this->nr = u->GetUnknown(this->id_n_cold)->GetGrid()->GetNr();
-
-	this->timescales = new real_t[this->nr];
-	this->ncold = new real_t[this->nr];
+	this->ids.push_back(this->id_n_cold);
+	this->previous.resize(1, std::vector<real_t>(u->GetUnknown(this->id_n_cold)->NumberOfElements()));
+	this->rates.resize(1);
 }
 
 /**
  * Destructor.
  */
-TimeStepperIonization::~TimeStepperIonization() {
-	delete [] this->ncold;
-	delete [] this->timescales;
-}
+TimeStepperIonization::~TimeStepperIonization() { }
+
+
+/**
+ * Include the time scale of the named unknown quantity when
+ * determining the time step.
+ *
+ * name: Name of unknown quantity.
+ */
+void TimeStepperIonization::AddTimeScaleUnknown(const string& name) {
+	if (!this->unknowns->HasUnknown(name))
+		throw TimeStepperException(
+			"TimeStepperIonization: The time scale of '%s' cannot be used "
+			"since it is not an unknown quantity.", name.c_str()
+		);
+
+	const len_t id = this->unknowns->GetUnknownID(name);
+	if (find(this->ids.begin(), this->ids.end(), id) != this->ids.end())
+		return;
 
+	this->ids.push_back(id);
+	this->previous.push_back(std::vector<real_t>(this->unknowns->GetUnknown(id)->NumberOfElements()));
+	this->rates.push_back(std::vector<real_t>());
+}
 
 /**
- * Evaluates the current ionization time scale. If the time
- * scale cannot be evaluated (i.e. if n_cold is only known in
- * a single time point), zero is returned.
+ * Evaluates the current time scale, as the shortest time scale
+ * |x|/|dx/dt| of all elements of the selected unknowns. If the time
+ * scale cannot be evaluated (i.e. if the unknowns are only known in
+ * a single time point, or are not changing), zero is returned.
  */
 real_t TimeStepperIonization::GetIonizationTimeScale() {
 	if (this->currentTime == 0)
 		return 0;
 
-	FVM::UnknownQuantity *n_cold = this->unknowns->GetUnknown(this->id_n_cold);
-	const real_t *n  = n_cold->GetData();
+	real_t tscale = std::numeric_limits<real_t>::infinity();
+	for (len_t k = 0; k < this->ids.size(); k++) {
+		FVM::UnknownQuantity *uqty = this->unknowns->GetUnknown(this->ids[k]);
+		const real_t *x = uqty->GetData();
+		const real_t *xold = this->previous[k].data();
+		const len_t N = uqty->NumberOfElements();
 
-	// Evaluate time scale as "1 / (|dn/dt| / n)"
-	for (len_t ir = 0; ir < this->nr; ir++) {
-		if (n[ir] != this->ncold[ir])
-			timescales[ir] = n[ir] * this->dt / std::abs(n[ir]-this->ncold[ir]);
-		else
-			timescales[ir] = std::numeric_limits<real_t>::infinity();
+		// The cold electron density never vanishes and is used as
+		// is, while for other unknowns (which may vanish or change
+		// sign), elements much smaller than the largest element
+		// are only resolved relative to the latter
+		const bool isNCold = (this->ids[k] == this->id_n_cold);
+		real_t floor = 0;
+		if (!isNCold) {
+			for (len_t i = 0; i < N; i++)
+				floor = max(floor, std::abs(x[i]));
+			floor *= TIMESCALE_FLOOR;
+		}
+
+		std::vector<real_t> &r = this->rates[k];
+		const bool smooth = (this->smoothing > 0 && r.size() == N);
+		r.resize(N);
+
+		// Evaluate time scale as "1 / (|dx/dt| / x)"
+		for (len_t i = 0; i < N; i++) {
+			real_t rate = std::abs(x[i]-xold[i]) / this->dt;
+			if (smooth)
+				rate = this->smoothing*r[i] + (1-this->smoothing)*rate;
+			r[i] = rate;
+
+			const real_t scale = (isNCold ? x[i] : max(std::abs(x[i]), floor));
+			if (rate > 0 && scale > 0)
+				tscale = min(tscale, scale / rate);
+		}
 	}
 	
-	// Find shortest time scale
-	real_t tscale = timescales[0];
-	for (len_t ir = 0; ir < this->nr; ir++)
-		if (timescales[ir] < tscale)
-			tscale = timescales[ir];
-	
 	if (isinf(tscale))
 		return 0;
 	else
@@ -96,11 +147,26 @@ real_t TimeStepperIonization::NextTime() {
 			DREAM::IO::PrintInfo("Setting baseline timestep: %.7e\n", this->dt0);
 		}
 
-		this->dt = (this->dt0 * timescale / this->tscale0);
+		// Time step allowed by the time scale
+		const real_t dtScale = (this->dt0 * timescale / this->tscale0);
+		const real_t ratio = this->dt / dtScale;
+
+		if (this->controller == OptionConstants::TIMESTEPPER_IONIZATION_CONTROLLER_PI && this->oldRatio > 0) {
+			real_t fac = pow(1/ratio, PI_KI) * pow(this->oldRatio/ratio, PI_KP);
+			fac = max(PI_FAC_MIN, min(PI_FAC_MAX, fac));
+
+			this->dt = min(this->dt*fac, dtScale);
+		} else
+			this->dt = dtScale;
+
+		this->oldRatio = ratio;
+
 		if (this->dtMax > 0 && this->dt > this->dtMax)
 			this->dt = this->dtMax;
 	}
 
+	this->dt = this->LimitStepToEvents(this->currentTime, this->dt);
+
 	if ((this->currentTime+this->dt) > this->tMax)
 		return this->tMax;
 	else
@@ -121,10 +187,11 @@ void TimeStepperIonization::ValidateStep() {
 	
 	this->currentStep++;
 
-	// Copy current value of n_cold
-	const real_t *n = this->unknowns->GetUnknownDataPrevious(this->id_n_cold);
-	for (len_t ir = 0; ir < this->nr; ir++)
-		this->ncold[ir] = n[ir];
+	// Copy the values at the start of the step
+	for (len_t k = 0; k < this->ids.size(); k++) {
+		const real_t *x = this->unknowns->GetUnknownDataPrevious(this->ids[k]);
+		std::copy(x, x+this->previous[k].size(), this->previous[k].begin());
+	}
 }
 
 /**
@@ -159,3 +226,54 @@ void TimeStepperIonization::PrintProgress() {
 	cout << flush;
 }
 
+
+/**
+ * Save the state of this time stepper to the given checkpoint.
+ */
+void TimeStepperIonization::SaveCheckpoint(Checkpoint &cp) const {
+	cp.Put("timestepper/currentTime", this->currentTime);
+	cp.Put("timestepper/currentStep", (real_t)this->currentStep);
+	cp.Put("timestepper/dt", this->dt);
+	cp.Put("timestepper/dt0", this->dt0);
+	cp.Put("timestepper/tscale0", this->tscale0);
+	cp.Put("timestepper/oldRatio", this->oldRatio);
+	cp.Put("timestepper/ncold", this->previous[0].data(), this->previous[0].size());
+
+	for (len_t k = 1; k < this->ids.size(); k++) {
+		const string name = this->unknowns->GetUnknown(this->ids[k])->GetName();
+		cp.Put("timestepper/previous_" + name, this->previous[k].data(), this->previous[k].size());
+	}
+	for (len_t k = 0; k < this->ids.size(); k++) {
+		const string name = this->unknowns->GetUnknown(this->ids[k])->GetName();
+		if (!this->rates[k].empty())
+			cp.Put("timestepper/rates_" + name, this->rates[k].data(), this->rates[k].size());
+	}
+}
+
+/**
+ * Restore the state of this time stepper from the given checkpoint.
+ */
+void TimeStepperIonization::LoadCheckpoint(const Checkpoint &cp) {
+	this->currentTime = cp.GetScalar("timestepper/currentTime");
+	this->currentStep = (len_t)cp.GetScalar("timestepper/currentStep");
+	this->dt = cp.GetScalar("timestepper/dt");
+	this->dt0 = cp.GetScalar("timestepper/dt0");
+	this->tscale0 = cp.GetScalar("timestepper/tscale0");
+
+	this->oldRatio = (cp.Has("timestepper/oldRatio") ? cp.GetScalar("timestepper/oldRatio") : 0);
+
+	for (len_t k = 0; k < this->ids.size(); k++) {
+		const string name = this->unknowns->GetUnknown(this->ids[k])->GetName();
+		const string pname = (k == 0 ? "timestepper/ncold" : "timestepper/previous_" + name);
+		const len_t N = this->previous[k].size();
+
+		const real_t *x = cp.Get(pname, N);
+		std::copy(x, x+N, this->previous[k].begin());
+
+		this->rates[k].clear();
+		if (cp.Has("timestepper/rates_" + name)) {
+			const real_t *r = cp.Get("timestepper/rates_" + name, N);
+			this->rates[k].assign(r, r+N);
+		}
+	}
+}
@@ -1,5 +1,6 @@
 
 #include <map>
+#include <string>
 #include "DREAM/DREAMException.hpp"
 #include "DREAM/UnknownQuantityEquation.hpp"
 #include "FVM/Equation/PredeterminedParameter.hpp"
@@ -135,6 +136,28 @@ bool UnknownQuantityEquation::IsPredetermined() {
         return false;
 }
 
+/**
+ * Returns 'true' if the jacobian matrix block row corresponding
+ * to this equation can be built concurrently with the rows of
+ * other equations.
+ */
+bool UnknownQuantityEquation::IsThreadSafe() const {
+    for (auto it = equations.begin(); it != equations.end(); it++)
+        if (!it->second->IsThreadSafe())
+            return false;
+
+    return true;
+}
+
+/**
+ * Adds to 'objs' the shared objects modified by the operators of
+ * this equation (see 'FVM::EquationTerm::GetSharedObjects()').
+ */
+void UnknownQuantityEquation::GetSharedObjects(std::vector<const void*>& objs) const {
+    for (auto it = equations.begin(); it != equations.end(); it++)
+        it->second->GetSharedObjects(objs);
+}
+
 void UnknownQuantityEquation::RebuildEquations(
     const real_t t, const real_t dt, FVM::UnknownQuantityHandler *uqty
 ) {
@@ -158,3 +181,29 @@ void UnknownQuantityEquation::SetVectorElements(
         it->second->SetVectorElements(vec, uqty->GetData());
     }
 }
+
+/**
+ * Identify the term of this equation which sets a non-finite
+ * (NaN or Inf) value in element 'i' of the function vector
+ * (see 'FVM::Operator::FindNonFiniteTerm()').
+ *
+ * i:        Index of the non-finite element of the function vector.
+ * unknowns: List of unknowns.
+ *
+ * RETURNS a description of the term, or an empty string if no
+ * term evaluates to a non-finite value in element 'i'.
+ */
+std::string UnknownQuantityEquation::FindNonFiniteTerm(
+    const len_t i, FVM::UnknownQuantityHandler *unknowns
+) {
+    const len_t n = this->NumberOfElements();
+    for (auto it = equations.begin(); it != equations.end(); it++) {
+        FVM::UnknownQuantity *uqty = unknowns->GetUnknown(it->first);
+        std::string name = it->second->FindNonFiniteTerm(i, n, uqty->GetData());
+
+        if (!name.empty())
+            return "'" + name + "' (applied to '" + uqty->GetName() + "')";
+    }
+
+    return "";
+}
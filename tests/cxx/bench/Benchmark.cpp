@@ -0,0 +1,104 @@
+/**
+ * Implementation of the 'Benchmark' base class, used for measuring
+ * the throughput of individual kernels of the DREAM and FVM libraries.
+ */
+
+#include <cstdio>
+#include "FVM/DurationTimer.hpp"
+#include "bench/Benchmark.hpp"
+
+
+using namespace DREAMTESTS;
+using namespace std;
+
+
+// Minimum wall-clock time (in seconds) to spend
+// on measuring each kernel
+real_t Benchmark::minimumTime = 0.2;
+// Number of grid sizes (from 'GetGridSizes()') to run
+len_t Benchmark::nGridSizes = 3;
+
+
+/**
+ * Returns the list of grid sizes to run all benchmarks for,
+ * in order of increasing size.
+ */
+const vector<struct Benchmark::gridsize>& Benchmark::GetGridSizes() {
+    static const vector<struct gridsize> sizes = {
+        {  4,  20, 10 },
+        { 10,  50, 30 },
+        { 20, 100, 60 }
+    };
+
+    return sizes;
+}
+
+/**
+ * Run this benchmark for all grid sizes.
+ */
+bool Benchmark::Run(bool) {
+    const vector<struct gridsize>& sizes = GetGridSizes();
+
+    for (len_t i = 0; i < sizes.size() && i < nGridSizes; i++) {
+        this->currentSize = sizes[i];
+        this->PrintStatus(
+            "nr = " LEN_T_PRINTF_FMT ", np = " LEN_T_PRINTF_FMT ", nxi = " LEN_T_PRINTF_FMT,
+            sizes[i].nr, sizes[i].np, sizes[i].nxi
+        );
+
+        this->RunBenchmark(sizes[i]);
+    }
+
+    return true;
+}
+
+/**
+ * Measure the time taken by the given kernel. The kernel is
+ * first called once (so that any one-time allocations are not
+ * counted), and then repeatedly until at least 'minimumTime'
+ * seconds have passed.
+ *
+ * kernel: Name of the kernel.
+ * nCells: Number of cells processed in each call to the kernel.
+ * nnz:    Number of matrix non-zeros set in each call to the kernel
+ *         (zero if the kernel does not build a matrix).
+ * f:      Function which calls the kernel once.
+ */
+void Benchmark::Measure(
+    const string& kernel, const len_t nCells, const len_t nnz,
+    const function<void()>& f
+) {
+    DREAM::FVM::DurationTimer timer;
+
+    f();
+
+    len_t nCalls = 0;
+    unsigned long long allocs0 = nAllocations.load();
+    timer.Start();
+    do {
+        f();
+        nCalls++;
+        timer.Stop();
+        timer.Start();
+    } while (timer.GetMicroseconds()*1e-6 < minimumTime);
+    timer.Stop();
+    unsigned long long allocs1 = nAllocations.load();
+
+    struct result r;
+    r.benchmark = this->name;
+    r.kernel = kernel;
+    r.size = this->currentSize;
+    r.nCalls = nCalls;
+    r.secondsPerCall = timer.GetMicroseconds()*1e-6 / nCalls;
+    r.cellsPerSecond = nCells / r.secondsPerCall;
+    r.nnzPerSecond = nnz / r.secondsPerCall;
+    r.allocationsPerCall = real_t(allocs1 - allocs0) / nCalls;
+
+    this->results.push_back(r);
+
+    printf(
+        "  %-32s %12.3e s/call  %12.3e cells/s  %12.3e nnz/s  %10.1f allocs/call\n",
+        kernel.c_str(), r.secondsPerCall, r.cellsPerSecond,
+        r.nnzPerSecond, r.allocationsPerCall
+    );
+}
@@ -0,0 +1,59 @@
+#ifndef _DREAMTESTS_BENCHMARK_HPP
+#define _DREAMTESTS_BENCHMARK_HPP
+
+#include <atomic>
+#include <functional>
+#include <string>
+#include <vector>
+#include "UnitTest.hpp"
+
+namespace DREAMTESTS {
+    // Number of calls to 'operator new' made by the
+    // process (counted in 'dreambench.cpp')
+    extern std::atomic<unsigned long long> nAllocations;
+
+    class Benchmark : public UnitTest {
+    public:
+        // Grid size to run a benchmark for
+        struct gridsize {
+            len_t nr, np, nxi;
+        };
+
+        // Result of benchmarking one kernel on one grid
+        struct result {
+            std::string benchmark, kernel;
+            struct gridsize size;
+            len_t nCalls;
+            real_t secondsPerCall;
+            real_t cellsPerSecond;
+            real_t nnzPerSecond;
+            real_t allocationsPerCall;
+        };
+
+    protected:
+        std::vector<struct result> results;
+        struct gridsize currentSize;
+
+        static real_t minimumTime;
+        static len_t nGridSizes;
+
+        void Measure(
+            const std::string&, const len_t, const len_t,
+            const std::function<void()>&
+        );
+
+    public:
+        Benchmark(const std::string& name) : UnitTest(name) {}
+
+        const std::vector<struct result>& GetResults() const { return this->results; }
+
+        virtual void RunBenchmark(const struct gridsize&) = 0;
+        virtual bool Run(bool) override;
+
+        static const std::vector<struct gridsize>& GetGridSizes();
+        static void SetMinimumTime(const real_t t) { minimumTime = t; }
+        static void SetNumberOfGridSizes(const len_t n) { nGridSizes = n; }
+    };
+}
+
+#endif/*_DREAMTESTS_BENCHMARK_HPP*/
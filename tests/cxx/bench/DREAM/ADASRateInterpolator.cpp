@@ -0,0 +1,67 @@
+/**
+ * Benchmark of the 'ADASRateInterpolator' class, evaluating the
+ * argon ionization rate coefficient (with derivatives) for all
+ * charge states in a number of (n, T) points.
+ */
+
+#include <cmath>
+#include "DREAM/ADAS.hpp"
+#include "DREAM/ADASRateInterpolator.hpp"
+#include "ADASRateInterpolator.hpp"
+
+
+using namespace DREAMTESTS::BENCH::_DREAM;
+
+
+/**
+ * Run the benchmark for the given grid size. The rate coefficient
+ * is evaluated in 'nr*np' points, spanning the density and
+ * temperature ranges typical of a disruption.
+ */
+void ADASRateInterpolator::RunBenchmark(const struct gridsize& size) {
+    DREAM::ADAS *adas = new DREAM::ADAS();
+    const len_t Z = 18;
+    DREAM::ADASRateInterpolator *scd = adas->GetSCD(Z);
+
+    const len_t N = size.nr*size.np;
+    real_t *n = new real_t[N];
+    real_t *T = new real_t[N];
+    for (len_t i = 0; i < N; i++) {
+        n[i] = 1e19 * pow(1e2, i/real_t(N));
+        T[i] = 1 * pow(1e4, Rand());
+    }
+
+    real_t **coeff = new real_t*[Z+1];
+    real_t **dcoeff_dn = new real_t*[Z+1];
+    real_t **dcoeff_dT = new real_t*[Z+1];
+    for (len_t Z0 = 0; Z0 <= Z; Z0++) {
+        coeff[Z0] = new real_t[N];
+        dcoeff_dn[Z0] = new real_t[N];
+        dcoeff_dT[Z0] = new real_t[N];
+    }
+
+    const len_t nEvals = (Z+1)*N;
+    Measure("adasrateinterpolator/eval", nEvals, 0, [&]() {
+        for (len_t Z0 = 0; Z0 <= Z; Z0++)
+            for (len_t i = 0; i < N; i++)
+                coeff[Z0][i] = scd->Eval(Z0, n[i], T[i]);
+    });
+    Measure("adasrateinterpolator/evalchargestates", nEvals, 0, [&]() {
+        scd->Eval(N, n, T, coeff);
+    });
+    Measure("adasrateinterpolator/evalchargestates_deriv", nEvals, 0, [&]() {
+        scd->Eval(N, n, T, coeff, dcoeff_dn, dcoeff_dT);
+    });
+
+    for (len_t Z0 = 0; Z0 <= Z; Z0++) {
+        delete [] dcoeff_dT[Z0];
+        delete [] dcoeff_dn[Z0];
+        delete [] coeff[Z0];
+    }
+    delete [] dcoeff_dT;
+    delete [] dcoeff_dn;
+    delete [] coeff;
+    delete [] T;
+    delete [] n;
+    delete adas;
+}
@@ -0,0 +1,15 @@
+#ifndef _DREAMTESTS_BENCH_DREAM_ADAS_RATE_INTERPOLATOR_HPP
+#define _DREAMTESTS_BENCH_DREAM_ADAS_RATE_INTERPOLATOR_HPP
+
+#include "bench/Benchmark.hpp"
+
+namespace DREAMTESTS::BENCH::_DREAM {
+    class ADASRateInterpolator : public Benchmark {
+    public:
+        ADASRateInterpolator(const std::string& name) : Benchmark(name) {}
+
+        virtual void RunBenchmark(const struct gridsize&) override;
+    };
+}
+
+#endif/*_DREAMTESTS_BENCH_DREAM_ADAS_RATE_INTERPOLATOR_HPP*/
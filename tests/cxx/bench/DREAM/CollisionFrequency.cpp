@@ -0,0 +1,114 @@
+/**
+ * Benchmark of the 'CollisionFrequency' classes (slowing-down and
+ * pitch-angle scattering frequencies, with the Coulomb logarithms
+ * they depend on) in a deuterium-argon plasma.
+ */
+
+#include <string>
+#include <vector>
+#include "DREAM/Equations/CollisionQuantity.hpp"
+#include "DREAM/Equations/CoulombLogarithm.hpp"
+#include "DREAM/Equations/PitchScatterFrequency.hpp"
+#include "DREAM/Equations/SlowingDownFrequency.hpp"
+#include "DREAM/IonHandler.hpp"
+#include "DREAM/Settings/OptionConstants.hpp"
+#include "FVM/UnknownQuantityHandler.hpp"
+#include "CollisionFrequency.hpp"
+
+
+using namespace DREAMTESTS::BENCH::_DREAM;
+using namespace std;
+
+
+/**
+ * Run the benchmark for the given grid size.
+ */
+void CollisionFrequency::RunBenchmark(const struct gridsize& size) {
+    DREAM::FVM::Grid *grid = InitializeGridRCylPXi(size.nr, size.np, size.nxi);
+    const len_t nr = grid->GetNr();
+
+    const len_t N_IONS = 2;
+    const len_t Z_IONS[N_IONS] = {1, 18};
+    const len_t nZ0 = (Z_IONS[0]+1) + (Z_IONS[1]+1);
+
+    DREAM::FVM::UnknownQuantityHandler *uqh = new DREAM::FVM::UnknownQuantityHandler();
+    const len_t id_ni = uqh->InsertUnknown(DREAM::OptionConstants::UQTY_ION_SPECIES, "0", grid, nZ0);
+    const len_t id_ncold = uqh->InsertUnknown(DREAM::OptionConstants::UQTY_N_COLD, "0", grid);
+    const len_t id_Tcold = uqh->InsertUnknown(DREAM::OptionConstants::UQTY_T_COLD, "0", grid);
+
+    // Singly ionized argon in a fully ionized deuterium plasma
+    real_t *ni = new real_t[nZ0*nr];
+    real_t *ncold = new real_t[nr];
+    real_t *Tcold = new real_t[nr];
+    for (len_t i = 0; i < nZ0*nr; i++)
+        ni[i] = 0;
+    for (len_t ir = 0; ir < nr; ir++) {
+        ni[1*nr + ir] = 1e20;
+        ni[(Z_IONS[0]+2)*nr + ir] = 1e19;
+        ncold[ir] = 1.1e20;
+        Tcold[ir] = 10 + 990*ir/real_t(nr);
+    }
+    uqh->SetInitialValue(id_ni, ni);
+    uqh->SetInitialValue(id_ncold, ncold);
+    uqh->SetInitialValue(id_Tcold, Tcold);
+
+    vector<string> names(N_IONS), tritiumNames(0), hydrogenNames(0);
+    DREAM::IonHandler *ih = new DREAM::IonHandler(
+        grid->GetRadialGrid(), uqh, Z_IONS, N_IONS, names, tritiumNames, hydrogenNames
+    );
+    ih->Rebuild();
+
+    DREAM::CollisionQuantity::collqty_settings *cq = new DREAM::CollisionQuantity::collqty_settings;
+    cq->collfreq_type = DREAM::OptionConstants::COLLQTY_COLLISION_FREQUENCY_TYPE_PARTIALLY_SCREENED;
+    cq->collfreq_mode = DREAM::OptionConstants::COLLQTY_COLLISION_FREQUENCY_MODE_FULL;
+    cq->lnL_type      = DREAM::OptionConstants::COLLQTY_LNLAMBDA_ENERGY_DEPENDENT;
+    cq->pstar_mode    = DREAM::OptionConstants::COLLQTY_PSTAR_MODE_COLLISIONLESS;
+    cq->bremsstrahlung_mode = DREAM::OptionConstants::EQTERM_BREMSSTRAHLUNG_MODE_NEGLECT;
+
+    const enum DREAM::OptionConstants::momentumgrid_type gridtype = DREAM::OptionConstants::MOMENTUMGRID_TYPE_PXI;
+    DREAM::CoulombLogarithm *lnLEE = new DREAM::CoulombLogarithm(grid, uqh, ih, gridtype, cq, DREAM::CollisionQuantity::LNLAMBDATYPE_EE);
+    DREAM::CoulombLogarithm *lnLEI = new DREAM::CoulombLogarithm(grid, uqh, ih, gridtype, cq, DREAM::CollisionQuantity::LNLAMBDATYPE_EI);
+    DREAM::SlowingDownFrequency *nuS  = new DREAM::SlowingDownFrequency(grid, uqh, ih, lnLEE, lnLEI, gridtype, cq);
+    DREAM::PitchScatterFrequency *nuD = new DREAM::PitchScatterFrequency(grid, uqh, ih, lnLEI, lnLEE, gridtype, cq);
+
+    auto rebuild = [&]() {
+        lnLEE->Rebuild();
+        lnLEI->Rebuild();
+        nuS->Rebuild();
+        nuD->Rebuild();
+    };
+
+    // Rebuild with new temperatures (the terms which only
+    // depend on the grid are kept)
+    const len_t ncells = grid->GetNCells();
+    len_t k = 0;
+    Measure("collisionfrequency/rebuild", ncells, 0, [&]() {
+        // Alternate between two temperature profiles
+        const real_t fac = (k++ % 2 == 0) ? 1.01 : 1/1.01;
+        for (len_t ir = 0; ir < nr; ir++)
+            Tcold[ir] *= fac;
+        uqh->Store(id_Tcold, Tcold);
+        rebuild();
+    });
+
+    // Rebuild everything (as after a grid rebuild)
+    Measure("collisionfrequency/gridrebuilt", ncells, 0, [&]() {
+        lnLEE->GridRebuilt();
+        lnLEI->GridRebuilt();
+        nuS->GridRebuilt();
+        nuD->GridRebuilt();
+        rebuild();
+    });
+
+    delete nuD;
+    delete nuS;
+    delete lnLEI;
+    delete lnLEE;
+    delete cq;
+    delete ih;
+    delete uqh;
+    delete [] Tcold;
+    delete [] ncold;
+    delete [] ni;
+    delete grid;
+}
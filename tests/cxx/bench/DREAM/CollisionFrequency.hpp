@@ -0,0 +1,15 @@
+#ifndef _DREAMTESTS_BENCH_DREAM_COLLISION_FREQUENCY_HPP
+#define _DREAMTESTS_BENCH_DREAM_COLLISION_FREQUENCY_HPP
+
+#include "bench/Benchmark.hpp"
+
+namespace DREAMTESTS::BENCH::_DREAM {
+    class CollisionFrequency : public Benchmark {
+    public:
+        CollisionFrequency(const std::string& name) : Benchmark(name) {}
+
+        virtual void RunBenchmark(const struct gridsize&) override;
+    };
+}
+
+#endif/*_DREAMTESTS_BENCH_DREAM_COLLISION_FREQUENCY_HPP*/
@@ -0,0 +1,52 @@
+/**
+ * Benchmark of the 'BounceAverager' class, evaluating bounce
+ * averages in all cells of a grid with an analytic magnetic field.
+ */
+
+#include <cmath>
+#include "FVM/Grid/fluxGridType.enum.hpp"
+#include "BounceAverager.hpp"
+
+
+using namespace DREAMTESTS::BENCH::FVM;
+
+
+/**
+ * Function to bounce average (of the same form as
+ * the bounce-averaged coefficients in DREAM).
+ */
+static real_t BounceAverageFunction(
+    real_t xiOverXi0, real_t BOverBmin, real_t ROverR0, real_t NablaR2, void*
+) {
+    return xiOverXi0*xiOverXi0*sqrt(BOverBmin)*ROverR0 + NablaR2;
+}
+
+/**
+ * Run the benchmark for the given grid size.
+ */
+void BounceAverager::RunBenchmark(const struct gridsize& size) {
+    DREAM::FVM::Grid *grid = InitializeGridGeneralRPXi(size.nr, size.np, size.nxi);
+
+    const len_t nr = grid->GetNr();
+    const len_t ncells = grid->GetNCells();
+    real_t sum = 0;
+    Measure("bounceaverager/average", ncells, 0, [&]() {
+        for (len_t ir = 0; ir < nr; ir++) {
+            const len_t np1 = grid->GetMomentumGrid(ir)->GetNp1();
+            const len_t np2 = grid->GetMomentumGrid(ir)->GetNp2();
+            for (len_t j = 0; j < np2; j++)
+                for (len_t i = 0; i < np1; i++)
+                    sum += grid->CalculateBounceAverage(
+                        ir, i, j, DREAM::FVM::FLUXGRIDTYPE_DISTRIBUTION,
+                        &BounceAverageFunction
+                    );
+        }
+    });
+
+    // (use the result to prevent the compiler from
+    // optimizing away the calculation)
+    if (!std::isfinite(sum))
+        PrintWarning("Bounce average is not finite.");
+
+    delete grid;
+}
@@ -0,0 +1,15 @@
+#ifndef _DREAMTESTS_BENCH_FVM_BOUNCE_AVERAGER_HPP
+#define _DREAMTESTS_BENCH_FVM_BOUNCE_AVERAGER_HPP
+
+#include "bench/Benchmark.hpp"
+
+namespace DREAMTESTS::BENCH::FVM {
+    class BounceAverager : public Benchmark {
+    public:
+        BounceAverager(const std::string& name) : Benchmark(name) {}
+
+        virtual void RunBenchmark(const struct gridsize&) override;
+    };
+}
+
+#endif/*_DREAMTESTS_BENCH_FVM_BOUNCE_AVERAGER_HPP*/
@@ -0,0 +1,87 @@
+/**
+ * Benchmarks of the 'AdvectionTerm' and 'DiffusionTerm' classes
+ * (through an 'Operator', so that the interpolation coefficients
+ * are included).
+ */
+
+#include "FVM/Equation/AdvectionInterpolationCoefficient.hpp"
+#include "FVM/Matrix.hpp"
+#include "tests/FVM/GeneralAdvectionTerm.hpp"
+#include "tests/FVM/GeneralDiffusionTerm.hpp"
+#include "EquationTerms.hpp"
+
+
+using namespace DREAMTESTS::BENCH::FVM;
+
+
+/**
+ * Benchmark rebuilding the given operator, and setting the
+ * corresponding matrix and vector elements.
+ *
+ * name:       Name of the operator.
+ * grid:       Grid on which the operator is defined.
+ * op:         Operator to benchmark.
+ * buildIndex: Index passed as time to 'RebuildTerms()', selecting
+ *             which coefficients of the general test terms to set.
+ */
+void EquationTerms::BenchmarkOperator(
+    const std::string& name, DREAM::FVM::Grid *grid,
+    DREAM::FVM::Operator *op, const real_t buildIndex
+) {
+    const len_t ncells = grid->GetNCells();
+    DREAM::FVM::Matrix *mat = new DREAM::FVM::Matrix(
+        ncells, ncells, op->GetNumberOfNonZerosPerRow()
+    );
+    real_t *f   = new real_t[ncells];
+    real_t *vec = new real_t[ncells];
+    for (len_t i = 0; i < ncells; i++)
+        f[i] = 1 + Rand();
+
+    op->RebuildTerms(buildIndex, 0, nullptr);
+    op->SetMatrixElements(mat, nullptr);
+    mat->Assemble();
+    const len_t nnz = mat->GetNNZ();
+
+    Measure(name + "/rebuild", ncells, 0, [&]() {
+        op->RebuildTerms(buildIndex, 0, nullptr);
+    });
+    Measure(name + "/setmatrixelements", ncells, nnz, [&]() {
+        mat->Zero();
+        op->SetMatrixElements(mat, nullptr);
+        mat->Assemble();
+    });
+    Measure(name + "/setvectorelements", ncells, 0, [&]() {
+        for (len_t i = 0; i < ncells; i++)
+            vec[i] = 0;
+        op->SetVectorElements(vec, f);
+    });
+
+    delete [] vec;
+    delete [] f;
+    delete mat;
+}
+
+/**
+ * Run the benchmark for the given grid size.
+ */
+void EquationTerms::RunBenchmark(const struct gridsize& size) {
+    DREAM::FVM::Grid *grid = InitializeGridRCylPXi(size.nr, size.np, size.nxi);
+
+    // Advection term (all three components)
+    DREAM::FVM::Operator *op = new DREAM::FVM::Operator(grid);
+    op->AddTerm(new DREAMTESTS::FVM::GeneralAdvectionTerm(grid));
+    op->SetAdvectionBoundaryConditions(
+        DREAM::FVM::AdvectionInterpolationCoefficient::AD_BC_DIRICHLET, 
+        DREAM::FVM::AdvectionInterpolationCoefficient::AD_BC_DIRICHLET
+    );
+    BenchmarkOperator("advectionterm", grid, op, 3);
+    delete op;
+
+    // Diffusion term (all five components)
+    op = new DREAM::FVM::Operator(grid);
+    op->AddTerm(new DREAMTESTS::FVM::GeneralDiffusionTerm(grid));
+    BenchmarkOperator("diffusionterm", grid, op, 5);
+    delete op;
+
+    delete grid;
+}
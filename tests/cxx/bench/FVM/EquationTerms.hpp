@@ -0,0 +1,22 @@
+#ifndef _DREAMTESTS_BENCH_FVM_EQUATION_TERMS_HPP
+#define _DREAMTESTS_BENCH_FVM_EQUATION_TERMS_HPP
+
+#include "FVM/Equation/Operator.hpp"
+#include "FVM/Grid/Grid.hpp"
+#include "bench/Benchmark.hpp"
+
+namespace DREAMTESTS::BENCH::FVM {
+    class EquationTerms : public Benchmark {
+    public:
+        EquationTerms(const std::string& name) : Benchmark(name) {}
+
+        void BenchmarkOperator(
+            const std::string&, DREAM::FVM::Grid*,
+            DREAM::FVM::Operator*, const real_t
+        );
+
+        virtual void RunBenchmark(const struct gridsize&) override;
+    };
+}
+
+#endif/*_DREAMTESTS_BENCH_FVM_EQUATION_TERMS_HPP*/
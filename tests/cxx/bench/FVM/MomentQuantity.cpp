@@ -0,0 +1,63 @@
+/**
+ * Benchmark of the 'MomentQuantity' class, through the density
+ * moment of the distribution function.
+ */
+
+#include "DREAM/Equations/Fluid/DensityFromDistributionFunction.hpp"
+#include "DREAM/Settings/OptionConstants.hpp"
+#include "FVM/Matrix.hpp"
+#include "FVM/UnknownQuantityHandler.hpp"
+#include "MomentQuantity.hpp"
+
+
+using namespace DREAMTESTS::BENCH::FVM;
+
+
+/**
+ * Run the benchmark for the given grid size.
+ */
+void MomentQuantity::RunBenchmark(const struct gridsize& size) {
+    DREAM::FVM::Grid *fluidGrid   = InitializeFluidGrid(size.nr);
+    DREAM::FVM::Grid *kineticGrid = InitializeGridRCylPXi(size.nr, size.np, size.nxi);
+
+    DREAM::FVM::UnknownQuantityHandler *uqh = new DREAM::FVM::UnknownQuantityHandler();
+    const len_t id_n = uqh->InsertUnknown(DREAM::OptionConstants::UQTY_N_HOT, "0", fluidGrid);
+    const len_t id_f = uqh->InsertUnknown(DREAM::OptionConstants::UQTY_F_HOT, "0", kineticGrid);
+
+    const len_t nr = fluidGrid->GetNCells();
+    const len_t ncells = kineticGrid->GetNCells();
+    real_t *f   = new real_t[ncells];
+    real_t *vec = new real_t[nr];
+    for (len_t i = 0; i < ncells; i++)
+        f[i] = 1 + Rand();
+
+    DREAM::DensityFromDistributionFunction *mq =
+        new DREAM::DensityFromDistributionFunction(fluidGrid, kineticGrid, id_n, id_f, uqh);
+
+    DREAM::FVM::Matrix *mat = new DREAM::FVM::Matrix(nr, ncells, mq->GetNumberOfNonZerosPerRow());
+    mq->SetMatrixElements(mat, nullptr);
+    mat->Assemble();
+    const len_t nnz = mat->GetNNZ();
+
+    Measure("momentquantity/gridrebuilt", ncells, 0, [&]() {
+        mq->GridRebuilt();
+    });
+    Measure("momentquantity/setmatrixelements", ncells, nnz, [&]() {
+        mat->Zero();
+        mq->SetMatrixElements(mat, nullptr);
+        mat->Assemble();
+    });
+    Measure("momentquantity/setvectorelements", ncells, 0, [&]() {
+        for (len_t i = 0; i < nr; i++)
+            vec[i] = 0;
+        mq->SetVectorElements(vec, f);
+    });
+
+    delete mat;
+    delete mq;
+    delete [] vec;
+    delete [] f;
+    delete uqh;
+    delete kineticGrid;
+    delete fluidGrid;
+}
@@ -0,0 +1,15 @@
+#ifndef _DREAMTESTS_BENCH_FVM_MOMENT_QUANTITY_HPP
+#define _DREAMTESTS_BENCH_FVM_MOMENT_QUANTITY_HPP
+
+#include "bench/Benchmark.hpp"
+
+namespace DREAMTESTS::BENCH::FVM {
+    class MomentQuantity : public Benchmark {
+    public:
+        MomentQuantity(const std::string& name) : Benchmark(name) {}
+
+        virtual void RunBenchmark(const struct gridsize&) override;
+    };
+}
+
+#endif/*_DREAMTESTS_BENCH_FVM_MOMENT_QUANTITY_HPP*/
@@ -0,0 +1,57 @@
+/**
+ * Benchmark of the parallel reductions ('FVM::Parallel::Sum()'), through
+ * the norms evaluated by the convergence checks of the non-linear solver,
+ * with and without the reproducible (fixed-order) mode. The difference
+ * between the '/reproducible' and '/unordered' kernels is the cost of the
+ * reproducible mode.
+ */
+
+#include "DREAM/Settings/OptionConstants.hpp"
+#include "FVM/NormEvaluator.hpp"
+#include "FVM/Parallel.hpp"
+#include "FVM/UnknownQuantityHandler.hpp"
+#include "ParallelSum.hpp"
+
+
+using namespace DREAMTESTS::BENCH::FVM;
+
+
+/**
+ * Run the benchmark for the given grid size.
+ */
+void ParallelSum::RunBenchmark(const struct gridsize& size) {
+    DREAM::FVM::Grid *kineticGrid = InitializeGridRCylPXi(size.nr, size.np, size.nxi);
+
+    DREAM::FVM::UnknownQuantityHandler *uqh = new DREAM::FVM::UnknownQuantityHandler();
+    const len_t id_f = uqh->InsertUnknown(DREAM::OptionConstants::UQTY_F_HOT, "0", kineticGrid);
+
+    const len_t ncells = kineticGrid->GetNCells();
+    real_t *x  = new real_t[ncells];
+    real_t *dx = new real_t[ncells];
+    for (len_t i = 0; i < ncells; i++) {
+        x[i]  = 1 + Rand();
+        dx[i] = 1e-3*(Rand()-0.5);
+    }
+
+    DREAM::FVM::NormEvaluator *ne =
+        new DREAM::FVM::NormEvaluator(uqh, std::vector<len_t>{id_f});
+    const real_t abstol = 1e-10, reltol = 1e-6;
+    real_t xnorm, dxnorm, wrms;
+
+    const bool reproducible = DREAM::FVM::Parallel::IsReproducible();
+    for (const bool r : {true, false}) {
+        DREAM::FVM::Parallel::SetReproducible(r);
+        const std::string mode = (r ? "/reproducible" : "/unordered");
+
+        Measure("parallelsum/norms" + mode, ncells, 0, [&]() {
+            ne->Norms(x, dx, nullptr, &xnorm, &dxnorm, &abstol, &reltol, &wrms);
+        });
+    }
+    DREAM::FVM::Parallel::SetReproducible(reproducible);
+
+    delete ne;
+    delete [] dx;
+    delete [] x;
+    delete uqh;
+    delete kineticGrid;
+}
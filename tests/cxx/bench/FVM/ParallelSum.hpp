@@ -0,0 +1,15 @@
+#ifndef _DREAMTESTS_BENCH_FVM_PARALLEL_SUM_HPP
+#define _DREAMTESTS_BENCH_FVM_PARALLEL_SUM_HPP
+
+#include "bench/Benchmark.hpp"
+
+namespace DREAMTESTS::BENCH::FVM {
+    class ParallelSum : public Benchmark {
+    public:
+        ParallelSum(const std::string& name) : Benchmark(name) {}
+
+        virtual void RunBenchmark(const struct gridsize&) override;
+    };
+}
+
+#endif/*_DREAMTESTS_BENCH_FVM_PARALLEL_SUM_HPP*/
@@ -0,0 +1,214 @@
+/* Micro-benchmarks */
+
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <new>
+#include <string>
+#include <vector>
+#include <petsc.h>
+
+#include <softlib/SOFTLibException.h>
+
+#include "tests/cxx/config.h"
+#include "FVM/FVMException.hpp"
+
+#include "bench/Benchmark.hpp"
+
+// Benchmarks
+#include "bench/DREAM/ADASRateInterpolator.hpp"
+#include "bench/DREAM/CollisionFrequency.hpp"
+
+#include "bench/FVM/BounceAverager.hpp"
+#include "bench/FVM/EquationTerms.hpp"
+#include "bench/FVM/MomentQuantity.hpp"
+#include "bench/FVM/ParallelSum.hpp"
+
+using namespace std;
+using namespace DREAMTESTS;
+
+
+/**
+ * Count all allocations made by the process, so that the
+ * number of allocations made per call to a kernel can be
+ * reported.
+ */
+std::atomic<unsigned long long> DREAMTESTS::nAllocations(0);
+
+void *operator new(size_t size) {
+    DREAMTESTS::nAllocations++;
+    if (size == 0)
+        size = 1;
+
+    void *p = malloc(size);
+    if (p == nullptr)
+        throw std::bad_alloc();
+    return p;
+}
+void *operator new[](size_t size) { return operator new(size); }
+void operator delete(void *p) noexcept { free(p); }
+void operator delete[](void *p) noexcept { free(p); }
+void operator delete(void *p, size_t) noexcept { free(p); }
+void operator delete[](void *p, size_t) noexcept { free(p); }
+
+
+vector<Benchmark*> benchmarks;
+
+void add_benchmark(Benchmark *b) {
+    benchmarks.push_back(b);
+}
+void init() {
+    add_benchmark(new DREAMTESTS::BENCH::_DREAM::ADASRateInterpolator("dream/adasrateinterpolator"));
+    add_benchmark(new DREAMTESTS::BENCH::_DREAM::CollisionFrequency("dream/collisionfrequency"));
+
+    add_benchmark(new DREAMTESTS::BENCH::FVM::BounceAverager("fvm/bounceaverager"));
+    add_benchmark(new DREAMTESTS::BENCH::FVM::EquationTerms("fvm/equationterms"));
+    add_benchmark(new DREAMTESTS::BENCH::FVM::MomentQuantity("fvm/momentquantity"));
+    add_benchmark(new DREAMTESTS::BENCH::FVM::ParallelSum("fvm/parallelsum"));
+}
+
+/**
+ * Check if a benchmark with the given name exists.
+ *
+ * RETURNS the index of the benchmark if found,
+ * otherwise, -1.
+ */
+int has_benchmark(const char *name) {
+    for (size_t i = 0; i < benchmarks.size(); i++) {
+        if (benchmarks[i]->HasName(name))
+            return i;
+    }
+
+    return -1;
+}
+
+/**
+ * Run the benchmark with index 'index'.
+ *
+ * RETURNS 1 if the benchmark failed, 0 otherwise.
+ */
+int run_benchmark(int index) {
+    cout << "\x1B[1m:: " << benchmarks[index]->GetName() << "\x1B[0m" << endl;
+    try {
+        benchmarks[index]->Run(true);
+        return 0;
+    } catch (DREAM::FVM::FVMException& ex) {
+        cout << "\x1B[1;31m[ERROR]\x1B[0m   --> " << ex.whats() << endl;
+    } catch (SOFTLibException& ex) {
+        cout << "\x1B[1;31m[ERROR]\x1B[0m   --> " << ex.whats() << endl;
+    }
+
+    cout << "\x1B[1;31m[FAIL]\x1B[0m    Benchmark '" << benchmarks[index]->GetName() << "' unexpectedly threw exception." << endl;
+    return 1;
+}
+
+/**
+ * Write the results of all benchmarks which have been
+ * run to the named file, in JSON format.
+ */
+void write_json(const string& filename) {
+    ofstream f(filename);
+    if (!f.good()) {
+        cerr << "\x1B[1;31m[ERROR]\x1B[0m   Unable to open '" << filename << "' for writing." << endl;
+        return;
+    }
+
+    f << "{" << endl
+      << "  \"version\": \"" << DREAM_GIT_SHA1 << "\"," << endl
+      << "  \"results\": [";
+
+    bool first = true;
+    char buffer[512];
+    for (Benchmark *b : benchmarks) {
+        for (const struct Benchmark::result& r : b->GetResults()) {
+            snprintf(buffer, sizeof(buffer),
+                "%s\n    {\"benchmark\": \"%s\", \"kernel\": \"%s\", "
+                "\"nr\": " LEN_T_PRINTF_FMT ", \"np\": " LEN_T_PRINTF_FMT ", \"nxi\": " LEN_T_PRINTF_FMT ", "
+                "\"calls\": " LEN_T_PRINTF_FMT ", \"seconds_per_call\": %.6e, "
+                "\"cells_per_second\": %.6e, \"nnz_per_second\": %.6e, "
+                "\"allocations_per_call\": %.3f}",
+                (first ? "" : ","), r.benchmark.c_str(), r.kernel.c_str(),
+                r.size.nr, r.size.np, r.size.nxi, r.nCalls, r.secondsPerCall,
+                r.cellsPerSecond, r.nnzPerSecond, r.allocationsPerCall
+            );
+            f << buffer;
+            first = false;
+        }
+    }
+
+    f << endl << "  ]" << endl << "}" << endl;
+}
+
+/**
+ * Print help text.
+ */
+void help() {
+    printf(
+        "Micro-benchmarks for DREAM\n\n"
+
+        "Usage:\n"
+        "    dreambench [options] all\n"
+        "                        Run all benchmarks.\n"
+        "    dreambench [options] [bench1 [bench2 [...]]]\n"
+        "                        Runs the benchmarks with names 'bench1', 'bench2' etc.\n\n"
+
+        "Options:\n"
+        "    --json FILE         Write results to FILE in JSON format.\n"
+        "    --sizes N           Only run the N smallest grid sizes.\n"
+        "    --time T            Spend at least T seconds measuring each kernel.\n\n"
+
+        "Available benchmarks:\n"
+    );
+    for (unsigned int i = 0; i < benchmarks.size(); i++) {
+        printf("    %s\n", benchmarks[i]->GetName().c_str());
+    }
+
+    printf("\n");
+}
+
+int main(int argc, char *argv[]) {
+    int failed = 0;
+    string jsonFile;
+    vector<int> selected;
+
+    PetscInitialize(&argc, &argv, NULL, NULL);
+
+    init();
+
+    for (int i = 1; i < argc; i++) {
+        if (!strcmp(argv[i], "--json") && i+1 < argc)
+            jsonFile = argv[++i];
+        else if (!strcmp(argv[i], "--sizes") && i+1 < argc)
+            Benchmark::SetNumberOfGridSizes((len_t)atoi(argv[++i]));
+        else if (!strcmp(argv[i], "--time") && i+1 < argc)
+            Benchmark::SetMinimumTime(atof(argv[++i]));
+        else if (!strcmp(argv[i], "all")) {
+            for (size_t j = 0; j < benchmarks.size(); j++)
+                selected.push_back(j);
+        } else {
+            int t = has_benchmark(argv[i]);
+            if (t >= 0)
+                selected.push_back(t);
+            else {
+                cerr << "\x1B[1;31m[ERROR]\x1B[0m   Unrecognized benchmark: '" << argv[i] << "'." << endl;
+                failed++;
+            }
+        }
+    }
+
+    if (selected.empty() && failed == 0)
+        help();
+
+    for (int t : selected)
+        failed += run_benchmark(t);
+
+    if (!jsonFile.empty())
+        write_json(jsonFile);
+
+    PetscFinalize();
+
+    return failed;
+}
@@ -26,11 +26,17 @@
 #include "tests/FVM/AdvectionTerm.hpp"
 #include "tests/FVM/AdvectionDiffusionTerm.hpp"
 #include "tests/FVM/AnalyticBRadialGridGenerator.hpp"
+#include "tests/FVM/BicubicSpline.hpp"
 #include "tests/FVM/DiffusionTerm.hpp"
 #include "tests/FVM/Grid.hpp"
 #include "tests/FVM/Interpolator1D.hpp"
 #include "tests/FVM/Interpolator3D.hpp"
+#include "tests/FVM/Matrix.hpp"
+#include "tests/FVM/MomentumGridMapping.hpp"
+#include "tests/FVM/Operator.hpp"
+#include "tests/FVM/Parallel.hpp"
 #include "tests/FVM/PXiExternalKineticKinetic.hpp"
+#include "tests/FVM/ScratchArena.hpp"
 
 using namespace std;
 using namespace DREAMTESTS;
@@ -51,10 +57,16 @@ void init() {
     add_test(new DREAMTESTS::FVM::DiffusionTerm("fvm/diffusionterm"));
     add_test(new DREAMTESTS::FVM::AdvectionDiffusionTerm("fvm/advectiondiffusionterm"));
     add_test(new DREAMTESTS::FVM::AnalyticBRadialGridGenerator("fvm/fluxsurfaceaverage"));
+    add_test(new DREAMTESTS::FVM::BicubicSpline("fvm/bicubicspline"));
     add_test(new DREAMTESTS::FVM::Grid("fvm/grid"));
     add_test(new DREAMTESTS::FVM::Interpolator1D("fvm/interpolator1d"));
     add_test(new DREAMTESTS::FVM::Interpolator3D("fvm/interpolator3d"));
+    add_test(new DREAMTESTS::FVM::Matrix("fvm/matrix"));
+    add_test(new DREAMTESTS::FVM::MomentumGridMapping("fvm/momentumgridmapping"));
+    add_test(new DREAMTESTS::FVM::Operator("fvm/operator"));
+    add_test(new DREAMTESTS::FVM::Parallel("fvm/parallel"));
     add_test(new DREAMTESTS::FVM::PXiExternalKineticKinetic("fvm/boundaryflux/2kinetic"));
+    add_test(new DREAMTESTS::FVM::ScratchArena("fvm/scratcharena"));
 }
 
 /**
@@ -6,6 +6,7 @@
 #include <string>
 #include "IonRateEquation.hpp"
 #include "DREAM/ADAS.hpp"
+#include "DREAM/ADASRateCache.hpp"
 #include "DREAM/Equations/Fluid/IonRateEquation.hpp"
 #include "DREAM/Settings/OptionConstants.hpp"
 
@@ -168,6 +169,70 @@ BREAK_LOOP:
     return success;
 }
 
+/**
+ * Check that the ion rate equation gives identical results when
+ * the rate coefficients are read from a (shared) rate cache.
+ */
+bool IonRateEquation::CheckRateCache() {
+    bool success = true;
+    DREAM::FVM::Grid *grid = this->InitializeFluidGrid();
+    DREAM::FVM::UnknownQuantityHandler *uqh = GetUnknownHandler(grid);
+    DREAM::IonHandler *ih = GetIonHandler(grid, uqh);
+    ih->Rebuild();
+    DREAM::ADAS *adas = new DREAM::ADAS();
+    DREAM::ADASRateCache *cache = new DREAM::ADASRateCache(adas, grid->GetRadialGrid(), uqh);
+    const len_t Nr = grid->GetNr();
+
+    const real_t *ntot = ih->GetFreePlusBoundElectronDensity();
+    uqh->SetInitialValue(DREAM::OptionConstants::UQTY_N_TOT, ntot);
+
+    len_t nSize = uqh->GetUnknown(this->id_ions)->NumberOfElements();
+    real_t *vec = new real_t[nSize];
+    real_t *vecCached = new real_t[nSize];
+    real_t *nions = uqh->GetUnknown(this->id_ions)->GetData();
+
+    for (len_t i = 0; i < nSize; i++)
+        vec[i] = vecCached[i] = 0;
+
+    len_t rOffset = 0;
+    for (len_t iIon = 0; iIon < N_IONS; iIon++) {
+        DREAM::IonRateEquation ire(grid, ih, iIon, adas, uqh, true, true, false);
+        DREAM::IonRateEquation ireCached(grid, ih, iIon, adas, uqh, true, true, false, cache);
+
+        ire.Rebuild(0, 1, uqh);
+        // (the second rebuild reads the rates stored in the first)
+        ireCached.Rebuild(0, 1, uqh);
+        ireCached.Rebuild(0, 1, uqh);
+
+        for (len_t Z0 = 0; Z0 <= Z_IONS[iIon]; Z0++, rOffset += Nr) {
+            ire.SetCSVectorElements(vec, nions, iIon, Z0, rOffset);
+            ireCached.SetCSVectorElements(vecCached, nions, iIon, Z0, rOffset);
+        }
+    }
+
+    for (len_t i = 0; i < nSize; i++) {
+        if (vec[i] != vecCached[i]) {
+            this->PrintError(
+                "Ion rate equation with cached rates differs at index "
+                LEN_T_PRINTF_FMT ": %e (cached) vs. %e.",
+                i, vecCached[i], vec[i]
+            );
+            success = false;
+            break;
+        }
+    }
+
+    delete [] vecCached;
+    delete [] vec;
+    delete cache;
+    delete adas;
+    delete ih;
+    delete uqh;
+    delete grid;
+
+    return success;
+}
+
 /**
  * Run this test.
  */
@@ -179,6 +244,11 @@ bool IonRateEquation::Run(bool) {
     else
         this->PrintError("The ion rate equation does not conserve density.");
 
+    if ((success &= CheckRateCache()))
+        this->PrintOK("The ion rate equation is unchanged by the rate cache.");
+    else
+        this->PrintError("The ion rate equation is changed by the rate cache.");
+
     return success;
 }
 
@@ -19,6 +19,7 @@ namespace DREAMTESTS::_DREAM {
         DREAM::FVM::UnknownQuantityHandler *GetUnknownHandler(DREAM::FVM::Grid*);
 
         bool CheckConservativity();
+        bool CheckRateCache();
         virtual bool Run(bool) override;
     };
 }
@@ -0,0 +1,119 @@
+/**
+ * Test for the bicubic spline with precomputed patch coefficients.
+ */
+
+#include <cmath>
+#include "FVM/Grid/BicubicSpline.hpp"
+#include "BicubicSpline.hpp"
+
+
+using namespace DREAMTESTS::FVM;
+using namespace std;
+
+
+/**
+ * Verify that the spline passes through the given
+ * data in all grid points.
+ */
+bool BicubicSpline::TestGridPoints() {
+    const len_t nx = 7, ny = 9;
+    const real_t tol = 1e-12;
+
+    real_t x[nx], y[ny], z[nx*ny];
+    for (len_t i = 0; i < nx; i++)
+        x[i] = i*i / ((real_t)((nx-1)*(nx-1)));
+    for (len_t j = 0; j < ny; j++)
+        y[j] = 2*M_PI*j / (ny-1);
+    for (len_t j = 0; j < ny; j++)
+        for (len_t i = 0; i < nx; i++)
+            z[j*nx+i] = cos(3*x[i]) * sin(y[j]) + 2*x[i];
+
+    DREAM::FVM::BicubicSpline s(x, nx, y, ny, z);
+
+    for (len_t j = 0; j < ny; j++)
+        for (len_t i = 0; i < nx; i++) {
+            real_t v = s.Eval(x[i], y[j]);
+            real_t Delta = fabs(v - z[j*nx+i]);
+            if (Delta > tol*(1+fabs(z[j*nx+i]))) {
+                this->PrintError(
+                    "Spline does not pass through data point (%zu, %zu). "
+                    "Delta = %e.", i, j, Delta
+                );
+                return false;
+            }
+        }
+
+    return true;
+}
+
+/**
+ * Verify that a bilinear function (which is reproduced exactly by
+ * the natural cubic splines used to estimate the derivatives) is
+ * interpolated exactly, together with its first derivatives, also
+ * when evaluating in consecutive points along a grid line.
+ */
+bool BicubicSpline::TestBilinear() {
+    const len_t nx = 6, ny = 5;
+    const real_t tol = 1e-11;
+
+    const real_t x[nx] = {0, 0.3, 0.5, 1.1, 1.4, 2};
+    const real_t y[ny] = {0, 0.7, 1.0, 2.2, 3};
+    auto f = [](const real_t x, const real_t y) { return 1.5 - 2*x + 0.5*y + 3*x*y; };
+
+    real_t z[nx*ny];
+    for (len_t j = 0; j < ny; j++)
+        for (len_t i = 0; i < nx; i++)
+            z[j*nx+i] = f(x[i], y[j]);
+
+    DREAM::FVM::BicubicSpline s(x, nx, y, ny, z);
+
+    const len_t NX = 23, NY = 41;
+    for (len_t i = 0; i < NX; i++) {
+        real_t xx = 2.0*i / (NX-1);
+        DREAM::FVM::BicubicSpline::point p;
+        for (len_t j = 0; j < NY; j++) {
+            real_t yy = 3.0*j / (NY-1);
+            real_t F, dFdx, dFdy;
+
+            s.Locate(xx, yy, p);
+            s.Eval(p, F, dFdx, dFdy);
+
+            real_t Delta = fabs(F - f(xx, yy))
+                + fabs(dFdx - (-2 + 3*yy))
+                + fabs(dFdy - (0.5 + 3*xx))
+                + fabs(s.Eval(xx, yy) - F);
+
+            if (Delta > tol) {
+                this->PrintError(
+                    "Bilinear function not reproduced at (x, y) = (%.3f, %.3f). "
+                    "Delta = %e.", xx, yy, Delta
+                );
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Run this test.
+ */
+bool BicubicSpline::Run(bool) {
+    bool success = true;
+    if (TestGridPoints())
+        this->PrintOK("Bicubic spline passes through all data points.");
+    else {
+        this->PrintError("Bicubic spline does not pass through all data points.");
+        success = false;
+    }
+
+    if (TestBilinear())
+        this->PrintOK("Bicubic spline reproduces bilinear functions.");
+    else {
+        this->PrintError("Bicubic spline does not reproduce bilinear functions.");
+        success = false;
+    }
+
+    return success;
+}
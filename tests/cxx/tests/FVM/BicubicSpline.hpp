@@ -0,0 +1,19 @@
+#ifndef _DREAMTESTS_FVM_BICUBIC_SPLINE_HPP
+#define _DREAMTESTS_FVM_BICUBIC_SPLINE_HPP
+
+#include "FVM/Grid/BicubicSpline.hpp"
+#include "UnitTest.hpp"
+
+namespace DREAMTESTS::FVM {
+    class BicubicSpline : public UnitTest {
+    public:
+        BicubicSpline(const std::string& name) : UnitTest(name) {}
+
+        bool TestGridPoints();
+        bool TestBilinear();
+
+        virtual bool Run(bool) override;
+    };
+}
+
+#endif/*_DREAMTESTS_FVM_BICUBIC_SPLINE_HPP*/
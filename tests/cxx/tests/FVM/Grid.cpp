@@ -2,6 +2,7 @@
  * Test for the 'Grid' class in the FVM library.
  */
 
+#include <cmath>
 #include "UnitTest.hpp"
 #include "Grid.hpp"
 
@@ -47,6 +48,60 @@ bool Grid::CheckGridRCylPXi() {
     return success;
 }
 
+/**
+ * Check that V' and the bounce averages are given by their
+ * closed-form expressions in cylindrical geometry (where the
+ * magnetic field is uniform on the flux surfaces).
+ */
+bool Grid::CheckUniformFieldAverages() {
+    bool success = true;
+    const real_t tol = 1e-12;
+
+    DREAM::FVM::Grid *grid = this->InitializeGridRCylPXi(4, 5, 6);
+
+    if (grid->HasTrapped()) {
+        this->PrintError("Trapped orbits found in cylindrical geometry.");
+        success = false;
+    }
+
+    const len_t nr = grid->GetNr();
+    for (len_t ir = 0; ir < nr && success; ir++) {
+        DREAM::FVM::MomentumGrid *mg = grid->GetMomentumGrid(ir);
+        const len_t np1 = mg->GetNp1(), np2 = mg->GetNp2();
+        const real_t VpVol = grid->GetVpVol(ir);
+
+        for (len_t j = 0; j < np2 && success; j++) {
+            for (len_t i = 0; i < np1; i++) {
+                const real_t p = mg->GetP1(i);
+                const real_t Vp = 2*M_PI*p*p*VpVol;
+                if (fabs(grid->GetVp(ir, i, j) - Vp) > tol*Vp) {
+                    this->PrintError(
+                        "V' differs from its closed-form value at (ir, i, j) = (" LEN_T_PRINTF_FMT ", "
+                        LEN_T_PRINTF_FMT ", " LEN_T_PRINTF_FMT ").", ir, i, j
+                    );
+                    success = false;
+                    break;
+                }
+
+                // {xi/xi0} = {B^3/Bmin^3} = 1
+                if (fabs(grid->GetBA_xi_f1(ir)[j*(np1+1)+i] - 1) > tol ||
+                    fabs(grid->GetBA_B3_f1(ir)[j*(np1+1)+i] - 1) > tol) {
+                    this->PrintError(
+                        "Bounce average differs from its closed-form value at (ir, i, j) = (" LEN_T_PRINTF_FMT ", "
+                        LEN_T_PRINTF_FMT ", " LEN_T_PRINTF_FMT ").", ir, i, j
+                    );
+                    success = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    delete grid;
+
+    return success;
+}
+
 /**
  * Run all Grid tests.
  * Returns 'true' if all tests passed. 'false' otherwise.
@@ -63,6 +118,11 @@ bool Grid::Run(bool) {
         this->PrintError("Failed to construct a cylindrical r-grid with p/xi momentum grid.");
     }
 
+    if (CheckUniformFieldAverages())
+        this->PrintOK("Bounce averages are evaluated in closed form in cylindrical geometry.");
+    else
+        success = false;
+
     // TODO
     // - Multiple radii, one momentum grid
     // - One radius, full momentum grid
@@ -2,6 +2,7 @@
  * Test for the 1D interpolation object.
  */
 
+#include <cmath>
 #include "FVM/Interpolator1D.hpp"
 #include "Interpolator1D.hpp"
 
@@ -152,6 +153,69 @@ bool Interpolator1D::TestNearest() {
     });
 }
 
+/**
+ * Verify that evaluating an interpolator in a sequence of
+ * monotonically increasing (and occasionally repeated or
+ * decreasing) points, where the interval located in the previous
+ * evaluation is tried first, gives the same result as evaluating
+ * a fresh interpolator in each point. Also verifies that
+ * interpolators sharing their interval index, and evaluating into
+ * a caller-provided buffer, give the same result.
+ */
+bool Interpolator1D::TestCachedIndex() {
+    const len_t nx = 17, nblocks = 3, ntests = 200;
+    const real_t TOL = 10*std::numeric_limits<real_t>::epsilon();
+
+    real_t x[nx], v[nx*nblocks], w[nx*nblocks];
+    for (len_t i = 0; i < nx; i++) {
+        x[i] = i*i / ((real_t)(nx-1));
+        for (len_t j = 0; j < nblocks; j++) {
+            v[i*nblocks + j] = sin(x[i] + j);
+            w[i*nblocks + j] = cos(2*x[i] - j);
+        }
+    }
+
+    DREAM::FVM::Interpolator1D intpv(nx, nblocks, x, v);
+    DREAM::FVM::Interpolator1D intpw(nx, nblocks, x, w);
+    intpw.ShareIndex(&intpv);
+
+    real_t out[nblocks];
+    for (len_t k = 0; k < ntests; k++) {
+        // Step forward, with a few steps back (as when a time
+        // step is rejected) and points outside the grid
+        real_t xv = -0.5 + (x[nx-1]+1) * k / (ntests-1);
+        if (k % 17 == 5)
+            xv -= 1.3;
+
+        DREAM::FVM::Interpolator1D refv(nx, nblocks, x, v);
+        DREAM::FVM::Interpolator1D refw(nx, nblocks, x, w);
+
+        const real_t *a = intpv.Eval(xv);
+        const real_t *b = refv.Eval(xv);
+        for (len_t j = 0; j < nblocks; j++) {
+            if (abs(a[j]-b[j]) > TOL*(1+abs(b[j]))) {
+                this->PrintError(
+                    "Interpolation with cached interval index failed at x = %.4f.", xv
+                );
+                return false;
+            }
+        }
+
+        intpw.Eval(xv, out);
+        b = refw.Eval(xv);
+        for (len_t j = 0; j < nblocks; j++) {
+            if (abs(out[j]-b[j]) > TOL*(1+abs(b[j]))) {
+                this->PrintError(
+                    "Interpolation with shared interval index failed at x = %.4f.", xv
+                );
+                return false;
+            }
+        }
+    }
+
+    return true;
+}
+
 /**
  * Run this test.
  */
@@ -167,6 +231,13 @@ bool Interpolator1D::Run(bool) {
     else
         this->PrintError("1D interpolation with 'linear' method failed.");
 
+    if (TestCachedIndex())
+        this->PrintOK("1D interpolation with cached interval index works.");
+    else {
+        this->PrintError("1D interpolation with cached interval index failed.");
+        success = false;
+    }
+
     return success;
 }
 
@@ -15,6 +15,7 @@ namespace DREAMTESTS::FVM {
             std::function<bool(len_t, len_t, real_t, const real_t*, const real_t*, const real_t*, const std::function<real_t(const real_t, const real_t)>&)>);
         bool TestLinear();
         bool TestNearest();
+        bool TestCachedIndex();
 
         virtual bool Run(bool) override;
     };
@@ -260,6 +260,88 @@ bool Interpolator3D::TestLinear() {
     );
 }
 
+/**
+ * Verify that evaluating the interpolator through a precomputed
+ * stencil gives the same result as evaluating it directly, also
+ * when the stencil is applied to other data on the same grid.
+ */
+bool Interpolator3D::TestStencil(enum DREAM::FVM::Interpolator3D::interp_method meth) {
+    function<real_t(real_t, real_t, real_t)> f =
+        [](real_t x1, real_t x2, real_t x3) { return sin(3*x1) + x2*x3*x3 + cos(x2-x3); };
+    function<real_t(real_t, real_t, real_t)> g =
+        [](real_t x1, real_t x2, real_t x3) { return exp(x1)*(1+x2) - x3; };
+
+    struct gridlimits limits = {0, 1, -1, 1, 0, 1};
+    const len_t nx1 = 10, nx2 = 11, nx3 = 12;
+    struct griddata *gdf = GenerateData(limits, nx1, nx2, nx3, f);
+    struct griddata *gdg = GenerateData(limits, nx1, nx2, nx3, g);
+
+    // Target grid extending somewhat outside the input grid
+    const len_t n1 = 7, n2 = 9, n3 = 8;
+    real_t t1[n1], t2[n2], t3[n3];
+    for (len_t i = 0; i < n1; i++) t1[i] = -0.1 + 1.2*i/(n1-1);
+    for (len_t i = 0; i < n2; i++) t2[i] = -0.95 + 1.9*i/(n2-1);
+    for (len_t i = 0; i < n3; i++) t3[i] = 0.05 + 1.1*i/(n3-1);
+
+    DREAM::FVM::Interpolator3D intpf(
+        nx1, nx2, nx3, gdf->x1, gdf->x2, gdf->x3, gdf->y,
+        DREAM::FVM::Interpolator3D::GRID_PXI, meth
+    );
+    DREAM::FVM::Interpolator3D intpg(
+        nx1, nx2, nx3, gdf->x1, gdf->x2, gdf->x3, gdg->y,
+        DREAM::FVM::Interpolator3D::GRID_PXI, meth, false
+    );
+
+    bool success = true;
+    const real_t TOL = 1e2*std::numeric_limits<real_t>::epsilon();
+    const enum DREAM::FVM::Interpolator3D::momentumgrid_type types[2] = {
+        DREAM::FVM::Interpolator3D::GRID_PXI,
+        DREAM::FVM::Interpolator3D::GRID_PPARPPERP
+    };
+    const len_t N = n1*n2*n3;
+    for (len_t it = 0; it < 2 && success; it++) {
+        DREAM::FVM::Interpolator3D::Stencil *st =
+            intpf.CreateStencil(n1, n2, n3, t1, t2, t3, types[it]);
+
+        const real_t *df = intpf.Eval(n1, n2, n3, t1, t2, t3, types[it]);
+        const real_t *dg = intpg.Eval(n1, n2, n3, t1, t2, t3, types[it]);
+        real_t *sf = new real_t[N], *sg = new real_t[N];
+        intpf.Eval(st, sf);
+        st->Eval(gdg->y, sg);
+
+        for (len_t i = 0; i < N; i++) {
+            real_t Delta = max(
+                abs(sf[i]-df[i]) / (1+abs(df[i])),
+                abs(sg[i]-dg[i]) / (1+abs(dg[i]))
+            );
+            if (Delta > TOL) {
+                this->PrintError(
+                    "Interpolation stencil differs from direct evaluation at "
+                    "element " LEN_T_PRINTF_FMT ". Delta = %e", i, Delta
+                );
+                success = false;
+                break;
+            }
+        }
+
+        delete [] sg;
+        delete [] sf;
+        delete [] dg;
+        delete [] df;
+        delete st;
+    }
+
+    // The arrays of 'gdf' are owned by 'intpf'
+    delete [] gdg->x3;
+    delete [] gdg->x2;
+    delete [] gdg->x1;
+    delete [] gdg->y;
+    delete gdg;
+    delete gdf;
+
+    return success;
+}
+
 /**
  * Run this test.
  */
@@ -280,6 +362,14 @@ bool Interpolator3D::Run(bool) {
         success = false;
     }
 
+    if (TestStencil(DREAM::FVM::Interpolator3D::INTERP_LINEAR) &&
+        TestStencil(DREAM::FVM::Interpolator3D::INTERP_NEAREST)) {
+        this->PrintOK("3D interpolation with precomputed stencils works.");
+    } else {
+        this->PrintError("3D interpolation with precomputed stencils failed.");
+        success = false;
+    }
+
     return success;
 }
 
@@ -31,6 +31,7 @@ namespace DREAMTESTS::FVM {
             std::function<real_t(real_t, real_t, real_t)>
         );
         bool TestLinear();
+        bool TestStencil(enum DREAM::FVM::Interpolator3D::interp_method);
         //bool TestNearest();
 
         virtual bool Run(bool) override;
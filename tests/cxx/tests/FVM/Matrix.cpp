@@ -0,0 +1,288 @@
+/**
+ * Tests for the 'FVM::Matrix' class.
+ */
+
+#include <cmath>
+#include <limits>
+#include <vector>
+#include "FVM/Matrix.hpp"
+#include "Matrix.hpp"
+
+
+using namespace DREAMTESTS::FVM;
+using namespace std;
+
+
+/**
+ * Set the elements of a banded test matrix.
+ *
+ * mat:   Matrix to set elements of.
+ * n:     Number of rows (and columns) of the matrix.
+ * iter:  Index of assembly (determines the element values).
+ * extra: If true, also sets elements outside of the band.
+ */
+void Matrix::SetElements(DREAM::FVM::Matrix *mat, const len_t n, const len_t iter, const bool extra) {
+    for (len_t i = 0; i < n; i++) {
+        for (len_t j = (i<2 ? 0 : i-2); j < n && j <= i+2; j++) {
+            // Let some elements vanish in some assemblies, and
+            // add several contributions to others
+            real_t v = sin(1.0 + i + 3*j + 7*iter);
+            if ((i+j+iter) % 5 == 0)
+                v = 0;
+
+            mat->SetElement(i, j, v);
+            if (i == j)
+                mat->SetElement(i, j, 0.5*v);
+        }
+
+        if (extra && i+4 < n)
+            mat->SetElement(i, i+4, cos(1.0 + i + iter));
+    }
+}
+
+/**
+ * Verify that a matrix assembled using direct assembly is identical
+ * to the same matrix assembled through PETSc, also when the pattern
+ * of elements set changes between assemblies.
+ */
+bool Matrix::TestDirectAssembly() {
+    const len_t n = 20;
+    const len_t nIter = 6;
+
+    DREAM::FVM::Matrix *ref = new DREAM::FVM::Matrix(n, n, 6);
+    DREAM::FVM::Matrix *dir = new DREAM::FVM::Matrix(n, n, 6);
+    dir->SetDirectAssembly(true);
+
+    bool success = true;
+    for (len_t iter = 0; iter < nIter && success; iter++) {
+        const bool extra = (iter == 3);
+
+        ref->Zero();
+        dir->Zero();
+
+        SetElements(ref, n, iter, extra);
+        SetElements(dir, n, iter, extra);
+
+        ref->Assemble();
+        dir->Assemble();
+
+        for (len_t i = 0; i < n && success; i++) {
+            for (len_t j = 0; j < n; j++) {
+                real_t a = ref->GetElement(i, j);
+                real_t b = dir->GetElement(i, j);
+
+                if (a != b) {
+                    this->PrintError(
+                        "Assembly %zu: element (%zu, %zu) differs with direct "
+                        "assembly. Expected %e, got %e.", iter, i, j, a, b
+                    );
+                    success = false;
+                    break;
+                }
+            }
+        }
+    }
+
+    delete dir;
+    delete ref;
+
+    return success;
+}
+
+/**
+ * Verify that the matrix-vector products agree with products
+ * evaluated from the individual matrix elements, also when the
+ * work vectors are reused for several multiplications.
+ */
+bool Matrix::TestMultiply() {
+    const len_t n = 20, nVectors = 3;
+    const real_t alpha = 1.5, beta = -0.25;
+
+    DREAM::FVM::Matrix *mat = new DREAM::FVM::Matrix(n, n, 6);
+    SetElements(mat, n, 1, true);
+    mat->Assemble();
+
+    real_t x[nVectors][n], y[nVectors][n], y0[nVectors][n];
+    real_t *px[nVectors], *py[nVectors];
+    for (len_t k = 0; k < nVectors; k++) {
+        for (len_t i = 0; i < n; i++) {
+            x[k][i] = cos(2.0 + i + 5*k);
+            y[k][i] = y0[k][i] = sin(3.0*i + k);
+        }
+        px[k] = x[k];
+        py[k] = y[k];
+    }
+
+    mat->Multiply(nVectors, px, py, alpha, beta);
+
+    bool success = true;
+    for (len_t k = 0; k < nVectors && success; k++) {
+        for (len_t i = 0; i < n; i++) {
+            real_t Ax = 0;
+            for (len_t j = 0; j < n; j++)
+                Ax += mat->GetElement(i, j) * x[k][j];
+
+            const real_t expected = alpha*Ax + beta*y0[k][i];
+            if (fabs(y[k][i] - expected) > 1e-14*(1 + fabs(expected))) {
+                this->PrintError(
+                    "Vector %zu: element %zu of product differs. Expected %e, got %e.",
+                    k, i, expected, y[k][i]
+                );
+                success = false;
+                break;
+            }
+        }
+    }
+
+    delete mat;
+
+    return success;
+}
+
+/**
+ * Verify that the first non-finite element set in a matrix is
+ * detected (with its global indices), and that the record is
+ * cleared when the matrix is zeroed.
+ */
+bool Matrix::TestNonFinite() {
+    const len_t n = 10;
+
+    DREAM::FVM::Matrix *mat = new DREAM::FVM::Matrix(n, n, 6);
+    SetElements(mat, n, 1, true);
+
+    bool success = true;
+    if (mat->HasNonFiniteElement()) {
+        this->PrintError("Non-finite element detected in finite matrix.");
+        success = false;
+    }
+
+    PetscInt I, J;
+    mat->SetOffset(2, 3);
+    mat->SetElement(4, 1, std::numeric_limits<real_t>::quiet_NaN());
+    mat->SetElement(5, 2, std::numeric_limits<real_t>::infinity());
+    mat->ResetOffset();
+    if (!mat->HasNonFiniteElement(&I, &J)) {
+        this->PrintError("NaN element was not detected.");
+        success = false;
+    } else if (I != 6 || J != 4) {
+        this->PrintError(
+            "Wrong location of first non-finite element: (%lld, %lld).",
+            (long long)I, (long long)J
+        );
+        success = false;
+    }
+
+    mat->Assemble();
+    mat->Zero();
+    if (mat->HasNonFiniteElement()) {
+        this->PrintError("Non-finite element still recorded after zeroing matrix.");
+        success = false;
+    }
+
+    delete mat;
+
+    return success;
+}
+
+/**
+ * Verify that only the rows selected by the row mask are assembled
+ * (with and without direct assembly), and that the full matrix can
+ * be assembled again, within the same non-zero structure, after the
+ * mask has been removed.
+ */
+bool Matrix::TestRowMask() {
+    const len_t n = 20;
+
+    vector<char> mask(n, 0);
+    for (len_t i = 5; i < 12; i++)
+        mask[i] = 1;
+
+    DREAM::FVM::Matrix *ref = new DREAM::FVM::Matrix(n, n, 6);
+    SetElements(ref, n, 1, false);
+    ref->Assemble();
+
+    bool success = true;
+    for (const bool direct : {false, true}) {
+        DREAM::FVM::Matrix *mat = new DREAM::FVM::Matrix(n, n, 6);
+        mat->SetDirectAssembly(direct);
+
+        // First assembly determines the full non-zero structure
+        SetElements(mat, n, 1, false);
+        mat->Assemble();
+        const len_t nnz = mat->GetNNZ();
+
+        for (len_t iter = 0; iter < 3 && success; iter++) {
+            // Assemble masked in the first two iterations, then in full
+            const bool masked = (iter < 2);
+            mat->SetRowMask(masked ? &mask : nullptr);
+            mat->Zero();
+            SetElements(mat, n, 1, false);
+            mat->Assemble();
+
+            if (mat->GetNNZ() != nnz) {
+                this->PrintError(
+                    "Number of non-zeros changed from %zu to %zu.",
+                    nnz, mat->GetNNZ()
+                );
+                success = false;
+            }
+
+            for (len_t i = 0; i < n && success; i++) {
+                for (len_t j = 0; j < n; j++) {
+                    const real_t expected = (masked && !mask[i] ? 0 : ref->GetElement(i, j));
+                    const real_t v = mat->GetElement(i, j);
+                    if (v != expected) {
+                        this->PrintError(
+                            "Assembly %zu%s: element (%zu, %zu) is %e (expected %e).",
+                            iter, (direct ? " (direct)" : ""), i, j, v, expected
+                        );
+                        success = false;
+                        break;
+                    }
+                }
+            }
+        }
+
+        delete mat;
+    }
+
+    delete ref;
+
+    return success;
+}
+
+/**
+ * Run this test.
+ */
+bool Matrix::Run(bool) {
+    bool success = true;
+    if (TestDirectAssembly())
+        this->PrintOK("Direct matrix assembly gives identical matrices.");
+    else {
+        this->PrintError("Direct matrix assembly gives different matrices.");
+        success = false;
+    }
+
+    if (TestMultiply())
+        this->PrintOK("Matrix-vector products are correct.");
+    else {
+        this->PrintError("Matrix-vector products are incorrect.");
+        success = false;
+    }
+
+    if (TestNonFinite())
+        this->PrintOK("Non-finite matrix elements are detected.");
+    else {
+        this->PrintError("Non-finite matrix elements are not detected.");
+        success = false;
+    }
+
+    if (TestRowMask())
+        this->PrintOK("Row masks restrict the assembled rows.");
+    else {
+        this->PrintError("Row masks do not restrict the assembled rows.");
+        success = false;
+    }
+
+    return success;
+}
@@ -0,0 +1,22 @@
+#ifndef _DREAMTESTS_FVM_MATRIX_HPP
+#define _DREAMTESTS_FVM_MATRIX_HPP
+
+#include "FVM/Matrix.hpp"
+#include "UnitTest.hpp"
+
+namespace DREAMTESTS::FVM {
+    class Matrix : public UnitTest {
+    public:
+        Matrix(const std::string& name) : UnitTest(name) {}
+
+        void SetElements(DREAM::FVM::Matrix*, const len_t, const len_t, const bool);
+        bool TestDirectAssembly();
+        bool TestMultiply();
+        bool TestNonFinite();
+        bool TestRowMask();
+
+        virtual bool Run(bool) override;
+    };
+}
+
+#endif/*_DREAMTESTS_FVM_MATRIX_HPP*/
@@ -0,0 +1,162 @@
+/**
+ * Test of the conservative mapping between two p-xi momentum grids,
+ * used for coupling radii with different momentum grids.
+ */
+
+#include <cmath>
+#include <vector>
+#include "FVM/Grid/MomentumGridMapping.hpp"
+#include "MomentumGridMapping.hpp"
+
+
+using namespace DREAMTESTS::FVM;
+using namespace std;
+
+
+/**
+ * Verify that the projection weights W of every cell of the grid
+ * mapped to, and the distribution weights R of every cell of the
+ * grid mapped from, sum to one.
+ *
+ * np1, nxi1: Size of the grid mapped from.
+ * np2, nxi2: Size of the grid mapped to.
+ */
+bool MomentumGridMapping::CheckWeights(
+    const len_t np1, const len_t nxi1, const len_t np2, const len_t nxi2
+) {
+    const real_t tol = 1e-12;
+    DREAM::FVM::Grid *g1 = this->InitializeGridRCylPXi(1, np1, nxi1);
+    DREAM::FVM::Grid *g2 = this->InitializeGridRCylPXi(1, np2, nxi2);
+    DREAM::FVM::MomentumGridMapping map(g1->GetMomentumGrid(0), g2->GetMomentumGrid(0));
+
+    bool success = true;
+    vector<real_t> sumR(np1*nxi1, 0.0);
+    for (len_t j = 0; j < nxi2 && success; j++)
+        for (len_t i = 0; i < np2 && success; i++) {
+            real_t sumW = 0;
+            map.ForEachOverlap(i, j, [&sumW,&sumR,np1](const len_t a, const len_t b, const real_t W, const real_t R) {
+                sumW += W;
+                sumR[b*np1+a] += R;
+            });
+
+            if (fabs(sumW-1) > tol) {
+                this->PrintError(
+                    "Projection weights of cell (%zu, %zu) sum to %.12e.", i, j, sumW
+                );
+                success = false;
+            }
+        }
+
+    for (len_t k = 0; k < np1*nxi1 && success; k++)
+        if (fabs(sumR[k]-1) > tol) {
+            this->PrintError(
+                "Distribution weights of cell %zu sum to %.12e.", k, sumR[k]
+            );
+            success = false;
+        }
+
+    delete g2;
+    delete g1;
+
+    return success;
+}
+
+/**
+ * Verify that distributing a quantity given on one grid over the
+ * cells of another grid, using the weights R, conserves the momentum
+ * space integral of the quantity, and that projecting it back with
+ * the weights W recovers a constant function.
+ *
+ * np1, nxi1: Size of the grid mapped from.
+ * np2, nxi2: Size of the grid mapped to.
+ */
+bool MomentumGridMapping::CheckConservation(
+    const len_t np1, const len_t nxi1, const len_t np2, const len_t nxi2
+) {
+    const real_t tol = 1e-12;
+    DREAM::FVM::Grid *g1 = this->InitializeGridRCylPXi(1, np1, nxi1);
+    DREAM::FVM::Grid *g2 = this->InitializeGridRCylPXi(1, np2, nxi2);
+    const DREAM::FVM::MomentumGrid *mg1 = g1->GetMomentumGrid(0), *mg2 = g2->GetMomentumGrid(0);
+    DREAM::FVM::MomentumGridMapping map(mg1, mg2);
+
+    // Momentum-space volume of a cell
+    auto volume = [](const DREAM::FVM::MomentumGrid *mg, const len_t i, const len_t j) {
+        const real_t p0 = mg->GetP1_f(i), p1 = mg->GetP1_f(i+1);
+        return (p1*p1*p1 - p0*p0*p0)/3 * mg->GetDp2(j);
+    };
+
+    // Number of particles in each cell of 'mg1'
+    real_t N1 = 0;
+    vector<real_t> n1(np1*nxi1);
+    for (len_t j = 0; j < nxi1; j++)
+        for (len_t i = 0; i < np1; i++) {
+            n1[j*np1+i] = (1 + i + 3*j) * volume(mg1, i, j);
+            N1 += n1[j*np1+i];
+        }
+
+    // Distribute over the cells of 'mg2'
+    real_t N2 = 0;
+    for (len_t j = 0; j < nxi2; j++)
+        for (len_t i = 0; i < np2; i++)
+            map.ForEachOverlap(i, j, [&N2,&n1,np1](const len_t a, const len_t b, const real_t, const real_t R) {
+                N2 += R * n1[b*np1+a];
+            });
+
+    bool success = true;
+    if (fabs(N2-N1) > tol*fabs(N1)) {
+        this->PrintError(
+            "Particle number not conserved by mapping: %.12e vs. %.12e.", N2, N1
+        );
+        success = false;
+    }
+
+    // Constant functions should be projected exactly
+    vector<real_t> one(np1*nxi1, 1.0), out(np2*nxi2);
+    map.Interpolate(one.data(), out.data());
+    for (len_t k = 0; k < np2*nxi2 && success; k++)
+        if (fabs(out[k]-1) > tol) {
+            this->PrintError("Constant function not projected exactly: f = %.12e.", out[k]);
+            success = false;
+        }
+
+    delete g2;
+    delete g1;
+
+    return success;
+}
+
+/**
+ * Run this test.
+ */
+bool MomentumGridMapping::Run(bool) {
+    bool success = true;
+
+    // (coarser, finer and non-nested resolutions)
+    const len_t sizes[][4] = {
+        {8, 10, 4, 5},
+        {4, 5, 8, 10},
+        {7, 9, 5, 4},
+        {6, 6, 6, 6}
+    };
+
+    for (auto s : sizes) {
+        if (!CheckWeights(s[0], s[1], s[2], s[3])) {
+            this->PrintError(
+                "Invalid mapping weights from %zux%zu to %zux%zu grid.", s[0], s[1], s[2], s[3]
+            );
+            success = false;
+        }
+
+        if (!CheckConservation(s[0], s[1], s[2], s[3])) {
+            this->PrintError(
+                "Mapping from %zux%zu to %zux%zu grid is not conservative.", s[0], s[1], s[2], s[3]
+            );
+            success = false;
+        }
+    }
+
+    if (success)
+        this->PrintOK("Momentum grid mappings are conservative.");
+
+    return success;
+}
@@ -0,0 +1,19 @@
+#ifndef _DREAMTESTS_FVM_MOMENTUM_GRID_MAPPING_HPP
+#define _DREAMTESTS_FVM_MOMENTUM_GRID_MAPPING_HPP
+
+#include "FVM/Grid/MomentumGridMapping.hpp"
+#include "UnitTest.hpp"
+
+namespace DREAMTESTS::FVM {
+    class MomentumGridMapping : public UnitTest {
+    public:
+        MomentumGridMapping(const std::string& name) : UnitTest(name) {}
+
+        bool CheckWeights(const len_t, const len_t, const len_t, const len_t);
+        bool CheckConservation(const len_t, const len_t, const len_t, const len_t);
+
+        virtual bool Run(bool) override;
+    };
+}
+
+#endif/*_DREAMTESTS_FVM_MOMENTUM_GRID_MAPPING_HPP*/
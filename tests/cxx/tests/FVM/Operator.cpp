@@ -0,0 +1,120 @@
+/**
+ * Test of the 'Operator' class, in particular of the assembly of
+ * diagonal terms together into a single diagonal.
+ */
+
+#include <cmath>
+#include <vector>
+#include "FVM/Equation/DiagonalLinearTerm.hpp"
+#include "FVM/Equation/IdentityTerm.hpp"
+#include "FVM/Equation/Operator.hpp"
+#include "Operator.hpp"
+
+
+using namespace DREAMTESTS::FVM;
+using namespace std;
+
+
+namespace {
+    // Diagonal term with weights varying from cell to cell
+    class VaryingDiagonalTerm : public DREAM::FVM::DiagonalLinearTerm {
+    protected:
+        virtual void SetWeights() override {
+            for (len_t i = 0; i < grid->GetNCells(); i++)
+                weights[i] = 1.0 / (1.0 + i);
+        }
+    public:
+        VaryingDiagonalTerm(DREAM::FVM::Grid *g) : DiagonalLinearTerm(g) {}
+    };
+}
+
+
+/**
+ * Verify that diagonal terms are only assembled together when
+ * an operator has at least two of them.
+ */
+bool Operator::CheckGrouping() {
+    DREAM::FVM::Grid *grid = this->InitializeFluidGrid(5);
+    DREAM::FVM::Operator op(grid);
+
+    op.AddTerm(new DREAM::FVM::IdentityTerm(grid, 2.0));
+    if (op.GetNFusedDiagonalTerms() != 0) {
+        this->PrintError("A single diagonal term was assembled as a group.");
+        return false;
+    }
+
+    op.AddTerm(new DREAM::FVM::IdentityTerm(grid, 3.0));
+    if (op.GetNFusedDiagonalTerms() != 2) {
+        this->PrintError(
+            "Expected 2 diagonal terms to be assembled together, found " LEN_T_PRINTF_FMT ".",
+            op.GetNFusedDiagonalTerms()
+        );
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Verify that the function vector of an operator consisting of
+ * several diagonal terms (assembled together) equals the sum of
+ * the function vectors of the individual terms.
+ */
+bool Operator::CheckFusedDiagonal() {
+    const real_t tol = 1e-13;
+    DREAM::FVM::Grid *grid = this->InitializeGridRCylPXi(3, 8, 6);
+    const len_t N = grid->GetNCells();
+
+    DREAM::FVM::Operator op(grid);
+    vector<DREAM::FVM::DiagonalLinearTerm*> terms = {
+        new DREAM::FVM::IdentityTerm(grid, 2.0),
+        new VaryingDiagonalTerm(grid),
+        new DREAM::FVM::IdentityTerm(grid, -0.5)
+    };
+    for (auto t : terms)
+        op.AddTerm(t);
+
+    op.RebuildTerms(0, 1, nullptr);
+
+    vector<real_t> x(N), vOp(N, 0), vRef(N, 0);
+    for (len_t i = 0; i < N; i++)
+        x[i] = sin(0.1*i) + 2;
+
+    op.SetVectorElements(vOp.data(), x.data());
+    for (auto t : terms)
+        t->SetVectorElements(vRef.data(), x.data());
+
+    for (len_t i = 0; i < N; i++) {
+        if (fabs(vOp[i] - vRef[i]) > tol*fabs(vRef[i])) {
+            this->PrintError(
+                "Element " LEN_T_PRINTF_FMT " of the operator differs from the sum of its terms: "
+                "%.12e vs. %.12e.", i, vOp[i], vRef[i]
+            );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Run this test.
+ */
+bool Operator::Run(bool) {
+    bool success = true;
+    if (CheckGrouping())
+        this->PrintOK("Diagonal terms are grouped correctly.");
+    else {
+        this->PrintError("Diagonal terms are not grouped correctly.");
+        success = false;
+    }
+
+    if (CheckFusedDiagonal())
+        this->PrintOK("Diagonal terms assembled together evaluate correctly.");
+    else {
+        this->PrintError("Diagonal terms assembled together do not evaluate correctly.");
+        success = false;
+    }
+
+    return success;
+}
@@ -0,0 +1,19 @@
+#ifndef _DREAMTESTS_FVM_OPERATOR_HPP
+#define _DREAMTESTS_FVM_OPERATOR_HPP
+
+#include "FVM/Equation/Operator.hpp"
+#include "UnitTest.hpp"
+
+namespace DREAMTESTS::FVM {
+    class Operator : public UnitTest {
+    public:
+        Operator(const std::string& name) : UnitTest(name) {}
+
+        bool CheckGrouping();
+        bool CheckFusedDiagonal();
+
+        virtual bool Run(bool) override;
+    };
+}
+
+#endif/*_DREAMTESTS_FVM_OPERATOR_HPP*/
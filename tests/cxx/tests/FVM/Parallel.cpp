@@ -0,0 +1,214 @@
+/**
+ * Test for the helpers used in the thread-parallel parts of DREAM.
+ */
+
+#include <atomic>
+#include <cmath>
+#include <vector>
+#include "FVM/FVMException.hpp"
+#include "FVM/Parallel.hpp"
+#include "Parallel.hpp"
+
+
+using namespace DREAMTESTS::FVM;
+using namespace std;
+
+
+/**
+ * Verify that an exception thrown by one of the tasks is
+ * propagated to the caller (and that all other tasks are
+ * still evaluated).
+ */
+bool Parallel::TestExceptions() {
+    const len_t n = 100;
+    vector<char> done(n, 0);
+
+    try {
+        DREAM::FVM::Parallel::For(n, 4, [&done](const len_t i) {
+            if (i == 17)
+                throw DREAM::FVM::FVMException("Task %zu failed.", i);
+            done[i] = 1;
+        });
+    } catch (DREAM::FVM::FVMException&) {
+        for (len_t i = 0; i < n; i++)
+            if (i != 17 && !done[i]) {
+                this->PrintError("Task %zu was not evaluated.", i);
+                return false;
+            }
+
+        return true;
+    }
+
+    this->PrintError("The exception thrown by a task was not propagated.");
+    return false;
+}
+
+/**
+ * Verify that every task is evaluated exactly once.
+ */
+bool Parallel::TestFor() {
+    const len_t n = 1000;
+    vector<len_t> count(n, 0);
+
+    for (len_t nThreads = 1; nThreads <= 4; nThreads++) {
+        DREAM::FVM::Parallel::For(n, nThreads, [&count](const len_t i) {
+            count[i]++;
+        });
+    }
+
+    for (len_t i = 0; i < n; i++)
+        if (count[i] != 4) {
+            this->PrintError("Task %zu was evaluated %zu times (expected 4).", i, count[i]);
+            return false;
+        }
+
+    return true;
+}
+
+/**
+ * Verify that every task is evaluated exactly once by 'ForWithScratch()',
+ * that no scratch object is used by two tasks at the same time, and that
+ * at most one scratch object is constructed per thread.
+ */
+bool Parallel::TestScratch() {
+    struct scratch {
+        std::atomic<int> users;
+        std::atomic<len_t> *nConstructed;
+
+        scratch(std::atomic<len_t> *n) : users(0), nConstructed(n) { (*n)++; }
+    };
+
+    const len_t n = 1000;
+    for (len_t nThreads = 1; nThreads <= 4; nThreads++) {
+        vector<len_t> count(n, 0);
+        std::atomic<len_t> nConstructed(0);
+        std::atomic<bool> shared(false);
+
+        DREAM::FVM::Parallel::ForWithScratch<scratch>(n, nThreads, [&](const len_t i, scratch &s) {
+            if (s.users++ != 0)
+                shared = true;
+            count[i]++;
+            s.users--;
+        }, &nConstructed);
+
+        for (len_t i = 0; i < n; i++)
+            if (count[i] != 1) {
+                this->PrintError("Task %zu was evaluated %zu times (expected 1).", i, count[i]);
+                return false;
+            }
+
+        if (shared) {
+            this->PrintError("A scratch object was used by two tasks at the same time.");
+            return false;
+        } else if (nConstructed > nThreads) {
+            this->PrintError(
+                "%zu scratch objects were constructed on %zu threads.",
+                (len_t)nConstructed, nThreads
+            );
+            return false;
+        }
+    }
+
+    return true;
+}
+
+/**
+ * Verify that sums are bitwise identical regardless of the
+ * number of threads used (and agree with a serial sum up to
+ * round-off).
+ */
+bool Parallel::TestSum() {
+    const len_t n = 100007;
+    auto blockSum = [](const len_t i0, const len_t i1) {
+        // Terms of varying magnitude and sign, for which the
+        // round-off error depends on the order of summation
+        real_t s = 0;
+        for (len_t i = i0; i < i1; i++)
+            s += (i%2 == 0 ? 1.0 : -1.0) / (1.0 + i*i*1e-3);
+        return s;
+    };
+
+    const real_t s1 = DREAM::FVM::Parallel::Sum(n, 1, 0.0, blockSum);
+    const real_t sSerial = blockSum(0, n);
+    if (fabs(s1-sSerial) > 1e-12*fabs(sSerial)) {
+        this->PrintError(
+            "Sum differs from the serial sum: %.16e != %.16e.",
+            s1, sSerial
+        );
+        return false;
+    }
+
+    for (len_t nThreads = 2; nThreads <= 8; nThreads++) {
+        const real_t s = DREAM::FVM::Parallel::Sum(n, nThreads, 0.0, blockSum);
+        if (s != s1) {
+            this->PrintError(
+                "Sum evaluated on %zu threads differs from the sum on one thread: %.16e != %.16e.",
+                nThreads, s, s1
+            );
+            return false;
+        }
+    }
+
+    // Sums with fewer terms than a block are evaluated by a single call
+    const len_t nShort = DREAM::FVM::Parallel::SUM_BLOCK_SIZE-1;
+    if (DREAM::FVM::Parallel::Sum(nShort, 4, 0.0, blockSum) != blockSum(0, nShort)) {
+        this->PrintError("Short sums differ from the serial sum.");
+        return false;
+    }
+
+    // Outside of the reproducible mode, the sum only agrees up to round-off
+    DREAM::FVM::Parallel::SetReproducible(false);
+    bool success = true;
+    for (len_t nThreads = 1; nThreads <= 8 && success; nThreads++) {
+        const real_t s = DREAM::FVM::Parallel::Sum(n, nThreads, 0.0, blockSum);
+        if (fabs(s-sSerial) > 1e-12*fabs(sSerial)) {
+            this->PrintError(
+                "Unordered sum evaluated on %zu threads differs from the serial sum: %.16e != %.16e.",
+                nThreads, s, sSerial
+            );
+            success = false;
+        }
+    }
+    DREAM::FVM::Parallel::SetReproducible(true);
+
+    if (!success)
+        return false;
+
+    return true;
+}
+
+/**
+ * Run this test.
+ */
+bool Parallel::Run(bool) {
+    bool success = true;
+    if (TestFor())
+        this->PrintOK("Parallel loops evaluate every task once.");
+    else {
+        this->PrintError("Parallel loops do not evaluate every task once.");
+        success = false;
+    }
+
+    if (TestExceptions())
+        this->PrintOK("Exceptions are propagated out of parallel loops.");
+    else {
+        this->PrintError("Exceptions are not propagated out of parallel loops.");
+        success = false;
+    }
+
+    if (TestScratch())
+        this->PrintOK("Scratch objects are never shared between threads.");
+    else {
+        this->PrintError("Scratch objects are shared between threads.");
+        success = false;
+    }
+
+    if (TestSum())
+        this->PrintOK("Parallel sums are independent of the number of threads.");
+    else {
+        this->PrintError("Parallel sums depend on the number of threads.");
+        success = false;
+    }
+
+    return success;
+}
@@ -0,0 +1,21 @@
+#ifndef _DREAMTESTS_FVM_PARALLEL_HPP
+#define _DREAMTESTS_FVM_PARALLEL_HPP
+
+#include "FVM/Parallel.hpp"
+#include "UnitTest.hpp"
+
+namespace DREAMTESTS::FVM {
+    class Parallel : public UnitTest {
+    public:
+        Parallel(const std::string& name) : UnitTest(name) {}
+
+        bool TestExceptions();
+        bool TestFor();
+        bool TestScratch();
+        bool TestSum();
+
+        virtual bool Run(bool) override;
+    };
+}
+
+#endif/*_DREAMTESTS_FVM_PARALLEL_HPP*/
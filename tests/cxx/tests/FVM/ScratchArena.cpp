@@ -0,0 +1,98 @@
+/**
+ * Test for the scratch arena used for temporary arrays in equation terms.
+ */
+
+#include <cstdint>
+#include "FVM/ScratchArena.hpp"
+#include "ScratchArena.hpp"
+
+
+using namespace DREAMTESTS::FVM;
+using namespace std;
+
+
+/**
+ * Verify that arrays allocated within the same iteration are
+ * aligned and do not overlap, also when the first block of the
+ * arena is exhausted.
+ */
+bool ScratchArena::TestDisjoint() {
+    DREAM::FVM::ScratchArena &arena = DREAM::FVM::ScratchArena::Get();
+    DREAM::FVM::ScratchArena::NextIteration();
+
+    const len_t nArrays = 40, n = 3001;
+    real_t *a[nArrays];
+    for (len_t k = 0; k < nArrays; k++) {
+        a[k] = arena.Allocate<real_t>(n + k);
+        if (((uintptr_t)a[k]) % alignof(std::max_align_t) != 0) {
+            this->PrintError("Array %zu is not correctly aligned.", k);
+            return false;
+        }
+
+        for (len_t i = 0; i < n+k; i++)
+            a[k][i] = k;
+    }
+
+    for (len_t k = 0; k < nArrays; k++)
+        for (len_t i = 0; i < n+k; i++)
+            if (a[k][i] != k) {
+                this->PrintError("Array %zu was overwritten by another array.", k);
+                return false;
+            }
+
+    return true;
+}
+
+/**
+ * Verify that the memory of the previous iteration is reused
+ * without new heap allocations once the arena has grown to the
+ * size needed in each iteration.
+ */
+bool ScratchArena::TestReuse() {
+    DREAM::FVM::ScratchArena &arena = DREAM::FVM::ScratchArena::Get();
+
+    const len_t n = 100000;
+    auto iterate = [&arena]() {
+        DREAM::FVM::ScratchArena::NextIteration();
+        for (len_t k = 0; k < 5; k++)
+            arena.Allocate<real_t>(n);
+    };
+
+    // Let the arena grow to its final size
+    iterate();
+    iterate();
+
+    len_t nAlloc = DREAM::FVM::ScratchArena::GetNHeapAllocations();
+    for (len_t it = 0; it < 10; it++)
+        iterate();
+
+    len_t nNew = DREAM::FVM::ScratchArena::GetNHeapAllocations() - nAlloc;
+    if (nNew != 0) {
+        this->PrintError("%zu heap allocations were made in iterations of constant size.", nNew);
+        return false;
+    }
+
+    return true;
+}
+
+/**
+ * Run this test.
+ */
+bool ScratchArena::Run(bool) {
+    bool success = true;
+    if (TestDisjoint())
+        this->PrintOK("Scratch arrays are aligned and disjoint.");
+    else {
+        this->PrintError("Scratch arrays are not aligned and disjoint.");
+        success = false;
+    }
+
+    if (TestReuse())
+        this->PrintOK("Scratch memory is reused between iterations.");
+    else {
+        this->PrintError("Scratch memory is not reused between iterations.");
+        success = false;
+    }
+
+    return success;
+}
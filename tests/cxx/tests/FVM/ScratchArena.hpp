@@ -0,0 +1,19 @@
+#ifndef _DREAMTESTS_FVM_SCRATCH_ARENA_HPP
+#define _DREAMTESTS_FVM_SCRATCH_ARENA_HPP
+
+#include "FVM/ScratchArena.hpp"
+#include "UnitTest.hpp"
+
+namespace DREAMTESTS::FVM {
+    class ScratchArena : public UnitTest {
+    public:
+        ScratchArena(const std::string& name) : UnitTest(name) {}
+
+        bool TestDisjoint();
+        bool TestReuse();
+
+        virtual bool Run(bool) override;
+    };
+}
+
+#endif/*_DREAMTESTS_FVM_SCRATCH_ARENA_HPP*/
@@ -0,0 +1,324 @@
+#!/usr/bin/env python3
+#
+# Performance regression harness for DREAM.
+#
+# Runs a curated subset of the examples in 'examples/' at fixed
+# resolutions and collects the timing information recorded by the
+# kernel, the number of Newton iterations taken, the peak resident
+# set size of 'dreami' and the size of the output file. The results
+# are compared against a stored baseline, and any quantity exceeding
+# its tolerance band is flagged as a regression.
+#
+# Run as
+#
+#   $ tests/performance/runperf.py all
+#   $ tests/performance/runperf.py --save-baseline all
+#
+# Baselines are machine specific, and should therefore be generated
+# (with '--save-baseline') on the machine used for the comparison,
+# from a DREAM version which is known to be good.
+#
+# ###################################################################
+
+import argparse
+import json
+import os
+import pathlib
+import shutil
+import subprocess
+import sys
+import tempfile
+import time
+
+ROOT = (pathlib.Path(__file__).parent / '..' / '..').resolve().absolute()
+
+try:
+    import DREAM
+except ImportError:
+    sys.path.append(str(ROOT / 'py'))
+    import DREAM
+
+from DREAM.DREAMSettings import DREAMSettings
+from DREAM.DREAMOutput import DREAMOutput
+
+
+# Benchmark cases. Each case names an example script (relative to
+# 'examples/') which generates the settings file 'settings', and
+# the resolution to run it at. Only examples which generate a single
+# settings file (without running 'dreami' themselves) can be used.
+CASES = {
+    'basic': {
+        'script': 'basic/basic.py', 'settings': 'dream_settings.h5',
+        'nr': 10, 'hottail': (100, 30), 'nt': 4
+    },
+    '2kinetic': {
+        'script': '2kinetic/generate.py', 'settings': 'dream_settings.h5',
+        'nr': 1, 'hottail': (200, 30), 'runaway': (400, 30), 'nt': 10
+    },
+    'fluid-kinetic': {
+        'script': 'fluid-kinetic/generate.py', 'settings': 'dream_settings.h5',
+        'nr': 1, 'nt': 20
+    },
+    'runaway': {
+        'script': 'runaway/basic.py', 'settings': 'dream_settings.h5',
+        'nr': 1, 'hottail': (100, 20), 'nt': 20
+    },
+    'transport-re': {
+        'script': 'transport-re/generate.py', 'settings': 'dream_settings.h5',
+        'nr': 10, 'runaway': (60, 20), 'nt': 20
+    }
+}
+
+# Relative tolerance bands for each measured quantity. A quantity is
+# flagged as a regression if it exceeds the baseline value by more
+# than the given fraction.
+TOLERANCES = {
+    'wall':       0.25,
+    'total':      0.25,
+    'iterations': 0.10,
+    'peak_rss':   0.20,
+    'outputsize': 0.05
+}
+
+DEFAULT_BASELINE = pathlib.Path(__file__).parent / 'baseline.json'
+
+
+def print_ok(msg):
+    print("\x1B[1;32m[OK]\x1B[0m      --> {}".format(msg))
+
+
+def print_warning(msg):
+    print("\x1B[1;33m[WARNING]\x1B[0m --> {}".format(msg))
+
+
+def print_error(msg):
+    print("\x1B[1;31m[ERROR]\x1B[0m   --> {}".format(msg))
+
+
+def generateSettings(name, case, workdir):
+    """
+    Run the example script of the named case in 'workdir' and load
+    the settings it generates, overriding the resolution with the
+    one specified for the case.
+    """
+    script = ROOT / 'examples' / case['script']
+
+    env = dict(os.environ)
+    env['PYTHONPATH'] = str(ROOT / 'py') + os.pathsep + env.get('PYTHONPATH', '')
+    env['MPLBACKEND'] = 'Agg'
+
+    subprocess.run([sys.executable, str(script)], cwd=workdir, env=env,
+        check=True, stdout=subprocess.DEVNULL)
+
+    ds = DREAMSettings(os.path.join(workdir, case['settings']), chain=False)
+
+    ds.radialgrid.setNr(case['nr'])
+    if 'hottail' in case and ds.hottailgrid.enabled:
+        ds.hottailgrid.setNp(case['hottail'][0])
+        ds.hottailgrid.setNxi(case['hottail'][1])
+    if 'runaway' in case and ds.runawaygrid.enabled:
+        ds.runawaygrid.setNp(case['runaway'][0])
+        ds.runawaygrid.setNxi(case['runaway'][1])
+    if 'nt' in case:
+        ds.timestep.setNt(case['nt'])
+
+    ds.solver.setVerbose(False)
+    ds.output.setTiming(stdout=False, file=True)
+    ds.output.setFilename(os.path.join(workdir, 'output.h5'))
+
+    return ds
+
+
+def flattenTimings(timings, prefix=''):
+    """
+    Convert the hierarchical timing information of a DREAMOutput
+    object to a flat dict (with times given in seconds).
+    """
+    d = {}
+    for key in timings.timings:
+        d[prefix+key] = timings.timings[key] * 1e-6
+    for key in timings.subtimers:
+        d[prefix+key] = timings[key].getTotal() * 1e-6
+        d.update(flattenTimings(timings[key], prefix=prefix+key+'/'))
+
+    return d
+
+
+def runCase(name, case, verbose=False):
+    """
+    Run the named benchmark case and return a dict with the
+    measured quantities.
+    """
+    workdir = tempfile.mkdtemp(prefix='dreamperf_')
+    try:
+        ds = generateSettings(name, case, workdir)
+        infile = os.path.join(workdir, 'perf_settings.h5')
+        ds.save(infile)
+
+        dreami = os.environ.get('DREAMPATH', str(ROOT)).rstrip('/') + '/build/iface/dreami'
+
+        tic = time.perf_counter()
+        p = subprocess.Popen([dreami, infile], cwd=workdir,
+            stdout=(None if verbose else subprocess.DEVNULL))
+        # Use 'wait4()' to obtain the resource usage of this
+        # particular child process only
+        _, status, rusage = os.wait4(p.pid, 0)
+        wall = time.perf_counter() - tic
+        p.returncode = os.waitstatus_to_exitcode(status)
+
+        if p.returncode != 0:
+            raise Exception("DREAMi exited with a non-zero exit code: {}".format(p.returncode))
+
+        outfile = os.path.join(workdir, 'output.h5')
+        do = DREAMOutput(outfile)
+
+        result = {
+            'wall': wall,
+            # 'ru_maxrss' is given in kB on Linux
+            'peak_rss': rusage.ru_maxrss * 1024,
+            'outputsize': os.path.getsize(outfile)
+        }
+
+        if do.timings is not None:
+            t = flattenTimings(do.timings)
+            result['total'] = do.timings.getTotal() * 1e-6
+            result['timings'] = t
+
+        if do.solver is not None and hasattr(do.solver, 'iterations'):
+            result['iterations'] = int(sum(do.solver.iterations))
+
+        do.close()
+        return result
+    finally:
+        shutil.rmtree(workdir, ignore_errors=True)
+
+
+def compare(name, result, baseline):
+    """
+    Compare the given result against the baseline and report any
+    regressions.
+
+    RETURNS True if no quantity exceeded its tolerance band.
+    """
+    if baseline is None:
+        print_warning("No baseline available for '{}'.".format(name))
+        return True
+
+    success = True
+    for q, tol in TOLERANCES.items():
+        if q not in result or q not in baseline:
+            continue
+
+        v, v0 = result[q], baseline[q]
+        rel = (v - v0) / v0 if v0 != 0 else 0
+        msg = "{:12s} {:12.4g}  (baseline {:12.4g}, {:+.1f}%)".format(q, v, v0, 100*rel)
+
+        if rel > tol:
+            print_error(msg)
+            success = False
+        else:
+            print_ok(msg)
+
+    return success
+
+
+def loadBaseline(filename):
+    """
+    Load the baseline stored in the named file.
+    """
+    if not os.path.isfile(filename):
+        return {}
+
+    with open(filename, 'r') as f:
+        return json.load(f)
+
+
+def saveBaseline(filename, results):
+    """
+    Store the given results as the new baseline.
+    """
+    with open(filename, 'w') as f:
+        json.dump(results, f, indent=2, sort_keys=True)
+
+
+def print_help():
+    """
+    Prints command help.
+    """
+    print("Performance regression tests for DREAM\n")
+
+    print("Usage:")
+    print("    runperf.py           Show this help message.")
+    print("    runperf.py all       Run all benchmark cases.")
+    print("    runperf.py [FLAGS] [case1 [case2 [...]]]")
+    print("                         Run the benchmark cases with names 'case1', 'case2' etc.\n")
+
+    print("Options:")
+    print("    --baseline FILE      Name of file containing the baseline.")
+    print("    --json FILE          Write the measured quantities to FILE.")
+    print("    --save-baseline      Store the results as the new baseline.")
+    print("    --verbose            Show the output of DREAMi.\n")
+
+    print("Available cases:")
+    for case in CASES:
+        print("    {}".format(case))
+
+
+def main(argv):
+    """
+    Program entry point.
+    """
+    parser = argparse.ArgumentParser(description='DREAM performance regression tests')
+
+    parser.add_argument('--baseline', help="Name of file containing the baseline", type=str, default=str(DEFAULT_BASELINE))
+    parser.add_argument('--json', help="Write the measured quantities to the named file", type=str, default=None)
+    parser.add_argument('--save-baseline', help="Store the results as the new baseline", action="store_true")
+    parser.add_argument('--verbose', help="Show the output of DREAMi", action="store_true")
+    parser.add_argument('cases', help="List of benchmark cases to run", type=str, nargs='*')
+
+    args = parser.parse_args(argv)
+
+    if len(args.cases) == 0:
+        print_help()
+        return 1
+    elif len(args.cases) == 1 and args.cases[0].lower() == 'all':
+        cases = list(CASES.keys())
+    else:
+        cases = args.cases
+
+    baseline = loadBaseline(args.baseline)
+    results = {}
+    success = True
+
+    for name in cases:
+        print("\x1B[1m:: {} \x1B[0m".format(name))
+        if name not in CASES:
+            print_error("Unrecognized benchmark case: '{}'.".format(name))
+            success = False
+            continue
+
+        try:
+            results[name] = runCase(name, CASES[name], verbose=args.verbose)
+        except Exception as ex:
+            print_error("Benchmark case '{}' failed: {}".format(name, ex))
+            success = False
+            continue
+
+        if not args.save_baseline:
+            success = compare(name, results[name], baseline.get(name)) and success
+
+    if args.json is not None:
+        saveBaseline(args.json, results)
+
+    if args.save_baseline:
+        baseline.update(results)
+        saveBaseline(args.baseline, baseline)
+        print("Baseline written to '{}'.".format(args.baseline))
+
+    # Return non-zero exit code on regression
+    if success: return 0
+    else: return 255
+
+
+if __name__ == '__main__':
+    sys.exit(main(sys.argv[1:]))
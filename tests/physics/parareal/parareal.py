@@ -0,0 +1,149 @@
+# PARAREAL TEST
+#
+# This test solves a runaway avalanche (an exponentially growing runaway
+# electron density, driven by a constant electric field) with the constant
+# time stepper, first serially and then in parallel in time with the parareal
+# method on several MPI processes. Once the parareal iteration has converged,
+# the merged output of the time windows must agree with the serial solution
+# in every time step.
+
+import numpy as np
+import os
+import shutil
+import subprocess
+
+import dreamtests
+
+import DREAM
+import DREAM.Settings.CollisionHandler as Collisions
+import DREAM.Settings.Solver as Solver
+import DREAM.Settings.TimeStepper as TimeStepper
+import DREAM.Settings.Equations.IonSpecies as Ions
+import DREAM.Settings.Equations.RunawayElectrons as RE
+from DREAM.Parareal import mergeWindows
+
+
+# Number of MPI processes (time windows) to use
+NPROC = 2
+# Tolerance of the parareal iteration
+PARAREAL_RELTOL = 1e-10
+# Largest allowed relative difference from the serial solution
+TOLERANCE = 1e-8
+
+
+def genSettings():
+    """
+    Generate the DREAMSettings object.
+    """
+    ds = DREAM.DREAMSettings()
+
+    a    = 0.5
+    B0   = 5
+    E    = 1
+    Nr   = 4
+    Nt   = 200
+    T    = 100
+    tMax = 0.1
+
+    ds.collisions.collfreq_mode = Collisions.COLLFREQ_MODE_FULL
+
+    ds.radialgrid.setB0(B0)
+    ds.radialgrid.setNr(Nr)
+    ds.radialgrid.setMinorRadius(a)
+    ds.radialgrid.setWallRadius(a)
+
+    ds.timestep.setType(TimeStepper.TYPE_CONSTANT)
+    ds.timestep.setTmax(tMax)
+    ds.timestep.setNt(Nt)
+    ds.timestep.setParareal(coarsesteps=5, maxiter=NPROC, reltol=PARAREAL_RELTOL)
+
+    ds.eqsys.n_i.addIon(name='D', Z=1, iontype=Ions.IONS_PRESCRIBED_FULLY_IONIZED, n=5e19)
+    ds.eqsys.E_field.setPrescribedData(E)
+    ds.eqsys.T_cold.setPrescribedData(T)
+
+    ds.eqsys.n_re.setAvalanche(RE.AVALANCHE_MODE_FLUID)
+    ds.eqsys.n_re.setInitialProfile(density=1e16)
+
+    ds.hottailgrid.setEnabled(False)
+    ds.runawaygrid.setEnabled(False)
+
+    ds.solver.setType(Solver.NONLINEAR)
+    ds.solver.setLinearSolver(linsolv=Solver.LINEAR_SOLVER_LU)
+
+    return ds
+
+
+def runParareal(ds, output, save):
+    """
+    Run the simulation on 'NPROC' MPI processes and merge the
+    output of the time windows into the file 'output'. Unless
+    'save' is 'True', the settings file is removed afterwards.
+    """
+    settings = 'settings_parareal.h5'
+    ds.output.setFilename(output)
+    ds.save(settings)
+
+    stem, ext = os.path.splitext(output)
+    windows = ['{}_window{}{}'.format(stem, i, ext) for i in range(NPROC)]
+
+    try:
+        p = subprocess.run([shutil.which('mpiexec'), '-n', str(NPROC), '{}/build/iface/dreami'.format(DREAM.DREAMPATH), settings], stdout=subprocess.PIPE, stderr=subprocess.PIPE)
+        if p.returncode != 0:
+            print(p.stderr.decode('utf-8'))
+            return None
+
+        mergeWindows(windows, output)
+        return DREAM.DREAMOutput(output)
+    finally:
+        for f in windows:
+            if os.path.isfile(f):
+                os.remove(f)
+
+        if not save:
+            os.remove(settings)
+
+
+def run(args):
+    """
+    Run the test.
+    """
+    QUIET = True
+
+    if shutil.which('mpiexec') is None:
+        dreamtests.print_error("Unable to locate 'mpiexec', which is required for running DREAMi in parallel.")
+        return False
+
+    output_serial = None
+    if args['save']:
+        output_serial = 'output_parareal_serial.h5'
+
+    ds = genSettings()
+    do_serial = DREAM.runiface(ds, output_serial, quiet=QUIET)
+
+    output = 'output_parareal.h5'
+    do_para = runParareal(genSettings(), output, args['save'])
+    if do_para is None:
+        dreamtests.print_error("DREAMi exited with a non-zero exit code when running in parallel.")
+        return False
+
+    success = True
+    t_serial, t_para = do_serial.grid.t[:], do_para.grid.t[:]
+    if t_serial.shape != t_para.shape or not np.allclose(t_serial, t_para, rtol=1e-12, atol=0):
+        dreamtests.print_error("The merged parareal output has a different time grid than the serial solution.")
+        success = False
+    else:
+        a = do_serial.eqsys.n_re[:]
+        b = do_para.eqsys.n_re[:]
+        eps = np.amax(np.abs(a/b - 1))
+
+        if eps > TOLERANCE:
+            dreamtests.print_error("The parareal solution differs from the serial solution. eps = {:.8e}".format(eps))
+            success = False
+        else:
+            dreamtests.print_ok("The parareal solution agrees with the serial solution. eps = {:.8e}".format(eps))
+
+    do_para.close()
+    if not args['save']:
+        os.remove(output)
+
+    return success
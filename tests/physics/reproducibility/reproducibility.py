@@ -0,0 +1,115 @@
+# REPRODUCIBILITY TEST
+#
+# This test solves the same equation system using a different number of
+# threads for assembling the equation system, and verifies that the
+# solutions are bitwise identical. Since golden outputs are compared
+# exactly, the results of DREAM may not depend on the number of threads
+# used in the reproducible mode (the default, 'solver/reproducible'), i.e.
+# any parallel reduction must be evaluated in a fixed order, as is done
+# by 'FVM::Parallel::Sum()'.
+
+import numpy as np
+import sys
+
+import dreamtests
+
+import DREAM
+import DREAM.Settings.CollisionHandler as Collisions
+import DREAM.Settings.Solver as Solver
+import DREAM.Settings.Equations.ElectricField as EField
+import DREAM.Settings.Equations.HotElectronDistribution as FHot
+import DREAM.Settings.Equations.IonSpecies as Ions
+import DREAM.Settings.Equations.RunawayElectrons as RE
+
+
+NTHREADS = [1, 2, 4]
+
+
+def genSettings(nthreads):
+    """
+    Generate the DREAMSettings object for a run with the
+    given number of threads.
+    """
+    ds = DREAM.DREAMSettings()
+
+    a    = 0.5
+    B0   = 5
+    E    = 0.5
+    Nr   = 4
+    Np   = 40
+    Nt   = 4
+    Nxi  = 10
+    pMax = 1
+    tMax = 1e-4
+    T    = 1000
+
+    ds.collisions.collfreq_mode = Collisions.COLLFREQ_MODE_FULL
+
+    ds.radialgrid.setB0(B0)
+    ds.radialgrid.setNr(Nr)
+    ds.radialgrid.setMinorRadius(a)
+    ds.radialgrid.setWallRadius(a)
+
+    ds.timestep.setTmax(tMax)
+    ds.timestep.setNt(Nt)
+
+    ds.eqsys.n_i.addIon(name='D', Z=1, iontype=Ions.IONS_PRESCRIBED_FULLY_IONIZED, n=1e20)
+    ds.eqsys.n_i.addIon(name='Ar', Z=18, iontype=Ions.IONS_PRESCRIBED, Z0=2, n=1e19)
+    ds.eqsys.E_field.setPrescribedData(E)
+    ds.eqsys.T_cold.setPrescribedData(T)
+
+    ds.eqsys.n_re.setAvalanche(RE.AVALANCHE_MODE_FLUID)
+
+    ds.hottailgrid.setEnabled(True)
+    ds.hottailgrid.setNxi(Nxi)
+    ds.hottailgrid.setNp(Np)
+    ds.hottailgrid.setPmax(pMax)
+
+    ds.runawaygrid.setEnabled(False)
+
+    nfree_initial, rn0 = ds.eqsys.n_i.getFreeElectronDensity()
+    ds.eqsys.f_hot.setInitialProfiles(rn0=rn0, n0=nfree_initial, rT0=0, T0=T)
+    ds.eqsys.f_hot.setBoundaryCondition(bc=FHot.BC_F_0)
+    ds.eqsys.f_hot.setParticleSource(particleSource=FHot.PARTICLE_SOURCE_IMPLICIT)
+
+    ds.solver.setType(Solver.NONLINEAR)
+    ds.solver.setLinearSolver(linsolv=Solver.LINEAR_SOLVER_LU)
+    ds.solver.setNumberOfThreads(nthreads)
+    ds.solver.setReproducible(True)
+
+    return ds
+
+
+def run(args):
+    """
+    Run the test.
+    """
+    QUIET = True
+
+    outputs = []
+    for nthreads in NTHREADS:
+        ds = genSettings(nthreads)
+        output = None
+        if args['save']:
+            ds.save('settings_reproducibility_{}.h5'.format(nthreads))
+            output = 'output_reproducibility_{}.h5'.format(nthreads)
+
+        outputs.append(DREAM.runiface(ds, output, quiet=QUIET))
+
+    # Compare results
+    success = True
+    ref = outputs[0]
+    for nthreads, do in zip(NTHREADS[1:], outputs[1:]):
+        for name in ref.eqsys.getUnknownNames():
+            a = ref.eqsys[name].data[:]
+            b = do.eqsys[name].data[:]
+
+            if a.shape != b.shape or not np.array_equal(a, b, equal_nan=True):
+                dreamtests.print_error("'{}' differs between runs with {} and {} threads.".format(name, NTHREADS[0], nthreads))
+                success = False
+
+    if success:
+        dreamtests.print_ok("Solutions are bitwise identical for {} threads.".format(', '.join([str(n) for n in NTHREADS])))
+
+    return success
+
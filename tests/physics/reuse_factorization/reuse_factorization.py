@@ -0,0 +1,98 @@
+# FACTORIZATION REUSE TEST
+#
+# This test solves a runaway avalanche (an exponentially growing runaway
+# electron density, driven by a constant electric field and in a plasma with
+# constant density and temperature) with the linearly implicit solver, with
+# and without reusing the factorization of the matrix between time steps.
+# Since the matrix of this equation system is the same in every time step,
+# the factorization is only computed once when reuse is enabled. The reuse
+# may however never affect the solution, and the results of the two runs must
+# therefore be bitwise identical.
+
+import numpy as np
+
+import dreamtests
+
+import DREAM
+import DREAM.Settings.CollisionHandler as Collisions
+import DREAM.Settings.Solver as Solver
+import DREAM.Settings.TimeStepper as TimeStepper
+import DREAM.Settings.Equations.IonSpecies as Ions
+import DREAM.Settings.Equations.RunawayElectrons as RE
+
+
+def genSettings(reuse):
+    """
+    Generate the DREAMSettings object.
+    """
+    ds = DREAM.DREAMSettings()
+
+    a    = 0.5
+    B0   = 5
+    E    = 1
+    Nr   = 4
+    Nt   = 20
+    T    = 100
+    tMax = 0.1
+
+    ds.collisions.collfreq_mode = Collisions.COLLFREQ_MODE_FULL
+
+    ds.radialgrid.setB0(B0)
+    ds.radialgrid.setNr(Nr)
+    ds.radialgrid.setMinorRadius(a)
+    ds.radialgrid.setWallRadius(a)
+
+    ds.timestep.setType(TimeStepper.TYPE_CONSTANT)
+    ds.timestep.setTmax(tMax)
+    ds.timestep.setNt(Nt)
+
+    ds.eqsys.n_i.addIon(name='D', Z=1, iontype=Ions.IONS_PRESCRIBED_FULLY_IONIZED, n=5e19)
+    ds.eqsys.E_field.setPrescribedData(E)
+    ds.eqsys.T_cold.setPrescribedData(T)
+
+    ds.eqsys.n_re.setAvalanche(RE.AVALANCHE_MODE_FLUID)
+    ds.eqsys.n_re.setInitialProfile(density=1e16)
+
+    ds.hottailgrid.setEnabled(False)
+    ds.runawaygrid.setEnabled(False)
+
+    ds.solver.setType(Solver.LINEAR_IMPLICIT)
+    ds.solver.setLinearSolver(linsolv=Solver.LINEAR_SOLVER_LU)
+    ds.solver.setReuseFactorization(reuse)
+
+    return ds
+
+
+def run(args):
+    """
+    Run the test.
+    """
+    QUIET = True
+
+    outputs = {}
+    for reuse in [False, True]:
+        name = 'reuse' if reuse else 'noreuse'
+        ds = genSettings(reuse)
+
+        output = None
+        if args['save']:
+            ds.save('settings_reuse_factorization_{}.h5'.format(name))
+            output = 'output_reuse_factorization_{}.h5'.format(name)
+
+        outputs[reuse] = DREAM.runiface(ds, output, quiet=QUIET)
+
+    # Compare results
+    success = True
+    ref, do = outputs[False], outputs[True]
+    for name in ref.eqsys.getUnknownNames():
+        a = ref.eqsys[name].data[:]
+        b = do.eqsys[name].data[:]
+
+        if a.shape != b.shape or not np.array_equal(a, b, equal_nan=True):
+            dreamtests.print_error("'{}' differs between runs with and without reuse of the factorization.".format(name))
+            success = False
+
+    if success:
+        dreamtests.print_ok("Solutions with and without reuse of the factorization are bitwise identical.")
+
+    return success
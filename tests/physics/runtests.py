@@ -26,8 +26,14 @@ from code_runaway import code_runaway
 from code_synchrotron import code_synchrotron
 from DREAM_avalanche import DREAM_avalanche
 from numericmag import numericmag
+from parareal import parareal
+from reproducibility import reproducibility
+from reuse_factorization import reuse_factorization
+from solver_nonlinear import solver_nonlinear
 from trapping_conductivity import trapping_conductivity
 from ts_adaptive import ts_adaptive
+from ts_bdf import ts_bdf
+from ts_embedded import ts_embedded
 
 
 TESTS = [
@@ -36,8 +42,14 @@ TESTS = [
     'code_synchrotron',
     'DREAM_avalanche',
     'numericmag',
+    'parareal',
+    'reproducibility',
+    'reuse_factorization',
+    'solver_nonlinear',
     'trapping_conductivity',
-    'ts_adaptive'
+    'ts_adaptive',
+    'ts_bdf',
+    'ts_embedded'
 ]
 
 
@@ -0,0 +1,146 @@
+# NON-LINEAR SOLVER TEST
+#
+# This test solves a non-linear equation system (a self-consistent electric
+# field, ionizing argon and fluid runaway generation) with the standard
+# Newton iteration, and with several alternative configurations of the
+# non-linear solver. Since all configurations solve the same equations to the
+# same tolerance, they must converge to the same solution (to within the
+# tolerance of the solver), even though the iterations themselves differ.
+
+import numpy as np
+
+import dreamtests
+
+import DREAM
+import DREAM.Settings.CollisionHandler as Collisions
+import DREAM.Settings.Solver as Solver
+import DREAM.Settings.Equations.ElectricField as EField
+import DREAM.Settings.Equations.IonSpecies as Ions
+import DREAM.Settings.Equations.RunawayElectrons as RE
+
+
+# Largest allowed relative difference from the standard Newton solution
+TOLERANCE = 1e-4
+
+
+def setJFNK(ds):
+    ds.solver.setJacobianUpdate(Solver.JACOBIAN_UPDATE_JFNK)
+
+
+def setLineSearch(ds):
+    ds.solver.setLineSearch(Solver.LINE_SEARCH_BACKTRACKING)
+
+
+def setLocalizedNewton(ds):
+    ds.solver.setLocalizedNewton(True, width=1, maxfraction=1)
+
+
+def setPseudoTransient(ds):
+    ds.solver.setPseudoTransient(True)
+
+
+# Solver configurations to compare with the standard Newton iteration
+CONFIGS = {
+    'jfnk': setJFNK,
+    'linesearch': setLineSearch,
+    'localized': setLocalizedNewton,
+    'pseudotransient': setPseudoTransient
+}
+
+
+def genSettings():
+    """
+    Generate the baseline DREAMSettings object, which is solved
+    using the standard Newton iteration.
+    """
+    ds = DREAM.DREAMSettings()
+
+    a    = 0.5
+    b    = 0.6
+    B0   = 5
+    E0   = 0.5
+    Nr   = 10
+    Nt   = 10
+    R0   = 1.65
+    tMax = 1e-3
+    T    = 100
+
+    ds.collisions.collfreq_type = Collisions.COLLFREQ_TYPE_PARTIALLY_SCREENED
+
+    ds.radialgrid.setB0(B0)
+    ds.radialgrid.setNr(Nr)
+    ds.radialgrid.setMinorRadius(a)
+    ds.radialgrid.setWallRadius(b)
+
+    ds.timestep.setTmax(tMax)
+    ds.timestep.setNt(Nt)
+
+    ds.eqsys.n_i.addIon(name='D', Z=1, iontype=Ions.IONS_PRESCRIBED_FULLY_IONIZED, n=5e19)
+    ds.eqsys.n_i.addIon(name='Ar', Z=18, iontype=Ions.IONS_DYNAMIC_NEUTRAL, n=1e18)
+
+    ds.eqsys.E_field.setType(EField.TYPE_SELFCONSISTENT)
+    ds.eqsys.E_field.setInitialProfile(efield=E0)
+    ds.eqsys.E_field.setBoundaryCondition(EField.BC_TYPE_TRANSFORMER, V_loop_wall_R0=E0, inverse_wall_time=1e2, R0=R0)
+    ds.eqsys.T_cold.setPrescribedData(T)
+
+    ds.eqsys.n_re.setAvalanche(RE.AVALANCHE_MODE_FLUID)
+    ds.eqsys.n_re.setDreicer(RE.DREICER_RATE_CONNOR_HASTIE)
+
+    ds.hottailgrid.setEnabled(False)
+    ds.runawaygrid.setEnabled(False)
+
+    ds.solver.setType(Solver.NONLINEAR)
+    ds.solver.setLinearSolver(linsolv=Solver.LINEAR_SOLVER_LU)
+
+    return ds
+
+
+def runSingle(name, args, quiet, config=None):
+    """
+    Run the simulation with the given solver configuration.
+    """
+    ds = genSettings()
+    if config is not None:
+        config(ds)
+
+    output = None
+    if args['save']:
+        ds.save('settings_solver_nonlinear_{}.h5'.format(name))
+        output = 'output_solver_nonlinear_{}.h5'.format(name)
+
+    return DREAM.runiface(ds, output, quiet=quiet)
+
+
+def run(args):
+    """
+    Run the test.
+    """
+    QUIET = True
+
+    ref = runSingle('newton', args, QUIET)
+
+    success = True
+    for name, config in CONFIGS.items():
+        do = runSingle(name, args, QUIET, config)
+
+        eps = 0
+        for uqn in ref.eqsys.getUnknownNames():
+            a = ref.eqsys[uqn].data[:]
+            b = do.eqsys[uqn].data[:]
+
+            if a.shape != b.shape:
+                dreamtests.print_error("'{}' has a different shape in the '{}' solution.".format(uqn, name))
+                success = False
+                continue
+
+            scale = np.amax(np.abs(a))
+            if scale > 0:
+                eps = max(eps, np.amax(np.abs(a-b)) / scale)
+
+        if eps > TOLERANCE:
+            dreamtests.print_error("The '{}' solution differs from the Newton solution. eps = {:.8e}".format(name, eps))
+            success = False
+        else:
+            dreamtests.print_ok("The '{}' solution agrees with the Newton solution. eps = {:.8e}".format(name, eps))
+
+    return success
@@ -0,0 +1,117 @@
+# BDF ORDER OF CONVERGENCE TEST
+#
+# This test evolves a runaway avalanche (an exponentially growing runaway
+# electron density, driven by a constant electric field) with the constant
+# time stepper, using BDF methods of different orders and a sequence of
+# halved time steps. The error of the final runaway density, relative to a
+# reference solution computed with very short time steps, must decrease with
+# the time step at (at least approximately) the order of the method.
+
+import numpy as np
+
+import dreamtests
+
+import DREAM
+import DREAM.Settings.CollisionHandler as Collisions
+import DREAM.Settings.Solver as Solver
+import DREAM.Settings.TimeStepper as TimeStepper
+import DREAM.Settings.Equations.IonSpecies as Ions
+import DREAM.Settings.Equations.RunawayElectrons as RE
+
+
+# BDF orders to test
+ORDERS = [1, 2]
+# Number of time steps to take (each twice the previous)
+NTS = [25, 50, 100]
+# Number of time steps (and BDF order) of the reference solution
+NT_REFERENCE = 3200
+ORDER_REFERENCE = 3
+# Largest allowed deviation of the observed order from the order of the method
+ORDER_TOLERANCE = 0.3
+
+
+def genSettings(order, nt):
+    """
+    Generate the DREAMSettings object for a run with the given
+    BDF order and number of time steps.
+    """
+    ds = DREAM.DREAMSettings()
+
+    a    = 0.5
+    B0   = 5
+    E    = 1
+    Nr   = 1
+    T    = 100
+    tMax = 0.1
+
+    ds.collisions.collfreq_mode = Collisions.COLLFREQ_MODE_FULL
+
+    ds.radialgrid.setB0(B0)
+    ds.radialgrid.setNr(Nr)
+    ds.radialgrid.setMinorRadius(a)
+    ds.radialgrid.setWallRadius(a)
+
+    ds.timestep.setType(TimeStepper.TYPE_CONSTANT)
+    ds.timestep.setTmax(tMax)
+    ds.timestep.setNt(nt)
+    ds.timestep.setBDFOrder(order)
+
+    ds.eqsys.n_i.addIon(name='D', Z=1, iontype=Ions.IONS_PRESCRIBED_FULLY_IONIZED, n=5e19)
+    ds.eqsys.E_field.setPrescribedData(E)
+    ds.eqsys.T_cold.setPrescribedData(T)
+
+    ds.eqsys.n_re.setAvalanche(RE.AVALANCHE_MODE_FLUID)
+    ds.eqsys.n_re.setInitialProfile(density=1e16)
+
+    ds.hottailgrid.setEnabled(False)
+    ds.runawaygrid.setEnabled(False)
+
+    ds.solver.setType(Solver.NONLINEAR)
+    ds.solver.setLinearSolver(linsolv=Solver.LINEAR_SOLVER_LU)
+
+    return ds
+
+
+def runSingle(order, nt, args, quiet):
+    """
+    Run a single simulation and return the final runaway density.
+    """
+    name = 'ts_bdf_{}_{}'.format(order, nt)
+    ds = genSettings(order, nt)
+
+    output = None
+    if args['save']:
+        ds.save('settings_{}.h5'.format(name))
+        output = 'output_{}.h5'.format(name)
+
+    do = DREAM.runiface(ds, output, quiet=quiet)
+    return do.eqsys.n_re[-1,0]
+
+
+def run(args):
+    """
+    Run the test.
+    """
+    QUIET = True
+
+    nre_ref = runSingle(ORDER_REFERENCE, NT_REFERENCE, args, QUIET)
+
+    success = True
+    errors = {}
+    for order in ORDERS:
+        errors[order] = np.array([np.abs(runSingle(order, nt, args, QUIET) / nre_ref - 1) for nt in NTS])
+
+        # Observed orders of convergence
+        p = np.log2(errors[order][:-1] / errors[order][1:])
+        if np.any(p < order - ORDER_TOLERANCE):
+            dreamtests.print_error("BDF{} converges too slowly. Observed orders: {}.".format(order, ', '.join(['{:.3f}'.format(x) for x in p])))
+            success = False
+        else:
+            dreamtests.print_ok("BDF{} converges at the expected rate. Observed orders: {}.".format(order, ', '.join(['{:.3f}'.format(x) for x in p])))
+
+    for order in ORDERS[1:]:
+        if np.any(errors[order] >= errors[order-1]):
+            dreamtests.print_error("BDF{} is not more accurate than BDF{} with the same time steps.".format(order, order-1))
+            success = False
+
+    return success
@@ -0,0 +1,121 @@
+# EMBEDDED TIME STEPPER TEST
+#
+# This test evolves a runaway avalanche (an exponentially growing runaway
+# electron density, driven by a constant electric field) with the embedded
+# adaptive time stepper for a few different tolerances, and compares the
+# final runaway density with a reference solution computed with very short
+# constant time steps. The time stepper must reach the final time, and
+# tightening the tolerance must both shorten the time steps and reduce the
+# error of the solution.
+
+import numpy as np
+
+import dreamtests
+
+import DREAM
+import DREAM.Settings.CollisionHandler as Collisions
+import DREAM.Settings.Solver as Solver
+import DREAM.Settings.TimeStepper as TimeStepper
+import DREAM.Settings.Equations.IonSpecies as Ions
+import DREAM.Settings.Equations.RunawayElectrons as RE
+
+
+# Time step tolerances to test (in decreasing order)
+RELTOLS = [1e-2, 1e-3, 1e-4]
+# Number of time steps in the reference solution
+NT_REFERENCE = 10000
+# Simulation time
+TMAX = 0.1
+
+
+def genSettings(reltol=None):
+    """
+    Generate the DREAMSettings object. If 'reltol' is 'None', the
+    constant time stepper is used to generate the reference solution.
+    """
+    ds = DREAM.DREAMSettings()
+
+    a    = 0.5
+    B0   = 5
+    E    = 1
+    Nr   = 1
+    T    = 100
+
+    ds.collisions.collfreq_mode = Collisions.COLLFREQ_MODE_FULL
+
+    ds.radialgrid.setB0(B0)
+    ds.radialgrid.setNr(Nr)
+    ds.radialgrid.setMinorRadius(a)
+    ds.radialgrid.setWallRadius(a)
+
+    if reltol is None:
+        ds.timestep.setType(TimeStepper.TYPE_CONSTANT)
+        ds.timestep.setTmax(TMAX)
+        ds.timestep.setNt(NT_REFERENCE)
+    else:
+        ds.timestep.setEmbedded(dt0=TMAX*1e-4, tmax=TMAX)
+        ds.timestep.setRelTol(reltol)
+
+    ds.eqsys.n_i.addIon(name='D', Z=1, iontype=Ions.IONS_PRESCRIBED_FULLY_IONIZED, n=5e19)
+    ds.eqsys.E_field.setPrescribedData(E)
+    ds.eqsys.T_cold.setPrescribedData(T)
+
+    ds.eqsys.n_re.setAvalanche(RE.AVALANCHE_MODE_FLUID)
+    ds.eqsys.n_re.setInitialProfile(density=1e16)
+
+    ds.hottailgrid.setEnabled(False)
+    ds.runawaygrid.setEnabled(False)
+
+    ds.solver.setType(Solver.NONLINEAR)
+    ds.solver.setLinearSolver(linsolv=Solver.LINEAR_SOLVER_LU)
+
+    return ds
+
+
+def run(args):
+    """
+    Run the test.
+    """
+    QUIET = True
+
+    output_ref = None
+    if args['save']:
+        output_ref = 'output_ts_embedded_ref.h5'
+
+    ds_ref = genSettings()
+    if args['save']:
+        ds_ref.save('settings_ts_embedded_ref.h5')
+    do_ref = DREAM.runiface(ds_ref, output_ref, quiet=QUIET)
+    nre_ref = do_ref.eqsys.n_re[-1,0]
+
+    success = True
+    errors, nsteps = [], []
+    for i, reltol in enumerate(RELTOLS):
+        output = None
+        ds = genSettings(reltol)
+        if args['save']:
+            ds.save('settings_ts_embedded_{}.h5'.format(i))
+            output = 'output_ts_embedded_{}.h5'.format(i)
+
+        do = DREAM.runiface(ds, output, quiet=QUIET)
+
+        t = do.grid.t[:]
+        if not np.isclose(t[-1], TMAX, rtol=1e-10, atol=0):
+            dreamtests.print_error("Embedded time stepper stopped at t = {:.8e} instead of t = {:.8e} with reltol = {:.1e}.".format(t[-1], TMAX, reltol))
+            success = False
+
+        errors.append(np.abs(do.eqsys.n_re[-1,0] / nre_ref - 1))
+        nsteps.append(t.size-1)
+
+    for i in range(1, len(RELTOLS)):
+        if nsteps[i] <= nsteps[i-1]:
+            dreamtests.print_error("The number of time steps did not increase when reducing the tolerance from {:.1e} to {:.1e} ({} vs {} steps).".format(RELTOLS[i-1], RELTOLS[i], nsteps[i-1], nsteps[i]))
+            success = False
+        if errors[i] >= errors[i-1]:
+            dreamtests.print_error("The error did not decrease when reducing the tolerance from {:.1e} to {:.1e} (eps = {:.8e} vs {:.8e}).".format(RELTOLS[i-1], RELTOLS[i], errors[i-1], errors[i]))
+            success = False
+
+    if success:
+        dreamtests.print_ok("Embedded time stepper converges to the reference solution (eps = {}).".format(', '.join(['{:.2e}'.format(e) for e in errors])))
+
+    return success
@@ -1,4 +1,5 @@
 
+from .csrmat import *
 from .petscmat import *
 from .residual import *
 from .DREAMEqsys import DREAMEqsys
@@ -0,0 +1,111 @@
+#
+# Routines for loading matrices stored in the raw binary CSR format
+# written by DREAM when the solver debug format is set to
+# 'DEBUG_FORMAT_CSR'. The arrays of the file are memory-mapped, so that
+# individual blocks of (very) large jacobians can be inspected without
+# reading the full matrix into memory.
+
+import json
+import numpy as np
+import scipy.sparse as sparse
+
+
+MAGIC = b'DREAMCSR'
+
+
+class CSRFile:
+
+
+    def __init__(self, filename):
+        """
+        Open the named CSR file and map its arrays into memory.
+        """
+        self.filename = filename
+
+        with open(filename, 'rb') as f:
+            magic = f.read(8)
+            if magic != MAGIC:
+                raise Exception("'{}': Not a DREAM CSR matrix file.".format(filename))
+
+            header = np.fromfile(f, dtype=np.int64, count=5)
+            version, self.nrows, self.ncols, self.nnz, nindex = [int(h) for h in header]
+            if version != 1:
+                raise Exception("'{}': Unsupported CSR file version: {}.".format(filename, version))
+
+            index = f.read(nindex).decode('utf-8').strip()
+
+        self.index = json.loads(index) if index else {}
+        self.unknowns = { u['name']: u for u in self.index.get('unknowns', []) }
+
+        offset = 8 + 5*8 + nindex
+        self.rowptr = np.memmap(filename, dtype=np.int64, mode='r', offset=offset, shape=(self.nrows+1,))
+        offset += (self.nrows+1)*8
+        self.colidx = np.memmap(filename, dtype=np.int64, mode='r', offset=offset, shape=(self.nnz,))
+        offset += self.nnz*8
+        self.values = np.memmap(filename, dtype=np.float64, mode='r', offset=offset, shape=(self.nnz,))
+
+
+    def __getitem__(self, key):
+        """
+        Shorthand for 'getBlock()', i.e. 'f[row, col]' with 'row'
+        and 'col' names of unknowns.
+        """
+        return self.getBlock(*key)
+
+
+    def _getRange(self, unknown):
+        """
+        Returns the range of matrix indices corresponding to
+        the named unknown.
+        """
+        if unknown not in self.unknowns:
+            raise KeyError("No unknown named '{}' in '{}'.".format(unknown, self.filename))
+
+        u = self.unknowns[unknown]
+        return u['offset'], u['offset']+u['size']
+
+
+    def getMatrix(self):
+        """
+        Returns the full matrix as a 'scipy.sparse.csr_matrix'.
+        """
+        return sparse.csr_matrix((self.values, self.colidx, self.rowptr), shape=(self.nrows, self.ncols))
+
+
+    def getBlock(self, rowUnknown, colUnknown):
+        """
+        Returns the block of the matrix corresponding to the equation
+        for 'rowUnknown' and the unknown 'colUnknown', as a
+        'scipy.sparse.csr_matrix'. Only the rows of the block are read
+        from the file.
+        """
+        r0, r1 = self._getRange(rowUnknown)
+        c0, c1 = self._getRange(colUnknown)
+
+        rp = np.array(self.rowptr[r0:r1+1])
+        cols = np.array(self.colidx[rp[0]:rp[-1]])
+        vals = np.array(self.values[rp[0]:rp[-1]])
+        rows = np.repeat(np.arange(r1-r0), np.diff(rp))
+
+        sel = (cols >= c0) & (cols < c1)
+        return sparse.csr_matrix((vals[sel], (rows[sel], cols[sel]-c0)), shape=(r1-r0, c1-c0))
+
+
+def loadcsr(filename):
+    """
+    Load a matrix saved in the DREAM CSR format. Returns a tuple
+    consisting of the full matrix (as a 'scipy.sparse.csr_matrix')
+    and the index of unknowns stored with it.
+    """
+    f = CSRFile(filename)
+    return f.getMatrix(), f.index
+
+
+def loadblock(filename, rowUnknown, colUnknown):
+    """
+    Load the block of the matrix in the named CSR file corresponding
+    to the equation for 'rowUnknown' and the unknown 'colUnknown'.
+    """
+    return CSRFile(filename).getBlock(rowUnknown, colUnknown)
+
+